@@ -309,6 +309,27 @@ void btgattc_notify_cb(int conn_id, const btgatt_notify_params_t& p_data) {
                                jb.get());
 }
 
+void btgattc_notify_batch_cb(int conn_id, const btgatt_notify_params_t* p_data,
+                             int count) {
+  std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
+  CallbackEnv sCallbackEnv(__func__);
+  if (!sCallbackEnv.valid() || !mCallbacksObj || count <= 0) return;
+
+  // All the notifications of a batch come from the same connection
+  ScopedLocalRef<jstring> address(
+      sCallbackEnv.get(), bdaddr2newjstr(sCallbackEnv.get(), &p_data[0].bda));
+  for (int i = 0; i < count; i++) {
+    ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(),
+                                  sCallbackEnv->NewByteArray(p_data[i].len));
+    sCallbackEnv->SetByteArrayRegion(jb.get(), 0, p_data[i].len,
+                                     (jbyte*)p_data[i].value);
+
+    sCallbackEnv->CallVoidMethod(mCallbacksObj, method_onNotify, conn_id,
+                                 address.get(), p_data[i].handle,
+                                 p_data[i].is_notify, jb.get());
+  }
+}
+
 void btgattc_read_characteristic_cb(int conn_id, int status,
                                     btgatt_read_params_t* p_data) {
   std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
@@ -633,6 +654,7 @@ static const btgatt_client_callbacks_t sGattClientCallbacks = {
     btgattc_conn_updated_cb,
     btgattc_service_changed_cb,
     btgattc_subrate_change_cb,
+    btgattc_notify_batch_cb,
 };
 
 /**
@@ -1039,6 +1061,33 @@ class JniScanningCallbacks : ScanningCallbacks {
         rssi, periodic_adv_int, jb.get(), fake_address.get());
   }
 
+  void OnScanResultBatch(std::vector<ScanResultBatchEntry> results,
+                         std::vector<uint8_t> adv_data) {
+    std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
+    CallbackEnv sCallbackEnv(__func__);
+    if (!sCallbackEnv.valid() || !mCallbacksObj) return;
+
+    // The whole batch is delivered under one lock and JNI environment
+    char empty_address[18] = "00:00:00:00:00:00";
+    ScopedLocalRef<jstring> fake_address(
+        sCallbackEnv.get(), sCallbackEnv->NewStringUTF(empty_address));
+    for (const ScanResultBatchEntry& result : results) {
+      ScopedLocalRef<jstring> address(
+          sCallbackEnv.get(), bdaddr2newjstr(sCallbackEnv.get(), &result.bda));
+      ScopedLocalRef<jbyteArray> jb(
+          sCallbackEnv.get(), sCallbackEnv->NewByteArray(result.adv_data_len));
+      sCallbackEnv->SetByteArrayRegion(
+          jb.get(), 0, result.adv_data_len,
+          (jbyte*)adv_data.data() + result.adv_data_offset);
+
+      sCallbackEnv->CallVoidMethod(
+          mCallbacksObj, method_onScanResult, result.event_type,
+          result.addr_type, address.get(), result.primary_phy,
+          result.secondary_phy, result.advertising_sid, result.tx_power,
+          result.rssi, result.periodic_adv_int, jb.get(), fake_address.get());
+    }
+  }
+
   void OnTrackAdvFoundLost(AdvertisingTrackInfo track_info) {
     std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
     CallbackEnv sCallbackEnv(__func__);
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "asrc_resampler.h"
+
+#include <algorithm>
+
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace bluetooth::audio::asrc {
+
+static const int KERNEL_A = ResamplerTables::KERNEL_A;
+
+//
+// Generic Resampler Filtering
+//
+
+static int64_t FilterGeneric(const int32_t* in, const int32_t* h, int16_t mu,
+                             const int16_t* d) {
+  int64_t s = 0;
+  for (int i = 0; i < 2 * KERNEL_A - 1; i++)
+    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
+
+  return s;
+}
+
+//
+// ARM AArch 64 Neon Resampler Filtering
+//
+
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+
+static inline int32x4_t vmull_low_s16(int16x8_t a, int16x8_t b) {
+  return vmull_s16(vget_low_s16(a), vget_low_s16(b));
+}
+
+static inline int64x2_t vmull_low_s32(int32x4_t a, int32x4_t b) {
+  return vmull_s32(vget_low_s32(a), vget_low_s32(b));
+}
+
+static inline int64x2_t vmlal_low_s32(int64x2_t r, int32x4_t a, int32x4_t b) {
+  return vmlal_s32(r, vget_low_s32(a), vget_low_s32(b));
+}
+
+static int64_t FilterNeon(const int32_t* x, const int32_t* h, int16_t _mu,
+                   const int16_t* d) {
+  int64x2_t sx;
+
+  int16x8_t mu = vdupq_n_s16(_mu);
+
+  int16x8_t d0 = vld1q_s16(d + 0);
+  int32x4_t h0 = vld1q_s32(h + 0), h4 = vld1q_s32(h + 4);
+  int32x4_t x0 = vld1q_s32(x + 0), x4 = vld1q_s32(x + 4);
+
+  h0 = vaddq_s32(h0, vrshrq_n_s32(vmull_low_s16(d0, mu), 7));
+  h4 = vaddq_s32(h4, vrshrq_n_s32(vmull_high_s16(d0, mu), 7));
+
+  sx = vmull_low_s32(x0, h0);
+  sx = vmlal_high_s32(sx, x0, h0);
+  sx = vmlal_low_s32(sx, x4, h4);
+  sx = vmlal_high_s32(sx, x4, h4);
+
+  for (int i = 8; i < 32; i += 8) {
+    int16x8_t d8 = vld1q_s16(d + i);
+    int32x4_t h8 = vld1q_s32(h + i), h12 = vld1q_s32(h + i + 4);
+    int32x4_t x8 = vld1q_s32(x + i), x12 = vld1q_s32(x + i + 4);
+
+    h8 = vaddq_s32(h8, vrshrq_n_s32(vmull_low_s16(d8, mu), 7));
+    h12 = vaddq_s32(h12, vrshrq_n_s32(vmull_high_s16(d8, mu), 7));
+
+    sx = vmlal_low_s32(sx, x8, h8);
+    sx = vmlal_high_s32(sx, x8, h8);
+    sx = vmlal_low_s32(sx, x12, h12);
+    sx = vmlal_high_s32(sx, x12, h12);
+  }
+
+  return vaddvq_s64(sx);
+}
+
+//
+// x86 SSE4.1 and AVX2 Resampler Filtering
+//
+// SSE4.1 is part of the x86_64 Android ABI, but not of the Linux hosts
+// baseline: the kernels are compiled for their target, and selected
+// according to the features of the CPU. The products of 32 bits are
+// accumulated on 64 bits, two by two, with `pmuldq`.
+//
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse4.1"))) static int64_t FilterSse41(
+    const int32_t* x, const int32_t* h, int16_t _mu, const int16_t* d) {
+  const __m128i mu = _mm_set1_epi32(_mu);
+  const __m128i round = _mm_set1_epi32(1 << 6);
+
+  __m128i sx = _mm_setzero_si128();
+
+  for (int i = 0; i < 32; i += 4) {
+    __m128i d4 = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(d + i)));
+    __m128i h4 = _mm_loadu_si128((const __m128i*)(h + i));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(x + i));
+
+    h4 = _mm_add_epi32(
+        h4, _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(d4, mu), round), 7));
+
+    sx = _mm_add_epi64(sx, _mm_mul_epi32(x4, h4));
+    sx = _mm_add_epi64(sx, _mm_mul_epi32(_mm_srli_epi64(x4, 32),
+                                         _mm_srli_epi64(h4, 32)));
+  }
+
+  int64_t sum[2];
+  _mm_storeu_si128((__m128i*)sum, sx);
+
+  return sum[0] + sum[1];
+}
+
+__attribute__((target("avx2"))) static int64_t FilterAvx2(
+    const int32_t* x, const int32_t* h, int16_t _mu, const int16_t* d) {
+  const __m256i mu = _mm256_set1_epi32(_mu);
+  const __m256i round = _mm256_set1_epi32(1 << 6);
+
+  __m256i sx = _mm256_setzero_si256();
+
+  for (int i = 0; i < 32; i += 8) {
+    __m256i d8 =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(d + i)));
+    __m256i h8 = _mm256_loadu_si256((const __m256i*)(h + i));
+    __m256i x8 = _mm256_loadu_si256((const __m256i*)(x + i));
+
+    h8 = _mm256_add_epi32(
+        h8, _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_mullo_epi32(d8, mu), round), 7));
+
+    sx = _mm256_add_epi64(sx, _mm256_mul_epi32(x8, h8));
+    sx = _mm256_add_epi64(sx, _mm256_mul_epi32(_mm256_srli_epi64(x8, 32),
+                                               _mm256_srli_epi64(h8, 32)));
+  }
+
+  __m128i s2 = _mm_add_epi64(_mm256_castsi256_si128(sx),
+                             _mm256_extracti128_si256(sx, 1));
+
+  int64_t sum[2];
+  _mm_storeu_si128((__m128i*)sum, s2);
+
+  return sum[0] + sum[1];
+}
+
+#endif
+
+bool Resampler::IsKernelSupported(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::kAuto:
+    case Kernel::kGeneric:
+      return true;
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+    case Kernel::kNeon:
+      return true;
+#elif defined(__x86_64__) || defined(__i386__)
+    case Kernel::kSse41:
+      return __builtin_cpu_supports("sse4.1");
+    case Kernel::kAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+Resampler::KernelFn Resampler::SelectKernel(Kernel kernel) {
+  if (!IsKernelSupported(kernel)) kernel = Kernel::kAuto;
+
+  if (kernel == Kernel::kAuto) {
+    for (auto k : {Kernel::kAvx2, Kernel::kSse41, Kernel::kNeon})
+      if (IsKernelSupported(k)) return SelectKernel(k);
+    kernel = Kernel::kGeneric;
+  }
+
+  switch (kernel) {
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+    case Kernel::kNeon:
+      return FilterNeon;
+#elif defined(__x86_64__) || defined(__i386__)
+    case Kernel::kSse41:
+      return FilterSse41;
+    case Kernel::kAvx2:
+      return FilterAvx2;
+#endif
+    default:
+      return FilterGeneric;
+  }
+}
+
+Resampler::Resampler(int bit_depth, Kernel kernel)
+    : h_(resampler_tables.h),
+      d_(resampler_tables.d),
+      win_{{0}, {0}},
+      out_pos_(0),
+      in_pos_(0),
+      pcm_min_(-(int32_t(1) << (bit_depth - 1))),
+      pcm_max_((int32_t(1) << (bit_depth - 1)) - 1),
+      kernel_(SelectKernel(kernel)) {}
+
+inline int32_t Resampler::Filter(const int32_t* in, const int32_t* h,
+                                 int16_t mu, const int16_t* d) {
+  int64_t s = (kernel_(in, h, mu, d) + (1 << 30)) >> 31;
+  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+}
+
+template <typename T>
+__attribute__((no_sanitize("integer"))) void Resampler::Upsample(
+    unsigned ratio, const T* in, int in_stride, size_t in_len,
+    size_t* in_count, T* out, int out_stride, size_t out_len,
+    size_t* out_count) {
+  int nin = in_len, nout = out_len;
+
+  while (nin > 0 && nout > 0) {
+    unsigned idx = (in_pos_ >> 26);
+    unsigned phy = (in_pos_ >> 17) & 0x1ff;
+    int16_t mu = (in_pos_ >> 2) & 0x7fff;
+
+    unsigned wbuf = idx < WSIZE / 2 || idx >= WSIZE + WSIZE / 2;
+    auto w = win_[wbuf] + ((idx + wbuf * WSIZE / 2) % WSIZE) - WSIZE / 2;
+
+    *out = Filter(w, h_[phy], mu, d_[phy]);
+    out += out_stride;
+    nout--;
+    in_pos_ += ratio;
+
+    if (in_pos_ - (out_pos_ << 26) >= (1u << 26)) {
+      win_[0][(out_pos_ + WSIZE / 2) % WSIZE] = win_[1][(out_pos_)] = *in;
+
+      in += in_stride;
+      nin--;
+      out_pos_ = (out_pos_ + 1) % WSIZE;
+    }
+  }
+
+  *in_count = in_len - nin;
+  *out_count = out_len - nout;
+}
+
+template <typename T>
+__attribute__((no_sanitize("integer"))) void Resampler::Downsample(
+    unsigned ratio, const T* in, int in_stride, size_t in_len,
+    size_t* in_count, T* out, int out_stride, size_t out_len,
+    size_t* out_count) {
+  size_t nin = in_len, nout = out_len;
+
+  while (nin > 0 && nout > 0) {
+    if (in_pos_ - (out_pos_ << 26) < (1u << 26)) {
+      unsigned idx = (in_pos_ >> 26);
+      unsigned phy = (in_pos_ >> 17) & 0x1ff;
+      int16_t mu = (in_pos_ >> 2) & 0x7fff;
+
+      unsigned wbuf = idx < WSIZE / 2 || idx >= WSIZE + WSIZE / 2;
+      auto w = win_[wbuf] + ((idx + wbuf * WSIZE / 2) % WSIZE) - WSIZE / 2;
+
+      *out = Filter(w, h_[phy], mu, d_[phy]);
+      out += out_stride;
+      nout--;
+      in_pos_ += ratio;
+    }
+
+    win_[0][(out_pos_ + WSIZE / 2) % WSIZE] = win_[1][(out_pos_)] = *in;
+
+    in += in_stride;
+    nin--;
+    out_pos_ = (out_pos_ + 1) % WSIZE;
+  }
+
+  *in_count = in_len - nin;
+  *out_count = out_len - nout;
+}
+
+template <typename T>
+void Resampler::Resample(unsigned ratio_q26, const T* in, int in_stride,
+                         size_t in_len, size_t* in_count, T* out,
+                         int out_stride, size_t out_len, size_t* out_count,
+                         unsigned* in_sub_q26) {
+  auto fn = ratio_q26 < (1u << 26) ? &Resampler::Upsample<T>
+                                   : &Resampler::Downsample<T>;
+
+  (this->*fn)(ratio_q26, in, in_stride, in_len, in_count, out, out_stride,
+              out_len, out_count);
+
+  *in_sub_q26 = in_pos_ & ((1u << 26) - 1);
+}
+
+template void Resampler::Resample<int16_t>(unsigned, const int16_t*, int,
+                                           size_t, size_t*, int16_t*, int,
+                                           size_t, size_t*, unsigned*);
+template void Resampler::Resample<int32_t>(unsigned, const int32_t*, int,
+                                           size_t, size_t*, int32_t*, int,
+                                           size_t, size_t*, unsigned*);
+
+}  // namespace bluetooth::audio::asrc
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "asrc_tables.h"
+
+namespace bluetooth::audio::asrc {
+
+// Polyphase resampler of a single PCM channel, used by the LE Audio
+// asynchronous sample rate conversion and the A2DP SBC feeding.
+//
+// The interpolation kernel is a windowed sinc of 32 taps, sampled on 512
+// phases. The coefficients between two phases are linearly interpolated.
+// The cut-off of the kernel is at the Nyquist frequency of the input stream,
+// conversions are best when down-sampling by a small ratio or up-sampling.
+
+class Resampler {
+ public:
+  // Implementations of the filtering. `kAuto` selects at run time the fastest
+  // one supported by the CPU, the others are given to compare them.
+
+  enum class Kernel { kAuto, kGeneric, kNeon, kSse41, kAvx2 };
+
+  static bool IsKernelSupported(Kernel kernel);
+
+  // The output samples are clipped to `bit_depth` bits. An unsupported
+  // `kernel` falls back to `kAuto`.
+
+  Resampler(int bit_depth, Kernel kernel = Kernel::kAuto);
+
+  // Resample from `in` buffer to `out` buffer, until the end of any of
+  // the two buffers. `in_count` returns the number of consumed samples,
+  // and `out_count` the number produced. `in_sub` returns the phase in
+  // the input stream, in Q26 format.
+  //
+  // The ratio between the input and output sample rates is given in Q26
+  // format, and can change from one call to the other.
+
+  template <typename T>
+  void Resample(unsigned ratio_q26, const T* in, int in_stride, size_t in_len,
+                size_t* in_count, T* out, int out_stride, size_t out_len,
+                size_t* out_count, unsigned* in_sub_q26);
+
+ private:
+  static const int KERNEL_Q = ResamplerTables::KERNEL_Q;
+  static const int KERNEL_A = ResamplerTables::KERNEL_A;
+
+  const int32_t (*h_)[2 * KERNEL_A];
+  const int16_t (*d_)[2 * KERNEL_A];
+
+  static const unsigned WSIZE = 64;
+
+  int32_t win_[2][WSIZE];
+  unsigned out_pos_, in_pos_;
+  int32_t pcm_min_, pcm_max_;
+
+  // Return the sum of the products of the `2 * KERNEL_A` input samples with
+  // the transfer coefficients, in Q31 format.
+
+  using KernelFn = int64_t (*)(const int32_t* in, const int32_t* h, int16_t mu,
+                               const int16_t* d);
+  KernelFn kernel_;
+
+  static KernelFn SelectKernel(Kernel kernel);
+
+  // Apply the transfer coefficients `h`, corrected by linear interpolation,
+  // given fraction position `mu` weigthed by `d` values.
+
+  inline int32_t Filter(const int32_t* in, const int32_t* h, int16_t mu,
+                        const int16_t* d);
+
+  // Upsampling loop, the ratio is less than 1.0 in Q26 format,
+  // more output samples are produced compared to input.
+
+  template <typename T>
+  void Upsample(unsigned ratio, const T* in, int in_stride, size_t in_len,
+                size_t* in_count, T* out, int out_stride, size_t out_len,
+                size_t* out_count);
+
+  // Downsample loop, the ratio is greater than 1.0 in Q26 format,
+  // less output samples are produced compared to input.
+
+  template <typename T>
+  void Downsample(unsigned ratio, const T* in, int in_stride, size_t in_len,
+                  size_t* in_count, T* out, int out_stride, size_t out_len,
+                  size_t* out_count);
+};
+
+}  // namespace bluetooth::audio::asrc
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "asrc_resampler.h"
+
+using ::benchmark::State;
+using bluetooth::audio::asrc::Resampler;
+
+// One second of a stereo 16 bits tone, resampled from the rate of the first
+// argument to the rate of the second, with the filtering kernel of the third.
+// The throughput is given in output frames, the quality of the conversion in
+// the `snr_db` counter.
+static void BM_ResampleStereo16(State& state) {
+  const int in_rate = state.range(0);
+  const int out_rate = state.range(1);
+  const auto kernel = static_cast<Resampler::Kernel>(state.range(2));
+  if (!Resampler::IsKernelSupported(kernel)) {
+    state.SkipWithError("Kernel not supported by the CPU");
+    return;
+  }
+
+  const double w_in = 2 * M_PI * 1000 / in_rate;
+  const double w_out = 2 * M_PI * 1000 / out_rate;
+
+  std::vector<int16_t> in(2 * in_rate);
+  for (int i = 0; i < in_rate; i++) {
+    in[2 * i] = in[2 * i + 1] = round(16384 * sin(w_in * i));
+  }
+  std::vector<int16_t> out(2 * (out_rate + 1));
+  unsigned ratio_q26 = round(ldexp(double(in_rate) / out_rate, 26));
+  size_t in_count, out_count = 0;
+  unsigned in_sub_q26;
+
+  for (auto _ : state) {
+    Resampler resamplers[2] = {Resampler(16, kernel), Resampler(16, kernel)};
+    for (int ch = 0; ch < 2; ch++) {
+      resamplers[ch].Resample<int16_t>(ratio_q26, in.data() + ch, 2, in_rate,
+                                       &in_count, out.data() + ch, 2,
+                                       out_rate + 1, &out_count, &in_sub_q26);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * out_count);
+
+  // Fit the tone on the left channel, after the transient of the filter
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+  const size_t start = 64 * out_rate / in_rate + 1;
+  for (size_t i = start; i < out_count; i++) {
+    double s = sin(w_out * i), c = cos(w_out * i);
+    ss += s * s, sc += s * c, cc += c * c;
+    ys += out[2 * i] * s, yc += out[2 * i] * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+  double signal = 0, noise = 0;
+  for (size_t i = start; i < out_count; i++) {
+    double fit = a * sin(w_out * i) + b * cos(w_out * i);
+    signal += fit * fit;
+    noise += (out[2 * i] - fit) * (out[2 * i] - fit);
+  }
+  state.counters["snr_db"] = 10 * log10(signal / noise);
+}
+
+BENCHMARK(BM_ResampleStereo16)
+    ->ArgNames({"in_rate", "out_rate", "kernel"})
+    ->ArgsProduct({{44100}, {48000}, {1, 2, 3, 4}})
+    ->ArgsProduct({{48000}, {44100}, {1, 2, 3, 4}})
+    ->ArgsProduct({{16000}, {48000}, {1, 2, 3, 4}})
+    ->ArgsProduct({{32000}, {44100}, {1, 2, 3, 4}});
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "asrc_resampler.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace bluetooth::audio::asrc {
+
+namespace {
+
+// Signal to noise ratio of a tone of frequency `f` after resampling from
+// `in_rate` to `out_rate`. The tone is fitted on the output, after the
+// transient of the filter (the window of 64 input samples), the residual is
+// the noise and distortion.
+template <typename T>
+double ResampledToneSnr(int bit_depth, int in_rate, int out_rate, double f) {
+  const double amplitude = ldexp(0.5, bit_depth - 1);
+  const double w_in = 2 * M_PI * f / in_rate;
+
+  std::vector<T> in(in_rate);
+  for (size_t i = 0; i < in.size(); i++) {
+    in[i] = round(amplitude * sin(w_in * i));
+  }
+
+  std::vector<T> out(out_rate);
+  size_t in_count, out_count;
+  unsigned in_sub_q26;
+  unsigned ratio_q26 = round(ldexp(double(in_rate) / out_rate, 26));
+
+  Resampler resampler(bit_depth);
+  resampler.Resample<T>(ratio_q26, in.data(), 1, in.size(), &in_count,
+                        out.data(), 1, out.size(), &out_count, &in_sub_q26);
+
+  const double w_out = 2 * M_PI * f / out_rate;
+  const size_t start = 64 * out_rate / in_rate + 1;
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+  for (size_t i = start; i < out_count; i++) {
+    double s = sin(w_out * i), c = cos(w_out * i);
+    ss += s * s, sc += s * c, cc += c * c;
+    ys += out[i] * s, yc += out[i] * c;
+  }
+
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+
+  double signal = 0, noise = 0;
+  for (size_t i = start; i < out_count; i++) {
+    double fit = a * sin(w_out * i) + b * cos(w_out * i);
+    signal += fit * fit;
+    noise += (out[i] - fit) * (out[i] - fit);
+  }
+
+  return 10 * log10(signal / noise);
+}
+
+// Resample a sweep from `in_rate` to `out_rate` with the given `kernel`
+template <typename T>
+std::vector<T> ResampledSweep(Resampler::Kernel kernel, int bit_depth,
+                              int in_rate, int out_rate) {
+  const double amplitude = ldexp(0.9, bit_depth - 1);
+
+  std::vector<T> in(in_rate / 10);
+  for (size_t i = 0; i < in.size(); i++) {
+    double t = double(i) / in_rate;
+    in[i] = round(amplitude * sin(2 * M_PI * (100 + 100000 * t) * t));
+  }
+
+  std::vector<T> out(out_rate / 10 + 1);
+  size_t in_count, out_count;
+  unsigned in_sub_q26;
+  unsigned ratio_q26 = round(ldexp(double(in_rate) / out_rate, 26));
+
+  Resampler resampler(bit_depth, kernel);
+  resampler.Resample<T>(ratio_q26, in.data(), 1, in.size(), &in_count,
+                        out.data(), 1, out.size(), &out_count, &in_sub_q26);
+
+  out.resize(out_count);
+  return out;
+}
+
+}  // namespace
+
+TEST(AsrcResamplerTest, kernels_are_bit_exact) {
+  for (auto kernel : {Resampler::Kernel::kNeon, Resampler::Kernel::kSse41,
+                      Resampler::Kernel::kAvx2}) {
+    if (!Resampler::IsKernelSupported(kernel)) continue;
+
+    for (auto [in_rate, out_rate] :
+         {std::pair{44100, 48000}, {48000, 44100}, {16000, 48000}}) {
+      EXPECT_EQ(ResampledSweep<int16_t>(kernel, 16, in_rate, out_rate),
+                ResampledSweep<int16_t>(Resampler::Kernel::kGeneric, 16,
+                                        in_rate, out_rate));
+      EXPECT_EQ(ResampledSweep<int32_t>(kernel, 24, in_rate, out_rate),
+                ResampledSweep<int32_t>(Resampler::Kernel::kGeneric, 24,
+                                        in_rate, out_rate));
+    }
+  }
+}
+
+TEST(AsrcResamplerTest, output_follows_the_ratio) {
+  std::vector<int16_t> in(44100);
+  std::vector<int16_t> out(2 * 48000);
+  size_t in_count, out_count;
+  unsigned in_sub_q26;
+
+  Resampler resampler(16);
+  resampler.Resample<int16_t>(round(ldexp(44100. / 48000, 26)), in.data(), 1,
+                              in.size(), &in_count, out.data(), 1, out.size(),
+                              &out_count, &in_sub_q26);
+
+  EXPECT_EQ(in_count, in.size());
+  EXPECT_NEAR(out_count, 48000, 1);
+}
+
+TEST(AsrcResamplerTest, stops_on_full_output) {
+  std::vector<int16_t> in(480);
+  std::vector<int16_t> out(441);
+  size_t in_count, out_count;
+  unsigned in_sub_q26;
+
+  Resampler resampler(16);
+  resampler.Resample<int16_t>(round(ldexp(48000. / 44100, 26)), in.data(), 1,
+                              in.size(), &in_count, out.data(), 1, out.size(),
+                              &out_count, &in_sub_q26);
+
+  EXPECT_EQ(out_count, out.size());
+  EXPECT_NEAR(in_count, 480, 1);
+}
+
+TEST(AsrcResamplerTest, upsample_tone_16_bits) {
+  EXPECT_GT(ResampledToneSnr<int16_t>(16, 44100, 48000, 1000), 85);
+  EXPECT_GT(ResampledToneSnr<int16_t>(16, 16000, 48000, 1000), 85);
+  EXPECT_GT(ResampledToneSnr<int16_t>(16, 32000, 44100, 10000), 75);
+}
+
+TEST(AsrcResamplerTest, downsample_tone_16_bits) {
+  EXPECT_GT(ResampledToneSnr<int16_t>(16, 48000, 44100, 1000), 85);
+  EXPECT_GT(ResampledToneSnr<int16_t>(16, 48000, 44100, 10000), 75);
+}
+
+TEST(AsrcResamplerTest, resample_tone_24_bits) {
+  EXPECT_GT(ResampledToneSnr<int32_t>(24, 44100, 48000, 1000), 95);
+  EXPECT_GT(ResampledToneSnr<int32_t>(24, 48000, 44100, 1000), 95);
+}
+
+}  // namespace bluetooth::audio::asrc
@@ -127,6 +127,15 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return aidl::a2dp::read(p_buf, len);
 }
 
+// Number of bytes in the FMQ of BluetoothAudio HAL, ready to be read
+size_t available_to_read() {
+  if (HalVersionManager::GetHalTransport() ==
+      BluetoothAudioHalTransport::HIDL) {
+    return hidl::a2dp::available_to_read();
+  }
+  return aidl::a2dp::available_to_read();
+}
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report) {
   if (HalVersionManager::GetHalTransport() ==
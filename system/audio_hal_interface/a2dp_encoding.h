@@ -56,6 +56,10 @@ void ack_stream_suspended(const tA2DP_CTRL_ACK& status);
 // Read from the FMQ of BluetoothAudio HAL
 size_t read(uint8_t* p_buf, uint32_t len);
 
+// Number of bytes in the FMQ of BluetoothAudio HAL, ready to be read.
+// SIZE_MAX if the data path cannot tell.
+size_t available_to_read();
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report);
 
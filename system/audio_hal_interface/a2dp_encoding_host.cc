@@ -19,6 +19,7 @@
 #include <grp.h>
 #include <sys/stat.h>
 
+#include <cstdint>
 #include <memory>
 
 #include "a2dp_encoding.h"
@@ -278,6 +279,10 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return bytes_read;
 }
 
+// The audio server writes to a UIPC socket which does not tell how much data
+// it holds
+size_t available_to_read() { return SIZE_MAX; }
+
 // Check if OPUS codec is supported
 bool is_opus_supported() { return true; }
 
@@ -559,6 +559,12 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return active_hal_interface->ReadAudioData(p_buf, len);
 }
 
+// Number of bytes in the FMQ of BluetoothAudio HAL, ready to be read
+size_t available_to_read() {
+  if (!is_hal_enabled() || is_hal_offloading()) return 0;
+  return active_hal_interface->GetAudioDataAvailable();
+}
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report) {
   if (!is_hal_enabled()) {
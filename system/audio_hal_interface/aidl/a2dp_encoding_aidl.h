@@ -76,6 +76,11 @@ void ack_stream_suspended(const tA2DP_CTRL_ACK& status);
  ***/
 size_t read(uint8_t* p_buf, uint32_t len);
 
+/***
+ * Number of bytes in the FMQ of BluetoothAudio HAL, ready to be read
+ ***/
+size_t available_to_read();
+
 /***
  * Update A2DP delay report to BluetoothAudio HAL
  ***/
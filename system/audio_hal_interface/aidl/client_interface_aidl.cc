@@ -319,6 +319,12 @@ int BluetoothAudioClientInterface::StartSession() {
 
   if (data_mq && data_mq->isValid()) {
     data_mq_ = std::move(data_mq);
+    EventFlag* event_flag = nullptr;
+    if (data_mq_->getEventFlagWord() != nullptr &&
+        EventFlag::createEventFlag(data_mq_->getEventFlagWord(),
+                                   &event_flag) == ::android::OK) {
+      data_mq_event_flag_.reset(event_flag);
+    }
   } else if (transport_->GetSessionType() ==
                  SessionType::A2DP_HARDWARE_OFFLOAD_ENCODING_DATAPATH ||
              transport_->GetSessionType() ==
@@ -403,6 +409,7 @@ int BluetoothAudioClientInterface::EndSession() {
     LOG(ERROR) << __func__ << ": BluetoothAudioHal nullptr";
     return -EINVAL;
   }
+  data_mq_event_flag_ = nullptr;
   data_mq_ = nullptr;
 
   auto aidl_retval = provider_->endSession();
@@ -442,16 +449,29 @@ void BluetoothAudioClientInterface::FlushAudioData() {
 
 size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
                                                         uint32_t len) {
+  if (p_buf == nullptr) return 0;
+  return ConsumeAudioData(len, [&p_buf](const uint8_t* data, size_t size) {
+    memcpy(p_buf, data, size);
+    p_buf += size;
+  });
+}
+
+size_t BluetoothAudioSinkClientInterface::ConsumeAudioData(
+    uint32_t len, const AudioDataConsumer& consumer) {
   if (!IsValid()) {
     LOG(ERROR) << __func__ << ": BluetoothAudioHal is not valid";
     return 0;
   }
-  if (p_buf == nullptr || len == 0) return 0;
+  if (len == 0) return 0;
 
   std::lock_guard<std::mutex> guard(internal_mutex_);
 
   size_t total_read = 0;
-  int timeout_ms = kDefaultDataReadTimeoutMs;
+  const auto start = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::milliseconds(kDefaultDataReadTimeoutMs);
+  const auto poll_interval =
+      std::chrono::milliseconds(kDefaultDataReadPollIntervalMs);
+  auto elapsed = std::chrono::milliseconds(0);
   do {
     if (data_mq_ == nullptr || !data_mq_->isValid()) break;
 
@@ -460,30 +480,34 @@ size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
       if (avail_to_read > len - total_read) {
         avail_to_read = len - total_read;
       }
-      if (data_mq_->read((MqDataType*)p_buf + total_read, avail_to_read) == 0) {
+      DataMQ::MemTransaction tx;
+      if (!data_mq_->beginRead(avail_to_read, &tx)) {
         LOG(WARNING) << __func__ << ": len=" << len
                      << " total_read=" << total_read << " failed";
         break;
       }
+      for (const auto* region : {&tx.getFirstRegion(), &tx.getSecondRegion()}) {
+        if (region->getLength() == 0) continue;
+        consumer(reinterpret_cast<const uint8_t*>(region->getAddress()),
+                 region->getLength());
+      }
+      data_mq_->commitRead(avail_to_read);
       total_read += avail_to_read;
-    } else if (timeout_ms >= kDefaultDataReadPollIntervalMs) {
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(kDefaultDataReadPollIntervalMs));
-      timeout_ms -= kDefaultDataReadPollIntervalMs;
+    } else if (elapsed + poll_interval <= timeout) {
+      WaitForAudioData(poll_interval);
+      elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
       continue;
     } else {
       LOG(WARNING) << __func__ << ": " << (len - total_read) << "/" << len
-                   << " no data " << (kDefaultDataReadTimeoutMs - timeout_ms)
-                   << " ms";
+                   << " no data " << elapsed.count() << " ms";
       break;
     }
   } while (total_read < len);
 
-  if (timeout_ms <
-          (kDefaultDataReadTimeoutMs - kDefaultDataReadPollIntervalMs) &&
-      timeout_ms >= kDefaultDataReadPollIntervalMs) {
+  if (elapsed > poll_interval && elapsed + poll_interval <= timeout) {
     VLOG(1) << __func__ << ": underflow " << len << " -> " << total_read
-            << " read " << (kDefaultDataReadTimeoutMs - timeout_ms) << " ms";
+            << " read " << elapsed.count() << " ms";
   } else {
     VLOG(2) << __func__ << ": " << len << " -> " << total_read << " read";
   }
@@ -492,6 +516,27 @@ size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
   return total_read;
 }
 
+void BluetoothAudioSinkClientInterface::WaitForAudioData(
+    std::chrono::milliseconds timeout) {
+  if (data_mq_event_flag_ == nullptr) {
+    std::this_thread::sleep_for(timeout);
+    return;
+  }
+  uint32_t event_flag_state = 0;
+  data_mq_event_flag_->wait(
+      kDataMqNotEmpty, &event_flag_state,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count(),
+      /* retry */ true);
+}
+
+size_t BluetoothAudioSinkClientInterface::GetAudioDataAvailable() {
+  if (!IsValid()) return 0;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (data_mq_ == nullptr || !data_mq_->isValid()) return 0;
+  return data_mq_->availableToRead();
+}
+
 void BluetoothAudioClientInterface::RenewAudioProviderAndSession() {
   // NOTE: must be invoked on the same thread where this
   // BluetoothAudioClientInterface is running
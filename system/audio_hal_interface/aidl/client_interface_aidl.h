@@ -17,9 +17,12 @@
 #pragma once
 
 #include <fmq/AidlMessageQueue.h>
+#include <fmq/EventFlag.h>
 #include <hardware/audio.h>
 
+#include <chrono>
 #include <ctime>
+#include <functional>
 #include <mutex>
 #include <vector>
 
@@ -55,6 +58,7 @@ using ::aidl::android::hardware::bluetooth::audio::PcmConfiguration;
 using ::aidl::android::hardware::common::fmq::MQDescriptor;
 using ::aidl::android::hardware::common::fmq::SynchronizedReadWrite;
 using ::android::AidlMessageQueue;
+using ::android::hardware::EventFlag;
 
 using MqDataType = int8_t;
 using MqDataMode = SynchronizedReadWrite;
@@ -155,6 +159,15 @@ class BluetoothAudioClientInterface {
   bool session_started_;
   std::unique_ptr<DataMQ> data_mq_;
 
+  struct EventFlagDeleter {
+    void operator()(EventFlag* event_flag) const {
+      EventFlag::deleteEventFlag(&event_flag);
+    }
+  };
+  // Event flag of |data_mq_|, when the audio HAL configured one. Declared after
+  // |data_mq_| as it refers to the event flag word within the queue.
+  std::unique_ptr<EventFlag, EventFlagDeleter> data_mq_event_flag_;
+
   ::ndk::ScopedAIBinder_DeathRecipient death_recipient_;
   // static constexpr const char* kDefaultAudioProviderFactoryInterface =
   //     "android.hardware.bluetooth.audio.IBluetoothAudioProviderFactory/default";
@@ -193,11 +206,34 @@ class BluetoothAudioSinkClientInterface : public BluetoothAudioClientInterface {
    ***/
   size_t ReadAudioData(uint8_t* p_buf, uint32_t len);
 
+  /***
+   * Read up to |len| bytes from the fmq without copying them: |consumer| is
+   * called with the regions of the fmq holding the data, in order, then the
+   * regions are released to the audio HAL. A region may be shorter than an
+   * audio frame when the fmq wraps around. Returns the number of bytes read.
+   ***/
+  using AudioDataConsumer =
+      std::function<void(const uint8_t* data, size_t size)>;
+  size_t ConsumeAudioData(uint32_t len, const AudioDataConsumer& consumer);
+
+  /***
+   * Number of bytes written by the audio HAL to the fmq and not read yet
+   ***/
+  size_t GetAudioDataAvailable();
+
  private:
   IBluetoothSinkTransportInstance* sink_;
 
+  /***
+   * Wait for the audio HAL to write to the fmq, for at most |timeout|. Woken
+   * up right away by the blocking writes when the fmq has an event flag.
+   ***/
+  void WaitForAudioData(std::chrono::milliseconds timeout);
+
   static constexpr int kDefaultDataReadTimeoutMs = 10;
   static constexpr int kDefaultDataReadPollIntervalMs = 1;
+  // Bit set in the event flag of the fmq by its blocking writes (FMQ_NOT_EMPTY)
+  static constexpr uint32_t kDataMqNotEmpty = 1 << 0;
 };
 
 class BluetoothAudioSourceClientInterface
@@ -90,6 +90,14 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return aidl::hearing_aid::read(p_buf, len);
 }
 
+size_t available_to_read() {
+  if (HalVersionManager::GetHalTransport() ==
+      BluetoothAudioHalTransport::HIDL) {
+    return hidl::hearing_aid::available_to_read();
+  }
+  return aidl::hearing_aid::available_to_read();
+}
+
 }  // namespace hearing_aid
 }  // namespace audio
 }  // namespace bluetooth
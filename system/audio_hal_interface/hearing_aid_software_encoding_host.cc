@@ -35,6 +35,8 @@ void end_session() {}
 
 size_t read(uint8_t* p_buf, uint32_t len) { return 0; }
 
+size_t available_to_read() { return 0; }
+
 void set_remote_delay(uint16_t delay_report_ms) {}
 
 }  // namespace hearing_aid
@@ -812,6 +812,14 @@ size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
   return total_read;
 }
 
+size_t BluetoothAudioSinkClientInterface::GetAudioDataAvailable() {
+  if (!IsValid()) return 0;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (mDataMQ == nullptr || !mDataMQ->isValid()) return 0;
+  return mDataMQ->availableToRead();
+}
+
 void BluetoothAudioClientInterface::RenewAudioProviderAndSession() {
   // NOTE: must be invoked on the same thread where this
   // BluetoothAudioClientInterface is running
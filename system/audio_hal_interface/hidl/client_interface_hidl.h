@@ -265,6 +265,9 @@ class BluetoothAudioSinkClientInterface : public BluetoothAudioClientInterface {
   // Read data from audio  HAL through fmq
   size_t ReadAudioData(uint8_t* p_buf, uint32_t len);
 
+  // Number of bytes written by the audio HAL to the fmq and not read yet
+  size_t GetAudioDataAvailable();
+
  private:
   IBluetoothSinkTransportInstance* sink_;
 };
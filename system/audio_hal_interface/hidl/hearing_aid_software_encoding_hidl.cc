@@ -242,6 +242,11 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return hearing_aid_hal_clientinterface->ReadAudioData(p_buf, len);
 }
 
+size_t available_to_read() {
+  if (!is_hal_2_0_enabled()) return 0;
+  return hearing_aid_hal_clientinterface->GetAudioDataAvailable();
+}
+
 // Update Hearing Aids delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report_ms) {
   if (!is_hal_2_0_enabled()) {
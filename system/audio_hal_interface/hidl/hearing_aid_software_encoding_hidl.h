@@ -47,6 +47,9 @@ void set_remote_delay(uint16_t delay_report_ms);
 // Read from the FMQ of BluetoothAudio HAL
 size_t read(uint8_t* p_buf, uint32_t len);
 
+// Number of bytes in the FMQ of BluetoothAudio HAL, ready to be read
+size_t available_to_read();
+
 }  // namespace hearing_aid
 }  // namespace hidl
 }  // namespace audio
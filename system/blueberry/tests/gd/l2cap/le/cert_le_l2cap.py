@@ -164,6 +164,9 @@ class CertLeL2cap(Closable):
         self.control_channel.send(response)
         return (our_scid, our_dcid)
 
+    def get_acl_handle(self):
+        return self._le_acl.handle
+
     def get_control_channel(self):
         return self.control_channel
 
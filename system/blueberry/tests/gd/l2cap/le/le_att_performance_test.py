@@ -0,0 +1,269 @@
+#
+#   Copyright 2023 - The Android Open Source Project
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+
+import json
+import os
+from datetime import datetime, timedelta
+
+from bluetooth_packets_python3 import RawBuilder
+from blueberry.tests.gd.cert.matchers import L2capMatchers
+from blueberry.tests.gd.cert.performance_test_logger import PerformanceTestLogger
+from blueberry.tests.gd.cert.py_l2cap import PyLeL2cap
+from blueberry.tests.gd.cert.truth import assertThat
+from blueberry.tests.gd.cert import gd_base_test
+from blueberry.tests.gd.l2cap.le.cert_le_l2cap import CertLeL2cap
+from blueberry.facade import common_pb2 as common
+from blueberry.facade.hci import le_advertising_manager_facade_pb2 as le_advertising_facade
+from blueberry.facade.hci import le_initiator_address_facade_pb2 as le_initiator_address_facade
+from mobly import test_runner
+import hci_packets as hci
+
+ATT_CID = 4
+ATT_DEFAULT_MTU = 23
+ATT_HEADER_SIZE = 3
+
+ATT_EXCHANGE_MTU_REQUEST = 0x02
+ATT_EXCHANGE_MTU_RESPONSE = 0x03
+ATT_READ_REQUEST = 0x0A
+ATT_READ_RESPONSE = 0x0B
+ATT_HANDLE_VALUE_NOTIFICATION = 0x1B
+ATT_WRITE_COMMAND = 0x52
+
+SAMPLE_HANDLE = 0x002A
+
+RESULTS_FILE_NAME = 'le_att_performance_results.json'
+
+
+def att_pdu(opcode, parameter, value=b''):
+    return bytes([opcode, parameter & 0xff, parameter >> 8]) + value
+
+
+def percentile(samples, fraction):
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+class LeAttPerformanceTest(gd_base_test.GdBaseTestClass):
+    """
+    Measures the ATT traffic patterns of GATT clients and servers between two stacks over the simulated controller.
+
+    The GD stack has no GATT module, so the ATT PDUs are built by the test and carried on the ATT fixed channel, with
+    the DUT running the L2CAP LE module and the cert sending raw L2CAP frames. Each test writes its results to
+    le_att_performance_results.json in its output directory, so that runs of different stack versions can be compared.
+    """
+
+    def setup_class(self):
+        gd_base_test.GdBaseTestClass.setup_class(self, dut_module='L2CAP', cert_module='HCI_INTERFACES')
+
+    def setup_test(self):
+        gd_base_test.GdBaseTestClass.setup_test(self)
+        self.performance_test_logger = PerformanceTestLogger()
+        self.results = []
+
+        self.dut_l2cap = PyLeL2cap(self.dut)
+        self.cert_l2cap = CertLeL2cap(self.cert)
+        self.dut_address = common.BluetoothAddressWithType(
+            address=common.BluetoothAddress(address=bytes(b'D0:05:04:03:02:01')), type=common.RANDOM_DEVICE_ADDRESS)
+        self.cert_address = common.BluetoothAddressWithType(
+            address=common.BluetoothAddress(address=bytes(b'C0:11:FF:AA:33:22')), type=common.RANDOM_DEVICE_ADDRESS)
+        for (device, address) in ((self.dut, self.dut_address), (self.cert, self.cert_address)):
+            privacy_policy = le_initiator_address_facade.PrivacyPolicy(
+                address_policy=le_initiator_address_facade.AddressPolicy.USE_STATIC_ADDRESS,
+                address_with_type=address,
+                rotation_irk=b'\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00',
+                minimum_rotation_time=0,
+                maximum_rotation_time=0)
+            device.hci_le_initiator_address.SetPrivacyPolicyForInitiatorAddress(privacy_policy)
+
+    def teardown_test(self):
+        with open(os.path.join(self.log_path_base, RESULTS_FILE_NAME), 'w') as results_file:
+            json.dump({'test': self.current_test_info.name, 'results': self.results}, results_file, indent=2)
+        self.cert_l2cap.close()
+        self.dut_l2cap.close()
+        gd_base_test.GdBaseTestClass.teardown_test(self)
+
+    def _record(self, metric, **values):
+        result = dict(metric=metric, **values)
+        self.log.info("%s" % json.dumps(result))
+        self.results.append(result)
+
+    def _setup_link_from_cert(self):
+        """
+        Connect the cert to the advertising DUT, and return the ATT channels of both sides
+        """
+        self.dut_l2cap.enable_fixed_channel(ATT_CID)
+        gap_name = hci.GapData(data_type=hci.GapDataType.COMPLETE_LOCAL_NAME, data=list(bytes(b'Im_The_DUT')))
+        gap_data = le_advertising_facade.GapDataMsg(data=gap_name.serialize())
+        config = le_advertising_facade.AdvertisingConfig(
+            advertisement=[gap_data],
+            interval_min=512,
+            interval_max=768,
+            advertising_type=le_advertising_facade.AdvertisingEventType.ADV_IND,
+            own_address_type=common.USE_RANDOM_DEVICE_ADDRESS,
+            channel_map=7,
+            filter_policy=le_advertising_facade.AdvertisingFilterPolicy.ALL_DEVICES)
+        request = le_advertising_facade.CreateAdvertiserRequest(config=config)
+        self.dut.hci_le_advertising_manager.CreateAdvertiser(request)
+        self.cert_l2cap.connect_le_acl(self.dut_address)
+
+        dut_channel = self.dut_l2cap.get_fixed_channel(ATT_CID)
+        cert_channel = self.cert_l2cap.open_fixed_channel(ATT_CID)
+        return (dut_channel, cert_channel)
+
+    def _set_data_length(self, tx_octets):
+        """
+        Ask the cert controller to use LE Data Packet Length Extension, with the time of an LE 1M PDU
+        """
+        tx_time = (tx_octets + 14) * 8
+        command = hci.LeSetDataLength(
+            connection_handle=self.cert_l2cap.get_acl_handle(), tx_octets=tx_octets, tx_time=tx_time)
+        self.cert.hci.SendCommand(common.Data(payload=command.serialize()))
+
+    def _exchange_mtu(self, dut_channel, cert_channel, mtu):
+        """
+        Exchange the ATT MTU from the cert, the DUT answers with the same MTU
+        """
+        cert_channel.send(RawBuilder(list(att_pdu(ATT_EXCHANGE_MTU_REQUEST, mtu))))
+        assertThat(dut_channel).emits(L2capMatchers.PacketPayloadRawData(att_pdu(ATT_EXCHANGE_MTU_REQUEST, mtu)))
+        dut_channel.send(att_pdu(ATT_EXCHANGE_MTU_RESPONSE, mtu))
+        assertThat(cert_channel).emits(L2capMatchers.Data(att_pdu(ATT_EXCHANGE_MTU_RESPONSE, mtu)))
+
+    def _link(self, att_mtu=ATT_DEFAULT_MTU, tx_octets=None):
+        (dut_channel, cert_channel) = self._setup_link_from_cert()
+        if att_mtu != ATT_DEFAULT_MTU:
+            self._exchange_mtu(dut_channel, cert_channel, att_mtu)
+        if tx_octets is not None:
+            self._set_data_length(tx_octets)
+        return (dut_channel, cert_channel)
+
+    def _notification_throughput(self, packets, att_mtu=ATT_DEFAULT_MTU, tx_octets=None):
+        """
+        Send notifications of the largest value the ATT MTU allows from the cert, and record the rate the DUT
+        receives them at
+        """
+        (dut_channel, cert_channel) = self._link(att_mtu, tx_octets)
+        value = b'n' * (att_mtu - ATT_HEADER_SIZE)
+        notification = att_pdu(ATT_HANDLE_VALUE_NOTIFICATION, SAMPLE_HANDLE, value)
+
+        self.performance_test_logger.start_interval("NOTIFY")
+        for _ in range(packets):
+            cert_channel.send(RawBuilder(list(notification)))
+        assertThat(dut_channel).emits(
+            L2capMatchers.PacketPayloadRawData(notification), at_least_times=packets, timeout=timedelta(seconds=60))
+        self.performance_test_logger.end_interval("NOTIFY")
+
+        duration = self.performance_test_logger.get_duration_of_intervals("NOTIFY")[0]
+        self._record(
+            'notification_throughput',
+            att_mtu=att_mtu,
+            tx_octets=tx_octets,
+            packets=packets,
+            duration_ms=duration / timedelta(milliseconds=1),
+            packets_per_second=packets / duration.total_seconds(),
+            value_bytes_per_second=packets * len(value) / duration.total_seconds())
+        return duration
+
+    def _write_without_response_rate(self, att_mtu=ATT_DEFAULT_MTU, tx_octets=None, interval=timedelta(seconds=10),
+                                     batch_size=20):
+        """
+        Send write commands from the DUT for a fixed interval, and record how many of them the cert received
+        """
+        (dut_channel, cert_channel) = self._link(att_mtu, tx_octets)
+        value = b'w' * (att_mtu - ATT_HEADER_SIZE)
+        write_command = att_pdu(ATT_WRITE_COMMAND, SAMPLE_HANDLE, value)
+
+        start_time = datetime.now()
+        end_time = start_time + interval
+        packets_sent = 0
+        while datetime.now() < end_time:
+            for _ in range(batch_size):
+                dut_channel.send(write_command)
+            packets_sent += batch_size
+            assertThat(cert_channel).emits(L2capMatchers.Data(write_command), at_least_times=batch_size)
+        duration = datetime.now() - start_time
+
+        self._record(
+            'write_without_response_rate',
+            att_mtu=att_mtu,
+            tx_octets=tx_octets,
+            packets=packets_sent,
+            duration_ms=duration / timedelta(milliseconds=1),
+            packets_per_second=packets_sent / duration.total_seconds(),
+            value_bytes_per_second=packets_sent * len(value) / duration.total_seconds())
+        return packets_sent
+
+    def _read_latency(self, samples, att_mtu=ATT_DEFAULT_MTU):
+        """
+        Read a characteristic from the DUT, with the cert answering each Read Request, and record the distribution
+        of the round trips as seen by the DUT
+        """
+        (dut_channel, cert_channel) = self._link(att_mtu)
+        read_request = att_pdu(ATT_READ_REQUEST, SAMPLE_HANDLE)
+        read_response = bytes([ATT_READ_RESPONSE]) + b'r' * (att_mtu - 1)
+
+        for _ in range(samples):
+            self.performance_test_logger.start_interval("READ")
+            dut_channel.send(read_request)
+            assertThat(cert_channel).emits(L2capMatchers.Data(read_request))
+            cert_channel.send(RawBuilder(list(read_response)))
+            assertThat(dut_channel).emits(L2capMatchers.PacketPayloadRawData(read_response))
+            self.performance_test_logger.end_interval("READ")
+
+        latencies_ms = [
+            duration / timedelta(milliseconds=1)
+            for duration in self.performance_test_logger.get_duration_of_intervals("READ")
+        ]
+        self._record(
+            'read_latency',
+            att_mtu=att_mtu,
+            samples=samples,
+            min_ms=min(latencies_ms),
+            mean_ms=sum(latencies_ms) / len(latencies_ms),
+            p50_ms=percentile(latencies_ms, 0.5),
+            p90_ms=percentile(latencies_ms, 0.9),
+            p99_ms=percentile(latencies_ms, 0.99),
+            max_ms=max(latencies_ms),
+            latencies_ms=latencies_ms)
+        return latencies_ms
+
+    def test_notification_throughput_default_mtu(self):
+        self._notification_throughput(200)
+
+    def test_notification_throughput_mtu_247(self):
+        self._notification_throughput(200, att_mtu=247)
+
+    def test_notification_throughput_mtu_247_data_length_251(self):
+        self._notification_throughput(200, att_mtu=247, tx_octets=251)
+
+    def test_write_without_response_rate_default_mtu(self):
+        packets_sent = self._write_without_response_rate()
+        assertThat(packets_sent > 0).isTrue()
+
+    def test_write_without_response_rate_mtu_247(self):
+        packets_sent = self._write_without_response_rate(att_mtu=247)
+        assertThat(packets_sent > 0).isTrue()
+
+    def test_write_without_response_rate_mtu_247_data_length_251(self):
+        packets_sent = self._write_without_response_rate(att_mtu=247, tx_octets=251)
+        assertThat(packets_sent > 0).isTrue()
+
+    def test_read_latency_distribution(self):
+        latencies_ms = self._read_latency(100)
+        assertThat(len(latencies_ms)).isEqualTo(100)
+
+
+if __name__ == '__main__':
+    test_runner.main()
@@ -24,6 +24,7 @@
 #define LOG_TAG "bta_ag_at"
 
 #include <cstdint>
+#include <cstring>
 
 #include "bt_target.h"  // Must be first to define build configuration:
 
@@ -37,11 +38,108 @@
  *  Constants
  ****************************************************************************/
 
+/******************************************************************************
+ *
+ * Function         bta_ag_at_bucket
+ *
+ * Description      Get the bucket of the AT command index of a command, or of
+ *                  a received command line after the "AT". Letters are keyed
+ *                  by their five low bits, the same in upper and lower case.
+ *
+ *
+ * Returns          Index of the bucket
+ *
+ *****************************************************************************/
+static uint8_t bta_ag_at_bucket(const char* p_cmd) {
+  if (p_cmd[0] == '+') {
+    return BTA_AG_AT_NUM_BUCKETS / 2 + (p_cmd[1] & 0x1F);
+  }
+  return p_cmd[0] & 0x1F;
+}
+
+/******************************************************************************
+ *
+ * Function         bta_ag_at_build_index
+ *
+ * Description      Index the AT command table of the control block.
+ *
+ *
+ * Returns          void
+ *
+ *****************************************************************************/
+static void bta_ag_at_build_index(tBTA_AG_AT_CB* p_cb) {
+  tBTA_AG_AT_INDEX* p_index = &p_cb->index;
+  uint8_t last[BTA_AG_AT_NUM_BUCKETS];
+
+  memset(p_index->first, BTA_AG_AT_NO_CMD, sizeof(p_index->first));
+  memset(last, BTA_AG_AT_NO_CMD, sizeof(last));
+  p_index->num_cmds = 0;
+  p_index->is_valid = false;
+  if (p_cb->p_at_tbl == nullptr) return;
+
+  uint8_t idx;
+  for (idx = 0; p_cb->p_at_tbl[idx].p_cmd[0] != 0; idx++) {
+    const char* p_cmd = p_cb->p_at_tbl[idx].p_cmd;
+    /* A lone "+" would match the commands of all the "+" buckets */
+    if (idx == BTA_AG_AT_MAX_CMDS || (p_cmd[0] == '+' && p_cmd[1] == 0)) {
+      LOG_WARN("AT command table not indexed, looking commands up linearly");
+      return;
+    }
+
+    uint8_t bucket = bta_ag_at_bucket(p_cmd);
+    p_index->next[idx] = BTA_AG_AT_NO_CMD;
+    if (last[bucket] == BTA_AG_AT_NO_CMD) {
+      p_index->first[bucket] = idx;
+    } else {
+      p_index->next[last[bucket]] = idx;
+    }
+    last[bucket] = idx;
+  }
+  p_index->num_cmds = idx;
+  p_index->is_valid = true;
+}
+
+/******************************************************************************
+ *
+ * Function         bta_ag_at_find_cmd
+ *
+ * Description      Find the first command of the AT command table the
+ *                  received command line starts with.
+ *
+ *
+ * Returns          Index of the command in the table, index of the end of
+ *                  table marker if there is no match.
+ *
+ *****************************************************************************/
+static uint16_t bta_ag_at_find_cmd(tBTA_AG_AT_CB* p_cb) {
+  uint16_t idx;
+
+  if (!p_cb->index.is_valid) {
+    for (idx = 0; p_cb->p_at_tbl[idx].p_cmd[0] != 0; idx++) {
+      if (!utl_strucmp(p_cb->p_at_tbl[idx].p_cmd, p_cb->p_cmd_buf)) {
+        break;
+      }
+    }
+    return idx;
+  }
+
+  /* A command of another bucket can't be a prefix of the command line, so the
+   * first match of the bucket is the first match of the table */
+  for (idx = p_cb->index.first[bta_ag_at_bucket(p_cb->p_cmd_buf)];
+       idx != BTA_AG_AT_NO_CMD; idx = p_cb->index.next[idx]) {
+    if (!utl_strucmp(p_cb->p_at_tbl[idx].p_cmd, p_cb->p_cmd_buf)) {
+      return idx;
+    }
+  }
+  return p_cb->index.num_cmds;
+}
+
 /******************************************************************************
  *
  * Function         bta_ag_at_init
  *
- * Description      Initialize the AT command parser control block.
+ * Description      Initialize the AT command parser control block, and
+ *                  index its AT command table, that must be set.
  *
  *
  * Returns          void
@@ -50,6 +148,7 @@
 void bta_ag_at_init(tBTA_AG_AT_CB* p_cb) {
   p_cb->p_cmd_buf = nullptr;
   p_cb->cmd_pos = 0;
+  bta_ag_at_build_index(p_cb);
 }
 
 /******************************************************************************
@@ -86,12 +185,8 @@ void bta_ag_process_at(tBTA_AG_AT_CB* p_cb, char* p_end) {
   uint8_t arg_type;
   char* p_arg;
   int16_t int_arg = 0;
-  /* loop through at command table looking for match */
-  for (idx = 0; p_cb->p_at_tbl[idx].p_cmd[0] != 0; idx++) {
-    if (!utl_strucmp(p_cb->p_at_tbl[idx].p_cmd, p_cb->p_cmd_buf)) {
-      break;
-    }
-  }
+  /* look the command up in the at command table */
+  idx = bta_ag_at_find_cmd(p_cb);
 
   /* if there is a match; verify argument type */
   if (p_cb->p_at_tbl[idx].p_cmd[0] != 0) {
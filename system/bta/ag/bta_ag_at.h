@@ -43,6 +43,16 @@
 #define BTA_AG_AT_STR 0 /* string */
 #define BTA_AG_AT_INT 1 /* integer */
 
+/* Maximum number of commands of an AT command table that can be indexed */
+#define BTA_AG_AT_MAX_CMDS 64
+
+/* Number of buckets of the AT command index, half of them for the extended
+ * "+" commands */
+#define BTA_AG_AT_NUM_BUCKETS 64
+
+/* End of a bucket of the AT command index */
+#define BTA_AG_AT_NO_CMD 0xFF
+
 /*****************************************************************************
  *  Data types
  ****************************************************************************/
@@ -57,6 +67,17 @@ typedef struct {
   int16_t max;       /* maximum value for int arg */
 } tBTA_AG_AT_CMD;
 
+/* AT command table index: the commands are chained, in table order, in
+ * buckets keyed by their first character, or by the character following the
+ * '+' of the extended commands, so that a command is only compared with the
+ * few commands sharing its bucket */
+typedef struct {
+  uint8_t first[BTA_AG_AT_NUM_BUCKETS]; /* first command of each bucket */
+  uint8_t next[BTA_AG_AT_MAX_CMDS];     /* next command in the same bucket */
+  uint8_t num_cmds;                     /* number of commands in the table */
+  bool is_valid;                        /* false if the table is too large */
+} tBTA_AG_AT_INDEX;
+
 /* callback function executed when command is parsed */
 struct tBTA_AG_SCB;
 typedef void(tBTA_AG_AT_CMD_CBACK)(tBTA_AG_SCB* p_user, uint16_t command_id,
@@ -77,6 +98,7 @@ typedef struct {
   uint16_t cmd_pos;                  /* position in temp buffer */
   uint16_t cmd_max_len;              /* length of temp buffer to allocate */
   uint8_t state;                     /* parsing state */
+  tBTA_AG_AT_INDEX index;            /* index of the AT command table */
 } tBTA_AG_AT_CB;
 
 /*****************************************************************************
@@ -87,7 +109,8 @@ typedef struct {
  *
  * Function         bta_ag_at_init
  *
- * Description      Initialize the AT command parser control block.
+ * Description      Initialize the AT command parser control block, and
+ *                  index its AT command table, that must be set.
  *
  *
  * Returns          void
@@ -85,6 +85,15 @@ constexpr char kBtmLogTag[] = "A2DP";
 #define BTA_AV_RECONFIG_RETRY 6
 #endif
 
+/* system property to disable the cache of the remote SEPs */
+#define BTA_AV_SEP_CACHE_PROPERTY "persist.bluetooth.a2dp.sep_cache.enabled"
+
+/* layout of BTA_AV_SEP_CACHE_CONFIG_KEY: format, lmp_version, manufacturer,
+ * lmp_subversion, AVDTP version and number of SEPs, followed by the SEPs */
+#define BTA_AV_SEP_CACHE_FORMAT 1
+#define BTA_AV_SEP_CACHE_HDR_SIZE 9
+#define BTA_AV_SEP_CACHE_ENTRY_SIZE (7 + AVDT_CODEC_SIZE + AVDT_PROTECT_SIZE)
+
 /* ACL quota we are letting FW use for A2DP Offload Tx. */
 #define BTA_AV_A2DP_OFFLOAD_XMIT_QUOTA 4
 
@@ -291,6 +300,180 @@ void bta_av_st_rc_timer(tBTA_AV_SCB* p_scb, UNUSED_ATTR tBTA_AV_DATA* p_data) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_av_sep_cache_enabled
+ *
+ * Description      Check whether the remote SEPs of the peer may be read
+ *                  from, and written to, the SEP cache.
+ *
+ * Returns          true if the SEP cache is used for the peer.
+ *
+ ******************************************************************************/
+static bool bta_av_sep_cache_enabled(const RawAddress& peer_address) {
+  if (!osi_property_get_bool(BTA_AV_SEP_CACHE_PROPERTY, true)) {
+    return false;
+  }
+  if (interop_match_addr(INTEROP_DISABLE_AVDTP_SEP_CACHE, &peer_address)) {
+    LOG_INFO("%s: disable SEP cache: interop matched address %s", __func__,
+             ADDRESS_TO_LOGGABLE_CSTR(peer_address));
+    return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_av_sep_cache_save
+ *
+ * Description      Store the remote SEPs and capabilities found by stream
+ *                  discovery, along with the peer firmware and AVDTP
+ *                  versions they are valid for.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_av_sep_cache_save(tBTA_AV_SCB* p_scb) {
+  const RawAddress& peer_address = p_scb->PeerAddress();
+  uint8_t lmp_version = 0;
+  uint16_t manufacturer = 0;
+  uint16_t lmp_sub_version = 0;
+
+  if (p_scb->peer_caps_mask == 0 || !bta_av_sep_cache_enabled(peer_address)) {
+    return;
+  }
+  if (!BTM_ReadRemoteVersion(peer_address, &lmp_version, &manufacturer,
+                             &lmp_sub_version)) {
+    LOG_WARN("%s: peer %s remote version unknown, SEPs not cached", __func__,
+             ADDRESS_TO_LOGGABLE_CSTR(peer_address));
+    return;
+  }
+
+  std::vector<uint8_t> value(BTA_AV_SEP_CACHE_HDR_SIZE +
+                             BTA_AV_NUM_SEPS * BTA_AV_SEP_CACHE_ENTRY_SIZE);
+  uint8_t* p = value.data();
+  UINT8_TO_STREAM(p, BTA_AV_SEP_CACHE_FORMAT);
+  UINT8_TO_STREAM(p, lmp_version);
+  UINT16_TO_STREAM(p, manufacturer);
+  UINT16_TO_STREAM(p, lmp_sub_version);
+  UINT16_TO_STREAM(p, p_scb->AvdtpVersion());
+  uint8_t* p_num_seps = p;
+  UINT8_TO_STREAM(p, 0);
+
+  uint8_t num_seps = 0;
+  for (int i = 0; i < p_scb->num_seps; i++) {
+    if ((p_scb->peer_caps_mask & (1u << i)) == 0) continue;
+    const tAVDT_SEP_INFO& sep_info = p_scb->sep_info[i];
+    const AvdtpSepConfig& cap = p_scb->peer_caps[i];
+    UINT8_TO_STREAM(p, sep_info.seid);
+    UINT8_TO_STREAM(p, sep_info.media_type);
+    UINT8_TO_STREAM(p, sep_info.tsep);
+    UINT8_TO_STREAM(p, cap.num_codec);
+    ARRAY_TO_STREAM(p, cap.codec_info, AVDT_CODEC_SIZE);
+    UINT8_TO_STREAM(p, cap.num_protect);
+    ARRAY_TO_STREAM(p, cap.protect_info, AVDT_PROTECT_SIZE);
+    UINT16_TO_STREAM(p, cap.psc_mask);
+    num_seps++;
+  }
+  *p_num_seps = num_seps;
+  value.resize(p - value.data());
+
+  if (!btif_config_set_bin(peer_address.ToString(),
+                           BTA_AV_SEP_CACHE_CONFIG_KEY, value.data(),
+                           value.size())) {
+    LOG_WARN("%s: Failed to store SEPs of %s", __func__,
+             ADDRESS_TO_LOGGABLE_CSTR(peer_address));
+    return;
+  }
+  LOG_VERBOSE("%s: peer %s cached %d SEPs", __func__,
+              ADDRESS_TO_LOGGABLE_CSTR(peer_address), num_seps);
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_av_sep_cache_load
+ *
+ * Description      Restore the remote SEPs and capabilities of the peer into
+ *                  sep_info[] and peer_caps[], if they were cached for the
+ *                  current peer firmware and AVDTP versions.
+ *
+ * Returns          true if the cached SEPs were restored.
+ *
+ ******************************************************************************/
+static bool bta_av_sep_cache_load(tBTA_AV_SCB* p_scb) {
+  const RawAddress& peer_address = p_scb->PeerAddress();
+  std::string section = peer_address.ToString();
+  uint8_t lmp_version = 0;
+  uint16_t manufacturer = 0;
+  uint16_t lmp_sub_version = 0;
+
+  size_t length =
+      btif_config_get_bin_length(section, BTA_AV_SEP_CACHE_CONFIG_KEY);
+  if (length < BTA_AV_SEP_CACHE_HDR_SIZE ||
+      !bta_av_sep_cache_enabled(peer_address)) {
+    return false;
+  }
+  std::vector<uint8_t> value(length);
+  if (!btif_config_get_bin(section, BTA_AV_SEP_CACHE_CONFIG_KEY, value.data(),
+                           &length) ||
+      length < BTA_AV_SEP_CACHE_HDR_SIZE) {
+    return false;
+  }
+  if (!BTM_ReadRemoteVersion(peer_address, &lmp_version, &manufacturer,
+                             &lmp_sub_version)) {
+    return false;
+  }
+
+  const uint8_t* p = value.data();
+  uint8_t format, cached_lmp_version, num_seps;
+  uint16_t cached_manufacturer, cached_lmp_sub_version, avdtp_version;
+  STREAM_TO_UINT8(format, p);
+  STREAM_TO_UINT8(cached_lmp_version, p);
+  STREAM_TO_UINT16(cached_manufacturer, p);
+  STREAM_TO_UINT16(cached_lmp_sub_version, p);
+  STREAM_TO_UINT16(avdtp_version, p);
+  STREAM_TO_UINT8(num_seps, p);
+
+  if (format != BTA_AV_SEP_CACHE_FORMAT || num_seps == 0 ||
+      num_seps > BTA_AV_NUM_SEPS ||
+      length != BTA_AV_SEP_CACHE_HDR_SIZE +
+                    (size_t)num_seps * BTA_AV_SEP_CACHE_ENTRY_SIZE) {
+    LOG_WARN("%s: peer %s invalid SEP cache", __func__,
+             ADDRESS_TO_LOGGABLE_CSTR(peer_address));
+    btif_config_remove(section, BTA_AV_SEP_CACHE_CONFIG_KEY);
+    return false;
+  }
+  if (cached_lmp_version != lmp_version ||
+      cached_manufacturer != manufacturer ||
+      cached_lmp_sub_version != lmp_sub_version ||
+      avdtp_version != p_scb->AvdtpVersion()) {
+    LOG_INFO(
+        "%s: peer %s firmware or AVDTP version changed, SEP cache is stale",
+        __func__, ADDRESS_TO_LOGGABLE_CSTR(peer_address));
+    btif_config_remove(section, BTA_AV_SEP_CACHE_CONFIG_KEY);
+    return false;
+  }
+
+  for (int i = 0; i < num_seps; i++) {
+    tAVDT_SEP_INFO& sep_info = p_scb->sep_info[i];
+    AvdtpSepConfig& cap = p_scb->peer_caps[i];
+    cap.Reset();
+    sep_info.in_use = false;
+    STREAM_TO_UINT8(sep_info.seid, p);
+    STREAM_TO_UINT8(sep_info.media_type, p);
+    STREAM_TO_UINT8(sep_info.tsep, p);
+    STREAM_TO_UINT8(cap.num_codec, p);
+    STREAM_TO_ARRAY(cap.codec_info, p, AVDT_CODEC_SIZE);
+    STREAM_TO_UINT8(cap.num_protect, p);
+    STREAM_TO_ARRAY(cap.protect_info, p, AVDT_PROTECT_SIZE);
+    STREAM_TO_UINT16(cap.psc_mask, p);
+  }
+  p_scb->num_seps = num_seps;
+  p_scb->peer_caps_mask =
+      (num_seps == 32) ? UINT32_MAX : ((1u << num_seps) - 1);
+  return true;
+}
+
 /*******************************************************************************
  *
  * Function         bta_av_next_getcap
@@ -319,6 +502,14 @@ static bool bta_av_next_getcap(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
         (p_scb->sep_info[i].media_type == p_scb->media_type)) {
       p_scb->sep_info_idx = i;
 
+      if (p_scb->sep_cache_used && (p_scb->peer_caps_mask & (1u << i))) {
+        /* the capabilities are known from the SEP cache */
+        p_scb->peer_cap = p_scb->peer_caps[i];
+        sent_cmd = true;
+        bta_av_ssm_execute(p_scb, BTA_AV_STR_GETCAP_OK_EVT, p_data);
+        break;
+      }
+
       /* we got a stream; get its capabilities */
       bool get_all_cap = (p_scb->AvdtpVersion() >= AVDT_VERSION_1_3) &&
                          (A2DP_GetAvdtpVersion() >= AVDT_VERSION_1_3);
@@ -1222,6 +1413,11 @@ void bta_av_str_opened(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
     p_scb->suspend_sup = false;
   }
 
+  /* the stream was configured with the SEPs we discovered */
+  if ((p_scb->role & BTA_AV_ROLE_AD_ACP) == 0 && !p_scb->sep_cache_used) {
+    bta_av_sep_cache_save(p_scb);
+  }
+
   p_scb->stream_mtu =
       p_data->str_msg.msg.open_ind.peer_mtu - AVDT_MEDIA_HDR_SIZE;
   LOG_VERBOSE("%s: l2c_cid: 0x%x stream_mtu: %d", __func__, p_scb->l2c_cid,
@@ -1735,6 +1931,12 @@ void bta_av_getcap_results(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
   uint8_t media_type = A2DP_GetMediaType(p_scb->peer_cap.codec_info);
   tAVDT_SEP_INFO* p_info = &p_scb->sep_info[p_scb->sep_info_idx];
 
+  if (!p_scb->sep_cache_used && p_scb->sep_info_idx < BTA_AV_NUM_SEPS) {
+    /* keep the capabilities for the SEP cache */
+    p_scb->peer_caps[p_scb->sep_info_idx] = p_scb->peer_cap;
+    p_scb->peer_caps_mask |= 1u << p_scb->sep_info_idx;
+  }
+
   cfg.num_codec = 1;
   cfg.num_protect = p_scb->peer_cap.num_protect;
   memcpy(cfg.codec_info, p_scb->peer_cap.codec_info, AVDT_CODEC_SIZE);
@@ -1849,12 +2051,49 @@ void bta_av_setconfig_rej(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
  *
  ******************************************************************************/
 void bta_av_discover_req(tBTA_AV_SCB* p_scb, UNUSED_ATTR tBTA_AV_DATA* p_data) {
-  /* send avdtp discover request */
+  p_scb->peer_caps_mask = 0;
+  p_scb->sep_cache_used = false;
+
+  /* skip the stream discovery if the SEPs of the peer are cached */
+  if (bta_av_is_scb_opening(p_scb) && bta_av_sep_cache_load(p_scb)) {
+    LOG_INFO("%s: peer %s using %d cached SEPs", __func__,
+             ADDRESS_TO_LOGGABLE_CSTR(p_scb->PeerAddress()), p_scb->num_seps);
+    p_scb->sep_cache_used = true;
+
+    tBTA_AV_STR_MSG msg{};
+    msg.hdr.layer_specific = p_scb->hndl;
+    msg.bd_addr = p_scb->PeerAddress();
+    msg.scb_index = p_scb->hdi;
+    msg.avdt_event = AVDT_DISCOVER_CFM_EVT;
+    msg.msg.discover_cfm.p_sep_info = p_scb->sep_info;
+    msg.msg.discover_cfm.num_seps = p_scb->num_seps;
+    bta_av_ssm_execute(p_scb, BTA_AV_STR_DISC_OK_EVT, (tBTA_AV_DATA*)&msg);
+    return;
+  }
 
+  /* send avdtp discover request */
   AVDT_DiscoverReq(p_scb->PeerAddress(), p_scb->hdi, p_scb->sep_info,
                    BTA_AV_NUM_SEPS, &bta_av_proc_stream_evt);
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_av_sep_cache_failed
+ *
+ * Description      The stream could not be opened with the cached SEPs of the
+ *                  peer. Drop the SEP cache and run the stream discovery.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_av_sep_cache_failed(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
+  LOG_WARN("%s: peer %s cached SEPs rejected, discovering streams", __func__,
+           ADDRESS_TO_LOGGABLE_CSTR(p_scb->PeerAddress()));
+  btif_config_remove(p_scb->PeerAddress().ToString(),
+                     BTA_AV_SEP_CACHE_CONFIG_KEY);
+  bta_av_discover_req(p_scb, p_data);
+}
+
 /*******************************************************************************
  *
  * Function         bta_av_conn_failed
@@ -140,6 +140,9 @@ enum {
 /* maximum number of SEPS in stream discovery results */
 #define BTA_AV_NUM_SEPS 32
 
+/* storage key of the remote SEPs and capabilities found by stream discovery */
+#define BTA_AV_SEP_CACHE_CONFIG_KEY "A2dpSepCache"
+
 /* initialization value for AVRC handle */
 #define BTA_AV_RC_HANDLE_NONE 0xFF
 
@@ -564,6 +567,10 @@ struct tBTA_AV_SCB final {
   uint8_t q_tag; /* identify the associated q_info union member */
   bool no_rtp_header; /* true if add no RTP header */
   uint16_t uuid_int; /*intended UUID of Initiator to connect to */
+  AvdtpSepConfig peer_caps[BTA_AV_NUM_SEPS]; /* capabilities of sep_info[] */
+  uint32_t peer_caps_mask; /* bit i set if peer_caps[i] is valid */
+  bool sep_cache_used; /* true if sep_info[] and peer_caps[] were read from
+                          the SEP cache instead of stream discovery */
 
   /**
    * Called to setup the state when connected to a peer.
@@ -804,6 +811,7 @@ void bta_av_open_failed(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_getcap_results(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_setconfig_rej(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_discover_req(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
+void bta_av_sep_cache_failed(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_conn_failed(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_do_start(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
 void bta_av_str_stopped(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data);
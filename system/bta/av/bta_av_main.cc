@@ -377,6 +377,8 @@ void tBTA_AV_SCB::OnConnected(const RawAddress& peer_address) {
 void tBTA_AV_SCB::OnDisconnected() {
   peer_address_ = RawAddress::kEmpty;
   SetAvdtpVersion(0);
+  peer_caps_mask = 0;
+  sep_cache_used = false;
 }
 
 void tBTA_AV_SCB::SetAvdtpVersion(uint16_t avdtp_version) {
@@ -308,6 +308,7 @@ class CsisClientImpl : public CsisClient {
           CsisGroupLockStatus::FAILED_LOCKED_BY_OTHER) {
     /* Clear information about ongoing lock procedure */
     CsisLockCb cb = csis_group->GetLockCb();
+    csis_group->RecordLockProcedureResult(false);
     csis_group->SetTargetLockState(CsisLockState::CSIS_STATE_UNSET);
 
     int group_id = csis_group->GetGroupId();
@@ -520,6 +521,9 @@ class CsisClientImpl : public CsisClient {
       /* In locking case we need to make sure we lock all the device
        * and that in case of error on the way to lock the group, we
        * can revert lock previously locked devices as per specification.
+       * The members are locked one after the other in the rank order, as
+       * required by the Ordered Access procedure to not deadlock with
+       * another client locking the same set.
        */
       auto csis_device = csis_group->GetFirstDevice();
       while (!csis_device->IsConnected()) {
@@ -535,13 +539,14 @@ class CsisClientImpl : public CsisClient {
        * order and check if we get new state notification.
        */
       auto csis_device = csis_group->GetLastDevice();
-      auto csis_instance = csis_device->GetCsisInstanceByGroupId(group_id);
-      LOG_ASSERT(csis_instance) << " csis_instance does not exist!";
       while (csis_device) {
-        if ((csis_device->IsConnected()) &&
-            ((csis_instance->GetLockState() != new_lock_state))) {
-          csis_group->UpdateLockTransitionCnt(1);
-          SetLock(csis_device, csis_instance, new_lock_state);
+        if (csis_device->IsConnected()) {
+          auto csis_instance = csis_device->GetCsisInstanceByGroupId(group_id);
+          LOG_ASSERT(csis_instance) << " csis_instance does not exist!";
+          if (csis_instance->GetLockState() != new_lock_state) {
+            csis_group->UpdateLockTransitionCnt(1);
+            SetLock(csis_device, csis_instance, new_lock_state);
+          }
         }
         csis_device = csis_group->GetPrevDevice(csis_device);
       }
@@ -727,8 +732,18 @@ class CsisClientImpl : public CsisClient {
              << "    current lock state: "
              << static_cast<int>(g->GetCurrentLockState()) << "\n"
              << "    target lock state: "
-             << static_cast<int>(g->GetTargetLockState()) << "\n"
-             << "    devices: \n";
+             << static_cast<int>(g->GetTargetLockState()) << "\n";
+      for (bool lock : {true, false}) {
+        const auto& stats = g->GetLockProcedureStats(lock);
+        stream << "    " << (lock ? "lock" : "unlock")
+               << " procedures (done/failed): " << stats.completed_cnt << "/"
+               << stats.failed_cnt << ", latency ms (avg/max): "
+               << (stats.completed_cnt
+                       ? stats.total_latency_ms / stats.completed_cnt
+                       : 0)
+               << "/" << stats.max_latency_ms << "\n";
+      }
+      stream << "    devices: \n";
       for (auto& device : devices_) {
         if (!g->IsDeviceInTheGroup(device)) {
           if (device->GetExpectedGroupIdMember() == g->GetGroupId()) {
@@ -996,6 +1011,8 @@ class CsisClientImpl : public CsisClient {
     LOG_DEBUG("group id: %d, target state %s", csis_group->GetGroupId(),
               (lock ? "lock" : "unlock"));
 
+    csis_group->RecordLockProcedureResult(status ==
+                                          CsisGroupLockStatus::SUCCESS);
     NotifyGroupStatus(csis_group->GetGroupId(), lock, status,
                       std::move(csis_group->GetLockCb()));
     csis_group->SetTargetLockState(CsisLockState::CSIS_STATE_UNSET);
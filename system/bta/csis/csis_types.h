@@ -20,6 +20,7 @@
 #include <base/strings/string_number_conversions.h>
 
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <vector>
 
@@ -405,8 +406,22 @@ class CsisGroup {
 
   void SetCurrentLockState(CsisLockState state) { lock_state_ = state; }
 
+  /* Latency of the lock and unlock procedures, from the request until all
+   * the connected members answered.
+   */
+  struct LockProcedureStats {
+    size_t completed_cnt = 0;
+    size_t failed_cnt = 0;
+    uint64_t total_latency_ms = 0;
+    uint64_t max_latency_ms = 0;
+  };
+
   void SetTargetLockState(CsisLockState state,
                           CsisLockCb cb = base::DoNothing()) {
+    if (state != CsisLockState::CSIS_STATE_UNSET &&
+        target_lock_state_ == CsisLockState::CSIS_STATE_UNSET) {
+      lock_procedure_start_ = std::chrono::steady_clock::now();
+    }
     target_lock_state_ = state;
     cb_ = std::move(cb);
     switch (state) {
@@ -420,6 +435,31 @@ class CsisGroup {
     }
   }
 
+  /* Records the end of the ongoing lock or unlock procedure */
+  void RecordLockProcedureResult(bool success) {
+    if (target_lock_state_ == CsisLockState::CSIS_STATE_UNSET) return;
+
+    auto& stats = target_lock_state_ == CsisLockState::CSIS_STATE_LOCKED
+                      ? lock_stats_
+                      : unlock_stats_;
+    if (!success) {
+      stats.failed_cnt++;
+      return;
+    }
+
+    uint64_t latency_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - lock_procedure_start_)
+            .count();
+    stats.completed_cnt++;
+    stats.total_latency_ms += latency_ms;
+    stats.max_latency_ms = std::max(stats.max_latency_ms, latency_ms);
+  }
+
+  const LockProcedureStats& GetLockProcedureStats(bool lock) const {
+    return lock ? lock_stats_ : unlock_stats_;
+  }
+
   CsisLockCb GetLockCb(void) { return std::move(cb_); }
 
   CsisLockState GetCurrentLockState(void) const { return lock_state_; }
@@ -561,6 +601,9 @@ class CsisGroup {
   CsisLockState lock_state_;
   CsisLockState target_lock_state_;
   int lock_transition_cnt_;
+  std::chrono::steady_clock::time_point lock_procedure_start_;
+  LockProcedureStats lock_stats_;
+  LockProcedureStats unlock_stats_;
 
   CsisLockCb cb_;
 };
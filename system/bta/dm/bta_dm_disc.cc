@@ -32,6 +32,7 @@
 #include "common/circular_buffer.h"
 #include "common/init_flags.h"
 #include "common/strings.h"
+#include "common/time_util.h"
 #include "device/include/interop.h"
 #include "include/bind_helpers.h"
 #include "internal_include/bt_target.h"
@@ -39,7 +40,9 @@
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
+#include "osi/include/list.h"
 #include "osi/include/osi.h"  // UNUSED_ATTR
+#include "osi/include/properties.h"
 #include "stack/btm/btm_int_types.h"  // TimestampedStringCircularBuffer
 #include "stack/btm/neighbor_inquiry.h"
 #include "stack/include/avrc_api.h"
@@ -69,6 +72,26 @@ namespace {
 constexpr char kBtmLogTag[] = "SDP";
 
 tBTA_DM_SEARCH_CB bta_dm_search_cb;
+
+/* GATT service discovery of a LE device running alongside the BR/EDR service
+ * discovery of another device held by |bta_dm_search_cb| */
+struct tBTA_DM_LE_DISC_CB {
+  bool active;
+  RawAddress bd_addr;
+  uint16_t conn_id;
+  tBTA_DM_SEARCH_CBACK* p_cback;
+  uint64_t start_ms;
+};
+
+tBTA_DM_LE_DISC_CB bta_dm_le_disc_cb = {.conn_id = GATT_INVALID_CONN_ID};
+
+struct {
+  size_t started;
+  size_t succeeded;
+  size_t failed;
+  size_t coalesced;
+  uint64_t total_ms;
+} bta_dm_le_disc_stats;
 }  // namespace
 
 static void bta_dm_gatt_disc_complete(uint16_t conn_id, tGATT_STATUS status);
@@ -100,6 +123,9 @@ static void bta_dm_free_sdp_db();
 static void bta_dm_execute_queued_request();
 static void bta_dm_search_cancel_notify();
 static void bta_dm_close_gatt_conn(UNUSED_ATTR tBTA_DM_MSG* p_data);
+static bool bta_dm_le_disc_start(const tBTA_DM_MSG* p_data);
+static void bta_dm_le_disc_complete(tGATT_STATUS status);
+static void bta_dm_le_disc_abort();
 
 TimestampedStringCircularBuffer disc_gatt_history_{50};
 
@@ -192,6 +218,10 @@ void bta_dm_disc_gatt_refresh(const RawAddress& bd_addr) {
 }
 
 void bta_dm_disc_remove_device(const RawAddress& bd_addr) {
+  if (bta_dm_le_disc_cb.active && bta_dm_le_disc_cb.bd_addr == bd_addr) {
+    LOG_INFO("Device removed while LE service discovery was pending");
+    bta_dm_le_disc_complete(GATT_ERROR);
+  }
   if (bta_dm_search_cb.state == BTA_DM_DISCOVER_ACTIVE &&
       bta_dm_search_cb.peer_bdaddr == bd_addr) {
     LOG_INFO(
@@ -357,6 +387,8 @@ static void bta_dm_discover(tBTA_DM_MSG* p_data) {
  *
  ******************************************************************************/
 static void bta_dm_disable_search_and_disc(void) {
+  bta_dm_le_disc_abort();
+
   switch (bta_dm_search_get_state()) {
     case BTA_DM_SEARCH_IDLE:
       break;
@@ -1049,6 +1081,8 @@ static void bta_dm_queue_search(tBTA_DM_MSG* p_data) {
  *
  ******************************************************************************/
 static void bta_dm_queue_disc(tBTA_DM_MSG* p_data) {
+  if (bta_dm_le_disc_start(p_data)) return;
+
   tBTA_DM_MSG* p_pending_discovery =
       (tBTA_DM_MSG*)osi_malloc(sizeof(tBTA_DM_API_DISCOVER));
   memcpy(p_pending_discovery, p_data, sizeof(tBTA_DM_API_DISCOVER));
@@ -1276,9 +1310,9 @@ static void bta_dm_discover_next_device(void) {
  *
  ******************************************************************************/
 static tBT_TRANSPORT bta_dm_determine_discovery_transport(
-    const RawAddress& remote_bd_addr) {
+    const RawAddress& remote_bd_addr, tBT_TRANSPORT requested_transport) {
   tBT_TRANSPORT transport = BT_TRANSPORT_BR_EDR;
-  if (bta_dm_search_cb.transport == BT_TRANSPORT_AUTO) {
+  if (requested_transport == BT_TRANSPORT_AUTO) {
     tBT_DEVICE_TYPE dev_type;
     tBLE_ADDR_TYPE addr_type;
 
@@ -1296,14 +1330,14 @@ static tBT_TRANSPORT bta_dm_determine_discovery_transport(
       }
     }
   } else {
-    transport = bta_dm_search_cb.transport;
+    transport = requested_transport;
   }
   return transport;
 }
 
 static void bta_dm_discover_device(const RawAddress& remote_bd_addr) {
-  const tBT_TRANSPORT transport =
-      bta_dm_determine_discovery_transport(remote_bd_addr);
+  const tBT_TRANSPORT transport = bta_dm_determine_discovery_transport(
+      remote_bd_addr, bta_dm_search_cb.transport);
 
   VLOG(1) << __func__ << " BDA: " << ADDRESS_TO_LOGGABLE_STR(remote_bd_addr);
 
@@ -2029,6 +2063,184 @@ static void btm_dm_start_gatt_discovery(const RawAddress& bd_addr) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_dm_le_disc_start
+ *
+ * Description      Starts the GATT service discovery of a LE device right away
+ *                  when the search control block is busy with the service
+ *                  discovery of another device, instead of queuing it.
+ *
+ * Returns          true if the request was consumed, false if it must be
+ *                  queued
+ *
+ ******************************************************************************/
+static bool bta_dm_le_disc_start(const tBTA_DM_MSG* p_data) {
+  const RawAddress& bd_addr = p_data->discover.bd_addr;
+
+  if (bta_dm_search_get_state() != BTA_DM_DISCOVER_ACTIVE ||
+      !osi_property_get_bool("bluetooth.bta.dm.parallel_le_discovery.enabled",
+                             true)) {
+    return false;
+  }
+
+  if (bta_dm_le_disc_cb.active) {
+    if (bta_dm_le_disc_cb.bd_addr != bd_addr ||
+        bta_dm_le_disc_cb.p_cback != p_data->discover.p_cback) {
+      return false;
+    }
+    /* The discovery in progress reports to the same callback */
+    LOG_INFO("LE service discovery already in progress for %s",
+             ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    bta_dm_le_disc_stats.coalesced++;
+    return true;
+  }
+
+  if (bta_dm_search_cb.client_if == BTA_GATTS_INVALID_IF ||
+      bta_dm_search_cb.peer_bdaddr == bd_addr ||
+      bta_dm_search_cb.pending_close_bda == bd_addr) {
+    return false;
+  }
+
+  /* Only take LE devices whose name is known, as the name discovery is left
+   * to the search control block */
+  if (bta_dm_determine_discovery_transport(
+          bd_addr, p_data->discover.transport) != BT_TRANSPORT_LE ||
+      !BTM_IsRemoteNameKnown(bd_addr, BT_TRANSPORT_LE)) {
+    return false;
+  }
+
+  /* Keep the order of the requests already queued for this device */
+  list_t* pending =
+      fixed_queue_get_list(bta_dm_search_cb.pending_discovery_queue);
+  for (const list_node_t* node = list_begin(pending); node != list_end(pending);
+       node = list_next(node)) {
+    const tBTA_DM_MSG* p_pending = (const tBTA_DM_MSG*)list_node(node);
+    if (p_pending->discover.bd_addr == bd_addr) return false;
+  }
+
+  LOG_INFO(
+      "bta_dm_discovery: starting GATT discovery on %s alongside discovery "
+      "of %s",
+      ADDRESS_TO_LOGGABLE_CSTR(bd_addr),
+      ADDRESS_TO_LOGGABLE_CSTR(bta_dm_search_cb.peer_bdaddr));
+  BTM_LogHistory(kBtmLogTag, bd_addr, "Discovery started ",
+                 "Transport:le parallel");
+
+  bta_dm_le_disc_cb = {
+      .active = true,
+      .bd_addr = bd_addr,
+      .conn_id = GATT_INVALID_CONN_ID,
+      .p_cback = p_data->discover.p_cback,
+      .start_ms = bluetooth::common::time_get_os_boottime_ms(),
+  };
+  bta_dm_le_disc_stats.started++;
+
+  /* GATTC serves the search from its cache when the database is unchanged */
+  const bool is_connected =
+      get_btm_client_interface().peer.BTM_IsAclConnectionUp(bd_addr,
+                                                            BT_TRANSPORT_LE);
+  get_gatt_interface().BTA_GATTC_Open(bta_dm_search_cb.client_if, bd_addr,
+                                      BTM_BLE_DIRECT_CONNECTION,
+                                      /* opportunistic */ is_connected);
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_le_disc_complete
+ *
+ * Description      Reports the result of the parallel LE service discovery
+ *                  and releases its GATT connection.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_le_disc_complete(tGATT_STATUS status) {
+  if (!bta_dm_le_disc_cb.active) return;
+
+  const tBTA_DM_LE_DISC_CB le_disc = bta_dm_le_disc_cb;
+  bta_dm_le_disc_cb = {.conn_id = GATT_INVALID_CONN_ID};
+
+  tBTA_DM_SEARCH result;
+  std::vector<Uuid> gatt_services;
+  result.disc_ble_res.services = &gatt_services;
+  result.disc_ble_res.bd_addr = le_disc.bd_addr;
+  const char* p_name =
+      get_btm_client_interface().security.BTM_SecReadDevName(le_disc.bd_addr);
+  strlcpy((char*)result.disc_ble_res.bd_name, (p_name) ? p_name : "",
+          BD_NAME_LEN + 1);
+
+  bool send_gatt_results = bluetooth::common::init_flags::
+      always_send_services_if_gatt_disc_done_is_enabled();
+
+  if (le_disc.conn_id != GATT_INVALID_CONN_ID) {
+    if (status == GATT_SUCCESS) {
+      btgatt_db_element_t* db = NULL;
+      int count = 0;
+      get_gatt_interface().BTA_GATTC_GetGattDb(le_disc.conn_id, 0x0000, 0xFFFF,
+                                               &db, &count);
+      for (int i = 0; i < count; i++) {
+        // we process service entries only
+        if (db[i].type == BTGATT_DB_PRIMARY_SERVICE) {
+          gatt_services.push_back(db[i].uuid);
+        }
+      }
+      osi_free(db);
+      if (count != 0) send_gatt_results = true;
+    }
+    get_gatt_interface().BTA_GATTC_Close(le_disc.conn_id);
+  } else {
+    get_gatt_interface().BTA_GATTC_CancelOpen(bta_dm_search_cb.client_if,
+                                              le_disc.bd_addr, true);
+  }
+
+  if (status == GATT_SUCCESS) {
+    bta_dm_le_disc_stats.succeeded++;
+  } else {
+    bta_dm_le_disc_stats.failed++;
+  }
+  bta_dm_le_disc_stats.total_ms +=
+      bluetooth::common::time_get_os_boottime_ms() - le_disc.start_ms;
+
+  LOG_INFO("bta_dm_discovery: GATT discovery on %s done status:%s services:%zu",
+           ADDRESS_TO_LOGGABLE_CSTR(le_disc.bd_addr),
+           gatt_status_text(status).c_str(), gatt_services.size());
+
+  if (send_gatt_results) {
+    le_disc.p_cback(BTA_DM_GATT_OVER_LE_RES_EVT, &result);
+  }
+  le_disc.p_cback(BTA_DM_DISC_CMPL_EVT, nullptr);
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_le_disc_abort
+ *
+ * Description      Drops the parallel LE service discovery without reporting
+ *                  it, e.g. when Bluetooth is being disabled.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_le_disc_abort() {
+  if (!bta_dm_le_disc_cb.active) return;
+
+  LOG_INFO("Aborting GATT discovery on %s",
+           ADDRESS_TO_LOGGABLE_CSTR(bta_dm_le_disc_cb.bd_addr));
+  if (bta_dm_le_disc_cb.conn_id != GATT_INVALID_CONN_ID) {
+    get_gatt_interface().BTA_GATTC_Close(bta_dm_le_disc_cb.conn_id);
+  } else {
+    get_gatt_interface().BTA_GATTC_CancelOpen(
+        bta_dm_search_cb.client_if, bta_dm_le_disc_cb.bd_addr, true);
+  }
+  bta_dm_le_disc_cb = {.conn_id = GATT_INVALID_CONN_ID};
+}
+
+static bool bta_dm_le_disc_is_peer(const RawAddress& bd_addr) {
+  return bta_dm_le_disc_cb.active && bta_dm_le_disc_cb.bd_addr == bd_addr;
+}
+
 /*******************************************************************************
  *
  * Function         bta_dm_proc_open_evt
@@ -2052,6 +2264,17 @@ static void bta_dm_proc_open_evt(tBTA_GATTC_OPEN* p_data) {
       p_data->conn_id, p_data->client_if,
       gatt_client_event_text(BTA_GATTC_OPEN_EVT).c_str()));
 
+  if (bta_dm_le_disc_is_peer(p_data->remote_bda)) {
+    if (p_data->status == GATT_SUCCESS) {
+      bta_dm_le_disc_cb.conn_id = p_data->conn_id;
+      get_gatt_interface().BTA_GATTC_ServiceSearchRequest(p_data->conn_id,
+                                                          nullptr);
+    } else {
+      bta_dm_le_disc_complete(p_data->status);
+    }
+    return;
+  }
+
   bta_dm_search_cb.conn_id = p_data->conn_id;
 
   if (p_data->status == GATT_SUCCESS) {
@@ -2111,15 +2334,20 @@ static void bta_dm_gattc_callback(tBTA_GATTC_EVT event, tBTA_GATTC* p_data) {
       break;
 
     case BTA_GATTC_SEARCH_CMPL_EVT:
-      switch (bta_dm_search_get_state()) {
-        case BTA_DM_SEARCH_IDLE:
-          break;
-        case BTA_DM_SEARCH_ACTIVE:
-        case BTA_DM_SEARCH_CANCELLING:
-        case BTA_DM_DISCOVER_ACTIVE:
-          bta_dm_gatt_disc_complete(p_data->search_cmpl.conn_id,
-                                    p_data->search_cmpl.status);
-          break;
+      if (bta_dm_le_disc_cb.active &&
+          bta_dm_le_disc_cb.conn_id == p_data->search_cmpl.conn_id) {
+        bta_dm_le_disc_complete(p_data->search_cmpl.status);
+      } else {
+        switch (bta_dm_search_get_state()) {
+          case BTA_DM_SEARCH_IDLE:
+            break;
+          case BTA_DM_SEARCH_ACTIVE:
+          case BTA_DM_SEARCH_CANCELLING:
+          case BTA_DM_DISCOVER_ACTIVE:
+            bta_dm_gatt_disc_complete(p_data->search_cmpl.conn_id,
+                                      p_data->search_cmpl.status);
+            break;
+        }
       }
       disc_gatt_history_.Push(base::StringPrintf(
           "%-32s conn_id:%hu status:%s", "GATTC_EventCallback",
@@ -2130,6 +2358,13 @@ static void bta_dm_gattc_callback(tBTA_GATTC_EVT event, tBTA_GATTC* p_data) {
     case BTA_GATTC_CLOSE_EVT:
       LOG_INFO("BTA_GATTC_CLOSE_EVT reason = %d", p_data->close.reason);
 
+      if (bta_dm_le_disc_is_peer(p_data->close.remote_bda)) {
+        /* in case of disconnect before search is completed */
+        bta_dm_le_disc_cb.conn_id = GATT_INVALID_CONN_ID;
+        bta_dm_le_disc_complete(GATT_ERROR);
+        break;
+      }
+
       if (p_data->close.remote_bda == bta_dm_search_cb.peer_bdaddr) {
         if (bluetooth::common::init_flags::
                 bta_dm_clear_conn_id_on_client_close_is_enabled()) {
@@ -2182,7 +2417,8 @@ void bta_dm_remname_cback(const tBTM_REMOTE_DEV_NAME* p) {
 }
 
 tBT_TRANSPORT bta_dm_determine_discovery_transport(const RawAddress& bd_addr) {
-  return ::bta_dm_determine_discovery_transport(bd_addr);
+  return ::bta_dm_determine_discovery_transport(bd_addr,
+                                                ::bta_dm_search_cb.transport);
 }
 
 void bta_dm_remote_name_cmpl(const tBTA_DM_MSG* p_data) {
@@ -2396,6 +2632,7 @@ static void bta_dm_disc_init_search_cb(tBTA_DM_SEARCH_CB& bta_dm_search_cb) {
 }
 
 static void bta_dm_disc_reset() {
+  bta_dm_le_disc_cb = {.conn_id = GATT_INVALID_CONN_ID};
   alarm_free(bta_dm_search_cb.search_timer);
   alarm_free(bta_dm_search_cb.gatt_close_timer);
   osi_free_and_reset((void**)&bta_dm_search_cb.p_pending_search);
@@ -2482,6 +2719,22 @@ void DumpsysBtaDmDisc(int fd) {
   }
   LOG_DUMPSYS(fd, " current bta_dm_search_state:%s",
               bta_dm_state_text(bta_dm_search_get_state()).c_str());
+  const size_t le_disc_done =
+      bta_dm_le_disc_stats.succeeded + bta_dm_le_disc_stats.failed;
+  LOG_DUMPSYS(fd,
+              " parallel le discovery started:%zu succeeded:%zu failed:%zu "
+              "coalesced:%zu avg_ms:%llu",
+              bta_dm_le_disc_stats.started, bta_dm_le_disc_stats.succeeded,
+              bta_dm_le_disc_stats.failed, bta_dm_le_disc_stats.coalesced,
+              (unsigned long long)(le_disc_done == 0
+                                       ? 0
+                                       : bta_dm_le_disc_stats.total_ms /
+                                             le_disc_done));
+  if (bta_dm_le_disc_cb.active) {
+    LOG_DUMPSYS(fd, " parallel le discovery in progress peer:%s conn_id:%hu",
+                ADDRESS_TO_LOGGABLE_CSTR(bta_dm_le_disc_cb.bd_addr),
+                bta_dm_le_disc_cb.conn_id);
+  }
 }
 #undef DUMPSYS_TAG
 
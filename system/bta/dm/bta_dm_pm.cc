@@ -334,6 +334,43 @@ static void bta_dm_pm_stop_timer_by_index(tBTA_PM_TIMER* p_timer,
   alarm_cancel(p_timer->timer[timer_idx]);
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_dm_pm_update_sniff_guard
+ *
+ * Description      Limit the sniff interval that btm may pick from the link
+ *                  traffic while a latency sensitive service (HID, SCO) is
+ *                  connected to the peer.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_pm_update_sniff_guard(const RawAddress& peer_addr) {
+  if (!get_btm_client_interface().peer.BTM_IsAclConnectionUp(
+          peer_addr, BT_TRANSPORT_BR_EDR)) {
+    return;
+  }
+
+  uint16_t max_interval = 0;
+  for (uint8_t i = 0; i < bta_dm_conn_srvcs.count; i++) {
+    const tBTA_DM_SRVCS& srvc = bta_dm_conn_srvcs.conn_srvc[i];
+    if (srvc.peer_bdaddr != peer_addr) continue;
+
+    uint16_t limit = 0;
+    if (srvc.id == BTA_ID_HH) {
+      limit = BTA_DM_PM_HH_MAX_SNIFF_INTERVAL;
+    } else if ((srvc.id == BTA_ID_AG || srvc.id == BTA_ID_HS) &&
+               srvc.state == BTA_SYS_SCO_OPEN) {
+      limit = BTA_DM_PM_SCO_MAX_SNIFF_INTERVAL;
+    }
+    if (limit != 0 && (max_interval == 0 || limit < max_interval)) {
+      max_interval = limit;
+    }
+  }
+  get_btm_client_interface().link_policy.BTM_PM_SetMaxSniffInterval(
+      peer_addr, max_interval);
+}
+
 /*******************************************************************************
  *
  * Function         bta_dm_pm_cback
@@ -492,6 +529,7 @@ static void bta_dm_pm_cback(tBTA_SYS_CONN_STATUS status, const tBTA_SYS_ID id,
     }
   }
 
+  bta_dm_pm_update_sniff_guard(peer_addr);
   bta_dm_pm_set_mode(peer_addr, BTA_DM_PM_NO_ACTION, pm_req);
 }
 
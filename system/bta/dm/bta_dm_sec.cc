@@ -30,6 +30,7 @@
 #include "internal_include/bt_target.h"
 #include "osi/include/compat.h"  // strlcpy
 #include "osi/include/osi.h"     // UNUSED_ATTR
+#include "stack/include/bt_device_type.h"
 #include "stack/include/btm_ble_sec_api_types.h"
 #include "stack/include/btm_client_interface.h"
 #include "stack/include/btm_sec_api.h"
@@ -1058,6 +1059,39 @@ void bta_dm_add_ble_device(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
                                                           addr_type);
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_dm_add_bonded_devices
+ *
+ * Description      This function adds the bonded devices restored from the
+ *                  NVRAM to the security database, with their link key and
+ *                  BLE keys.
+ *                  It is normally called during host startup.
+ *
+ * Parameters:
+ *
+ ******************************************************************************/
+void bta_dm_add_bonded_devices(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+  BD_NAME bd_name = {};
+  for (auto& device : devices) {
+    if (device.link_key_known &&
+        !get_btm_client_interface().security.BTM_SecAddDevice(
+            device.bd_addr, device.dev_class, bd_name, nullptr,
+            &device.link_key, device.key_type, device.pin_length)) {
+      LOG(ERROR) << "BTA_DM: Error adding device "
+                 << ADDRESS_TO_LOGGABLE_STR(device.bd_addr);
+    }
+    if (device.ble_keys.empty()) continue;
+
+    get_btm_client_interface().security.BTM_SecAddBleDevice(
+        device.bd_addr, BT_DEVICE_TYPE_BLE, device.addr_type);
+    for (auto& [key_type, key] : device.ble_keys) {
+      get_btm_client_interface().security.BTM_SecAddBleKey(
+          device.bd_addr, (tBTM_LE_KEY_VALUE*)&key, key_type);
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Function         bta_dm_add_ble_device
@@ -225,6 +225,26 @@ void BTA_DmAddBleDevice(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         BTA_DmAddBondedDevices
+ *
+ * Description      Add the bonded devices restored from the NVRAM.
+ *
+ * Parameters:      devices          - bonded devices with their keys.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_DmAddBondedDevices(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+  if (IS_FLAG_ENABLED(synchronous_bta_sec)) {
+    bta_dm_add_bonded_devices(std::move(devices));
+  } else {
+    do_in_main_thread(FROM_HERE, base::BindOnce(bta_dm_add_bonded_devices,
+                                                std::move(devices)));
+  }
+}
+
 /*******************************************************************************
  *
  * Function         BTA_DmBlePasskeyReply
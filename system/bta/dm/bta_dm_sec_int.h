@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "bta/include/bta_api.h"
 #include "bta/include/bta_sec_api.h"
@@ -80,6 +81,7 @@ void bta_dm_add_ble_device(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
                            tBT_DEVICE_TYPE dev_type);
 void bta_dm_add_blekey(const RawAddress& bd_addr, tBTA_LE_KEY_VALUE blekey,
                        tBTM_LE_KEY_TYPE key_type);
+void bta_dm_add_bonded_devices(std::vector<tBTA_DM_BONDED_DEVICE> devices);
 void bta_dm_add_device(std::unique_ptr<tBTA_DM_API_ADD_DEVICE> msg);
 void bta_dm_ble_config_local_privacy(bool privacy_enable);
 void bta_dm_ble_confirm_reply(const RawAddress& bd_addr, bool accept);
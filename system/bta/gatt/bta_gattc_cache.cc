@@ -31,6 +31,8 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <utility>
+#include <vector>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/gatt/bta_gattc_int.h"
@@ -119,16 +121,6 @@ void bta_gattc_init_cache(tBTA_GATTC_SERV* p_srvc_cb) {
   p_srvc_cb->pending_discovery.Clear();
 }
 
-const Service* bta_gattc_find_matching_service(
-    const std::list<Service>& services, uint16_t handle) {
-  for (const Service& service : services) {
-    if (handle >= service.handle && handle <= service.end_handle)
-      return &service;
-  }
-
-  return nullptr;
-}
-
 /// Whether the peer device uses robust caching
 RobustCachingSupport GetRobustCachingSupport(const tBTA_GATTC_CLCB* p_clcb,
                                              const gatt::Database& db) {
@@ -634,31 +626,22 @@ const std::list<Service>* bta_gattc_get_services(uint16_t conn_id) {
 
 const Service* bta_gattc_get_service_for_handle_srcb(tBTA_GATTC_SERV* p_srcb,
                                                      uint16_t handle) {
-  const std::list<Service>* services = bta_gattc_get_services_srcb(p_srcb);
-  if (services == NULL) return NULL;
-  return bta_gattc_find_matching_service(*services, handle);
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database.FindService(handle);
 }
 
 const Service* bta_gattc_get_service_for_handle(uint16_t conn_id,
                                                 uint16_t handle) {
-  const std::list<Service>* services = bta_gattc_get_services(conn_id);
-  if (services == NULL) return NULL;
+  tBTA_GATTC_CLCB* p_clcb = bta_gattc_find_clcb_by_conn_id(conn_id);
+  if (p_clcb == NULL) return NULL;
 
-  return bta_gattc_find_matching_service(*services, handle);
+  return bta_gattc_get_service_for_handle_srcb(p_clcb->p_srcb, handle);
 }
 
 const Characteristic* bta_gattc_get_characteristic_srcb(tBTA_GATTC_SERV* p_srcb,
                                                         uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) return NULL;
-
-  for (const Characteristic& charac : service->characteristics) {
-    if (handle == charac.value_handle) return &charac;
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database.FindCharacteristic(handle);
 }
 
 const Characteristic* bta_gattc_get_characteristic(uint16_t conn_id,
@@ -673,20 +656,8 @@ const Characteristic* bta_gattc_get_characteristic(uint16_t conn_id,
 
 const Descriptor* bta_gattc_get_descriptor_srcb(tBTA_GATTC_SERV* p_srcb,
                                                 uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) {
-    return NULL;
-  }
-
-  for (const Characteristic& charac : service->characteristics) {
-    for (const Descriptor& desc : charac.descriptors) {
-      if (handle == desc.handle) return &desc;
-    }
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database.FindDescriptor(handle);
 }
 
 const Descriptor* bta_gattc_get_descriptor(uint16_t conn_id, uint16_t handle) {
@@ -700,18 +671,8 @@ const Descriptor* bta_gattc_get_descriptor(uint16_t conn_id, uint16_t handle) {
 
 const Characteristic* bta_gattc_get_owning_characteristic_srcb(
     tBTA_GATTC_SERV* p_srcb, uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) return NULL;
-
-  for (const Characteristic& charac : service->characteristics) {
-    for (const Descriptor& desc : charac.descriptors) {
-      if (handle == desc.handle) return &charac;
-    }
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database.FindOwningCharacteristic(handle);
 }
 
 const Characteristic* bta_gattc_get_owning_characteristic(uint16_t conn_id,
@@ -918,35 +879,6 @@ void bta_gattc_fill_gatt_db_el(btgatt_db_element_t* p_attr,
   p_attr->uuid = uuid;
 }
 
-/*******************************************************************************
- * Returns          number of elements inside db from start_handle to end_handle
- ******************************************************************************/
-static size_t bta_gattc_get_db_size(const std::list<Service>& services,
-                                    uint16_t start_handle,
-                                    uint16_t end_handle) {
-  if (services.empty()) return 0;
-
-  size_t db_size = 0;
-
-  for (const Service& service : services) {
-    if (service.handle < start_handle) continue;
-
-    if (service.end_handle > end_handle) break;
-
-    db_size++;
-
-    for (const Characteristic& charac : service.characteristics) {
-      db_size++;
-
-      db_size += charac.descriptors.size();
-    }
-
-    db_size += service.included_services.size();
-  }
-
-  return db_size;
-}
-
 /*******************************************************************************
  *
  * Function         bta_gattc_get_gatt_db_impl
@@ -976,52 +908,59 @@ static void bta_gattc_get_gatt_db_impl(tBTA_GATTC_SERV* p_srvc_cb,
     return;
   }
 
-  size_t db_size = bta_gattc_get_db_size(p_srvc_cb->gatt_database.Services(),
-                                         start_handle, end_handle);
+  const std::vector<gatt::DatabaseAttribute>& attributes =
+      p_srvc_cb->gatt_database.Attributes();
+  std::pair<size_t, size_t> range =
+      p_srvc_cb->gatt_database.ServicesAttributes(start_handle, end_handle);
+  size_t db_size = range.second - range.first;
 
   void* buffer = osi_malloc(db_size * sizeof(btgatt_db_element_t));
   btgatt_db_element_t* curr_db_attr = (btgatt_db_element_t*)buffer;
+  btgatt_db_element_t* characteristic = NULL;
 
-  for (const Service& service : p_srvc_cb->gatt_database.Services()) {
-    if (service.handle < start_handle) continue;
-
-    if (service.end_handle > end_handle) break;
-
-    bta_gattc_fill_gatt_db_el(curr_db_attr,
-                              service.is_primary ? BTGATT_DB_PRIMARY_SERVICE
-                                                 : BTGATT_DB_SECONDARY_SERVICE,
-                              0 /* att_handle */, service.handle,
-                              service.end_handle, service.handle, service.uuid,
-                              0 /* prop */);
-    curr_db_attr++;
-
-    for (const Characteristic& charac : service.characteristics) {
-      bta_gattc_fill_gatt_db_el(curr_db_attr, BTGATT_DB_CHARACTERISTIC,
-                                charac.value_handle, 0 /* s_handle */,
-                                0 /* e_handle */, charac.value_handle,
-                                charac.uuid, charac.properties);
-      btgatt_db_element_t* characteristic = curr_db_attr;
-      curr_db_attr++;
-
-      for (const Descriptor& desc : charac.descriptors) {
+  for (size_t i = range.first; i < range.second; i++, curr_db_attr++) {
+    const gatt::DatabaseAttribute& attr = attributes[i];
+    switch (attr.type) {
+      case gatt::DatabaseAttribute::Type::SERVICE: {
+        const Service& service = *attr.service;
+        bta_gattc_fill_gatt_db_el(
+            curr_db_attr,
+            service.is_primary ? BTGATT_DB_PRIMARY_SERVICE
+                               : BTGATT_DB_SECONDARY_SERVICE,
+            0 /* att_handle */, service.handle, service.end_handle,
+            service.handle, service.uuid, 0 /* prop */);
+        break;
+      }
+      case gatt::DatabaseAttribute::Type::CHARACTERISTIC: {
+        const Characteristic& charac = *attr.characteristic;
+        bta_gattc_fill_gatt_db_el(curr_db_attr, BTGATT_DB_CHARACTERISTIC,
+                                  charac.value_handle, 0 /* s_handle */,
+                                  0 /* e_handle */, charac.value_handle,
+                                  charac.uuid, charac.properties);
+        characteristic = curr_db_attr;
+        break;
+      }
+      case gatt::DatabaseAttribute::Type::DESCRIPTOR: {
+        const Descriptor& desc = *attr.descriptor;
         bta_gattc_fill_gatt_db_el(
             curr_db_attr, BTGATT_DB_DESCRIPTOR, desc.handle, 0 /* s_handle */,
             0 /* e_handle */, desc.handle, desc.uuid, 0 /* property */);
 
-        if (desc.uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
+        if (characteristic &&
+            desc.uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
           characteristic->extended_properties =
               desc.characteristic_extended_properties;
         }
-        curr_db_attr++;
+        break;
+      }
+      case gatt::DatabaseAttribute::Type::INCLUDED_SERVICE: {
+        const IncludedService& p_isvc = *attr.included_service;
+        bta_gattc_fill_gatt_db_el(curr_db_attr, BTGATT_DB_INCLUDED_SERVICE,
+                                  p_isvc.handle, p_isvc.start_handle,
+                                  0 /* e_handle */, p_isvc.handle, p_isvc.uuid,
+                                  0 /* property */);
+        break;
       }
-    }
-
-    for (const IncludedService& p_isvc : service.included_services) {
-      bta_gattc_fill_gatt_db_el(curr_db_attr, BTGATT_DB_INCLUDED_SERVICE,
-                                p_isvc.handle, p_isvc.start_handle,
-                                0 /* e_handle */, p_isvc.handle, p_isvc.uuid,
-                                0 /* property */);
-      curr_db_attr++;
     }
   }
 
@@ -21,8 +21,13 @@
 #include <base/logging.h>
 #include <base/strings/string_number_conversions.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <cstring>
+#include <list>
 #include <string>
 #include <vector>
 
@@ -57,6 +62,17 @@ using std::vector;
 // Default expired time is 7 days
 #define GATT_HASH_EXPIRED_TIME 604800
 
+// Number of cache files kept deserialized after being loaded
+#define GATT_LOADED_DB_MAX_SIZE 8
+
+// Cache files are version, number of attributes, then the attributes, which
+// are read in place from the mapped file
+#define GATT_CACHE_HEADER_SIZE (2 * sizeof(uint16_t))
+static_assert(sizeof(StoredAttribute) == StoredAttribute::kSizeOnDisk,
+              "GATT cache attributes are read in place");
+static_assert(GATT_CACHE_HEADER_SIZE % alignof(StoredAttribute) == 0,
+              "GATT cache attributes are read in place");
+
 static void bta_gattc_hash_remove_least_recently_used_if_possible();
 
 static void bta_gattc_generate_cache_file_name(char* buffer, size_t buffer_len,
@@ -74,62 +90,154 @@ static void bta_gattc_generate_hash_file_name(char* buffer, size_t buffer_len,
 
 static gatt::Database EMPTY_DB;
 
+/* Database deserialized from a cache file. The address files of the devices
+ * are hard links to the hash file of their database, so devices with the same
+ * database share the entry of the file. */
+struct tBTA_GATTC_LOADED_DB {
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  gatt::Database database;
+};
+
+/* Most recently loaded first */
+static std::list<tBTA_GATTC_LOADED_DB> loaded_dbs;
+
+static bool bta_gattc_is_same_file(const tBTA_GATTC_LOADED_DB& loaded,
+                                   const struct stat& st) {
+  return loaded.dev == st.st_dev && loaded.ino == st.st_ino &&
+         loaded.size == st.st_size &&
+         loaded.mtime.tv_sec == st.st_mtim.tv_sec &&
+         loaded.mtime.tv_nsec == st.st_mtim.tv_nsec;
+}
+
+/* Drop the loaded database of a file about to be written or removed */
+static void bta_gattc_forget_loaded_db(const char* fname) {
+  struct stat st;
+  if (stat(fname, &st) == -1) return;
+
+  loaded_dbs.remove_if([&st](const tBTA_GATTC_LOADED_DB& loaded) {
+    return loaded.dev == st.st_dev && loaded.ino == st.st_ino;
+  });
+}
+
 /*******************************************************************************
  *
- * Function         bta_gattc_load_db
+ * Function         bta_gattc_parse_db
  *
- * Description      Load GATT database from storage.
+ * Description      Deserialize GATT database from the content of a cache file.
  *
- * Parameter        fname: input file name
+ * Parameter        data, size: content of the file, mapped in memory.
+ *                  fname: file name, for logging.
  *
  * Returns          non-empty GATT database on success, empty GATT database
  *                  otherwise
  *
  ******************************************************************************/
-static gatt::Database bta_gattc_load_db(const char* fname) {
-  FILE* fd = fopen(fname, "rb");
-  if (!fd) {
-    LOG(ERROR) << __func__ << ": can't open GATT cache file " << fname
-               << " for reading, error: " << strerror(errno);
-    return EMPTY_DB;
-  }
-
+static gatt::Database bta_gattc_parse_db(const uint8_t* data, size_t size,
+                                         const char* fname) {
   uint16_t cache_ver = 0;
   uint16_t num_attr = 0;
 
-  if (fread(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
+  if (size < sizeof(uint16_t)) {
     LOG(ERROR) << __func__ << ": can't read GATT cache version from: " << fname;
-    goto done;
+    return EMPTY_DB;
   }
+  memcpy(&cache_ver, data, sizeof(uint16_t));
 
   if (cache_ver != GATT_CACHE_VERSION) {
     LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
-    goto done;
+    return EMPTY_DB;
   }
 
-  if (fread(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
+  if (size < GATT_CACHE_HEADER_SIZE) {
     LOG(ERROR) << __func__
                << ": can't read number of GATT attributes: " << fname;
-    goto done;
+    return EMPTY_DB;
   }
+  memcpy(&num_attr, data + sizeof(uint16_t), sizeof(uint16_t));
 
-  {
-    std::vector<StoredAttribute> attr(num_attr);
+  if (size - GATT_CACHE_HEADER_SIZE < num_attr * sizeof(StoredAttribute)) {
+    LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
+    return EMPTY_DB;
+  }
+
+  bool success = false;
+  gatt::Database result = gatt::Database::Deserialize(
+      reinterpret_cast<const StoredAttribute*>(data + GATT_CACHE_HEADER_SIZE),
+      num_attr, &success);
+  return success ? result : EMPTY_DB;
+}
 
-    if (fread(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
-      LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
-      goto done;
+/*******************************************************************************
+ *
+ * Function         bta_gattc_load_db
+ *
+ * Description      Load GATT database from storage. The file is mapped rather
+ *                  than read, and only deserialized if it wasn't recently
+ *                  loaded, possibly for another device.
+ *
+ * Parameter        fname: input file name
+ *
+ * Returns          non-empty GATT database on success, empty GATT database
+ *                  otherwise
+ *
+ ******************************************************************************/
+static gatt::Database bta_gattc_load_db(const char* fname) {
+  int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    LOG(ERROR) << __func__ << ": can't open GATT cache file " << fname
+               << " for reading, error: " << strerror(errno);
+    return EMPTY_DB;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    LOG(ERROR) << __func__ << ": can't stat GATT cache file " << fname
+               << ", error: " << strerror(errno);
+    close(fd);
+    return EMPTY_DB;
+  }
+
+  for (auto it = loaded_dbs.begin(); it != loaded_dbs.end(); it++) {
+    if (bta_gattc_is_same_file(*it, st)) {
+      close(fd);
+      loaded_dbs.splice(loaded_dbs.begin(), loaded_dbs, it);
+      VLOG(1) << __func__ << ": already loaded " << fname;
+      return loaded_dbs.front().database;
     }
-    fclose(fd);
+  }
 
-    bool success = false;
-    gatt::Database result = gatt::Database::Deserialize(attr, &success);
-    return success ? result : EMPTY_DB;
+  size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return bta_gattc_parse_db(nullptr, 0, fname);
   }
 
-done:
-  fclose(fd);
-  return EMPTY_DB;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << __func__ << ": can't map GATT cache file " << fname
+               << ", error: " << strerror(errno);
+    return EMPTY_DB;
+  }
+
+  gatt::Database result =
+      bta_gattc_parse_db(static_cast<const uint8_t*>(data), size, fname);
+  munmap(data, size);
+
+  if (!result.IsEmpty()) {
+    loaded_dbs.push_front(tBTA_GATTC_LOADED_DB{
+        .dev = st.st_dev,
+        .ino = st.st_ino,
+        .size = st.st_size,
+        .mtime = st.st_mtim,
+        .database = result,
+    });
+    if (loaded_dbs.size() > GATT_LOADED_DB_MAX_SIZE) loaded_dbs.pop_back();
+  }
+  return result;
 }
 
 /*******************************************************************************
@@ -237,6 +345,8 @@ void StoredAttribute::SerializeStoredAttribute(const StoredAttribute& attr,
  ******************************************************************************/
 static bool bta_gattc_store_db(const char* fname,
                                const std::vector<StoredAttribute>& attr) {
+  bta_gattc_forget_loaded_db(fname);
+
   FILE* fd = fopen(fname, "wb");
   if (!fd) {
     LOG(ERROR) << __func__
@@ -445,12 +555,14 @@ static void bta_gattc_hash_remove_least_recently_used_if_possible() {
 
   // if the number of hash files exceeds the limit, remove the cadidate item.
   if (count > GATT_HASH_MAX_SIZE && !candidate_item.empty()) {
+    bta_gattc_forget_loaded_db(candidate_item.c_str());
     unlink(candidate_item.c_str());
     LOG_DEBUG("delete hash file (size), name=%s", candidate_item.c_str());
   }
 
   // If there is any file expired, also delete it.
   for (string expired_item : expired_items) {
+    bta_gattc_forget_loaded_db(expired_item.c_str());
     unlink(expired_item.c_str());
     LOG_DEBUG("delete hash file (expired), name=%s", expired_item.c_str());
   }
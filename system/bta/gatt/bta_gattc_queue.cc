@@ -19,11 +19,15 @@
 #include "bta_gatt_queue.h"
 
 #include <list>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
+#include "stack/include/gatt_api.h"
 
 #include <base/logging.h>
 
@@ -44,6 +48,7 @@ struct gatt_read_op_data {
 std::unordered_map<uint16_t, std::list<gatt_operation>>
     BtaGattQueue::gatt_op_queue;
 std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_executing;
+std::unordered_set<uint16_t> BtaGattQueue::gatt_read_multi_var_rejected;
 
 void BtaGattQueue::mark_as_not_executing(uint16_t conn_id) {
   gatt_op_queue_executing.erase(conn_id);
@@ -138,6 +143,101 @@ void BtaGattQueue::gatt_read_multi_op_finished(uint16_t conn_id,
   }
 }
 
+/* Reads sent together in one Read Multiple Variable Length request */
+struct gatt_merged_read_op_data {
+  std::list<gatt_operation> ops;
+};
+
+static bool is_mergeable_read(const gatt_operation& op) {
+  return (op.type == GATT_READ_CHAR || op.type == GATT_READ_DESC) &&
+         !op.single_read;
+}
+
+/* Sends the reads at the front of |gatt_ops| in one Read Multiple Variable
+ * Length request, if there are at least two of them and the server supports
+ * it. Returns true if the request was sent. */
+bool BtaGattQueue::gatt_merge_reads(uint16_t conn_id,
+                                    std::list<gatt_operation>& gatt_ops) {
+  if (gatt_ops.size() < 2 || !is_mergeable_read(gatt_ops.front()) ||
+      !is_mergeable_read(*std::next(gatt_ops.begin())) ||
+      gatt_read_multi_var_rejected.count(conn_id)) {
+    return false;
+  }
+
+  uint8_t max_handles = GATTC_GetMaxReadMultiVarHandles(conn_id);
+  tBTA_GATTC_MULTI handles{};
+  auto end = gatt_ops.begin();
+  while (end != gatt_ops.end() && handles.num_attr < max_handles &&
+         is_mergeable_read(*end)) {
+    handles.handles[handles.num_attr++] = end->handle;
+    end++;
+  }
+  if (handles.num_attr < 2) return false;
+
+  LOG_VERBOSE("%s: conn_id=0x%x, merging %d reads", __func__, conn_id,
+              handles.num_attr);
+  gatt_merged_read_op_data* data = new gatt_merged_read_op_data();
+  data->ops.splice(data->ops.end(), gatt_ops, gatt_ops.begin(), end);
+  BTA_GATTC_ReadMultiple(conn_id, handles, true /* variable_len */,
+                         GATT_AUTH_REQ_NONE, gatt_merged_read_op_finished,
+                         data);
+  return true;
+}
+
+void BtaGattQueue::gatt_merged_read_op_finished(uint16_t conn_id,
+                                                tGATT_STATUS status,
+                                                tBTA_GATTC_MULTI& /* handles */,
+                                                uint16_t len, uint8_t* value,
+                                                void* data) {
+  std::unique_ptr<gatt_merged_read_op_data> tmp(
+      static_cast<gatt_merged_read_op_data*>(data));
+  std::list<gatt_operation>& ops = tmp->ops;
+
+  if (status == GATT_REQ_NOT_SUPPORTED) {
+    gatt_read_multi_var_rejected.insert(conn_id);
+  }
+
+  /* The response holds a (length, value) tuple per handle, in the order of
+   * the request, and is cut at the MTU */
+  std::vector<std::pair<uint16_t, uint8_t*>> values;
+  if (status == GATT_SUCCESS) {
+    uint8_t* p = value;
+    uint16_t left = len;
+    while (values.size() < ops.size() && left >= 2) {
+      uint16_t value_len = p[0] | (p[1] << 8);
+      p += 2;
+      left -= 2;
+      if (value_len > left) break;
+      values.emplace_back(value_len, p);
+      p += value_len;
+      left -= value_len;
+    }
+  }
+
+  /* Reads that failed or did not fit are done again one by one, unless the
+   * queue was cleaned meanwhile */
+  auto not_read = std::next(ops.begin(), values.size());
+  if (not_read != ops.end() && gatt_op_queue_executing.count(conn_id)) {
+    LOG_VERBOSE("%s: conn_id=0x%x, status=0x%x, reading %zu values again",
+                __func__, conn_id, status,
+                (size_t)std::distance(not_read, ops.end()));
+    for (auto it = not_read; it != ops.end(); it++) it->single_read = true;
+    std::list<gatt_operation>& gatt_ops = gatt_op_queue[conn_id];
+    gatt_ops.splice(gatt_ops.begin(), ops, not_read, ops.end());
+  }
+
+  mark_as_not_executing(conn_id);
+  gatt_execute_next_op(conn_id);
+
+  auto value_it = values.begin();
+  for (auto op = ops.begin(); value_it != values.end(); op++, value_it++) {
+    if (op->read_cb) {
+      op->read_cb(conn_id, GATT_SUCCESS, op->handle, value_it->first,
+                  value_it->second, op->read_cb_data);
+    }
+  }
+}
+
 void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
   LOG_VERBOSE("%s: conn_id=0x%x", __func__, conn_id);
   if (gatt_op_queue.empty()) {
@@ -161,6 +261,8 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
 
   std::list<gatt_operation>& gatt_ops = map_ptr->second;
 
+  if (gatt_merge_reads(conn_id, gatt_ops)) return;
+
   gatt_operation& op = gatt_ops.front();
 
   if (op.type == GATT_READ_CHAR) {
@@ -219,6 +321,7 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
 void BtaGattQueue::Clean(uint16_t conn_id) {
   gatt_op_queue.erase(conn_id);
   gatt_op_queue_executing.erase(conn_id);
+  gatt_read_multi_var_rejected.erase(conn_id);
 }
 
 void BtaGattQueue::ReadCharacteristic(uint16_t conn_id, uint16_t handle,
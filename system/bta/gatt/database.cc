@@ -21,8 +21,10 @@
 #include <base/logging.h>
 
 #include <algorithm>
+#include <iterator>
 #include <list>
 #include <sstream>
+#include <utility>
 
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "internal_include/bt_trace.h"
@@ -61,6 +63,135 @@ Service* FindService(std::list<Service>& services, uint16_t handle) {
   return nullptr;
 }
 
+void Database::BuildIndex() {
+  attributes.clear();
+  handle_index.clear();
+  service_index.clear();
+
+  for (const Service& service : services) {
+    service_index.push_back(attributes.size());
+    handle_index.emplace_back(service.handle, attributes.size());
+    attributes.push_back(DatabaseAttribute{
+        .type = DatabaseAttribute::Type::SERVICE,
+        .handle = service.handle,
+        .service = &service,
+        .characteristic = nullptr,
+        .descriptor = nullptr,
+        .included_service = nullptr,
+    });
+
+    for (const Characteristic& charac : service.characteristics) {
+      handle_index.emplace_back(charac.declaration_handle, attributes.size());
+      handle_index.emplace_back(charac.value_handle, attributes.size());
+      attributes.push_back(DatabaseAttribute{
+          .type = DatabaseAttribute::Type::CHARACTERISTIC,
+          .handle = charac.value_handle,
+          .service = &service,
+          .characteristic = &charac,
+          .descriptor = nullptr,
+          .included_service = nullptr,
+      });
+
+      for (const Descriptor& desc : charac.descriptors) {
+        handle_index.emplace_back(desc.handle, attributes.size());
+        attributes.push_back(DatabaseAttribute{
+            .type = DatabaseAttribute::Type::DESCRIPTOR,
+            .handle = desc.handle,
+            .service = &service,
+            .characteristic = &charac,
+            .descriptor = &desc,
+            .included_service = nullptr,
+        });
+      }
+    }
+
+    for (const IncludedService& is : service.included_services) {
+      handle_index.emplace_back(is.handle, attributes.size());
+      attributes.push_back(DatabaseAttribute{
+          .type = DatabaseAttribute::Type::INCLUDED_SERVICE,
+          .handle = is.handle,
+          .service = &service,
+          .characteristic = nullptr,
+          .descriptor = nullptr,
+          .included_service = &is,
+      });
+    }
+  }
+
+  std::sort(handle_index.begin(), handle_index.end());
+}
+
+const DatabaseAttribute* Database::FindAttribute(uint16_t handle) const {
+  if (handle_index.empty() || handle < handle_index.front().first)
+    return nullptr;
+
+  // Discovered attributes usually have consecutive handles, so the handle is
+  // normally found right at its offset
+  size_t offset = handle - handle_index.front().first;
+  if (offset < handle_index.size() && handle_index[offset].first == handle)
+    return &attributes[handle_index[offset].second];
+
+  auto it = std::lower_bound(handle_index.begin(), handle_index.end(),
+                             std::make_pair(handle, size_t{0}));
+  if (it == handle_index.end() || it->first != handle) return nullptr;
+  return &attributes[it->second];
+}
+
+std::pair<size_t, size_t> Database::ServicesAttributes(
+    uint16_t start_handle, uint16_t end_handle) const {
+  auto it = std::lower_bound(service_index.begin(), service_index.end(),
+                             start_handle,
+                             [this](size_t position, uint16_t handle) {
+                               return attributes[position].handle < handle;
+                             });
+  size_t begin = (it == service_index.end()) ? attributes.size() : *it;
+
+  for (; it != service_index.end(); it++) {
+    if (attributes[*it].service->end_handle > end_handle) break;
+  }
+  size_t end = (it == service_index.end()) ? attributes.size() : *it;
+
+  return std::make_pair(begin, end);
+}
+
+const Service* Database::FindService(uint16_t handle) const {
+  auto it = std::upper_bound(service_index.begin(), service_index.end(),
+                             handle, [this](uint16_t handle, size_t position) {
+                               return handle < attributes[position].handle;
+                             });
+  if (it == service_index.begin()) return nullptr;
+
+  const Service* service = attributes[*std::prev(it)].service;
+  return HandleInRange(*service, handle) ? service : nullptr;
+}
+
+const Characteristic* Database::FindCharacteristic(
+    uint16_t value_handle) const {
+  const DatabaseAttribute* attr = FindAttribute(value_handle);
+  if (!attr || attr->type != DatabaseAttribute::Type::CHARACTERISTIC ||
+      attr->handle != value_handle)
+    return nullptr;
+
+  return attr->characteristic;
+}
+
+const Descriptor* Database::FindDescriptor(uint16_t handle) const {
+  const DatabaseAttribute* attr = FindAttribute(handle);
+  if (!attr || attr->type != DatabaseAttribute::Type::DESCRIPTOR)
+    return nullptr;
+
+  return attr->descriptor;
+}
+
+const Characteristic* Database::FindOwningCharacteristic(
+    uint16_t handle) const {
+  const DatabaseAttribute* attr = FindAttribute(handle);
+  if (!attr || attr->type != DatabaseAttribute::Type::DESCRIPTOR)
+    return nullptr;
+
+  return attr->characteristic;
+}
+
 std::string Database::ToString() const {
   std::stringstream tmp;
 
@@ -137,13 +268,14 @@ std::vector<StoredAttribute> Database::Serialize() const {
   return nv_attr;
 }
 
-Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
+Database Database::Deserialize(const StoredAttribute* nv_attr, size_t count,
                                bool* success) {
   // clear reallocating
   Database result;
-  auto it = nv_attr.cbegin();
+  const StoredAttribute* it = nv_attr;
+  const StoredAttribute* end = nv_attr + count;
 
-  for (; it != nv_attr.cend(); ++it) {
+  for (; it != end; ++it) {
     const auto& attr = *it;
     if (attr.type != PRIMARY_SERVICE && attr.type != SECONDARY_SERVICE) break;
     result.services.emplace_back(Service{
@@ -157,7 +289,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
   }
 
   auto current_service_it = result.services.begin();
-  for (; it != nv_attr.cend(); it++) {
+  for (; it != end; it++) {
     const auto& attr = *it;
 
     // go to the service this attribute belongs to; attributes are stored in
@@ -172,15 +304,18 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
       LOG(ERROR) << "Can't find service for attribute with handle: "
                  << loghex(attr.handle);
       *success = false;
+      result.BuildIndex();
       return result;
     }
 
     if (attr.type == INCLUDE) {
       Service* included_service =
-          FindService(result.services, attr.value.included_service.handle);
+          gatt::FindService(result.services,
+                            attr.value.included_service.handle);
       if (!included_service) {
         LOG(ERROR) << __func__ << ": Non-existing included service!";
         *success = false;
+        result.BuildIndex();
         return result;
       }
       current_service_it->included_services.push_back(IncludedService{
@@ -217,6 +352,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
     }
   }
   *success = true;
+  result.BuildIndex();
   return result;
 }
 
@@ -20,6 +20,7 @@
 
 #include <list>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "stack/include/bt_octets.h"
@@ -100,26 +101,93 @@ struct Descriptor {
   uint16_t characteristic_extended_properties;
 };
 
+/* Element of the flat view of a database: each service is followed by its
+ * characteristics, each with its descriptors, and then by its included
+ * services. */
+struct DatabaseAttribute {
+  enum class Type : uint8_t {
+    SERVICE,
+    CHARACTERISTIC,
+    DESCRIPTOR,
+    INCLUDED_SERVICE,
+  };
+
+  Type type;
+  /* declaration handle of a service, value handle of a characteristic */
+  uint16_t handle;
+  const Service* service;
+  /* also set for the descriptors of the characteristic */
+  const Characteristic* characteristic;
+  const Descriptor* descriptor;
+  const IncludedService* included_service;
+};
+
 class DatabaseBuilder;
 
 class Database {
  public:
+  Database() = default;
+  /* The flat view points into the services, so it is built again for copies */
+  Database(const Database& other) : services(other.services) { BuildIndex(); }
+  Database& operator=(const Database& other) {
+    if (this != &other) {
+      services = other.services;
+      BuildIndex();
+    }
+    return *this;
+  }
+  Database(Database&&) = default;
+  Database& operator=(Database&&) = default;
+
   /* Return true if there are no services in this database. */
   bool IsEmpty() const { return services.empty(); }
 
   /* Clear the GATT database. This method forces relocation to ensure no extra
    * space is used unnecesarly */
-  void Clear() { std::list<Service>().swap(services); }
+  void Clear() {
+    std::list<Service>().swap(services);
+    BuildIndex();
+  }
 
   /* Return list of services available in this database */
   const std::list<Service>& Services() const { return services; }
 
+  /* Return the flat view of the services available in this database */
+  const std::vector<DatabaseAttribute>& Attributes() const {
+    return attributes;
+  }
+
+  /* Return the range of Attributes() holding the services from the first one
+   * starting at or after |start_handle|, up to the first one ending after
+   * |end_handle|. */
+  std::pair<size_t, size_t> ServicesAttributes(uint16_t start_handle,
+                                               uint16_t end_handle) const;
+
+  /* Return the service owning |handle|, or nullptr */
+  const Service* FindService(uint16_t handle) const;
+
+  /* Return the characteristic with the |value_handle|, or nullptr */
+  const Characteristic* FindCharacteristic(uint16_t value_handle) const;
+
+  /* Return the descriptor with the |handle|, or nullptr */
+  const Descriptor* FindDescriptor(uint16_t handle) const;
+
+  /* Return the characteristic owning the descriptor with the |handle|, or
+   * nullptr */
+  const Characteristic* FindOwningCharacteristic(uint16_t handle) const;
+
   std::string ToString() const;
 
   std::vector<gatt::StoredAttribute> Serialize() const;
 
   static Database Deserialize(const std::vector<gatt::StoredAttribute>& nv_attr,
-                              bool* success);
+                              bool* success) {
+    return Deserialize(nv_attr.data(), nv_attr.size(), success);
+  }
+
+  /* Deserialize |count| attributes read in place, i.e. from a mapped file */
+  static Database Deserialize(const gatt::StoredAttribute* nv_attr,
+                              size_t count, bool* success);
 
   /* Return 128 bit unique identifier of this GATT database */
   Octet16 Hash() const;
@@ -127,7 +195,21 @@ class Database {
   friend class DatabaseBuilder;
 
  private:
+  /* Build the flat view of the database from the services */
+  void BuildIndex();
+
+  /* Return the element of Attributes() with the |handle|, or nullptr. A
+   * characteristic is also found by its declaration handle. */
+  const DatabaseAttribute* FindAttribute(uint16_t handle) const;
+
   std::list<Service> services;
+
+  std::vector<DatabaseAttribute> attributes;
+  /* handle of each attribute, with its position in attributes, in handle
+   * order */
+  std::vector<std::pair<uint16_t, size_t>> handle_index;
+  /* position in attributes of each service, in handle order */
+  std::vector<size_t> service_index;
 };
 
 /* Find a service that should contain handle. Helper method for internal use
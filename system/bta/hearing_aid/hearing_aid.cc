@@ -263,6 +263,8 @@ class HearingAidImpl : public HearingAid {
       "persist.bluetooth.hearing_aid_min_ce_len";
   const std::string PERSIST_MAX_CE_LEN_NAME =
       "persist.bluetooth.hearing_aid_max_ce_len";
+  // Never delay a new frame behind the ones still queued in the L2CAP channel
+  bool low_latency_mode = false;
   // Record whether the connection parameter needs to update to a better one
   bool needs_parameter_update = false;
   std::chrono::time_point<std::chrono::steady_clock> last_drop_time_point =
@@ -304,6 +306,9 @@ class HearingAidImpl : public HearingAid {
     if (overwrite_max_ce_len != -1) {
       LOG_INFO("Overwrites MAX_CE_LEN=%d", overwrite_max_ce_len);
     }
+    low_latency_mode = osi_property_get_bool(
+        "bluetooth.hearing_aid.low_latency.enabled", false);
+    LOG_INFO("low_latency_mode=%d", low_latency_mode);
 
     BTA_GATTC_AppRegister(
         hearingaid_gattc_callback,
@@ -1153,6 +1158,7 @@ class HearingAidImpl : public HearingAid {
       }
       codec.bit_rate = 16;
       codec.data_interval_ms = default_data_interval_ms;
+      codec.low_latency = low_latency_mode;
 
       uint16_t delay_report_ms = 0;
       if (hearingDevice.render_delay != 0) {
@@ -1413,7 +1419,7 @@ class HearingAidImpl : public HearingAid {
     }
 
     uint16_t l2cap_flush_threshold = 0;
-    if (IS_FLAG_ENABLED(higher_l2cap_flush_threshold)) {
+    if (IS_FLAG_ENABLED(higher_l2cap_flush_threshold) && !low_latency_mode) {
       l2cap_flush_threshold = 1;
     }
 
@@ -1440,7 +1446,11 @@ class HearingAidImpl : public HearingAid {
       if (packets_in_chans > l2cap_flush_threshold) {
         // Compare the two sides LE CoC credit value to confirm need to drop or
         // skip audio packet.
-        if (NeedToDropPacket(left, right) && IsBelowDropFrequency(time_point)) {
+        // In low latency mode, the packets still queued are flushed rather
+        // than the new frame dropped, the sequence numbers of the frames sent
+        // telling the hearing aids what was skipped.
+        if (!low_latency_mode && NeedToDropPacket(left, right) &&
+            IsBelowDropFrequency(time_point)) {
           LOG_INFO("%s triggers dropping, %u packets in channel",
                    ADDRESS_TO_LOGGABLE_CSTR(left->address),
                    packets_in_chans);
@@ -1474,7 +1484,8 @@ class HearingAidImpl : public HearingAid {
       if (packets_in_chans > l2cap_flush_threshold) {
         // Compare the two sides LE CoC credit value to confirm need to drop or
         // skip audio packet.
-        if (NeedToDropPacket(right, left) && IsBelowDropFrequency(time_point)) {
+        if (!low_latency_mode && NeedToDropPacket(right, left) &&
+            IsBelowDropFrequency(time_point)) {
           LOG_INFO("%s triggers dropping, %u packets in channel",
                    ADDRESS_TO_LOGGABLE_CSTR(right->address),
                    packets_in_chans);
@@ -63,6 +63,10 @@ int bit_rate = -1;
 int sample_rate = -1;
 int data_interval_ms = -1;
 int num_channels = 2;
+bool low_latency = false;
+// In low latency mode, audio buffered in the audio HAL beyond this many data
+// intervals, on top of the one being read, is dropped
+constexpr uint32_t kLowLatencyMaxBufferedIntervals = 1;
 bluetooth::common::RepeatingTimer audio_timer;
 HearingAidAudioReceiver* localAudioReceiver = nullptr;
 std::unique_ptr<tUIPC_STATE> uipc_hearing_aid = nullptr;
@@ -71,6 +75,8 @@ struct AudioHalStats {
   size_t media_read_total_underflow_bytes;
   size_t media_read_total_underflow_count;
   uint64_t media_read_last_underflow_us;
+  size_t media_read_total_dropped_bytes;
+  size_t media_read_total_dropped_count;
 
   AudioHalStats() { Reset(); }
 
@@ -78,6 +84,8 @@ struct AudioHalStats {
     media_read_total_underflow_bytes = 0;
     media_read_total_underflow_count = 0;
     media_read_last_underflow_us = 0;
+    media_read_total_dropped_bytes = 0;
+    media_read_total_dropped_count = 0;
   }
 };
 
@@ -92,6 +100,22 @@ void send_audio_data() {
 
   uint8_t p_buf[bytes_per_tick];
 
+  // Catch up with the audio HAL by dropping the oldest whole intervals, which
+  // keeps the samples of both channels aligned
+  if (low_latency && bluetooth::audio::hearing_aid::is_hal_enabled()) {
+    size_t max_buffered_bytes =
+        bytes_per_tick * (1 + kLowLatencyMaxBufferedIntervals);
+    size_t available = bluetooth::audio::hearing_aid::available_to_read();
+    if (available > max_buffered_bytes) {
+      size_t drop_intervals = (available - max_buffered_bytes) / bytes_per_tick;
+      for (size_t i = 0; i < drop_intervals; i++) {
+        stats.media_read_total_dropped_bytes +=
+            bluetooth::audio::hearing_aid::read(p_buf, bytes_per_tick);
+      }
+      if (drop_intervals > 0) stats.media_read_total_dropped_count++;
+    }
+  }
+
   uint32_t bytes_read;
   if (bluetooth::audio::hearing_aid::is_hal_enabled()) {
     bytes_read = bluetooth::audio::hearing_aid::read(p_buf, bytes_per_tick);
@@ -127,7 +151,7 @@ void start_audio_ticks() {
     LOG_ALWAYS_FATAL("Unsupported data interval: %d", data_interval_ms);
   }
 
-  wakelock_acquire();
+  wakelock_acquire_for("hearing_aid");
   audio_timer.SchedulePeriodic(
       get_main_thread()->GetWeakPtr(), FROM_HERE, base::Bind(&send_audio_data),
 #if BASE_VER < 931007
@@ -141,7 +165,7 @@ void start_audio_ticks() {
 void stop_audio_ticks() {
   LOG_INFO("stopped");
   audio_timer.CancelAndWait();
-  wakelock_release();
+  wakelock_release_for("hearing_aid");
 }
 
 void hearing_aid_data_cb(tUIPC_CH_ID, tUIPC_EVENT event) {
@@ -389,6 +413,7 @@ void HearingAidAudioSource::Start(const CodecConfiguration& codecConfiguration,
   bit_rate = codecConfiguration.bit_rate;
   sample_rate = codecConfiguration.sample_rate;
   data_interval_ms = codecConfiguration.data_interval_ms;
+  low_latency = codecConfiguration.low_latency;
 
   stats.Reset();
 
@@ -445,6 +470,12 @@ void HearingAidAudioSource::DebugDump(int fd) {
                                         stats.media_read_last_underflow_us) /
                        1000
                  : 0)
+         << "\n    Low latency mode                                        : "
+         << (low_latency ? "enabled" : "disabled")
+         << "\n    Counts (dropped to catch up)                            : "
+         << stats.media_read_total_dropped_count
+         << "\n    Bytes (dropped to catch up)                             : "
+         << stats.media_read_total_dropped_bytes
          << std::endl;
   dprintf(fd, "%s", stream.str().c_str());
 }
@@ -32,6 +32,7 @@
 #include "bta/include/bta_hh_co.h"
 #include "bta/sys/bta_sys.h"
 #include "btif/include/btif_storage.h"
+#include "common/time_util.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/osi.h"  // UNUSED_ATTR
@@ -628,6 +629,8 @@ void bta_hh_open_cmpl_act(tBTA_HH_DEV_CB* p_cb, const tBTA_HH_DATA* p_data) {
   conn.attr_mask = p_cb->attr_mask;
   conn.app_id = p_cb->app_id;
 
+  p_cb->rpt_stats = {};
+
   BTM_LogHistory(kBtmLogTag, p_cb->addr, "Opened",
                  base::StringPrintf(
                      "%s initiator:%s", (p_cb->is_le_device) ? "le" : "classic",
@@ -714,6 +717,9 @@ void bta_hh_data_act(tBTA_HH_DEV_CB* p_cb, const tBTA_HH_DATA* p_data) {
                  pdata->len, p_cb->mode, p_cb->sub_class,
                  p_cb->dscp_info.ctry_code, p_cb->addr, p_cb->app_id);
 
+  bta_hh_update_rpt_stats(&p_cb->rpt_stats, p_data->hid_cback.rx_timestamp_us,
+                          bluetooth::common::time_get_os_boottime_us());
+
   osi_free_and_reset((void**)&pdata);
 }
 
@@ -1178,6 +1184,45 @@ void bta_hh_write_dev_act(tBTA_HH_DEV_CB* p_cb, const tBTA_HH_DATA* p_data) {
 /*****************************************************************************
  *  Static Function
  ****************************************************************************/
+/*******************************************************************************
+ *
+ * Function         bta_hh_input_rpt_fast_path
+ *
+ * Description      Deliver an input report of a connected device right away,
+ *                  instead of posting it to the BTA event queue. In the
+ *                  connected state the report is handed over to the HID
+ *                  driver without any state change, so it does not have to
+ *                  wait behind the pending events. The HID callback already
+ *                  runs in the main thread.
+ *
+ * Returns          true if the report was delivered, false if it has to go
+ *                  through the state machine.
+ *
+ ******************************************************************************/
+static bool bta_hh_input_rpt_fast_path(uint8_t dev_handle,
+                                       const RawAddress& addr, uint32_t data,
+                                       BT_HDR* pdata,
+                                       uint64_t rx_timestamp_us) {
+  uint8_t index = bta_hh_dev_handle_to_cb_idx(dev_handle);
+  if (index >= BTA_HH_MAX_DEVICE) return false;
+
+  tBTA_HH_DEV_CB* p_cb = &bta_hh_cb.kdev[index];
+  if (!p_cb->in_use || p_cb->is_le_device || p_cb->state != BTA_HH_CONN_ST ||
+      p_cb->hid_handle != dev_handle || pdata == nullptr) {
+    return false;
+  }
+
+  tBTA_HH_DATA hh_data;
+  hh_data.hid_cback.hdr.event = BTA_HH_INT_DATA_EVT;
+  hh_data.hid_cback.hdr.layer_specific = (uint16_t)dev_handle;
+  hh_data.hid_cback.data = data;
+  hh_data.hid_cback.addr = addr;
+  hh_data.hid_cback.p_data = pdata;
+  hh_data.hid_cback.rx_timestamp_us = rx_timestamp_us;
+  bta_hh_data_act(p_cb, &hh_data);
+  return true;
+}
+
 /*******************************************************************************
  *
  * Function         bta_hh_cback
@@ -1192,6 +1237,7 @@ static void bta_hh_cback(uint8_t dev_handle, const RawAddress& addr,
                          uint8_t event, uint32_t data, BT_HDR* pdata) {
   uint16_t sm_event = BTA_HH_INVALID_EVT;
   uint8_t xx = 0;
+  uint64_t rx_timestamp_us = bluetooth::common::time_get_os_boottime_us();
 
   LOG_VERBOSE("%s::HID_event [%s]", __func__, bta_hh_hid_event_name(event));
 
@@ -1203,6 +1249,10 @@ static void bta_hh_cback(uint8_t dev_handle, const RawAddress& addr,
       sm_event = BTA_HH_INT_CLOSE_EVT;
       break;
     case HID_HDEV_EVT_INTR_DATA:
+      if (bta_hh_input_rpt_fast_path(dev_handle, addr, data, pdata,
+                                     rx_timestamp_us)) {
+        return;
+      }
       sm_event = BTA_HH_INT_DATA_EVT;
       break;
     case HID_HDEV_EVT_HANDSHAKE:
@@ -1236,6 +1286,7 @@ static void bta_hh_cback(uint8_t dev_handle, const RawAddress& addr,
     p_buf->data = data;
     p_buf->addr = addr;
     p_buf->p_data = pdata;
+    p_buf->rx_timestamp_us = rx_timestamp_us;
 
     bta_sys_sendmsg(p_buf);
   }
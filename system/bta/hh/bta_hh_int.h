@@ -26,6 +26,7 @@
 #define BTA_HH_INT_H
 
 #include <cstdint>
+#include <string>
 
 #include "bta/include/bta_api.h"
 #include "bta/include/bta_gatt_api.h"
@@ -92,6 +93,7 @@ typedef struct {
   RawAddress addr;
   uint32_t data;
   BT_HDR* p_data;
+  uint64_t rx_timestamp_us; /* time the HID callback was called */
 } tBTA_HH_CBACK_DATA;
 
 typedef struct {
@@ -178,6 +180,24 @@ typedef struct {
 #define BTA_HH_IS_LE_DEV_HDL(x) ((x)&0xf0)
 #define BTA_HH_IS_LE_DEV_HDL_VALID(x) (((x) >> 4) <= BTA_HH_LE_MAX_KNOWN)
 
+/* Number of buckets of the input report histograms; the bucket bounds are
+ * kBtaHhRptHistBoundsUs, the last bucket counts the samples above them */
+#define BTA_HH_RPT_HIST_NUM_BUCKETS 8
+
+typedef struct {
+  uint64_t count;
+  uint64_t sum_us;
+  uint32_t max_us;
+  uint32_t buckets[BTA_HH_RPT_HIST_NUM_BUCKETS];
+} tBTA_HH_RPT_HIST;
+
+/* input report statistics of a connection */
+typedef struct {
+  tBTA_HH_RPT_HIST latency;  /* HID callback to report written to UHID */
+  tBTA_HH_RPT_HIST interval; /* between two consecutive input reports */
+  uint64_t last_rpt_us;      /* time of the last input report */
+} tBTA_HH_RPT_STATS;
+
 /* device control block */
 typedef struct {
   tBTA_HH_DEV_DSCP_INFO dscp_info; /* report descriptor and DI information */
@@ -218,6 +238,7 @@ typedef struct {
 #define BTA_HH_LE_SCPS_NOTIFY_ENB 0x02
   uint8_t scps_notify; /* scan refresh supported/notification enabled */
   bool security_pending;
+  tBTA_HH_RPT_STATS rpt_stats; /* reset when the connection opens */
 } tBTA_HH_DEV_CB;
 
 /******************************************************************************
@@ -282,6 +303,9 @@ void bta_hh_update_di_info(tBTA_HH_DEV_CB* p_cb, uint16_t vendor_id,
 void bta_hh_cleanup_disable(tBTA_HH_STATUS status);
 
 uint8_t bta_hh_dev_handle_to_cb_idx(uint8_t dev_handle);
+void bta_hh_update_rpt_stats(tBTA_HH_RPT_STATS* p_stats,
+                             uint64_t rx_timestamp_us, uint64_t now_us);
+std::string bta_hh_rpt_hist_text(const tBTA_HH_RPT_HIST& hist);
 
 /* action functions used outside state machine */
 void bta_hh_api_enable(tBTA_HH_CBACK* p_cback, bool enable_hid,
@@ -28,14 +28,33 @@
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/hh/bta_hh_int.h"
+#include "main/shim/dumpsys.h"
 #include "osi/include/allocator.h"
 #include "stack/include/bt_hdr.h"
+#include "types/raw_address.h"
 
 /*****************************************************************************
  * Global data
  ****************************************************************************/
 tBTA_HH_CB bta_hh_cb;
 
+#define DUMPSYS_TAG "shim::legacy::bta::hh"
+void DumpsysBtaHh(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  for (size_t i = 0; i < BTA_HH_MAX_DEVICE; i++) {
+    const tBTA_HH_DEV_CB& cb = bta_hh_cb.kdev[i];
+    if (!cb.in_use || cb.state != BTA_HH_CONN_ST) continue;
+    LOG_DUMPSYS(fd, "  %zu: addr:%s handle:%hhu le:%s", i,
+                ADDRESS_TO_LOGGABLE_CSTR(cb.addr), cb.hid_handle,
+                cb.is_le_device ? "T" : "F");
+    LOG_DUMPSYS(fd, "    input report latency (us) %s",
+                bta_hh_rpt_hist_text(cb.rpt_stats.latency).c_str());
+    LOG_DUMPSYS(fd, "    input report interval (us) %s",
+                bta_hh_rpt_hist_text(cb.rpt_stats.interval).c_str());
+  }
+}
+#undef DUMPSYS_TAG
+
 /*****************************************************************************
  * Static functions
  ****************************************************************************/
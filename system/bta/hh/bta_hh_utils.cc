@@ -357,6 +357,64 @@ uint8_t bta_hh_dev_handle_to_cb_idx(uint8_t dev_handle) {
 
   return index;
 }
+
+/* Exclusive upper bounds of the buckets of the input report histograms */
+constexpr uint32_t kBtaHhRptHistBoundsUs[BTA_HH_RPT_HIST_NUM_BUCKETS - 1] = {
+    250, 500, 1000, 2000, 4000, 8000, 16000};
+
+static void bta_hh_rpt_hist_update(tBTA_HH_RPT_HIST* p_hist, uint32_t us) {
+  size_t i = 0;
+  while (i < BTA_HH_RPT_HIST_NUM_BUCKETS - 1 && us >= kBtaHhRptHistBoundsUs[i])
+    i++;
+  p_hist->buckets[i]++;
+  p_hist->count++;
+  p_hist->sum_us += us;
+  if (us > p_hist->max_us) p_hist->max_us = us;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_hh_update_rpt_stats
+ *
+ * Description      Account an input report that was written to UHID at
+ *                  now_us, after its HID callback at rx_timestamp_us.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_hh_update_rpt_stats(tBTA_HH_RPT_STATS* p_stats,
+                             uint64_t rx_timestamp_us, uint64_t now_us) {
+  if (rx_timestamp_us == 0 || now_us < rx_timestamp_us) return;
+
+  bta_hh_rpt_hist_update(&p_stats->latency, now_us - rx_timestamp_us);
+  if (p_stats->last_rpt_us != 0 && rx_timestamp_us >= p_stats->last_rpt_us) {
+    bta_hh_rpt_hist_update(&p_stats->interval,
+                           rx_timestamp_us - p_stats->last_rpt_us);
+  }
+  p_stats->last_rpt_us = rx_timestamp_us;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_hh_rpt_hist_text
+ *
+ * Description      Format a report histogram as
+ *                  count:<n> mean:<m> max:<x> histogram:<b0>/<b1>/...
+ *
+ * Returns          std::string
+ *
+ ******************************************************************************/
+std::string bta_hh_rpt_hist_text(const tBTA_HH_RPT_HIST& hist) {
+  std::string s =
+      "count:" + std::to_string(hist.count) +
+      " mean:" + std::to_string(hist.count ? hist.sum_us / hist.count : 0) +
+      " max:" + std::to_string(hist.max_us) + " histogram:";
+  for (size_t i = 0; i < BTA_HH_RPT_HIST_NUM_BUCKETS; i++) {
+    if (i) s += "/";
+    s += std::to_string(hist.buckets[i]);
+  }
+  return s;
+}
 #if (BTA_HH_DEBUG == TRUE)
 /*******************************************************************************
  *
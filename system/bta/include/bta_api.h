@@ -416,6 +416,16 @@ enum {
 #define BTA_DM_PM_HH_IDLE_DELAY 30000
 #endif
 
+/* Largest sniff interval allowed while a HID device is connected, or while
+ * SCO is open, whatever the traffic seen on the link */
+#ifndef BTA_DM_PM_HH_MAX_SNIFF_INTERVAL
+#define BTA_DM_PM_HH_MAX_SNIFF_INTERVAL BTA_DM_PM_SNIFF2_MAX
+#endif
+
+#ifndef BTA_DM_PM_SCO_MAX_SNIFF_INTERVAL
+#define BTA_DM_PM_SCO_MAX_SNIFF_INTERVAL BTA_DM_PM_SNIFF3_MAX
+#endif
+
 /* The Sniff Parameters defined below must be ordered from highest
  * latency (biggest interval) to lowest latency.  If there is a conflict
  * among the connected services the setting with the lowest latency will
@@ -968,5 +978,6 @@ void BTA_DmBleSubrateRequest(const RawAddress& bd_addr, uint16_t subrate_min,
 bool BTA_DmCheckLeAudioCapable(const RawAddress& address);
 
 void DumpsysBtaDm(int fd);
+void DumpsysBtaSys(int fd);
 
 #endif /* BTA_API_H */
@@ -71,6 +71,10 @@ class BtaGattQueue {
     /* write-specific fields */
     tGATT_WRITE_TYPE write_type;
     std::vector<uint8_t> value;
+
+    /* read that must not be merged into a Read Multiple Variable Length
+     * request, i.e. because such a request including it already failed */
+    bool single_read;
   };
 
  private:
@@ -88,8 +92,17 @@ class BtaGattQueue {
                                           tBTA_GATTC_MULTI& handle,
                                           uint16_t len, uint8_t* value,
                                           void* data);
+  static bool gatt_merge_reads(uint16_t conn_id,
+                               std::list<gatt_operation>& gatt_ops);
+  static void gatt_merged_read_op_finished(uint16_t conn_id,
+                                           tGATT_STATUS status,
+                                           tBTA_GATTC_MULTI& handles,
+                                           uint16_t len, uint8_t* value,
+                                           void* data);
   // maps connection id to operations waiting for execution
   static std::unordered_map<uint16_t, std::list<gatt_operation>> gatt_op_queue;
   // contain connection ids that currently execute operations
   static std::unordered_set<uint16_t> gatt_op_queue_executing;
+  // contain connection ids whose server rejected Read Multiple Variable Length
+  static std::unordered_set<uint16_t> gatt_read_multi_var_rejected;
 };
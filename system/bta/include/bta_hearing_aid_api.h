@@ -273,6 +273,11 @@ struct CodecConfiguration {
    * connection interval is integer.
    */
   uint16_t data_interval_ms;
+
+  /** In low latency mode, the audio buffered in the audio HAL and in the L2CAP
+   * channels is kept to one data interval: older audio is dropped instead of
+   * being sent late. */
+  bool low_latency = false;
 };
 
 /** Represents source of audio for hearing aids */
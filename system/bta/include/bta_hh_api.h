@@ -518,4 +518,16 @@ void BTA_HhAddDev(const RawAddress& bda, tBTA_HH_ATTR_MASK attr_mask,
  ******************************************************************************/
 void BTA_HhRemoveDev(uint8_t dev_handle);
 
+/*******************************************************************************
+ *
+ * Function         DumpsysBtaHh
+ *
+ * Description      Dump the input report statistics of the connected HID
+ *                  devices.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void DumpsysBtaHh(int fd);
+
 #endif /* BTA_HH_API_H */
@@ -511,6 +511,26 @@ void BTA_JvL2capConnect(int conn_type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
                         const RawAddress& peer_bd_addr,
                         tBTA_JV_L2CAP_CBACK* p_cback, uint32_t l2cap_socket_id);
 
+/*******************************************************************************
+ *
+ * Function         BTA_JvL2capConnectCreditBased
+ *
+ * Description      Initiate up to L2CAP_CREDIT_BASED_MAX_CIDS LE CoC client
+ *                  connections to the given BD Address with a single credit
+ *                  based connection request. The LE link must be up.
+ *                  tBTA_JV_L2CAP_CBACK is called with BTA_JV_L2CAP_CL_INIT_EVT
+ *                  for each channel being set up, in the order of the request,
+ *                  or once with a failure status if none is.
+ *                  Each channel then reports BTA_JV_L2CAP_OPEN_EVT or
+ *                  BTA_JV_L2CAP_CLOSE_EVT on its own.
+ *
+ ******************************************************************************/
+void BTA_JvL2capConnectCreditBased(tBTA_SEC sec_mask, uint16_t remote_psm,
+                                   uint16_t rx_mtu, uint8_t num_channels,
+                                   const RawAddress& peer_bd_addr,
+                                   tBTA_JV_L2CAP_CBACK* p_cback,
+                                   uint32_t l2cap_socket_id);
+
 /*******************************************************************************
  *
  * Function         BTA_JvL2capClose
@@ -573,6 +593,20 @@ tBTA_JV_STATUS BTA_JvL2capStopServer(uint16_t local_psm,
 tBTA_JV_STATUS BTA_JvL2capRead(uint32_t handle, uint32_t req_id,
                                uint8_t* p_data, uint16_t len);
 
+/*******************************************************************************
+ *
+ * Function         BTA_JvL2capReadBuf
+ *
+ * Description      This function dequeues the first SDU received on an L2CAP
+ *                  connection without copying it. The caller owns the
+ *                  returned buffer and must osi_free it.
+ *
+ * Returns          BTA_JV_SUCCESS, if an SDU is returned in *pp_buf.
+ *                  BTA_JV_FAILURE, otherwise.
+ *
+ ******************************************************************************/
+tBTA_JV_STATUS BTA_JvL2capReadBuf(uint32_t handle, BT_HDR** pp_buf);
+
 /*******************************************************************************
  *
  * Function         BTA_JvL2capReady
@@ -22,6 +22,7 @@
 #include <base/strings/stringprintf.h>
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "bt_target.h"  // Must be first to define build configuration
@@ -113,6 +114,19 @@ typedef union {
   tBTM_LE_PID_KEYS lid_key; /* local device ID key for the particular remote */
 } tBTA_LE_KEY_VALUE;
 
+/* A bonded device restored from the NVRAM, see BTA_DmAddBondedDevices */
+typedef struct {
+  RawAddress bd_addr;
+  bool link_key_known; /* add the device with its link key */
+  LinkKey link_key;
+  uint8_t key_type;
+  DEV_CLASS dev_class;
+  uint8_t pin_length;
+  tBLE_ADDR_TYPE addr_type;
+  /* add the device as a LE device with these keys, if any */
+  std::vector<std::pair<tBTM_LE_KEY_TYPE, tBTA_LE_KEY_VALUE>> ble_keys;
+} tBTA_DM_BONDED_DEVICE;
+
 #define BTA_BLE_LOCAL_KEY_TYPE_ID 1
 #define BTA_BLE_LOCAL_KEY_TYPE_ER 2
 typedef uint8_t tBTA_DM_BLE_LOCAL_KEY_MASK;
@@ -438,6 +452,22 @@ void BTA_DmAddBleDevice(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
 void BTA_DmAddBleKey(const RawAddress& bd_addr, tBTA_LE_KEY_VALUE* p_le_key,
                      tBTM_LE_KEY_TYPE key_type);
 
+/*******************************************************************************
+ *
+ * Function         BTA_DmAddBondedDevices
+ *
+ * Description      Add the bonded devices restored from the NVRAM to the
+ *                  security database, in a single call to the BTA task.
+ *                  Same as BTA_DmAddDevice, BTA_DmAddBleDevice and
+ *                  BTA_DmAddBleKey for each device.
+ *
+ * Parameters:      devices          - bonded devices with their keys.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_DmAddBondedDevices(std::vector<tBTA_DM_BONDED_DEVICE> devices);
+
 /*******************************************************************************
  *
  * Function         BTA_DmSetEncryption
@@ -28,6 +28,7 @@
 
 #include <cstdint>
 #include <unordered_set>
+#include <vector>
 
 #include "bta/include/bta_jv_co.h"
 #include "bta/include/bta_rfcomm_scn.h"
@@ -1028,6 +1029,53 @@ void bta_jv_l2cap_connect(int32_t type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
   }
 }
 
+/* makes several LE CoC client connections with one credit based request */
+void bta_jv_l2cap_connect_credit_based(tBTA_SEC sec_mask, uint16_t remote_psm,
+                                       uint16_t rx_mtu, uint8_t num_channels,
+                                       const RawAddress& peer_bd_addr,
+                                       tBTA_JV_L2CAP_CBACK* p_cback,
+                                       uint32_t l2cap_socket_id) {
+  tL2CAP_CFG_INFO cfg;
+  memset(&cfg, 0, sizeof(tL2CAP_CFG_INFO));
+  cfg.mtu_present = true;
+  cfg.mtu = rx_mtu;
+
+  std::vector<uint16_t> handles;
+  uint8_t sec_id = bta_jv_alloc_sec_id();
+  if (sec_id) {
+    uint16_t max_mps = 0xffff;  // Let GAP set the max_mps.
+    handles = GAP_ConnOpenCreditBased("", sec_id, peer_bd_addr, remote_psm,
+                                      max_mps, &cfg, sec_mask,
+                                      bta_jv_l2cap_client_cback, num_channels);
+  }
+
+  tBTA_JV bta_jv;
+  if (handles.empty()) {
+    bta_jv_free_sec_id(&sec_id);
+    bta_jv.l2c_cl_init.status = BTA_JV_FAILURE;
+    bta_jv.l2c_cl_init.handle = GAP_INVALID_HANDLE;
+    bta_jv.l2c_cl_init.sec_id = 0;
+    p_cback(BTA_JV_L2CAP_CL_INIT_EVT, &bta_jv, l2cap_socket_id);
+    return;
+  }
+
+  for (uint16_t handle : handles) {
+    tBTA_JV_L2C_CB* p_cb = &bta_jv_cb.l2c_cb[handle];
+    p_cb->handle = handle;
+    p_cb->p_cback = p_cback;
+    p_cb->l2cap_socket_id = l2cap_socket_id;
+    p_cb->psm = 0; /* not a server */
+    /* The security ID is released with the first channel */
+    p_cb->sec_id = (handle == handles.front()) ? sec_id : 0;
+    p_cb->state = BTA_JV_ST_CL_OPENING;
+
+    bta_jv.l2c_cl_init.status = BTA_JV_SUCCESS;
+    bta_jv.l2c_cl_init.handle = handle;
+    bta_jv.l2c_cl_init.sec_id = p_cb->sec_id;
+    p_cback(BTA_JV_L2CAP_CL_INIT_EVT, &bta_jv, l2cap_socket_id);
+  }
+}
+
 /** Close an L2CAP client connection */
 void bta_jv_l2cap_close(uint32_t handle, tBTA_JV_L2C_CB* p_cb) {
   tBTA_JV_L2CAP_CLOSE evt_data;
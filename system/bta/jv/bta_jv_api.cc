@@ -239,6 +239,31 @@ void BTA_JvL2capConnect(int conn_type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
                          base::Passed(&ertm_info), p_cback, l2cap_socket_id));
 }
 
+/*******************************************************************************
+ *
+ * Function         BTA_JvL2capConnectCreditBased
+ *
+ * Description      Initiate several LE CoC client connections to the given BD
+ *                  Address with a single credit based connection request.
+ *                  tBTA_JV_L2CAP_CBACK is called with BTA_JV_L2CAP_CL_INIT_EVT
+ *                  for each channel, then with BTA_JV_L2CAP_OPEN_EVT or
+ *                  BTA_JV_L2CAP_CLOSE_EVT when the channel is set up.
+ *
+ ******************************************************************************/
+void BTA_JvL2capConnectCreditBased(tBTA_SEC sec_mask, uint16_t remote_psm,
+                                   uint16_t rx_mtu, uint8_t num_channels,
+                                   const RawAddress& peer_bd_addr,
+                                   tBTA_JV_L2CAP_CBACK* p_cback,
+                                   uint32_t l2cap_socket_id) {
+  VLOG(2) << __func__;
+  CHECK(p_cback);
+
+  do_in_main_thread(FROM_HERE,
+                    Bind(&bta_jv_l2cap_connect_credit_based, sec_mask,
+                         remote_psm, rx_mtu, num_channels, peer_bd_addr,
+                         p_cback, l2cap_socket_id));
+}
+
 /*******************************************************************************
  *
  * Function         BTA_JvL2capClose
@@ -344,6 +369,30 @@ tBTA_JV_STATUS BTA_JvL2capRead(uint32_t handle, uint32_t req_id,
   return BTA_JV_SUCCESS;
 }
 
+/*******************************************************************************
+ *
+ * Function         BTA_JvL2capReadBuf
+ *
+ * Description      This function dequeues the first SDU received on an L2CAP
+ *                  connection and hands it over to the caller, which becomes
+ *                  responsible for freeing it. No data copy is made.
+ *
+ * Returns          BTA_JV_SUCCESS, if an SDU is returned in *pp_buf.
+ *                  BTA_JV_FAILURE, otherwise.
+ *
+ ******************************************************************************/
+tBTA_JV_STATUS BTA_JvL2capReadBuf(uint32_t handle, BT_HDR** pp_buf) {
+  VLOG(2) << __func__;
+
+  if (handle >= BTA_JV_MAX_L2C_CONN || !bta_jv_cb.l2c_cb[handle].p_cback)
+    return BTA_JV_FAILURE;
+
+  if (BT_PASS != GAP_ConnBTRead((uint16_t)handle, pp_buf))
+    return BTA_JV_FAILURE;
+
+  return BTA_JV_SUCCESS;
+}
+
 /*******************************************************************************
  *
  * Function         BTA_JvL2capReady
@@ -162,6 +162,11 @@ void bta_jv_l2cap_connect(int32_t type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
                           std::unique_ptr<tL2CAP_ERTM_INFO> ertm_info,
                           tBTA_JV_L2CAP_CBACK* p_cback,
                           uint32_t l2cap_socket_id);
+void bta_jv_l2cap_connect_credit_based(tBTA_SEC sec_mask, uint16_t remote_psm,
+                                       uint16_t rx_mtu, uint8_t num_channels,
+                                       const RawAddress& peer_bd_addr,
+                                       tBTA_JV_L2CAP_CBACK* p_cback,
+                                       uint32_t l2cap_socket_id);
 void bta_jv_l2cap_close(uint32_t handle, tBTA_JV_L2C_CB* p_cb);
 void bta_jv_l2cap_start_server(int32_t type, tBTA_SEC sec_mask,
                                tBTA_JV_ROLE role, uint16_t local_psm,
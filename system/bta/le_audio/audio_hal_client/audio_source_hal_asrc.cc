@@ -22,7 +22,6 @@
 #include <cmath>
 #include <utility>
 
-#include "asrc_tables.h"
 #include "gd/hal/nocp_iso_clocker.h"
 
 namespace le_audio {
@@ -217,204 +216,6 @@ class SourceAudioHalAsrc::ClockRecovery : ::bluetooth::hal::NocpIsoHandler {
   }
 };
 
-class SourceAudioHalAsrc::Resampler {
-  static const int KERNEL_Q = asrc::ResamplerTables::KERNEL_Q;
-  static const int KERNEL_A = asrc::ResamplerTables::KERNEL_A;
-
-  const int32_t (*h_)[2 * KERNEL_A];
-  const int16_t (*d_)[2 * KERNEL_A];
-
-  static const unsigned WSIZE = 64;
-
-  int32_t win_[2][WSIZE];
-  unsigned out_pos_, in_pos_;
-  const int32_t pcm_min_, pcm_max_;
-
-  // Apply the transfer coefficients `h`, corrected by linear interpolation,
-  // given fraction position `mu` weigthed by `d` values.
-
-  inline int32_t Filter(const int32_t* in, const int32_t* h, int16_t mu,
-                        const int16_t* d);
-
-  // Upsampling loop, the ratio is less than 1.0 in Q26 format,
-  // more output samples are produced compared to input.
-
-  template <typename T>
-  __attribute__((no_sanitize("integer"))) void Upsample(
-      unsigned ratio, const T* in, int in_stride, size_t in_len,
-      size_t* in_count, T* out, int out_stride, size_t out_len,
-      size_t* out_count) {
-    int nin = in_len, nout = out_len;
-
-    while (nin > 0 && nout > 0) {
-      unsigned idx = (in_pos_ >> 26);
-      unsigned phy = (in_pos_ >> 17) & 0x1ff;
-      int16_t mu = (in_pos_ >> 2) & 0x7fff;
-
-      unsigned wbuf = idx < WSIZE / 2 || idx >= WSIZE + WSIZE / 2;
-      auto w = win_[wbuf] + ((idx + wbuf * WSIZE / 2) % WSIZE) - WSIZE / 2;
-
-      *out = Filter(w, h_[phy], mu, d_[phy]);
-      out += out_stride;
-      nout--;
-      in_pos_ += ratio;
-
-      if (in_pos_ - (out_pos_ << 26) >= (1u << 26)) {
-        win_[0][(out_pos_ + WSIZE / 2) % WSIZE] = win_[1][(out_pos_)] = *in;
-
-        in += in_stride;
-        nin--;
-        out_pos_ = (out_pos_ + 1) % WSIZE;
-      }
-    }
-
-    *in_count = in_len - nin;
-    *out_count = out_len - nout;
-  }
-
-  // Downsample loop, the ratio is greater than 1.0 in Q26 format,
-  // less output samples are produced compared to input.
-
-  template <typename T>
-  __attribute__((no_sanitize("integer"))) void Downsample(
-      unsigned ratio, const T* in, int in_stride, size_t in_len,
-      size_t* in_count, T* out, int out_stride, size_t out_len,
-      size_t* out_count) {
-    size_t nin = in_len, nout = out_len;
-
-    while (nin > 0 && nout > 0) {
-      if (in_pos_ - (out_pos_ << 26) < (1u << 26)) {
-        unsigned idx = (in_pos_ >> 26);
-        unsigned phy = (in_pos_ >> 17) & 0x1ff;
-        int16_t mu = (in_pos_ >> 2) & 0x7fff;
-
-        unsigned wbuf = idx < WSIZE / 2 || idx >= WSIZE + WSIZE / 2;
-        auto w = win_[wbuf] + ((idx + wbuf * WSIZE / 2) % WSIZE) - WSIZE / 2;
-
-        *out = Filter(w, h_[phy], mu, d_[phy]);
-        out += out_stride;
-        nout--;
-        in_pos_ += ratio;
-      }
-
-      win_[0][(out_pos_ + WSIZE / 2) % WSIZE] = win_[1][(out_pos_)] = *in;
-
-      in += in_stride;
-      nin--;
-      out_pos_ = (out_pos_ + 1) % WSIZE;
-    }
-
-    *in_count = in_len - nin;
-    *out_count = out_len - nout;
-  }
-
- public:
-  Resampler(int bit_depth)
-      : h_(asrc::resampler_tables.h),
-        d_(asrc::resampler_tables.d),
-        win_{{0}, {0}},
-        out_pos_(0),
-        in_pos_(0),
-        pcm_min_(-(int32_t(1) << (bit_depth - 1))),
-        pcm_max_((int32_t(1) << (bit_depth - 1)) - 1) {}
-
-  // Resample from `in` buffer to `out` buffer, until the end of any of
-  // the two buffers. `in_count` returns the number of consumed samples,
-  // and `out_count` the number produced. `in_sub` returns the phase in
-  // the input stream, in Q26 format.
-
-  template <typename T>
-  void Resample(unsigned ratio_q26, const T* in, int in_stride, size_t in_len,
-                size_t* in_count, T* out, int out_stride, size_t out_len,
-                size_t* out_count, unsigned* in_sub_q26) {
-    auto fn = ratio_q26 < (1u << 26) ? &Resampler::Upsample<T>
-                                     : &Resampler::Downsample<T>;
-
-    (this->*fn)(ratio_q26, in, in_stride, in_len, in_count, out, out_stride,
-                out_len, out_count);
-
-    *in_sub_q26 = in_pos_ & ((1u << 26) - 1);
-  }
-};
-
-//
-// ARM AArch 64 Neon Resampler Filtering
-//
-
-#if __ARM_NEON && __ARM_ARCH_ISA_A64
-
-#include <arm_neon.h>
-
-static inline int32x4_t vmull_low_s16(int16x8_t a, int16x8_t b) {
-  return vmull_s16(vget_low_s16(a), vget_low_s16(b));
-}
-
-static inline int64x2_t vmull_low_s32(int32x4_t a, int32x4_t b) {
-  return vmull_s32(vget_low_s32(a), vget_low_s32(b));
-}
-
-static inline int64x2_t vmlal_low_s32(int64x2_t r, int32x4_t a, int32x4_t b) {
-  return vmlal_s32(r, vget_low_s32(a), vget_low_s32(b));
-}
-
-inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x,
-                                                     const int32_t* h,
-                                                     int16_t _mu,
-                                                     const int16_t* d) {
-  int64x2_t sx;
-
-  int16x8_t mu = vdupq_n_s16(_mu);
-
-  int16x8_t d0 = vld1q_s16(d + 0);
-  int32x4_t h0 = vld1q_s32(h + 0), h4 = vld1q_s32(h + 4);
-  int32x4_t x0 = vld1q_s32(x + 0), x4 = vld1q_s32(x + 4);
-
-  h0 = vaddq_s32(h0, vrshrq_n_s32(vmull_low_s16(d0, mu), 7));
-  h4 = vaddq_s32(h4, vrshrq_n_s32(vmull_high_s16(d0, mu), 7));
-
-  sx = vmull_low_s32(x0, h0);
-  sx = vmlal_high_s32(sx, x0, h0);
-  sx = vmlal_low_s32(sx, x4, h4);
-  sx = vmlal_high_s32(sx, x4, h4);
-
-  for (int i = 8; i < 32; i += 8) {
-    int16x8_t d8 = vld1q_s16(d + i);
-    int32x4_t h8 = vld1q_s32(h + i), h12 = vld1q_s32(h + i + 4);
-    int32x4_t x8 = vld1q_s32(x + i), x12 = vld1q_s32(x + i + 4);
-
-    h8 = vaddq_s32(h8, vrshrq_n_s32(vmull_low_s16(d8, mu), 7));
-    h12 = vaddq_s32(h12, vrshrq_n_s32(vmull_high_s16(d8, mu), 7));
-
-    sx = vmlal_low_s32(sx, x8, h8);
-    sx = vmlal_high_s32(sx, x8, h8);
-    sx = vmlal_low_s32(sx, x12, h12);
-    sx = vmlal_high_s32(sx, x12, h12);
-  }
-
-  int64_t s = (vaddvq_s64(sx) + (1 << 30)) >> 31;
-  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
-}
-
-//
-// Generic Resampler Filtering
-//
-
-#else
-
-inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* in,
-                                                     const int32_t* h,
-                                                     int16_t mu,
-                                                     const int16_t* d) {
-  int64_t s = 0;
-  for (int i = 0; i < 2 * KERNEL_A - 1; i++)
-    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
-
-  s = (s + (1 << 30)) >> 31;
-  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
-}
-
-#endif
-
 SourceAudioHalAsrc::SourceAudioHalAsrc(int channels, int sample_rate,
                                        int bit_depth, int interval_us,
                                        int num_burst_buffers,
@@ -458,7 +259,9 @@ SourceAudioHalAsrc::SourceAudioHalAsrc(int channels, int sample_rate,
   // when the PCM bit_depth is higher than 16 bits.
 
   clock_recovery_ = std::make_unique<ClockRecovery>(interval_us_);
-  resamplers_ = std::make_unique<std::vector<Resampler>>(channels, bit_depth_);
+  resamplers_ =
+      std::make_unique<std::vector<::bluetooth::audio::asrc::Resampler>>(
+          channels, bit_depth_);
 
   // Deduct from the PCM stream characteristics, the size of the pool buffers
   // It needs 3 buffers (one almost full, an entire one, and a last which can be
@@ -557,21 +360,23 @@ __attribute__((no_sanitize("integer"))) void SourceAudioHalAsrc::Resample(
                         (int64_t(sample_rate_) << 26));
 }
 
-__attribute__((no_sanitize("integer"))) std::vector<const std::vector<uint8_t>*>
-SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
-  std::vector<const std::vector<uint8_t>*> out;
+__attribute__((no_sanitize("integer"))) void SourceAudioHalAsrc::Run(
+    const std::vector<uint8_t>& in,
+    std::vector<const std::vector<uint8_t>*>* out) {
+  out->clear();
 
   if (in.size() != buffers_size_) {
     LOG(ERROR) << "Inconsistent input buffer size: " << in.size() << " ("
                << buffers_size_ << " expected)" << std::endl;
-    return out;
+    return;
   }
 
   // The burst delay has expired, let's generate the burst.
 
   if (burst_buffers_.size() && stream_us_ >= burst_delay_us_) {
     for (size_t i = 0; i < burst_buffers_.size(); i++)
-      out.push_back(burst_buffers_[(out_counter_ + i) % burst_buffers_.size()]);
+      out->push_back(
+          burst_buffers_[(out_counter_ + i) % burst_buffers_.size()]);
 
     burst_buffers_.clear();
   }
@@ -590,9 +395,9 @@ SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
   uint32_t output_us;
 
   if (bit_depth_ <= 16)
-    Resample<int16_t>(ratio, in, &out, &output_us);
+    Resample<int16_t>(ratio, in, out, &output_us);
   else
-    Resample<int32_t>(ratio, in, &out, &output_us);
+    Resample<int32_t>(ratio, in, out, &output_us);
 
   drift_us_ += drift_z0_ * (int(output_us - local_us) - drift_us_);
 
@@ -600,15 +405,16 @@ SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
   // the associated delay has expired.
 
   if (burst_buffers_.size()) {
-    for (size_t i = 0; i < out.size(); i++)
+    for (size_t i = 0; i < out->size(); i++)
       std::exchange<const std::vector<uint8_t>*>(
-          out[i], burst_buffers_[(out_counter_ + i) % burst_buffers_.size()]);
+          (*out)[i],
+          burst_buffers_[(out_counter_ + i) % burst_buffers_.size()]);
   }
 
   // Return the output statistics to the clock recovery module
 
-  out_counter_ += out.size();
-  clock_recovery_->UpdateOutputStats(out.size(), ratio * sample_rate_,
+  out_counter_ += out->size();
+  clock_recovery_->UpdateOutputStats(out->size(), ratio * sample_rate_,
                                      int(output_us - local_us));
 
   if (0)
@@ -617,8 +423,6 @@ SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
                      output_us / (1000 * 1000), output_us % (1000 * 1000),
                      ratio * sample_rate_, int(output_us - local_us))
               << std::endl;
-
-  return out;
 }
 
 }  // namespace le_audio
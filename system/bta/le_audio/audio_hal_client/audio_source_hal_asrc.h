@@ -21,6 +21,8 @@
 #include <memory>
 #include <vector>
 
+#include "audio/asrc/asrc_resampler.h"
+
 namespace le_audio {
 
 class SourceAudioHalAsrc {
@@ -42,15 +44,18 @@ class SourceAudioHalAsrc {
 
   ~SourceAudioHalAsrc();
 
-  // Takes an input buffer, and returns a list of resamples buffers locked to
-  // the cadence of the transmission. The input and output buffers have a fixed
-  // size, deducted from the PCM characteristics, given to the constructor.
+  // Takes an input buffer, and returns in `out` a list of resamples buffers
+  // locked to the cadence of the transmission. The input and output buffers
+  // have a fixed size, deducted from the PCM characteristics, given to the
+  // constructor. The list `out` is cleared first, the caller can reuse it
+  // from one call to the other.
   //
   // The data of `in` mest be aligned to `int16_t` or `int32_t` for respectively
   // bit depth less or equal to 16, or greater.
   //
 
-  std::vector<const std::vector<uint8_t>*> Run(const std::vector<uint8_t>& in);
+  void Run(const std::vector<uint8_t>& in,
+           std::vector<const std::vector<uint8_t>*>* out);
 
  private:
   const int sample_rate_;
@@ -75,8 +80,7 @@ class SourceAudioHalAsrc {
   class ClockRecovery;
   std::unique_ptr<ClockRecovery> clock_recovery_;
 
-  class Resampler;
-  std::unique_ptr<std::vector<Resampler>> resamplers_;
+  std::unique_ptr<std::vector<::bluetooth::audio::asrc::Resampler>> resamplers_;
   struct {
     unsigned seconds;
     int samples;
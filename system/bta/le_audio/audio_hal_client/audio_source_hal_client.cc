@@ -21,12 +21,15 @@
 #include <android_bluetooth_flags.h>
 #include <base/logging.h>
 
+#include <algorithm>
+
 #include "audio_hal_client.h"
 #include "audio_hal_interface/le_audio_software.h"
 #include "audio_source_hal_asrc.h"
 #include "bta/le_audio/codec_manager.h"
 #include "common/time_util.h"
 #include "osi/include/log.h"
+#include "osi/include/thread_scheduler.h"
 #include "osi/include/wakelock.h"
 #include "stack/include/main_thread.h"
 
@@ -101,6 +104,9 @@ class SourceImpl : public LeAudioSourceAudioHalClient {
   LeAudioSourceAudioHalClient::Callbacks* audioSourceCallbacks_ = nullptr;
   std::mutex audioSourceCallbacksMutex_;
   std::unique_ptr<SourceAudioHalAsrc> asrc_;
+  // Buffers of the audio ticks, reused not to allocate while streaming
+  std::vector<uint8_t> pcm_buffer_;
+  std::vector<const std::vector<uint8_t>*> asrc_buffers_;
 };
 
 bool SourceImpl::Acquire() {
@@ -194,7 +200,8 @@ void SourceImpl::SendAudioData() {
       (source_codec_config_.num_channels * source_codec_config_.sample_rate *
        source_codec_config_.data_interval_us / 1000 * bytes_per_sample) /
       1000;
-  std::vector<uint8_t> data(bytes_per_tick);
+  std::vector<uint8_t>& data = pcm_buffer_;
+  data.resize(bytes_per_tick);
 
   uint32_t bytes_read = halSinkInterface_->Read(data.data(), bytes_per_tick);
   if (bytes_read < bytes_per_tick) {
@@ -202,13 +209,15 @@ void SourceImpl::SendAudioData() {
     sStats.media_read_total_underflow_count++;
     sStats.media_read_last_underflow_us =
         bluetooth::common::time_get_os_boottime_us();
+    // The buffer is reused, don't send the samples of the previous tick
+    std::fill(data.begin() + bytes_read, data.end(), 0);
   }
 
   if (IS_FLAG_ENABLED(leaudio_hal_client_asrc)) {
-    auto asrc_buffers = asrc_->Run(data);
+    asrc_->Run(data, &asrc_buffers_);
 
     std::lock_guard<std::mutex> guard(audioSourceCallbacksMutex_);
-    for (auto buffer : asrc_buffers) {
+    for (auto buffer : asrc_buffers_) {
       if (audioSourceCallbacks_ != nullptr) {
         audioSourceCallbacks_->OnAudioDataReady(*buffer);
       }
@@ -234,7 +243,8 @@ bool SourceImpl::InitAudioSinkThread() {
   }
 
   /* Schedule the rest of the operations */
-  if (!worker_thread_->EnableRealTimeScheduling()) {
+  if (!thread_scheduler_apply_profile(worker_thread_->GetLinuxThreadId(),
+                                      "le_audio_worker")) {
 #if defined(__ANDROID__)
     LOG(FATAL) << __func__ << ", Failed to increase media thread priority";
 #endif
@@ -244,7 +254,7 @@ bool SourceImpl::InitAudioSinkThread() {
 }
 
 void SourceImpl::StartAudioTicks() {
-  wakelock_acquire();
+  wakelock_acquire_for("le_audio");
   if (IS_FLAG_ENABLED(leaudio_hal_client_asrc)) {
     asrc_ = std::make_unique<SourceAudioHalAsrc>(
         source_codec_config_.num_channels, source_codec_config_.sample_rate,
@@ -264,7 +274,7 @@ void SourceImpl::StartAudioTicks() {
 void SourceImpl::StopAudioTicks() {
   audio_timer_.CancelAndWait();
   asrc_.reset(nullptr);
-  wakelock_release();
+  wakelock_release_for("le_audio");
 }
 
 bool SourceImpl::OnSuspendReq() {
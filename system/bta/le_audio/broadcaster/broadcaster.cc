@@ -766,6 +766,7 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
     }
 
     dprintf(fd, "%s", stream.str().c_str());
+    audio_receiver_.Dump(fd);
   }
 
  private:
@@ -992,6 +993,14 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
 
         sw_enc_.emplace_back(std::move(codec));
       }
+
+      /* The worker threads are kept as long as the channel count holds */
+      if (!sw_enc_channels_ ||
+          sw_enc_channels_max_ != codec_wrapper_.GetNumChannels()) {
+        sw_enc_channels_max_ = codec_wrapper_.GetNumChannels();
+        sw_enc_channels_ =
+            le_audio::MultiChannelEncoder::CreateInstance(sw_enc_channels_max_);
+      }
     }
 
     const BroadcastCodecWrapper& getCurrentCodecConfig(void) const {
@@ -1002,9 +1011,12 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       codec_wrapper_ = config;
     }
 
-    static void sendBroadcastData(
+    /* Returns the BIS connection handles the channels of the broadcast are
+     * sent to, or nullptr if it cannot carry all of them.
+     */
+    static const std::vector<uint16_t>* getBroadcastBisHandles(
         const std::unique_ptr<BroadcastStateMachine>& broadcast,
-        std::vector<std::unique_ptr<le_audio::CodecInterface>>& encoders) {
+        size_t num_channels) {
       auto const& config = broadcast->GetBigConfig();
       if (config == std::nullopt) {
         LOG_ERROR(
@@ -1012,19 +1024,23 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
             "state=%s",
             broadcast->GetBroadcastId(),
             ToString(broadcast->GetState()).c_str());
-        return;
+        return nullptr;
       }
 
-      if (config->connection_handles.size() < encoders.size()) {
+      if (config->connection_handles.size() < num_channels) {
         LOG_ERROR("Not enough BIS'es to broadcast all channels!");
-        return;
+        return nullptr;
       }
 
-      for (uint8_t chan = 0; chan < encoders.size(); ++chan) {
+      return &config->connection_handles;
+    }
+
+    void sendChannelData(size_t chan) {
+      auto const& samples = sw_enc_[chan]->GetDecodedSamples();
+      for (auto bis_handles : sw_enc_bis_handles_) {
         IsoManager::GetInstance()->SendIsoData(
-            config->connection_handles[chan],
-            (const uint8_t*)encoders[chan]->GetDecodedSamples().data(),
-            encoders[chan]->GetDecodedSamples().size() * 2);
+            (*bis_handles)[chan], (const uint8_t*)samples.data(),
+            samples.size() * 2);
       }
     }
 
@@ -1037,25 +1053,39 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       const auto num_channels = codec_wrapper_.GetNumChannels();
       const auto bytes_per_sample = (codec_wrapper_.GetBitsPerSample() / 8);
 
-      /* Prepare encoded data for all channels */
-      for (uint8_t chan = 0; chan < num_channels; ++chan) {
-        auto initial_channel_offset = chan * bytes_per_sample;
-        sw_enc_[chan]->Encode(data.data() + initial_channel_offset,
-                              num_channels,
-                              codec_wrapper_.GetOctetsPerCodecFrame());
-      }
-
       /* Currently there is no way to broadcast multiple distinct streams.
        * We just receive all system sounds mixed into a one stream and each
        * broadcast gets the same data.
        */
+      sw_enc_bis_handles_.clear();
       for (auto& broadcast_pair : instance->broadcasts_) {
         auto& broadcast = broadcast_pair.second;
-        if ((broadcast->GetState() ==
-             BroadcastStateMachine::State::STREAMING) &&
-            !broadcast->IsMuted())
-          sendBroadcastData(broadcast, sw_enc_);
+        if ((broadcast->GetState() !=
+             BroadcastStateMachine::State::STREAMING) ||
+            broadcast->IsMuted())
+          continue;
+
+        auto bis_handles = getBroadcastBisHandles(broadcast, num_channels);
+        if (bis_handles) sw_enc_bis_handles_.push_back(bis_handles);
+      }
+
+      /* Prepare encoded data for all channels */
+      auto& channels = sw_enc_channel_list_;
+      channels.clear();
+      for (uint8_t chan = 0; chan < num_channels; ++chan) {
+        auto initial_channel_offset = chan * bytes_per_sample;
+        channels.push_back({sw_enc_[chan].get(),
+                            data.data() + initial_channel_offset, num_channels,
+                            codec_wrapper_.GetOctetsPerCodecFrame()});
       }
+
+      /* Each BIS is sent as soon as its channel is encoded, while the next
+       * channels are still being encoded.
+       */
+      sw_enc_channels_->Encode(
+          channels,
+          codec_wrapper_.GetLeAudioCodecConfiguration().data_interval_us,
+          [this](size_t chan) { sendChannelData(chan); });
       LOG_VERBOSE("All data sent.");
     }
 
@@ -1100,9 +1130,21 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       }
     }
 
+    void Dump(int fd) const {
+      if (sw_enc_channels_) {
+        dprintf(fd, "    Encoder:\n");
+        sw_enc_channels_->Dump(fd);
+      }
+    }
+
    private:
     BroadcastCodecWrapper codec_wrapper_;
     std::vector<std::unique_ptr<le_audio::CodecInterface>> sw_enc_;
+    std::unique_ptr<le_audio::MultiChannelEncoder> sw_enc_channels_;
+    size_t sw_enc_channels_max_ = 0;
+    /* Reused frame to frame, not to allocate while streaming */
+    std::vector<le_audio::MultiChannelEncoder::Channel> sw_enc_channel_list_;
+    std::vector<const std::vector<uint16_t>*> sw_enc_bis_handles_;
   } audio_receiver_;
 
   static class QueuedBroadcast {
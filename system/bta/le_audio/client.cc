@@ -1460,55 +1460,77 @@ class LeAudioClientImpl : public LeAudioClient {
     /* Use same as supported ones for now. */
     leAudioDevice->SetAvailableContexts(supported_contexts);
 
-    if (!DeserializeHandles(leAudioDevice, handles)) {
+    /* Services are parsed when the device connects, see
+     * LoadStoredServices() */
+    leAudioDevice->stored_services_ = LeAudioDevice::StoredServices{
+        .handles = handles,
+        .sink_pacs = sink_pacs,
+        .source_pacs = source_pacs,
+        .ases = ases,
+    };
+
+    leAudioDevice->autoconnect_flag_ = autoconnect;
+    /* When adding from storage, make sure that autoconnect is used
+     * by all the devices in the group.
+     */
+    leAudioDevices_.SetInitialGroupAutoconnectState(
+        group_id, gatt_if_, reconnection_mode_, autoconnect);
+  }
+
+  void LoadStoredServices(LeAudioDevice* leAudioDevice) {
+    if (leAudioDevice == nullptr || !leAudioDevice->stored_services_) {
+      return;
+    }
+
+    auto stored_services = std::move(*leAudioDevice->stored_services_);
+    leAudioDevice->stored_services_.reset();
+
+    if (!DeserializeHandles(leAudioDevice, stored_services.handles)) {
       LOG_WARN("Could not load Handles");
     }
 
-    if (!DeserializeSinkPacs(leAudioDevice, sink_pacs)) {
+    if (!DeserializeSinkPacs(leAudioDevice, stored_services.sink_pacs)) {
       /* If PACs are invalid, just say whole cache is invalid */
       leAudioDevice->known_service_handles_ = false;
       LOG_WARN("Could not load sink pacs");
     }
 
-    if (!DeserializeSourcePacs(leAudioDevice, source_pacs)) {
+    if (!DeserializeSourcePacs(leAudioDevice, stored_services.source_pacs)) {
       /* If PACs are invalid, just say whole cache is invalid */
       leAudioDevice->known_service_handles_ = false;
       LOG_WARN("Could not load source pacs");
     }
 
-    if (!DeserializeAses(leAudioDevice, ases)) {
+    if (!DeserializeAses(leAudioDevice, stored_services.ases)) {
       /* If ASEs are invalid, just say whole cache is invalid */
       leAudioDevice->known_service_handles_ = false;
       LOG_WARN("Could not load ases");
     }
-
-    leAudioDevice->autoconnect_flag_ = autoconnect;
-    /* When adding from storage, make sure that autoconnect is used
-     * by all the devices in the group.
-     */
-    leAudioDevices_.SetInitialGroupAutoconnectState(
-        group_id, gatt_if_, reconnection_mode_, autoconnect);
   }
 
   bool GetHandlesForStorage(const RawAddress& addr, std::vector<uint8_t>& out) {
     LeAudioDevice* leAudioDevice = leAudioDevices_.FindByAddress(addr);
+    LoadStoredServices(leAudioDevice);
     return SerializeHandles(leAudioDevice, out);
   }
 
   bool GetSinkPacsForStorage(const RawAddress& addr,
                              std::vector<uint8_t>& out) {
     LeAudioDevice* leAudioDevice = leAudioDevices_.FindByAddress(addr);
+    LoadStoredServices(leAudioDevice);
     return SerializeSinkPacs(leAudioDevice, out);
   }
 
   bool GetSourcePacsForStorage(const RawAddress& addr,
                                std::vector<uint8_t>& out) {
     LeAudioDevice* leAudioDevice = leAudioDevices_.FindByAddress(addr);
+    LoadStoredServices(leAudioDevice);
     return SerializeSourcePacs(leAudioDevice, out);
   }
 
   bool GetAsesForStorage(const RawAddress& addr, std::vector<uint8_t>& out) {
     LeAudioDevice* leAudioDevice = leAudioDevices_.FindByAddress(addr);
+    LoadStoredServices(leAudioDevice);
 
     return SerializeAses(leAudioDevice, out);
   }
@@ -1985,6 +2007,8 @@ class LeAudioClientImpl : public LeAudioClient {
     leAudioDevice->conn_id_ = conn_id;
     leAudioDevice->mtu_ = mtu;
 
+    LoadStoredServices(leAudioDevice);
+
     /* Remove device from the background connect (it might be either Allow list
      * or TA) and add it again with reconnection_mode_. In case it is TA, we are
      * sure that device will not be in the allow list for other applications
@@ -3218,10 +3242,10 @@ class LeAudioClientImpl : public LeAudioClient {
     return true;
   }
 
-  // mix stero signal into mono
-  std::vector<uint8_t> mono_blend(const std::vector<uint8_t>& buf,
-                                  int bytes_per_sample, size_t frames) {
-    std::vector<uint8_t> mono_out;
+  // mix stero signal into mono, the output buffer is reused frame to frame
+  const std::vector<uint8_t>& mono_blend(const std::vector<uint8_t>& buf,
+                                         int bytes_per_sample, size_t frames) {
+    std::vector<uint8_t>& mono_out = sw_enc_mono_data;
     mono_out.resize(frames * bytes_per_sample);
 
     if (bytes_per_sample == 2) {
@@ -3278,7 +3302,7 @@ class LeAudioClientImpl : public LeAudioClient {
     uint16_t byte_count = stream_params.octets_per_codec_frame;
     bool mix_to_mono = (left_cis_handle == 0) || (right_cis_handle == 0);
     if (mix_to_mono) {
-      std::vector<uint8_t> mono = mono_blend(
+      const std::vector<uint8_t>& mono = mono_blend(
           data, bytes_per_sample, number_of_required_samples_per_channel);
       if (left_cis_handle) {
         sw_enc_left->Encode(mono.data(), 1, byte_count);
@@ -3288,8 +3312,12 @@ class LeAudioClientImpl : public LeAudioClient {
         sw_enc_left->Encode(mono.data(), 1, byte_count);
       }
     } else {
-      sw_enc_left->Encode(data.data(), 2, byte_count);
-      sw_enc_right->Encode(data.data() + bytes_per_sample, 2, byte_count);
+      sw_enc_channel_list.assign(
+          {{sw_enc_left.get(), data.data(), 2, byte_count},
+           {sw_enc_right.get(), data.data() + bytes_per_sample, 2,
+            byte_count}});
+      sw_enc_channels->Encode(sw_enc_channel_list,
+                              current_source_codec_config.data_interval_us);
     }
 
     DLOG(INFO) << __func__ << " left_cis_handle: " << +left_cis_handle
@@ -3328,14 +3356,18 @@ class LeAudioClientImpl : public LeAudioClient {
     if (mix_to_mono) {
       /* Since we always get two channels from framework, lets make it mono here
        */
-      std::vector<uint8_t> mono = mono_blend(
+      const std::vector<uint8_t>& mono = mono_blend(
           data, bytes_per_sample, number_of_required_samples_per_channel);
       sw_enc_left->Encode(mono.data(), 1, byte_count);
     } else {
-      sw_enc_left->Encode((const uint8_t*)data.data(), 2, byte_count);
-      // Output to the left channel buffer with `byte_count` offset
-      sw_enc_right->Encode((const uint8_t*)data.data() + 2, 2, byte_count,
-                           &sw_enc_left->GetDecodedSamples(), byte_count);
+      // Output the right channel to the left channel buffer with `byte_count`
+      // offset
+      sw_enc_channel_list.assign(
+          {{sw_enc_left.get(), (const uint8_t*)data.data(), 2, byte_count},
+           {sw_enc_right.get(), (const uint8_t*)data.data() + 2, 2, byte_count,
+            &sw_enc_left->GetDecodedSamples(), byte_count}});
+      sw_enc_channels->Encode(sw_enc_channel_list,
+                              current_source_codec_config.data_interval_us);
     }
 
     IsoManager::GetInstance()->SendIsoData(
@@ -3500,9 +3532,8 @@ class LeAudioClientImpl : public LeAudioClient {
                                                       to_write);
       } else {
         /* stereo audio over bluetooth, audio framework expects mono */
-        for (size_t i = 0; i < left->size(); i++) {
-          (*left)[i] = ((*left)[i] + (*right)[i]) / 2;
-        }
+        le_audio::utils::DownmixStereoToMono(left->data(), right->data(),
+                                             left->size());
         to_write = sizeof(int16_t) * left->size();
         written = le_audio_sink_hal_client_->SendData((uint8_t*)left->data(),
                                                       to_write);
@@ -3512,15 +3543,14 @@ class LeAudioClientImpl : public LeAudioClient {
        * Here we handle stream without checking bt_got_stereo flag.
        */
       const size_t mono_size = left ? left->size() : right->size();
-      std::vector<uint16_t> mixed(mono_size * 2);
-
-      for (size_t i = 0; i < mono_size; i++) {
-        mixed[2 * i] = left ? (*left)[i] : (*right)[i];
-        mixed[2 * i + 1] = right ? (*right)[i] : (*left)[i];
-      }
-      to_write = sizeof(int16_t) * mixed.size();
-      written =
-          le_audio_sink_hal_client_->SendData((uint8_t*)mixed.data(), to_write);
+      const int16_t* left_data = left ? left->data() : right->data();
+      const int16_t* right_data = right ? right->data() : left->data();
+      sw_dec_stereo_data.resize(mono_size * 2);
+      le_audio::utils::InterleaveStereo(left_data, right_data,
+                                        sw_dec_stereo_data.data(), mono_size);
+      to_write = sizeof(int16_t) * sw_dec_stereo_data.size();
+      written = le_audio_sink_hal_client_->SendData(
+          (uint8_t*)sw_dec_stereo_data.data(), to_write);
     }
 
     /* TODO: What to do if not all data sinked ? */
@@ -3608,6 +3638,11 @@ class LeAudioClientImpl : public LeAudioClient {
         groupStateMachine_->StopStream(group);
         return;
       }
+
+      if (!sw_enc_channels) {
+        sw_enc_channels =
+            le_audio::MultiChannelEncoder::CreateInstance(2 /* channels */);
+      }
     }
 
     le_audio_source_hal_client_->UpdateRemoteDelay(remote_delay_ms);
@@ -3786,6 +3821,10 @@ class LeAudioClientImpl : public LeAudioClient {
     }
     dprintf(fd, "\n");
     printCurrentStreamConfiguration(fd);
+    if (sw_enc_channels) {
+      dprintf(fd, " Speaker encoder\n");
+      sw_enc_channels->Dump(fd);
+    }
     dprintf(fd, "  ----------------\n ");
     dprintf(fd, "  LE Audio Groups:\n");
     aseGroups_.Dump(fd, active_group_id_);
@@ -5648,9 +5687,19 @@ class LeAudioClientImpl : public LeAudioClient {
 
   std::unique_ptr<le_audio::CodecInterface> sw_enc_left;
   std::unique_ptr<le_audio::CodecInterface> sw_enc_right;
+  /* Encodes the left and right channels of a frame together. Kept across the
+   * streams, along with its worker threads. */
+  std::unique_ptr<le_audio::MultiChannelEncoder> sw_enc_channels;
+  /* Per frame buffers of the encoders, kept to not allocate while streaming.
+   * The encoded SDUs are held by the encoders themselves. */
+  std::vector<le_audio::MultiChannelEncoder::Channel> sw_enc_channel_list;
+  std::vector<uint8_t> sw_enc_mono_data;
 
   std::unique_ptr<le_audio::CodecInterface> sw_dec_left;
   std::unique_ptr<le_audio::CodecInterface> sw_dec_right;
+  /* Interleaved frame sent to the Audio Framework, kept to not allocate while
+   * streaming. */
+  std::vector<int16_t> sw_dec_stereo_data;
 
   std::vector<uint8_t> encoded_data;
   std::unique_ptr<LeAudioSourceAudioHalClient> le_audio_source_hal_client_;
@@ -21,11 +21,20 @@
 #include <base/logging.h>
 #include <lc3.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 #include "osi/include/log.h"
+#include "osi/include/properties.h"
+#include "osi/include/thread_scheduler.h"
 
 namespace le_audio {
 
@@ -295,4 +304,296 @@ uint8_t CodecInterface::GetNumOfBytesPerSample() {
   return impl->GetNumOfBytesPerSample();
 };
 
+struct MultiChannelEncoder::Impl {
+  static constexpr char kParallelEncodingProp[] =
+      "persist.bluetooth.leaudio.parallel_encoding";
+  // Log one missed deadline out of this many
+  static constexpr uint64_t kMissedDeadlineLogPeriod = 100;
+
+  Impl(size_t max_channels) {
+    if (max_channels < 2 || !osi_property_get_bool(kParallelEncodingProp, true))
+      return;
+
+    size_t num_cpus = std::thread::hardware_concurrency();
+    if (num_cpus < 2) return;
+
+    size_t num_workers = std::min(max_channels, num_cpus) - 1;
+    for (size_t i = 0; i < num_workers; i++) {
+      workers_.emplace_back(&Impl::WorkerMain, this);
+    }
+    LOG_INFO("%zu encoder worker(s) for %zu channels", workers_.size(),
+             max_channels);
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  CodecInterface::Status Encode(
+      const std::vector<Channel>& channels, uint32_t frame_interval_us,
+      const ChannelEncodedCallback& on_channel_encoded) {
+    auto start = std::chrono::steady_clock::now();
+    PrepareChannelState(channels.size());
+
+    if (workers_.empty() || channels.size() < 2) {
+      for (size_t index = 0; index < channels.size(); index++) {
+        statuses_[index] = EncodeChannel(channels[index], index);
+        if (on_channel_encoded) on_channel_encoded(index);
+      }
+    } else {
+      // A channel output into the buffer of another channel would resize it
+      // while the other channel encodes: size the buffers up front.
+      for (const auto& channel : channels) {
+        PrepareOutputBuffer(channel);
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      channels_ = &channels;
+      next_channel_ = 0;
+      remaining_channels_ = channels.size();
+      notify_each_channel_ = static_cast<bool>(on_channel_encoded);
+      generation_++;
+      lock.unlock();
+      work_cv_.notify_all();
+
+      // Report the channels encoded in order, between the encoding of the
+      // channels claimed by this thread, then as the workers complete them.
+      size_t reported = 0;
+      auto report_encoded_channels = [&] {
+        while (reported < channels.size() &&
+               channel_done_[reported].load(std::memory_order_acquire)) {
+          on_channel_encoded(reported++);
+        }
+      };
+      while (EncodeNextChannel(channels)) {
+        if (on_channel_encoded) report_encoded_channels();
+      }
+      if (on_channel_encoded) {
+        while (reported < channels.size()) {
+          lock.lock();
+          done_cv_.wait(lock, [&] {
+            return channel_done_[reported].load(std::memory_order_acquire);
+          });
+          lock.unlock();
+          report_encoded_channels();
+        }
+      }
+
+      lock.lock();
+      done_cv_.wait(lock, [this] {
+        return remaining_channels_ == 0 && active_workers_ == 0;
+      });
+      channels_ = nullptr;
+      lock.unlock();
+    }
+
+    UpdateDeadlineStats(start, frame_interval_us, channels.size());
+    for (size_t index = 0; index < channels.size(); index++) {
+      if (statuses_[index] != CodecInterface::Status::STATUS_OK)
+        return statuses_[index];
+    }
+    return CodecInterface::Status::STATUS_OK;
+  }
+
+  bool IsParallel() const { return !workers_.empty(); }
+
+  DeadlineStats GetDeadlineStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+  }
+
+  void Dump(int fd) const {
+    DeadlineStats stats = GetDeadlineStats();
+    dprintf(fd, "  Encoder workers: %zu\n", workers_.size());
+    dprintf(fd, "  Encoded frames (total/missed deadline): %llu / %llu\n",
+            (unsigned long long)stats.num_frames,
+            (unsigned long long)stats.num_missed_deadlines);
+    dprintf(fd,
+            "  Frame encoding time in us (ave/max/interval): %llu / %llu / "
+            "%u\n",
+            stats.num_frames
+                ? (unsigned long long)(stats.total_encoding_time_us /
+                                       stats.num_frames)
+                : 0,
+            (unsigned long long)stats.max_encoding_time_us,
+            stats.frame_interval_us);
+    for (size_t index = 0; index < stats.channels.size(); index++) {
+      const auto& channel = stats.channels[index];
+      dprintf(fd,
+              "    Channel %zu encoding time in us (ave/max): %llu / %llu\n",
+              index,
+              channel.num_frames
+                  ? (unsigned long long)(channel.total_encoding_time_us /
+                                         channel.num_frames)
+                  : 0,
+              (unsigned long long)channel.max_encoding_time_us);
+    }
+  }
+
+ private:
+  // Encodes a channel and records its encoding time, each channel of a frame
+  // being encoded by a single thread.
+  CodecInterface::Status EncodeChannel(const Channel& channel, size_t index) {
+    auto start = std::chrono::steady_clock::now();
+    auto status =
+        channel.codec->Encode(channel.data, channel.stride, channel.out_size,
+                              channel.out_buffer, channel.out_offset);
+    channel_time_us_[index] =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    return status;
+  }
+
+  // The per channel state is only reallocated when the channel count grows
+  void PrepareChannelState(size_t num_channels) {
+    if (num_channels > channel_done_size_) {
+      channel_done_ = std::make_unique<std::atomic<bool>[]>(num_channels);
+      channel_done_size_ = num_channels;
+    }
+    for (size_t index = 0; index < num_channels; index++) {
+      channel_done_[index].store(false, std::memory_order_relaxed);
+    }
+    statuses_.assign(num_channels, CodecInterface::Status::STATUS_OK);
+    channel_time_us_.resize(num_channels);
+  }
+
+  static void PrepareOutputBuffer(const Channel& channel) {
+    std::vector<int16_t>* out_buffer = channel.out_buffer;
+    if (out_buffer == nullptr) {
+      out_buffer = &channel.codec->GetDecodedSamples();
+    }
+    // Same sizing as CodecInterface::Encode(): two bytes per sample
+    size_t channel_samples = (channel.out_offset + channel.out_size) / 2;
+    if (out_buffer->size() < channel_samples) {
+      out_buffer->resize(channel_samples);
+    }
+  }
+
+  // Encodes the next channel not claimed yet by the other threads, returns
+  // false once all the channels are claimed.
+  bool EncodeNextChannel(const std::vector<Channel>& channels) {
+    size_t index = next_channel_.fetch_add(1);
+    if (index >= channels.size()) return false;
+    statuses_[index] = EncodeChannel(channels[index], index);
+    channel_done_[index].store(true, std::memory_order_release);
+    remaining_channels_.fetch_sub(1);
+    if (notify_each_channel_) {
+      // Taking the lock orders the wake-up after the wait predicate check
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      done_cv_.notify_one();
+    }
+    return true;
+  }
+
+  void WorkerMain() {
+    if (!thread_scheduler_apply_profile(0, "le_audio_worker")) {
+      LOG_WARN("Unable to apply the scheduling profile of the encoder worker");
+    }
+
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      work_cv_.wait(lock,
+                    [&] { return exit_ || generation_ != seen_generation; });
+      if (exit_) return;
+      seen_generation = generation_;
+      // The frame may have been fully encoded before this worker woke up
+      if (channels_ == nullptr) continue;
+
+      const std::vector<Channel>* channels = channels_;
+      active_workers_++;
+      lock.unlock();
+      while (EncodeNextChannel(*channels)) {
+      }
+      lock.lock();
+      active_workers_--;
+      done_cv_.notify_one();
+    }
+  }
+
+  void UpdateDeadlineStats(std::chrono::steady_clock::time_point start,
+                           uint32_t frame_interval_us, size_t num_channels) {
+    uint64_t encoding_time_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (stats_.channels.size() < num_channels) {
+      stats_.channels.resize(num_channels);
+    }
+    for (size_t index = 0; index < num_channels; index++) {
+      auto& channel = stats_.channels[index];
+      channel.num_frames++;
+      channel.total_encoding_time_us += channel_time_us_[index];
+      channel.max_encoding_time_us =
+          std::max(channel.max_encoding_time_us, channel_time_us_[index]);
+    }
+    stats_.num_frames++;
+    stats_.total_encoding_time_us += encoding_time_us;
+    stats_.max_encoding_time_us =
+        std::max(stats_.max_encoding_time_us, encoding_time_us);
+    stats_.frame_interval_us = frame_interval_us;
+    if (frame_interval_us != 0 && encoding_time_us > frame_interval_us) {
+      if (stats_.num_missed_deadlines++ % kMissedDeadlineLogPeriod == 0) {
+        LOG_WARN(
+            "Frame encoding took %llu us, over the %u us frame interval "
+            "(%llu missed deadline(s))",
+            (unsigned long long)encoding_time_us, frame_interval_us,
+            (unsigned long long)stats_.num_missed_deadlines);
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+
+  // Frame being encoded, protected by |mutex_|
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::vector<Channel>* channels_ = nullptr;
+  uint64_t generation_ = 0;
+  size_t active_workers_ = 0;
+  bool exit_ = false;
+  bool notify_each_channel_ = false;
+
+  // Claimed and completed channels of the frame being encoded
+  std::atomic<size_t> next_channel_ = 0;
+  std::atomic<size_t> remaining_channels_ = 0;
+  std::vector<CodecInterface::Status> statuses_;
+  std::unique_ptr<std::atomic<bool>[]> channel_done_;
+  size_t channel_done_size_ = 0;
+  std::vector<uint64_t> channel_time_us_;
+
+  mutable std::mutex stats_mutex_;
+  DeadlineStats stats_;
+};
+
+MultiChannelEncoder::MultiChannelEncoder(size_t max_channels)
+    : impl(std::make_unique<Impl>(max_channels)) {}
+MultiChannelEncoder::~MultiChannelEncoder() = default;
+CodecInterface::Status MultiChannelEncoder::Encode(
+    const std::vector<Channel>& channels, uint32_t frame_interval_us) {
+  return impl->Encode(channels, frame_interval_us, nullptr);
+}
+CodecInterface::Status MultiChannelEncoder::Encode(
+    const std::vector<Channel>& channels, uint32_t frame_interval_us,
+    const ChannelEncodedCallback& on_channel_encoded) {
+  return impl->Encode(channels, frame_interval_us, on_channel_encoded);
+}
+bool MultiChannelEncoder::IsParallel() const { return impl->IsParallel(); }
+MultiChannelEncoder::DeadlineStats MultiChannelEncoder::GetDeadlineStats()
+    const {
+  return impl->GetDeadlineStats();
+}
+void MultiChannelEncoder::Dump(int fd) const { impl->Dump(fd); }
+
 }  // namespace le_audio
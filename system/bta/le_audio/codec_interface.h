@@ -20,6 +20,9 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <vector>
+
 #include "audio_hal_client/audio_hal_client.h"
 #include "le_audio_types.h"
 
@@ -70,4 +73,76 @@ class CodecInterface {
   struct Impl;
   Impl* impl;
 };
+
+/* MultiChannelEncoder encodes the channels of one frame interval, each with
+ * its own CodecInterface instance, as a single operation. In parallel mode the
+ * channels are spread over a persistent pool of worker threads, with the
+ * calling thread encoding as well, and Encode() returns once every channel of
+ * the frame is encoded. Otherwise the channels are encoded one after the
+ * other on the calling thread.
+ * The encoding time of each frame is checked against the frame interval, and
+ * the frames missing that deadline are reported.
+ */
+class MultiChannelEncoder {
+ public:
+  /* The encoding of a single channel; the parameters match the ones of
+   * CodecInterface::Encode(). A channel may output into the buffer of another
+   * channel of the same frame, at a distinct offset. */
+  struct Channel {
+    CodecInterface* codec;
+    const uint8_t* data;
+    int stride;
+    uint16_t out_size;
+    std::vector<int16_t>* out_buffer = nullptr;
+    uint16_t out_offset = 0;
+  };
+
+  struct ChannelStats {
+    uint64_t num_frames = 0;
+    uint64_t total_encoding_time_us = 0;
+    uint64_t max_encoding_time_us = 0;
+  };
+
+  struct DeadlineStats {
+    uint64_t num_frames = 0;
+    uint64_t num_missed_deadlines = 0;
+    uint64_t total_encoding_time_us = 0;
+    uint64_t max_encoding_time_us = 0;
+    uint32_t frame_interval_us = 0;
+    // Encoding time of each channel, indexed as the channels of Encode()
+    std::vector<ChannelStats> channels;
+  };
+
+  /* Called with the index of a channel once it is encoded. */
+  using ChannelEncodedCallback = std::function<void(size_t channel_index)>;
+
+  /* Up to |max_channels| - 1 worker threads are started, bounded by the
+   * number of CPUs, unless parallel encoding is disabled with the
+   * "persist.bluetooth.leaudio.parallel_encoding" property. */
+  MultiChannelEncoder(size_t max_channels);
+  virtual ~MultiChannelEncoder();
+  static std::unique_ptr<MultiChannelEncoder> CreateInstance(
+      size_t max_channels) {
+    return std::make_unique<MultiChannelEncoder>(max_channels);
+  }
+
+  /* Encodes all the |channels| of a frame lasting |frame_interval_us|.
+   * Returns the first error status of the channels, if any. */
+  virtual CodecInterface::Status Encode(const std::vector<Channel>& channels,
+                                        uint32_t frame_interval_us);
+  /* Same as above, but |on_channel_encoded| is called on the calling thread
+   * for each channel in order, as soon as the channel and all the channels
+   * before it are encoded, while the next channels are still encoding. Every
+   * channel is encoded and reported, even after an error. */
+  virtual CodecInterface::Status Encode(
+      const std::vector<Channel>& channels, uint32_t frame_interval_us,
+      const ChannelEncodedCallback& on_channel_encoded);
+  virtual bool IsParallel() const;
+  virtual DeadlineStats GetDeadlineStats() const;
+  virtual void Dump(int fd) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
 }  // namespace le_audio
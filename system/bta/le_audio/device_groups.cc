@@ -746,7 +746,7 @@ bool LeAudioDeviceGroup::UpdateAudioContextAvailability(void) {
 bool LeAudioDeviceGroup::UpdateAudioSetConfigurationCache(
     LeAudioContextType ctx_type) {
   const le_audio::set_configurations::AudioSetConfiguration* new_conf =
-      FindFirstSupportedConfiguration(ctx_type);
+      FindFirstSupportedConfigurationMemoized(ctx_type);
   auto update_config = true;
 
   if (context_to_configuration_cache_map.count(ctx_type) != 0) {
@@ -1855,6 +1855,82 @@ LeAudioDeviceGroup::FindFirstSupportedConfiguration(
   return nullptr;
 }
 
+std::vector<uint8_t> LeAudioDeviceGroup::GetConfigurationFingerprint(
+    LeAudioContextType context_type) const {
+  std::vector<uint8_t> fingerprint;
+  auto append = [&fingerprint](auto value) {
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    fingerprint.insert(fingerprint.end(), bytes, bytes + sizeof(value));
+  };
+  auto append_bytes = [&](const std::vector<uint8_t>& bytes) {
+    append(static_cast<uint16_t>(bytes.size()));
+    fingerprint.insert(fingerprint.end(), bytes.begin(), bytes.end());
+  };
+
+  /* The candidate configurations and the group wide parameters */
+  append(reinterpret_cast<uintptr_t>(
+      AudioSetConfigurationProvider::Get()->GetConfigurations(context_type)));
+  append(CodecManager::GetInstance()->GetCodecLocation());
+  append(static_cast<uint16_t>(Size()));
+  append(static_cast<uint32_t>(snk_audio_locations_.to_ulong()));
+
+  for (auto* device = GetFirstDevice(); device != nullptr;
+       device = GetNextDevice(device)) {
+    append(static_cast<uint8_t>(
+        (device->conn_id_ != GATT_INVALID_CONN_ID) &&
+        (device->GetConnectionState() == DeviceConnectState::CONNECTED)));
+    append(device->GetSupportedContexts(types::kLeAudioDirectionSink).value());
+    append(
+        device->GetSupportedContexts(types::kLeAudioDirectionSource).value());
+    append(static_cast<uint32_t>(device->snk_audio_locations_.to_ulong()));
+    append(static_cast<uint32_t>(device->src_audio_locations_.to_ulong()));
+    append(static_cast<uint16_t>(
+        device->GetAseCount(types::kLeAudioDirectionSink)));
+    append(static_cast<uint16_t>(
+        device->GetAseCount(types::kLeAudioDirectionSource)));
+
+    for (auto* pacs : {&device->snk_pacs_, &device->src_pacs_}) {
+      append(static_cast<uint16_t>(pacs->size()));
+      for (const auto& pac_tuple : *pacs) {
+        auto& pac_recs = std::get<1>(pac_tuple);
+        append(static_cast<uint16_t>(pac_recs.size()));
+        for (const auto& pac : pac_recs) {
+          append(pac.codec_id.coding_format);
+          append(pac.codec_id.vendor_company_id);
+          append(pac.codec_id.vendor_codec_id);
+          append_bytes(pac.codec_spec_caps.RawPacket());
+          append_bytes(pac.metadata);
+        }
+      }
+    }
+  }
+
+  return fingerprint;
+}
+
+const set_configurations::AudioSetConfiguration*
+LeAudioDeviceGroup::FindFirstSupportedConfigurationMemoized(
+    LeAudioContextType context_type) {
+  /* Bounds the memory used by a group going through many states */
+  static constexpr size_t kMaxConfigurationMemoSize = 64;
+
+  auto key =
+      std::make_pair(context_type, GetConfigurationFingerprint(context_type));
+  auto it = configuration_memo_.find(key);
+  if (it != configuration_memo_.end()) {
+    configuration_memo_hits_++;
+    return it->second;
+  }
+
+  configuration_memo_misses_++;
+  auto conf = FindFirstSupportedConfiguration(context_type);
+  if (configuration_memo_.size() >= kMaxConfigurationMemoSize) {
+    configuration_memo_.clear();
+  }
+  configuration_memo_.emplace(std::move(key), conf);
+  return conf;
+}
+
 /* This method should choose aproperiate ASEs to be active and set a cached
  * configuration for codec and qos.
  */
@@ -1980,6 +2056,9 @@ void LeAudioDeviceGroup::Dump(int fd, int active_group_id) const {
          << "      num of sources(connected): "
          << stream_conf.stream_params.source.num_of_devices << "("
          << stream_conf.stream_params.source.stream_locations.size() << ")\n"
+         << "      configuration selections (memoized/computed): "
+         << configuration_memo_hits_ << "/" << configuration_memo_misses_
+         << "\n"
          << "      allocated CISes: " << static_cast<int>(cig.cises.size());
 
   if (cig.cises.size() > 0) {
@@ -2033,8 +2112,11 @@ LeAudioDeviceGroup* LeAudioDeviceGroups::Add(int group_id) {
     return nullptr;
   }
 
-  return (groups_.emplace_back(std::make_unique<LeAudioDeviceGroup>(group_id)))
-      .get();
+  auto group =
+      groups_.emplace_back(std::make_unique<LeAudioDeviceGroup>(group_id))
+          .get();
+  group_index_[group_id] = group;
+  return group;
 }
 
 void LeAudioDeviceGroups::Remove(int group_id) {
@@ -2047,15 +2129,13 @@ void LeAudioDeviceGroups::Remove(int group_id) {
     return;
   }
 
+  group_index_.erase(group_id);
   groups_.erase(iter);
 }
 
 LeAudioDeviceGroup* LeAudioDeviceGroups::FindById(int group_id) const {
-  auto iter = std::find_if(
-      groups_.begin(), groups_.end(),
-      [&group_id](auto const& group) { return group->group_id_ == group_id; });
-
-  return (iter == groups_.end()) ? nullptr : iter->get();
+  auto iter = group_index_.find(group_id);
+  return (iter == group_index_.end()) ? nullptr : iter->second;
 }
 
 void LeAudioDeviceGroups::Cleanup(void) {
@@ -2064,6 +2144,7 @@ void LeAudioDeviceGroups::Cleanup(void) {
   }
 
   groups_.clear();
+  group_index_.clear();
 }
 
 void LeAudioDeviceGroups::Dump(int fd, int active_group_id) const {
@@ -28,6 +28,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include <utility>  // for std::pair
 #include <vector>
 
@@ -357,6 +358,11 @@ class LeAudioDeviceGroup {
 
   const set_configurations::AudioSetConfiguration*
   FindFirstSupportedConfiguration(types::LeAudioContextType context_type) const;
+  const set_configurations::AudioSetConfiguration*
+  FindFirstSupportedConfigurationMemoized(
+      types::LeAudioContextType context_type);
+  std::vector<uint8_t> GetConfigurationFingerprint(
+      types::LeAudioContextType context_type) const;
   bool ConfigureAses(
       const set_configurations::AudioSetConfiguration* audio_set_conf,
       types::LeAudioContextType context_type,
@@ -394,6 +400,19 @@ class LeAudioDeviceGroup {
            std::pair<bool, const set_configurations::AudioSetConfiguration*>>
       context_to_configuration_cache_map;
 
+  /* Results of FindFirstSupportedConfiguration(), kept across the cache
+   * invalidations. Keyed by the context type and a fingerprint of the group
+   * and members state the selection depends on: connected members, their
+   * PACs, ASEs, audio locations and supported contexts. A PAC or ASE change
+   * leads to a new key, while going back to a known state (e.g. a member
+   * reconnecting) reuses the previous selection.
+   */
+  std::map<std::pair<types::LeAudioContextType, std::vector<uint8_t>>,
+           const set_configurations::AudioSetConfiguration*>
+      configuration_memo_;
+  uint32_t configuration_memo_hits_ = 0;
+  uint32_t configuration_memo_misses_ = 0;
+
   types::AseState target_state_;
   types::AseState current_state_;
   std::vector<std::weak_ptr<LeAudioDevice>> leAudioDevices_;
@@ -416,6 +435,7 @@ class LeAudioDeviceGroups {
 
  private:
   std::vector<std::unique_ptr<LeAudioDeviceGroup>> groups_;
+  std::unordered_map<int, LeAudioDeviceGroup*> group_index_;
 };
 
 }  // namespace le_audio
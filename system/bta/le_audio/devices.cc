@@ -1034,74 +1034,100 @@ void LeAudioDevices::Add(const RawAddress& address, DeviceConnectState state,
     return;
   }
 
-  leAudioDevices_.emplace_back(
+  address_index_[address] = leAudioDevices_.emplace_back(
       std::make_shared<LeAudioDevice>(address, state, group_id));
 }
 
-void LeAudioDevices::Remove(const RawAddress& address) {
-  auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
-                           [&address](auto const& leAudioDevice) {
-                             return leAudioDevice->address_ == address;
-                           });
+template <typename T>
+static void RemoveHintsToDevice(T& hints, const LeAudioDevice* device) {
+  for (auto it = hints.begin(); it != hints.end();) {
+    if (it->second == device) {
+      it = hints.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
 
-  if (iter == leAudioDevices_.end()) {
+void LeAudioDevices::Remove(const RawAddress& address) {
+  auto index_iter = address_index_.find(address);
+  if (index_iter == address_index_.end()) {
     LOG(ERROR) << __func__ << ", no such address: "
                << ADDRESS_TO_LOGGABLE_STR(address);
     return;
   }
 
-  leAudioDevices_.erase(iter);
+  auto device = index_iter->second.get();
+  RemoveHintsToDevice(conn_id_hints_, device);
+  RemoveHintsToDevice(cis_conn_hdl_hints_, device);
+  address_index_.erase(index_iter);
+
+  leAudioDevices_.erase(
+      std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
+                   [device](auto const& leAudioDevice) {
+                     return leAudioDevice.get() == device;
+                   }));
 }
 
 LeAudioDevice* LeAudioDevices::FindByAddress(const RawAddress& address) const {
-  auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
-                           [&address](auto const& leAudioDevice) {
-                             return leAudioDevice->address_ == address;
-                           });
-
-  return (iter == leAudioDevices_.end()) ? nullptr : iter->get();
+  auto iter = address_index_.find(address);
+  return (iter == address_index_.end()) ? nullptr : iter->second.get();
 }
 
 std::shared_ptr<LeAudioDevice> LeAudioDevices::GetByAddress(
     const RawAddress& address) const {
-  auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
-                           [&address](auto const& leAudioDevice) {
-                             return leAudioDevice->address_ == address;
-                           });
-
-  return (iter == leAudioDevices_.end()) ? nullptr : *iter;
+  auto iter = address_index_.find(address);
+  return (iter == address_index_.end()) ? nullptr : iter->second;
 }
 
 LeAudioDevice* LeAudioDevices::FindByConnId(uint16_t conn_id) const {
+  /* Many devices may have no connection, keep the scan order for these */
+  bool use_hint = (conn_id != GATT_INVALID_CONN_ID);
+  if (use_hint) {
+    auto hint = conn_id_hints_.find(conn_id);
+    if (hint != conn_id_hints_.end() && hint->second->conn_id_ == conn_id) {
+      return hint->second;
+    }
+  }
+
   auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
                            [&conn_id](auto const& leAudioDevice) {
                              return leAudioDevice->conn_id_ == conn_id;
                            });
 
-  return (iter == leAudioDevices_.end()) ? nullptr : iter->get();
+  if (iter == leAudioDevices_.end()) return nullptr;
+
+  if (use_hint) conn_id_hints_[conn_id] = iter->get();
+  return iter->get();
+}
+
+static bool IsDeviceUsingCis(LeAudioDevice* dev, uint8_t cig_id,
+                             uint16_t conn_hdl) {
+  if (dev->group_id_ != cig_id) {
+    return false;
+  }
+
+  auto ases = dev->GetAsesByCisConnHdl(conn_hdl);
+  return (ases.sink || ases.source);
 }
 
 LeAudioDevice* LeAudioDevices::FindByCisConnHdl(uint8_t cig_id,
                                                 uint16_t conn_hdl) const {
+  uint32_t key = (static_cast<uint32_t>(cig_id) << 16) | conn_hdl;
+  auto hint = cis_conn_hdl_hints_.find(key);
+  if (hint != cis_conn_hdl_hints_.end() &&
+      IsDeviceUsingCis(hint->second, cig_id, conn_hdl)) {
+    return hint->second;
+  }
+
   auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
                            [&conn_hdl, &cig_id](auto& d) {
-                             LeAudioDevice* dev;
-                             BidirectionalPair<struct ase*> ases;
-
-                             dev = d.get();
-                             if (dev->group_id_ != cig_id) {
-                               return false;
-                             }
-
-                             ases = dev->GetAsesByCisConnHdl(conn_hdl);
-                             if (ases.sink || ases.source)
-                               return true;
-                             else
-                               return false;
+                             return IsDeviceUsingCis(d.get(), cig_id, conn_hdl);
                            });
 
   if (iter == leAudioDevices_.end()) return nullptr;
 
+  cis_conn_hdl_hints_[key] = iter->get();
   return iter->get();
 }
 
@@ -1177,6 +1203,9 @@ void LeAudioDevices::Cleanup(tGATT_IF client_if) {
     }
   }
   leAudioDevices_.clear();
+  address_index_.clear();
+  conn_id_hints_.clear();
+  cis_conn_hdl_hints_.clear();
 }
 
 }  // namespace le_audio
@@ -23,6 +23,7 @@
 #include <memory>
 #include <optional>
 #include <tuple>
+#include <unordered_map>
 #include <utility>  // for std::pair
 #include <vector>
 
@@ -123,6 +124,17 @@ class LeAudioDevice {
   alarm_t* link_quality_timer;
   uint16_t link_quality_timer_data;
 
+  /* Serialized services restored from the storage. They are parsed on the
+   * first connection instead of when the stack starts.
+   */
+  struct StoredServices {
+    std::vector<uint8_t> handles;
+    std::vector<uint8_t> sink_pacs;
+    std::vector<uint8_t> source_pacs;
+    std::vector<uint8_t> ases;
+  };
+  std::optional<StoredServices> stored_services_;
+
   LeAudioDevice(const RawAddress& address_, DeviceConnectState state,
                 int group_id = bluetooth::groups::kGroupUnknown)
       : address_(address_),
@@ -284,6 +296,16 @@ class LeAudioDevices {
 
  private:
   std::vector<std::shared_ptr<LeAudioDevice>> leAudioDevices_;
+
+  /* The address index follows Add() and Remove(). The connection id and the
+   * CIS handles are updated directly on the devices, hence their indexes only
+   * hold hints: a hint is checked against the device it points to, and a
+   * missing or stale hint is refreshed with a scan of the devices.
+   */
+  std::unordered_map<RawAddress, std::shared_ptr<LeAudioDevice>>
+      address_index_;
+  mutable std::unordered_map<uint16_t, LeAudioDevice*> conn_id_hints_;
+  mutable std::unordered_map<uint32_t, LeAudioDevice*> cis_conn_hdl_hints_;
 };
 
 }  // namespace le_audio
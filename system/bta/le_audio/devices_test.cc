@@ -173,6 +173,51 @@ TEST_F(LeAudioDevicesTest, test_find_by_conn_id_failed) {
   ASSERT_EQ(nullptr, devices_->FindByConnId(0x0006));
 }
 
+TEST_F(LeAudioDevicesTest, test_find_by_conn_id_after_update) {
+  devices_->Add(GetTestAddress(0), DeviceConnectState::CONNECTING_BY_USER);
+  devices_->Add(GetTestAddress(1), DeviceConnectState::CONNECTING_BY_USER);
+  LeAudioDevice* device_0 = devices_->FindByAddress(GetTestAddress(0));
+  LeAudioDevice* device_1 = devices_->FindByAddress(GetTestAddress(1));
+
+  device_0->conn_id_ = 0x0005;
+  ASSERT_EQ(device_0, devices_->FindByConnId(0x0005));
+
+  /* The connection id moves to another device */
+  device_0->conn_id_ = GATT_INVALID_CONN_ID;
+  device_1->conn_id_ = 0x0005;
+  ASSERT_EQ(device_1, devices_->FindByConnId(0x0005));
+
+  devices_->Remove(GetTestAddress(1));
+  ASSERT_EQ(nullptr, devices_->FindByConnId(0x0005));
+  ASSERT_EQ(nullptr, devices_->FindByAddress(GetTestAddress(1)));
+  ASSERT_EQ(device_0, devices_->FindByAddress(GetTestAddress(0)));
+}
+
+TEST_F(LeAudioDevicesTest, test_find_by_cis_conn_hdl_after_update) {
+  const int group_id = 1;
+  devices_->Add(GetTestAddress(0), DeviceConnectState::CONNECTED, group_id);
+  devices_->Add(GetTestAddress(1), DeviceConnectState::CONNECTED, group_id);
+  LeAudioDevice* device_0 = devices_->FindByAddress(GetTestAddress(0));
+  LeAudioDevice* device_1 = devices_->FindByAddress(GetTestAddress(1));
+  device_0->ases_.emplace_back(0x0001, 0x0002, kLeAudioDirectionSink, 1);
+  device_1->ases_.emplace_back(0x0003, 0x0004, kLeAudioDirectionSink, 1);
+
+  device_0->ases_[0].cis_conn_hdl = 0x0060;
+  device_1->ases_[0].cis_conn_hdl = 0x0061;
+  ASSERT_EQ(device_0, devices_->FindByCisConnHdl(group_id, 0x0060));
+  ASSERT_EQ(device_1, devices_->FindByCisConnHdl(group_id, 0x0061));
+  ASSERT_EQ(nullptr, devices_->FindByCisConnHdl(group_id + 1, 0x0060));
+
+  /* The CIS handles are reassigned on the next stream setup */
+  device_0->ases_[0].cis_conn_hdl = 0x0061;
+  device_1->ases_[0].cis_conn_hdl = 0x0060;
+  ASSERT_EQ(device_1, devices_->FindByCisConnHdl(group_id, 0x0060));
+  ASSERT_EQ(device_0, devices_->FindByCisConnHdl(group_id, 0x0061));
+
+  devices_->Remove(GetTestAddress(0));
+  ASSERT_EQ(nullptr, devices_->FindByCisConnHdl(group_id, 0x0061));
+}
+
 TEST_F(LeAudioDevicesTest, test_get_device_model_name_success) {
   RawAddress test_address_0 = GetTestAddress(0);
   devices_->Add(test_address_0, DeviceConnectState::CONNECTING_BY_USER);
@@ -199,8 +244,6 @@ TEST_F(LeAudioDevicesTest, test_get_device_model_name_failed) {
   ASSERT_EQ("Test", device->model_name_);
 }
 
-/* TODO: Add FindByCisConnHdl test cases (ASE) */
-
 }  // namespace
 
 namespace {
@@ -1116,6 +1159,76 @@ TEST_F(LeAudioAseConfigurationTest, test_context_update) {
       group_->IsAudioSetConfigurationAvailable(LeAudioContextType::ALERTS));
 }
 
+TEST_F(LeAudioAseConfigurationTest, test_configuration_memoized) {
+  LeAudioDevice* left = AddTestDevice(1, 1);
+  LeAudioDevice* right = AddTestDevice(1, 1);
+  ASSERT_EQ(2, group_->Size());
+
+  left->snk_audio_locations_ =
+      ::le_audio::codec_spec_conf::kLeAudioLocationFrontLeft;
+  left->src_audio_locations_ =
+      ::le_audio::codec_spec_conf::kLeAudioLocationFrontLeft;
+  right->snk_audio_locations_ =
+      ::le_audio::codec_spec_conf::kLeAudioLocationFrontRight;
+  right->src_audio_locations_ =
+      ::le_audio::codec_spec_conf::kLeAudioLocationFrontRight;
+  group_->ReloadAudioLocations();
+
+  auto conversational_configuration = getSpecificConfiguration(
+      "SingleDev_OneChanStereoSnk_OneChanMonoSrc_16_2_Low_Latency",
+      LeAudioContextType::CONVERSATIONAL);
+  auto media_configuration = getSpecificConfiguration(
+      "SingleDev_TwoChanStereoSnk_48_4_High_Reliability",
+      LeAudioContextType::MEDIA);
+  ASSERT_NE(nullptr, conversational_configuration);
+  ASSERT_NE(nullptr, media_configuration);
+
+  PublishedAudioCapabilitiesBuilder snk_pac_builder, src_pac_builder;
+  for (const auto& entry : (*conversational_configuration).confs) {
+    if (entry.direction == kLeAudioDirectionSink) {
+      snk_pac_builder.Add(entry.codec, 1);
+    } else {
+      src_pac_builder.Add(entry.codec, 1);
+    }
+  }
+  for (const auto& entry : (*media_configuration).confs) {
+    if (entry.direction == kLeAudioDirectionSink) {
+      snk_pac_builder.Add(entry.codec, 2);
+    }
+  }
+  left->snk_pacs_ = snk_pac_builder.Get();
+  left->src_pacs_ = src_pac_builder.Get();
+  right->snk_pacs_ = snk_pac_builder.Get();
+  right->src_pacs_ = src_pac_builder.Get();
+
+  auto conf = group_->GetConfiguration(LeAudioContextType::MEDIA);
+  ASSERT_NE(nullptr, conf);
+
+  /* The selection remains after the cache invalidation */
+  group_->InvalidateCachedConfigurations();
+  ASSERT_EQ(conf, group_->GetConfiguration(LeAudioContextType::MEDIA));
+
+  /* Without the sink PACs there is nothing to select */
+  left->snk_pacs_.clear();
+  right->snk_pacs_.clear();
+  group_->InvalidateCachedConfigurations();
+  ASSERT_EQ(nullptr, group_->GetConfiguration(LeAudioContextType::MEDIA));
+
+  /* Restoring the PACs gives back the same selection */
+  left->snk_pacs_ = snk_pac_builder.Get();
+  right->snk_pacs_ = snk_pac_builder.Get();
+  group_->InvalidateCachedConfigurations();
+  ASSERT_EQ(conf, group_->GetConfiguration(LeAudioContextType::MEDIA));
+
+  /* A member disconnection is a distinct group state */
+  right->SetConnectionState(DeviceConnectState::DISCONNECTED);
+  group_->InvalidateCachedConfigurations();
+  group_->GetConfiguration(LeAudioContextType::MEDIA);
+  right->SetConnectionState(DeviceConnectState::CONNECTED);
+  group_->InvalidateCachedConfigurations();
+  ASSERT_EQ(conf, group_->GetConfiguration(LeAudioContextType::MEDIA));
+}
+
 TEST_F(LeAudioAseConfigurationTest, test_mono_speaker_ringtone) {
   LeAudioDevice* mono_speaker = AddTestDevice(1, 0);
   TestGroupAseConfigurationData data(
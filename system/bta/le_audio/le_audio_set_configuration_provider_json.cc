@@ -16,6 +16,10 @@
  */
 
 #include <base/logging.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <mutex>
 #include <string>
@@ -43,42 +47,86 @@ using le_audio::types::LeAudioContextType;
 namespace le_audio {
 using ::le_audio::CodecManager;
 
+/* The configuration files are compiled at build time into binary
+ * flatbuffers, used in place. The JSON files are only parsed, against the
+ * binary schema, if the binary file cannot be used or if the
+ * kUseJsonConfigurationsProp development override is set.
+ */
+struct ConfigurationFiles {
+  const char* binary;
+  const char* schema;
+  const char* json;
+};
+
 #ifdef __ANDROID__
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.bfbs",
-         "/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {{"/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.bfbs",
-                             "/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetConfigs = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetScenarios = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.json"}};
 #elif defined(TARGET_FLOSS)
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"/etc/bluetooth/le_audio/audio_set_configurations.bfbs",
-         "/etc/bluetooth/le_audio/audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {
-        {"/etc/bluetooth/le_audio/audio_set_scenarios.bfbs",
-         "/etc/bluetooth/le_audio/audio_set_scenarios.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetConfigs = {
+    {"/etc/bluetooth/le_audio/audio_set_configurations.bin",
+     "/etc/bluetooth/le_audio/audio_set_configurations.bfbs",
+     "/etc/bluetooth/le_audio/audio_set_configurations.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetScenarios = {
+    {"/etc/bluetooth/le_audio/audio_set_scenarios.bin",
+     "/etc/bluetooth/le_audio/audio_set_scenarios.bfbs",
+     "/etc/bluetooth/le_audio/audio_set_scenarios.json"}};
 #else
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"audio_set_configurations.bfbs", "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {
-        {"audio_set_scenarios.bfbs", "audio_set_scenarios.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetConfigs = {
+    {"audio_set_configurations.bin", "audio_set_configurations.bfbs",
+     "audio_set_configurations.json"}};
+static const std::vector<ConfigurationFiles> kLeAudioSetScenarios = {
+    {"audio_set_scenarios.bin", "audio_set_scenarios.bfbs",
+     "audio_set_scenarios.json"}};
 #endif
 
+static constexpr char kUseJsonConfigurationsProp[] =
+    "persist.bluetooth.leaudio.use_json_set_configurations";
+
+/* Read-only mapping of a binary flatbuffer file */
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const uint8_t*>(data);
+        size_ = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) munmap(const_cast<uint8_t*>(data_), size_);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 /** Provides a set configurations for the given context type */
 struct AudioSetConfigurationProviderJson {
   static constexpr auto kDefaultScenario = "Media";
@@ -86,6 +134,7 @@ struct AudioSetConfigurationProviderJson {
   AudioSetConfigurationProviderJson(types::CodecLocation location) {
     dual_bidirection_swb_supported_ = osi_property_get_bool(
         "bluetooth.leaudio.dual_bidirection_swb.supported", false);
+    use_json_ = osi_property_get_bool(kUseJsonConfigurationsProp, false);
     ASSERT_LOG(LoadContent(kLeAudioSetConfigs, kLeAudioSetScenarios, location),
                ": Unable to load le audio set configuration files.");
   }
@@ -183,6 +232,7 @@ struct AudioSetConfigurationProviderJson {
    * supported or not
    */
   bool dual_bidirection_swb_supported_;
+  bool use_json_;
 
   static const bluetooth::le_audio::CodecSpecificConfiguration*
   LookupCodecSpecificParam(
@@ -434,34 +484,57 @@ struct AudioSetConfigurationProviderJson {
     }
   }
 
-  bool LoadConfigurationsFromFiles(const char* schema_file,
-                                   const char* content_file,
-                                   types::CodecLocation location) {
-    flatbuffers::Parser configurations_parser_;
-    std::string configurations_schema_binary_content;
-    bool ok = flatbuffers::LoadFile(schema_file, true,
-                                    &configurations_schema_binary_content);
+  /* Parses the JSON |content_file| against the binary |schema_file|, into
+   * the builder of |parser|. */
+  static bool ParseJsonFile(flatbuffers::Parser& parser,
+                            const char* schema_file, const char* content_file) {
+    std::string schema_binary_content;
+    bool ok = flatbuffers::LoadFile(schema_file, true, &schema_binary_content);
     if (!ok) return ok;
 
     /* Load the binary schema */
-    ok = configurations_parser_.Deserialize(
-        (uint8_t*)configurations_schema_binary_content.c_str(),
-        configurations_schema_binary_content.length());
+    ok = parser.Deserialize((uint8_t*)schema_binary_content.c_str(),
+                            schema_binary_content.length());
     if (!ok) return ok;
 
     /* Load the content from JSON */
-    std::string configurations_json_content;
-    ok = flatbuffers::LoadFile(content_file, false,
-                               &configurations_json_content);
+    std::string json_content;
+    ok = flatbuffers::LoadFile(content_file, false, &json_content);
     if (!ok) return ok;
 
     /* Parse */
-    ok = configurations_parser_.Parse(configurations_json_content.c_str());
-    if (!ok) return ok;
+    return parser.Parse(json_content.c_str());
+  }
+
+  bool LoadConfigurationsFromFiles(const ConfigurationFiles& files,
+                                   types::CodecLocation location) {
+    if (!use_json_) {
+      MappedFile binary(files.binary);
+      if (binary.data() != nullptr) {
+        flatbuffers::Verifier verifier(binary.data(), binary.size());
+        if (bluetooth::le_audio::VerifyAudioSetConfigurationsBuffer(verifier)) {
+          return LoadConfigurations(
+              bluetooth::le_audio::GetAudioSetConfigurations(binary.data()),
+              location);
+        }
+        LOG_ERROR("Invalid binary configurations %s", files.binary);
+      }
+      LOG_WARN("Unable to use %s, parsing %s", files.binary, files.json);
+    }
 
-    /* Import from flatbuffers */
-    auto configurations_root = bluetooth::le_audio::GetAudioSetConfigurations(
-        configurations_parser_.builder_.GetBufferPointer());
+    flatbuffers::Parser configurations_parser_;
+    if (!ParseJsonFile(configurations_parser_, files.schema, files.json))
+      return false;
+
+    return LoadConfigurations(
+        bluetooth::le_audio::GetAudioSetConfigurations(
+            configurations_parser_.builder_.GetBufferPointer()),
+        location);
+  }
+
+  bool LoadConfigurations(
+      const bluetooth::le_audio::AudioSetConfigurations* configurations_root,
+      types::CodecLocation location) {
     if (!configurations_root) return false;
 
     auto flat_qos_configs = configurations_root->qos_configurations();
@@ -515,32 +588,30 @@ struct AudioSetConfigurationProviderJson {
     return items;
   }
 
-  bool LoadScenariosFromFiles(const char* schema_file,
-                              const char* content_file) {
-    flatbuffers::Parser scenarios_parser_;
-    std::string scenarios_schema_binary_content;
-    bool ok = flatbuffers::LoadFile(schema_file, true,
-                                    &scenarios_schema_binary_content);
-    if (!ok) return ok;
-
-    /* Load the binary schema */
-    ok = scenarios_parser_.Deserialize(
-        (uint8_t*)scenarios_schema_binary_content.c_str(),
-        scenarios_schema_binary_content.length());
-    if (!ok) return ok;
+  bool LoadScenariosFromFiles(const ConfigurationFiles& files) {
+    if (!use_json_) {
+      MappedFile binary(files.binary);
+      if (binary.data() != nullptr) {
+        flatbuffers::Verifier verifier(binary.data(), binary.size());
+        if (bluetooth::le_audio::VerifyAudioSetScenariosBuffer(verifier)) {
+          return LoadScenarios(
+              bluetooth::le_audio::GetAudioSetScenarios(binary.data()));
+        }
+        LOG_ERROR("Invalid binary scenarios %s", files.binary);
+      }
+      LOG_WARN("Unable to use %s, parsing %s", files.binary, files.json);
+    }
 
-    /* Load the content from JSON */
-    std::string scenarios_json_content;
-    ok = flatbuffers::LoadFile(content_file, false, &scenarios_json_content);
-    if (!ok) return ok;
+    flatbuffers::Parser scenarios_parser_;
+    if (!ParseJsonFile(scenarios_parser_, files.schema, files.json))
+      return false;
 
-    /* Parse */
-    ok = scenarios_parser_.Parse(scenarios_json_content.c_str());
-    if (!ok) return ok;
+    return LoadScenarios(bluetooth::le_audio::GetAudioSetScenarios(
+        scenarios_parser_.builder_.GetBufferPointer()));
+  }
 
-    /* Import from flatbuffers */
-    auto scenarios_root = bluetooth::le_audio::GetAudioSetScenarios(
-        scenarios_parser_.builder_.GetBufferPointer());
+  bool LoadScenarios(
+      const bluetooth::le_audio::AudioSetScenarios* scenarios_root) {
     if (!scenarios_root) return false;
 
     auto flat_scenarios = scenarios_root->scenarios();
@@ -566,18 +637,15 @@ struct AudioSetConfigurationProviderJson {
     return true;
   }
 
-  bool LoadContent(
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          config_files,
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          scenario_files,
-      types::CodecLocation location) {
-    for (auto [schema, content] : config_files) {
-      if (!LoadConfigurationsFromFiles(schema, content, location)) return false;
+  bool LoadContent(std::vector<ConfigurationFiles> config_files,
+                   std::vector<ConfigurationFiles> scenario_files,
+                   types::CodecLocation location) {
+    for (auto const& files : config_files) {
+      if (!LoadConfigurationsFromFiles(files, location)) return false;
     }
 
-    for (auto [schema, content] : scenario_files) {
-      if (!LoadScenariosFromFiles(schema, content)) return false;
+    for (auto const& files : scenario_files) {
+      if (!LoadScenariosFromFiles(files)) return false;
     }
     return true;
   }
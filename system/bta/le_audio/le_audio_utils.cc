@@ -16,6 +16,12 @@
 
 #include "le_audio_utils.h"
 
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "bta/le_audio/content_control_id_keeper.h"
 #include "gd/common/strings.h"
 #include "le_audio_types.h"
@@ -383,5 +389,62 @@ GetRemoteBtLeAudioCodecConfigFromPac(
   return vec;
 }
 
+void InterleaveStereo(const int16_t* left, const int16_t* right, int16_t* out,
+                      size_t num_samples) {
+  size_t i = 0;
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+  for (; i + 8 <= num_samples; i += 8) {
+    int16x8x2_t lr = {{vld1q_s16(left + i), vld1q_s16(right + i)}};
+    vst2q_s16(out + 2 * i, lr);
+  }
+#elif defined(__SSE2__)
+  for (; i + 8 <= num_samples; i += 8) {
+    __m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+    __m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+    _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(l, r));
+    _mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+  }
+#endif
+  for (; i < num_samples; i++) {
+    out[2 * i] = left[i];
+    out[2 * i + 1] = right[i];
+  }
+}
+
+void DownmixStereoToMono(int16_t* left, const int16_t* right,
+                         size_t num_samples) {
+  size_t i = 0;
+  /* The sums are widened to 32 bits, and their sign bit is added before the
+   * shift so that the result matches the integer division. */
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+  for (; i + 8 <= num_samples; i += 8) {
+    int16x8_t l = vld1q_s16(left + i);
+    int16x8_t r = vld1q_s16(right + i);
+    int32x4_t lo = vaddl_s16(vget_low_s16(l), vget_low_s16(r));
+    int32x4_t hi = vaddl_high_s16(l, r);
+    lo = vreinterpretq_s32_u32(vsraq_n_u32(vreinterpretq_u32_s32(lo),
+                                           vreinterpretq_u32_s32(lo), 31));
+    hi = vreinterpretq_s32_u32(vsraq_n_u32(vreinterpretq_u32_s32(hi),
+                                           vreinterpretq_u32_s32(hi), 31));
+    vst1q_s16(left + i, vcombine_s16(vshrn_n_s32(lo, 1), vshrn_n_s32(hi, 1)));
+  }
+#elif defined(__SSE2__)
+  for (; i + 8 <= num_samples; i += 8) {
+    __m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+    __m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+    __m128i lo = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(l, l), 16),
+                               _mm_srai_epi32(_mm_unpacklo_epi16(r, r), 16));
+    __m128i hi = _mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(l, l), 16),
+                               _mm_srai_epi32(_mm_unpackhi_epi16(r, r), 16));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_srli_epi32(lo, 31)), 1);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_srli_epi32(hi, 31)), 1);
+    _mm_storeu_si128((__m128i*)(left + i), _mm_packs_epi32(lo, hi));
+  }
+#endif
+  for (; i < num_samples; i++) {
+    left[i] = (left[i] + right[i]) / 2;
+  }
+}
+
 }  // namespace utils
 }  // namespace le_audio
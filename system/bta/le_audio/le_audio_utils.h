@@ -57,5 +57,16 @@ void fillStreamParamsToBtLeAudioCodecConfig(
 std::vector<bluetooth::le_audio::btle_audio_codec_config_t>
 GetRemoteBtLeAudioCodecConfigFromPac(
     const types::PublishedAudioCapabilities& group_pacs);
+
+/* Interleaves |num_samples| samples of |left| and |right| into |out|, which
+ * holds 2 * |num_samples| samples. |left| and |right| may be the same buffer.
+ */
+void InterleaveStereo(const int16_t* left, const int16_t* right, int16_t* out,
+                      size_t num_samples);
+/* Replaces the |num_samples| samples of |left| with the average of |left| and
+ * |right|, rounded towards zero.
+ */
+void DownmixStereoToMono(int16_t* left, const int16_t* right,
+                         size_t num_samples);
 }  // namespace utils
 }  // namespace le_audio
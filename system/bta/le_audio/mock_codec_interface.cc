@@ -64,4 +64,35 @@ uint16_t CodecInterface::GetNumOfSamplesPerChannel() {
 uint8_t CodecInterface::GetNumOfBytesPerSample() {
   return impl->GetNumOfBytesPerSample();
 };
+
+// The channels are encoded sequentially, through the mocked instances
+struct MultiChannelEncoder::Impl {};
+
+MultiChannelEncoder::MultiChannelEncoder(size_t max_channels)
+    : impl(std::make_unique<Impl>()) {}
+MultiChannelEncoder::~MultiChannelEncoder() = default;
+CodecInterface::Status MultiChannelEncoder::Encode(
+    const std::vector<Channel>& channels, uint32_t frame_interval_us) {
+  return Encode(channels, frame_interval_us, nullptr);
+}
+CodecInterface::Status MultiChannelEncoder::Encode(
+    const std::vector<Channel>& channels, uint32_t frame_interval_us,
+    const ChannelEncodedCallback& on_channel_encoded) {
+  auto result = CodecInterface::Status::STATUS_OK;
+  for (size_t index = 0; index < channels.size(); index++) {
+    const auto& channel = channels[index];
+    auto status =
+        channel.codec->Encode(channel.data, channel.stride, channel.out_size,
+                              channel.out_buffer, channel.out_offset);
+    if (result == CodecInterface::Status::STATUS_OK) result = status;
+    if (on_channel_encoded) on_channel_encoded(index);
+  }
+  return result;
+}
+bool MultiChannelEncoder::IsParallel() const { return false; }
+MultiChannelEncoder::DeadlineStats MultiChannelEncoder::GetDeadlineStats()
+    const {
+  return DeadlineStats();
+}
+void MultiChannelEncoder::Dump(int fd) const {}
 }  // namespace le_audio
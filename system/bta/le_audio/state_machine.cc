@@ -2144,6 +2144,16 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
           return;
         }
 
+        /* Enable only depends on the QoS of this device, and the CIG is
+         * already created, so don't wait for the other members. The CISes
+         * are created once all of them are enabled.
+         */
+        if (group->GetTargetState() ==
+            AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
+          PrepareAndSendEnable(leAudioDevice);
+          return;
+        }
+
         if (!group->HaveAllActiveDevicesAsesTheSameState(
                 AseState::BTA_LE_AUDIO_ASE_STATE_QOS_CONFIGURED)) {
           LOG_DEBUG("Waiting for all the devices to be in QoS state");
@@ -2603,6 +2603,47 @@ TEST_F(StateMachineTest, testStreamMultiple) {
   ASSERT_EQ(1, get_func_call_count("alarm_cancel"));
 }
 
+TEST_F(StateMachineTest, testStreamMultiple_EnableDoesNotWaitForOtherMembers) {
+  const auto context_type = kContextTypeMedia;
+  const auto leaudio_group_id = 4;
+  const auto num_devices = 2;
+
+  // Prepare multiple fake connected devices in a group
+  auto* group =
+      PrepareSingleTestDeviceGroup(leaudio_group_id, context_type, num_devices);
+  ASSERT_EQ(group->Size(), num_devices);
+
+  auto* firstDevice = group->GetFirstDevice();
+  auto* lastDevice = group->GetNextDevice(firstDevice);
+  ASSERT_NE(nullptr, lastDevice);
+
+  PrepareConfigureCodecHandler(group);
+  PrepareConfigureQosHandler(group);
+  PrepareEnableHandler(group);
+
+  // The last member does not answer the QoS Configure
+  ON_CALL(ase_ctp_handler, AseCtpConfigureQosHandler(lastDevice, _, _, _))
+      .WillByDefault(Return());
+
+  EXPECT_CALL(*mock_iso_manager_, CreateCig(_, _)).Times(1);
+  EXPECT_CALL(*mock_iso_manager_, EstablishCis(_)).Times(0);
+  EXPECT_CALL(ase_ctp_handler, AseCtpEnableHandler(firstDevice, _, _, _))
+      .Times(1);
+  EXPECT_CALL(ase_ctp_handler, AseCtpEnableHandler(lastDevice, _, _, _))
+      .Times(0);
+
+  InjectInitialIdleNotification(group);
+
+  // Start the configuration and stream Media content
+  ASSERT_TRUE(LeAudioGroupStateMachine::Get()->StartStream(
+      group, context_type,
+      {.sink = types::AudioContexts(context_type),
+       .source = types::AudioContexts(context_type)}));
+
+  ASSERT_NE(group->GetState(),
+            types::AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING);
+}
+
 TEST_F(StateMachineTest, testUpdateMetadataMultiple) {
   const auto context_type = kContextTypeMedia;
   const auto leaudio_group_id = 4;
@@ -44,6 +44,15 @@ typedef struct {
   tBTA_SYS_CONN_CBACK* p_coll_cback[MAX_COLLISION_REG];
 } tBTA_SYS_COLLISION;
 
+/* Statistics of the messages dispatched to a subsystem */
+typedef struct {
+  uint64_t num_msgs;
+  uint64_t total_delay_us; /* from posting to dispatching */
+  uint32_t max_delay_us;
+  uint64_t total_handler_us; /* spent in the subsystem event handler */
+  uint32_t max_handler_us;
+} tBTA_SYS_MSG_STATS;
+
 /* system manager control block */
 typedef struct {
   tBTA_SYS_REG* reg[BTA_ID_MAX]; /* registration structures */
@@ -67,6 +76,9 @@ typedef struct {
   /* VS event handler */
   tBTA_SYS_VS_EVT_HDLR* p_vs_evt_hdlr;
 
+  tBTA_SYS_MSG_STATS msg_stats[BTA_ID_MAX]; /* written on the main thread */
+  uint64_t msg_stats_start_us;
+
 } tBTA_SYS_CB;
 
 /*****************************************************************************
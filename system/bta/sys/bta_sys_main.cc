@@ -27,12 +27,16 @@
 #include <base/functional/bind.h>
 #include <base/logging.h>
 
+#include <algorithm>
+#include <cinttypes>
 #include <cstring>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/sys/bta_sys.h"
 #include "bta/sys/bta_sys_int.h"
+#include "common/time_util.h"
 #include "include/hardware/bluetooth.h"
+#include "main/shim/dumpsys.h"
 #include "osi/include/alarm.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
@@ -56,8 +60,30 @@ tBTA_SYS_CB bta_sys_cb;
  ******************************************************************************/
 void bta_sys_init(void) {
   memset(&bta_sys_cb, 0, sizeof(tBTA_SYS_CB));
+  bta_sys_cb.msg_stats_start_us = bluetooth::common::time_get_os_boottime_us();
 }
 
+#define DUMPSYS_TAG "shim::legacy::bta::sys"
+void DumpsysBtaSys(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  uint64_t elapsed_us = bluetooth::common::time_get_os_boottime_us() -
+                        bta_sys_cb.msg_stats_start_us;
+  uint64_t elapsed_s = std::max<uint64_t>(elapsed_us / 1000000, 1);
+  for (int id = 0; id < BTA_ID_MAX; id++) {
+    const tBTA_SYS_MSG_STATS& stats = bta_sys_cb.msg_stats[id];
+    if (stats.num_msgs == 0) continue;
+    LOG_DUMPSYS(fd,
+                "  %s: msgs:%" PRIu64 " rate:%" PRIu64
+                "/s queue delay (us) avg:%" PRIu64 " max:%u handler (us) "
+                "avg:%" PRIu64 " max:%u",
+                BtaIdSysText(static_cast<tBTA_SYS_ID>(id)).c_str(),
+                stats.num_msgs, stats.num_msgs / elapsed_s,
+                stats.total_delay_us / stats.num_msgs, stats.max_delay_us,
+                stats.total_handler_us / stats.num_msgs, stats.max_handler_us);
+  }
+}
+#undef DUMPSYS_TAG
+
 void bta_set_forward_hw_failures(bool value) {
   bta_sys_cb.forward_hw_failures = value;
 }
@@ -78,7 +104,7 @@ void BTA_sys_signal_hw_error() {
  * Returns          void
  *
  ******************************************************************************/
-static void bta_sys_event(BT_HDR_RIGID* p_msg) {
+static void bta_sys_event(BT_HDR_RIGID* p_msg, uint64_t due_us) {
   bool freebuf = true;
 
   LOG_VERBOSE("%s: Event 0x%x", __func__, p_msg->event);
@@ -88,7 +114,18 @@ static void bta_sys_event(BT_HDR_RIGID* p_msg) {
 
   /* verify id and call subsystem event handler */
   if ((id < BTA_ID_MAX) && (bta_sys_cb.reg[id] != NULL)) {
+    tBTA_SYS_MSG_STATS& stats = bta_sys_cb.msg_stats[id];
+    uint64_t start_us = bluetooth::common::time_get_os_boottime_us();
     freebuf = (*bta_sys_cb.reg[id]->evt_hdlr)(p_msg);
+    uint64_t end_us = bluetooth::common::time_get_os_boottime_us();
+
+    uint32_t delay_us = start_us > due_us ? start_us - due_us : 0;
+    uint32_t handler_us = end_us - start_us;
+    stats.num_msgs++;
+    stats.total_delay_us += delay_us;
+    stats.max_delay_us = std::max(stats.max_delay_us, delay_us);
+    stats.total_handler_us += handler_us;
+    stats.max_handler_us = std::max(stats.max_handler_us, handler_us);
   } else {
     LOG_INFO("Ignoring receipt of unregistered event id:%s[%hhu]",
              BtaIdSysText(static_cast<tBTA_SYS_ID>(id)).c_str(), id);
@@ -159,7 +196,8 @@ bool bta_sys_is_register(uint8_t id) { return bta_sys_cb.is_reg[id]; }
 void bta_sys_sendmsg(void* p_msg) {
   if (do_in_main_thread(
           FROM_HERE,
-          base::BindOnce(&bta_sys_event, static_cast<BT_HDR_RIGID*>(p_msg))) !=
+          base::BindOnce(&bta_sys_event, static_cast<BT_HDR_RIGID*>(p_msg),
+                         bluetooth::common::time_get_os_boottime_us())) !=
       BT_STATUS_SUCCESS) {
     LOG(ERROR) << __func__ << ": do_in_main_thread failed";
   }
@@ -168,7 +206,9 @@ void bta_sys_sendmsg(void* p_msg) {
 void bta_sys_sendmsg_delayed(void* p_msg, const base::TimeDelta& delay) {
   if (do_in_main_thread_delayed(
           FROM_HERE,
-          base::Bind(&bta_sys_event, static_cast<BT_HDR_RIGID*>(p_msg)),
+          base::Bind(&bta_sys_event, static_cast<BT_HDR_RIGID*>(p_msg),
+                     bluetooth::common::time_get_os_boottime_us() +
+                         delay.InMicroseconds()),
           delay) != BT_STATUS_SUCCESS) {
     LOG(ERROR) << __func__ << ": do_in_main_thread_delayed failed";
   }
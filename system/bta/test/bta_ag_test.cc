@@ -314,3 +314,73 @@ TEST_F_WITH_FLAGS(BtaAgCmdTest,
   ASSERT_EQ(this->codec, ESCO_CODEC_SWB_Q0);
   ASSERT_TRUE(enable_aptx_voice_property(false));
 }
+
+namespace {
+
+/* Commands sharing a bucket of the AT command index, in an order where a
+ * shorter command shadows a longer one */
+const tBTA_AG_AT_CMD bta_ag_at_test_cmd[] = {
+    {"A", 1, BTA_AG_AT_NONE, BTA_AG_AT_STR, 0, 0},
+    {"D", 2, BTA_AG_AT_NONE | BTA_AG_AT_FREE, BTA_AG_AT_STR, 0, 0},
+    {"+BIA", 3, BTA_AG_AT_SET, BTA_AG_AT_STR, 0, 0},
+    {"+BI", 4, BTA_AG_AT_SET | BTA_AG_AT_FREE, BTA_AG_AT_STR, 0, 0},
+    {"+BIND", 5, BTA_AG_AT_SET, BTA_AG_AT_STR, 0, 0},
+    {"+VGS", 6, BTA_AG_AT_SET, BTA_AG_AT_INT, 0, 15},
+    {"+%QAC", 7, BTA_AG_AT_SET, BTA_AG_AT_STR, 0, 0},
+    {"", 0, 0, 0, 0, 0}};
+
+std::vector<uint16_t> at_test_commands;
+std::vector<std::string> at_test_args;
+int at_test_errors = 0;
+
+}  // namespace
+
+class BtaAgAtTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    at_test_commands.clear();
+    at_test_args.clear();
+    at_test_errors = 0;
+    at_cb_.p_at_tbl = bta_ag_at_test_cmd;
+    at_cb_.p_cmd_cback = [](tBTA_AG_SCB* p_user, uint16_t command_id,
+                            uint8_t arg_type, char* p_arg, char* p_end,
+                            int16_t int_arg) {
+      at_test_commands.push_back(command_id);
+      at_test_args.push_back(p_arg);
+    };
+    at_cb_.p_err_cback = [](tBTA_AG_SCB* p_user, bool unknown,
+                            const char* p_arg) { at_test_errors++; };
+    at_cb_.p_user = nullptr;
+    at_cb_.cmd_max_len = 512;
+    bta_ag_at_init(&at_cb_);
+  }
+  void TearDown() override { bta_ag_at_reinit(&at_cb_); }
+
+  void Parse(std::string line) {
+    bta_ag_at_parse(&at_cb_, line.data(), line.size());
+  }
+
+  tBTA_AG_AT_CB at_cb_ = {};
+};
+
+TEST_F(BtaAgAtTest, parse_matches_first_command_of_table) {
+  Parse("ATA\rATD1234;\rAT+BIA=1,0\rAT+BIND=1,2\rAT+%QAC=0,4\r");
+  std::vector<uint16_t> expected_commands = {1, 2, 3, 4, 7};
+  std::vector<std::string> expected_args = {"", "1234;", "1,0", "ND=1,2",
+                                            "0,4"};
+  ASSERT_EQ(expected_commands, at_test_commands);
+  ASSERT_EQ(expected_args, at_test_args);
+  ASSERT_EQ(0, at_test_errors);
+}
+
+TEST_F(BtaAgAtTest, parse_is_case_insensitive) {
+  Parse("at+vgs=7\r");
+  ASSERT_EQ(std::vector<uint16_t>{6}, at_test_commands);
+  ASSERT_EQ(0, at_test_errors);
+}
+
+TEST_F(BtaAgAtTest, parse_unknown_and_invalid_commands) {
+  Parse("AT+CLCC\rAT+VGS=16\rAT+\r");
+  ASSERT_TRUE(at_test_commands.empty());
+  ASSERT_EQ(3, at_test_errors);
+}
@@ -103,3 +103,20 @@ TEST_F(BtaHhTest, bta_hh_ctrl_dat_act__BTA_HH_GET_RPT_EVT) {
   bta_hh_ctrl_dat_act(&cb, &data);
   ASSERT_EQ(cb.w4_evt, 0);
 }
+
+TEST_F(BtaHhTest, bta_hh_update_rpt_stats) {
+  tBTA_HH_RPT_STATS stats = {};
+
+  bta_hh_update_rpt_stats(&stats, 1000, 1100);
+  bta_hh_update_rpt_stats(&stats, 2000, 2600);
+  // Reports without a timestamp are not accounted.
+  bta_hh_update_rpt_stats(&stats, 0, 3000);
+
+  ASSERT_EQ(2UL, stats.latency.count);
+  ASSERT_EQ(600U, stats.latency.max_us);
+  ASSERT_EQ("count:2 mean:350 max:600 histogram:1/0/1/0/0/0/0/0",
+            bta_hh_rpt_hist_text(stats.latency));
+  ASSERT_EQ("count:1 mean:1000 max:1000 histogram:0/0/0/1/0/0/0/0",
+            bta_hh_rpt_hist_text(stats.interval));
+  ASSERT_EQ(2000UL, stats.last_rpt_us);
+}
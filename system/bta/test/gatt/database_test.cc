@@ -552,4 +552,48 @@ TEST(GattDatabaseTest, serialized_hash_test) {
   EXPECT_EQ(db_from_disk.Hash(), db_from_serialized.Hash());
 }
 
+/* Make sure the flat view of the database resolves handles the same way as
+ * walking the services, including for copies of the database */
+TEST(GattDatabaseTest, find_attributes_by_handle_test) {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0020, 0x002f, SERVICE_2_UUID, false);
+  builder.AddIncludedService(0x0002, SERVICE_2_UUID, 0x0020, 0x002f);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, SERVICE_1_CHAR_1_DESC_1_UUID);
+  builder.AddCharacteristic(0x0021, 0x0022, SERVICE_1_CHAR_1_UUID, 0x10);
+
+  Database original = builder.Build();
+  Database copy;
+  copy = original;
+
+  for (const Database* db : {&original, &copy}) {
+    EXPECT_EQ(db->FindService(0x0000), nullptr);
+    EXPECT_EQ(db->FindService(0x000f)->handle, 0x0001);
+    EXPECT_EQ(db->FindService(0x0010), nullptr);
+    EXPECT_EQ(db->FindService(0x0025)->handle, 0x0020);
+
+    EXPECT_EQ(db->FindCharacteristic(0x0003), nullptr);
+    EXPECT_EQ(db->FindCharacteristic(0x0004)->declaration_handle, 0x0003);
+    EXPECT_EQ(db->FindCharacteristic(0x0022)->properties, 0x10);
+    EXPECT_EQ(db->FindCharacteristic(0x0005), nullptr);
+
+    EXPECT_EQ(db->FindDescriptor(0x0005)->uuid, SERVICE_1_CHAR_1_DESC_1_UUID);
+    EXPECT_EQ(db->FindDescriptor(0x0004), nullptr);
+    EXPECT_EQ(db->FindOwningCharacteristic(0x0005)->value_handle, 0x0004);
+    EXPECT_EQ(db->FindOwningCharacteristic(0x0022), nullptr);
+
+    // service, characteristic, descriptor, included service, then the second
+    // service with its characteristic
+    ASSERT_EQ(db->Attributes().size(), 6u);
+    EXPECT_EQ(db->Attributes()[3].type,
+              DatabaseAttribute::Type::INCLUDED_SERVICE);
+    using Range = std::pair<size_t, size_t>;
+    EXPECT_EQ(db->ServicesAttributes(0x0001, 0xffff), Range(0, 6));
+    EXPECT_EQ(db->ServicesAttributes(0x0002, 0xffff), Range(4, 6));
+    EXPECT_EQ(db->ServicesAttributes(0x0001, 0x0020), Range(0, 4));
+    EXPECT_EQ(db->ServicesAttributes(0x0030, 0xffff), Range(6, 6));
+  }
+}
+
 }  // namespace gatt
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <queue>
 #include <vector>
 
@@ -71,7 +73,11 @@ struct VolumeOperation {
   uint8_t opcode_;
   std::vector<uint8_t> arguments_;
 
+  /* Devices which did not complete the operation yet */
   std::vector<RawAddress> devices_;
+  /* Devices to which the operation was written */
+  std::vector<RawAddress> started_devices_;
+  std::chrono::steady_clock::time_point start_time_;
   alarm_t* operation_timeout_;
 
   VolumeOperation(int operation_id, int group_id, bool is_autonomous, uint8_t opcode,
@@ -101,7 +107,24 @@ struct VolumeOperation {
   }
 
   bool IsStarted(void) { return started_; };
-  void Start(void) { started_ = true; }
+  void Start(void) {
+    started_ = true;
+    start_time_ = std::chrono::steady_clock::now();
+  }
+
+  bool IsStartedForDevice(const RawAddress& addr) const {
+    return std::find(started_devices_.begin(), started_devices_.end(), addr) !=
+           started_devices_.end();
+  }
+  void StartForDevice(const RawAddress& addr) {
+    started_devices_.push_back(addr);
+  }
+
+  uint64_t GetElapsedMs(void) const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start_time_)
+        .count();
+  }
 };
 
 struct VolumeOffset {
@@ -499,6 +499,8 @@ class VolumeControlImpl : public VolumeControl {
     if (!op->devices_.empty()) {
       DLOG(INFO) << __func__ << " wait for more responses for operation_id: "
                  << op->operation_id_;
+      /* The device can go on with its next operation */
+      StartQueueOperation();
       return;
     }
 
@@ -512,6 +514,7 @@ class VolumeControlImpl : public VolumeControl {
                                        device->mute, false);
     }
 
+    RecordOperationResult(*op, true);
     ongoing_operations_.erase(op);
     StartQueueOperation();
   }
@@ -654,6 +657,20 @@ class VolumeControlImpl : public VolumeControl {
 
   void Dump(int fd) {
     dprintf(fd, "APP ID: %d\n", gatt_if_);
+    dprintf(fd, "Ongoing operations: %zu\n", ongoing_operations_.size());
+    for (bool group : {true, false}) {
+      const auto& stats = group ? group_ops_stats_ : device_ops_stats_;
+      dprintf(fd,
+              "%s operations (done/failed): %zu/%zu, latency ms (avg/max): "
+              "%llu/%llu\n",
+              group ? "Group" : "Device", stats.completed_cnt,
+              stats.failed_cnt,
+              (unsigned long long)(stats.completed_cnt
+                                       ? stats.total_latency_ms /
+                                             stats.completed_cnt
+                                       : 0),
+              (unsigned long long)stats.max_latency_ms);
+    }
     volume_control_devices_.DebugDump(fd);
   }
 
@@ -728,9 +745,10 @@ class VolumeControlImpl : public VolumeControl {
     if (it != op->devices_.end()) {
       op->devices_.erase(it);
       if (op->devices_.empty()) {
+        RecordOperationResult(*op, false);
         ongoing_operations_.erase(op);
-        StartQueueOperation();
       }
+      StartQueueOperation();
       return;
     }
   }
@@ -796,29 +814,57 @@ class VolumeControlImpl : public VolumeControl {
     instance->CancelVolumeOperation(PTR_TO_INT(data));
   }
 
+  /* Writes the queued operations to the devices which completed all their
+   * previous operations. Each write carries the change counter of the device,
+   * which is only updated by the notification completing the operation, so a
+   * device only has one operation ongoing at a time. The devices of a group
+   * operation are written in parallel, and each of them goes on with its next
+   * operation without waiting for the other members.
+   */
   void StartQueueOperation(void) {
     LOG(INFO) << __func__;
-    if (ongoing_operations_.empty()) {
-      return;
-    };
 
-    auto op = &ongoing_operations_.front();
+    std::set<RawAddress> busy_devices;
+    for (auto& op : ongoing_operations_) {
+      std::vector<RawAddress> devices;
+      for (auto const& addr : op.devices_) {
+        if (busy_devices.count(addr) == 0 && !op.IsStartedForDevice(addr)) {
+          devices.push_back(addr);
+        }
+      }
+      busy_devices.insert(op.devices_.begin(), op.devices_.end());
+      if (devices.empty()) continue;
 
-    LOG(INFO) << __func__ << " operation_id: " << op->operation_id_;
+      LOG(INFO) << __func__ << " operation_id: " << op.operation_id_
+                << ", devices: " << devices.size();
 
-    if (op->IsStarted()) {
-      LOG(INFO) << __func__ << " wait until operation " << op->operation_id_
-                << " is complete";
-      return;
+      if (!op.IsStarted()) {
+        op.Start();
+        alarm_set_on_mloop(op.operation_timeout_, 3000, operation_callback,
+                           INT_TO_PTR(op.operation_id_));
+      }
+      for (auto const& addr : devices) op.StartForDevice(addr);
+
+      devices_control_point_helper(
+          devices, op.opcode_,
+          op.arguments_.size() == 0 ? nullptr : &(op.arguments_),
+          op.operation_id_);
     }
+  }
 
-    op->Start();
+  void RecordOperationResult(const VolumeOperation& op, bool success) {
+    auto& stats =
+        op.group_id_ != bluetooth::groups::kGroupUnknown ? group_ops_stats_
+                                                         : device_ops_stats_;
+    if (!success) {
+      stats.failed_cnt++;
+      return;
+    }
 
-    alarm_set_on_mloop(op->operation_timeout_, 3000, operation_callback,
-                       INT_TO_PTR(op->operation_id_));
-    devices_control_point_helper(
-        op->devices_, op->opcode_,
-        op->arguments_.size() == 0 ? nullptr : &(op->arguments_));
+    uint64_t latency_ms = op.GetElapsedMs();
+    stats.completed_cnt++;
+    stats.total_latency_ms += latency_ms;
+    stats.max_latency_ms = std::max(stats.max_latency_ms, latency_ms);
   }
 
   void CancelVolumeOperation(int operation_id) {
@@ -835,6 +881,7 @@ class VolumeControlImpl : public VolumeControl {
     }
 
     /* Possibly close GATT operations */
+    RecordOperationResult(*op, false);
     ongoing_operations_.erase(op);
     StartQueueOperation();
   }
@@ -1119,6 +1166,18 @@ class VolumeControlImpl : public VolumeControl {
   std::list<VolumeOperation> ongoing_operations_;
   int latest_operation_id_;
 
+  /* Latency of the operations, from the first write until all the devices
+   * notified the new state
+   */
+  struct OperationStats {
+    size_t completed_cnt = 0;
+    size_t failed_cnt = 0;
+    uint64_t total_latency_ms = 0;
+    uint64_t max_latency_ms = 0;
+  };
+  OperationStats group_ops_stats_;
+  OperationStats device_ops_stats_;
+
   void verify_device_ready(VolumeControlDevice* device, uint16_t handle) {
     if (device->IsReady()) return;
 
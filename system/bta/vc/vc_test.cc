@@ -1377,6 +1377,55 @@ TEST_F(VolumeControlCsis, test_set_volume) {
   GetNotificationEvent(conn_id_2, test_address_2, 0x0021, value2);
 }
 
+TEST_F(VolumeControlCsis, test_set_volume_does_not_wait_for_other_members) {
+  TestConnect(test_address_1);
+  GetConnectedEvent(test_address_1, conn_id_1);
+  GetSearchCompleteEvent(conn_id_1);
+  TestConnect(test_address_2);
+  GetConnectedEvent(test_address_2, conn_id_2);
+  GetSearchCompleteEvent(conn_id_2);
+
+  EXPECT_CALL(gatt_queue,
+              WriteCharacteristic(conn_id_1, 0x0024, _, GATT_WRITE, _, _));
+  EXPECT_CALL(gatt_queue,
+              WriteCharacteristic(conn_id_2, 0x0024, _, GATT_WRITE, _, _));
+  VolumeControl::Get()->SetVolume(group_id, 10);
+  Mock::VerifyAndClearExpectations(&gatt_queue);
+
+  /* The first member applied the volume, the second one did not yet */
+  std::vector<uint8_t> value_1({10, 0x00, 0x01});
+  GetNotificationEvent(conn_id_1, test_address_1, 0x0021, value_1);
+
+  /* The next volume is written right away to the first member only */
+  const std::vector<uint8_t> vol_x20_1({0x04, 0x01, 0x20});
+  EXPECT_CALL(gatt_queue, WriteCharacteristic(conn_id_1, 0x0024, vol_x20_1,
+                                              GATT_WRITE, _, _))
+      .Times(1);
+  EXPECT_CALL(gatt_queue,
+              WriteCharacteristic(conn_id_2, 0x0024, _, GATT_WRITE, _, _))
+      .Times(0);
+  VolumeControl::Get()->SetVolume(group_id, 0x20);
+  Mock::VerifyAndClearExpectations(&gatt_queue);
+
+  /* The second member completes the first operation, and gets the next one */
+  EXPECT_CALL(*callbacks,
+              OnGroupVolumeStateChanged(group_id, 10, false, false));
+  const std::vector<uint8_t> vol_x20_2({0x04, 0x01, 0x20});
+  EXPECT_CALL(gatt_queue, WriteCharacteristic(conn_id_2, 0x0024, vol_x20_2,
+                                              GATT_WRITE, _, _))
+      .Times(1);
+  std::vector<uint8_t> value_2({10, 0x00, 0x01});
+  GetNotificationEvent(conn_id_2, test_address_2, 0x0021, value_2);
+  Mock::VerifyAndClearExpectations(&gatt_queue);
+  Mock::VerifyAndClearExpectations(callbacks.get());
+
+  EXPECT_CALL(*callbacks,
+              OnGroupVolumeStateChanged(group_id, 0x20, false, false));
+  std::vector<uint8_t> value_x20({0x20, 0x00, 0x02});
+  GetNotificationEvent(conn_id_1, test_address_1, 0x0021, value_x20);
+  GetNotificationEvent(conn_id_2, test_address_2, 0x0021, value_x20);
+}
+
 TEST_F(VolumeControlCsis, test_set_volume_device_not_ready) {
   /* Make sure we did not get responds to the initial reads,
    * so that the device was not marked as ready yet.
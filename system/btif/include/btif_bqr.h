@@ -106,6 +106,17 @@ static constexpr uint16_t kMinReportIntervalNoLimit = 0;
 static constexpr uint16_t kMinReportIntervalMaxMs = 0xFFFF;
 // The maximum count of Log Dump related event can be written in the log file.
 static constexpr uint16_t kLogDumpEventPerFile = 0x00FF;
+// The Log Dump related trace log files start with these magic octets and the
+// format version, followed by one record per event:
+//   Timestamp (ms since epoch) | 8 octets
+//   Quality_Report_ID          | 1 octet
+//   Connection_Handle          | 2 octets
+//   Length of the VSP          | 1 octet
+//   Vendor Specific Parameters | Length octets
+// All the fields are little endian.
+static constexpr uint8_t kLogDumpFileMagic[] = {'B', 'Q', 'R', 'T'};
+static constexpr uint8_t kLogDumpFileFormatVersion = 0x01;
+static constexpr uint8_t kLogDumpRecordHeaderLen = 12;
 // Total length of all parameters of the link Quality related event except
 // Vendor Specific Parameters.
 static constexpr uint8_t kLinkQualityParamTotalLen = 48;
@@ -126,6 +137,14 @@ static constexpr int8_t kCriWarnRssi = -80;
 static constexpr uint8_t kCriWarnUnusedCh = 55;
 // The queue size of recording the BQR events.
 static constexpr uint8_t kBqrEventQueueSize = 25;
+// The maximum count of connection handles whose link quality is aggregated.
+static constexpr uint8_t kBqrLinkStatsMaxHandles = 16;
+// Upper bounds (inclusive) of the RSSI histogram buckets in dBm, the last
+// bucket holds the stronger RSSI values.
+static constexpr int8_t kBqrRssiBucketBounds[] = {-90, -80, -70, -60, -50};
+// Upper bounds (exclusive) of the packet error rate histogram buckets in
+// percent, the last bucket holds the higher rates.
+static constexpr uint8_t kBqrPerBucketBounds[] = {1, 5, 10, 25};
 // The Property of BQR event mask configuration.
 static constexpr const char* kpPropertyEventMask =
     "persist.bluetooth.bqr.event_mask";
@@ -138,13 +157,14 @@ static constexpr const char* kpPropertyVndTraceMask =
 // The Property of BQR minimum report interval configuration.
 static constexpr const char* kpPropertyMinReportIntervalMs =
     "persist.bluetooth.bqr.min_interval_ms";
-// Path of the LMP/LL message trace log file.
+// Path of the LMP/LL message trace log file, in the Log Dump binary format.
 static constexpr const char* kpLmpLlMessageTraceLogPath =
     "/data/misc/bluetooth/logs/lmp_ll_message_trace.log";
 // Path of the last LMP/LL message trace log file.
 static constexpr const char* kpLmpLlMessageTraceLastLogPath =
     "/data/misc/bluetooth/logs/lmp_ll_message_trace.log.last";
-// Path of the Bluetooth Multi-profile/Coex scheduling trace log file.
+// Path of the Bluetooth Multi-profile/Coex scheduling trace log file, in the
+// Log Dump binary format.
 static constexpr const char* kpBtSchedulingTraceLogPath =
     "/data/misc/bluetooth/logs/bt_scheduling_trace.log";
 // Path of the last Bluetooth Multi-profile/Coex scheduling trace log file.
@@ -157,6 +177,7 @@ static constexpr const char* kpBtSchedulingTraceLastLogPath =
 static constexpr const char* kpPropertyChoppyThreshold =
     "persist.bluetooth.bqr.choppy_threshold";
 
+// The Log Dump trace log files are only accessed on the BQR log thread.
 // File Descriptor of LMP/LL message trace log
 static int LmpLlMessageTraceLogFd = INVALID_FD;
 // File Descriptor of Bluetooth Multi-profile/Coex scheduling trace log
@@ -333,14 +354,16 @@ class BqrVseSubEvt {
   // @param length Total length of all parameters contained in the sub-event.
   // @param p_param_buf A pointer to the parameters contained in the sub-event.
   void ParseBqrLinkQualityEvt(uint8_t length, const uint8_t* p_param_buf);
-  // Write the LMP/LL message trace to the log file.
+  // Write the LMP/LL message trace to the log file, as one Log Dump record
+  // stamped with |timestamp_ms_|.
   //
   // @param fd The File Descriptor of the log file.
   // @param length Total length of all parameters contained in the sub-event.
   // @param p_param_buf A pointer to the parameters contained in the sub-event.
   void WriteLmpLlTraceLogFile(int fd, uint8_t length,
                               const uint8_t* p_param_buf);
-  // Write the Bluetooth Multi-profile/Coex scheduling trace to the log file.
+  // Write the Bluetooth Multi-profile/Coex scheduling trace to the log file,
+  // as one Log Dump record stamped with |timestamp_ms_|.
   //
   // @param fd The File Descriptor of the log file.
   // @param length Total length of all parameters contained in the sub-event.
@@ -363,6 +386,8 @@ class BqrVseSubEvt {
   BqrLogDumpEvent bqr_log_dump_event_ = {};
   // Local wall clock timestamp of receiving BQR VSE sub-event
   std::tm tm_timestamp_ = {};
+  // Wall clock timestamp (in ms) of receiving BQR VSE sub-event
+  uint64_t timestamp_ms_ = 0;
 };
 
 BluetoothQualityReportInterface* getBluetoothQualityReportInterface();
@@ -425,17 +450,19 @@ void AddLinkQualityEventToQueue(uint8_t length,
                                 const uint8_t* p_link_quality_event);
 
 // Dump the LMP/LL message handshaking with the remote device to a log file.
+// The event is copied and written on the BQR log thread.
 //
 // @param length Lengths of the LMP/LL message trace event.
 // @param p_lmp_ll_message_event A pointer to the LMP/LL message trace event.
 void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event);
 
-// Open the LMP/LL message trace log file.
+// Open the LMP/LL message trace log file and write its file header.
 //
 // @return a file descriptor of the LMP/LL message trace log file.
 int OpenLmpLlTraceLogFile();
 
 // Dump the Bluetooth Multi-profile/Coex scheduling information to a log file.
+// The event is copied and written on the BQR log thread.
 //
 // @param length Lengths of the Bluetooth Multi-profile/Coex scheduling trace
 //   event.
@@ -443,7 +470,8 @@ int OpenLmpLlTraceLogFile();
 //   scheduling trace event.
 void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event);
 
-// Open the Bluetooth Multi-profile/Coex scheduling trace log file.
+// Open the Bluetooth Multi-profile/Coex scheduling trace log file and write
+// its file header.
 //
 // @return a file descriptor of the Bluetooth Multi-profile/Coex scheduling
 //   trace log file.
@@ -21,6 +21,7 @@
 
 void jni_thread_startup();
 void jni_thread_shutdown();
+void jni_thread_debug_dump(int fd);
 
 /*******************************************************************************
  *
@@ -37,6 +37,7 @@ bt_status_t btif_queue_connect(uint16_t uuid, const RawAddress* bda,
                                btif_connect_cb_t connect_cb);
 void btif_queue_cleanup(uint16_t uuid);
 void btif_queue_advance();
+void btif_queue_advance_by_uuid(uint16_t uuid, const RawAddress* bda);
 
 /**
  * Dispatch the next pending connect request.
@@ -49,4 +50,6 @@ bt_status_t btif_queue_connect_next(void);
 
 void btif_queue_release();
 
+void btif_debug_queue_dump(int fd);
+
 #endif
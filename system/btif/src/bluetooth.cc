@@ -49,6 +49,12 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "audio_hal_interface/a2dp_encoding.h"
 #include "bta/hh/bta_hh_int.h"  // for HID HACK profile methods
 #include "bta/include/bta_api.h"
@@ -61,6 +67,7 @@
 #include "bta/include/bta_le_audio_broadcaster_api.h"
 #include "bta/include/bta_vc_api.h"
 #include "btif/avrcp/avrcp_service.h"
+#include "btif/include/btif_jni_task.h"
 #include "btif/include/btif_sock.h"
 #include "btif/include/core_callbacks.h"
 #include "btif/include/stack_manager.h"
@@ -77,6 +84,7 @@
 #include "btif_keystore.h"
 #include "btif_metrics_logging.h"
 #include "btif_pan.h"
+#include "btif_profile_queue.h"
 #include "btif_profile_storage.h"
 #include "btif_rc.h"
 #include "btif_sock.h"
@@ -88,24 +96,30 @@
 #include "device/include/interop.h"
 #include "device/include/interop_config.h"
 #include "gd/common/init_flags.h"
+#include "gd/os/logging/binary_log.h"
 #include "gd/os/parameter_provider.h"
 #include "internal_include/bt_target.h"
 #include "main/shim/dumpsys.h"
 #include "os/log.h"
 #include "osi/include/alarm.h"
 #include "osi/include/allocator.h"
+#include "osi/include/properties.h"
 #include "osi/include/stack_power_telemetry.h"
+#include "osi/include/thread_scheduler.h"
 #include "osi/include/wakelock.h"
 #include "stack/btm/btm_sco_hfp_hal.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/include/a2dp_api.h"
 #include "stack/include/avdt_api.h"
 #include "stack/include/btm_api.h"
+#include "stack/include/btm_ble_addr.h"
+#include "stack/include/gatt_api.h"
 #include "stack/include/hfp_lc3_decoder.h"
 #include "stack/include/hfp_lc3_encoder.h"
 #include "stack/include/hfp_msbc_decoder.h"
 #include "stack/include/hfp_msbc_encoder.h"
 #include "stack/include/hidh_api.h"
+#include "stack/include/l2c_api.h"
 #include "stack/include/main_thread.h"
 #include "stack/include/pan_api.h"
 #include "types/raw_address.h"
@@ -404,6 +418,9 @@ static int init(bt_callbacks_t* callbacks, bool start_restricted,
       config_compare_result);
 
   bluetooth::common::InitFlags::Load(init_flags);
+  bluetooth::os::BinaryLog::SetLevel(
+      osi_property_get_int32(bluetooth::os::BinaryLog::kPropertyLevel,
+                             bluetooth::os::BinaryLog::kDisabled));
 
   if (interface_ready()) return BT_STATUS_DONE;
 
@@ -779,8 +796,11 @@ static int set_event_filter_connection_setup_all_devices() {
   return BT_STATUS_SUCCESS;
 }
 
+static void property_callback_coalescing_dump(int fd);
+
 static void dump(int fd, const char** arguments) {
   btif_debug_conn_dump(fd);
+  btif_debug_queue_dump(fd);
   btif_debug_bond_event_dump(fd);
   btif_debug_linkkey_type_dump(fd);
   btif_debug_rc_dump(fd);
@@ -795,6 +815,12 @@ static void dump(int fd, const char** arguments) {
   BTA_HfClientDumpStatistics(fd);
   wakelock_debug_dump(fd);
   alarm_debug_dump(fd);
+  osi_allocator_debug_dump(fd);
+  thread_scheduler_debug_dump(fd);
+  dprintf(fd, "\nThread Task Stats:\n");
+  get_main_thread()->DumpTaskStats(fd);
+  jni_thread_debug_dump(fd);
+  property_callback_coalescing_dump(fd);
   bluetooth::csis::CsisClient::DebugDump(fd);
   le_audio::has::HasClient::DebugDump(fd);
   HearingAid::DebugDump(fd);
@@ -802,10 +828,17 @@ static void dump(int fd, const char** arguments) {
   LeAudioBroadcaster::DebugDump(fd);
   VolumeControl::DebugDump(fd);
   connection_manager::dump(fd);
+  GATT_Dumpsys(fd);
   bluetooth::bqr::DebugDump(fd);
   PAN_Dumpsys(fd);
+  L2CA_Dumpsys(fd);
+  BTM_BleAddrDumpsys(fd);
+  BTM_ScoDumpsys(fd);
   DumpsysHid(fd);
+  DumpsysBtaHh(fd);
   DumpsysBtaDm(fd);
+  DumpsysBtaSys(fd);
+  bluetooth::os::BinaryLog::Dump(fd);
   bluetooth::shim::Dump(fd, arguments);
   power_telemetry::GetInstance().Dumpsys(fd);
 }
@@ -1250,9 +1283,149 @@ void invoke_adapter_properties_cb(bt_status_t status, int num_properties,
                        property_deep_copy_array(num_properties, properties)));
 }
 
+namespace {
+
+// Device found and remote device property updates that are still queued on
+// the JNI thread, by device. An update for a device whose previous update has
+// not been delivered yet is merged into it, the newest value of each property
+// winning, so that inquiry, scan and RSSI storms cross into Java as one
+// callback per device instead of one per event.
+struct PendingPropertiesUpdate {
+  bool is_device_found;
+  bt_status_t status;
+  RawAddress bd_addr;
+  std::vector<bt_property_type_t> types;
+  std::vector<std::vector<uint8_t>> values;
+};
+
+struct {
+  std::mutex mutex;
+  std::map<RawAddress, std::shared_ptr<PendingPropertiesUpdate>> pending;
+  uint64_t posted;
+  uint64_t coalesced;
+  size_t max_pending;
+} properties_coalescer;
+
+bool is_property_callback_coalescing_enabled() {
+  return osi_property_get_bool("bluetooth.btif.coalesce_property_cb.enabled",
+                               true);
+}
+
+void merge_properties(PendingPropertiesUpdate* update, int num_properties,
+                      bt_property_t* properties) {
+  for (int i = 0; i < num_properties; i++) {
+    const uint8_t* val = (const uint8_t*)properties[i].val;
+    std::vector<uint8_t> value;
+    if (properties[i].len > 0) value.assign(val, val + properties[i].len);
+
+    size_t j = 0;
+    while (j < update->types.size() && update->types[j] != properties[i].type)
+      j++;
+    if (j == update->types.size()) {
+      update->types.push_back(properties[i].type);
+      update->values.push_back(std::move(value));
+    } else {
+      update->values[j] = std::move(value);
+    }
+  }
+}
+
+void deliver_properties_update(
+    std::shared_ptr<PendingPropertiesUpdate> update) {
+  {
+    std::lock_guard<std::mutex> lock(properties_coalescer.mutex);
+    auto it = properties_coalescer.pending.find(update->bd_addr);
+    if (it != properties_coalescer.pending.end() && it->second == update) {
+      properties_coalescer.pending.erase(it);
+    }
+  }
+
+  // No more updates are merged into |update| once it is out of the map.
+  int num_properties = update->types.size();
+  std::vector<bt_property_t> properties(num_properties);
+  for (int i = 0; i < num_properties; i++) {
+    properties[i].type = update->types[i];
+    properties[i].len = update->values[i].size();
+    properties[i].val =
+        update->values[i].empty() ? nullptr : update->values[i].data();
+  }
+
+  if (update->is_device_found) {
+    HAL_CBACK(bt_hal_cbacks, device_found_cb, num_properties,
+              properties.data());
+  } else {
+    HAL_CBACK(bt_hal_cbacks, remote_device_properties_cb, update->status,
+              &update->bd_addr, num_properties, properties.data());
+  }
+}
+
+// Merges the update into the one queued for |bd_addr| if it is of the same
+// kind, otherwise queues it.
+void post_properties_update(bool is_device_found, bt_status_t status,
+                            const RawAddress& bd_addr, int num_properties,
+                            bt_property_t* properties) {
+  std::lock_guard<std::mutex> lock(properties_coalescer.mutex);
+  auto& pending = properties_coalescer.pending[bd_addr];
+  // An update of the other kind queued in between keeps the older one from
+  // being merged into, so that property values never reach Java out of order.
+  if (pending != nullptr && pending->is_device_found == is_device_found &&
+      pending->status == status) {
+    merge_properties(pending.get(), num_properties, properties);
+    properties_coalescer.coalesced++;
+    return;
+  }
+
+  pending = std::make_shared<PendingPropertiesUpdate>();
+  pending->is_device_found = is_device_found;
+  pending->status = status;
+  pending->bd_addr = bd_addr;
+  merge_properties(pending.get(), num_properties, properties);
+  if (do_in_jni_thread(FROM_HERE, base::BindOnce(deliver_properties_update,
+                                                 pending)) !=
+      BT_STATUS_SUCCESS) {
+    properties_coalescer.pending.erase(bd_addr);
+    return;
+  }
+  properties_coalescer.posted++;
+  properties_coalescer.max_pending = std::max(
+      properties_coalescer.max_pending, properties_coalescer.pending.size());
+}
+
+bool find_bdaddr_property(int num_properties, bt_property_t* properties,
+                          RawAddress* bd_addr) {
+  for (int i = 0; i < num_properties; i++) {
+    if (properties[i].type == BT_PROPERTY_BDADDR &&
+        properties[i].len == (int)sizeof(RawAddress)) {
+      memcpy(bd_addr, properties[i].val, sizeof(RawAddress));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+#define DUMPSYS_TAG "shim::legacy::btif::callbacks"
+static void property_callback_coalescing_dump(int fd) {
+  std::lock_guard<std::mutex> lock(properties_coalescer.mutex);
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  LOG_DUMPSYS(fd, "Property callbacks posted:%llu coalesced:%llu",
+              (unsigned long long)properties_coalescer.posted,
+              (unsigned long long)properties_coalescer.coalesced);
+  LOG_DUMPSYS(fd, "Devices with queued updates:%zu max:%zu",
+              properties_coalescer.pending.size(),
+              properties_coalescer.max_pending);
+}
+#undef DUMPSYS_TAG
+
 void invoke_remote_device_properties_cb(bt_status_t status, RawAddress bd_addr,
                                         int num_properties,
                                         bt_property_t* properties) {
+  if (is_property_callback_coalescing_enabled()) {
+    post_properties_update(false, status, bd_addr, num_properties, properties);
+    return;
+  }
+
   do_in_jni_thread(
       FROM_HERE, base::BindOnce(
                      [](bt_status_t status, RawAddress bd_addr,
@@ -1268,6 +1441,14 @@ void invoke_remote_device_properties_cb(bt_status_t status, RawAddress bd_addr,
 }
 
 void invoke_device_found_cb(int num_properties, bt_property_t* properties) {
+  RawAddress bd_addr;
+  if (is_property_callback_coalescing_enabled() &&
+      find_bdaddr_property(num_properties, properties, &bd_addr)) {
+    post_properties_update(true, BT_STATUS_SUCCESS, bd_addr, num_properties,
+                           properties);
+    return;
+  }
+
   do_in_jni_thread(FROM_HERE,
                    base::BindOnce(
                        [](int num_properties, bt_property_t* properties) {
@@ -21,27 +21,35 @@
 
 #include "btif/include/btif_a2dp_sink.h"
 
+#include <android_bluetooth_sysprop.h>
 #include <base/functional/bind.h>
 #include <base/logging.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "bt_target.h"  // Must be first to define build configuration
+#include "audio/asrc/asrc_resampler.h"
 #include "btif/include/btif_av.h"
 #include "btif/include/btif_av_co.h"
 #include "btif/include/btif_avrcp_audio_track.h"
 #include "btif/include/btif_util.h"  // CASE_RETURN_STR
 #include "common/message_loop_thread.h"
+#include "common/time_util.h"
 #include "osi/include/alarm.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"  // UNUSED_ATTR
+#include "osi/include/thread_scheduler.h"
 #include "stack/include/bt_hdr.h"
 #include "types/raw_address.h"
 
+using bluetooth::audio::asrc::Resampler;
 using bluetooth::common::MessageLoopThread;
 using LockGuard = std::lock_guard<std::mutex>;
 
@@ -55,6 +63,27 @@ using LockGuard = std::lock_guard<std::mutex>;
 /* In case of A2DP Sink, we will delay start by 5 AVDTP Packets */
 #define MAX_A2DP_DELAYED_START_FRAME_COUNT 5
 
+/**
+ * Bounds of the target depth of the adaptive jitter buffer, in AVDTP packets.
+ * The depth of the fixed buffer is used until the arrival times are measured.
+ */
+#define MIN_A2DP_JITTER_BUFFER_DEPTH 2
+#define MAX_A2DP_JITTER_BUFFER_DEPTH (MAX_INPUT_A2DP_FRAME_QUEUE_SZ / 2)
+
+/* Inter-arrival times above this are a pause of the stream, not jitter */
+#define MAX_A2DP_ARRIVAL_INTERVAL_US (500 * 1000)
+
+/* An underrun adds a packet to the target depth, removed after this time */
+#define A2DP_UNDERRUN_BOOST_DECAY_US (10 * 1000 * 1000)
+
+/**
+ * Sample rate correction of the drift of the source clock, in parts per
+ * million, for each packet of difference between the average and the target
+ * depth beyond the first one, and its bound.
+ */
+#define A2DP_DRIFT_CORRECTION_PPM_PER_PACKET 1000
+#define MAX_A2DP_DRIFT_CORRECTION_PPM 5000
+
 enum {
   BTIF_A2DP_SINK_STATE_OFF,
   BTIF_A2DP_SINK_STATE_STARTING_UP,
@@ -82,6 +111,82 @@ typedef struct {
   btif_a2dp_sink_focus_state_t focus_state;
 } tBTIF_MEDIA_SINK_FOCUS_UPDATE;
 
+/**
+ * Adaptive jitter buffer of the receiving queue.
+ *
+ * The jitter is the mean deviation of the packet inter-arrival times, as in
+ * RFC 3550, the RTP timestamps not being reported to BTIF. The target depth
+ * covers a decoding tick and four times the jitter, plus one packet for each
+ * recent underrun. Decoding only starts, or resumes after an underrun, once
+ * the queue reaches the target depth.
+ *
+ * The depth of the queue at each decoding tick is averaged. The difference
+ * with the target is the drift of the source clock, corrected by resampling
+ * the decoded PCM by a small ratio before writing it to the audio track.
+ */
+class BtifA2dpSinkJitterBuffer {
+ public:
+  BtifA2dpSinkJitterBuffer() : resamplers{Resampler(16), Resampler(16)} {
+    Reset();
+  }
+
+  void Reset() {
+    adaptive = false;
+    drift_correction = false;
+    target_depth = MAX_A2DP_DELAYED_START_FRAME_COUNT;
+    underrun_boost = 0;
+    boost_update_us = 0;
+    mean_interval_us = 0;
+    jitter_us = 0;
+    packet_duration_us = 0;
+    decoded_frames = 0;
+    total_packets = 0;
+    total_dropped_packets = 0;
+    total_underruns = 0;
+    last_underrun_us = 0;
+    max_jitter_us = 0;
+    max_depth = 0;
+    Restart();
+  }
+
+  // Restart at the beginning of a stream, keeping the measured jitter
+  void Restart() {
+    last_arrival_us = 0;
+    playing = false;
+    rebuffering = false;
+    average_depth_q8 = static_cast<int64_t>(target_depth) << 8;
+    correction_ppm = 0;
+    for (auto& resampler : resamplers) {
+      resampler = Resampler(16);
+    }
+  }
+
+  bool adaptive;         /* Adapt the target depth and correct the drift */
+  bool drift_correction; /* Resample the decoded PCM, 16 bits PCM only */
+  size_t target_depth;   /* Depth to start or resume decoding, in packets */
+  size_t underrun_boost; /* Packets added to the target by the underruns */
+  uint64_t boost_update_us;
+  uint64_t last_arrival_us;
+  int64_t mean_interval_us;   /* Average of the packet inter-arrival times */
+  int64_t jitter_us;          /* Mean deviation of the inter-arrival times */
+  int64_t packet_duration_us; /* Average of the decoded packet durations */
+  int64_t average_depth_q8;   /* Average depth at the decoding ticks, Q8 */
+  int32_t correction_ppm;     /* Input to output rate ratio minus one, ppm */
+  bool playing;          /* At least a packet decoded since the start */
+  bool rebuffering;      /* Waiting for the target depth after an underrun */
+  size_t decoded_frames; /* PCM frames decoded from the current packet */
+  std::array<Resampler, 2> resamplers;
+  std::vector<int16_t> resampled_pcm;
+
+  // Statistics since the codec configuration
+  size_t total_packets;
+  size_t total_dropped_packets;
+  size_t total_underruns;
+  uint64_t last_underrun_us;
+  int64_t max_jitter_us;
+  size_t max_depth;
+};
+
 /* BTIF A2DP Sink control block */
 class BtifA2dpSinkControlBlock {
  public:
@@ -111,6 +216,7 @@ class BtifA2dpSinkControlBlock {
     sample_rate = 0;
     channel_count = 0;
     decoder_interface = nullptr;
+    jitter_buffer.Reset();
   }
 
   MessageLoopThread worker_thread;
@@ -123,6 +229,7 @@ class BtifA2dpSinkControlBlock {
   btif_a2dp_sink_focus_state_t rx_focus_state; /* audio focus state */
   void* audio_track;
   const tA2DP_DECODER_INTERFACE* decoder_interface;
+  BtifA2dpSinkJitterBuffer jitter_buffer;
 };
 
 // Mutex for below data structures.
@@ -156,6 +263,8 @@ static void btif_a2dp_sink_audio_rx_flush_event();
 static void btif_a2dp_sink_clear_track_event_req();
 static void btif_a2dp_sink_on_start_event();
 static void btif_a2dp_sink_on_suspend_event();
+static void btif_a2dp_sink_jitter_on_arrival(uint64_t now_us);
+static bool btif_a2dp_sink_jitter_on_tick(size_t queue_length);
 
 UNUSED_ATTR static const char* dump_media_event(uint16_t event) {
   switch (event) {
@@ -184,6 +293,7 @@ bool btif_a2dp_sink_init() {
   btif_a2dp_sink_state = BTIF_A2DP_SINK_STATE_STARTING_UP;
 
   /* Start A2DP Sink media task */
+  btif_a2dp_sink_cb.worker_thread.EnableTaskStats();
   btif_a2dp_sink_cb.worker_thread.StartUp();
   if (!btif_a2dp_sink_cb.worker_thread.IsRunning()) {
     LOG_ERROR("%s: unable to start up media thread", __func__);
@@ -194,7 +304,8 @@ bool btif_a2dp_sink_init() {
   btif_a2dp_sink_cb.rx_audio_queue = fixed_queue_new(SIZE_MAX);
 
   /* Schedule the rest of the operations */
-  if (!btif_a2dp_sink_cb.worker_thread.EnableRealTimeScheduling()) {
+  if (!thread_scheduler_apply_profile(
+          btif_a2dp_sink_cb.worker_thread.GetLinuxThreadId(), "a2dp_sink")) {
 #if defined(__ANDROID__)
     LOG(FATAL) << __func__
                << ": Failed to increase A2DP decoder thread priority";
@@ -469,6 +580,7 @@ static void btif_a2dp_sink_audio_handle_stop_decoding() {
     btif_a2dp_sink_audio_rx_flush_req();
     old_alarm = btif_a2dp_sink_cb.decode_alarm;
     btif_a2dp_sink_cb.decode_alarm = nullptr;
+    btif_a2dp_sink_cb.jitter_buffer.Restart();
   }
 
   // Drop the lock here, btif_decode_alarm_cb may in the process of being called
@@ -512,7 +624,8 @@ static void btif_a2dp_sink_audio_handle_start_decoding() {
   BtifAvrcpAudioTrackStart(btif_a2dp_sink_cb.audio_track);
 #endif
 
-  btif_a2dp_sink_cb.decode_alarm = alarm_new_periodic("btif.a2dp_sink_decode");
+  btif_a2dp_sink_cb.decode_alarm = alarm_new_with_priority(
+      "btif.a2dp_sink_decode", true, ALARM_PRIORITY_MEDIA);
   if (btif_a2dp_sink_cb.decode_alarm == nullptr) {
     LOG_ERROR("%s: unable to allocate decode alarm", __func__);
     return;
@@ -521,7 +634,44 @@ static void btif_a2dp_sink_audio_handle_start_decoding() {
             btif_decode_alarm_cb, nullptr);
 }
 
+// Resample the decoded PCM to correct the drift of the source clock.
+// Returns the resampled PCM, or the decoded PCM when not corrected.
+// Must be called while locked.
+static uint8_t* btif_a2dp_sink_correct_drift(uint8_t* data, uint32_t* len) {
+  BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+  if (!jb.drift_correction) return data;
+
+  const size_t channel_count = btif_a2dp_sink_cb.channel_count;
+  const size_t in_frames = *len / (channel_count * sizeof(int16_t));
+  const size_t out_frames = in_frames + in_frames / 128 + 1;
+  jb.resampled_pcm.resize(out_frames * channel_count);
+
+  const unsigned ratio_q26 =
+      (1u << 26) + static_cast<int64_t>(jb.correction_ppm) * (1 << 26) /
+                       1000000;
+  const int16_t* in = reinterpret_cast<const int16_t*>(data);
+  size_t in_count = 0;
+  size_t out_count = 0;
+  unsigned in_sub_q26;
+  for (size_t ch = 0; ch < channel_count; ch++) {
+    jb.resamplers[ch].Resample<int16_t>(
+        ratio_q26, in + ch, channel_count, in_frames, &in_count,
+        jb.resampled_pcm.data() + ch, channel_count, out_frames, &out_count,
+        &in_sub_q26);
+  }
+
+  *len = out_count * channel_count * sizeof(int16_t);
+  return reinterpret_cast<uint8_t*>(jb.resampled_pcm.data());
+}
+
 static void btif_a2dp_sink_on_decode_complete(uint8_t* data, uint32_t len) {
+  size_t frame_size = btif_a2dp_sink_cb.channel_count *
+                      (btif_a2dp_sink_cb.bits_per_sample / 8);
+  if (frame_size > 0) {
+    btif_a2dp_sink_cb.jitter_buffer.decoded_frames += len / frame_size;
+  }
+
+  data = btif_a2dp_sink_correct_drift(data, &len);
 #ifdef __ANDROID__
   BtifAvrcpAudioTrackWriteData(btif_a2dp_sink_cb.audio_track,
                                reinterpret_cast<void*>(data), len);
@@ -536,10 +686,114 @@ static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg) {
     return;
   }
 
+  BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+  jb.decoded_frames = 0;
+
   CHECK(btif_a2dp_sink_cb.decoder_interface != nullptr);
   if (!btif_a2dp_sink_cb.decoder_interface->decode_packet(p_msg)) {
     LOG_ERROR("%s: decoding failed", __func__);
   }
+
+  // Average duration of the packets, to report the latency of the queue
+  if (jb.decoded_frames > 0 && btif_a2dp_sink_cb.sample_rate > 0) {
+    int64_t duration_us = static_cast<int64_t>(jb.decoded_frames) * 1000000 /
+                          btif_a2dp_sink_cb.sample_rate;
+    if (jb.packet_duration_us == 0) {
+      jb.packet_duration_us = duration_us;
+    } else {
+      jb.packet_duration_us += (duration_us - jb.packet_duration_us) / 16;
+    }
+  }
+  jb.playing = true;
+}
+
+// Update the jitter estimate and the target depth on the arrival of a packet.
+// Must be called while locked.
+static void btif_a2dp_sink_jitter_on_arrival(uint64_t now_us) {
+  BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+  jb.total_packets++;
+
+  uint64_t last_arrival_us = jb.last_arrival_us;
+  jb.last_arrival_us = now_us;
+  if (last_arrival_us == 0 || now_us < last_arrival_us ||
+      now_us - last_arrival_us > MAX_A2DP_ARRIVAL_INTERVAL_US) {
+    return;
+  }
+
+  int64_t interval_us = now_us - last_arrival_us;
+  if (jb.mean_interval_us == 0) {
+    jb.mean_interval_us = interval_us;
+  } else {
+    jb.mean_interval_us += (interval_us - jb.mean_interval_us) / 16;
+  }
+  int64_t deviation_us = std::abs(interval_us - jb.mean_interval_us);
+  jb.jitter_us += (deviation_us - jb.jitter_us) / 16;
+  jb.max_jitter_us = std::max(jb.max_jitter_us, jb.jitter_us);
+
+  if (!jb.adaptive || jb.mean_interval_us <= 0) return;
+
+  if (jb.underrun_boost > 0 &&
+      now_us - jb.boost_update_us > A2DP_UNDERRUN_BOOST_DECAY_US) {
+    jb.underrun_boost--;
+    jb.boost_update_us = now_us;
+  }
+
+  int64_t covered_us = BTIF_SINK_MEDIA_TIME_TICK_MS * 1000 + 4 * jb.jitter_us;
+  size_t depth = (covered_us + jb.mean_interval_us - 1) / jb.mean_interval_us;
+  jb.target_depth =
+      std::clamp<size_t>(depth + jb.underrun_boost,
+                         MIN_A2DP_JITTER_BUFFER_DEPTH,
+                         MAX_A2DP_JITTER_BUFFER_DEPTH);
+}
+
+// Account the depth of the queue at a decoding tick, and update the drift
+// correction. Returns false when the queue is rebuffering after an underrun.
+// Must be called while locked.
+static bool btif_a2dp_sink_jitter_on_tick(size_t queue_length) {
+  BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+
+  if (queue_length == 0) {
+    if (jb.playing && !jb.rebuffering && !btif_a2dp_sink_cb.rx_flush) {
+      LOG_VERBOSE("%s: underrun, target depth %zu", __func__, jb.target_depth);
+      jb.total_underruns++;
+      jb.last_underrun_us = bluetooth::common::time_get_os_boottime_us();
+      if (jb.adaptive) {
+        jb.rebuffering = true;
+        if (jb.target_depth < MAX_A2DP_JITTER_BUFFER_DEPTH) {
+          jb.underrun_boost++;
+          jb.target_depth++;
+        }
+        jb.boost_update_us = jb.last_underrun_us;
+      }
+    }
+    return false;
+  }
+
+  jb.max_depth = std::max(jb.max_depth, queue_length);
+  if (!jb.adaptive) return true;
+
+  if (jb.rebuffering) {
+    if (queue_length < jb.target_depth) return false;
+    jb.rebuffering = false;
+  }
+
+  jb.average_depth_q8 +=
+      ((static_cast<int64_t>(queue_length) << 8) - jb.average_depth_q8) / 16;
+
+  // No correction within a packet of the target
+  int64_t error_q8 =
+      jb.average_depth_q8 - (static_cast<int64_t>(jb.target_depth) << 8);
+  if (error_q8 > (1 << 8)) {
+    error_q8 -= 1 << 8;
+  } else if (error_q8 < -(1 << 8)) {
+    error_q8 += 1 << 8;
+  } else {
+    error_q8 = 0;
+  }
+  jb.correction_ppm = std::clamp<int64_t>(
+      error_q8 * A2DP_DRIFT_CORRECTION_PPM_PER_PACKET >> 8,
+      -MAX_A2DP_DRIFT_CORRECTION_PPM, MAX_A2DP_DRIFT_CORRECTION_PPM);
+  return true;
 }
 
 static void btif_a2dp_sink_avk_handle_timer() {
@@ -548,6 +802,7 @@ static void btif_a2dp_sink_avk_handle_timer() {
   BT_HDR* p_msg;
   if (fixed_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
     LOG_VERBOSE("%s: empty queue", __func__);
+    btif_a2dp_sink_jitter_on_tick(0);
     return;
   }
 
@@ -559,6 +814,14 @@ static void btif_a2dp_sink_avk_handle_timer() {
   /* Play only in BTIF_A2DP_SINK_FOCUS_GRANTED case */
   if (btif_a2dp_sink_cb.rx_flush) {
     fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    btif_a2dp_sink_cb.jitter_buffer.Restart();
+    return;
+  }
+
+  if (!btif_a2dp_sink_jitter_on_tick(
+          fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue))) {
+    LOG_VERBOSE("%s: rebuffering to %zu packets", __func__,
+                btif_a2dp_sink_cb.jitter_buffer.target_depth);
     return;
   }
 
@@ -625,6 +888,15 @@ static void btif_a2dp_sink_decoder_update_event(
   btif_a2dp_sink_cb.bits_per_sample = bits_per_sample;
   btif_a2dp_sink_cb.channel_count = channel_count;
 
+  BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+  jb.Reset();
+  jb.adaptive = GET_SYSPROP(A2dp, sink_adaptive_jitter_buffer, false);
+  jb.drift_correction = jb.adaptive && bits_per_sample == 16 &&
+                        channel_count <= static_cast<int>(jb.resamplers.size());
+  LOG_INFO("%s: adaptive jitter buffer %s, drift correction %s", __func__,
+           jb.adaptive ? "enabled" : "disabled",
+           jb.drift_correction ? "enabled" : "disabled");
+
   btif_a2dp_sink_cb.rx_flush = false;
   LOG_VERBOSE("%s: reset to Sink role", __func__);
 
@@ -662,10 +934,13 @@ static void btif_a2dp_sink_decoder_update_event(
 }
 
 uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
   LockGuard lock(g_mutex);
   if (btif_a2dp_sink_cb.rx_flush) /* Flush enabled, do not enqueue */
     return fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
 
+  btif_a2dp_sink_jitter_on_arrival(now_us);
+
   LOG_VERBOSE("%s +", __func__);
   /* Allocate and queue this buffer */
   BT_HDR* p_msg =
@@ -678,6 +953,7 @@ uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
   if (fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) ==
       MAX_INPUT_A2DP_FRAME_QUEUE_SZ) {
     osi_free(fixed_queue_try_dequeue(btif_a2dp_sink_cb.rx_audio_queue));
+    btif_a2dp_sink_cb.jitter_buffer.total_dropped_packets++;
     uint8_t ret = fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
     return ret;
   }
@@ -685,7 +961,7 @@ uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
   // Avoid other checks if alarm has already been initialized.
   if (btif_a2dp_sink_cb.decode_alarm == nullptr &&
       fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) >=
-          MAX_A2DP_DELAYED_START_FRAME_COUNT) {
+          btif_a2dp_sink_cb.jitter_buffer.target_depth) {
     LOG_VERBOSE("%s: Initiate decoding. Current focus state:%d", __func__,
                 btif_a2dp_sink_cb.rx_focus_state);
     if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_GRANTED) {
@@ -710,8 +986,55 @@ void btif_a2dp_sink_audio_rx_flush_req() {
       FROM_HERE, base::BindOnce(btif_a2dp_sink_command_ready, p_buf));
 }
 
-void btif_a2dp_sink_debug_dump(UNUSED_ATTR int fd) {
-  // Nothing to do
+void btif_a2dp_sink_debug_dump(int fd) {
+  // Not locked, the worker thread holds the lock while writing to the track
+  const BtifA2dpSinkJitterBuffer& jb = btif_a2dp_sink_cb.jitter_buffer;
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+
+  dprintf(fd, "\nA2DP Sink State:\n");
+  dprintf(fd, "  RxQueue:\n");
+
+  dprintf(fd,
+          "  Adaptive jitter buffer (enabled/drift correction)       : %s / "
+          "%s\n",
+          jb.adaptive ? "true" : "false",
+          jb.drift_correction ? "true" : "false");
+
+  dprintf(fd,
+          "  Depth in packets (current/target/average/max)           : %zu / "
+          "%zu / %.1f / %zu\n",
+          fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue),
+          jb.target_depth, jb.average_depth_q8 / 256.0, jb.max_depth);
+
+  dprintf(fd,
+          "  Latency in ms (target/average)                          : %lld / "
+          "%lld\n",
+          (long long)(jb.target_depth * jb.packet_duration_us / 1000),
+          (long long)((jb.average_depth_q8 * jb.packet_duration_us >> 8) /
+                      1000));
+
+  dprintf(fd,
+          "  Packet interval in us (average/jitter/max jitter)       : %lld / "
+          "%lld / %lld\n",
+          (long long)jb.mean_interval_us, (long long)jb.jitter_us,
+          (long long)jb.max_jitter_us);
+
+  dprintf(fd,
+          "  Drift correction in ppm                                 : %d\n",
+          jb.correction_ppm);
+
+  dprintf(fd,
+          "  Counts (packets/dropped/underruns)                      : %zu / "
+          "%zu / %zu\n",
+          jb.total_packets, jb.total_dropped_packets, jb.total_underruns);
+
+  dprintf(fd,
+          "  Last update time ago in ms (underrun)                   : %llu\n",
+          (jb.last_underrun_us > 0)
+              ? (unsigned long long)(now_us - jb.last_underrun_us) / 1000
+              : 0);
+
+  btif_a2dp_sink_cb.worker_thread.DumpTaskStats(fd);
 }
 
 void btif_a2dp_sink_set_focus_state_req(btif_a2dp_sink_focus_state_t state) {
@@ -736,6 +1059,7 @@ static void btif_a2dp_sink_set_focus_state_event(
   if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_NOT_GRANTED) {
     fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
     btif_a2dp_sink_cb.rx_flush = true;
+    btif_a2dp_sink_cb.jitter_buffer.Restart();
   } else if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_GRANTED) {
     btif_a2dp_sink_cb.rx_flush = false;
   }
@@ -20,6 +20,7 @@
 #define LOG_TAG "bt_btif_a2dp_source"
 #define ATRACE_TAG ATRACE_TAG_AUDIO
 
+#include <android_bluetooth_sysprop.h>
 #include <base/logging.h>
 #include <base/run_loop.h>
 #ifdef __ANDROID__
@@ -30,6 +31,7 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <future>
 
 #include "audio_a2dp_hw/include/audio_a2dp_hw.h"
@@ -46,10 +48,12 @@
 #include "common/metrics.h"
 #include "common/repeating_timer.h"
 #include "common/time_util.h"
+#include "gd/common/audio_pipeline_trace.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/thread_scheduler.h"
 #include "osi/include/wakelock.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_api_types.h"
@@ -58,6 +62,7 @@
 #include "udrv/include/uipc.h"
 
 using bluetooth::common::A2dpSessionMetrics;
+using bluetooth::common::AudioPipelineTrace;
 using bluetooth::common::BluetoothMetricsLogger;
 using bluetooth::common::RepeatingTimer;
 
@@ -70,6 +75,23 @@ extern std::unique_ptr<tUIPC_STATE> a2dp_uipc;
  */
 #define MAX_OUTPUT_A2DP_FRAME_QUEUE_SZ (MAX_PCM_FRAME_NUM_PER_TICK * 2)
 
+/**
+ * With HAL paced encoding, the number of consecutive timer ticks the encoder
+ * can be deferred while the audio HAL has not yet written the PCM data of an
+ * encoder interval. The time not fed is carried over to the next tick.
+ */
+#define MAX_HAL_PACED_DEFERRED_TICKS 1
+
+/**
+ * With encoder offload, the number of encoder intervals of PCM data read
+ * ahead of the encoder thread, so that a late encoder thread finds the data
+ * of the next interval already read from the audio HAL.
+ */
+#define A2DP_ENCODER_LOOKAHEAD_INTERVALS 1
+
+/* Capacity of the queue of PCM data read ahead for the encoder thread */
+#define MAX_A2DP_ENCODER_PCM_CHUNKS 8
+
 class SchedulingStats {
  public:
   SchedulingStats() { Reset(); }
@@ -140,6 +162,9 @@ class BtifMediaStats {
     media_read_total_underflow_bytes = 0;
     media_read_total_underflow_count = 0;
     media_read_last_underflow_us = 0;
+    hal_paced_deferred_ticks = 0;
+    encoder_offload_total_packets = 0;
+    encoder_offload_dropped_packets = 0;
     codec_index = -1;
   }
 
@@ -170,6 +195,11 @@ class BtifMediaStats {
   size_t media_read_total_underflow_count;
   uint64_t media_read_last_underflow_us;
 
+  size_t hal_paced_deferred_ticks;
+
+  size_t encoder_offload_total_packets;
+  size_t encoder_offload_dropped_packets;
+
   int codec_index = -1;
 };
 
@@ -188,6 +218,15 @@ class BtifA2dpSource {
         sw_audio_is_encoding(false),
         encoder_interface(nullptr),
         encoder_interval_ms(0),
+        hal_paced(false),
+        pcm_bytes_per_interval(0),
+        deferred_ticks(0),
+        encoder_offload(false),
+        pcm_queue(nullptr),
+        encoded_queue(nullptr),
+        lookahead_bytes(0),
+        pcm_chunk(nullptr),
+        encoded_packets_pending(false),
         state_(kStateOff) {}
 
   void Reset() {
@@ -195,9 +234,21 @@ class BtifA2dpSource {
     tx_audio_queue = nullptr;
     tx_flush = false;
     media_alarm.CancelAndWait();
-    wakelock_release();
+    wakelock_release_for("a2dp_source");
     encoder_interface = nullptr;
     encoder_interval_ms = 0;
+    hal_paced = false;
+    pcm_bytes_per_interval = 0;
+    deferred_ticks = 0;
+    last_tick_us = 0;
+    encoder_offload = false;
+    fixed_queue_free(pcm_queue, osi_free);
+    pcm_queue = nullptr;
+    fixed_queue_free(encoded_queue, osi_free);
+    encoded_queue = nullptr;
+    lookahead_bytes = 0;
+    osi_free_and_reset((void**)&pcm_chunk);
+    encoded_packets_pending = false;
     stats.Reset();
     accumulated_stats.Reset();
     state_ = kStateOff;
@@ -225,6 +276,18 @@ class BtifA2dpSource {
   RepeatingTimer media_alarm;
   const tA2DP_ENCODER_INTERFACE* encoder_interface;
   uint64_t encoder_interval_ms; /* Local copy of the encoder interval */
+  bool hal_paced; /* Encode only once the audio HAL has written the data */
+  size_t pcm_bytes_per_interval; /* PCM data read per encoder interval */
+  size_t deferred_ticks;         /* Consecutive ticks deferred by HAL pacing */
+  uint64_t last_tick_us;         /* Time of the last encoder timer tick */
+  bool encoder_offload; /* Encode on btif_a2dp_source_encoder_thread */
+  /* PCM data read ahead for the encoder thread, and the encoded packets it
+   * hands back. Both are single producer / single consumer queues. */
+  fixed_queue_t* pcm_queue;
+  fixed_queue_t* encoded_queue;
+  std::atomic<size_t> lookahead_bytes; /* PCM data read ahead, in bytes */
+  BT_HDR* pcm_chunk;            /* PCM being read by the encoder thread */
+  bool encoded_packets_pending; /* Packets enqueued by the encoder thread */
   BtifMediaStats stats;
   BtifMediaStats accumulated_stats;
 
@@ -234,6 +297,8 @@ class BtifA2dpSource {
 
 static bluetooth::common::MessageLoopThread btif_a2dp_source_thread(
     "bt_a2dp_source_worker_thread");
+static bluetooth::common::MessageLoopThread btif_a2dp_source_encoder_thread(
+    "bt_a2dp_source_encoder_thread");
 static BtifA2dpSource btif_a2dp_source_cb;
 
 static uint8_t btif_a2dp_source_dynamic_audio_buffer_size =
@@ -266,9 +331,22 @@ static void btif_a2dp_source_audio_feeding_update_event(
     const btav_a2dp_codec_config_t& codec_audio_config);
 static bool btif_a2dp_source_audio_tx_flush_req(void);
 static void btif_a2dp_source_audio_handle_timer(void);
+static uint32_t btif_a2dp_source_read_audio(uint8_t* p_buf, uint32_t len);
+static void btif_a2dp_source_log_read(uint32_t len, uint32_t bytes_read);
 static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len);
 static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
                                               uint32_t bytes_read);
+static void btif_a2dp_source_read_lookahead(void);
+static void btif_a2dp_source_encode_event(uint64_t timestamp_us,
+                                          size_t transmit_queue_length);
+static void btif_a2dp_source_encoded_ready_event(void);
+static void btif_a2dp_source_encoder_stop(void);
+static void btif_a2dp_source_encoder_stop_event(std::promise<void> promise);
+static uint32_t btif_a2dp_source_encoder_read_callback(uint8_t* p_buf,
+                                                       uint32_t len);
+static bool btif_a2dp_source_encoder_enqueue_callback(BT_HDR* p_buf,
+                                                      size_t frames_n,
+                                                      uint32_t bytes_read);
 static void log_tstamps_us(const char* comment, uint64_t timestamp_us);
 static void update_scheduling_stats(SchedulingStats* stats, uint64_t now_us,
                                     uint64_t expected_delta);
@@ -321,6 +399,9 @@ void btif_a2dp_source_accumulate_stats(BtifMediaStats* src,
   dst->media_read_total_underflow_count +=
       src->media_read_total_underflow_count;
   dst->media_read_last_underflow_us = src->media_read_last_underflow_us;
+  dst->hal_paced_deferred_ticks += src->hal_paced_deferred_ticks;
+  dst->encoder_offload_total_packets += src->encoder_offload_total_packets;
+  dst->encoder_offload_dropped_packets += src->encoder_offload_dropped_packets;
   if (dst->codec_index < 0) dst->codec_index = src->codec_index;
   btif_a2dp_source_accumulate_scheduling_stats(&src->tx_queue_enqueue_stats,
                                                &dst->tx_queue_enqueue_stats);
@@ -333,7 +414,10 @@ bool btif_a2dp_source_init(void) {
   LOG_INFO("%s", __func__);
 
   // Start A2DP Source media task
+  btif_a2dp_source_thread.EnableTaskStats();
   btif_a2dp_source_thread.StartUp();
+  btif_a2dp_source_encoder_thread.EnableTaskStats();
+  btif_a2dp_source_encoder_thread.StartUp();
   btif_a2dp_source_thread.DoInThread(
       FROM_HERE, base::Bind(&btif_a2dp_source_init_delayed));
   return true;
@@ -355,6 +439,23 @@ bool btif_a2dp_source_startup(void) {
   btif_a2dp_source_cb.Reset();
   btif_a2dp_source_cb.SetState(BtifA2dpSource::kStateStartingUp);
   btif_a2dp_source_cb.tx_audio_queue = fixed_queue_new(SIZE_MAX);
+  btif_a2dp_source_cb.pcm_queue =
+      fixed_queue_new_spsc(MAX_A2DP_ENCODER_PCM_CHUNKS);
+  btif_a2dp_source_cb.encoded_queue =
+      fixed_queue_new_spsc(MAX_OUTPUT_A2DP_FRAME_QUEUE_SZ);
+
+  AudioPipelineTrace::SetEnabled(
+      GET_SYSPROP(A2dp, source_pipeline_trace, false));
+#ifdef __ANDROID__
+  AudioPipelineTrace::SetObserver(
+      [](AudioPipelineTrace::Stage stage, uint64_t latency_us) {
+        static const std::string kTrackNames[AudioPipelineTrace::NUM_STAGES] =
+            {"A2DP encode us", "A2DP tx_queue us", "A2DP stack us",
+             "A2DP acl_scheduling us", "A2DP controller us"};
+        ATRACE_INT(kTrackNames[stage].c_str(),
+                   std::min<uint64_t>(latency_us, INT32_MAX));
+      });
+#endif
 
   // Schedule the rest of the operations
   btif_a2dp_source_thread.DoInThread(
@@ -365,11 +466,18 @@ bool btif_a2dp_source_startup(void) {
 
 static void btif_a2dp_source_startup_delayed() {
   LOG_INFO("%s: state=%s", __func__, btif_a2dp_source_cb.StateStr().c_str());
-  if (!btif_a2dp_source_thread.EnableRealTimeScheduling()) {
+  if (!thread_scheduler_apply_profile(
+          btif_a2dp_source_thread.GetLinuxThreadId(), "a2dp_source")) {
 #if defined(__ANDROID__)
     LOG(FATAL) << __func__ << ": unable to enable real time scheduling";
 #endif
   }
+  if (!thread_scheduler_apply_profile(
+          btif_a2dp_source_encoder_thread.GetLinuxThreadId(),
+          "a2dp_encoder")) {
+    LOG_WARN("%s: unable to enable real time scheduling of the encoder",
+             __func__);
+  }
   if (!bluetooth::audio::a2dp::init(&btif_a2dp_source_thread)) {
     if (btif_av_is_a2dp_offload_enabled()) {
       // TODO: BluetoothA2dp@1.0 is deprecated
@@ -508,7 +616,8 @@ static void btif_a2dp_source_shutdown_delayed(
 
   // Stop the timer
   btif_a2dp_source_cb.media_alarm.CancelAndWait();
-  wakelock_release();
+  wakelock_release_for("a2dp_source");
+  btif_a2dp_source_encoder_stop();
 
   if (bluetooth::audio::a2dp::is_hal_enabled()) {
     bluetooth::audio::a2dp::cleanup();
@@ -517,6 +626,10 @@ static void btif_a2dp_source_shutdown_delayed(
   }
   fixed_queue_free(btif_a2dp_source_cb.tx_audio_queue, nullptr);
   btif_a2dp_source_cb.tx_audio_queue = nullptr;
+  fixed_queue_free(btif_a2dp_source_cb.pcm_queue, osi_free);
+  btif_a2dp_source_cb.pcm_queue = nullptr;
+  fixed_queue_free(btif_a2dp_source_cb.encoded_queue, osi_free);
+  btif_a2dp_source_cb.encoded_queue = nullptr;
 
   btif_a2dp_source_cb.SetState(BtifA2dpSource::kStateOff);
 
@@ -533,8 +646,9 @@ void btif_a2dp_source_cleanup(void) {
   btif_a2dp_source_thread.DoInThread(
       FROM_HERE, base::Bind(&btif_a2dp_source_cleanup_delayed));
 
-  // Exit the thread
+  // Exit the threads
   btif_a2dp_source_thread.ShutDown();
+  btif_a2dp_source_encoder_thread.ShutDown();
 }
 
 static void btif_a2dp_source_cleanup_delayed(void) {
@@ -576,6 +690,9 @@ static void btif_a2dp_source_setup_codec_delayed(
            ADDRESS_TO_LOGGABLE_CSTR(peer_address),
            btif_a2dp_source_cb.StateStr().c_str());
 
+  // The encoder is about to be re-initialized from this thread
+  btif_a2dp_source_encoder_stop();
+
   tA2DP_ENCODER_INIT_PEER_PARAMS peer_params;
   bta_av_co_get_peer_params(peer_address, &peer_params);
 
@@ -596,14 +713,63 @@ static void btif_a2dp_source_setup_codec_delayed(
     return;
   }
 
-  btif_a2dp_source_cb.encoder_interface->encoder_init(
-      &peer_params, a2dp_codec_config, btif_a2dp_source_read_callback,
-      btif_a2dp_source_enqueue_callback);
+  // LDAC and Opus encode bursts take long enough to delay the control events
+  // of this thread: encode them on the encoder thread, from PCM data read
+  // ahead here.
+  btav_a2dp_codec_index_t codec_index = a2dp_codec_config->codecIndex();
+  btif_a2dp_source_cb.encoder_offload =
+      (codec_index == BTAV_A2DP_CODEC_INDEX_SOURCE_LDAC ||
+       codec_index == BTAV_A2DP_CODEC_INDEX_SOURCE_OPUS) &&
+      GET_SYSPROP(A2dp, source_encoder_offload, true) &&
+      btif_a2dp_source_encoder_thread.IsRunning();
+  if (btif_a2dp_source_cb.encoder_offload) {
+    btif_a2dp_source_cb.encoder_interface->encoder_init(
+        &peer_params, a2dp_codec_config,
+        btif_a2dp_source_encoder_read_callback,
+        btif_a2dp_source_encoder_enqueue_callback);
+  } else {
+    btif_a2dp_source_cb.encoder_interface->encoder_init(
+        &peer_params, a2dp_codec_config, btif_a2dp_source_read_callback,
+        btif_a2dp_source_enqueue_callback);
+  }
 
   // Save a local copy of the encoder_interval_ms
   btif_a2dp_source_cb.encoder_interval_ms =
       btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms();
 
+  // Size of the PCM data the encoder reads per interval, used to tell whether
+  // the audio HAL is late with HAL paced encoding
+  uint8_t codec_info[AVDT_CODEC_SIZE];
+  btif_a2dp_source_cb.pcm_bytes_per_interval = 0;
+  if (a2dp_codec_config->copyOutOtaCodecConfig(codec_info)) {
+    int sample_rate = A2DP_GetTrackSampleRate(codec_info);
+    int channel_count = A2DP_GetTrackChannelCount(codec_info);
+    int bits_per_sample = A2DP_GetTrackBitsPerSample(codec_info);
+    if (sample_rate > 0 && channel_count > 0 && bits_per_sample > 0) {
+      btif_a2dp_source_cb.pcm_bytes_per_interval =
+          static_cast<size_t>(sample_rate) *
+          btif_a2dp_source_cb.encoder_interval_ms / 1000 * channel_count *
+          (bits_per_sample / 8);
+    }
+  }
+  btif_a2dp_source_cb.hal_paced =
+      GET_SYSPROP(A2dp, source_hal_paced, false) &&
+      btif_a2dp_source_cb.pcm_bytes_per_interval > 0;
+
+  // The PCM data read ahead for the encoder thread is sized in intervals
+  if (btif_a2dp_source_cb.encoder_offload &&
+      btif_a2dp_source_cb.pcm_bytes_per_interval == 0) {
+    LOG_WARN("%s: unknown PCM interval size, encoding on this thread",
+             __func__);
+    btif_a2dp_source_cb.encoder_offload = false;
+    btif_a2dp_source_cb.encoder_interface->encoder_cleanup();
+    btif_a2dp_source_cb.encoder_interface->encoder_init(
+        &peer_params, a2dp_codec_config, btif_a2dp_source_read_callback,
+        btif_a2dp_source_enqueue_callback);
+  }
+  LOG_INFO("%s: encoder_offload=%s", __func__,
+           btif_a2dp_source_cb.encoder_offload ? "true" : "false");
+
   if (bluetooth::audio::a2dp::is_hal_enabled()) {
     bluetooth::audio::a2dp::setup_codec();
   }
@@ -619,6 +785,8 @@ static void btif_a2dp_source_cleanup_codec() {
 
 static void btif_a2dp_source_cleanup_codec_delayed() {
   LOG_INFO("%s: state=%s", __func__, btif_a2dp_source_cb.StateStr().c_str());
+  btif_a2dp_source_encoder_stop();
+  btif_a2dp_source_cb.encoder_offload = false;
   if (btif_a2dp_source_cb.encoder_interface != nullptr) {
     btif_a2dp_source_cb.encoder_interface->encoder_cleanup();
     btif_a2dp_source_cb.encoder_interface = nullptr;
@@ -807,7 +975,9 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
 
   /* Reset the media feeding state */
   CHECK(btif_a2dp_source_cb.encoder_interface != nullptr);
+  btif_a2dp_source_encoder_stop();
   btif_a2dp_source_cb.encoder_interface->feeding_reset();
+  btif_a2dp_source_cb.deferred_ticks = 0;
 
   LOG_VERBOSE("%s: starting timer %" PRIu64 " ms", __func__,
               btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms());
@@ -815,7 +985,7 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
   /* audio engine starting, reset tx suspended flag */
   btif_a2dp_source_cb.tx_flush = false;
 
-  wakelock_acquire();
+  wakelock_acquire_for("a2dp_source");
   btif_a2dp_source_cb.media_alarm.SchedulePeriodic(
       btif_a2dp_source_thread.GetWeakPtr(), FROM_HERE,
       base::Bind(&btif_a2dp_source_audio_handle_timer),
@@ -870,7 +1040,8 @@ static void btif_a2dp_source_audio_tx_stop_event(void) {
 
   /* Stop the timer first */
   btif_a2dp_source_cb.media_alarm.CancelAndWait();
-  wakelock_release();
+  wakelock_release_for("a2dp_source");
+  btif_a2dp_source_encoder_stop();
 
   if (bluetooth::audio::a2dp::is_hal_enabled()) {
     bluetooth::audio::a2dp::ack_stream_suspended(A2DP_CTRL_ACK_SUCCESS);
@@ -913,6 +1084,7 @@ static void btif_a2dp_source_audio_handle_timer(void) {
 #endif
 
   log_tstamps_us("A2DP Source tx scheduling timer", timestamp_us);
+  btif_a2dp_source_cb.last_tick_us = stats_timestamp_us;
 
   if (!btif_a2dp_source_is_streaming()) {
     LOG_ERROR("%s: ERROR Media task Scheduled after Suspend", __func__);
@@ -924,19 +1096,49 @@ static void btif_a2dp_source_audio_handle_timer(void) {
 #ifdef __ANDROID__
   ATRACE_INT("btif TX queue", transmit_queue_length);
 #endif
-  if (btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length !=
-      nullptr) {
+  if (!btif_a2dp_source_cb.encoder_offload &&
+      btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length !=
+          nullptr) {
     btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length(
         transmit_queue_length);
   }
-  btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
-  bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
+
+  // With HAL paced encoding, do not encode what the audio HAL has not written
+  // yet: the read would be short and padded with silence. The next tick
+  // encodes the time of both ticks, the deferral is bounded so that a stalled
+  // HAL is still reported as an underflow.
+  if (btif_a2dp_source_cb.hal_paced &&
+      bluetooth::audio::a2dp::is_hal_enabled()) {
+    if (bluetooth::audio::a2dp::available_to_read() <
+            btif_a2dp_source_cb.pcm_bytes_per_interval &&
+        btif_a2dp_source_cb.deferred_ticks < MAX_HAL_PACED_DEFERRED_TICKS) {
+      btif_a2dp_source_cb.deferred_ticks++;
+      btif_a2dp_source_cb.stats.hal_paced_deferred_ticks++;
+      update_scheduling_stats(
+          &btif_a2dp_source_cb.stats.tx_queue_enqueue_stats, stats_timestamp_us,
+          btif_a2dp_source_cb.encoder_interval_ms * 1000);
+      return;
+    }
+    btif_a2dp_source_cb.deferred_ticks = 0;
+  }
+
+  if (btif_a2dp_source_cb.encoder_offload) {
+    // The encoded packets are handed back by
+    // btif_a2dp_source_encoded_ready_event()
+    btif_a2dp_source_read_lookahead();
+    btif_a2dp_source_encoder_thread.DoInThread(
+        FROM_HERE, base::BindOnce(&btif_a2dp_source_encode_event, timestamp_us,
+                                  transmit_queue_length));
+  } else {
+    btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
+    bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
+  }
   update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_enqueue_stats,
                           stats_timestamp_us,
                           btif_a2dp_source_cb.encoder_interval_ms * 1000);
 }
 
-static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
+static uint32_t btif_a2dp_source_read_audio(uint8_t* p_buf, uint32_t len) {
   uint32_t bytes_read = 0;
 
   if (bluetooth::audio::a2dp::is_hal_enabled()) {
@@ -945,6 +1147,17 @@ static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
     bytes_read = UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, len);
   }
 
+  return bytes_read;
+}
+
+static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
+  uint32_t bytes_read = btif_a2dp_source_read_audio(p_buf, len);
+  btif_a2dp_source_log_read(len, bytes_read);
+  return bytes_read;
+}
+
+// Accounts for an encoder read of |len| bytes that returned |bytes_read|.
+static void btif_a2dp_source_log_read(uint32_t len, uint32_t bytes_read) {
   if (btif_a2dp_source_cb.sw_audio_is_encoding && bytes_read < len) {
     LOG_WARN("%s: UNDERFLOW: ONLY READ %d BYTES OUT OF %d", __func__,
              bytes_read, len);
@@ -957,8 +1170,6 @@ static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
                                   btif_a2dp_source_cb.encoder_interval_ms,
                                   len - bytes_read);
   }
-
-  return bytes_read;
 }
 
 static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
@@ -1052,16 +1263,163 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
       frames_n, btif_a2dp_source_cb.stats.tx_queue_max_frames_per_packet);
   CHECK(btif_a2dp_source_cb.encoder_interface != nullptr);
 
+  // The trace id is carried up to btif_a2dp_source_audio_readbuf()
+  p_buf->event = AudioPipelineTrace::OnEncoded(
+      now_us > btif_a2dp_source_cb.last_tick_us
+          ? now_us - btif_a2dp_source_cb.last_tick_us
+          : 0);
   fixed_queue_enqueue(btif_a2dp_source_cb.tx_audio_queue, p_buf);
 
   return true;
 }
 
+// Reads ahead the PCM data for the encoder thread: the data of the interval
+// about to be encoded, plus A2DP_ENCODER_LOOKAHEAD_INTERVALS intervals.
+// Runs on btif_a2dp_source_thread, the producer of |pcm_queue|.
+static void btif_a2dp_source_read_lookahead(void) {
+  size_t target_bytes = btif_a2dp_source_cb.pcm_bytes_per_interval *
+                        (1 + A2DP_ENCODER_LOOKAHEAD_INTERVALS);
+  size_t buffered_bytes = btif_a2dp_source_cb.lookahead_bytes;
+  if (buffered_bytes >= target_bytes) return;
+
+  size_t len = target_bytes - buffered_bytes;
+  if (bluetooth::audio::a2dp::is_hal_enabled()) {
+    len = std::min(len, bluetooth::audio::a2dp::available_to_read());
+  }
+  len = std::min<size_t>(len, UINT16_MAX);
+  if (len == 0) return;
+
+  BT_HDR* p_chunk = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + len);
+  p_chunk->event = 0;
+  p_chunk->offset = 0;
+  p_chunk->layer_specific = 0;
+  p_chunk->len = btif_a2dp_source_read_audio((uint8_t*)(p_chunk + 1), len);
+  btif_a2dp_control_log_bytes_read(p_chunk->len);
+  if (p_chunk->len == 0) {
+    osi_free(p_chunk);
+    return;
+  }
+
+  // Account for the data before the encoder thread can consume it
+  btif_a2dp_source_cb.lookahead_bytes += p_chunk->len;
+  if (!fixed_queue_try_enqueue(btif_a2dp_source_cb.pcm_queue, p_chunk)) {
+    LOG_WARN("%s: PCM lookahead queue is full, dropped %d bytes", __func__,
+             p_chunk->len);
+    btif_a2dp_source_cb.lookahead_bytes -= p_chunk->len;
+    osi_free(p_chunk);
+  }
+}
+
+// Encodes the PCM data read ahead for a timer tick, and hands the encoded
+// packets back to btif_a2dp_source_thread.
+// Runs on btif_a2dp_source_encoder_thread.
+static void btif_a2dp_source_encode_event(uint64_t timestamp_us,
+                                          size_t transmit_queue_length) {
+  const tA2DP_ENCODER_INTERFACE* encoder_interface =
+      btif_a2dp_source_cb.encoder_interface;
+  if (encoder_interface == nullptr) return;
+
+  if (encoder_interface->set_transmit_queue_length != nullptr) {
+    encoder_interface->set_transmit_queue_length(transmit_queue_length);
+  }
+  btif_a2dp_source_cb.encoded_packets_pending = false;
+  encoder_interface->send_frames(timestamp_us);
+  if (btif_a2dp_source_cb.encoded_packets_pending) {
+    btif_a2dp_source_thread.DoInThread(
+        FROM_HERE, base::BindOnce(&btif_a2dp_source_encoded_ready_event));
+  }
+}
+
+// Moves the packets encoded by the encoder thread to the TX queue.
+// Runs on btif_a2dp_source_thread, the consumer of |encoded_queue|.
+static void btif_a2dp_source_encoded_ready_event(void) {
+  if (btif_a2dp_source_cb.encoded_queue == nullptr) return;
+
+  BT_HDR* p_buf;
+  while ((p_buf = (BT_HDR*)fixed_queue_try_dequeue(
+              btif_a2dp_source_cb.encoded_queue)) != nullptr) {
+    size_t frames_n = p_buf->event;
+    p_buf->event = 0;
+    btif_a2dp_source_enqueue_callback(p_buf, frames_n, 0);
+  }
+  bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
+}
+
+// Waits for the encoding posted to the encoder thread, then discards the PCM
+// data read ahead and the encoded packets not handed back yet, so that the
+// encoder can be used from btif_a2dp_source_thread.
+// Runs on btif_a2dp_source_thread.
+static void btif_a2dp_source_encoder_stop(void) {
+  if (!btif_a2dp_source_cb.encoder_offload) return;
+
+  std::promise<void> stop_promise;
+  std::future<void> stop_future = stop_promise.get_future();
+  if (btif_a2dp_source_encoder_thread.DoInThread(
+          FROM_HERE, base::BindOnce(&btif_a2dp_source_encoder_stop_event,
+                                    std::move(stop_promise)))) {
+    stop_future.wait();
+  }
+  fixed_queue_flush(btif_a2dp_source_cb.encoded_queue, osi_free);
+}
+
+static void btif_a2dp_source_encoder_stop_event(std::promise<void> promise) {
+  fixed_queue_flush(btif_a2dp_source_cb.pcm_queue, osi_free);
+  osi_free_and_reset((void**)&btif_a2dp_source_cb.pcm_chunk);
+  btif_a2dp_source_cb.lookahead_bytes = 0;
+  promise.set_value();
+}
+
+// Reads the PCM data read ahead by btif_a2dp_source_read_lookahead().
+// Runs on btif_a2dp_source_encoder_thread, the consumer of |pcm_queue|.
+static uint32_t btif_a2dp_source_encoder_read_callback(uint8_t* p_buf,
+                                                       uint32_t len) {
+  uint32_t bytes_read = 0;
+
+  while (bytes_read < len) {
+    BT_HDR* p_chunk = btif_a2dp_source_cb.pcm_chunk;
+    if (p_chunk == nullptr) {
+      p_chunk = (BT_HDR*)fixed_queue_try_dequeue(btif_a2dp_source_cb.pcm_queue);
+      if (p_chunk == nullptr) break;
+      btif_a2dp_source_cb.pcm_chunk = p_chunk;
+    }
+    uint32_t n = std::min<uint32_t>(len - bytes_read, p_chunk->len);
+    memcpy(p_buf + bytes_read, (uint8_t*)(p_chunk + 1) + p_chunk->offset, n);
+    p_chunk->offset += n;
+    p_chunk->len -= n;
+    bytes_read += n;
+    if (p_chunk->len == 0) {
+      osi_free_and_reset((void**)&btif_a2dp_source_cb.pcm_chunk);
+    }
+  }
+  btif_a2dp_source_cb.lookahead_bytes -= bytes_read;
+
+  btif_a2dp_source_log_read(len, bytes_read);
+  return bytes_read;
+}
+
+// Hands an encoded packet back to btif_a2dp_source_thread.
+// Runs on btif_a2dp_source_encoder_thread, the producer of |encoded_queue|.
+static bool btif_a2dp_source_encoder_enqueue_callback(
+    BT_HDR* p_buf, size_t frames_n, uint32_t /* bytes_read */) {
+  // The frame count travels in the event field, unused by media packets
+  p_buf->event = frames_n;
+  if (!fixed_queue_try_enqueue(btif_a2dp_source_cb.encoded_queue, p_buf)) {
+    LOG_WARN("%s: encoded packet queue is full, dropped packet", __func__);
+    btif_a2dp_source_cb.stats.encoder_offload_dropped_packets++;
+    osi_free(p_buf);
+    return false;
+  }
+  btif_a2dp_source_cb.stats.encoder_offload_total_packets++;
+  btif_a2dp_source_cb.encoded_packets_pending = true;
+  return true;
+}
+
 static void btif_a2dp_source_audio_tx_flush_event(void) {
   /* Flush all enqueued audio buffers (encoded) */
   LOG_INFO("%s: state=%s", __func__, btif_a2dp_source_cb.StateStr().c_str());
   if (btif_av_is_a2dp_offload_running()) return;
 
+  btif_a2dp_source_encoder_stop();
   if (btif_a2dp_source_cb.encoder_interface != nullptr)
     btif_a2dp_source_cb.encoder_interface->feeding_flush();
 
@@ -1096,6 +1454,8 @@ BT_HDR* btif_a2dp_source_audio_readbuf(void) {
     update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_dequeue_stats,
                             now_us,
                             btif_a2dp_source_cb.encoder_interval_ms * 1000);
+    AudioPipelineTrace::OnDequeued(p_buf->event);
+    p_buf->event = 0;
   }
 
   return p_buf;
@@ -1236,6 +1596,20 @@ void btif_a2dp_source_debug_dump(int fd) {
                     1000
               : 0);
 
+  dprintf(fd,
+          "  Counts (encoding deferred until HAL data is available)  : %zu\n",
+          accumulated_stats->hal_paced_deferred_ticks);
+
+  dprintf(fd,
+          "  Encoder offload                                         : %s\n",
+          btif_a2dp_source_cb.encoder_offload ? "true" : "false");
+
+  dprintf(fd,
+          "  Encoder offload packets (total/dropped)                 : %zu / "
+          "%zu\n",
+          accumulated_stats->encoder_offload_total_packets,
+          accumulated_stats->encoder_offload_dropped_packets);
+
   //
   // TxQueue enqueue stats
   //
@@ -1311,6 +1685,15 @@ void btif_a2dp_source_debug_dump(int fd) {
       (unsigned long long)dequeue_stats->max_premature_scheduling_delta_us /
           1000,
       (unsigned long long)ave_time_us / 1000);
+
+  if (AudioPipelineTrace::IsEnabled()) {
+    // Bucket bounds in us: 1000/2000/5000/10000/20000/50000/100000/200000
+    dprintf(fd, "  Pipeline latency:\n");
+    dprintf(fd, "%s", AudioPipelineTrace::ToString("    ").c_str());
+  }
+
+  btif_a2dp_source_thread.DumpTaskStats(fd);
+  btif_a2dp_source_encoder_thread.DumpTaskStats(fd);
 }
 
 static void btif_a2dp_source_update_metrics(void) {
@@ -1732,7 +1732,8 @@ bool BtifAvStateMachine::StateIdle::ProcessEvent(uint32_t event, void* p_data) {
             "peers",
             __PRETTY_FUNCTION__, ADDRESS_TO_LOGGABLE_CSTR(peer_.PeerAddress()));
         if (peer_.SelfInitiatedConnection()) {
-          btif_queue_advance();
+          btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                     &peer_.PeerAddress());
         }
         break;
       }
@@ -1939,7 +1940,8 @@ bool BtifAvStateMachine::StateIdle::ProcessEvent(uint32_t event, void* p_data) {
         DEVICE_IOT_CONFIG_ADDR_INT_ADD_ONE(peer_.PeerAddress(),
                                            IOT_CONF_KEY_A2DP_CONN_FAIL_COUNT);
       }
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                 &peer_.PeerAddress());
     } break;
 
     case BTA_AV_REMOTE_CMD_EVT:
@@ -2031,7 +2033,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
                                    bt_status_t::BT_STATUS_FAIL, BTA_AV_FAIL);
       peer_.StateMachine().TransitionTo(BtifAvStateMachine::kStateIdle);
       if (peer_.SelfInitiatedConnection()) {
-        btif_queue_advance();
+        btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                   &peer_.PeerAddress());
       }
       break;
     case BTA_AV_REJECT_EVT:
@@ -2047,7 +2050,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
           bt_status_t::BT_STATUS_AUTH_REJECTED, BTA_AV_FAIL);
       peer_.StateMachine().TransitionTo(BtifAvStateMachine::kStateIdle);
       if (peer_.SelfInitiatedConnection()) {
-        btif_queue_advance();
+        btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                   &peer_.PeerAddress());
       }
       break;
 
@@ -2168,7 +2172,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
           BTA_AvOpenRc(peer_.BtaHandle());
       }
       if (peer_.SelfInitiatedConnection()) {
-        btif_queue_advance();
+        btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                   &peer_.PeerAddress());
       }
     } break;
 
@@ -2200,7 +2205,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
       log_counter_metrics_btif(
           android::bluetooth::CodePathCounterKeyEnum::A2DP_ALREADY_CONNECTING,
           1);
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                 &peer_.PeerAddress());
     } break;
 
     case BTA_AV_PENDING_EVT: {
@@ -2238,7 +2244,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
       DEVICE_IOT_CONFIG_ADDR_INT_ADD_ONE(peer_.PeerAddress(),
                                          IOT_CONF_KEY_A2DP_CONN_FAIL_COUNT);
       if (peer_.SelfInitiatedConnection()) {
-        btif_queue_advance();
+        btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                   &peer_.PeerAddress());
       }
       break;
 
@@ -2254,7 +2261,8 @@ bool BtifAvStateMachine::StateOpening::ProcessEvent(uint32_t event,
                                    A2DP_CONNECTION_DISCONNECTED,
                                1);
       if (peer_.SelfInitiatedConnection()) {
-        btif_queue_advance();
+        btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                   &peer_.PeerAddress());
       }
       break;
 
@@ -2485,7 +2493,8 @@ bool BtifAvStateMachine::StateOpened::ProcessEvent(uint32_t event,
       LOG_WARN("%s: Peer %s : Ignore %s for same device", __PRETTY_FUNCTION__,
                ADDRESS_TO_LOGGABLE_CSTR(peer_.PeerAddress()),
                BtifAvEvent::EventName(event).c_str());
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                 &peer_.PeerAddress());
     } break;
 
     case BTIF_AV_OFFLOAD_START_REQ_EVT:
@@ -2830,7 +2839,8 @@ bool BtifAvStateMachine::StateClosing::ProcessEvent(uint32_t event,
       LOG_WARN("%s: Peer %s : Ignore %s in StateClosing", __PRETTY_FUNCTION__,
                ADDRESS_TO_LOGGABLE_CSTR(peer_.PeerAddress()),
                BtifAvEvent::EventName(event).c_str());
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(peer_.LocalUuidServiceClass(),
+                                 &peer_.PeerAddress());
       peer_.StateMachine().TransitionTo(BtifAvStateMachine::kStateIdle);
       break;
 
@@ -3522,7 +3532,7 @@ static bt_status_t connect_int(RawAddress* peer_address, uint16_t uuid) {
       peer = btif_av_sink.FindOrCreatePeer(*peer_address, kBtaHandleUnknown);
     }
     if (peer == nullptr) {
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(uuid, peer_address);
       return;
     }
     peer->StateMachine().ProcessEvent(BTIF_AV_CONNECT_REQ_EVT, nullptr);
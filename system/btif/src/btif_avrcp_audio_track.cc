@@ -30,6 +30,12 @@
 #include <algorithm>
 #include <thread>
 
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "internal_include/bt_target.h"
 #include "os/log.h"
 
@@ -220,13 +226,37 @@ static size_t sampleSizeFor(BtifAvrcpAudioTrack* trackHolder) {
   return trackHolder->bitsPerSample / 8;
 }
 
+// The vector loops convert and scale 8 samples at a time, with the same
+// rounding as the scalar loops which handle the remaining samples.
 static size_t transcodeQ15ToFloat(uint8_t* buffer, size_t length,
                                   BtifAvrcpAudioTrack* trackHolder) {
   size_t sampleSize = sampleSizeFor(trackHolder);
   size_t i = 0;
+  const size_t count = std::min(trackHolder->bufferLength, length / sampleSize);
+  const int16_t* in = (int16_t*)buffer;
+  float* out = trackHolder->buffer;
   const float scaledGain = trackHolder->gain * kScaleQ15ToFloat;
-  for (; i < std::min(trackHolder->bufferLength, length / sampleSize); i++) {
-    trackHolder->buffer[i] = ((int16_t*)buffer)[i] * scaledGain;
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t samples = vld1q_s16(in + i);
+    vst1q_f32(out + i,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))),
+                          scaledGain));
+    vst1q_f32(out + i + 4,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(samples)), scaledGain));
+  }
+#elif defined(__SSE2__)
+  const __m128 gain = _mm_set1_ps(scaledGain);
+  for (; i + 8 <= count; i += 8) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(in + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), gain));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), gain));
+  }
+#endif
+  for (; i < count; i++) {
+    out[i] = in[i] * scaledGain;
   }
   return i * sampleSize;
 }
@@ -248,9 +278,28 @@ static size_t transcodeQ31ToFloat(uint8_t* buffer, size_t length,
                                   BtifAvrcpAudioTrack* trackHolder) {
   size_t sampleSize = sampleSizeFor(trackHolder);
   size_t i = 0;
+  const size_t count = std::min(trackHolder->bufferLength, length / sampleSize);
+  const int32_t* in = (int32_t*)buffer;
+  float* out = trackHolder->buffer;
   const float scaledGain = trackHolder->gain * kScaleQ31ToFloat;
-  for (; i < std::min(trackHolder->bufferLength, length / sampleSize); i++) {
-    trackHolder->buffer[i] = ((int32_t*)buffer)[i] * scaledGain;
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+  for (; i + 8 <= count; i += 8) {
+    vst1q_f32(out + i,
+              vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), scaledGain));
+    vst1q_f32(out + i + 4,
+              vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i + 4)), scaledGain));
+  }
+#elif defined(__SSE2__)
+  const __m128 gain = _mm_set1_ps(scaledGain);
+  for (; i + 8 <= count; i += 8) {
+    __m128i lo = _mm_loadu_si128((const __m128i*)(in + i));
+    __m128i hi = _mm_loadu_si128((const __m128i*)(in + i + 4));
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), gain));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), gain));
+  }
+#endif
+  for (; i < count; i++) {
+    out[i] = in[i] * scaledGain;
   }
   return i * sampleSize;
 }
@@ -21,8 +21,12 @@
 #endif
 #include <stdio.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <cerrno>
+#include <iterator>
+#include <map>
+#include <mutex>
 
 #include "btif/include/stack_manager.h"
 #include "btif_bqr.h"
@@ -31,6 +35,7 @@
 #include "btm_api.h"
 #include "btm_ble_api.h"
 #include "common/leaky_bonded_queue.h"
+#include "common/message_loop_thread.h"
 #include "common/time_util.h"
 #include "core_callbacks.h"
 #include "osi/include/properties.h"
@@ -42,6 +47,7 @@ namespace bluetooth {
 namespace bqr {
 
 using bluetooth::common::LeakyBondedQueue;
+using bluetooth::common::MessageLoopThread;
 using std::chrono::system_clock;
 
 // The instance of BQR event queue
@@ -50,6 +56,23 @@ static std::unique_ptr<LeakyBondedQueue<BqrVseSubEvt>> kpBqrEventQueue(
 
 static uint16_t vendor_cap_supported_version;
 
+// Writes the Log Dump trace log files and aggregates the link quality, so
+// that the HCI thread never waits for the file system or formats text.
+static MessageLoopThread bqr_log_thread("bt_bqr_log_thread");
+
+// Link quality aggregated per connection handle.
+struct BqrLinkStats {
+  uint64_t last_update_ms = 0;
+  uint32_t report_count = 0;
+  uint32_t rssi_histogram[std::size(kBqrRssiBucketBounds) + 1] = {};
+  // Only ISO links report their number of transmitted packets.
+  uint32_t per_histogram[std::size(kBqrPerBucketBounds) + 1] = {};
+};
+
+// Written on the BQR log thread, read by DebugDump.
+static std::mutex bqr_link_stats_mutex;
+static std::map<uint16_t, BqrLinkStats> bqr_link_stats;
+
 class BluetoothQualityReportInterfaceImpl;
 std::unique_ptr<BluetoothQualityReportInterface> bluetoothQualityReportInstance;
 
@@ -135,47 +158,42 @@ void BqrVseSubEvt::ParseBqrLinkQualityEvt(uint8_t length,
   localtime_r(&now, &tm_timestamp_);
 }
 
+// Write one Log Dump record with a single system call.
+static void WriteLogDumpRecord(int fd, const BqrLogDumpEvent& event,
+                               uint64_t timestamp_ms, uint8_t vsp_length) {
+  uint8_t header[kLogDumpRecordHeaderLen];
+  uint8_t* p_header = header;
+  UINT32_TO_STREAM(p_header, static_cast<uint32_t>(timestamp_ms));
+  UINT32_TO_STREAM(p_header, static_cast<uint32_t>(timestamp_ms >> 32));
+  UINT8_TO_STREAM(p_header, event.quality_report_id);
+  UINT16_TO_STREAM(p_header, event.connection_handle);
+  UINT8_TO_STREAM(p_header, vsp_length);
+
+  struct iovec iov[] = {
+      {header, sizeof(header)},
+      {const_cast<uint8_t*>(event.vendor_specific_parameter), vsp_length}};
+  TEMP_FAILURE_RETRY(writev(fd, iov, std::size(iov)));
+}
+
 void BqrVseSubEvt::WriteLmpLlTraceLogFile(int fd, uint8_t length,
                                           const uint8_t* p_param_buf) {
-  const auto now = system_clock::to_time_t(system_clock::now());
-  localtime_r(&now, &tm_timestamp_);
-
   STREAM_TO_UINT8(bqr_log_dump_event_.quality_report_id, p_param_buf);
   STREAM_TO_UINT16(bqr_log_dump_event_.connection_handle, p_param_buf);
   length -= kLogDumpParamTotalLen;
   bqr_log_dump_event_.vendor_specific_parameter = p_param_buf;
 
-  std::stringstream ss_log;
-  ss_log << "\n"
-         << std::put_time(&tm_timestamp_, "%m-%d %H:%M:%S ")
-         << "Handle: " << loghex(bqr_log_dump_event_.connection_handle)
-         << " VSP: ";
-
-  TEMP_FAILURE_RETRY(write(fd, ss_log.str().c_str(), ss_log.str().size()));
-  TEMP_FAILURE_RETRY(
-      write(fd, bqr_log_dump_event_.vendor_specific_parameter, length));
+  WriteLogDumpRecord(fd, bqr_log_dump_event_, timestamp_ms_, length);
   LmpLlMessageTraceCounter++;
 }
 
 void BqrVseSubEvt::WriteBtSchedulingTraceLogFile(int fd, uint8_t length,
                                                  const uint8_t* p_param_buf) {
-  const auto now = system_clock::to_time_t(system_clock::now());
-  localtime_r(&now, &tm_timestamp_);
-
   STREAM_TO_UINT8(bqr_log_dump_event_.quality_report_id, p_param_buf);
   STREAM_TO_UINT16(bqr_log_dump_event_.connection_handle, p_param_buf);
   length -= kLogDumpParamTotalLen;
   bqr_log_dump_event_.vendor_specific_parameter = p_param_buf;
 
-  std::stringstream ss_log;
-  ss_log << "\n"
-         << std::put_time(&tm_timestamp_, "%m-%d %H:%M:%S ")
-         << "Handle: " << loghex(bqr_log_dump_event_.connection_handle)
-         << " VSP: ";
-
-  TEMP_FAILURE_RETRY(write(fd, ss_log.str().c_str(), ss_log.str().size()));
-  TEMP_FAILURE_RETRY(
-      write(fd, bqr_log_dump_event_.vendor_specific_parameter, length));
+  WriteLogDumpRecord(fd, bqr_log_dump_event_, timestamp_ms_, length);
   BtSchedulingTraceCounter++;
 }
 
@@ -329,6 +347,10 @@ void EnableBtQualityReport(bool is_enable) {
     return;
   }
 
+  if (is_enable && !bqr_log_thread.IsRunning()) {
+    bqr_log_thread.StartUp();
+  }
+
   BqrConfiguration bqr_config = {};
 
   if (is_enable) {
@@ -480,6 +502,22 @@ void ConfigBqrA2dpScoThreshold() {
                             NULL);
 }
 
+// Close the Log Dump trace log files of the disabled quality events.
+static void CloseTraceLogFiles(uint32_t current_evt_mask) {
+  if (LmpLlMessageTraceLogFd != INVALID_FD &&
+      (current_evt_mask & kQualityEventMaskLmpMessageTrace) == 0) {
+    LOG(INFO) << __func__ << ": Closing LMP/LL log file.";
+    close(LmpLlMessageTraceLogFd);
+    LmpLlMessageTraceLogFd = INVALID_FD;
+  }
+  if (BtSchedulingTraceLogFd != INVALID_FD &&
+      (current_evt_mask & kQualityEventMaskBtSchedulingTrace) == 0) {
+    LOG(INFO) << __func__ << ": Closing Scheduling log file.";
+    close(BtSchedulingTraceLogFd);
+    BtSchedulingTraceLogFd = INVALID_FD;
+  }
+}
+
 void ConfigureBqrCmpl(uint32_t current_evt_mask) {
   LOG(INFO) << __func__ << ": current_evt_mask: " << loghex(current_evt_mask);
   // (Un)Register for VSE of Bluetooth Quality Report sub event
@@ -498,17 +536,10 @@ void ConfigureBqrCmpl(uint32_t current_evt_mask) {
     return;
   }
 
-  if (LmpLlMessageTraceLogFd != INVALID_FD &&
-      (current_evt_mask & kQualityEventMaskLmpMessageTrace) == 0) {
-    LOG(INFO) << __func__ << ": Closing LMP/LL log file.";
-    close(LmpLlMessageTraceLogFd);
-    LmpLlMessageTraceLogFd = INVALID_FD;
-  }
-  if (BtSchedulingTraceLogFd != INVALID_FD &&
-      (current_evt_mask & kQualityEventMaskBtSchedulingTrace) == 0) {
-    LOG(INFO) << __func__ << ": Closing Scheduling log file.";
-    close(BtSchedulingTraceLogFd);
-    BtSchedulingTraceLogFd = INVALID_FD;
+  // The pending records are written before the log files are closed.
+  if (!bqr_log_thread.DoInThread(
+          FROM_HERE, base::BindOnce(&CloseTraceLogFiles, current_evt_mask))) {
+    CloseTraceLogFiles(current_evt_mask);
   }
 }
 
@@ -555,14 +586,60 @@ void CategorizeBqrEvent(uint8_t length, const uint8_t* p_bqr_event) {
   }
 }
 
+// Log the Link Quality related BQR event and add it to the statistics of its
+// connection handle. Runs on the BQR log thread.
+static void AggregateLinkQuality(BqrVseSubEvt bqr_event) {
+  LOG(WARNING) << bqr_event;
+
+  const BqrLinkQualityEvent& event = bqr_event.bqr_link_quality_event_;
+  std::lock_guard<std::mutex> lock(bqr_link_stats_mutex);
+  if (bqr_link_stats.count(event.connection_handle) == 0 &&
+      bqr_link_stats.size() >= kBqrLinkStatsMaxHandles) {
+    auto oldest = bqr_link_stats.begin();
+    for (auto it = bqr_link_stats.begin(); it != bqr_link_stats.end(); it++) {
+      if (it->second.last_update_ms < oldest->second.last_update_ms) {
+        oldest = it;
+      }
+    }
+    bqr_link_stats.erase(oldest);
+  }
+
+  BqrLinkStats& stats = bqr_link_stats[event.connection_handle];
+  stats.last_update_ms = bqr_event.timestamp_ms_;
+  stats.report_count++;
+
+  size_t rssi_bucket = 0;
+  while (rssi_bucket < std::size(kBqrRssiBucketBounds) &&
+         event.rssi > kBqrRssiBucketBounds[rssi_bucket]) {
+    rssi_bucket++;
+  }
+  stats.rssi_histogram[rssi_bucket]++;
+
+  if (event.tx_total_packets > 0) {
+    uint64_t per = static_cast<uint64_t>(event.tx_unacked_packets) * 100 /
+                   event.tx_total_packets;
+    size_t per_bucket = 0;
+    while (per_bucket < std::size(kBqrPerBucketBounds) &&
+           per >= kBqrPerBucketBounds[per_bucket]) {
+      per_bucket++;
+    }
+    stats.per_histogram[per_bucket]++;
+  }
+}
+
 void AddLinkQualityEventToQueue(uint8_t length,
                                 const uint8_t* p_link_quality_event) {
   std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
   RawAddress bd_addr;
 
   p_bqr_event->ParseBqrLinkQualityEvt(length, p_link_quality_event);
+  p_bqr_event->timestamp_ms_ =
+      bluetooth::common::time_gettimeofday_us() / 1000;
 
-  LOG(WARNING) << *p_bqr_event;
+  if (!bqr_log_thread.DoInThread(
+          FROM_HERE, base::BindOnce(&AggregateLinkQuality, *p_bqr_event))) {
+    LOG(WARNING) << *p_bqr_event;
+  }
   GetInterfaceToProfiles()->events->invoke_link_quality_report_cb(
       bluetooth::common::time_get_os_boottime_ms(),
       p_bqr_event->bqr_link_quality_event_.quality_report_id,
@@ -632,17 +709,49 @@ void AddLinkQualityEventToQueue(uint8_t length,
   kpBqrEventQueue->Enqueue(p_bqr_event.release());
 }
 
-void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event) {
-  std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
-
+// Write the LMP/LL message trace event. Runs on the BQR log thread.
+static void WriteLmpLlMessage(std::unique_ptr<BqrVseSubEvt> p_bqr_event,
+                              std::vector<uint8_t> event) {
   if (LmpLlMessageTraceLogFd == INVALID_FD ||
       LmpLlMessageTraceCounter >= kLogDumpEventPerFile) {
+    if (LmpLlMessageTraceLogFd != INVALID_FD) {
+      close(LmpLlMessageTraceLogFd);
+    }
     LmpLlMessageTraceLogFd = OpenLmpLlTraceLogFile();
   }
   if (LmpLlMessageTraceLogFd != INVALID_FD) {
-    p_bqr_event->WriteLmpLlTraceLogFile(LmpLlMessageTraceLogFd, length,
-                                        p_lmp_ll_message_event);
+    p_bqr_event->WriteLmpLlTraceLogFile(LmpLlMessageTraceLogFd, event.size(),
+                                        event.data());
+  }
+}
+
+void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event) {
+  if (length < kLogDumpParamTotalLen) {
+    LOG(WARNING) << __func__
+                 << ": Parameter total length: " << std::to_string(length)
+                 << " is abnormal.";
+    return;
   }
+
+  std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
+  p_bqr_event->timestamp_ms_ =
+      bluetooth::common::time_gettimeofday_us() / 1000;
+  std::vector<uint8_t> event(p_lmp_ll_message_event,
+                             p_lmp_ll_message_event + length);
+  if (!bqr_log_thread.DoInThread(
+          FROM_HERE, base::BindOnce(&WriteLmpLlMessage, std::move(p_bqr_event),
+                                    std::move(event)))) {
+    LOG(WARNING) << __func__ << ": BQR log thread is not running";
+  }
+}
+
+// Write the file header of a Log Dump trace log file.
+static void WriteLogDumpFileHeader(int fd) {
+  uint8_t header[sizeof(kLogDumpFileMagic) + 1];
+  uint8_t* p_header = header;
+  ARRAY_TO_STREAM(p_header, kLogDumpFileMagic, sizeof(kLogDumpFileMagic));
+  UINT8_TO_STREAM(p_header, kLogDumpFileFormatVersion);
+  TEMP_FAILURE_RETRY(write(fd, header, sizeof(header)));
 }
 
 int OpenLmpLlTraceLogFile() {
@@ -662,21 +771,46 @@ int OpenLmpLlTraceLogFile() {
     LOG(ERROR) << __func__ << ": Unable to open '" << kpLmpLlMessageTraceLogPath
                << "' : " << strerror(errno);
   } else {
+    WriteLogDumpFileHeader(logfile_fd);
     LmpLlMessageTraceCounter = 0;
   }
   return logfile_fd;
 }
 
-void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event) {
-  std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
-
+// Write the Bluetooth Multi-profile/Coex scheduling trace event. Runs on the
+// BQR log thread.
+static void WriteBtScheduling(std::unique_ptr<BqrVseSubEvt> p_bqr_event,
+                              std::vector<uint8_t> event) {
   if (BtSchedulingTraceLogFd == INVALID_FD ||
-      BtSchedulingTraceCounter == kLogDumpEventPerFile) {
+      BtSchedulingTraceCounter >= kLogDumpEventPerFile) {
+    if (BtSchedulingTraceLogFd != INVALID_FD) {
+      close(BtSchedulingTraceLogFd);
+    }
     BtSchedulingTraceLogFd = OpenBtSchedulingTraceLogFile();
   }
   if (BtSchedulingTraceLogFd != INVALID_FD) {
-    p_bqr_event->WriteBtSchedulingTraceLogFile(BtSchedulingTraceLogFd, length,
-                                               p_bt_scheduling_event);
+    p_bqr_event->WriteBtSchedulingTraceLogFile(BtSchedulingTraceLogFd,
+                                               event.size(), event.data());
+  }
+}
+
+void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event) {
+  if (length < kLogDumpParamTotalLen) {
+    LOG(WARNING) << __func__
+                 << ": Parameter total length: " << std::to_string(length)
+                 << " is abnormal.";
+    return;
+  }
+
+  std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
+  p_bqr_event->timestamp_ms_ =
+      bluetooth::common::time_gettimeofday_us() / 1000;
+  std::vector<uint8_t> event(p_bt_scheduling_event,
+                             p_bt_scheduling_event + length);
+  if (!bqr_log_thread.DoInThread(
+          FROM_HERE, base::BindOnce(&WriteBtScheduling, std::move(p_bqr_event),
+                                    std::move(event)))) {
+    LOG(WARNING) << __func__ << ": BQR log thread is not running";
   }
 }
 
@@ -697,12 +831,43 @@ int OpenBtSchedulingTraceLogFile() {
     LOG(ERROR) << __func__ << ": Unable to open '" << kpBtSchedulingTraceLogPath
                << "' : " << strerror(errno);
   } else {
+    WriteLogDumpFileHeader(logfile_fd);
     BtSchedulingTraceCounter = 0;
   }
   return logfile_fd;
 }
 
+// Dump the link quality histograms of each connection handle.
+static void DumpLinkQualityStats(int fd) {
+  std::lock_guard<std::mutex> lock(bqr_link_stats_mutex);
+  if (bqr_link_stats.empty()) {
+    return;
+  }
+
+  constexpr size_t rssi_buckets = std::size(kBqrRssiBucketBounds);
+  constexpr size_t per_buckets = std::size(kBqrPerBucketBounds);
+  dprintf(fd, "\nBT Quality Report Link Statistics: \n");
+  for (const auto& [handle, stats] : bqr_link_stats) {
+    dprintf(fd, "  Handle: 0x%04x, Reports: %u\n", handle, stats.report_count);
+    dprintf(fd, "    RSSI(dBm):");
+    for (size_t i = 0; i < rssi_buckets; i++) {
+      dprintf(fd, " <=%d: %u,", kBqrRssiBucketBounds[i],
+              stats.rssi_histogram[i]);
+    }
+    dprintf(fd, " >%d: %u\n", kBqrRssiBucketBounds[rssi_buckets - 1],
+            stats.rssi_histogram[rssi_buckets]);
+    dprintf(fd, "    PER(%%):");
+    for (size_t i = 0; i < per_buckets; i++) {
+      dprintf(fd, " <%u: %u,", kBqrPerBucketBounds[i], stats.per_histogram[i]);
+    }
+    dprintf(fd, " >=%u: %u\n", kBqrPerBucketBounds[per_buckets - 1],
+            stats.per_histogram[per_buckets]);
+  }
+}
+
 void DebugDump(int fd) {
+  DumpLinkQualityStats(fd);
+
   dprintf(fd, "\nBT Quality Report Events: \n");
 
   if (kpBqrEventQueue->Empty()) {
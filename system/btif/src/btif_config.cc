@@ -37,7 +37,6 @@
 #include "btcore/include/module.h"
 #include "btif_api.h"
 #include "btif_common.h"
-#include "btif_config_cache.h"
 #include "btif_keystore.h"
 #include "btif_metrics_logging.h"
 #include "common/address_obfuscator.h"
@@ -54,8 +53,6 @@
 #include "raw_address.h"
 #include "stack/include/bt_octets.h"
 
-#define TEMPORARY_SECTION_CAPACITY 10000
-
 #define INFO_SECTION "Info"
 #define FILE_TIMESTAMP "TimeCreated"
 #define FILE_SOURCE "FileSource"
@@ -178,9 +175,6 @@ static void init_metric_id_allocator() {
 
 static std::recursive_mutex config_lock;  // protects operations on |config|.
 
-// limited btif config cache capacity
-static BtifConfigCache btif_config_cache(TEMPORARY_SECTION_CAPACITY);
-
 // Module lifecycle functions
 
 static future_t* init(void) {
@@ -374,16 +368,15 @@ void btif_debug_config_dump(int fd) {
   }
 
   std::optional<std::string> file_source;
+  std::vector<std::string> devices;
   if (bluetooth::shim::is_gd_stack_started_up()) {
     file_source =
         bluetooth::shim::BtifConfigInterface::GetStr(INFO_SECTION, FILE_SOURCE);
-  } else {
-    file_source = btif_config_cache.GetString(INFO_SECTION, FILE_SOURCE);
+    devices = bluetooth::shim::BtifConfigInterface::GetPersistentDevices();
   }
   if (!file_source) {
     file_source.emplace("Original");
   }
-  auto devices = btif_config_cache.GetPersistentSectionNames();
   dprintf(fd, "  Devices loaded: %zu\n", devices.size());
   dprintf(fd, "  File created/tagged: %s\n", btif_config_time_created);
   dprintf(fd, "  File source: %s\n", file_source->c_str());
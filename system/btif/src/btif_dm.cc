@@ -47,8 +47,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <map>
 #include <mutex>
 #include <optional>
+#include <vector>
 
 #include "advertise_data_parser.h"
 #include "bta/dm/bta_dm_disc.h"
@@ -63,6 +65,7 @@
 #include "btif_storage.h"
 #include "btif_util.h"
 #include "common/metrics.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "gd/common/lru_cache.h"
@@ -231,6 +234,28 @@ static skip_sdp_entry_t sdp_rejectlist[] = {{76}};  // Apple Mouse and Keyboard
 /* This flag will be true if HCI_Inquiry is in progress */
 static bool btif_dm_inquiry_in_progress = false;
 
+#define BTIF_DM_DISCOVERY_MAX_DEVICES 256
+
+/* Minimum interval between two reports of a changed RSSI of a device */
+#define BTIF_DM_DISCOVERY_RSSI_REPORT_INTERVAL_MS 1000
+
+/* A device found during the ongoing discovery session */
+typedef struct {
+  /* Last value of each property reported to the upper layer */
+  std::map<bt_property_type_t, std::vector<uint8_t>> reported;
+  /* Property values not written to storage yet */
+  std::map<bt_property_type_t, std::vector<uint8_t>> unsaved;
+  std::optional<tBLE_ADDR_TYPE> unsaved_addr_type;
+  uint64_t rssi_reported_ms;
+} btif_dm_discovered_device_t;
+
+typedef struct {
+  bool enabled;
+  std::map<RawAddress, btif_dm_discovered_device_t> devices;
+} btif_dm_discovery_cb_t;
+
+static btif_dm_discovery_cb_t discovery_cb;
+
 /*******************************************************************************
  *  Static variables
  ******************************************************************************/
@@ -254,6 +279,7 @@ static size_t btif_events_end_index = 0;
 static void btif_dm_ble_sec_req_evt(tBTA_DM_BLE_SEC_REQ* p_ble_req,
                                     bool is_consent);
 static void btif_dm_remove_ble_bonding_keys(void);
+static void btif_dm_discovery_flush(void);
 static void btif_dm_save_ble_bonding_keys(RawAddress& bd_addr);
 static btif_dm_pairing_cb_t pairing_cb;
 static btif_dm_oob_cb_t oob_cb;
@@ -303,6 +329,7 @@ static bool is_bonding_or_sdp() {
 void btif_dm_init(uid_set_t* set) { uid_set = set; }
 
 void btif_dm_cleanup(void) {
+  btif_dm_discovery_flush();
   if (uid_set) {
     uid_set_destroy(uid_set);
     uid_set = NULL;
@@ -1356,6 +1383,153 @@ static void btif_dm_auth_cmpl_evt(tBTA_DM_AUTH_CMPL* p_auth_cmpl) {
   }
 }
 
+/******************************************************************************
+ *
+ * Discovery session cache
+ *
+ * Inquiry and LE scan results repeat the same properties for the same device
+ * many times during a discovery. The devices found during the session are
+ * cached so that only the properties that changed are reported, the RSSI at
+ * most once per BTIF_DM_DISCOVERY_RSSI_REPORT_INTERVAL_MS, and so that a
+ * device is written to storage when it is first found and then only once more
+ * when the discovery ends.
+ *
+ *****************************************************************************/
+
+static void btif_dm_discovery_save_device(const RawAddress& bd_addr,
+                                          btif_dm_discovered_device_t& device) {
+  if (!device.unsaved.empty()) {
+    std::vector<bt_property_t> properties;
+    for (auto& [type, value] : device.unsaved) {
+      properties.push_back({type, (int)value.size(), value.data()});
+    }
+    bt_status_t status = btif_storage_add_remote_device(
+        &bd_addr, properties.size(), properties.data());
+    ASSERTC(status == BT_STATUS_SUCCESS,
+            "failed to save remote device (inquiry)", status);
+    device.unsaved.clear();
+  }
+  if (device.unsaved_addr_type.has_value()) {
+    bt_status_t status =
+        btif_storage_set_remote_addr_type(&bd_addr, *device.unsaved_addr_type);
+    ASSERTC(status == BT_STATUS_SUCCESS,
+            "failed to save remote addr type (inquiry)", status);
+    device.unsaved_addr_type.reset();
+  }
+}
+
+/* Writes the deferred properties of the devices found and ends the session */
+static void btif_dm_discovery_flush(void) {
+  for (auto& [bd_addr, device] : discovery_cb.devices) {
+    btif_dm_discovery_save_device(bd_addr, device);
+  }
+  discovery_cb.devices.clear();
+}
+
+/* Writes the deferred properties of |bd_addr|, before they are needed */
+static void btif_dm_discovery_flush_device(const RawAddress& bd_addr) {
+  auto it = discovery_cb.devices.find(bd_addr);
+  if (it != discovery_cb.devices.end()) {
+    btif_dm_discovery_save_device(bd_addr, it->second);
+  }
+}
+
+static void btif_dm_discovery_start(void) {
+  btif_dm_discovery_flush();
+  discovery_cb.enabled =
+      osi_property_get_bool("bluetooth.btif.discovery_cache.enabled", true);
+}
+
+/* Returns the cache entry of |bd_addr|, or nullptr when it isn't cached */
+static btif_dm_discovered_device_t* btif_dm_discovery_get_device(
+    const RawAddress& bd_addr, bool* is_new) {
+  *is_new = false;
+  if (!discovery_cb.enabled) return nullptr;
+  auto it = discovery_cb.devices.find(bd_addr);
+  if (it != discovery_cb.devices.end()) return &it->second;
+  if (discovery_cb.devices.size() >= BTIF_DM_DISCOVERY_MAX_DEVICES) {
+    return nullptr;
+  }
+  *is_new = true;
+  return &discovery_cb.devices[bd_addr];
+}
+
+/* Gets the device type of |bd_addr| including the one not saved yet */
+static bool btif_dm_discovery_get_device_type(const RawAddress& bd_addr,
+                                              int* p_device_type) {
+  auto it = discovery_cb.devices.find(bd_addr);
+  if (it != discovery_cb.devices.end()) {
+    auto type = it->second.unsaved.find(BT_PROPERTY_TYPE_OF_DEVICE);
+    if (type != it->second.unsaved.end() &&
+        type->second.size() == sizeof(uint32_t)) {
+      uint32_t dev_type;
+      memcpy(&dev_type, type->second.data(), sizeof(dev_type));
+      *p_device_type = dev_type;
+      return true;
+    }
+  }
+  return btif_get_device_type(bd_addr, p_device_type);
+}
+
+static void btif_dm_discovery_defer_save(btif_dm_discovered_device_t* device,
+                                         uint32_t num_properties,
+                                         bt_property_t* properties,
+                                         tBLE_ADDR_TYPE addr_type) {
+  for (uint32_t i = 0; i < num_properties; i++) {
+    const uint8_t* val = (const uint8_t*)properties[i].val;
+    device->unsaved[properties[i].type].assign(val, val + properties[i].len);
+  }
+  device->unsaved_addr_type = addr_type;
+}
+
+/* Removes the properties that were already reported with the same value, and
+ * the RSSI if it was reported too recently. Returns the number of properties
+ * left, which is 0 when there is nothing new to report. */
+static uint32_t btif_dm_discovery_filter_reported(
+    btif_dm_discovered_device_t* device, uint32_t num_properties,
+    bt_property_t* properties) {
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  uint32_t num_kept = 0;
+  bool changed = false;
+  bt_property_t rssi = {};
+
+  for (uint32_t i = 0; i < num_properties; i++) {
+    bt_property_t property = properties[i];
+    const uint8_t* val = (const uint8_t*)property.val;
+    std::vector<uint8_t> value(val, val + property.len);
+    auto reported = device->reported.find(property.type);
+    bool is_new = reported == device->reported.end();
+    if (property.type == BT_PROPERTY_BDADDR) {
+      properties[num_kept++] = property;
+      device->reported[property.type] = std::move(value);
+      continue;
+    }
+    if (!is_new && reported->second == value) continue;
+    if (property.type == BT_PROPERTY_REMOTE_RSSI && !is_new) {
+      // Decided below, once it is known whether anything else is reported
+      rssi = property;
+      continue;
+    }
+    if (property.type == BT_PROPERTY_REMOTE_RSSI) {
+      device->rssi_reported_ms = now_ms;
+    }
+    properties[num_kept++] = property;
+    device->reported[property.type] = std::move(value);
+    changed = true;
+  }
+
+  if (rssi.val != nullptr &&
+      (changed || now_ms - device->rssi_reported_ms >=
+                      BTIF_DM_DISCOVERY_RSSI_REPORT_INTERVAL_MS)) {
+    const uint8_t* val = (const uint8_t*)rssi.val;
+    device->reported[rssi.type].assign(val, val + rssi.len);
+    device->rssi_reported_ms = now_ms;
+    properties[num_kept++] = rssi;
+    changed = true;
+  }
+  return changed ? num_kept : 0;
+}
+
 /******************************************************************************
  *
  * Function         btif_dm_search_devices_evt
@@ -1389,6 +1563,12 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
                 "failed to save remote device property", status);
         GetInterfaceToProfiles()->events->invoke_remote_device_properties_cb(
             status, bdaddr, 1, properties);
+        auto device = discovery_cb.devices.find(bdaddr);
+        if (device != discovery_cb.devices.end()) {
+          const uint8_t* name = p_search_data->disc_res.bd_name;
+          device->second.reported[BT_PROPERTY_BDNAME].assign(
+              name, name + properties[0].len);
+        }
         /** Fix inquiry time too long @{ */
         uint32_t cod = 0;
         /* Check if we already have cod in our btif_storage cache */
@@ -1480,7 +1660,7 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
 
         /* Verify if the device is dual mode in NVRAM */
         int stored_device_type = 0;
-        if (btif_get_device_type(bdaddr, &stored_device_type) &&
+        if (btif_dm_discovery_get_device_type(bdaddr, &stored_device_type) &&
             ((stored_device_type != BT_DEVICE_TYPE_BREDR &&
               p_search_data->inq_res.device_type == BT_DEVICE_TYPE_BREDR) ||
              (stored_device_type != BT_DEVICE_TYPE_BLE &&
@@ -1582,13 +1762,21 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
           num_properties++;
         }
 
-        status =
-            btif_storage_add_remote_device(&bdaddr, num_properties, properties);
-        ASSERTC(status == BT_STATUS_SUCCESS,
-                "failed to save remote device (inquiry)", status);
-        status = btif_storage_set_remote_addr_type(&bdaddr, addr_type);
-        ASSERTC(status == BT_STATUS_SUCCESS,
-                "failed to save remote addr type (inquiry)", status);
+        bool is_new_device;
+        btif_dm_discovered_device_t* device =
+            btif_dm_discovery_get_device(bdaddr, &is_new_device);
+        if (device != nullptr && !is_new_device) {
+          btif_dm_discovery_defer_save(device, num_properties, properties,
+                                       addr_type);
+        } else {
+          status = btif_storage_add_remote_device(&bdaddr, num_properties,
+                                                  properties);
+          ASSERTC(status == BT_STATUS_SUCCESS,
+                  "failed to save remote device (inquiry)", status);
+          status = btif_storage_set_remote_addr_type(&bdaddr, addr_type);
+          ASSERTC(status == BT_STATUS_SUCCESS,
+                  "failed to save remote addr type (inquiry)", status);
+        }
 
         bool restrict_report = osi_property_get_bool(
             "bluetooth.restrict_discovered_device.enabled", false);
@@ -1600,6 +1788,12 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
           break;
         }
 
+        if (device != nullptr) {
+          num_properties = btif_dm_discovery_filter_reported(
+              device, num_properties, properties);
+          if (num_properties == 0) break;
+        }
+
         /* Callback to notify upper layer of device */
         GetInterfaceToProfiles()->events->invoke_device_found_cb(num_properties,
                                                                  properties);
@@ -1610,6 +1804,7 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
       /* do nothing */
     } break;
     case BTA_DM_DISC_CMPL_EVT: {
+      btif_dm_discovery_flush();
       GetInterfaceToProfiles()->events->invoke_discovery_state_changed_cb(
           BT_DISCOVERY_STOPPED);
     } break;
@@ -1624,6 +1819,7 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
        *
        */
       if (!btif_dm_inquiry_in_progress) {
+        btif_dm_discovery_flush();
         GetInterfaceToProfiles()->events->invoke_discovery_state_changed_cb(
             BT_DISCOVERY_STOPPED);
       }
@@ -2487,6 +2683,7 @@ void btif_dm_start_discovery(void) {
 
   /* Will be enabled to true once inquiry busy level has been received */
   btif_dm_inquiry_in_progress = false;
+  btif_dm_discovery_start();
   /* find nearby devices */
   BTA_DmSearch(btif_dm_search_devices_evt);
   power_telemetry::GetInstance().LogScanStarted();
@@ -2528,6 +2725,7 @@ void btif_dm_create_bond(const RawAddress bd_addr, int transport) {
   btif_stats_add_bond_event(bd_addr, BTIF_DM_FUNC_CREATE_BOND,
                             pairing_cb.state);
 
+  btif_dm_discovery_flush_device(bd_addr);
   pairing_cb.timeout_retries = NUM_TIMEOUT_RETRIES;
   btif_dm_cb_create_bond(bd_addr, transport);
 }
@@ -2555,6 +2753,7 @@ void btif_dm_create_bond_le(const RawAddress bd_addr,
   btif_stats_add_bond_event(bd_addr, BTIF_DM_FUNC_CREATE_BOND,
                             pairing_cb.state);
 
+  btif_dm_discovery_flush_device(bd_addr);
   pairing_cb.timeout_retries = NUM_TIMEOUT_RETRIES;
   btif_dm_cb_create_bond_le(bd_addr, addr_type);
 }
@@ -34,7 +34,10 @@
 #include <hardware/bt_gatt.h>
 #include <hardware/bt_gatt_types.h>
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "bta/include/bta_sec_api.h"
 #include "bta_api.h"
@@ -103,6 +106,85 @@ namespace {
 
 uint8_t rssi_request_client_if;
 
+constexpr int kMaxNotifyBatchCount = 64;
+constexpr int kMaxNotifyBatchDelayMs = 100;
+
+/* Notifications of one connection that are reported in a single upcall */
+struct NotifyBatch {
+  int max_count;
+  int max_delay_ms;
+  /* Tells the flush timeout of the pending batch apart from earlier ones */
+  uint32_t generation;
+  std::vector<btgatt_notify_params_t> notifications;
+};
+
+/* Connections with batched notifications, only used on the main thread */
+std::unordered_map<uint16_t, NotifyBatch> notify_batches;
+
+static void btif_gattc_flush_notify_batch(uint16_t conn_id,
+                                          NotifyBatch& batch) {
+  if (batch.notifications.empty()) return;
+
+  batch.generation++;
+  do_in_jni_thread(base::BindOnce(
+      [](uint16_t conn_id, std::vector<btgatt_notify_params_t> notifications) {
+        HAL_CBACK(bt_gatt_callbacks, client->notify_batch_cb, conn_id,
+                  notifications.data(), (int)notifications.size());
+      },
+      conn_id, std::move(batch.notifications)));
+  batch.notifications.clear();
+}
+
+static void btif_gattc_flush_all_notify_batches() {
+  for (auto& [conn_id, batch] : notify_batches) {
+    btif_gattc_flush_notify_batch(conn_id, batch);
+  }
+}
+
+static void btif_gattc_notify_batch_timeout(uint16_t conn_id,
+                                            uint32_t generation) {
+  auto it = notify_batches.find(conn_id);
+  if (it == notify_batches.end() || it->second.generation != generation) {
+    return;
+  }
+  btif_gattc_flush_notify_batch(conn_id, it->second);
+}
+
+/* Adds a notification to the batch of its connection, returns false if the
+ * notification must be reported on its own */
+static bool btif_gattc_batch_notification(const tBTA_GATTC_NOTIFY& notify) {
+  auto it = notify_batches.find(notify.conn_id);
+  if (it == notify_batches.end()) return false;
+
+  NotifyBatch& batch = it->second;
+  if (!notify.is_notify) {
+    /* Indications are confirmed once reported, keep them in order */
+    btif_gattc_flush_notify_batch(notify.conn_id, batch);
+    return false;
+  }
+
+  if (batch.notifications.empty()) {
+    batch.notifications.reserve(batch.max_count);
+    do_in_main_thread_delayed(
+        FROM_HERE,
+        base::BindOnce(&btif_gattc_notify_batch_timeout, notify.conn_id,
+                       batch.generation),
+        base::Milliseconds(batch.max_delay_ms));
+  }
+
+  btgatt_notify_params_t& data = batch.notifications.emplace_back();
+  data.bda = notify.bda;
+  memcpy(data.value, notify.value, notify.len);
+  data.handle = notify.handle;
+  data.is_notify = notify.is_notify;
+  data.len = notify.len;
+
+  if ((int)batch.notifications.size() >= batch.max_count) {
+    btif_gattc_flush_notify_batch(notify.conn_id, batch);
+  }
+  return true;
+}
+
 static void btif_gattc_upstreams_evt(uint16_t event, char* p_param) {
   LOG_DEBUG("Event %s [%d]",
             gatt_client_event_text(static_cast<tBTA_GATTC_EVT>(event)).c_str(),
@@ -218,6 +300,18 @@ static void btif_gattc_upstreams_evt(uint16_t event, char* p_param) {
 }
 
 static void bta_gattc_cback(tBTA_GATTC_EVT event, tBTA_GATTC* p_data) {
+  if (!notify_batches.empty()) {
+    if (event == BTA_GATTC_NOTIF_EVT) {
+      if (btif_gattc_batch_notification(p_data->notify)) return;
+    } else {
+      /* Pending notifications are reported before any later event */
+      btif_gattc_flush_all_notify_batches();
+      if (event == BTA_GATTC_CLOSE_EVT) {
+        notify_batches.erase(p_data->close.conn_id);
+      }
+    }
+  }
+
   LOG_DEBUG(" gatt client callback event:%s [%d]",
             gatt_client_event_text(event).c_str(), event);
   bt_status_t status =
@@ -679,6 +773,33 @@ static bt_status_t btif_gattc_subrate_request(const RawAddress& bd_addr,
            subrate_min, subrate_max, max_latency, cont_num, sup_timeout));
 }
 
+static void btif_gattc_set_notify_batching_impl(uint16_t conn_id,
+                                                int max_count,
+                                                int max_delay_ms) {
+  auto it = notify_batches.find(conn_id);
+  if (it != notify_batches.end()) {
+    btif_gattc_flush_notify_batch(conn_id, it->second);
+    notify_batches.erase(it);
+  }
+  if (max_count < 2) return;
+
+  NotifyBatch& batch = notify_batches[conn_id];
+  batch.max_count = std::min(max_count, kMaxNotifyBatchCount);
+  batch.max_delay_ms = std::clamp(max_delay_ms, 0, kMaxNotifyBatchDelayMs);
+  batch.generation = 0;
+}
+
+static bt_status_t btif_gattc_set_notify_batching(int conn_id, int max_count,
+                                                  int max_delay_ms) {
+  CHECK_BTGATT_INIT();
+  if (max_count > 1 && bt_gatt_callbacks->client->notify_batch_cb == nullptr) {
+    return BT_STATUS_UNSUPPORTED;
+  }
+  return do_in_main_thread(
+      FROM_HERE, base::BindOnce(&btif_gattc_set_notify_batching_impl,
+                                conn_id, max_count, max_delay_ms));
+}
+
 }  // namespace
 
 const btgatt_client_interface_t btgattClientInterface = {
@@ -706,4 +827,5 @@ const btgatt_client_interface_t btgattClientInterface = {
     btif_gattc_test_command,
     btif_gattc_get_gatt_db,
     btif_gattc_subrate_request,
+    btif_gattc_set_notify_batching,
 };
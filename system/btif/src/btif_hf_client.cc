@@ -884,7 +884,9 @@ static void btif_hf_client_upstreams_evt(uint16_t event, char* p_param) {
       if (cb->state == BTHF_CLIENT_CONNECTION_STATE_DISCONNECTED)
         cb->peer_bda = RawAddress::kAny;
 
-      if (p_data->open.status != BTA_HF_CLIENT_SUCCESS) btif_queue_advance();
+      if (p_data->open.status != BTA_HF_CLIENT_SUCCESS)
+        btif_queue_advance_by_uuid(UUID_SERVCLASS_HF_HANDSFREE,
+                                   &p_data->bd_addr);
       break;
 
     case BTA_HF_CLIENT_CONN_EVT:
@@ -901,7 +903,7 @@ static void btif_hf_client_upstreams_evt(uint16_t event, char* p_param) {
                   BTHF_CLIENT_IN_BAND_RINGTONE_PROVIDED);
       }
 
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(UUID_SERVCLASS_HF_HANDSFREE, &p_data->bd_addr);
       break;
 
     case BTA_HF_CLIENT_CLOSE_EVT:
@@ -927,7 +929,7 @@ static void btif_hf_client_upstreams_evt(uint16_t event, char* p_param) {
         cb->handle = 0;
       }
 
-      btif_queue_advance();
+      btif_queue_advance_by_uuid(UUID_SERVCLASS_HF_HANDSFREE, &p_data->bd_addr);
       break;
 
     case BTA_HF_CLIENT_IND_EVT:
@@ -21,6 +21,9 @@
 #include <base/logging.h>
 #include <base/threading/platform_thread.h>
 
+#include <stdio.h>
+
+#include <atomic>
 #include <cstdint>
 #include <utility>
 
@@ -33,10 +36,29 @@ using base::PlatformThread;
 
 static bluetooth::common::MessageLoopThread jni_thread("bt_jni_thread");
 
-void jni_thread_startup() { jni_thread.StartUp(); }
+// Number of tasks posted to the JNI thread that have not run yet, and the
+// highest value it reached.
+static std::atomic<uint32_t> jni_queue_depth{0};
+static std::atomic<uint32_t> jni_queue_max_depth{0};
+
+void jni_thread_startup() {
+  jni_thread.EnableTaskStats();
+  jni_thread.StartUp();
+}
 
 void jni_thread_shutdown() { jni_thread.ShutDown(); }
 
+void jni_thread_debug_dump(int fd) {
+  jni_thread.DumpTaskStats(fd);
+  dprintf(fd, "  bt_jni_thread queue depth: %u max: %u\n",
+          jni_queue_depth.load(), jni_queue_max_depth.load());
+}
+
+static void run_jni_task(base::OnceClosure task) {
+  jni_queue_depth--;
+  std::move(task).Run();
+}
+
 /*******************************************************************************
  *
  * Function         btif_task
@@ -100,7 +122,14 @@ bt_status_t btif_transfer_context(tBTIF_CBACK* p_cback, uint16_t event,
  **/
 bt_status_t do_in_jni_thread(const base::Location& from_here,
                              base::OnceClosure task) {
-  if (!jni_thread.DoInThread(from_here, std::move(task))) {
+  uint32_t depth = ++jni_queue_depth;
+  uint32_t max_depth = jni_queue_max_depth.load();
+  while (depth > max_depth &&
+         !jni_queue_max_depth.compare_exchange_weak(max_depth, depth)) {
+  }
+  if (!jni_thread.DoInThread(from_here,
+                             base::BindOnce(run_jni_task, std::move(task)))) {
+    jni_queue_depth--;
     LOG(ERROR) << __func__ << ": Post task to task runner failed!";
     return BT_STATUS_FAIL;
   }
@@ -24,6 +24,7 @@
 #include <hardware/bluetooth.h>
 
 #include <map>
+#include <mutex>
 
 #include "btif_common.h"
 #include "btif_storage.h"
@@ -77,7 +78,11 @@ class BluetoothKeystoreInterfaceImpl
     }
 
     // Save the value into a map.
-    key_map[prefix] = decryptedString;
+    {
+      std::lock_guard<std::mutex> lock(key_map_mutex);
+      WipeString(key_map[prefix]);
+      key_map[prefix] = decryptedString;
+    }
 
     do_in_jni_thread(base::BindOnce(
         &bluetooth::bluetooth_keystore::BluetoothKeystoreCallbacks::
@@ -94,30 +99,47 @@ class BluetoothKeystoreInterfaceImpl
       return "";
     }
 
-    std::string decryptedString;
     // try to find the key.
-    std::map<std::string, std::string>::iterator iter = key_map.find(prefix);
-    if (iter == key_map.end()) {
-      decryptedString = callbacks->get_key(prefix);
-      // Save the value into a map.
-      key_map[prefix] = decryptedString;
-      VLOG(2) << __func__ << ": get key from bluetoothkeystore.";
-    } else {
-      decryptedString = iter->second;
+    {
+      std::lock_guard<std::mutex> lock(key_map_mutex);
+      auto iter = key_map.find(prefix);
+      if (iter != key_map.end()) {
+        return iter->second;
+      }
     }
+
+    // Decrypting goes through the keystore service, do not hold the lock
+    // meanwhile so that other keys are still served from the map.
+    std::string decryptedString = callbacks->get_key(prefix);
+    VLOG(2) << __func__ << ": get key from bluetoothkeystore.";
+    // Save the value into a map.
+    std::lock_guard<std::mutex> lock(key_map_mutex);
+    key_map.emplace(prefix, decryptedString);
     return decryptedString;
   }
 
   void clear_map() override {
     VLOG(2) << __func__;
 
-    std::map<std::string, std::string> empty_map;
-    key_map.swap(empty_map);
+    std::lock_guard<std::mutex> lock(key_map_mutex);
+    for (auto& entry : key_map) {
+      WipeString(entry.second);
+    }
     key_map.clear();
   }
 
  private:
+  // Overwrite the decrypted key material before its memory is released
+  static void WipeString(std::string& value) {
+    volatile char* data = value.data();
+    for (size_t i = 0; i < value.size(); i++) {
+      data[i] = 0;
+    }
+  }
+
   BluetoothKeystoreCallbacks* callbacks = nullptr;
+  // Decrypted keys, kept for the lifetime of the stack, until clear_map()
+  std::mutex key_map_mutex;
   std::map<std::string, std::string> key_map;
 };
 
@@ -35,8 +35,8 @@
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
-#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "bta/include/bta_pan_api.h"
@@ -396,17 +396,20 @@ int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst,
     eth_hdr.h_dest = dst;
     eth_hdr.h_src = src;
     eth_hdr.h_proto = htons(proto);
-    char packet[TAP_MAX_PKT_WRITE_LEN + sizeof(tETH_HDR)];
-    memcpy(packet, &eth_hdr, sizeof(tETH_HDR));
     if (len > TAP_MAX_PKT_WRITE_LEN) {
       LOG_ERROR("btpan_tap_send eth packet size:%d is exceeded limit!", len);
       return -1;
     }
-    memcpy(packet + sizeof(tETH_HDR), buf, len);
 
-    /* Send data to network interface */
+    /* Send data to network interface. The TAP driver takes one frame per
+     * write, gather the header and the payload instead of copying them. */
+    struct iovec iov[2];
+    iov[0].iov_base = &eth_hdr;
+    iov[0].iov_len = sizeof(tETH_HDR);
+    iov[1].iov_base = (void*)buf;
+    iov[1].iov_len = len;
     ssize_t ret;
-    OSI_NO_INTR(ret = write(tap_fd, packet, len + sizeof(tETH_HDR)));
+    OSI_NO_INTR(ret = writev(tap_fd, iov, 2));
     LOG_VERBOSE("ret:%zd", ret);
     return (int)ret;
   }
@@ -642,22 +645,15 @@ static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data) {
                         sizeof(tBTA_PAN), NULL);
 }
 
-#define IS_EXCEPTION(e) ((e) & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL))
 static void btu_exec_tap_fd_read(int fd) {
-  struct pollfd ufd;
-
   if (fd == INVALID_FD || fd != btpan_cb.tap_fd) return;
 
   // Don't occupy BTU context too long, avoid buffer overruns and
   // give other profiles a chance to run by limiting the amount of memory
   // PAN can use.
+  // The TAP fd is non-blocking, so the batch ends when a read would block
+  // instead of polling the fd after every frame.
   for (int i = 0; i < PAN_BUF_MAX && btif_is_enabled() && btpan_cb.flow; i++) {
-    BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
-    buffer->offset = PAN_MINIMUM_OFFSET;
-    buffer->len = PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset;
-
-    uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
-
     // If we don't have an undelivered packet left over, pull one from the TAP
     // driver.
     // We save it in the congest_packet right away in case we can't deliver it
@@ -667,17 +663,17 @@ static void btu_exec_tap_fd_read(int fd) {
       ssize_t ret;
       OSI_NO_INTR(ret = read(fd, btpan_cb.congest_packet,
                              sizeof(btpan_cb.congest_packet)));
+      // No more frames queued in the driver.
+      if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
       switch (ret) {
         case -1:
           LOG_ERROR("%s unable to read from driver: %s", __func__,
                     strerror(errno));
-          osi_free(buffer);
           // add fd back to monitor thread to try it again later
           btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
           return;
         case 0:
           LOG_WARN("%s end of file reached.", __func__);
-          osi_free(buffer);
           // add fd back to monitor thread to process the exception
           btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
           return;
@@ -687,6 +683,12 @@ static void btu_exec_tap_fd_read(int fd) {
       }
     }
 
+    BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
+    buffer->offset = PAN_MINIMUM_OFFSET;
+    buffer->len = PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset;
+
+    uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
+
     memcpy(packet, btpan_cb.congest_packet,
            MIN(btpan_cb.congest_packet_size, buffer->len));
     buffer->len = MIN(btpan_cb.congest_packet_size, buffer->len);
@@ -709,15 +711,6 @@ static void btu_exec_tap_fd_read(int fd) {
       btpan_cb.congest_packet_size = 0;
       osi_free(buffer);
     }
-
-    // Bail out of the loop if reading from the TAP fd would block.
-    ufd.fd = fd;
-    ufd.events = POLLIN;
-    ufd.revents = 0;
-
-    int ret;
-    OSI_NO_INTR(ret = poll(&ufd, 1, 0));
-    if (ret <= 0 || IS_EXCEPTION(ufd.revents)) break;
   }
 
   if (btpan_cb.flow) {
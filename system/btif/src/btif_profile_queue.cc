@@ -34,23 +34,35 @@
 #include <base/strings/stringprintf.h>
 #include <string.h>
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <list>
+#include <mutex>
 
 #include "btif/include/stack_manager.h"
 #include "btif_common.h"
 #include "main/shim/dumpsys.h"
+#include "osi/include/properties.h"
+#include "stack/include/bt_uuid16.h"
 #include "types/raw_address.h"
 
 /*******************************************************************************
  *  Local type definitions
  ******************************************************************************/
 
+using Clock = std::chrono::steady_clock;
+
 // Class to store connect info.
 class ConnectNode {
  public:
   ConnectNode(const RawAddress& address, uint16_t uuid,
               btif_connect_cb_t connect_cb)
-      : address_(address), uuid_(uuid), busy_(false), connect_cb_(connect_cb) {}
+      : address_(address),
+        uuid_(uuid),
+        busy_(false),
+        connect_cb_(connect_cb),
+        queued_at_(Clock::now()) {}
 
   std::string ToString() const {
     return base::StringPrintf("address=%s UUID=%04X busy=%s",
@@ -60,6 +72,12 @@ class ConnectNode {
 
   const RawAddress& address() const { return address_; }
   uint16_t uuid() const { return uuid_; }
+  bool busy() const { return busy_; }
+
+  // Time spent in the queue before the connection was initiated.
+  uint64_t wait_ms() const { return ElapsedMs(queued_at_, started_at_); }
+  // Time since the connection was initiated.
+  uint64_t connect_ms() const { return ElapsedMs(started_at_, Clock::now()); }
 
   /**
    * Initiate the connection.
@@ -71,14 +89,38 @@ class ConnectNode {
   bt_status_t connect() {
     if (busy_) return BT_STATUS_SUCCESS;
     busy_ = true;
+    started_at_ = Clock::now();
     return connect_cb_(&address_, uuid_);
   }
 
  private:
+  static uint64_t ElapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from)
+        .count();
+  }
+
   RawAddress address_;
   uint16_t uuid_;
   bool busy_;
   btif_connect_cb_t connect_cb_;
+  Clock::time_point queued_at_;
+  Clock::time_point started_at_;
+};
+
+// Latency statistics of the connection requests, shared with dumpsys.
+struct ConnectStats {
+  std::mutex mutex;
+  uint64_t started = 0;
+  uint64_t failed = 0;
+  uint64_t completed = 0;
+  uint64_t total_wait_ms = 0;
+  uint64_t max_wait_ms = 0;
+  uint64_t total_connect_ms = 0;
+  uint64_t max_connect_ms = 0;
+  size_t queued = 0;
+  size_t in_progress = 0;
+  size_t max_in_progress = 0;
+  std::deque<std::string> recent;
 };
 
 /*******************************************************************************
@@ -89,10 +131,108 @@ static std::list<ConnectNode> connect_queue;
 
 static const size_t MAX_REASONABLE_REQUESTS = 20;
 
+// Default number of connection requests in progress at the same time, to
+// different devices or to profiles of the same device that don't conflict.
+static const int32_t DEFAULT_MAX_CONCURRENT_CONNECTS = 3;
+
+static const size_t MAX_RECENT_REQUESTS = 16;
+
+static ConnectStats connect_stats;
+
+// Set by the tests, overrides the configured concurrency cap when not zero.
+static size_t max_concurrent_connects_override = 0;
+
 /*******************************************************************************
  *  Queue helper functions
  ******************************************************************************/
 
+static size_t queue_int_max_concurrent_connects() {
+  if (max_concurrent_connects_override != 0) {
+    return max_concurrent_connects_override;
+  }
+  int32_t max_connects =
+      osi_property_get_int32("bluetooth.btif.profile_queue.max_connects",
+                             DEFAULT_MAX_CONCURRENT_CONNECTS);
+  return std::max<int32_t>(max_connects, 1);
+}
+
+static bool is_avdtp_profile(uint16_t uuid) {
+  return uuid == UUID_SERVCLASS_AUDIO_SOURCE ||
+         uuid == UUID_SERVCLASS_AUDIO_SINK;
+}
+
+static bool is_rfcomm_profile(uint16_t uuid) {
+  return uuid == UUID_SERVCLASS_AG_HANDSFREE ||
+         uuid == UUID_SERVCLASS_HF_HANDSFREE;
+}
+
+static bool is_same_profile_family(uint16_t uuid1, uint16_t uuid2) {
+  return (is_avdtp_profile(uuid1) && is_avdtp_profile(uuid2)) ||
+         (is_rfcomm_profile(uuid1) && is_rfcomm_profile(uuid2));
+}
+
+// A2DP runs on its own L2CAP channels and HFP on RFCOMM, with separate state
+// machines, so one of each can be connecting to the same device at once. Any
+// other combination is serialized per device.
+static bool is_parallel_connect_safe(uint16_t uuid1, uint16_t uuid2) {
+  return (is_avdtp_profile(uuid1) && is_rfcomm_profile(uuid2)) ||
+         (is_rfcomm_profile(uuid1) && is_avdtp_profile(uuid2));
+}
+
+// Requests to the same device are started in order, and only alongside the
+// requests of that device in progress they don't conflict with.
+static bool queue_int_can_connect(std::list<ConnectNode>::iterator node) {
+  bool is_before_node = true;
+  for (auto it = connect_queue.begin(); it != connect_queue.end(); ++it) {
+    if (it == node) {
+      is_before_node = false;
+      continue;
+    }
+    if (it->address() != node->address()) continue;
+    if (it->busy()) {
+      if (!is_parallel_connect_safe(it->uuid(), node->uuid())) return false;
+    } else if (is_before_node) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void queue_int_update_stats() {
+  std::lock_guard<std::mutex> lock(connect_stats.mutex);
+  connect_stats.queued = connect_queue.size();
+  connect_stats.in_progress =
+      std::count_if(connect_queue.begin(), connect_queue.end(),
+                    [](const ConnectNode& node) { return node.busy(); });
+  connect_stats.max_in_progress =
+      std::max(connect_stats.max_in_progress, connect_stats.in_progress);
+}
+
+static void queue_int_record(const ConnectNode& node, bool started) {
+  std::lock_guard<std::mutex> lock(connect_stats.mutex);
+  uint64_t wait_ms = node.wait_ms();
+  uint64_t connect_ms = started ? node.connect_ms() : 0;
+  connect_stats.total_wait_ms += wait_ms;
+  connect_stats.max_wait_ms = std::max(connect_stats.max_wait_ms, wait_ms);
+  if (started) {
+    connect_stats.completed++;
+    connect_stats.total_connect_ms += connect_ms;
+    connect_stats.max_connect_ms =
+        std::max(connect_stats.max_connect_ms, connect_ms);
+  } else {
+    connect_stats.failed++;
+  }
+
+  connect_stats.recent.push_back(base::StringPrintf(
+      "address=%s UUID=%04X %s wait_ms=%llu connect_ms=%llu",
+      ADDRESS_TO_LOGGABLE_CSTR(node.address()), node.uuid(),
+      started ? "completed" : "failed", (unsigned long long)wait_ms,
+      (unsigned long long)connect_ms));
+  if (connect_stats.recent.size() > MAX_RECENT_REQUESTS) {
+    connect_stats.recent.pop_front();
+  }
+}
+
 static void queue_int_add(uint16_t uuid, const RawAddress& bda,
                           btif_connect_cb_t connect_cb) {
   // Sanity check to make sure we're not leaking connection requests
@@ -113,13 +253,45 @@ static void queue_int_add(uint16_t uuid, const RawAddress& bda,
   btif_queue_connect_next();
 }
 
+static void queue_int_remove(std::list<ConnectNode>::iterator node) {
+  LOG_INFO("%s: removing connection request: %s", __func__,
+           node->ToString().c_str());
+  if (node->busy()) queue_int_record(*node, true);
+  connect_queue.erase(node);
+}
+
 static void queue_int_advance() {
   if (connect_queue.empty()) return;
 
-  const ConnectNode& head = connect_queue.front();
-  LOG_INFO("%s: removing connection request: %s", __func__,
-           head.ToString().c_str());
-  connect_queue.pop_front();
+  // Without the completed request, assume it is the oldest one in progress.
+  auto node = std::find_if(connect_queue.begin(), connect_queue.end(),
+                           [](const ConnectNode& node) { return node.busy(); });
+  if (node == connect_queue.end()) node = connect_queue.begin();
+  queue_int_remove(node);
+
+  btif_queue_connect_next();
+}
+
+static void queue_int_advance_by_uuid(uint16_t uuid, const RawAddress& bda) {
+  auto node = std::find_if(connect_queue.begin(), connect_queue.end(),
+                           [&](const ConnectNode& node) {
+                             return node.busy() && node.uuid() == uuid &&
+                                    node.address() == bda;
+                           });
+  if (node == connect_queue.end()) {
+    // The role of an A2DP or HFP peer may have changed since the request.
+    node = std::find_if(connect_queue.begin(), connect_queue.end(),
+                        [&](const ConnectNode& node) {
+                          return node.busy() && node.address() == bda &&
+                                 is_same_profile_family(node.uuid(), uuid);
+                        });
+  }
+  if (node != connect_queue.end()) {
+    queue_int_remove(node);
+  } else {
+    LOG_VERBOSE("%s: no connection request in progress for %s UUID=%04X",
+                __func__, ADDRESS_TO_LOGGABLE_CSTR(bda), uuid);
+  }
 
   btif_queue_connect_next();
 }
@@ -136,9 +308,13 @@ static void queue_int_cleanup(uint16_t uuid) {
       connect_queue.erase(it_prev);
     }
   }
+  queue_int_update_stats();
 }
 
-static void queue_int_release() { connect_queue.clear(); }
+static void queue_int_release() {
+  connect_queue.clear();
+  queue_int_update_stats();
+}
 
 /*******************************************************************************
  *
@@ -173,8 +349,10 @@ void btif_queue_cleanup(uint16_t uuid) {
  *
  * Function         btif_queue_advance
  *
- * Description      Clear the queue's busy status and advance to the next
- *                  scheduled connection.
+ * Description      Remove the oldest connection request in progress and
+ *                  advance to the next scheduled connection. Prefer
+ *                  btif_queue_advance_by_uuid which removes the request that
+ *                  completed.
  *
  * Returns          void
  *
@@ -183,6 +361,21 @@ void btif_queue_advance() {
   do_in_jni_thread(FROM_HERE, base::BindOnce(&queue_int_advance));
 }
 
+/*******************************************************************************
+ *
+ * Function         btif_queue_advance_by_uuid
+ *
+ * Description      Remove the connection request in progress for the UUID
+ *                  and device, and advance to the next scheduled connections.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btif_queue_advance_by_uuid(uint16_t uuid, const RawAddress* bda) {
+  do_in_jni_thread(FROM_HERE,
+                   base::BindOnce(&queue_int_advance_by_uuid, uuid, *bda));
+}
+
 bt_status_t btif_queue_connect_next(void) {
   // The call must be on the JNI thread, otherwise the access to connect_queue
   // is not thread-safe.
@@ -192,15 +385,38 @@ bt_status_t btif_queue_connect_next(void) {
   if (!stack_manager_get_interface()->get_stack_is_running())
     return BT_STATUS_FAIL;
 
-  ConnectNode& head = connect_queue.front();
+  size_t max_connects = queue_int_max_concurrent_connects();
+  size_t in_progress =
+      std::count_if(connect_queue.begin(), connect_queue.end(),
+                    [](const ConnectNode& node) { return node.busy(); });
+  bt_status_t b_status = BT_STATUS_SUCCESS;
+
+  auto it = connect_queue.begin();
+  while (it != connect_queue.end() && in_progress < max_connects) {
+    if (it->busy() || !queue_int_can_connect(it)) {
+      ++it;
+      continue;
+    }
+
+    LOG_INFO("Executing profile connection request:%s", it->ToString().c_str());
+    {
+      std::lock_guard<std::mutex> lock(connect_stats.mutex);
+      connect_stats.started++;
+    }
+    b_status = it->connect();
+    if (b_status == BT_STATUS_SUCCESS) {
+      in_progress++;
+      ++it;
+      continue;
+    }
 
-  LOG_INFO("Executing profile connection request:%s", head.ToString().c_str());
-  bt_status_t b_status = head.connect();
-  if (b_status != BT_STATUS_SUCCESS) {
     LOG_INFO("%s: connect %s failed, advance to next scheduled connection.",
-             __func__, head.ToString().c_str());
-    btif_queue_advance();
+             __func__, it->ToString().c_str());
+    queue_int_record(*it, false);
+    it = connect_queue.erase(it);
   }
+
+  queue_int_update_stats();
   return b_status;
 }
 
@@ -220,3 +436,46 @@ void btif_queue_release() {
     LOG(FATAL) << __func__ << ": Failed to schedule on JNI thread";
   }
 }
+
+#define DUMPSYS_TAG "shim::legacy::btif::profile_queue"
+void btif_debug_queue_dump(int fd) {
+  std::lock_guard<std::mutex> lock(connect_stats.mutex);
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  LOG_DUMPSYS(fd, "Queued:%zu in progress:%zu max in progress:%zu cap:%zu",
+              connect_stats.queued, connect_stats.in_progress,
+              connect_stats.max_in_progress,
+              queue_int_max_concurrent_connects());
+  LOG_DUMPSYS(fd, "Started:%llu completed:%llu failed:%llu",
+              (unsigned long long)connect_stats.started,
+              (unsigned long long)connect_stats.completed,
+              (unsigned long long)connect_stats.failed);
+  uint64_t requests = connect_stats.completed + connect_stats.failed;
+  LOG_DUMPSYS(fd, "Wait ms avg:%llu max:%llu",
+              (unsigned long long)(requests
+                                       ? connect_stats.total_wait_ms / requests
+                                       : 0),
+              (unsigned long long)connect_stats.max_wait_ms);
+  LOG_DUMPSYS(
+      fd, "Connect ms avg:%llu max:%llu",
+      (unsigned long long)(connect_stats.completed
+                               ? connect_stats.total_connect_ms /
+                                     connect_stats.completed
+                               : 0),
+      (unsigned long long)connect_stats.max_connect_ms);
+  for (const auto& request : connect_stats.recent) {
+    LOG_DUMPSYS(fd, "  %s", request.c_str());
+  }
+}
+#undef DUMPSYS_TAG
+
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+
+void btif_queue_set_max_concurrent_connects(size_t max_connects) {
+  max_concurrent_connects_override = max_connects;
+}
+
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
@@ -40,6 +40,7 @@
 #include "btif_config.h"
 #include "btif_hh.h"
 #include "btif_storage.h"
+#include "stack/include/bt_types.h"
 #include "stack/include/bt_uuid16.h"
 #include "stack/include/main_thread.h"
 #include "types/bluetooth/uuid.h"
@@ -62,6 +63,7 @@ using bluetooth::groups::DeviceGroups;
 #define BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN "SinkPacsBin"
 #define BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN "SourcePacsBin"
 #define BTIF_STORAGE_LEAUDIO_ASES_BIN "AsesBin"
+#define BTIF_STORAGE_LEAUDIO_SERVICES_BIN "LeAudioServicesBin"
 #define BTIF_STORAGE_LEAUDIO_SINK_AUDIOLOCATION "SinkAudioLocation"
 #define BTIF_STORAGE_LEAUDIO_SOURCE_AUDIOLOCATION "SourceAudioLocation"
 #define BTIF_STORAGE_LEAUDIO_SINK_SUPPORTED_CONTEXT_TYPE \
@@ -538,68 +540,121 @@ void btif_storage_set_leaudio_autoconnect(const RawAddress& addr,
                                   addr, autoconnect));
 }
 
-/** Store ASEs information */
-void btif_storage_leaudio_update_handles_bin(const RawAddress& addr) {
+namespace {
+
+/* Layout of BTIF_STORAGE_LEAUDIO_SERVICES_BIN: magic, followed by the
+ * handles, sink PACs, source PACs and ASEs blobs, each one prefixed with its
+ * 16 bit length. It replaces the per blob keys, which are only read when the
+ * record is missing.
+ */
+constexpr uint8_t kLeAudioServicesBinMagic = 0x01;
+
+struct LeAudioServices {
   std::vector<uint8_t> handles;
+  std::vector<uint8_t> sink_pacs;
+  std::vector<uint8_t> source_pacs;
+  std::vector<uint8_t> ases;
+};
+
+bool leaudio_serialize_services(const LeAudioServices& services,
+                                std::vector<uint8_t>& out) {
+  const std::vector<uint8_t>* blobs[] = {&services.handles,
+                                         &services.sink_pacs,
+                                         &services.source_pacs,
+                                         &services.ases};
+  size_t size = 1;
+  for (auto blob : blobs) {
+    if (blob->size() > UINT16_MAX) return false;
+    size += 2 + blob->size();
+  }
 
-  if (LeAudioClient::GetHandlesForStorage(addr, handles)) {
-    do_in_jni_thread(
-        FROM_HERE,
-        Bind(
-            [](const RawAddress& bd_addr, std::vector<uint8_t> handles) {
-              auto bdstr = bd_addr.ToString();
-              btif_config_set_bin(bdstr, BTIF_STORAGE_LEAUDIO_HANDLES_BIN,
-                                  handles.data(), handles.size());
-            },
-            addr, std::move(handles)));
+  out.resize(size);
+  auto* ptr = out.data();
+  UINT8_TO_STREAM(ptr, kLeAudioServicesBinMagic);
+  for (auto blob : blobs) {
+    UINT16_TO_STREAM(ptr, blob->size());
+    ARRAY_TO_STREAM(ptr, blob->data(), (int)blob->size());
   }
+  return true;
 }
 
-/** Store PACs information */
-void btif_storage_leaudio_update_pacs_bin(const RawAddress& addr) {
-  std::vector<uint8_t> sink_pacs;
+bool leaudio_deserialize_services(const std::vector<uint8_t>& in,
+                                  LeAudioServices& services) {
+  std::vector<uint8_t>* blobs[] = {&services.handles, &services.sink_pacs,
+                                   &services.source_pacs, &services.ases};
+  if (in.empty() || in[0] != kLeAudioServicesBinMagic) return false;
+
+  size_t offset = 1;
+  for (auto blob : blobs) {
+    if (in.size() - offset < 2) return false;
+    const uint8_t* ptr = in.data() + offset;
+    uint16_t len;
+    STREAM_TO_UINT16(len, ptr);
+    offset += 2;
+    if (in.size() - offset < len) return false;
+    blob->assign(in.begin() + offset, in.begin() + offset + len);
+    offset += len;
+  }
+  return offset == in.size();
+}
 
-  if (LeAudioClient::GetSinkPacsForStorage(addr, sink_pacs)) {
-    do_in_jni_thread(
-        FROM_HERE,
-        Bind(
-            [](const RawAddress& bd_addr, std::vector<uint8_t> sink_pacs) {
-              auto bdstr = bd_addr.ToString();
-              btif_config_set_bin(bdstr, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN,
-                                  sink_pacs.data(), sink_pacs.size());
-            },
-            addr, std::move(sink_pacs)));
+std::vector<uint8_t> leaudio_read_bin(const std::string& section,
+                                      const std::string& key) {
+  size_t buffer_size = btif_config_get_bin_length(section, key);
+  std::vector<uint8_t> buffer(buffer_size);
+  if (buffer_size > 0) {
+    btif_config_get_bin(section, key, buffer.data(), &buffer_size);
   }
+  return buffer;
+}
 
-  std::vector<uint8_t> source_pacs;
-  if (LeAudioClient::GetSourcePacsForStorage(addr, source_pacs)) {
-    do_in_jni_thread(
-        FROM_HERE,
-        Bind(
-            [](const RawAddress& bd_addr, std::vector<uint8_t> source_pacs) {
-              auto bdstr = bd_addr.ToString();
-              btif_config_set_bin(bdstr, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN,
-                                  source_pacs.data(), source_pacs.size());
-            },
-            addr, std::move(source_pacs)));
+/** Store all the services of the device in a single record */
+void btif_storage_leaudio_update_services_bin(const RawAddress& addr) {
+  LeAudioServices services;
+
+  bool has_services = false;
+  has_services |= LeAudioClient::GetHandlesForStorage(addr, services.handles);
+  has_services |=
+      LeAudioClient::GetSinkPacsForStorage(addr, services.sink_pacs);
+  has_services |=
+      LeAudioClient::GetSourcePacsForStorage(addr, services.source_pacs);
+  has_services |= LeAudioClient::GetAsesForStorage(addr, services.ases);
+
+  std::vector<uint8_t> record;
+  if (!has_services || !leaudio_serialize_services(services, record)) {
+    return;
   }
+
+  do_in_jni_thread(
+      FROM_HERE,
+      Bind(
+          [](const RawAddress& bd_addr, std::vector<uint8_t> record) {
+            auto bdstr = bd_addr.ToString();
+            btif_config_set_bin(bdstr, BTIF_STORAGE_LEAUDIO_SERVICES_BIN,
+                                record.data(), record.size());
+            btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
+            btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
+            btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
+            btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_ASES_BIN);
+          },
+          addr, std::move(record)));
+}
+
+}  // namespace
+
+/** Store handles information */
+void btif_storage_leaudio_update_handles_bin(const RawAddress& addr) {
+  btif_storage_leaudio_update_services_bin(addr);
+}
+
+/** Store PACs information */
+void btif_storage_leaudio_update_pacs_bin(const RawAddress& addr) {
+  btif_storage_leaudio_update_services_bin(addr);
 }
 
 /** Store ASEs information */
 void btif_storage_leaudio_update_ase_bin(const RawAddress& addr) {
-  std::vector<uint8_t> ases;
-
-  if (LeAudioClient::GetAsesForStorage(addr, ases)) {
-    do_in_jni_thread(
-        FROM_HERE,
-        Bind(
-            [](const RawAddress& bd_addr, std::vector<uint8_t> ases) {
-              auto bdstr = bd_addr.ToString();
-              btif_config_set_bin(bdstr, BTIF_STORAGE_LEAUDIO_ASES_BIN,
-                                  ases.data(), ases.size());
-            },
-            addr, std::move(ases)));
-  }
+  btif_storage_leaudio_update_services_bin(addr);
 }
 
 /** Store Le Audio device audio locations */
@@ -695,36 +750,18 @@ void btif_storage_load_bonded_leaudio() {
             name, BTIF_STORAGE_LEAUDIO_SOURCE_SUPPORTED_CONTEXT_TYPE, &value))
       source_supported_context_type = value;
 
-    size_t buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
-    std::vector<uint8_t> handles(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN,
-                          handles.data(), &buffer_size);
-    }
-
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
-    std::vector<uint8_t> sink_pacs(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN,
-                          sink_pacs.data(), &buffer_size);
-    }
-
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
-    std::vector<uint8_t> source_pacs(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN,
-                          source_pacs.data(), &buffer_size);
-    }
-
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_ASES_BIN);
-    std::vector<uint8_t> ases(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_ASES_BIN, ases.data(),
-                          &buffer_size);
+    LeAudioServices services;
+    if (!leaudio_deserialize_services(
+            leaudio_read_bin(name, BTIF_STORAGE_LEAUDIO_SERVICES_BIN),
+            services)) {
+      /* Stored before the services were kept in a single record */
+      services.handles =
+          leaudio_read_bin(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
+      services.sink_pacs =
+          leaudio_read_bin(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
+      services.source_pacs =
+          leaudio_read_bin(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
+      services.ases = leaudio_read_bin(name, BTIF_STORAGE_LEAUDIO_ASES_BIN);
     }
 
     do_in_main_thread(
@@ -732,15 +769,17 @@ void btif_storage_load_bonded_leaudio() {
         Bind(&LeAudioClient::AddFromStorage, bd_addr, autoconnect,
              sink_audio_location, source_audio_location,
              sink_supported_context_type, source_supported_context_type,
-             std::move(handles), std::move(sink_pacs), std::move(source_pacs),
-             std::move(ases)));
+             std::move(services.handles), std::move(services.sink_pacs),
+             std::move(services.source_pacs), std::move(services.ases)));
   }
 }
 
 void btif_storage_leaudio_clear_service_data(const RawAddress& address) {
   auto bdstr = address.ToString();
+  btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_SERVICES_BIN);
   btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
   btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
+  btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
   btif_config_remove(bdstr, BTIF_STORAGE_LEAUDIO_ASES_BIN);
 }
 
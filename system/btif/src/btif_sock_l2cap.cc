@@ -34,15 +34,13 @@
 #include "internal_include/bt_target.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
+#include "osi/include/list.h"
 #include "osi/include/osi.h"
 #include "stack/include/bt_hdr.h"
 #include "types/raw_address.h"
 
-struct packet {
-  struct packet *next, *prev;
-  uint32_t len;
-  uint8_t* data;
-};
+/* Maximum number of queued SDUs sent to the app in a single sendmmsg() */
+#define L2CAP_INCOMING_MSG_MAX 16
 
 typedef struct l2cap_socket {
   struct l2cap_socket* prev;  // link to prev list item
@@ -58,8 +56,7 @@ typedef struct l2cap_socket {
   int app_fd;                 // fd from app's side
 
   unsigned bytes_buffered;
-  struct packet* first_packet;  // fist packet to be delivered to app
-  struct packet* last_packet;   // last packet to be delivered to app
+  list_t* rx_queue;  // SDUs (BT_HDR) to be delivered to app, in order
 
   unsigned server : 1;            // is a server? (or connecting?)
   unsigned connected : 1;         // is connected?
@@ -68,6 +65,16 @@ typedef struct l2cap_socket {
   bool is_le_coc;                 // is le connection oriented channel?
   uint16_t rx_mtu;
   uint16_t tx_mtu;
+  // Channels requested, more than one when SDUs are striped over several LE
+  // CoC channels set up with one credit based connection request
+  uint8_t num_channels;
+  // Striped channels, in the order of the request; |handle| is the first one
+  int channel_handles[L2CAP_CREDIT_BASED_MAX_CIDS];
+  bool channel_open[L2CAP_CREDIT_BASED_MAX_CIDS];
+  uint8_t num_handles;
+  uint8_t tx_channel;          // index of the channel the next SDU is sent on
+  uint8_t rx_channel;          // index of the channel the next SDU comes from
+  uint8_t congested_channels;  // bit mask of the congested channel indexes
   // Cumulative number of bytes transmitted on this socket
   int64_t tx_bytes;
   // Cumulative number of bytes received on this socket
@@ -75,6 +82,7 @@ typedef struct l2cap_socket {
 } l2cap_socket;
 
 static void btsock_l2cap_server_listen(l2cap_socket* sock);
+static void btsock_l2cap_connect_l(l2cap_socket* sock);
 
 static std::mutex state_lock;
 
@@ -100,84 +108,18 @@ static void btsock_l2cap_cbk(tBTA_JV_EVT event, tBTA_JV* p_data,
  * wait
  *       confirming the l2cap_ind until we have more space in the buffer. */
 
-/* returns false if none - caller must free "data" memory when done with it */
-static char packet_get_head_l(l2cap_socket* sock, uint8_t** data,
-                              uint32_t* len) {
-  struct packet* p = sock->first_packet;
-
-  if (!p) return false;
-
-  if (data) *data = sock->first_packet->data;
-  if (len) *len = sock->first_packet->len;
-  sock->first_packet = p->next;
-  if (sock->first_packet)
-    sock->first_packet->prev = NULL;
-  else
-    sock->last_packet = NULL;
-
-  if (len) sock->bytes_buffered -= *len;
-
-  osi_free(p);
-
-  return true;
-}
-
-static struct packet* packet_alloc(const uint8_t* data, uint32_t len) {
-  struct packet* p = (struct packet*)osi_calloc(sizeof(*p));
-  uint8_t* buf = (uint8_t*)osi_malloc(len);
-
-  p->data = buf;
-  p->len = len;
-  memcpy(p->data, data, len);
-  return p;
-}
-
-/* makes a copy of the data, returns true on success */
-static char packet_put_head_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
-
-  /*
-   * We do not check size limits here since this is used to undo "getting" a
-   * packet that the user read incompletely. That is to say the packet was
-   * already in the queue. We do check thos elimits in packet_put_tail_l() since
-   * that function is used to put new data into the queue.
-   */
-
-  if (!p) return false;
-
-  p->prev = NULL;
-  p->next = sock->first_packet;
-  sock->first_packet = p;
-  if (p->next)
-    p->next->prev = p;
-  else
-    sock->last_packet = p;
-
-  sock->bytes_buffered += len;
-
-  return true;
-}
-
-/* makes a copy of the data, returns true on success */
-static char packet_put_tail_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
+/* Queues an SDU received from the stack, taking ownership of it. No data copy
+ * is made. Returns true on success, false (and frees the SDU) on overflow. */
+static bool rx_queue_put_l(l2cap_socket* sock, BT_HDR* p_buf) {
   if (sock->bytes_buffered >= L2CAP_MAX_RX_BUFFER) {
     LOG_ERROR("Unable to add to buffer due to buffer overflow socket_id:%u",
               sock->id);
+    osi_free(p_buf);
     return false;
   }
 
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
-  p->next = NULL;
-  p->prev = sock->last_packet;
-  sock->last_packet = p;
-  if (p->prev)
-    p->prev->next = p;
-  else
-    sock->first_packet = p;
-
-  sock->bytes_buffered += len;
+  list_append(sock->rx_queue, p_buf);
+  sock->bytes_buffered += p_buf->len;
 
   return true;
 }
@@ -197,7 +139,6 @@ static l2cap_socket* btsock_l2cap_find_by_id_l(uint32_t id) {
 }
 
 static void btsock_l2cap_free_l(l2cap_socket* sock) {
-  uint8_t* buf;
   l2cap_socket* t = socks;
 
   while (t && t != sock) t = t->next;
@@ -234,12 +175,15 @@ static void btsock_l2cap_free_l(l2cap_socket* sock) {
              sock->id);
   }
 
-  while (packet_get_head_l(sock, &buf, NULL)) osi_free(buf);
+  list_free(sock->rx_queue);
 
   // lower-level close() should be idempotent... so let's call it and see...
   if (sock->is_le_coc) {
     // Only call if we are non server connections
-    if (sock->handle >= 0 && (!sock->server)) {
+    if (sock->num_handles > 1) {
+      for (uint8_t i = 0; i < sock->num_handles; i++)
+        BTA_JvL2capClose(sock->channel_handles[i]);
+    } else if (sock->handle >= 0 && (!sock->server)) {
       BTA_JvL2capClose(sock->handle);
     }
     if ((sock->channel >= 0) && (sock->server)) {
@@ -297,12 +241,12 @@ static l2cap_socket* btsock_l2cap_alloc_l(const char* name,
   sock->handle = 0;
   sock->server_psm_sent = false;
   sock->app_uid = -1;
+  sock->num_channels = 1;
 
   if (name) strncpy(sock->name, name, sizeof(sock->name) - 1);
   if (addr) sock->addr = *addr;
 
-  sock->first_packet = NULL;
-  sock->last_packet = NULL;
+  sock->rx_queue = list_new(osi_free);
 
   sock->tx_mtu = L2CAP_LE_MIN_MTU;
 
@@ -446,14 +390,38 @@ static void on_cl_l2cap_init(tBTA_JV_L2CAP_CL_INIT* p_init, uint32_t id) {
   }
 
   if (p_init->status != BTA_JV_SUCCESS) {
+    if (sock->num_channels > 1 && sock->num_handles == 0) {
+      /* The credit based request needs the LE link to be up already */
+      LOG_WARN("Unable to set up %u channels, falling back to one socket_id:%u",
+               sock->num_channels, id);
+      sock->num_channels = 1;
+      btsock_l2cap_connect_l(sock);
+      return;
+    }
     LOG_ERROR("Initialization status failed socket_id:%u", id);
     btsock_l2cap_free_l(sock);
     return;
   }
 
+  if (sock->num_channels > 1) {
+    sock->channel_handles[sock->num_handles] = p_init->handle;
+    sock->channel_open[sock->num_handles] = false;
+    sock->num_handles++;
+    sock->handle = sock->channel_handles[0];
+    return;
+  }
+
   sock->handle = p_init->handle;
 }
 
+/* Index of |handle| in the striped channels of |sock|, -1 if not found */
+static int find_channel_index_l(l2cap_socket* sock, uint32_t handle) {
+  for (uint8_t i = 0; i < sock->num_handles; i++) {
+    if (sock->channel_handles[i] == (int)handle) return i;
+  }
+  return -1;
+}
+
 /**
  * Here we allocate a new sock instance to mimic the BluetoothSocket. The socket
  * will be a clone of the sock representing the BluetoothServerSocket.
@@ -543,6 +511,48 @@ static void on_cl_l2cap_psm_connect_l(tBTA_JV_L2CAP_OPEN* p_open,
   sock->connected = true;
 }
 
+/* A striped socket is reported connected once all its channels are set up,
+ * with the smallest MTU of the channels. The channels the peer refused are
+ * left out of the striping. */
+static void on_cl_l2cap_stripe_update_l(l2cap_socket* sock) {
+  if (sock->num_handles == 0) {
+    LOG_ERROR("No channel could be opened socket_id:%u", sock->id);
+    btsock_l2cap_free_l(sock);
+    return;
+  }
+  sock->handle = sock->channel_handles[0];
+
+  for (uint8_t i = 0; i < sock->num_handles; i++) {
+    if (!sock->channel_open[i]) return;
+  }
+
+  LOG_INFO("Striping l2cap socket socket_id:%u over %u channels", sock->id,
+           sock->num_handles);
+  tBTA_JV_L2CAP_OPEN open = {
+      .status = BTA_JV_SUCCESS,
+      .handle = (uint32_t)sock->channel_handles[0],
+      .rem_bda = sock->addr,
+      .tx_mtu = sock->tx_mtu,
+  };
+  on_cl_l2cap_psm_connect_l(&open, sock);
+}
+
+static void on_cl_l2cap_stripe_connect_l(tBTA_JV_L2CAP_OPEN* p_open,
+                                         l2cap_socket* sock) {
+  int index = find_channel_index_l(sock, p_open->handle);
+  if (index < 0 || sock->connected) return;
+
+  bool first_open = true;
+  for (uint8_t i = 0; i < sock->num_handles; i++) {
+    if (sock->channel_open[i]) first_open = false;
+  }
+  if (first_open || p_open->tx_mtu < sock->tx_mtu)
+    sock->tx_mtu = p_open->tx_mtu;
+
+  sock->channel_open[index] = true;
+  on_cl_l2cap_stripe_update_l(sock);
+}
+
 static void on_l2cap_connect(tBTA_JV* p_data, uint32_t id) {
   l2cap_socket* sock;
   tBTA_JV_L2CAP_OPEN* psm_open = &p_data->l2c_open;
@@ -555,6 +565,11 @@ static void on_l2cap_connect(tBTA_JV* p_data, uint32_t id) {
     return;
   }
 
+  if (sock->num_handles > 1 && psm_open->status == BTA_JV_SUCCESS) {
+    on_cl_l2cap_stripe_connect_l(psm_open, sock);
+    return;
+  }
+
   sock->tx_mtu = le_open->tx_mtu;
   if (psm_open->status == BTA_JV_SUCCESS) {
     if (!sock->server) {
@@ -581,6 +596,20 @@ static void on_l2cap_close(tBTA_JV_L2CAP_CLOSE* p_close, uint32_t id) {
     return;
   }
 
+  int index = find_channel_index_l(sock, p_close->handle);
+  if (index >= 0 && !sock->connected) {
+    /* One of the striped channels could not be set up, go on without it */
+    LOG_WARN("Channel %d of l2cap socket socket_id:%u closed while set up",
+             index, sock->id);
+    for (uint8_t i = index; i + 1 < sock->num_handles; i++) {
+      sock->channel_handles[i] = sock->channel_handles[i + 1];
+      sock->channel_open[i] = sock->channel_open[i + 1];
+    }
+    sock->num_handles--;
+    on_cl_l2cap_stripe_update_l(sock);
+    return;
+  }
+
   btif_sock_connection_logger(
       SOCKET_CONNECTION_STATE_DISCONNECTING,
       sock->server ? SOCKET_ROLE_LISTEN : SOCKET_ROLE_CONNECTION, sock->addr,
@@ -615,7 +644,16 @@ static void on_l2cap_outgoing_congest(tBTA_JV_L2CAP_CONG* p, uint32_t id) {
     return;
   }
 
-  sock->outgoing_congest = p->cong ? 1 : 0;
+  int index = find_channel_index_l(sock, p->handle);
+  if (index >= 0) {
+    if (p->cong)
+      sock->congested_channels |= 1 << index;
+    else
+      sock->congested_channels &= ~(1 << index);
+    sock->outgoing_congest = sock->congested_channels != 0;
+  } else {
+    sock->outgoing_congest = p->cong ? 1 : 0;
+  }
 
   if (!sock->outgoing_congest) {
     LOG_VERBOSE("Monitoring l2cap socket for outgoing data socket_id:%u",
@@ -645,6 +683,18 @@ static void on_l2cap_write_done(uint16_t len, uint32_t id) {
   uid_set_add_tx(uid_set, app_uid, len);
 }
 
+static int rx_handle_l(l2cap_socket* sock) {
+  if (sock->num_handles > 1) return sock->channel_handles[sock->rx_channel];
+  return sock->handle;
+}
+
+static int tx_handle_l(l2cap_socket* sock) {
+  if (sock->num_handles <= 1) return sock->handle;
+  int handle = sock->channel_handles[sock->tx_channel];
+  sock->tx_channel = (sock->tx_channel + 1) % sock->num_handles;
+  return handle;
+}
+
 static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
   l2cap_socket* sock;
 
@@ -660,26 +710,28 @@ static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
 
   app_uid = sock->app_uid;
 
-  uint32_t count;
-
-  if (BTA_JvL2capReady(sock->handle, &count) == BTA_JV_SUCCESS) {
-    std::vector<uint8_t> buffer(count);
-    if (BTA_JvL2capRead(sock->handle, sock->id, buffer.data(), count) ==
-        BTA_JV_SUCCESS) {
-      if (packet_put_tail_l(sock, buffer.data(), count)) {
-        bytes_read = count;
-        btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_WR,
-                             sock->id);
-      } else {  // connection must be dropped
-        LOG_WARN("Closing socket as unable to push data to socket socket_id:%u",
-                 sock->id);
-        BTA_JvL2capClose(sock->handle);
-        btsock_l2cap_free_l(sock);
-        return;
-      }
+  /* Take over the received SDUs as they are, each one is delivered to the app
+   * as its own message. */
+  BT_HDR* p_buf;
+  while (BTA_JvL2capReadBuf(rx_handle_l(sock), &p_buf) == BTA_JV_SUCCESS) {
+    /* The peer stripes the SDUs round robin, read them back in that order */
+    if (sock->num_handles > 1)
+      sock->rx_channel = (sock->rx_channel + 1) % sock->num_handles;
+    uint16_t len = p_buf->len;
+    if (!rx_queue_put_l(sock, p_buf)) {  // connection must be dropped
+      LOG_WARN("Closing socket as unable to push data to socket socket_id:%u",
+               sock->id);
+      BTA_JvL2capClose(sock->handle);
+      btsock_l2cap_free_l(sock);
+      return;
     }
+    bytes_read += len;
   }
 
+  if (bytes_read)
+    btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_WR,
+                         sock->id);
+
   sock->rx_bytes += bytes_read;
   uid_set_add_rx(uid_set, app_uid, bytes_read);
 }
@@ -777,6 +829,31 @@ static void btsock_l2cap_server_listen(l2cap_socket* sock) {
                          std::move(cfg), btsock_l2cap_cbk, sock->id);
 }
 
+static void btsock_l2cap_connect_l(l2cap_socket* sock) {
+  if (sock->num_channels > 1) {
+    BTA_JvL2capConnectCreditBased(sock->security, sock->channel, sock->rx_mtu,
+                                  sock->num_channels, sock->addr,
+                                  btsock_l2cap_cbk, sock->id);
+    return;
+  }
+
+  int connection_type =
+      sock->is_le_coc ? BTA_JV_CONN_TYPE_L2CAP_LE : BTA_JV_CONN_TYPE_L2CAP;
+
+  /* Setup ETM settings: mtu will be set below */
+  std::unique_ptr<tL2CAP_CFG_INFO> cfg = std::make_unique<tL2CAP_CFG_INFO>(
+      tL2CAP_CFG_INFO{.fcr_present = true, .fcr = kDefaultErtmOptions});
+
+  std::unique_ptr<tL2CAP_ERTM_INFO> ertm_info;
+  if (!sock->is_le_coc) {
+    ertm_info.reset(new tL2CAP_ERTM_INFO(obex_l2c_etm_opt));
+  }
+
+  BTA_JvL2capConnect(connection_type, sock->security, 0, std::move(ertm_info),
+                     sock->channel, sock->rx_mtu, std::move(cfg), sock->addr,
+                     btsock_l2cap_cbk, sock->id);
+}
+
 static bt_status_t btsock_l2cap_listen_or_connect(const char* name,
                                                   const RawAddress* addr,
                                                   int channel, int* sock_fd,
@@ -804,25 +881,19 @@ static bt_status_t btsock_l2cap_listen_or_connect(const char* name,
   sock->is_le_coc = is_le_coc;
   sock->rx_mtu = is_le_coc ? L2CAP_SDU_LENGTH_LE_MAX : L2CAP_SDU_LENGTH_MAX;
 
+  if (is_le_coc && !listen) {
+    int num_channels = (flags & BTSOCK_FLAG_LE_COC_CHANNELS_MASK) >>
+                       BTSOCK_FLAG_LE_COC_CHANNELS_SHIFT;
+    if (num_channels > 1)
+      sock->num_channels =
+          std::min(num_channels, (int)L2CAP_CREDIT_BASED_MAX_CIDS);
+  }
+
   /* "role" is never initialized in rfcomm code */
   if (listen) {
     btsock_l2cap_server_listen(sock);
   } else {
-      int connection_type =
-          sock->is_le_coc ? BTA_JV_CONN_TYPE_L2CAP_LE : BTA_JV_CONN_TYPE_L2CAP;
-
-      /* Setup ETM settings: mtu will be set below */
-      std::unique_ptr<tL2CAP_CFG_INFO> cfg = std::make_unique<tL2CAP_CFG_INFO>(
-          tL2CAP_CFG_INFO{.fcr_present = true, .fcr = kDefaultErtmOptions});
-
-      std::unique_ptr<tL2CAP_ERTM_INFO> ertm_info;
-      if (!sock->is_le_coc) {
-        ertm_info.reset(new tL2CAP_ERTM_INFO(obex_l2c_etm_opt));
-      }
-
-      BTA_JvL2capConnect(
-          connection_type, sock->security, 0, std::move(ertm_info), channel,
-          sock->rx_mtu, std::move(cfg), sock->addr, btsock_l2cap_cbk, sock->id);
+    btsock_l2cap_connect_l(sock);
   }
 
   *sock_fd = sock->app_fd;
@@ -855,26 +926,44 @@ bt_status_t btsock_l2cap_connect(const RawAddress* bd_addr, int channel,
  * (for example: unrecoverable error or no data)
  */
 static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
-  uint8_t* buf;
-  uint32_t len;
-
-  while (packet_get_head_l(sock, &buf, &len)) {
-    ssize_t sent;
-    OSI_NO_INTR(sent = send(sock->our_fd, buf, len, MSG_DONTWAIT));
-    int saved_errno = errno;
-
-    if (sent == (signed)len)
-      osi_free(buf);
-    else if (sent >= 0) {
-      packet_put_head_l(sock, buf + sent, len - sent);
-      osi_free(buf);
-      if (!sent) /* special case if other end not keeping up */
-        return true;
-    } else {
-      packet_put_head_l(sock, buf, len);
-      osi_free(buf);
-      return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
+  while (!list_is_empty(sock->rx_queue)) {
+    struct mmsghdr msgs[L2CAP_INCOMING_MSG_MAX] = {};
+    struct iovec iov[L2CAP_INCOMING_MSG_MAX];
+    unsigned int msg_count = 0;
+    for (const list_node_t* node = list_begin(sock->rx_queue);
+         node != list_end(sock->rx_queue) && msg_count < L2CAP_INCOMING_MSG_MAX;
+         node = list_next(node)) {
+      BT_HDR* p_buf = (BT_HDR*)list_node(node);
+      iov[msg_count].iov_base = p_buf->data + p_buf->offset;
+      iov[msg_count].iov_len = p_buf->len;
+      msgs[msg_count].msg_hdr.msg_iov = &iov[msg_count];
+      msgs[msg_count].msg_hdr.msg_iovlen = 1;
+      msg_count++;
     }
+
+    int sent;
+    OSI_NO_INTR(sent = sendmmsg(sock->our_fd, msgs, msg_count, MSG_DONTWAIT));
+    if (sent < 0) return errno == EWOULDBLOCK || errno == EAGAIN;
+
+    for (int i = 0; i < sent; i++) {
+      BT_HDR* p_buf = (BT_HDR*)list_front(sock->rx_queue);
+      unsigned int len = msgs[i].msg_len;
+      if (len < p_buf->len) {
+        /* Only a stream socket can take part of a message; keep the rest
+         * queued. */
+        p_buf->offset += len;
+        p_buf->len -= len;
+        sock->bytes_buffered -= len;
+        if (!len) /* special case if other end not keeping up */
+          return true;
+        break;
+      }
+      sock->bytes_buffered -= p_buf->len;
+      list_remove(sock->rx_queue, p_buf);
+    }
+
+    /* The app did not take all the messages, wait for it to be ready */
+    if ((unsigned int)sent < msg_count) return true;
   }
 
   return false;
@@ -936,7 +1025,8 @@ void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id) {
         buffer->len = count;
 
         // will take care of freeing buffer
-        BTA_JvL2capWrite(sock->handle, PTR_TO_UINT(buffer), buffer, user_id);
+        BTA_JvL2capWrite(tx_handle_l(sock), PTR_TO_UINT(buffer), buffer,
+                         user_id);
       }
     } else
       drop_it = true;
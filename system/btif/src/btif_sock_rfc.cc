@@ -854,6 +854,9 @@ typedef enum {
   SENT_ALL,
 } sent_status_t;
 
+/* Maximum number of queued incoming buffers sent to the app at once */
+#define RFC_INCOMING_IOV_MAX 16
+
 static sent_status_t send_data_to_app(int fd, BT_HDR* p_buf) {
   if (p_buf->len == 0) return SENT_ALL;
 
@@ -877,25 +880,72 @@ static sent_status_t send_data_to_app(int fd, BT_HDR* p_buf) {
   return SENT_PARTIAL;
 }
 
-static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
+/* Send the queued incoming buffers to the app, as many at once as the app
+ * socket accepts.
+ * Returns          SENT_ALL if the queue was emptied. */
+static sent_status_t send_queued_data_to_app(rfc_slot_t* slot) {
   while (!list_is_empty(slot->incoming_queue)) {
-    BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
-    switch (send_data_to_app(slot->fd, p_buf)) {
-      case SENT_NONE:
-      case SENT_PARTIAL:
-        // monitor the fd to get callback when app is ready to receive data
-        btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR,
-                             slot->id);
-        return true;
+    struct iovec iov[RFC_INCOMING_IOV_MAX];
+    size_t iov_count = 0;
+    size_t total_len = 0;
+    for (const list_node_t* node = list_begin(slot->incoming_queue);
+         node != list_end(slot->incoming_queue) &&
+         iov_count < RFC_INCOMING_IOV_MAX;
+         node = list_next(node)) {
+      BT_HDR* p_buf = (BT_HDR*)list_node(node);
+      iov[iov_count].iov_base = p_buf->data + p_buf->offset;
+      iov[iov_count].iov_len = p_buf->len;
+      total_len += p_buf->len;
+      iov_count++;
+    }
 
-      case SENT_ALL:
-        list_remove(slot->incoming_queue, p_buf);
-        break;
+    ssize_t sent = 0;
+    if (total_len != 0) {
+      struct msghdr msg = {};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iov_count;
+      OSI_NO_INTR(sent = sendmsg(slot->fd, &msg, MSG_DONTWAIT));
+
+      if (sent == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return SENT_NONE;
+        LOG_ERROR("%s error writing RFCOMM data back to app: %s", __func__,
+                  strerror(errno));
+        return SENT_FAILED;
+      }
 
-      case SENT_FAILED:
-        list_remove(slot->incoming_queue, p_buf);
-        return false;
+      if (sent == 0) return SENT_FAILED;
     }
+
+    // free the buffers sent, and skip the data sent of the last one
+    for (size_t i = 0; i < iov_count; i++) {
+      BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
+      if ((size_t)sent < p_buf->len) {
+        p_buf->offset += sent;
+        p_buf->len -= sent;
+        return SENT_PARTIAL;
+      }
+      sent -= p_buf->len;
+      list_remove(slot->incoming_queue, p_buf);
+    }
+  }
+  return SENT_ALL;
+}
+
+static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
+  switch (send_queued_data_to_app(slot)) {
+    case SENT_NONE:
+    case SENT_PARTIAL:
+      // monitor the fd to get callback when app is ready to receive data
+      btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR,
+                           slot->id);
+      return true;
+
+    case SENT_ALL:
+      break;
+
+    case SENT_FAILED:
+      list_remove(slot->incoming_queue, list_front(slot->incoming_queue));
+      return false;
   }
 
   // app is ready to receive data, tell stack to start the data flow
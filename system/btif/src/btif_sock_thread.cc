@@ -20,7 +20,7 @@
  *
  *  Filename:      btif_sock_thread.cc
  *
- *  Description:   socket select thread
+ *  Description:   socket epoll thread
  *
  ******************************************************************************/
 
@@ -31,12 +31,11 @@
 #include <alloca.h>
 #include <fcntl.h>
 #include <features.h>
-#include <poll.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -46,6 +45,7 @@
 #include <array>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 
 #include "os/log.h"
 #include "osi/include/osi.h"  // OSI_NO_INTR
@@ -58,11 +58,11 @@
   } while (0)
 
 #define MAX_THREAD 8
-#define MAX_POLL 64
-#define POLL_EXCEPTION_EVENTS (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)
+#define MAX_EVENTS 64 /* events handled per epoll_wait, not a limit of fds */
+#define POLL_EXCEPTION_EVENTS (EPOLLHUP | EPOLLRDHUP | EPOLLERR)
 #define IS_EXCEPTION(e) ((e)&POLL_EXCEPTION_EVENTS)
-#define IS_READ(e) ((e)&POLLIN)
-#define IS_WRITE(e) ((e)&POLLOUT)
+#define IS_READ(e) ((e)&EPOLLIN)
+#define IS_WRITE(e) ((e)&EPOLLOUT)
 /*cmd executes in socket poll thread */
 #define CMD_WAKEUP 1
 #define CMD_EXIT 2
@@ -70,17 +70,18 @@
 #define CMD_REMOVE_FD 4
 #define CMD_USER_PRIVATE 5
 
+/* The data fds are registered one-shot: once signaled, an fd is disarmed
+ * until it is added again, or re-armed for its monitored flags left */
 struct poll_slot_t {
-  struct pollfd pfd;
   uint32_t user_id;
   int type;
   int flags;
+  bool registered;  // whether the fd is in the epoll interest list
 };
 struct thread_slot_t {
   int cmd_fdr, cmd_fdw;
-  int poll_count;
-  poll_slot_t ps[MAX_POLL];
-  int psi[MAX_POLL];  // index of poll slot
+  int epoll_fd;
+  std::unordered_map<int, poll_slot_t> ps;  // poll slots by fd
   std::optional<pthread_t> thread_id;
   btsock_signaled_cb callback;
   btsock_cmd_cb cmd_callback;
@@ -149,9 +150,9 @@ void btsock_thread_init() {
     int h;
     for (h = 0; h < MAX_THREAD; h++) {
       ts[h].cmd_fdr = ts[h].cmd_fdw = -1;
+      ts[h].epoll_fd = -1;
       ts[h].used = 0;
       ts[h].thread_id = std::nullopt;
-      ts[h].poll_count = 0;
       ts[h].callback = NULL;
       ts[h].cmd_callback = NULL;
     }
@@ -178,17 +179,33 @@ int btsock_thread_create(btsock_signaled_cb callback,
   return h;
 }
 
-/* create dummy socket pair used to wake up select loop */
+/* create dummy socket pair used to wake up epoll loop */
 static inline void init_cmd_fd(int h) {
   asrt(ts[h].cmd_fdr == -1 && ts[h].cmd_fdw == -1);
+  asrt(ts[h].epoll_fd == -1);
+  ts[h].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (ts[h].epoll_fd == -1) {
+    LOG_ERROR("epoll_create1 failed: %s", strerror(errno));
+    return;
+  }
   if (socketpair(AF_UNIX, SOCK_STREAM, 0, &ts[h].cmd_fdr) < 0) {
     LOG_ERROR("socketpair failed: %s", strerror(errno));
     return;
   }
-  // add the cmd fd for read & write
-  add_poll(h, ts[h].cmd_fdr, 0, SOCK_THREAD_FD_RD, 0);
+  // the cmd fd is always armed for read, it is not a poll slot
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = ts[h].cmd_fdr;
+  if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, ts[h].cmd_fdr, &event) == -1) {
+    LOG_ERROR("epoll_ctl cmd fd failed: %s", strerror(errno));
+  }
 }
 static inline void close_cmd_fd(int h) {
+  if (ts[h].epoll_fd != -1) {
+    close(ts[h].epoll_fd);
+    ts[h].epoll_fd = -1;
+  }
+  ts[h].ps.clear();
   if (ts[h].cmd_fdr != -1) {
     close(ts[h].cmd_fdr);
     ts[h].cmd_fdr = -1;
@@ -323,72 +340,70 @@ int btsock_thread_exit(int h) {
   return false;
 }
 static void init_poll(int h) {
-  int i;
-  ts[h].poll_count = 0;
+  ts[h].ps.clear();
   ts[h].thread_id = std::nullopt;
   ts[h].callback = NULL;
   ts[h].cmd_callback = NULL;
-  for (i = 0; i < MAX_POLL; i++) {
-    ts[h].ps[i].pfd.fd = -1;
-    ts[h].psi[i] = -1;
-  }
   init_cmd_fd(h);
 }
 static inline unsigned int flags2pevents(int flags) {
-  unsigned int pevents = 0;
-  if (flags & SOCK_THREAD_FD_WR) pevents |= POLLOUT;
-  if (flags & SOCK_THREAD_FD_RD) pevents |= POLLIN;
+  unsigned int pevents = EPOLLONESHOT;
+  if (flags & SOCK_THREAD_FD_WR) pevents |= EPOLLOUT;
+  if (flags & SOCK_THREAD_FD_RD) pevents |= EPOLLIN;
   pevents |= POLL_EXCEPTION_EVENTS;
   return pevents;
 }
 
-static inline void set_poll(poll_slot_t* ps, int fd, int type, int flags,
+/* (re-)arm the fd of a poll slot for its monitored flags */
+static void arm_poll(int h, int fd, poll_slot_t* ps) {
+  struct epoll_event event = {};
+  event.events = flags2pevents(ps->flags);
+  event.data.fd = fd;
+
+  int op = ps->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  int ret = epoll_ctl(ts[h].epoll_fd, op, fd, &event);
+  // the fd may have been closed, and its number reused, behind our back
+  if (ret == -1 && errno == ENOENT) {
+    ret = epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, fd, &event);
+  } else if (ret == -1 && errno == EEXIST) {
+    ret = epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_MOD, fd, &event);
+  }
+  if (ret == -1) {
+    LOG_ERROR("epoll_ctl fd:%d failed: %s", fd, strerror(errno));
+  }
+  ps->registered = ret != -1;
+}
+
+static inline void set_poll(poll_slot_t* ps, int type, int flags,
                             uint32_t user_id) {
-  ps->pfd.fd = fd;
   ps->user_id = user_id;
   if (ps->type != 0 && ps->type != type)
     LOG_ERROR("poll socket type should not changed! type was:%d, type now:%d",
               ps->type, type);
   ps->type = type;
   ps->flags = flags;
-  ps->pfd.events = flags2pevents(flags);
-  ps->pfd.revents = 0;
 }
 static inline void add_poll(int h, int fd, int type, int flags,
                             uint32_t user_id) {
   asrt(fd != -1);
-  int i;
-  int empty = -1;
-  poll_slot_t* ps = ts[h].ps;
-
-  for (i = 0; i < MAX_POLL; i++) {
-    if (ps[i].pfd.fd == fd) {
-      asrt(ts[h].poll_count < MAX_POLL);
+  // a new slot is zeroed: nothing monitored and not registered
+  poll_slot_t* ps = &ts[h].ps[fd];
 
-      set_poll(&ps[i], fd, type, flags | ps[i].flags, user_id);
-      return;
-    } else if (empty < 0 && ps[i].pfd.fd == -1)
-      empty = i;
-  }
-  if (empty >= 0) {
-    asrt(ts[h].poll_count < MAX_POLL);
-    set_poll(&ps[empty], fd, type, flags, user_id);
-    ++ts[h].poll_count;
-    return;
-  }
-  LOG_ERROR("exceeded max poll slot:%d!", MAX_POLL);
+  set_poll(ps, type, flags | ps->flags, user_id);
+  arm_poll(h, fd, ps);
 }
-static inline void remove_poll(int h, poll_slot_t* ps, int flags) {
+static inline void remove_poll(int h, int fd, poll_slot_t* ps, int flags) {
   if (flags == ps->flags) {
-    // all monitored events signaled. To remove it, just clear the slot
-    --ts[h].poll_count;
+    // all monitored events signaled. To remove it, just clear the slot; the
+    // one-shot fd stays disarmed until it is added again
+    bool registered = ps->registered;
     memset(ps, 0, sizeof(*ps));
-    ps->pfd.fd = -1;
+    ps->registered = registered;
   } else {
     // one read or one write monitor event signaled, removed the accordding bit
     ps->flags &= ~flags;
-    // update the poll events mask
-    ps->pfd.events = flags2pevents(ps->flags);
+    // re-arm the fd for the events left
+    arm_poll(h, fd, ps);
   }
 }
 static int process_cmd_sock(int h) {
@@ -406,16 +421,17 @@ static int process_cmd_sock(int h) {
     case CMD_ADD_FD:
       add_poll(h, cmd.fd, cmd.type, cmd.flags, cmd.user_id);
       break;
-    case CMD_REMOVE_FD:
-      for (int i = 1; i < MAX_POLL; ++i) {
-        poll_slot_t* poll_slot = &ts[h].ps[i];
-        if (poll_slot->pfd.fd == cmd.fd) {
-          remove_poll(h, poll_slot, poll_slot->flags);
-          break;
+    case CMD_REMOVE_FD: {
+      auto poll_slot = ts[h].ps.find(cmd.fd);
+      if (poll_slot != ts[h].ps.end()) {
+        if (poll_slot->second.registered) {
+          epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, cmd.fd, nullptr);
         }
+        ts[h].ps.erase(poll_slot);
       }
       close(cmd.fd);
       break;
+    }
     case CMD_WAKEUP:
       break;
     case CMD_USER_PRIVATE:
@@ -432,94 +448,69 @@ static int process_cmd_sock(int h) {
   return true;
 }
 
-static void process_data_sock(int h, struct pollfd* pfds, int pfds_count,
+static void process_data_sock(int h, struct epoll_event* events,
                               int event_count) {
-  asrt(event_count <= pfds_count);
   int i;
-  for (i = 1; i < pfds_count; i++) {
-    if (pfds[i].revents) {
-      int ps_i = ts[h].psi[i];
-      if (ts[h].ps[ps_i].pfd.fd == -1) {
-        LOG_INFO("Socket has been removed from poll set");
-        continue;
-      }
-      asrt(pfds[i].fd == ts[h].ps[ps_i].pfd.fd);
-      uint32_t user_id = ts[h].ps[ps_i].user_id;
-      int type = ts[h].ps[ps_i].type;
-      int flags = 0;
-      if (IS_READ(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_RD;
-      }
-      if (IS_WRITE(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_WR;
-      }
-      if (IS_EXCEPTION(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_EXCEPTION;
-        // remove the whole slot not flags
-        remove_poll(h, &ts[h].ps[ps_i], ts[h].ps[ps_i].flags);
-      } else if (flags)
-        remove_poll(h, &ts[h].ps[ps_i],
-                    flags);  // remove the monitor flags that already processed
-      if (flags) ts[h].callback(pfds[i].fd, type, flags, user_id);
+  for (i = 0; i < event_count; i++) {
+    int fd = events[i].data.fd;
+    uint32_t revents = events[i].events;
+    if (fd == ts[h].cmd_fdr) continue;
+
+    auto poll_slot = ts[h].ps.find(fd);
+    if (poll_slot == ts[h].ps.end() || poll_slot->second.flags == 0) {
+      LOG_INFO("Socket has been removed from poll set");
+      continue;
     }
-  }
-}
-
-static void prepare_poll_fds(int h, struct pollfd* pfds) {
-  int count = 0;
-  int ps_i = 0;
-  int pfd_i = 0;
-  asrt(ts[h].poll_count <= MAX_POLL);
-  while (count < ts[h].poll_count) {
-    if (ps_i >= MAX_POLL) {
-      LOG_ERROR(
-          "exceed max poll range, ps_i:%d, MAX_POLL:%d, count:%d, "
-          "ts[h].poll_count:%d",
-          ps_i, MAX_POLL, count, ts[h].poll_count);
-      return;
+    poll_slot_t* ps = &poll_slot->second;
+    uint32_t user_id = ps->user_id;
+    int type = ps->type;
+    int flags = 0;
+    if (IS_READ(revents)) {
+      flags |= SOCK_THREAD_FD_RD;
     }
-    if (ts[h].ps[ps_i].pfd.fd >= 0) {
-      pfds[pfd_i] = ts[h].ps[ps_i].pfd;
-      ts[h].psi[pfd_i] = ps_i;
-      count++;
-      pfd_i++;
+    if (IS_WRITE(revents)) {
+      flags |= SOCK_THREAD_FD_WR;
     }
-    ps_i++;
+    if (IS_EXCEPTION(revents)) {
+      flags |= SOCK_THREAD_FD_EXCEPTION;
+      // remove the whole slot not flags
+      remove_poll(h, fd, ps, ps->flags);
+    } else if (flags)
+      remove_poll(h, fd, ps,
+                  flags);  // remove the monitor flags that already processed
+    else
+      arm_poll(h, fd, ps);  // nothing monitored was signaled, re-arm the fd
+    // the callback may add fds: the poll slot must not be used past this point
+    if (flags) ts[h].callback(fd, type, flags, user_id);
   }
 }
+
 static void* sock_poll_thread(void* arg) {
-  std::array<struct pollfd, MAX_POLL> pfds;
+  std::array<struct epoll_event, MAX_EVENTS> events;
 
   int h = (intptr_t)arg;
   for (;;) {
-    pfds = {};
-    prepare_poll_fds(h, pfds.data());
     int ret;
-    OSI_NO_INTR(ret = poll(pfds.data(), ts[h].poll_count, -1));
+    OSI_NO_INTR(ret = epoll_wait(ts[h].epoll_fd, events.data(), events.size(),
+                                 -1));
     if (ret == -1) {
-      LOG_ERROR("poll ret -1, exit the thread, errno:%d, err:%s", errno,
+      LOG_ERROR("epoll_wait ret -1, exit the thread, errno:%d, err:%s", errno,
                 strerror(errno));
       break;
     }
     if (ret != 0) {
-      int need_process_data_fd = true;
-      int pfds_count = ts[h].poll_count;
-      if (pfds[0].revents)  // cmd fd always is the first one
-      {
-        asrt(pfds[0].fd == ts[h].cmd_fdr);
-        if (!process_cmd_sock(h)) {
-          LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
-          break;
-        }
-        if (ret == 1)
-          need_process_data_fd = false;
-        else
-          ret--;  // exclude the cmd fd
+      // process the cmd first, as it may remove some of the fds signaled
+      bool cmd_signaled = false;
+      for (int i = 0; i < ret; i++) {
+        if (events[i].data.fd == ts[h].cmd_fdr) cmd_signaled = true;
+      }
+      if (cmd_signaled && !process_cmd_sock(h)) {
+        LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
+        break;
       }
-      if (need_process_data_fd)
-        process_data_sock(h, pfds.data(), pfds_count, ret);
+      process_data_sock(h, events.data(), ret);
     } else {
-      LOG_INFO("no data, select ret: %d", ret);
+      LOG_INFO("no data, epoll_wait ret: %d", ret);
     };
   }
   LOG_INFO("socket poll thread exiting, h:%d", h);
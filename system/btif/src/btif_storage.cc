@@ -38,6 +38,8 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -469,11 +471,10 @@ bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr) {
  *
  ******************************************************************************/
 static bt_status_t btif_in_fetch_bonded_devices(
-    btif_bonded_devices_t* p_bonded_devices, int add) {
+    btif_bonded_devices_t* p_bonded_devices) {
   memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
 
   bool bt_linkkey_file_found = false;
-  int device_type;
 
   for (const auto& bd_addr : btif_config_get_paired_devices()) {
     auto name = bd_addr.ToString();
@@ -486,22 +487,6 @@ static bt_status_t btif_in_fetch_bonded_devices(
       int linkkey_type;
       if (btif_config_get_int(name, BTIF_STORAGE_KEY_LINK_KEY_TYPE,
                               &linkkey_type)) {
-        if (add) {
-          DEV_CLASS dev_class = {0, 0, 0};
-          int cod;
-          int pin_length = 0;
-          if (btif_config_get_int(name, BTIF_STORAGE_KEY_DEV_CLASS, &cod))
-            uint2devclass((uint32_t)cod, dev_class);
-          btif_config_get_int(name, BTIF_STORAGE_KEY_PIN_LENGTH, &pin_length);
-          BTA_DmAddDevice(bd_addr, dev_class, link_key, (uint8_t)linkkey_type,
-                          pin_length);
-
-          if (btif_config_get_int(name, BTIF_STORAGE_KEY_DEV_TYPE,
-                                  &device_type) &&
-              (device_type == BT_DEVICE_TYPE_DUMO)) {
-            btif_gatts_add_bonded_dev_from_nv(bd_addr);
-          }
-        }
         bt_linkkey_file_found = true;
         if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
           p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
@@ -512,7 +497,7 @@ static bt_status_t btif_in_fetch_bonded_devices(
         bt_linkkey_file_found = false;
       }
     }
-    if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) &&
+    if (!btif_in_fetch_bonded_ble_device(name, false, p_bonded_devices) &&
         !bt_linkkey_file_found) {
       LOG_VERBOSE("No link key or ble key found for device:%s",
                   ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
@@ -548,6 +533,157 @@ static void btif_read_le_key(const uint8_t key_type, const size_t key_len,
   }
 }
 
+/* A bonded device, with all its keys decoded from its config section */
+typedef struct {
+  RawAddress bd_addr;
+  bool link_key_found;
+  LinkKey link_key;
+  int link_key_type;
+  int cod;
+  int pin_length;
+  bool device_type_found;
+  int device_type;
+  bool le_device; /* the LE keys are added to BTM */
+  tBLE_ADDR_TYPE addr_type;
+  bool le_key_found[std::size(BTIF_STORAGE_LE_KEYS)];
+  tBTA_LE_KEY_VALUE le_keys[std::size(BTIF_STORAGE_LE_KEYS)];
+} btif_stored_bond_t;
+
+/*******************************************************************************
+ *
+ * Function         btif_read_stored_bonds
+ *
+ * Description      Internal helper function to read the bonded devices and
+ *                  all their keys from NVRAM, in one pass over the paired
+ *                  devices
+ *
+ * Returns          The devices with a link key or LE keys
+ *
+ ******************************************************************************/
+static std::vector<btif_stored_bond_t> btif_read_stored_bonds() {
+  std::vector<btif_stored_bond_t> bonds;
+
+  for (const auto& bd_addr : btif_config_get_paired_devices()) {
+    auto name = bd_addr.ToString();
+    btif_stored_bond_t bond = {};
+    bond.bd_addr = bd_addr;
+
+    LOG_VERBOSE("Remote device:%s", ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    size_t size = bond.link_key.size();
+    bond.link_key_found =
+        btif_config_get_bin(name, BTIF_STORAGE_KEY_LINK_KEY,
+                            bond.link_key.data(), &size) &&
+        btif_config_get_int(name, BTIF_STORAGE_KEY_LINK_KEY_TYPE,
+                            &bond.link_key_type);
+    if (bond.link_key_found) {
+      btif_config_get_int(name, BTIF_STORAGE_KEY_DEV_CLASS, &bond.cod);
+      btif_config_get_int(name, BTIF_STORAGE_KEY_PIN_LENGTH, &bond.pin_length);
+    }
+    bond.device_type_found = btif_config_get_int(
+        name, BTIF_STORAGE_KEY_DEV_TYPE, &bond.device_type);
+
+    bool has_le_keys = btif_has_ble_keys(name);
+    bond.le_device =
+        bond.device_type_found &&
+        ((bond.device_type & BT_DEVICE_TYPE_BLE) == BT_DEVICE_TYPE_BLE ||
+         has_le_keys);
+    bool key_found = false;
+    if (bond.le_device || has_le_keys) {
+      for (size_t i = 0; i < std::size(BTIF_STORAGE_LE_KEYS); i++) {
+        auto key = BTIF_STORAGE_LE_KEYS[i];
+        size_t length = key.size;
+        bond.le_key_found[i] = btif_config_get_bin(
+            name, key.name, (uint8_t*)&bond.le_keys[i], &length);
+        key_found |= bond.le_key_found[i];
+      }
+      bond.le_device = bond.le_device && key_found;
+    }
+    if (bond.le_device &&
+        !btif_storage_get_remote_addr_type(bd_addr, bond.addr_type)) {
+      bond.addr_type = BLE_ADDR_PUBLIC;
+      btif_storage_set_remote_addr_type(&bd_addr, BLE_ADDR_PUBLIC);
+    }
+
+    if (bond.link_key_found || key_found) {
+      bonds.push_back(bond);
+    }
+  }
+  return bonds;
+}
+
+static const tBTA_LE_KEY_VALUE* btif_stored_bond_le_key(
+    const btif_stored_bond_t& bond, uint8_t key_type) {
+  for (size_t i = 0; i < std::size(BTIF_STORAGE_LE_KEYS); i++) {
+    if (BTIF_STORAGE_LE_KEYS[i].type == key_type) {
+      return bond.le_key_found[i] ? &bond.le_keys[i] : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+static void btif_in_add_bonded_device(btif_bonded_devices_t* p_bonded_devices,
+                                      const RawAddress& bd_addr) {
+  if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
+    p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
+  } else {
+    LOG_WARN("Exceed the max number of bonded devices");
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_add_stored_bonds
+ *
+ * Description      Internal helper function to add the bonded devices read
+ *                  from NVRAM to BTA, with a single call for all the devices
+ *
+ ******************************************************************************/
+static void btif_add_stored_bonds(const std::vector<btif_stored_bond_t>& bonds,
+                                  btif_bonded_devices_t* p_bonded_devices) {
+  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
+
+  std::vector<tBTA_DM_BONDED_DEVICE> devices;
+  devices.reserve(bonds.size());
+  for (const auto& bond : bonds) {
+    if (!bond.link_key_found && !bond.le_device) continue;
+
+    tBTA_DM_BONDED_DEVICE device = {};
+    device.bd_addr = bond.bd_addr;
+
+    if (bond.link_key_found) {
+      device.link_key_known = true;
+      device.link_key = bond.link_key;
+      device.key_type = (uint8_t)bond.link_key_type;
+      uint2devclass((uint32_t)bond.cod, device.dev_class);
+      device.pin_length = (uint8_t)bond.pin_length;
+      if (bond.device_type_found && bond.device_type == BT_DEVICE_TYPE_DUMO) {
+        btif_gatts_add_bonded_dev_from_nv(bond.bd_addr);
+      }
+      btif_in_add_bonded_device(p_bonded_devices, bond.bd_addr);
+    }
+
+    if (bond.le_device) {
+      LOG_VERBOSE("Found a LE device: %s",
+                  ADDRESS_TO_LOGGABLE_CSTR(bond.bd_addr));
+      device.addr_type = bond.addr_type;
+      for (size_t i = 0; i < std::size(BTIF_STORAGE_LE_KEYS); i++) {
+        if (bond.le_key_found[i]) {
+          device.ble_keys.emplace_back(BTIF_STORAGE_LE_KEYS[i].type,
+                                       bond.le_keys[i]);
+        }
+      }
+      btif_in_add_bonded_device(p_bonded_devices, bond.bd_addr);
+      btif_gatts_add_bonded_dev_from_nv(bond.bd_addr);
+    }
+
+    devices.push_back(std::move(device));
+  }
+
+  if (!devices.empty()) {
+    BTA_DmAddBondedDevices(std::move(devices));
+  }
+}
+
 /*******************************************************************************
  * Functions
  *
@@ -667,7 +803,7 @@ bt_status_t btif_storage_get_adapter_property(bt_property_t* property) {
   } else if (property->type == BT_PROPERTY_ADAPTER_BONDED_DEVICES) {
     btif_bonded_devices_t bonded_devices;
 
-    btif_in_fetch_bonded_devices(&bonded_devices, 0);
+    btif_in_fetch_bonded_devices(&bonded_devices);
 
     LOG_VERBOSE(
         "BT_PROPERTY_ADAPTER_BONDED_DEVICES: Number of bonded devices=%d",
@@ -915,29 +1051,25 @@ bt_status_t btif_storage_remove_bonded_device(
  * We still allow such devices to bond in order to give the user a chance to
  * update firmware.
  */
-static void remove_devices_with_sample_ltk() {
-  std::vector<RawAddress> bad_ltk;
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    tBTA_LE_KEY_VALUE key;
-    memset(&key, 0, sizeof(key));
-
-    if (btif_storage_get_ble_bonding_key(
-            bd_addr, BTM_LE_KEY_PENC, (uint8_t*)&key,
-            sizeof(tBTM_LE_PENC_KEYS)) == BT_STATUS_SUCCESS) {
-      if (is_sample_ltk(key.penc_key.ltk)) {
-        bad_ltk.push_back(bd_addr);
-      }
-    }
-  }
-
-  for (RawAddress address : bad_ltk) {
+static void remove_devices_with_sample_ltk(
+    std::vector<btif_stored_bond_t>* bonds) {
+  auto has_sample_ltk = [](const btif_stored_bond_t& bond) {
+    const tBTA_LE_KEY_VALUE* key =
+        btif_stored_bond_le_key(bond, BTM_LE_KEY_PENC);
+    return key != nullptr && is_sample_ltk(key->penc_key.ltk);
+  };
+
+  for (const auto& bond : *bonds) {
+    if (!has_sample_ltk(bond)) continue;
+
+    RawAddress address = bond.bd_addr;
     LOG_ERROR("Removing bond to device using test TLK: %s",
               ADDRESS_TO_LOGGABLE_CSTR(address));
 
     btif_storage_remove_bonded_device(&address);
   }
+  bonds->erase(std::remove_if(bonds->begin(), bonds->end(), has_sample_ltk),
+               bonds->end());
 }
 
 /*******************************************************************************
@@ -953,31 +1085,33 @@ static void remove_devices_with_sample_ltk() {
  *
  ******************************************************************************/
 void btif_storage_load_le_devices(void) {
+  std::vector<btif_stored_bond_t> bonds = btif_read_stored_bonds();
   btif_bonded_devices_t bonded_devices;
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  btif_add_stored_bonds(bonds, &bonded_devices);
   std::unordered_set<RawAddress> bonded_addresses;
   for (uint16_t i = 0; i < bonded_devices.num_devices; i++) {
     bonded_addresses.insert(bonded_devices.devices[i]);
   }
+  std::unordered_map<RawAddress, const tBTA_LE_KEY_VALUE*> pid_keys;
+  for (const auto& bond : bonds) {
+    pid_keys[bond.bd_addr] = btif_stored_bond_le_key(bond, BTM_LE_KEY_PID);
+  }
 
   std::vector<std::pair<RawAddress, RawAddress>> consolidated_devices;
   for (uint16_t i = 0; i < bonded_devices.num_devices; i++) {
-    // RawAddress* p_remote_addr;
-    tBTA_LE_KEY_VALUE key = {};
-    if (btif_storage_get_ble_bonding_key(
-            bonded_devices.devices[i], BTM_LE_KEY_PID, (uint8_t*)&key,
-            sizeof(tBTM_LE_PID_KEYS)) == BT_STATUS_SUCCESS) {
-      if (bonded_devices.devices[i] != key.pid_key.identity_addr) {
+    const tBTA_LE_KEY_VALUE* key = pid_keys[bonded_devices.devices[i]];
+    if (key != nullptr) {
+      if (bonded_devices.devices[i] != key->pid_key.identity_addr) {
         LOG_INFO("Found device with a known identity address %s %s",
                  ADDRESS_TO_LOGGABLE_CSTR(bonded_devices.devices[i]),
-                 ADDRESS_TO_LOGGABLE_CSTR(key.pid_key.identity_addr));
+                 ADDRESS_TO_LOGGABLE_CSTR(key->pid_key.identity_addr));
 
         if (bonded_devices.devices[i].IsEmpty() ||
-            key.pid_key.identity_addr.IsEmpty()) {
+            key->pid_key.identity_addr.IsEmpty()) {
           LOG_WARN("Address is empty! Skip");
         } else {
           consolidated_devices.emplace_back(bonded_devices.devices[i],
-                                            key.pid_key.identity_addr);
+                                            key->pid_key.identity_addr);
         }
       }
     }
@@ -1039,9 +1173,10 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   Uuid remote_uuids[BT_MAX_NUM_UUIDS];
   bt_status_t status;
 
-  remove_devices_with_sample_ltk();
+  std::vector<btif_stored_bond_t> bonds = btif_read_stored_bonds();
+  remove_devices_with_sample_ltk(&bonds);
 
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  btif_add_stored_bonds(bonds, &bonded_devices);
 
   /* Now send the adapter_properties_cb with all adapter_properties */
   {
@@ -1509,7 +1644,7 @@ bool btif_storage_is_restricted_device(const RawAddress* remote_bd_addr) {
 
 int btif_storage_get_num_bonded_devices(void) {
   btif_bonded_devices_t bonded_devices;
-  btif_in_fetch_bonded_devices(&bonded_devices, 0);
+  btif_in_fetch_bonded_devices(&bonded_devices);
   return bonded_devices.num_devices;
 }
 
@@ -22,6 +22,7 @@
 
 #include <hardware/bluetooth.h>
 
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 
@@ -115,6 +116,38 @@ using bluetooth::common::MessageLoopThread;
 
 static MessageLoopThread management_thread("bt_stack_manager_thread");
 
+namespace {
+// Logs how long each phase of a stack transition takes, and the whole of it
+class StackPhaseTimer {
+ public:
+  explicit StackPhaseTimer(const char* transition)
+      : transition_(transition),
+        start_(std::chrono::steady_clock::now()),
+        phase_start_(start_) {}
+
+  ~StackPhaseTimer() {
+    LOG_INFO("%s took %lld ms", transition_, elapsed_ms(start_));
+  }
+
+  void EndPhase(const char* phase) {
+    LOG_INFO("%s: %s took %lld ms", transition_, phase,
+             elapsed_ms(phase_start_));
+    phase_start_ = std::chrono::steady_clock::now();
+  }
+
+ private:
+  static long long elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - since)
+        .count();
+  }
+
+  const char* transition_;
+  const std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point phase_start_;
+};
+}  // namespace
+
 // If initialized, any of the bluetooth API functions can be called.
 // (e.g. turning logging on and off, enabling/disabling the stack, etc)
 static bool stack_is_initialized;
@@ -238,6 +271,7 @@ inline const module_t* get_local_module(const char* name) {
 static void init_stack_internal(bluetooth::core::CoreInterface* interface) {
   // all callbacks out of libbluetooth-core happen via this interface
   interfaceToProfiles = interface;
+  StackPhaseTimer timer("stack init");
 
   module_management_start();
 
@@ -245,12 +279,16 @@ static void init_stack_internal(bluetooth::core::CoreInterface* interface) {
 
   module_init(get_local_module(DEVICE_IOT_CONFIG_MODULE));
   module_init(get_local_module(OSI_MODULE));
+  timer.EndPhase("threads and osi");
   module_start_up(get_local_module(GD_SHIM_MODULE));
+  timer.EndPhase("gd stack");
   module_init(get_local_module(BTIF_CONFIG_MODULE));
   btif_init_bluetooth();
+  timer.EndPhase("btif");
 
   module_init(get_local_module(INTEROP_MODULE));
   module_init(get_local_module(STACK_CONFIG_MODULE));
+  timer.EndPhase("config");
 
   // stack init is synchronous, so no waiting necessary here
   stack_is_initialized = true;
@@ -293,12 +331,14 @@ static void event_start_up_stack(bluetooth::core::CoreInterface* interface,
   ensure_stack_is_initialized(interface);
 
   LOG_INFO("%s is bringing up the stack", __func__);
+  StackPhaseTimer timer("stack start up");
   future_t* local_hack_future = future_new();
   hack_future = local_hack_future;
 
   LOG_INFO("%s Gd shim module enabled", __func__);
   get_btm_client_interface().lifecycle.btm_init();
   module_start_up(get_local_module(BTIF_CONFIG_MODULE));
+  timer.EndPhase("config");
 
   l2c_init();
   sdp_init();
@@ -308,8 +348,10 @@ static void event_start_up_stack(bluetooth::core::CoreInterface* interface,
 
   RFCOMM_Init();
   GAP_Init();
+  timer.EndPhase("core stack");
 
   startProfiles();
+  timer.EndPhase("profiles");
 
   bta_sys_init();
 
@@ -318,11 +360,13 @@ static void event_start_up_stack(bluetooth::core::CoreInterface* interface,
   btif_init_ok();
   BTA_dm_init();
   bta_dm_enable(btif_dm_sec_evt, btif_dm_acl_evt);
+  timer.EndPhase("bta");
 
   bta_set_forward_hw_failures(true);
   btm_acl_device_down();
   CHECK(module_start_up(get_local_module(GD_CONTROLLER_MODULE)));
   BTM_reset_complete();
+  timer.EndPhase("controller");
 
   BTA_dm_on_hw_on();
 
@@ -332,8 +376,10 @@ static void event_start_up_stack(bluetooth::core::CoreInterface* interface,
     event_shut_down_stack(stopProfiles);
     return;
   }
+  timer.EndPhase("bta dm enable");
 
   module_start_up(get_local_module(RUST_MODULE));
+  timer.EndPhase("rust");
 
   stack_is_running = true;
   LOG_INFO("%s finished", __func__);
@@ -348,22 +394,26 @@ static void event_shut_down_stack(ProfileStopCallback stopProfiles) {
   }
 
   LOG_INFO("%s is bringing down the stack", __func__);
+  StackPhaseTimer timer("stack shut down");
   future_t* local_hack_future = future_new();
   hack_future = local_hack_future;
   stack_is_running = false;
 
   module_shut_down(get_local_module(RUST_MODULE));
+  timer.EndPhase("rust");
 
   do_in_main_thread(FROM_HERE, base::BindOnce(&btm_ble_scanner_cleanup));
 
   btif_dm_on_disable();
   stopProfiles();
+  timer.EndPhase("profiles");
 
   do_in_main_thread(FROM_HERE, base::BindOnce(bta_dm_disable));
 
   btif_dm_cleanup();
 
   future_await(local_hack_future);
+  timer.EndPhase("bta dm disable");
   local_hack_future = future_new();
   hack_future = local_hack_future;
 
@@ -375,6 +425,7 @@ static void event_shut_down_stack(ProfileStopCallback stopProfiles) {
   module_shut_down(get_local_module(DEVICE_IOT_CONFIG_MODULE));
 
   future_await(local_hack_future);
+  timer.EndPhase("bta and config");
 
   module_clean_up(get_local_module(BTE_LOGMSG_MODULE));
 
@@ -384,10 +435,12 @@ static void event_shut_down_stack(ProfileStopCallback stopProfiles) {
   get_btm_client_interface().lifecycle.btm_ble_free();
 
   get_btm_client_interface().lifecycle.btm_free();
+  timer.EndPhase("core stack");
 
   hack_future = future_new();
   do_in_jni_thread(FROM_HERE, base::BindOnce(event_signal_stack_down, nullptr));
   future_await(hack_future);
+  timer.EndPhase("stack down callback");
   LOG_INFO("%s finished", __func__);
 }
 
@@ -410,23 +463,30 @@ static void event_clean_up_stack(std::promise<void> promise,
   ensure_stack_is_not_running(stopProfiles);
 
   LOG_INFO("%s is cleaning up the stack", __func__);
-  stack_is_initialized = false;
+  {
+    StackPhaseTimer timer("stack clean up");
+    stack_is_initialized = false;
 
-  btif_cleanup_bluetooth();
+    btif_cleanup_bluetooth();
+    timer.EndPhase("btif");
 
-  module_clean_up(get_local_module(STACK_CONFIG_MODULE));
-  module_clean_up(get_local_module(INTEROP_MODULE));
+    module_clean_up(get_local_module(STACK_CONFIG_MODULE));
+    module_clean_up(get_local_module(INTEROP_MODULE));
 
-  module_clean_up(get_local_module(BTIF_CONFIG_MODULE));
-  module_clean_up(get_local_module(DEVICE_IOT_CONFIG_MODULE));
+    module_clean_up(get_local_module(BTIF_CONFIG_MODULE));
+    module_clean_up(get_local_module(DEVICE_IOT_CONFIG_MODULE));
 
-  module_clean_up(get_local_module(OSI_MODULE));
-  LOG_INFO("%s Gd shim module disabled", __func__);
-  module_shut_down(get_local_module(GD_SHIM_MODULE));
+    module_clean_up(get_local_module(OSI_MODULE));
+    timer.EndPhase("config and osi");
+    LOG_INFO("%s Gd shim module disabled", __func__);
+    module_shut_down(get_local_module(GD_SHIM_MODULE));
+    timer.EndPhase("gd stack");
 
-  main_thread_shut_down();
+    main_thread_shut_down();
 
-  module_management_stop();
+    module_management_stop();
+    timer.EndPhase("threads");
+  }
   LOG_INFO("%s finished", __func__);
 
 cleanup:;
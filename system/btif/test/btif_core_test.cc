@@ -16,8 +16,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <future>
 #include <map>
+#include <vector>
 
 #include "bta/include/bta_ag_api.h"
 #include "bta/include/bta_av_api.h"
@@ -32,6 +34,7 @@
 #include "include/hardware/bt_av.h"
 #include "test/common/core_interface.h"
 #include "test/mock/mock_main_shim_controller.h"
+#include "test/mock/mock_osi_properties.h"
 #include "test/mock/mock_stack_btm_sec.h"
 #include "types/raw_address.h"
 
@@ -64,8 +67,17 @@ void remote_device_properties_callback(bt_status_t /* status */,
                                        RawAddress* /* bd_addr */,
                                        int /* num_properties */,
                                        bt_property_t* /* properties */) {}
-void device_found_callback(int /* num_properties */,
-                           bt_property_t* /* properties */) {}
+std::vector<std::map<bt_property_type_t, std::vector<uint8_t>>>
+    device_found_properties_;
+void device_found_callback(int num_properties, bt_property_t* properties) {
+  std::map<bt_property_type_t, std::vector<uint8_t>> found;
+  for (int i = 0; i < num_properties; i++) {
+    const uint8_t* val = (const uint8_t*)properties[i].val;
+    found[properties[i].type] =
+        std::vector<uint8_t>(val, val + properties[i].len);
+  }
+  device_found_properties_.push_back(found);
+}
 void discovery_state_changed_callback(bt_discovery_state_t /* state */) {}
 void pin_request_callback(RawAddress* /* remote_bd_addr */,
                           bt_bdname_t* /* bd_name */, uint32_t /* cod */,
@@ -217,6 +229,61 @@ TEST_F(BtifCoreTest, test_post_on_bt_jni_simple3) {
   ASSERT_EQ(val, future.get());
 }
 
+TEST_F(BtifCoreTest, coalesce_device_found_callbacks) {
+  test::mock::osi_properties::osi_property_get_bool.body =
+      [](const char* key, bool default_value) { return default_value; };
+  device_found_properties_.clear();
+
+  // Hold the JNI thread so that the updates queue up behind it
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  post_on_bt_jni([released]() { released.wait(); });
+
+  const RawAddress other({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+  RawAddress addr = kRawAddress;
+  RawAddress other_addr = other;
+  int8_t rssi = -60;
+  char name[] = "name";
+  bt_property_t first[] = {
+      {BT_PROPERTY_BDADDR, sizeof(addr), &addr},
+      {BT_PROPERTY_REMOTE_RSSI, sizeof(rssi), &rssi},
+  };
+  invoke_device_found_cb(2, first);
+  bt_property_t second[] = {
+      {BT_PROPERTY_BDADDR, sizeof(other_addr), &other_addr},
+      {BT_PROPERTY_REMOTE_RSSI, sizeof(rssi), &rssi},
+  };
+  invoke_device_found_cb(2, second);
+  rssi = -40;
+  bt_property_t third[] = {
+      {BT_PROPERTY_BDADDR, sizeof(addr), &addr},
+      {BT_PROPERTY_BDNAME, (int)strlen(name), name},
+      {BT_PROPERTY_REMOTE_RSSI, sizeof(rssi), &rssi},
+  };
+  invoke_device_found_cb(3, third);
+
+  std::promise<void> promise;
+  std::future<void> future = promise.get_future();
+  post_on_bt_jni([&promise]() { promise.set_value(); });
+  release.set_value();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(timeout_time));
+
+  // The third update was merged into the first one, the newest RSSI winning
+  ASSERT_EQ(2u, device_found_properties_.size());
+  auto& merged = device_found_properties_[0];
+  ASSERT_EQ(3u, merged.size());
+  ASSERT_EQ(std::vector<uint8_t>(kRawAddress.address, kRawAddress.address + 6),
+            merged[BT_PROPERTY_BDADDR]);
+  ASSERT_EQ(std::vector<uint8_t>(name, name + strlen(name)),
+            merged[BT_PROPERTY_BDNAME]);
+  ASSERT_EQ(std::vector<uint8_t>({(uint8_t)-40}),
+            merged[BT_PROPERTY_REMOTE_RSSI]);
+  ASSERT_EQ(std::vector<uint8_t>(other.address, other.address + 6),
+            device_found_properties_[1][BT_PROPERTY_BDADDR]);
+
+  test::mock::osi_properties::osi_property_get_bool = {};
+}
+
 extern const char* dump_av_sm_event_name(int event);
 TEST_F(BtifCoreTest, dump_av_sm_event_name) {
   std::vector<std::pair<int, std::string>> events = {
@@ -35,6 +35,7 @@ bt_status_t btif_transfer_context(tBTIF_CBACK* p_cback, uint16_t event,
   return BT_STATUS_SUCCESS;
 }
 void btif_queue_advance() {}
+void btif_queue_advance_by_uuid(uint16_t uuid, const RawAddress* bda) {}
 const char* dump_hf_client_event(uint16_t event) {
   return "UNKNOWN MSG ID";
 }
@@ -22,10 +22,23 @@
 #include <base/location.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "btif/include/stack_manager.h"
+#include "stack/include/bt_uuid16.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
 
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+
+void btif_queue_set_max_concurrent_connects(size_t max_connects);
+
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
+
 typedef void(tBTIF_CBACK)(uint16_t event, char* p_param);
 typedef void(tBTIF_COPY_CBACK)(uint16_t event, char* p_dest, const char* p_src);
 
@@ -64,8 +77,13 @@ class BtifProfileQueueTest : public ::testing::Test {
   void SetUp() override {
     sStackRunning = true;
     sResult = NOT_SET;
+    // Connection requests are executed one at a time
+    bluetooth::legacy::testing::btif_queue_set_max_concurrent_connects(1);
+  };
+  void TearDown() override {
+    btif_queue_release();
+    bluetooth::legacy::testing::btif_queue_set_max_concurrent_connects(0);
   };
-  void TearDown() override { btif_queue_release(); };
 };
 
 const RawAddress BtifProfileQueueTest::kTestAddr1{
@@ -263,3 +281,72 @@ TEST_F(BtifProfileQueueTest, test_cleanup_both_reverse_order) {
   btif_queue_connect_next();
   EXPECT_EQ(sResult, NOT_SET);
 }
+
+static std::vector<std::pair<uint16_t, RawAddress>> sConnects;
+
+static bt_status_t test_connect_cb_record(RawAddress* bda, uint16_t uuid) {
+  sConnects.push_back({uuid, *bda});
+  return BT_STATUS_SUCCESS;
+}
+
+class BtifProfileQueueConcurrentTest : public BtifProfileQueueTest {
+ protected:
+  void SetUp() override {
+    BtifProfileQueueTest::SetUp();
+    sConnects.clear();
+    bluetooth::legacy::testing::btif_queue_set_max_concurrent_connects(2);
+  };
+};
+
+TEST_F(BtifProfileQueueConcurrentTest, test_connect_different_devices) {
+  btif_queue_connect(kTestUuid1, &kTestAddr1, test_connect_cb_record);
+  btif_queue_connect(kTestUuid1, &kTestAddr2, test_connect_cb_record);
+  // Both devices are connected at once
+  ASSERT_EQ(2u, sConnects.size());
+  EXPECT_EQ(kTestAddr1, sConnects[0].second);
+  EXPECT_EQ(kTestAddr2, sConnects[1].second);
+  // A third device waits for one of them to complete
+  const RawAddress addr3{{0x10, 0x20, 0x30, 0x40, 0x50, 0x60}};
+  btif_queue_connect(kTestUuid1, &addr3, test_connect_cb_record);
+  ASSERT_EQ(2u, sConnects.size());
+  btif_queue_advance_by_uuid(kTestUuid1, &kTestAddr1);
+  ASSERT_EQ(3u, sConnects.size());
+  EXPECT_EQ(addr3, sConnects[2].second);
+}
+
+TEST_F(BtifProfileQueueConcurrentTest, test_connect_same_device_in_order) {
+  btif_queue_connect(kTestUuid1, &kTestAddr1, test_connect_cb_record);
+  btif_queue_connect(kTestUuid2, &kTestAddr1, test_connect_cb_record);
+  btif_queue_connect(kTestUuid1, &kTestAddr2, test_connect_cb_record);
+  // The second profile of ADDR1 waits for the first, ADDR2 doesn't
+  ASSERT_EQ(2u, sConnects.size());
+  EXPECT_EQ(kTestAddr2, sConnects[1].second);
+  // Completing another request doesn't start it
+  btif_queue_advance_by_uuid(kTestUuid1, &kTestAddr2);
+  ASSERT_EQ(2u, sConnects.size());
+  btif_queue_advance_by_uuid(kTestUuid1, &kTestAddr1);
+  ASSERT_EQ(3u, sConnects.size());
+  EXPECT_EQ(uint16_t{kTestUuid2}, sConnects[2].first);
+  EXPECT_EQ(kTestAddr1, sConnects[2].second);
+}
+
+TEST_F(BtifProfileQueueConcurrentTest, test_connect_a2dp_and_hfp_together) {
+  btif_queue_connect(UUID_SERVCLASS_AUDIO_SOURCE, &kTestAddr1,
+                     test_connect_cb_record);
+  btif_queue_connect(UUID_SERVCLASS_AG_HANDSFREE, &kTestAddr1,
+                     test_connect_cb_record);
+  // A2DP and HFP of the same device are connected at once
+  ASSERT_EQ(2u, sConnects.size());
+  EXPECT_EQ(UUID_SERVCLASS_AG_HANDSFREE, sConnects[1].first);
+}
+
+TEST_F(BtifProfileQueueConcurrentTest, test_advance_unknown_request) {
+  btif_queue_connect(kTestUuid1, &kTestAddr1, test_connect_cb_record);
+  btif_queue_connect(kTestUuid2, &kTestAddr1, test_connect_cb_record);
+  ASSERT_EQ(1u, sConnects.size());
+  // A request that isn't in progress doesn't advance the queue
+  btif_queue_advance_by_uuid(kTestUuid2, &kTestAddr1);
+  ASSERT_EQ(1u, sConnects.size());
+  btif_queue_advance_by_uuid(kTestUuid1, &kTestAddr1);
+  ASSERT_EQ(2u, sConnects.size());
+}
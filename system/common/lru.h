@@ -18,17 +18,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <iterator>
-#include <list>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <thread>
-#include <unordered_map>
 
 #include <base/logging.h>
 
 #include "check.h"
+#include "gd/common/flat_lru_cache.h"
 
 namespace bluetooth {
 
@@ -45,11 +46,14 @@ class LegacyLruCache {
    * @param log_tag, keyword to put at the head of log.
    */
   LegacyLruCache(const size_t& capacity, const std::string& log_tag)
-      : capacity_(capacity) {
-    if (capacity_ == 0) {
+      : cache_(std::max<size_t>(capacity, 1)) {
+    if (capacity == 0) {
       // don't allow invalid capacity
       LOG(FATAL) << log_tag << " unable to have 0 LRU Cache capacity";
     }
+    // The cache never grows past |capacity|, so pointers returned by Find()
+    // stay valid until their key is removed or evicted
+    cache_.reserve(capacity);
   }
 
   // delete copy constructor
@@ -63,8 +67,7 @@ class LegacyLruCache {
    */
   void Clear() {
     std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
-    lru_map_.clear();
-    node_list_.clear();
+    cache_.clear();
   }
 
   /**
@@ -78,12 +81,7 @@ class LegacyLruCache {
    */
   V* Find(const K& key) {
     std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
-    auto map_iterator = lru_map_.find(key);
-    if (map_iterator == lru_map_.end()) {
-      return nullptr;
-    }
-    node_list_.splice(node_list_.begin(), node_list_, map_iterator->second);
-    return &(map_iterator->second->second);
+    return cache_.find(key);
   }
 
   /**
@@ -127,23 +125,9 @@ class LegacyLruCache {
    */
   std::optional<Node> Put(const K& key, V value) {
     std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
-    auto value_ptr = Find(key);
-    if (value_ptr != nullptr) {
-      // hasKey() calls get(), therefore already move the node to the head
-      *value_ptr = std::move(value);
-      return std::nullopt;
-    }
-
-    // remove tail
     std::optional<Node> ret = std::nullopt;
-    if (lru_map_.size() == capacity_) {
-      lru_map_.erase(node_list_.back().first);
-      ret = std::move(node_list_.back());
-      node_list_.pop_back();
-    }
-    // insert to dummy next;
-    node_list_.emplace_front(key, std::move(value));
-    lru_map_.emplace(key, node_list_.begin());
+    cache_.insert_or_assign(key, std::move(value),
+                            [&ret](Node&& evicted) { ret = std::move(evicted); });
     return ret;
   }
 
@@ -155,18 +139,7 @@ class LegacyLruCache {
    */
   bool Remove(const K& key) {
     std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
-    auto map_iterator = lru_map_.find(key);
-    if (map_iterator == lru_map_.end()) {
-      return false;
-    }
-
-    // remove from the list
-    node_list_.erase(map_iterator->second);
-
-    // delete key from map
-    lru_map_.erase(map_iterator);
-
-    return true;
+    return cache_.erase(key);
   }
 
   /**
@@ -176,13 +149,19 @@ class LegacyLruCache {
    */
   int Size() const {
     std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
-    return lru_map_.size();
+    return cache_.size();
+  }
+
+  /**
+   * Return the hit, miss, insertion and eviction counters of the cache
+   */
+  LruCacheStats GetStats() const {
+    std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
+    return cache_.stats();
   }
 
  private:
-  std::list<Node> node_list_;
-  size_t capacity_;
-  std::unordered_map<K, typename std::list<Node>::iterator> lru_map_;
+  FlatLruCache<K, V, LruEntryCount<K, V>> cache_;
   mutable std::recursive_mutex lru_mutex_;
 };
 
@@ -75,6 +75,12 @@ bool MessageLoopThread::DoInThreadDelayed(const base::Location& from_here,
                << ", from " << from_here.ToString();
     return false;
   }
+  if (task_stats_ != nullptr && task_stats_->ShouldSample()) {
+    auto due_time = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(delay.InMicroseconds());
+    task = base::BindOnce(&MessageLoopThread::RunSampledTask, task_stats_,
+                          from_here, due_time, std::move(task));
+  }
   if (!message_loop_->task_runner()->PostDelayedTask(from_here, std::move(task),
                                                      delay)) {
     LOG(ERROR) << __func__
@@ -120,6 +126,11 @@ base::PlatformThreadId MessageLoopThread::GetThreadId() const {
   return thread_id_;
 }
 
+pid_t MessageLoopThread::GetLinuxThreadId() const {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  return linux_tid_;
+}
+
 std::string MessageLoopThread::GetName() const { return thread_name_; }
 
 std::string MessageLoopThread::ToString() const {
@@ -165,6 +176,43 @@ bool MessageLoopThread::EnableRealTimeScheduling() {
   return true;
 }
 
+void MessageLoopThread::EnableTaskStats(
+    uint32_t sample_rate, std::chrono::milliseconds slow_task_threshold) {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  if (task_stats_ != nullptr) {
+    LOG(WARNING) << __func__ << ": task stats already enabled for thread "
+                 << *this;
+    return;
+  }
+  task_stats_ = std::make_shared<TaskStats>(thread_name_, sample_rate,
+                                            slow_task_threshold);
+}
+
+void MessageLoopThread::DumpTaskStats(int fd) const {
+  std::shared_ptr<TaskStats> task_stats;
+  {
+    std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+    task_stats = task_stats_;
+  }
+  if (task_stats != nullptr) {
+    task_stats->Dump(fd);
+  }
+}
+
+void MessageLoopThread::RunSampledTask(
+    std::shared_ptr<TaskStats> task_stats, const base::Location& from_here,
+    std::chrono::steady_clock::time_point due_time, base::OnceClosure task) {
+  auto start_time = std::chrono::steady_clock::now();
+  std::move(task).Run();
+  auto end_time = std::chrono::steady_clock::now();
+  task_stats->Record(
+      from_here,
+      std::chrono::duration_cast<std::chrono::microseconds>(start_time -
+                                                            due_time),
+      std::chrono::duration_cast<std::chrono::microseconds>(end_time -
+                                                            start_time));
+}
+
 base::WeakPtr<MessageLoopThread> MessageLoopThread::GetWeakPtr() {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
   return weak_ptr_factory_.GetWeakPtr();
@@ -22,11 +22,14 @@
 #include <base/threading/platform_thread.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <future>
+#include <memory>
 #include <string>
 #include <thread>
 
 #include "abstract_message_loop.h"
+#include "common/task_stats.h"
 #include "gd/common/contextual_callback.h"
 #include "gd/common/i_postable_context.h"
 
@@ -97,6 +100,14 @@ class MessageLoopThread final : public IPostableContext {
    */
   base::PlatformThreadId GetThreadId() const;
 
+  /**
+   * Get the linux thread id of this thread, as returned by gettid(). This is
+   * the id to pass to the osi thread_scheduler to apply a scheduling profile.
+   *
+   * @return this thread's linux thread id, or -1 if it is not running
+   */
+  pid_t GetLinuxThreadId() const;
+
   /**
    * Get this thread's name set in constructor
    *
@@ -125,6 +136,26 @@ class MessageLoopThread final : public IPostableContext {
    */
   bool EnableRealTimeScheduling();
 
+  /**
+   * Start sampling the queueing delay and run time of the tasks posted to this
+   * thread. Tasks running longer than |slow_task_threshold| are logged. The
+   * statistics are kept across ShutDown() and StartUp().
+   *
+   * Repeated call to this method will only enable statistics once
+   *
+   * @param sample_rate one task out of every |sample_rate| is sampled
+   * @param slow_task_threshold run time from which a task is logged
+   */
+  void EnableTaskStats(uint32_t sample_rate = TaskStats::kDefaultSampleRate,
+                       std::chrono::milliseconds slow_task_threshold =
+                           TaskStats::kDefaultSlowTaskThreshold);
+
+  /**
+   * Write the task statistics of this thread to |fd| in dumpsys format. Does
+   * nothing if EnableTaskStats() was never called.
+   */
+  void DumpTaskStats(int fd) const;
+
   /**
    * Return the weak pointer to this object. This can be useful when posting
    * delayed tasks to this MessageLoopThread using Timer.
@@ -234,6 +265,14 @@ class MessageLoopThread final : public IPostableContext {
    */
   void Run(std::promise<void> start_up_promise);
 
+  /**
+   * Run a sampled task and record its statistics
+   */
+  static void RunSampledTask(std::shared_ptr<TaskStats> task_stats,
+                             const base::Location& from_here,
+                             std::chrono::steady_clock::time_point due_time,
+                             base::OnceClosure task);
+
   mutable std::recursive_mutex api_mutex_;
   const std::string thread_name_;
   btbase::AbstractMessageLoop* message_loop_;
@@ -244,6 +283,7 @@ class MessageLoopThread final : public IPostableContext {
   pid_t linux_tid_;
   base::WeakPtrFactory<MessageLoopThread> weak_ptr_factory_;
   bool shutting_down_;
+  std::shared_ptr<TaskStats> task_stats_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
@@ -166,6 +166,24 @@ TEST_F(MessageLoopThreadTest, test_thread_id) {
   ASSERT_EQ(thread_id, my_thread_id);
 }
 
+TEST_F(MessageLoopThreadTest, test_linux_thread_id) {
+  std::string name = "test_thread";
+  MessageLoopThread message_loop_thread(name);
+  ASSERT_LT(message_loop_thread.GetLinuxThreadId(), 0);
+  message_loop_thread.StartUp();
+  pid_t linux_tid = message_loop_thread.GetLinuxThreadId();
+  ASSERT_GT(linux_tid, 0);
+  std::promise<pid_t> tid_promise;
+  std::future<pid_t> tid_future = tid_promise.get_future();
+  message_loop_thread.DoInThread(
+      FROM_HERE,
+      base::BindOnce(&MessageLoopThreadTest::GetLinuxTid,
+                     base::Unretained(this), std::move(tid_promise)));
+  ASSERT_EQ(linux_tid, tid_future.get());
+  message_loop_thread.ShutDown();
+  ASSERT_LT(message_loop_thread.GetLinuxThreadId(), 0);
+}
+
 TEST_F(MessageLoopThreadTest, test_set_realtime_priority_fail_before_start) {
   std::string name = "test_thread";
   MessageLoopThread message_loop_thread(name);
@@ -346,3 +364,22 @@ TEST_F(MessageLoopThreadTest, test_post_twice) {
   message_loop_thread.ShutDown();
   ASSERT_EQ(counter, 2);
 }
+
+TEST_F(MessageLoopThreadTest, test_task_stats) {
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.EnableTaskStats(1, std::chrono::milliseconds(1000));
+  message_loop_thread.StartUp();
+  int counter = 0;
+  for (int i = 0; i < 10; i++) {
+    message_loop_thread.DoInThread(
+        FROM_HERE, base::BindOnce([](int* counter) { (*counter)++; }, &counter));
+  }
+  message_loop_thread.ShutDown();
+  ASSERT_EQ(counter, 10);
+
+  FILE* file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  message_loop_thread.DumpTaskStats(fileno(file));
+  ASSERT_GT(ftell(file), 0);
+  fclose(file);
+}
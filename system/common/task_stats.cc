@@ -0,0 +1,212 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/task_stats.h"
+
+#include <base/logging.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+namespace bluetooth {
+
+namespace common {
+
+// Lower bound of bucket 1 is 2^kFirstBucketShift microseconds
+static constexpr int kFirstBucketShift = 6;
+
+TaskStats::TaskStats(const std::string& name, uint32_t sample_rate,
+                     std::chrono::milliseconds slow_task_threshold)
+    : name_(name),
+      sample_rate_(std::max<uint32_t>(sample_rate, 1)),
+      slow_task_threshold_(slow_task_threshold) {}
+
+bool TaskStats::ShouldSample() {
+  return post_count_.fetch_add(1, std::memory_order_relaxed) % sample_rate_ ==
+         0;
+}
+
+size_t TaskStats::BucketIndex(std::chrono::microseconds duration) {
+  uint64_t us = duration.count() > 0 ? duration.count() : 0;
+  size_t index = 0;
+  for (us >>= (kFirstBucketShift - 1); us > 1 && index < kNumBuckets - 1;
+       us >>= 1) {
+    index++;
+  }
+  return index;
+}
+
+TaskStats::LocationStats* TaskStats::FindOrAddLocation(
+    const base::Location& from_here) {
+  for (size_t i = 0; i < num_locations_; i++) {
+    LocationStats& location = locations_[i];
+    if (location.line_number == from_here.line_number() &&
+        location.file_name == from_here.file_name()) {
+      return &location;
+    }
+  }
+  if (num_locations_ == kMaxLocations) {
+    return nullptr;
+  }
+  LocationStats& location = locations_[num_locations_++];
+  location.file_name = from_here.file_name();
+  location.function_name = from_here.function_name();
+  location.line_number = from_here.line_number();
+  return &location;
+}
+
+void TaskStats::Record(const base::Location& from_here,
+                       std::chrono::microseconds queue_delay,
+                       std::chrono::microseconds run_time) {
+  bool is_slow = run_time >= slow_task_threshold_;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampled_count_++;
+    queue_delay_buckets_[BucketIndex(queue_delay)]++;
+    run_time_buckets_[BucketIndex(run_time)]++;
+    max_queue_delay_ = std::max(max_queue_delay_, queue_delay);
+
+    LocationStats* location = FindOrAddLocation(from_here);
+    if (location != nullptr) {
+      location->count++;
+      location->total_run_time += run_time;
+      location->max_run_time = std::max(location->max_run_time, run_time);
+    } else {
+      untracked_location_count_++;
+    }
+
+    // Keep the slowest tasks, replacing the fastest of them once full
+    SlowTask* slot = nullptr;
+    if (num_slowest_tasks_ < kNumSlowestTasks) {
+      slot = &slowest_tasks_[num_slowest_tasks_++];
+    } else {
+      slot = &*std::min_element(slowest_tasks_.begin(), slowest_tasks_.end(),
+                                [](const SlowTask& a, const SlowTask& b) {
+                                  return a.run_time < b.run_time;
+                                });
+      if (slot->run_time >= run_time) {
+        slot = nullptr;
+      }
+    }
+    if (slot != nullptr) {
+      slot->from_here = from_here;
+      slot->timestamp = std::chrono::system_clock::now();
+      slot->queue_delay = queue_delay;
+      slot->run_time = run_time;
+    }
+    if (is_slow) {
+      slow_count_++;
+    }
+  }
+
+  if (is_slow) {
+    LOG(WARNING) << __func__ << ": slow task on " << name_ << " from "
+                 << from_here.ToString() << " ran for " << run_time.count()
+                 << "us after waiting " << queue_delay.count() << "us";
+  }
+}
+
+uint64_t TaskStats::GetSampledTaskCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sampled_count_;
+}
+
+static void dump_buckets(int fd, const char* title,
+                         const std::array<uint64_t, TaskStats::kNumBuckets>&
+                             buckets) {
+  dprintf(fd, "    %s:\n", title);
+  for (size_t i = 0; i < buckets.size(); i++) {
+    if (buckets[i] == 0) continue;
+    if (i == 0) {
+      dprintf(fd, "      < %8dus : %" PRIu64 "\n", 1 << kFirstBucketShift,
+              buckets[i]);
+    } else if (i == buckets.size() - 1) {
+      dprintf(fd, "      >= %7dus : %" PRIu64 "\n",
+              1 << (kFirstBucketShift + i - 1), buckets[i]);
+    } else {
+      dprintf(fd, "      < %8dus : %" PRIu64 "\n",
+              1 << (kFirstBucketShift + i), buckets[i]);
+    }
+  }
+}
+
+void TaskStats::Dump(int fd) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  dprintf(fd, "  Task stats for %s (1 in %u tasks sampled):\n", name_.c_str(),
+          sample_rate_);
+  dprintf(fd, "    Sampled tasks                      : %" PRIu64 "\n",
+          sampled_count_);
+  dprintf(fd, "    Slow tasks (>= %" PRId64 "us)            : %" PRIu64 "\n",
+          static_cast<int64_t>(slow_task_threshold_.count()), slow_count_);
+  dprintf(fd, "    Max queue delay                    : %" PRId64 "us\n",
+          static_cast<int64_t>(max_queue_delay_.count()));
+  if (sampled_count_ == 0) return;
+
+  dump_buckets(fd, "Queue delay", queue_delay_buckets_);
+  dump_buckets(fd, "Run time", run_time_buckets_);
+
+  std::vector<const LocationStats*> locations;
+  for (size_t i = 0; i < num_locations_; i++) {
+    locations.push_back(&locations_[i]);
+  }
+  std::sort(locations.begin(), locations.end(),
+            [](const LocationStats* a, const LocationStats* b) {
+              return a->total_run_time > b->total_run_time;
+            });
+  dprintf(fd, "    Run time by location (count / avg / max):\n");
+  for (const LocationStats* location : locations) {
+    dprintf(fd, "      %s@%s:%d : %" PRIu64 " / %" PRId64 "us / %" PRId64
+                "us\n",
+            location->function_name, location->file_name,
+            location->line_number, location->count,
+            static_cast<int64_t>(location->total_run_time.count() /
+                                 location->count),
+            static_cast<int64_t>(location->max_run_time.count()));
+  }
+  if (untracked_location_count_ > 0) {
+    dprintf(fd, "      (untracked locations) : %" PRIu64 "\n",
+            untracked_location_count_);
+  }
+
+  std::vector<const SlowTask*> slowest;
+  for (size_t i = 0; i < num_slowest_tasks_; i++) {
+    slowest.push_back(&slowest_tasks_[i]);
+  }
+  std::sort(slowest.begin(), slowest.end(),
+            [](const SlowTask* a, const SlowTask* b) {
+              return a->run_time > b->run_time;
+            });
+  dprintf(fd, "    Slowest tasks:\n");
+  for (const SlowTask* task : slowest) {
+    time_t timestamp = std::chrono::system_clock::to_time_t(task->timestamp);
+    struct tm tm;
+    char time_buf[32];
+    localtime_r(&timestamp, &tm);
+    strftime(time_buf, sizeof(time_buf), "%m-%d %H:%M:%S", &tm);
+    dprintf(fd, "      %s %s ran %" PRId64 "us after waiting %" PRId64 "us\n",
+            time_buf, task->from_here.ToString().c_str(),
+            static_cast<int64_t>(task->run_time.count()),
+            static_cast<int64_t>(task->queue_delay.count()));
+  }
+}
+
+}  // namespace common
+
+}  // namespace bluetooth
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <base/location.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace bluetooth {
+
+namespace common {
+
+/**
+ * Sampled latency statistics of the tasks run by a MessageLoopThread.
+ *
+ * For one task out of every |sample_rate| posted, records the queueing delay
+ * (from the time the task was due to the time it started) and its run time.
+ * All the storage is allocated up front so recording never allocates, and
+ * the counters can stay enabled in production.
+ */
+class TaskStats {
+ public:
+  static constexpr uint32_t kDefaultSampleRate = 16;
+  static constexpr std::chrono::milliseconds kDefaultSlowTaskThreshold{50};
+
+  // Bucket 0 holds durations below 64us, bucket i holds [2^(i+5), 2^(i+6))us
+  // and the last bucket holds everything from ~1s up.
+  static constexpr size_t kNumBuckets = 16;
+  static constexpr size_t kMaxLocations = 64;
+  static constexpr size_t kNumSlowestTasks = 8;
+
+  TaskStats(const std::string& name, uint32_t sample_rate,
+            std::chrono::milliseconds slow_task_threshold);
+
+  TaskStats(const TaskStats&) = delete;
+  TaskStats& operator=(const TaskStats&) = delete;
+
+  /**
+   * Check whether the task being posted should be sampled. Thread safe.
+   *
+   * @return true for one call out of every |sample_rate|
+   */
+  bool ShouldSample();
+
+  /**
+   * Record a sampled task. Tasks running for at least the slow task threshold
+   * are also logged.
+   *
+   * @param from_here location where the task was posted from
+   * @param queue_delay time between the task being due and it starting
+   * @param run_time time the task took to run
+   */
+  void Record(const base::Location& from_here,
+              std::chrono::microseconds queue_delay,
+              std::chrono::microseconds run_time);
+
+  /**
+   * Write the collected statistics to |fd| in dumpsys format
+   */
+  void Dump(int fd) const;
+
+  uint64_t GetSampledTaskCount() const;
+
+  static size_t BucketIndex(std::chrono::microseconds duration);
+
+ private:
+  struct LocationStats {
+    const char* file_name = nullptr;
+    const char* function_name = nullptr;
+    int line_number = 0;
+    uint64_t count = 0;
+    std::chrono::microseconds total_run_time{0};
+    std::chrono::microseconds max_run_time{0};
+  };
+
+  struct SlowTask {
+    base::Location from_here;
+    std::chrono::system_clock::time_point timestamp;
+    std::chrono::microseconds queue_delay{0};
+    std::chrono::microseconds run_time{0};
+  };
+
+  LocationStats* FindOrAddLocation(const base::Location& from_here);
+
+  const std::string name_;
+  const uint32_t sample_rate_;
+  const std::chrono::microseconds slow_task_threshold_;
+  std::atomic<uint32_t> post_count_{0};
+
+  mutable std::mutex mutex_;
+  uint64_t sampled_count_ = 0;
+  uint64_t slow_count_ = 0;
+  std::array<uint64_t, kNumBuckets> queue_delay_buckets_{};
+  std::array<uint64_t, kNumBuckets> run_time_buckets_{};
+  std::chrono::microseconds max_queue_delay_{0};
+  std::array<LocationStats, kMaxLocations> locations_{};
+  size_t num_locations_ = 0;
+  uint64_t untracked_location_count_ = 0;
+  std::array<SlowTask, kNumSlowestTasks> slowest_tasks_{};
+  size_t num_slowest_tasks_ = 0;
+};
+
+}  // namespace common
+
+}  // namespace bluetooth
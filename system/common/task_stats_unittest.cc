@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/task_stats.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+
+using bluetooth::common::TaskStats;
+using std::chrono::microseconds;
+
+namespace {
+
+std::string DumpToString(const TaskStats& stats) {
+  FILE* file = tmpfile();
+  stats.Dump(fileno(file));
+  std::string output(ftell(file), '\0');
+  rewind(file);
+  output.resize(fread(output.data(), 1, output.size(), file));
+  fclose(file);
+  return output;
+}
+
+}  // namespace
+
+TEST(TaskStatsTest, bucket_index) {
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(-1)), 0u);
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(0)), 0u);
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(63)), 0u);
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(64)), 1u);
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(127)), 1u);
+  EXPECT_EQ(TaskStats::BucketIndex(microseconds(128)), 2u);
+  EXPECT_EQ(TaskStats::BucketIndex(std::chrono::hours(1)),
+            TaskStats::kNumBuckets - 1);
+}
+
+TEST(TaskStatsTest, sample_rate) {
+  TaskStats stats("test", 4, std::chrono::milliseconds(100));
+  int sampled = 0;
+  for (int i = 0; i < 100; i++) {
+    if (stats.ShouldSample()) sampled++;
+  }
+  EXPECT_EQ(sampled, 25);
+}
+
+TEST(TaskStatsTest, record_and_dump) {
+  TaskStats stats("test_thread", 1, std::chrono::milliseconds(10));
+  base::Location fast_location = FROM_HERE;
+  base::Location slow_location = FROM_HERE;
+  for (int i = 0; i < 100; i++) {
+    stats.Record(fast_location, microseconds(10), microseconds(100));
+  }
+  stats.Record(slow_location, microseconds(5000), microseconds(20000));
+  EXPECT_EQ(stats.GetSampledTaskCount(), 101u);
+
+  std::string dump = DumpToString(stats);
+  EXPECT_NE(dump.find("test_thread"), std::string::npos);
+  EXPECT_NE(dump.find("ran 20000us after waiting 5000us"), std::string::npos);
+}
+
+TEST(TaskStatsTest, location_table_is_bounded) {
+  TaskStats stats("test_thread", 1, std::chrono::milliseconds(10));
+  for (size_t i = 0; i < TaskStats::kMaxLocations + 1; i++) {
+    stats.Record(base::Location("function", "file", i, nullptr),
+                 microseconds(0), microseconds(1));
+  }
+  EXPECT_NE(DumpToString(stats).find("(untracked locations) : 1"),
+            std::string::npos);
+}
@@ -343,6 +343,11 @@ typedef enum {
   // It is required for some devices to provide sound.
   INTEROP_INSERT_CALL_WHEN_SCO_START,
 
+  // Some devices change their stream endpoints without changing their
+  // firmware version. Always run the AVDTP stream discovery for them instead
+  // of using the cached stream endpoints.
+  INTEROP_DISABLE_AVDTP_SEP_CACHE,
+
   END_OF_INTEROP_LIST
 } interop_feature_t;
 
@@ -118,7 +118,7 @@ bool device_iot_config_int_add_one(const std::string& section,
     result = 0;
   }
   config_set_int(config.get(), section, key, result);
-  device_iot_config_save_async();
+  device_iot_config_save_counters_async();
 
   return true;
 }
@@ -241,6 +241,20 @@ void device_iot_config_save_async(void) {
             device_iot_config_timer_save_cb, NULL);
 }
 
+void device_iot_config_save_counters_async(void) {
+  if (!InitFlags::IsDeviceIotConfigLoggingEnabled()) return;
+
+  CHECK(config != NULL);
+  CHECK(config_timer != NULL);
+
+  // Do not postpone a save already scheduled
+  if (alarm_is_scheduled(config_timer)) return;
+
+  LOG_VERBOSE("");
+  alarm_set(config_timer, CONFIG_COUNTER_FLUSH_PERIOD_MS,
+            device_iot_config_timer_save_cb, NULL);
+}
+
 int device_iot_config_get_device_num(const config_t& conf) {
   if (!InitFlags::IsDeviceIotConfigLoggingEnabled()) return 0;
 
@@ -59,6 +59,9 @@ static const char* IOT_CONFIG_FILE_PATH = "bt_remote_dev_info.conf";
 static const char* IOT_CONFIG_BACKUP_PATH = "bt_remote_dev_info.bak";
 #endif  // __ANDROID__
 static const uint64_t CONFIG_SETTLE_PERIOD_MS = 12000;
+// Counters change on most connection events, they are only saved with the
+// other changes or after this period
+static const uint64_t CONFIG_COUNTER_FLUSH_PERIOD_MS = 10 * 60 * 1000;
 
 enum ConfigSource { NOT_LOADED, ORIGINAL, BACKUP, NEW_FILE, RESET };
 
@@ -87,6 +90,7 @@ bool device_iot_config_has_key_value(const std::string& section,
                                      const std::string& key,
                                      const std::string& value_str);
 void device_iot_config_save_async(void);
+void device_iot_config_save_counters_async(void);
 int device_iot_config_get_device_num(const config_t& config);
 void device_iot_config_restrict_device_num(config_t& config);
 bool device_iot_config_compare_key(const entry_t& first, const entry_t& second);
@@ -35,7 +35,9 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "btcore/include/module.h"
 #include "btif/include/btif_storage.h"
@@ -186,9 +188,17 @@ typedef struct {
 
 } interop_db_entry_t;
 
+// Entries of |interop_list| by type and feature, in the order of the list, so
+// that a lookup only compares the entries of its feature.
+// Protected by |interop_list_lock|.
+static std::unordered_map<uint32_t, std::vector<interop_db_entry_t*>>
+    interop_index;
+
 static const char* interop_feature_string_(const interop_feature_t feature);
 static void interop_free_entry_(void* data);
 static void interop_lazy_init_(void);
+static void interop_index_add_(interop_db_entry_t* entry);
+static void interop_index_remove_(interop_db_entry_t* entry);
 
 // Config related functions
 static void interop_config_cleanup(void);
@@ -307,6 +317,7 @@ static future_t* interop_clean_up(void) {
   pthread_mutex_lock(&interop_list_lock);
   list_free(interop_list);
   interop_list = NULL;
+  interop_index.clear();
   list_free(media_player_list);
   media_player_list = NULL;
   interop_is_initialized = false;
@@ -394,6 +405,7 @@ static const char* interop_feature_string_(const interop_feature_t feature) {
     CASE_RETURN_STR(INTEROP_IGNORE_DISC_BEFORE_SIGNALLING_TIMEOUT);
     CASE_RETURN_STR(INTEROP_SUSPEND_ATT_TRAFFIC_DURING_PAIRING);
     CASE_RETURN_STR(INTEROP_INSERT_CALL_WHEN_SCO_START);
+    CASE_RETURN_STR(INTEROP_DISABLE_AVDTP_SEP_CACHE);
   }
   return UNKNOWN_INTEROP_FEATURE;
 }
@@ -411,6 +423,54 @@ static void interop_lazy_init_(void) {
   }
 }
 
+static interop_feature_t interop_entry_feature_(
+    const interop_db_entry_t* entry) {
+  switch (entry->bl_type) {
+    case INTEROP_BL_TYPE_ADDR:
+      return entry->entry_type.addr_entry.feature;
+    case INTEROP_BL_TYPE_NAME:
+      return entry->entry_type.name_entry.feature;
+    case INTEROP_BL_TYPE_MANUFACTURE:
+      return entry->entry_type.mnfr_entry.feature;
+    case INTEROP_BL_TYPE_VNDR_PRDT:
+      return entry->entry_type.vnr_pdt_entry.feature;
+    case INTEROP_BL_TYPE_SSR_MAX_LAT:
+      return entry->entry_type.ssr_max_lat_entry.feature;
+    case INTEROP_BL_TYPE_VERSION:
+      return entry->entry_type.version_entry.feature;
+    case INTEROP_BL_TYPE_LMP_VERSION:
+      return entry->entry_type.lmp_version_entry.feature;
+    case INTEROP_BL_TYPE_ADDR_RANGE:
+      return entry->entry_type.addr_range_entry.feature;
+  }
+  return END_OF_INTEROP_LIST;
+}
+
+static uint32_t interop_index_key_(const interop_db_entry_t* entry) {
+  return ((uint32_t)entry->bl_type << 16) |
+         (uint16_t)interop_entry_feature_(entry);
+}
+
+// Must be called with |interop_list_lock| held
+static void interop_index_add_(interop_db_entry_t* entry) {
+  interop_index[interop_index_key_(entry)].push_back(entry);
+}
+
+// Must be called with |interop_list_lock| held
+static void interop_index_remove_(interop_db_entry_t* entry) {
+  auto bucket = interop_index.find(interop_index_key_(entry));
+  if (bucket == interop_index.end()) return;
+
+  auto& entries = bucket->second;
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (*it == entry) {
+      entries.erase(it);
+      break;
+    }
+  }
+  if (entries.empty()) interop_index.erase(bucket);
+}
+
 // interop config related functions
 
 static int interop_config_init(void) {
@@ -633,6 +693,7 @@ static void interop_database_add_(interop_db_entry_t* db_entry, bool persist) {
 
   if (interop_list) {
     list_append(interop_list, db_entry);
+    interop_index_add_(db_entry);
   }
 
   pthread_mutex_unlock(&interop_list_lock);
@@ -651,26 +712,18 @@ static bool interop_database_match(interop_db_entry_t* entry,
   CHECK(entry);
   bool found = false;
   pthread_mutex_lock(&interop_list_lock);
-  if (interop_list == NULL || list_length(interop_list) == 0) {
+  auto bucket = interop_index.find(interop_index_key_(entry));
+  if (bucket == interop_index.end()) {
     pthread_mutex_unlock(&interop_list_lock);
     return false;
   }
 
-  const list_node_t* node = list_begin(interop_list);
-
-  while (node != list_end(interop_list)) {
-    interop_db_entry_t* db_entry = (interop_db_entry_t*)list_node(node);
+  for (interop_db_entry_t* db_entry : bucket->second) {
     CHECK(db_entry);
 
-    if (entry->bl_type != db_entry->bl_type) {
-      node = list_next(node);
-      continue;
-    }
-
     if ((entry_type == INTEROP_ENTRY_TYPE_STATIC) ||
         (entry_type == INTEROP_ENTRY_TYPE_DYNAMIC)) {
       if (entry->bl_entry_type != db_entry->bl_entry_type) {
-        node = list_next(node);
         continue;
       }
     }
@@ -768,11 +821,10 @@ static bool interop_database_match(interop_db_entry_t* entry,
         break;
     }
 
-    if (found && ret_entry) {
-      *ret_entry = db_entry;
+    if (found) {
+      if (ret_entry) *ret_entry = db_entry;
       break;
     }
-    node = list_next(node);
   }
   pthread_mutex_unlock(&interop_list_lock);
   return found;
@@ -790,6 +842,7 @@ static bool interop_database_remove_(interop_db_entry_t* entry) {
 
   // first remove it from linked list
   pthread_mutex_lock(&interop_list_lock);
+  interop_index_remove_(ret_entry);
   list_remove(interop_list, (void*)ret_entry);
   pthread_mutex_unlock(&interop_list_lock);
 
@@ -1578,6 +1631,7 @@ bool interop_database_remove_feature(const interop_feature_t feature) {
 
     if (entry_match) {
       pthread_mutex_lock(&interop_list_lock);
+      interop_index_remove_(entry);
       list_remove(interop_list, (void*)entry);
       pthread_mutex_unlock(&interop_list_lock);
     }
@@ -1536,6 +1536,51 @@ TEST_F(DeviceIotConfigTest, test_device_iot_config_addr_int_add_one) {
   test::mock::osi_alarm::alarm_set.body = {};
 }
 
+TEST_F(DeviceIotConfigTest, test_device_iot_config_int_add_one_save_period) {
+  std::string expected_section = "abc", expected_key = "def";
+  bool is_scheduled;
+  uint64_t actual_interval_ms = 0;
+
+  test::mock::osi_alarm::alarm_is_scheduled.body =
+      [&](const alarm_t* alarm) -> bool { return is_scheduled; };
+
+  test::mock::osi_alarm::alarm_set.body =
+      [&](alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
+          void* data) { actual_interval_ms = interval_ms; };
+
+  {
+    reset_mock_function_count_map();
+
+    is_scheduled = false;
+
+    EXPECT_TRUE(device_iot_config_int_add_one(expected_section, expected_key));
+    EXPECT_EQ(get_func_call_count("alarm_set"), 1);
+    EXPECT_EQ(actual_interval_ms, CONFIG_COUNTER_FLUSH_PERIOD_MS);
+  }
+
+  {
+    reset_mock_function_count_map();
+
+    is_scheduled = true;
+
+    EXPECT_TRUE(device_iot_config_int_add_one(expected_section, expected_key));
+    EXPECT_EQ(get_func_call_count("alarm_set"), 0);
+  }
+
+  {
+    reset_mock_function_count_map();
+
+    is_scheduled = true;
+
+    EXPECT_TRUE(device_iot_config_set_int(expected_section, expected_key, 1));
+    EXPECT_EQ(get_func_call_count("alarm_set"), 1);
+    EXPECT_EQ(actual_interval_ms, CONFIG_SETTLE_PERIOD_MS);
+  }
+
+  test::mock::osi_alarm::alarm_is_scheduled.body = {};
+  test::mock::osi_alarm::alarm_set.body = {};
+}
+
 TEST_F(DeviceIotConfigTest, test_device_iot_config_get_hex) {
   std::string actual_section, actual_key,
       expected_section = "00:00:00:00:00:00", expected_key = "def";
@@ -417,6 +417,31 @@ TEST_F(InteropTest, test_dynamic_db_clear) {
   module_clean_up(&interop_module);
 }
 
+TEST_F(InteropTest, test_dynamic_db_remove) {
+  module_init(&interop_module);
+
+  RawAddress test_address;
+
+  RawAddress::FromString("11:22:33:44:55:66", test_address);
+  interop_database_add(INTEROP_DISABLE_LE_SECURE_CONNECTIONS, &test_address, 3);
+  interop_database_add(INTEROP_AUTO_RETRY_PAIRING, &test_address, 3);
+  EXPECT_TRUE(
+      interop_match_addr(INTEROP_DISABLE_LE_SECURE_CONNECTIONS, &test_address));
+  EXPECT_TRUE(interop_match_addr(INTEROP_AUTO_RETRY_PAIRING, &test_address));
+
+  EXPECT_TRUE(interop_database_remove_addr(
+      INTEROP_DISABLE_LE_SECURE_CONNECTIONS, &test_address));
+  EXPECT_FALSE(
+      interop_match_addr(INTEROP_DISABLE_LE_SECURE_CONNECTIONS, &test_address));
+  EXPECT_TRUE(interop_match_addr(INTEROP_AUTO_RETRY_PAIRING, &test_address));
+  EXPECT_FALSE(interop_database_remove_addr(
+      INTEROP_DISABLE_LE_SECURE_CONNECTIONS, &test_address));
+
+  interop_database_clear();
+
+  module_clean_up(&interop_module);
+}
+
 TEST_F(InteropTest, test_name_hit) {
   module_init(&interop_module);
 
@@ -0,0 +1,336 @@
+/**
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*------------------------------------------------------------------------------
+ *
+ *  SIMD kernels of the encoder, with SSE4.1 (selected at runtime) or NEON.
+ *  The products of the convolutions are accumulated on 64 bits as in the
+ *  scalar functions, the rounding and saturation of the accumulators are
+ *  then done as in QmfConv.c.
+ *
+ *----------------------------------------------------------------------------*/
+
+#include "AptxSimd.h"
+
+#include "Qmf.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define APTX_SIMD_SSE41
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define APTX_SIMD_NEON
+#endif
+
+#if defined(APTX_SIMD_SSE41) || defined(APTX_SIMD_NEON)
+
+/* Rounding of the outer QMF accumulators, 16 bits samples */
+static int32_t roundConvO(int64_t local_acc) {
+  int32_t tmp_round0 = (int32_t)local_acc & 0x00FFFFL;
+  int32_t acc;
+
+  local_acc += 0x004000L;
+  acc = (int32_t)(local_acc >> 15);
+  if (tmp_round0 == 0x004000L) {
+    acc--;
+  }
+  return ssat24(acc);
+}
+
+/* Rounding of the inner QMF accumulators, 24 bits samples */
+static int32_t roundConvI(int64_t local_acc) {
+  uint32_t tmp_round0 = (uint32_t)local_acc;
+  int32_t acc;
+
+  local_acc += 0x00400000L;
+  acc = (int32_t)(local_acc >> 23);
+  if (((tmp_round0 << 8) ^ 0x40000000) == 0) {
+    acc--;
+  }
+  return ssat24(acc);
+}
+
+#endif
+
+#if defined(APTX_SIMD_SSE41)
+
+/* Accumulate the 4 products of coeff and data, two by two on 64 bits */
+__attribute__((target("sse4.1"))) static __m128i mac_sse41(__m128i acc,
+                                                           __m128i coeff,
+                                                           __m128i data) {
+  acc = _mm_add_epi64(acc, _mm_mul_epi32(coeff, data));
+  return _mm_add_epi64(acc, _mm_mul_epi32(_mm_srli_epi64(coeff, 32),
+                                          _mm_srli_epi64(data, 32)));
+}
+
+__attribute__((target("sse4.1"))) static int64_t sum_sse41(__m128i acc) {
+  int64_t sum[2];
+
+  _mm_storeu_si128((__m128i*)sum, acc);
+  return sum[0] + sum[1];
+}
+
+/* Load p[-3..0] in the order p[0], p[-1], p[-2], p[-3] */
+__attribute__((target("sse4.1"))) static __m128i loadBackward_sse41(
+    const int32_t* p) {
+  return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(p - 3)), 0x1B);
+}
+
+__attribute__((target("sse4.1"))) static __m128i loadBackward16_sse41(
+    const int16_t* p) {
+  return _mm_shuffle_epi32(
+      _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(p - 3))), 0x1B);
+}
+
+__attribute__((target("sse4.1"))) static void AsmQmfConvI_sse41(
+    const int32_t* p1dl_buffPtr, const int32_t* p2dl_buffPtr,
+    const int32_t* coeffPtr, int32_t* filterOutputs) {
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  int32_t phaseConv0;
+  int32_t phaseConv1;
+  int32_t k;
+
+  for (k = 0; k < 16; k += 4) {
+    __m128i coeff = _mm_loadu_si128((const __m128i*)(coeffPtr + k));
+    acc0 = mac_sse41(acc0, coeff, loadBackward_sse41(p1dl_buffPtr - k));
+    acc1 = mac_sse41(acc1, coeff,
+                     _mm_loadu_si128((const __m128i*)(p2dl_buffPtr + k)));
+  }
+
+  phaseConv0 = roundConvI(sum_sse41(acc0));
+  phaseConv1 = roundConvI(sum_sse41(acc1));
+  filterOutputs[0] = ssat24(phaseConv1 + phaseConv0);
+  filterOutputs[1] = ssat24(phaseConv1 - phaseConv0);
+}
+
+__attribute__((target("sse4.1"))) static void AsmQmfConvO_sse41(
+    const int16_t* p1dl_buffPtr, const int16_t* p2dl_buffPtr,
+    const int32_t* coeffPtr, int32_t* convSumDiff) {
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  int32_t phaseConv0;
+  int32_t phaseConv1;
+  int32_t k;
+
+  for (k = 0; k < 16; k += 4) {
+    __m128i coeff = _mm_loadu_si128((const __m128i*)(coeffPtr + k));
+    acc0 = mac_sse41(acc0, coeff, loadBackward16_sse41(p1dl_buffPtr - k));
+    acc1 = mac_sse41(acc1, coeff,
+                     _mm_cvtepi16_epi32(_mm_loadl_epi64(
+                         (const __m128i*)(p2dl_buffPtr + k))));
+  }
+
+  phaseConv0 = roundConvO(sum_sse41(acc0));
+  phaseConv1 = roundConvO(sum_sse41(acc1));
+  convSumDiff[0] = ssat24(phaseConv1 + phaseConv0);
+  convSumDiff[2] = ssat24(phaseConv1 - phaseConv0);
+}
+
+__attribute__((target("sse4.1"))) static int64_t zeroFilterConv_sse41(
+    int32_t* zeroCoeffPt, const int32_t* cbuf_pt, const int32_t invQ,
+    const int32_t invQincr_pos, const int32_t invQincr_neg,
+    const int32_t numCoeffs) {
+  const __m128i incrPos = _mm_set1_epi32(invQincr_pos);
+  const __m128i incrDiff = _mm_set1_epi32(invQincr_pos ^ invQincr_neg);
+  const __m128i roundMask = _mm_set1_epi32(0x1FF);
+  const __m128i roundHalf = _mm_set1_epi32(0x100);
+  __m128i prevZData = _mm_set_epi32(invQ, 0, 0, 0);
+  __m128i accL = _mm_setzero_si128();
+  int32_t k;
+
+  for (k = 0; k + 4 <= numCoeffs; k += 4) {
+    __m128i zData = loadBackward_sse41(cbuf_pt - k);
+    __m128i oldZData = _mm_alignr_epi8(zData, prevZData, 12);
+    __m128i coeff = _mm_loadu_si128((const __m128i*)(zeroCoeffPt + k));
+
+    /* Select invQincr_neg for the negative samples */
+    __m128i incr = _mm_xor_si128(
+        incrPos, _mm_and_si128(incrDiff, _mm_srai_epi32(zData, 31)));
+    __m128i acc = _mm_sub_epi32(incr, coeff);
+    __m128i round = _mm_cmpeq_epi32(_mm_and_si128(acc, roundMask), roundHalf);
+    acc = _mm_add_epi32(_mm_add_epi32(_mm_srai_epi32(acc, 8), coeff), round);
+
+    _mm_storeu_si128((__m128i*)(zeroCoeffPt + k), acc);
+    accL = mac_sse41(accL, acc, oldZData);
+    prevZData = zData;
+  }
+
+  if (k == numCoeffs) {
+    return sum_sse41(accL);
+  }
+  return sum_sse41(accL) + zeroFilterConv(zeroCoeffPt + k, cbuf_pt - k,
+                                          cbuf_pt[1 - k], invQincr_pos,
+                                          invQincr_neg, numCoeffs - k);
+}
+
+#elif defined(APTX_SIMD_NEON)
+
+/* Load p[-3..0] in the order p[0], p[-1], p[-2], p[-3] */
+static int32x4_t loadBackward_neon(const int32_t* p) {
+  int32x4_t v = vrev64q_s32(vld1q_s32(p - 3));
+  return vextq_s32(v, v, 2);
+}
+
+static int32x4_t loadBackward16_neon(const int16_t* p) {
+  int32x4_t v = vrev64q_s32(vmovl_s16(vld1_s16(p - 3)));
+  return vextq_s32(v, v, 2);
+}
+
+static int64x2_t mac_neon(int64x2_t acc, int32x4_t coeff, int32x4_t data) {
+  acc = vmlal_s32(acc, vget_low_s32(coeff), vget_low_s32(data));
+  return vmlal_high_s32(acc, coeff, data);
+}
+
+static void AsmQmfConvI_neon(const int32_t* p1dl_buffPtr,
+                             const int32_t* p2dl_buffPtr,
+                             const int32_t* coeffPtr, int32_t* filterOutputs) {
+  int64x2_t acc0 = vdupq_n_s64(0);
+  int64x2_t acc1 = vdupq_n_s64(0);
+  int32_t phaseConv0;
+  int32_t phaseConv1;
+  int32_t k;
+
+  for (k = 0; k < 16; k += 4) {
+    int32x4_t coeff = vld1q_s32(coeffPtr + k);
+    acc0 = mac_neon(acc0, coeff, loadBackward_neon(p1dl_buffPtr - k));
+    acc1 = mac_neon(acc1, coeff, vld1q_s32(p2dl_buffPtr + k));
+  }
+
+  phaseConv0 = roundConvI(vaddvq_s64(acc0));
+  phaseConv1 = roundConvI(vaddvq_s64(acc1));
+  filterOutputs[0] = ssat24(phaseConv1 + phaseConv0);
+  filterOutputs[1] = ssat24(phaseConv1 - phaseConv0);
+}
+
+static void AsmQmfConvO_neon(const int16_t* p1dl_buffPtr,
+                             const int16_t* p2dl_buffPtr,
+                             const int32_t* coeffPtr, int32_t* convSumDiff) {
+  int64x2_t acc0 = vdupq_n_s64(0);
+  int64x2_t acc1 = vdupq_n_s64(0);
+  int32_t phaseConv0;
+  int32_t phaseConv1;
+  int32_t k;
+
+  for (k = 0; k < 16; k += 4) {
+    int32x4_t coeff = vld1q_s32(coeffPtr + k);
+    acc0 = mac_neon(acc0, coeff, loadBackward16_neon(p1dl_buffPtr - k));
+    acc1 = mac_neon(acc1, coeff, vmovl_s16(vld1_s16(p2dl_buffPtr + k)));
+  }
+
+  phaseConv0 = roundConvO(vaddvq_s64(acc0));
+  phaseConv1 = roundConvO(vaddvq_s64(acc1));
+  convSumDiff[0] = ssat24(phaseConv1 + phaseConv0);
+  convSumDiff[2] = ssat24(phaseConv1 - phaseConv0);
+}
+
+static int64_t zeroFilterConv_neon(int32_t* zeroCoeffPt,
+                                   const int32_t* cbuf_pt, const int32_t invQ,
+                                   const int32_t invQincr_pos,
+                                   const int32_t invQincr_neg,
+                                   const int32_t numCoeffs) {
+  const int32x4_t incrPos = vdupq_n_s32(invQincr_pos);
+  const int32x4_t incrNeg = vdupq_n_s32(invQincr_neg);
+  const int32x4_t roundMask = vdupq_n_s32(0x1FF);
+  const int32x4_t roundHalf = vdupq_n_s32(0x100);
+  int32x4_t prevZData = vsetq_lane_s32(invQ, vdupq_n_s32(0), 3);
+  int64x2_t accL = vdupq_n_s64(0);
+  int32_t k;
+
+  for (k = 0; k + 4 <= numCoeffs; k += 4) {
+    int32x4_t zData = loadBackward_neon(cbuf_pt - k);
+    int32x4_t oldZData = vextq_s32(prevZData, zData, 3);
+    int32x4_t coeff = vld1q_s32(zeroCoeffPt + k);
+
+    /* Select invQincr_neg for the negative samples */
+    int32x4_t acc =
+        vsubq_s32(vbslq_s32(vcltzq_s32(zData), incrNeg, incrPos), coeff);
+    uint32x4_t round = vceqq_s32(vandq_s32(acc, roundMask), roundHalf);
+    acc = vaddq_s32(vsraq_n_s32(coeff, acc, 8), vreinterpretq_s32_u32(round));
+
+    vst1q_s32(zeroCoeffPt + k, acc);
+    accL = mac_neon(accL, acc, oldZData);
+    prevZData = zData;
+  }
+
+  if (k == numCoeffs) {
+    return vaddvq_s64(accL);
+  }
+  return vaddvq_s64(accL) + zeroFilterConv(zeroCoeffPt + k, cbuf_pt - k,
+                                           cbuf_pt[1 - k], invQincr_pos,
+                                           invQincr_neg, numCoeffs - k);
+}
+
+#endif
+
+int32_t aptxSimdSupported(void) {
+#if defined(APTX_SIMD_SSE41)
+  return __builtin_cpu_supports("sse4.1") ? 1 : 0;
+#elif defined(APTX_SIMD_NEON)
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void AsmQmfConvI_simd(const int32_t* p1dl_buffPtr, const int32_t* p2dl_buffPtr,
+                      const int32_t* coeffPtr, int32_t* filterOutputs) {
+#if defined(APTX_SIMD_SSE41)
+  if (__builtin_cpu_supports("sse4.1")) {
+    AsmQmfConvI_sse41(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, filterOutputs);
+    return;
+  }
+  AsmQmfConvI(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, filterOutputs);
+#elif defined(APTX_SIMD_NEON)
+  AsmQmfConvI_neon(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, filterOutputs);
+#else
+  AsmQmfConvI(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, filterOutputs);
+#endif
+}
+
+void AsmQmfConvO_simd(const int16_t* p1dl_buffPtr, const int16_t* p2dl_buffPtr,
+                      const int32_t* coeffPtr, int32_t* convSumDiff) {
+#if defined(APTX_SIMD_SSE41)
+  if (__builtin_cpu_supports("sse4.1")) {
+    AsmQmfConvO_sse41(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, convSumDiff);
+    return;
+  }
+  AsmQmfConvO(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, convSumDiff);
+#elif defined(APTX_SIMD_NEON)
+  AsmQmfConvO_neon(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, convSumDiff);
+#else
+  AsmQmfConvO(p1dl_buffPtr, p2dl_buffPtr, coeffPtr, convSumDiff);
+#endif
+}
+
+int64_t zeroFilterConv_simd(int32_t* zeroCoeffPt, const int32_t* cbuf_pt,
+                            const int32_t invQ, const int32_t invQincr_pos,
+                            const int32_t invQincr_neg,
+                            const int32_t numCoeffs) {
+#if defined(APTX_SIMD_SSE41)
+  if (__builtin_cpu_supports("sse4.1")) {
+    return zeroFilterConv_sse41(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                                invQincr_neg, numCoeffs);
+  }
+  return zeroFilterConv(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                        invQincr_neg, numCoeffs);
+#elif defined(APTX_SIMD_NEON)
+  return zeroFilterConv_neon(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                             invQincr_neg, numCoeffs);
+#else
+  return zeroFilterConv(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                        invQincr_neg, numCoeffs);
+#endif
+}
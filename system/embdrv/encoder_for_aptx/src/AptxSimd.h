@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*------------------------------------------------------------------------------
+ *
+ *  Prototypes of the SIMD kernels of the encoder: the QMF convolutions and
+ *  the zero filter of the subband predictors. The kernels are bit-exact with
+ *  the scalar functions, and fall back to them when the CPU has no SIMD
+ *  implementation.
+ *
+ *----------------------------------------------------------------------------*/
+
+#ifndef APTXSIMD_H
+#define APTXSIMD_H
+
+#include <stdint.h>
+
+/* Return 1 if the SIMD kernels have an implementation for the CPU */
+int32_t aptxSimdSupported(void);
+
+void AsmQmfConvI_simd(const int32_t* p1dl_buffPtr, const int32_t* p2dl_buffPtr,
+                      const int32_t* coeffPtr, int32_t* filterOutputs);
+void AsmQmfConvO_simd(const int16_t* p1dl_buffPtr, const int16_t* p2dl_buffPtr,
+                      const int32_t* coeffPtr, int32_t* convSumDiff);
+
+/* Update the numCoeffs zero filter coefficients with the sign of the delay
+ * line samples, read backward from cbuf_pt, and return the convolution of the
+ * updated coefficients with the delay line delayed by one sample (invQ being
+ * the newest sample). */
+int64_t zeroFilterConv(int32_t* zeroCoeffPt, const int32_t* cbuf_pt,
+                       const int32_t invQ, const int32_t invQincr_pos,
+                       const int32_t invQincr_neg, const int32_t numCoeffs);
+int64_t zeroFilterConv_simd(int32_t* zeroCoeffPt, const int32_t* cbuf_pt,
+                            const int32_t invQ, const int32_t invQincr_pos,
+                            const int32_t invQincr_neg,
+                            const int32_t numCoeffs);
+
+#endif  // APTXSIMD_H
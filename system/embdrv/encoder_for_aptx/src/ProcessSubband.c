@@ -62,3 +62,40 @@ void processSubbandHL(const int32_t qCode, const int32_t ditherVal,
   /* Predictor filtering */
   performPredictionFilteringHL(iqDataPt->invQ, SubbandDataPt);
 }
+
+/* Zero filter coefficient update and convolution, for the number of
+ * coefficients of the subband. */
+int64_t zeroFilterConv(int32_t* zeroCoeffPt, const int32_t* cbuf_pt,
+                       const int32_t invQ, const int32_t invQincr_pos,
+                       const int32_t invQincr_neg, const int32_t numCoeffs) {
+  int32_t acc;
+  int64_t accL;
+  int32_t zData0;
+  int32_t k;
+  int32_t oldZData;
+
+  oldZData = invQ;
+  accL = 0;
+  for (k = 0; k < numCoeffs; k++) {
+    uint32_t tmp_round0;
+    int32_t coeffValue;
+
+    zData0 = (*(cbuf_pt--));
+    coeffValue = *(zeroCoeffPt + k);
+    if (zData0 < 0L) {
+      acc = invQincr_neg - coeffValue;
+    } else {
+      acc = invQincr_pos - coeffValue;
+    }
+    tmp_round0 = acc;
+    acc = (acc >> 8) + coeffValue;
+    if (((tmp_round0 << 23) ^ 0x80000000) == 0) {
+      acc--;
+    }
+    accL += (int64_t)acc * (int64_t)(oldZData);
+    oldZData = zData0;
+    *(zeroCoeffPt + k) = acc;
+  }
+
+  return accL;
+}
@@ -25,6 +25,7 @@
 #define QMF_H
 
 #include "AptxParameters.h"
+#include "AptxSimd.h"
 
 typedef struct {
   int32_t QmfL_buf[32];
@@ -99,9 +100,9 @@ XBT_INLINE_ void QmfAnalysisFilter(const int32_t pcm[4], Qmf_storage* Qmf_St,
   Qmf_St->QmfH_buf[lc_QmfO_pt++] = pcm[SecondPcm];
   lc_QmfO_pt &= 0xF;
 
-  AsmQmfConvO_HD(&Qmf_St->QmfL_buf[lc_QmfO_pt + 15],
-                 &Qmf_St->QmfH_buf[lc_QmfO_pt], Qmf_outerCoeffs,
-                 &convSumDiff[0]);
+  AsmQmfConvO_HD_simd(&Qmf_St->QmfL_buf[lc_QmfO_pt + 15],
+                      &Qmf_St->QmfH_buf[lc_QmfO_pt], Qmf_outerCoeffs,
+                      &convSumDiff[0]);
 
   /* Load outer filter phase1 and phase2 delay lines with the second 2 PCM
    * samples. Convolve the filter and get the 2 convolution results. */
@@ -111,9 +112,9 @@ XBT_INLINE_ void QmfAnalysisFilter(const int32_t pcm[4], Qmf_storage* Qmf_St,
   Qmf_St->QmfH_buf[lc_QmfO_pt++] = pcm[FourthPcm];
   lc_QmfO_pt &= 0xF;
 
-  AsmQmfConvO_HD(&Qmf_St->QmfL_buf[lc_QmfO_pt + 15],
-                 &Qmf_St->QmfH_buf[lc_QmfO_pt], Qmf_outerCoeffs,
-                 &convSumDiff[1]);
+  AsmQmfConvO_HD_simd(&Qmf_St->QmfL_buf[lc_QmfO_pt + 15],
+                      &Qmf_St->QmfH_buf[lc_QmfO_pt], Qmf_outerCoeffs,
+                      &convSumDiff[1]);
 
   /* Load the first inner filter phase1 and phase2 delay lines with the 2
    * convolution sum (low-pass) outer filter outputs. Convolve the filter and
@@ -124,9 +125,9 @@ XBT_INLINE_ void QmfAnalysisFilter(const int32_t pcm[4], Qmf_storage* Qmf_St,
   Qmf_St->QmfLH_buf[lc_QmfI_pt + 16] = convSumDiff[1];
   Qmf_St->QmfLH_buf[lc_QmfI_pt] = convSumDiff[1];
 
-  AsmQmfConvI_HD(&Qmf_St->QmfLL_buf[lc_QmfI_pt + 16],
-                 &Qmf_St->QmfLH_buf[lc_QmfI_pt + 1], &Qmf_innerCoeffs[0],
-                 &filterOutputs[LL]);
+  AsmQmfConvI_HD_simd(&Qmf_St->QmfLL_buf[lc_QmfI_pt + 16],
+                      &Qmf_St->QmfLH_buf[lc_QmfI_pt + 1],
+                      &Qmf_innerCoeffs[0], &filterOutputs[LL]);
 
   /* Load the second inner filter phase1 and phase2 delay lines with the 2
    * convolution difference (high-pass) outer filter outputs. Convolve the
@@ -139,9 +140,9 @@ XBT_INLINE_ void QmfAnalysisFilter(const int32_t pcm[4], Qmf_storage* Qmf_St,
   Qmf_St->QmfHH_buf[lc_QmfI_pt++] = convSumDiff[3];
   lc_QmfI_pt &= 0xF;
 
-  AsmQmfConvI_HD(&Qmf_St->QmfHL_buf[lc_QmfI_pt + 15],
-                 &Qmf_St->QmfHH_buf[lc_QmfI_pt], &Qmf_innerCoeffs[0],
-                 &filterOutputs[HL]);
+  AsmQmfConvI_HD_simd(&Qmf_St->QmfHL_buf[lc_QmfI_pt + 15],
+                      &Qmf_St->QmfHH_buf[lc_QmfI_pt], &Qmf_innerCoeffs[0],
+                      &filterOutputs[HL]);
 
   /* Subtracted the previous predicted value from the filter output on a
    * per-subband basis. Ensure these values are saturated, if necessary.
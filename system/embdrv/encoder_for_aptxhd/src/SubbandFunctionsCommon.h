@@ -25,6 +25,8 @@
 #ifndef SUBBANDFUNCTIONSCOMMON_H
 #define SUBBANDFUNCTIONSCOMMON_H
 
+#include "AptxSimd.h"
+
 enum reg64_reg { reg64_H = 1, reg64_L = 0 };
 
 void processSubband_HD(const int32_t qCode, const int32_t ditherVal,
@@ -248,8 +250,6 @@ XBT_INLINE_ void performPredictionFiltering(const int32_t invQ,
   int32_t* cbuf_pt;
   int32_t invQincr_pos;
   int32_t invQincr_neg;
-  int32_t k;
-  int32_t oldZData;
   /* Pole coefficient and data indices */
   enum { a1 = 0, a2 = 1 };
 
@@ -294,31 +294,10 @@ XBT_INLINE_ void performPredictionFiltering(const int32_t invQ,
 
   SubbandDataPt->m_predData.m_zeroDelayLine.modulo = invQ;
 
-  /* Iterate over the number of coefficients for this subband */
-  oldZData = invQ;
-  accL = 0;
-  for (k = 0; k < 12; k++) {
-    uint32_t tmp_round0;
-    int32_t coeffValue;
-    int32_t zData0;
-
-    /* ------------------------------------------------------------------*/
-    zData0 = (*(cbuf_pt--));
-    coeffValue = *(zeroCoeffPt + k);
-    if (zData0 < 0L) {
-      acc = invQincr_neg - coeffValue;
-    } else {
-      acc = invQincr_pos - coeffValue;
-    }
-    tmp_round0 = acc;
-    acc = (acc >> 8) + coeffValue;
-    if (((tmp_round0 << 23) ^ 0x80000000) == 0) {
-      acc--;
-    }
-    accL += (int64_t)acc * (int64_t)(oldZData);
-    oldZData = zData0;
-    *(zeroCoeffPt + k) = acc;
-  }
+  /* Update the zero filter coefficients for this subband, and convolve
+   * them with the zero filter delay line. */
+  accL = zeroFilterConv_HD_simd(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                                invQincr_neg, 12);
 
   acc = (int32_t)(accL >> 22);
   acc = ssat24(acc);
@@ -353,8 +332,6 @@ XBT_INLINE_ void performPredictionFilteringLL(const int32_t invQ,
   int32_t* cbuf_pt;
   int32_t invQincr_pos;
   int32_t invQincr_neg;
-  int32_t k;
-  int32_t oldZData;
   /* Pole coefficient and data indices */
   enum { a1 = 0, a2 = 1 };
 
@@ -401,28 +378,10 @@ XBT_INLINE_ void performPredictionFilteringLL(const int32_t invQ,
 
   SubbandDataPt->m_predData.m_zeroDelayLine.modulo = invQ;
 
-  /* Iterate over the number of coefficients for this subband */
-  oldZData = invQ;
-  accL = 0;
-  for (k = 0; k < 24; k++) {
-    int32_t zData0;
-    int32_t coeffValue;
-
-    zData0 = (*(cbuf_pt--));
-    coeffValue = *(zeroCoeffPt + k);
-    if (zData0 < 0L) {
-      acc = invQincr_neg - coeffValue;
-    } else {
-      acc = invQincr_pos - coeffValue;
-    }
-    if (((acc << 23) ^ 0x80000000) == 0) {
-      coeffValue--;
-    }
-    acc = (acc >> 8) + coeffValue;
-    accL += (int64_t)acc * (int64_t)(oldZData);
-    oldZData = zData0;
-    *(zeroCoeffPt + k) = acc;
-  }
+  /* Update the zero filter coefficients for this subband, and convolve
+   * them with the zero filter delay line. */
+  accL = zeroFilterConv_HD_simd(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                                invQincr_neg, 24);
 
   acc = (int32_t)(accL >> 22);
   acc = ssat24(acc);
@@ -458,9 +417,6 @@ XBT_INLINE_ void performPredictionFilteringHL(const int32_t invQ,
   int32_t* cbuf_pt;
   int32_t invQincr_pos;
   int32_t invQincr_neg;
-  int32_t k;
-  int32_t oldZData;
-  const int32_t roundCte = 0x80000000;
   /* Pole coefficient and data indices */
   enum { a1 = 0, a2 = 1 };
 
@@ -504,32 +460,10 @@ XBT_INLINE_ void performPredictionFilteringHL(const int32_t invQ,
 
   SubbandDataPt->m_predData.m_zeroDelayLine.modulo = invQ;
 
-  /* Iterate over the number of coefficients for this subband */
-  oldZData = invQ;
-  accL = 0;
-
-  for (k = 0; k < 6; k++) {
-    uint32_t tmp_round0;
-    int32_t coeffValue;
-    int32_t zData0;
-
-    /* ------------------------------------------------------------------*/
-    zData0 = (*(cbuf_pt--));
-    coeffValue = *(zeroCoeffPt + k);
-    if (zData0 < 0L) {
-      acc = invQincr_neg - coeffValue;
-    } else {
-      acc = invQincr_pos - coeffValue;
-    }
-    tmp_round0 = acc;
-    acc = (acc >> 8) + coeffValue;
-    if (((tmp_round0 << 23) ^ roundCte) == 0) {
-      acc--;
-    }
-    accL += (int64_t)acc * (int64_t)(oldZData);
-    oldZData = zData0;
-    *(zeroCoeffPt + k) = acc;
-  }
+  /* Update the zero filter coefficients for this subband, and convolve
+   * them with the zero filter delay line. */
+  accL = zeroFilterConv_HD_simd(zeroCoeffPt, cbuf_pt, invQ, invQincr_pos,
+                                invQincr_neg, 6);
 
   acc = (int32_t)(accL >> 22);
   acc = ssat24(acc);
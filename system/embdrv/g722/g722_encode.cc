@@ -31,6 +31,7 @@
 
 #include "g722_typedefs.h"
 #include "g722_enc_dec.h"
+#include "g722_simd.h"
 
 #if !defined(FALSE)
 #define FALSE 0
@@ -77,8 +78,6 @@ static void block4(g722_band_t *band, int d)
     int i;
     int sg[7];
     int ap1, ap2;
-    int sg0, sgi;
-    int sz;
 
     /* Block 4, RECONS */
     band->d[0] = d;
@@ -118,32 +117,9 @@ static void block4(g722_band_t *band, int d)
         ap1 = -wd3;
     band->ap[1] = ap1;
 
-    /* Block 4, UPZERO */
-    /* Block 4, FILTEZ */
-    wd1 = (d == 0)  ?  0  :  128;
+    /* Block 4, UPZERO, FILTEZ and DELAYA */
+    band->sz = g722_zero_filter_simd(band->b, band->bp, band->d);
 
-    sg0 = sg[0] = d >> 15;
-    for (i = 1;  i < 7;  i++)
-    {
-	sgi = band->d[i] >> 15;
-	wd2 = (sgi == sg0) ? wd1 : -wd1;
-        wd3 = (band->b[i]*32640) >> 15;
-        band->bp[i] = saturate(wd2 + wd3);
-    }
-
-    /* Block 4, DELAYA */
-    sz = 0;
-    for (i = 6;  i > 0;  i--)
-    {
-	int bi;
-
-        band->d[i] = band->d[i - 1];
-        bi = band->b[i] = band->bp[i];
-        wd1 = saturate(band->d[i] + band->d[i]);
-        sz += (bi*wd1) >> 15;
-    }
-    band->sz = sz;
-    
     for (i = 2;  i > 0;  i--)
     {
         band->r[i] = band->r[i - 1];
@@ -259,17 +235,32 @@ static int16_t qm2[4] =
 {
     -7408,  -1616,   7408,   1616
 };
-static int16_t qmf_coeffs[12] =
-{
-       3,  -11,   12,   32, -210,  951, 3876, -805,  362, -156,   53,  -11,
-};
 static int16_t ihn[3] = {0, 1, 0};
 static int16_t ihp[3] = {0, 3, 2};
 static int16_t wh[3] = {0, -214, 798};
 static int16_t rh2[4] = {2, 1, 2, 1};
 
-int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
-                       const int16_t amp[], int len)
+/* Block 1L, QUANTL */
+static __inline int quantl(int wd, int det)
+{
+    int i;
+    int n;
+    int half;
+
+    /* The decision levels are increasing, so the first one above wd, or 30 if
+       there is none, is found by bisection rather than by scanning them all.
+       The steps are conditional moves, as the branches would not predict. */
+    i = 1;
+    for (n = 30;  n > 1;  n -= half)
+    {
+        half = n >> 1;
+        i = (wd >= ((q6[i + half - 1]*det) >> 12))  ?  i + half  :  i;
+    }
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int encode_sample(g722_encode_state_t *s, int xlow, int xhigh)
 {
     int dlow;
     int dhigh;
@@ -284,154 +275,170 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     int eh;
     int mih;
     int i;
-    int j;
-    /* Low and high band PCM from the QMF */
-    int xlow;
-    int xhigh;
-    int g722_bytes;
-    /* Even and odd tap accumulators */
-    int sumeven;
-    int sumodd;
     int ihigh;
     int ilow;
     int code;
 
-    g722_bytes = 0;
-    xhigh = 0;
-    for (j = 0;  j < len;  )
-    {
-        if (s->itu_test_mode)
-        {
-            xlow =
-            xhigh = amp[j++] >> 1;
-        }
-        else
-        {
-            {
-                /* Apply the transmit QMF */
-                /* Shuffle the buffer down */
-                for (i = 0;  i < 22;  i++)
-                    s->x[i] = s->x[i + 2];
-                //TODO: if len is odd, then this can be a buffer overrun
-                s->x[22] = amp[j++];
-                s->x[23] = amp[j++];
-    
-                /* Discard every other QMF output */
-                sumeven = 0;
-                sumodd = 0;
-                for (i = 0;  i < 12;  i++)
-                {
-                    sumodd += s->x[2*i]*qmf_coeffs[i];
-                    sumeven += s->x[2*i + 1]*qmf_coeffs[11 - i];
-                }
-                /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
-                   to allow for us summing two filters, plus 1 to allow for the 15 bit
-                   input to the G.722 algorithm. */
-                xlow = (sumeven + sumodd) >> 14;
-                xhigh = (sumeven - sumodd) >> 14;
-
 #ifdef RUN_LIKE_REFERENCE_G722
-                /* The following lines are only used to verify bit-exactness
-                 * with reference implementation of G.722. Higher precision
-                 * is achieved without limiting the values.
-                 */
-                xlow = limitValues(xlow);
-                xhigh = limitValues(xhigh);
+    /* The following lines are only used to verify bit-exactness
+     * with reference implementation of G.722. Higher precision
+     * is achieved without limiting the values.
+     */
+    if (!s->itu_test_mode)
+    {
+        xlow = limitValues(xlow);
+        xhigh = limitValues(xhigh);
+    }
 #endif
-            }
-        }
-        /* Block 1L, SUBTRA */
-        el = saturate(xlow - s->band[0].s);
 
-        /* Block 1L, QUANTL */
-        wd = (el >= 0)  ?  el  :  -(el + 1);
+    /* Block 1L, SUBTRA */
+    el = saturate(xlow - s->band[0].s);
 
-        for (i = 1;  i < 30;  i++)
-        {
-            wd1 = (q6[i]*s->band[0].det) >> 12;
-            if (wd < wd1)
-                break;
-        }
-        ilow = (el < 0)  ?  iln[i]  :  ilp[i];
-
-        /* Block 2L, INVQAL */
-        ril = ilow >> 2;
-        wd2 = qm4[ril];
-        dlow = (s->band[0].det*wd2) >> 15;
-
-        /* Block 3L, LOGSCL */
-        il4 = rl42[ril];
-        wd = (s->band[0].nb*127) >> 7;
-        s->band[0].nb = wd + wl[il4];
-        if (s->band[0].nb < 0)
-            s->band[0].nb = 0;
-        else if (s->band[0].nb > 18432)
-            s->band[0].nb = 18432;
-
-        /* Block 3L, SCALEL */
-        wd1 = (s->band[0].nb >> 6) & 31;
-        wd2 = 8 - (s->band[0].nb >> 11);
+    /* Block 1L, QUANTL */
+    wd = (el >= 0)  ?  el  :  -(el + 1);
+
+    i = quantl(wd, s->band[0].det);
+    ilow = (el < 0)  ?  iln[i]  :  ilp[i];
+
+    /* Block 2L, INVQAL */
+    ril = ilow >> 2;
+    wd2 = qm4[ril];
+    dlow = (s->band[0].det*wd2) >> 15;
+
+    /* Block 3L, LOGSCL */
+    il4 = rl42[ril];
+    wd = (s->band[0].nb*127) >> 7;
+    s->band[0].nb = wd + wl[il4];
+    if (s->band[0].nb < 0)
+        s->band[0].nb = 0;
+    else if (s->band[0].nb > 18432)
+        s->band[0].nb = 18432;
+
+    /* Block 3L, SCALEL */
+    wd1 = (s->band[0].nb >> 6) & 31;
+    wd2 = 8 - (s->band[0].nb >> 11);
+    wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
+    s->band[0].det = wd3 << 2;
+
+    block4(&s->band[0], dlow);
+    {
+        int nb;
+
+        /* Block 1H, SUBTRA */
+        eh = saturate(xhigh - s->band[1].s);
+
+        /* Block 1H, QUANTH */
+        wd = (eh >= 0)  ?  eh  :  -(eh + 1);
+        wd1 = (564*s->band[1].det) >> 12;
+        mih = (wd >= wd1)  ?  2  :  1;
+        ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
+
+        /* Block 2H, INVQAH */
+        wd2 = qm2[ihigh];
+        dhigh = (s->band[1].det*wd2) >> 15;
+
+        /* Block 3H, LOGSCH */
+        ih2 = rh2[ihigh];
+        wd = (s->band[1].nb*127) >> 7;
+
+        nb = wd + wh[ih2];
+        if (nb < 0)
+            nb = 0;
+        else if (nb > 22528)
+            nb = 22528;
+        s->band[1].nb = nb;
+
+        /* Block 3H, SCALEH */
+        wd1 = (s->band[1].nb >> 6) & 31;
+        wd2 = 10 - (s->band[1].nb >> 11);
         wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-        s->band[0].det = wd3 << 2;
+        s->band[1].det = wd3 << 2;
 
-        block4(&s->band[0], dlow);
-        {
-	    int nb;
-
-            /* Block 1H, SUBTRA */
-            eh = saturate(xhigh - s->band[1].s);
-
-            /* Block 1H, QUANTH */
-            wd = (eh >= 0)  ?  eh  :  -(eh + 1);
-            wd1 = (564*s->band[1].det) >> 12;
-            mih = (wd >= wd1)  ?  2  :  1;
-            ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
-
-            /* Block 2H, INVQAH */
-            wd2 = qm2[ihigh];
-            dhigh = (s->band[1].det*wd2) >> 15;
-
-            /* Block 3H, LOGSCH */
-            ih2 = rh2[ihigh];
-            wd = (s->band[1].nb*127) >> 7;
-
-            nb = wd + wh[ih2];
-            if (nb < 0)
-                nb = 0;
-            else if (nb > 22528)
-                nb = 22528;
-	    s->band[1].nb = nb;
-
-            /* Block 3H, SCALEH */
-            wd1 = (s->band[1].nb >> 6) & 31;
-            wd2 = 10 - (s->band[1].nb >> 11);
-            wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-            s->band[1].det = wd3 << 2;
-
-            block4(&s->band[1], dhigh);
+        block4(&s->band[1], dhigh);
 #if   BITS_PER_SAMPLE == 8
-            code = ((ihigh << 6) | ilow);
+        code = ((ihigh << 6) | ilow);
 #elif BITS_PER_SAMPLE == 7
-            code = ((ihigh << 6) | ilow) >> 1;
+        code = ((ihigh << 6) | ilow) >> 1;
 #elif BITS_PER_SAMPLE == 6
-            code = ((ihigh << 6) | ilow) >> 2;
+        code = ((ihigh << 6) | ilow) >> 2;
 #endif
-        }
+    }
+    return code;
+}
+/*- End of function --------------------------------------------------------*/
 
+static __inline int put_code(g722_encode_state_t *s, uint8_t g722_data[],
+                             int g722_bytes, int code)
+{
 #if PACKED_OUTPUT == 1
-            /* Pack the code bits */
-            s->out_buffer |= (code << s->out_bits);
-            s->out_bits += s->bits_per_sample;
-            if (s->out_bits >= 8)
-            {
-                g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
-                s->out_bits -= 8;
-                s->out_buffer >>= 8;
-            }
+    /* Pack the code bits */
+    s->out_buffer |= (code << s->out_bits);
+    s->out_bits += s->bits_per_sample;
+    if (s->out_bits >= 8)
+    {
+        g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
+        s->out_bits -= 8;
+        s->out_buffer >>= 8;
+    }
 #else
-            g722_data[g722_bytes++] = (uint8_t) code;
+    g722_data[g722_bytes++] = (uint8_t) code;
 #endif
+    return g722_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Sample pairs run through the transmit QMF at a time */
+#define QMF_BLOCK_PAIRS (80)
+
+int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
+                       const int16_t amp[], int len)
+{
+    /* QMF history followed by the input of the block */
+    int16_t x[G722_QMF_HISTORY + 2*QMF_BLOCK_PAIRS];
+    /* Low and high band PCM from the QMF */
+    int xlow[QMF_BLOCK_PAIRS];
+    int xhigh[QMF_BLOCK_PAIRS];
+    int g722_bytes;
+    int pairs;
+    int band;
+    int i;
+    int j;
+
+    g722_bytes = 0;
+    if (s->itu_test_mode)
+    {
+        for (j = 0;  j < len;  j++)
+        {
+            band = amp[j] >> 1;
+            g722_bytes = put_code(s, g722_data, g722_bytes,
+                                  encode_sample(s, band, band));
+        }
+        return g722_bytes;
+    }
+
+    /* Apply the transmit QMF a block at a time, from a linear copy of the
+       history and the input rather than shuffling the history down for each
+       sample pair. An odd trailing sample has no pair and is not encoded. */
+    for (i = 0;  i < G722_QMF_HISTORY;  i++)
+        x[i] = (int16_t) s->x[i + 2];
+    for (j = 0;  j + 1 < len;  j += 2*pairs)
+    {
+        pairs = (len - j) >> 1;
+        if (pairs > QMF_BLOCK_PAIRS)
+            pairs = QMF_BLOCK_PAIRS;
+        memcpy(&x[G722_QMF_HISTORY], &amp[j], 2*pairs*sizeof(x[0]));
+        g722_qmf_tx_simd(x, pairs, xlow, xhigh);
+        for (i = 0;  i < pairs;  i++)
+        {
+            g722_bytes = put_code(s, g722_data, g722_bytes,
+                                  encode_sample(s, xlow[i], xhigh[i]));
+        }
+        s->x[0] = x[2*pairs - 2];
+        s->x[1] = x[2*pairs - 1];
+        memmove(x, &x[2*pairs], G722_QMF_HISTORY*sizeof(x[0]));
     }
+    for (i = 0;  i < G722_QMF_HISTORY;  i++)
+        s->x[i + 2] = x[i];
     return g722_bytes;
 }
 /*- End of function --------------------------------------------------------*/
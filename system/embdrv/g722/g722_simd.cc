@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SIMD kernels of the G.722 encoder, with SSE4.1 (selected at runtime) or
+ * NEON. The QMF products of 16 bits samples and coefficients are summed on 32
+ * bits without overflow, as in the scalar function, and the zero filter taps
+ * are computed lane by lane with the saturations of the scalar function, so
+ * the outputs are exact.
+ */
+
+#include "g722_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define G722_SIMD_SSE41
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define G722_SIMD_NEON
+#endif
+
+static __inline int16_t saturate(int32_t amp)
+{
+    int16_t amp16;
+
+    /* Hopefully this is optimised for the common case - not clipping */
+    amp16 = (int16_t) amp;
+    if (amp == amp16)
+        return amp16;
+    if (amp > 0x7FFF)
+        return  0x7FFF;
+    return  0x8000;
+}
+/*- End of function --------------------------------------------------------*/
+
+static const int16_t qmf_coeffs[12] =
+{
+       3,  -11,   12,   32, -210,  951, 3876, -805,  362, -156,   53,  -11,
+};
+
+void g722_qmf_tx(const int16_t *x, int num_pairs, int xlow[], int xhigh[])
+{
+    int i;
+    int j;
+    /* Even and odd tap accumulators */
+    int sumeven;
+    int sumodd;
+
+    for (j = 0;  j < num_pairs;  j++, x += 2)
+    {
+        /* Discard every other QMF output */
+        sumeven = 0;
+        sumodd = 0;
+        for (i = 0;  i < 12;  i++)
+        {
+            sumodd += x[2*i]*qmf_coeffs[i];
+            sumeven += x[2*i + 1]*qmf_coeffs[11 - i];
+        }
+        /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
+           to allow for us summing two filters, plus 1 to allow for the 15 bit
+           input to the G.722 algorithm. */
+        xlow[j] = (sumeven + sumodd) >> 14;
+        xhigh[j] = (sumeven - sumodd) >> 14;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_zero_filter(int b[7], int bp[7], int d[7])
+{
+    int wd1;
+    int wd2;
+    int wd3;
+    int i;
+    int sg0;
+    int sgi;
+    int sz;
+
+    /* Block 4, UPZERO */
+    /* Block 4, FILTEZ */
+    wd1 = (d[0] == 0)  ?  0  :  128;
+
+    sg0 = d[0] >> 15;
+    for (i = 1;  i < 7;  i++)
+    {
+        sgi = d[i] >> 15;
+        wd2 = (sgi == sg0) ? wd1 : -wd1;
+        wd3 = (b[i]*32640) >> 15;
+        bp[i] = saturate(wd2 + wd3);
+    }
+
+    /* Block 4, DELAYA */
+    sz = 0;
+    for (i = 6;  i > 0;  i--)
+    {
+        int bi;
+
+        d[i] = d[i - 1];
+        bi = b[i] = bp[i];
+        wd1 = saturate(d[i] + d[i]);
+        sz += (bi*wd1) >> 15;
+    }
+    return sz;
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(G722_SIMD_SSE41) || defined(G722_SIMD_NEON)
+/* Coefficients interleaved to match the odd and even taps of the window,
+   with the odd taps negated for the difference of the two filters. */
+static const int16_t qmf_sum_coeffs[24] =
+{
+       3,  -11,  -11,   53,   12, -156,   32,  362,
+    -210, -805,  951, 3876, 3876,  951, -805, -210,
+     362,   32, -156,   12,   53,  -11,  -11,    3,
+};
+static const int16_t qmf_diff_coeffs[24] =
+{
+      -3,  -11,   11,   53,  -12, -156,  -32,  362,
+     210, -805, -951, 3876, -3876, 951,  805, -210,
+    -362,   32,  156,   12,  -53,  -11,   11,    3,
+};
+#endif
+
+#if defined(G722_SIMD_SSE41)
+__attribute__((target("sse4.1")))
+static void g722_qmf_tx_sse41(const int16_t *x, int num_pairs, int xlow[],
+                              int xhigh[])
+{
+    const __m128i *sum_coeffs = (const __m128i *) qmf_sum_coeffs;
+    const __m128i *diff_coeffs = (const __m128i *) qmf_diff_coeffs;
+    __m128i s0 = _mm_loadu_si128(sum_coeffs);
+    __m128i s1 = _mm_loadu_si128(sum_coeffs + 1);
+    __m128i s2 = _mm_loadu_si128(sum_coeffs + 2);
+    __m128i d0 = _mm_loadu_si128(diff_coeffs);
+    __m128i d1 = _mm_loadu_si128(diff_coeffs + 1);
+    __m128i d2 = _mm_loadu_si128(diff_coeffs + 2);
+    int j;
+
+    for (j = 0;  j < num_pairs;  j++, x += 2)
+    {
+        __m128i w0 = _mm_loadu_si128((const __m128i *) x);
+        __m128i w1 = _mm_loadu_si128((const __m128i *) (x + 8));
+        __m128i w2 = _mm_loadu_si128((const __m128i *) (x + 16));
+        __m128i sum = _mm_add_epi32(_mm_madd_epi16(w0, s0),
+                                    _mm_add_epi32(_mm_madd_epi16(w1, s1),
+                                                  _mm_madd_epi16(w2, s2)));
+        __m128i diff = _mm_add_epi32(_mm_madd_epi16(w0, d0),
+                                     _mm_add_epi32(_mm_madd_epi16(w1, d1),
+                                                   _mm_madd_epi16(w2, d2)));
+        /* Reduce to the sum in lane 0 and the difference in lane 1 */
+        __m128i acc = _mm_add_epi32(_mm_unpacklo_epi32(sum, diff),
+                                    _mm_unpackhi_epi32(sum, diff));
+        acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+        acc = _mm_srai_epi32(acc, 14);
+        xlow[j] = _mm_cvtsi128_si32(acc);
+        xhigh[j] = _mm_cvtsi128_si32(_mm_srli_si128(acc, 4));
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Saturate the 4 lanes to 16 bits */
+__attribute__((target("sse4.1")))
+static __inline __m128i saturate_sse41(__m128i amp)
+{
+    return _mm_cvtepi16_epi32(_mm_packs_epi32(amp, amp));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The taps 1 to 4 are in the low vectors, and the taps 5 and 6 in the two
+   lower lanes of the high vectors, the upper lanes of which are zero. */
+__attribute__((target("sse4.1")))
+static int g722_zero_filter_sse41(int b[7], int bp[7], int d[7])
+{
+    __m128i wd1 = _mm_set1_epi32((d[0] == 0)  ?  0  :  128);
+    __m128i nwd1 = _mm_sub_epi32(_mm_setzero_si128(), wd1);
+    __m128i sg0 = _mm_set1_epi32(d[0] >> 15);
+    __m128i k = _mm_set1_epi32(32640);
+    __m128i d_lo = _mm_loadu_si128((const __m128i *) (d + 1));
+    __m128i d_hi = _mm_loadl_epi64((const __m128i *) (d + 5));
+    __m128i b_lo = _mm_loadu_si128((const __m128i *) (b + 1));
+    __m128i b_hi = _mm_loadl_epi64((const __m128i *) (b + 5));
+    /* The differences once shifted down by DELAYA */
+    __m128i n_lo = _mm_loadu_si128((const __m128i *) d);
+    __m128i n_hi = _mm_loadl_epi64((const __m128i *) (d + 4));
+    __m128i wd2_lo;
+    __m128i wd2_hi;
+    __m128i bp_lo;
+    __m128i bp_hi;
+    __m128i sz;
+
+    /* Block 4, UPZERO */
+    wd2_lo = _mm_blendv_epi8(nwd1, wd1,
+                             _mm_cmpeq_epi32(_mm_srai_epi32(d_lo, 15), sg0));
+    wd2_hi = _mm_blendv_epi8(nwd1, wd1,
+                             _mm_cmpeq_epi32(_mm_srai_epi32(d_hi, 15), sg0));
+    bp_lo = saturate_sse41(_mm_add_epi32(
+        wd2_lo, _mm_srai_epi32(_mm_mullo_epi32(b_lo, k), 15)));
+    bp_hi = saturate_sse41(_mm_add_epi32(
+        wd2_hi, _mm_srai_epi32(_mm_mullo_epi32(b_hi, k), 15)));
+    _mm_storeu_si128((__m128i *) (bp + 1), bp_lo);
+    _mm_storel_epi64((__m128i *) (bp + 5), bp_hi);
+
+    /* Block 4, DELAYA */
+    _mm_storeu_si128((__m128i *) (b + 1), bp_lo);
+    _mm_storel_epi64((__m128i *) (b + 5), bp_hi);
+    _mm_storeu_si128((__m128i *) (d + 1), n_lo);
+    _mm_storel_epi64((__m128i *) (d + 5), n_hi);
+
+    /* Block 4, FILTEZ */
+    sz = _mm_add_epi32(
+        _mm_srai_epi32(_mm_mullo_epi32(
+            bp_lo, saturate_sse41(_mm_add_epi32(n_lo, n_lo))), 15),
+        _mm_srai_epi32(_mm_mullo_epi32(
+            bp_hi, saturate_sse41(_mm_add_epi32(n_hi, n_hi))), 15));
+    sz = _mm_add_epi32(sz, _mm_srli_si128(sz, 8));
+    sz = _mm_add_epi32(sz, _mm_srli_si128(sz, 4));
+    return _mm_cvtsi128_si32(sz);
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+#if defined(G722_SIMD_NEON)
+static void g722_qmf_tx_neon(const int16_t *x, int num_pairs, int xlow[],
+                             int xhigh[])
+{
+    int16x8_t s0 = vld1q_s16(qmf_sum_coeffs);
+    int16x8_t s1 = vld1q_s16(qmf_sum_coeffs + 8);
+    int16x8_t s2 = vld1q_s16(qmf_sum_coeffs + 16);
+    int16x8_t d0 = vld1q_s16(qmf_diff_coeffs);
+    int16x8_t d1 = vld1q_s16(qmf_diff_coeffs + 8);
+    int16x8_t d2 = vld1q_s16(qmf_diff_coeffs + 16);
+    int j;
+
+    for (j = 0;  j < num_pairs;  j++, x += 2)
+    {
+        int16x8_t w0 = vld1q_s16(x);
+        int16x8_t w1 = vld1q_s16(x + 8);
+        int16x8_t w2 = vld1q_s16(x + 16);
+        int32x4_t sum = vmull_s16(vget_low_s16(w0), vget_low_s16(s0));
+        int32x4_t diff = vmull_s16(vget_low_s16(w0), vget_low_s16(d0));
+
+        sum = vmlal_high_s16(sum, w0, s0);
+        sum = vmlal_s16(sum, vget_low_s16(w1), vget_low_s16(s1));
+        sum = vmlal_high_s16(sum, w1, s1);
+        sum = vmlal_s16(sum, vget_low_s16(w2), vget_low_s16(s2));
+        sum = vmlal_high_s16(sum, w2, s2);
+        diff = vmlal_high_s16(diff, w0, d0);
+        diff = vmlal_s16(diff, vget_low_s16(w1), vget_low_s16(d1));
+        diff = vmlal_high_s16(diff, w1, d1);
+        diff = vmlal_s16(diff, vget_low_s16(w2), vget_low_s16(d2));
+        diff = vmlal_high_s16(diff, w2, d2);
+        xlow[j] = vaddvq_s32(sum) >> 14;
+        xhigh[j] = vaddvq_s32(diff) >> 14;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Saturate the 4 lanes to 16 bits */
+static __inline int32x4_t saturate_neon(int32x4_t amp)
+{
+    return vmovl_s16(vqmovn_s32(amp));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The taps 1 to 4 are in the low vectors, and the taps 5 and 6 in the two
+   lower lanes of the high vectors, the upper lanes of which are zero. */
+static int g722_zero_filter_neon(int b[7], int bp[7], int d[7])
+{
+    int32x4_t wd1 = vdupq_n_s32((d[0] == 0)  ?  0  :  128);
+    int32x4_t nwd1 = vnegq_s32(wd1);
+    int32x4_t sg0 = vdupq_n_s32(d[0] >> 15);
+    int32x2_t zero = vdup_n_s32(0);
+    int32x4_t d_lo = vld1q_s32(d + 1);
+    int32x4_t d_hi = vcombine_s32(vld1_s32(d + 5), zero);
+    int32x4_t b_lo = vld1q_s32(b + 1);
+    int32x4_t b_hi = vcombine_s32(vld1_s32(b + 5), zero);
+    /* The differences once shifted down by DELAYA */
+    int32x4_t n_lo = vld1q_s32(d);
+    int32x4_t n_hi = vcombine_s32(vld1_s32(d + 4), zero);
+    int32x4_t wd2_lo;
+    int32x4_t wd2_hi;
+    int32x4_t bp_lo;
+    int32x4_t bp_hi;
+    int32x4_t sz;
+
+    /* Block 4, UPZERO */
+    wd2_lo = vbslq_s32(vceqq_s32(vshrq_n_s32(d_lo, 15), sg0), wd1, nwd1);
+    wd2_hi = vbslq_s32(vceqq_s32(vshrq_n_s32(d_hi, 15), sg0), wd1, nwd1);
+    bp_lo = saturate_neon(vaddq_s32(
+        wd2_lo, vshrq_n_s32(vmulq_n_s32(b_lo, 32640), 15)));
+    bp_hi = saturate_neon(vaddq_s32(
+        wd2_hi, vshrq_n_s32(vmulq_n_s32(b_hi, 32640), 15)));
+    vst1q_s32(bp + 1, bp_lo);
+    vst1_s32(bp + 5, vget_low_s32(bp_hi));
+
+    /* Block 4, DELAYA */
+    vst1q_s32(b + 1, bp_lo);
+    vst1_s32(b + 5, vget_low_s32(bp_hi));
+    vst1q_s32(d + 1, n_lo);
+    vst1_s32(d + 5, vget_low_s32(n_hi));
+
+    /* Block 4, FILTEZ */
+    sz = vaddq_s32(
+        vshrq_n_s32(vmulq_s32(bp_lo, saturate_neon(vaddq_s32(n_lo, n_lo))), 15),
+        vshrq_n_s32(vmulq_s32(bp_hi, saturate_neon(vaddq_s32(n_hi, n_hi))), 15));
+    return vaddvq_s32(sz);
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+int g722_simd_supported(void)
+{
+#if defined(G722_SIMD_SSE41)
+    return __builtin_cpu_supports("sse4.1") ? 1 : 0;
+#elif defined(G722_SIMD_NEON)
+    return 1;
+#else
+    return 0;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+void g722_qmf_tx_simd(const int16_t *x, int num_pairs, int xlow[],
+                      int xhigh[])
+{
+#if defined(G722_SIMD_SSE41)
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        g722_qmf_tx_sse41(x, num_pairs, xlow, xhigh);
+        return;
+    }
+    g722_qmf_tx(x, num_pairs, xlow, xhigh);
+#elif defined(G722_SIMD_NEON)
+    g722_qmf_tx_neon(x, num_pairs, xlow, xhigh);
+#else
+    g722_qmf_tx(x, num_pairs, xlow, xhigh);
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_zero_filter_simd(int b[7], int bp[7], int d[7])
+{
+#if defined(G722_SIMD_SSE41)
+    if (__builtin_cpu_supports("sse4.1"))
+        return g722_zero_filter_sse41(b, bp, d);
+    return g722_zero_filter(b, bp, d);
+#elif defined(G722_SIMD_NEON)
+    return g722_zero_filter_neon(b, bp, d);
+#else
+    return g722_zero_filter(b, bp, d);
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
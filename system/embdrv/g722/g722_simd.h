@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Prototypes of the SIMD kernels of the G.722 encoder. The kernels are
+ * bit-exact with the scalar functions, and fall back to them when the CPU has
+ * no SIMD implementation.
+ */
+
+#if !defined(_G722_SIMD_H_)
+#define _G722_SIMD_H_
+
+#include <stdint.h>
+
+/* Samples of history of the transmit QMF, ahead of the new sample pair */
+#define G722_QMF_HISTORY 22
+
+/* Return 1 if the SIMD kernels have an implementation for the CPU */
+int g722_simd_supported(void);
+
+/* Apply the transmit QMF to num_pairs sample pairs. x holds the
+ * G722_QMF_HISTORY samples of history followed by the 2 * num_pairs input
+ * samples, the low and high band samples of pair i are written to xlow[i] and
+ * xhigh[i]. */
+void g722_qmf_tx(const int16_t *x, int num_pairs, int xlow[], int xhigh[]);
+void g722_qmf_tx_simd(const int16_t *x, int num_pairs, int xlow[],
+                      int xhigh[]);
+
+/* Block 4, UPZERO and DELAYA: update the 6 zero predictor coefficients b[1..6]
+ * (and bp[1..6]) from the sign of the differences, d[0] being the newest one,
+ * shift the differences down, and return the FILTEZ output sz. */
+int g722_zero_filter(int b[7], int bp[7], int d[7]);
+int g722_zero_filter_simd(int b[7], int bp[7], int d[7]);
+
+#endif
+/*- End of file ------------------------------------------------------------*/
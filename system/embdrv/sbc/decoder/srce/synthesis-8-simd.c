@@ -0,0 +1,221 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/** @file
+
+ 8-subband synthesis window computed on the 8 output samples at once, with
+ AVX2 (selected at runtime) or NEON. The results are bit-exact with
+ SynthWindow80_generated: each of the 10 taps of an output sample is the
+ product of a buffer sample and a coefficient, shifted as in the generated
+ code, and the sum is divided by 32768 and clipped to 16 bits.
+
+ @ingroup codec_internal
+ */
+
+/**@addgroup codec_internal*/
+/**@{*/
+
+#include "oi_codec_sbc_private.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SYNTH80_SIMD_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SYNTH80_SIMD_NEON
+#endif
+
+#if defined(SYNTH80_SIMD_AVX2) || defined(SYNTH80_SIMD_NEON)
+
+/* Coefficient of tap t of output sample o, the left shifts of the generated
+ * code are folded into the coefficients. Tap 2m of output sample o reads
+ * buffer[16m + {12, 5, 6, 7, 8, 7, 6, 5}[o]], tap 2m + 1 reads
+ * buffer[16m + {20, 11, 10, 9, -, 9, 10, 11}[o]]. */
+static const int32_t synth80Coeff[10][8] = {
+    {8235, -3263, -10385, -16457, 10445, 16913, 11167, 9293},
+    {-23167, 29293, 24995, 19083, 0, -8443, -10337, -6087},
+    {26479, -5229, -4944, -23641, -10594, 7374, 7668, 9976},
+    {-34794, 30835, 9161, -29015, 0, -9632, -30605, -23144},
+    {75192, -54042, -46126, -51556, 89196, 61788, 66536, 94684},
+    {34794, 63266, 55122, 49160, 0, 41020, 38212, 36110},
+    {26479, 34638, 18472, 24211, 10603, -18233, 22117, 11537},
+    {23167, 26663, 12705, 23469, 0, 9405, 16383, 3494},
+    {8235, 4555, 6239, 21223, 9539, 1499, 7543, 1370},
+    {0, 12419, 9251, 26913, 0, 26189, 8603, 8721},
+};
+
+/* Right shift of the product of tap t of output sample o */
+static const int32_t synth80Shift[10][8] = {
+    {3, 5, 6, 6, 4, 5, 4, 3}, {3, 5, 5, 5, 0, 7, 4, 2},
+    {2, 0, 0, 2, 0, 0, 0, 0}, {0, 3, 3, 4, 0, 0, 1, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0, 0, 0},
+    {2, 0, 0, 1, 0, 3, 4, 1}, {3, 2, 1, 2, 0, 1, 2, 0},
+    {3, 1, 3, 8, 4, 1, 3, 0}, {0, 4, 4, 6, 0, 7, 6, 7},
+};
+
+/* Byte shuffles of the 8 samples loaded at buffer[16m + 5] for the even taps,
+ * and at buffer[16m + 8] for the odd taps. The odd taps of output sample 4
+ * have no coefficient, and buffer[16m + 20] is inserted for output sample 0:
+ * the 8 samples from buffer[16m + 9] would read past the window for m = 4. */
+static const uint8_t synth80EvenShuffle[16] = {14, 15, 0, 1, 2, 3, 4, 5,
+                                               6,  7,  4, 5, 2, 3, 0, 1};
+static const uint8_t synth80OddShuffle[16] = {0x80, 0x80, 6, 7, 4, 5, 2, 3,
+                                              0x80, 0x80, 2, 3, 4, 5, 6, 7};
+
+#endif
+
+#if defined(SYNTH80_SIMD_AVX2)
+
+__attribute__((target("avx2"))) static __m256i SynthWindow80Tap_avx2(
+    __m256i acc, __m128i samples, OI_UINT tap) {
+  __m256i product = _mm256_mullo_epi32(
+      _mm256_cvtepi16_epi32(samples),
+      _mm256_loadu_si256((const __m256i*)synth80Coeff[tap]));
+  product = _mm256_srav_epi32(
+      product, _mm256_loadu_si256((const __m256i*)synth80Shift[tap]));
+  return _mm256_add_epi32(acc, product);
+}
+
+__attribute__((target("avx2"))) static void SynthWindow80_avx2(
+    int16_t* pcm, SBC_BUFFER_T const* RESTRICT buffer, OI_UINT strideShift) {
+  const __m128i evenShuffle =
+      _mm_loadu_si128((const __m128i*)synth80EvenShuffle);
+  const __m128i oddShuffle = _mm_loadu_si128((const __m128i*)synth80OddShuffle);
+  __m256i acc = _mm256_setzero_si256();
+  __m128i samples;
+  int16_t out[8];
+  OI_UINT m;
+  OI_UINT o;
+
+  for (m = 0; m < 5; m++) {
+    samples = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i*)(buffer + 16 * m + 5)), evenShuffle);
+    acc = SynthWindow80Tap_avx2(acc, samples, 2 * m);
+    samples = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i*)(buffer + 16 * m + 8)), oddShuffle);
+    if (m < 4) {
+      samples = _mm_insert_epi16(samples, buffer[16 * m + 20], 0);
+    }
+    acc = SynthWindow80Tap_avx2(acc, samples, 2 * m + 1);
+  }
+
+  /* Divide by 32768 rounding toward zero, as the generated code */
+  acc = _mm256_add_epi32(acc,
+                         _mm256_srli_epi32(_mm256_srai_epi32(acc, 31), 17));
+  acc = _mm256_srai_epi32(acc, 15);
+  samples = _mm_packs_epi32(_mm256_castsi256_si128(acc),
+                            _mm256_extracti128_si256(acc, 1));
+
+  if (strideShift == 0) {
+    _mm_storeu_si128((__m128i*)pcm, samples);
+    return;
+  }
+  _mm_storeu_si128((__m128i*)out, samples);
+  for (o = 0; o < 8; o++) {
+    pcm[o << strideShift] = out[o];
+  }
+}
+
+#elif defined(SYNTH80_SIMD_NEON)
+
+static int32x4x2_t SynthWindow80Tap_neon(int32x4x2_t acc, int16x8_t samples,
+                                         OI_UINT tap) {
+  int32x4_t lo = vmulq_s32(vmovl_s16(vget_low_s16(samples)),
+                           vld1q_s32(synth80Coeff[tap]));
+  int32x4_t hi = vmulq_s32(vmovl_s16(vget_high_s16(samples)),
+                           vld1q_s32(synth80Coeff[tap] + 4));
+
+  /* A shift by a negative count is an arithmetic right shift */
+  lo = vshlq_s32(lo, vnegq_s32(vld1q_s32(synth80Shift[tap])));
+  hi = vshlq_s32(hi, vnegq_s32(vld1q_s32(synth80Shift[tap] + 4)));
+  acc.val[0] = vaddq_s32(acc.val[0], lo);
+  acc.val[1] = vaddq_s32(acc.val[1], hi);
+  return acc;
+}
+
+/* Divide by 32768 rounding toward zero, as the generated code */
+static int16x4_t SynthWindow80Scale_neon(int32x4_t acc) {
+  acc = vaddq_s32(acc, vreinterpretq_s32_u32(vshrq_n_u32(
+                           vreinterpretq_u32_s32(vshrq_n_s32(acc, 31)), 17)));
+  return vqmovn_s32(vshrq_n_s32(acc, 15));
+}
+
+static void SynthWindow80_neon(int16_t* pcm,
+                               SBC_BUFFER_T const* RESTRICT buffer,
+                               OI_UINT strideShift) {
+  const uint8x16_t evenShuffle = vld1q_u8(synth80EvenShuffle);
+  const uint8x16_t oddShuffle = vld1q_u8(synth80OddShuffle);
+  int32x4x2_t acc = {{vdupq_n_s32(0), vdupq_n_s32(0)}};
+  int16x8_t samples;
+  int16_t out[8];
+  OI_UINT m;
+  OI_UINT o;
+
+  for (m = 0; m < 5; m++) {
+    samples = vreinterpretq_s16_u8(vqtbl1q_u8(
+        vreinterpretq_u8_s16(vld1q_s16(buffer + 16 * m + 5)), evenShuffle));
+    acc = SynthWindow80Tap_neon(acc, samples, 2 * m);
+    samples = vreinterpretq_s16_u8(vqtbl1q_u8(
+        vreinterpretq_u8_s16(vld1q_s16(buffer + 16 * m + 8)), oddShuffle));
+    if (m < 4) {
+      samples = vsetq_lane_s16(buffer[16 * m + 20], samples, 0);
+    }
+    acc = SynthWindow80Tap_neon(acc, samples, 2 * m + 1);
+  }
+
+  samples = vcombine_s16(SynthWindow80Scale_neon(acc.val[0]),
+                         SynthWindow80Scale_neon(acc.val[1]));
+  if (strideShift == 0) {
+    vst1q_s16(pcm, samples);
+    return;
+  }
+  vst1q_s16(out, samples);
+  for (o = 0; o < 8; o++) {
+    pcm[o << strideShift] = out[o];
+  }
+}
+
+#endif
+
+PRIVATE OI_BOOL SynthWindow80_simd_supported(void) {
+#if defined(SYNTH80_SIMD_AVX2)
+  return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#elif defined(SYNTH80_SIMD_NEON)
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+PRIVATE void SynthWindow80_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift) {
+#if defined(SYNTH80_SIMD_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    SynthWindow80_avx2(pcm, buffer, strideShift);
+    return;
+  }
+  SynthWindow80_generated(pcm, buffer, strideShift);
+#elif defined(SYNTH80_SIMD_NEON)
+  SynthWindow80_neon(pcm, buffer, strideShift);
+#else
+  SynthWindow80_generated(pcm, buffer, strideShift);
+#endif
+}
+
+/**@}*/
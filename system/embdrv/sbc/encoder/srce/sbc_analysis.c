@@ -27,6 +27,28 @@
 #include "sbc_encoder.h"
 /*#include <math.h>*/
 
+/* Set SBC_SIMD_WINDOW_ACCU to TRUE to compute the window with SSE2 or NEON.
+ * Only the default window with 16 bit coefficients (SBC_IPAQ_OPT) has a SIMD
+ * version. Both instruction sets are part of the baseline of the targets that
+ * define __SSE2__ or __ARM_NEON. */
+#ifndef SBC_SIMD_WINDOW_ACCU
+#if (SBC_ARM_ASM_OPT == FALSE) && (SBC_IPAQ_OPT == TRUE) && \
+    (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE) &&             \
+    (defined(__SSE2__) || defined(__ARM_NEON))
+#define SBC_SIMD_WINDOW_ACCU TRUE
+#else
+#define SBC_SIMD_WINDOW_ACCU FALSE
+#endif
+#endif /* SBC_SIMD_WINDOW_ACCU */
+
+#if (SBC_SIMD_WINDOW_ACCU == TRUE)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
 #define WIND_4_SUBBANDS_0_1                                              \
   (int32_t)0x01659F45 /* gas32CoeffFor4SBs[8] = -gas32CoeffFor4SBs[32] = \
@@ -208,6 +230,120 @@ static int16_t* s16X =
 #pragma arm section zidata
 #endif
 
+#if (SBC_SIMD_WINDOW_ACCU == TRUE)
+/* The window computes each s32DCTY[i] as the sum over the 5 taps j of
+ * coeff[j][i] * s16X[ChOffset + j * 2 * subbands + i]. The sums and
+ * differences of WINDOW_ACCU_x_0 and of the middle output are split into
+ * one tap per sample. */
+static const int16_t gas16WindowCoeff4[5][SUB_BANDS_4 * 2] = {
+    {0, WIND_4_SUBBANDS_1_0, WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_1_4},
+    {WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_1, WIND_4_SUBBANDS_2_1,
+     WIND_4_SUBBANDS_3_1, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_3,
+     WIND_4_SUBBANDS_2_3, WIND_4_SUBBANDS_1_3},
+    {WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_2, WIND_4_SUBBANDS_2_2,
+     WIND_4_SUBBANDS_3_2, WIND_4_SUBBANDS_4_2, WIND_4_SUBBANDS_3_2,
+     WIND_4_SUBBANDS_2_2, WIND_4_SUBBANDS_1_2},
+    {-WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_3, WIND_4_SUBBANDS_2_3,
+     WIND_4_SUBBANDS_3_3, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_1,
+     WIND_4_SUBBANDS_2_1, WIND_4_SUBBANDS_1_1},
+    {-WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_1_0},
+};
+
+static const int16_t gas16WindowCoeff8[5][SUB_BANDS_8 * 2] = {
+    {0, WIND_8_SUBBANDS_1_0, WIND_8_SUBBANDS_2_0, WIND_8_SUBBANDS_3_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_5_0, WIND_8_SUBBANDS_6_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_8_0, WIND_8_SUBBANDS_7_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_5_4, WIND_8_SUBBANDS_4_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_2_4, WIND_8_SUBBANDS_1_4},
+    {WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_1_3},
+    {WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_8_2,
+     WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_1_2},
+    {-WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_1_1},
+    {-WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_4, WIND_8_SUBBANDS_2_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_4_4, WIND_8_SUBBANDS_5_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_7_4, WIND_8_SUBBANDS_8_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_6_0, WIND_8_SUBBANDS_5_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_3_0, WIND_8_SUBBANDS_2_0,
+     WIND_8_SUBBANDS_1_0},
+};
+
+/* Compute the window of one channel into s32DCTY, 8 outputs at a time. The
+ * products of the 16 bit samples and coefficients are summed on 32 bits as in
+ * WINDOW_ACCU_x_y, so the result is the same. */
+static void SbcWindowAccuSimd(const int16_t* ps16X, const int16_t* ps16Coeff,
+                              int32_t s32NumOfSubBands) {
+  const int32_t s32Stride = s32NumOfSubBands * 2;
+  int32_t k;
+
+  for (k = 0; k < s32Stride; k += 8) {
+    const int16_t* x = ps16X + k;
+    const int16_t* c = ps16Coeff + k;
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i x0 = _mm_loadu_si128((const __m128i*)x);
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(x + s32Stride));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(x + 2 * s32Stride));
+    __m128i x3 = _mm_loadu_si128((const __m128i*)(x + 3 * s32Stride));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(x + 4 * s32Stride));
+    __m128i c0 = _mm_loadu_si128((const __m128i*)c);
+    __m128i c1 = _mm_loadu_si128((const __m128i*)(c + s32Stride));
+    __m128i c2 = _mm_loadu_si128((const __m128i*)(c + 2 * s32Stride));
+    __m128i c3 = _mm_loadu_si128((const __m128i*)(c + 3 * s32Stride));
+    __m128i c4 = _mm_loadu_si128((const __m128i*)(c + 4 * s32Stride));
+    __m128i lo, hi;
+
+    /* PMADDWD adds the products of two taps. None of the coefficients is
+     * -32768, so the sum does not overflow. */
+    lo = _mm_madd_epi16(_mm_unpacklo_epi16(x0, x1), _mm_unpacklo_epi16(c0, c1));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(x2, x3),
+                                          _mm_unpacklo_epi16(c2, c3)));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(x4, zero),
+                                          _mm_unpacklo_epi16(c4, zero)));
+    hi = _mm_madd_epi16(_mm_unpackhi_epi16(x0, x1), _mm_unpackhi_epi16(c0, c1));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(x2, x3),
+                                          _mm_unpackhi_epi16(c2, c3)));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(x4, zero),
+                                          _mm_unpackhi_epi16(c4, zero)));
+    _mm_storeu_si128((__m128i*)&s32DCTY[k], lo);
+    _mm_storeu_si128((__m128i*)&s32DCTY[k + 4], hi);
+#else
+    int16x8_t xj = vld1q_s16(x);
+    int16x8_t cj = vld1q_s16(c);
+    int32x4_t lo = vmull_s16(vget_low_s16(xj), vget_low_s16(cj));
+    int32x4_t hi = vmull_s16(vget_high_s16(xj), vget_high_s16(cj));
+    int32_t j;
+
+    for (j = 1; j < 5; j++) {
+      xj = vld1q_s16(x + j * s32Stride);
+      cj = vld1q_s16(c + j * s32Stride);
+      lo = vmlal_s16(lo, vget_low_s16(xj), vget_low_s16(cj));
+      hi = vmlal_s16(hi, vget_high_s16(xj), vget_high_s16(cj));
+    }
+    vst1q_s32(&s32DCTY[k], lo);
+    vst1q_s32(&s32DCTY[k + 4], hi);
+#endif
+  }
+}
+#endif /* SBC_SIMD_WINDOW_ACCU */
+
 /* This macro is for 4 subbands */
 #define SHIFTUP_X4                                      \
   {                                                     \
@@ -1036,6 +1172,13 @@ static int16_t* s16X =
     s32DCTY[4] = (int32_t)(s32Temp);                                        \
   }
 #endif
+#if (SBC_SIMD_WINDOW_ACCU == TRUE)
+#define WINDOW_PARTIAL_4 \
+  { SbcWindowAccuSimd(&s16X[ChOffset], gas16WindowCoeff4[0], SUB_BANDS_4); }
+
+#define WINDOW_PARTIAL_8 \
+  { SbcWindowAccuSimd(&s16X[ChOffset], gas16WindowCoeff8[0], SUB_BANDS_8); }
+#else
 #define WINDOW_PARTIAL_4 \
   {                      \
     WINDOW_ACCU_4_0;     \
@@ -1057,6 +1200,7 @@ static int16_t* s16X =
     WINDOW_ACCU_8_7_9;   \
     WINDOW_ACCU_8_8;     \
   }
+#endif /* SBC_SIMD_WINDOW_ACCU */
 #else
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
 #define WINDOW_ACCU_4(i)                                                     \
@@ -1205,7 +1349,7 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #if (SBC_IPAQ_OPT == TRUE)
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
   register int64_t s64Temp, s64Temp2;
-#else
+#elif (SBC_SIMD_WINDOW_ACCU == FALSE)
   register int32_t s32Temp, s32Temp2;
 #endif
 #else
@@ -1296,7 +1440,7 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #if (SBC_IPAQ_OPT == TRUE)
 #if (SBC_IS_64_MULT_IN_WINDOW_ACCU == TRUE)
   register int64_t s64Temp, s64Temp2;
-#else
+#elif (SBC_SIMD_WINDOW_ACCU == FALSE)
   register int32_t s32Temp, s32Temp2;
 #endif
 #else
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "aptXHDbtenc.h"
+#include "aptXbtenc.h"
+
+using ::benchmark::State;
+
+// One second of 44.1 kHz stereo samples, encoded 4 samples per channel at a
+// time as by the A2DP source
+#define NUM_SAMPLES 44100
+#define SAMPLES_PER_CODEWORD 4
+
+class BM_AptxEncoder : public ::benchmark::Fixture {
+ public:
+  void SetUp(State& st) override {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> noise(-8192, 8191);
+    pcm_.resize(2 * NUM_SAMPLES);
+    for (auto& sample : pcm_) {
+      sample = noise(gen);
+    }
+    ::benchmark::Fixture::SetUp(st);
+  }
+
+  void TearDown(State& st) override {
+    pcm_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  // Low 16 bits for aptX, sign extended 24 bits for aptX HD
+  std::vector<int32_t> pcm_;
+};
+
+BENCHMARK_F(BM_AptxEncoder, encode_aptx)(State& state) {
+  void* aptxbtenc = malloc(SizeofAptxbtenc());
+  for (auto _ : state) {
+    aptxbtenc_init(aptxbtenc, 0);
+    for (size_t i = 0; i < pcm_.size(); i += 2 * SAMPLES_PER_CODEWORD) {
+      uint32_t pcmL[SAMPLES_PER_CODEWORD];
+      uint32_t pcmR[SAMPLES_PER_CODEWORD];
+      for (size_t j = 0; j < SAMPLES_PER_CODEWORD; j++) {
+        pcmL[j] = pcm_[i + 2 * j];
+        pcmR[j] = pcm_[i + 2 * j + 1];
+      }
+      uint32_t codeword;
+      aptxbtenc_encodestereo(aptxbtenc, &pcmL, &pcmR, &codeword);
+      benchmark::DoNotOptimize(codeword);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_SAMPLES);
+  free(aptxbtenc);
+}
+
+BENCHMARK_F(BM_AptxEncoder, encode_aptxhd)(State& state) {
+  void* aptxhdbtenc = malloc(SizeofAptxhdbtenc());
+  for (auto _ : state) {
+    aptxhdbtenc_init(aptxhdbtenc, 0);
+    for (size_t i = 0; i < pcm_.size(); i += 2 * SAMPLES_PER_CODEWORD) {
+      uint32_t pcmL[SAMPLES_PER_CODEWORD];
+      uint32_t pcmR[SAMPLES_PER_CODEWORD];
+      for (size_t j = 0; j < SAMPLES_PER_CODEWORD; j++) {
+        pcmL[j] = pcm_[i + 2 * j] * 256;
+        pcmR[j] = pcm_[i + 2 * j + 1] * 256;
+      }
+      uint32_t codeword[2];
+      aptxhdbtenc_encodestereo(aptxhdbtenc, &pcmL, &pcmR, codeword);
+      benchmark::DoNotOptimize(codeword);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_SAMPLES);
+  free(aptxhdbtenc);
+}
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
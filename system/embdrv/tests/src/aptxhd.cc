@@ -22,9 +22,15 @@
 
 #include <fstream>
 #include <iostream>
+#include <random>
 
 #include "aptXHDbtenc.h"
 
+extern "C" {
+#include "AptxSimd.h"
+#include "Qmf.h"
+}
+
 #define BYTES_PER_CODEWORD 24
 
 class LibAptxHdEncTest : public ::testing::Test {
@@ -78,3 +84,83 @@ TEST_F(LibAptxHdEncTest, encode_fake_data) {
     ++idx;
   }
 }
+
+// The SIMD kernels must be bit-exact with the scalar functions
+class LibAptxHdEncSimdTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!aptxSimdSupported_HD()) {
+      GTEST_SKIP() << "No SIMD kernels for this CPU";
+    }
+  }
+
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int32_t> pcm{-(1 << 23), (1 << 23) - 1};
+};
+
+TEST_F(LibAptxHdEncSimdTest, qmf_outer_convolution) {
+  int32_t buffer[32];
+  for (int i = 0; i < 10000; i++) {
+    for (auto& sample : buffer) {
+      sample = pcm(gen);
+    }
+    int32_t expected[4] = {};
+    int32_t actual[4] = {};
+    AsmQmfConvO_HD(&buffer[15], &buffer[16], Qmf_outerCoeffs, expected);
+    AsmQmfConvO_HD_simd(&buffer[15], &buffer[16], Qmf_outerCoeffs, actual);
+    for (size_t j = 0; j < 4; j++) {
+      ASSERT_EQ(expected[j], actual[j]) << "iteration " << i;
+    }
+  }
+}
+
+TEST_F(LibAptxHdEncSimdTest, qmf_inner_convolution) {
+  int32_t buffer[32];
+  for (int i = 0; i < 10000; i++) {
+    for (auto& sample : buffer) {
+      sample = pcm(gen);
+    }
+    int32_t expected[2] = {};
+    int32_t actual[2] = {};
+    AsmQmfConvI_HD(&buffer[15], &buffer[16], Qmf_innerCoeffs, expected);
+    AsmQmfConvI_HD_simd(&buffer[15], &buffer[16], Qmf_innerCoeffs, actual);
+    for (size_t j = 0; j < 2; j++) {
+      ASSERT_EQ(expected[j], actual[j]) << "iteration " << i;
+    }
+  }
+}
+
+// The zero filters of the HL, LH and HH, and LL subbands have 6, 12 and 24
+// coefficients
+TEST_F(LibAptxHdEncSimdTest, zero_filter) {
+  std::bernoulli_distribution zero(0.1);
+  for (int32_t numCoeffs : {6, 12, 24}) {
+    for (int i = 0; i < 10000; i++) {
+      int32_t delayLine[48];
+      int32_t expected[24];
+      int32_t actual[24];
+      for (auto& sample : delayLine) {
+        sample = zero(gen) ? 0 : pcm(gen);
+      }
+      for (int32_t k = 0; k < numCoeffs; k++) {
+        expected[k] = actual[k] = pcm(gen);
+      }
+      int32_t invQ = zero(gen) ? 0 : pcm(gen);
+      int32_t invQincr_pos = invQ == 0 ? 0 : invQ < 0 ? -0x800000 : 0x800000;
+      int32_t invQincr_neg = 0x0080 - invQincr_pos;
+      invQincr_pos += 0x0080;
+      const int32_t* cbuf_pt = &delayLine[numCoeffs + i % numCoeffs];
+
+      int64_t expectedAcc = zeroFilterConv_HD(expected, cbuf_pt, invQ,
+                                              invQincr_pos, invQincr_neg,
+                                              numCoeffs);
+      int64_t actualAcc = zeroFilterConv_HD_simd(actual, cbuf_pt, invQ,
+                                                 invQincr_pos, invQincr_neg,
+                                                 numCoeffs);
+      ASSERT_EQ(expectedAcc, actualAcc) << numCoeffs << " coefficients";
+      for (int32_t k = 0; k < numCoeffs; k++) {
+        ASSERT_EQ(expected[k], actual[k]) << numCoeffs << " coefficients";
+      }
+    }
+  }
+}
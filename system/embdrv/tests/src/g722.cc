@@ -0,0 +1,155 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "g722_enc_dec.h"
+#include "g722_simd.h"
+
+#define NUM_SAMPLES 16000
+
+static uint32_t fnv1a(const std::vector<uint8_t>& data) {
+  uint32_t hash = 2166136261u;
+  for (uint8_t byte : data) {
+    hash = (hash ^ byte) * 16777619u;
+  }
+  return hash;
+}
+
+class LibG722EncTest : public ::testing::Test {
+ protected:
+  // One second of silence, full scale noise, a 1 kHz tone and a clipped
+  // 440 Hz tone at 16 kHz
+  void SetUp() override {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> noise(INT16_MIN, INT16_MAX);
+    signals_.assign(4, std::vector<int16_t>(NUM_SAMPLES));
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+      signals_[0][i] = 0;
+      signals_[1][i] = noise(gen);
+      signals_[2][i] = (int16_t)(12000 * sin(2 * M_PI * 1000 * i / 16000.0));
+      int clipped = (int)(60000 * sin(2 * M_PI * 440 * i / 16000.0));
+      signals_[3][i] =
+          clipped > INT16_MAX ? INT16_MAX
+                              : (clipped < INT16_MIN ? INT16_MIN : clipped);
+    }
+  }
+
+  std::vector<std::vector<int16_t>> signals_;
+};
+
+// The hashes of the encoded signals were recorded with the original SpanDSP
+// encoder, before the QMF and the predictor were vectorized
+TEST_F(LibG722EncTest, encode_matches_reference) {
+  const uint32_t expected_hashes[] = {0x0fbe9c9b, 0x623e90fd, 0x40f7d8f1,
+                                      0xc3a269d7};
+
+  for (size_t k = 0; k < signals_.size(); k++) {
+    g722_encode_state_t state;
+    g722_encode_init(&state, 64000, G722_PACKED);
+    std::vector<uint8_t> encoded(NUM_SAMPLES / 2);
+    ASSERT_EQ(g722_encode(&state, encoded.data(), signals_[k].data(),
+                          NUM_SAMPLES),
+              NUM_SAMPLES / 2);
+    ASSERT_EQ(fnv1a(encoded), expected_hashes[k]) << "signal " << k;
+  }
+}
+
+// The QMF history carries over between calls of any even length
+TEST_F(LibG722EncTest, encode_in_chunks) {
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int> pairs(0, 200);
+
+  for (const auto& signal : signals_) {
+    g722_encode_state_t whole;
+    g722_encode_init(&whole, 64000, G722_PACKED);
+    std::vector<uint8_t> expected(NUM_SAMPLES / 2);
+    g722_encode(&whole, expected.data(), signal.data(), NUM_SAMPLES);
+
+    g722_encode_state_t chunked;
+    g722_encode_init(&chunked, 64000, G722_PACKED);
+    std::vector<uint8_t> actual(NUM_SAMPLES / 2);
+    int offset = 0;
+    int encoded = 0;
+    while (offset < NUM_SAMPLES) {
+      int len = std::min(2 * pairs(gen), NUM_SAMPLES - offset);
+      encoded += g722_encode(&chunked, actual.data() + encoded,
+                             signal.data() + offset, len);
+      offset += len;
+    }
+    ASSERT_EQ(encoded, NUM_SAMPLES / 2);
+    ASSERT_EQ(actual, expected);
+  }
+}
+
+// The SIMD kernels must be bit-exact with the scalar functions
+class LibG722EncSimdTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!g722_simd_supported()) {
+      GTEST_SKIP() << "No SIMD kernels for this CPU";
+    }
+  }
+
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int> pcm16{INT16_MIN, INT16_MAX};
+};
+
+TEST_F(LibG722EncSimdTest, qmf_tx) {
+  int16_t buffer[G722_QMF_HISTORY + 2 * 64];
+  std::bernoulli_distribution full_scale(0.2);
+  for (int i = 0; i < 1000; i++) {
+    for (auto& sample : buffer) {
+      sample = full_scale(gen) ? (pcm16(gen) < 0 ? INT16_MIN : INT16_MAX)
+                               : pcm16(gen);
+    }
+    int expected_low[64], expected_high[64];
+    int actual_low[64], actual_high[64];
+    g722_qmf_tx(buffer, 64, expected_low, expected_high);
+    g722_qmf_tx_simd(buffer, 64, actual_low, actual_high);
+    for (size_t j = 0; j < 64; j++) {
+      ASSERT_EQ(expected_low[j], actual_low[j]) << "iteration " << i;
+      ASSERT_EQ(expected_high[j], actual_high[j]) << "iteration " << i;
+    }
+  }
+}
+
+TEST_F(LibG722EncSimdTest, zero_filter) {
+  std::bernoulli_distribution zero(0.1);
+  for (int i = 0; i < 10000; i++) {
+    int expected_b[7], expected_bp[7], expected_d[7];
+    int actual_b[7], actual_bp[7], actual_d[7];
+    for (int k = 0; k < 7; k++) {
+      expected_b[k] = actual_b[k] = pcm16(gen);
+      expected_bp[k] = actual_bp[k] = pcm16(gen);
+      expected_d[k] = actual_d[k] = zero(gen) ? 0 : pcm16(gen);
+    }
+
+    int expected_sz = g722_zero_filter(expected_b, expected_bp, expected_d);
+    int actual_sz = g722_zero_filter_simd(actual_b, actual_bp, actual_d);
+    ASSERT_EQ(expected_sz, actual_sz) << "iteration " << i;
+    for (int k = 0; k < 7; k++) {
+      ASSERT_EQ(expected_b[k], actual_b[k]) << "iteration " << i;
+      ASSERT_EQ(expected_bp[k], actual_bp[k]) << "iteration " << i;
+      ASSERT_EQ(expected_d[k], actual_d[k]) << "iteration " << i;
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "g722_enc_dec.h"
+#include "g722_simd.h"
+
+using ::benchmark::State;
+
+// One second of 16 kHz samples, encoded 10 ms at a time as by the hearing aid
+// source
+#define NUM_SAMPLES 16000
+#define SAMPLES_PER_FRAME 160
+
+class BM_G722Encoder : public ::benchmark::Fixture {
+ public:
+  void SetUp(State& st) override {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> noise(-8192, 8191);
+    pcm_.resize(G722_QMF_HISTORY + NUM_SAMPLES);
+    for (auto& sample : pcm_) {
+      sample = noise(gen);
+    }
+    ::benchmark::Fixture::SetUp(st);
+  }
+
+  void TearDown(State& st) override {
+    pcm_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<int16_t> pcm_;
+};
+
+BENCHMARK_F(BM_G722Encoder, encode)(State& state) {
+  std::vector<uint8_t> encoded(NUM_SAMPLES / 2);
+  for (auto _ : state) {
+    g722_encode_state_t encoder;
+    g722_encode_init(&encoder, 64000, G722_PACKED);
+    for (size_t i = 0; i < NUM_SAMPLES; i += SAMPLES_PER_FRAME) {
+      g722_encode(&encoder, &encoded[i / 2], &pcm_[i], SAMPLES_PER_FRAME);
+    }
+    benchmark::DoNotOptimize(encoded.data());
+  }
+}
+
+BENCHMARK_F(BM_G722Encoder, qmf_tx)(State& state) {
+  std::vector<int> xlow(NUM_SAMPLES / 2);
+  std::vector<int> xhigh(NUM_SAMPLES / 2);
+  for (auto _ : state) {
+    g722_qmf_tx(pcm_.data(), NUM_SAMPLES / 2, xlow.data(), xhigh.data());
+    benchmark::DoNotOptimize(xlow.data());
+    benchmark::DoNotOptimize(xhigh.data());
+  }
+}
+
+BENCHMARK_F(BM_G722Encoder, qmf_tx_simd)(State& state) {
+  std::vector<int> xlow(NUM_SAMPLES / 2);
+  std::vector<int> xhigh(NUM_SAMPLES / 2);
+  for (auto _ : state) {
+    g722_qmf_tx_simd(pcm_.data(), NUM_SAMPLES / 2, xlow.data(), xhigh.data());
+    benchmark::DoNotOptimize(xlow.data());
+    benchmark::DoNotOptimize(xhigh.data());
+  }
+}
+
+BENCHMARK_MAIN();
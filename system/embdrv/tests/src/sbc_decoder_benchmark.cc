@@ -0,0 +1,138 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "sbc_encoder.h"
+
+extern "C" {
+#include "oi_codec_sbc_private.h"
+}
+
+using ::benchmark::State;
+
+// One second of 44.1 kHz samples, in frames of 16 blocks of 8 subbands
+#define NUM_FRAMES 345
+#define SAMPLES_PER_FRAME 128
+
+// Frames encoded as by the A2DP source: joint stereo, loudness allocation,
+// bitpool 53
+class BM_SbcDecoder : public ::benchmark::Fixture {
+ public:
+  void SetUp(State& st) override {
+    SBC_ENC_PARAMS params;
+    memset(&params, 0, sizeof(params));
+    params.s16SamplingFreq = SBC_sf44100;
+    params.s16ChannelMode = SBC_JOINT_STEREO;
+    params.s16NumOfSubBands = 8;
+    params.s16NumOfBlocks = 16;
+    params.s16AllocationMethod = SBC_LOUDNESS;
+    params.u16BitRate = 328;
+    params.Format = SBC_FORMAT_GENERAL;
+    SBC_Encoder_Init(&params);
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> noise(-8192, 8191);
+    int16_t pcm[2 * SAMPLES_PER_FRAME];
+    uint8_t frame[512];
+    frames_.clear();
+    for (int i = 0; i < NUM_FRAMES; i++) {
+      for (auto& sample : pcm) {
+        sample = noise(gen);
+      }
+      uint32_t len = SBC_Encode(&params, pcm, frame);
+      frames_.insert(frames_.end(), frame, frame + len);
+    }
+    ::benchmark::Fixture::SetUp(st);
+  }
+
+  void TearDown(State& st) override {
+    frames_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<uint8_t> frames_;
+  uint32_t context_data_[CODEC_DATA_WORDS(2, SBC_CODEC_FAST_FILTER_BUFFERS)];
+  OI_CODEC_SBC_DECODER_CONTEXT context_;
+};
+
+BENCHMARK_F(BM_SbcDecoder, decode_frames)(State& state) {
+  for (auto _ : state) {
+    OI_CODEC_SBC_DecoderReset(&context_, context_data_, sizeof(context_data_),
+                              2, 2, FALSE);
+    const OI_BYTE* data = frames_.data();
+    uint32_t size = frames_.size();
+    while (size > 0) {
+      int16_t pcm[2 * SAMPLES_PER_FRAME];
+      uint32_t pcm_size = sizeof(pcm);
+      if (!OI_SUCCESS(OI_CODEC_SBC_DecodeFrame(&context_, &data, &size, pcm,
+                                               &pcm_size))) {
+        state.SkipWithError("Failed to decode frame");
+        return;
+      }
+      benchmark::DoNotOptimize(pcm);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_FRAMES);
+}
+
+class BM_SbcSynthesisWindow : public ::benchmark::Fixture {
+ public:
+  void SetUp(State& st) override {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> sample(-8192, 8191);
+    for (auto& value : buffer_) {
+      value = sample(gen);
+    }
+    ::benchmark::Fixture::SetUp(st);
+  }
+
+  // Windows of the 8-subband synthesis slide by 8 samples per block
+  SBC_BUFFER_T buffer_[80 + 8 * 16];
+};
+
+BENCHMARK_F(BM_SbcSynthesisWindow, window_80_generated)(State& state) {
+  int16_t pcm[8];
+  for (auto _ : state) {
+    for (size_t offset = 0; offset <= 8 * 16; offset += 8) {
+      SynthWindow80_generated(pcm, buffer_ + offset, 0);
+      benchmark::DoNotOptimize(pcm);
+    }
+  }
+}
+
+BENCHMARK_F(BM_SbcSynthesisWindow, window_80_simd)(State& state) {
+  int16_t pcm[8];
+  for (auto _ : state) {
+    for (size_t offset = 0; offset <= 8 * 16; offset += 8) {
+      SynthWindow80_simd(pcm, buffer_ + offset, 0);
+      benchmark::DoNotOptimize(pcm);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
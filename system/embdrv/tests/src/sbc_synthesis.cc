@@ -0,0 +1,91 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+extern "C" {
+#include "oi_codec_sbc_private.h"
+}
+
+// The sums of the generated synthesis window could overflow 32 bits with
+// larger samples, the samples of the synthesis buffer are much smaller.
+constexpr int kMaxSample = 8192;
+
+class SbcSynthesisTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!SynthWindow80_simd_supported()) {
+      GTEST_SKIP() << "No SIMD synthesis window for this CPU";
+    }
+  }
+
+  void window_cmp(const SBC_BUFFER_T buffer[80]) {
+    for (OI_UINT stride_shift = 0; stride_shift <= 1; stride_shift++) {
+      int16_t expected[16] = {};
+      int16_t actual[16] = {};
+      SynthWindow80_generated(expected, buffer, stride_shift);
+      SynthWindow80_simd(actual, buffer, stride_shift);
+      for (size_t i = 0; i < 16; i++) {
+        ASSERT_EQ(expected[i], actual[i])
+            << "sample " << i << ", stride shift " << stride_shift;
+      }
+    }
+  }
+};
+
+TEST_F(SbcSynthesisTest, window_80_random_samples) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> small(-256, 255);
+  std::uniform_int_distribution<int> large(-kMaxSample, kMaxSample);
+  SBC_BUFFER_T buffer[80];
+
+  for (int i = 0; i < 10000; i++) {
+    for (auto& sample : buffer) {
+      sample = (i % 2) ? large(gen) : small(gen);
+    }
+    window_cmp(buffer);
+  }
+}
+
+TEST_F(SbcSynthesisTest, window_80_clipped_samples) {
+  std::mt19937 gen(0);
+  std::bernoulli_distribution sign;
+  SBC_BUFFER_T buffer[80];
+
+  for (int i = 0; i < 10000; i++) {
+    for (auto& sample : buffer) {
+      sample = sign(gen) ? kMaxSample : -kMaxSample;
+    }
+    window_cmp(buffer);
+  }
+}
+
+TEST_F(SbcSynthesisTest, window_80_single_sample) {
+  SBC_BUFFER_T buffer[80];
+
+  for (size_t i = 0; i < 80; i++) {
+    for (int value : {-kMaxSample, -1, 1, kMaxSample}) {
+      for (auto& sample : buffer) {
+        sample = 0;
+      }
+      buffer[i] = value;
+      window_cmp(buffer);
+    }
+  }
+}
@@ -16,6 +16,50 @@
 
 #include <benchmark/benchmark.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark_allocations.h"
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+
+}  // namespace
+
+// Counts every heap allocation of the benchmark binary, so that benchmarks can
+// report how many allocations they make per packet
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t /* size */) noexcept {
+  std::free(p);
+}
+
+namespace bluetooth {
+
+uint64_t GetAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+}  // namespace bluetooth
+
+// Micro benchmarks of the os primitives, plus scenario benchmarks driving the HCI layer and the ACL scheduler through
+// fake HAL and controller. Scenario benchmarks use fixed iteration counts and report their latencies as p50_us/p99_us
+// counters, so that runs of two builds can be compared, e.g. with
+//   bluetooth_benchmark_gd --benchmark_out=<build>.json --benchmark_out_format=json
+// and google benchmark's tools/compare.py on the two files.
 int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
   if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace bluetooth {
+
+// Heap allocations made so far by all the threads of the benchmark binary,
+// counted by the operator new of benchmark.cc
+uint64_t GetAllocationCount();
+
+// Records the allocations made during a benchmark, per iteration, as the
+// |name| counter
+class AllocationCounter {
+ public:
+  AllocationCounter(::benchmark::State& state, std::string name)
+      : state_(state), name_(std::move(name)), start_(GetAllocationCount()) {}
+  ~AllocationCounter() {
+    state_.counters[name_] = ::benchmark::Counter(GetAllocationCount() - start_, ::benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  ::benchmark::State& state_;
+  std::string name_;
+  uint64_t start_;
+};
+
+}  // namespace bluetooth
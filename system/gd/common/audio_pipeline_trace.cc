@@ -0,0 +1,239 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/audio_pipeline_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace bluetooth {
+namespace common {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// More than the packets in flight between two stages
+constexpr size_t kNumTracedPackets = 64;
+constexpr uint16_t kInvalidHandle = 0xffff;
+constexpr size_t kL2capBasicHeaderSize = 4;
+constexpr size_t kRtpHeaderSize = 12;
+
+struct QueuedPacket {
+  uint16_t trace_id = 0;
+  Clock::time_point queued_at;
+};
+
+struct MediaPacket {
+  bool valid = false;
+  uint16_t sequence_number = 0;
+  // Start of the stage the packet is in
+  AudioPipelineTrace::Stage stage = AudioPipelineTrace::STACK;
+  Clock::time_point stage_start;
+};
+
+std::atomic_bool enabled{false};
+std::mutex mutex;
+AudioPipelineTrace::StageObserver observer;
+std::array<AudioPipelineTrace::StageStats, AudioPipelineTrace::NUM_STAGES> stage_stats;
+std::array<QueuedPacket, kNumTracedPackets> queued_packets;
+std::array<MediaPacket, kNumTracedPackets> media_packets;
+uint16_t next_trace_id = 1;
+std::atomic<uint16_t> media_handle{kInvalidHandle};
+std::atomic<uint16_t> media_remote_cid{0};
+
+uint64_t elapsed_us(Clock::time_point since, Clock::time_point now) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(now - since).count();
+}
+
+void record_locked(AudioPipelineTrace::Stage stage, uint64_t latency_us) {
+  auto& stats = stage_stats[stage];
+  stats.count++;
+  stats.total_us += latency_us;
+  stats.max_us = std::max(stats.max_us, latency_us);
+  const auto& bounds = AudioPipelineTrace::kBucketBoundsUs;
+  stats.buckets[std::upper_bound(bounds.begin(), bounds.end(), latency_us) - bounds.begin()]++;
+  if (observer) {
+    observer(stage, latency_us);
+  }
+}
+
+// Ends |stage| of the media packet |sequence_number|, and starts the next one
+void end_media_stage(uint16_t sequence_number, AudioPipelineTrace::Stage stage) {
+  if (!enabled) {
+    return;
+  }
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  MediaPacket& packet = media_packets[sequence_number % kNumTracedPackets];
+  if (!packet.valid || packet.sequence_number != sequence_number || packet.stage != stage) {
+    return;
+  }
+  record_locked(stage, elapsed_us(packet.stage_start, now));
+  if (stage == AudioPipelineTrace::CONTROLLER) {
+    packet.valid = false;
+    return;
+  }
+  packet.stage = static_cast<AudioPipelineTrace::Stage>(stage + 1);
+  packet.stage_start = now;
+}
+
+}  // namespace
+
+void AudioPipelineTrace::SetEnabled(bool enable) {
+  enabled = enable;
+}
+
+bool AudioPipelineTrace::IsEnabled() {
+  return enabled;
+}
+
+void AudioPipelineTrace::SetObserver(StageObserver stage_observer) {
+  std::lock_guard<std::mutex> lock(mutex);
+  observer = std::move(stage_observer);
+}
+
+const char* AudioPipelineTrace::StageText(Stage stage) {
+  switch (stage) {
+    case ENCODE:
+      return "encode";
+    case TX_QUEUE:
+      return "tx_queue";
+    case STACK:
+      return "stack";
+    case ACL_SCHEDULING:
+      return "acl_scheduling";
+    case CONTROLLER:
+      return "controller";
+    default:
+      return "unknown";
+  }
+}
+
+void AudioPipelineTrace::SetMediaChannel(uint16_t handle, uint16_t remote_cid) {
+  media_remote_cid = remote_cid;
+  media_handle = handle;
+}
+
+void AudioPipelineTrace::ClearMediaChannel() {
+  media_handle = kInvalidHandle;
+}
+
+bool AudioPipelineTrace::IsMediaHandle(uint16_t handle) {
+  return enabled && handle != kInvalidHandle && media_handle == handle;
+}
+
+bool AudioPipelineTrace::GetMediaSequenceNumber(const std::vector<uint8_t>& l2cap_pdu, uint16_t* sequence_number) {
+  if (l2cap_pdu.size() < kL2capBasicHeaderSize + kRtpHeaderSize) {
+    return false;
+  }
+  uint16_t cid = l2cap_pdu[2] | (l2cap_pdu[3] << 8);
+  if (cid != media_remote_cid) {
+    return false;
+  }
+  const uint8_t* rtp = &l2cap_pdu[kL2capBasicHeaderSize];
+  *sequence_number = (rtp[2] << 8) | rtp[3];
+  return true;
+}
+
+uint16_t AudioPipelineTrace::OnEncoded(uint64_t encode_latency_us) {
+  if (!enabled) {
+    return 0;
+  }
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  record_locked(ENCODE, encode_latency_us);
+  uint16_t trace_id = next_trace_id++;
+  if (next_trace_id == 0) {
+    next_trace_id = 1;
+  }
+  queued_packets[trace_id % kNumTracedPackets] = {trace_id, now};
+  return trace_id;
+}
+
+void AudioPipelineTrace::OnDequeued(uint16_t trace_id) {
+  if (!enabled || trace_id == 0) {
+    return;
+  }
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  QueuedPacket& packet = queued_packets[trace_id % kNumTracedPackets];
+  if (packet.trace_id != trace_id) {
+    return;
+  }
+  record_locked(TX_QUEUE, elapsed_us(packet.queued_at, now));
+  packet.trace_id = 0;
+}
+
+void AudioPipelineTrace::OnMediaPacketWritten(uint16_t sequence_number) {
+  if (!enabled) {
+    return;
+  }
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  media_packets[sequence_number % kNumTracedPackets] = {true, sequence_number, STACK, now};
+}
+
+void AudioPipelineTrace::OnAclBuffered(uint16_t sequence_number) {
+  end_media_stage(sequence_number, STACK);
+}
+
+void AudioPipelineTrace::OnAclSent(uint16_t sequence_number) {
+  end_media_stage(sequence_number, ACL_SCHEDULING);
+}
+
+void AudioPipelineTrace::OnAclCompleted(uint16_t sequence_number) {
+  end_media_stage(sequence_number, CONTROLLER);
+}
+
+AudioPipelineTrace::StageStats AudioPipelineTrace::GetStageStats(Stage stage) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stage_stats[stage];
+}
+
+std::string AudioPipelineTrace::ToString(const std::string& prefix) {
+  std::string s;
+  for (size_t i = 0; i < NUM_STAGES; i++) {
+    auto stage = static_cast<Stage>(i);
+    StageStats stats = GetStageStats(stage);
+    if (stats.count == 0) {
+      continue;
+    }
+    s += prefix + StageText(stage) + ": count:" + std::to_string(stats.count) +
+         " avg_us:" + std::to_string(stats.total_us / stats.count) + " max_us:" + std::to_string(stats.max_us) +
+         " histogram:";
+    for (size_t b = 0; b < stats.buckets.size(); b++) {
+      if (b != 0) {
+        s += "/";
+      }
+      s += std::to_string(stats.buckets[b]);
+    }
+    s += "\n";
+  }
+  return s;
+}
+
+void AudioPipelineTrace::Reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  stage_stats = {};
+  queued_packets = {};
+  media_packets = {};
+}
+
+}  // namespace common
+}  // namespace bluetooth
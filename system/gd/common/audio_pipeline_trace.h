@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+// Latency trace of the A2DP source media packets through the stack, with a histogram per stage:
+//   ENCODE:         from the tick of the encoder timer to the encoded packet queued for transmission
+//   TX_QUEUE:       time in the btif transmit queue, until AVDTP takes the packet
+//   STACK:          from AVDTP, which gives the packet its RTP sequence number, to the ACL scheduler
+//   ACL_SCHEDULING: from the ACL scheduler to the last fragment of the packet handed to the HCI layer
+//   CONTROLLER:     from the last fragment handed to the HCI layer to its Number Of Completed Packets
+// The packets are identified by a trace id up to AVDTP, carried in the event field of their BT_HDR, and by their
+// RTP sequence number below. Disabled by default; every call is a no-op until SetEnabled(true).
+// All the functions can be called from any thread.
+class AudioPipelineTrace {
+ public:
+  enum Stage : size_t { ENCODE, TX_QUEUE, STACK, ACL_SCHEDULING, CONTROLLER, NUM_STAGES };
+
+  // Exclusive upper bounds of the latency buckets; the last bucket holds the latencies above them
+  static constexpr std::array<uint32_t, 8> kBucketBoundsUs = {1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000};
+
+  struct StageStats {
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    std::array<uint64_t, kBucketBoundsUs.size() + 1> buckets = {};
+  };
+
+  // Called with every latency recorded, e.g. to export them as trace counters
+  using StageObserver = std::function<void(Stage stage, uint64_t latency_us)>;
+
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+  static void SetObserver(StageObserver observer);
+  static const char* StageText(Stage stage);
+
+  // The ACL connection and remote L2CAP channel carrying the traced media packets
+  static void SetMediaChannel(uint16_t handle, uint16_t remote_cid);
+  static void ClearMediaChannel();
+  static bool IsMediaHandle(uint16_t handle);
+  // Reads the RTP sequence number of |l2cap_pdu| when it is a media packet of the media channel
+  static bool GetMediaSequenceNumber(const std::vector<uint8_t>& l2cap_pdu, uint16_t* sequence_number);
+
+  // Returns the trace id of the packet, 0 when tracing is disabled
+  static uint16_t OnEncoded(uint64_t encode_latency_us);
+  static void OnDequeued(uint16_t trace_id);
+  static void OnMediaPacketWritten(uint16_t sequence_number);
+  static void OnAclBuffered(uint16_t sequence_number);
+  static void OnAclSent(uint16_t sequence_number);
+  static void OnAclCompleted(uint16_t sequence_number);
+
+  static StageStats GetStageStats(Stage stage);
+  // One line per stage with samples, each starting with |prefix|
+  static std::string ToString(const std::string& prefix = "");
+  static void Reset();
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/audio_pipeline_trace.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+class AudioPipelineTraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    AudioPipelineTrace::Reset();
+    AudioPipelineTrace::SetEnabled(true);
+  }
+
+  void TearDown() override {
+    AudioPipelineTrace::SetEnabled(false);
+    AudioPipelineTrace::SetObserver(nullptr);
+    AudioPipelineTrace::ClearMediaChannel();
+    AudioPipelineTrace::Reset();
+  }
+};
+
+TEST_F(AudioPipelineTraceTest, disabled_trace_records_nothing) {
+  AudioPipelineTrace::SetEnabled(false);
+  EXPECT_EQ(0, AudioPipelineTrace::OnEncoded(100));
+  AudioPipelineTrace::OnMediaPacketWritten(1);
+  AudioPipelineTrace::OnAclBuffered(1);
+  EXPECT_EQ(0u, AudioPipelineTrace::GetStageStats(AudioPipelineTrace::ENCODE).count);
+  EXPECT_EQ(0u, AudioPipelineTrace::GetStageStats(AudioPipelineTrace::STACK).count);
+}
+
+TEST_F(AudioPipelineTraceTest, encode_and_tx_queue) {
+  uint16_t trace_id = AudioPipelineTrace::OnEncoded(3000);
+  EXPECT_NE(0, trace_id);
+  AudioPipelineTrace::OnDequeued(trace_id);
+  // A packet is only dequeued once
+  AudioPipelineTrace::OnDequeued(trace_id);
+
+  auto encode = AudioPipelineTrace::GetStageStats(AudioPipelineTrace::ENCODE);
+  EXPECT_EQ(1u, encode.count);
+  EXPECT_EQ(3000u, encode.max_us);
+  EXPECT_EQ(1u, encode.buckets[2]);
+  EXPECT_EQ(1u, AudioPipelineTrace::GetStageStats(AudioPipelineTrace::TX_QUEUE).count);
+}
+
+TEST_F(AudioPipelineTraceTest, media_packet_stages_in_order) {
+  std::vector<AudioPipelineTrace::Stage> observed;
+  AudioPipelineTrace::SetObserver(
+      [&observed](AudioPipelineTrace::Stage stage, uint64_t) { observed.push_back(stage); });
+
+  AudioPipelineTrace::OnMediaPacketWritten(7);
+  // Out of order stages are ignored
+  AudioPipelineTrace::OnAclSent(7);
+  AudioPipelineTrace::OnAclBuffered(7);
+  AudioPipelineTrace::OnAclSent(7);
+  AudioPipelineTrace::OnAclCompleted(7);
+  AudioPipelineTrace::OnAclCompleted(7);
+
+  std::vector<AudioPipelineTrace::Stage> expected = {
+      AudioPipelineTrace::STACK, AudioPipelineTrace::ACL_SCHEDULING, AudioPipelineTrace::CONTROLLER};
+  EXPECT_EQ(expected, observed);
+}
+
+TEST_F(AudioPipelineTraceTest, media_sequence_number_of_media_channel) {
+  AudioPipelineTrace::SetMediaChannel(0x0002, 0x0041);
+  EXPECT_TRUE(AudioPipelineTrace::IsMediaHandle(0x0002));
+  EXPECT_FALSE(AudioPipelineTrace::IsMediaHandle(0x0003));
+
+  // L2CAP basic header for CID 0x0041, then an RTP header with sequence number 0x1234
+  std::vector<uint8_t> pdu = {0x0d, 0x00, 0x41, 0x00, 0x80, 0x60, 0x12, 0x34, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+  uint16_t sequence_number = 0;
+  EXPECT_TRUE(AudioPipelineTrace::GetMediaSequenceNumber(pdu, &sequence_number));
+  EXPECT_EQ(0x1234, sequence_number);
+
+  pdu[2] = 0x42;
+  EXPECT_FALSE(AudioPipelineTrace::GetMediaSequenceNumber(pdu, &sequence_number));
+  pdu.resize(8);
+  EXPECT_FALSE(AudioPipelineTrace::GetMediaSequenceNumber(pdu, &sequence_number));
+
+  AudioPipelineTrace::ClearMediaChannel();
+  EXPECT_FALSE(AudioPipelineTrace::IsMediaHandle(0x0002));
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
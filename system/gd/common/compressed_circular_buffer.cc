@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/compressed_circular_buffer.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace common {
+
+namespace {
+
+// Zero runs shorter than this are cheaper to keep inside a literal run than to encode as their own run
+constexpr size_t kMinZeroRun = 3;
+
+void put_varint(std::string& out, size_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+size_t get_varint(const std::string& in, size_t& position) {
+  size_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    ASSERT(position < in.size());
+    uint8_t byte = in[position++];
+    value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+uint8_t byte_at(const std::string& s, size_t i) {
+  return i < s.size() ? static_cast<uint8_t>(s[i]) : 0;
+}
+
+// Encode |record| XORed with |reference| as alternating runs of zeros and literals:
+//   length, then (zero run length, literal run length, literal bytes) until length bytes are covered
+void encode(const std::string& record, const std::string& reference, std::string& out) {
+  size_t length = record.size();
+  auto diff = [&](size_t i) { return static_cast<uint8_t>(record[i]) ^ byte_at(reference, i); };
+  put_varint(out, length);
+  size_t i = 0;
+  while (i < length) {
+    size_t zeros_start = i;
+    while (i < length && diff(i) == 0) {
+      i++;
+    }
+    size_t literal_start = i;
+    while (i < length) {
+      if (diff(i) != 0) {
+        i++;
+        continue;
+      }
+      size_t run_end = i;
+      while (run_end < length && diff(run_end) == 0) {
+        run_end++;
+      }
+      if (run_end - i >= kMinZeroRun || run_end == length) {
+        break;
+      }
+      i = run_end;
+    }
+    put_varint(out, literal_start - zeros_start);
+    put_varint(out, i - literal_start);
+    for (size_t j = literal_start; j < i; j++) {
+      out.push_back(static_cast<char>(diff(j)));
+    }
+  }
+}
+
+std::string decode(const std::string& in, size_t& position, const std::string& reference) {
+  size_t length = get_varint(in, position);
+  std::string record(length, '\0');
+  size_t i = 0;
+  while (i < length) {
+    size_t zeros = get_varint(in, position);
+    size_t literals = get_varint(in, position);
+    ASSERT(i + zeros + literals <= length && position + literals <= in.size());
+    for (size_t end = i + zeros; i < end; i++) {
+      record[i] = static_cast<char>(byte_at(reference, i));
+    }
+    for (size_t end = i + literals; i < end; i++) {
+      record[i] = static_cast<char>(static_cast<uint8_t>(in[position++]) ^ byte_at(reference, i));
+    }
+  }
+  return record;
+}
+
+}  // namespace
+
+CompressedCircularBuffer::CompressedCircularBuffer(size_t max_bytes) : max_bytes_(std::max(max_bytes, kChunkSize)) {}
+
+void CompressedCircularBuffer::Push(const std::string& record) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::string encoded;
+  if (!chunks_.empty()) {
+    encode(record, previous_, encoded);
+  }
+  if (chunks_.empty() || (chunks_.back().records > 0 && chunks_.back().data.size() + encoded.size() > kChunkSize)) {
+    // Start a new chunk, whose first record is encoded against nothing
+    chunks_.emplace_back();
+    chunks_.back().data.reserve(kChunkSize);
+    stored_bytes_ += chunks_.back().data.capacity();
+    encoded.clear();
+    encode(record, std::string(), encoded);
+  }
+
+  Chunk& chunk = chunks_.back();
+  size_t capacity = chunk.data.capacity();
+  chunk.data.append(encoded);
+  stored_bytes_ += chunk.data.capacity() - capacity;
+  chunk.records++;
+  chunk.raw_bytes += record.size();
+  previous_ = record;
+
+  while (stored_bytes_ > max_bytes_ && chunks_.size() > 1) {
+    stored_bytes_ -= chunks_.front().data.capacity();
+    chunks_.pop_front();
+  }
+}
+
+void CompressedCircularBuffer::DecodeChunk(const Chunk& chunk, std::vector<std::string>& records) const {
+  std::string reference;
+  size_t position = 0;
+  for (size_t i = 0; i < chunk.records; i++) {
+    std::string record = decode(chunk.data, position, reference);
+    records.push_back(record);
+    reference = std::move(record);
+  }
+}
+
+std::vector<std::string> CompressedCircularBuffer::Pull() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<std::string> records;
+  for (const Chunk& chunk : chunks_) {
+    DecodeChunk(chunk, records);
+  }
+  return records;
+}
+
+std::vector<std::string> CompressedCircularBuffer::Drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<std::string> records;
+  for (const Chunk& chunk : chunks_) {
+    DecodeChunk(chunk, records);
+  }
+  chunks_.clear();
+  previous_.clear();
+  stored_bytes_ = 0;
+  return records;
+}
+
+CompressedCircularBuffer::Stats CompressedCircularBuffer::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Stats stats;
+  for (const Chunk& chunk : chunks_) {
+    stats.records += chunk.records;
+    stats.raw_bytes += chunk.raw_bytes;
+  }
+  stats.stored_bytes = stored_bytes_;
+  return stats;
+}
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+// A circular buffer of byte string records bounded by the memory it uses rather than by a record count, dropping the
+// oldest records once full.
+//
+// Records are stored compressed: each one is XORed with the record before it and the result is run-length encoded,
+// so fields that repeat from one record to the next (e.g. packet headers, connection handles, high timestamp bytes)
+// cost close to nothing. Records are grouped in chunks encoded independently so the oldest chunk can be dropped
+// without decoding anything.
+class CompressedCircularBuffer {
+ public:
+  static constexpr size_t kChunkSize = 4096;
+
+  struct Stats {
+    size_t records = 0;
+    // Size of the records as pushed
+    size_t raw_bytes = 0;
+    // Memory used to hold them
+    size_t stored_bytes = 0;
+  };
+
+  // |max_bytes| bounds the memory allocated for the chunks, and is at least one chunk
+  explicit CompressedCircularBuffer(size_t max_bytes);
+
+  // Push one record to the circular buffer
+  void Push(const std::string& record);
+  // Take a snapshot of the circular buffer and return it as a vector
+  std::vector<std::string> Pull() const;
+  // Drain everything from the circular buffer and return them as a vector
+  std::vector<std::string> Drain();
+
+  Stats GetStats() const;
+
+ private:
+  struct Chunk {
+    std::string data;
+    size_t records = 0;
+    size_t raw_bytes = 0;
+  };
+
+  void DecodeChunk(const Chunk& chunk, std::vector<std::string>& records) const;
+
+  const size_t max_bytes_;
+  std::deque<Chunk> chunks_;
+  // Last record pushed to the newest chunk, the reference the next record is encoded against
+  std::string previous_;
+  size_t stored_bytes_ = 0;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
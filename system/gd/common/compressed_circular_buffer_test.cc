@@ -0,0 +1,122 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/compressed_circular_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace testing {
+
+using bluetooth::common::CompressedCircularBuffer;
+
+namespace {
+
+// A btsnoop-like record: fixed header fields, an increasing big endian timestamp and a mostly constant payload
+std::string MakeRecord(uint64_t timestamp, uint8_t sequence) {
+  std::string record = {0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    record.push_back(static_cast<char>(timestamp >> shift));
+  }
+  record += std::string{0x02, 0x40, 0x20, 0x0e, 0x00, 0x0a, 0x00, 0x41, 0x00};
+  record.push_back(static_cast<char>(sequence));
+  record += std::string(7, 'x');
+  return record;
+}
+
+}  // namespace
+
+TEST(CompressedCircularBufferTest, push_pull_round_trip) {
+  CompressedCircularBuffer buffer(64 * 1024);
+  std::vector<std::string> records;
+  for (int i = 0; i < 100; i++) {
+    records.push_back(MakeRecord(0x00dcddb30f2f8000 + i * 1250, i));
+  }
+  records.push_back("");
+  records.push_back(std::string(3000, '\0'));
+  records.push_back("short");
+  for (const auto& record : records) {
+    buffer.Push(record);
+  }
+
+  ASSERT_EQ(buffer.Pull(), records);
+  // Pull() takes a snapshot
+  ASSERT_EQ(buffer.Pull(), records);
+  ASSERT_EQ(buffer.GetStats().records, records.size());
+}
+
+TEST(CompressedCircularBufferTest, random_records_round_trip) {
+  CompressedCircularBuffer buffer(1024 * 1024);
+  std::mt19937 generator(42);
+  std::vector<std::string> records;
+  for (int i = 0; i < 2000; i++) {
+    std::string record(generator() % 200, '\0');
+    for (auto& c : record) {
+      // Bias towards zeros to exercise both run types
+      c = static_cast<char>(generator() % 3 == 0 ? generator() : 0);
+    }
+    records.push_back(record);
+    buffer.Push(record);
+  }
+  ASSERT_EQ(buffer.Pull(), records);
+}
+
+TEST(CompressedCircularBufferTest, similar_records_are_compressed) {
+  CompressedCircularBuffer buffer(1024 * 1024);
+  for (int i = 0; i < 1000; i++) {
+    buffer.Push(MakeRecord(0x00dcddb30f2f8000 + i * 1250, i));
+  }
+  auto stats = buffer.GetStats();
+  ASSERT_EQ(stats.records, 1000u);
+  ASSERT_LT(stats.stored_bytes * 3, stats.raw_bytes);
+}
+
+TEST(CompressedCircularBufferTest, oldest_records_are_dropped_when_full) {
+  const size_t max_bytes = 4 * CompressedCircularBuffer::kChunkSize;
+  CompressedCircularBuffer buffer(max_bytes);
+  std::vector<std::string> records;
+  for (int i = 0; i < 10000; i++) {
+    records.push_back(MakeRecord(0x00dcddb30f2f8000 + i * 1250, i));
+    buffer.Push(records.back());
+  }
+
+  auto stats = buffer.GetStats();
+  ASSERT_LE(stats.stored_bytes, max_bytes);
+  // The same memory holds far more records than it would uncompressed
+  ASSERT_GT(stats.records, max_bytes / records.back().size() * 2);
+
+  auto pulled = buffer.Pull();
+  ASSERT_EQ(pulled.size(), stats.records);
+  ASSERT_TRUE(std::equal(pulled.begin(), pulled.end(), records.end() - pulled.size()));
+}
+
+TEST(CompressedCircularBufferTest, drain) {
+  CompressedCircularBuffer buffer(64 * 1024);
+  buffer.Push("one");
+  buffer.Push("two");
+  ASSERT_EQ(buffer.Drain(), (std::vector<std::string>{"one", "two"}));
+  ASSERT_TRUE(buffer.Pull().empty());
+  ASSERT_EQ(buffer.GetStats().stored_bytes, 0u);
+
+  buffer.Push("three");
+  ASSERT_EQ(buffer.Pull(), (std::vector<std::string>{"three"}));
+}
+
+}  // namespace testing
@@ -56,7 +56,7 @@ class ContextualOnceCallback<R(Args...)> {
 
  private:
   common::OnceCallback<R(Args...)> callback_;
-  IPostableContext* context_;
+  IPostableContext* context_{nullptr};
 };
 
 template <typename R, typename... Args>
@@ -92,7 +92,7 @@ class ContextualCallback<R(Args...)> {
 
  private:
   common::Callback<R(Args...)> callback_;
-  IPostableContext* context_;
+  IPostableContext* context_{nullptr};
 };
 
 }  // namespace common
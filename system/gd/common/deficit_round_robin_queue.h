@@ -0,0 +1,193 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace bluetooth {
+namespace common {
+
+struct DeficitRoundRobinClassStats {
+  uint64_t enqueued = 0;
+  uint64_t dequeued = 0;
+  uint64_t dequeued_cost = 0;
+  // Turns given up by a backlogged class because its front item cost more than its deficit
+  uint64_t skipped_turns = 0;
+  // Most items of other classes dequeued in a row while this class was backlogged
+  uint64_t max_wait = 0;
+};
+
+/**
+ * A queue sharing its output between NUM_CLASSES traffic classes with deficit round robin.
+ * Each class is FIFO and has a quantum: the cost (e.g. bytes) it may dequeue per round. Unlike
+ * MultiPriorityQueue, a backlogged class always gets its share, so no class can starve another.
+ *
+ * front() takes a predicate telling whether an item can be dequeued right now (e.g. whether its
+ * controller buffer has credits); classes whose front item can't are skipped without spending
+ * their deficit.
+ */
+template <typename T, size_t NUM_CLASSES>
+class DeficitRoundRobinQueue {
+  static_assert(NUM_CLASSES > 0);
+
+ public:
+  using ClassStats = DeficitRoundRobinClassStats;
+
+  explicit DeficitRoundRobinQueue(const std::array<size_t, NUM_CLASSES>& quanta) {
+    for (size_t i = 0; i < NUM_CLASSES; i++) {
+      set_quantum(i, quanta[i]);
+    }
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size_ == 0;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return size_;
+  }
+
+  [[nodiscard]] size_t size(size_t traffic_class) const {
+    return classes_[traffic_class].queue.size();
+  }
+
+  // Push the item at the back of |traffic_class|
+  void push(T&& t, size_t traffic_class, size_t cost) {
+    Class& c = classes_[traffic_class];
+    if (c.queue.empty()) {
+      c.wait = 0;
+    }
+    c.queue.push_back(Entry{std::move(t), cost});
+    c.stats.enqueued++;
+    size_++;
+  }
+
+  // Get the item to dequeue next, or nullptr if no front item satisfies |can_dequeue|. Calling
+  // this again without pop() in between returns the same item.
+  template <typename Predicate>
+  T* front(Predicate can_dequeue) {
+    size_t unservable = 0;
+    while (size_ > 0 && unservable < NUM_CLASSES) {
+      Class& c = classes_[current_];
+      if (c.queue.empty() || !can_dequeue(c.queue.front().item)) {
+        unservable++;
+        end_turn();
+        continue;
+      }
+      if (!turn_started_) {
+        c.deficit += c.quantum;
+        turn_started_ = true;
+      }
+      if (c.queue.front().cost <= c.deficit) {
+        return &c.queue.front().item;
+      }
+      c.stats.skipped_turns++;
+      unservable = 0;
+      end_turn();
+    }
+    return nullptr;
+  }
+
+  // Pop the item returned by the last front()
+  void pop() {
+    Class& c = classes_[current_];
+    size_t cost = c.queue.front().cost;
+    c.deficit -= std::min(cost, c.deficit);
+    c.stats.dequeued++;
+    c.stats.dequeued_cost += cost;
+    c.wait = 0;
+    c.queue.pop_front();
+    size_--;
+    for (size_t i = 0; i < NUM_CLASSES; i++) {
+      Class& other = classes_[i];
+      if (i != current_ && !other.queue.empty()) {
+        other.wait++;
+        other.stats.max_wait = std::max(other.stats.max_wait, other.wait);
+      }
+    }
+    if (c.queue.empty()) {
+      c.deficit = 0;
+      end_turn();
+    }
+  }
+
+  // Remove all the items for which |predicate| returns true and return how many were removed
+  template <typename Predicate>
+  size_t remove_if(Predicate predicate) {
+    size_t removed = 0;
+    for (size_t i = 0; i < NUM_CLASSES; i++) {
+      Class& c = classes_[i];
+      auto new_end =
+          std::remove_if(c.queue.begin(), c.queue.end(), [&predicate](Entry& entry) { return predicate(entry.item); });
+      removed += std::distance(new_end, c.queue.end());
+      c.queue.erase(new_end, c.queue.end());
+      if (c.queue.empty()) {
+        c.deficit = 0;
+        if (i == current_) {
+          turn_started_ = false;
+        }
+      }
+    }
+    size_ -= removed;
+    return removed;
+  }
+
+  [[nodiscard]] size_t quantum(size_t traffic_class) const {
+    return classes_[traffic_class].quantum;
+  }
+
+  void set_quantum(size_t traffic_class, size_t quantum) {
+    classes_[traffic_class].quantum = std::max<size_t>(quantum, 1);
+  }
+
+  [[nodiscard]] const ClassStats& stats(size_t traffic_class) const {
+    return classes_[traffic_class].stats;
+  }
+
+ private:
+  struct Entry {
+    T item;
+    size_t cost;
+  };
+
+  struct Class {
+    std::deque<Entry> queue;
+    size_t quantum = 1;
+    size_t deficit = 0;
+    uint64_t wait = 0;
+    ClassStats stats;
+  };
+
+  void end_turn() {
+    turn_started_ = false;
+    current_ = (current_ + 1) % NUM_CLASSES;
+  }
+
+  std::array<Class, NUM_CLASSES> classes_;
+  size_t size_ = 0;
+  size_t current_ = 0;
+  bool turn_started_ = false;
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,124 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "common/deficit_round_robin_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+namespace {
+
+auto any = [](const int&) { return true; };
+
+std::vector<int> drain(DeficitRoundRobinQueue<int, 3>& q) {
+  std::vector<int> out;
+  while (int* item = q.front(any)) {
+    out.push_back(*item);
+    q.pop();
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(DeficitRoundRobinQueueTest, single_class_is_fifo) {
+  DeficitRoundRobinQueue<int, 3> q({10, 10, 10});
+  ASSERT_TRUE(q.empty());
+  ASSERT_EQ(q.front(any), nullptr);
+  for (int i = 0; i < 5; i++) {
+    q.push(int(i), 1, 100);
+  }
+  ASSERT_EQ(q.size(), 5ul);
+  ASSERT_EQ(drain(q), std::vector<int>({0, 1, 2, 3, 4}));
+  ASSERT_TRUE(q.empty());
+}
+
+TEST(DeficitRoundRobinQueueTest, front_is_stable_until_pop) {
+  DeficitRoundRobinQueue<int, 3> q({1, 1, 1});
+  q.push(1, 0, 5);
+  q.push(2, 2, 5);
+  int* first = q.front(any);
+  ASSERT_NE(first, nullptr);
+  ASSERT_EQ(q.front(any), first);
+  ASSERT_EQ(q.front(any), first);
+}
+
+TEST(DeficitRoundRobinQueueTest, classes_share_by_quantum) {
+  DeficitRoundRobinQueue<int, 3> q({100, 300, 0});
+  for (int i = 0; i < 6; i++) {
+    q.push(0, 0, 100);
+    q.push(1, 1, 100);
+  }
+  std::vector<int> out = drain(q);
+  ASSERT_EQ(out, std::vector<int>({0, 1, 1, 1, 0, 1, 1, 1, 0, 0, 0, 0}));
+  ASSERT_EQ(q.stats(0).dequeued, 6u);
+  ASSERT_EQ(q.stats(1).dequeued_cost, 600u);
+  ASSERT_EQ(q.stats(0).max_wait, 3u);
+}
+
+TEST(DeficitRoundRobinQueueTest, high_volume_class_does_not_starve_others) {
+  DeficitRoundRobinQueue<int, 3> q({1000, 1000, 1000});
+  for (int i = 0; i < 100; i++) {
+    q.push(2, 2, 250);
+  }
+  q.push(0, 0, 250);
+  std::vector<int> out = drain(q);
+  auto position = std::find(out.begin(), out.end(), 0) - out.begin();
+  ASSERT_LE(position, 4);
+  ASSERT_LE(q.stats(0).max_wait, 4u);
+}
+
+TEST(DeficitRoundRobinQueueTest, large_item_accumulates_deficit) {
+  DeficitRoundRobinQueue<int, 3> q({10, 10, 10});
+  q.push(0, 0, 35);
+  q.push(1, 1, 5);
+  ASSERT_EQ(drain(q), std::vector<int>({1, 0}));
+  ASSERT_EQ(q.stats(0).skipped_turns, 3u);
+}
+
+TEST(DeficitRoundRobinQueueTest, ineligible_class_is_skipped) {
+  DeficitRoundRobinQueue<int, 3> q({10, 10, 10});
+  q.push(0, 0, 1);
+  q.push(1, 1, 1);
+  auto not_zero = [](const int& i) { return i != 0; };
+  int* item = q.front(not_zero);
+  ASSERT_NE(item, nullptr);
+  ASSERT_EQ(*item, 1);
+  q.pop();
+  ASSERT_EQ(q.front(not_zero), nullptr);
+  ASSERT_EQ(drain(q), std::vector<int>({0}));
+}
+
+TEST(DeficitRoundRobinQueueTest, remove_if) {
+  DeficitRoundRobinQueue<int, 3> q({10, 10, 10});
+  for (int i = 0; i < 6; i++) {
+    q.push(int(i), i % 3, 1);
+  }
+  ASSERT_EQ(q.remove_if([](const int& i) { return i % 2 == 0; }), 3ul);
+  ASSERT_EQ(q.size(), 3ul);
+  ASSERT_EQ(q.size(0), 1ul);
+  ASSERT_EQ(drain(q), std::vector<int>({3, 1, 5}));
+}
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace common {
+
+// Charge every entry sizeof(Key) + sizeof(T). Caches of variable sized values should supply their own functor.
+template <typename Key, typename T>
+struct LruEntrySize {
+  size_t operator()(const Key&, const T&) const {
+    return sizeof(Key) + sizeof(T);
+  }
+};
+
+// Charge every entry 1, turning the budget into an entry count
+template <typename Key, typename T>
+struct LruEntryCount {
+  size_t operator()(const Key&, const T&) const {
+    return 1;
+  }
+};
+
+struct LruCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t insertions = 0;
+  uint64_t evictions = 0;
+};
+
+// An LRU map-cache bounded by the total size of its entries, as measured by SizeOf, evicting the coldest entries
+// when an insertion would exceed the budget
+//
+// Usage:
+//   - find(), contains() and insert_or_assign() will warm up the key
+//   - peek() and for_each() won't warm up keys
+//   - an entry larger than the whole budget is still kept, alone
+//   - SizeOf is evaluated on insert_or_assign() only; modifying a value through find() doesn't re-charge it
+//   - NOT THREAD SAFE
+//
+// Performance:
+//   - Entries live in one contiguous array and are linked from warmest to coldest by index. Keys are indexed by an
+//     open-addressed, linearly probed table of slot indices.
+//   - find() and updating an existing key never allocate. Inserting can grow the slot array or the index table;
+//     after reserve(n), a cache that never holds more than n entries doesn't allocate either.
+//   - Pointers returned by find() stay valid until the key is removed or evicted, or the slot array grows
+//
+// Template:
+//   - Key key type
+//   - T value type
+//   - SizeOf functor returning the size charged to the budget for a (key, value) pair
+//   - Hash hash functor for Key
+template <typename Key, typename T, typename SizeOf = LruEntrySize<Key, T>, typename Hash = std::hash<Key>>
+class FlatLruCache {
+ public:
+  using value_type = std::pair<Key, T>;
+
+  // Construct a LRU cache holding at most |max_bytes| worth of entries
+  explicit FlatLruCache(size_t max_bytes, SizeOf size_of = SizeOf(), Hash hash = Hash())
+      : max_bytes_(max_bytes), size_of_(std::move(size_of)), hash_(std::move(hash)) {
+    ASSERT_LOG(max_bytes_ != 0, "Unable to have 0 LRU Cache budget");
+  }
+
+  // Preallocate slots and index space for |count| entries
+  void reserve(size_t count) {
+    slots_.reserve(count);
+    if (count * 2 > table_.size()) {
+      rehash(table_size_for(count));
+    }
+  }
+
+  // Find the value of a key and warm it up. Return nullptr if the key is not cached.
+  T* find(const Key& key) {
+    uint32_t index = lookup(key, hash_key(key)).second;
+    if (index == kNone) {
+      stats_.misses++;
+      return nullptr;
+    }
+    stats_.hits++;
+    move_to_front(index);
+    return &slots_[index].entry->second;
+  }
+
+  // Find the value of a key without warming it up or counting a hit or miss
+  const T* peek(const Key& key) const {
+    uint32_t index = lookup(key, hash_key(key)).second;
+    return index == kNone ? nullptr : &slots_[index].entry->second;
+  }
+
+  // Check if the key is cached and warm it up
+  bool contains(const Key& key) {
+    return find(key) != nullptr;
+  }
+
+  // Put a key-value pair at the head of the cache, evicting the coldest entries until the new one fits. Each evicted
+  // entry is passed to |on_evict| as a value_type&&. Return true if the key was inserted, false if it was updated.
+  //
+  // LRU: Will warm up key
+  template <typename OnEvict>
+  bool insert_or_assign(const Key& key, T value, OnEvict on_evict) {
+    size_t hash = hash_key(key);
+    size_t cost = size_of_(key, value);
+    uint32_t index = lookup(key, hash).second;
+    if (index != kNone) {
+      Slot& slot = slots_[index];
+      move_to_front(index);
+      bytes_ = bytes_ - slot.cost + cost;
+      slot.cost = cost;
+      slot.entry->second = std::move(value);
+      while (bytes_ > max_bytes_ && tail_ != index) {
+        evict_tail(on_evict);
+      }
+      return false;
+    }
+
+    while (size_ > 0 && bytes_ + cost > max_bytes_) {
+      evict_tail(on_evict);
+    }
+    if ((size_ + 1) * 2 > table_.size()) {
+      rehash(table_size_for(size_ + 1));
+    }
+    index = allocate_slot();
+    Slot& slot = slots_[index];
+    slot.entry.emplace(key, std::move(value));
+    slot.hash = hash;
+    slot.cost = cost;
+    link_front(index);
+    size_t position = hash & (table_.size() - 1);
+    while (table_[position] != kNone) {
+      position = (position + 1) & (table_.size() - 1);
+    }
+    table_[position] = index;
+    size_++;
+    bytes_ += cost;
+    stats_.insertions++;
+    return true;
+  }
+
+  bool insert_or_assign(const Key& key, T value) {
+    return insert_or_assign(key, std::move(value), [](value_type&&) {});
+  }
+
+  // Remove a key from the cache and return its entry, std::nullopt if it is not cached
+  std::optional<value_type> extract(const Key& key) {
+    auto [position, index] = lookup(key, hash_key(key));
+    if (index == kNone) {
+      return std::nullopt;
+    }
+    std::optional<value_type> entry = std::move(slots_[index].entry);
+    release(position, index);
+    return entry;
+  }
+
+  // Remove a key from the cache, return true if it was cached
+  bool erase(const Key& key) {
+    auto [position, index] = lookup(key, hash_key(key));
+    if (index == kNone) {
+      return false;
+    }
+    release(position, index);
+    return true;
+  }
+
+  // Remove all the entries, keeping the allocated storage and the counters
+  void clear() {
+    slots_.clear();
+    std::fill(table_.begin(), table_.end(), kNone);
+    head_ = tail_ = free_head_ = kNone;
+    size_ = 0;
+    bytes_ = 0;
+  }
+
+  // Call |f| with each key and value, from warmest to coldest
+  template <typename F>
+  void for_each(F f) const {
+    for (uint32_t index = head_; index != kNone; index = slots_[index].next) {
+      f(slots_[index].entry->first, slots_[index].entry->second);
+    }
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t bytes() const {
+    return bytes_;
+  }
+
+  size_t max_bytes() const {
+    return max_bytes_;
+  }
+
+  const LruCacheStats& stats() const {
+    return stats_;
+  }
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+  static constexpr size_t kMinTableSize = 16;
+
+  struct Slot {
+    std::optional<value_type> entry;
+    size_t hash = 0;
+    size_t cost = 0;
+    // Neighbours in the LRU list while in use, next free slot otherwise
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+  };
+
+  // Spread the bits of the user hash, as std::hash is the identity for integers and sequential keys would otherwise
+  // form long probe runs
+  size_t hash_key(const Key& key) const {
+    uint64_t hash = hash_(key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+  }
+
+  static size_t table_size_for(size_t count) {
+    size_t table_size = kMinTableSize;
+    while (table_size < count * 2) {
+      table_size *= 2;
+    }
+    return table_size;
+  }
+
+  // Return the table position and slot index of |key|, kNone if it is not cached
+  std::pair<size_t, uint32_t> lookup(const Key& key, size_t hash) const {
+    if (size_ == 0) {
+      return {0, kNone};
+    }
+    size_t mask = table_.size() - 1;
+    for (size_t position = hash & mask; table_[position] != kNone; position = (position + 1) & mask) {
+      const Slot& slot = slots_[table_[position]];
+      if (slot.hash == hash && slot.entry->first == key) {
+        return {position, table_[position]};
+      }
+    }
+    return {0, kNone};
+  }
+
+  void rehash(size_t table_size) {
+    table_.assign(table_size, kNone);
+    size_t mask = table_size - 1;
+    for (uint32_t index = head_; index != kNone; index = slots_[index].next) {
+      size_t position = slots_[index].hash & mask;
+      while (table_[position] != kNone) {
+        position = (position + 1) & mask;
+      }
+      table_[position] = index;
+    }
+  }
+
+  // Remove the table entry at |position|, shifting back the entries probed past it
+  void table_erase(size_t position) {
+    size_t mask = table_.size() - 1;
+    size_t hole = position;
+    for (size_t next = (hole + 1) & mask; table_[next] != kNone; next = (next + 1) & mask) {
+      size_t ideal = slots_[table_[next]].hash & mask;
+      bool stays = hole < next ? (hole < ideal && ideal <= next) : (hole < ideal || ideal <= next);
+      if (!stays) {
+        table_[hole] = table_[next];
+        hole = next;
+      }
+    }
+    table_[hole] = kNone;
+  }
+
+  uint32_t allocate_slot() {
+    if (free_head_ != kNone) {
+      uint32_t index = free_head_;
+      free_head_ = slots_[index].next;
+      return index;
+    }
+    ASSERT(slots_.size() < kNone);
+    slots_.emplace_back();
+    return slots_.size() - 1;
+  }
+
+  void link_front(uint32_t index) {
+    Slot& slot = slots_[index];
+    slot.prev = kNone;
+    slot.next = head_;
+    if (head_ != kNone) {
+      slots_[head_].prev = index;
+    }
+    head_ = index;
+    if (tail_ == kNone) {
+      tail_ = index;
+    }
+  }
+
+  void unlink(uint32_t index) {
+    Slot& slot = slots_[index];
+    if (slot.prev != kNone) {
+      slots_[slot.prev].next = slot.next;
+    } else {
+      head_ = slot.next;
+    }
+    if (slot.next != kNone) {
+      slots_[slot.next].prev = slot.prev;
+    } else {
+      tail_ = slot.prev;
+    }
+  }
+
+  void move_to_front(uint32_t index) {
+    if (head_ != index) {
+      unlink(index);
+      link_front(index);
+    }
+  }
+
+  void release(size_t position, uint32_t index) {
+    Slot& slot = slots_[index];
+    table_erase(position);
+    unlink(index);
+    slot.entry.reset();
+    slot.next = free_head_;
+    free_head_ = index;
+    size_--;
+    bytes_ -= slot.cost;
+  }
+
+  template <typename OnEvict>
+  void evict_tail(OnEvict& on_evict) {
+    uint32_t index = tail_;
+    Slot& slot = slots_[index];
+    size_t position = lookup(slot.entry->first, slot.hash).first;
+    value_type entry = std::move(*slot.entry);
+    release(position, index);
+    stats_.evictions++;
+    on_evict(std::move(entry));
+  }
+
+  size_t max_bytes_;
+  SizeOf size_of_;
+  Hash hash_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> table_;
+  uint32_t head_ = kNone;
+  uint32_t tail_ = kNone;
+  uint32_t free_head_ = kNone;
+  size_t size_ = 0;
+  size_t bytes_ = 0;
+  LruCacheStats stats_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
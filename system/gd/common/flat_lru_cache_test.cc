@@ -0,0 +1,199 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/flat_lru_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace testing {
+
+using bluetooth::common::FlatLruCache;
+using bluetooth::common::LruEntryCount;
+
+using IntCache = FlatLruCache<int, int, LruEntryCount<int, int>>;
+
+std::vector<int> Keys(const IntCache& cache) {
+  std::vector<int> keys;
+  cache.for_each([&keys](const int& key, const int&) { keys.push_back(key); });
+  return keys;
+}
+
+TEST(FlatLruCacheTest, insert_find_and_evict_coldest) {
+  IntCache cache(3);
+  EXPECT_TRUE(cache.insert_or_assign(1, 10));
+  EXPECT_TRUE(cache.insert_or_assign(2, 20));
+  EXPECT_TRUE(cache.insert_or_assign(3, 30));
+  EXPECT_EQ(cache.size(), 3ul);
+  EXPECT_THAT(Keys(cache), ElementsAre(3, 2, 1));
+
+  ASSERT_NE(cache.find(1), nullptr);
+  EXPECT_EQ(*cache.find(1), 10);
+  EXPECT_THAT(Keys(cache), ElementsAre(1, 3, 2));
+
+  std::vector<std::pair<int, int>> evicted;
+  auto on_evict = [&evicted](std::pair<int, int>&& entry) { evicted.push_back(entry); };
+  EXPECT_TRUE(cache.insert_or_assign(4, 40, on_evict));
+  EXPECT_THAT(evicted, ElementsAre(Pair(2, 20)));
+  EXPECT_EQ(cache.find(2), nullptr);
+  EXPECT_THAT(Keys(cache), ElementsAre(4, 1, 3));
+
+  EXPECT_FALSE(cache.insert_or_assign(3, 300, on_evict));
+  EXPECT_EQ(evicted.size(), 1ul);
+  EXPECT_EQ(*cache.peek(3), 300);
+  EXPECT_THAT(Keys(cache), ElementsAre(3, 4, 1));
+}
+
+TEST(FlatLruCacheTest, peek_does_not_warm_up) {
+  IntCache cache(2);
+  cache.insert_or_assign(1, 10);
+  cache.insert_or_assign(2, 20);
+  EXPECT_EQ(*cache.peek(1), 10);
+  EXPECT_EQ(cache.peek(5), nullptr);
+  cache.insert_or_assign(3, 30);
+  EXPECT_EQ(cache.peek(1), nullptr);
+  EXPECT_EQ(cache.stats().hits, 0u);
+  EXPECT_EQ(cache.stats().misses, 0u);
+}
+
+TEST(FlatLruCacheTest, stats) {
+  IntCache cache(2);
+  cache.insert_or_assign(1, 10);
+  cache.insert_or_assign(2, 20);
+  cache.find(1);
+  cache.find(1);
+  cache.find(3);
+  cache.insert_or_assign(3, 30);
+  EXPECT_EQ(cache.stats().hits, 2u);
+  EXPECT_EQ(cache.stats().misses, 1u);
+  EXPECT_EQ(cache.stats().insertions, 3u);
+  EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST(FlatLruCacheTest, byte_budget) {
+  struct StringSize {
+    size_t operator()(const int&, const std::string& value) const {
+      return value.size();
+    }
+  };
+  FlatLruCache<int, std::string, StringSize> cache(10);
+  cache.insert_or_assign(1, "aaaa");
+  cache.insert_or_assign(2, "bbbb");
+  EXPECT_EQ(cache.bytes(), 8ul);
+  // Needs both older entries gone
+  cache.insert_or_assign(3, "cccccccc");
+  EXPECT_EQ(cache.size(), 1ul);
+  EXPECT_EQ(cache.bytes(), 8ul);
+  EXPECT_EQ(cache.stats().evictions, 2u);
+
+  // Growing a value evicts others but never itself
+  cache.insert_or_assign(4, "dd");
+  EXPECT_EQ(cache.bytes(), 10ul);
+  cache.insert_or_assign(4, "dddddddddddd");
+  EXPECT_EQ(cache.size(), 1ul);
+  EXPECT_EQ(cache.bytes(), 12ul);
+  EXPECT_EQ(*cache.peek(4), "dddddddddddd");
+}
+
+TEST(FlatLruCacheTest, extract_erase_and_clear) {
+  IntCache cache(4);
+  for (int i = 0; i < 4; i++) {
+    cache.insert_or_assign(i, i * 10);
+  }
+  EXPECT_THAT(cache.extract(2), Optional(Pair(2, 20)));
+  EXPECT_EQ(cache.extract(2), std::nullopt);
+  EXPECT_TRUE(cache.erase(0));
+  EXPECT_FALSE(cache.erase(0));
+  EXPECT_THAT(Keys(cache), ElementsAre(3, 1));
+  // Freed slots are reused
+  cache.insert_or_assign(5, 50);
+  cache.insert_or_assign(6, 60);
+  EXPECT_THAT(Keys(cache), ElementsAre(6, 5, 3, 1));
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0ul);
+  EXPECT_EQ(cache.find(6), nullptr);
+  cache.insert_or_assign(7, 70);
+  EXPECT_THAT(Keys(cache), ElementsAre(7));
+}
+
+TEST(FlatLruCacheTest, pointers_are_stable_after_reserve) {
+  IntCache cache(100);
+  cache.reserve(100);
+  cache.insert_or_assign(0, 0);
+  int* value = cache.find(0);
+  for (int i = 1; i < 100; i++) {
+    cache.insert_or_assign(i, i);
+  }
+  EXPECT_EQ(value, cache.find(0));
+}
+
+TEST(FlatLruCacheTest, matches_reference_under_pressure) {
+  // Colliding hashes exercise probing and backward shift deletion
+  struct BadHash {
+    size_t operator()(const int& key) const {
+      return key % 7;
+    }
+  };
+  FlatLruCache<int, int, LruEntryCount<int, int>, BadHash> cache(50);
+  std::unordered_map<int, int> reference;
+  std::vector<int> order;  // warmest first
+  uint32_t seed = 1;
+  for (int i = 0; i < 20000; i++) {
+    seed = seed * 1103515245 + 12345;
+    int key = (seed >> 16) % 120;
+    int op = (seed >> 8) % 3;
+    auto it = std::find(order.begin(), order.end(), key);
+    if (op == 0) {
+      // Evicting may invalidate |it|
+      cache.insert_or_assign(key, i, [&](std::pair<int, int>&& entry) {
+        ASSERT_EQ(entry.first, order.back());
+        reference.erase(order.back());
+        order.pop_back();
+      });
+      auto old = std::find(order.begin(), order.end(), key);
+      if (old != order.end()) {
+        order.erase(old);
+      }
+      order.insert(order.begin(), key);
+      reference[key] = i;
+    } else if (op == 1) {
+      int* value = cache.find(key);
+      ASSERT_EQ(value != nullptr, it != order.end());
+      if (value != nullptr) {
+        ASSERT_EQ(*value, reference[key]);
+        order.erase(it);
+        order.insert(order.begin(), key);
+      }
+    } else {
+      ASSERT_EQ(cache.erase(key), it != order.end());
+      if (it != order.end()) {
+        order.erase(it);
+        reference.erase(key);
+      }
+    }
+    ASSERT_EQ(cache.size(), order.size());
+  }
+  std::vector<int> keys;
+  cache.for_each([&keys](const int& key, const int&) { keys.push_back(key); });
+  ASSERT_EQ(keys, order);
+}
+
+}  // namespace testing
@@ -77,10 +77,9 @@ bool MetricIdManager::Init(
           kMinId,
           kMaxId);
     }
-    auto evicted = paired_device_cache_.insert_or_assign(p.first, p.second);
-    if (evicted) {
-      ForgetDevicePostprocess(evicted->first, evicted->second);
-    }
+    paired_device_cache_.insert_or_assign(p.first, p.second, [this](std::pair<Address, int>&& evicted) {
+      ForgetDevicePostprocess(evicted.first, evicted.second);
+    });
     id_set_.insert(p.second);
     next_id_ = std::max(next_id_, p.second + 1);
   }
@@ -123,14 +122,14 @@ bool MetricIdManager::IsEmpty() const {
 // call this function when a new device is scanned
 int MetricIdManager::AllocateId(const Address& mac_address) {
   std::lock_guard<std::mutex> lock(id_allocator_mutex_);
-  auto it = paired_device_cache_.find(mac_address);
+  const int* cached_id = paired_device_cache_.find(mac_address);
   // if already have an id, return it
-  if (it != paired_device_cache_.end()) {
-    return it->second;
+  if (cached_id != nullptr) {
+    return *cached_id;
   }
-  it = temporary_device_cache_.find(mac_address);
-  if (it != temporary_device_cache_.end()) {
-    return it->second;
+  cached_id = temporary_device_cache_.find(mac_address);
+  if (cached_id != nullptr) {
+    return *cached_id;
   }
 
   // find next available id
@@ -143,10 +142,8 @@ int MetricIdManager::AllocateId(const Address& mac_address) {
   }
   int id = next_id_++;
   id_set_.insert(id);
-  auto evicted = temporary_device_cache_.insert_or_assign(mac_address, id);
-  if (evicted) {
-    this->id_set_.extract(evicted->second);
-  }
+  temporary_device_cache_.insert_or_assign(
+      mac_address, id, [this](std::pair<Address, int>&& evicted) { this->id_set_.extract(evicted.second); });
 
   if (next_id_ > kMaxId) {
     next_id_ = kMinId;
@@ -171,10 +168,9 @@ bool MetricIdManager::SaveDevice(const Address& mac_address) {
     return false;
   }
   int id = opt->second;
-  auto evicted = paired_device_cache_.insert_or_assign(mac_address, id);
-  if (evicted) {
-    ForgetDevicePostprocess(evicted->first, evicted->second);
-  }
+  paired_device_cache_.insert_or_assign(mac_address, id, [this](std::pair<Address, int>&& evicted) {
+    ForgetDevicePostprocess(evicted.first, evicted.second);
+  });
   if (!save_id_callback_(mac_address, id)) {
     LOG_ERROR("Callback returned false after saving the device");
     return false;
@@ -23,7 +23,7 @@
 #include <thread>
 #include <unordered_set>
 
-#include "common/lru_cache.h"
+#include "common/flat_lru_cache.h"
 #include "hci/address.h"
 
 namespace bluetooth {
@@ -119,8 +119,8 @@ class MetricIdManager {
  private:
   mutable std::mutex id_allocator_mutex_;
 
-  LruCache<hci::Address, int> paired_device_cache_;
-  LruCache<hci::Address, int> temporary_device_cache_;
+  FlatLruCache<hci::Address, int, LruEntryCount<hci::Address, int>> paired_device_cache_;
+  FlatLruCache<hci::Address, int, LruEntryCount<hci::Address, int>> temporary_device_cache_;
   std::unordered_set<int> id_set_;
 
   int next_id_{kMinId};
@@ -80,12 +80,19 @@ template <class InputIt>
 std::string ToHexString(InputIt first, InputIt last) {
   static_assert(
       std::is_same_v<typename std::iterator_traits<InputIt>::value_type, uint8_t>, "Must use uint8_t iterator");
-  std::stringstream ss;
+  // Called for every key read from or written to the config, avoid the cost of a stringstream
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  std::string str;
+  if constexpr (std::is_base_of_v<
+                    std::random_access_iterator_tag,
+                    typename std::iterator_traits<InputIt>::iterator_category>) {
+    str.reserve(2 * (last - first));
+  }
   for (InputIt it = first; it != last; ++it) {
-    // +(byte) to prevent an uint8_t to be interpreted as a char
-    ss << std::hex << std::setw(2) << std::setfill('0') << +(*it);
+    str.push_back(kHexDigits[*it >> 4]);
+    str.push_back(kHexDigits[*it & 0x0f]);
   }
-  return ss.str();
+  return str;
 }
 // Convenience method for normal cases and initializer list, e.g. ToHexString({0x12, 0x34, 0x56, 0xab})
 std::string ToHexString(const std::vector<uint8_t>& value);
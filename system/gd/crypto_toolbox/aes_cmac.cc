@@ -26,6 +26,7 @@
 #include <cstdint>
 
 #include "aes.h"
+#include "aes_hw.h"
 #include "crypto_toolbox.h"
 #include "hci/octets.h"
 
@@ -58,24 +59,58 @@ static void xor_128(Octet16* a, const Octet16& b) {
     aa[i] = aa[i] ^ bb[i];
   }
 }
-}  // namespace
 
-/* This function computes AES_128(key, message) */
-Octet16 aes_128(const Octet16& key, const Octet16& message) {
+/* Keys encrypted together by aes_128_multi_key */
+constexpr size_t kMultiKeyBatchSize = 8;
+
+/** Expand the AES-128 key schedule of a little endian |key| */
+void aes_128_set_key(const Octet16& key, aes_context* ctx) {
   Octet16 key_reversed;
+  std::reverse_copy(key.begin(), key.end(), key_reversed.begin());
+  aes_set_key_128(key_reversed.data(), ctx);
+}
+
+/** AES_128 of a little endian |message| with an expanded key */
+Octet16 aes_128_encrypt(const aes_context& ctx, const Octet16& message) {
   Octet16 message_reversed;
   Octet16 output;
 
-  std::reverse_copy(key.begin(), key.end(), key_reversed.begin());
   std::reverse_copy(message.begin(), message.end(), message_reversed.begin());
-
-  aes_context ctx;
-  aes_set_key(key_reversed.data(), key_reversed.size(), &ctx);
-  aes_encrypt(message_reversed.data(), output.data(), &ctx);
+  aes_encrypt_blocks(&ctx, message_reversed.data(), output.data(), 1);
 
   std::reverse(output.begin(), output.end());
   return output;
 }
+}  // namespace
+
+/* This function computes AES_128(key, message) */
+Octet16 aes_128(const Octet16& key, const Octet16& message) {
+  aes_context ctx;
+  aes_128_set_key(key, &ctx);
+  return aes_128_encrypt(ctx, message);
+}
+
+/* This function computes AES_128(keys[i], message) for each of the keys */
+void aes_128_multi_key(const Octet16* keys, size_t count, const Octet16& message, Octet16* output) {
+  aes_context ctx[kMultiKeyBatchSize];
+  uint8_t in[kMultiKeyBatchSize * kOctet16Length];
+  uint8_t out[kMultiKeyBatchSize * kOctet16Length];
+
+  for (size_t k = 0; k < kMultiKeyBatchSize; k++) {
+    std::reverse_copy(message.begin(), message.end(), &in[k * kOctet16Length]);
+  }
+
+  for (size_t i = 0; i < count; i += kMultiKeyBatchSize) {
+    size_t n = std::min(count - i, kMultiKeyBatchSize);
+    for (size_t k = 0; k < n; k++) {
+      aes_128_set_key(keys[i + k], &ctx[k]);
+    }
+    aes_encrypt_blocks(ctx, in, out, n);
+    for (size_t k = 0; k < n; k++) {
+      std::reverse_copy(&out[k * kOctet16Length], &out[(k + 1) * kOctet16Length], output[i + k].begin());
+    }
+  }
+}
 
 /** utility function to padding the given text to be a 128 bits data. The
  * parameter dest is input and output parameter, it must point to a
@@ -99,7 +134,7 @@ static void leftshift_onebit(uint8_t* input, uint8_t* output) {
 }
 
 /** This function is the calculation of block cipher using AES-128. */
-static Octet16 cmac_aes_k_calculate(const Octet16& key) {
+static Octet16 cmac_aes_k_calculate(const aes_context& ctx) {
   Octet16 output;
   Octet16 x{0};  // zero initialized
 
@@ -108,7 +143,7 @@ static Octet16 cmac_aes_k_calculate(const Octet16& key) {
     /* Mi' := Mi (+) X  */
     xor_128((Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length], x);
 
-    output = aes_128(key, *(Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length]);
+    output = aes_128_encrypt(ctx, *(Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length]);
     x = output;
     i++;
   }
@@ -137,11 +172,11 @@ static void cmac_prepare_last_block(const Octet16& k1, const Octet16& k2) {
 }
 
 /** This is the function to generate the two subkeys.
- * |key| is CMAC key, expect SRK when used by SMP.
+ * |ctx| is the key schedule of the CMAC key, expect SRK when used by SMP.
  */
-static void cmac_generate_subkey(const Octet16& key) {
+static void cmac_generate_subkey(const aes_context& ctx) {
   Octet16 zero{};
-  Octet16 p = aes_128(key, zero);
+  Octet16 p = aes_128_encrypt(ctx, zero);
 
   Octet16 k1, k2;
   uint8_t* pp = p.data();
@@ -194,10 +229,14 @@ Octet16 aes_cmac(const Octet16& key, const uint8_t* input, uint16_t length) {
     cmac_cb.len = 0;
   }
 
+  /* the key schedule is shared by all the blocks */
+  aes_context ctx;
+  aes_128_set_key(key, &ctx);
+
   /* prepare calculation for subkey s and last block of data */
-  cmac_generate_subkey(key);
+  cmac_generate_subkey(ctx);
   /* start calculation */
-  Octet16 signature = cmac_aes_k_calculate(key);
+  Octet16 signature = cmac_aes_k_calculate(ctx);
 
   /* clean up */
   memset(&cmac_cb, 0, sizeof(tCMAC_CB));
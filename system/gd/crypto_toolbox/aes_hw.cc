@@ -0,0 +1,219 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/******************************************************************************
+ *
+ *  This file contains the AES-128 encryption with the AES instructions of the
+ *  CPU, selected at runtime.
+ *
+ ******************************************************************************/
+
+#include "aes_hw.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#define AES_HW_X86
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define AES_HW_ARM
+#if defined(__clang__)
+#define AES_HW_ARM_TARGET __attribute__((target("aes")))
+#else
+#define AES_HW_ARM_TARGET __attribute__((target("+crypto")))
+#endif
+#endif
+
+namespace crypto_toolbox {
+
+namespace {
+
+constexpr uint8_t kAes128Rounds = 10;
+
+/* Blocks encrypted together, the AES instructions have a latency of several
+ * cycles but can start every cycle. */
+constexpr size_t kInterleavedBlocks = 4;
+
+using EncryptBlocks = void (*)(const aes_context*, const unsigned char*, unsigned char*, size_t);
+using SetKey128 = void (*)(const unsigned char*, aes_context*);
+
+struct AesHw {
+  EncryptBlocks encrypt_blocks;
+  SetKey128 set_key_128;
+};
+
+#if defined(AES_HW_X86)
+__attribute__((target("aes,sse2"))) inline __m128i aes_expand_key_ni(__m128i key, __m128i assist) {
+  assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+__attribute__((target("aes,sse2"))) void aes_set_key_128_ni(const unsigned char* key, aes_context* ctx) {
+  __m128i rk[kAes128Rounds + 1];
+
+  /* The round constant of AESKEYGENASSIST must be an immediate */
+  rk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+  rk[1] = aes_expand_key_ni(rk[0], _mm_aeskeygenassist_si128(rk[0], 0x01));
+  rk[2] = aes_expand_key_ni(rk[1], _mm_aeskeygenassist_si128(rk[1], 0x02));
+  rk[3] = aes_expand_key_ni(rk[2], _mm_aeskeygenassist_si128(rk[2], 0x04));
+  rk[4] = aes_expand_key_ni(rk[3], _mm_aeskeygenassist_si128(rk[3], 0x08));
+  rk[5] = aes_expand_key_ni(rk[4], _mm_aeskeygenassist_si128(rk[4], 0x10));
+  rk[6] = aes_expand_key_ni(rk[5], _mm_aeskeygenassist_si128(rk[5], 0x20));
+  rk[7] = aes_expand_key_ni(rk[6], _mm_aeskeygenassist_si128(rk[6], 0x40));
+  rk[8] = aes_expand_key_ni(rk[7], _mm_aeskeygenassist_si128(rk[7], 0x80));
+  rk[9] = aes_expand_key_ni(rk[8], _mm_aeskeygenassist_si128(rk[8], 0x1b));
+  rk[10] = aes_expand_key_ni(rk[9], _mm_aeskeygenassist_si128(rk[9], 0x36));
+
+  for (uint8_t r = 0; r <= kAes128Rounds; r++) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ctx->ksch + r * N_BLOCK), rk[r]);
+  }
+  ctx->rnd = kAes128Rounds;
+}
+
+__attribute__((target("aes,sse2"))) void aes_encrypt_blocks_ni(
+    const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count) {
+  for (size_t i = 0; i < count; i += kInterleavedBlocks) {
+    size_t n = count - i < kInterleavedBlocks ? count - i : kInterleavedBlocks;
+    __m128i s[kInterleavedBlocks];
+
+    for (size_t k = 0; k < n; k++) {
+      s[k] = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (i + k) * N_BLOCK)),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctx[i + k].ksch)));
+    }
+    for (uint8_t r = 1; r < kAes128Rounds; r++) {
+      for (size_t k = 0; k < n; k++) {
+        s[k] = _mm_aesenc_si128(s[k], _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctx[i + k].ksch + r * N_BLOCK)));
+      }
+    }
+    for (size_t k = 0; k < n; k++) {
+      s[k] = _mm_aesenclast_si128(
+          s[k], _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctx[i + k].ksch + kAes128Rounds * N_BLOCK)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i + k) * N_BLOCK), s[k]);
+    }
+  }
+}
+#endif
+
+#if defined(AES_HW_ARM)
+AES_HW_ARM_TARGET void aes_set_key_128_ce(const unsigned char* key, aes_context* ctx) {
+  static const uint8_t rcon[kAes128Rounds] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+  uint32_t w[(kAes128Rounds + 1) * 4];
+
+  memcpy(w, key, N_BLOCK);
+  for (uint8_t r = 0; r < kAes128Rounds; r++) {
+    /* With the same word in all the columns, ShiftRows has no effect and
+     * AESE with a zero key is SubWord */
+    uint8x16_t word = vreinterpretq_u8_u32(vdupq_n_u32(w[r * 4 + 3]));
+    uint32_t sub = vgetq_lane_u32(vreinterpretq_u32_u8(vaeseq_u8(word, vdupq_n_u8(0))), 0);
+    uint32_t t = ((sub >> 8) | (sub << 24)) ^ rcon[r];
+
+    w[r * 4 + 4] = w[r * 4] ^ t;
+    w[r * 4 + 5] = w[r * 4 + 1] ^ w[r * 4 + 4];
+    w[r * 4 + 6] = w[r * 4 + 2] ^ w[r * 4 + 5];
+    w[r * 4 + 7] = w[r * 4 + 3] ^ w[r * 4 + 6];
+  }
+  memcpy(ctx->ksch, w, sizeof(w));
+  ctx->rnd = kAes128Rounds;
+}
+
+AES_HW_ARM_TARGET void aes_encrypt_blocks_ce(
+    const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count) {
+  for (size_t i = 0; i < count; i += kInterleavedBlocks) {
+    size_t n = count - i < kInterleavedBlocks ? count - i : kInterleavedBlocks;
+    uint8x16_t s[kInterleavedBlocks];
+
+    for (size_t k = 0; k < n; k++) {
+      s[k] = vld1q_u8(in + (i + k) * N_BLOCK);
+    }
+    /* AESE adds the round key before SubBytes and ShiftRows */
+    for (uint8_t r = 0; r < kAes128Rounds - 1; r++) {
+      for (size_t k = 0; k < n; k++) {
+        s[k] = vaesmcq_u8(vaeseq_u8(s[k], vld1q_u8(ctx[i + k].ksch + r * N_BLOCK)));
+      }
+    }
+    for (size_t k = 0; k < n; k++) {
+      s[k] = vaeseq_u8(s[k], vld1q_u8(ctx[i + k].ksch + (kAes128Rounds - 1) * N_BLOCK));
+      s[k] = veorq_u8(s[k], vld1q_u8(ctx[i + k].ksch + kAes128Rounds * N_BLOCK));
+      vst1q_u8(out + (i + k) * N_BLOCK, s[k]);
+    }
+  }
+}
+#endif
+
+AesHw select_aes_hw() {
+#if defined(AES_HW_X86)
+  if (__builtin_cpu_supports("aes")) {
+    return {aes_encrypt_blocks_ni, aes_set_key_128_ni};
+  }
+#elif defined(AES_HW_ARM)
+  if (getauxval(AT_HWCAP) & HWCAP_AES) {
+    return {aes_encrypt_blocks_ce, aes_set_key_128_ce};
+  }
+#endif
+  return {nullptr, nullptr};
+}
+
+const AesHw& aes_hw() {
+  static const AesHw hw = select_aes_hw();
+  return hw;
+}
+
+}  // namespace
+
+bool aes_hw_supported() {
+  return aes_hw().encrypt_blocks != nullptr;
+}
+
+void aes_set_key_128(const unsigned char key[N_BLOCK], aes_context* ctx) {
+  if (aes_hw().set_key_128 == nullptr) {
+    aes_set_key(key, N_BLOCK, ctx);
+    return;
+  }
+  aes_hw().set_key_128(key, ctx);
+}
+
+void aes_encrypt_blocks_sw(const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    aes_encrypt(in + i * N_BLOCK, out + i * N_BLOCK, &ctx[i]);
+  }
+}
+
+void aes_encrypt_blocks(const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count) {
+  EncryptBlocks encrypt_blocks = aes_hw().encrypt_blocks;
+  if (encrypt_blocks == nullptr) {
+    aes_encrypt_blocks_sw(ctx, in, out, count);
+    return;
+  }
+  /* The AES instructions are only used with 128 bit keys */
+  for (size_t i = 0; i < count; i++) {
+    if (ctx[i].rnd != kAes128Rounds) {
+      aes_encrypt_blocks_sw(ctx, in, out, count);
+      return;
+    }
+  }
+  encrypt_blocks(ctx, in, out, count);
+}
+
+}  // namespace crypto_toolbox
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "aes.h"
+
+namespace crypto_toolbox {
+
+/* Return true if the CPU has AES instructions (AES-NI, or the ARMv8 Crypto
+ * Extension), checked once. */
+bool aes_hw_supported();
+
+/* Expand the key schedule of a 128 bit key, same as aes_set_key. */
+void aes_set_key_128(const unsigned char key[N_BLOCK], aes_context* ctx);
+
+/* Encrypt |count| blocks: block i of |in| with the key schedule ctx[i].
+ * The blocks are interleaved to keep the AES units busy when the CPU has AES
+ * instructions, and encrypted one by one with the table-based AES otherwise. */
+void aes_encrypt_blocks(const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count);
+
+/* Same as aes_encrypt_blocks, with the table-based AES only. */
+void aes_encrypt_blocks_sw(const aes_context* ctx, const unsigned char* in, unsigned char* out, size_t count);
+
+}  // namespace crypto_toolbox
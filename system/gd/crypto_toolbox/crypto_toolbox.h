@@ -17,6 +17,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
@@ -40,6 +41,12 @@ bluetooth::hci::Octet16 s1(
 
 bluetooth::hci::Octet16 aes_128(
     const bluetooth::hci::Octet16& key, const bluetooth::hci::Octet16& message);
+/* output[i] = aes_128(keys[i], message) for each of the |count| keys, e.g. to
+ * resolve a RPA with all the IRKs. The blocks are processed together when the
+ * CPU has AES instructions. */
+void aes_128_multi_key(
+    const bluetooth::hci::Octet16* keys, size_t count, const bluetooth::hci::Octet16& message,
+    bluetooth::hci::Octet16* output);
 bluetooth::hci::Octet16 aes_cmac(
     const bluetooth::hci::Octet16& key, const uint8_t* message, uint16_t length);
 bluetooth::hci::Octet16 f4(
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "crypto_toolbox/aes.h"
+#include "crypto_toolbox/aes_hw.h"
+#include "crypto_toolbox/crypto_toolbox.h"
+
+using ::benchmark::State;
+using bluetooth::hci::kOctet16Length;
+using bluetooth::hci::Octet16;
+
+namespace crypto_toolbox {
+
+namespace {
+
+std::vector<Octet16> MakeKeys(size_t count) {
+  std::vector<Octet16> keys(count);
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < kOctet16Length; j++) {
+      keys[i][j] = static_cast<uint8_t>(i * 31 + j);
+    }
+  }
+  return keys;
+}
+
+std::vector<aes_context> MakeContexts(size_t count) {
+  std::vector<aes_context> ctx(count);
+  auto keys = MakeKeys(count);
+  for (size_t i = 0; i < count; i++) {
+    aes_set_key(keys[i].data(), kOctet16Length, &ctx[i]);
+  }
+  return ctx;
+}
+
+}  // namespace
+
+// Table-based AES, the way every block was encrypted
+void BM_AesEncryptBlocksSoftware(State& state) {
+  auto ctx = MakeContexts(state.range(0));
+  std::vector<uint8_t> in(ctx.size() * kOctet16Length);
+  std::vector<uint8_t> out(in.size());
+  for (auto _ : state) {
+    aes_encrypt_blocks_sw(ctx.data(), in.data(), out.data(), ctx.size());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * ctx.size());
+}
+
+void BM_AesEncryptBlocks(State& state) {
+  auto ctx = MakeContexts(state.range(0));
+  std::vector<uint8_t> in(ctx.size() * kOctet16Length);
+  std::vector<uint8_t> out(in.size());
+  for (auto _ : state) {
+    aes_encrypt_blocks(ctx.data(), in.data(), out.data(), ctx.size());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * ctx.size());
+}
+
+// RPA resolution against |range| IRKs, one aes_128 per IRK
+void BM_Aes128(State& state) {
+  auto keys = MakeKeys(state.range(0));
+  Octet16 prand{0x94, 0x81, 0x70};
+  for (auto _ : state) {
+    for (const Octet16& key : keys) {
+      benchmark::DoNotOptimize(aes_128(key, prand));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+void BM_Aes128MultiKey(State& state) {
+  auto keys = MakeKeys(state.range(0));
+  std::vector<Octet16> output(keys.size());
+  Octet16 prand{0x94, 0x81, 0x70};
+  for (auto _ : state) {
+    aes_128_multi_key(keys.data(), keys.size(), prand, output.data());
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+void BM_AesCmac(State& state) {
+  Octet16 key = MakeKeys(1)[0];
+  std::vector<uint8_t> message(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(aes_cmac(key, message.data(), message.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+
+BENCHMARK(BM_AesEncryptBlocksSoftware)->Arg(1)->Arg(16);
+BENCHMARK(BM_AesEncryptBlocks)->Arg(1)->Arg(16);
+BENCHMARK(BM_Aes128)->Arg(16);
+BENCHMARK(BM_Aes128MultiKey)->Arg(16);
+BENCHMARK(BM_AesCmac)->Arg(65)->Arg(512);
+
+}  // namespace crypto_toolbox
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "crypto_toolbox/aes.h"
+#include "crypto_toolbox/aes_hw.h"
 #include "hci/octets.h"
 
 namespace crypto_toolbox {
@@ -354,4 +355,55 @@ TEST(CryptoToolboxTest, bt_spec_example_d_12_test) {
   EXPECT_EQ(expected_ltk, ltk);
 }
 
+TEST(CryptoToolboxTest, aes_encrypt_blocks_matches_software_aes) {
+  constexpr size_t kBlocks = 11;
+  aes_context ctx[kBlocks];
+  uint8_t in[kBlocks * kOctet16Length];
+  uint8_t out[kBlocks * kOctet16Length];
+  uint8_t expected[kBlocks * kOctet16Length];
+
+  for (size_t i = 0; i < kBlocks; i++) {
+    uint8_t key[kOctet16Length];
+    for (size_t j = 0; j < kOctet16Length; j++) {
+      key[j] = static_cast<uint8_t>(i * 31 + j * 7);
+      in[i * kOctet16Length + j] = static_cast<uint8_t>(i * 13 + j * 11);
+    }
+    aes_set_key(key, sizeof(key), &ctx[i]);
+  }
+
+  aes_encrypt_blocks_sw(ctx, in, expected, kBlocks);
+  aes_encrypt_blocks(ctx, in, out, kBlocks);
+  EXPECT_EQ(memcmp(out, expected, sizeof(out)), 0);
+}
+
+TEST(CryptoToolboxTest, aes_set_key_128_matches_aes_set_key) {
+  uint8_t key[kOctet16Length] = {
+      0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+  aes_context expected;
+  aes_context ctx;
+
+  aes_set_key(key, sizeof(key), &expected);
+  aes_set_key_128(key, &ctx);
+  EXPECT_EQ(ctx.rnd, expected.rnd);
+  EXPECT_EQ(memcmp(ctx.ksch, expected.ksch, (expected.rnd + 1) * kOctet16Length), 0);
+}
+
+TEST(CryptoToolboxTest, aes_128_multi_key_test) {
+  constexpr size_t kKeys = 19;
+  Octet16 keys[kKeys];
+  Octet16 output[kKeys];
+  Octet16 prand{0x94, 0x81, 0x70};
+
+  for (size_t i = 0; i < kKeys; i++) {
+    for (size_t j = 0; j < kOctet16Length; j++) {
+      keys[i][j] = static_cast<uint8_t>(i * 17 + j);
+    }
+  }
+
+  aes_128_multi_key(keys, kKeys, prand, output);
+  for (size_t i = 0; i < kKeys; i++) {
+    EXPECT_EQ(output[i], aes_128(keys[i], prand));
+  }
+}
+
 }  // namespace crypto_toolbox
@@ -59,18 +59,27 @@ namespace bluetooth {
 namespace hal {
 namespace {
 
+// Snoop logs are written out asynchronously, give the writer thread this long to catch up before crashing
+constexpr std::chrono::milliseconds kSnoopLogFlushTimeout = std::chrono::milliseconds(500);
+
 class HciDeathRecipient : public ::android::hardware::hidl_death_recipient {
  public:
+  explicit HciDeathRecipient(SnoopLogger* btsnoop_logger) : btsnoop_logger_(btsnoop_logger) {}
+
   virtual void serviceDied(uint64_t /*cookie*/, const android::wp<::android::hidl::base::V1_0::IBase>& /*who*/) {
     LOG_ERROR("The Bluetooth HAL service died. Dumping logs and crashing in 1 second.");
     common::StopWatch::DumpStopWatchLog();
     // At shutdown, sometimes the HAL service gets killed before Bluetooth.
     std::this_thread::sleep_for(std::chrono::seconds(1));
+    btsnoop_logger_->FlushBeforeCrash(kSnoopLogFlushTimeout);
     LOG_ALWAYS_FATAL("The Bluetooth HAL died.");
   }
+
+ private:
+  SnoopLogger* btsnoop_logger_;
 };
 
-android::sp<HciDeathRecipient> hci_death_recipient_ = new HciDeathRecipient();
+android::sp<HciDeathRecipient> hci_death_recipient_;
 
 template <class VecType>
 std::string GetTimerText(const char* func_name, VecType vec) {
@@ -393,11 +402,12 @@ class HciHalHidl : public HciHal {
     if (aidl_hci_ != nullptr) {
       LOG_INFO("Using the AIDL interface");
       aidl_death_recipient_ =
-          ::ndk::ScopedAIBinder_DeathRecipient(AIBinder_DeathRecipient_new([](void* /* cookie*/) {
+          ::ndk::ScopedAIBinder_DeathRecipient(AIBinder_DeathRecipient_new([](void* cookie) {
             LOG_ERROR("The Bluetooth HAL service died. Dumping logs and crashing in 1 second.");
             common::StopWatch::DumpStopWatchLog();
             // At shutdown, sometimes the HAL service gets killed before Bluetooth.
             std::this_thread::sleep_for(std::chrono::seconds(1));
+            static_cast<HciHalHidl*>(cookie)->btsnoop_logger_->FlushBeforeCrash(kSnoopLogFlushTimeout);
             LOG_ALWAYS_FATAL("The Bluetooth HAL died.");
           }));
 
@@ -446,6 +456,7 @@ class HciHalHidl : public HciHal {
     delete get_service_alarm;
 
     ASSERT(bt_hci_ != nullptr);
+    hci_death_recipient_ = new HciDeathRecipient(btsnoop_logger_);
     auto death_link = bt_hci_->linkToDeath(hci_death_recipient_, 0);
     ASSERT_LOG(death_link.isOk(), "Unable to set the death recipient for the Bluetooth HAL");
     hidl_callbacks_ = new InternalHciCallbacks(btsnoop_logger_, nocp_iso_clocker_);
@@ -21,12 +21,15 @@
 #include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <array>
 #include <chrono>
 #include <csignal>
 #include <mutex>
 #include <queue>
+#include <utility>
 
 #include "gd/common/init_flags.h"
 #include "hal/hci_hal.h"
@@ -37,6 +40,7 @@
 #include "os/log.h"
 #include "os/reactor.h"
 #include "os/thread.h"
+#include "os/utils.h"
 
 namespace {
 constexpr int INVALID_FD = -1;
@@ -53,6 +57,7 @@ constexpr uint8_t kHciScoHeaderSize = 3;
 constexpr uint8_t kHciEvtHeaderSize = 2;
 constexpr uint8_t kHciIsoHeaderSize = 4;
 constexpr int kBufSize = 1024 + 4 + 1;  // DeviceProperties::acl_data_packet_size_ + ACL header + H4 header
+constexpr size_t kMaxPacketsPerRead = 16;  // Packets received per reactor wakeup
 
 constexpr uint8_t BTPROTO_HCI = 1;
 constexpr uint16_t HCI_CHANNEL_USER = 1;
@@ -246,37 +251,29 @@ class HciHalHost : public HciHal {
   void sendHciCommand(HciPacket command) override {
     std::lock_guard<std::mutex> lock(api_mutex_);
     ASSERT(sock_fd_ != INVALID_FD);
-    std::vector<uint8_t> packet = std::move(command);
-    btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
-    packet.insert(packet.cbegin(), kH4Command);
-    write_to_fd(packet);
+    btsnoop_logger_->Capture(command, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+    write_to_fd(kH4Command, std::move(command));
   }
 
   void sendAclData(HciPacket data) override {
     std::lock_guard<std::mutex> lock(api_mutex_);
     ASSERT(sock_fd_ != INVALID_FD);
-    std::vector<uint8_t> packet = std::move(data);
-    btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
-    packet.insert(packet.cbegin(), kH4Acl);
-    write_to_fd(packet);
+    btsnoop_logger_->Capture(data, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
+    write_to_fd(kH4Acl, std::move(data));
   }
 
   void sendScoData(HciPacket data) override {
     std::lock_guard<std::mutex> lock(api_mutex_);
     ASSERT(sock_fd_ != INVALID_FD);
-    std::vector<uint8_t> packet = std::move(data);
-    btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::SCO);
-    packet.insert(packet.cbegin(), kH4Sco);
-    write_to_fd(packet);
+    btsnoop_logger_->Capture(data, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::SCO);
+    write_to_fd(kH4Sco, std::move(data));
   }
 
   void sendIsoData(HciPacket data) override {
     std::lock_guard<std::mutex> lock(api_mutex_);
     ASSERT(sock_fd_ != INVALID_FD);
-    std::vector<uint8_t> packet = std::move(data);
-    btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ISO);
-    packet.insert(packet.cbegin(), kH4Iso);
-    write_to_fd(packet);
+    btsnoop_logger_->Capture(data, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ISO);
+    write_to_fd(kH4Iso, std::move(data));
   }
 
   uint16_t getMsftOpcode() override {
@@ -346,13 +343,17 @@ class HciHalHost : public HciHal {
   bluetooth::os::Thread hci_incoming_thread_ =
       bluetooth::os::Thread("hci_incoming_thread", bluetooth::os::Thread::Priority::NORMAL);
   bluetooth::os::Reactor::Reactable* reactable_ = nullptr;
-  std::queue<std::vector<uint8_t>> hci_outgoing_queue_;
+  // H4 packet type and packet
+  std::queue<std::pair<uint8_t, std::vector<uint8_t>>> hci_outgoing_queue_;
   SnoopLogger* btsnoop_logger_ = nullptr;
   NocpIsoClocker* nocp_iso_clocker_ = nullptr;
+  std::array<std::array<uint8_t, kBufSize>, kMaxPacketsPerRead> receive_buffers_;
+  std::array<struct iovec, kMaxPacketsPerRead> receive_iovecs_;
+  std::array<struct mmsghdr, kMaxPacketsPerRead> receive_msgs_;
 
-  void write_to_fd(HciPacket packet) {
+  void write_to_fd(uint8_t h4_type, HciPacket packet) {
     // TODO: replace this with new queue when it's ready
-    hci_outgoing_queue_.emplace(packet);
+    hci_outgoing_queue_.emplace(h4_type, std::move(packet));
     if (hci_outgoing_queue_.size() == 1) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(reactable_, os::Reactor::REACT_ON_READ_WRITE);
     }
@@ -361,8 +362,14 @@ class HciHalHost : public HciHal {
   void send_packet_ready() {
     std::lock_guard<std::mutex> lock(api_mutex_);
     if (hci_outgoing_queue_.empty()) return;
-    auto packet_to_send = hci_outgoing_queue_.front();
-    auto bytes_written = write(sock_fd_, (void*)packet_to_send.data(), packet_to_send.size());
+    auto& [h4_type, packet_to_send] = hci_outgoing_queue_.front();
+    // Send the H4 type and the packet as one datagram without copying the packet behind the type
+    std::array<struct iovec, 2> iovecs = {{
+        {.iov_base = &h4_type, .iov_len = sizeof(h4_type)},
+        {.iov_base = packet_to_send.data(), .iov_len = packet_to_send.size()},
+    }};
+    ssize_t bytes_written;
+    RUN_NO_INTR(bytes_written = writev(sock_fd_, iovecs.data(), iovecs.size()));
     hci_outgoing_queue_.pop();
     if (bytes_written == -1) {
       abort();
@@ -380,25 +387,46 @@ class HciHalHost : public HciHal {
         return;
       }
     }
-    uint8_t buf[kBufSize] = {};
 
-    ssize_t received_size;
-    RUN_NO_INTR(received_size = read(sock_fd_, buf, kBufSize));
+    // Each datagram of the HCI user channel holds exactly one H4 packet. Drain up to kMaxPacketsPerRead of them with
+    // a single syscall into the pooled receive buffers.
+    for (size_t i = 0; i < kMaxPacketsPerRead; i++) {
+      receive_iovecs_[i] = {.iov_base = receive_buffers_[i].data(), .iov_len = kBufSize};
+      receive_msgs_[i] = {};
+      receive_msgs_[i].msg_hdr.msg_iov = &receive_iovecs_[i];
+      receive_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int received_count;
+    RUN_NO_INTR(received_count = recvmmsg(sock_fd_, receive_msgs_.data(), kMaxPacketsPerRead, MSG_DONTWAIT, nullptr));
+
+    if (received_count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return;
+    }
 
     // we don't want crash when the chipset is broken.
-    if (received_size == -1) {
+    if (received_count == -1) {
       LOG_ERROR("Can't receive from socket: %s", strerror(errno));
       close(sock_fd_);
       raise(SIGINT);
       return;
     }
 
+    for (int i = 0; i < received_count; i++) {
+      if (!handle_incoming_packet(receive_buffers_[i].data(), receive_msgs_[i].msg_len)) {
+        return;
+      }
+    }
+  }
+
+  // Parse one H4 packet and deliver it. Return false if no more packets should be handled.
+  bool handle_incoming_packet(const uint8_t* buf, ssize_t received_size) {
     if (received_size == 0) {
       LOG_WARN("Can't read H4 header. EOF received");
       // First close sock fd before raising sigint
       close(sock_fd_);
       raise(SIGINT);
-      return;
+      return false;
     }
 
     if (buf[0] == kH4Event) {
@@ -420,9 +448,9 @@ class HciHalHost : public HciHal {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an event after processing");
-          return;
+          return false;
         }
-        incoming_packet_callback_->hciEventReceived(receivedHciPacket);
+        incoming_packet_callback_->hciEventReceived(std::move(receivedHciPacket));
       }
     }
 
@@ -445,9 +473,9 @@ class HciHalHost : public HciHal {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an ACL packet after processing");
-          return;
+          return false;
         }
-        incoming_packet_callback_->aclDataReceived(receivedHciPacket);
+        incoming_packet_callback_->aclDataReceived(std::move(receivedHciPacket));
       }
     }
 
@@ -469,9 +497,9 @@ class HciHalHost : public HciHal {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a SCO packet after processing");
-          return;
+          return false;
         }
-        incoming_packet_callback_->scoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->scoDataReceived(std::move(receivedHciPacket));
       }
     }
 
@@ -493,12 +521,12 @@ class HciHalHost : public HciHal {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a ISO packet after processing");
-          return;
+          return false;
         }
-        incoming_packet_callback_->isoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->isoDataReceived(std::move(receivedHciPacket));
       }
     }
-    memset(buf, 0, kBufSize);
+    return true;
   }
 };
 
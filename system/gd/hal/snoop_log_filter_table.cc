@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_filter_table.h"
+
+#include <utility>
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+// Keys only use the low 29 bits, so this never collides with a channel
+constexpr uint32_t kEmptyKey = 0xffffffff;
+constexpr uint16_t kHandleMask = 0x0fff;
+
+uint32_t make_key(uint16_t handle, bool local, uint16_t cid) {
+  return (static_cast<uint32_t>(local) << 28) | (static_cast<uint32_t>(handle & kHandleMask) << 16) | cid;
+}
+
+size_t hash_key(uint32_t key, size_t capacity) {
+  // Fibonacci hashing, capacity is a power of two
+  return static_cast<size_t>(key * 2654435769u) & (capacity - 1);
+}
+
+}  // namespace
+
+SnoopLogFilterTable::SnoopLogFilterTable() : slots_(kMinCapacity, Slot{Decision(), kEmptyKey}) {}
+
+size_t SnoopLogFilterTable::FindSlot(uint32_t key) const {
+  size_t index = hash_key(key, slots_.size());
+  while (slots_[index].key != key && slots_[index].key != kEmptyKey) {
+    index = (index + 1) & (slots_.size() - 1);
+  }
+  return index;
+}
+
+void SnoopLogFilterTable::Grow() {
+  std::vector<Slot> slots(slots_.size() * 2, Slot{Decision(), kEmptyKey});
+  std::swap(slots, slots_);
+  for (const Slot& slot : slots) {
+    if (slot.key != kEmptyKey) {
+      slots_[FindSlot(slot.key)] = slot;
+    }
+  }
+}
+
+void SnoopLogFilterTable::Add(uint16_t handle, bool local, uint16_t cid, const Decision& decision) {
+  // Keep the load factor at or below 1/2 so probe sequences stay short
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  uint32_t key = make_key(handle, local, cid);
+  Slot& slot = slots_[FindSlot(key)];
+  if (slot.key == kEmptyKey) {
+    slot.key = key;
+    size_++;
+  }
+  slot.decision.flags |= decision.flags;
+  slot.decision.rfcomm_dlci_mask |= decision.rfcomm_dlci_mask;
+}
+
+const SnoopLogFilterTable::Decision* SnoopLogFilterTable::Lookup(uint16_t handle, bool local, uint16_t cid) const {
+  const Slot& slot = slots_[FindSlot(make_key(handle, local, cid))];
+  return slot.key == kEmptyKey ? nullptr : &slot.decision;
+}
+
+void SnoopLogFilterTable::Clear() {
+  slots_.assign(kMinCapacity, Slot{Decision(), kEmptyKey});
+  size_ = 0;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+
+// Filtering decisions of the snoop logger, precomputed per (connection handle, direction, L2CAP CID).
+//
+// The table is rebuilt from the channel trackers whenever a channel is opened or closed, so that deciding how to
+// filter a packet costs a single probe into a flat open addressed array instead of several map and set lookups.
+//
+// NOT THREAD SAFE
+class SnoopLogFilterTable {
+ public:
+  // Flags of a decision
+  static constexpr uint8_t kL2capAcceptlisted = 1 << 0;
+  static constexpr uint8_t kRfcommChannel = 1 << 1;
+  static constexpr uint8_t kA2dpMedia = 1 << 2;
+
+  struct Decision {
+    // Bit n is set if RFCOMM DLCI n is acceptlisted, only meaningful for kRfcommChannel
+    uint64_t rfcomm_dlci_mask = 0;
+    uint8_t flags = 0;
+
+    bool IsDlciAcceptlisted(uint8_t dlci) const {
+      return dlci < 64 && (rfcomm_dlci_mask >> dlci) & 1;
+    }
+  };
+
+  SnoopLogFilterTable();
+
+  // Merge |decision| into the decision of the channel, creating it if needed
+  void Add(uint16_t handle, bool local, uint16_t cid, const Decision& decision);
+
+  // Return the decision of the channel, or nullptr if no decision was added for it
+  const Decision* Lookup(uint16_t handle, bool local, uint16_t cid) const;
+
+  void Clear();
+
+  size_t Size() const {
+    return size_;
+  }
+
+ private:
+  struct Slot {
+    Decision decision;
+    uint32_t key;
+  };
+
+  static constexpr size_t kMinCapacity = 16;
+
+  size_t FindSlot(uint32_t key) const;
+  void Grow();
+
+  std::vector<Slot> slots_;
+  size_t size_ = 0;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
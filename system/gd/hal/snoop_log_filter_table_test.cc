@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_filter_table.h"
+
+#include <gtest/gtest.h>
+
+namespace testing {
+
+using bluetooth::hal::SnoopLogFilterTable;
+
+TEST(SnoopLogFilterTableTest, lookup_missing_channel) {
+  SnoopLogFilterTable table;
+  ASSERT_EQ(table.Lookup(0x0001, true, 0x0040), nullptr);
+  ASSERT_EQ(table.Size(), 0u);
+}
+
+TEST(SnoopLogFilterTableTest, lookup_is_per_handle_and_direction) {
+  SnoopLogFilterTable table;
+  table.Add(0x0001, true, 0x0040, {.flags = SnoopLogFilterTable::kL2capAcceptlisted});
+
+  auto decision = table.Lookup(0x0001, true, 0x0040);
+  ASSERT_NE(decision, nullptr);
+  ASSERT_EQ(decision->flags, SnoopLogFilterTable::kL2capAcceptlisted);
+  ASSERT_EQ(table.Lookup(0x0001, false, 0x0040), nullptr);
+  ASSERT_EQ(table.Lookup(0x0002, true, 0x0040), nullptr);
+  // Packet boundary and broadcast flags are not part of the handle
+  ASSERT_NE(table.Lookup(0x2001, true, 0x0040), nullptr);
+}
+
+TEST(SnoopLogFilterTableTest, add_merges_decisions) {
+  SnoopLogFilterTable table;
+  table.Add(0x0001, true, 0x0041, {.rfcomm_dlci_mask = 1, .flags = SnoopLogFilterTable::kRfcommChannel});
+  table.Add(0x0001, true, 0x0041, {.rfcomm_dlci_mask = 1ull << 5, .flags = SnoopLogFilterTable::kL2capAcceptlisted});
+  ASSERT_EQ(table.Size(), 1u);
+
+  auto decision = table.Lookup(0x0001, true, 0x0041);
+  ASSERT_NE(decision, nullptr);
+  ASSERT_EQ(decision->flags, SnoopLogFilterTable::kRfcommChannel | SnoopLogFilterTable::kL2capAcceptlisted);
+  ASSERT_TRUE(decision->IsDlciAcceptlisted(0));
+  ASSERT_TRUE(decision->IsDlciAcceptlisted(5));
+  ASSERT_FALSE(decision->IsDlciAcceptlisted(4));
+  ASSERT_FALSE(decision->IsDlciAcceptlisted(64));
+}
+
+TEST(SnoopLogFilterTableTest, grows_past_initial_capacity) {
+  SnoopLogFilterTable table;
+  for (uint16_t handle = 0; handle < 32; handle++) {
+    for (uint16_t cid = 0x0040; cid < 0x0060; cid++) {
+      table.Add(handle, (cid & 1) != 0, cid, {.flags = SnoopLogFilterTable::kA2dpMedia});
+    }
+  }
+  ASSERT_EQ(table.Size(), 32u * 32);
+  for (uint16_t handle = 0; handle < 32; handle++) {
+    for (uint16_t cid = 0x0040; cid < 0x0060; cid++) {
+      ASSERT_NE(table.Lookup(handle, (cid & 1) != 0, cid), nullptr);
+      ASSERT_EQ(table.Lookup(handle, (cid & 1) == 0, cid), nullptr);
+    }
+  }
+}
+
+TEST(SnoopLogFilterTableTest, clear) {
+  SnoopLogFilterTable table;
+  table.Add(0x0001, true, 0x0040, {.flags = SnoopLogFilterTable::kA2dpMedia});
+  table.Clear();
+  ASSERT_EQ(table.Size(), 0u);
+  ASSERT_EQ(table.Lookup(0x0001, true, 0x0040), nullptr);
+}
+
+}  // namespace testing
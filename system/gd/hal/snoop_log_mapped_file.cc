@@ -0,0 +1,185 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_mapped_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "hal/snoop_logger_common.h"
+#include "os/files.h"
+#include "os/log.h"
+#include "os/utils.h"
+
+namespace bluetooth {
+namespace hal {
+
+struct SnoopLogMappedFile::Trailer {
+  uint8_t magic[8];
+  // Offset of the end of the last complete record
+  uint64_t committed_size;
+};
+
+namespace {
+
+constexpr uint8_t kTrailerMagic[8] = {'b', 't', 's', 'n', 'o', 'i', 'd', 'x'};
+constexpr size_t kFileHeaderSize = sizeof(SnoopLoggerCommon::FileHeaderType);
+
+size_t round_up_file_size(size_t file_size) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t min_size = kFileHeaderSize + sizeof(uint8_t[8]) + sizeof(uint64_t);
+  file_size = std::max(file_size, min_size);
+  return (file_size + page_size - 1) / page_size * page_size;
+}
+
+}  // namespace
+
+SnoopLogMappedFile::SnoopLogMappedFile(std::string log_path, size_t file_size)
+    : log_path_(std::move(log_path)), file_size_(round_up_file_size(file_size)) {}
+
+SnoopLogMappedFile::~SnoopLogMappedFile() {
+  Close();
+}
+
+SnoopLogMappedFile::Trailer* SnoopLogMappedFile::GetTrailer() const {
+  return reinterpret_cast<Trailer*>(map_ + file_size_ - sizeof(Trailer));
+}
+
+bool SnoopLogMappedFile::Open() {
+  Close();
+
+  if (os::FileExists(log_path_)) {
+    Recover(log_path_);
+    auto last_file_path = log_path_ + ".last";
+    if (!os::RenameFile(log_path_, last_file_path)) {
+      LOG_ERROR(
+          "Unabled to rename existing snoop log from \"%s\" to \"%s\"", log_path_.c_str(), last_file_path.c_str());
+    }
+  } else {
+    LOG_INFO("Previous log file \"%s\" does not exist, skip renaming", log_path_.c_str());
+  }
+
+  mode_t prevmask = umask(0);
+  int fd = open(log_path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  umask(prevmask);
+  if (fd < 0) {
+    LOG_ERROR("Unable to open snoop log at \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+    return false;
+  }
+
+  // Allocate all the blocks up front so the file doesn't fragment as it grows
+  int ret = posix_fallocate(fd, 0, file_size_);
+  if (ret != 0) {
+    LOG_WARN("Unable to preallocate \"%s\", error: \"%s\"", log_path_.c_str(), strerror(ret));
+    if (ftruncate(fd, file_size_) != 0) {
+      LOG_ERROR("Unable to resize \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+      close(fd);
+      return false;
+    }
+  }
+
+  void* map = mmap(nullptr, file_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    LOG_ERROR("Unable to map \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  fd_ = fd;
+  map_ = static_cast<uint8_t*>(map);
+
+  memcpy(map_, &SnoopLoggerCommon::kBtSnoopFileHeader, kFileHeaderSize);
+  Trailer* trailer = GetTrailer();
+  memcpy(trailer->magic, kTrailerMagic, sizeof(kTrailerMagic));
+  __atomic_store_n(&trailer->committed_size, kFileHeaderSize, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool SnoopLogMappedFile::Append(const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  ASSERT(IsOpen());
+  Trailer* trailer = GetTrailer();
+  size_t committed_size = trailer->committed_size;
+  if (committed_size + header_length + payload_length > file_size_ - sizeof(Trailer)) {
+    return false;
+  }
+  memcpy(map_ + committed_size, header, header_length);
+  if (payload_length > 0) {
+    memcpy(map_ + committed_size + header_length, payload, payload_length);
+  }
+  // Only publish the record once it is complete
+  __atomic_store_n(&trailer->committed_size, committed_size + header_length + payload_length, __ATOMIC_RELEASE);
+  return true;
+}
+
+void SnoopLogMappedFile::Sync() {
+  if (IsOpen() && msync(map_, file_size_, MS_SYNC) != 0) {
+    LOG_ERROR("Failed to sync \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+  }
+}
+
+void SnoopLogMappedFile::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+  size_t committed_size = GetCommittedSize();
+  munmap(map_, file_size_);
+  map_ = nullptr;
+  if (ftruncate(fd_, committed_size) != 0) {
+    LOG_ERROR("Unable to truncate \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+  }
+  close(fd_);
+  fd_ = -1;
+}
+
+size_t SnoopLogMappedFile::GetCommittedSize() const {
+  return IsOpen() ? GetTrailer()->committed_size : 0;
+}
+
+bool SnoopLogMappedFile::Recover(const std::string& path) {
+  int fd;
+  RUN_NO_INTR(fd = open(path.c_str(), O_RDWR | O_CLOEXEC));
+  if (fd < 0) {
+    return false;
+  }
+  bool recovered = false;
+  struct stat st;
+  Trailer trailer;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= kFileHeaderSize + sizeof(Trailer) &&
+      pread(fd, &trailer, sizeof(trailer), st.st_size - sizeof(trailer)) == static_cast<ssize_t>(sizeof(trailer)) &&
+      memcmp(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic)) == 0 && trailer.committed_size >= kFileHeaderSize &&
+      trailer.committed_size <= st.st_size - sizeof(trailer)) {
+    LOG_INFO(
+        "Recovering \"%s\", truncating it from %zu to %zu bytes",
+        path.c_str(),
+        static_cast<size_t>(st.st_size),
+        static_cast<size_t>(trailer.committed_size));
+    if (ftruncate(fd, trailer.committed_size) == 0) {
+      recovered = true;
+    } else {
+      LOG_ERROR("Unable to truncate \"%s\", error: \"%s\"", path.c_str(), strerror(errno));
+    }
+  }
+  close(fd);
+  return recovered;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bluetooth {
+namespace hal {
+
+// A btsnoop log file preallocated to a fixed size and written through a shared memory mapping.
+//
+// Appending a record is a memcpy followed by an update of the commit index, an 8 byte offset stored in a trailer at
+// the end of the preallocated region (the btsnoop file header has no room for it). The mapping is shared with the
+// page cache, so a crash of this process loses at most the record being copied; pages are written back by the
+// kernel, or by Sync().
+//
+// Close() truncates the file to its committed size, leaving a regular btsnoop file. A file left preallocated by a
+// crash is truncated the same way by Recover(), which Open() runs on the previous file before rotating it to
+// "<path>.last".
+//
+// NOT THREAD SAFE
+class SnoopLogMappedFile {
+ public:
+  SnoopLogMappedFile(std::string log_path, size_t file_size);
+  SnoopLogMappedFile(const SnoopLogMappedFile&) = delete;
+  SnoopLogMappedFile& operator=(const SnoopLogMappedFile&) = delete;
+  ~SnoopLogMappedFile();
+
+  // Rotate the previous log file, then create, preallocate and map a new one starting with the btsnoop file header.
+  // Return false if the file could not be created or mapped.
+  bool Open();
+
+  // Copy one record made of |header| followed by |payload| at the end of the log. Return false if the file is full.
+  bool Append(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  // Write the dirty pages back to storage
+  void Sync();
+
+  // Unmap the file and truncate it to its committed size
+  void Close();
+
+  bool IsOpen() const {
+    return map_ != nullptr;
+  }
+
+  // Size of the btsnoop file header and records committed so far
+  size_t GetCommittedSize() const;
+
+  // Truncate a file left preallocated by a crash to its committed size. Return false if |path| was not such a file.
+  static bool Recover(const std::string& path);
+
+ private:
+  struct Trailer;
+
+  Trailer* GetTrailer() const;
+
+  const std::string log_path_;
+  const size_t file_size_;
+  int fd_ = -1;
+  uint8_t* map_ = nullptr;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
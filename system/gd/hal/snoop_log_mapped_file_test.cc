@@ -0,0 +1,164 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_mapped_file.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "hal/snoop_logger_common.h"
+
+namespace testing {
+
+using bluetooth::hal::SnoopLoggerCommon;
+using bluetooth::hal::SnoopLogMappedFile;
+
+namespace {
+
+constexpr size_t kFileHeaderSize = sizeof(SnoopLoggerCommon::FileHeaderType);
+const std::string kHeader = "header";
+const std::string kPayload = "payload";
+constexpr size_t kRecordSize = 13;
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream stream(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+class SnoopLogMappedFileTest : public Test {
+ protected:
+  void SetUp() override {
+    const testing::TestInfo* const test_info = testing::UnitTest::GetInstance()->current_test_info();
+    log_path_ = std::filesystem::temp_directory_path() / (std::string(test_info->name()) + "_btsnoop_hci.log");
+    last_log_path_ = log_path_.string() + ".last";
+    DeleteLogFiles();
+  }
+
+  void TearDown() override {
+    DeleteLogFiles();
+  }
+
+  bool AppendRecord(SnoopLogMappedFile& file) {
+    return file.Append(kHeader.data(), kHeader.size(), kPayload.data(), kPayload.size());
+  }
+
+  std::filesystem::path log_path_;
+  std::filesystem::path last_log_path_;
+
+ private:
+  void DeleteLogFiles() {
+    std::filesystem::remove(log_path_);
+    std::filesystem::remove(last_log_path_);
+  }
+};
+
+TEST_F(SnoopLogMappedFileTest, open_preallocates_file) {
+  SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+  ASSERT_TRUE(file.Open());
+  ASSERT_EQ(std::filesystem::file_size(log_path_), 64u * 1024);
+  ASSERT_EQ(file.GetCommittedSize(), kFileHeaderSize);
+}
+
+TEST_F(SnoopLogMappedFileTest, close_truncates_to_committed_records) {
+  SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+  ASSERT_TRUE(file.Open());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(AppendRecord(file));
+  }
+  ASSERT_EQ(file.GetCommittedSize(), kFileHeaderSize + 3 * kRecordSize);
+  file.Close();
+
+  std::string content = ReadFile(log_path_);
+  ASSERT_EQ(content.size(), kFileHeaderSize + 3 * kRecordSize);
+  ASSERT_EQ(0, memcmp(content.data(), &SnoopLoggerCommon::kBtSnoopFileHeader, kFileHeaderSize));
+  ASSERT_EQ(content.substr(kFileHeaderSize, kRecordSize), kHeader + kPayload);
+  ASSERT_EQ(content.substr(kFileHeaderSize + 2 * kRecordSize), kHeader + kPayload);
+}
+
+TEST_F(SnoopLogMappedFileTest, append_fails_when_full) {
+  // Rounded up to one page
+  SnoopLogMappedFile file(log_path_.string(), 1);
+  ASSERT_TRUE(file.Open());
+  size_t file_size = std::filesystem::file_size(log_path_);
+  size_t records = 0;
+  while (AppendRecord(file)) {
+    records++;
+  }
+  ASSERT_GT(records, 0u);
+  ASSERT_LE(file.GetCommittedSize(), file_size);
+  ASSERT_EQ(file.GetCommittedSize(), kFileHeaderSize + records * kRecordSize);
+}
+
+TEST_F(SnoopLogMappedFileTest, open_rotates_previous_file) {
+  SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+  ASSERT_TRUE(file.Open());
+  ASSERT_TRUE(AppendRecord(file));
+  ASSERT_TRUE(file.Open());
+  ASSERT_TRUE(AppendRecord(file));
+  ASSERT_TRUE(AppendRecord(file));
+  file.Close();
+
+  ASSERT_EQ(std::filesystem::file_size(last_log_path_), kFileHeaderSize + kRecordSize);
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + 2 * kRecordSize);
+}
+
+TEST_F(SnoopLogMappedFileTest, records_survive_a_crash) {
+  ASSERT_EXIT(
+      {
+        SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+        file.Open();
+        AppendRecord(file);
+        AppendRecord(file);
+        _exit(0);
+      },
+      ExitedWithCode(0),
+      "");
+
+  // The crashed process left the file preallocated
+  ASSERT_EQ(std::filesystem::file_size(log_path_), 64u * 1024);
+  ASSERT_TRUE(SnoopLogMappedFile::Recover(log_path_.string()));
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + 2 * kRecordSize);
+  // Recovering a regular btsnoop file is a no-op
+  ASSERT_FALSE(SnoopLogMappedFile::Recover(log_path_.string()));
+}
+
+TEST_F(SnoopLogMappedFileTest, open_recovers_crashed_file_before_rotating_it) {
+  ASSERT_EXIT(
+      {
+        SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+        file.Open();
+        AppendRecord(file);
+        _exit(0);
+      },
+      ExitedWithCode(0),
+      "");
+
+  SnoopLogMappedFile file(log_path_.string(), 64 * 1024);
+  ASSERT_TRUE(file.Open());
+  file.Close();
+  ASSERT_EQ(std::filesystem::file_size(last_log_path_), kFileHeaderSize + kRecordSize);
+}
+
+}  // namespace testing
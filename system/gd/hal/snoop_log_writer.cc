@@ -0,0 +1,322 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "hal/snoop_logger_common.h"
+#include "os/files.h"
+#include "os/log.h"
+#include "os/utils.h"
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+constexpr size_t kMinBufferSize = 64;
+
+size_t round_up_to_power_of_two(size_t size) {
+  size_t capacity = kMinBufferSize;
+  while (capacity < size) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+SnoopLogWriter::SnoopLogWriter(
+    std::string log_path, size_t max_packets_per_file, FlushPolicy policy, size_t buffer_size)
+    : log_path_(std::move(log_path)),
+      max_packets_per_file_(max_packets_per_file),
+      policy_(policy),
+      capacity_(round_up_to_power_of_two(buffer_size)),
+      ring_(new uint8_t[capacity_]) {
+  batch_.reserve(policy_.max_buffered_bytes);
+}
+
+SnoopLogWriter::~SnoopLogWriter() {
+  Stop();
+}
+
+void SnoopLogWriter::Start() {
+  ASSERT(thread_ == nullptr);
+  OpenNextFile();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+  }
+  thread_ = std::make_unique<std::thread>(&SnoopLogWriter::Run, this);
+}
+
+void SnoopLogWriter::Stop() {
+  if (thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_up_cv_.notify_one();
+    thread_->join();
+    thread_.reset();
+  }
+  // The writer thread is gone, pick up whatever was queued after it last drained
+  Drain();
+  WriteBatch();
+  CloseFile();
+}
+
+bool SnoopLogWriter::Write(const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  uint32_t length = header_length + payload_length;
+  size_t needed = sizeof(length) + length;
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  size_t used = tail - head_.load(std::memory_order_acquire);
+  if (needed > capacity_ - used) {
+    records_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  CopyIn(tail, &length, sizeof(length));
+  CopyIn(tail + sizeof(length), header, header_length);
+  CopyIn(tail + sizeof(length) + header_length, payload, payload_length);
+  tail_.store(tail + needed);
+
+  used += needed;
+  if (used > max_buffer_usage_.load(std::memory_order_relaxed)) {
+    max_buffer_usage_.store(used, std::memory_order_relaxed);
+  }
+  // Only wake the writer up to start the time based flush, or once enough data is pending. Pairs with the
+  // writer_waiting_ store and PendingBytes() check in Run().
+  if ((used == needed || used >= policy_.max_buffered_bytes) && writer_waiting_.load() &&
+      writer_waiting_.exchange(false)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_up_cv_.notify_one();
+  }
+  return true;
+}
+
+bool SnoopLogWriter::FlushBeforeCrash(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (thread_ == nullptr) {
+    return false;
+  }
+  uint64_t request = ++flush_requested_;
+  wake_up_cv_.notify_one();
+  return flushed_cv_.wait_for(lock, timeout, [this, request] { return flush_done_ >= request; });
+}
+
+SnoopLogWriter::Stats SnoopLogWriter::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.records_dropped = records_dropped_.load(std::memory_order_relaxed);
+  stats.max_buffer_usage = max_buffer_usage_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+size_t SnoopLogWriter::PendingBytes() const {
+  return tail_.load() - head_.load();
+}
+
+bool SnoopLogWriter::ShouldWakeUp(bool has_deadline) const {
+  if (stop_ || flush_requested_ != flush_done_) {
+    return true;
+  }
+  // Until the first record arrives there is nothing to time out on
+  return has_deadline ? PendingBytes() >= policy_.max_buffered_bytes : PendingBytes() > 0;
+}
+
+void SnoopLogWriter::Run() {
+  bool stopping = false;
+  while (!stopping) {
+    uint64_t flush_request = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      bool has_deadline = PendingBytes() > 0;
+      auto deadline = std::chrono::steady_clock::now() + policy_.max_buffered_time;
+      while (!ShouldWakeUp(has_deadline)) {
+        writer_waiting_.store(true);
+        // Check again now that producers can see writer_waiting_, a record pushed in between would not notify
+        if (ShouldWakeUp(has_deadline)) {
+          break;
+        }
+        if (!has_deadline) {
+          wake_up_cv_.wait(lock);
+          if (PendingBytes() > 0) {
+            has_deadline = true;
+            deadline = std::chrono::steady_clock::now() + policy_.max_buffered_time;
+          }
+        } else if (wake_up_cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+          break;
+        }
+      }
+      writer_waiting_.store(false);
+      stopping = stop_;
+      flush_request = flush_requested_;
+    }
+
+    Drain();
+    WriteBatch();
+
+    if (flush_request != flush_done_) {
+      if (policy_.fsync_on_crash && fd_ >= 0 && fsync(fd_) != 0) {
+        LOG_ERROR("Failed to sync \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_done_ = flush_request;
+      }
+      flushed_cv_.notify_all();
+    }
+  }
+}
+
+void SnoopLogWriter::Drain() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  size_t tail = tail_.load(std::memory_order_acquire);
+  while (head != tail) {
+    uint32_t length = 0;
+    CopyOut(head, &length, sizeof(length));
+
+    packet_counter_++;
+    if (packet_counter_ > max_packets_per_file_) {
+      WriteBatch();
+      OpenNextFile();
+    }
+
+    size_t offset = batch_.size();
+    batch_.resize(offset + length);
+    CopyOut(head + sizeof(length), batch_.data() + offset, length);
+    batch_records_++;
+    head += sizeof(length) + length;
+    head_.store(head, std::memory_order_release);
+
+    if (batch_.size() >= policy_.max_buffered_bytes) {
+      WriteBatch();
+    }
+    if (head == tail) {
+      tail = tail_.load(std::memory_order_acquire);
+    }
+  }
+}
+
+void SnoopLogWriter::WriteBatch() {
+  uint64_t dropped = records_dropped_.load(std::memory_order_relaxed);
+  if (dropped != reported_drops_) {
+    LOG_WARN("Dropped %" PRIu64 " btsnoop records, the write buffer is full", dropped - reported_drops_);
+    reported_drops_ = dropped;
+  }
+  if (batch_.empty()) {
+    return;
+  }
+
+  WriteToFile(batch_.data(), batch_.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.records_written += batch_records_;
+    stats_.bytes_written += batch_.size();
+    stats_.write_calls++;
+  }
+  batch_.clear();
+  batch_records_ = 0;
+}
+
+void SnoopLogWriter::OpenNextFile() {
+  CloseFile();
+
+  auto last_file_path = log_path_ + ".last";
+  if (os::FileExists(log_path_)) {
+    if (!os::RenameFile(log_path_, last_file_path)) {
+      LOG_ERROR(
+          "Unabled to rename existing snoop log from \"%s\" to \"%s\"", log_path_.c_str(), last_file_path.c_str());
+    }
+  } else {
+    LOG_INFO("Previous log file \"%s\" does not exist, skip renaming", log_path_.c_str());
+  }
+
+  mode_t prevmask = umask(0);
+  // do not use O_APPEND as we want override the existing file
+  fd_ = open(log_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd_ < 0) {
+    LOG_ALWAYS_FATAL("Unable to open snoop log at \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+  }
+  umask(prevmask);
+
+  const auto& header = SnoopLoggerCommon::kBtSnoopFileHeader;
+  ssize_t ret;
+  RUN_NO_INTR(ret = write(fd_, &header, sizeof(header)));
+  if (ret != static_cast<ssize_t>(sizeof(header))) {
+    LOG_ALWAYS_FATAL("Unable to write file header to \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+  }
+}
+
+void SnoopLogWriter::CloseFile() {
+  if (fd_ >= 0) {
+    if (policy_.fsync_on_close && fsync(fd_) != 0) {
+      LOG_ERROR("Failed to sync \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+    }
+    close(fd_);
+    fd_ = -1;
+  }
+  packet_counter_ = 0;
+}
+
+void SnoopLogWriter::WriteToFile(const void* data, size_t length) {
+  if (fd_ < 0) {
+    return;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  while (length > 0) {
+    ssize_t ret;
+    RUN_NO_INTR(ret = write(fd_, bytes, length));
+    if (ret < 0) {
+      LOG_ERROR("Failed to write to \"%s\", error: \"%s\"", log_path_.c_str(), strerror(errno));
+      return;
+    }
+    bytes += ret;
+    length -= ret;
+  }
+}
+
+void SnoopLogWriter::CopyIn(size_t position, const void* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(length, capacity_ - offset);
+  memcpy(ring_.get() + offset, data, first);
+  memcpy(ring_.get(), static_cast<const uint8_t*>(data) + first, length - first);
+}
+
+void SnoopLogWriter::CopyOut(size_t position, void* data, size_t length) const {
+  if (length == 0) {
+    return;
+  }
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(length, capacity_ - offset);
+  memcpy(data, ring_.get() + offset, first);
+  memcpy(static_cast<uint8_t*>(data) + first, ring_.get(), length - first);
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace bluetooth {
+namespace hal {
+
+// Writes btsnoop records to a rotating log file from a dedicated thread.
+//
+// The capturing thread copies each record into a bounded single producer, single consumer ring and returns without
+// any syscall in the common case. The writer thread drains the ring, batches records and writes them out according
+// to the FlushPolicy. When the ring is full, records are dropped and counted rather than blocking the caller.
+//
+// The file format is the same as a synchronous writer would produce: the btsnoop file header followed by the records,
+// with the current file renamed to "<path>.last" once it holds more than |max_packets_per_file| records.
+//
+// Write() must only be called from one thread at a time.
+class SnoopLogWriter {
+ public:
+  static constexpr size_t kDefaultBufferSize = 1024 * 1024;
+  static constexpr size_t kDefaultMaxBufferedBytes = 16 * 1024;
+  static constexpr std::chrono::milliseconds kDefaultMaxBufferedTime{100};
+
+  struct FlushPolicy {
+    // Write the batched records out once this many bytes are pending
+    size_t max_buffered_bytes = kDefaultMaxBufferedBytes;
+    // Write the batched records out at the latest this long after the first of them was captured
+    std::chrono::milliseconds max_buffered_time = kDefaultMaxBufferedTime;
+    // fsync() the log file when it is rotated or closed
+    bool fsync_on_close = false;
+    // fsync() the log file in FlushBeforeCrash()
+    bool fsync_on_crash = true;
+  };
+
+  struct Stats {
+    uint64_t records_written = 0;
+    uint64_t bytes_written = 0;
+    uint64_t write_calls = 0;
+    uint64_t records_dropped = 0;
+    size_t max_buffer_usage = 0;
+  };
+
+  // |buffer_size| bounds the memory used by records not yet written out and is rounded up to a power of two
+  SnoopLogWriter(
+      std::string log_path, size_t max_packets_per_file, FlushPolicy policy, size_t buffer_size = kDefaultBufferSize);
+  SnoopLogWriter(const SnoopLogWriter&) = delete;
+  SnoopLogWriter& operator=(const SnoopLogWriter&) = delete;
+  ~SnoopLogWriter();
+
+  // Rotate the existing log file, open a new one with the btsnoop file header and start the writer thread
+  void Start();
+
+  // Write out every pending record, close the log file and join the writer thread
+  void Stop();
+
+  // Queue one record made of |header| followed by |payload|. Return false if it was dropped because the buffer is full.
+  bool Write(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  // Wait up to |timeout| for the records queued so far to be written out, and synced if FlushPolicy::fsync_on_crash
+  // is set. Return true if they were.
+  bool FlushBeforeCrash(std::chrono::milliseconds timeout);
+
+  Stats GetStats() const;
+
+ private:
+  void Run();
+  size_t PendingBytes() const;
+  bool ShouldWakeUp(bool has_deadline) const;
+  // Move all the records from the ring to the batch, rotating the file as needed
+  void Drain();
+  // Write the batch to the log file
+  void WriteBatch();
+  void OpenNextFile();
+  void CloseFile();
+  void WriteToFile(const void* data, size_t length);
+  void CopyIn(size_t position, const void* data, size_t length);
+  void CopyOut(size_t position, void* data, size_t length) const;
+
+  const std::string log_path_;
+  const size_t max_packets_per_file_;
+  const FlushPolicy policy_;
+  const size_t capacity_;
+  std::unique_ptr<uint8_t[]> ring_;
+  // Total bytes ever consumed and produced. The producer owns tail_ and the writer thread owns head_.
+  std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> tail_ = 0;
+  std::atomic<bool> writer_waiting_ = false;
+  std::atomic<uint64_t> records_dropped_ = 0;
+  std::atomic<size_t> max_buffer_usage_ = 0;
+
+  // Only accessed by the writer thread once started
+  int fd_ = -1;
+  size_t packet_counter_ = 0;
+  std::string batch_;
+  uint64_t batch_records_ = 0;
+  uint64_t reported_drops_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_up_cv_;
+  std::condition_variable flushed_cv_;
+  bool stop_ = false;
+  uint64_t flush_requested_ = 0;
+  uint64_t flush_done_ = 0;
+  Stats stats_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_log_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hal/snoop_logger_common.h"
+
+namespace testing {
+
+using bluetooth::hal::SnoopLoggerCommon;
+using bluetooth::hal::SnoopLogWriter;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t kFileHeaderSize = sizeof(SnoopLoggerCommon::FileHeaderType);
+const std::string kHeader = "header";
+const std::string kPayload = "payload";
+constexpr size_t kRecordSize = 13;
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream stream(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+class SnoopLogWriterTest : public Test {
+ protected:
+  void SetUp() override {
+    const testing::TestInfo* const test_info = testing::UnitTest::GetInstance()->current_test_info();
+    log_path_ = std::filesystem::temp_directory_path() / (std::string(test_info->name()) + "_btsnoop_hci.log");
+    last_log_path_ = log_path_.string() + ".last";
+    DeleteLogFiles();
+  }
+
+  void TearDown() override {
+    DeleteLogFiles();
+  }
+
+  void WriteRecord(SnoopLogWriter& writer) {
+    ASSERT_TRUE(writer.Write(kHeader.data(), kHeader.size(), kPayload.data(), kPayload.size()));
+  }
+
+  std::filesystem::path log_path_;
+  std::filesystem::path last_log_path_;
+
+ private:
+  void DeleteLogFiles() {
+    std::filesystem::remove(log_path_);
+    std::filesystem::remove(last_log_path_);
+  }
+};
+
+TEST_F(SnoopLogWriterTest, start_writes_file_header) {
+  SnoopLogWriter writer(log_path_.string(), 10, SnoopLogWriter::FlushPolicy());
+  writer.Start();
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize);
+  writer.Stop();
+
+  std::string content = ReadFile(log_path_);
+  ASSERT_EQ(content.size(), kFileHeaderSize);
+  ASSERT_EQ(0, memcmp(content.data(), &SnoopLoggerCommon::kBtSnoopFileHeader, kFileHeaderSize));
+}
+
+TEST_F(SnoopLogWriterTest, stop_writes_out_pending_records) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_time = 1h;
+  SnoopLogWriter writer(log_path_.string(), 10, policy);
+  writer.Start();
+  for (int i = 0; i < 3; i++) {
+    WriteRecord(writer);
+  }
+  writer.Stop();
+
+  std::string content = ReadFile(log_path_);
+  ASSERT_EQ(content.size(), kFileHeaderSize + 3 * kRecordSize);
+  ASSERT_EQ(content.substr(kFileHeaderSize, kRecordSize), kHeader + kPayload);
+  ASSERT_EQ(writer.GetStats().records_written, 3u);
+}
+
+TEST_F(SnoopLogWriterTest, records_are_written_out_after_max_buffered_time) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_time = 10ms;
+  SnoopLogWriter writer(log_path_.string(), 10, policy);
+  writer.Start();
+  WriteRecord(writer);
+
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (std::filesystem::file_size(log_path_) < kFileHeaderSize + kRecordSize &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + kRecordSize);
+  writer.Stop();
+}
+
+TEST_F(SnoopLogWriterTest, records_are_batched) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_bytes = 10 * kRecordSize;
+  policy.max_buffered_time = 1h;
+  SnoopLogWriter writer(log_path_.string(), 1000, policy);
+  writer.Start();
+  for (int i = 0; i < 100; i++) {
+    WriteRecord(writer);
+  }
+  writer.Stop();
+
+  auto stats = writer.GetStats();
+  ASSERT_EQ(stats.records_written, 100u);
+  ASSERT_EQ(stats.bytes_written, 100 * kRecordSize);
+  ASSERT_LE(stats.write_calls, 25u);
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + 100 * kRecordSize);
+}
+
+TEST_F(SnoopLogWriterTest, flush_before_crash_writes_out_queued_records) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_time = 1h;
+  SnoopLogWriter writer(log_path_.string(), 10, policy);
+  writer.Start();
+  WriteRecord(writer);
+  WriteRecord(writer);
+  ASSERT_TRUE(writer.FlushBeforeCrash(5s));
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + 2 * kRecordSize);
+  writer.Stop();
+}
+
+TEST_F(SnoopLogWriterTest, rotate_file_after_max_packets) {
+  SnoopLogWriter writer(log_path_.string(), 10, SnoopLogWriter::FlushPolicy());
+  writer.Start();
+  for (int i = 0; i < 11; i++) {
+    WriteRecord(writer);
+  }
+  writer.Stop();
+
+  ASSERT_EQ(std::filesystem::file_size(last_log_path_), kFileHeaderSize + 10 * kRecordSize);
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + 1 * kRecordSize);
+}
+
+TEST_F(SnoopLogWriterTest, start_rotates_previous_file) {
+  {
+    SnoopLogWriter writer(log_path_.string(), 10, SnoopLogWriter::FlushPolicy());
+    writer.Start();
+    WriteRecord(writer);
+    writer.Stop();
+  }
+  SnoopLogWriter writer(log_path_.string(), 10, SnoopLogWriter::FlushPolicy());
+  writer.Start();
+  writer.Stop();
+
+  ASSERT_EQ(std::filesystem::file_size(last_log_path_), kFileHeaderSize + kRecordSize);
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize);
+}
+
+TEST_F(SnoopLogWriterTest, records_are_dropped_when_buffer_is_full) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_bytes = 1024;
+  policy.max_buffered_time = 1h;
+  // Room for 3 records of 4 + 13 bytes
+  SnoopLogWriter writer(log_path_.string(), 1000, policy, 64);
+  writer.Start();
+  size_t written = 0;
+  for (int i = 0; i < 8; i++) {
+    if (writer.Write(kHeader.data(), kHeader.size(), kPayload.data(), kPayload.size())) {
+      written++;
+    }
+  }
+  writer.Stop();
+
+  auto stats = writer.GetStats();
+  ASSERT_EQ(written, 3u);
+  ASSERT_EQ(stats.records_dropped, 5u);
+  ASSERT_EQ(stats.records_written, written);
+  ASSERT_EQ(std::filesystem::file_size(log_path_), kFileHeaderSize + written * kRecordSize);
+}
+
+TEST_F(SnoopLogWriterTest, concurrent_producer_keeps_records_in_order) {
+  SnoopLogWriter::FlushPolicy policy;
+  policy.max_buffered_bytes = 256;
+  policy.max_buffered_time = 1ms;
+  SnoopLogWriter writer(log_path_.string(), 100000, policy, 4096);
+  writer.Start();
+  uint32_t sent = 0;
+  for (uint32_t i = 0; i < 20000; i++) {
+    if (writer.Write(&i, sizeof(i), nullptr, 0)) {
+      sent++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  writer.Stop();
+
+  std::string content = ReadFile(log_path_);
+  ASSERT_EQ(content.size(), kFileHeaderSize + sent * sizeof(uint32_t));
+  uint32_t previous = 0;
+  for (size_t offset = kFileHeaderSize; offset < content.size(); offset += sizeof(uint32_t)) {
+    uint32_t value;
+    memcpy(&value, content.data() + offset, sizeof(value));
+    if (offset != kFileHeaderSize) {
+      ASSERT_LT(previous, value);
+    }
+    previous = value;
+  }
+}
+
+}  // namespace testing
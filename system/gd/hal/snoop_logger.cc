@@ -22,11 +22,14 @@
 #include <algorithm>
 #include <bitset>
 #include <chrono>
+#include <cinttypes>
+#include <mutex>
 #include <sstream>
 
 #include "common/circular_buffer.h"
 #include "common/init_flags.h"
 #include "common/strings.h"
+#include "hal/snoop_log_filter_table.h"
 #include "hal/snoop_logger_common.h"
 #include "module_dumper_flatbuffer.h"
 #include "os/files.h"
@@ -313,6 +316,59 @@ std::mutex snoop_log_filters_mutex;
 
 std::mutex profiles_filter_mutex;
 std::unordered_map<int16_t, ProfilesFilter> profiles_filter_table;
+
+// Decisions derived from filter_tracker_list and a2dpMediaChannels, looked up for every filtered ACL packet
+std::mutex filter_table_mutex;
+SnoopLogFilterTable filter_table;
+
+// Rebuild filter_table after a channel was opened or closed. Must be called without holding
+// filter_tracker_list_mutex or a2dpMediaChannels_mutex.
+void rebuild_filter_table() {
+  std::scoped_lock lock(filter_tracker_list_mutex, a2dpMediaChannels_mutex);
+  SnoopLogFilterTable table;
+  for (const auto& [handle, tracker] : filter_tracker_list) {
+    for (bool local : {true, false}) {
+      // Always add the CIDs a connection without tracker falls back on, see default_filter_decision()
+      table.Add(handle, local, 0, {});
+      table.Add(handle, local, 1, {});
+      for (uint16_t cid : local ? tracker.l2c_local_cid : tracker.l2c_remote_cid) {
+        table.Add(handle, local, cid, {.flags = SnoopLogFilterTable::kL2capAcceptlisted});
+      }
+      SnoopLogFilterTable::Decision rfcomm = {.flags = SnoopLogFilterTable::kRfcommChannel};
+      for (uint16_t dlci : tracker.rfcomm_channels) {
+        if (dlci < 64) {
+          rfcomm.rfcomm_dlci_mask |= 1ull << dlci;
+        }
+      }
+      table.Add(handle, local, local ? tracker.rfcomm_local_cid : tracker.rfcomm_remote_cid, rfcomm);
+    }
+  }
+  for (const auto& channel : a2dpMediaChannels) {
+    table.Add(channel.conn_handle, true, channel.local_cid, {.flags = SnoopLogFilterTable::kA2dpMedia});
+    table.Add(channel.conn_handle, false, channel.remote_cid, {.flags = SnoopLogFilterTable::kA2dpMedia});
+  }
+
+  std::lock_guard<std::mutex> table_lock(filter_table_mutex);
+  std::swap(filter_table, table);
+}
+
+// Decision for a connection with no tracker, which behaves as a default constructed FilterTracker: only the L2CAP
+// signaling channel is acceptlisted and RFCOMM is not set up (CID 0 with DLCI 0).
+SnoopLogFilterTable::Decision default_filter_decision(uint16_t cid) {
+  if (cid == 0) {
+    return {.rfcomm_dlci_mask = 1, .flags = SnoopLogFilterTable::kRfcommChannel};
+  }
+  if (cid == 1) {
+    return {.flags = SnoopLogFilterTable::kL2capAcceptlisted};
+  }
+  return {};
+}
+
+SnoopLogFilterTable::Decision get_filter_decision(uint16_t conn_handle, bool local, uint16_t cid) {
+  std::lock_guard<std::mutex> lock(filter_table_mutex);
+  const SnoopLogFilterTable::Decision* decision = filter_table.Lookup(conn_handle, local, cid);
+  return decision != nullptr ? *decision : default_filter_decision(cid);
+}
 constexpr const char* payload_fill_magic = "PROHIBITED";
 constexpr const char* cpbr_pattern = "\x0d\x0a+CPBR:";
 constexpr const char* clcc_pattern = "\x0d\x0a+CLCC:";
@@ -433,6 +489,10 @@ size_t get_btsnooz_packet_length_to_write(
 
 // system properties
 const std::string SnoopLogger::kBtSnoopMaxPacketsPerFileProperty = "persist.bluetooth.btsnoopsize";
+const std::string SnoopLogger::kBtSnoopFlushBytesProperty = "persist.bluetooth.btsnoopflushbytes";
+const std::string SnoopLogger::kBtSnoopFlushIntervalProperty = "persist.bluetooth.btsnoopflushintervalms";
+const std::string SnoopLogger::kBtSnoopFsyncOnCloseProperty = "persist.bluetooth.btsnoopfsynconclose";
+const std::string SnoopLogger::kBtSnoopPreallocatedFileSizeProperty = "persist.bluetooth.btsnooppreallocsize";
 const std::string SnoopLogger::kIsDebuggableProperty = "ro.debuggable";
 const std::string SnoopLogger::kBtSnoopLogModeProperty = "persist.bluetooth.btsnooplogmode";
 const std::string SnoopLogger::kBtSnoopDefaultLogModeProperty = "persist.bluetooth.btsnoopdefaultmode";
@@ -486,11 +546,16 @@ SnoopLogger::SnoopLogger(
     bool qualcomm_debug_log_enabled,
     const std::chrono::milliseconds snooz_log_life_time,
     const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-    bool snoop_log_persists)
+    bool snoop_log_persists,
+    SnoopLogWriter::FlushPolicy flush_policy,
+    size_t preallocated_file_size)
     : snoop_log_path_(std::move(snoop_log_path)),
       snooz_log_path_(std::move(snooz_log_path)),
       max_packets_per_file_(max_packets_per_file),
-      btsnooz_buffer_(max_packets_per_buffer),
+      flush_policy_(flush_policy),
+      preallocated_file_size_(preallocated_file_size),
+      // Same memory budget as max_packets_per_buffer uncompressed packets, holding many more compressed
+      btsnooz_buffer_(max_packets_per_buffer * kDefaultBtSnoozMaxBytesPerPacket),
       qualcomm_debug_log_enabled_(qualcomm_debug_log_enabled),
       snooz_log_life_time_(snooz_log_life_time),
       snooz_log_delete_alarm_interval_(snooz_log_delete_alarm_interval),
@@ -525,52 +590,6 @@ SnoopLogger::SnoopLogger(
   snoop_log_path_ = get_btsnoop_log_path(snoop_log_path_, btsnoop_mode_ == kBtSnoopLogModeFiltered);
 }
 
-void SnoopLogger::CloseCurrentSnoopLogFile() {
-  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
-  if (btsnoop_ostream_.is_open()) {
-    btsnoop_ostream_.flush();
-    btsnoop_ostream_.close();
-  }
-  packet_counter_ = 0;
-}
-
-void SnoopLogger::OpenNextSnoopLogFile() {
-  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
-  CloseCurrentSnoopLogFile();
-
-  auto last_file_path = get_last_log_path(snoop_log_path_);
-
-  if (os::FileExists(snoop_log_path_)) {
-    if (!os::RenameFile(snoop_log_path_, last_file_path)) {
-      LOG_ERROR(
-          "Unabled to rename existing snoop log from \"%s\" to \"%s\"",
-          snoop_log_path_.c_str(),
-          last_file_path.c_str());
-    }
-  } else {
-    LOG_INFO("Previous log file \"%s\" does not exist, skip renaming", snoop_log_path_.c_str());
-  }
-
-  mode_t prevmask = umask(0);
-  // do not use std::ios::app as we want override the existing file
-  btsnoop_ostream_.open(snoop_log_path_, std::ios::binary | std::ios::out);
-#ifdef USE_FAKE_TIMERS
-  file_creation_time = fake_timerfd_get_clock();
-#endif
-  if (!btsnoop_ostream_.good()) {
-    LOG_ALWAYS_FATAL("Unable to open snoop log at \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
-  }
-  umask(prevmask);
-  if (!btsnoop_ostream_.write(
-          reinterpret_cast<const char*>(&SnoopLoggerCommon::kBtSnoopFileHeader),
-          sizeof(SnoopLoggerCommon::FileHeaderType))) {
-    LOG_ALWAYS_FATAL("Unable to write file header to \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
-  }
-  if (!btsnoop_ostream_.flush()) {
-    LOG_ERROR("Failed to flush, error: \"%s\"", strerror(errno));
-  }
-}
-
 void SnoopLogger::EnableFilters() {
   if (btsnoop_mode_ != kBtSnoopLogModeFiltered) {
     return;
@@ -624,20 +643,19 @@ bool SnoopLogger::IsFilterEnabled(std::string filter_name) {
 bool SnoopLogger::ShouldFilterLog(bool is_received, uint8_t* packet) {
   uint16_t conn_handle =
       ((((uint16_t)packet[ACL_CHANNEL_OFFSET + 1]) << 8) + packet[ACL_CHANNEL_OFFSET]) & 0x0fff;
-  std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
-  auto& filters = filter_tracker_list[conn_handle];
   uint16_t cid = (packet[L2CAP_CHANNEL_OFFSET + 1] << 8) + packet[L2CAP_CHANNEL_OFFSET];
-  if (filters.IsRfcommChannel(is_received, cid)) {
+  auto decision = get_filter_decision(conn_handle, is_received, cid);
+  if (decision.flags & SnoopLogFilterTable::kRfcommChannel) {
     uint8_t rfcomm_event = packet[RFCOMM_EVENT_OFFSET] & 0b11101111;
     if (rfcomm_event == RFCOMM_SABME || rfcomm_event == RFCOMM_UA) {
       return false;
     }
 
     uint8_t rfcomm_dlci = packet[RFCOMM_CHANNEL_OFFSET] >> 2;
-    if (!filters.IsAcceptlistedDlci(rfcomm_dlci)) {
+    if (!decision.IsDlciAcceptlisted(rfcomm_dlci)) {
       return true;
     }
-  } else if (!filters.IsAcceptlistedL2cap(is_received, cid)) {
+  } else if (!(decision.flags & SnoopLogFilterTable::kL2capAcceptlisted)) {
     return true;
   }
 
@@ -884,11 +902,14 @@ void SnoopLogger::AcceptlistL2capChannel(
       conn_handle,
       local_cid,
       remote_cid);
-  std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
+  {
+    std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
 
-  // This will create the entry if there is no associated filter with the
-  // connection.
-  filter_tracker_list[conn_handle].AddL2capCid(local_cid, remote_cid);
+    // This will create the entry if there is no associated filter with the
+    // connection.
+    filter_tracker_list[conn_handle].AddL2capCid(local_cid, remote_cid);
+  }
+  rebuild_filter_table();
 }
 
 void SnoopLogger::AcceptlistRfcommDlci(uint16_t conn_handle, uint16_t local_cid, uint8_t dlci) {
@@ -898,9 +919,11 @@ void SnoopLogger::AcceptlistRfcommDlci(uint16_t conn_handle, uint16_t local_cid,
   }
 
   LOG_DEBUG("Acceptlisting rfcomm channel: local cid=%d, dlci=%d", local_cid, dlci);
-  std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
-
-  filter_tracker_list[conn_handle].AddRfcommDlci(dlci);
+  {
+    std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
+    filter_tracker_list[conn_handle].AddRfcommDlci(dlci);
+  }
+  rebuild_filter_table();
 }
 
 void SnoopLogger::AddRfcommL2capChannel(
@@ -915,10 +938,12 @@ void SnoopLogger::AddRfcommL2capChannel(
       conn_handle,
       local_cid,
       remote_cid);
-  std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
-
-  filter_tracker_list[conn_handle].SetRfcommCid(local_cid, remote_cid);
-  local_cid_to_acl.insert({local_cid, conn_handle});
+  {
+    std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
+    filter_tracker_list[conn_handle].SetRfcommCid(local_cid, remote_cid);
+    local_cid_to_acl.insert({local_cid, conn_handle});
+  }
+  rebuild_filter_table();
 }
 
 void SnoopLogger::ClearL2capAcceptlist(
@@ -933,9 +958,11 @@ void SnoopLogger::ClearL2capAcceptlist(
       conn_handle,
       local_cid,
       remote_cid);
-  std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
-
-  filter_tracker_list[conn_handle].RemoveL2capCid(local_cid, remote_cid);
+  {
+    std::lock_guard<std::mutex> lock(filter_tracker_list_mutex);
+    filter_tracker_list[conn_handle].RemoveL2capCid(local_cid, remote_cid);
+  }
+  rebuild_filter_table();
 }
 
 bool SnoopLogger::IsA2dpMediaChannel(uint16_t conn_handle, uint16_t cid, bool is_local_cid) {
@@ -968,7 +995,7 @@ bool SnoopLogger::IsA2dpMediaPacket(bool is_received, uint8_t* packet) {
   conn_handle = (uint16_t)((packet[0] + (packet[1] << 8)) & 0x0FFF);
   cid = (uint16_t)(packet[6] + (packet[7] << 8));
 
-  return IsA2dpMediaChannel(conn_handle, cid, is_local_cid);
+  return get_filter_decision(conn_handle, is_local_cid, cid).flags & SnoopLogFilterTable::kA2dpMedia;
 }
 
 void SnoopLogger::AddA2dpMediaChannel(
@@ -984,8 +1011,11 @@ void SnoopLogger::AddA2dpMediaChannel(
         conn_handle,
         local_cid,
         remote_cid);
-    std::lock_guard<std::mutex> lock(a2dpMediaChannels_mutex);
-    a2dpMediaChannels.push_back({conn_handle, local_cid, remote_cid});
+    {
+      std::lock_guard<std::mutex> lock(a2dpMediaChannels_mutex);
+      a2dpMediaChannels.push_back({conn_handle, local_cid, remote_cid});
+    }
+    rebuild_filter_table();
   }
 }
 
@@ -995,15 +1025,18 @@ void SnoopLogger::RemoveA2dpMediaChannel(uint16_t conn_handle, uint16_t local_ci
     return;
   }
 
-  std::lock_guard<std::mutex> lock(a2dpMediaChannels_mutex);
-  a2dpMediaChannels.erase(
-      std::remove_if(
-          a2dpMediaChannels.begin(),
-          a2dpMediaChannels.end(),
-          [conn_handle, local_cid](auto& el) {
-            return (el.conn_handle == conn_handle && el.local_cid == local_cid);
-          }),
-      a2dpMediaChannels.end());
+  {
+    std::lock_guard<std::mutex> lock(a2dpMediaChannels_mutex);
+    a2dpMediaChannels.erase(
+        std::remove_if(
+            a2dpMediaChannels.begin(),
+            a2dpMediaChannels.end(),
+            [conn_handle, local_cid](auto& el) {
+              return (el.conn_handle == conn_handle && el.local_cid == local_cid);
+            }),
+        a2dpMediaChannels.end());
+  }
+  rebuild_filter_table();
 }
 
 void SnoopLogger::SetRfcommPortOpen(
@@ -1243,32 +1276,65 @@ void SnoopLogger::Capture(HciPacket& packet, Direction direction, PacketType typ
       header.length_captured = htonl(length);
     }
 
-    packet_counter_++;
-    if (packet_counter_ > max_packets_per_file_) {
-      OpenNextSnoopLogFile();
-    }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
-      LOG_ERROR("Failed to write packet header for btsnoop, error: \"%s\"", strerror(errno));
-    }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), length - 1)) {
-      LOG_ERROR("Failed to write packet payload for btsnoop, error: \"%s\"", strerror(errno));
+    // Either copy the record into the preallocated file mapping, or hand it to the writer thread which batches the
+    // records and rotates the file every max_packets_per_file_ packets. Both keep syscalls off this thread.
+    if (btsnoop_mapped_file_ != nullptr) {
+      AppendToMappedFile(header, packet.data(), length - 1);
+    } else if (btsnoop_writer_ != nullptr) {
+      btsnoop_writer_->Write(&header, sizeof(PacketHeaderType), packet.data(), length - 1);
     }
 
     if (socket_ != nullptr) {
       socket_->Write(&header, sizeof(PacketHeaderType));
       socket_->Write(packet.data(), (size_t)(length - 1));
     }
+  }
+}
 
-    // std::ofstream::flush() pushes user data into kernel memory. The data will be written even if this process
-    // crashes. However, data will be lost if there is a kernel panic, which is out of scope of BT snoop log.
-    // NOTE: std::ofstream::write() followed by std::ofstream::flush() has similar effect as UNIX write(fd, data, len)
-    //       as write() syscall dumps data into kernel memory directly
-    if (!btsnoop_ostream_.flush()) {
-      LOG_ERROR("Failed to flush, error: \"%s\"", strerror(errno));
+void SnoopLogger::AppendToMappedFile(const PacketHeaderType& header, const uint8_t* payload, size_t payload_length) {
+  packet_counter_++;
+  bool appended = false;
+  if (packet_counter_ <= max_packets_per_file_) {
+    appended = btsnoop_mapped_file_->Append(&header, sizeof(PacketHeaderType), payload, payload_length);
+  }
+  if (!appended) {
+    OpenBtSnoopLog();
+    if (btsnoop_mapped_file_ != nullptr) {
+      if (!btsnoop_mapped_file_->Append(&header, sizeof(PacketHeaderType), payload, payload_length)) {
+        LOG_ERROR("Dropped a %zu bytes packet larger than the btsnoop file", payload_length);
+      }
+    } else if (btsnoop_writer_ != nullptr) {
+      btsnoop_writer_->Write(&header, sizeof(PacketHeaderType), payload, payload_length);
     }
   }
 }
 
+void SnoopLogger::OpenBtSnoopLog() {
+  packet_counter_ = 0;
+  if (preallocated_file_size_ > 0 && btsnoop_writer_ == nullptr) {
+    if (btsnoop_mapped_file_ == nullptr) {
+      btsnoop_mapped_file_ = std::make_unique<SnoopLogMappedFile>(snoop_log_path_, preallocated_file_size_);
+    }
+    if (btsnoop_mapped_file_->Open()) {
+      return;
+    }
+    LOG_ERROR("Unable to use a preallocated btsnoop file, falling back to buffered writes");
+    btsnoop_mapped_file_.reset();
+  }
+  btsnoop_writer_ = std::make_unique<SnoopLogWriter>(snoop_log_path_, max_packets_per_file_, flush_policy_);
+  btsnoop_writer_->Start();
+}
+
+void SnoopLogger::FlushBeforeCrash(std::chrono::milliseconds timeout) {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  if (btsnoop_mapped_file_ != nullptr && flush_policy_.fsync_on_crash) {
+    btsnoop_mapped_file_->Sync();
+  }
+  if (btsnoop_writer_ != nullptr && !btsnoop_writer_->FlushBeforeCrash(timeout)) {
+    LOG_ERROR("Timed out writing out btsnoop log before crashing");
+  }
+}
+
 void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (btsnoop_mode_ != kBtSnoopLogModeDisabled) {
@@ -1318,7 +1384,10 @@ void SnoopLogger::ListDependencies(ModuleList* /* list */) const {
 void SnoopLogger::Start() {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (btsnoop_mode_ != kBtSnoopLogModeDisabled) {
-    OpenNextSnoopLogFile();
+    OpenBtSnoopLog();
+#ifdef USE_FAKE_TIMERS
+    file_creation_time = fake_timerfd_get_clock();
+#endif
 
     if (btsnoop_mode_ == kBtSnoopLogModeFiltered) {
       EnableFilters();
@@ -1345,7 +1414,24 @@ void SnoopLogger::Start() {
 void SnoopLogger::Stop() {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   LOG_DEBUG("Closing btsnoop log data at %s", snoop_log_path_.c_str());
-  CloseCurrentSnoopLogFile();
+  if (btsnoop_mapped_file_ != nullptr) {
+    if (flush_policy_.fsync_on_close) {
+      btsnoop_mapped_file_->Sync();
+    }
+    btsnoop_mapped_file_->Close();
+    btsnoop_mapped_file_.reset();
+  }
+  if (btsnoop_writer_ != nullptr) {
+    btsnoop_writer_->Stop();
+    auto stats = btsnoop_writer_->GetStats();
+    LOG_INFO(
+        "Wrote %" PRIu64 " btsnoop records in %" PRIu64 " writes, dropped %" PRIu64 ", max buffer usage %zu bytes",
+        stats.records_written,
+        stats.write_calls,
+        stats.records_dropped,
+        stats.max_buffer_usage);
+    btsnoop_writer_.reset();
+  }
 
   if (snoop_logger_socket_thread_ != nullptr) {
     snoop_logger_socket_thread_->Stop();
@@ -1389,6 +1475,37 @@ size_t SnoopLogger::GetMaxPacketsPerFile() {
   return max_packets_per_file;
 }
 
+SnoopLogWriter::FlushPolicy SnoopLogger::GetFlushPolicy() {
+  SnoopLogWriter::FlushPolicy policy;
+  auto flush_bytes_prop = os::GetSystemProperty(kBtSnoopFlushBytesProperty);
+  if (flush_bytes_prop) {
+    auto flush_bytes = common::Uint64FromString(flush_bytes_prop.value());
+    if (flush_bytes) {
+      policy.max_buffered_bytes = flush_bytes.value();
+    }
+  }
+  auto flush_interval_prop = os::GetSystemProperty(kBtSnoopFlushIntervalProperty);
+  if (flush_interval_prop) {
+    auto flush_interval_ms = common::Uint64FromString(flush_interval_prop.value());
+    if (flush_interval_ms) {
+      policy.max_buffered_time = std::chrono::milliseconds(flush_interval_ms.value());
+    }
+  }
+  policy.fsync_on_close = os::GetSystemPropertyBool(kBtSnoopFsyncOnCloseProperty, policy.fsync_on_close);
+  return policy;
+}
+
+size_t SnoopLogger::GetPreallocatedFileSize() {
+  auto preallocated_file_size_prop = os::GetSystemProperty(kBtSnoopPreallocatedFileSizeProperty);
+  if (preallocated_file_size_prop) {
+    auto preallocated_file_size = common::Uint64FromString(preallocated_file_size_prop.value());
+    if (preallocated_file_size) {
+      return preallocated_file_size.value();
+    }
+  }
+  return 0;
+}
+
 size_t SnoopLogger::GetMaxPacketsPerBuffer() {
   // We want to use at most 256 KB memory for btsnooz log for release builds
   // and 512 KB memory for userdebug/eng builds
@@ -1465,7 +1582,9 @@ const ModuleFactory SnoopLogger::Factory = ModuleFactory([]() {
       IsQualcommDebugLogEnabled(),
       kBtSnoozLogLifeTime,
       kBtSnoozLogDeleteRepeatingAlarmInterval,
-      IsBtSnoopLogPersisted());
+      IsBtSnoopLogPersisted(),
+      GetFlushPolicy(),
+      GetPreallocatedFileSize());
 });
 
 }  // namespace hal
@@ -21,8 +21,10 @@
 #include <unordered_map>
 #include <unordered_set>
 
-#include "common/circular_buffer.h"
+#include "common/compressed_circular_buffer.h"
 #include "hal/hci_hal.h"
+#include "hal/snoop_log_mapped_file.h"
+#include "hal/snoop_log_writer.h"
 #include "hal/snoop_logger_socket_interface.h"
 #include "hal/snoop_logger_socket_thread.h"
 #include "hal/syscall_wrapper_impl.h"
@@ -141,6 +143,10 @@ class SnoopLogger : public ::bluetooth::Module {
   static const ModuleFactory Factory;
 
   static const std::string kBtSnoopMaxPacketsPerFileProperty;
+  static const std::string kBtSnoopFlushBytesProperty;
+  static const std::string kBtSnoopFlushIntervalProperty;
+  static const std::string kBtSnoopFsyncOnCloseProperty;
+  static const std::string kBtSnoopPreallocatedFileSizeProperty;
   static const std::string kIsDebuggableProperty;
   static const std::string kBtSnoopLogModeProperty;
   static const std::string kBtSnoopLogPersists;
@@ -195,6 +201,14 @@ class SnoopLogger : public ::bluetooth::Module {
 
   static size_t GetMaxPacketsPerBuffer();
 
+  // Returns when the btsnoop log writer thread writes captured packets out
+  // Changes to this value is only effective after restarting Bluetooth
+  static SnoopLogWriter::FlushPolicy GetFlushPolicy();
+
+  // Returns the size of the preallocated, memory mapped btsnoop files, 0 to write them with SnoopLogWriter instead
+  // Changes to this value is only effective after restarting Bluetooth
+  static size_t GetPreallocatedFileSize();
+
   // Get snoop logger mode based on current system setup
   // Changes to this values is only effective after restarting Bluetooth
   static std::string GetBtSnoopMode();
@@ -222,6 +236,9 @@ class SnoopLogger : public ::bluetooth::Module {
 
   void Capture(HciPacket& packet, Direction direction, PacketType type);
 
+  // Write out the packets captured so far before an intentional crash, waiting at most |timeout|
+  void FlushBeforeCrash(std::chrono::milliseconds timeout);
+
   // Set a L2CAP channel as acceptlisted, allowing packets with that L2CAP CID
   // to show up in the snoop logs.
   void AcceptlistL2capChannel(uint16_t conn_handle, uint16_t local_cid, uint16_t remote_cid);
@@ -287,10 +304,14 @@ class SnoopLogger : public ::bluetooth::Module {
       bool qualcomm_debug_log_enabled,
       const std::chrono::milliseconds snooz_log_life_time,
       const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-      bool snoop_log_persists);
-  void CloseCurrentSnoopLogFile();
-  void OpenNextSnoopLogFile();
+      bool snoop_log_persists,
+      SnoopLogWriter::FlushPolicy flush_policy = SnoopLogWriter::FlushPolicy(),
+      size_t preallocated_file_size = 0);
   void DumpSnoozLogToFile(const std::vector<std::string>& data) const;
+  // Open the btsnoop log in the configured mode
+  void OpenBtSnoopLog();
+  // Append a record to the preallocated btsnoop file, rotating it when it is full or has max_packets_per_file_ packets
+  void AppendToMappedFile(const PacketHeaderType& header, const uint8_t* payload, size_t payload_length);
   // Enable filters according to their sysprops
   void EnableFilters();
   // Disable all filters
@@ -336,11 +357,14 @@ class SnoopLogger : public ::bluetooth::Module {
   static std::string btsnoop_mode_;
   std::string snoop_log_path_;
   std::string snooz_log_path_;
-  std::ofstream btsnoop_ostream_;
+  std::unique_ptr<SnoopLogWriter> btsnoop_writer_;
+  std::unique_ptr<SnoopLogMappedFile> btsnoop_mapped_file_;
   size_t max_packets_per_file_;
-  common::CircularBuffer<std::string> btsnooz_buffer_;
-  bool qualcomm_debug_log_enabled_ = false;
+  SnoopLogWriter::FlushPolicy flush_policy_;
+  size_t preallocated_file_size_;
   size_t packet_counter_ = 0;
+  common::CompressedCircularBuffer btsnooz_buffer_;
+  bool qualcomm_debug_log_enabled_ = false;
   mutable std::recursive_mutex file_mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   std::chrono::milliseconds snooz_log_life_time_;
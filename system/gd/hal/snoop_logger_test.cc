@@ -111,6 +111,7 @@ std::vector<bluetooth::hal::HciPacket> kTestData = {
 
 using bluetooth::TestModuleRegistry;
 using bluetooth::hal::SnoopLogger;
+using bluetooth::hal::SnoopLogWriter;
 using namespace std::chrono_literals;
 
 const char* test_flags[] = {
@@ -127,7 +128,8 @@ class TestSnoopLoggerModule : public SnoopLogger {
       size_t max_packets_per_file,
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
-      bool snoop_log_persists)
+      bool snoop_log_persists,
+      size_t preallocated_file_size = 0)
       : SnoopLogger(
             std::move(snoop_log_path),
             std::move(snooz_log_path),
@@ -137,7 +139,9 @@ class TestSnoopLoggerModule : public SnoopLogger {
             qualcomm_debug_log_enabled,
             20ms,
             5ms,
-            snoop_log_persists) {}
+            snoop_log_persists,
+            SnoopLogWriter::FlushPolicy(),
+            preallocated_file_size) {}
 
   std::string ToString() const override {
     return std::string("TestSnoopLoggerModule");
@@ -551,6 +555,37 @@ TEST_F(SnoopLoggerModuleTest, rotate_file_after_full_test) {
           (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
 }
 
+TEST_F(SnoopLoggerModuleTest, preallocated_file_rotate_after_full_test) {
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(),
+      temp_snooz_log_.string(),
+      10,
+      SnoopLogger::kBtSnoopLogModeFull,
+      false,
+      false,
+      64 * 1024);
+  test_registry->InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  // The preallocated file is truncated to the captured packets once closed
+  for (int i = 0; i < 11; i++) {
+    snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+
+  test_registry->StopAll();
+
+  // Verify states after test
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_));
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_last_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 1);
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_last_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
+}
+
 TEST_F(SnoopLoggerModuleTest, qualcomm_debug_log_test) {
   auto* snoop_logger = new TestSnoopLoggerModule(
       temp_snoop_log_.string(),
@@ -24,6 +24,7 @@
 #include "dumpsys_data_generated.h"
 #include "hci/acl_manager/acl_scheduler.h"
 #include "hci/acl_manager/classic_impl.h"
+#include "hci/acl_manager/host_flow_control.h"
 #include "hci/acl_manager/le_acceptlist_callbacks.h"
 #include "hci/acl_manager/le_acl_connection.h"
 #include "hci/acl_manager/le_impl.h"
@@ -32,6 +33,7 @@
 #include "hci/hci_layer.h"
 #include "hci/remote_name_request.h"
 #include "hci_acl_manager_generated.h"
+#include "os/system_properties.h"
 #include "security/security_module.h"
 #include "storage/storage_module.h"
 
@@ -56,6 +58,7 @@ using acl_manager::LeConnectionCallbacks;
 using acl_manager::RoundRobinScheduler;
 
 using acl_manager::AclScheduler;
+using acl_manager::HostFlowControl;
 
 struct AclManager::impl {
   impl(const AclManager& acl_manager) : acl_manager_(acl_manager) {}
@@ -83,6 +86,11 @@ struct AclManager::impl {
       le_impl_ = new le_impl(hci_layer_, controller_, handler_, round_robin_scheduler_, crash_on_unknown_handle);
     }
 
+    if (os::GetSystemPropertyBool(HostFlowControl::kPropertyEnabled, false)) {
+      const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+      host_flow_control_ = std::make_unique<HostFlowControl>(handler_, hci_layer_);
+    }
+
     hci_queue_end_ = hci_layer_->GetAclQueueEnd();
     hci_queue_end_->RegisterDequeue(
         handler_, common::Bind(&impl::dequeue_and_route_acl_packet_to_connection, common::Unretained(this)));
@@ -100,6 +108,7 @@ struct AclManager::impl {
       delete classic_impl_;
       le_impl_ = nullptr;
       classic_impl_ = nullptr;
+      host_flow_control_.reset();
     }
 
     unknown_acl_alarm_.reset();
@@ -115,15 +124,7 @@ struct AclManager::impl {
   void retry_unknown_acl(bool timed_out) {
     std::vector<AclView> unsent_packets;
     for (const auto& itr : waiting_packets_) {
-      auto handle = itr.GetHandle();
-      if (!classic_impl_->send_packet_upward(
-              handle,
-              [itr](struct acl_manager::assembler* assembler) {
-                assembler->on_incoming_packet(itr);
-              }) &&
-          !le_impl_->send_packet_upward(handle, [itr](struct acl_manager::assembler* assembler) {
-            assembler->on_incoming_packet(itr);
-          })) {
+      if (!send_packet_upward(itr)) {
         if (!timed_out) {
           unsent_packets.push_back(itr);
         } else {
@@ -131,12 +132,24 @@ struct AclManager::impl {
               "Dropping packet of size %zu to unknown connection 0x%0hx",
               itr.size(),
               itr.GetHandle());
+          if (host_flow_control_ != nullptr) {
+            host_flow_control_->OnPacketsReleased(itr.GetHandle(), 1);
+          }
         }
       }
     }
     waiting_packets_ = std::move(unsent_packets);
   }
 
+  // Gives |packet| to the assembler of its connection, false when the connection is unknown
+  bool send_packet_upward(AclView packet) {
+    auto on_packet = [this, &packet](struct acl_manager::assembler* assembler) {
+      assembler->on_incoming_packet(packet, host_flow_control_.get());
+    };
+    uint16_t handle = packet.GetHandle();
+    return classic_impl_->send_packet_upward(handle, on_packet) || le_impl_->send_packet_upward(handle, on_packet);
+  }
+
   static void on_unknown_acl_timer(struct AclManager::impl* impl) {
     LOG_INFO("Timer fired!");
     impl->retry_unknown_acl(/* timed_out = */ true);
@@ -158,12 +171,10 @@ struct AclManager::impl {
     }
     uint16_t handle = packet->GetHandle();
     if (handle == kQualcommDebugHandle) return;
-    if (classic_impl_->send_packet_upward(
-            handle, [&packet](struct acl_manager::assembler* assembler) { assembler->on_incoming_packet(*packet); }))
-      return;
-    if (le_impl_->send_packet_upward(
-            handle, [&packet](struct acl_manager::assembler* assembler) { assembler->on_incoming_packet(*packet); }))
-      return;
+    if (host_flow_control_ != nullptr) {
+      host_flow_control_->OnPacketReceived(handle);
+    }
+    if (send_packet_upward(*packet)) return;
     if (unknown_acl_alarm_ == nullptr) {
       unknown_acl_alarm_.reset(new os::Alarm(handler_));
     }
@@ -189,6 +200,7 @@ struct AclManager::impl {
   Controller* controller_ = nullptr;
   HciLayer* hci_layer_ = nullptr;
   RoundRobinScheduler* round_robin_scheduler_ = nullptr;
+  std::unique_ptr<HostFlowControl> host_flow_control_;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
   std::atomic_bool enqueue_registered_ = false;
   uint16_t default_link_policy_settings_ = 0xffff;
@@ -332,6 +344,10 @@ void AclManager::ClearFilterAcceptList() {
   CallOn(pimpl_->le_impl_, &le_impl::clear_filter_accept_list);
 }
 
+void AclManager::UpdateLeAcceptList(std::vector<AddressWithType> to_remove, std::vector<AddressWithType> to_add) {
+  CallOn(pimpl_->le_impl_, &le_impl::update_accept_list, std::move(to_remove), std::move(to_add));
+}
+
 void AclManager::AddDeviceToResolvingList(
     AddressWithType address_with_type,
     const std::array<uint8_t, 16>& peer_irk,
@@ -343,6 +359,10 @@ void AclManager::RemoveDeviceFromResolvingList(AddressWithType address_with_type
   CallOn(pimpl_->le_impl_, &le_impl::remove_device_from_resolving_list, address_with_type);
 }
 
+void AclManager::UpdateResolvingList(std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add) {
+  CallOn(pimpl_->le_impl_, &le_impl::update_resolving_list, std::move(to_remove), std::move(to_add));
+}
+
 void AclManager::ClearResolvingList() {
   CallOn(pimpl_->le_impl_, &le_impl::clear_resolving_list);
 }
@@ -418,6 +438,10 @@ void AclManager::HACK_SetAclTxPriority(uint8_t handle, bool high_priority) {
   CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkPriority, handle, high_priority);
 }
 
+void AclManager::SetAclTrafficClass(uint16_t handle, acl_manager::AclTrafficClass traffic_class) {
+  CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetTrafficClass, handle, traffic_class);
+}
+
 void AclManager::ListDependencies(ModuleList* list) const {
   list->add<HciLayer>();
   list->add<Controller>();
@@ -462,12 +486,67 @@ void AclManager::impl::Dump(
   }
   auto vecofstrings = fb_builder->CreateVector(strings, connect_list.size());
 
+  std::vector<flatbuffers::Offset<AclTrafficClassData>> traffic_class_offsets;
+  if (round_robin_scheduler_ != nullptr) {
+    auto traffic_class_stats = round_robin_scheduler_->GetTrafficClassStats();
+    for (size_t i = 0; i < traffic_class_stats.size(); i++) {
+      const auto& stats = traffic_class_stats[i].stats;
+      auto name = fb_builder->CreateString(
+          RoundRobinScheduler::TrafficClassText(static_cast<RoundRobinScheduler::TrafficClass>(i)));
+      AclTrafficClassDataBuilder traffic_class_builder(*fb_builder);
+      traffic_class_builder.add_name(name);
+      traffic_class_builder.add_quantum_bytes(traffic_class_stats[i].quantum_bytes);
+      traffic_class_builder.add_enqueued_fragments(stats.enqueued);
+      traffic_class_builder.add_sent_fragments(stats.dequeued);
+      traffic_class_builder.add_sent_bytes(stats.dequeued_cost);
+      traffic_class_builder.add_skipped_turns(stats.skipped_turns);
+      traffic_class_builder.add_max_wait_fragments(stats.max_wait);
+      traffic_class_offsets.push_back(traffic_class_builder.Finish());
+    }
+  }
+  auto acl_traffic_classes = fb_builder->CreateVector(traffic_class_offsets);
+
+  std::vector<flatbuffers::Offset<AclConnectionSchedulingData>> connection_offsets;
+  if (round_robin_scheduler_ != nullptr) {
+    for (const auto& stats : round_robin_scheduler_->GetConnectionStats()) {
+      auto traffic_class = fb_builder->CreateString(RoundRobinScheduler::TrafficClassText(stats.traffic_class));
+      AclConnectionSchedulingDataBuilder connection_builder(*fb_builder);
+      connection_builder.add_handle(stats.handle);
+      connection_builder.add_is_le(stats.connection_type == RoundRobinScheduler::ConnectionType::LE);
+      connection_builder.add_traffic_class(traffic_class);
+      connection_builder.add_outstanding_credits(stats.outstanding_credits);
+      connection_builder.add_sent_fragments(stats.sent_fragments);
+      connection_builder.add_average_queueing_delay_us(stats.average_queueing_delay_us);
+      connection_builder.add_max_queueing_delay_us(stats.max_queueing_delay_us);
+      connection_offsets.push_back(connection_builder.Finish());
+    }
+  }
+  auto acl_connections = fb_builder->CreateVector(connection_offsets);
+
+  flatbuffers::Offset<AclHostFlowControlData> host_flow_control;
+  if (host_flow_control_ != nullptr) {
+    auto stats = host_flow_control_->GetStats();
+    AclHostFlowControlDataBuilder host_flow_control_builder(*fb_builder);
+    host_flow_control_builder.add_received_packets(stats.received_packets);
+    host_flow_control_builder.add_returned_packets(stats.returned_packets);
+    host_flow_control_builder.add_commands_sent(stats.commands_sent);
+    host_flow_control_builder.add_throttled_count(stats.throttled_count);
+    host_flow_control_builder.add_total_throttled_us(stats.total_throttled_us);
+    host_flow_control_builder.add_max_throttled_us(stats.max_throttled_us);
+    host_flow_control = host_flow_control_builder.Finish();
+  }
+
   AclManagerDataBuilder builder(*fb_builder);
   builder.add_title(title);
   builder.add_le_filter_accept_list_count(connect_list.size());
   builder.add_le_filter_accept_list(vecofstrings);
   builder.add_le_connectability_state(le_connectability_state);
   builder.add_le_create_connection_timeout_alarms_count(le_create_connection_timeout_alarms_count);
+  builder.add_acl_traffic_classes(acl_traffic_classes);
+  builder.add_acl_connections(acl_connections);
+  if (host_flow_control_ != nullptr) {
+    builder.add_host_flow_control(host_flow_control);
+  }
 
   flatbuffers::Offset<AclManagerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
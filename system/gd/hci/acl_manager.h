@@ -19,7 +19,9 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <vector>
 
+#include "hci/acl_manager/acl_traffic_class.h"
 #include "hci/acl_manager/connection_callbacks.h"
 #include "hci/acl_manager/le_acceptlist_callbacks.h"
 #include "hci/acl_manager/le_connection_callbacks.h"
@@ -116,6 +118,10 @@ class AclManager : public Module {
   // cancelled, or OnConnectSuccess if not successfully cancelled and already
   // connected
   virtual void CancelConnect(Address address);
+
+  // Profile hint for scheduling the outgoing traffic of the connection, BULK by default for
+  // classic connections and GATT for LE ones
+  virtual void SetAclTrafficClass(uint16_t handle, acl_manager::AclTrafficClass traffic_class);
   virtual void RemoveFromBackgroundList(AddressWithType address_with_type);
   virtual void IsOnBackgroundList(AddressWithType address_with_type, std::promise<bool> promise);
 
@@ -123,11 +129,18 @@ class AclManager : public Module {
 
   virtual void ClearFilterAcceptList();
 
+  // Removes |to_remove| from the background connections and adds |to_add| to them with a single update of the
+  // filter accept list, so that the initiator is paused once for the whole change
+  virtual void UpdateLeAcceptList(std::vector<AddressWithType> to_remove, std::vector<AddressWithType> to_add);
+
   virtual void AddDeviceToResolvingList(
       AddressWithType address_with_type,
       const std::array<uint8_t, 16>& peer_irk,
       const std::array<uint8_t, 16>& local_irk);
   virtual void RemoveDeviceFromResolvingList(AddressWithType address_with_type);
+  // Removes |to_remove| from and adds |to_add| to the resolving list with a single pause of scanning, advertising
+  // and the initiator
+  virtual void UpdateResolvingList(std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add);
   virtual void ClearResolvingList();
 
   virtual void CentralLinkKey(KeyFlag key_flag);
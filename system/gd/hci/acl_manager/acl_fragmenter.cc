@@ -16,21 +16,59 @@
 
 #include "hci/acl_manager/acl_fragmenter.h"
 
+#include <algorithm>
+
 #include "os/log.h"
-#include "packet/fragmenting_inserter.h"
+#include "packet/bit_inserter.h"
 
 namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+namespace {
+
+// A fragment of a serialized packet, sharing the buffer with the other fragments of the packet
+class FragmentBuilder : public packet::BasePacketBuilder {
+ public:
+  FragmentBuilder(std::shared_ptr<const std::vector<uint8_t>> bytes, size_t begin, size_t end)
+      : bytes_(std::move(bytes)), begin_(begin), end_(end) {}
+
+  size_t size() const override {
+    return end_ - begin_;
+  }
+
+  void Serialize(packet::BitInserter& it) const override {
+    for (size_t i = begin_; i < end_; i++) {
+      it.insert_byte((*bytes_)[i]);
+    }
+  }
+
+ private:
+  std::shared_ptr<const std::vector<uint8_t>> bytes_;
+  size_t begin_;
+  size_t end_;
+};
+
+}  // namespace
+
 AclFragmenter::AclFragmenter(size_t mtu, std::unique_ptr<packet::BasePacketBuilder> packet)
-    : mtu_(mtu), packet_(std::move(packet)) {}
+    : mtu_(mtu), packet_(std::move(packet)) {
+  ASSERT(mtu_ > 0);
+}
+
+std::vector<std::unique_ptr<packet::BasePacketBuilder>> AclFragmenter::GetFragments() {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bytes->reserve(packet_->size());
+  packet::BitInserter inserter(*bytes);
+  packet_->Serialize(inserter);
 
-std::vector<std::unique_ptr<packet::RawBuilder>> AclFragmenter::GetFragments() {
-  std::vector<std::unique_ptr<packet::RawBuilder>> to_return;
-  packet::FragmentingInserter fragmenting_inserter(mtu_, std::back_insert_iterator(to_return));
-  packet_->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
+  std::vector<std::unique_ptr<packet::BasePacketBuilder>> to_return;
+  to_return.reserve((bytes->size() + mtu_ - 1) / mtu_);
+  for (size_t begin = 0; begin < bytes->size(); begin += mtu_) {
+    size_t end = std::min(begin + mtu_, bytes->size());
+    auto fragment = std::make_unique<FragmentBuilder>(bytes, begin, end);
+    to_return.push_back(std::move(fragment));
+  }
   return to_return;
 }
 
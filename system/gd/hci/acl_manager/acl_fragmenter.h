@@ -23,18 +23,19 @@
 #include <vector>
 
 #include "packet/base_packet_builder.h"
-#include "packet/raw_builder.h"
 
 namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+// Splits a packet into fragments of at most |mtu| bytes. The packet is serialized once, and the fragments are slices
+// sharing that buffer, so fragmenting does not copy the payload again.
 class AclFragmenter {
  public:
   AclFragmenter(size_t mtu, std::unique_ptr<packet::BasePacketBuilder> input);
   virtual ~AclFragmenter() = default;
 
-  std::vector<std::unique_ptr<packet::RawBuilder>> GetFragments();
+  std::vector<std::unique_ptr<packet::BasePacketBuilder>> GetFragments();
 
  private:
   size_t mtu_;
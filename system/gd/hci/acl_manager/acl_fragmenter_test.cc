@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/acl_manager/acl_fragmenter.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+namespace {
+
+std::vector<uint8_t> Serialize(const packet::BasePacketBuilder& builder) {
+  std::vector<uint8_t> bytes;
+  packet::BitInserter it(bytes);
+  builder.Serialize(it);
+  return bytes;
+}
+
+std::vector<uint8_t> MakePayload(size_t size) {
+  std::vector<uint8_t> payload(size);
+  for (size_t i = 0; i < size; i++) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  return payload;
+}
+
+TEST(AclFragmenterTest, fragments_are_slices_of_the_packet) {
+  auto payload = MakePayload(25);
+  auto fragments = AclFragmenter(10, std::make_unique<packet::RawBuilder>(payload)).GetFragments();
+
+  ASSERT_EQ(fragments.size(), 3u);
+  ASSERT_EQ(fragments[0]->size(), 10u);
+  ASSERT_EQ(fragments[1]->size(), 10u);
+  ASSERT_EQ(fragments[2]->size(), 5u);
+
+  std::vector<uint8_t> reassembled;
+  for (const auto& fragment : fragments) {
+    auto bytes = Serialize(*fragment);
+    ASSERT_EQ(bytes.size(), fragment->size());
+    reassembled.insert(reassembled.end(), bytes.begin(), bytes.end());
+  }
+  ASSERT_EQ(reassembled, payload);
+}
+
+TEST(AclFragmenterTest, packet_of_a_multiple_of_the_mtu) {
+  auto payload = MakePayload(20);
+  auto fragments = AclFragmenter(10, std::make_unique<packet::RawBuilder>(payload)).GetFragments();
+
+  ASSERT_EQ(fragments.size(), 2u);
+  ASSERT_EQ(Serialize(*fragments[1]), std::vector<uint8_t>(payload.begin() + 10, payload.end()));
+}
+
+TEST(AclFragmenterTest, fragments_outlive_the_fragmenter) {
+  auto payload = MakePayload(15);
+  std::vector<std::unique_ptr<packet::BasePacketBuilder>> fragments;
+  {
+    AclFragmenter fragmenter(8, std::make_unique<packet::RawBuilder>(payload));
+    fragments = fragmenter.GetFragments();
+  }
+  ASSERT_EQ(fragments.size(), 2u);
+  ASSERT_EQ(Serialize(*fragments[0]), std::vector<uint8_t>(payload.begin(), payload.begin() + 8));
+}
+
+}  // namespace
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
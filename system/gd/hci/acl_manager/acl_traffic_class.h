@@ -0,0 +1,29 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+// Profile hint used to schedule the outgoing ACL traffic of a connection. AUDIO links get
+// controller buffers reserved for them, so bulk transfers on other links can't starve them.
+enum AclTrafficClass { BULK, GATT, HID, AUDIO };
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
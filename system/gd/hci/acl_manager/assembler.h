@@ -21,6 +21,7 @@
 #include <memory>
 
 #include "hci/acl_manager/acl_connection.h"
+#include "hci/acl_manager/host_flow_control.h"
 #include "hci/address_with_type.h"
 #include "os/handler.h"
 #include "os/log.h"
@@ -76,52 +77,87 @@ struct assembler {
   PacketViewForRecombination recombination_stage_{};
   std::shared_ptr<std::atomic_bool> enqueue_registered_ = std::make_shared<std::atomic_bool>(false);
   std::queue<packet::PacketView<packet::kLittleEndian>> incoming_queue_;
+  // Host flow control of the connection, set with its first packet. The HCI packets in the recombination stage and in
+  // each PDU of the incoming queue hold host buffers until they are dropped or dequeued.
+  HostFlowControl* host_flow_control_ = nullptr;
+  uint16_t handle_ = 0;
+  uint16_t recombination_fragments_ = 0;
+  std::queue<uint16_t> incoming_fragments_;
 
   ~assembler() {
     if (enqueue_registered_->exchange(false)) {
       down_end_->UnregisterEnqueue();
     }
+    if (host_flow_control_ != nullptr) {
+      host_flow_control_->OnConnectionClosed(handle_);
+    }
+  }
+
+  void release_fragments(uint16_t fragments) {
+    if (host_flow_control_ != nullptr && fragments != 0) {
+      host_flow_control_->OnPacketsReleased(handle_, fragments);
+    }
+  }
+
+  void drop_recombination_stage() {
+    recombination_stage_ = PacketViewForRecombination();
+    release_fragments(recombination_fragments_);
+    recombination_fragments_ = 0;
   }
 
   // Invoked from some external Queue Reactable context
   std::unique_ptr<packet::PacketView<packet::kLittleEndian>> on_data_ready() {
     auto packet = incoming_queue_.front();
     incoming_queue_.pop();
+    uint16_t fragments = incoming_fragments_.front();
+    incoming_fragments_.pop();
     if (incoming_queue_.empty() && enqueue_registered_->exchange(false)) {
       down_end_->UnregisterEnqueue();
     }
+    release_fragments(fragments);
     return std::make_unique<PacketView<packet::kLittleEndian>>(packet);
   }
 
-  void on_incoming_packet(AclView packet) {
+  // |host_flow_control| is given the host buffers of the packet back when it is dropped or dequeued
+  void on_incoming_packet(AclView packet, HostFlowControl* host_flow_control = nullptr) {
+    host_flow_control_ = host_flow_control;
+    handle_ = packet.GetHandle();
     PacketView<packet::kLittleEndian> payload = packet.GetPayload();
     auto broadcast_flag = packet.GetBroadcastFlag();
     if (broadcast_flag == BroadcastFlag::ACTIVE_PERIPHERAL_BROADCAST) {
       LOG_WARN("Dropping broadcast from remote");
+      release_fragments(1);
       return;
     }
     auto packet_boundary_flag = packet.GetPacketBoundaryFlag();
     if (packet_boundary_flag == PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE) {
       LOG_ERROR("Controller is not allowed to send FIRST_NON_AUTOMATICALLY_FLUSHABLE to host except loopback mode");
+      release_fragments(1);
       return;
     }
     if (packet_boundary_flag == PacketBoundaryFlag::CONTINUING_FRAGMENT) {
       if (!recombination_stage_.ReceivedFirstPacket()) {
         LOG_ERROR("Continuing fragment received without previous first, dropping it.");
+        release_fragments(1);
         return;
       }
       recombination_stage_.AppendPacketView(payload);
+      recombination_fragments_++;
     } else if (packet_boundary_flag == PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE) {
       if (recombination_stage_.ReceivedFirstPacket()) {
         LOG_ERROR("Controller sent a starting packet without finishing previous packet. Drop previous one.");
       }
+      drop_recombination_stage();
       recombination_stage_ = payload;
+      recombination_fragments_ = 1;
+    } else {
+      release_fragments(1);
     }
     // Check the size of the packet
     size_t expected_size = GetL2capPduSize(recombination_stage_) + kL2capBasicFrameHeaderSize;
     if (expected_size < recombination_stage_.size()) {
       LOG_INFO("Packet size doesn't match L2CAP header, dropping it.");
-      recombination_stage_ = PacketViewForRecombination();
+      drop_recombination_stage();
       return;
     } else if (expected_size > recombination_stage_.size()) {
       // Wait for the next fragment before sending
@@ -130,12 +166,14 @@ struct assembler {
     if (incoming_queue_.size() > kMaxQueuedPacketsPerConnection) {
       LOG_ERROR("Dropping packet from %s due to congestion",
                  ADDRESS_TO_LOGGABLE_CSTR(address_with_type_));
-      recombination_stage_ = PacketViewForRecombination();
+      drop_recombination_stage();
       return;
     }
 
     incoming_queue_.push(recombination_stage_);
+    incoming_fragments_.push(recombination_fragments_);
     recombination_stage_ = PacketViewForRecombination();
+    recombination_fragments_ = 0;
     if (!enqueue_registered_->exchange(true)) {
       down_end_->RegisterEnqueue(
           handler_, common::Bind(&assembler::on_data_ready, common::Unretained(this)));
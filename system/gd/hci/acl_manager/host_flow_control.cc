@@ -0,0 +1,163 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/acl_manager/host_flow_control.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common/bind.h"
+#include "hci/event_checkers.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+HostFlowControl::HostFlowControl(os::Handler* handler, HciLayer* hci_layer)
+    : handler_(handler), hci_layer_(hci_layer), batch_alarm_(handler) {
+  // HCI Reset disables it again when the stack restarts
+  hci_layer_->EnqueueCommand(
+      HostBufferSizeBuilder::Create(
+          kHostAclDataPacketLength,
+          kHostSynchronousDataPacketLength,
+          kHostTotalNumAclDataPackets,
+          kHostTotalNumSynchronousDataPackets),
+      handler_->BindOnce(check_complete<HostBufferSizeCompleteView>));
+  hci_layer_->EnqueueCommand(
+      SetControllerToHostFlowControlBuilder::Create(/* acl */ 1, /* synchronous */ 0),
+      handler_->BindOnce(check_complete<SetControllerToHostFlowControlCompleteView>));
+  LOG_INFO("Host flow control enabled with %hu ACL buffers", kHostTotalNumAclDataPackets);
+}
+
+HostFlowControl::~HostFlowControl() {
+  batch_alarm_.Cancel();
+}
+
+void HostFlowControl::OnPacketReceived(uint16_t handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.received_packets++;
+  held_packets_[handle]++;
+  outstanding_packets_++;
+  if (outstanding_packets_ > kHostTotalNumAclDataPackets) {
+    LOG_WARN("Controller sent %hu packets for %hu host buffers", outstanding_packets_, kHostTotalNumAclDataPackets);
+  }
+  if (outstanding_packets_ >= kHostTotalNumAclDataPackets && !throttled_) {
+    throttled_ = true;
+    throttled_since_ = std::chrono::steady_clock::now();
+    stats_.throttled_count++;
+  }
+}
+
+void HostFlowControl::OnPacketsReleased(uint16_t handle, uint16_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto held = held_packets_.find(handle);
+  if (held == held_packets_.end()) {
+    // The connection is closed, and the controller freed its buffers
+    return;
+  }
+  count = std::min(count, held->second);
+  held->second -= count;
+  released_packets_[handle] += count;
+  total_released_packets_ += count;
+
+  uint16_t controller_buffers =
+      kHostTotalNumAclDataPackets - std::min(outstanding_packets_, kHostTotalNumAclDataPackets);
+  if (controller_buffers <= kLowWatermark || total_released_packets_ >= kMaxBatchedPackets) {
+    send_completed_packets_locked();
+    return;
+  }
+  if (!batch_scheduled_) {
+    batch_scheduled_ = true;
+    batch_alarm_.Schedule(
+        common::BindOnce(&HostFlowControl::on_batch_timeout, common::Unretained(this)), kMaxBatchDelay);
+  }
+}
+
+void HostFlowControl::OnConnectionClosed(uint16_t handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint16_t freed = 0;
+  auto held = held_packets_.find(handle);
+  if (held != held_packets_.end()) {
+    freed += held->second;
+    held_packets_.erase(held);
+  }
+  auto released = released_packets_.find(handle);
+  if (released != released_packets_.end()) {
+    freed += released->second;
+    total_released_packets_ -= released->second;
+    released_packets_.erase(released);
+  }
+  outstanding_packets_ -= std::min(freed, outstanding_packets_);
+  if (outstanding_packets_ < kHostTotalNumAclDataPackets) {
+    end_throttle_locked();
+  }
+}
+
+HostFlowControl::Stats HostFlowControl::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void HostFlowControl::send_completed_packets_locked() {
+  if (batch_scheduled_) {
+    batch_scheduled_ = false;
+    batch_alarm_.Cancel();
+  }
+  if (total_released_packets_ == 0) {
+    return;
+  }
+  std::vector<CompletedPackets> completed_packets;
+  for (const auto& [handle, count] : released_packets_) {
+    if (count == 0) {
+      continue;
+    }
+    CompletedPackets packets;
+    packets.connection_handle_ = handle;
+    packets.host_num_of_completed_packets_ = count;
+    completed_packets.push_back(packets);
+  }
+  released_packets_.clear();
+  hci_layer_->SendHostNumCompletedPackets(HostNumCompletedPacketsBuilder::Create(completed_packets));
+
+  outstanding_packets_ -= std::min(total_released_packets_, outstanding_packets_);
+  stats_.returned_packets += total_released_packets_;
+  stats_.commands_sent++;
+  total_released_packets_ = 0;
+  end_throttle_locked();
+}
+
+void HostFlowControl::on_batch_timeout() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  batch_scheduled_ = false;
+  send_completed_packets_locked();
+}
+
+void HostFlowControl::end_throttle_locked() {
+  if (!throttled_) {
+    return;
+  }
+  throttled_ = false;
+  uint64_t throttled_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - throttled_since_)
+                              .count();
+  stats_.total_throttled_us += throttled_us;
+  stats_.max_throttled_us = std::max(stats_.max_throttled_us, throttled_us);
+}
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "hci/hci_layer.h"
+#include "os/alarm.h"
+#include "os/handler.h"
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+// Host Controller To Host Flow Control of the ACL data. The controller sends at most kHostTotalNumAclDataPackets ACL
+// packets it has not been given back, so that a busy host throttles the controller instead of queuing without bounds.
+// A packet is released when it is dropped, or when the L2CAP PDU it belongs to is dequeued from its AclConnection
+// queue. The released packets are given back with Host Number Of Completed Packets: batched while the controller has
+// buffers left, right away when it is about to run out.
+// All the functions can be called from any thread.
+class HostFlowControl {
+ public:
+  static constexpr char kPropertyEnabled[] = "bluetooth.hci.host_flow_control.enabled";
+
+  // The largest BR/EDR baseband payload, 3-DH5
+  static constexpr uint16_t kHostAclDataPacketLength = 1021;
+  static constexpr uint16_t kHostTotalNumAclDataPackets = 64;
+  // Synchronous flow control stays disabled, but the Host Buffer Size command needs them
+  static constexpr uint8_t kHostSynchronousDataPacketLength = 255;
+  static constexpr uint16_t kHostTotalNumSynchronousDataPackets = 8;
+
+  // Released packets are given back at once when the controller has at most this many buffers left, or when this
+  // many are waiting to be given back
+  static constexpr uint16_t kLowWatermark = kHostTotalNumAclDataPackets / 4;
+  static constexpr uint16_t kMaxBatchedPackets = kHostTotalNumAclDataPackets / 4;
+  // Longest time a released packet waits to be given back otherwise
+  static constexpr std::chrono::milliseconds kMaxBatchDelay = std::chrono::milliseconds(5);
+
+  struct Stats {
+    uint64_t received_packets = 0;
+    uint64_t returned_packets = 0;
+    uint64_t commands_sent = 0;
+    // Times the host held all its buffers, which stops the controller from sending ACL data
+    uint64_t throttled_count = 0;
+    uint64_t total_throttled_us = 0;
+    uint64_t max_throttled_us = 0;
+  };
+
+  // Enables the flow control in the controller
+  HostFlowControl(os::Handler* handler, HciLayer* hci_layer);
+  HostFlowControl(const HostFlowControl&) = delete;
+  HostFlowControl& operator=(const HostFlowControl&) = delete;
+  ~HostFlowControl();
+
+  void OnPacketReceived(uint16_t handle);
+  void OnPacketsReleased(uint16_t handle, uint16_t count);
+  // The controller frees the buffers of a connection when it is disconnected
+  void OnConnectionClosed(uint16_t handle);
+
+  Stats GetStats() const;
+
+ private:
+  void send_completed_packets_locked();
+  void on_batch_timeout();
+  void end_throttle_locked();
+
+  os::Handler* handler_;
+  HciLayer* hci_layer_;
+  os::Alarm batch_alarm_;
+
+  mutable std::mutex mutex_;
+  bool batch_scheduled_ = false;
+  // Packets received and not returned to the controller yet
+  uint16_t outstanding_packets_ = 0;
+  // Packets released and waiting to be returned, per connection handle
+  std::unordered_map<uint16_t, uint16_t> released_packets_;
+  uint16_t total_released_packets_ = 0;
+  // Packets received and not released yet, per connection handle
+  std::unordered_map<uint16_t, uint16_t> held_packets_;
+  bool throttled_ = false;
+  std::chrono::steady_clock::time_point throttled_since_;
+  Stats stats_;
+};
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
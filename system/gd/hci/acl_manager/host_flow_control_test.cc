@@ -0,0 +1,195 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/acl_manager/host_flow_control.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hci/hci_packets.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/bit_inserter.h"
+
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+using namespace std::chrono_literals;
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+namespace {
+
+CommandView GetCommandView(std::unique_ptr<CommandBuilder> command) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  packet::BitInserter i(*bytes);
+  command->Serialize(i);
+  return CommandView::Create(packet::PacketView<packet::kLittleEndian>(bytes));
+}
+
+class TestHciLayer : public HciLayer {
+ public:
+  void EnqueueCommand(
+      std::unique_ptr<CommandBuilder> command,
+      common::ContextualOnceCallback<void(CommandCompleteView)> /* on_complete */) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    op_codes_.push_back(GetCommandView(std::move(command)).GetOpCode());
+  }
+
+  void EnqueueCommand(
+      std::unique_ptr<CommandBuilder> command,
+      common::ContextualOnceCallback<void(CommandStatusView)> /* on_status */) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    op_codes_.push_back(GetCommandView(std::move(command)).GetOpCode());
+  }
+
+  void SendHostNumCompletedPackets(std::unique_ptr<HostNumCompletedPacketsBuilder> command) override {
+    auto view = HostNumCompletedPacketsView::Create(GetCommandView(std::move(command)));
+    ASSERT_TRUE(view.IsValid());
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed_packets_.push_back(view.GetCompletedPackets());
+    if (completed_packets_promise_ != nullptr) {
+      completed_packets_promise_->set_value();
+      completed_packets_promise_.reset();
+    }
+  }
+
+  std::future<void> GetCompletedPacketsFuture() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed_packets_promise_ = std::make_unique<std::promise<void>>();
+    return completed_packets_promise_->get_future();
+  }
+
+  std::vector<OpCode> GetOpCodes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return op_codes_;
+  }
+
+  std::vector<std::vector<CompletedPackets>> GetCompletedPackets() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completed_packets_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<OpCode> op_codes_;
+  std::vector<std::vector<CompletedPackets>> completed_packets_;
+  std::unique_ptr<std::promise<void>> completed_packets_promise_;
+};
+
+class HostFlowControlTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new Thread("thread", Thread::Priority::NORMAL);
+    handler_ = new Handler(thread_);
+    host_flow_control_ = std::make_unique<HostFlowControl>(handler_, &hci_layer_);
+  }
+
+  void TearDown() override {
+    host_flow_control_.reset();
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+  }
+
+  void ReceivePackets(uint16_t handle, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+      host_flow_control_->OnPacketReceived(handle);
+    }
+  }
+
+  Thread* thread_;
+  Handler* handler_;
+  TestHciLayer hci_layer_;
+  std::unique_ptr<HostFlowControl> host_flow_control_;
+};
+
+TEST_F(HostFlowControlTest, enables_flow_control) {
+  auto op_codes = hci_layer_.GetOpCodes();
+  ASSERT_EQ(op_codes.size(), 2u);
+  ASSERT_EQ(op_codes[0], OpCode::HOST_BUFFER_SIZE);
+  ASSERT_EQ(op_codes[1], OpCode::SET_CONTROLLER_TO_HOST_FLOW_CONTROL);
+}
+
+TEST_F(HostFlowControlTest, released_packets_are_batched) {
+  ReceivePackets(0x01, 3);
+  ReceivePackets(0x02, 1);
+  auto future = hci_layer_.GetCompletedPacketsFuture();
+  host_flow_control_->OnPacketsReleased(0x01, 2);
+  host_flow_control_->OnPacketsReleased(0x02, 1);
+  ASSERT_TRUE(hci_layer_.GetCompletedPackets().empty());
+
+  ASSERT_EQ(future.wait_for(1s), std::future_status::ready);
+  auto completed_packets = hci_layer_.GetCompletedPackets();
+  ASSERT_EQ(completed_packets.size(), 1u);
+  ASSERT_EQ(completed_packets[0].size(), 2u);
+  uint16_t returned = 0;
+  for (const auto& packets : completed_packets[0]) {
+    returned += packets.host_num_of_completed_packets_;
+  }
+  ASSERT_EQ(returned, 3);
+  ASSERT_EQ(host_flow_control_->GetStats().returned_packets, 3u);
+  ASSERT_EQ(host_flow_control_->GetStats().commands_sent, 1u);
+}
+
+TEST_F(HostFlowControlTest, released_packets_are_returned_when_controller_runs_low) {
+  ReceivePackets(0x01, HostFlowControl::kHostTotalNumAclDataPackets - HostFlowControl::kLowWatermark);
+  host_flow_control_->OnPacketsReleased(0x01, 1);
+
+  auto completed_packets = hci_layer_.GetCompletedPackets();
+  ASSERT_EQ(completed_packets.size(), 1u);
+  ASSERT_EQ(completed_packets[0].size(), 1u);
+  ASSERT_EQ(completed_packets[0][0].connection_handle_, 0x01);
+  ASSERT_EQ(completed_packets[0][0].host_num_of_completed_packets_, 1);
+}
+
+TEST_F(HostFlowControlTest, throttled_time_is_recorded) {
+  ReceivePackets(0x01, HostFlowControl::kHostTotalNumAclDataPackets);
+  ASSERT_EQ(host_flow_control_->GetStats().throttled_count, 1u);
+  std::this_thread::sleep_for(5ms);
+  host_flow_control_->OnPacketsReleased(0x01, 1);
+
+  auto stats = host_flow_control_->GetStats();
+  ASSERT_EQ(stats.received_packets, HostFlowControl::kHostTotalNumAclDataPackets);
+  ASSERT_EQ(stats.returned_packets, 1u);
+  ASSERT_EQ(stats.throttled_count, 1u);
+  ASSERT_GE(stats.total_throttled_us, 5000u);
+  ASSERT_EQ(stats.max_throttled_us, stats.total_throttled_us);
+}
+
+TEST_F(HostFlowControlTest, closed_connection_frees_its_buffers) {
+  ReceivePackets(0x01, HostFlowControl::kHostTotalNumAclDataPackets);
+  host_flow_control_->OnConnectionClosed(0x01);
+  host_flow_control_->OnPacketsReleased(0x01, 1);
+  ASSERT_TRUE(hci_layer_.GetCompletedPackets().empty());
+
+  ReceivePackets(0x02, HostFlowControl::kHostTotalNumAclDataPackets - HostFlowControl::kLowWatermark - 1);
+  auto future = hci_layer_.GetCompletedPacketsFuture();
+  host_flow_control_->OnPacketsReleased(0x02, 1);
+  ASSERT_TRUE(hci_layer_.GetCompletedPackets().empty());
+  ASSERT_EQ(future.wait_for(1s), std::future_status::ready);
+  ASSERT_EQ(host_flow_control_->GetStats().throttled_count, 1u);
+}
+
+}  // namespace
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -18,7 +18,11 @@
 
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -30,6 +34,7 @@
 #include "hci/acl_manager/le_connection_management_callbacks.h"
 #include "hci/acl_manager/round_robin_scheduler.h"
 #include "hci/controller.h"
+#include "hci/event_checkers.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_address_manager.h"
@@ -56,13 +61,19 @@ constexpr uint16_t kScanIntervalSlow = 0x0800;    /* 1.28 s = 2048 *0.625 */
 constexpr uint16_t kScanWindowSlow = 0x0030;      /* 30 ms = 48 *0.625 */
 constexpr uint16_t kScanIntervalSystemSuspend = 0x0400; /* 640 ms = 1024 * 0.625 */
 constexpr uint16_t kScanWindowSystemSuspend = 0x0012;   /* 11.25ms = 18 * 0.625 */
+constexpr uint16_t kScanIntervalFastReconnect = 0x0030; /* 30 ms = 48 *0.625 */
+constexpr uint16_t kScanWindowFastReconnect = 0x0030;   /* 30 ms = 48 *0.625, scan continuously */
 constexpr uint32_t kCreateConnectionTimeoutMs = 30 * 1000;
+constexpr uint32_t kFastReconnectWindowMs = 2 * 1000;
+constexpr size_t kMaxCachedConnectionParameters = 32;
+constexpr uint16_t kLeMinimumTxOctets = 0x001B;
 constexpr uint8_t PHY_LE_NO_PACKET = 0x00;
 constexpr uint8_t PHY_LE_1M = 0x01;
 constexpr uint8_t PHY_LE_2M = 0x02;
 constexpr uint8_t PHY_LE_CODED = 0x04;
 constexpr bool kEnableBlePrivacy = true;
 constexpr bool kEnableBleOnlyInit1mPhy = false;
+constexpr bool kEnableFastReconnect = true;
 
 static const std::string kPropertyMinConnInterval = "bluetooth.core.le.min_connection_interval";
 static const std::string kPropertyMaxConnInterval = "bluetooth.core.le.max_connection_interval";
@@ -77,6 +88,8 @@ static const std::string kPropertyConnScanIntervalSlow = "bluetooth.core.le.conn
 static const std::string kPropertyConnScanWindowSlow = "bluetooth.core.le.connection_scan_window_slow";
 static const std::string kPropertyEnableBlePrivacy = "bluetooth.core.gap.le.privacy.enabled";
 static const std::string kPropertyEnableBleOnlyInit1mPhy = "bluetooth.core.gap.le.conn.only_init_1m_phy.enabled";
+static const std::string kPropertyEnableFastReconnect = "bluetooth.core.le.fast_reconnect.enabled";
+static const std::string kPropertyFastReconnectWindow = "bluetooth.core.le.fast_reconnect_window";
 
 enum class ConnectabilityState {
   DISARMED = 0,
@@ -114,6 +127,28 @@ struct le_acl_connection {
   LeConnectionManagementCallbacks* le_connection_management_callbacks_ = nullptr;
 };
 
+// Last parameters a connection to the device settled on, used to create the next connection to it
+struct le_cached_connection_parameters {
+  uint16_t interval = 0;
+  uint16_t latency = 0;
+  uint16_t supervision_timeout = 0;
+  PhyType tx_phy = PhyType::LE_1M;
+  PhyType rx_phy = PhyType::LE_1M;
+  uint16_t max_tx_octets = kLeMinimumTxOctets;
+  uint16_t max_tx_time = 0;
+  std::chrono::steady_clock::time_point last_updated;
+};
+
+// Time from the direct connection request to the connection complete event
+struct le_connection_time_stats {
+  uint32_t count = 0;
+  // Connections created with the cached parameters
+  uint32_t fast_reconnect_count = 0;
+  uint64_t last_ms = 0;
+  uint64_t max_ms = 0;
+  uint64_t total_ms = 0;
+};
+
 struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
   le_impl(
       HciLayer* hci_layer,
@@ -136,9 +171,11 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
         controller->GetMacAddress(),
         controller->GetLeFilterAcceptListSize(),
         controller->GetLeResolvingListSize());
+    fast_reconnect_alarm_ = std::make_unique<os::Alarm>(handler_);
   }
 
   ~le_impl() {
+    fast_reconnect_alarm_->Cancel();
     if (address_manager_registered) {
       le_address_manager_->UnregisterSync(this);
     }
@@ -422,7 +459,8 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     auto role_specific_data = initialize_role_specific_data(role);
     auto queue = std::make_shared<AclConnection::Queue>(10);
     auto queue_down_end = queue->GetDownEnd();
-    round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::LE, handle, queue);
+    round_robin_scheduler_->Register(
+        RoundRobinScheduler::ConnectionType::LE, handle, queue, RoundRobinScheduler::TrafficClass::GATT);
     std::unique_ptr<LeAclConnection> connection(new LeAclConnection(
         std::move(queue),
         le_acl_connection_interface_,
@@ -435,6 +473,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     connection->supervision_timeout_ = supervision_timeout;
     connection->in_filter_accept_list_ = in_filter_accept_list;
     connection->locally_initiated_ = (role == hci::Role::CENTRAL);
+    on_connection_established(remote_address, handle, role, conn_interval, conn_latency, supervision_timeout);
     auto connection_callbacks = connection->GetEventCallbacks(
         [this](uint16_t handle) { this->connections.invalidate(handle); });
     if (std::holds_alternative<DataAsUninitializedPeripheral>(role_specific_data)) {
@@ -561,7 +600,8 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     uint16_t handle = connection_complete.GetConnectionHandle();
     auto queue = std::make_shared<AclConnection::Queue>(10);
     auto queue_down_end = queue->GetDownEnd();
-    round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::LE, handle, queue);
+    round_robin_scheduler_->Register(
+        RoundRobinScheduler::ConnectionType::LE, handle, queue, RoundRobinScheduler::TrafficClass::GATT);
     std::unique_ptr<LeAclConnection> connection(new LeAclConnection(
         std::move(queue),
         le_acl_connection_interface_,
@@ -576,6 +616,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     connection->peer_resolvable_private_address_ = connection_complete.GetPeerResolvablePrivateAddress();
     connection->in_filter_accept_list_ = in_filter_accept_list;
     connection->locally_initiated_ = (role == hci::Role::CENTRAL);
+    on_connection_established(remote_address, handle, role, conn_interval, conn_latency, supervision_timeout);
 
     auto connection_callbacks = connection->GetEventCallbacks(
         [this](uint16_t handle) { this->connections.invalidate(handle); });
@@ -656,6 +697,14 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
       return;
     }
     auto handle = complete_view.GetConnectionHandle();
+    if (complete_view.GetStatus() == ErrorCode::SUCCESS) {
+      auto cached = get_cached_connection_parameters(handle);
+      if (cached != nullptr) {
+        cached->interval = complete_view.GetConnInterval();
+        cached->latency = complete_view.GetConnLatency();
+        cached->supervision_timeout = complete_view.GetSupervisionTimeout();
+      }
+    }
     connections.execute(handle, [=](LeConnectionManagementCallbacks* callbacks) {
       callbacks->OnConnectionUpdate(
           complete_view.GetStatus(),
@@ -672,6 +721,13 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
       return;
     }
     auto handle = complete_view.GetConnectionHandle();
+    if (complete_view.GetStatus() == ErrorCode::SUCCESS) {
+      auto cached = get_cached_connection_parameters(handle);
+      if (cached != nullptr) {
+        cached->tx_phy = static_cast<PhyType>(complete_view.GetTxPhy());
+        cached->rx_phy = static_cast<PhyType>(complete_view.GetRxPhy());
+      }
+    }
     connections.execute(handle, [=](LeConnectionManagementCallbacks* callbacks) {
       callbacks->OnPhyUpdate(complete_view.GetStatus(), complete_view.GetTxPhy(), complete_view.GetRxPhy());
     });
@@ -691,6 +747,11 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
       return;
     }
     auto handle = data_length_view.GetConnectionHandle();
+    auto cached = get_cached_connection_parameters(handle);
+    if (cached != nullptr) {
+      cached->max_tx_octets = data_length_view.GetMaxTxOctets();
+      cached->max_tx_time = data_length_view.GetMaxTxTime();
+    }
     connections.execute(handle, [=](LeConnectionManagementCallbacks* callbacks) {
       callbacks->OnDataLengthChange(
           data_length_view.GetMaxTxOctets(),
@@ -809,6 +870,19 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     le_address_manager_->ClearFilterAcceptList();
   }
 
+  // All the filter accept list commands are queued in the le address manager before it pauses the initiator, so
+  // they go out during one pause and the initiator is armed once afterwards
+  void update_accept_list(std::vector<AddressWithType> to_remove, std::vector<AddressWithType> to_add) {
+    for (const auto& address_with_type : to_remove) {
+      remove_device_from_background_connection_list(address_with_type);
+      cancel_connect(address_with_type);
+    }
+    for (const auto& address_with_type : to_add) {
+      add_device_to_background_connection_list(address_with_type);
+      create_le_connection(address_with_type, true, false);
+    }
+  }
+
   void add_device_to_resolving_list(
       AddressWithType address_with_type,
       const std::array<uint8_t, 16>& peer_irk,
@@ -830,6 +904,14 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     }
   }
 
+  void update_resolving_list(std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add) {
+    register_with_address_manager();
+    le_address_manager_->UpdateResolvingList(std::move(to_remove), std::move(to_add));
+    if (le_acceptlist_callbacks_ != nullptr) {
+      le_acceptlist_callbacks_->OnResolvingListChange();
+    }
+  }
+
   void update_connectability_state_after_armed(const ErrorCode& status) {
     switch (connectability_state_) {
       case ConnectabilityState::DISARMED:
@@ -911,6 +993,22 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     uint16_t supervision_timeout = os::GetSystemPropertyUint32(kPropertyConnSupervisionTimeout, kSupervisionTimeout);
     ASSERT(check_connection_parameters(conn_interval_min, conn_interval_max, conn_latency, supervision_timeout));
 
+    // Reconnect with the parameters the last connection settled on, scanning continuously for a bounded window
+    le_cached_connection_parameters* fast_reconnect = get_fast_reconnect_parameters();
+    armed_with_cached_parameters_ = fast_reconnect != nullptr;
+    if (fast_reconnect != nullptr) {
+      fast_reconnect_address_ = *direct_connections_.begin();
+      LOG_INFO("Fast reconnection with cached parameters to %s", ADDRESS_TO_LOGGABLE_CSTR(fast_reconnect_address_));
+      le_scan_interval = kScanIntervalFastReconnect;
+      le_scan_window = kScanWindowFastReconnect;
+      le_scan_window_2m = le_scan_window;
+      le_scan_window_coded = le_scan_window;
+      conn_interval_min = fast_reconnect->interval;
+      conn_interval_max = fast_reconnect->interval;
+      conn_latency = fast_reconnect->latency;
+      supervision_timeout = fast_reconnect->supervision_timeout;
+    }
+
     AddressWithType address_with_type = connection_peer_address_with_type_;
     if (initiator_filter_policy == InitiatorFilterPolicy::USE_FILTER_ACCEPT_LIST) {
       address_with_type = AddressWithType();
@@ -945,7 +1043,16 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
         parameters.push_back(scan_parameters_2m);
         initiating_phys |= PHY_LE_2M;
       }
-      if (controller_->SupportsBleCodedPhy() && !only_init_1m_phy) {
+      bool init_coded_phy = controller_->SupportsBleCodedPhy() && !only_init_1m_phy;
+      if (fast_reconnect != nullptr) {
+        // Scanning on the coded PHY takes time from the 1M PHY, only do it if the device was connected over it
+        init_coded_phy &= fast_reconnect->tx_phy == PhyType::LE_CODED || fast_reconnect->rx_phy == PhyType::LE_CODED;
+        if (init_coded_phy) {
+          parameters[0].scan_window_ = le_scan_interval / 2;
+          le_scan_window_coded = le_scan_interval / 2;
+        }
+      }
+      if (init_coded_phy) {
         LeCreateConnPhyScanParameters scan_parameters_coded;
         scan_parameters_coded.scan_interval_ = le_scan_interval;
         scan_parameters_coded.scan_window_ = le_scan_window_coded;
@@ -1042,6 +1149,8 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
               .Schedule(
                   common::BindOnce(&le_impl::on_create_connection_timeout, common::Unretained(this), address_with_type),
                   std::chrono::milliseconds(connection_timeout));
+          connection_request_times_[address_with_type] = std::chrono::steady_clock::now();
+          start_fast_reconnect_window(address_with_type);
         }
       }
     }
@@ -1092,6 +1201,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
   void on_create_connection_timeout(AddressWithType address_with_type) {
     LOG_INFO("on_create_connection_timeout, address: %s",
              ADDRESS_TO_LOGGABLE_CSTR(address_with_type));
+    connection_request_times_.erase(address_with_type);
     if (create_connection_timeout_alarms_.find(address_with_type) != create_connection_timeout_alarms_.end()) {
       create_connection_timeout_alarms_.at(address_with_type).Cancel();
       create_connection_timeout_alarms_.erase(address_with_type);
@@ -1111,6 +1221,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
   }
 
   void cancel_connect(AddressWithType address_with_type) {
+    connection_request_times_.erase(address_with_type);
     // Remove any alarms for this peer, if any
     if (create_connection_timeout_alarms_.find(address_with_type) != create_connection_timeout_alarms_.end()) {
       create_connection_timeout_alarms_.at(address_with_type).Cancel();
@@ -1218,6 +1329,123 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     return true;
   }
 
+  le_cached_connection_parameters* get_cached_connection_parameters(uint16_t handle) {
+    auto cached = cached_connection_parameters_.find(connections.getAddressWithType(handle));
+    if (cached == cached_connection_parameters_.end()) {
+      return nullptr;
+    }
+    cached->second.last_updated = std::chrono::steady_clock::now();
+    return &cached->second;
+  }
+
+  // Cached parameters of the device of the only pending direct connection, while its fast reconnection window is open
+  le_cached_connection_parameters* get_fast_reconnect_parameters() {
+    if (!fast_reconnect_window_open_ || system_suspend_ || direct_connections_.size() != 1) {
+      return nullptr;
+    }
+    auto cached = cached_connection_parameters_.find(*direct_connections_.begin());
+    if (cached == cached_connection_parameters_.end()) {
+      return nullptr;
+    }
+    const le_cached_connection_parameters& parameters = cached->second;
+    if (!check_connection_parameters(
+            parameters.interval, parameters.interval, parameters.latency, parameters.supervision_timeout)) {
+      return nullptr;
+    }
+    return &cached->second;
+  }
+
+  void start_fast_reconnect_window(AddressWithType address_with_type) {
+    if (!os::GetSystemPropertyBool(kPropertyEnableFastReconnect, kEnableFastReconnect) ||
+        cached_connection_parameters_.count(address_with_type) == 0) {
+      return;
+    }
+    fast_reconnect_window_open_ = true;
+    uint32_t window = os::GetSystemPropertyUint32(kPropertyFastReconnectWindow, kFastReconnectWindowMs);
+    fast_reconnect_alarm_->Schedule(
+        common::BindOnce(&le_impl::on_fast_reconnect_window_end, common::Unretained(this)),
+        std::chrono::milliseconds(window));
+  }
+
+  void on_fast_reconnect_window_end() {
+    fast_reconnect_window_open_ = false;
+    if (connectability_state_ == ConnectabilityState::ARMED || connectability_state_ == ConnectabilityState::ARMING) {
+      // Create the connection again with the default parameters and duty cycle
+      LOG_INFO("Fast reconnection window ended");
+      arm_on_disarm_ = true;
+      disarm_connectability();
+    }
+  }
+
+  void on_connection_established(
+      AddressWithType address_with_type,
+      uint16_t handle,
+      Role role,
+      uint16_t conn_interval,
+      uint16_t conn_latency,
+      uint16_t supervision_timeout) {
+    bool fast_reconnect = false;
+    if (role == Role::CENTRAL) {
+      fast_reconnect = armed_with_cached_parameters_ && fast_reconnect_address_ == address_with_type;
+      armed_with_cached_parameters_ = false;
+      fast_reconnect_window_open_ = false;
+      fast_reconnect_alarm_->Cancel();
+      record_connection_time(address_with_type, fast_reconnect);
+    }
+
+    auto cached = cached_connection_parameters_.find(address_with_type);
+    if (cached == cached_connection_parameters_.end()) {
+      if (cached_connection_parameters_.size() >= kMaxCachedConnectionParameters) {
+        auto oldest = std::min_element(
+            cached_connection_parameters_.begin(), cached_connection_parameters_.end(), [](auto& a, auto& b) {
+              return a.second.last_updated < b.second.last_updated;
+            });
+        cached_connection_parameters_.erase(oldest);
+      }
+      cached = cached_connection_parameters_.emplace(address_with_type, le_cached_connection_parameters{}).first;
+    }
+    le_cached_connection_parameters& parameters = cached->second;
+    parameters.interval = conn_interval;
+    parameters.latency = conn_latency;
+    parameters.supervision_timeout = supervision_timeout;
+    parameters.last_updated = std::chrono::steady_clock::now();
+
+    // The data length can't be given with the create connection, request it before the upper layers do
+    if (fast_reconnect && parameters.max_tx_octets > kLeMinimumTxOctets &&
+        controller_->SupportsBleDataPacketLengthExtension()) {
+      le_acl_connection_interface_->EnqueueCommand(
+          LeSetDataLengthBuilder::Create(handle, parameters.max_tx_octets, parameters.max_tx_time),
+          handler_->BindOnce(check_complete<LeSetDataLengthCompleteView>));
+    }
+  }
+
+  void record_connection_time(AddressWithType address_with_type, bool fast_reconnect) {
+    auto request_time = connection_request_times_.find(address_with_type);
+    if (request_time == connection_request_times_.end()) {
+      return;
+    }
+    uint64_t connection_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      std::chrono::steady_clock::now() - request_time->second)
+                                      .count();
+    connection_request_times_.erase(request_time);
+
+    le_connection_time_stats& stats = connection_time_stats_[address_with_type];
+    stats.count++;
+    if (fast_reconnect) {
+      stats.fast_reconnect_count++;
+    }
+    stats.last_ms = connection_time_ms;
+    stats.max_ms = std::max(stats.max_ms, connection_time_ms);
+    stats.total_ms += connection_time_ms;
+    LOG_INFO(
+        "Connected to %s in %" PRIu64 " ms%s, average %" PRIu64 " ms over %u connections",
+        ADDRESS_TO_LOGGABLE_CSTR(address_with_type),
+        connection_time_ms,
+        fast_reconnect ? " with cached parameters" : "",
+        stats.total_ms / stats.count,
+        stats.count);
+  }
+
   void add_device_to_background_connection_list(AddressWithType address_with_type) {
     background_connections_.insert(address_with_type);
   }
@@ -1323,6 +1551,13 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
   bool system_suspend_ = false;
   ConnectabilityState connectability_state_{ConnectabilityState::DISARMED};
   std::map<AddressWithType, os::Alarm> create_connection_timeout_alarms_{};
+  std::map<AddressWithType, le_cached_connection_parameters> cached_connection_parameters_{};
+  std::map<AddressWithType, std::chrono::steady_clock::time_point> connection_request_times_{};
+  std::map<AddressWithType, le_connection_time_stats> connection_time_stats_{};
+  std::unique_ptr<os::Alarm> fast_reconnect_alarm_;
+  bool fast_reconnect_window_open_ = false;
+  bool armed_with_cached_parameters_ = false;
+  AddressWithType fast_reconnect_address_;
 };
 
 }  // namespace acl_manager
@@ -1873,6 +1873,51 @@ TEST_F(LeImplTest, direct_connection_after_background_connection) {
   ASSERT_NE(direct_create_connection.GetLeScanInterval(), bg_create_connection.GetLeScanInterval());
 }
 
+TEST_F(LeImplWithConnectionTest, direct_reconnection_uses_cached_connection_parameters) {
+  le_impl_->on_le_disconnect(kHciHandle, ErrorCode::REMOTE_USER_TERMINATED_CONNECTION);
+  sync_handler();
+
+  // act: Connect to the device again
+  ASSERT_NO_FATAL_FAILURE(hci_layer_->SetCommandFuture());
+  le_impl_->create_le_connection(remote_public_address_with_type_, true, /* is_direct */ true);
+  hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  ASSERT_NO_FATAL_FAILURE(hci_layer_->SetCommandFuture());
+  hci_layer_->CommandCompleteCallback(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  auto raw_create_connection = hci_layer_->GetCommand(OpCode::LE_CREATE_CONNECTION);
+  hci_layer_->CommandStatusCallback(LeCreateConnectionStatusBuilder::Create(ErrorCode::SUCCESS, 0x01));
+  sync_handler();
+
+  // assert: The parameters of the previous connection are requested, scanning continuously
+  auto create_connection = LeCreateConnectionView::Create(
+      LeConnectionManagementCommandView::Create(AclCommandView::Create(raw_create_connection)));
+  ASSERT_TRUE(create_connection.IsValid());
+  ASSERT_EQ(kScanIntervalFastReconnect, create_connection.GetLeScanInterval());
+  ASSERT_EQ(create_connection.GetLeScanInterval(), create_connection.GetLeScanWindow());
+  ASSERT_EQ(0x0024, create_connection.GetConnIntervalMin());
+  ASSERT_EQ(0x0024, create_connection.GetConnIntervalMax());
+  ASSERT_EQ(0x0000, create_connection.GetConnLatency());
+  ASSERT_EQ(0x0011, create_connection.GetSupervisionTimeout());
+
+  // act: The device connects
+  EXPECT_CALL(mock_le_connection_callbacks_, OnLeConnectSuccess(_, _)).Times(1);
+  hci_layer_->IncomingLeMetaEvent(LeConnectionCompleteBuilder::Create(
+      ErrorCode::SUCCESS,
+      kHciHandle,
+      Role::CENTRAL,
+      AddressType::PUBLIC_DEVICE_ADDRESS,
+      remote_address_,
+      0x0024,
+      0x0000,
+      0x0011,
+      ClockAccuracy::PPM_30));
+  sync_handler();
+
+  // assert: The time to connect is recorded
+  auto stats = le_impl_->connection_time_stats_[remote_public_address_with_type_];
+  ASSERT_EQ(1u, stats.count);
+  ASSERT_EQ(1u, stats.fast_reconnect_count);
+}
+
 }  // namespace acl_manager
 }  // namespace hci
 }  // namespace bluetooth
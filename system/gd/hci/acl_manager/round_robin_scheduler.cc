@@ -15,15 +15,31 @@
  */
 
 #include "hci/acl_manager/round_robin_scheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common/audio_pipeline_trace.h"
 #include "hci/acl_manager/acl_fragmenter.h"
 
 namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+// Bytes each traffic class may send per round, indexed by TrafficClass
+static constexpr std::array<size_t, RoundRobinScheduler::kNumTrafficClasses> kTrafficClassQuanta = {
+    1024,  // BULK
+    2048,  // GATT
+    2048,  // HID
+    4096,  // AUDIO
+};
+
 RoundRobinScheduler::RoundRobinScheduler(
     os::Handler* handler, Controller* controller, common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end)
-    : handler_(handler), controller_(controller), hci_queue_end_(hci_queue_end) {
+    : handler_(handler),
+      controller_(controller),
+      fragments_to_send_(kTrafficClassQuanta),
+      hci_queue_end_(hci_queue_end) {
   max_acl_packet_credits_ = controller_->GetNumAclPacketBuffers();
   acl_packet_credits_ = max_acl_packet_credits_;
   hci_mtu_ = controller_->GetAclPacketLength();
@@ -40,13 +56,18 @@ RoundRobinScheduler::~RoundRobinScheduler() {
 }
 
 void RoundRobinScheduler::Register(ConnectionType connection_type, uint16_t handle,
-                                   std::shared_ptr<acl_manager::AclConnection::Queue> queue) {
+                                   std::shared_ptr<acl_manager::AclConnection::Queue> queue,
+                                   TrafficClass traffic_class) {
   ASSERT(acl_queue_handlers_.count(handle) == 0);
   acl_queue_handler acl_queue_handler = {connection_type, std::move(queue), false, 0};
-  acl_queue_handlers_.insert(std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
-  if (fragments_to_send_.size() == 0) {
-    start_round_robin();
+  acl_queue_handler.traffic_class_ = traffic_class;
+  {
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    acl_queue_handlers_.insert(
+        std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
   }
+  update_reserved_credits();
+  start_round_robin();
 }
 
 void RoundRobinScheduler::Unregister(uint16_t handle) {
@@ -64,8 +85,19 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
     acl_queue_handler.dequeue_is_registered_ = false;
     acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
   }
-  acl_queue_handlers_.erase(handle);
+  {
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    acl_queue_handlers_.erase(handle);
+    // Drop the fragments not sent yet
+    if (acl_queue_handler.number_of_buffered_fragments_ > 0) {
+      fragments_to_send_.remove_if([handle](const fragment& fragment) { return fragment.handle_ == handle; });
+    }
+  }
   starting_point_ = acl_queue_handlers_.begin();
+  update_reserved_credits();
+  if (next_fragment() == nullptr && enqueue_registered_.exchange(false)) {
+    hci_queue_end_->UnregisterEnqueue();
+  }
 }
 
 void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
@@ -75,6 +107,17 @@ void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
     return;
   }
   acl_queue_handler->second.high_priority_ = high_priority;
+  update_reserved_credits();
+}
+
+void RoundRobinScheduler::SetTrafficClass(uint16_t handle, TrafficClass traffic_class) {
+  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  if (acl_queue_handler == acl_queue_handlers_.end()) {
+    LOG_WARN("handle %d is invalid", handle);
+    return;
+  }
+  acl_queue_handler->second.traffic_class_ = traffic_class;
+  update_reserved_credits();
 }
 
 uint16_t RoundRobinScheduler::GetCredits() {
@@ -85,20 +128,125 @@ uint16_t RoundRobinScheduler::GetLeCredits() {
   return le_acl_packet_credits_;
 }
 
+std::array<RoundRobinScheduler::TrafficClassStats, RoundRobinScheduler::kNumTrafficClasses>
+RoundRobinScheduler::GetTrafficClassStats() const {
+  std::lock_guard<std::mutex> lock(fragments_mutex_);
+  std::array<TrafficClassStats, kNumTrafficClasses> traffic_class_stats;
+  for (size_t i = 0; i < kNumTrafficClasses; i++) {
+    traffic_class_stats[i] = {fragments_to_send_.quantum(i), fragments_to_send_.stats(i)};
+  }
+  return traffic_class_stats;
+}
+
+std::vector<RoundRobinScheduler::ConnectionStats> RoundRobinScheduler::GetConnectionStats() const {
+  std::lock_guard<std::mutex> lock(fragments_mutex_);
+  std::vector<ConnectionStats> connection_stats;
+  for (const auto& [handle, acl_queue_handler] : acl_queue_handlers_) {
+    uint64_t sent_fragments = acl_queue_handler.sent_fragments_;
+    connection_stats.push_back({
+        .handle = handle,
+        .connection_type = acl_queue_handler.connection_type_,
+        .traffic_class = effective_traffic_class(acl_queue_handler),
+        .outstanding_credits = acl_queue_handler.number_of_sent_packets_,
+        .sent_fragments = sent_fragments,
+        .average_queueing_delay_us =
+            sent_fragments == 0 ? 0 : acl_queue_handler.total_queueing_delay_us_ / sent_fragments,
+        .max_queueing_delay_us = acl_queue_handler.max_queueing_delay_us_,
+    });
+  }
+  return connection_stats;
+}
+
+uint16_t RoundRobinScheduler::GetReservedCredits() const {
+  return reserved_acl_packet_credits_;
+}
+
+uint16_t RoundRobinScheduler::GetLeReservedCredits() const {
+  return le_reserved_acl_packet_credits_;
+}
+
+const char* RoundRobinScheduler::TrafficClassText(TrafficClass traffic_class) {
+  switch (traffic_class) {
+    case BULK:
+      return "BULK";
+    case GATT:
+      return "GATT";
+    case HID:
+      return "HID";
+    case AUDIO:
+      return "AUDIO";
+  }
+  return "UNKNOWN";
+}
+
+RoundRobinScheduler::TrafficClass RoundRobinScheduler::effective_traffic_class(
+    const acl_queue_handler& acl_queue_handler) {
+  return acl_queue_handler.high_priority_ ? TrafficClass::AUDIO : acl_queue_handler.traffic_class_;
+}
+
+bool RoundRobinScheduler::has_credits(const fragment& fragment) const {
+  uint16_t credits = acl_packet_credits_;
+  uint16_t reserved_credits = reserved_acl_packet_credits_;
+  if (fragment.connection_type_ == ConnectionType::LE) {
+    credits = le_acl_packet_credits_;
+    reserved_credits = le_reserved_acl_packet_credits_;
+  }
+  if (fragment.traffic_class_ == TrafficClass::AUDIO) {
+    return credits > 0;
+  }
+  return credits > reserved_credits;
+}
+
+void RoundRobinScheduler::update_reserved_credits() {
+  bool has_audio_link = false;
+  bool has_le_audio_link = false;
+  for (const auto& [handle, acl_queue_handler] : acl_queue_handlers_) {
+    if (effective_traffic_class(acl_queue_handler) != TrafficClass::AUDIO) {
+      continue;
+    }
+    if (acl_queue_handler.connection_type_ == ConnectionType::CLASSIC) {
+      has_audio_link = true;
+    } else {
+      has_le_audio_link = true;
+    }
+  }
+  // Leave most of the buffers to the other classes, so they keep moving next to an audio stream
+  uint16_t reserved_credits = std::min<uint16_t>(kMaxReservedAudioCredits, max_acl_packet_credits_ / 4);
+  uint16_t le_reserved_credits = std::min<uint16_t>(kMaxReservedAudioCredits, le_max_acl_packet_credits_ / 4);
+  {
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    reserved_acl_packet_credits_ = has_audio_link ? reserved_credits : 0;
+    le_reserved_acl_packet_credits_ = has_le_audio_link ? le_reserved_credits : 0;
+  }
+  // Fragments held back by a reservation which is gone can be sent now
+  if (next_fragment() != nullptr) {
+    send_next_fragment();
+  }
+}
+
+// Only called for the packets of the traced media channel, which are serialized one more time
+static std::optional<uint16_t> trace_media_packet(const packet::BasePacketBuilder& packet) {
+  std::vector<uint8_t> bytes;
+  packet.SerializeInto(bytes);
+  uint16_t sequence_number;
+  if (!common::AudioPipelineTrace::GetMediaSequenceNumber(bytes, &sequence_number)) {
+    return std::nullopt;
+  }
+  common::AudioPipelineTrace::OnAclBuffered(sequence_number);
+  return sequence_number;
+}
+
+RoundRobinScheduler::fragment* RoundRobinScheduler::next_fragment() {
+  std::lock_guard<std::mutex> lock(fragments_mutex_);
+  return fragments_to_send_.front([this](const fragment& fragment) { return has_credits(fragment); });
+}
+
 void RoundRobinScheduler::start_round_robin() {
   if (acl_packet_credits_ == 0 && le_acl_packet_credits_ == 0) {
     return;
   }
-  if (!fragments_to_send_.empty()) {
-    auto connection_type = fragments_to_send_.front().first;
-    bool classic_buffer_full = acl_packet_credits_ == 0 && connection_type == ConnectionType::CLASSIC;
-    bool le_buffer_full = le_acl_packet_credits_ == 0 && connection_type == ConnectionType::LE;
-    if (classic_buffer_full || le_buffer_full) {
-      LOG_WARN("Buffer of connection_type %d is full", connection_type);
-      return;
-    }
+  if (next_fragment() != nullptr) {
     send_next_fragment();
-    return;
   }
   if (acl_queue_handlers_.empty()) {
     LOG_INFO("No any acl connection");
@@ -116,7 +264,9 @@ void RoundRobinScheduler::start_round_robin() {
         acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::CLASSIC;
     bool le_buffer_full =
         le_acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::LE;
-    if (!acl_queue_handler->second.dequeue_is_registered_ && !classic_buffer_full && !le_buffer_full) {
+    bool has_buffered_packet = acl_queue_handler->second.number_of_buffered_fragments_ > 0;
+    if (!acl_queue_handler->second.dequeue_is_registered_ && !has_buffered_packet && !classic_buffer_full &&
+        !le_buffer_full) {
       acl_queue_handler->second.dequeue_is_registered_ = true;
       uint16_t acl_handle = acl_queue_handler->first;
       acl_queue_handler->second.queue_->GetDownEnd()->RegisterDequeue(
@@ -144,34 +294,55 @@ void RoundRobinScheduler::buffer_packet(uint16_t acl_handle) {
   auto packet = acl_queue_handler->second.queue_->GetDownEnd()->TryDequeue();
   ASSERT(packet != nullptr);
 
+  // Take no more packets from this connection until this one is sent
+  acl_queue_handler->second.dequeue_is_registered_ = false;
+  acl_queue_handler->second.queue_->GetDownEnd()->UnregisterDequeue();
+
   ConnectionType connection_type = acl_queue_handler->second.connection_type_;
   size_t mtu = connection_type == ConnectionType::CLASSIC ? hci_mtu_ : le_hci_mtu_;
   PacketBoundaryFlag packet_boundary_flag = (packet->IsFlushable())
                                                 ? PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE
                                                 : PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE;
 
-  int acl_priority = acl_queue_handler->second.high_priority_ ? 1 : 0;
+  TrafficClass traffic_class = effective_traffic_class(acl_queue_handler->second);
+  std::optional<uint16_t> trace_sequence_number;
+  if (common::AudioPipelineTrace::IsMediaHandle(handle)) {
+    trace_sequence_number = trace_media_packet(*packet);
+  }
+  std::vector<std::unique_ptr<AclBuilder>> builders;
   if (packet->size() <= mtu) {
-    fragments_to_send_.push(
-        std::make_pair(
-            connection_type, AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))),
-        acl_priority);
+    builders.push_back(AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet)));
   } else {
     auto fragments = AclFragmenter(mtu, std::move(packet)).GetFragments();
     for (size_t i = 0; i < fragments.size(); i++) {
+      builders.push_back(AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i])));
+      packet_boundary_flag = PacketBoundaryFlag::CONTINUING_FRAGMENT;
+    }
+  }
+  ASSERT(builders.size() > 0);
+  {
+    auto buffered_at = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    for (size_t i = 0; i < builders.size(); i++) {
+      size_t cost = builders[i]->size();
+      bool is_last = i + 1 == builders.size();
       fragments_to_send_.push(
-          std::make_pair(
+          fragment{
               connection_type,
-              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))),
-          acl_priority);
-      packet_boundary_flag = PacketBoundaryFlag::CONTINUING_FRAGMENT;
+              handle,
+              traffic_class,
+              buffered_at,
+              std::move(builders[i]),
+              is_last ? trace_sequence_number : std::nullopt},
+          traffic_class,
+          cost);
     }
   }
-  ASSERT(fragments_to_send_.size() > 0);
-  unregister_all_connections();
 
-  acl_queue_handler->second.number_of_sent_packets_ += fragments_to_send_.size();
-  send_next_fragment();
+  acl_queue_handler->second.number_of_buffered_fragments_ += builders.size();
+  if (next_fragment() != nullptr) {
+    send_next_fragment();
+  }
 }
 
 void RoundRobinScheduler::unregister_all_connections() {
@@ -193,7 +364,13 @@ void RoundRobinScheduler::send_next_fragment() {
 
 // Invoked from some external Queue Reactable context 1
 std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment() {
-  ConnectionType connection_type = fragments_to_send_.front().first;
+  fragment* next = next_fragment();
+  ASSERT(next != nullptr);
+  ConnectionType connection_type = next->connection_type_;
+  uint16_t handle = next->handle_;
+  auto queueing_delay_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - next->buffered_at_)
+                               .count();
   if (connection_type == ConnectionType::CLASSIC) {
     ASSERT(acl_packet_credits_ > 0);
     acl_packet_credits_ -= 1;
@@ -202,20 +379,36 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     le_acl_packet_credits_ -= 1;
   }
 
-  auto raw_pointer = fragments_to_send_.front().second.release();
-  fragments_to_send_.pop();
-  if (fragments_to_send_.empty()) {
-    if (enqueue_registered_.exchange(false)) {
-      hci_queue_end_->UnregisterEnqueue();
+  auto raw_pointer = next->packet_.release();
+  std::optional<uint16_t> trace_sequence_number = next->trace_sequence_number_;
+  bool packet_is_sent = false;
+  {
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    fragments_to_send_.pop();
+
+    auto acl_queue_handler = acl_queue_handlers_.find(handle);
+    if (acl_queue_handler != acl_queue_handlers_.end()) {
+      acl_queue_handler->second.number_of_sent_packets_++;
+      acl_queue_handler->second.number_of_buffered_fragments_--;
+      acl_queue_handler->second.sent_fragments_++;
+      acl_queue_handler->second.total_queueing_delay_us_ += queueing_delay_us;
+      acl_queue_handler->second.max_queueing_delay_us_ =
+          std::max<uint64_t>(acl_queue_handler->second.max_queueing_delay_us_, queueing_delay_us);
+      packet_is_sent = acl_queue_handler->second.number_of_buffered_fragments_ == 0;
+      if (common::AudioPipelineTrace::IsMediaHandle(handle)) {
+        acl_queue_handler->second.traced_fragments_in_flight_.push_back(trace_sequence_number);
+      }
     }
+  }
+  if (trace_sequence_number) {
+    common::AudioPipelineTrace::OnAclSent(*trace_sequence_number);
+  }
+
+  if (next_fragment() == nullptr && enqueue_registered_.exchange(false)) {
+    hci_queue_end_->UnregisterEnqueue();
+  }
+  if (packet_is_sent) {
     handler_->Post(common::BindOnce(&RoundRobinScheduler::start_round_robin, common::Unretained(this)));
-  } else {
-    ConnectionType next_connection_type = fragments_to_send_.front().first;
-    bool classic_buffer_full = next_connection_type == ConnectionType::CLASSIC && acl_packet_credits_ == 0;
-    bool le_buffer_full = next_connection_type == ConnectionType::LE && le_acl_packet_credits_ == 0;
-    if ((classic_buffer_full || le_buffer_full) && enqueue_registered_.exchange(false)) {
-      hci_queue_end_->UnregisterEnqueue();
-    }
   }
   return std::unique_ptr<AclBuilder>(raw_pointer);
 }
@@ -226,11 +419,21 @@ void RoundRobinScheduler::incoming_acl_credits(uint16_t handle, uint16_t credits
     return;
   }
 
-  if (acl_queue_handler->second.number_of_sent_packets_ >= credits) {
-    acl_queue_handler->second.number_of_sent_packets_ -= credits;
-  } else {
-    LOG_WARN("receive more credits than we sent");
-    acl_queue_handler->second.number_of_sent_packets_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(fragments_mutex_);
+    if (acl_queue_handler->second.number_of_sent_packets_ >= credits) {
+      acl_queue_handler->second.number_of_sent_packets_ -= credits;
+    } else {
+      LOG_WARN("receive more credits than we sent");
+      acl_queue_handler->second.number_of_sent_packets_ = 0;
+    }
+  }
+  auto& traced_fragments = acl_queue_handler->second.traced_fragments_in_flight_;
+  for (uint16_t i = 0; i < credits && !traced_fragments.empty(); i++) {
+    if (traced_fragments.front()) {
+      common::AudioPipelineTrace::OnAclCompleted(*traced_fragments.front());
+    }
+    traced_fragments.pop_front();
   }
 
   bool credit_was_zero = false;
@@ -255,6 +458,9 @@ void RoundRobinScheduler::incoming_acl_credits(uint16_t handle, uint16_t credits
   }
   if (credit_was_zero) {
     start_round_robin();
+  } else if (next_fragment() != nullptr) {
+    // A fragment may have been held back by the credits reserved for audio
+    send_next_fragment();
   }
 }
 
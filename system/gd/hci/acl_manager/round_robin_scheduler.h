@@ -18,9 +18,17 @@
 
 #include <stdint.h>
 
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
 #include "common/bidi_queue.h"
-#include "common/multi_priority_queue.h"
+#include "common/deficit_round_robin_queue.h"
 #include "hci/acl_manager.h"
+#include "hci/acl_manager/acl_traffic_class.h"
 #include "hci/controller.h"
 #include "hci/hci_packets.h"
 #include "os/handler.h"
@@ -37,37 +45,97 @@ class RoundRobinScheduler {
 
   enum ConnectionType { CLASSIC, LE };
 
+  // Connections of different classes share the controller buffers in deficit round robin, each
+  // class getting its own byte budget per round. Connections of a class are served in FIFO order.
+  // While an AUDIO connection is registered, a few buffers of its controller pool are kept for
+  // AUDIO fragments only.
+  using TrafficClass = AclTrafficClass;
+  static constexpr size_t kNumTrafficClasses = AUDIO + 1;
+  static constexpr uint16_t kMaxReservedAudioCredits = 2;
+
   struct acl_queue_handler {
     ConnectionType connection_type_;
     std::shared_ptr<acl_manager::AclConnection::Queue> queue_;
     bool dequeue_is_registered_ = false;
     uint16_t number_of_sent_packets_ = 0;  // Track credits
     bool high_priority_ = false;           // For A2dp use
+    TrafficClass traffic_class_ = BULK;
+    uint16_t number_of_buffered_fragments_ = 0;  // At most one packet is buffered per connection
+    uint64_t sent_fragments_ = 0;
+    uint64_t total_queueing_delay_us_ = 0;
+    uint64_t max_queueing_delay_us_ = 0;
+    // RTP sequence number of the traced media packets, for each fragment waiting for its credit
+    std::deque<std::optional<uint16_t>> traced_fragments_in_flight_;
+  };
+
+  struct TrafficClassStats {
+    size_t quantum_bytes;
+    common::DeficitRoundRobinClassStats stats;
+  };
+
+  struct ConnectionStats {
+    uint16_t handle;
+    ConnectionType connection_type;
+    TrafficClass traffic_class;
+    uint16_t outstanding_credits;
+    uint64_t sent_fragments;
+    // Time from a fragment being buffered to it being handed to the HCI layer
+    uint64_t average_queueing_delay_us;
+    uint64_t max_queueing_delay_us;
   };
 
   void Register(ConnectionType connection_type, uint16_t handle,
-                std::shared_ptr<acl_manager::AclConnection::Queue> queue);
+                std::shared_ptr<acl_manager::AclConnection::Queue> queue, TrafficClass traffic_class = BULK);
   void Unregister(uint16_t handle);
+  // A high priority link is scheduled as AUDIO, whatever its traffic class
   void SetLinkPriority(uint16_t handle, bool high_priority);
+  void SetTrafficClass(uint16_t handle, TrafficClass traffic_class);
   uint16_t GetCredits();
   uint16_t GetLeCredits();
+  // Can be called from any thread
+  std::array<TrafficClassStats, kNumTrafficClasses> GetTrafficClassStats() const;
+  // Can be called from any thread
+  std::vector<ConnectionStats> GetConnectionStats() const;
+  uint16_t GetReservedCredits() const;
+  uint16_t GetLeReservedCredits() const;
+  static const char* TrafficClassText(TrafficClass traffic_class);
 
  private:
+  struct fragment {
+    ConnectionType connection_type_;
+    uint16_t handle_;
+    TrafficClass traffic_class_;
+    std::chrono::steady_clock::time_point buffered_at_;
+    std::unique_ptr<AclBuilder> packet_;
+    // Set on the last fragment of a traced media packet
+    std::optional<uint16_t> trace_sequence_number_;
+  };
+
+  static TrafficClass effective_traffic_class(const acl_queue_handler& acl_queue_handler);
+
   void start_round_robin();
   void buffer_packet(uint16_t acl_handle);
   void unregister_all_connections();
   void send_next_fragment();
   std::unique_ptr<AclBuilder> handle_enqueue_next_fragment();
   void incoming_acl_credits(uint16_t handle, uint16_t credits);
+  bool has_credits(const fragment& fragment) const;
+  void update_reserved_credits();
+  fragment* next_fragment();
 
   os::Handler* handler_ = nullptr;
   Controller* controller_ = nullptr;
   std::map<uint16_t, acl_queue_handler> acl_queue_handlers_;
-  common::MultiPriorityQueue<std::pair<ConnectionType, std::unique_ptr<AclBuilder>>, 2> fragments_to_send_;
+  common::DeficitRoundRobinQueue<fragment, kNumTrafficClasses> fragments_to_send_;
+  // Guards fragments_to_send_ and the acl_queue_handlers_ stats against the getters
+  mutable std::mutex fragments_mutex_;
   uint16_t max_acl_packet_credits_ = 0;
   uint16_t acl_packet_credits_ = 0;
   uint16_t le_max_acl_packet_credits_ = 0;
   uint16_t le_acl_packet_credits_ = 0;
+  // Credits only AUDIO fragments may use
+  uint16_t reserved_acl_packet_credits_ = 0;
+  uint16_t le_reserved_acl_packet_credits_ = 0;
   size_t hci_mtu_{0};
   size_t le_hci_mtu_{0};
   std::atomic_bool enqueue_registered_ = false;
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "hci/acl_manager/round_robin_scheduler.h"
+#include "hci/controller.h"
+#include "hci/hci_packets.h"
+#include "os/handler.h"
+#include "os/queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+namespace {
+
+// Controller with fixed buffer sizes, so that the numbers of different builds can be compared
+class BenchmarkController : public Controller {
+ public:
+  uint16_t GetNumAclPacketBuffers() const override {
+    return kAclPacketBuffers;
+  }
+
+  uint16_t GetAclPacketLength() const override {
+    return kAclPacketLength;
+  }
+
+  LeBufferSize GetLeBufferSize() const override {
+    LeBufferSize le_buffer_size;
+    le_buffer_size.le_data_packet_length_ = kLeAclPacketLength;
+    le_buffer_size.total_num_le_packets_ = kLeAclPacketBuffers;
+    return le_buffer_size;
+  }
+
+  void RegisterCompletedAclPacketsCallback(CompletedAclPacketsCallback cb) override {
+    acl_credits_callback_ = cb;
+  }
+
+  void UnregisterCompletedAclPacketsCallback() override {
+    acl_credits_callback_ = {};
+  }
+
+  void SendCompletedAclPacketsCallback(uint16_t handle, uint16_t credits) {
+    acl_credits_callback_.Invoke(handle, credits);
+  }
+
+  static constexpr uint16_t kAclPacketBuffers = 8;
+  static constexpr uint16_t kAclPacketLength = 1021;
+  static constexpr uint16_t kLeAclPacketBuffers = 8;
+  static constexpr uint16_t kLeAclPacketLength = 251;
+
+ private:
+  CompletedAclPacketsCallback acl_credits_callback_;
+};
+
+}  // namespace
+
+// ACL TX packets per second from the connection queues through RoundRobinScheduler and AclFragmenter down to the
+// HCI queue. The fake controller returns each credit as soon as the fragment reaches the HCI queue.
+class BM_RoundRobinScheduler : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = new os::Thread("round_robin_benchmark", os::Thread::Priority::NORMAL);
+    handler_ = new os::Handler(thread_);
+    controller_ = new BenchmarkController();
+    hci_queue_ = std::make_unique<common::BidiQueue<AclView, AclBuilder>>(3);
+    round_robin_scheduler_ = new RoundRobinScheduler(handler_, controller_, hci_queue_->GetUpEnd());
+    hci_queue_->GetDownEnd()->RegisterDequeue(
+        handler_, common::Bind(&BM_RoundRobinScheduler::hci_down_end_dequeue, common::Unretained(this)));
+  }
+
+  void TearDown(State& st) override {
+    hci_queue_->GetDownEnd()->UnregisterDequeue();
+    delete round_robin_scheduler_;
+    delete controller_;
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+    hci_queue_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void hci_down_end_dequeue() {
+    auto packet = hci_queue_->GetDownEnd()->TryDequeue();
+    // Serialize the fragment as the HAL would, and read back its handle to return the credit
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    bytes->reserve(packet->size());
+    packet::BitInserter i(*bytes);
+    packet->Serialize(i);
+    auto acl = AclView::Create(packet::PacketView<packet::kLittleEndian>(bytes));
+    ASSERT(acl.IsValid());
+    controller_->SendCompletedAclPacketsCallback(acl.GetHandle(), 1);
+
+    if (--fragments_remaining_ == 0) {
+      promise_->set_value();
+    }
+  }
+
+  void RunTraffic(RoundRobinScheduler::ConnectionType type, size_t connections, size_t packets, size_t sdu_size) {
+    size_t mtu = type == RoundRobinScheduler::ConnectionType::LE ? BenchmarkController::kLeAclPacketLength
+                                                                 : BenchmarkController::kAclPacketLength;
+    fragments_remaining_ = connections * packets * ((sdu_size + mtu - 1) / mtu);
+    promise_ = std::make_unique<std::promise<void>>();
+    auto future = promise_->get_future();
+
+    std::vector<std::shared_ptr<AclConnection::Queue>> queues;
+    std::vector<std::unique_ptr<os::EnqueueBuffer<packet::BasePacketBuilder>>> buffers;
+    for (size_t c = 0; c < connections; c++) {
+      uint16_t handle = static_cast<uint16_t>(0x0001 + c);
+      queues.push_back(std::make_shared<AclConnection::Queue>(10));
+      round_robin_scheduler_->Register(type, handle, queues.back());
+      buffers.push_back(std::make_unique<os::EnqueueBuffer<packet::BasePacketBuilder>>(queues.back()->GetUpEnd()));
+    }
+
+    std::vector<uint8_t> payload(sdu_size, 0x42);
+    for (size_t p = 0; p < packets; p++) {
+      for (auto& buffer : buffers) {
+        auto sdu = std::make_unique<packet::RawBuilder>();
+        sdu->AddOctets(payload);
+        buffer->Enqueue(std::move(sdu), handler_);
+      }
+    }
+    future.wait();
+
+    // Unregister on the scheduler thread, as AclManager does
+    std::promise<void> done;
+    auto done_future = done.get_future();
+    handler_->Post(common::BindOnce(
+        [](RoundRobinScheduler* scheduler,
+           std::vector<std::unique_ptr<os::EnqueueBuffer<packet::BasePacketBuilder>>>* buffers,
+           size_t connections,
+           std::promise<void> done) {
+          buffers->clear();
+          for (size_t c = 0; c < connections; c++) {
+            scheduler->Unregister(static_cast<uint16_t>(0x0001 + c));
+          }
+          done.set_value();
+        },
+        common::Unretained(round_robin_scheduler_),
+        common::Unretained(&buffers),
+        connections,
+        std::move(done)));
+    done_future.wait();
+  }
+
+  os::Thread* thread_;
+  os::Handler* handler_;
+  BenchmarkController* controller_;
+  std::unique_ptr<common::BidiQueue<AclView, AclBuilder>> hci_queue_;
+  RoundRobinScheduler* round_robin_scheduler_;
+  size_t fragments_remaining_ = 0;
+  std::unique_ptr<std::promise<void>> promise_;
+};
+
+constexpr size_t kPacketsPerConnection = 500;
+
+BENCHMARK_DEFINE_F(BM_RoundRobinScheduler, classic_acl_tx)(State& state) {
+  for (auto _ : state) {
+    RunTraffic(RoundRobinScheduler::ConnectionType::CLASSIC, state.range(0), kPacketsPerConnection, state.range(1));
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0) * kPacketsPerConnection);
+  state.SetBytesProcessed(
+      static_cast<int_fast64_t>(state.iterations()) * state.range(0) * kPacketsPerConnection * state.range(1));
+};
+
+// {connections, SDU size}. 672 fits a single fragment, 2000 needs two.
+BENCHMARK_REGISTER_F(BM_RoundRobinScheduler, classic_acl_tx)
+    ->Args({1, 672})
+    ->Args({1, 2000})
+    ->Args({4, 672})
+    ->Args({4, 2000})
+    ->Iterations(20)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(BM_RoundRobinScheduler, le_acl_tx)(State& state) {
+  for (auto _ : state) {
+    RunTraffic(RoundRobinScheduler::ConnectionType::LE, state.range(0), kPacketsPerConnection, state.range(1));
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0) * kPacketsPerConnection);
+  state.SetBytesProcessed(
+      static_cast<int_fast64_t>(state.iterations()) * state.range(0) * kPacketsPerConnection * state.range(1));
+};
+
+// {connections, SDU size}. 247 is a full LE data PDU, 512 a typical L2CAP CoC SDU split in three fragments.
+BENCHMARK_REGISTER_F(BM_RoundRobinScheduler, le_acl_tx)
+    ->Args({1, 247})
+    ->Args({1, 512})
+    ->Args({8, 247})
+    ->Args({8, 512})
+    ->Iterations(20)
+    ->UseRealTime();
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
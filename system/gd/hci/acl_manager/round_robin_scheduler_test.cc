@@ -412,6 +412,94 @@ TEST_F(RoundRobinSchedulerTest, receive_le_credit_when_next_fragment_is_classic)
   round_robin_scheduler_->Unregister(le_handle);
 }
 
+TEST_F(RoundRobinSchedulerTest, count_fragments_per_traffic_class) {
+  uint16_t handle = 0x01;
+  uint16_t le_handle = 0x02;
+  auto connection_queue = std::make_shared<AclConnection::Queue>(10);
+  auto le_connection_queue = std::make_shared<AclConnection::Queue>(10);
+
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle, connection_queue);
+  round_robin_scheduler_->Register(
+      RoundRobinScheduler::ConnectionType::LE, le_handle, le_connection_queue, RoundRobinScheduler::TrafficClass::GATT);
+  round_robin_scheduler_->SetLinkPriority(handle, true);
+
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(4));
+  std::vector<uint8_t> packet = {0x01, 0x02, 0x03};
+  std::vector<uint8_t> le_packet(controller_->le_hci_mtu_ * 3, 0x04);
+  EnqueueAclUpEnd(connection_queue->GetUpEnd(), packet);
+  EnqueueAclUpEnd(le_connection_queue->GetUpEnd(), le_packet);
+  packet_future_->wait();
+
+  auto traffic_class_stats = round_robin_scheduler_->GetTrafficClassStats();
+  ASSERT_EQ(traffic_class_stats[RoundRobinScheduler::TrafficClass::AUDIO].stats.dequeued, 1u);
+  ASSERT_EQ(traffic_class_stats[RoundRobinScheduler::TrafficClass::GATT].stats.dequeued, 3u);
+  ASSERT_EQ(traffic_class_stats[RoundRobinScheduler::TrafficClass::BULK].stats.dequeued, 0u);
+  ASSERT_GT(traffic_class_stats[RoundRobinScheduler::TrafficClass::AUDIO].quantum_bytes,
+            traffic_class_stats[RoundRobinScheduler::TrafficClass::BULK].quantum_bytes);
+
+  round_robin_scheduler_->Unregister(handle);
+  round_robin_scheduler_->Unregister(le_handle);
+}
+
+TEST_F(RoundRobinSchedulerTest, reserve_credits_for_audio_link) {
+  uint16_t handle = 0x01;
+  uint16_t audio_handle = 0x02;
+  auto connection_queue = std::make_shared<AclConnection::Queue>(20);
+  auto audio_connection_queue = std::make_shared<AclConnection::Queue>(10);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle, connection_queue);
+  round_robin_scheduler_->Register(
+      RoundRobinScheduler::ConnectionType::CLASSIC,
+      audio_handle,
+      audio_connection_queue,
+      RoundRobinScheduler::TrafficClass::AUDIO);
+  uint16_t reserved_credits = round_robin_scheduler_->GetReservedCredits();
+  ASSERT_GT(reserved_credits, 0);
+  ASSERT_EQ(round_robin_scheduler_->GetLeReservedCredits(), 0);
+
+  // Bulk traffic stops short of the reserved credits
+  uint16_t bulk_packets = controller_->max_acl_packet_credits_ - reserved_credits;
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(bulk_packets));
+  std::vector<uint8_t> packet = {0x01, 0x02, 0x03};
+  for (uint16_t i = 0; i < bulk_packets + 1; i++) {
+    EnqueueAclUpEnd(connection_queue->GetUpEnd(), packet);
+  }
+  packet_future_->wait();
+  sync_handler();
+  ASSERT_EQ(round_robin_scheduler_->GetCredits(), reserved_credits);
+
+  // The audio link still gets a buffer
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(1));
+  std::vector<uint8_t> audio_packet = {0x04, 0x05, 0x06};
+  EnqueueAclUpEnd(audio_connection_queue->GetUpEnd(), audio_packet);
+  packet_future_->wait();
+  for (uint16_t i = 0; i < bulk_packets; i++) {
+    VerifyPacket(handle, packet);
+  }
+  VerifyPacket(audio_handle, audio_packet);
+  ASSERT_EQ(round_robin_scheduler_->GetCredits(), reserved_credits - 1);
+
+  auto connection_stats = round_robin_scheduler_->GetConnectionStats();
+  ASSERT_EQ(connection_stats.size(), 2u);
+  ASSERT_EQ(connection_stats[0].handle, handle);
+  ASSERT_EQ(connection_stats[0].traffic_class, RoundRobinScheduler::TrafficClass::BULK);
+  ASSERT_EQ(connection_stats[0].outstanding_credits, bulk_packets);
+  ASSERT_EQ(connection_stats[0].sent_fragments, bulk_packets);
+  ASSERT_EQ(connection_stats[1].handle, audio_handle);
+  ASSERT_EQ(connection_stats[1].traffic_class, RoundRobinScheduler::TrafficClass::AUDIO);
+  ASSERT_EQ(connection_stats[1].outstanding_credits, 1);
+  ASSERT_EQ(connection_stats[1].sent_fragments, 1u);
+  ASSERT_GE(connection_stats[1].max_queueing_delay_us, connection_stats[1].average_queueing_delay_us);
+
+  // The held back bulk packet goes once the audio link is gone
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(1));
+  round_robin_scheduler_->Unregister(audio_handle);
+  ASSERT_EQ(round_robin_scheduler_->GetReservedCredits(), 0);
+  packet_future_->wait();
+  VerifyPacket(handle, packet);
+
+  round_robin_scheduler_->Unregister(handle);
+}
+
 }  // namespace
 }  // namespace acl_manager
 }  // namespace hci
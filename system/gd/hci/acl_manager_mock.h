@@ -73,6 +73,16 @@ class MockAclManager : public AclManager {
   MOCK_METHOD(void, RegisterLeCallbacks, (LeConnectionCallbacks * callbacks, os::Handler* handler), (override));
   MOCK_METHOD(void, CreateConnection, (Address address), (override));
   MOCK_METHOD(void, CreateLeConnection, (AddressWithType address_with_type, bool is_direct), (override));
+  MOCK_METHOD(
+      void,
+      UpdateLeAcceptList,
+      (std::vector<AddressWithType> to_remove, std::vector<AddressWithType> to_add),
+      (override));
+  MOCK_METHOD(
+      void,
+      UpdateResolvingList,
+      (std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add),
+      (override));
   MOCK_METHOD(void, CancelConnect, (Address address), (override));
   MOCK_METHOD(
       void,
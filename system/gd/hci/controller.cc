@@ -19,15 +19,20 @@
 #include <android-base/strings.h>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/init_flags.h"
 #include "dumpsys_data_generated.h"
+#include "hci/controller_capability_cache.h"
 #include "hci/event_checkers.h"
 #include "hci/hci_layer.h"
 #include "hci_controller_generated.h"
 #include "os/metrics.h"
+#include "os/parameter_provider.h"
 #include "os/system_properties.h"
 #include "sysprops/sysprops_module.h"
 
@@ -41,6 +46,7 @@ static const std::string kPropertyVendorCapabilitiesEnabled =
     "bluetooth.core.le.vendor_capabilities.enabled";
 static const char kPropertyDisabledCommands[] =
     "bluetooth.hci.disabled_commands";
+constexpr bool kDefaultCapabilityCacheEnabled = false;
 
 using os::Handler;
 
@@ -57,32 +63,50 @@ struct Controller::impl {
     write_le_host_support(Enable::ENABLED, Enable::DISABLED);
     hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
                          handler->BindOnceOn(this, &Controller::impl::read_local_name_complete_handler));
-    hci_->EnqueueCommand(ReadLocalVersionInformationBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_version_information_complete_handler));
-    hci_->EnqueueCommand(ReadLocalSupportedCommandsBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_supported_commands_complete_handler));
 
+    // The capability cache belongs to the controller and firmware version, wait for them
+    std::promise<void> version_promise;
+    auto version_future = version_promise.get_future();
     hci_->EnqueueCommand(
+        ReadLocalVersionInformationBuilder::Create(),
+        handler->BindOnceOn(
+            this, &Controller::impl::read_local_version_information_complete_handler, std::move(version_promise)));
+    if (os::GetSystemPropertyBool(Controller::kPropertyCapabilityCacheEnabled, kDefaultCapabilityCacheEnabled)) {
+      version_future.wait();
+      load_capability_cache();
+    }
+
+    read_capability(
+        OpCode::READ_LOCAL_SUPPORTED_COMMANDS,
+        ReadLocalSupportedCommandsBuilder::Create(),
+        &Controller::impl::read_local_supported_commands_complete_handler);
+
+    read_capability(
+        OpCode::LE_READ_LOCAL_SUPPORTED_FEATURES,
         LeReadLocalSupportedFeaturesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_local_supported_features_handler));
+        &Controller::impl::le_read_local_supported_features_handler);
 
-    hci_->EnqueueCommand(
+    read_capability(
+        OpCode::LE_READ_SUPPORTED_STATES,
         LeReadSupportedStatesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_supported_states_handler));
+        &Controller::impl::le_read_supported_states_handler);
 
     // Wait for all extended features read
-    std::promise<void> features_promise;
-    auto features_future = features_promise.get_future();
+    extended_features_promise_ = std::promise<void>();
+    auto features_future = extended_features_promise_.get_future();
 
-    hci_->EnqueueCommand(ReadLocalExtendedFeaturesBuilder::Create(0x00),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                             std::move(features_promise)));
+    read_capability(
+        OpCode::READ_LOCAL_EXTENDED_FEATURES,
+        ReadLocalExtendedFeaturesBuilder::Create(0x00),
+        &Controller::impl::read_local_extended_features_complete_handler);
     features_future.wait();
 
     le_set_event_mask(MaskLeEventMask(local_version_information_.hci_version_, kDefaultLeEventMask));
 
-    hci_->EnqueueCommand(ReadBufferSizeBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_buffer_size_complete_handler));
+    read_capability(
+        OpCode::READ_BUFFER_SIZE,
+        ReadBufferSizeBuilder::Create(),
+        &Controller::impl::read_buffer_size_complete_handler);
 
     if (common::init_flags::set_min_encryption_is_enabled() && is_supported(OpCode::SET_MIN_ENCRYPTION_KEY_SIZE)) {
       hci_->EnqueueCommand(
@@ -91,37 +115,44 @@ struct Controller::impl {
     }
 
     if (is_supported(OpCode::LE_READ_BUFFER_SIZE_V2)) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_BUFFER_SIZE_V2,
           LeReadBufferSizeV2Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_v2_handler));
+          &Controller::impl::le_read_buffer_size_v2_handler);
     } else {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_BUFFER_SIZE_V1,
           LeReadBufferSizeV1Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_handler));
+          &Controller::impl::le_read_buffer_size_handler);
     }
 
     if (is_supported(OpCode::READ_LOCAL_SUPPORTED_CODECS_V1)) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::READ_LOCAL_SUPPORTED_CODECS_V1,
           ReadLocalSupportedCodecsV1Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::read_local_supported_codecs_v1_handler));
+          &Controller::impl::read_local_supported_codecs_v1_handler);
     }
 
-    hci_->EnqueueCommand(
+    read_capability(
+        OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE,
         LeReadFilterAcceptListSizeBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_connect_list_size_handler));
+        &Controller::impl::le_read_connect_list_size_handler);
 
     if (is_supported(OpCode::LE_READ_RESOLVING_LIST_SIZE) && module_.SupportsBlePrivacy()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_RESOLVING_LIST_SIZE,
           LeReadResolvingListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_resolving_list_size_handler));
+          &Controller::impl::le_read_resolving_list_size_handler);
     } else {
       LOG_INFO("LE_READ_RESOLVING_LIST_SIZE not supported, defaulting to 0");
       le_resolving_list_size_ = 0;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(LeReadMaximumDataLengthBuilder::Create(),
-                           handler->BindOnceOn(this, &Controller::impl::le_read_maximum_data_length_handler));
+      read_capability(
+          OpCode::LE_READ_MAXIMUM_DATA_LENGTH,
+          LeReadMaximumDataLengthBuilder::Create(),
+          &Controller::impl::le_read_maximum_data_length_handler);
     } else {
       LOG_INFO("LE_READ_MAXIMUM_DATA_LENGTH not supported, defaulting to 0");
       le_maximum_data_length_.supported_max_rx_octets_ = 0;
@@ -139,18 +170,20 @@ struct Controller::impl {
               this, &Controller::impl::write_secure_connections_host_support_complete_handler));
     }
     if (is_supported(OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH,
           LeReadSuggestedDefaultDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_suggested_default_data_length_handler));
+          &Controller::impl::le_read_suggested_default_data_length_handler);
     } else {
       LOG_INFO("LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH not supported, defaulting to 27 (0x1B)");
       le_suggested_default_data_length_ = 27;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH) && module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH,
           LeReadMaximumAdvertisingDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_maximum_advertising_data_length_handler));
+          &Controller::impl::le_read_maximum_advertising_data_length_handler);
     } else {
       LOG_INFO("LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH not supported, defaulting to 31 (0x1F)");
       le_maximum_advertising_data_length_ = 31;
@@ -158,9 +191,10 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS) &&
         module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS,
           LeReadNumberOfSupportedAdvertisingSetsBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_number_of_supported_advertising_sets_handler));
+          &Controller::impl::le_read_number_of_supported_advertising_sets_handler);
     } else {
       LOG_INFO("LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS not supported, defaulting to 1");
       le_number_supported_advertising_sets_ = 1;
@@ -168,9 +202,10 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE) &&
         module_.SupportsBlePeriodicAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE,
           LeReadPeriodicAdvertiserListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_periodic_advertiser_list_size_handler));
+          &Controller::impl::le_read_periodic_advertiser_list_size_handler);
     } else {
       LOG_INFO("LE_READ_PERIODIC_ADVERTISER_LIST_SIZE not supported, defaulting to 0");
       le_periodic_advertiser_list_size_ = 0;
@@ -199,9 +234,10 @@ struct Controller::impl {
     // Skip vendor capabilities check if configured.
     if (os::GetSystemPropertyBool(
             kPropertyVendorCapabilitiesEnabled, kDefaultVendorCapabilitiesEnabled)) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_GET_VENDOR_CAPABILITIES,
           LeGetVendorCapabilitiesBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_get_vendor_capabilities_handler));
+          &Controller::impl::le_get_vendor_capabilities_handler);
     } else {
       vendor_capabilities_.is_supported_ = 0x00;
     }
@@ -213,12 +249,122 @@ struct Controller::impl {
         ReadBdAddrBuilder::Create(),
         handler->BindOnceOn(this, &Controller::impl::read_controller_mac_address_handler, std::move(promise)));
     future.wait();
+
+    if (capability_cache_enabled_) {
+      finish_capability_cache();
+    }
   }
 
   void Stop() {
     hci_ = nullptr;
   }
 
+  // Identity of the controller capability cache, the version information read from the controller
+  std::vector<uint8_t> capability_cache_identity() const {
+    return {
+        static_cast<uint8_t>(local_version_information_.hci_version_),
+        static_cast<uint8_t>(local_version_information_.hci_revision_),
+        static_cast<uint8_t>(local_version_information_.hci_revision_ >> 8),
+        static_cast<uint8_t>(local_version_information_.lmp_version_),
+        static_cast<uint8_t>(local_version_information_.manufacturer_name_),
+        static_cast<uint8_t>(local_version_information_.manufacturer_name_ >> 8),
+        static_cast<uint8_t>(local_version_information_.lmp_subversion_),
+        static_cast<uint8_t>(local_version_information_.lmp_subversion_ >> 8),
+    };
+  }
+
+  void load_capability_cache() {
+    auto cache = ControllerCapabilityCache::Load(
+        os::ParameterProvider::ControllerCapabilityCacheFilePath(), capability_cache_identity());
+    std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+    LOG_INFO("Loaded %zu cached controller capabilities", cache.Size());
+    capability_cache_.emplace(std::move(cache));
+    capability_cache_enabled_ = true;
+  }
+
+  // Reads served from the cache are validated against the controller once the module started
+  void finish_capability_cache() {
+    std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+    if (capability_cache_dirty_) {
+      capability_cache_->Save(os::ParameterProvider::ControllerCapabilityCacheFilePath());
+      capability_cache_dirty_ = false;
+    }
+    if (!pending_capability_validations_.empty()) {
+      module_.GetHandler()->CallOn(this, &Controller::impl::validate_capability_cache);
+    }
+  }
+
+  // Hand the cached Command Complete event of the read to |handler|, or send the read to the controller and cache
+  // its Command Complete event
+  void read_capability(
+      OpCode op_code,
+      std::unique_ptr<CommandBuilder> command,
+      void (Controller::impl::*handler)(CommandCompleteView),
+      uint8_t page = 0) {
+    if (capability_cache_enabled_) {
+      std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+      const std::vector<uint8_t>* event = capability_cache_->Get(static_cast<uint16_t>(op_code), page);
+      if (event != nullptr) {
+        auto bytes = std::make_shared<std::vector<uint8_t>>(*event);
+        auto view = CommandCompleteView::Create(EventView::Create(packet::PacketView<packet::kLittleEndian>(bytes)));
+        if (view.IsValid() && view.GetCommandOpCode() == op_code) {
+          capability_cache_hits_++;
+          pending_capability_validations_.push_back({op_code, page, std::move(command)});
+          module_.GetHandler()->CallOn(this, handler, view);
+          return;
+        }
+        LOG_WARN("Ignoring invalid cached %s", OpCodeText(op_code).c_str());
+      }
+    }
+    hci_->EnqueueCommand(
+        std::move(command),
+        module_.GetHandler()->BindOnceOn(this, &Controller::impl::on_capability_read, page, handler));
+  }
+
+  void on_capability_read(
+      uint8_t page, void (Controller::impl::*handler)(CommandCompleteView), CommandCompleteView view) {
+    if (capability_cache_enabled_ && view.IsValid()) {
+      std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+      capability_cache_->Set(static_cast<uint16_t>(view.GetCommandOpCode()), page, {view.begin(), view.end()});
+      capability_cache_dirty_ = true;
+    }
+    (this->*handler)(view);
+  }
+
+  void validate_capability_cache() {
+    if (hci_ == nullptr) {
+      return;
+    }
+    std::vector<CapabilityValidation> validations;
+    {
+      std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+      validations.swap(pending_capability_validations_);
+    }
+    for (auto& validation : validations) {
+      hci_->EnqueueCommand(
+          std::move(validation.command),
+          module_.GetHandler()->BindOnceOn(
+              this, &Controller::impl::on_capability_validated, validation.op_code, validation.page));
+    }
+  }
+
+  // Values already handed out stay as they are, a stale cache is only fixed for the next start
+  void on_capability_validated(OpCode op_code, uint8_t page, CommandCompleteView view) {
+    if (!view.IsValid()) {
+      LOG_WARN("Invalid %s Command Complete while validating the capability cache", OpCodeText(op_code).c_str());
+      return;
+    }
+    std::vector<uint8_t> event(view.begin(), view.end());
+    std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+    if (capability_cache_->Matches(static_cast<uint16_t>(op_code), page, event)) {
+      return;
+    }
+    LOG_WARN("Cached %s is stale, updating the controller capability cache", OpCodeText(op_code).c_str());
+    capability_cache_mismatches_++;
+    capability_cache_->Set(static_cast<uint16_t>(op_code), page, std::move(event));
+    capability_cache_->Save(os::ParameterProvider::ControllerCapabilityCacheFilePath());
+  }
+
   void NumberOfCompletedPackets(EventView event) {
     if (acl_credits_callback_.IsEmpty()) {
       LOG_WARN("Received event when AclManager is not listening");
@@ -285,7 +431,7 @@ struct Controller::impl {
     local_name_.erase(std::find(local_name_.begin(), local_name_.end(), '\0'), local_name_.end());
   }
 
-  void read_local_version_information_complete_handler(CommandCompleteView view) {
+  void read_local_version_information_complete_handler(std::promise<void> promise, CommandCompleteView view) {
     auto complete_view = ReadLocalVersionInformationCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
@@ -298,6 +444,7 @@ struct Controller::impl {
         local_version_information_.lmp_subversion_,
         static_cast<uint8_t>(local_version_information_.hci_version_),
         local_version_information_.hci_revision_);
+    promise.set_value();
   }
 
   void read_local_supported_commands_complete_handler(CommandCompleteView view) {
@@ -317,7 +464,7 @@ struct Controller::impl {
     }
   }
 
-  void read_local_extended_features_complete_handler(std::promise<void> promise, CommandCompleteView view) {
+  void read_local_extended_features_complete_handler(CommandCompleteView view) {
     auto complete_view = ReadLocalExtendedFeaturesCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
@@ -328,12 +475,13 @@ struct Controller::impl {
     // Query all extended features
     if (page_number < complete_view.GetMaximumPageNumber()) {
       page_number++;
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::READ_LOCAL_EXTENDED_FEATURES,
           ReadLocalExtendedFeaturesBuilder::Create(page_number),
-          module_.GetHandler()->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                           std::move(promise)));
+          &Controller::impl::read_local_extended_features_complete_handler,
+          page_number);
     } else {
-      promise.set_value();
+      extended_features_promise_.set_value();
     }
   }
 
@@ -1107,6 +1255,23 @@ struct Controller::impl {
   uint8_t le_number_supported_advertising_sets_{};
   uint8_t le_periodic_advertiser_list_size_{};
   VendorCapabilities vendor_capabilities_{};
+
+  struct CapabilityValidation {
+    OpCode op_code;
+    uint8_t page;
+    std::unique_ptr<CommandBuilder> command;
+  };
+
+  std::promise<void> extended_features_promise_;
+  // Set before the first capability read and never changed afterwards
+  bool capability_cache_enabled_ = false;
+  // Guards the cache, read and written from both the starting thread and the module handler
+  mutable std::mutex capability_cache_mutex_;
+  std::optional<ControllerCapabilityCache> capability_cache_;
+  bool capability_cache_dirty_ = false;
+  std::vector<CapabilityValidation> pending_capability_validations_;
+  uint32_t capability_cache_hits_ = 0;
+  uint32_t capability_cache_mismatches_ = 0;
 };  // namespace hci
 
 Controller::Controller() : impl_(std::make_unique<impl>(*this)) {}
@@ -1477,6 +1642,14 @@ void Controller::impl::Dump(
 
   auto extended_lmp_features_vector = fb_builder->CreateVector(extended_lmp_features_array_);
 
+  uint32_t capability_cache_hits = 0;
+  uint32_t capability_cache_mismatches = 0;
+  {
+    std::lock_guard<std::mutex> lock(capability_cache_mutex_);
+    capability_cache_hits = capability_cache_hits_;
+    capability_cache_mismatches = capability_cache_mismatches_;
+  }
+
   // Create the root table
   ControllerDataBuilder builder(*fb_builder);
 
@@ -1502,6 +1675,9 @@ void Controller::impl::Dump(
   builder.add_le_local_supported_features(le_local_supported_features_);
   builder.add_le_supported_states(le_supported_states_);
   builder.add_vendor_capabilities(&vendor_capabilities_data);
+  builder.add_capability_cache_enabled(capability_cache_enabled_);
+  builder.add_capability_cache_hits(capability_cache_hits);
+  builder.add_capability_cache_mismatches(capability_cache_mismatches);
 
   flatbuffers::Offset<ControllerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
@@ -221,6 +221,10 @@ class Controller : public Module {
 
   static uint64_t MaskLeEventMask(HciVersion version, uint64_t mask);
 
+  // When true, the capability reads are answered from the Command Complete events cached at a previous start with
+  // the same controller and firmware version, then validated against the controller once the module started.
+  static constexpr char kPropertyCapabilityCacheEnabled[] = "bluetooth.hci.controller_capability_cache.enabled";
+
  protected:
   void ListDependencies(ModuleList* list) const override;
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/controller_capability_cache.h"
+
+#include <sstream>
+
+#include "common/strings.h"
+#include "os/files.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+constexpr char kVersionKey[] = "version";
+constexpr char kIdentityKey[] = "identity";
+// Num_HCI_Command_Packets of a Command Complete event, after the event code and parameter length
+constexpr size_t kCommandCreditsOffset = 2;
+
+uint32_t make_key(uint16_t op_code, uint8_t page) {
+  return (static_cast<uint32_t>(op_code) << 8) | page;
+}
+
+}  // namespace
+
+const std::vector<uint8_t>* ControllerCapabilityCache::Get(uint16_t op_code, uint8_t page) const {
+  auto event = events_.find(make_key(op_code, page));
+  return event == events_.end() ? nullptr : &event->second;
+}
+
+void ControllerCapabilityCache::Set(uint16_t op_code, uint8_t page, std::vector<uint8_t> event) {
+  events_.insert_or_assign(make_key(op_code, page), std::move(event));
+}
+
+bool ControllerCapabilityCache::Matches(uint16_t op_code, uint8_t page, const std::vector<uint8_t>& event) const {
+  const std::vector<uint8_t>* cached_event = Get(op_code, page);
+  if (cached_event == nullptr || cached_event->size() != event.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < event.size(); i++) {
+    if (i != kCommandCreditsOffset && (*cached_event)[i] != event[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// One "<key> <value>" line per entry, the key of an event being its op code and page in hex
+std::string ControllerCapabilityCache::Serialize() const {
+  std::stringstream data;
+  data << kVersionKey << " " << kVersion << "\n";
+  data << kIdentityKey << " " << common::ToHexString(identity_) << "\n";
+  for (const auto& [key, event] : events_) {
+    data << common::StringFormat("%06x", key) << " " << common::ToHexString(event) << "\n";
+  }
+  return data.str();
+}
+
+std::optional<ControllerCapabilityCache> ControllerCapabilityCache::Parse(const std::string& data) {
+  auto lines = common::StringSplit(data, "\n");
+  if (lines.size() < 2 || lines[0] != common::StringFormat("%s %d", kVersionKey, kVersion)) {
+    return std::nullopt;
+  }
+  auto identity = common::StringSplit(lines[1], " ");
+  if (identity.size() != 2 || identity[0] != kIdentityKey) {
+    return std::nullopt;
+  }
+  auto identity_bytes = common::FromHexString(identity[1]);
+  if (!identity_bytes) {
+    return std::nullopt;
+  }
+  ControllerCapabilityCache cache(std::move(*identity_bytes));
+  for (size_t i = 2; i < lines.size(); i++) {
+    if (lines[i].empty()) {
+      continue;
+    }
+    auto entry = common::StringSplit(lines[i], " ");
+    if (entry.size() != 2 || entry[0].size() != 6 || !common::IsValidHexString(entry[0])) {
+      return std::nullopt;
+    }
+    auto event = common::FromHexString(entry[1]);
+    if (!event || event->empty()) {
+      return std::nullopt;
+    }
+    cache.events_.insert_or_assign(std::stoul(entry[0], nullptr, 16), std::move(*event));
+  }
+  return cache;
+}
+
+ControllerCapabilityCache ControllerCapabilityCache::Load(
+    const std::string& path, const std::vector<uint8_t>& identity) {
+  auto data = os::ReadSmallFile(path);
+  if (!data) {
+    LOG_INFO("No controller capability cache at %s", path.c_str());
+    return ControllerCapabilityCache(identity);
+  }
+  auto cache = Parse(*data);
+  if (!cache) {
+    LOG_WARN("Ignoring malformed controller capability cache at %s", path.c_str());
+    return ControllerCapabilityCache(identity);
+  }
+  if (cache->identity_ != identity) {
+    LOG_INFO("Ignoring controller capability cache of another controller or firmware");
+    return ControllerCapabilityCache(identity);
+  }
+  return std::move(*cache);
+}
+
+bool ControllerCapabilityCache::Save(const std::string& path) const {
+  if (!os::WriteToFile(path, Serialize())) {
+    LOG_WARN("Unable to write the controller capability cache to %s", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace hci
+}  // namespace bluetooth
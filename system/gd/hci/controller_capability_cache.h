@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace hci {
+
+// Command Complete events of the controller capability reads, kept across enables. The cache
+// belongs to one controller identity, the Read Local Version Information Command Complete
+// event, which holds the manufacturer and the firmware revision. A cache read back for another
+// identity comes back empty.
+class ControllerCapabilityCache {
+ public:
+  explicit ControllerCapabilityCache(std::vector<uint8_t> identity) : identity_(std::move(identity)) {}
+
+  // Return the event cached for |op_code|, |page| tells apart the reads taking a page number
+  const std::vector<uint8_t>* Get(uint16_t op_code, uint8_t page = 0) const;
+  void Set(uint16_t op_code, uint8_t page, std::vector<uint8_t> event);
+  // Return true when |event| is the event cached for |op_code|, whatever command credits they hand back
+  bool Matches(uint16_t op_code, uint8_t page, const std::vector<uint8_t>& event) const;
+  size_t Size() const {
+    return events_.size();
+  }
+  const std::vector<uint8_t>& GetIdentity() const {
+    return identity_;
+  }
+
+  std::string Serialize() const;
+  // Return std::nullopt when |data| is malformed or was written by another cache version
+  static std::optional<ControllerCapabilityCache> Parse(const std::string& data);
+
+  // Return an empty cache for |identity| when |path| is missing, malformed or belongs to another controller
+  static ControllerCapabilityCache Load(const std::string& path, const std::vector<uint8_t>& identity);
+  bool Save(const std::string& path) const;
+
+ private:
+  static constexpr int kVersion = 1;
+
+  std::vector<uint8_t> identity_;
+  std::map<uint32_t, std::vector<uint8_t>> events_;
+};
+
+}  // namespace hci
+}  // namespace bluetooth
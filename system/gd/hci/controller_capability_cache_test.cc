@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/controller_capability_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "os/files.h"
+
+namespace testing {
+
+using bluetooth::hci::ControllerCapabilityCache;
+
+namespace {
+
+const std::vector<uint8_t> kIdentity = {0x09, 0x34, 0x12, 0x08, 0xad, 0x0b, 0x78, 0x56};
+// Read Buffer Size Command Complete
+const std::vector<uint8_t> kReadBufferSizeEvent = {
+    0x0e, 0x0b, 0x01, 0x05, 0x10, 0x00, 0x00, 0x04, 0x3c, 0x0a, 0x00, 0x0c, 0x00};
+constexpr uint16_t kReadBufferSize = 0x1005;
+constexpr uint16_t kReadLocalExtendedFeatures = 0x1004;
+
+}  // namespace
+
+TEST(ControllerCapabilityCacheTest, get_is_per_op_code_and_page) {
+  ControllerCapabilityCache cache(kIdentity);
+  ASSERT_EQ(cache.Get(kReadBufferSize), nullptr);
+
+  cache.Set(kReadBufferSize, 0, kReadBufferSizeEvent);
+  cache.Set(kReadLocalExtendedFeatures, 1, {0x0e, 0x04, 0x01, 0x04, 0x10, 0x00});
+  ASSERT_EQ(cache.Size(), 2u);
+  ASSERT_NE(cache.Get(kReadBufferSize), nullptr);
+  ASSERT_EQ(*cache.Get(kReadBufferSize), kReadBufferSizeEvent);
+  ASSERT_NE(cache.Get(kReadLocalExtendedFeatures, 1), nullptr);
+  ASSERT_EQ(cache.Get(kReadLocalExtendedFeatures, 0), nullptr);
+}
+
+TEST(ControllerCapabilityCacheTest, matches_ignores_command_credits) {
+  ControllerCapabilityCache cache(kIdentity);
+  cache.Set(kReadBufferSize, 0, kReadBufferSizeEvent);
+
+  auto event = kReadBufferSizeEvent;
+  event[2] = 0x05;
+  ASSERT_TRUE(cache.Matches(kReadBufferSize, 0, event));
+  event[7] = 0x02;
+  ASSERT_FALSE(cache.Matches(kReadBufferSize, 0, event));
+  ASSERT_FALSE(cache.Matches(kReadLocalExtendedFeatures, 0, kReadBufferSizeEvent));
+}
+
+TEST(ControllerCapabilityCacheTest, serialize_parse) {
+  ControllerCapabilityCache cache(kIdentity);
+  cache.Set(kReadBufferSize, 0, kReadBufferSizeEvent);
+  cache.Set(kReadLocalExtendedFeatures, 2, {0x0e, 0x04, 0x01, 0x04, 0x10, 0x00});
+
+  auto parsed = ControllerCapabilityCache::Parse(cache.Serialize());
+  ASSERT_TRUE(parsed.has_value());
+  ASSERT_EQ(parsed->GetIdentity(), kIdentity);
+  ASSERT_EQ(parsed->Size(), 2u);
+  ASSERT_EQ(*parsed->Get(kReadBufferSize), kReadBufferSizeEvent);
+  ASSERT_NE(parsed->Get(kReadLocalExtendedFeatures, 2), nullptr);
+}
+
+TEST(ControllerCapabilityCacheTest, parse_malformed) {
+  ASSERT_FALSE(ControllerCapabilityCache::Parse("").has_value());
+  ASSERT_FALSE(ControllerCapabilityCache::Parse("version 0\nidentity 00\n").has_value());
+  ASSERT_FALSE(ControllerCapabilityCache::Parse("version 1\nidentity zz\n").has_value());
+  ASSERT_FALSE(ControllerCapabilityCache::Parse("version 1\nidentity 00\n100500 0e0\n").has_value());
+  ASSERT_FALSE(ControllerCapabilityCache::Parse("version 1\nidentity 00\n1005 0e00\n").has_value());
+  ASSERT_TRUE(ControllerCapabilityCache::Parse("version 1\nidentity 00\n100500 0e00\n").has_value());
+}
+
+TEST(ControllerCapabilityCacheTest, load_save) {
+  auto path = (std::filesystem::temp_directory_path() / "controller_capability_cache_test.conf").string();
+  if (bluetooth::os::FileExists(path)) {
+    ASSERT_TRUE(bluetooth::os::RemoveFile(path));
+  }
+  ASSERT_EQ(ControllerCapabilityCache::Load(path, kIdentity).Size(), 0u);
+
+  ControllerCapabilityCache cache(kIdentity);
+  cache.Set(kReadBufferSize, 0, kReadBufferSizeEvent);
+  ASSERT_TRUE(cache.Save(path));
+  ASSERT_EQ(ControllerCapabilityCache::Load(path, kIdentity).Size(), 1u);
+
+  // Another firmware version does not get the cached capabilities
+  auto identity = kIdentity;
+  identity[6]++;
+  auto other_cache = ControllerCapabilityCache::Load(path, identity);
+  ASSERT_EQ(other_cache.Size(), 0u);
+  ASSERT_EQ(other_cache.GetIdentity(), identity);
+
+  ASSERT_TRUE(bluetooth::os::RemoveFile(path));
+}
+
+}  // namespace testing
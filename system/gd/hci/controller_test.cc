@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <filesystem>
 #include <future>
 #include <memory>
 
@@ -27,6 +28,9 @@
 #include "hci/address.h"
 #include "hci/hci_layer.h"
 #include "module_dumper.h"
+#include "os/files.h"
+#include "os/parameter_provider.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -337,6 +341,38 @@ class Controller096Test : public ControllerTest {
   }
 };
 
+class ControllerCapabilityCacheTest : public ControllerTest {
+ protected:
+  void SetUp() override {
+    cache_path_ = (std::filesystem::temp_directory_path() / "controller_test_capability_cache.conf").string();
+    if (os::FileExists(cache_path_)) {
+      ASSERT_TRUE(os::RemoveFile(cache_path_));
+    }
+    os::ParameterProvider::OverrideControllerCapabilityCacheFilePath(cache_path_);
+    os::SetSystemProperty(Controller::kPropertyCapabilityCacheEnabled, "true");
+    ControllerTest::SetUp();
+  }
+
+  void TearDown() override {
+    ControllerTest::TearDown();
+    os::SetSystemProperty(Controller::kPropertyCapabilityCacheEnabled, "false");
+    if (os::FileExists(cache_path_)) {
+      os::RemoveFile(cache_path_);
+    }
+    os::ParameterProvider::OverrideControllerCapabilityCacheFilePath("");
+  }
+
+  void RestartController() {
+    fake_registry_.StopAll();
+    test_hci_layer_ = new TestHciLayer;
+    fake_registry_.InjectTestModule(&HciLayer::Factory, test_hci_layer_);
+    fake_registry_.Start<Controller>(&thread_);
+    controller_ = static_cast<Controller*>(fake_registry_.GetModuleUnderTest(&Controller::Factory));
+  }
+
+  std::string cache_path_;
+};
+
 TEST_F(ControllerTest, startup_teardown) {}
 
 TEST_F(ControllerTest, read_controller_info) {
@@ -488,6 +524,19 @@ void CheckReceivedCredits(uint16_t handle, uint16_t credits) {
   }
 }
 
+TEST_F(ControllerCapabilityCacheTest, capabilities_are_read_back_from_the_cache) {
+  ASSERT_TRUE(os::FileExists(cache_path_));
+  RestartController();
+
+  ASSERT_EQ(controller_->GetAclPacketLength(), test_hci_layer_->acl_data_packet_length);
+  ASSERT_EQ(controller_->GetNumAclPacketBuffers(), test_hci_layer_->total_num_acl_data_packets);
+  ASSERT_EQ(controller_->GetLeBufferSize().le_data_packet_length_, 0x16);
+  ASSERT_EQ(controller_->GetLocalFeatures(2), 0x012345678abcdefUL + 2);
+  ASSERT_EQ(controller_->GetLeSupportedStates(), 0x001f123456789abeUL);
+  ASSERT_TRUE(controller_->IsSupported(OpCode::READ_BUFFER_SIZE));
+  ASSERT_EQ(controller_->GetVendorCapabilities().max_advt_instances_, 0x10);
+}
+
 TEST_F(ControllerTest, aclCreditCallbacksTest) {
   credits1_set = std::promise<void>();
   credits2_set = std::promise<void>();
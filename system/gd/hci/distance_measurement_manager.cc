@@ -17,7 +17,10 @@
 
 #include <math.h>
 
+#include <algorithm>
+#include <array>
 #include <unordered_map>
+#include <vector>
 
 #include "common/strings.h"
 #include "hci/acl_manager.h"
@@ -54,6 +57,9 @@ static constexpr uint32_t kMinSubeventLen = 0x0004E2;         // 1250us
 static constexpr uint32_t kMaxSubeventLen = 0x3d0900;         // 4s
 static constexpr uint8_t kToneAntennaConfigSelection = 0x07;  // 2x2
 static constexpr uint8_t kTxPwrDelta = 0x00;
+static constexpr uint8_t kCsStepModeTwo = 0x02;
+static constexpr uint8_t kCsMaxAntennaPaths = 0x04;
+static constexpr uint8_t kCsToneDataSize = 4;  // 3 bytes of PCT, 1 byte of tone quality indicator
 
 struct DistanceMeasurementManager::impl {
   ~impl() {}
@@ -204,11 +210,15 @@ struct DistanceMeasurementManager::impl {
     }
     switch (event.GetSubeventCode()) {
       case hci::SubeventCode::LE_CS_TEST_END_COMPLETE:
-      case hci::SubeventCode::LE_CS_SUBEVENT_RESULT_CONTINUE:
-      case hci::SubeventCode::LE_CS_SUBEVENT_RESULT:
       case hci::SubeventCode::LE_CS_READ_REMOTE_FAE_TABLE_COMPLETE: {
         LOG_WARN("Unhandled subevent %s", hci::SubeventCodeText(event.GetSubeventCode()).c_str());
       } break;
+      case hci::SubeventCode::LE_CS_SUBEVENT_RESULT_CONTINUE: {
+        on_cs_subevent_result_continue(LeCsSubeventResultContinueView::Create(event));
+      } break;
+      case hci::SubeventCode::LE_CS_SUBEVENT_RESULT: {
+        on_cs_subevent_result(LeCsSubeventResultView::Create(event));
+      } break;
       case hci::SubeventCode::LE_CS_PROCEDURE_ENABLE_COMPLETE: {
         on_cs_procedure_enable_complete(LeCsProcedureEnableCompleteView::Create(event));
       } break;
@@ -463,6 +473,112 @@ struct DistanceMeasurementManager::impl {
     }
   }
 
+  void on_cs_subevent_result(LeCsSubeventResultView event_view) {
+    if (!event_view.IsValid()) {
+      LOG_WARN("Get invalid LeCsSubeventResultView");
+      return;
+    }
+    uint16_t connection_handle = event_view.GetConnectionHandle();
+    if (cs_trackers_.find(connection_handle) == cs_trackers_.end()) {
+      LOG_WARN("Can't find cs tracker for connection_handle %d", connection_handle);
+      return;
+    }
+    CsProcedureData& procedure_data = cs_trackers_[connection_handle].procedure_data;
+    uint16_t procedure_counter = event_view.GetProcedureCounter();
+    if (!procedure_data.in_progress || procedure_data.procedure_counter != procedure_counter) {
+      procedure_data.Reset(procedure_counter, event_view.GetNumAntennaPaths());
+    }
+    append_cs_tone_data(
+        connection_handle, event_view.GetNumAntennaPaths(), event_view.GetResultDataStructures());
+    on_cs_subevent_done(
+        connection_handle, event_view.GetProcedureDoneStatus(), event_view.GetAbortReason());
+  }
+
+  void on_cs_subevent_result_continue(LeCsSubeventResultContinueView event_view) {
+    if (!event_view.IsValid()) {
+      LOG_WARN("Get invalid LeCsSubeventResultContinueView");
+      return;
+    }
+    uint16_t connection_handle = event_view.GetConnectionHandle();
+    if (cs_trackers_.find(connection_handle) == cs_trackers_.end()) {
+      LOG_WARN("Can't find cs tracker for connection_handle %d", connection_handle);
+      return;
+    }
+    CsProcedureData& procedure_data = cs_trackers_[connection_handle].procedure_data;
+    if (!procedure_data.in_progress) {
+      LOG_WARN("Drop subevent result continue without procedure, connection_handle %d", connection_handle);
+      return;
+    }
+    append_cs_tone_data(
+        connection_handle, event_view.GetNumAntennaPaths(), event_view.GetResultDataStructures());
+    on_cs_subevent_done(
+        connection_handle, event_view.GetProcedureDoneStatus(), event_view.GetAbortReason());
+  }
+
+  // Packs the tones of the mode 2 steps, read straight from the step data, into the per antenna path
+  // arrays of the procedure
+  void append_cs_tone_data(
+      uint16_t connection_handle,
+      uint8_t num_antenna_paths,
+      const std::vector<LeCsResultDataStructure>& result_data_structures) {
+    CsProcedureData& procedure_data = cs_trackers_[connection_handle].procedure_data;
+    if (num_antenna_paths != procedure_data.num_antenna_paths) {
+      LOG_WARN(
+          "Number of antenna paths changed from %d to %d during procedure %d",
+          procedure_data.num_antenna_paths,
+          num_antenna_paths,
+          procedure_data.procedure_counter);
+      return;
+    }
+    // Antenna permutation index, then one tone per antenna path and one for the tone extension slot
+    size_t min_step_data_size = 1 + kCsToneDataSize * num_antenna_paths;
+    for (const auto& result : result_data_structures) {
+      if (result.step_mode_ != kCsStepModeTwo) {
+        continue;
+      }
+      if (result.step_data_.size() < min_step_data_size) {
+        LOG_WARN("Drop mode 2 step with %zu bytes of step data", result.step_data_.size());
+        procedure_data.dropped_steps++;
+        continue;
+      }
+      procedure_data.step_channel.push_back(result.step_channel_);
+      const uint8_t* tone = result.step_data_.data() + 1;
+      for (uint8_t path = 0; path < num_antenna_paths; path++, tone += kCsToneDataSize) {
+        uint32_t pct = tone[0] | (tone[1] << 8) | (tone[2] << 16);
+        // I and Q are 12 bits signed values
+        procedure_data.i_samples[path].push_back(static_cast<int16_t>(pct << 4) >> 4);
+        procedure_data.q_samples[path].push_back(static_cast<int16_t>(pct >> 8) >> 4);
+        procedure_data.tone_quality[path].push_back(tone[3]);
+      }
+    }
+  }
+
+  void on_cs_subevent_done(
+      uint16_t connection_handle, CsProcedureDoneStatus procedure_done_status, uint8_t abort_reason) {
+    CsProcedureData& procedure_data = cs_trackers_[connection_handle].procedure_data;
+    switch (procedure_done_status) {
+      case CsProcedureDoneStatus::PARTIAL_RESULTS:
+        return;
+      case CsProcedureDoneStatus::ALL_RESULTS_COMPLETE:
+        LOG_DEBUG(
+            "Procedure %d complete, connection_handle %d, mode 2 steps %zu, dropped steps %d",
+            procedure_data.procedure_counter,
+            connection_handle,
+            procedure_data.step_channel.size(),
+            procedure_data.dropped_steps);
+        break;
+      default:
+        LOG_WARN(
+            "Procedure %d aborted, connection_handle %d, abort_reason 0x%02x",
+            procedure_data.procedure_counter,
+            connection_handle,
+            abort_reason);
+        procedure_data.Reset(procedure_data.procedure_counter, procedure_data.num_antenna_paths);
+        break;
+    }
+    procedure_data.in_progress = false;
+  }
+
   void on_read_remote_transmit_power_level_status(Address address, CommandStatusView view) {
     auto status_view = LeReadRemoteTransmitPowerLevelStatusView::Create(view);
     if (!status_view.IsValid()) {
@@ -594,6 +710,34 @@ struct DistanceMeasurementManager::impl {
     std::unique_ptr<os::Alarm> alarm;
   };
 
+  // Tone data of the mode 2 steps of a CS procedure, accumulated over its subevent results. The fields are
+  // kept in separate contiguous arrays, indexed by antenna path then by step, for the distance estimation to
+  // run over them without walking the packets again.
+  struct CsProcedureData {
+    bool in_progress = false;
+    uint16_t procedure_counter = 0;
+    uint8_t num_antenna_paths = 0;
+    uint16_t dropped_steps = 0;
+    std::vector<uint8_t> step_channel;
+    std::array<std::vector<int16_t>, kCsMaxAntennaPaths> i_samples;
+    std::array<std::vector<int16_t>, kCsMaxAntennaPaths> q_samples;
+    std::array<std::vector<uint8_t>, kCsMaxAntennaPaths> tone_quality;
+
+    // Keeps the capacity of the arrays, which is reused by the next procedures
+    void Reset(uint16_t counter, uint8_t antenna_paths) {
+      in_progress = true;
+      procedure_counter = counter;
+      num_antenna_paths = std::min(antenna_paths, kCsMaxAntennaPaths);
+      dropped_steps = 0;
+      step_channel.clear();
+      for (uint8_t path = 0; path < kCsMaxAntennaPaths; path++) {
+        i_samples[path].clear();
+        q_samples[path].clear();
+        tone_quality[path].clear();
+      }
+    }
+  };
+
   struct CsTracker {
     Address address;
     uint16_t local_counter;
@@ -605,6 +749,7 @@ struct DistanceMeasurementManager::impl {
     CsSubModeType sub_mode_type;
     CsRttType rtt_type;
     bool remote_support_phase_based_ranging = false;
+    CsProcedureData procedure_data;
   };
 
   os::Handler* handler_;
@@ -69,6 +69,8 @@ class FuzzHciLayer : public HciLayer {
     }
   }
 
+  void SendHostNumCompletedPackets(std::unique_ptr<hci::HostNumCompletedPacketsBuilder> /* command */) override {}
+
   common::BidiQueueEnd<hci::AclBuilder, hci::AclView>* GetAclQueueEnd() override {
     return acl_queue_.GetUpEnd();
   }
@@ -16,13 +16,23 @@
 
 #include "hci/hci_layer.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <mutex>
+
 #include "common/bind.h"
 #include "common/init_flags.h"
 #include "common/stop_watch.h"
+#include "dumpsys_data_generated.h"
 #include "hci/hci_metrics_logging.h"
+#include "hci_layer_generated.h"
 #include "os/alarm.h"
 #include "os/metrics.h"
 #include "os/queue.h"
+#include "os/repeating_alarm.h"
+#include "os/system_properties.h"
 #include "osi/include/stack_power_telemetry.h"
 #include "packet/packet_builder.h"
 #include "storage/storage_module.h"
@@ -76,7 +86,10 @@ class CommandQueueEntry {
         on_status(std::move(on_status_function)) {}
 
   unique_ptr<CommandBuilder> command;
+  // Set when the command is first considered for sending
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
   unique_ptr<CommandView> command_view;
+  std::chrono::steady_clock::time_point sent_time;
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -98,9 +111,26 @@ class CommandQueueEntry {
   }
 };
 
+struct CommandLatencyStats {
+  uint64_t count = 0;
+  uint64_t total_us = 0;
+  uint64_t max_us = 0;
+};
+
 struct HciLayer::impl {
-  impl(hal::HciHal* hal, HciLayer& module) : hal_(hal), module_(module) {
+  impl(hal::HciHal* hal, HciLayer& module)
+      : hal_(hal),
+        module_(module),
+        command_pipelining_enabled_(
+            os::GetSystemPropertyBool(HciLayer::kPropertyCommandPipeliningEnabled, false)) {
     hci_timeout_alarm_ = new Alarm(module.GetHandler());
+    if (os::GetSystemPropertyBool(HciLayer::kPropertyMetricsAggregationEnabled, false)) {
+      metrics_aggregator_ = std::make_unique<HciMetricsAggregator>();
+      metrics_flush_alarm_ = std::make_unique<os::RepeatingAlarm>(module.GetHandler());
+      metrics_flush_alarm_->Schedule(
+          common::Bind(&HciMetricsAggregator::Flush, common::Unretained(metrics_aggregator_.get())),
+          kMetricsFlushInterval);
+    }
   }
 
   ~impl() {
@@ -113,7 +143,11 @@ struct HciLayer::impl {
     if (hci_abort_alarm_ != nullptr) {
       delete hci_abort_alarm_;
     }
+    if (metrics_flush_alarm_ != nullptr) {
+      metrics_flush_alarm_->Cancel();
+    }
     command_queue_.clear();
+    outstanding_commands_.clear();
   }
 
   void drop(EventView event) {
@@ -123,25 +157,22 @@ struct HciLayer::impl {
   void on_outbound_acl_ready() {
     auto packet = acl_queue_.GetDownEnd()->TryDequeue();
     std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendAclData(bytes);
+    packet->SerializeInto(bytes);
+    hal_->sendAclData(std::move(bytes));
   }
 
   void on_outbound_sco_ready() {
     auto packet = sco_queue_.GetDownEnd()->TryDequeue();
     std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendScoData(bytes);
+    packet->SerializeInto(bytes);
+    hal_->sendScoData(std::move(bytes));
   }
 
   void on_outbound_iso_ready() {
     auto packet = iso_queue_.GetDownEnd()->TryDequeue();
     std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendIsoData(bytes);
+    packet->SerializeInto(bytes);
+    hal_->sendIsoData(std::move(bytes));
   }
 
   template <typename TResponse>
@@ -165,6 +196,25 @@ struct HciLayer::impl {
     handle_command_response<CommandStatusView>(event, "status");
   }
 
+  void send_host_num_completed_packets(std::unique_ptr<HostNumCompletedPacketsBuilder> command) {
+    std::vector<uint8_t> bytes;
+    command->SerializeInto(bytes);
+    hal_->sendHciCommand(bytes);
+  }
+
+  // Host Number Of Completed Packets has no outstanding command to match its response with
+  bool on_host_num_completed_packets_error(EventView event) {
+    auto view = CommandCompleteView::Create(event);
+    if (!view.IsValid() || view.GetCommandOpCode() != OpCode::HOST_NUMBER_OF_COMPLETED_PACKETS) {
+      return false;
+    }
+    auto error_view = HostNumCompletedPacketsErrorView::Create(view);
+    LOG_ERROR(
+        "Host Number Of Completed Packets failed: %s",
+        error_view.IsValid() ? ErrorCodeText(error_view.GetErrorCode()).c_str() : "invalid response");
+    return true;
+  }
+
   void on_command_complete(EventView event) {
     handle_command_response<CommandCompleteView>(event, "complete");
   }
@@ -182,27 +232,33 @@ struct HciLayer::impl {
     bool is_status = logging_id == "status";
 
     ASSERT_LOG(
-        !command_queue_.empty(),
+        !outstanding_commands_.empty(),
         "Unexpected %s event with OpCode 0x%02hx (%s)",
         logging_id.c_str(),
         op_code,
         OpCodeText(op_code).c_str());
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
+    OpCode oldest_op_code = outstanding_commands_.front().command_view->GetOpCode();
+    if (oldest_op_code == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
       LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
       common::StopWatch::DumpStopWatchLog();
       return;
     }
+    // At most one command of each op code is outstanding, so the response matches exactly one of them
+    auto command = std::find_if(
+        outstanding_commands_.begin(), outstanding_commands_.end(), [op_code](const CommandQueueEntry& entry) {
+          return entry.command_view->GetOpCode() == op_code;
+        });
     ASSERT_LOG(
-        waiting_command_ == op_code,
+        command != outstanding_commands_.end(),
         "Waiting for 0x%02hx (%s), got 0x%02hx (%s)",
-        waiting_command_,
-        OpCodeText(waiting_command_).c_str(),
+        oldest_op_code,
+        OpCodeText(oldest_op_code).c_str(),
         op_code,
         OpCodeText(op_code).c_str());
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !command->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected,
       // we can't treat this as hard failure since we have no way of probing this lack of support at
@@ -210,36 +266,49 @@ struct HciLayer::impl {
       // packet, which will be interpreted as invalid response.
       CommandCompleteView command_complete_view = CommandCompleteView::Create(
           EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-      command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(
-          std::move(command_complete_view));
+      command->GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
     } else {
-      if (command_queue_.front().waiting_for_status_ == is_status) {
-        command_queue_.front().GetCallback<TResponse>()->Invoke(std::move(response_view));
+      if (command->waiting_for_status_ == is_status) {
+        command->GetCallback<TResponse>()->Invoke(std::move(response_view));
       } else {
         CommandCompleteView command_complete_view = CommandCompleteView::Create(
             EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-        command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
+        command->GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
       }
     }
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    record_command_latency(op_code, command->sent_time);
+    outstanding_commands_.erase(command);
     if (hci_timeout_alarm_ != nullptr) {
       hci_timeout_alarm_->Cancel();
+      schedule_command_timeout();
       send_next_command();
     }
   }
 
+  void record_command_latency(OpCode op_code, std::chrono::steady_clock::time_point sent_time) {
+    uint64_t latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sent_time).count();
+    if (metrics_aggregator_ != nullptr) {
+      metrics_aggregator_->RecordCommandLatency(op_code, latency_us);
+    }
+    std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+    auto& stats = command_latency_stats_[op_code];
+    stats.count++;
+    stats.total_us += latency_us;
+    stats.max_us = std::max(stats.max_us, latency_us);
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     LOG_ERROR("Timed out waiting for 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
     // TODO: LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size());
+    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size() + outstanding_commands_.size());
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    outstanding_commands_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     // Ignore the response, since we don't know what might come back.
     enqueue_command(ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce([](CommandCompleteView) {}));
     // Don't time out for this one;
@@ -256,30 +325,53 @@ struct HciLayer::impl {
     }
   }
 
-  void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
+  // Commands which are only sent once every other command got its response, and hold back the commands after them
+  static bool must_be_sent_alone(OpCode op_code) {
+    constexpr uint16_t kVendorSpecificOgf = 0x3f;
+    bool is_vendor_specific = (static_cast<uint16_t>(op_code) >> 10) == kVendorSpecificOgf;
+    return op_code == OpCode::RESET || is_vendor_specific;
+  }
+
+  // Serialize the command at the front of the queue, if not done yet
+  const CommandView& prepare_next_command() {
+    auto& entry = command_queue_.front();
+    if (entry.command_view == nullptr) {
+      entry.command_bytes = std::make_shared<std::vector<uint8_t>>();
+      entry.command->SerializeInto(*entry.command_bytes);
+      auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(entry.command_bytes));
+      ASSERT(cmd_view.IsValid());
+      entry.command_view = std::make_unique<CommandView>(std::move(cmd_view));
     }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
+    return *entry.command_view;
+  }
+
+  bool can_send_next_command() {
+    if (command_credits_ == 0 || command_queue_.empty()) {
+      return false;
+    }
+    if (outstanding_commands_.empty()) {
+      return true;
+    }
+    if (!command_pipelining_enabled_) {
+      return false;
+    }
+    OpCode op_code = prepare_next_command().GetOpCode();
+    if (must_be_sent_alone(op_code)) {
+      return false;
     }
-    if (command_queue_.size() == 0) {
+    return std::none_of(
+        outstanding_commands_.begin(), outstanding_commands_.end(), [op_code](const CommandQueueEntry& entry) {
+          OpCode outstanding_op_code = entry.command_view->GetOpCode();
+          return outstanding_op_code == op_code || must_be_sent_alone(outstanding_op_code);
+        });
+  }
+
+  // Time out on the oldest outstanding command
+  void schedule_command_timeout() {
+    if (outstanding_commands_.empty()) {
       return;
     }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
-
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    ASSERT(cmd_view.IsValid());
-    OpCode op_code = cmd_view.GetOpCode();
-    power_telemetry::GetInstance().LogHciCmdDetail();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
+    OpCode op_code = outstanding_commands_.front().command_view->GetOpCode();
     if (hci_timeout_alarm_ != nullptr) {
       hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
     } else {
@@ -287,6 +379,35 @@ struct HciLayer::impl {
     }
   }
 
+  void send_next_command() {
+    while (can_send_next_command()) {
+      OpCode op_code = prepare_next_command().GetOpCode();
+      auto& entry = command_queue_.front();
+      hal_->sendHciCommand(*entry.command_bytes);
+
+      power_telemetry::GetInstance().LogHciCmdDetail();
+      log_link_layer_connection_command(entry.command_view);
+      log_classic_pairing_command_status(entry.command_view, ErrorCode::STATUS_UNKNOWN);
+      entry.sent_time = std::chrono::steady_clock::now();
+      outstanding_commands_.splice(outstanding_commands_.end(), command_queue_, command_queue_.begin());
+      command_credits_--;
+      {
+        std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+        max_outstanding_commands_ = std::max(max_outstanding_commands_, outstanding_commands_.size());
+      }
+      if (outstanding_commands_.size() == 1) {
+        schedule_command_timeout();
+      }
+      LOG_DEBUG(
+          "Sent %s, %zu outstanding, %hhu credits left",
+          OpCodeText(op_code).c_str(),
+          outstanding_commands_.size(),
+          command_credits_);
+    }
+  }
+
+  void Dump(std::promise<flatbuffers::Offset<HciLayerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const;
+
   void register_event(EventCode event, ContextualCallback<void(EventView)> handler) {
     ASSERT_LOG(
         event != EventCode::LE_META_EVENT,
@@ -294,28 +415,36 @@ struct HciLayer::impl {
         EventCode::LE_META_EVENT,
         EventCodeText(EventCode::LE_META_EVENT).c_str());
     ASSERT_LOG(
-        event_handlers_.count(event) == 0,
+        event_handler(event).IsEmpty(),
         "Can not register a second handler for %02hhx (%s)",
         event,
         EventCodeText(event).c_str());
-    event_handlers_[event] = handler;
+    event_handler(event) = handler;
   }
 
   void unregister_event(EventCode event) {
-    event_handlers_.erase(event);
+    event_handler(event) = {};
   }
 
   void register_le_event(SubeventCode event, ContextualCallback<void(LeMetaEventView)> handler) {
     ASSERT_LOG(
-        subevent_handlers_.count(event) == 0,
+        subevent_handler(event).IsEmpty(),
         "Can not register a second handler for %02hhx (%s)",
         event,
         SubeventCodeText(event).c_str());
-    subevent_handlers_[event] = handler;
+    subevent_handler(event) = handler;
   }
 
   void unregister_le_event(SubeventCode event) {
-    subevent_handlers_.erase(subevent_handlers_.find(event));
+    subevent_handler(event) = {};
+  }
+
+  ContextualCallback<void(EventView)>& event_handler(EventCode event) {
+    return event_handlers_[static_cast<uint8_t>(event)];
+  }
+
+  ContextualCallback<void(LeMetaEventView)>& subevent_handler(SubeventCode event) {
+    return subevent_handlers_[static_cast<uint8_t>(event)];
   }
 
   static void abort_after_root_inflammation(uint8_t vse_error) {
@@ -340,9 +469,20 @@ struct HciLayer::impl {
     }
   }
 
+  void log_hci_event_metrics(std::unique_ptr<CommandView>& command_view, EventView event) {
+    if (metrics_aggregator_ != nullptr) {
+      metrics_aggregator_->LogHciEvent(command_view, event, module_.GetDependency<storage::StorageModule>());
+    } else {
+      log_hci_event(command_view, event, module_.GetDependency<storage::StorageModule>());
+    }
+  }
+
   void on_hci_event(EventView event) {
     ASSERT(event.IsValid());
-    if (command_queue_.empty()) {
+    if (event.GetEventCode() == EventCode::COMMAND_COMPLETE && on_host_num_completed_packets_error(event)) {
+      return;
+    }
+    if (outstanding_commands_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -371,12 +511,17 @@ struct HciLayer::impl {
             OpCodeText(op_code).c_str());
       }
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
-      log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
+      log_hci_event_metrics(no_waiting_command, event);
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      log_hci_event_metrics(outstanding_commands_.front().command_view, event);
     }
     power_telemetry::GetInstance().LogHciEvtDetail();
     EventCode event_code = event.GetEventCode();
+    // The credits of the ACL scheduler, the most frequent event during data transfers
+    if (event_code == EventCode::NUMBER_OF_COMPLETED_PACKETS) {
+      event_handler(event_code).InvokeIfNotEmpty(event);
+      return;
+    }
     // Root Inflamation is a special case, since it aborts here
     if (event_code == EventCode::VENDOR_SPECIFIC) {
       auto view = VendorSpecificEventView::Create(event);
@@ -401,13 +546,13 @@ struct HciLayer::impl {
         on_le_meta_event(event);
         break;
       default:
-        if (event_handlers_.find(event_code) == event_handlers_.end()) {
+        if (event_handler(event_code).IsEmpty()) {
           LOG_WARN(
               "Unhandled event of type 0x%02hhx (%s)",
               event_code,
               EventCodeText(event_code).c_str());
         } else {
-          event_handlers_[event_code].Invoke(event);
+          event_handler(event_code).Invoke(event);
         }
     }
   }
@@ -416,11 +561,12 @@ struct HciLayer::impl {
     LeMetaEventView meta_event_view = LeMetaEventView::Create(event);
     ASSERT(meta_event_view.IsValid());
     SubeventCode subevent_code = meta_event_view.GetSubeventCode();
-    if (subevent_handlers_.find(subevent_code) == subevent_handlers_.end()) {
+    auto& handler = subevent_handler(subevent_code);
+    if (handler.IsEmpty()) {
       LOG_WARN("Unhandled le subevent of type 0x%02hhx (%s)", subevent_code, SubeventCodeText(subevent_code).c_str());
       return;
     }
-    subevent_handlers_[subevent_code].Invoke(meta_event_view);
+    handler.Invoke(meta_event_view);
   }
 
   hal::HciHal* hal_;
@@ -428,14 +574,26 @@ struct HciLayer::impl {
 
   // Command Handling
   std::list<CommandQueueEntry> command_queue_;
+  // Commands sent to the controller and waiting for their response, oldest first
+  std::list<CommandQueueEntry> outstanding_commands_;
 
-  std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
-  std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> subevent_handlers_;
-  OpCode waiting_command_{OpCode::NONE};
+  // Indexed by the one byte event and subevent codes, empty when not registered
+  std::array<ContextualCallback<void(EventView)>, 256> event_handlers_;
+  std::array<ContextualCallback<void(LeMetaEventView)>, 256> subevent_handlers_;
   uint8_t command_credits_{1};  // Send reset first
+  const bool command_pipelining_enabled_;
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
 
+  // Guards the statistics below, which are read by dumpsys
+  mutable std::mutex dumpsys_mutex_;
+  std::map<OpCode, CommandLatencyStats> command_latency_stats_;
+  size_t max_outstanding_commands_{0};
+
+  // Set when the HCI metrics are aggregated rather than logged for every packet
+  std::unique_ptr<HciMetricsAggregator> metrics_aggregator_;
+  std::unique_ptr<os::RepeatingAlarm> metrics_flush_alarm_;
+
   // Acl packets
   BidiQueue<AclView, AclBuilder> acl_queue_{3 /* TODO: Set queue depth */};
   os::EnqueueBuffer<AclView> incoming_acl_buffer_{acl_queue_.GetDownEnd()};
@@ -449,6 +607,86 @@ struct HciLayer::impl {
   os::EnqueueBuffer<IsoView> incoming_iso_buffer_{iso_queue_.GetDownEnd()};
 };
 
+void HciLayer::impl::Dump(
+    std::promise<flatbuffers::Offset<HciLayerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const {
+  const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+  auto title = fb_builder->CreateString("----- Hci Layer Dumpsys -----");
+
+  std::vector<flatbuffers::Offset<CommandLatencyData>> command_latencies;
+  for (const auto& [op_code, stats] : command_latency_stats_) {
+    auto op_code_text = fb_builder->CreateString(OpCodeText(op_code));
+    CommandLatencyDataBuilder latency_builder(*fb_builder);
+    latency_builder.add_op_code(op_code_text);
+    latency_builder.add_count(stats.count);
+    latency_builder.add_average_latency_us(stats.count == 0 ? 0 : stats.total_us / stats.count);
+    latency_builder.add_max_latency_us(stats.max_us);
+    command_latencies.push_back(latency_builder.Finish());
+  }
+  auto command_latencies_vector = fb_builder->CreateVector(command_latencies);
+
+  std::vector<flatbuffers::Offset<HciPacketCountData>> event_counts;
+  std::vector<flatbuffers::Offset<HciPacketCountData>> command_counts;
+  if (metrics_aggregator_ != nullptr) {
+    auto add_count = [fb_builder](
+                         std::vector<flatbuffers::Offset<HciPacketCountData>>* counts,
+                         const std::string& code,
+                         const HciMetricsAggregator::Stats& stats,
+                         const std::vector<int64_t>& latency_histogram) {
+      uint64_t count = stats.count.load(std::memory_order_relaxed);
+      if (count == 0) {
+        return;
+      }
+      auto code_text = fb_builder->CreateString(code);
+      auto histogram = fb_builder->CreateVector(latency_histogram);
+      HciPacketCountDataBuilder count_builder(*fb_builder);
+      count_builder.add_code(code_text);
+      count_builder.add_count(count);
+      count_builder.add_sampled(stats.sampled.load(std::memory_order_relaxed));
+      count_builder.add_latency_histogram_us(histogram);
+      counts->push_back(count_builder.Finish());
+    };
+    for (int code = 0; code < 256; code++) {
+      auto event_code = static_cast<EventCode>(code);
+      add_count(&event_counts, EventCodeText(event_code), metrics_aggregator_->GetEventStats(event_code), {});
+      auto subevent_code = static_cast<SubeventCode>(code);
+      add_count(
+          &event_counts, SubeventCodeText(subevent_code), metrics_aggregator_->GetSubeventStats(subevent_code), {});
+    }
+    auto add_command_count = [&](const std::string& op_code_text, const HciMetricsAggregator::CommandStats& stats) {
+      std::vector<int64_t> latency_histogram;
+      for (const auto& bucket : stats.latency_buckets) {
+        latency_histogram.push_back(bucket.load(std::memory_order_relaxed));
+      }
+      add_count(&command_counts, op_code_text, stats, latency_histogram);
+    };
+    for (const auto& stats : metrics_aggregator_->GetCommandStats()) {
+      auto op_code = static_cast<OpCode>(stats.op_code.load(std::memory_order_acquire));
+      if (op_code != OpCode::NONE) {
+        add_command_count(OpCodeText(op_code), stats);
+      }
+    }
+    add_command_count("other", metrics_aggregator_->GetOverflowCommandStats());
+  }
+  auto event_counts_vector = fb_builder->CreateVector(event_counts);
+  auto command_counts_vector = fb_builder->CreateVector(command_counts);
+
+  // The queues are only modified on the HCI handler, so their sizes are a best effort snapshot
+  HciLayerDataBuilder builder(*fb_builder);
+  builder.add_title(title);
+  builder.add_command_pipelining_enabled(command_pipelining_enabled_);
+  builder.add_command_credits(command_credits_);
+  builder.add_queued_commands(command_queue_.size());
+  builder.add_outstanding_commands(outstanding_commands_.size());
+  builder.add_max_outstanding_commands(max_outstanding_commands_);
+  builder.add_command_latencies(command_latencies_vector);
+  builder.add_metrics_aggregation_enabled(metrics_aggregator_ != nullptr);
+  builder.add_event_counts(event_counts_vector);
+  builder.add_command_counts(command_counts_vector);
+
+  flatbuffers::Offset<HciLayerData> dumpsys_data = builder.Finish();
+  promise.set_value(dumpsys_data);
+}
+
 // All functions here are running on the HAL thread
 struct HciLayer::hal_callbacks : public hal::HciHalCallbacks {
   hal_callbacks(HciLayer& module) : module_(module) {}
@@ -514,6 +752,10 @@ void HciLayer::EnqueueCommand(
       impl_, &impl::enqueue_command<CommandStatusView>, std::move(command), std::move(on_status));
 }
 
+void HciLayer::SendHostNumCompletedPackets(unique_ptr<HostNumCompletedPacketsBuilder> command) {
+  CallOn(impl_, &impl::send_host_num_completed_packets, std::move(command));
+}
+
 void HciLayer::RegisterEventHandler(EventCode event, ContextualCallback<void(EventView)> handler) {
   CallOn(impl_, &impl::register_event, event, handler);
 }
@@ -696,6 +938,20 @@ void HciLayer::Start() {
   EnqueueCommand(ResetBuilder::Create(), handler->BindOnce(&fail_if_reset_complete_not_success));
 }
 
+DumpsysDataFinisher HciLayer::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  ASSERT(fb_builder != nullptr);
+
+  std::promise<flatbuffers::Offset<HciLayerData>> promise;
+  auto future = promise.get_future();
+  impl_->Dump(std::move(promise), fb_builder);
+
+  auto dumpsys_data = future.get();
+
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_hci_layer_dumpsys_data(dumpsys_data);
+  };
+}
+
 void HciLayer::Stop() {
   auto hal = GetDependency<hal::HciHal>();
   hal->unregisterIncomingPacketCallback();
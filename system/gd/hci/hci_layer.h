@@ -61,6 +61,10 @@ class HciLayer : public Module, public CommandInterface<CommandBuilder> {
       std::unique_ptr<CommandBuilder> command,
       common::ContextualOnceCallback<void(CommandStatusView)> on_status) override;
 
+  // Sent right away, outside of the command queue: the controller takes it at any time, even without command credits,
+  // and only answers it when it fails
+  virtual void SendHostNumCompletedPackets(std::unique_ptr<HostNumCompletedPacketsBuilder> command);
+
   virtual common::BidiQueueEnd<AclBuilder, AclView>* GetAclQueueEnd();
 
   virtual common::BidiQueueEnd<ScoBuilder, ScoView>* GetScoQueueEnd();
@@ -110,6 +114,15 @@ class HciLayer : public Module, public CommandInterface<CommandBuilder> {
 
   static constexpr std::chrono::milliseconds kHciTimeoutMs = std::chrono::milliseconds(2000);
   static constexpr std::chrono::milliseconds kHciTimeoutRestartMs = std::chrono::milliseconds(5000);
+  // Length of the sampling intervals of the aggregated HCI metrics
+  static constexpr std::chrono::seconds kMetricsFlushInterval = std::chrono::seconds(10);
+
+  // When true, up to Num_HCI_Command_Packets commands may be waiting for their response at the same time, instead of
+  // one. Commands are still sent in order, and a command is held back while another one with the same op code, a
+  // reset or a vendor specific command is outstanding.
+  static constexpr char kPropertyCommandPipeliningEnabled[] = "bluetooth.hci.command_pipelining.enabled";
+  // Aggregate the HCI metrics and only log the per packet ones for a sample of the packets
+  static constexpr char kPropertyMetricsAggregationEnabled[] = "bluetooth.hci.metrics_aggregation.enabled";
 
   static const ModuleFactory Factory;
 
@@ -121,6 +134,8 @@ class HciLayer : public Module, public CommandInterface<CommandBuilder> {
 
   void Stop() override;
 
+  DumpsysDataFinisher GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const override;  // Module
+
   virtual void Disconnect(uint16_t handle, ErrorCode reason);
   virtual void ReadRemoteVersion(
       hci::ErrorCode hci_status,
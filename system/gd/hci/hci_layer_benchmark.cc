@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "hal/hci_hal_fake.h"
+#include "hci/hci_layer.h"
+#include "module.h"
+#include "os/handler.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+
+// Latency from the HAL handing an HCI event to the stack until the callback registered by a module runs on its
+// handler. The event is not handled by HciLayer itself, so this is the plain HAL -> HCI -> module dispatch.
+class BM_HciLayer : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    hal_ = new hal::TestHciHal();
+    registry_ = std::make_unique<TestModuleRegistry>();
+    registry_->InjectTestModule(&hal::HciHal::Factory, hal_);
+    registry_->Start<HciLayer>(&registry_->GetTestThread());
+    hci_ = static_cast<HciLayer*>(registry_->GetModuleUnderTest(&HciLayer::Factory));
+    handler_ = registry_->GetTestModuleHandler(&HciLayer::Factory);
+
+    // Let the HCI layer complete its start up reset so no command timeout is pending
+    ASSERT(hal_->GetSentCommand().has_value());
+    hal_->InjectEvent(ResetCompleteBuilder::Create(1, ErrorCode::SUCCESS));
+    ASSERT(registry_->SynchronizeModuleHandler(&HciLayer::Factory, std::chrono::seconds(1)));
+
+    hci_->RegisterEventHandler(
+        EventCode::LINK_SUPERVISION_TIMEOUT_CHANGED, handler_->BindOn(this, &BM_HciLayer::on_event));
+    latencies_us_.clear();
+  }
+
+  void TearDown(State& st) override {
+    hci_->UnregisterEventHandler(EventCode::LINK_SUPERVISION_TIMEOUT_CHANGED);
+    registry_->SynchronizeModuleHandler(&HciLayer::Factory, std::chrono::milliseconds(20));
+    registry_->StopAll();
+    registry_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void on_event(EventView /* view */) {
+    latencies_us_.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - injected_at_).count());
+    promise_->set_value();
+  }
+
+  void ReportLatency(State& state) {
+    std::sort(latencies_us_.begin(), latencies_us_.end());
+    state.counters["p50_us"] = latencies_us_[latencies_us_.size() / 2];
+    state.counters["p99_us"] = latencies_us_[latencies_us_.size() * 99 / 100];
+    state.counters["max_us"] = latencies_us_.back();
+  }
+
+  hal::TestHciHal* hal_ = nullptr;
+  HciLayer* hci_ = nullptr;
+  os::Handler* handler_ = nullptr;
+  std::unique_ptr<TestModuleRegistry> registry_;
+  std::unique_ptr<std::promise<void>> promise_;
+  std::chrono::steady_clock::time_point injected_at_;
+  std::vector<int64_t> latencies_us_;
+};
+
+BENCHMARK_DEFINE_F(BM_HciLayer, event_to_module_callback_latency)(State& state) {
+  for (auto _ : state) {
+    promise_ = std::make_unique<std::promise<void>>();
+    auto future = promise_->get_future();
+    injected_at_ = std::chrono::steady_clock::now();
+    hal_->InjectEvent(LinkSupervisionTimeoutChangedBuilder::Create(0x0001, 0x7d00));
+    future.wait();
+  }
+  ReportLatency(state);
+};
+
+// Fixed iteration counts keep the p50/p99 counters comparable from one build to the next
+BENCHMARK_REGISTER_F(BM_HciLayer, event_to_module_callback_latency)->Iterations(10000)->UseRealTime();
+
+}  // namespace hci
+}  // namespace bluetooth
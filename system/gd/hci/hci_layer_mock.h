@@ -43,6 +43,7 @@ class MockHciLayer : public HciLayer {
       EnqueueCommand,
       (std::unique_ptr<CommandBuilder>, common::ContextualOnceCallback<void(CommandStatusView)>),
       (override));
+  MOCK_METHOD(void, SendHostNumCompletedPackets, (std::unique_ptr<HostNumCompletedPacketsBuilder>), (override));
   MOCK_METHOD((common::BidiQueueEnd<AclBuilder, AclView>*), GetAclQueueEnd, (), (override));
   MOCK_METHOD((common::BidiQueueEnd<ScoBuilder, ScoView>*), GetScoQueueEnd, (), (override));
   MOCK_METHOD((common::BidiQueueEnd<IsoBuilder, IsoView>*), GetIsoQueueEnd, (), (override));
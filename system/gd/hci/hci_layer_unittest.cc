@@ -31,6 +31,7 @@
 #include "module.h"
 #include "os/fake_timer/fake_timerfd.h"
 #include "os/handler.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -120,6 +121,30 @@ class HciLayerTest : public ::testing::Test {
 
 class HciLayerDeathTest : public HciLayerTest {};
 
+class HciLayerPipeliningTest : public HciLayerTest {
+ protected:
+  void SetUp() override {
+    os::SetSystemProperty(HciLayer::kPropertyCommandPipeliningEnabled, "true");
+    HciLayerTest::SetUp();
+  }
+
+  void TearDown() override {
+    HciLayerTest::TearDown();
+    os::SetSystemProperty(HciLayer::kPropertyCommandPipeliningEnabled, "false");
+  }
+
+  void ExpectSentCommand(OpCode op_code) {
+    auto sent_command = hal_->GetSentCommand();
+    ASSERT_TRUE(sent_command.has_value());
+    ASSERT_EQ(sent_command->GetOpCode(), op_code);
+  }
+
+  void ExpectNoSentCommand() {
+    sync_handler();
+    ASSERT_FALSE(hal_->GetSentCommand(std::chrono::milliseconds(20)).has_value());
+  }
+};
+
 TEST_F(HciLayerTest, setup_teardown) {}
 
 TEST_F(HciLayerTest, reset_command_sent_on_start) {
@@ -479,5 +504,68 @@ TEST_F(HciLayerTest, command_status_callback_is_invoked_with_failure_status) {
   sync_handler();
 }
 
+TEST_F(HciLayerPipeliningTest, commands_are_pipelined_up_to_command_credits) {
+  FailIfResetNotSent();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(2, ErrorCode::SUCCESS));
+
+  hci_->EnqueueCommand(
+      ReadClockOffsetBuilder::Create(0x001), hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  hci_->EnqueueCommand(
+      ReadRemoteVersionInformationBuilder::Create(0x001),
+      hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  hci_->EnqueueCommand(
+      ReadRemoteSupportedFeaturesBuilder::Create(0x001),
+      hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+  ExpectSentCommand(OpCode::READ_REMOTE_VERSION_INFORMATION);
+  ExpectNoSentCommand();
+
+  // Responses may come back out of order
+  hal_->InjectEvent(ReadRemoteVersionInformationStatusBuilder::Create(ErrorCode::SUCCESS, 1));
+  ExpectSentCommand(OpCode::READ_REMOTE_SUPPORTED_FEATURES);
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 1));
+  hal_->InjectEvent(ReadRemoteSupportedFeaturesStatusBuilder::Create(ErrorCode::SUCCESS, 1));
+  sync_handler();
+}
+
+TEST_F(HciLayerPipeliningTest, commands_with_the_same_op_code_are_not_pipelined) {
+  FailIfResetNotSent();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+
+  hci_->EnqueueCommand(
+      ReadClockOffsetBuilder::Create(0x001), hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  hci_->EnqueueCommand(
+      ReadClockOffsetBuilder::Create(0x002), hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  hci_->EnqueueCommand(
+      ReadRemoteVersionInformationBuilder::Create(0x001),
+      hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+  // Commands are sent in order, so the held back command also holds back the ones after it
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 3));
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+  ExpectSentCommand(OpCode::READ_REMOTE_VERSION_INFORMATION);
+  hal_->InjectEvent(ReadRemoteVersionInformationStatusBuilder::Create(ErrorCode::SUCCESS, 3));
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 3));
+  sync_handler();
+}
+
+TEST_F(HciLayerPipeliningTest, reset_is_sent_alone) {
+  FailIfResetNotSent();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+
+  hci_->EnqueueCommand(
+      ReadClockOffsetBuilder::Create(0x001), hci_handler_->BindOnce([](CommandStatusView /* view */) {}));
+  hci_->EnqueueCommand(ResetBuilder::Create(), hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 3));
+  ExpectSentCommand(OpCode::RESET);
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+  sync_handler();
+}
+
 }  // namespace hci
 }  // namespace bluetooth
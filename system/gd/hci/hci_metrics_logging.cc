@@ -17,6 +17,8 @@
 
 #include <frameworks/proto_logging/stats/enums/bluetooth/hci/enums.pb.h>
 
+#include <algorithm>
+
 #include "common/audit_log.h"
 #include "common/strings.h"
 #include "os/metrics.h"
@@ -64,6 +66,105 @@ void log_hci_event(
   }
 }
 
+namespace {
+// Only the HCI handler writes the counters, so a relaxed load and store is enough to increment them
+void increment(std::atomic<uint64_t>* counter) {
+  counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void count_packet(HciMetricsAggregator::Stats* stats) {
+  increment(&stats->count);
+  stats->interval_count++;
+}
+}  // namespace
+
+bool HciMetricsAggregator::Sample(Stats* stats) {
+  count_packet(stats);
+  if (stats->interval_count > kSampleThreshold && stats->interval_count % kSampleRate != 0) {
+    return false;
+  }
+  increment(&stats->sampled);
+  return true;
+}
+
+HciMetricsAggregator::CommandStats* HciMetricsAggregator::GetCommand(OpCode op_code) {
+  const uint16_t key = static_cast<uint16_t>(op_code);
+  size_t index = (key * 2654435761u) % kMaxOpCodes;
+  for (size_t probe = 0; probe < kMaxOpCodes; probe++) {
+    CommandStats& entry = commands_[index];
+    uint16_t entry_key = entry.op_code.load(std::memory_order_relaxed);
+    if (entry_key == key) {
+      return &entry;
+    }
+    if (entry_key == static_cast<uint16_t>(OpCode::NONE)) {
+      // Publish the op code after the entry is initialized, for the readers on other threads
+      entry.op_code.store(key, std::memory_order_release);
+      return &entry;
+    }
+    index = (index + 1) % kMaxOpCodes;
+  }
+  return &overflow_command_;
+}
+
+void HciMetricsAggregator::LogHciEvent(
+    std::unique_ptr<CommandView>& command_view, EventView event_view, storage::StorageModule* storage_module) {
+  ASSERT(event_view.IsValid());
+  EventCode event_code = event_view.GetEventCode();
+  Stats* stats = &events_[static_cast<uint8_t>(event_code)];
+  bool sampled;
+  switch (event_code) {
+    case EventCode::COMMAND_COMPLETE:
+    case EventCode::COMMAND_STATUS: {
+      OpCode op_code;
+      if (event_code == EventCode::COMMAND_COMPLETE) {
+        CommandCompleteView complete_view = CommandCompleteView::Create(event_view);
+        ASSERT(complete_view.IsValid());
+        op_code = complete_view.GetCommandOpCode();
+      } else {
+        CommandStatusView status_view = CommandStatusView::Create(event_view);
+        ASSERT(status_view.IsValid());
+        op_code = status_view.GetCommandOpCode();
+      }
+      count_packet(stats);
+      if (op_code == OpCode::NONE) {
+        return;
+      }
+      sampled = Sample(GetCommand(op_code));
+      break;
+    }
+    case EventCode::LE_META_EVENT: {
+      LeMetaEventView le_meta_event_view = LeMetaEventView::Create(event_view);
+      ASSERT(le_meta_event_view.IsValid());
+      count_packet(stats);
+      sampled = Sample(&subevents_[static_cast<uint8_t>(le_meta_event_view.GetSubeventCode())]);
+      break;
+    }
+    default:
+      sampled = Sample(stats);
+  }
+  if (sampled) {
+    log_hci_event(command_view, event_view, storage_module);
+  }
+}
+
+void HciMetricsAggregator::RecordCommandLatency(OpCode op_code, uint64_t latency_us) {
+  const auto bound = std::upper_bound(kLatencyBoundsUs.begin(), kLatencyBoundsUs.end(), latency_us);
+  increment(&GetCommand(op_code)->latency_buckets[bound - kLatencyBoundsUs.begin()]);
+}
+
+void HciMetricsAggregator::Flush() {
+  for (auto& stats : events_) {
+    stats.interval_count = 0;
+  }
+  for (auto& stats : subevents_) {
+    stats.interval_count = 0;
+  }
+  for (auto& stats : commands_) {
+    stats.interval_count = 0;
+  }
+  overflow_command_.interval_count = 0;
+}
+
 void log_link_layer_connection_command(std::unique_ptr<CommandView>& command_view) {
   // get op_code
   ASSERT(command_view->IsValid());
@@ -17,6 +17,10 @@
 #pragma once
 #include <frameworks/proto_logging/stats/enums/bluetooth/enums.pb.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+
 #include "hci/hci_packets.h"
 #include "storage/storage_module.h"
 
@@ -34,6 +38,64 @@ void log_classic_pairing_command_status(std::unique_ptr<CommandView>& command_vi
 void log_classic_pairing_command_complete(EventView event, std::unique_ptr<CommandView>& command_view);
 void log_classic_pairing_other_hci_event(EventView packet);
 
+// Counts the HCI commands and events in preallocated tables, indexed by event code, LE subevent code and op code, and
+// only extracts the per packet metrics above from a sample of them: every packet of a code seen up to
+// kSampleThreshold times within a flush interval, then one in kSampleRate. That keeps the metrics of the rare
+// connection and pairing events while the cost of advertising reports and other bursts stays at a few increments.
+// Updated from the HCI handler only; the counters may be read concurrently, e.g. by dumpsys.
+class HciMetricsAggregator {
+ public:
+  static constexpr uint32_t kSampleThreshold = 32;
+  static constexpr uint32_t kSampleRate = 64;
+  // Exclusive upper bounds of the command latency buckets; the last bucket holds the latencies above them
+  static constexpr std::array<uint32_t, 7> kLatencyBoundsUs = {500, 1000, 2000, 5000, 10000, 50000, 200000};
+  static constexpr size_t kNumLatencyBuckets = kLatencyBoundsUs.size() + 1;
+  // Distinct op codes tracked; the commands of the op codes beyond are only counted in the overflow entry
+  static constexpr size_t kMaxOpCodes = 256;
+
+  struct Stats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sampled{0};
+    // Packets since the last flush
+    uint32_t interval_count{0};
+  };
+
+  struct CommandStats : Stats {
+    std::atomic<uint16_t> op_code{0};
+    std::atomic<uint64_t> latency_buckets[kNumLatencyBuckets]{};
+  };
+
+  // Counts |event_view| and logs its per packet metrics when it is sampled
+  void LogHciEvent(
+      std::unique_ptr<CommandView>& command_view, EventView event_view, storage::StorageModule* storage_module);
+  void RecordCommandLatency(OpCode op_code, uint64_t latency_us);
+  // Starts a new sampling interval
+  void Flush();
+
+  const Stats& GetEventStats(EventCode event_code) const {
+    return events_[static_cast<uint8_t>(event_code)];
+  }
+  const Stats& GetSubeventStats(SubeventCode subevent_code) const {
+    return subevents_[static_cast<uint8_t>(subevent_code)];
+  }
+  // Entries of the op codes seen so far, their op_code being OpCode::NONE when unused
+  const std::array<CommandStats, kMaxOpCodes>& GetCommandStats() const {
+    return commands_;
+  }
+  const CommandStats& GetOverflowCommandStats() const {
+    return overflow_command_;
+  }
+
+ private:
+  static bool Sample(Stats* stats);
+  CommandStats* GetCommand(OpCode op_code);
+
+  std::array<Stats, 256> events_;
+  std::array<Stats, 256> subevents_;
+  std::array<CommandStats, kMaxOpCodes> commands_;
+  CommandStats overflow_command_;
+};
+
 void log_remote_device_information(
     const Address& address,
     android::bluetooth::AddressTypeEnum address_type,
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/hci_metrics_logging.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+EventView CreateEvent(std::vector<uint8_t> bytes) {
+  auto packet = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::move(bytes)));
+  return EventView::Create(packet);
+}
+
+// Flush Occurred, handle 0x0001
+EventView CreateFlushOccurredEvent() {
+  return CreateEvent({static_cast<uint8_t>(EventCode::FLUSH_OCCURRED), 0x02, 0x01, 0x00});
+}
+
+class HciMetricsAggregatorTest : public ::testing::Test {
+ protected:
+  void LogEvents(EventView event, size_t count) {
+    std::unique_ptr<CommandView> no_command{nullptr};
+    for (size_t i = 0; i < count; i++) {
+      aggregator_.LogHciEvent(no_command, event, nullptr);
+    }
+  }
+
+  HciMetricsAggregator aggregator_;
+};
+
+TEST_F(HciMetricsAggregatorTest, samples_every_event_up_to_threshold) {
+  LogEvents(CreateFlushOccurredEvent(), HciMetricsAggregator::kSampleThreshold);
+
+  const auto& stats = aggregator_.GetEventStats(EventCode::FLUSH_OCCURRED);
+  EXPECT_EQ(HciMetricsAggregator::kSampleThreshold, stats.count.load());
+  EXPECT_EQ(HciMetricsAggregator::kSampleThreshold, stats.sampled.load());
+}
+
+TEST_F(HciMetricsAggregatorTest, samples_high_frequency_events) {
+  constexpr size_t kCount = HciMetricsAggregator::kSampleRate * 4;
+  LogEvents(CreateFlushOccurredEvent(), kCount);
+
+  const auto& stats = aggregator_.GetEventStats(EventCode::FLUSH_OCCURRED);
+  EXPECT_EQ(kCount, stats.count.load());
+  EXPECT_EQ(HciMetricsAggregator::kSampleThreshold + 4, stats.sampled.load());
+}
+
+TEST_F(HciMetricsAggregatorTest, flush_starts_new_interval) {
+  constexpr size_t kCount = HciMetricsAggregator::kSampleThreshold + 1;
+  LogEvents(CreateFlushOccurredEvent(), kCount);
+  aggregator_.Flush();
+  LogEvents(CreateFlushOccurredEvent(), kCount);
+
+  const auto& stats = aggregator_.GetEventStats(EventCode::FLUSH_OCCURRED);
+  EXPECT_EQ(2 * kCount, stats.count.load());
+  EXPECT_EQ(2 * HciMetricsAggregator::kSampleThreshold, stats.sampled.load());
+}
+
+TEST_F(HciMetricsAggregatorTest, counts_le_subevents) {
+  // LE Advertising Report with no report
+  LogEvents(
+      CreateEvent(
+          {static_cast<uint8_t>(EventCode::LE_META_EVENT), 0x02, static_cast<uint8_t>(SubeventCode::ADVERTISING_REPORT),
+           0x00}),
+      3);
+
+  EXPECT_EQ(3u, aggregator_.GetEventStats(EventCode::LE_META_EVENT).count.load());
+  EXPECT_EQ(0u, aggregator_.GetEventStats(EventCode::LE_META_EVENT).sampled.load());
+  EXPECT_EQ(3u, aggregator_.GetSubeventStats(SubeventCode::ADVERTISING_REPORT).count.load());
+}
+
+TEST_F(HciMetricsAggregatorTest, command_complete_without_op_code_is_not_sampled) {
+  // Command Complete for flow control, 1 command credit
+  LogEvents(CreateEvent({static_cast<uint8_t>(EventCode::COMMAND_COMPLETE), 0x03, 0x01, 0x00, 0x00}), 2);
+
+  EXPECT_EQ(2u, aggregator_.GetEventStats(EventCode::COMMAND_COMPLETE).count.load());
+  for (const auto& stats : aggregator_.GetCommandStats()) {
+    EXPECT_EQ(OpCode::NONE, static_cast<OpCode>(stats.op_code.load()));
+  }
+}
+
+TEST_F(HciMetricsAggregatorTest, command_latency_histogram) {
+  aggregator_.RecordCommandLatency(OpCode::RESET, 100);
+  aggregator_.RecordCommandLatency(OpCode::RESET, 500);
+  aggregator_.RecordCommandLatency(OpCode::RESET, 1000000);
+  aggregator_.RecordCommandLatency(OpCode::READ_BD_ADDR, 3000);
+
+  const HciMetricsAggregator::CommandStats* reset = nullptr;
+  const HciMetricsAggregator::CommandStats* read_bd_addr = nullptr;
+  for (const auto& stats : aggregator_.GetCommandStats()) {
+    auto op_code = static_cast<OpCode>(stats.op_code.load());
+    if (op_code == OpCode::RESET) reset = &stats;
+    if (op_code == OpCode::READ_BD_ADDR) read_bd_addr = &stats;
+  }
+  ASSERT_NE(nullptr, reset);
+  ASSERT_NE(nullptr, read_bd_addr);
+  EXPECT_EQ(1u, reset->latency_buckets[0].load());
+  EXPECT_EQ(1u, reset->latency_buckets[1].load());
+  EXPECT_EQ(1u, reset->latency_buckets[HciMetricsAggregator::kNumLatencyBuckets - 1].load());
+  EXPECT_EQ(1u, read_bd_addr->latency_buckets[3].load());
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
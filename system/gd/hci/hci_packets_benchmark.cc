@@ -0,0 +1,320 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_allocations.h"
+#include "hci/hci_packets.h"
+#include "l2cap/l2cap_packets.h"
+#include "os/log.h"
+#include "packet/raw_builder.h"
+#include "packet/scatter_gather_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+using packet::kLittleEndian;
+using packet::PacketView;
+
+// Packets are laid out like the ones found in btsnoop logs of a phone
+// scanning, talking to an LE peripheral and streaming LE audio. The HCI packet
+// type byte of the log is not part of the bytes handed over by the HAL.
+
+// LE Extended Advertising Report with one legacy ADV_IND: flags, Apple
+// manufacturer data and a complete local name
+const std::vector<uint8_t> kLeExtendedAdvertisingReport = {
+    0x3e, 0x34, 0x0d, 0x01,
+    // event type, address type, address
+    0x13, 0x00, 0x01, 0x6b, 0x2f, 0x9c, 0x11, 0x8a, 0x5e,
+    // primary phy, secondary phy, sid, tx power, rssi, periodic advertising interval
+    0x01, 0x00, 0xff, 0x7f, 0xc3, 0x00, 0x00,
+    // direct address type and address
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // advertising data
+    0x1a, 0x02, 0x01, 0x1a, 0x0b, 0xff, 0x4c, 0x00, 0x10, 0x07, 0x3b, 0x1f, 0x8e, 0x2a, 0x6c, 0x55, 0x0a, 0x09, 'P',
+    'i', 'x', 'e', 'l', ' ', 'B', 'u', 'd'};
+
+// Number Of Completed Packets for an ACL and an LE link
+const std::vector<uint8_t> kNumberOfCompletedPackets = {
+    0x13, 0x09, 0x02, 0x40, 0x00, 0x01, 0x00, 0x41, 0x00, 0x03, 0x00};
+
+// ACL carrying an LE Flow Control Credit on the LE signalling channel
+const std::vector<uint8_t> kAclLeFlowControlCredit = {
+    0x40, 0x20, 0x0c, 0x00, 0x08, 0x00, 0x05, 0x00, 0x16, 0x01, 0x04, 0x00, 0x40, 0x00, 0x05, 0x00};
+
+constexpr uint16_t kAclHandle = 0x0040;
+constexpr uint16_t kLeDynamicCid = 0x0040;
+constexpr uint16_t kLeSignallingCid = 0x0005;
+constexpr size_t kLeSduSize = 240;
+
+// ACL carrying a whole SDU in the first K-frame of an LE credit based channel
+std::vector<uint8_t> MakeAclLeInformationFrame() {
+  const uint16_t l2cap_size = 2 + kLeSduSize;
+  const uint16_t acl_size = 4 + l2cap_size;
+  std::vector<uint8_t> bytes = {
+      0x40,
+      0x20,
+      static_cast<uint8_t>(acl_size),
+      static_cast<uint8_t>(acl_size >> 8),
+      static_cast<uint8_t>(l2cap_size),
+      static_cast<uint8_t>(l2cap_size >> 8),
+      static_cast<uint8_t>(kLeDynamicCid),
+      static_cast<uint8_t>(kLeDynamicCid >> 8),
+      static_cast<uint8_t>(kLeSduSize),
+      static_cast<uint8_t>(kLeSduSize >> 8)};
+  for (size_t i = 0; i < kLeSduSize; i++) {
+    bytes.push_back(static_cast<uint8_t>(i));
+  }
+  return bytes;
+}
+
+constexpr uint16_t kIsoHandle = 0x0060;
+// One 10 ms LC3 frame at 96 kbps
+constexpr size_t kIsoSduSize = 120;
+
+// ISO data without time stamp carrying a complete SDU
+std::vector<uint8_t> MakeIsoData() {
+  const uint16_t iso_size = 4 + kIsoSduSize;
+  std::vector<uint8_t> bytes = {
+      0x60,
+      0x20,
+      static_cast<uint8_t>(iso_size),
+      static_cast<uint8_t>(iso_size >> 8),
+      // packet sequence number, SDU length and packet status
+      0x2a,
+      0x00,
+      static_cast<uint8_t>(kIsoSduSize),
+      static_cast<uint8_t>(kIsoSduSize >> 8)};
+  for (size_t i = 0; i < kIsoSduSize; i++) {
+    bytes.push_back(static_cast<uint8_t>(i));
+  }
+  return bytes;
+}
+
+PacketView<kLittleEndian> MakePacketView(const std::vector<uint8_t>& bytes) {
+  return PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(bytes));
+}
+
+}  // namespace
+
+// Parsing, the way LeScanningManager reads the reports
+void BM_ParseLeExtendedAdvertisingReportRaw(State& state) {
+  auto packet = MakePacketView(kLeExtendedAdvertisingReport);
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto view = LeExtendedAdvertisingReportRawView::Create(LeMetaEventView::Create(EventView::Create(packet)));
+    ASSERT(view.IsValid());
+    auto responses = view.GetResponses();
+    benchmark::DoNotOptimize(responses.data());
+  }
+}
+
+// Parsing, including the split of the advertising data in GAP data structures
+void BM_ParseLeExtendedAdvertisingReport(State& state) {
+  auto packet = MakePacketView(kLeExtendedAdvertisingReport);
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto view = LeExtendedAdvertisingReportView::Create(LeMetaEventView::Create(EventView::Create(packet)));
+    ASSERT(view.IsValid());
+    auto responses = view.GetResponses();
+    benchmark::DoNotOptimize(responses.data());
+  }
+}
+
+void BM_BuildLeExtendedAdvertisingReportRaw(State& state) {
+  auto view = LeExtendedAdvertisingReportRawView::Create(
+      LeMetaEventView::Create(EventView::Create(MakePacketView(kLeExtendedAdvertisingReport))));
+  ASSERT(view.IsValid());
+  auto responses = view.GetResponses();
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    LeExtendedAdvertisingReportRawBuilder::Create(responses)->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+// Parsing, the way the Controller returns ACL credits
+void BM_ParseNumberOfCompletedPackets(State& state) {
+  auto packet = MakePacketView(kNumberOfCompletedPackets);
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto view = NumberOfCompletedPacketsView::Create(EventView::Create(packet));
+    ASSERT(view.IsValid());
+    uint32_t credits = 0;
+    for (const auto& completed_packets : view.GetCompletedPackets()) {
+      credits += completed_packets.host_num_of_completed_packets_;
+    }
+    benchmark::DoNotOptimize(credits);
+  }
+}
+
+void BM_BuildNumberOfCompletedPackets(State& state) {
+  std::vector<CompletedPackets> completed_packets(2);
+  completed_packets[0].connection_handle_ = 0x0040;
+  completed_packets[0].host_num_of_completed_packets_ = 1;
+  completed_packets[1].connection_handle_ = 0x0041;
+  completed_packets[1].host_num_of_completed_packets_ = 3;
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    NumberOfCompletedPacketsBuilder::Create(completed_packets)->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+// Parsing, the way the LE signalling manager reads a credit from an ACL packet
+void BM_ParseAclLeFlowControlCredit(State& state) {
+  auto packet = MakePacketView(kAclLeFlowControlCredit);
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto acl = AclView::Create(packet);
+    ASSERT(acl.IsValid());
+    auto basic_frame = l2cap::BasicFrameView::Create(acl.GetPayload());
+    ASSERT(basic_frame.IsValid());
+    auto credit = l2cap::LeFlowControlCreditView::Create(l2cap::LeControlView::Create(basic_frame.GetPayload()));
+    ASSERT(credit.IsValid());
+    benchmark::DoNotOptimize(credit.GetCredits());
+  }
+}
+
+void BM_BuildAclLeFlowControlCredit(State& state) {
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    AclBuilder::Create(
+        kAclHandle,
+        PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE,
+        BroadcastFlag::POINT_TO_POINT,
+        l2cap::BasicFrameBuilder::Create(
+            kLeSignallingCid, l2cap::LeFlowControlCreditBuilder::Create(0x01, kLeDynamicCid, 5)))
+        ->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+// Parsing, the way the LE credit based data controller reads an SDU
+void BM_ParseAclLeInformationFrame(State& state) {
+  auto packet = MakePacketView(MakeAclLeInformationFrame());
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto acl = AclView::Create(packet);
+    ASSERT(acl.IsValid());
+    auto basic_frame = l2cap::BasicFrameView::Create(acl.GetPayload());
+    ASSERT(basic_frame.IsValid());
+    auto information_frame = l2cap::FirstLeInformationFrameView::Create(basic_frame);
+    ASSERT(information_frame.IsValid());
+    benchmark::DoNotOptimize(information_frame.GetL2capSduLength());
+    auto payload = information_frame.GetPayload();
+    benchmark::DoNotOptimize(payload.size());
+  }
+}
+
+void BM_BuildAclLeInformationFrame(State& state) {
+  std::vector<uint8_t> sdu(kLeSduSize, 0x5a);
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    AclBuilder::Create(
+        kAclHandle,
+        PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE,
+        BroadcastFlag::POINT_TO_POINT,
+        l2cap::FirstLeInformationFrameBuilder::Create(
+            kLeDynamicCid, kLeSduSize, std::make_unique<packet::RawBuilder>(sdu)))
+        ->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+// Parsing, the way the ISO manager hands SDUs to LE audio
+void BM_ParseIsoData(State& state) {
+  auto packet = MakePacketView(MakeIsoData());
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    auto iso = IsoView::Create(packet);
+    ASSERT(iso.IsValid());
+    auto iso_data = IsoWithoutTimestampView::Create(iso);
+    ASSERT(iso_data.IsValid());
+    benchmark::DoNotOptimize(iso_data.GetPacketSequenceNumber());
+    auto payload = iso_data.GetPayload();
+    benchmark::DoNotOptimize(payload.size());
+  }
+}
+
+void BM_BuildIsoData(State& state) {
+  std::vector<uint8_t> sdu(kIsoSduSize, 0x5a);
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    IsoWithoutTimestampBuilder::Create(
+        kIsoHandle,
+        IsoPacketBoundaryFlag::COMPLETE_SDU,
+        0x002a,
+        kIsoSduSize,
+        IsoPacketStatusFlag::VALID,
+        std::make_unique<packet::RawBuilder>(sdu))
+        ->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+// Same as BM_BuildIsoData, which copies the SDU in the builder, but the SDU is
+// shared with its producer, as IsoManager::SendIsoPacket does
+void BM_BuildIsoDataFromSharedSdu(State& state) {
+  auto sdu = std::make_shared<const std::vector<uint8_t>>(kIsoSduSize, 0x5a);
+  std::vector<uint8_t> bytes;
+  AllocationCounter counter(state, "allocs_per_packet");
+  for (auto _ : state) {
+    bytes.clear();
+    IsoWithoutTimestampBuilder::Create(
+        kIsoHandle,
+        IsoPacketBoundaryFlag::COMPLETE_SDU,
+        0x002a,
+        kIsoSduSize,
+        IsoPacketStatusFlag::VALID,
+        std::make_unique<packet::ScatterGatherBuilder>(sdu))
+        ->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+}
+
+BENCHMARK(BM_ParseLeExtendedAdvertisingReportRaw);
+BENCHMARK(BM_ParseLeExtendedAdvertisingReport);
+BENCHMARK(BM_BuildLeExtendedAdvertisingReportRaw);
+BENCHMARK(BM_ParseNumberOfCompletedPackets);
+BENCHMARK(BM_BuildNumberOfCompletedPackets);
+BENCHMARK(BM_ParseAclLeFlowControlCredit);
+BENCHMARK(BM_BuildAclLeFlowControlCredit);
+BENCHMARK(BM_ParseAclLeInformationFrame);
+BENCHMARK(BM_BuildAclLeInformationFrame);
+BENCHMARK(BM_ParseIsoData);
+BENCHMARK(BM_BuildIsoData);
+BENCHMARK(BM_BuildIsoDataFromSharedSdu);
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -222,7 +222,7 @@ AddressWithType LeAddressManager::GetInitiatorAddress() {
 
 AddressWithType LeAddressManager::NewResolvableAddress() {
   ASSERT(RotatingAddress());
-  hci::Address address = generate_rpa();
+  hci::Address address = take_rpa();
   auto random_address = AddressWithType(address, AddressType::RANDOM_DEVICE_ADDRESS);
   return random_address;
 }
@@ -297,6 +297,7 @@ void LeAddressManager::resume_registered_clients() {
     client.second = ClientState::WAITING_FOR_RESUME;
     client.first->OnResume();
   }
+  schedule_rpa_pool_refill();
 }
 
 void LeAddressManager::ack_resume(LeAddressManagerCallback* callback) {
@@ -326,7 +327,7 @@ void LeAddressManager::set_random_address() {
 
   hci::Address address;
   if (address_policy_ == AddressPolicy::USE_RESOLVABLE_ADDRESS) {
-    address = generate_rpa();
+    address = take_rpa();
   } else {
     address = generate_nrpa();
   }
@@ -357,6 +358,11 @@ void LeAddressManager::prepare_to_update_irk(UpdateIRKCommand update_irk_command
 }
 
 void LeAddressManager::update_irk(UpdateIRKCommand command) {
+  {
+    // The RPAs generated with the previous IRK can't be used anymore
+    std::unique_lock<std::mutex> lock(rpa_pool_mutex_);
+    rpa_pool_.clear();
+  }
   rotation_irk_ = command.rotation_irk;
   minimum_rotation_time_ = command.minimum_rotation_time;
   maximum_rotation_time_ = command.maximum_rotation_time;
@@ -400,6 +406,38 @@ hci::Address LeAddressManager::generate_rpa() {
   return address;
 }
 
+// Take an RPA from the pool, or generate it if the pool is empty
+hci::Address LeAddressManager::take_rpa() {
+  {
+    std::unique_lock<std::mutex> lock(rpa_pool_mutex_);
+    if (!rpa_pool_.empty()) {
+      hci::Address address = rpa_pool_.back();
+      rpa_pool_.pop_back();
+      return address;
+    }
+  }
+  return generate_rpa();
+}
+
+void LeAddressManager::schedule_rpa_pool_refill() {
+  if (address_policy_ != AddressPolicy::USE_RESOLVABLE_ADDRESS || rpa_pool_refill_scheduled_) {
+    return;
+  }
+  rpa_pool_refill_scheduled_ = true;
+  handler_->Post(common::BindOnce(&LeAddressManager::refill_rpa_pool, common::Unretained(this)));
+}
+
+void LeAddressManager::refill_rpa_pool() {
+  rpa_pool_refill_scheduled_ = false;
+  if (address_policy_ != AddressPolicy::USE_RESOLVABLE_ADDRESS) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(rpa_pool_mutex_);
+  while (rpa_pool_.size() < kRpaPoolSize) {
+    rpa_pool_.push_back(generate_rpa());
+  }
+}
+
 // This function generates NON-Resolvable Private Address (NRPA)
 hci::Address LeAddressManager::generate_nrpa() {
   // The two most significant bits of the address shall be equal to 0
@@ -547,6 +585,52 @@ void LeAddressManager::RemoveDeviceFromResolvingList(
   }
 }
 
+void LeAddressManager::UpdateResolvingList(
+    std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add) {
+  if (!supports_ble_privacy_ || (to_remove.empty() && to_add.empty())) {
+    return;
+  }
+
+  // Disable Address resolution
+  auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
+  Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}};
+  cached_commands_.push(std::move(disable));
+
+  // Removals first, to make room in the controller list for the additions
+  for (const auto& address_with_type : to_remove) {
+    auto packet_builder = hci::LeRemoveDeviceFromResolvingListBuilder::Create(
+        address_with_type.ToPeerAddressType(), address_with_type.GetAddress());
+    Command command = {CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST, HCICommand{std::move(packet_builder)}};
+    cached_commands_.push(std::move(command));
+  }
+
+  for (const auto& entry : to_add) {
+    auto packet_builder = hci::LeAddDeviceToResolvingListBuilder::Create(
+        entry.address_with_type.ToPeerAddressType(),
+        entry.address_with_type.GetAddress(),
+        entry.peer_irk,
+        entry.local_irk);
+    Command command = {CommandType::ADD_DEVICE_TO_RESOLVING_LIST, HCICommand{std::move(packet_builder)}};
+    cached_commands_.push(std::move(command));
+
+    auto privacy_mode_builder = hci::LeSetPrivacyModeBuilder::Create(
+        entry.address_with_type.ToPeerAddressType(), entry.address_with_type.GetAddress(), PrivacyMode::DEVICE);
+    Command privacy_mode = {CommandType::LE_SET_PRIVACY_MODE, HCICommand{std::move(privacy_mode_builder)}};
+    cached_commands_.push(std::move(privacy_mode));
+  }
+
+  // Enable Address resolution
+  auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
+  Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}};
+  cached_commands_.push(std::move(enable));
+
+  if (registered_clients_.empty()) {
+    handler_->BindOnceOn(this, &LeAddressManager::handle_next_command).Invoke();
+  } else {
+    handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
+  }
+}
+
 void LeAddressManager::ClearFilterAcceptList() {
   auto packet_builder = hci::LeClearFilterAcceptListBuilder::Create();
   Command command = {CommandType::CLEAR_CONNECT_LIST, HCICommand{std::move(packet_builder)}};
@@ -16,7 +16,9 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <variant>
+#include <vector>
 
 #include "common/callback.h"
 #include "hci/address_with_type.h"
@@ -36,6 +38,12 @@ class LeAddressManagerCallback {
   virtual void NotifyOnIRKChange(){};
 };
 
+struct ResolvingListEntry {
+  AddressWithType address_with_type;
+  std::array<uint8_t, 16> peer_irk;
+  std::array<uint8_t, 16> local_irk;
+};
+
 class LeAddressManager {
  public:
   LeAddressManager(
@@ -92,6 +100,8 @@ class LeAddressManager {
       const std::array<uint8_t, 16>& local_irk);
   void RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType connect_list_address_type, Address address);
   void RemoveDeviceFromResolvingList(PeerAddressType peer_identity_address_type, Address peer_identity_address);
+  // Applies all the removals, then all the additions, with address resolution disabled once around them
+  void UpdateResolvingList(std::vector<AddressWithType> to_remove, std::vector<ResolvingListEntry> to_add);
   void ClearFilterAcceptList();
   void ClearResolvingList();
   void OnCommandComplete(CommandCompleteView view);
@@ -102,6 +112,14 @@ class LeAddressManager {
     return cached_commands_.size();
   }
 
+  size_t NumberPrecomputedRpasForTest() {
+    std::unique_lock<std::mutex> lock(rpa_pool_mutex_);
+    return rpa_pool_.size();
+  }
+
+  // Number of RPAs generated ahead of the address rotations
+  static constexpr size_t kRpaPoolSize = 4;
+
  protected:
   AddressPolicy address_policy_ = AddressPolicy::POLICY_NOT_SET;
   std::chrono::milliseconds minimum_rotation_time_;
@@ -160,6 +178,9 @@ class LeAddressManager {
   void update_irk(UpdateIRKCommand command);
   hci::Address generate_rpa();
   hci::Address generate_nrpa();
+  hci::Address take_rpa();
+  void schedule_rpa_pool_refill();
+  void refill_rpa_pool();
   void handle_next_command();
   void check_cached_commands();
   template <class View>
@@ -178,6 +199,11 @@ class LeAddressManager {
   uint8_t resolving_list_size_;
   std::queue<Command> cached_commands_;
   bool supports_ble_privacy_{false};
+  // RPAs generated with rotation_irk_ outside of the pause window, they are
+  // also taken by NewResolvableAddress from other handlers
+  std::mutex rpa_pool_mutex_;
+  std::vector<hci::Address> rpa_pool_;
+  bool rpa_pool_refill_scheduled_{false};
 };
 
 }  // namespace hci
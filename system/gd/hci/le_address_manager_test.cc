@@ -241,6 +241,38 @@ TEST_F(LeAddressManagerTest, rotator_address_for_single_client) {
   sync_handler(handler_);
 }
 
+TEST_F(LeAddressManagerTest, rpa_pool_is_filled_after_rotation) {
+  Octet16 irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05, 0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+  auto minimum_rotation_time = std::chrono::milliseconds(1000);
+  auto maximum_rotation_time = std::chrono::milliseconds(3000);
+  AddressWithType remote_address(Address::kEmpty, AddressType::RANDOM_DEVICE_ADDRESS);
+  le_address_manager_->SetPrivacyPolicyForInitiatorAddress(
+      LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
+      remote_address,
+      irk,
+      false,
+      minimum_rotation_time,
+      maximum_rotation_time);
+  ASSERT_EQ(le_address_manager_->NumberPrecomputedRpasForTest(), 0u);
+
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->Register(clients[0].get());
+  sync_handler(handler_);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_RANDOM_ADDRESS);
+  test_hci_layer_->IncomingEvent(LeSetRandomAddressCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+  sync_handler(handler_);
+  ASSERT_EQ(le_address_manager_->NumberPrecomputedRpasForTest(), LeAddressManager::kRpaPoolSize);
+
+  // Addresses are taken from the pool
+  AddressWithType address = le_address_manager_->NewResolvableAddress();
+  ASSERT_EQ(address.GetAddress().address[5] & 0xc0, 0x40);
+  ASSERT_EQ(le_address_manager_->NumberPrecomputedRpasForTest(), LeAddressManager::kRpaPoolSize - 1);
+
+  le_address_manager_->Unregister(clients[0].get());
+  sync_handler(handler_);
+}
+
 TEST_F(LeAddressManagerTest, rotator_non_resolvable_address_for_single_client) {
   Octet16 irk = {};
   auto minimum_rotation_time = std::chrono::milliseconds(1000);
@@ -20,6 +20,7 @@
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 #include "common/init_flags.h"
 #include "common/strings.h"
@@ -83,6 +84,9 @@ struct Advertiser {
   bool directed = false;
   bool in_use = false;
   std::unique_ptr<os::Alarm> address_rotation_alarm;
+  // Last data programmed in the controller, to skip the updates that don't change it
+  std::optional<std::vector<GapData>> advertising_data;
+  std::optional<std::vector<GapData>> scan_response_data;
 };
 
 /**
@@ -974,6 +978,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    if (is_data_programmed(advertiser_id, set_scan_rsp, data)) {
+      LOG_DEBUG("Advertiser %d: %s unchanged", advertiser_id, set_scan_rsp ? "scan response" : "data");
+      on_data_unchanged(advertiser_id, set_scan_rsp);
+      return;
+    }
+
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
         if (set_scan_rsp) {
@@ -1086,6 +1096,38 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         }
       } break;
     }
+
+    if (set_scan_rsp) {
+      advertising_sets_[advertiser_id].scan_response_data = std::move(data);
+    } else {
+      advertising_sets_[advertiser_id].advertising_data = std::move(data);
+    }
+  }
+
+  // Return true if |data| is the data last programmed for the advertiser
+  bool is_data_programmed(AdvertiserId advertiser_id, bool set_scan_rsp, const std::vector<GapData>& data) {
+    const std::optional<std::vector<GapData>>& programmed = set_scan_rsp
+                                                                 ? advertising_sets_[advertiser_id].scan_response_data
+                                                                 : advertising_sets_[advertiser_id].advertising_data;
+    if (!programmed.has_value() || programmed->size() != data.size()) {
+      return false;
+    }
+    return std::equal(data.begin(), data.end(), programmed->begin(), [](const GapData& a, const GapData& b) {
+      return a.data_type_ == b.data_type_ && a.data_ == b.data_;
+    });
+  }
+
+  // Report the data of the advertiser as set, as the command complete would
+  void on_data_unchanged(AdvertiserId advertiser_id, bool set_scan_rsp) {
+    if (advertising_callbacks_ == nullptr || !advertising_sets_[advertiser_id].started ||
+        id_map_[advertiser_id] == kIdLocal) {
+      return;
+    }
+    if (set_scan_rsp) {
+      advertising_callbacks_->OnScanResponseDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+    } else {
+      advertising_callbacks_->OnAdvertisingDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+    }
   }
 
   void send_data_fragment(
@@ -1712,6 +1754,31 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   template <class View>
+  // The controller may hold other data than the last programmed after a failure
+  void forget_programmed_data(AdvertiserId id, OpCode opcode) {
+    auto advertising_set = advertising_sets_.find(id);
+    if (advertising_set == advertising_sets_.end()) {
+      return;
+    }
+    switch (opcode) {
+      case OpCode::LE_SET_ADVERTISING_DATA:
+      case OpCode::LE_SET_EXTENDED_ADVERTISING_DATA:
+        advertising_set->second.advertising_data.reset();
+        break;
+      case OpCode::LE_SET_SCAN_RESPONSE_DATA:
+      case OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA:
+        advertising_set->second.scan_response_data.reset();
+        break;
+      case OpCode::LE_MULTI_ADVT:
+        // The sub opcode is not known here
+        advertising_set->second.advertising_data.reset();
+        advertising_set->second.scan_response_data.reset();
+        break;
+      default:
+        break;
+    }
+  }
+
   void check_status_with_id(bool send_callback, AdvertiserId id, CommandCompleteView view) {
     ASSERT(view.IsValid());
     auto status_view = View::Create(view);
@@ -1726,6 +1793,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (status_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(status_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      forget_programmed_data(id, view.GetCommandOpCode());
     }
 
     // Do not trigger callback if the advertiser not stated yet, or the advertiser is not register
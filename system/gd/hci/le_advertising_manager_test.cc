@@ -1097,6 +1097,40 @@ TEST_F(LeExtendedAdvertisingAPITest, set_data_test) {
   test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, set_unchanged_data_test) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(2);
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The same data is not programmed again
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  sync_client_handler();
+  test_hci_layer_->AssertNoQueuedCommand();
+
+  // Changed data is programmed
+  advertising_data[0].data_.push_back('2');
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::UNSPECIFIED_ERROR));
+
+  // The data is programmed again after a failure
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+}
+
 TEST_F(LeAndroidHciAdvertisingAPITest, set_data_test) {
   // Set advertising data
   std::vector<GapData> advertising_data{};
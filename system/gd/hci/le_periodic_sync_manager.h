@@ -15,8 +15,11 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
 #include "common/callback.h"
@@ -35,6 +38,9 @@ namespace bluetooth {
 namespace hci {
 
 constexpr std::chrono::duration kPeriodicSyncTimeout = std::chrono::seconds(30);
+// The controller only synchronizes with one advertiser at a time, an attempt
+// gives way to the other requests after this time and is retried later.
+constexpr std::chrono::duration kPeriodicSyncAttemptTimeout = std::chrono::seconds(5);
 constexpr int kMaxSyncTransactions = 16;
 
 enum PeriodicSyncState : int {
@@ -63,20 +69,38 @@ struct PendingPeriodicSyncRequest {
       AddressWithType address_with_type,
       uint16_t skip,
       uint16_t sync_timeout,
+      int priority,
       os::Handler* handler)
       : advertiser_sid(advertiser_sid),
         address_with_type(std::move(address_with_type)),
         skip(skip),
         sync_timeout(sync_timeout),
+        priority(priority),
         sync_timeout_alarm(handler) {}
   bool busy = false;
+  // The attempt timed out and is being cancelled to be retried.
+  bool retrying = false;
   uint8_t advertiser_sid;
   AddressWithType address_with_type;
   uint16_t skip;
   uint16_t sync_timeout;
+  int priority;
+  int attempts = 0;
+  std::chrono::milliseconds attempted_time{0};
+  std::chrono::milliseconds attempt_timeout{0};
+  std::chrono::steady_clock::time_point queued_time = std::chrono::steady_clock::now();
   os::Alarm sync_timeout_alarm;
 };
 
+struct PeriodicSyncStats {
+  size_t established = 0;
+  size_t failed = 0;
+  size_t timed_out = 0;
+  size_t retried_attempts = 0;
+  std::chrono::milliseconds total_time_to_sync{0};
+  std::chrono::milliseconds max_time_to_sync{0};
+};
+
 class PeriodicSyncManager {
  public:
   explicit PeriodicSyncManager(ScanningCallback* callbacks)
@@ -91,7 +115,9 @@ class PeriodicSyncManager {
     callbacks_ = callbacks;
   }
 
-  void StartSync(const PeriodicSyncStates& request, uint16_t skip, uint16_t sync_timeout) {
+  // Requests with a higher priority are attempted first, requests of the same
+  // priority take turns.
+  void StartSync(const PeriodicSyncStates& request, uint16_t skip, uint16_t sync_timeout, int priority = 0) {
     if (periodic_syncs_.size() >= kMaxSyncTransactions) {
       int status = static_cast<int>(ErrorCode::CONNECTION_REJECTED_LIMITED_RESOURCES);
       callbacks_->OnPeriodicSyncStarted(
@@ -107,8 +133,14 @@ class PeriodicSyncManager {
     LOG_DEBUG("address = %s, sid = %d",
               ADDRESS_TO_LOGGABLE_CSTR(request.address_with_type),
               request.advertiser_sid);
-    pending_sync_requests_.emplace_back(
-        request.advertiser_sid, request.address_with_type, skip, sync_timeout, handler_);
+    pending_sync_requests_.emplace(
+        GetQueuePosition(priority),
+        request.advertiser_sid,
+        request.address_with_type,
+        skip,
+        sync_timeout,
+        priority,
+        handler_);
     HandleNextRequest();
   }
 
@@ -122,7 +154,7 @@ class PeriodicSyncManager {
           handler_->BindOnce(check_complete<LePeriodicAdvertisingTerminateSyncCompleteView>));
       return;
     };
-    periodic_syncs_.erase(periodic_sync);
+    EraseSync(periodic_sync);
     le_scanning_interface_->EnqueueCommand(
         hci::LePeriodicAdvertisingTerminateSyncBuilder::Create(handle),
         handler_->BindOnce(check_complete<LePeriodicAdvertisingTerminateSyncCompleteView>));
@@ -145,7 +177,7 @@ class PeriodicSyncManager {
       LOG_DEBUG("[PSync]: Removing Sync request from queue");
       CleanUpRequest(adv_sid, address);
     }
-    periodic_syncs_.erase(periodic_sync);
+    EraseSync(periodic_sync);
   }
 
   void TransferSync(
@@ -249,6 +281,12 @@ class PeriodicSyncManager {
         event_view.GetPeriodicAdvertisingInterval(),
         (uint16_t)event_view.GetAdvertiserClockAccuracy());
 
+    if (event_view.GetStatus() == ErrorCode::OPERATION_CANCELLED_BY_HOST && !pending_sync_requests_.empty() &&
+        pending_sync_requests_.front().retrying) {
+      RequeueRequest();
+      return;
+    }
+
     auto pending_sync_request =
         GetPendingSyncFromAddressAndSid(event_view.GetAdvertiserAddress(), event_view.GetAdvertisingSid());
     if (pending_sync_request != pending_sync_requests_.end()) {
@@ -282,8 +320,6 @@ class PeriodicSyncManager {
       AdvanceRequest();
       return;
     }
-    periodic_sync->sync_handle = event_view.GetSyncHandle();
-    periodic_sync->sync_state = PERIODIC_SYNC_STATE_ESTABLISHED;
     callbacks_->OnPeriodicSyncStarted(
         periodic_sync->request_id,
         (uint8_t)event_view.GetStatus(),
@@ -292,6 +328,18 @@ class PeriodicSyncManager {
         address_with_type,
         (uint16_t)event_view.GetAdvertiserPhy(),
         event_view.GetPeriodicAdvertisingInterval());
+    if (event_view.GetStatus() != ErrorCode::SUCCESS) {
+      // The upper layers forget a failed sync, free its slot.
+      stats_.failed++;
+      EraseSync(periodic_sync);
+    } else {
+      periodic_sync->sync_handle = event_view.GetSyncHandle();
+      periodic_sync->sync_state = PERIODIC_SYNC_STATE_ESTABLISHED;
+      established_syncs_[periodic_sync->sync_handle] = periodic_sync;
+      if (pending_sync_request != pending_sync_requests_.end()) {
+        RecordTimeToSync(*pending_sync_request);
+      }
+    }
     AdvanceRequest();
   }
 
@@ -332,7 +380,7 @@ class PeriodicSyncManager {
       LOG_ERROR("[PSync]: index not found for handle %u", sync_handle);
       return;
     }
-    periodic_syncs_.erase(periodic_sync);
+    EraseSync(periodic_sync);
   }
 
   void HandleLePeriodicAdvertisingSyncTransferReceived(LePeriodicAdvertisingSyncTransferReceivedView event_view) {
@@ -367,6 +415,26 @@ class PeriodicSyncManager {
 
   void OnStartSyncTimeout() {
     auto& request = pending_sync_requests_.front();
+    request.attempted_time += request.attempt_timeout;
+    if (request.attempted_time < kPeriodicSyncTimeout) {
+      if (!HasWaitingRequest(request.priority)) {
+        // Nothing else to try, keep waiting for this advertiser
+        ScheduleAttemptTimeout(request);
+        return;
+      }
+      LOG_INFO(
+          "sync attempt %d timeout SID=%04X, bd_addr=%s, trying the next request",
+          request.attempts,
+          request.advertiser_sid,
+          ADDRESS_TO_LOGGABLE_CSTR(request.address_with_type));
+      request.retrying = true;
+      stats_.retried_attempts++;
+      le_scanning_interface_->EnqueueCommand(
+          hci::LePeriodicAdvertisingCreateSyncCancelBuilder::Create(),
+          handler_->BindOnceOn(this, &PeriodicSyncManager::HandlePeriodicAdvertisingCreateSyncCancelStatus));
+      return;
+    }
+    stats_.timed_out++;
     LOG_WARN(
         "%s: sync timeout SID=%04X, bd_addr=%s",
         __func__,
@@ -384,6 +452,10 @@ class PeriodicSyncManager {
     RemoveSyncRequest(sync);
   }
 
+  PeriodicSyncStats GetStats() const {
+    return stats_;
+  }
+
   void HandleLeBigInfoAdvertisingReport(LeBigInfoAdvertisingReportView event_view) {
     ASSERT(event_view.IsValid());
     LOG_DEBUG(
@@ -409,12 +481,11 @@ class PeriodicSyncManager {
 
  private:
   std::list<PeriodicSyncStates>::iterator GetEstablishedSyncFromHandle(uint16_t handle) {
-    for (auto it = periodic_syncs_.begin(); it != periodic_syncs_.end(); it++) {
-      if (it->sync_handle == handle && it->sync_state == PeriodicSyncState::PERIODIC_SYNC_STATE_ESTABLISHED) {
-        return it;
-      }
+    auto it = established_syncs_.find(handle);
+    if (it == established_syncs_.end()) {
+      return periodic_syncs_.end();
     }
-    return periodic_syncs_.end();
+    return it->second;
   }
 
   std::list<PeriodicSyncStates>::iterator GetSyncFromAddressWithTypeAndSid(
@@ -447,9 +518,47 @@ class PeriodicSyncManager {
   }
 
   void RemoveSyncRequest(std::list<PeriodicSyncStates>::iterator it) {
+    EraseSync(it);
+  }
+
+  void EraseSync(std::list<PeriodicSyncStates>::iterator it) {
+    if (it->sync_state == PERIODIC_SYNC_STATE_ESTABLISHED) {
+      established_syncs_.erase(it->sync_handle);
+    }
     periodic_syncs_.erase(it);
   }
 
+  // Return where a request of this priority is queued, after the requests of
+  // the same or a higher priority.
+  std::list<PendingPeriodicSyncRequest>::iterator GetQueuePosition(int priority) {
+    return std::find_if(
+        pending_sync_requests_.begin(), pending_sync_requests_.end(), [priority](const auto& request) {
+          return !request.busy && request.priority < priority;
+        });
+  }
+
+  // Whether a request could use the controller in place of a running one.
+  bool HasWaitingRequest(int priority) const {
+    return std::any_of(
+        std::next(pending_sync_requests_.begin()), pending_sync_requests_.end(), [priority](const auto& request) {
+          return request.priority >= priority;
+        });
+  }
+
+  void RecordTimeToSync(const PendingPeriodicSyncRequest& request) {
+    auto time_to_sync = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - request.queued_time);
+    stats_.established++;
+    stats_.total_time_to_sync += time_to_sync;
+    stats_.max_time_to_sync = std::max(stats_.max_time_to_sync, time_to_sync);
+    LOG_INFO(
+        "synced SID=%04X, bd_addr=%s in %lld ms, %d attempts",
+        request.advertiser_sid,
+        ADDRESS_TO_LOGGABLE_CSTR(request.address_with_type),
+        static_cast<long long>(time_to_sync.count()),
+        request.attempts);
+  }
+
   std::list<PeriodicSyncTransferStates>::iterator GetSyncTransferRequestFromConnectionHandle(
       uint16_t connection_handle) {
     for (auto it = periodic_sync_transfers_.begin(); it != periodic_sync_transfers_.end(); it++) {
@@ -493,10 +602,34 @@ class PeriodicSyncManager {
       return;
     }
     request.busy = true;
+    request.attempts++;
     request.sync_timeout_alarm.Cancel();
     HandleStartSyncRequest(request.advertiser_sid, request.address_with_type, request.skip, request.sync_timeout);
+    ScheduleAttemptTimeout(request);
+  }
+
+  void ScheduleAttemptTimeout(PendingPeriodicSyncRequest& request) {
+    request.attempt_timeout = std::min<std::chrono::milliseconds>(
+        kPeriodicSyncAttemptTimeout, kPeriodicSyncTimeout - request.attempted_time);
     request.sync_timeout_alarm.Schedule(
-        base::BindOnce(&PeriodicSyncManager::OnStartSyncTimeout, base::Unretained(this)), kPeriodicSyncTimeout);
+        base::BindOnce(&PeriodicSyncManager::OnStartSyncTimeout, base::Unretained(this)), request.attempt_timeout);
+  }
+
+  // The timed out attempt was cancelled, queue it behind the other requests.
+  void RequeueRequest() {
+    auto request = pending_sync_requests_.begin();
+    request->sync_timeout_alarm.Cancel();
+    request->busy = false;
+    request->retrying = false;
+    auto sync = GetSyncFromAddressWithTypeAndSid(request->address_with_type, request->advertiser_sid);
+    if (sync == periodic_syncs_.end()) {
+      // The sync was cancelled meanwhile
+      AdvanceRequest();
+      return;
+    }
+    sync->sync_state = PERIODIC_SYNC_STATE_IDLE;
+    pending_sync_requests_.splice(GetQueuePosition(request->priority), pending_sync_requests_, request);
+    HandleNextRequest();
   }
 
   void AdvanceRequest() {
@@ -531,6 +664,8 @@ class PeriodicSyncManager {
   ScanningCallback* callbacks_;
   std::list<PendingPeriodicSyncRequest> pending_sync_requests_;
   std::list<PeriodicSyncStates> periodic_syncs_;
+  std::unordered_map<uint16_t, std::list<PeriodicSyncStates>::iterator> established_syncs_;
+  PeriodicSyncStats stats_;
   std::list<PeriodicSyncTransferStates> periodic_sync_transfers_;
   bool sync_received_callback_registered_ = false;
   int sync_received_callback_id{};
@@ -646,6 +646,89 @@ TEST_F(PeriodicSyncManagerTest, handle_biginfo_advertising_report_test) {
   sync_handler();
 }
 
+TEST_F(PeriodicSyncManagerTest, timed_out_attempt_gives_way_to_next_request_test) {
+  Address address;
+  Address::FromString("00:11:22:33:44:55", address);
+  Address other_address;
+  Address::FromString("00:11:22:33:44:66", other_address);
+  AddressWithType address_with_type = AddressWithType(address, AddressType::PUBLIC_DEVICE_ADDRESS);
+  AddressWithType other_address_with_type = AddressWithType(other_address, AddressType::PUBLIC_DEVICE_ADDRESS);
+  PeriodicSyncStates request{
+      .request_id = 0x01,
+      .advertiser_sid = 0x02,
+      .address_with_type = address_with_type,
+      .sync_handle = 0,
+      .sync_state = PeriodicSyncState::PERIODIC_SYNC_STATE_IDLE,
+  };
+  PeriodicSyncStates other_request{
+      .request_id = 0x02,
+      .advertiser_sid = 0x03,
+      .address_with_type = other_address_with_type,
+      .sync_handle = 0,
+      .sync_state = PeriodicSyncState::PERIODIC_SYNC_STATE_IDLE,
+  };
+  ASSERT_NO_FATAL_FAILURE(test_le_scanning_interface_->SetCommandFuture());
+  periodic_sync_manager_->StartSync(request, 0x04, 0x0A);
+  auto packet = test_le_scanning_interface_->GetCommand(OpCode::LE_PERIODIC_ADVERTISING_CREATE_SYNC);
+  test_le_scanning_interface_->CommandStatusCallback(
+      LePeriodicAdvertisingCreateSyncStatusBuilder::Create(ErrorCode::SUCCESS, 0x00));
+  periodic_sync_manager_->StartSync(other_request, 0x04, 0x0A);
+
+  // The first attempt is cancelled while others are waiting, without failing the sync
+  EXPECT_CALL(mock_callbacks_, OnPeriodicSyncStarted).Times(0);
+  ASSERT_NO_FATAL_FAILURE(test_le_scanning_interface_->SetCommandFuture());
+  periodic_sync_manager_->OnStartSyncTimeout();
+  packet = test_le_scanning_interface_->GetCommand(OpCode::LE_PERIODIC_ADVERTISING_CREATE_SYNC_CANCEL);
+  test_le_scanning_interface_->CommandCompleteCallback(
+      LePeriodicAdvertisingCreateSyncCancelCompleteBuilder::Create(0x00, ErrorCode::SUCCESS));
+
+  ASSERT_NO_FATAL_FAILURE(test_le_scanning_interface_->SetCommandFuture());
+  auto builder = LePeriodicAdvertisingSyncEstablishedBuilder::Create(
+      ErrorCode::OPERATION_CANCELLED_BY_HOST,
+      0,
+      0,
+      AddressType::PUBLIC_DEVICE_ADDRESS,
+      Address::kEmpty,
+      SecondaryPhyType::LE_1M,
+      0,
+      ClockAccuracy::PPM_500);
+  periodic_sync_manager_->HandleLePeriodicAdvertisingSyncEstablished(LePeriodicAdvertisingSyncEstablishedView::Create(
+      LeMetaEventView::Create(EventView::Create(GetPacketView(std::move(builder))))));
+  packet = test_le_scanning_interface_->GetCommand(OpCode::LE_PERIODIC_ADVERTISING_CREATE_SYNC);
+  auto packet_view = LePeriodicAdvertisingCreateSyncView::Create(LeScanningCommandView::Create(packet));
+  ASSERT_TRUE(packet_view.IsValid());
+  ASSERT_EQ(other_address, packet_view.GetAdvertiserAddress());
+  ASSERT_EQ(0x03, packet_view.GetAdvertisingSid());
+  test_le_scanning_interface_->CommandStatusCallback(
+      LePeriodicAdvertisingCreateSyncStatusBuilder::Create(ErrorCode::SUCCESS, 0x00));
+  ::testing::Mock::VerifyAndClearExpectations(&mock_callbacks_);
+
+  // The first request is attempted again once the other one is synced
+  EXPECT_CALL(mock_callbacks_, OnPeriodicSyncStarted(0x02, 0, 0x13, 0x03, ::testing::_, ::testing::_, ::testing::_));
+  ASSERT_NO_FATAL_FAILURE(test_le_scanning_interface_->SetCommandFuture());
+  builder = LePeriodicAdvertisingSyncEstablishedBuilder::Create(
+      ErrorCode::SUCCESS,
+      0x13,
+      0x03,
+      AddressType::PUBLIC_DEVICE_ADDRESS,
+      other_address,
+      SecondaryPhyType::LE_1M,
+      0xFF,
+      ClockAccuracy::PPM_250);
+  periodic_sync_manager_->HandleLePeriodicAdvertisingSyncEstablished(LePeriodicAdvertisingSyncEstablishedView::Create(
+      LeMetaEventView::Create(EventView::Create(GetPacketView(std::move(builder))))));
+  packet = test_le_scanning_interface_->GetCommand(OpCode::LE_PERIODIC_ADVERTISING_CREATE_SYNC);
+  packet_view = LePeriodicAdvertisingCreateSyncView::Create(LeScanningCommandView::Create(packet));
+  ASSERT_TRUE(packet_view.IsValid());
+  ASSERT_EQ(address, packet_view.GetAdvertiserAddress());
+
+  auto stats = periodic_sync_manager_->GetStats();
+  ASSERT_EQ(stats.established, 1u);
+  ASSERT_EQ(stats.retried_attempts, 1u);
+  ASSERT_EQ(stats.timed_out, 0u);
+  sync_handler();
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
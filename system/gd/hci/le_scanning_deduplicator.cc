@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_scanning_deduplicator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace bluetooth::hci {
+
+ScanReportFilter ScanReportFilter::Combine(const std::vector<ScanReportFilter>& filters) {
+  if (filters.empty()) {
+    return {};
+  }
+  ScanReportFilter combined;
+  combined.policy = ScanReportPolicy::ON_CHANGE;
+  combined.rssi_threshold_db = UINT8_MAX;
+  for (const ScanReportFilter& filter : filters) {
+    if (filter.policy == ScanReportPolicy::ALL_REPORTS) {
+      return {};
+    }
+    if (filter.rssi_threshold_db != 0) {
+      combined.rssi_threshold_db = std::min(combined.rssi_threshold_db, filter.rssi_threshold_db);
+    }
+    if (filter.policy == ScanReportPolicy::RATE_LIMITED &&
+        (combined.policy != ScanReportPolicy::RATE_LIMITED || filter.interval < combined.interval)) {
+      combined.policy = ScanReportPolicy::RATE_LIMITED;
+      combined.interval = filter.interval;
+    }
+  }
+  // No scanner asked for RSSI changes
+  if (combined.rssi_threshold_db == UINT8_MAX) {
+    combined.rssi_threshold_db = 0;
+  }
+  return combined;
+}
+
+LeScanningDeduplicator::LeScanningDeduplicator() : last_reports_(kMaxAdvertisers) {
+  last_reports_.reserve(kMaxAdvertisers);
+}
+
+void LeScanningDeduplicator::SetFilter(const ScanReportFilter& filter) {
+  filter_ = filter;
+  Reset();
+}
+
+void LeScanningDeduplicator::Reset() {
+  last_reports_.clear();
+}
+
+bool LeScanningDeduplicator::ShouldReport(
+    uint16_t event_type,
+    uint8_t address_type,
+    const Address& address,
+    uint8_t advertising_sid,
+    int8_t rssi,
+    const std::vector<uint8_t>& advertising_data,
+    Clock::time_point now) {
+  if (filter_.policy == ScanReportPolicy::ALL_REPORTS) {
+    stats_.forwarded++;
+    return true;
+  }
+
+  AdvertiserKey key{address, address_type, advertising_sid};
+  uint32_t data_hash = HashReport(event_type, advertising_data);
+  LastReport* last_report = last_reports_.find(key);
+  if (last_report != nullptr) {
+    bool data_changed = last_report->data_hash != data_hash;
+    bool rssi_changed = filter_.rssi_threshold_db != 0 &&
+                        std::abs(rssi - last_report->rssi) >= filter_.rssi_threshold_db;
+    bool interval_elapsed =
+        filter_.policy == ScanReportPolicy::RATE_LIMITED && now - last_report->time >= filter_.interval;
+    if (!data_changed && !rssi_changed && !interval_elapsed) {
+      stats_.dropped++;
+      return false;
+    }
+    *last_report = {data_hash, rssi, now};
+  } else {
+    last_reports_.insert_or_assign(key, {data_hash, rssi, now});
+  }
+  stats_.forwarded++;
+  return true;
+}
+
+size_t LeScanningDeduplicator::AdvertiserKeyHash::operator()(const AdvertiserKey& key) const {
+  uint64_t value = 0;
+  for (uint8_t byte : key.address.address) {
+    value = (value << 8) | byte;
+  }
+  value |= uint64_t{key.address_type} << 48;
+  value |= uint64_t{key.advertising_sid} << 56;
+  // Fibonacci hashing, the cache indexes its table with the low bits
+  return static_cast<size_t>((value * 0x9e3779b97f4a7c15ull) >> 32);
+}
+
+/// FNV-1a over the event type and the advertising data.
+uint32_t LeScanningDeduplicator::HashReport(
+    uint16_t event_type, const std::vector<uint8_t>& advertising_data) {
+  constexpr uint32_t kFnvPrime = 16777619u;
+  uint32_t hash = 2166136261u;
+  hash = (hash ^ (event_type & 0xff)) * kFnvPrime;
+  hash = (hash ^ (event_type >> 8)) * kFnvPrime;
+  for (uint8_t byte : advertising_data) {
+    hash = (hash ^ byte) * kFnvPrime;
+  }
+  return hash;
+}
+
+}  // namespace bluetooth::hci
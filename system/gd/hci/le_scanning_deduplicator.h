@@ -0,0 +1,124 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "common/flat_lru_cache.h"
+#include "hci/address.h"
+
+namespace bluetooth::hci {
+
+/// Selects which advertising reports of an advertiser are forwarded.
+enum class ScanReportPolicy : uint8_t {
+  /// Forward every report.
+  ALL_REPORTS = 0,
+  /// Forward reports whose data changed, or whose RSSI moved by at least
+  /// the RSSI threshold since the last forwarded report.
+  ON_CHANGE = 1,
+  /// Same as ON_CHANGE, and forward unchanged reports again once the
+  /// interval has elapsed since the last forwarded report.
+  RATE_LIMITED = 2,
+};
+
+struct ScanReportFilter {
+  ScanReportPolicy policy{ScanReportPolicy::ALL_REPORTS};
+  /// RSSI change that makes a report different, 0 to ignore the RSSI.
+  uint8_t rssi_threshold_db{0};
+  /// Used with RATE_LIMITED only.
+  std::chrono::milliseconds interval{0};
+
+  /// Combine the filters of all the scanners sharing the scan results: a
+  /// report is forwarded if any of the scanners would get it.
+  static ScanReportFilter Combine(const std::vector<ScanReportFilter>& filters);
+};
+
+/// The LE Scanning deduplicator drops the complete advertising reports that
+/// repeat the last report forwarded for the same advertiser, before they
+/// are sent up the stack.
+class LeScanningDeduplicator {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Bound on the number of advertisers remembered. The least recently
+  /// seen advertiser is forgotten first, its next report is forwarded.
+  static constexpr size_t kMaxAdvertisers = 256;
+
+  struct Stats {
+    uint64_t forwarded{0};
+    uint64_t dropped{0};
+  };
+
+  LeScanningDeduplicator();
+  LeScanningDeduplicator(const LeScanningDeduplicator&) = delete;
+  LeScanningDeduplicator& operator=(const LeScanningDeduplicator&) = delete;
+
+  /// Set the filter applied to all the reports. The advertisers seen so
+  /// far are forgotten.
+  void SetFilter(const ScanReportFilter& filter);
+
+  /// Forget the advertisers seen so far, e.g. when a new scan starts.
+  void Reset();
+
+  /// Return true if the report must be forwarded, and record it as the
+  /// last report of the advertiser.
+  bool ShouldReport(
+      uint16_t event_type,
+      uint8_t address_type,
+      const Address& address,
+      uint8_t advertising_sid,
+      int8_t rssi,
+      const std::vector<uint8_t>& advertising_data,
+      Clock::time_point now);
+
+  const Stats& GetStats() const {
+    return stats_;
+  }
+
+ private:
+  struct AdvertiserKey {
+    Address address;
+    uint8_t address_type;
+    uint8_t advertising_sid;
+
+    bool operator==(const AdvertiserKey& other) const {
+      return address == other.address && address_type == other.address_type &&
+             advertising_sid == other.advertising_sid;
+    }
+  };
+
+  struct AdvertiserKeyHash {
+    size_t operator()(const AdvertiserKey& key) const;
+  };
+
+  /// Last report forwarded for an advertiser.
+  struct LastReport {
+    uint32_t data_hash;
+    int8_t rssi;
+    Clock::time_point time;
+  };
+
+  static uint32_t HashReport(uint16_t event_type, const std::vector<uint8_t>& advertising_data);
+
+  ScanReportFilter filter_;
+  common::FlatLruCache<AdvertiserKey, LastReport, common::LruEntryCount<AdvertiserKey, LastReport>, AdvertiserKeyHash>
+      last_reports_;
+  Stats stats_;
+};
+
+}  // namespace bluetooth::hci
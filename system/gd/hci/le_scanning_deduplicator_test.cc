@@ -0,0 +1,137 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_deduplicator.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace bluetooth::hci {
+
+// Event type fields.
+static constexpr uint16_t kLegacy = 0x10;
+static constexpr uint16_t kScanResponse = 0x8;
+
+static constexpr uint8_t kPublicAddress = 0x00;
+static constexpr uint8_t kSidNotPresent = 0xff;
+
+static const Address kTestAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({0, 1, 2, 3, 4, 6});
+
+class LeScanningDeduplicatorTest : public ::testing::Test {
+ protected:
+  bool Report(
+      const Address& address,
+      int8_t rssi,
+      const std::vector<uint8_t>& data,
+      uint16_t event_type = kLegacy) {
+    return deduplicator_.ShouldReport(event_type, kPublicAddress, address, kSidNotPresent, rssi, data, now_);
+  }
+
+  static ScanReportFilter Filter(
+      ScanReportPolicy policy, uint8_t rssi_threshold_db = 0, std::chrono::milliseconds interval = 0ms) {
+    ScanReportFilter filter;
+    filter.policy = policy;
+    filter.rssi_threshold_db = rssi_threshold_db;
+    filter.interval = interval;
+    return filter;
+  }
+
+  LeScanningDeduplicator deduplicator_;
+  LeScanningDeduplicator::Clock::time_point now_ = LeScanningDeduplicator::Clock::now();
+};
+
+TEST_F(LeScanningDeduplicatorTest, all_reports_are_forwarded_by_default) {
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x2}));
+  }
+  ASSERT_EQ(deduplicator_.GetStats().forwarded, 3u);
+  ASSERT_EQ(deduplicator_.GetStats().dropped, 0u);
+}
+
+TEST_F(LeScanningDeduplicatorTest, on_change_drops_repeated_reports) {
+  deduplicator_.SetFilter(Filter(ScanReportPolicy::ON_CHANGE));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x2}));
+  ASSERT_FALSE(Report(kTestAddress, -60, {0x1, 0x2}));
+  ASSERT_TRUE(Report(kOtherAddress, -50, {0x1, 0x2}));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x3}));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x3}, kLegacy | kScanResponse));
+  now_ += 10s;
+  ASSERT_FALSE(Report(kTestAddress, -50, {0x1, 0x3}, kLegacy | kScanResponse));
+  ASSERT_EQ(deduplicator_.GetStats().forwarded, 4u);
+  ASSERT_EQ(deduplicator_.GetStats().dropped, 2u);
+
+  // A new scan reports every advertiser again.
+  deduplicator_.Reset();
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x3}, kLegacy | kScanResponse));
+}
+
+TEST_F(LeScanningDeduplicatorTest, rssi_changes_are_forwarded) {
+  deduplicator_.SetFilter(Filter(ScanReportPolicy::ON_CHANGE, 5));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x2}));
+  ASSERT_FALSE(Report(kTestAddress, -54, {0x1, 0x2}));
+  ASSERT_TRUE(Report(kTestAddress, -55, {0x1, 0x2}));
+  // The delta is measured from the last forwarded report.
+  ASSERT_FALSE(Report(kTestAddress, -51, {0x1, 0x2}));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x2}));
+}
+
+TEST_F(LeScanningDeduplicatorTest, rate_limited_repeats_after_the_interval) {
+  deduplicator_.SetFilter(Filter(ScanReportPolicy::RATE_LIMITED, 0, 100ms));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x2}));
+  now_ += 60ms;
+  ASSERT_FALSE(Report(kTestAddress, -50, {0x1, 0x2}));
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x4}));
+  now_ += 60ms;
+  ASSERT_FALSE(Report(kTestAddress, -50, {0x1, 0x4}));
+  now_ += 40ms;
+  ASSERT_TRUE(Report(kTestAddress, -50, {0x1, 0x4}));
+}
+
+TEST_F(LeScanningDeduplicatorTest, least_recently_seen_advertisers_are_forgotten) {
+  deduplicator_.SetFilter(Filter(ScanReportPolicy::ON_CHANGE));
+  for (size_t i = 0; i <= LeScanningDeduplicator::kMaxAdvertisers; i++) {
+    Address address({0, 1, 2, 3, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    ASSERT_TRUE(Report(address, -50, {0x1, 0x2}));
+  }
+  // The first advertiser was evicted, the last ones are remembered.
+  ASSERT_TRUE(Report(Address({0, 1, 2, 3, 0, 0}), -50, {0x1, 0x2}));
+  ASSERT_FALSE(Report(Address({0, 1, 2, 3, 1, 0}), -50, {0x1, 0x2}));
+}
+
+TEST_F(LeScanningDeduplicatorTest, combine_filters) {
+  // Any scanner taking all the reports disables deduplication.
+  ASSERT_EQ(ScanReportFilter::Combine({}).policy, ScanReportPolicy::ALL_REPORTS);
+  ASSERT_EQ(
+      ScanReportFilter::Combine({Filter(ScanReportPolicy::ON_CHANGE), Filter(ScanReportPolicy::ALL_REPORTS)})
+          .policy,
+      ScanReportPolicy::ALL_REPORTS);
+
+  ScanReportFilter combined = ScanReportFilter::Combine(
+      {Filter(ScanReportPolicy::ON_CHANGE, 8),
+       Filter(ScanReportPolicy::RATE_LIMITED, 0, 500ms),
+       Filter(ScanReportPolicy::RATE_LIMITED, 4, 200ms)});
+  ASSERT_EQ(combined.policy, ScanReportPolicy::RATE_LIMITED);
+  ASSERT_EQ(combined.rssi_threshold_db, 4);
+  ASSERT_EQ(combined.interval, 200ms);
+
+  combined = ScanReportFilter::Combine({Filter(ScanReportPolicy::ON_CHANGE), Filter(ScanReportPolicy::ON_CHANGE)});
+  ASSERT_EQ(combined.policy, ScanReportPolicy::ON_CHANGE);
+  ASSERT_EQ(combined.rssi_threshold_db, 0);
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_scanning_filter_planner.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth::hci {
+
+// Lowest RSSI threshold, -128 dBm
+constexpr uint8_t kAllPassRssiThreshold = 0x80;
+
+void LeScanningFilterPlanner::SetCapacity(uint8_t max_filters) {
+  filters_.clear();
+  slots_.assign(max_filters, Slot{});
+}
+
+std::optional<LeScanningFilterPlanner::Placement> LeScanningFilterPlanner::AddConditions(
+    uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& conditions) {
+  if (IsPassthrough()) {
+    return Placement{filter_index, conditions, std::nullopt};
+  }
+  Filter& filter = filters_[filter_index];
+  filter.conditions.insert(filter.conditions.end(), conditions.begin(), conditions.end());
+  if (!filter.controller_index.has_value()) {
+    return std::nullopt;
+  }
+
+  uint8_t controller_index = *filter.controller_index;
+  Slot& slot = slots_[controller_index];
+  // The all-pass filter already lets the reports through.
+  if (IsAllPass(controller_index)) {
+    return std::nullopt;
+  }
+  if (slot.users.size() == 1) {
+    slot.conditions.insert(slot.conditions.end(), conditions.begin(), conditions.end());
+    return Placement{controller_index, conditions, std::nullopt};
+  }
+  // The other filters sharing the index keep its conditions.
+  LOG_INFO("Filter %d changed after it was merged, filtering on the host", filter_index);
+  Detach(filter, filter_index);
+  return PlaceOnAllPass(filter_index);
+}
+
+LeScanningFilterPlanner::Placement LeScanningFilterPlanner::Place(
+    uint8_t filter_index, const AdvertisingFilterParameter& parameter) {
+  if (IsPassthrough()) {
+    return Placement{filter_index, {}, parameter};
+  }
+  Filter& filter = filters_[filter_index];
+  if (filter.controller_index.has_value()) {
+    LOG_WARN("Filter %d is placed again without being removed", filter_index);
+    Detach(filter, filter_index);
+  }
+
+  // Reports are not tagged with the filter that matched them, only the
+  // filters delivering them right away can be merged.
+  if (parameter.delivery_mode == DeliveryMode::IMMEDIATE) {
+    for (size_t i = 0; i + 1 < slots_.size(); i++) {
+      Slot& slot = slots_[i];
+      if (slot.in_use && IsSameParameter(slot.parameter, parameter) &&
+          slot.conditions.size() == filter.conditions.size() &&
+          std::equal(slot.conditions.begin(), slot.conditions.end(), filter.conditions.begin(), IsSameCondition)) {
+        slot.users.push_back(filter_index);
+        filter.controller_index = i;
+        return Placement{static_cast<uint8_t>(i), {}, std::nullopt};
+      }
+    }
+  }
+
+  for (size_t i = 0; i + 1 < slots_.size(); i++) {
+    Slot& slot = slots_[i];
+    if (!slot.in_use) {
+      slot.in_use = true;
+      slot.parameter = parameter;
+      slot.conditions = filter.conditions;
+      slot.users = {filter_index};
+      filter.controller_index = i;
+      return Placement{static_cast<uint8_t>(i), filter.conditions, parameter};
+    }
+  }
+
+  LOG_WARN("No controller filter left for filter %d, filtering on the host", filter_index);
+  return PlaceOnAllPass(filter_index);
+}
+
+LeScanningFilterPlanner::Placement LeScanningFilterPlanner::PlaceOnAllPass(uint8_t filter_index) {
+  uint8_t controller_index = slots_.size() - 1;
+  Slot& slot = slots_[controller_index];
+  slot.users.push_back(filter_index);
+  filters_[filter_index].controller_index = controller_index;
+  if (slot.in_use) {
+    return Placement{controller_index, {}, std::nullopt};
+  }
+
+  // No feature selected matches every report.
+  slot.in_use = true;
+  slot.parameter = {};
+  slot.parameter.rssi_high_thresh = kAllPassRssiThreshold;
+  slot.parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+  return Placement{controller_index, {}, slot.parameter};
+}
+
+std::optional<uint8_t> LeScanningFilterPlanner::Remove(uint8_t filter_index) {
+  if (IsPassthrough()) {
+    return filter_index;
+  }
+  auto it = filters_.find(filter_index);
+  if (it == filters_.end()) {
+    return std::nullopt;
+  }
+  std::optional<uint8_t> released;
+  if (it->second.controller_index.has_value()) {
+    released = Detach(it->second, filter_index);
+  }
+  filters_.erase(it);
+  return released;
+}
+
+std::optional<uint8_t> LeScanningFilterPlanner::Detach(Filter& filter, uint8_t filter_index) {
+  uint8_t controller_index = *filter.controller_index;
+  Slot& slot = slots_[controller_index];
+  filter.controller_index.reset();
+  slot.users.erase(std::remove(slot.users.begin(), slot.users.end(), filter_index), slot.users.end());
+  if (!slot.users.empty()) {
+    return std::nullopt;
+  }
+  slot = Slot{};
+  return controller_index;
+}
+
+void LeScanningFilterPlanner::Clear() {
+  filters_.clear();
+  std::fill(slots_.begin(), slots_.end(), Slot{});
+}
+
+std::optional<uint8_t> LeScanningFilterPlanner::GetControllerIndex(uint8_t filter_index) const {
+  if (IsPassthrough()) {
+    return filter_index;
+  }
+  auto it = filters_.find(filter_index);
+  if (it == filters_.end()) {
+    return std::nullopt;
+  }
+  return it->second.controller_index;
+}
+
+std::optional<uint8_t> LeScanningFilterPlanner::GetFilterIndex(uint8_t controller_index) const {
+  if (IsPassthrough()) {
+    return controller_index;
+  }
+  if (controller_index >= slots_.size() || IsAllPass(controller_index) ||
+      slots_[controller_index].users.size() != 1) {
+    return std::nullopt;
+  }
+  return slots_[controller_index].users[0];
+}
+
+LeScanningFilterPlanner::Stats LeScanningFilterPlanner::GetStats() const {
+  Stats stats;
+  stats.filters = filters_.size();
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (!slots_[i].in_use) {
+      continue;
+    }
+    stats.controller_filters++;
+    if (IsAllPass(i)) {
+      stats.host_filters += slots_[i].users.size();
+    } else if (slots_[i].users.size() > 1) {
+      stats.shared_filters += slots_[i].users.size();
+    }
+  }
+  return stats;
+}
+
+bool LeScanningFilterPlanner::IsSameCondition(
+    const AdvertisingPacketContentFilterCommand& a, const AdvertisingPacketContentFilterCommand& b) {
+  return a.filter_type == b.filter_type && a.address == b.address &&
+         a.application_address_type == b.application_address_type && a.uuid == b.uuid &&
+         a.uuid_mask == b.uuid_mask && a.name == b.name && a.company == b.company &&
+         a.company_mask == b.company_mask && a.org_id == b.org_id && a.tds_flags == b.tds_flags &&
+         a.tds_flags_mask == b.tds_flags_mask && a.meta_data_type == b.meta_data_type &&
+         a.meta_data == b.meta_data && a.ad_type == b.ad_type && a.data == b.data &&
+         a.data_mask == b.data_mask && a.irk == b.irk;
+}
+
+bool LeScanningFilterPlanner::IsSameParameter(
+    const AdvertisingFilterParameter& a, const AdvertisingFilterParameter& b) {
+  return a.feature_selection == b.feature_selection && a.list_logic_type == b.list_logic_type &&
+         a.filter_logic_type == b.filter_logic_type && a.rssi_high_thresh == b.rssi_high_thresh &&
+         a.delivery_mode == b.delivery_mode && a.onfound_timeout == b.onfound_timeout &&
+         a.onfound_timeout_cnt == b.onfound_timeout_cnt && a.rssi_low_thresh == b.rssi_low_thresh &&
+         a.onlost_timeout == b.onlost_timeout && a.num_of_tracking_entries == b.num_of_tracking_entries;
+}
+
+}  // namespace bluetooth::hci
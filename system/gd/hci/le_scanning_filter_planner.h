@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "hci/le_scanning_callback.h"
+
+namespace bluetooth::hci {
+
+/// The LE Scanning filter planner maps the APCF filters configured by the
+/// scanners to the filter indexes of the controller:
+/// - Filters with the same conditions and parameters, delivered
+///   immediately, share one controller filter index.
+/// - Filters that do not fit in the controller are served by a single
+///   all-pass filter, and the host matches their conditions on the scan
+///   results. The last controller index is kept for it.
+/// The conditions of a filter are buffered until its parameters are set,
+/// which is when the filter is placed.
+/// When the capacity of the controller is unknown, the filters are
+/// programmed at their own index as they are configured.
+class LeScanningFilterPlanner {
+ public:
+  /// What to program in the controller after a planner update.
+  struct Placement {
+    uint8_t controller_index;
+    /// Conditions to add at controller_index.
+    std::vector<AdvertisingPacketContentFilterCommand> conditions;
+    /// Parameters to set at controller_index, if the index is new.
+    std::optional<AdvertisingFilterParameter> parameter;
+  };
+
+  struct Stats {
+    /// Filters configured by the scanners.
+    size_t filters{0};
+    /// Controller filter indexes in use, including the all-pass filter.
+    size_t controller_filters{0};
+    /// Filters sharing a controller index with another filter.
+    size_t shared_filters{0};
+    /// Filters left to host filtering.
+    size_t host_filters{0};
+  };
+
+  /// Set the number of filter indexes of the controller, 0 if unknown. The
+  /// filters already placed are forgotten.
+  void SetCapacity(uint8_t max_filters);
+
+  /// Record conditions for a filter. Return what to program when the filter
+  /// was already placed.
+  std::optional<Placement> AddConditions(
+      uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& conditions);
+
+  /// Place a filter with its parameters, and return what to program.
+  Placement Place(uint8_t filter_index, const AdvertisingFilterParameter& parameter);
+
+  /// Remove a filter. Return the controller index to delete, if no other
+  /// filter uses it.
+  std::optional<uint8_t> Remove(uint8_t filter_index);
+
+  /// Remove all the filters.
+  void Clear();
+
+  /// Return the controller index of a filter, if placed.
+  std::optional<uint8_t> GetControllerIndex(uint8_t filter_index) const;
+
+  /// Return the filter alone at a controller index, the events of
+  /// tracking filters are reported for it.
+  std::optional<uint8_t> GetFilterIndex(uint8_t controller_index) const;
+
+  Stats GetStats() const;
+
+ private:
+  struct Filter {
+    std::vector<AdvertisingPacketContentFilterCommand> conditions;
+    std::optional<uint8_t> controller_index;
+  };
+
+  struct Slot {
+    bool in_use{false};
+    AdvertisingFilterParameter parameter{};
+    std::vector<AdvertisingPacketContentFilterCommand> conditions;
+    std::vector<uint8_t> users;
+  };
+
+  /// Place a filter with the all-pass filter.
+  Placement PlaceOnAllPass(uint8_t filter_index);
+  /// Detach a filter from its controller index, return the index if unused.
+  std::optional<uint8_t> Detach(Filter& filter, uint8_t filter_index);
+  bool IsPassthrough() const {
+    return slots_.empty();
+  }
+  bool IsAllPass(uint8_t controller_index) const {
+    return controller_index + 1u == slots_.size();
+  }
+
+  static bool IsSameCondition(
+      const AdvertisingPacketContentFilterCommand& a, const AdvertisingPacketContentFilterCommand& b);
+  static bool IsSameParameter(const AdvertisingFilterParameter& a, const AdvertisingFilterParameter& b);
+
+  std::map<uint8_t, Filter> filters_;
+  std::vector<Slot> slots_;
+};
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_filter_planner.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth::hci {
+
+static constexpr uint8_t kMaxFilters = 4;
+static constexpr uint8_t kAllPassIndex = kMaxFilters - 1;
+
+class LeScanningFilterPlannerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    planner_.SetCapacity(kMaxFilters);
+  }
+
+  static std::vector<AdvertisingPacketContentFilterCommand> NameFilter(const std::string& name) {
+    AdvertisingPacketContentFilterCommand filter{};
+    filter.filter_type = ApcfFilterType::LOCAL_NAME;
+    filter.name.assign(name.begin(), name.end());
+    return {filter};
+  }
+
+  static AdvertisingFilterParameter Parameter(DeliveryMode delivery_mode = DeliveryMode::IMMEDIATE) {
+    AdvertisingFilterParameter parameter{};
+    parameter.feature_selection = 0x10;
+    parameter.list_logic_type = 0x10;
+    parameter.filter_logic_type = 0x1;
+    parameter.delivery_mode = delivery_mode;
+    return parameter;
+  }
+
+  LeScanningFilterPlanner::Placement Add(
+      uint8_t filter_index, const std::string& name, DeliveryMode delivery_mode = DeliveryMode::IMMEDIATE) {
+    EXPECT_FALSE(planner_.AddConditions(filter_index, NameFilter(name)).has_value());
+    return planner_.Place(filter_index, Parameter(delivery_mode));
+  }
+
+  LeScanningFilterPlanner planner_;
+};
+
+TEST_F(LeScanningFilterPlannerTest, unknown_capacity_is_passthrough) {
+  planner_.SetCapacity(0);
+  auto conditions = planner_.AddConditions(7, NameFilter("a"));
+  ASSERT_TRUE(conditions.has_value());
+  ASSERT_EQ(conditions->controller_index, 7);
+  ASSERT_EQ(conditions->conditions.size(), 1u);
+  ASSERT_FALSE(conditions->parameter.has_value());
+
+  auto placement = planner_.Place(7, Parameter());
+  ASSERT_EQ(placement.controller_index, 7);
+  ASSERT_TRUE(placement.conditions.empty());
+  ASSERT_TRUE(placement.parameter.has_value());
+  ASSERT_EQ(planner_.GetFilterIndex(7), 7);
+  ASSERT_EQ(planner_.Remove(7), 7);
+}
+
+TEST_F(LeScanningFilterPlannerTest, conditions_are_programmed_with_the_parameters) {
+  auto placement = Add(5, "a");
+  ASSERT_EQ(placement.controller_index, 0);
+  ASSERT_EQ(placement.conditions.size(), 1u);
+  ASSERT_TRUE(placement.parameter.has_value());
+  ASSERT_EQ(planner_.GetControllerIndex(5), 0);
+  ASSERT_EQ(planner_.GetFilterIndex(0), 5);
+
+  // Conditions added later go to the same controller filter
+  auto conditions = planner_.AddConditions(5, NameFilter("b"));
+  ASSERT_TRUE(conditions.has_value());
+  ASSERT_EQ(conditions->controller_index, 0);
+  ASSERT_EQ(conditions->conditions.size(), 1u);
+  ASSERT_FALSE(conditions->parameter.has_value());
+}
+
+TEST_F(LeScanningFilterPlannerTest, identical_immediate_filters_share_an_index) {
+  ASSERT_EQ(Add(1, "a").controller_index, 0);
+  auto placement = Add(2, "a");
+  ASSERT_EQ(placement.controller_index, 0);
+  ASSERT_TRUE(placement.conditions.empty());
+  ASSERT_FALSE(placement.parameter.has_value());
+  ASSERT_EQ(Add(3, "b").controller_index, 1);
+
+  // Shared filters can't be told apart in tracking events
+  ASSERT_FALSE(planner_.GetFilterIndex(0).has_value());
+  ASSERT_EQ(planner_.GetStats().controller_filters, 2u);
+  ASSERT_EQ(planner_.GetStats().shared_filters, 2u);
+
+  ASSERT_FALSE(planner_.Remove(1).has_value());
+  ASSERT_EQ(planner_.Remove(2), 0);
+  ASSERT_EQ(planner_.GetStats().controller_filters, 1u);
+}
+
+TEST_F(LeScanningFilterPlannerTest, tracking_filters_are_not_shared) {
+  ASSERT_EQ(Add(1, "a", DeliveryMode::ONFOUND).controller_index, 0);
+  ASSERT_EQ(Add(2, "a", DeliveryMode::ONFOUND).controller_index, 1);
+  ASSERT_EQ(planner_.GetFilterIndex(0), 1);
+  ASSERT_EQ(planner_.GetFilterIndex(1), 2);
+}
+
+TEST_F(LeScanningFilterPlannerTest, filters_beyond_capacity_use_the_all_pass_filter) {
+  for (uint8_t i = 0; i < kAllPassIndex; i++) {
+    ASSERT_EQ(Add(i, std::string(1, 'a' + i)).controller_index, i);
+  }
+  auto placement = Add(10, "x");
+  ASSERT_EQ(placement.controller_index, kAllPassIndex);
+  ASSERT_TRUE(placement.conditions.empty());
+  ASSERT_TRUE(placement.parameter.has_value());
+  ASSERT_EQ(placement.parameter->feature_selection, 0);
+  ASSERT_EQ(placement.parameter->rssi_high_thresh, 0x80);
+
+  placement = Add(11, "y");
+  ASSERT_EQ(placement.controller_index, kAllPassIndex);
+  ASSERT_FALSE(placement.parameter.has_value());
+  ASSERT_EQ(planner_.GetStats().host_filters, 2u);
+  ASSERT_FALSE(planner_.GetFilterIndex(kAllPassIndex).has_value());
+
+  // The all-pass filter already matches the new conditions
+  ASSERT_FALSE(planner_.AddConditions(11, NameFilter("z")).has_value());
+
+  ASSERT_FALSE(planner_.Remove(10).has_value());
+  ASSERT_EQ(planner_.Remove(11), kAllPassIndex);
+
+  // A released index is used again
+  ASSERT_EQ(planner_.Remove(1), 1);
+  ASSERT_EQ(Add(12, "w").controller_index, 1);
+}
+
+TEST_F(LeScanningFilterPlannerTest, conditions_added_to_a_shared_filter_move_it_to_the_all_pass_filter) {
+  Add(1, "a");
+  Add(2, "a");
+  auto placement = planner_.AddConditions(2, NameFilter("b"));
+  ASSERT_TRUE(placement.has_value());
+  ASSERT_EQ(placement->controller_index, kAllPassIndex);
+  ASSERT_TRUE(placement->parameter.has_value());
+  ASSERT_EQ(planner_.GetControllerIndex(2), kAllPassIndex);
+  ASSERT_EQ(planner_.GetFilterIndex(0), 1);
+}
+
+TEST_F(LeScanningFilterPlannerTest, clear_removes_all_the_filters) {
+  Add(1, "a");
+  Add(2, "b");
+  planner_.Clear();
+  ASSERT_EQ(planner_.GetStats().filters, 0u);
+  ASSERT_EQ(planner_.GetStats().controller_filters, 0u);
+  ASSERT_FALSE(planner_.GetControllerIndex(1).has_value());
+  ASSERT_EQ(Add(3, "c").controller_index, 0);
+}
+
+}  // namespace bluetooth::hci
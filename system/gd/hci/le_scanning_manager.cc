@@ -24,6 +24,8 @@
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_periodic_sync_manager.h"
+#include "hci/le_scanning_deduplicator.h"
+#include "hci/le_scanning_filter_planner.h"
 #include "hci/le_scanning_interface.h"
 #include "hci/le_scanning_reassembler.h"
 #include "hci/vendor_specific_event_manager.h"
@@ -72,6 +74,7 @@ enum class ScanApiType {
 struct Scanner {
   Uuid app_uuid;
   bool in_use;
+  ScanReportFilter report_filter;
 };
 
 class NullScanningCallback : public ScanningCallback {
@@ -229,6 +232,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     is_periodic_advertising_sync_transfer_sender_supported_ =
         controller_->SupportsBlePeriodicAdvertisingSyncTransferSender();
     total_num_of_advt_tracked_ = controller->GetVendorCapabilities().total_num_of_advt_tracked_;
+    filter_planner_.SetCapacity(controller->GetVendorCapabilities().max_filter_);
     if (is_batch_scan_supported_) {
       vendor_specific_event_manager_->RegisterEventHandler(
           VseSubeventCode::BLE_THRESHOLD, handler->BindOn(this, &LeScanningManager::impl::on_storage_threshold_breach));
@@ -457,7 +461,15 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     auto complete_advertising_data = scanning_reassembler_.ProcessAdvertisingReport(
         event_type, address_type, address, advertising_sid, advertising_data);
 
-    if (complete_advertising_data.has_value()) {
+    if (complete_advertising_data.has_value() &&
+        scanning_deduplicator_.ShouldReport(
+            event_type,
+            address_type,
+            address,
+            advertising_sid,
+            rssi,
+            complete_advertising_data.value(),
+            LeScanningDeduplicator::Clock::now())) {
       switch (address_type) {
         case (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS:
         case (uint8_t)AddressType::PUBLIC_IDENTITY_ADDRESS:
@@ -539,6 +551,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       if (!scanners_[i].in_use) {
         scanners_[i].app_uuid = app_uuid;
         scanners_[i].in_use = true;
+        update_scan_report_filter();
         scanning_callbacks_->OnScannerRegistered(app_uuid, i, ScanningCallback::ScanningStatus::SUCCESS);
         return;
       }
@@ -557,15 +570,48 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     if (scanners_[scanner_id].in_use) {
       scanners_[scanner_id].in_use = false;
       scanners_[scanner_id].app_uuid = Uuid::kEmpty;
+      scanners_[scanner_id].report_filter = {};
+      update_scan_report_filter();
     } else {
       LOG_WARN("Unregister scanner with unused scanner id");
     }
   }
 
+  void set_scan_report_policy(
+      ScannerId scanner_id, ScanReportPolicy policy, uint8_t rssi_threshold_db, uint16_t interval_ms) {
+    if (scanner_id <= 0 || scanner_id > kMaxAppNum || !scanners_[scanner_id].in_use) {
+      LOG_WARN("Invalid scanner id %d", scanner_id);
+      return;
+    }
+    if (policy != ScanReportPolicy::ALL_REPORTS && policy != ScanReportPolicy::ON_CHANGE &&
+        policy != ScanReportPolicy::RATE_LIMITED) {
+      LOG_WARN("Invalid scan report policy %d", static_cast<int>(policy));
+      return;
+    }
+    ScanReportFilter& filter = scanners_[scanner_id].report_filter;
+    filter.policy = policy;
+    filter.rssi_threshold_db = rssi_threshold_db;
+    filter.interval = std::chrono::milliseconds(interval_ms);
+    update_scan_report_filter();
+  }
+
+  // All the scanners share the scan results, a report is only dropped when
+  // none of them would get it.
+  void update_scan_report_filter() {
+    std::vector<ScanReportFilter> filters;
+    for (const Scanner& scanner : scanners_) {
+      if (scanner.in_use) {
+        filters.push_back(scanner.report_filter);
+      }
+    }
+    scanning_deduplicator_.SetFilter(ScanReportFilter::Combine(filters));
+  }
+
   void scan(bool start) {
     // On-resume flag should always be reset if there is an explicit start/stop call.
     scan_on_resume_ = false;
     if (start) {
+      scanning_deduplicator_.Reset();
       configure_scan();
       start_scan();
     } else {
@@ -697,42 +743,38 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
-    auto entry = remove_me_later_map_.find(filter_index);
     switch (action) {
-      case ApcfAction::ADD:
-        le_scanning_interface_->EnqueueCommand(
-            LeAdvFilterAddFilteringParametersBuilder::Create(
-                filter_index,
-                advertising_filter_parameter.feature_selection,
-                advertising_filter_parameter.list_logic_type,
-                advertising_filter_parameter.filter_logic_type,
-                advertising_filter_parameter.rssi_high_thresh,
-                advertising_filter_parameter.delivery_mode,
-                advertising_filter_parameter.onfound_timeout,
-                advertising_filter_parameter.onfound_timeout_cnt,
-                advertising_filter_parameter.rssi_low_thresh,
-                advertising_filter_parameter.onlost_timeout,
-                advertising_filter_parameter.num_of_tracking_entries),
-            module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
-        break;
-      case ApcfAction::DELETE:
+      case ApcfAction::ADD: {
+        LeScanningFilterPlanner::Placement placement =
+            filter_planner_.Place(filter_index, advertising_filter_parameter);
+        program_filter(placement);
+        log_filter_plan(filter_index, placement.controller_index);
+      } break;
+      case ApcfAction::DELETE: {
         tracker_id_map_.erase(filter_index);
+        std::optional<uint8_t> controller_index = filter_planner_.Remove(filter_index);
+        if (!controller_index.has_value()) {
+          // Other filters still use the controller filter
+          break;
+        }
         le_scanning_interface_->EnqueueCommand(
-            LeAdvFilterDeleteFilteringParametersBuilder::Create(filter_index),
+            LeAdvFilterDeleteFilteringParametersBuilder::Create(*controller_index),
             module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
 
         // IRK Scanning
+        auto entry = remove_me_later_map_.find(*controller_index);
         if (entry != remove_me_later_map_.end()) {
           // Don't want to remove for a bonded device
           if (!is_bonded(entry->second.GetAddress())) {
             le_address_manager_->RemoveDeviceFromResolvingList(
                 static_cast<PeerAddressType>(entry->second.GetAddressType()), entry->second.GetAddress());
           }
-          remove_me_later_map_.erase(filter_index);
+          remove_me_later_map_.erase(*controller_index);
         }
-
-        break;
-      case ApcfAction::CLEAR:
+      } break;
+      case ApcfAction::CLEAR: {
+        auto entry = remove_me_later_map_.find(filter_planner_.GetControllerIndex(filter_index).value_or(filter_index));
+        filter_planner_.Clear();
         le_scanning_interface_->EnqueueCommand(
             LeAdvFilterClearFilteringParametersBuilder::Create(),
             module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
@@ -744,10 +786,9 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
             le_address_manager_->RemoveDeviceFromResolvingList(
                 static_cast<PeerAddressType>(entry->second.GetAddressType()), entry->second.GetAddress());
           }
-          remove_me_later_map_.erase(filter_index);
+          remove_me_later_map_.erase(entry);
         }
-
-        break;
+      } break;
       default:
         LOG_ERROR("Unknown action type: %d", (uint16_t)action);
         break;
@@ -760,8 +801,31 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
+    // The conditions are kept by the planner until the filter parameters
+    // are set, unless the filter is already placed.
+    std::optional<LeScanningFilterPlanner::Placement> placement = filter_planner_.AddConditions(filter_index, filters);
+    if (placement.has_value()) {
+      program_filter(*placement);
+    }
+  }
+
+  void log_filter_plan(uint8_t filter_index, uint8_t controller_index) {
+    LeScanningFilterPlanner::Stats stats = filter_planner_.GetStats();
+    LOG_INFO(
+        "filter %d at controller filter %d, filters:%zu controller_filters:%zu shared:%zu host:%zu",
+        filter_index,
+        controller_index,
+        stats.filters,
+        stats.controller_filters,
+        stats.shared_filters,
+        stats.host_filters);
+  }
+
+  // Program the conditions, then the parameters, of a controller filter
+  void program_filter(const LeScanningFilterPlanner::Placement& placement) {
+    uint8_t filter_index = placement.controller_index;
     ApcfAction apcf_action = ApcfAction::ADD;
-    for (auto filter : filters) {
+    for (auto filter : placement.conditions) {
       /* If data is passed, both mask and data have to be the same length */
       if (filter.data.size() != filter.data_mask.size() && filter.data.size() != 0 && filter.data_mask.size() != 0) {
         LOG_ERROR("data and data_mask are of different size");
@@ -813,6 +877,25 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
           break;
       }
     }
+
+    if (!placement.parameter.has_value()) {
+      return;
+    }
+    const AdvertisingFilterParameter& advertising_filter_parameter = *placement.parameter;
+    le_scanning_interface_->EnqueueCommand(
+        LeAdvFilterAddFilteringParametersBuilder::Create(
+            filter_index,
+            advertising_filter_parameter.feature_selection,
+            advertising_filter_parameter.list_logic_type,
+            advertising_filter_parameter.filter_logic_type,
+            advertising_filter_parameter.rssi_high_thresh,
+            advertising_filter_parameter.delivery_mode,
+            advertising_filter_parameter.onfound_timeout,
+            advertising_filter_parameter.onfound_timeout_cnt,
+            advertising_filter_parameter.rssi_low_thresh,
+            advertising_filter_parameter.onlost_timeout,
+            advertising_filter_parameter.num_of_tracking_entries),
+        module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
   }
 
   std::unordered_map<uint8_t, AddressWithType> remove_me_later_map_;
@@ -1591,7 +1674,12 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   void on_advertisement_tracking(VendorSpecificEventView event) {
     auto view = LEAdvertisementTrackingEventView::Create(event);
     ASSERT(view.IsValid());
-    uint8_t filter_index = view.GetApcfFilterIndex();
+    std::optional<uint8_t> planned_filter_index = filter_planner_.GetFilterIndex(view.GetApcfFilterIndex());
+    if (!planned_filter_index.has_value()) {
+      LOG_WARN("Advertisement track for shared filter %d", (uint16_t)view.GetApcfFilterIndex());
+      return;
+    }
+    uint8_t filter_index = *planned_filter_index;
     if (tracker_id_map_.find(filter_index) == tracker_id_map_.end()) {
       LOG_WARN("Advertisement track for filter_index %d is not register", (uint16_t)filter_index);
       return;
@@ -1669,6 +1757,8 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   bool scan_on_resume_ = false;
   bool paused_ = false;
   LeScanningReassembler scanning_reassembler_;
+  LeScanningDeduplicator scanning_deduplicator_;
+  LeScanningFilterPlanner filter_planner_;
   bool is_filter_supported_ = false;
   bool is_ad_type_filter_supported_ = false;
   bool is_batch_scan_supported_ = false;
@@ -1735,6 +1825,11 @@ void LeScanningManager::SetScanParameters(
   CallOn(pimpl_.get(), &impl::set_scan_parameters, scanner_id, scan_type, scan_interval, scan_window);
 }
 
+void LeScanningManager::SetScanReportPolicy(
+    ScannerId scanner_id, ScanReportPolicy policy, uint8_t rssi_threshold_db, uint16_t interval_ms) {
+  CallOn(pimpl_.get(), &impl::set_scan_report_policy, scanner_id, policy, rssi_threshold_db, interval_ms);
+}
+
 void LeScanningManager::SetScanFilterPolicy(LeScanningFilterPolicy filter_policy) {
   CallOn(pimpl_.get(), &impl::set_scan_filter_policy, filter_policy);
 }
@@ -21,6 +21,7 @@
 #include "hci/address_with_type.h"
 #include "hci/hci_packets.h"
 #include "hci/le_scanning_callback.h"
+#include "hci/le_scanning_deduplicator.h"
 #include "hci/uuid.h"
 #include "module.h"
 
@@ -54,6 +55,12 @@ class LeScanningManager : public bluetooth::Module {
   virtual void SetScanParameters(
       ScannerId scanner_id, LeScanType scan_type, uint16_t scan_interval, uint16_t scan_window);
 
+  /* Drop the advertising reports that repeat the last one of an advertiser.
+   * |rssi_threshold_db| of 0 ignores RSSI changes, |interval_ms| is used with
+   * RATE_LIMITED only. */
+  virtual void SetScanReportPolicy(
+      ScannerId scanner_id, ScanReportPolicy policy, uint8_t rssi_threshold_db, uint16_t interval_ms);
+
   virtual void SetScanFilterPolicy(LeScanningFilterPolicy filter_policy);
 
   /* Scan filter */
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <time.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_allocations.h"
+#include "hal/snoop_logger_common.h"
+#include "hci/acl_manager.h"
+#include "hci/controller.h"
+#include "hci/hci_layer.h"
+#include "hci/le_scanning_manager.h"
+#include "hci/le_scanning_reassembler.h"
+#include "module.h"
+#include "os/log.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+// Capture replayed by the benchmarks, instead of the synthesized dense environment
+constexpr char kCaptureEnv[] = "BT_SCANNING_BENCHMARK_BTSNOOP";
+
+constexpr uint8_t kH4Event = 0x04;
+constexpr uint8_t kLeMetaEventCode = 0x3e;
+constexpr size_t kLeMetaHeaderSize = 4;  // Event code, length, subevent code, number of reports
+constexpr size_t kBtSnoopRecordHeaderSize = 24;
+
+// Synthesized environment: |kNumAdvertisers| devices each advertising |kNumRounds| times
+constexpr size_t kNumAdvertisers = 300;
+constexpr size_t kNumRounds = 10;
+
+// LE Meta events carrying advertising reports, as received from the HAL
+struct Capture {
+  std::vector<std::vector<uint8_t>> events;
+  size_t num_reports = 0;
+};
+
+bool IsAdvertisingReport(const std::vector<uint8_t>& event) {
+  if (event.size() < kLeMetaHeaderSize || event[0] != kLeMetaEventCode) {
+    return false;
+  }
+  auto subevent_code = static_cast<SubeventCode>(event[2]);
+  return subevent_code == SubeventCode::ADVERTISING_REPORT ||
+         subevent_code == SubeventCode::EXTENDED_ADVERTISING_REPORT;
+}
+
+uint32_t ReadBigEndian32(const uint8_t* p) {
+  return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// Keeps the advertising reports of a btsnoop capture in the HCI UART (H4) format, as written by the snoop logger
+bool LoadBtSnoop(const char* path, Capture* capture) {
+  std::ifstream file(path, std::ios::binary);
+  hal::SnoopLoggerCommon::FileHeaderType header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      memcmp(
+          header.identification_pattern,
+          hal::SnoopLoggerCommon::kBtSnoopFileHeader.identification_pattern,
+          sizeof(header.identification_pattern)) != 0 ||
+      header.datalink_type != hal::SnoopLoggerCommon::kBtSnoopFileHeader.datalink_type) {
+    LOG_ERROR("%s is not a btsnoop H4 capture", path);
+    return false;
+  }
+
+  uint8_t record_header[kBtSnoopRecordHeaderSize];
+  while (file.read(reinterpret_cast<char*>(record_header), sizeof(record_header))) {
+    uint32_t included_length = ReadBigEndian32(&record_header[4]);
+    std::vector<uint8_t> packet(included_length);
+    if (!file.read(reinterpret_cast<char*>(packet.data()), included_length)) {
+      break;
+    }
+    if (packet.empty() || packet[0] != kH4Event) {
+      continue;
+    }
+    packet.erase(packet.begin());
+    if (IsAdvertisingReport(packet)) {
+      capture->num_reports += packet[3];
+      capture->events.push_back(std::move(packet));
+    }
+  }
+  return !capture->events.empty();
+}
+
+void AppendExtendedReport(
+    std::vector<uint8_t>* event, uint16_t event_type, const Address& address, const std::vector<uint8_t>& data) {
+  bool legacy = event_type & (1 << 4);
+  event->push_back(event_type & 0xff);
+  event->push_back(event_type >> 8);
+  event->push_back(0x01);  // Random device address
+  event->insert(event->end(), address.address.begin(), address.address.end());
+  event->push_back(0x01);                  // LE 1M
+  event->push_back(legacy ? 0x00 : 0x02);  // No secondary PHY for legacy PDUs, LE 2M otherwise
+  event->push_back(legacy ? 0xff : 0x01);  // No ADI for legacy PDUs
+  event->push_back(0x7f);                  // Tx power not available
+  event->push_back(static_cast<uint8_t>(-60 - (address.address[0] % 30)));
+  event->push_back(0x00);  // Not periodic
+  event->push_back(0x00);
+  event->push_back(0x00);  // Direct address type
+  event->insert(event->end(), 6, 0x00);
+  event->push_back(data.size());
+  event->insert(event->end(), data.begin(), data.end());
+}
+
+std::vector<uint8_t> MakeExtendedReportEvent(
+    uint16_t event_type, const Address& address, const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> event = {
+      kLeMetaEventCode, 0x00, static_cast<uint8_t>(SubeventCode::EXTENDED_ADVERTISING_REPORT), 0x01};
+  AppendExtendedReport(&event, event_type, address, data);
+  event[1] = event.size() - 2;
+  return event;
+}
+
+// A crowded environment as reported by a controller supporting extended advertising: a third of the devices send
+// scannable legacy advertisements answered by scan responses, a third send non connectable legacy beacons, and a
+// third send extended advertisements fragmented over two reports.
+void SynthesizeDenseEnvironment(Capture* capture) {
+  constexpr uint16_t kLegacyAdvInd = 0x13;
+  constexpr uint16_t kLegacyScanRsp = 0x1b;
+  constexpr uint16_t kLegacyNonConnInd = 0x10;
+  constexpr uint16_t kExtConnectableIncomplete = 0x01 | (1 << 5);
+  constexpr uint16_t kExtConnectableComplete = 0x01;
+
+  std::vector<uint8_t> legacy_data(31, 0xa5);
+  std::vector<uint8_t> fragment_data(229, 0x5a);
+  for (size_t round = 0; round < kNumRounds; round++) {
+    for (size_t i = 0; i < kNumAdvertisers; i++) {
+      Address address({static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 0x03, 0x04, 0x05, 0xc6});
+      switch (i % 3) {
+        case 0:
+          capture->events.push_back(MakeExtendedReportEvent(kLegacyAdvInd, address, legacy_data));
+          capture->events.push_back(MakeExtendedReportEvent(kLegacyScanRsp, address, legacy_data));
+          capture->num_reports += 2;
+          break;
+        case 1:
+          capture->events.push_back(MakeExtendedReportEvent(kLegacyNonConnInd, address, legacy_data));
+          capture->num_reports += 1;
+          break;
+        default:
+          capture->events.push_back(MakeExtendedReportEvent(kExtConnectableIncomplete, address, fragment_data));
+          capture->events.push_back(MakeExtendedReportEvent(kExtConnectableComplete, address, fragment_data));
+          capture->num_reports += 2;
+          break;
+      }
+    }
+  }
+}
+
+const Capture& GetCapture() {
+  static const Capture* capture = [] {
+    auto* c = new Capture();
+    const char* path = std::getenv(kCaptureEnv);
+    if (path == nullptr || !LoadBtSnoop(path, c)) {
+      *c = Capture();
+      SynthesizeDenseEnvironment(c);
+    }
+    LOG_INFO("Replaying %zu advertising reports in %zu events", c->num_reports, c->events.size());
+    return c;
+  }();
+  return *capture;
+}
+
+LeMetaEventView ParseLeMetaEvent(const std::vector<uint8_t>& bytes) {
+  auto packet = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(bytes));
+  return LeMetaEventView::Create(EventView::Create(packet));
+}
+
+uint64_t ProcessCpuTimeNs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Reports the throughput, and the CPU time and allocations per report of all the threads of the process, for
+// benchmarks processing |reports_per_iteration| advertising reports per iteration
+class ReportCounters {
+ public:
+  ReportCounters(State& state, size_t reports_per_iteration)
+      : state_(state),
+        reports_per_iteration_(reports_per_iteration),
+        cpu_start_ns_(ProcessCpuTimeNs()),
+        allocations_start_(GetAllocationCount()) {}
+
+  ~ReportCounters() {
+    int64_t num_reports = state_.iterations() * reports_per_iteration_;
+    if (num_reports == 0) {
+      return;
+    }
+    state_.SetItemsProcessed(num_reports);
+    state_.counters["cpu_ns_per_report"] = static_cast<double>(ProcessCpuTimeNs() - cpu_start_ns_) / num_reports;
+    state_.counters["allocs_per_report"] = static_cast<double>(GetAllocationCount() - allocations_start_) / num_reports;
+  }
+
+ private:
+  State& state_;
+  size_t reports_per_iteration_;
+  uint64_t cpu_start_ns_;
+  uint64_t allocations_start_;
+};
+
+// Hands the replayed events straight to the LE event handlers registered by LeScanningManager, and drops the commands
+// it sends: no scan is started, the reports are processed all the same.
+class ReplayHciLayer : public HciLayer {
+ public:
+  void EnqueueCommand(
+      std::unique_ptr<CommandBuilder> /* command */,
+      common::ContextualOnceCallback<void(CommandStatusView)> /* on_status */) override {}
+
+  void EnqueueCommand(
+      std::unique_ptr<CommandBuilder> /* command */,
+      common::ContextualOnceCallback<void(CommandCompleteView)> /* on_complete */) override {}
+
+  void RegisterEventHandler(
+      EventCode /* event_code */, common::ContextualCallback<void(EventView)> /* event_handler */) override {}
+
+  void UnregisterEventHandler(EventCode /* event_code */) override {}
+
+  void RegisterLeEventHandler(
+      SubeventCode subevent_code, common::ContextualCallback<void(LeMetaEventView)> event_handler) override {
+    le_event_handlers_.insert_or_assign(subevent_code, event_handler);
+  }
+
+  void UnregisterLeEventHandler(SubeventCode subevent_code) override {
+    le_event_handlers_.erase(subevent_code);
+  }
+
+  void InjectLeMetaEvent(LeMetaEventView event) {
+    le_event_handlers_.at(event.GetSubeventCode()).Invoke(event);
+  }
+
+ protected:
+  void ListDependencies(ModuleList* /* list */) const override {}
+  void Start() override {}
+  void Stop() override {}
+
+ private:
+  std::map<SubeventCode, common::ContextualCallback<void(LeMetaEventView)>> le_event_handlers_;
+};
+
+class ReplayController : public Controller {
+ protected:
+  void ListDependencies(ModuleList* /* list */) const override {}
+  void Start() override {}
+  void Stop() override {}
+};
+
+class ReplayAclManager : public AclManager {
+ public:
+  // Only used by LeScanningManager to start scanning
+  LeAddressManager* GetLeAddressManager() override {
+    return nullptr;
+  }
+
+ protected:
+  void ListDependencies(ModuleList* /* list */) const override {}
+  void Start() override {}
+  void Stop() override {}
+};
+
+class CountingScanningCallback : public ScanningCallback {
+ public:
+  void OnScanResult(
+      uint16_t /* event_type */,
+      uint8_t /* address_type */,
+      Address /* address */,
+      uint8_t /* primary_phy */,
+      uint8_t /* secondary_phy */,
+      uint8_t /* advertising_sid */,
+      int8_t /* tx_power */,
+      int8_t /* rssi */,
+      uint16_t /* periodic_advertising_interval */,
+      std::vector<uint8_t> advertising_data) override {
+    num_results++;
+    ::benchmark::DoNotOptimize(advertising_data.data());
+  }
+
+  void OnScannerRegistered(
+      const Uuid /* app_uuid */, ScannerId /* scanner_id */, ScanningStatus /* status */) override {}
+  void OnSetScannerParameterComplete(ScannerId /* scanner_id */, ScanningStatus /* status */) override {}
+  void OnTrackAdvFoundLost(AdvertisingFilterOnFoundOnLostInfo /* on_found_on_lost_info */) override {}
+  void OnBatchScanReports(
+      int /* client_if */,
+      int /* status */,
+      int /* report_format */,
+      int /* num_records */,
+      std::vector<uint8_t> /* data */) override {}
+  void OnBatchScanThresholdCrossed(int /* client_if */) override {}
+  void OnTimeout() override {}
+  void OnFilterEnable(Enable /* enable */, uint8_t /* status */) override {}
+  void OnFilterParamSetup(uint8_t /* available_spaces */, ApcfAction /* action */, uint8_t /* status */) override {}
+  void OnFilterConfigCallback(
+      ApcfFilterType /* filter_type */,
+      uint8_t /* available_spaces */,
+      ApcfAction /* action */,
+      uint8_t /* status */) override {}
+  void OnPeriodicSyncStarted(
+      int /* request_id */,
+      uint8_t /* status */,
+      uint16_t /* sync_handle */,
+      uint8_t /* advertising_sid */,
+      AddressWithType /* address_with_type */,
+      uint8_t /* phy */,
+      uint16_t /* interval */) override {}
+  void OnPeriodicSyncReport(
+      uint16_t /* sync_handle */,
+      int8_t /* tx_power */,
+      int8_t /* rssi */,
+      uint8_t /* status */,
+      std::vector<uint8_t> /* data */) override {}
+  void OnPeriodicSyncLost(uint16_t /* sync_handle */) override {}
+  void OnPeriodicSyncTransferred(int /* pa_source */, uint8_t /* status */, Address /* address */) override {}
+  void OnBigInfoReport(uint16_t /* sync_handle */, bool /* encrypted */) override {}
+
+  uint64_t num_results = 0;
+};
+
+}  // namespace
+
+// HCI stage: the HCI layer wrapping each event received from the HAL, and LeScanningManager splitting it into
+// advertising reports
+static void BM_ScanningPipeline_HciEvent(State& state) {
+  const Capture& capture = GetCapture();
+  ReportCounters counters(state, capture.num_reports);
+  for (auto _ : state) {
+    for (const auto& bytes : capture.events) {
+      LeMetaEventView event = ParseLeMetaEvent(bytes);
+      if (event.GetSubeventCode() == SubeventCode::EXTENDED_ADVERTISING_REPORT) {
+        auto view = LeExtendedAdvertisingReportRawView::Create(event);
+        ASSERT(view.IsValid());
+        ::benchmark::DoNotOptimize(view.GetResponses());
+      } else {
+        auto view = LeAdvertisingReportRawView::Create(event);
+        ASSERT(view.IsValid());
+        ::benchmark::DoNotOptimize(view.GetResponses());
+      }
+    }
+  }
+}
+BENCHMARK(BM_ScanningPipeline_HciEvent);
+
+// Reassembler stage alone, on reports parsed beforehand
+static void BM_ScanningPipeline_Reassembler(State& state) {
+  struct Report {
+    uint16_t event_type;
+    uint8_t address_type;
+    Address address;
+    uint8_t advertising_sid;
+    std::vector<uint8_t> advertising_data;
+  };
+  std::vector<Report> reports;
+  for (const auto& bytes : GetCapture().events) {
+    LeMetaEventView event = ParseLeMetaEvent(bytes);
+    if (event.GetSubeventCode() != SubeventCode::EXTENDED_ADVERTISING_REPORT) {
+      // Legacy reports are converted to extended event types by LeScanningManager; only extended ones are replayed
+      continue;
+    }
+    for (auto& r : LeExtendedAdvertisingReportRawView::Create(event).GetResponses()) {
+      uint16_t event_type = r.connectable_ | (r.scannable_ << 1) | (r.directed_ << 2) | (r.scan_response_ << 3) |
+                            (r.legacy_ << 4) | (static_cast<uint16_t>(r.data_status_) << 5);
+      reports.push_back(
+          {event_type, static_cast<uint8_t>(r.address_type_), r.address_, r.advertising_sid_, r.advertising_data_});
+    }
+  }
+
+  LeScanningReassembler reassembler;
+  ReportCounters counters(state, reports.size());
+  for (auto _ : state) {
+    for (const auto& r : reports) {
+      ::benchmark::DoNotOptimize(reassembler.ProcessAdvertisingReport(
+          r.event_type, r.address_type, r.address, r.advertising_sid, r.advertising_data));
+    }
+  }
+}
+BENCHMARK(BM_ScanningPipeline_Reassembler);
+
+// Whole GD stage: from the event received from the HAL to the ScanningCallback, through the module handler of
+// LeScanningManager, its reassembler and deduplicator
+class BM_ScanningPipeline : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    hci_layer_ = new ReplayHciLayer();  // Ownership is transferred to registry
+    registry_ = std::make_unique<TestModuleRegistry>();
+    registry_->InjectTestModule(&HciLayer::Factory, hci_layer_);
+    registry_->InjectTestModule(&Controller::Factory, new ReplayController());
+    registry_->InjectTestModule(&AclManager::Factory, new ReplayAclManager());
+    registry_->Start<LeScanningManager>(&registry_->GetTestThread());
+    le_scanning_manager_ =
+        static_cast<LeScanningManager*>(registry_->GetModuleUnderTest(&LeScanningManager::Factory));
+    le_scanning_manager_->RegisterScanningCallback(&callback_);
+    Synchronize();
+  }
+
+  void TearDown(State& st) override {
+    Synchronize();
+    registry_->StopAll();
+    registry_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void Synchronize() {
+    ASSERT(registry_->SynchronizeModuleHandler(&LeScanningManager::Factory, std::chrono::seconds(10)));
+  }
+
+  ReplayHciLayer* hci_layer_ = nullptr;
+  LeScanningManager* le_scanning_manager_ = nullptr;
+  std::unique_ptr<TestModuleRegistry> registry_;
+  CountingScanningCallback callback_;
+};
+
+BENCHMARK_DEFINE_F(BM_ScanningPipeline, hal_to_scanning_callback)(State& state) {
+  const Capture& capture = GetCapture();
+  ReportCounters counters(state, capture.num_reports);
+  for (auto _ : state) {
+    // Floods the module handler as a controller in a dense environment would; the rate at which it drains is the
+    // highest sustainable report rate
+    for (const auto& bytes : capture.events) {
+      hci_layer_->InjectLeMetaEvent(ParseLeMetaEvent(bytes));
+    }
+    Synchronize();
+  }
+  state.counters["results_per_report"] =
+      ::benchmark::Counter(static_cast<double>(callback_.num_results) / (state.iterations() * capture.num_reports));
+}
+BENCHMARK_REGISTER_F(BM_ScanningPipeline, hal_to_scanning_callback)->UseRealTime();
+
+}  // namespace hci
+}  // namespace bluetooth
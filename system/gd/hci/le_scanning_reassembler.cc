@@ -15,6 +15,7 @@
  */
 #include "hci/le_scanning_reassembler.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -32,6 +33,14 @@
 
 namespace bluetooth::hci {
 
+LeScanningReassembler::LeScanningReassembler() {
+  index_.fill(kInvalidIndex);
+  for (size_t i = 0; i < kMaximumCacheSize; i++) {
+    fragments_[i].next = i + 1 < kMaximumCacheSize ? i + 1 : kInvalidIndex;
+  }
+  free_head_ = 0;
+}
+
 std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessAdvertisingReport(
     uint16_t event_type,
     uint8_t address_type,
@@ -66,12 +75,15 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessAdvertisingRep
   }
 
   // Concatenate the data with existing fragments.
-  std::list<AdvertisingFragment>::iterator advertising_fragment =
-      AppendFragment(key, advertising_data);
+  AdvertisingFragment& advertising_fragment = AppendFragment(key, advertising_data);
 
   // Trim the advertising data when the complete payload is received.
-  if (data_status != DataStatus::CONTINUING) {
-    advertising_fragment->data = TrimAdvertisingData(advertising_fragment->data);
+  advertising_fragment.complete = data_status != DataStatus::CONTINUING;
+  if (advertising_fragment.complete) {
+    TrimAdvertisingDataInPlace(advertising_fragment.data);
+  }
+  if (data_status == DataStatus::TRUNCATED) {
+    stats_.incomplete_chains++;
   }
 
   // TODO(b/272120114) waiting for a scan response here is prone to failure as the
@@ -89,8 +101,9 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessAdvertisingRep
 
   // Otherwise the full advertising report has been reassembled,
   // removed the cache entry and return the complete advertising data.
-  std::vector<uint8_t> complete_advertising_data = std::move(advertising_fragment->data);
-  cache_.erase(advertising_fragment);
+  // The data is copied out so that the cache entry keeps its buffer.
+  std::vector<uint8_t> complete_advertising_data = advertising_fragment.data;
+  RemoveFragment(key);
   return complete_advertising_data;
 }
 
@@ -98,24 +111,33 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessAdvertisingRep
 /// GAP Data entries.
 std::vector<uint8_t> LeScanningReassembler::TrimAdvertisingData(
     const std::vector<uint8_t>& advertising_data) {
-  // Remove empty and overflowing entries from the advertising data.
-  std::vector<uint8_t> significant_advertising_data;
+  std::vector<uint8_t> significant_advertising_data(advertising_data);
+  TrimAdvertisingDataInPlace(significant_advertising_data);
+  return significant_advertising_data;
+}
+
+/// Same as TrimAdvertisingData, without allocating: the significant
+/// entries are moved towards the front of the buffer.
+void LeScanningReassembler::TrimAdvertisingDataInPlace(std::vector<uint8_t>& advertising_data) {
+  size_t significant_size = 0;
   for (size_t offset = 0; offset < advertising_data.size();) {
     size_t remaining_size = advertising_data.size() - offset;
     uint8_t entry_size = advertising_data[offset];
 
     if (entry_size != 0 && entry_size < remaining_size) {
-      significant_advertising_data.push_back(entry_size);
-      significant_advertising_data.insert(
-          significant_advertising_data.end(),
-          advertising_data.begin() + offset + 1,
-          advertising_data.begin() + offset + 1 + entry_size);
+      if (significant_size != offset) {
+        std::copy(
+            advertising_data.begin() + offset,
+            advertising_data.begin() + offset + 1 + entry_size,
+            advertising_data.begin() + significant_size);
+      }
+      significant_size += entry_size + 1;
     }
 
     offset += entry_size + 1;
   }
 
-  return significant_advertising_data;
+  advertising_data.resize(significant_size);
 }
 
 LeScanningReassembler::AdvertisingKey::AdvertisingKey(
@@ -132,48 +154,143 @@ LeScanningReassembler::AdvertisingKey::AdvertisingKey(
   }
 }
 
-bool LeScanningReassembler::AdvertisingKey::operator==(const AdvertisingKey& other) {
+bool LeScanningReassembler::AdvertisingKey::operator==(const AdvertisingKey& other) const {
   return address == other.address && sid == other.sid;
 }
 
+size_t LeScanningReassembler::AdvertisingKey::Hash() const {
+  uint64_t value = 0;
+  if (address.has_value()) {
+    for (uint8_t byte : address->GetAddress().address) {
+      value = (value << 8) | byte;
+    }
+    value |= uint64_t{static_cast<uint8_t>(address->GetAddressType()) + 1u} << 48;
+  }
+  if (sid.has_value()) {
+    value |= uint64_t{*sid + 1u} << 56;
+  }
+  // Fibonacci hashing, so that the index does not depend on the low
+  // address bytes alone.
+  return static_cast<size_t>((value * 0x9e3779b97f4a7c15ull) >> 32);
+}
+
 /// Append to the current advertising data of the selected advertiser.
 /// If the advertiser is unknown a new entry is added, optionally by
-/// dropping the oldest advertiser.
-std::list<LeScanningReassembler::AdvertisingFragment>::iterator
-LeScanningReassembler::AppendFragment(const AdvertisingKey& key, const std::vector<uint8_t>& data) {
-  auto it = FindFragment(key);
-  if (it != cache_.end()) {
-    it->data.insert(it->data.end(), data.cbegin(), data.cend());
-    return it;
+/// evicting the least recently updated advertiser.
+LeScanningReassembler::AdvertisingFragment& LeScanningReassembler::AppendFragment(
+    const AdvertisingKey& key, const std::vector<uint8_t>& data) {
+  size_t hash = key.Hash();
+  size_t bucket;
+  uint16_t fragment = FindFragment(key, hash, &bucket);
+  if (fragment != kInvalidIndex) {
+    fragments_[fragment].data.insert(fragments_[fragment].data.end(), data.cbegin(), data.cend());
+    Unlink(fragment);
+    LinkFront(fragment);
+    return fragments_[fragment];
   }
 
-  if (cache_.size() > kMaximumCacheSize) {
-    cache_.pop_back();
+  if (free_head_ == kInvalidIndex) {
+    uint16_t oldest = lru_tail_;
+    size_t oldest_bucket;
+    FindFragment(fragments_[oldest].key, fragments_[oldest].hash, &oldest_bucket);
+    stats_.evictions++;
+    if (!fragments_[oldest].complete) {
+      stats_.incomplete_chains++;
+    }
+    ReleaseFragment(oldest, oldest_bucket);
+    // The release may have shifted the empty bucket found for the key.
+    FindFragment(key, hash, &bucket);
   }
 
-  cache_.emplace_front(key, data);
-  return cache_.begin();
+  fragment = free_head_;
+  free_head_ = fragments_[fragment].next;
+  fragments_[fragment].key = key;
+  fragments_[fragment].hash = hash;
+  fragments_[fragment].complete = false;
+  fragments_[fragment].data.assign(data.cbegin(), data.cend());
+  index_[bucket] = fragment;
+  LinkFront(fragment);
+  return fragments_[fragment];
 }
 
 void LeScanningReassembler::RemoveFragment(const AdvertisingKey& key) {
-  auto it = FindFragment(key);
-  if (it != cache_.end()) {
-    cache_.erase(it);
+  size_t bucket;
+  uint16_t fragment = FindFragment(key, key.Hash(), &bucket);
+  if (fragment != kInvalidIndex) {
+    ReleaseFragment(fragment, bucket);
   }
 }
 
 bool LeScanningReassembler::ContainsFragment(const AdvertisingKey& key) {
-  return FindFragment(key) != cache_.end();
+  size_t bucket;
+  return FindFragment(key, key.Hash(), &bucket) != kInvalidIndex;
 }
 
-std::list<LeScanningReassembler::AdvertisingFragment>::iterator LeScanningReassembler::FindFragment(
-    const AdvertisingKey& key) {
-  for (auto it = cache_.begin(); it != cache_.end(); it++) {
-    if (it->key == key) {
-      return it;
+/// Return the fragment matching the key, and the index bucket that
+/// points to it. If the key is unknown, return kInvalidIndex and the
+/// empty bucket where it would be inserted.
+uint16_t LeScanningReassembler::FindFragment(const AdvertisingKey& key, size_t hash, size_t* bucket) {
+  constexpr size_t kMask = kIndexSize - 1;
+  for (size_t i = hash & kMask;; i = (i + 1) & kMask) {
+    uint16_t fragment = index_[i];
+    if (fragment == kInvalidIndex ||
+        (fragments_[fragment].hash == hash && fragments_[fragment].key == key)) {
+      *bucket = i;
+      return fragment;
     }
   }
-  return cache_.end();
+}
+
+/// Return the fragment to the free list. The data buffer is cleared but
+/// keeps its capacity for the next advertiser.
+void LeScanningReassembler::ReleaseFragment(uint16_t fragment, size_t bucket) {
+  // Backward shift deletion: the entries that follow in the probe sequence
+  // are moved up, unless the hole lies before their home bucket.
+  constexpr size_t kMask = kIndexSize - 1;
+  size_t hole = bucket;
+  for (size_t i = (hole + 1) & kMask; index_[i] != kInvalidIndex; i = (i + 1) & kMask) {
+    size_t home = fragments_[index_[i]].hash & kMask;
+    if (((i - home) & kMask) >= ((i - hole) & kMask)) {
+      index_[hole] = index_[i];
+      hole = i;
+    }
+  }
+  index_[hole] = kInvalidIndex;
+
+  Unlink(fragment);
+  fragments_[fragment].key = AdvertisingKey();
+  fragments_[fragment].data.clear();
+  fragments_[fragment].next = free_head_;
+  free_head_ = fragment;
+}
+
+void LeScanningReassembler::LinkFront(uint16_t fragment) {
+  fragments_[fragment].prev = kInvalidIndex;
+  fragments_[fragment].next = lru_head_;
+  if (lru_head_ != kInvalidIndex) {
+    fragments_[lru_head_].prev = fragment;
+  }
+  lru_head_ = fragment;
+  if (lru_tail_ == kInvalidIndex) {
+    lru_tail_ = fragment;
+  }
+}
+
+void LeScanningReassembler::Unlink(uint16_t fragment) {
+  uint16_t prev = fragments_[fragment].prev;
+  uint16_t next = fragments_[fragment].next;
+  if (prev != kInvalidIndex) {
+    fragments_[prev].next = next;
+  } else {
+    lru_head_ = next;
+  }
+  if (next != kInvalidIndex) {
+    fragments_[next].prev = prev;
+  } else {
+    lru_tail_ = prev;
+  }
+  fragments_[fragment].prev = kInvalidIndex;
+  fragments_[fragment].next = kInvalidIndex;
 }
 
 }  // namespace bluetooth::hci
@@ -17,8 +17,8 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <array>
 #include <cstdint>
-#include <list>
 #include <optional>
 #include <vector>
 
@@ -35,7 +35,7 @@ namespace bluetooth::hci {
 
 class LeScanningReassembler {
  public:
-  LeScanningReassembler(){};
+  LeScanningReassembler();
   LeScanningReassembler(const LeScanningReassembler&) = delete;
   LeScanningReassembler& operator=(const LeScanningReassembler&) = delete;
 
@@ -57,6 +57,19 @@ class LeScanningReassembler {
     ignore_scan_responses_ = ignore_scan_responses;
   }
 
+  /// Advertising cache statistics.
+  struct Stats {
+    /// Cached advertisements dropped to make room for another advertiser.
+    uint64_t evictions{0};
+    /// Fragment chains that never completed: evicted while more fragments
+    /// were expected, or truncated by the controller.
+    uint64_t incomplete_chains{0};
+  };
+
+  const Stats& GetStats() const {
+    return stats_;
+  }
+
  private:
   /// Determine if scan responses should be processed or ignored.
   bool ignore_scan_responses_{false};
@@ -82,39 +95,64 @@ class LeScanningReassembler {
     std::optional<AddressWithType> address;
     std::optional<uint8_t> sid;
 
+    AdvertisingKey() = default;
     AdvertisingKey(Address address, DirectAdvertisingAddressType address_type, uint8_t sid);
-    bool operator==(const AdvertisingKey& other);
+    bool operator==(const AdvertisingKey& other) const;
+    size_t Hash() const;
   };
 
   /// Packs incomplete advertising data.
+  /// The fragments are preallocated, and the data buffers keep their
+  /// capacity when released, so that steady state reassembly does not
+  /// allocate.
   struct AdvertisingFragment {
     AdvertisingKey key;
+    size_t hash{0};
     std::vector<uint8_t> data;
-
-    AdvertisingFragment(const AdvertisingKey& key, const std::vector<uint8_t>& data)
-        : key(key), data(data.begin(), data.end()) {}
+    /// False while more fragments of the advertising data are expected.
+    bool complete{false};
+    /// Links of the LRU list of used fragments, or of the free list.
+    uint16_t prev{kInvalidIndex};
+    uint16_t next{kInvalidIndex};
   };
 
   /// Advertising cache for de-fragmenting extended advertising reports,
   /// and joining advertising reports with the matching scan response when
   /// applicable.
   /// The cached advertising data is removed as soon as the complete
-  /// advertisement is got (including the scan response).
-  static constexpr size_t kMaximumCacheSize = 16;
-  std::list<AdvertisingFragment> cache_;
+  /// advertisement is got (including the scan response). When the cache is
+  /// full the least recently updated advertisement is evicted.
+  static constexpr size_t kMaximumCacheSize = 64;
+  static constexpr uint16_t kInvalidIndex = 0xffff;
+  std::array<AdvertisingFragment, kMaximumCacheSize> fragments_;
+  uint16_t lru_head_{kInvalidIndex};
+  uint16_t lru_tail_{kInvalidIndex};
+  uint16_t free_head_{kInvalidIndex};
+
+  /// Open addressing index of the used fragments, with linear probing.
+  /// Kept at most half full so that probe sequences stay short.
+  static constexpr size_t kIndexSize = 2 * kMaximumCacheSize;
+  static_assert((kIndexSize & (kIndexSize - 1)) == 0, "kIndexSize must be a power of two");
+  std::array<uint16_t, kIndexSize> index_;
+
+  Stats stats_;
 
   /// Advertising cache management methods.
-  std::list<AdvertisingFragment>::iterator AppendFragment(
-      const AdvertisingKey& key, const std::vector<uint8_t>& data);
+  AdvertisingFragment& AppendFragment(const AdvertisingKey& key, const std::vector<uint8_t>& data);
   void RemoveFragment(const AdvertisingKey& key);
   bool ContainsFragment(const AdvertisingKey& key);
-  std::list<AdvertisingFragment>::iterator FindFragment(const AdvertisingKey& key);
+  uint16_t FindFragment(const AdvertisingKey& key, size_t hash, size_t* bucket);
+  void ReleaseFragment(uint16_t fragment, size_t bucket);
+  void LinkFront(uint16_t fragment);
+  void Unlink(uint16_t fragment);
 
   /// Trim the advertising data by removing empty or overflowing
   /// GAP Data entries.
   static std::vector<uint8_t> TrimAdvertisingData(const std::vector<uint8_t>& advertising_data);
+  static void TrimAdvertisingDataInPlace(std::vector<uint8_t>& advertising_data);
 
   FRIEND_TEST(LeScanningReassemblerTest, trim_advertising_data);
+  FRIEND_TEST(LeScanningReassemblerTest, cache_stats);
 };
 
 }  // namespace bluetooth::hci
@@ -324,4 +324,73 @@ TEST_F(LeScanningReassemblerTest, interleaved_advertising) {
       std::vector<uint8_t>({0x2, 0x3, 0x3}));
 }
 
+TEST_F(LeScanningReassemblerTest, cache_stats) {
+  // Fill the cache with incomplete advertising data.
+  for (size_t i = 0; i < LeScanningReassembler::kMaximumCacheSize; i++) {
+    Address address({0, 1, 2, 3, 6, static_cast<uint8_t>(i + 1)});
+    ASSERT_FALSE(reassembler_
+                     .ProcessAdvertisingReport(
+                         kContinuation,
+                         (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                         address,
+                         kSidNotPresent,
+                         {0x2, 0x0})
+                     .has_value());
+  }
+
+  // Refresh the oldest advertiser, the second oldest becomes the least
+  // recently used.
+  Address first_address({0, 1, 2, 3, 6, 1});
+  Address second_address({0, 1, 2, 3, 6, 2});
+  ASSERT_FALSE(reassembler_
+                   .ProcessAdvertisingReport(
+                       kContinuation,
+                       (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                       first_address,
+                       kSidNotPresent,
+                       {0x1})
+                   .has_value());
+
+  // A new advertiser evicts the least recently used one.
+  ASSERT_EQ(
+      reassembler_.ProcessAdvertisingReport(
+          kComplete,
+          (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+          kTestAddress,
+          kSidNotPresent,
+          {0x1, 0x2}),
+      std::vector<uint8_t>({0x1, 0x2}));
+  ASSERT_EQ(reassembler_.GetStats().evictions, 1u);
+  ASSERT_EQ(reassembler_.GetStats().incomplete_chains, 1u);
+
+  ASSERT_EQ(
+      reassembler_.ProcessAdvertisingReport(
+          kComplete,
+          (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+          first_address,
+          kSidNotPresent,
+          {0x1, 0x2}),
+      std::vector<uint8_t>({0x2, 0x0, 0x1, 0x1, 0x2}));
+  ASSERT_EQ(
+      reassembler_.ProcessAdvertisingReport(
+          kComplete,
+          (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+          second_address,
+          kSidNotPresent,
+          {0x1, 0x3}),
+      std::vector<uint8_t>({0x1, 0x3}));
+
+  // Truncated advertising data is also an incomplete chain.
+  ASSERT_EQ(
+      reassembler_.ProcessAdvertisingReport(
+          kTruncated,
+          (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+          kTestAddress,
+          kSidNotPresent,
+          {0x1, 0x4}),
+      std::vector<uint8_t>({0x1, 0x4}));
+  ASSERT_EQ(reassembler_.GetStats().evictions, 1u);
+  ASSERT_EQ(reassembler_.GetStats().incomplete_chains, 2u);
+}
+
 }  // namespace bluetooth::hci
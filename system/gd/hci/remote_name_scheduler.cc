@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/remote_name_scheduler.h"
+
+namespace bluetooth::hci {
+
+// Weight of one dB of RSSI, in milliseconds of recency
+constexpr int64_t kMillisecondsPerDb = 1000;
+
+void RemoteNameScheduler::Add(const RemoteNameCandidate& candidate, Clock::time_point seen) {
+  int64_t priority = GetPriority(candidate.rssi, seen);
+  auto it = candidates_.find(candidate.address);
+  if (it != candidates_.end()) {
+    queue_.erase({it->second.priority, candidate.address});
+    it->second = {candidate, priority};
+    stats_.updated++;
+  } else {
+    candidates_.emplace(candidate.address, Entry{candidate, priority});
+    stats_.scheduled++;
+  }
+  queue_.emplace(priority, candidate.address);
+}
+
+void RemoteNameScheduler::Remove(const Address& address) {
+  auto it = candidates_.find(address);
+  if (it == candidates_.end()) {
+    return;
+  }
+  queue_.erase({it->second.priority, address});
+  candidates_.erase(it);
+}
+
+std::optional<RemoteNameCandidate> RemoteNameScheduler::Next() {
+  if (queue_.empty()) {
+    return std::nullopt;
+  }
+  auto it = candidates_.find(queue_.begin()->second);
+  queue_.erase(queue_.begin());
+  RemoteNameCandidate candidate = std::move(it->second.candidate);
+  candidates_.erase(it);
+  stats_.started++;
+  return candidate;
+}
+
+void RemoteNameScheduler::Clear() {
+  candidates_.clear();
+  queue_.clear();
+}
+
+// The age of all the candidates grows at the same rate, so ranking by the
+// time they were seen gives the same order at any later time.
+int64_t RemoteNameScheduler::GetPriority(int8_t rssi, Clock::time_point seen) {
+  int64_t seen_ms = std::chrono::duration_cast<std::chrono::milliseconds>(seen.time_since_epoch()).count();
+  return seen_ms + int64_t{rssi} * kMillisecondsPerDb;
+}
+
+}  // namespace bluetooth::hci
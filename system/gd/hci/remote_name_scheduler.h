@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+
+namespace bluetooth::hci {
+
+/// A device found by an inquiry, whose name is to be resolved.
+struct RemoteNameCandidate {
+  Address address;
+  int8_t rssi{0};
+  PageScanRepetitionMode page_scan_repetition_mode{PageScanRepetitionMode::R1};
+  uint16_t clock_offset{0};
+  ClockOffsetValid clock_offset_valid{ClockOffsetValid::INVALID};
+  /// Complete local name found in the extended inquiry response, if any.
+  std::optional<std::array<uint8_t, 248>> eir_name;
+};
+
+/// The remote name scheduler orders the remote name requests sent after an
+/// inquiry. The controller pages one device at a time, so the devices most
+/// likely to answer quickly go first: the strongest RSSI, and the most
+/// recently seen. A candidate seen one second later is worth one more dB.
+class RemoteNameScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats {
+    uint64_t scheduled{0};
+    /// Candidates reported again before their request was sent.
+    uint64_t updated{0};
+    uint64_t started{0};
+  };
+
+  /// Add a candidate seen at |seen|, or update it if already scheduled.
+  void Add(const RemoteNameCandidate& candidate, Clock::time_point seen);
+
+  /// Remove a candidate, e.g. when its name was found in the meantime.
+  void Remove(const Address& address);
+
+  /// Remove and return the candidate to resolve next.
+  std::optional<RemoteNameCandidate> Next();
+
+  bool Contains(const Address& address) const {
+    return candidates_.count(address) != 0;
+  }
+  size_t Size() const {
+    return candidates_.size();
+  }
+  bool IsEmpty() const {
+    return candidates_.empty();
+  }
+  void Clear();
+
+  const Stats& GetStats() const {
+    return stats_;
+  }
+
+ private:
+  /// Higher first, ties broken by address to keep the keys unique.
+  using Priority = std::pair<int64_t, Address>;
+
+  struct Entry {
+    RemoteNameCandidate candidate;
+    int64_t priority;
+  };
+
+  static int64_t GetPriority(int8_t rssi, Clock::time_point seen);
+
+  std::unordered_map<Address, Entry> candidates_;
+  std::set<Priority, std::greater<Priority>> queue_;
+  Stats stats_;
+};
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/remote_name_scheduler.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace bluetooth::hci {
+
+static const Address kAddress1 = Address({0, 1, 2, 3, 4, 1});
+static const Address kAddress2 = Address({0, 1, 2, 3, 4, 2});
+static const Address kAddress3 = Address({0, 1, 2, 3, 4, 3});
+
+class RemoteNameSchedulerTest : public ::testing::Test {
+ protected:
+  void Add(const Address& address, int8_t rssi) {
+    RemoteNameCandidate candidate;
+    candidate.address = address;
+    candidate.rssi = rssi;
+    scheduler_.Add(candidate, now_);
+  }
+
+  Address Next() {
+    auto candidate = scheduler_.Next();
+    EXPECT_TRUE(candidate.has_value());
+    return candidate.has_value() ? candidate->address : Address::kEmpty;
+  }
+
+  RemoteNameScheduler scheduler_;
+  RemoteNameScheduler::Clock::time_point now_ = RemoteNameScheduler::Clock::now();
+};
+
+TEST_F(RemoteNameSchedulerTest, strongest_candidate_goes_first) {
+  Add(kAddress1, -80);
+  Add(kAddress2, -40);
+  Add(kAddress3, -60);
+  ASSERT_EQ(scheduler_.Size(), 3u);
+  ASSERT_EQ(Next(), kAddress2);
+  ASSERT_EQ(Next(), kAddress3);
+  ASSERT_EQ(Next(), kAddress1);
+  ASSERT_FALSE(scheduler_.Next().has_value());
+  ASSERT_EQ(scheduler_.GetStats().started, 3u);
+}
+
+TEST_F(RemoteNameSchedulerTest, recent_candidate_outranks_slightly_stronger_one) {
+  Add(kAddress1, -50);
+  now_ += 5s;
+  Add(kAddress2, -53);
+  now_ += 10s;
+  Add(kAddress3, -70);
+  ASSERT_EQ(Next(), kAddress2);
+  ASSERT_EQ(Next(), kAddress1);
+  ASSERT_EQ(Next(), kAddress3);
+}
+
+TEST_F(RemoteNameSchedulerTest, candidate_seen_again_is_updated) {
+  Add(kAddress1, -50);
+  Add(kAddress2, -60);
+  Add(kAddress2, -40);
+  ASSERT_EQ(scheduler_.Size(), 2u);
+  ASSERT_EQ(scheduler_.GetStats().scheduled, 2u);
+  ASSERT_EQ(scheduler_.GetStats().updated, 1u);
+  ASSERT_EQ(Next(), kAddress2);
+  ASSERT_EQ(Next(), kAddress1);
+}
+
+TEST_F(RemoteNameSchedulerTest, removed_candidate_is_not_resolved) {
+  Add(kAddress1, -50);
+  Add(kAddress2, -60);
+  scheduler_.Remove(kAddress1);
+  scheduler_.Remove(kAddress3);
+  ASSERT_FALSE(scheduler_.Contains(kAddress1));
+  ASSERT_EQ(Next(), kAddress2);
+  ASSERT_TRUE(scheduler_.IsEmpty());
+
+  Add(kAddress3, -50);
+  scheduler_.Clear();
+  ASSERT_FALSE(scheduler_.Next().has_value());
+}
+
+}  // namespace bluetooth::hci
@@ -15,6 +15,8 @@
  */
 #include "hci/vendor_specific_event_manager.h"
 
+#include <array>
+
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
@@ -43,15 +45,19 @@ struct VendorSpecificEventManager::impl {
 
   void register_event(VseSubeventCode event, common::ContextualCallback<void(VendorSpecificEventView)> handler) {
     ASSERT_LOG(
-        subevent_handlers_.count(event) == 0,
+        subevent_handler(event).IsEmpty(),
         "Can not register a second handler for %02hhx (%s)",
         event,
         VseSubeventCodeText(event).c_str());
-    subevent_handlers_[event] = handler;
+    subevent_handler(event) = handler;
   }
 
   void unregister_event(VseSubeventCode event) {
-    subevent_handlers_.erase(subevent_handlers_.find(event));
+    subevent_handler(event) = {};
+  }
+
+  common::ContextualCallback<void(VendorSpecificEventView)>& subevent_handler(VseSubeventCode event) {
+    return subevent_handlers_[static_cast<uint8_t>(event)];
   }
 
   bool check_event_supported(VseSubeventCode event) {
@@ -82,11 +88,12 @@ struct VendorSpecificEventManager::impl {
     auto vendor_specific_event_view = VendorSpecificEventView::Create(event_view);
     ASSERT(vendor_specific_event_view.IsValid());
     VseSubeventCode vse_subevent_code = vendor_specific_event_view.GetSubeventCode();
-    if (subevent_handlers_.find(vse_subevent_code) == subevent_handlers_.end()) {
+    auto& handler = subevent_handler(vse_subevent_code);
+    if (handler.IsEmpty()) {
       LOG_WARN("Unhandled vendor specific event of type 0x%02hhx", vse_subevent_code);
       return;
     }
-    subevent_handlers_[vse_subevent_code].Invoke(vendor_specific_event_view);
+    handler.Invoke(vendor_specific_event_view);
   }
 
   Module* module_;
@@ -94,7 +101,8 @@ struct VendorSpecificEventManager::impl {
   hci::HciLayer* hci_layer_;
   hci::Controller* controller_;
   Controller::VendorCapabilities vendor_capabilities_;
-  std::map<VseSubeventCode, common::ContextualCallback<void(VendorSpecificEventView)>> subevent_handlers_;
+  // Indexed by the one byte subevent code, empty when not registered
+  std::array<common::ContextualCallback<void(VendorSpecificEventView)>, 256> subevent_handlers_;
 };
 
 VendorSpecificEventManager::VendorSpecificEventManager() {
@@ -172,7 +172,7 @@ class IsoModuleFacadeService : public IsoModuleFacade::Service {
       const ::bluetooth::iso::IsoPacket* request,
       ::google::protobuf::Empty* /* response */) override {
     std::vector<uint8_t> packet(request->payload().begin(), request->payload().end());
-    iso_module_->GetIsoManager()->SendIsoPacket(request->handle(), packet);
+    iso_module_->GetIsoManager()->SendIsoPacket(request->handle(), std::move(packet));
     return ::grpc::Status::OK;
   }
 
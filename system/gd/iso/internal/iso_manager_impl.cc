@@ -22,7 +22,7 @@
 #include "iso/iso_manager.h"
 #include "os/handler.h"
 #include "os/log.h"
-#include "packet/raw_builder.h"
+#include "packet/scatter_gather_builder.h"
 
 namespace bluetooth {
 namespace iso {
@@ -251,14 +251,18 @@ void IsoManagerImpl::RemoveCigComplete(hci::CommandCompleteView command_complete
 }
 
 void IsoManagerImpl::SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet) {
+  SendIsoPacket(cis_handle, std::make_shared<const std::vector<uint8_t>>(std::move(packet)));
+}
+
+void IsoManagerImpl::SendIsoPacket(uint16_t cis_handle, std::shared_ptr<const std::vector<uint8_t>> packet) {
+  uint16_t iso_sdu_length = packet->size();
   auto builder = hci::IsoWithoutTimestampBuilder::Create(
       cis_handle,
       hci::IsoPacketBoundaryFlag::COMPLETE_SDU,
       0 /* sequence_number */,
-      packet.size() /* iso_sdu_length */,
+      iso_sdu_length,
       hci::IsoPacketStatusFlag::VALID,
-      std::make_unique<bluetooth::packet::RawBuilder>(packet));
-  LOG_INFO("%c%c", packet[0], packet[1]);
+      std::make_unique<bluetooth::packet::ScatterGatherBuilder>(std::move(packet)));
   iso_enqueue_buffer_->Enqueue(std::move(builder), iso_handler_);
 }
 
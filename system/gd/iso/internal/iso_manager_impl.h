@@ -22,6 +22,8 @@
 #include "os/handler.h"
 
 #include <list>
+#include <memory>
+#include <vector>
 
 namespace bluetooth {
 namespace iso {
@@ -95,6 +97,7 @@ class IsoManagerImpl {
   void RemoveCigComplete(hci::CommandCompleteView command_complete);
 
   void SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet);
+  void SendIsoPacket(uint16_t cis_handle, std::shared_ptr<const std::vector<uint8_t>> packet);
   void OnIncomingPacket();
 
   bool IsKnownCig(uint8_t cig_id) {
@@ -97,7 +97,16 @@ void IsoManager::RemoveCig(uint8_t cig_id) {
 }
 
 void IsoManager::SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet) {
-  iso_handler_->CallOn(iso_manager_impl_, &internal::IsoManagerImpl::SendIsoPacket, cis_handle, packet);
+  SendIsoPacket(cis_handle, std::make_shared<const std::vector<uint8_t>>(std::move(packet)));
+}
+
+void IsoManager::SendIsoPacket(uint16_t cis_handle, std::shared_ptr<const std::vector<uint8_t>> packet) {
+  iso_handler_->CallOn(
+      iso_manager_impl_,
+      static_cast<void (internal::IsoManagerImpl::*)(uint16_t, std::shared_ptr<const std::vector<uint8_t>>)>(
+          &internal::IsoManagerImpl::SendIsoPacket),
+      cis_handle,
+      std::move(packet));
 }
 
 }  // namespace iso
@@ -75,6 +75,9 @@ class IsoManager {
   void RemoveCig(uint8_t cig_id);
 
   void SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet);
+  // Send an SDU held by its producer: the ISO packet refers to |packet| until it is serialized for the HAL, the bytes
+  // are not copied before that. |packet| must not be modified once handed over.
+  void SendIsoPacket(uint16_t cis_handle, std::shared_ptr<const std::vector<uint8_t>> packet);
 
  protected:
   IsoManager(os::Handler* iso_handler, internal::IsoManagerImpl* iso_manager_impl)
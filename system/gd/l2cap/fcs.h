@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace bluetooth {
@@ -28,8 +29,15 @@ class Fcs {
 
   void AddByte(uint8_t byte);
 
+  // Same result as AddByte on each byte, computed eight bytes at a time.
+  void AddBytes(const uint8_t* data, size_t length);
+
   uint16_t GetChecksum() const;
 
+  // Continue the checksum |crc| over |length| bytes. Shared with the legacy
+  // stack, which keeps its FCS in a plain uint16_t.
+  static uint16_t Update(uint16_t crc, const uint8_t* data, size_t length);
+
  private:
   uint16_t crc;
 };
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/fcs.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+
+namespace {
+
+std::vector<uint8_t> MakeFrame(size_t size) {
+  std::vector<uint8_t> frame(size);
+  for (size_t i = 0; i < size; i++) {
+    frame[i] = static_cast<uint8_t>(i);
+  }
+  return frame;
+}
+
+}  // namespace
+
+// FCS of an I-frame one byte at a time, the way it was computed for every frame
+void BM_FcsAddByte(State& state) {
+  auto frame = MakeFrame(state.range(0));
+  for (auto _ : state) {
+    Fcs fcs;
+    fcs.Initialize();
+    for (uint8_t byte : frame) {
+      fcs.AddByte(byte);
+    }
+    benchmark::DoNotOptimize(fcs.GetChecksum());
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+
+void BM_FcsAddBytes(State& state) {
+  auto frame = MakeFrame(state.range(0));
+  for (auto _ : state) {
+    Fcs fcs;
+    fcs.Initialize();
+    fcs.AddBytes(frame.data(), frame.size());
+    benchmark::DoNotOptimize(fcs.GetChecksum());
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+
+BENCHMARK(BM_FcsAddByte)->Arg(8)->Arg(251)->Arg(1021);
+BENCHMARK(BM_FcsAddBytes)->Arg(8)->Arg(251)->Arg(1021);
+
+}  // namespace l2cap
+}  // namespace bluetooth
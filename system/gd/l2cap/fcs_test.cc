@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/fcs.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace bluetooth {
+namespace l2cap {
+namespace {
+
+// Receiver Ready S-frame followed by its FCS
+const std::vector<uint8_t> kRrFrame = {0x04, 0x00, 0x40, 0x00, 0x01, 0x01};
+constexpr uint16_t kRrFrameFcs = 0x14d4;
+
+uint16_t BytewiseChecksum(const std::vector<uint8_t>& bytes, size_t begin, size_t end) {
+  Fcs fcs;
+  fcs.Initialize();
+  for (size_t i = begin; i < end; i++) {
+    fcs.AddByte(bytes[i]);
+  }
+  return fcs.GetChecksum();
+}
+
+TEST(L2capFcsTest, add_byte) {
+  ASSERT_EQ(BytewiseChecksum(kRrFrame, 0, kRrFrame.size()), kRrFrameFcs);
+}
+
+TEST(L2capFcsTest, add_bytes) {
+  Fcs fcs;
+  fcs.Initialize();
+  fcs.AddBytes(kRrFrame.data(), kRrFrame.size());
+  ASSERT_EQ(fcs.GetChecksum(), kRrFrameFcs);
+}
+
+TEST(L2capFcsTest, add_bytes_matches_add_byte) {
+  std::vector<uint8_t> bytes;
+  for (size_t i = 0; i < 1030; i++) {
+    bytes.push_back(static_cast<uint8_t>(i * 31 + 7));
+  }
+  // Every length around the eight byte steps, starting at unaligned offsets
+  for (size_t begin = 0; begin < 8; begin++) {
+    for (size_t end = begin; end < begin + 40; end++) {
+      Fcs fcs;
+      fcs.Initialize();
+      fcs.AddBytes(bytes.data() + begin, end - begin);
+      ASSERT_EQ(fcs.GetChecksum(), BytewiseChecksum(bytes, begin, end)) << begin << " " << end;
+    }
+  }
+  ASSERT_EQ(Fcs::Update(0, bytes.data(), bytes.size()), BytewiseChecksum(bytes, 0, bytes.size()));
+}
+
+TEST(L2capFcsTest, add_bytes_in_pieces) {
+  std::vector<uint8_t> bytes(100, 0xa5);
+  Fcs fcs;
+  fcs.Initialize();
+  fcs.AddBytes(bytes.data(), 13);
+  fcs.AddByte(bytes[13]);
+  fcs.AddBytes(bytes.data() + 14, bytes.size() - 14);
+  ASSERT_EQ(fcs.GetChecksum(), BytewiseChecksum(bytes, 0, bytes.size()));
+}
+
+}  // namespace
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_allocations.h"
+#include "common/bidi_queue.h"
+#include "l2cap/internal/basic_mode_channel_data_controller.h"
+#include "l2cap/internal/ilink.h"
+#include "l2cap/internal/le_credit_based_channel_data_controller.h"
+#include "l2cap/internal/scheduler.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+namespace {
+
+constexpr Cid kCid = 0x41;
+// MPS of an LE link with the largest LE data length
+constexpr uint16_t kLeMps = 247;
+
+class NullLink : public ILink {
+ public:
+  void SendDisconnectionRequest(Cid /* local_cid */, Cid /* remote_cid */) override {}
+  hci::AddressWithType GetDevice() const override {
+    return {};
+  }
+};
+
+// Counts the PDUs a data controller has ready, the way the scheduler does
+class CountingScheduler : public Scheduler {
+ public:
+  void OnPacketsReady(Cid /* cid */, int number_packets) override {
+    ready_ += number_packets;
+  }
+  int ready_ = 0;
+};
+
+// Drives the transmit path of a data controller up to the bytes that the HCI
+// layer hands over to the HAL: SDUs from the channel queue are segmented into
+// PDUs, and each PDU is serialized into its own buffer.
+class DataControllerBenchmark {
+ public:
+  DataControllerBenchmark() : thread_("l2cap_benchmark_thread", os::Thread::Priority::NORMAL), handler_(&thread_) {}
+  ~DataControllerBenchmark() {
+    handler_.Clear();
+  }
+
+  // |on_sent| is given the number of PDUs that went out for each SDU
+  template <typename OnSent>
+  void Run(State& state, DataController* controller, OnSent on_sent) {
+    std::vector<uint8_t> payload(state.range(0));
+    for (size_t i = 0; i < payload.size(); i++) {
+      payload[i] = static_cast<uint8_t>(i);
+    }
+    AllocationCounter counter(state, "allocs_per_sdu");
+    for (auto _ : state) {
+      controller->OnSdu(std::make_unique<packet::RawBuilder>(payload));
+      int sent = scheduler_.ready_;
+      for (; scheduler_.ready_ > 0; scheduler_.ready_--) {
+        auto pdu = controller->GetNextPacket();
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        bytes->reserve(pdu->size());
+        packet::BitInserter it(*bytes);
+        pdu->Serialize(it);
+        ::benchmark::DoNotOptimize(bytes->data());
+      }
+      on_sent(sent);
+    }
+    state.SetBytesProcessed(state.iterations() * payload.size());
+  }
+
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue_{10};
+  CountingScheduler scheduler_;
+  NullLink link_;
+  os::Thread thread_;
+  os::Handler handler_;
+};
+
+}  // namespace
+
+void BM_BasicModeTransmit(State& state) {
+  DataControllerBenchmark benchmark;
+  BasicModeDataController controller{
+      kCid, kCid, benchmark.channel_queue_.GetDownEnd(), &benchmark.handler_, &benchmark.scheduler_};
+  benchmark.Run(state, &controller, [](int /* sent */) {});
+}
+
+// Segmentation of SDUs in PDUs of kLeMps bytes, with the peer returning
+// credits as fast as the PDUs go out
+void BM_LeCreditBasedTransmit(State& state) {
+  DataControllerBenchmark benchmark;
+  LeCreditBasedDataController controller{
+      &benchmark.link_, kCid, kCid, benchmark.channel_queue_.GetDownEnd(), &benchmark.handler_, &benchmark.scheduler_};
+  controller.SetMtu(0xffff);
+  controller.SetMps(kLeMps);
+  controller.OnCredit(0x7fff);
+  benchmark.Run(state, &controller, [&controller](int sent) { controller.OnCredit(sent); });
+}
+
+BENCHMARK(BM_BasicModeTransmit)->Arg(64)->Arg(672)->Arg(4096);
+BENCHMARK(BM_LeCreditBasedTransmit)->Arg(64)->Arg(672)->Arg(4096);
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
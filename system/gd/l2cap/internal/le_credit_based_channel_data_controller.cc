@@ -18,18 +18,33 @@
 
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/le/internal/link.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/scatter_gather_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
 namespace internal {
 
+namespace {
+constexpr uint16_t kMaxPeerCredits = 0xffff;
+}  // namespace
+
 LeCreditBasedDataController::LeCreditBasedDataController(ILink* link, Cid cid, Cid remote_cid,
                                                          UpperQueueDownEnd* channel_queue_end, os::Handler* handler,
                                                          Scheduler* scheduler)
     : cid_(cid), remote_cid_(remote_cid), enqueue_buffer_(channel_queue_end), handler_(handler), scheduler_(scheduler),
-      link_(link) {}
+      link_(link) {
+  credit_policy_.Configure(0, kMaxPeerCredits, mps_, LeCreditPolicy::kDefaultMaxBufferedBytes);
+  enqueue_buffer_.NotifyOnEnqueue(
+      common::Bind(&LeCreditBasedDataController::on_sdu_enqueued, common::Unretained(this)));
+}
+
+LeCreditBasedDataController::~LeCreditBasedDataController() {
+  const auto& stats = credit_policy_.GetStats();
+  if (stats.starved_intervals > 0) {
+    LOG_INFO("cid 0x%04x: peer ran out of credits %u times, for %d ms", cid_, stats.starved_intervals,
+             static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(stats.starved_time).count()));
+  }
+}
 
 void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
   auto sdu_size = sdu->size();
@@ -40,11 +55,9 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
   if (sdu_size > mtu_) {
     LOG_WARN("Received sdu_size %d > mtu %d", static_cast<int>(sdu_size), mtu_);
   }
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
   // TODO: We don't need to waste 2 bytes for continuation segment.
-  packet::FragmentingInserter fragmenting_inserter(mps_ - 2, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
+  // The segments share the bytes of the SDU, which are serialized only once
+  auto segments = packet::ScatterGatherBuilder::Fragment(*sdu, mps_ - 2);
   std::unique_ptr<BasicFrameBuilder> builder;
   builder = FirstLeInformationFrameBuilder::Create(remote_cid_, sdu_size, std::move(segments[0]));
   pdu_queue_.emplace(std::move(builder));
@@ -65,40 +78,64 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
 }
 
 void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
+  if (peer_credits_ == 0) {
+    LOG_WARN("Received frame while the peer has no credit");
+  } else {
+    peer_credits_--;
+  }
+  size_t length = 0;
   auto basic_frame_view = BasicFrameView::Create(pdu);
   if (!basic_frame_view.IsValid()) {
     LOG_WARN("Received invalid frame");
-    return;
-  }
-  if (basic_frame_view.size() > mps_) {
+  } else if (basic_frame_view.size() > mps_) {
     LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(basic_frame_view.size()), mps_);
-    return;
+  } else {
+    length = reassemble(basic_frame_view);
   }
+  credit_policy_.OnPduReceived(length, peer_credits_, LeCreditPolicy::Clock::now());
+  if (remaining_sdu_continuation_packet_size_ == 0 && length > 0) {
+    enqueue_buffer_.Enqueue(std::make_unique<PacketView<kLittleEndian>>(reassembly_stage_), handler_);
+  } else if (remaining_sdu_continuation_packet_size_ < 0 || reassembly_stage_.size() > mtu_) {
+    LOG_WARN("Received larger SDU size than expected");
+    credit_policy_.OnConsumed(reassembly_stage_.size(), LeCreditPolicy::Clock::now());
+    reassembly_stage_ = PacketViewForReassembly(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
+    remaining_sdu_continuation_packet_size_ = 0;
+    link_->SendDisconnectionRequest(cid_, remote_cid_);
+  }
+  send_credits_if_needed();
+}
+
+size_t LeCreditBasedDataController::reassemble(BasicFrameView basic_frame_view) {
   if (remaining_sdu_continuation_packet_size_ == 0) {
     auto start_frame_view = FirstLeInformationFrameView::Create(basic_frame_view);
     if (!start_frame_view.IsValid()) {
       LOG_WARN("Received invalid frame");
-      return;
+      return 0;
     }
     auto payload = start_frame_view.GetPayload();
     auto sdu_size = start_frame_view.GetL2capSduLength();
     remaining_sdu_continuation_packet_size_ = sdu_size - payload.size();
     reassembly_stage_ = payload;
-  } else {
-    auto payload = basic_frame_view.GetPayload();
-    remaining_sdu_continuation_packet_size_ -= payload.size();
-    reassembly_stage_.AppendPacketView(payload);
+    return payload.size();
   }
-  if (remaining_sdu_continuation_packet_size_ == 0) {
-    enqueue_buffer_.Enqueue(std::make_unique<PacketView<kLittleEndian>>(reassembly_stage_), handler_);
-  } else if (remaining_sdu_continuation_packet_size_ < 0 || reassembly_stage_.size() > mtu_) {
-    LOG_WARN("Received larger SDU size than expected");
-    reassembly_stage_ = PacketViewForReassembly(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
-    remaining_sdu_continuation_packet_size_ = 0;
-    link_->SendDisconnectionRequest(cid_, remote_cid_);
+  auto payload = basic_frame_view.GetPayload();
+  remaining_sdu_continuation_packet_size_ -= payload.size();
+  reassembly_stage_.AppendPacketView(payload);
+  return payload.size();
+}
+
+void LeCreditBasedDataController::on_sdu_enqueued(const UpperEnqueue& sdu) {
+  credit_policy_.OnConsumed(sdu.size(), LeCreditPolicy::Clock::now());
+  send_credits_if_needed();
+}
+
+void LeCreditBasedDataController::send_credits_if_needed() {
+  uint16_t credits = credit_policy_.GetCreditsToSend(peer_credits_, LeCreditPolicy::Clock::now());
+  if (credits == 0) {
+    return;
   }
-  // TODO: Improve the logic by sending credit only after user dequeued the SDU
-  link_->SendLeCredit(cid_, 1);
+  peer_credits_ += credits;
+  link_->SendLeCredit(cid_, credits);
 }
 
 std::unique_ptr<packet::BasePacketBuilder> LeCreditBasedDataController::GetNextPacket() {
@@ -124,8 +161,8 @@ void LeCreditBasedDataController::OnCredit(uint16_t credits) {
   credits_ = total_credits;
   if (pending_frames_count_ > 0 && credits_ >= pending_frames_count_) {
     scheduler_->OnPacketsReady(cid_, pending_frames_count_);
-    pending_frames_count_ = 0;
     credits_ -= pending_frames_count_;
+    pending_frames_count_ = 0;
   } else if (pending_frames_count_ > 0) {
     scheduler_->OnPacketsReady(cid_, credits_);
     pending_frames_count_ -= credits_;
@@ -133,6 +170,11 @@ void LeCreditBasedDataController::OnCredit(uint16_t credits) {
   }
 }
 
+void LeCreditBasedDataController::SetInitialPeerCredits(uint16_t credits, uint16_t local_mps) {
+  peer_credits_ = credits;
+  credit_policy_.Configure(credits, kMaxPeerCredits, local_mps, LeCreditPolicy::kDefaultMaxBufferedBytes);
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -27,6 +27,7 @@
 #include "l2cap/internal/ilink.h"
 #include "l2cap/internal/scheduler.h"
 #include "l2cap/l2cap_packets.h"
+#include "l2cap/le_credit_policy.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
 #include "os/queue.h"
@@ -44,6 +45,7 @@ class LeCreditBasedDataController : public DataController {
   using UpperQueueDownEnd = common::BidiQueueEnd<UpperEnqueue, UpperDequeue>;
   LeCreditBasedDataController(ILink* link, Cid cid, Cid remote_cid, UpperQueueDownEnd* channel_queue_end,
                               os::Handler* handler, Scheduler* scheduler);
+  ~LeCreditBasedDataController();
 
   void OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) override;
   void OnPdu(packet::PacketView<true> pdu) override;
@@ -58,8 +60,15 @@ class LeCreditBasedDataController : public DataController {
   void SetMps(uint16_t mps);
   // TODO: Handle credits
   void OnCredit(uint16_t credits);
+  // Credits given to the peer in the connection request or response, for PDUs of up to |local_mps| bytes
+  void SetInitialPeerCredits(uint16_t credits, uint16_t local_mps);
 
  private:
+  // Returns the payload bytes added to the reassembly stage
+  size_t reassemble(BasicFrameView basic_frame_view);
+  void on_sdu_enqueued(const UpperEnqueue& sdu);
+  void send_credits_if_needed();
+
   Cid cid_;
   Cid remote_cid_;
   os::EnqueueBuffer<UpperEnqueue> enqueue_buffer_;
@@ -71,6 +80,9 @@ class LeCreditBasedDataController : public DataController {
   uint16_t mps_ = 251;
   uint16_t credits_ = 0;
   uint16_t pending_frames_count_ = 0;
+  // Credits the peer holds to send to us
+  uint16_t peer_credits_ = 0;
+  LeCreditPolicy credit_policy_;
 
   class PacketViewForReassembly : public packet::PacketView<kLittleEndian> {
    public:
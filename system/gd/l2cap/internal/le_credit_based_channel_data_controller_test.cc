@@ -151,7 +151,6 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented) {
   auto segment2 = CreateSdu({'e', 'f', 'g'});
   auto builder2 = BasicFrameBuilder::Create(0x41, std::move(segment2));
   base_view = GetPacketView(std::move(builder2));
-  EXPECT_CALL(link, SendLeCredit(0x41, 1));
   controller.OnPdu(base_view);
   sync_handler(queue_handler_);
   auto payload = channel_queue.GetUpEnd()->TryDequeue();
@@ -160,6 +159,21 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented) {
   EXPECT_EQ(data, "abcdefg");
 }
 
+TEST_F(LeCreditBasedDataControllerTest, receive_returns_credits_in_batches) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialPeerCredits(4, 251);
+  EXPECT_CALL(link, SendLeCredit(0x41, 2)).Times(1);
+  for (int i = 0; i < 3; i++) {
+    auto segment = CreateSdu({'a', 'b', 'c', 'd'});
+    auto builder = FirstLeInformationFrameBuilder::Create(0x41, 4, std::move(segment));
+    controller.OnPdu(GetPacketView(std::move(builder)));
+    sync_handler(queue_handler_);
+  }
+}
+
 TEST_F(LeCreditBasedDataControllerTest, receive_segmented_with_wrong_sdu_length) {
   common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
   testing::MockScheduler scheduler;
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/le_credit_policy.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace l2cap {
+
+void LeCreditPolicy::Configure(uint16_t initial_credits, uint16_t max_credits, uint16_t mps,
+                               size_t max_buffered_bytes) {
+  *this = {};
+  mps_ = std::max<uint16_t>(mps, 1);
+  max_buffered_bytes_ = max_buffered_bytes;
+  // Always let the peer hold one credit, or the channel could never make progress
+  size_t max_window = std::min<size_t>(max_credits, max_buffered_bytes_ / mps_);
+  max_window_ = static_cast<uint16_t>(std::max<size_t>(max_window, 1));
+  window_ = std::clamp<uint16_t>(initial_credits, std::min(kMinWindow, max_window_), max_window_);
+}
+
+void LeCreditPolicy::OnPduReceived(size_t length, uint16_t peer_credits, Clock::time_point now) {
+  buffered_bytes_ += length;
+  if (peer_credits > 0 || starved_) {
+    return;
+  }
+  // The peer had more to send than it had credits for
+  starved_ = true;
+  starved_since_ = now;
+  starved_in_period_ = true;
+  stats_.starved_intervals++;
+  window_ = static_cast<uint16_t>(std::min<uint32_t>(2 * window_, max_window_));
+}
+
+void LeCreditPolicy::OnConsumed(size_t length, Clock::time_point now) {
+  length = std::min(length, buffered_bytes_);
+  buffered_bytes_ -= length;
+  drained_bytes_ += length;
+  update_drain_rate(now);
+}
+
+void LeCreditPolicy::update_drain_rate(Clock::time_point now) {
+  if (period_start_ == Clock::time_point{}) {
+    period_start_ = now;
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - period_start_);
+  if (elapsed < kRatePeriod) {
+    return;
+  }
+  uint64_t rate = drained_bytes_ * 1000 / elapsed.count();
+  drain_rate_ = static_cast<uint32_t>(std::min<uint64_t>((3 * uint64_t{drain_rate_} + rate) / 4, UINT32_MAX));
+
+  // Shrink the window when half of it would still cover what the consumer
+  // drains in kTargetBuffering, unless the peer ran short meanwhile
+  uint64_t needed = uint64_t{drain_rate_} * kTargetBuffering.count() / 1000 / mps_ + 1;
+  if (!starved_in_period_ && 2 * needed < window_) {
+    window_ = std::max<uint16_t>(window_ - window_ / 4, std::min(kMinWindow, max_window_));
+  }
+
+  drained_bytes_ = 0;
+  period_start_ = now;
+  starved_in_period_ = false;
+}
+
+uint16_t LeCreditPolicy::GetCreditsToSend(uint16_t peer_credits, Clock::time_point now) {
+  size_t room =
+      max_buffered_bytes_ > buffered_bytes_ ? (max_buffered_bytes_ - buffered_bytes_) / mps_ : 0;
+  size_t allowed = std::min<size_t>(window_, room);
+  if (buffered_bytes_ == 0) {
+    allowed = std::max<size_t>(allowed, 1);
+  }
+  // Wait until the peer is down to half of what it may hold, so that credits
+  // go out in batches instead of one signalling packet per PDU
+  if (peer_credits >= allowed || (peer_credits > 0 && peer_credits > allowed / 2)) {
+    return 0;
+  }
+  if (starved_) {
+    starved_ = false;
+    stats_.starved_time += now - starved_since_;
+  }
+  return static_cast<uint16_t>(allowed - peer_credits);
+}
+
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace bluetooth {
+namespace l2cap {
+
+// Decides when, and how many, credits the receiver of an LE credit based
+// channel returns to the peer. Shared with the legacy stack.
+//
+// The peer may hold up to a window of credits. The window doubles each time
+// the peer runs out of credits, and shrinks when the consumer drains much less
+// than the window allows. Credits the peer holds, plus received bytes not yet
+// consumed, never exceed the memory ceiling of the channel. Credits are sent
+// in batches, once the peer is down to half of what it may hold.
+//
+// The caller keeps count of the credits the peer holds.
+class LeCreditPolicy {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultMaxBufferedBytes = 256 * 1024;
+  // Window the peer gets, unless the memory ceiling does not allow it
+  static constexpr uint16_t kMinWindow = 4;
+  // Data the peer may have in flight, at the rate the consumer drains
+  static constexpr std::chrono::milliseconds kTargetBuffering{200};
+  // Period over which the drain rate is measured
+  static constexpr std::chrono::milliseconds kRatePeriod{100};
+
+  struct Stats {
+    // Times the peer ran out of credits
+    uint32_t starved_intervals{0};
+    // Time the peer spent without credits
+    Clock::duration starved_time{};
+  };
+
+  // Start over for a channel on which the peer was given |initial_credits|,
+  // may send PDUs of up to |mps| bytes and hold at most |max_credits|.
+  void Configure(uint16_t initial_credits, uint16_t max_credits, uint16_t mps, size_t max_buffered_bytes);
+
+  bool IsConfigured() const {
+    return mps_ != 0;
+  }
+
+  // The peer used a credit to send a PDU of |length| bytes, which stay
+  // buffered until OnConsumed, and holds |peer_credits| more.
+  void OnPduReceived(size_t length, uint16_t peer_credits, Clock::time_point now);
+
+  // The consumer took |length| of the buffered bytes.
+  void OnConsumed(size_t length, Clock::time_point now);
+
+  // Credits to send to a peer that holds |peer_credits|, 0 if it has enough.
+  // The caller must send them.
+  uint16_t GetCreditsToSend(uint16_t peer_credits, Clock::time_point now);
+
+  size_t GetBufferedBytes() const {
+    return buffered_bytes_;
+  }
+
+  uint16_t GetWindow() const {
+    return window_;
+  }
+
+  // Bytes per second
+  uint32_t GetDrainRate() const {
+    return drain_rate_;
+  }
+
+  const Stats& GetStats() const {
+    return stats_;
+  }
+
+ private:
+  void update_drain_rate(Clock::time_point now);
+
+  uint16_t mps_{0};
+  uint16_t window_{0};
+  uint16_t max_window_{0};
+  size_t max_buffered_bytes_{0};
+  size_t buffered_bytes_{0};
+
+  uint32_t drain_rate_{0};
+  size_t drained_bytes_{0};
+  Clock::time_point period_start_{};
+  bool starved_in_period_{false};
+
+  bool starved_{false};
+  Clock::time_point starved_since_{};
+  Stats stats_{};
+};
+
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/le_credit_policy.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace l2cap {
+namespace {
+
+using std::chrono_literals::operator""ms;
+
+constexpr uint16_t kMps = 100;
+constexpr uint16_t kMaxCredits = 0xffff;
+
+class LeCreditPolicyTest : public ::testing::Test {
+ protected:
+  // The peer sends one PDU of kMps bytes, which the consumer takes right away
+  void ReceiveAndConsume() {
+    peer_credits_--;
+    policy_.OnPduReceived(kMps, peer_credits_, now_);
+    policy_.OnConsumed(kMps, now_);
+    peer_credits_ += policy_.GetCreditsToSend(peer_credits_, now_);
+  }
+
+  LeCreditPolicy policy_;
+  uint16_t peer_credits_ = 0;
+  LeCreditPolicy::Clock::time_point now_ = LeCreditPolicy::Clock::now();
+};
+
+TEST_F(LeCreditPolicyTest, credits_are_returned_once_half_of_the_window_is_used) {
+  peer_credits_ = 10;
+  policy_.Configure(peer_credits_, kMaxCredits, kMps, LeCreditPolicy::kDefaultMaxBufferedBytes);
+  for (int i = 0; i < 4; i++) {
+    peer_credits_--;
+    policy_.OnPduReceived(kMps, peer_credits_, now_);
+    EXPECT_EQ(policy_.GetCreditsToSend(peer_credits_, now_), 0);
+  }
+  peer_credits_--;
+  policy_.OnPduReceived(kMps, peer_credits_, now_);
+  EXPECT_EQ(policy_.GetCreditsToSend(peer_credits_, now_), 5);
+  EXPECT_EQ(policy_.GetStats().starved_intervals, 0u);
+}
+
+TEST_F(LeCreditPolicyTest, window_doubles_when_the_peer_runs_out_of_credits) {
+  peer_credits_ = 1;
+  policy_.Configure(peer_credits_, kMaxCredits, kMps, LeCreditPolicy::kDefaultMaxBufferedBytes);
+  EXPECT_EQ(policy_.GetWindow(), LeCreditPolicy::kMinWindow);
+  peer_credits_ = 0;
+  policy_.OnPduReceived(kMps, peer_credits_, now_);
+  EXPECT_EQ(policy_.GetStats().starved_intervals, 1u);
+  EXPECT_EQ(policy_.GetWindow(), 2 * LeCreditPolicy::kMinWindow);
+  policy_.OnConsumed(kMps, now_);
+  now_ += 30ms;
+  EXPECT_EQ(policy_.GetCreditsToSend(peer_credits_, now_), 2 * LeCreditPolicy::kMinWindow);
+  EXPECT_EQ(policy_.GetStats().starved_time, 30ms);
+}
+
+TEST_F(LeCreditPolicyTest, credits_and_buffered_bytes_stay_below_the_ceiling) {
+  peer_credits_ = 8;
+  policy_.Configure(peer_credits_, kMaxCredits, kMps, 8 * kMps);
+  // Nothing is consumed, so the peer only gets credits for the room left
+  for (int i = 0; i < 6; i++) {
+    peer_credits_--;
+    policy_.OnPduReceived(kMps, peer_credits_, now_);
+    peer_credits_ += policy_.GetCreditsToSend(peer_credits_, now_);
+    EXPECT_LE(peer_credits_ * kMps + policy_.GetBufferedBytes(), 8u * kMps);
+  }
+  EXPECT_EQ(peer_credits_, 2);
+  policy_.OnConsumed(6 * kMps, now_);
+  EXPECT_EQ(policy_.GetCreditsToSend(peer_credits_, now_), 6);
+}
+
+TEST_F(LeCreditPolicyTest, peer_gets_one_credit_when_the_ceiling_is_below_mps) {
+  policy_.Configure(0, kMaxCredits, kMps, kMps / 2);
+  EXPECT_EQ(policy_.GetCreditsToSend(0, now_), 1);
+  policy_.OnPduReceived(kMps, 0, now_);
+  EXPECT_EQ(policy_.GetCreditsToSend(0, now_), 0);
+  policy_.OnConsumed(kMps, now_);
+  EXPECT_EQ(policy_.GetCreditsToSend(0, now_), 1);
+}
+
+TEST_F(LeCreditPolicyTest, window_shrinks_when_the_consumer_drains_slowly) {
+  peer_credits_ = 200;
+  policy_.Configure(peer_credits_, kMaxCredits, kMps, LeCreditPolicy::kDefaultMaxBufferedBytes);
+  EXPECT_EQ(policy_.GetWindow(), 200);
+  // One PDU every 50 ms is 2000 bytes per second, which 5 credits cover
+  for (int i = 0; i < 100; i++) {
+    now_ += 50ms;
+    ReceiveAndConsume();
+  }
+  EXPECT_GT(policy_.GetDrainRate(), 1500u);
+  EXPECT_LT(policy_.GetDrainRate(), 2500u);
+  EXPECT_GE(policy_.GetWindow(), 5);
+  EXPECT_LE(policy_.GetWindow(), 10);
+  EXPECT_EQ(policy_.GetStats().starved_intervals, 0u);
+}
+
+TEST_F(LeCreditPolicyTest, window_stays_at_max_credits) {
+  peer_credits_ = 6;
+  policy_.Configure(peer_credits_, 6, kMps, LeCreditPolicy::kDefaultMaxBufferedBytes);
+  for (int i = 0; i < 6; i++) {
+    peer_credits_--;
+    policy_.OnPduReceived(kMps, peer_credits_, now_);
+  }
+  EXPECT_EQ(policy_.GetWindow(), 6);
+  policy_.OnConsumed(6 * kMps, now_);
+  EXPECT_EQ(policy_.GetCreditsToSend(peer_credits_, now_), 6);
+}
+
+}  // namespace
+}  // namespace l2cap
+}  // namespace bluetooth
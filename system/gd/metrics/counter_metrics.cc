@@ -57,8 +57,12 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
     LOG_WARN("count is not larger than 0. count: %s, key: %d", std::to_string(count).c_str(), key);
     return false;
   }
-  int64_t total = 0;
   std::lock_guard<std::mutex> lock(mutex_);
+  return AddToCounterLocked(key, count);
+}
+
+bool CounterMetrics::AddToCounterLocked(int32_t key, int64_t count) {
+  int64_t total = 0;
   if (counters_.find(key) != counters_.end()) {
     total = counters_[key];
   }
@@ -72,6 +76,32 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
   return true;
 }
 
+CounterMetrics::FastCounterId CounterMetrics::RegisterFastCounter(int32_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_fast_counters = num_fast_counters_.load(std::memory_order_relaxed);
+  for (FastCounterId id = 0; id < num_fast_counters; id++) {
+    if (fast_counter_keys_[id] == key) {
+      return id;
+    }
+  }
+  if (num_fast_counters == kMaxFastCounters) {
+    LOG_WARN("No fast counter left for key: %d", key);
+    return kInvalidFastCounterId;
+  }
+  fast_counter_keys_[num_fast_counters] = key;
+  num_fast_counters_.store(num_fast_counters + 1, std::memory_order_release);
+  return num_fast_counters;
+}
+
+void CounterMetrics::CacheFastCount(FastCounterId id, int64_t count) {
+  static std::atomic<size_t> next_slot{0};
+  thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kNumFastCounterSlots;
+  if (id >= num_fast_counters_.load(std::memory_order_acquire) || count <= 0) {
+    return;
+  }
+  fast_counters_[id][slot].value.fetch_add(count, std::memory_order_relaxed);
+}
+
 bool CounterMetrics::Count(int32_t key, int64_t count) {
   if (!IsInitialized()) {
     LOG_WARN("Counter metrics isn't initialized");
@@ -92,6 +122,18 @@ void CounterMetrics::DrainBufferedCounters() {
   }
   std::lock_guard<std::mutex> lock(mutex_);
   LOG_INFO("Draining buffered counters");
+  size_t num_fast_counters = num_fast_counters_.load(std::memory_order_relaxed);
+  for (FastCounterId id = 0; id < num_fast_counters; id++) {
+    int64_t total = 0;
+    for (auto& slot : fast_counters_[id]) {
+      // Saturate like CacheCount() rather than wrap around
+      int64_t value = slot.value.exchange(0, std::memory_order_relaxed);
+      total = (LLONG_MAX - total < value) ? LLONG_MAX : total + value;
+    }
+    if (total > 0) {
+      AddToCounterLocked(fast_counter_keys_[id], total);
+    }
+  }
   for (auto const& pair : counters_) {
     Count(pair.first, pair.second);
   }
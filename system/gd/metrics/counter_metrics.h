@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <unordered_map>
 
 #include "module.h"
@@ -25,7 +27,19 @@ namespace metrics {
 
 class CounterMetrics : public bluetooth::Module {
  public:
+  using FastCounterId = size_t;
+  static constexpr FastCounterId kInvalidFastCounterId = SIZE_MAX;
+  static constexpr size_t kMaxFastCounters = 32;
+  // Threads are spread over the slots of a fast counter, so that they rarely write to the same cache line
+  static constexpr size_t kNumFastCounterSlots = 8;
+
   bool CacheCount(int32_t key, int64_t value);
+  // Reserve a fast counter for |key|, to be counted with CacheFastCount(). Returns the same id when called again with
+  // the same key, and kInvalidFastCounterId once all the fast counters are taken.
+  FastCounterId RegisterFastCounter(int32_t key);
+  // Lock free CacheCount() for the hot paths, e.g. per packet. The count is added to the buffered counters of its key
+  // when they are drained.
+  void CacheFastCount(FastCounterId id, int64_t count = 1);
   virtual bool Count(int32_t key, int64_t count);
   void Stop() override;
   static const ModuleFactory Factory;
@@ -42,8 +56,18 @@ class CounterMetrics : public bluetooth::Module {
   }
 
  private:
+  struct alignas(64) FastCounterSlot {
+    std::atomic<int64_t> value{0};
+  };
+
+  bool AddToCounterLocked(int32_t key, int64_t count);
+
   std::unordered_map<int32_t, int64_t> counters_;
   mutable std::mutex mutex_;
+  std::array<std::array<FastCounterSlot, kNumFastCounterSlots>, kMaxFastCounters> fast_counters_;
+  std::array<int32_t, kMaxFastCounters> fast_counter_keys_{};
+  // Written under |mutex_|, ids below it are registered
+  std::atomic<size_t> num_fast_counters_{0};
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   bool initialized_ {false};
 };
@@ -16,7 +16,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -87,6 +89,51 @@ TEST_F(CounterMetricsTest, non_positive) {
   ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 5);
 }
 
+TEST_F(CounterMetricsTest, fast_counters) {
+  auto id = testable_counter_metrics_.RegisterFastCounter(1);
+  ASSERT_NE(CounterMetrics::kInvalidFastCounterId, id);
+  ASSERT_EQ(id, testable_counter_metrics_.RegisterFastCounter(1));
+  ASSERT_TRUE(testable_counter_metrics_.CacheCount(1, 2));
+  testable_counter_metrics_.CacheFastCount(id);
+  testable_counter_metrics_.CacheFastCount(id, 3);
+  testable_counter_metrics_.CacheFastCount(id, 0);
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 6);
+  testable_counter_metrics_.test_counters_.clear();
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_.count(1), 0u);
+}
+
+TEST_F(CounterMetricsTest, fast_counters_from_many_threads) {
+  constexpr int kNumThreads = 16;
+  constexpr int kCountsPerThread = 1000;
+  auto id = testable_counter_metrics_.RegisterFastCounter(1);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([this, id] {
+      for (int j = 0; j < kCountsPerThread; j++) {
+        testable_counter_metrics_.CacheFastCount(id);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[1], kNumThreads * kCountsPerThread);
+}
+
+TEST_F(CounterMetricsTest, fast_counters_exhausted) {
+  for (size_t i = 0; i < CounterMetrics::kMaxFastCounters; i++) {
+    ASSERT_NE(CounterMetrics::kInvalidFastCounterId, testable_counter_metrics_.RegisterFastCounter(i));
+  }
+  auto id = testable_counter_metrics_.RegisterFastCounter(CounterMetrics::kMaxFastCounters);
+  ASSERT_EQ(CounterMetrics::kInvalidFastCounterId, id);
+  testable_counter_metrics_.CacheFastCount(id);
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_TRUE(testable_counter_metrics_.test_counters_.empty());
+}
+
 }  // namespace
 }  // namespace metrics
 }  // namespace bluetooth
@@ -17,6 +17,11 @@
 
 #include "module.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <set>
+#include <thread>
+
 #include "common/init_flags.h"
 #include "module_dumper_flatbuffer.h"
 
@@ -44,8 +49,11 @@ const ModuleRegistry* Module::GetModuleRegistry() const {
 }
 
 Module* Module::GetDependency(const ModuleFactory* module) const {
-  for (auto& dependency : dependencies_.list_) {
-    if (dependency == module) {
+  for (size_t i = 0; i < dependencies_.list_.size(); i++) {
+    if (dependencies_.list_[i] == module) {
+      if (i < dependency_instances_.size()) {
+        return dependency_instances_[i];
+      }
       return registry_->Get(module);
     }
   }
@@ -60,20 +68,45 @@ Module* ModuleRegistry::Get(const ModuleFactory* module) const {
 }
 
 bool ModuleRegistry::IsStarted(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   return started_modules_.find(module) != started_modules_.end();
 }
 
 void ModuleRegistry::Start(ModuleList* modules, Thread* thread) {
+  if (max_parallel_starts_ > 1) {
+    StartInParallel(modules, thread);
+    return;
+  }
   for (auto it = modules->list_.begin(); it != modules->list_.end(); it++) {
     Start(*it, thread);
   }
 }
 
+void ModuleRegistry::SetMaxParallelStarts(size_t max_parallel_starts) {
+  max_parallel_starts_ = std::max<size_t>(max_parallel_starts, 1);
+}
+
+std::chrono::microseconds ModuleRegistry::GetStartTime(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto start_time = start_times_.find(module);
+  return start_time != start_times_.end() ? start_time->second : std::chrono::microseconds(0);
+}
+
 void ModuleRegistry::set_registry_and_handler(Module* instance, Thread* thread) const {
   instance->registry_ = this;
   instance->handler_ = new Handler(thread);
 }
 
+void ModuleRegistry::AssignThread(const ModuleFactory* module, Thread* thread) {
+  ASSERT_LOG(started_modules_.find(module) == started_modules_.end(), "Module already started");
+  assigned_threads_[module] = thread;
+}
+
+Thread* ModuleRegistry::GetModuleThread(const ModuleFactory* module, Thread* thread) const {
+  auto assigned_thread = assigned_threads_.find(module);
+  return assigned_thread != assigned_threads_.end() ? assigned_thread->second : thread;
+}
+
 Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
   auto started_instance = started_modules_.find(module);
   if (started_instance != started_modules_.end()) {
@@ -82,25 +115,159 @@ Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
 
   LOG_INFO("Constructing next module");
   Module* instance = module->ctor_();
-  set_registry_and_handler(instance, thread);
+  set_registry_and_handler(instance, GetModuleThread(module, thread));
 
   LOG_INFO("Starting dependencies of %s", instance->ToString().c_str());
   instance->ListDependencies(&instance->dependencies_);
   Start(&instance->dependencies_, thread);
 
   LOG_INFO("Finished starting dependencies and calling Start() of %s", instance->ToString().c_str());
+  StartInstance(module, instance);
+  return instance;
+}
+
+void ModuleRegistry::StartInstance(const ModuleFactory* module, Module* instance) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    instance->dependency_instances_.clear();
+    for (auto dependency : instance->dependencies_.list_) {
+      instance->dependency_instances_.push_back(Get(dependency));
+    }
+    last_instance_ = "starting " + instance->ToString();
+  }
 
-  last_instance_ = "starting " + instance->ToString();
+  auto start = std::chrono::steady_clock::now();
   instance->Start();
-  start_order_.push_back(module);
-  started_modules_[module] = instance;
-  LOG_INFO("Started %s", instance->ToString().c_str());
-  return instance;
+  auto start_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    start_order_.push_back(module);
+    started_modules_[module] = instance;
+    start_times_[module] = start_time;
+  }
+  LOG_INFO("Started %s in %lld us", instance->ToString().c_str(), static_cast<long long>(start_time.count()));
+}
+
+namespace {
+
+struct PendingModule {
+  const ModuleFactory* factory;
+  Module* instance;
+  size_t unstarted_dependencies = 0;
+  std::vector<size_t> dependents;
+};
+
+}  // namespace
+
+void ModuleRegistry::StartInParallel(ModuleList* modules, Thread* thread) {
+  // Construct every module that is not started yet, dependencies first, which is the order a sequential start
+  // follows. Modules are then started in that order as far as their dependencies allow.
+  std::vector<PendingModule> pending;
+  std::map<const ModuleFactory*, size_t> pending_index;
+  std::function<void(const ModuleFactory*)> construct = [&](const ModuleFactory* module) {
+    if (started_modules_.find(module) != started_modules_.end() ||
+        pending_index.find(module) != pending_index.end()) {
+      return;
+    }
+    Module* instance = module->ctor_();
+    set_registry_and_handler(instance, GetModuleThread(module, thread));
+    instance->ListDependencies(&instance->dependencies_);
+    for (auto dependency : instance->dependencies_.list_) {
+      construct(dependency);
+    }
+    pending_index[module] = pending.size();
+    pending.push_back(PendingModule{module, instance});
+  };
+  for (auto module : modules->list_) {
+    construct(module);
+  }
+
+  std::set<size_t> ready;
+  for (size_t i = 0; i < pending.size(); i++) {
+    for (auto dependency : pending[i].instance->dependencies_.list_) {
+      auto index = pending_index.find(dependency);
+      if (index != pending_index.end()) {
+        pending[i].unstarted_dependencies++;
+        pending[index->second].dependents.push_back(i);
+      }
+    }
+    if (pending[i].unstarted_dependencies == 0) {
+      ready.insert(i);
+    }
+  }
+
+  size_t num_threads = std::min(max_parallel_starts_, pending.size());
+  LOG_INFO("Starting %zu modules on up to %zu threads", pending.size(), num_threads);
+
+  std::mutex ready_mutex;
+  std::condition_variable ready_cv;
+  size_t remaining = pending.size();
+  auto start_ready_modules = [&]() {
+    std::unique_lock<std::mutex> lock(ready_mutex);
+    while (true) {
+      ready_cv.wait(lock, [&] { return !ready.empty() || remaining == 0; });
+      if (ready.empty()) {
+        return;
+      }
+      PendingModule& next = pending[*ready.begin()];
+      ready.erase(ready.begin());
+      lock.unlock();
+      StartInstance(next.factory, next.instance);
+      lock.lock();
+      remaining--;
+      for (auto dependent : next.dependents) {
+        if (--pending[dependent].unstarted_dependencies == 0) {
+          ready.insert(dependent);
+        }
+      }
+      ready_cv.notify_all();
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(start_ready_modules);
+  }
+  start_ready_modules();
+  for (auto& started_thread : threads) {
+    started_thread.join();
+  }
+  LOG_INFO(
+      "Started %zu modules in %lld ms",
+      pending.size(),
+      static_cast<long long>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
 }
 
 void ModuleRegistry::StopAll() {
+  ModuleList warm_modules;
+  StopAllExcept(&warm_modules);
+}
+
+void ModuleRegistry::StopAllExcept(ModuleList* warm_modules) {
+  std::set<const ModuleFactory*> warm;
+  std::function<void(const ModuleFactory*)> keep = [&](const ModuleFactory* module) {
+    auto instance = started_modules_.find(module);
+    if (instance == started_modules_.end() || !warm.insert(module).second) {
+      return;
+    }
+    for (auto dependency : instance->second->dependencies_.list_) {
+      keep(dependency);
+    }
+  };
+  for (auto module : warm_modules->list_) {
+    keep(module);
+  }
+
   // Since modules were brought up in dependency order, it is safe to tear down by going in reverse order.
+  // Warm modules only depend on warm modules, so they never outlive what they use.
   for (auto it = start_order_.rbegin(); it != start_order_.rend(); it++) {
+    if (warm.find(*it) != warm.end()) {
+      continue;
+    }
     auto instance = started_modules_.find(*it);
     ASSERT(instance != started_modules_.end());
     last_instance_ = "stopping " + instance->second->ToString();
@@ -113,15 +280,26 @@ void ModuleRegistry::StopAll() {
     instance->second->Stop();
   }
   for (auto it = start_order_.rbegin(); it != start_order_.rend(); it++) {
+    if (warm.find(*it) != warm.end()) {
+      LOG_INFO("Keeping Module %s started", started_modules_.find(*it)->second->ToString().c_str());
+      continue;
+    }
     auto instance = started_modules_.find(*it);
     ASSERT(instance != started_modules_.end());
     delete instance->second->handler_;
     delete instance->second;
     started_modules_.erase(instance);
+    start_times_.erase(*it);
   }
 
-  ASSERT(started_modules_.empty());
-  start_order_.clear();
+  ASSERT(started_modules_.size() == warm.size());
+  start_order_.erase(
+      std::remove_if(
+          start_order_.begin(),
+          start_order_.end(),
+          [&warm](const ModuleFactory* module) { return warm.find(module) == warm.end(); }),
+      start_order_.end());
+  assigned_threads_.clear();
 }
 
 os::Handler* ModuleRegistry::GetModuleHandler(const ModuleFactory* module) const {
@@ -21,6 +21,7 @@
 #include <functional>
 #include <future>
 #include <map>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -120,6 +121,8 @@ class Module {
 
   ::bluetooth::os::Handler* handler_ = nullptr;
   ModuleList dependencies_;
+  // Started instances of |dependencies_|, in the same order, resolved right before Start()
+  std::vector<Module*> dependency_instances_;
   const ModuleRegistry* registry_;
 };
 
@@ -146,19 +149,47 @@ class ModuleRegistry {
 
   Module* Start(const ModuleFactory* id, ::bluetooth::os::Thread* thread);
 
+  // Run |module| on |thread| instead of the thread passed to Start(). Its dependencies are not affected. Must be
+  // called before the module is started; assignments are forgotten by StopAll().
+  void AssignThread(const ModuleFactory* module, ::bluetooth::os::Thread* thread);
+
+  // Start up to |max_parallel_starts| modules of a list at once, each as soon as its dependencies are started.
+  // 1, the default, starts them one after another in dependency order on the calling thread.
+  void SetMaxParallelStarts(size_t max_parallel_starts);
+
+  // Time spent in the Start() of |module|, zero if it was not started by this registry
+  std::chrono::microseconds GetStartTime(const ModuleFactory* module) const;
+
   // Stop all running modules in reverse order of start
   void StopAll();
 
+  // Stop all running modules in reverse order of start, except |warm_modules| and the modules they depend on. Those
+  // stay started, so that the next Start() reuses them as they are; their threads must outlive the restart.
+  void StopAllExcept(ModuleList* warm_modules);
+
  protected:
+  // Not synchronized with a parallel start, modules reach their dependencies through GetDependency() while starting
   Module* Get(const ModuleFactory* module) const;
 
   void set_registry_and_handler(Module* instance, ::bluetooth::os::Thread* thread) const;
 
   os::Handler* GetModuleHandler(const ModuleFactory* module) const;
 
+  ::bluetooth::os::Thread* GetModuleThread(const ModuleFactory* module, ::bluetooth::os::Thread* thread) const;
+
+  // Start the constructed |instance| of |module|, once all its dependencies are started
+  void StartInstance(const ModuleFactory* module, Module* instance);
+
+  void StartInParallel(ModuleList* modules, ::bluetooth::os::Thread* thread);
+
+  // Guards the started modules, start order and times while modules start in parallel
+  mutable std::mutex mutex_;
   std::map<const ModuleFactory*, Module*> started_modules_;
+  std::map<const ModuleFactory*, ::bluetooth::os::Thread*> assigned_threads_;
+  std::map<const ModuleFactory*, std::chrono::microseconds> start_times_;
   std::vector<const ModuleFactory*> start_order_;
   std::string last_instance_;
+  size_t max_parallel_starts_ = 1;
 };
 
 class TestModuleRegistry : public ModuleRegistry {
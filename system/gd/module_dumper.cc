@@ -17,6 +17,10 @@
 
 #include "module_dumper.h"
 
+#include <future>
+#include <vector>
+
+#include "common/bind.h"
 #include "common/init_flags.h"
 #include "dumpsys_data_generated.h"
 #include "module.h"
@@ -27,6 +31,43 @@ using ::bluetooth::os::WakelockManager;
 namespace bluetooth {
 
 void ModuleDumper::DumpState(std::string* output) const {
+  DumpState(output, [](Module* module, flatbuffers::FlatBufferBuilder* builder) {
+    return module->GetDumpsysData(builder);
+  });
+}
+
+void ModuleDumper::DumpStateOnModuleHandlers(
+    std::string* output,
+    std::chrono::milliseconds module_budget,
+    std::vector<std::string>* slow_modules) const {
+  ASSERT(slow_modules != nullptr);
+  auto collect = [module_budget, slow_modules](
+                     Module* module, flatbuffers::FlatBufferBuilder* builder) {
+    std::promise<DumpsysDataFinisher> promise;
+    auto future = promise.get_future();
+    // The builder is used by one module at a time, the next module is posted once this one is done
+    module->GetHandler()->Post(common::BindOnce(
+        [](Module* module,
+           flatbuffers::FlatBufferBuilder* builder,
+           std::promise<DumpsysDataFinisher> promise) {
+          promise.set_value(module->GetDumpsysData(builder));
+        },
+        module,
+        builder,
+        std::move(promise)));
+    if (future.wait_for(module_budget) != std::future_status::ready) {
+      LOG_WARN(
+          "Dumpsys data of %s is taking longer than %lld ms",
+          module->ToString().c_str(),
+          static_cast<long long>(module_budget.count()));
+      slow_modules->push_back(module->ToString());
+    }
+    return future.get();
+  };
+  DumpState(output, collect);
+}
+
+void ModuleDumper::DumpState(std::string* output, const ModuleDataCollector& collect) const {
   ASSERT(output != nullptr);
 
   flatbuffers::FlatBufferBuilder builder(1024);
@@ -46,18 +87,32 @@ void ModuleDumper::DumpState(std::string* output) const {
 
   auto wakelock_offset = WakelockManager::Get().GetDumpsysData(&builder);
 
+  std::vector<flatbuffers::Offset<ModuleStartData>> module_start_times;
+  for (const auto& module : module_registry_.start_order_) {
+    auto instance = module_registry_.started_modules_.find(module);
+    ASSERT(instance != module_registry_.started_modules_.end());
+    auto name = builder.CreateString(instance->second->ToString());
+    ModuleStartDataBuilder start_builder(builder);
+    start_builder.add_name(name);
+    start_builder.add_start_time_us(module_registry_.GetStartTime(module).count());
+    module_start_times.push_back(start_builder.Finish());
+  }
+  auto module_start_times_offset = builder.CreateVector(module_start_times);
+
   std::queue<DumpsysDataFinisher> queue;
   for (auto it = module_registry_.start_order_.rbegin(); it != module_registry_.start_order_.rend();
        it++) {
     auto instance = module_registry_.started_modules_.find(*it);
     ASSERT(instance != module_registry_.started_modules_.end());
-    queue.push(instance->second->GetDumpsysData(&builder));
+    queue.push(collect(instance->second, &builder));
   }
 
   DumpsysDataBuilder data_builder(builder);
   data_builder.add_title(title);
   data_builder.add_init_flags(init_flags_offset);
   data_builder.add_wakelock_manager_data(wakelock_offset);
+  data_builder.add_max_parallel_module_starts(module_registry_.max_parallel_starts_);
+  data_builder.add_module_start_times(module_start_times_offset);
 
   while (!queue.empty()) {
     queue.front()(&data_builder);
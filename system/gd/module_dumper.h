@@ -16,10 +16,20 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <string>
+#include <vector>
+
+#include "module_dumper_flatbuffer.h"
+
+namespace flatbuffers {
+class FlatBufferBuilder;
+}  // namespace flatbuffers
 
 namespace bluetooth {
 
+class Module;
 class ModuleRegistry;
 
 class ModuleDumper {
@@ -28,7 +38,20 @@ class ModuleDumper {
       : module_registry_(module_registry), title_(title) {}
   void DumpState(std::string* output) const;
 
+  // Same as DumpState(), but each module produces its data on its own handler, one module at a
+  // time, so that the handlers keep running their other work in between. The data is merged on
+  // the calling thread, which must not be the thread of a module. Modules that took longer than
+  // |module_budget| are added to |slow_modules|.
+  void DumpStateOnModuleHandlers(
+      std::string* output,
+      std::chrono::milliseconds module_budget,
+      std::vector<std::string>* slow_modules) const;
+
  private:
+  using ModuleDataCollector =
+      std::function<DumpsysDataFinisher(Module*, flatbuffers::FlatBufferBuilder*)>;
+  void DumpState(std::string* output, const ModuleDataCollector& collect) const;
+
   const ModuleRegistry& module_registry_;
   const std::string title_;
 };
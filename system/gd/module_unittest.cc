@@ -16,8 +16,13 @@
 
 #include "module.h"
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <future>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "dumpsys_data_generated.h"
 #include "gtest/gtest.h"
@@ -218,6 +223,63 @@ class TestModuleDumpState : public Module {
 
 const ModuleFactory TestModuleDumpState::Factory = ModuleFactory([]() { return new TestModuleDumpState(); });
 
+// Modules that only finish starting if the other one is starting at the same time
+std::promise<void>* test_module_rendezvous_a = nullptr;
+std::promise<void>* test_module_rendezvous_b = nullptr;
+
+bool rendezvous(std::promise<void>* mine, std::promise<void>* other) {
+  mine->set_value();
+  return other->get_future().wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+}
+
+class TestModuleRendezvousA : public Module {
+ public:
+  static const ModuleFactory Factory;
+  bool met_ = false;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {
+    list->add<TestModuleNoDependency>();
+  }
+
+  void Start() override {
+    EXPECT_TRUE(GetModuleRegistry()->IsStarted<TestModuleNoDependency>());
+    met_ = rendezvous(test_module_rendezvous_a, test_module_rendezvous_b);
+  }
+
+  void Stop() override {}
+
+  std::string ToString() const override {
+    return std::string("TestModuleRendezvousA");
+  }
+};
+
+const ModuleFactory TestModuleRendezvousA::Factory = ModuleFactory([]() { return new TestModuleRendezvousA(); });
+
+class TestModuleRendezvousB : public Module {
+ public:
+  static const ModuleFactory Factory;
+  bool met_ = false;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {
+    list->add<TestModuleNoDependencyTwo>();
+  }
+
+  void Start() override {
+    EXPECT_TRUE(GetModuleRegistry()->IsStarted<TestModuleNoDependencyTwo>());
+    met_ = rendezvous(test_module_rendezvous_b, test_module_rendezvous_a);
+  }
+
+  void Stop() override {}
+
+  std::string ToString() const override {
+    return std::string("TestModuleRendezvousB");
+  }
+};
+
+const ModuleFactory TestModuleRendezvousB::Factory = ModuleFactory([]() { return new TestModuleRendezvousB(); });
+
 TEST_F(ModuleTest, no_dependency) {
   ModuleList list;
   list.add<TestModuleNoDependency>();
@@ -272,6 +334,33 @@ TEST_F(ModuleTest, two_dependencies) {
   EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
 }
 
+TEST_F(ModuleTest, stop_all_except_keeps_warm_modules) {
+  ModuleList list;
+  list.add<TestModuleTwoDependencies>();
+  registry_->Start(&list, thread_);
+  Module* warm_instance = registry_->Start(&TestModuleOneDependency::Factory, thread_);
+
+  ModuleList warm_list;
+  warm_list.add<TestModuleOneDependency>();
+  registry_->StopAllExcept(&warm_list);
+
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleOneDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
+
+  registry_->Start(&list, thread_);
+
+  EXPECT_EQ(warm_instance, registry_->Start(&TestModuleOneDependency::Factory, thread_));
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleTwoDependencies>());
+
+  registry_->StopAll();
+
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleOneDependency>());
+}
+
 void post_to_module_one_handler() {
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
   test_module_one_dependency_handler->Post(common::BindOnce([] { FAIL(); }));
@@ -285,6 +374,92 @@ TEST_F(ModuleTest, shutdown_with_unhandled_callback) {
   registry_->StopAll();
 }
 
+bool runs_on(os::Handler* handler, Thread* thread) {
+  std::promise<bool> promise;
+  auto future = promise.get_future();
+  handler->Post(common::BindOnce(
+      [](Thread* thread, std::promise<bool> promise) { promise.set_value(thread->IsSameThread()); },
+      common::Unretained(thread),
+      std::move(promise)));
+  return future.wait_for(std::chrono::seconds(1)) == std::future_status::ready && future.get();
+}
+
+TEST_F(ModuleTest, assigned_thread) {
+  Thread shard("test_shard", Thread::Priority::NORMAL);
+  registry_->AssignThread(&TestModuleOneDependency::Factory, &shard);
+  ModuleList list;
+  list.add<TestModuleOneDependency>();
+  registry_->Start(&list, thread_);
+
+  // Only the assigned module moves, its dependency stays on the default thread
+  EXPECT_TRUE(runs_on(test_module_one_dependency_handler, &shard));
+  EXPECT_TRUE(runs_on(test_module_no_dependency_handler, thread_));
+
+  registry_->StopAll();
+
+  // Assignments do not outlive StopAll()
+  registry_->Start(&list, thread_);
+  EXPECT_TRUE(runs_on(test_module_one_dependency_handler, thread_));
+  registry_->StopAll();
+}
+
+TEST_F(ModuleTest, parallel_start_follows_dependencies) {
+  registry_->SetMaxParallelStarts(4);
+  ModuleList list;
+  list.add<TestModuleTwoDependencies>();
+  registry_->Start(&list, thread_);
+
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleOneDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleTwoDependencies>());
+  EXPECT_TRUE(runs_on(test_module_one_dependency_handler, thread_));
+
+  registry_->StopAll();
+
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
+}
+
+TEST_F(ModuleTest, parallel_start_runs_independent_modules_concurrently) {
+  std::promise<void> rendezvous_a;
+  std::promise<void> rendezvous_b;
+  test_module_rendezvous_a = &rendezvous_a;
+  test_module_rendezvous_b = &rendezvous_b;
+
+  registry_->SetMaxParallelStarts(2);
+  ModuleList list;
+  list.add<TestModuleRendezvousA>();
+  list.add<TestModuleRendezvousB>();
+  registry_->Start(&list, thread_);
+
+  EXPECT_TRUE(registry_->Start<TestModuleRendezvousA>(thread_)->met_);
+  EXPECT_TRUE(registry_->Start<TestModuleRendezvousB>(thread_)->met_);
+  EXPECT_GT(registry_->GetStartTime(&TestModuleRendezvousA::Factory).count(), 0);
+
+  registry_->StopAll();
+  EXPECT_EQ(0, registry_->GetStartTime(&TestModuleRendezvousA::Factory).count());
+}
+
+TEST_F(ModuleTest, dump_module_start_times) {
+  ModuleList list;
+  list.add<TestModuleOneDependency>();
+  registry_->Start(&list, thread_);
+
+  ModuleDumper dumper(*registry_, "Test Dump Title");
+  std::string output;
+  dumper.DumpState(&output);
+
+  auto data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  EXPECT_EQ(1, data->max_parallel_module_starts());
+  auto start_times = data->module_start_times();
+  ASSERT_EQ(2u, start_times->size());
+  EXPECT_STREQ("TestModuleNoDependency", start_times->Get(0)->name()->c_str());
+  EXPECT_STREQ("TestModuleOneDependency", start_times->Get(1)->name()->c_str());
+
+  registry_->StopAll();
+}
+
 TEST_F(ModuleTest, dump_state) {
   static const char* title = "Test Dump Title";
   ModuleList list;
@@ -315,5 +490,43 @@ TEST_F(ModuleTest, dump_state) {
   registry_->StopAll();
 }
 
+TEST_F(ModuleTest, dump_state_on_module_handlers) {
+  static const char* title = "Test Dump Title";
+  ModuleList list;
+  list.add<TestModuleDumpState>();
+  registry_->Start(&list, thread_);
+
+  ModuleDumper dumper(*registry_, title);
+
+  std::string output;
+  std::vector<std::string> slow_modules;
+  dumper.DumpStateOnModuleHandlers(&output, std::chrono::seconds(1), &slow_modules);
+
+  auto data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  EXPECT_STREQ(title, data->title()->c_str());
+  EXPECT_STREQ("Initial Test String", data->module_unittest_data()->title()->c_str());
+  EXPECT_TRUE(slow_modules.empty());
+
+  // A module that does not answer within the budget is reported, and its data is still dumped
+  std::promise<void> blocked;
+  auto unblock = blocked.get_future();
+  test_module_one_dependency_handler->Post(
+      common::BindOnce([](std::shared_future<void> unblock) { unblock.wait(); }, unblock.share()));
+  std::thread release([&blocked]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    blocked.set_value();
+  });
+  dumper.DumpStateOnModuleHandlers(&output, std::chrono::milliseconds(10), &slow_modules);
+  release.join();
+
+  data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  EXPECT_STREQ("Initial Test String", data->module_unittest_data()->title()->c_str());
+  EXPECT_NE(
+      slow_modules.end(),
+      std::find(slow_modules.begin(), slow_modules.end(), "TestModuleDumpState"));
+
+  registry_->StopAll();
+}
+
 }  // namespace
 }  // namespace bluetooth
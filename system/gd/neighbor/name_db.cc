@@ -17,16 +17,23 @@
 
 #include "neighbor/name_db.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/bind.h"
+#include "common/strings.h"
 #include "hci/hci_packets.h"
 #include "hci/remote_name_request.h"
 #include "module.h"
 #include "os/handler.h"
 #include "os/log.h"
+#include "os/system_properties.h"
+#include "storage/storage_module.h"
 
 namespace bluetooth {
 namespace neighbor {
@@ -36,11 +43,26 @@ struct PendingRemoteNameRead {
   ReadRemoteNameDbCallback callback_;
   os::Handler* handler_;
 };
+
+// The names are kept in the storage, one property per slot: "<address> <update time> <hex name>"
+constexpr char kNameCacheSection[] = "NameCache";
+constexpr char kNameCachePropertyPrefix[] = "Name";
+constexpr char kNameCacheSizeProperty[] = "bluetooth.neighbor.name_cache.size";
+constexpr uint32_t kDefaultNameCacheSize = 200;
+constexpr char kNameMaxAgeProperty[] = "bluetooth.neighbor.name_cache.max_age_days";
+constexpr uint32_t kDefaultNameMaxAgeDays = 30;
+
+int64_t GetUnixTimeSeconds() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
 }  // namespace
 
 struct NameDbModule::impl {
   void ReadRemoteNameRequest(
       hci::Address address, ReadRemoteNameDbCallback callback, os::Handler* handler);
+  void ResolveRemoteNames(
+      std::vector<hci::RemoteNameCandidate> candidates, ResolveRemoteNamesCallback callback, os::Handler* handler);
 
   bool IsNameCached(hci::Address address) const;
   RemoteName ReadCachedRemoteName(hci::Address address) const;
@@ -51,12 +73,41 @@ struct NameDbModule::impl {
   void Stop();
 
  private:
-  std::unordered_map<hci::Address, std::list<PendingRemoteNameRead>> address_to_pending_read_map_;
-  std::unordered_map<hci::Address, RemoteName> address_to_name_map_;
+  struct CachedName {
+    RemoteName name;
+    // Last time the name was read from the device or its extended inquiry response
+    int64_t updated_unix_s;
+    // Last time the name was updated or the device was found, for the eviction of the least recently used names
+    int64_t used_unix_s;
+    size_t slot;
+  };
 
+  std::unordered_map<hci::Address, std::list<PendingRemoteNameRead>> address_to_pending_read_map_;
+  std::unordered_map<hci::Address, CachedName> address_to_name_map_;
+  // Address of the name stored in each slot of the storage
+  std::vector<std::optional<hci::Address>> slots_;
+  int64_t max_age_s_ = 0;
+
+  // Only one name request is given to the controller at a time, so the
+  // scheduler can still reorder the others as candidates are added.
+  hci::RemoteNameScheduler scheduler_;
+  std::optional<hci::Address> scheduled_request_;
+
+  void StartRemoteNameRequest(
+      hci::Address address,
+      hci::PageScanRepetitionMode page_scan_repetition_mode,
+      uint16_t clock_offset,
+      hci::ClockOffsetValid clock_offset_valid);
+  void StartNextScheduledRequest();
   void OnRemoteNameResponse(hci::Address address, hci::ErrorCode status, RemoteName name);
 
+  bool IsNameFresh(hci::Address address) const;
+  void StoreName(hci::Address address, const RemoteName& name);
+  void WriteSlot(size_t slot, hci::Address address, const CachedName& cached_name);
+  void LoadNames();
+
   hci::RemoteNameRequestModule* name_module_;
+  storage::StorageModule* storage_module_;
 
   const NameDbModule& module_;
   os::Handler* handler_;
@@ -72,17 +123,79 @@ void neighbor::NameDbModule::impl::ReadRemoteNameRequest(
   if (address_to_pending_read_map_.find(address) != address_to_pending_read_map_.end()) {
     LOG_WARN("Already have remote read db in progress; adding callback to callback list");
     address_to_pending_read_map_[address].push_back({std::move(callback), handler});
+    if (!scheduler_.Contains(address)) {
+      return;
+    }
+    // Still waiting for its turn in the scheduler, send it now
+    scheduler_.Remove(address);
+  } else {
+    std::list<PendingRemoteNameRead> tmp;
+    address_to_pending_read_map_[address] = std::move(tmp);
+    address_to_pending_read_map_[address].push_back({std::move(callback), handler});
+  }
+  if (IsNameFresh(address)) {
+    auto callback_list = std::move(address_to_pending_read_map_.at(address));
+    address_to_pending_read_map_.erase(address);
+    for (auto& it : callback_list) {
+      it.handler_->Call(std::move(it.callback_), address, true);
+    }
     return;
   }
 
-  std::list<PendingRemoteNameRead> tmp;
-  address_to_pending_read_map_[address] = std::move(tmp);
-  address_to_pending_read_map_[address].push_back({std::move(callback), handler});
-
   // TODO(cmanton) Use remote name request defaults for now
-  hci::PageScanRepetitionMode page_scan_repetition_mode = hci::PageScanRepetitionMode::R1;
-  uint16_t clock_offset = 0;
-  hci::ClockOffsetValid clock_offset_valid = hci::ClockOffsetValid::INVALID;
+  StartRemoteNameRequest(address, hci::PageScanRepetitionMode::R1, 0, hci::ClockOffsetValid::INVALID);
+}
+
+void neighbor::NameDbModule::impl::ResolveRemoteNames(
+    std::vector<hci::RemoteNameCandidate> candidates, ResolveRemoteNamesCallback callback, os::Handler* handler) {
+  auto now = hci::RemoteNameScheduler::Clock::now();
+  for (auto& candidate : candidates) {
+    hci::Address address = candidate.address;
+    if (candidate.eir_name.has_value()) {
+      StoreName(address, *candidate.eir_name);
+    }
+    if (IsNameFresh(address)) {
+      address_to_name_map_.at(address).used_unix_s = GetUnixTimeSeconds();
+      scheduler_.Remove(address);
+      handler->Post(common::BindOnce(callback, address, true));
+      continue;
+    }
+    auto pending = address_to_pending_read_map_.find(address);
+    if (pending != address_to_pending_read_map_.end()) {
+      pending->second.push_back({common::BindOnce(callback), handler});
+      // Still waiting for its turn: the new inquiry result updates its rank
+      if (scheduler_.Contains(address)) {
+        scheduler_.Add(candidate, now);
+      }
+      continue;
+    }
+    address_to_pending_read_map_[address].push_back({common::BindOnce(callback), handler});
+    scheduler_.Add(candidate, now);
+  }
+  StartNextScheduledRequest();
+}
+
+void neighbor::NameDbModule::impl::StartNextScheduledRequest() {
+  if (scheduled_request_.has_value()) {
+    return;
+  }
+  auto candidate = scheduler_.Next();
+  if (!candidate.has_value()) {
+    return;
+  }
+  scheduled_request_ = candidate->address;
+  StartRemoteNameRequest(
+      candidate->address,
+      candidate->page_scan_repetition_mode,
+      candidate->clock_offset,
+      candidate->clock_offset_valid);
+}
+
+void neighbor::NameDbModule::impl::StartRemoteNameRequest(
+    hci::Address address,
+    hci::PageScanRepetitionMode page_scan_repetition_mode,
+    uint16_t clock_offset,
+    hci::ClockOffsetValid clock_offset_valid) {
   name_module_->StartRemoteNameRequest(
       address,
       hci::RemoteNameRequestBuilder::Create(
@@ -98,13 +211,18 @@ void neighbor::NameDbModule::impl::OnRemoteNameResponse(
     hci::Address address, hci::ErrorCode status, RemoteName name) {
   ASSERT(address_to_pending_read_map_.find(address) != address_to_pending_read_map_.end());
   if (status == hci::ErrorCode::SUCCESS) {
-    address_to_name_map_[address] = name;
+    StoreName(address, name);
   }
   auto& callback_list = address_to_pending_read_map_.at(address);
   for (auto& it : callback_list) {
     it.handler_->Call(std::move(it.callback_), address, status == hci::ErrorCode::SUCCESS);
   }
   address_to_pending_read_map_.erase(address);
+
+  if (scheduled_request_ == address) {
+    scheduled_request_.reset();
+    StartNextScheduledRequest();
+  }
 }
 
 bool neighbor::NameDbModule::impl::IsNameCached(hci::Address address) const {
@@ -113,7 +231,86 @@ bool neighbor::NameDbModule::impl::IsNameCached(hci::Address address) const {
 
 RemoteName neighbor::NameDbModule::impl::ReadCachedRemoteName(hci::Address address) const {
   ASSERT(IsNameCached(address));
-  return address_to_name_map_.at(address);
+  return address_to_name_map_.at(address).name;
+}
+
+// Stale names are still reported, but are requested again when the device is paged or found
+bool neighbor::NameDbModule::impl::IsNameFresh(hci::Address address) const {
+  auto it = address_to_name_map_.find(address);
+  return it != address_to_name_map_.end() && GetUnixTimeSeconds() - it->second.updated_unix_s < max_age_s_;
+}
+
+void neighbor::NameDbModule::impl::StoreName(hci::Address address, const RemoteName& name) {
+  if (slots_.empty()) {
+    return;
+  }
+  auto now = GetUnixTimeSeconds();
+  auto it = address_to_name_map_.find(address);
+  if (it != address_to_name_map_.end()) {
+    it->second.used_unix_s = now;
+    // Only write to the storage when the name changed or is confirmed again
+    if (it->second.name == name && IsNameFresh(address)) {
+      return;
+    }
+    it->second.name = name;
+    it->second.updated_unix_s = now;
+    WriteSlot(it->second.slot, address, it->second);
+    return;
+  }
+
+  auto slot = std::find(slots_.begin(), slots_.end(), std::nullopt);
+  if (slot == slots_.end()) {
+    auto lru = std::min_element(address_to_name_map_.begin(), address_to_name_map_.end(), [](auto& a, auto& b) {
+      return a.second.used_unix_s < b.second.used_unix_s;
+    });
+    slot = slots_.begin() + lru->second.slot;
+    address_to_name_map_.erase(lru);
+  }
+  *slot = address;
+  CachedName& cached_name = address_to_name_map_[address];
+  cached_name = {name, now, now, static_cast<size_t>(slot - slots_.begin())};
+  WriteSlot(cached_name.slot, address, cached_name);
+}
+
+void neighbor::NameDbModule::impl::WriteSlot(size_t slot, hci::Address address, const CachedName& cached_name) {
+  auto end = std::find(cached_name.name.begin(), cached_name.name.end(), 0);
+  storage_module_->SetProperty(
+      kNameCacheSection,
+      kNameCachePropertyPrefix + std::to_string(slot),
+      address.ToString() + " " + std::to_string(cached_name.updated_unix_s) + " " +
+          common::ToHexString(cached_name.name.begin(), end));
+}
+
+void neighbor::NameDbModule::impl::LoadNames() {
+  for (size_t slot = 0; slot < slots_.size(); slot++) {
+    std::string property = kNameCachePropertyPrefix + std::to_string(slot);
+    auto value = storage_module_->GetProperty(kNameCacheSection, property);
+    if (!value.has_value()) {
+      continue;
+    }
+    // The name is empty in "<address> <update time>"
+    auto fields = common::StringSplit(*value, " ");
+    auto address = fields.size() >= 2 ? hci::Address::FromString(fields[0]) : std::nullopt;
+    auto updated_unix_s = fields.size() >= 2 ? common::Int64FromString(fields[1]) : std::nullopt;
+    auto name_bytes =
+        fields.size() == 3 ? common::FromHexString(fields[2]) : std::make_optional<std::vector<uint8_t>>();
+    if (!address || !updated_unix_s || fields.size() > 3 || !name_bytes ||
+        name_bytes->size() > RemoteName().size() || address_to_name_map_.count(*address) != 0) {
+      LOG_WARN("Dropping invalid cached name in slot %zu", slot);
+      storage_module_->RemoveProperty(kNameCacheSection, property);
+      continue;
+    }
+    CachedName cached_name = {{}, *updated_unix_s, *updated_unix_s, slot};
+    std::copy(name_bytes->begin(), name_bytes->end(), cached_name.name.begin());
+    address_to_name_map_[*address] = cached_name;
+    slots_[slot] = *address;
+  }
+  // Drop the names above the size of the cache, e.g. after it was reduced
+  size_t slot = slots_.size();
+  while (storage_module_->RemoveProperty(kNameCacheSection, kNameCachePropertyPrefix + std::to_string(slot))) {
+    slot++;
+  }
+  LOG_INFO("Loaded %zu cached names", address_to_name_map_.size());
 }
 
 /**
@@ -135,6 +332,16 @@ void neighbor::NameDbModule::ReadRemoteNameRequest(
       handler));
 }
 
+void neighbor::NameDbModule::ResolveRemoteNames(
+    std::vector<hci::RemoteNameCandidate> candidates, ResolveRemoteNamesCallback callback, os::Handler* handler) {
+  GetHandler()->Post(common::BindOnce(
+      &NameDbModule::impl::ResolveRemoteNames,
+      common::Unretained(pimpl_.get()),
+      std::move(candidates),
+      std::move(callback),
+      handler));
+}
+
 bool neighbor::NameDbModule::IsNameCached(hci::Address address) const {
   return pimpl_->IsNameCached(address);
 }
@@ -145,16 +352,26 @@ RemoteName neighbor::NameDbModule::ReadCachedRemoteName(hci::Address address) co
 
 void neighbor::NameDbModule::impl::Start() {
   name_module_ = module_.GetDependency<hci::RemoteNameRequestModule>();
+  storage_module_ = module_.GetDependency<storage::StorageModule>();
   handler_ = module_.GetHandler();
+  slots_.assign(os::GetSystemPropertyUint32(kNameCacheSizeProperty, kDefaultNameCacheSize), std::nullopt);
+  max_age_s_ = int64_t{os::GetSystemPropertyUint32(kNameMaxAgeProperty, kDefaultNameMaxAgeDays)} * 24 * 60 * 60;
+  LoadNames();
 }
 
-void neighbor::NameDbModule::impl::Stop() {}
+void neighbor::NameDbModule::impl::Stop() {
+  scheduler_.Clear();
+  scheduled_request_.reset();
+  address_to_name_map_.clear();
+  slots_.clear();
+}
 
 /**
  * Module methods here
  */
 void neighbor::NameDbModule::ListDependencies(ModuleList* list) const {
   list->add<hci::RemoteNameRequestModule>();
+  list->add<storage::StorageModule>();
 }
 
 void neighbor::NameDbModule::Start() {
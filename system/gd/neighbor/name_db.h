@@ -18,10 +18,13 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "common/bind.h"
+#include "common/callback.h"
 #include "hci/address.h"
 #include "hci/hci_packets.h"
+#include "hci/remote_name_scheduler.h"
 #include "module.h"
 
 namespace bluetooth {
@@ -29,11 +32,19 @@ namespace neighbor {
 
 using RemoteName = std::array<uint8_t, 248>;
 using ReadRemoteNameDbCallback = common::OnceCallback<void(hci::Address address, bool success)>;
+using ResolveRemoteNamesCallback = common::Callback<void(hci::Address address, bool success)>;
 
 class NameDbModule : public bluetooth::Module {
  public:
   virtual void ReadRemoteNameRequest(hci::Address address, ReadRemoteNameDbCallback callback, os::Handler* handler);
 
+  // Resolve the names of the devices found by an inquiry. Cached names and
+  // names from the extended inquiry response are reported right away, the
+  // other candidates are paged one at a time, in the order chosen by
+  // hci::RemoteNameScheduler. The callback is called once per candidate.
+  void ResolveRemoteNames(
+      std::vector<hci::RemoteNameCandidate> candidates, ResolveRemoteNamesCallback callback, os::Handler* handler);
+
   bool IsNameCached(hci::Address address) const;
   RemoteName ReadCachedRemoteName(hci::Address address) const;
 
@@ -22,20 +22,26 @@
 
 #include "common/callback.h"
 #include "os/handler.h"
+#include "os/internal/alarm_multiplexer.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
-// A single-shot alarm for reactor-based thread, implemented by Linux timerfd.
-// When it's constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister
-// itself from the thread.
+// A single-shot alarm for reactor-based thread. All the alarms of a handler share one Linux timerfd, see
+// internal::AlarmMultiplexer.
+// When it's constructed, it will add a timer to the multiplexer of the handler; when it's destroyed, it will remove
+// it.
 class Alarm {
  public:
   // Create and register a single-shot alarm on a given handler
   explicit Alarm(Handler* handler);
 
+  // Create a single-shot alarm that may fire up to |slack| late, so that it can share a wakeup with other alarms.
+  // Meant for timers that are not timing critical, such as supervision or cleanup timeouts.
+  Alarm(Handler* handler, std::chrono::milliseconds slack);
+
   Alarm(const Alarm&) = delete;
   Alarm& operator=(const Alarm&) = delete;
 
@@ -50,9 +56,9 @@ class Alarm {
 
  private:
   common::OnceClosure task_;
-  Handler* handler_;
-  int fd_ = 0;
-  Reactor::Reactable* token_;
+  std::shared_ptr<internal::AlarmMultiplexer> multiplexer_;
+  internal::AlarmMultiplexer::TimerId timer_id_;
+  std::chrono::milliseconds slack_;
   mutable std::mutex mutex_;
   void on_fire();
 };
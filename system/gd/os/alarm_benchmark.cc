@@ -14,9 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <future>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "common/bind.h"
@@ -140,3 +143,66 @@ BENCHMARK_REGISTER_F(BM_ReactableAlarm, periodic_accuracy)
     ->Args({2000, 15, 20})
     ->Iterations(1)
     ->UseRealTime();
+
+// Cost of arming then cancelling state.range(0) alarms sharing a handler, as done by connection supervision and
+// retransmission timers. With the shared timerfd only the earliest deadline reaches the kernel.
+BENCHMARK_DEFINE_F(BM_ReactableAlarm, schedule_and_cancel)(State& state) {
+  std::vector<std::unique_ptr<Alarm>> alarms;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    alarms.push_back(std::make_unique<Alarm>(handler_.get()));
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i < alarms.size(); i++) {
+      alarms[i]->Schedule(bluetooth::common::BindOnce([] {}), std::chrono::milliseconds(1000 + i));
+    }
+    for (auto& alarm : alarms) {
+      alarm->Cancel();
+    }
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_ReactableAlarm, schedule_and_cancel)->Arg(1)->Arg(10)->Arg(100)->Arg(500);
+
+// Lateness of state.range(0) alarms armed at once with spread out delays, reported as counters in microseconds
+BENCHMARK_DEFINE_F(BM_ReactableAlarm, firing_jitter)(State& state) {
+  std::vector<std::unique_ptr<Alarm>> alarms;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    alarms.push_back(std::make_unique<Alarm>(handler_.get()));
+  }
+  std::vector<int64_t> lateness_us(alarms.size());
+  for (auto _ : state) {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    int remaining = alarms.size();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < alarms.size(); i++) {
+      auto delay = std::chrono::milliseconds(1 + i % 20);
+      alarms[i]->Schedule(
+          bluetooth::common::BindOnce(
+              [](int64_t* lateness_us,
+                 std::chrono::steady_clock::time_point deadline,
+                 int* remaining,
+                 std::promise<void>* promise) {
+                *lateness_us =
+                    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - deadline)
+                        .count();
+                if (--(*remaining) == 0) {
+                  promise->set_value();
+                }
+              },
+              bluetooth::common::Unretained(&lateness_us[i]),
+              start + delay,
+              bluetooth::common::Unretained(&remaining),
+              bluetooth::common::Unretained(&promise)),
+          delay);
+    }
+    future.get();
+  }
+  std::sort(lateness_us.begin(), lateness_us.end());
+  state.counters["p50_us"] = lateness_us[lateness_us.size() / 2];
+  state.counters["p99_us"] = lateness_us[lateness_us.size() * 99 / 100];
+  state.counters["max_us"] = lateness_us.back();
+};
+
+BENCHMARK_REGISTER_F(BM_ReactableAlarm, firing_jitter)->Arg(10)->Arg(100)->Arg(500)->Iterations(10)->UseRealTime();
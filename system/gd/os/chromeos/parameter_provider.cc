@@ -32,6 +32,7 @@ std::mutex parameter_mutex;
 std::string config_file_path;
 std::string snoop_log_file_path;
 std::string snooz_log_file_path;
+std::string controller_capability_cache_file_path;
 std::string sysprops_file_path;
 }  // namespace
 
@@ -92,6 +93,21 @@ void ParameterProvider::OverrideSyspropsFilePath(const std::string& path) {
   sysprops_file_path = path;
 }
 
+std::string ParameterProvider::ControllerCapabilityCacheFilePath() {
+  {
+    std::lock_guard<std::mutex> lock(parameter_mutex);
+    if (!controller_capability_cache_file_path.empty()) {
+      return controller_capability_cache_file_path;
+    }
+  }
+  return "/var/lib/bluetooth/controller_cache.conf";
+}
+
+void ParameterProvider::OverrideControllerCapabilityCacheFilePath(const std::string& path) {
+  std::lock_guard<std::mutex> lock(parameter_mutex);
+  controller_capability_cache_file_path = path;
+}
+
 bluetooth_keystore::BluetoothKeystoreInterface* ParameterProvider::GetBtKeystoreInterface() {
   return nullptr;
 }
@@ -17,9 +17,11 @@
 #include "os/handler.h"
 
 #include <cstring>
+#include <thread>
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "os/internal/alarm_multiplexer.h"
 #include "os/log.h"
 #include "os/reactor.h"
 #include "os/utils.h"
@@ -28,7 +30,7 @@ namespace bluetooth {
 namespace os {
 using common::OnceClosure;
 
-Handler::Handler(Thread* thread) : tasks_(new std::queue<OnceClosure>()), thread_(thread) {
+Handler::Handler(Thread* thread) : cleared_(std::make_shared<std::atomic<bool>>(false)), thread_(thread) {
   event_ = thread_->GetReactor()->NewEvent();
   reactable_ = thread_->GetReactor()->Register(
       event_->Id(), common::Bind(&Handler::handle_next_event, common::Unretained(this)), common::Closure());
@@ -42,26 +44,47 @@ Handler::~Handler() {
   event_->Close();
 }
 
+std::shared_ptr<internal::AlarmMultiplexer> Handler::GetAlarmMultiplexer() {
+  std::lock_guard<std::mutex> lock(alarm_multiplexer_mutex_);
+  if (alarm_multiplexer_ == nullptr) {
+    alarm_multiplexer_ = std::make_shared<internal::AlarmMultiplexer>(thread_);
+  }
+  return alarm_multiplexer_;
+}
+
 void Handler::Post(OnceClosure closure) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (was_cleared()) {
-      LOG_WARN("Posting to a handler which has been cleared");
-      return;
-    }
-    tasks_->emplace(std::move(closure));
+  // Pairs with Clear(): either Clear() sees this post in progress and waits for it, or this post sees the handler
+  // cleared.
+  posting_.fetch_add(1);
+  if (was_cleared()) {
+    posting_.fetch_sub(1);
+    LOG_WARN("Posting to a handler which has been cleared");
+    return;
+  }
+  tasks_.Push(std::move(closure));
+  if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+    event_->Notify();
   }
-  event_->Notify();
+  posting_.fetch_sub(1);
 }
 
 void Handler::Clear() {
-  std::queue<OnceClosure>* tmp = nullptr;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     ASSERT_LOG(!was_cleared(), "Handlers must only be cleared once");
-    std::swap(tasks_, tmp);
+    cleared_->store(true);
+  }
+
+  // Let posts that started before the handler was cleared finish, then drop every pending closure
+  while (posting_.load() != 0) {
+    std::this_thread::yield();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    OnceClosure closure;
+    while (tasks_.Pop(&closure)) {
+    }
   }
-  delete tmp;
 
   event_->Clear();
 
@@ -75,20 +98,38 @@ void Handler::WaitUntilStopped(std::chrono::milliseconds timeout) {
 }
 
 void Handler::handle_next_event() {
-  common::OnceClosure closure;
+  // A closure may clear and destroy this handler, so only touch it after checking |cleared|
+  std::shared_ptr<std::atomic<bool>> cleared = cleared_;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    bool has_data = event_->Read();
+    if (cleared->load()) {
+      return;
+    }
+    event_->Read();
+    // Posts from here on notify again. Pairs with the exchange in Post(), so every closure pushed before a post saw
+    // the wakeup pending is visible below.
+    wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+  }
 
-    if (was_cleared()) {
+  for (size_t i = 0; i < kMaxTasksPerWakeup; i++) {
+    OnceClosure closure;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cleared->load() || !tasks_.Pop(&closure)) {
+        return;
+      }
+    }
+    std::move(closure).Run();
+    if (cleared->load()) {
       return;
     }
-    ASSERT_LOG(has_data, "Notified for work but no work available");
+  }
 
-    closure = std::move(tasks_->front());
-    tasks_->pop();
+  // Leave the remaining closures for the next wakeup so that the other reactables on this thread get to run
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!cleared->load() && !tasks_.Empty() && !wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+    event_->Notify();
   }
-  std::move(closure).Run();
 }
 
 }  // namespace os
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -24,15 +25,23 @@
 #include "common/bind.h"
 #include "common/callback.h"
 #include "common/contextual_callback.h"
+#include "os/internal/mpsc_queue.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
+namespace internal {
+class AlarmMultiplexer;
+}  // namespace internal
+
 // A message-queue style handler for reactor-based thread to handle incoming events from different threads. When it's
 // constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister itself
 // from the thread.
+//
+// Post() is lock-free: closures go through an intrusive MPSC queue and a burst of posts wakes the reactor once. The
+// reactor thread then runs up to kMaxTasksPerWakeup closures before yielding to the other reactables on the thread.
 class Handler : public common::IPostableContext {
  public:
   // Create and register a handler on given thread
@@ -44,7 +53,7 @@ class Handler : public common::IPostableContext {
   // Unregister this handler from the thread and release resource. Unhandled events will be discarded and not executed.
   virtual ~Handler();
 
-  // Enqueue a closure to the queue of this handler
+  // Enqueue a closure to the queue of this handler. Thread safe and does not block.
   virtual void Post(common::OnceClosure closure) override;
 
   // Remove all pending events from the queue of this handler
@@ -98,13 +107,25 @@ class Handler : public common::IPostableContext {
   friend class RepeatingAlarm;
 
  private:
+  static constexpr size_t kMaxTasksPerWakeup = 16;
+
+  // Return the timer multiplexer shared by the alarms of this handler, creating it on first use
+  std::shared_ptr<internal::AlarmMultiplexer> GetAlarmMultiplexer();
+
   inline bool was_cleared() const {
-    return tasks_ == nullptr;
+    return cleared_->load();
   };
-  std::queue<common::OnceClosure>* tasks_;
+  internal::MpscQueue<common::OnceClosure> tasks_;
+  // Shared so that handle_next_event() can tell when a closure cleared and destroyed this handler
+  std::shared_ptr<std::atomic<bool>> cleared_;
+  // Number of Post() calls in progress, which Clear() waits for before dropping the pending closures
+  std::atomic<int> posting_{0};
+  // Set while a reactor wakeup is pending, so that a burst of posts notifies |event_| only once
+  std::atomic<bool> wakeup_pending_{false};
   Thread* thread_;
   std::unique_ptr<Reactor::Event> event_;
   Reactor::Reactable* reactable_;
+  // Serializes popping from |tasks_| on the reactor thread with Clear()
   mutable std::mutex mutex_;
   void handle_next_event();
 };
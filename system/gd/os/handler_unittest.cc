@@ -18,6 +18,7 @@
 
 #include <future>
 #include <thread>
+#include <vector>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -94,6 +95,82 @@ TEST_F(HandlerTest, post_task_cleared) {
   ASSERT_EQ(val, 1);
 }
 
+TEST_F(HandlerTest, post_from_multiple_threads_in_order) {
+  constexpr int kNumThreads = 4;
+  constexpr int kPostsPerThread = 1000;
+  std::vector<int> last_seen(kNumThreads, -1);
+  int num_out_of_order = 0;
+  int num_run = 0;
+  std::promise<void> all_ran;
+  auto all_ran_future = all_ran.get_future();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kPostsPerThread; i++) {
+        // Only the handler thread touches the counters
+        handler_->Post(common::BindOnce(
+            [](std::vector<int>* last_seen,
+               int* num_out_of_order,
+               int* num_run,
+               std::promise<void>* all_ran,
+               int t,
+               int i) {
+              if ((*last_seen)[t] + 1 != i) {
+                (*num_out_of_order)++;
+              }
+              (*last_seen)[t] = i;
+              if (++(*num_run) == kNumThreads * kPostsPerThread) {
+                all_ran->set_value();
+              }
+            },
+            common::Unretained(&last_seen),
+            common::Unretained(&num_out_of_order),
+            common::Unretained(&num_run),
+            common::Unretained(&all_ran),
+            t,
+            i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(all_ran_future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  ASSERT_EQ(num_out_of_order, 0);
+  handler_->Clear();
+}
+
+TEST_F(HandlerTest, clear_while_posting) {
+  std::atomic<bool> stop = false;
+  std::thread poster([&]() {
+    while (!stop) {
+      handler_->Post(common::BindOnce([]() {}));
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  handler_->Clear();
+  stop = true;
+  poster.join();
+  handler_->WaitUntilStopped(std::chrono::seconds(1));
+}
+
+TEST_F(HandlerTest, closure_can_clear_its_handler) {
+  std::promise<void> cleared;
+  auto cleared_future = cleared.get_future();
+  handler_->Post(common::BindOnce(
+      [](Handler* handler, std::promise<void> cleared) {
+        handler->Clear();
+        cleared.set_value();
+      },
+      common::Unretained(handler_),
+      std::move(cleared)));
+  handler_->Post(common::BindOnce([]() { ASSERT_TRUE(false); }));
+  cleared_future.wait();
+  handler_->WaitUntilStopped(std::chrono::seconds(1));
+}
+
 void check_int(std::unique_ptr<int> number, std::shared_ptr<int> to_change) {
   *to_change = *number;
 }
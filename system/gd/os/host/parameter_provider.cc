@@ -32,6 +32,7 @@ std::mutex parameter_mutex;
 std::string config_file_path;
 std::string snoop_log_file_path;
 std::string snooz_log_file_path;
+std::string controller_capability_cache_file_path;
 }  // namespace
 
 // Write to $PWD/bt_stack.conf if $PWD can be found, otherwise, write to $HOME/bt_stack.conf
@@ -100,6 +101,26 @@ std::string ParameterProvider::SyspropsFilePath() {
   return "";
 }
 
+std::string ParameterProvider::ControllerCapabilityCacheFilePath() {
+  {
+    std::lock_guard<std::mutex> lock(parameter_mutex);
+    if (!controller_capability_cache_file_path.empty()) {
+      return controller_capability_cache_file_path;
+    }
+  }
+  char cwd[PATH_MAX] = {};
+  if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+    LOG_ERROR("Failed to get current working directory due to \"%s\", returning default", strerror(errno));
+    return "bt_controller_cache.conf";
+  }
+  return std::string(cwd) + "/bt_controller_cache.conf";
+}
+
+void ParameterProvider::OverrideControllerCapabilityCacheFilePath(const std::string& path) {
+  std::lock_guard<std::mutex> lock(parameter_mutex);
+  controller_capability_cache_file_path = path;
+}
+
 bluetooth_keystore::BluetoothKeystoreInterface* ParameterProvider::GetBtKeystoreInterface() {
   return nullptr;
 }
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/callback.h"
+#include "os/reactor.h"
+#include "os/thread.h"
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+// Multiplexes every Alarm and RepeatingAlarm of a Handler onto a single timerfd, backed by a min-heap of deadlines.
+// The timerfd is only reprogrammed when the earliest deadline changes, so scheduling a later alarm or cancelling one
+// costs no syscall. Timers armed with a slack have their deadline rounded up to a multiple of the slack, so that
+// non-critical timers scheduled close to each other expire in the same wakeup.
+class AlarmMultiplexer : public std::enable_shared_from_this<AlarmMultiplexer> {
+ public:
+  using TimerId = uint64_t;
+
+  explicit AlarmMultiplexer(Thread* thread);
+
+  AlarmMultiplexer(const AlarmMultiplexer&) = delete;
+  AlarmMultiplexer& operator=(const AlarmMultiplexer&) = delete;
+
+  ~AlarmMultiplexer();
+
+  // Add a disarmed timer running |on_fire| on the reactor thread each time it expires
+  TimerId AddTimer(common::Closure on_fire);
+
+  // Remove a timer. When called from another thread, waits for a running |on_fire| of this timer to return.
+  void RemoveTimer(TimerId id);
+
+  // (Re)arm a timer to expire after |delay|, then every |period| if it is non zero. A non zero |slack| allows the
+  // expiration to be delayed by up to |slack| to share a wakeup with other timers.
+  void Arm(TimerId id, std::chrono::milliseconds delay, std::chrono::milliseconds period, std::chrono::milliseconds slack);
+
+  // Disarm a timer. No-op if it's not armed.
+  void Disarm(TimerId id);
+
+  // Number of timers currently armed
+  size_t GetArmedCount() const;
+
+ private:
+  struct Timer {
+    common::Closure on_fire;
+    uint64_t generation = 0;
+    uint64_t period_ns = 0;
+    bool armed = false;
+  };
+
+  struct Deadline {
+    uint64_t when_ns;
+    TimerId id;
+    uint64_t generation;
+    bool operator>(const Deadline& other) const {
+      return when_ns > other.when_ns;
+    }
+  };
+
+  void on_fire();
+  bool is_current_locked(const Deadline& deadline) const;
+  void push_deadline_locked(Deadline deadline);
+  void program_timerfd_locked(uint64_t now_ns);
+
+  Thread* thread_;
+  int fd_;
+  Reactor::Reactable* reactable_;
+  mutable std::mutex mutex_;
+  std::condition_variable running_cv_;
+  TimerId next_id_ = 1;
+  // Timer whose |on_fire| is being run, 0 if none
+  TimerId running_ = 0;
+  std::unordered_map<TimerId, Timer> timers_;
+  // Min-heap of deadlines. Entries of disarmed or rearmed timers are left behind and skipped when they surface.
+  std::vector<Deadline> heap_;
+  size_t armed_count_ = 0;
+  // Deadline the timerfd is programmed for, 0 when it is not
+  uint64_t programmed_ns_ = 0;
+};
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+// DO NOT USE OUTSIDE os/
+// An unbounded, lock-free, multi-producer single-consumer FIFO queue.
+//
+// Push() may be called from any number of threads concurrently and never blocks. Pop() must only be called by one
+// thread at a time. Each element lives in an intrusive node allocated by Push(), so there is no shared buffer to
+// resize and producers only contend on a single atomic exchange.
+//
+// Pop() may transiently report the queue as empty while a concurrent Push() is half way through linking its node. The
+// pushed element becomes visible as soon as that Push() returns, so callers that signal the consumer after Push()
+// never lose an element.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Must not race with Push() or Pop()
+  ~MpscQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+  }
+
+  void Push(T value) {
+    Push(new Node(std::move(value)));
+  }
+
+  // Move the oldest element into |value| and return true, or return false if the queue is (transiently) empty. Must
+  // only be called by the consumer.
+  bool Pop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return false;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next == nullptr) {
+      // |tail| looks like the last node. If a producer swapped |head_| but did not link its node yet, wait for it.
+      if (tail != head_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      // Push the stub behind |tail| so that |tail| can be handed out.
+      Push(&stub_);
+      next = tail->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return false;
+      }
+    }
+
+    tail_ = next;
+    *value = std::move(*tail->value);
+    delete tail;
+    return true;
+  }
+
+  // Return true if there is no element to pop, with the same transient caveat as Pop(). Must only be called by the
+  // consumer.
+  bool Empty() const {
+    // Any node other than the stub at the tail holds an element that was not popped yet
+    return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T v) : value(std::move(v)) {}
+    std::atomic<Node*> next{nullptr};
+    std::optional<T> value;
+  };
+
+  void Push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  Node stub_;
+  std::atomic<Node*> head_;  // Most recently pushed node, written by producers
+  Node* tail_;               // Next node to pop, owned by the consumer
+};
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
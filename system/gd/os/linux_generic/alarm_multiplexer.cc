@@ -0,0 +1,262 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/internal/alarm_multiplexer.h"
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "common/bind.h"
+#include "os/linux_generic/linux.h"
+#include "os/log.h"
+#include "os/utils.h"
+
+#ifdef __ANDROID__
+#define ALARM_CLOCK CLOCK_BOOTTIME_ALARM
+#else
+#define ALARM_CLOCK CLOCK_BOOTTIME
+#endif
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+namespace {
+
+constexpr uint64_t kNanosPerMilli = 1000000;
+constexpr uint64_t kNanosPerSecond = 1000000000;
+
+#ifdef USE_FAKE_TIMERS
+// The fake timerfd counts in whole milliseconds
+constexpr uint64_t kMinimumDelayNs = kNanosPerMilli;
+// The fake clock jumps by arbitrary amounts, and a dedicated fake timerfd used to report every period crossed by the
+// jump. Keep doing so, so that tests can advance the clock in one go.
+constexpr bool kRunMissedPeriods = true;
+#else
+constexpr uint64_t kMinimumDelayNs = 1;
+// Like a dedicated timerfd, a periodic timer that fell behind runs once and then keeps its phase
+constexpr bool kRunMissedPeriods = false;
+#endif
+
+// Compact the heap when it holds more than this many entries per armed timer
+constexpr size_t kMaxStaleFactor = 2;
+constexpr size_t kMinHeapSizeToCompact = 32;
+
+uint64_t now_ns() {
+#ifdef USE_FAKE_TIMERS
+  return fake_timer::fake_timerfd_get_clock() * kNanosPerMilli;
+#else
+  timespec ts;
+  clock_gettime(CLOCK_BOOTTIME, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNanosPerSecond + ts.tv_nsec;
+#endif
+}
+
+}  // namespace
+
+AlarmMultiplexer::AlarmMultiplexer(Thread* thread)
+    : thread_(thread), fd_(TIMERFD_CREATE(ALARM_CLOCK, TFD_NONBLOCK)) {
+  ASSERT_LOG(fd_ != -1, "cannot create timerfd: %s", strerror(errno));
+
+  reactable_ = thread_->GetReactor()->Register(
+      fd_, common::Bind(&AlarmMultiplexer::on_fire, common::Unretained(this)), common::Closure());
+}
+
+AlarmMultiplexer::~AlarmMultiplexer() {
+  auto reactor = thread_->GetReactor();
+  reactor->Unregister(reactable_);
+  if (!thread_->IsSameThread()) {
+    reactor->WaitForUnregisteredReactable(std::chrono::milliseconds(1000));
+  }
+
+  int close_status;
+  RUN_NO_INTR(close_status = TIMERFD_CLOSE(fd_));
+  ASSERT(close_status != -1);
+}
+
+AlarmMultiplexer::TimerId AlarmMultiplexer::AddTimer(common::Closure on_fire) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TimerId id = next_id_++;
+  timers_[id].on_fire = std::move(on_fire);
+  return id;
+}
+
+void AlarmMultiplexer::RemoveTimer(TimerId id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto timer = timers_.find(id);
+  ASSERT(timer != timers_.end());
+  if (timer->second.armed) {
+    armed_count_--;
+  }
+  timers_.erase(timer);
+  if (!thread_->IsSameThread()) {
+    running_cv_.wait(lock, [this, id] { return running_ != id; });
+  }
+}
+
+void AlarmMultiplexer::Arm(
+    TimerId id, std::chrono::milliseconds delay, std::chrono::milliseconds period, std::chrono::milliseconds slack) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto timer = timers_.find(id);
+  ASSERT(timer != timers_.end());
+
+  uint64_t now = now_ns();
+  uint64_t when = now + delay.count() * kNanosPerMilli;
+  if (slack.count() > 0) {
+    uint64_t slack_ns = slack.count() * kNanosPerMilli;
+    when = (when + slack_ns - 1) / slack_ns * slack_ns;
+  }
+
+  Timer& entry = timer->second;
+  entry.generation++;
+  entry.period_ns = period.count() * kNanosPerMilli;
+  if (!entry.armed) {
+    entry.armed = true;
+    armed_count_++;
+  }
+  push_deadline_locked({when, id, entry.generation});
+
+  if (programmed_ns_ == 0 || when < programmed_ns_) {
+    program_timerfd_locked(now);
+  }
+}
+
+void AlarmMultiplexer::Disarm(TimerId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto timer = timers_.find(id);
+  ASSERT(timer != timers_.end());
+  if (!timer->second.armed) {
+    return;
+  }
+  // The heap entry goes stale; the timerfd is left as is and will at worst wake up once for nothing
+  timer->second.generation++;
+  timer->second.armed = false;
+  armed_count_--;
+}
+
+size_t AlarmMultiplexer::GetArmedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return armed_count_;
+}
+
+bool AlarmMultiplexer::is_current_locked(const Deadline& deadline) const {
+  auto timer = timers_.find(deadline.id);
+  return timer != timers_.end() && timer->second.generation == deadline.generation;
+}
+
+void AlarmMultiplexer::push_deadline_locked(Deadline deadline) {
+  if (heap_.size() >= kMinHeapSizeToCompact && heap_.size() > kMaxStaleFactor * armed_count_) {
+    heap_.erase(
+        std::remove_if(
+            heap_.begin(),
+            heap_.end(),
+            [this](const Deadline& entry) { return !is_current_locked(entry) || !timers_.at(entry.id).armed; }),
+        heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), std::greater<Deadline>());
+  }
+  heap_.push_back(deadline);
+  std::push_heap(heap_.begin(), heap_.end(), std::greater<Deadline>());
+}
+
+void AlarmMultiplexer::program_timerfd_locked(uint64_t now) {
+  while (!heap_.empty() && !is_current_locked(heap_.front())) {
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<Deadline>());
+    heap_.pop_back();
+  }
+  if (heap_.empty()) {
+    return;
+  }
+
+  uint64_t when = heap_.front().when_ns;
+  uint64_t delay = when > now ? std::max(when - now, kMinimumDelayNs) : kMinimumDelayNs;
+  itimerspec timer_itimerspec{
+      {/* interval for periodic timer */},
+      {static_cast<time_t>(delay / kNanosPerSecond), static_cast<long>(delay % kNanosPerSecond)}};
+  int result = TIMERFD_SETTIME(fd_, 0, &timer_itimerspec, nullptr);
+  ASSERT(result == 0);
+  programmed_ns_ = when;
+}
+
+void AlarmMultiplexer::on_fire() {
+  uint64_t times_invoked;
+  // Rearming from another thread may have reset the expiration count since the reactor saw the fd readable
+  [[maybe_unused]] auto bytes_read = read(fd_, &times_invoked, sizeof(uint64_t));
+
+  // A callback may drop the last reference to this multiplexer
+  std::shared_ptr<AlarmMultiplexer> self;
+  std::vector<Deadline> due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    self = weak_from_this().lock();
+    if (self == nullptr) {
+      return;
+    }
+    uint64_t now = now_ns();
+    programmed_ns_ = 0;
+    while (!heap_.empty() && heap_.front().when_ns <= now) {
+      Deadline deadline = heap_.front();
+      std::pop_heap(heap_.begin(), heap_.end(), std::greater<Deadline>());
+      heap_.pop_back();
+      if (!is_current_locked(deadline)) {
+        continue;
+      }
+
+      Timer& timer = timers_.at(deadline.id);
+      if (timer.period_ns == 0) {
+        timer.armed = false;
+        armed_count_--;
+        due.push_back(deadline);
+        continue;
+      }
+
+      uint64_t missed = (now - deadline.when_ns) / timer.period_ns;
+      size_t runs = kRunMissedPeriods ? missed + 1 : 1;
+      for (size_t i = 0; i < runs; i++) {
+        due.push_back(deadline);
+      }
+      push_deadline_locked({deadline.when_ns + (missed + 1) * timer.period_ns, deadline.id, deadline.generation});
+    }
+    program_timerfd_locked(now);
+  }
+
+  for (const auto& deadline : due) {
+    common::Closure on_fire;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Skip timers cancelled, rearmed or removed by an earlier callback of this batch
+      if (!is_current_locked(deadline)) {
+        continue;
+      }
+      on_fire = timers_.at(deadline.id).on_fire;
+      running_ = deadline.id;
+    }
+    on_fire.Run();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = 0;
+    }
+    running_cv_.notify_all();
+  }
+}
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -17,6 +17,7 @@
 #include "os/alarm.h"
 
 #include <future>
+#include <vector>
 
 #include "common/bind.h"
 #include "gtest/gtest.h"
@@ -50,9 +51,9 @@ class AlarmTest : public ::testing::Test {
     handler_->Post(common::BindOnce(fake_timerfd_advance, ms));
   }
   Alarm* alarm_;
+  Handler* handler_;
 
  private:
-  Handler* handler_;
   Thread* thread_;
 };
 
@@ -99,6 +100,43 @@ TEST_F(AlarmTest, delete_while_alarm_armed) {
   std::this_thread::sleep_for(std::chrono::milliseconds(10));
 }
 
+TEST_F(AlarmTest, alarms_of_a_handler_fire_in_deadline_order) {
+  Alarm second(handler_);
+  Alarm third(handler_);
+  std::vector<int> order;
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  alarm_->Schedule(
+      BindOnce(
+          [](std::vector<int>* order, std::promise<void>* promise) {
+            order->push_back(30);
+            promise->set_value();
+          },
+          common::Unretained(&order),
+          common::Unretained(&promise)),
+      std::chrono::milliseconds(30));
+  second.Schedule(
+      BindOnce([](std::vector<int>* order) { order->push_back(10); }, common::Unretained(&order)),
+      std::chrono::milliseconds(10));
+  third.Schedule(
+      BindOnce([](std::vector<int>* order) { order->push_back(20); }, common::Unretained(&order)),
+      std::chrono::milliseconds(20));
+  fake_timer_advance(30);
+  future.get();
+  ASSERT_EQ(order, std::vector<int>({10, 20, 30}));
+}
+
+TEST_F(AlarmTest, schedule_with_slack) {
+  Alarm alarm(handler_, std::chrono::milliseconds(20));
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  alarm.Schedule(BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)), std::chrono::milliseconds(5));
+  fake_timer_advance(5);
+  ASSERT_EQ(future.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+  fake_timer_advance(15);
+  future.get();
+}
+
 }  // namespace
 }  // namespace os
 }  // namespace bluetooth
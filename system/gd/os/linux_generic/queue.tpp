@@ -15,7 +15,7 @@
  */
 
 template <typename T>
-Queue<T>::Queue(size_t capacity) : enqueue_(capacity), dequeue_(0){};
+Queue<T>::Queue(size_t capacity) : capacity_(capacity), enqueue_(capacity), dequeue_(0){};
 
 template <typename T>
 Queue<T>::~Queue() {
@@ -25,14 +25,24 @@ Queue<T>::~Queue() {
 
 template <typename T>
 void Queue<T>::RegisterEnqueue(Handler* handler, EnqueueCallback callback) {
+  RegisterEnqueueInternal(
+      handler, base::Bind(&Queue<T>::EnqueueCallbackInternal, base::Unretained(this), std::move(callback)));
+}
+
+template <typename T>
+void Queue<T>::RegisterEnqueueBatch(Handler* handler, EnqueueBatchCallback callback) {
+  RegisterEnqueueInternal(
+      handler, base::Bind(&Queue<T>::EnqueueBatchCallbackInternal, base::Unretained(this), std::move(callback)));
+}
+
+template <typename T>
+void Queue<T>::RegisterEnqueueInternal(Handler* handler, common::Closure callback) {
   std::lock_guard<std::mutex> lock(mutex_);
   ASSERT(enqueue_.handler_ == nullptr);
   ASSERT(enqueue_.reactable_ == nullptr);
   enqueue_.handler_ = handler;
   enqueue_.reactable_ = enqueue_.handler_->thread_->GetReactor()->Register(
-      enqueue_.reactive_semaphore_.GetFd(),
-      base::Bind(&Queue<T>::EnqueueCallbackInternal, base::Unretained(this), std::move(callback)),
-      base::Closure());
+      enqueue_.reactive_semaphore_.GetFd(), std::move(callback), base::Closure());
 }
 
 template <typename T>
@@ -57,12 +67,26 @@ void Queue<T>::UnregisterEnqueue() {
 
 template <typename T>
 void Queue<T>::RegisterDequeue(Handler* handler, DequeueCallback callback) {
+  RegisterDequeueInternal(handler, std::move(callback));
+}
+
+template <typename T>
+void Queue<T>::RegisterDequeueBatch(Handler* handler, size_t max_batch_size, DequeueBatchCallback callback) {
+  ASSERT(max_batch_size > 0);
+  RegisterDequeueInternal(
+      handler,
+      base::Bind(
+          &Queue<T>::DequeueBatchCallbackInternal, base::Unretained(this), max_batch_size, std::move(callback)));
+}
+
+template <typename T>
+void Queue<T>::RegisterDequeueInternal(Handler* handler, common::Closure callback) {
   std::lock_guard<std::mutex> lock(mutex_);
   ASSERT(dequeue_.handler_ == nullptr);
   ASSERT(dequeue_.reactable_ == nullptr);
   dequeue_.handler_ = handler;
   dequeue_.reactable_ = dequeue_.handler_->thread_->GetReactor()->Register(
-      dequeue_.reactive_semaphore_.GetFd(), callback, base::Closure());
+      dequeue_.reactive_semaphore_.GetFd(), std::move(callback), base::Closure());
 }
 
 template <typename T>
@@ -103,6 +127,60 @@ std::unique_ptr<T> Queue<T>::TryDequeue() {
   return data;
 }
 
+template <typename T>
+std::vector<std::unique_ptr<T>> Queue<T>::TryDequeueBatch(size_t max_items) {
+  std::vector<std::unique_ptr<T>> batch;
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  size_t count = std::min(max_items, queue_.size());
+  if (count == 0) {
+    return batch;
+  }
+
+  batch.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    // The dequeue semaphore is in semaphore mode, so each read only takes one unit
+    dequeue_.reactive_semaphore_.Decrease();
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop();
+  }
+
+  enqueue_.reactive_semaphore_.Increase(count);
+
+  return batch;
+}
+
+template <typename T>
+void Queue<T>::DequeueBatchCallbackInternal(size_t max_batch_size, DequeueBatchCallback callback) {
+  auto batch = TryDequeueBatch(max_batch_size);
+  if (batch.empty()) {
+    return;
+  }
+  callback.Run(std::move(batch));
+}
+
+template <typename T>
+void Queue<T>::EnqueueBatchCallbackInternal(EnqueueBatchCallback callback) {
+  size_t space = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Only the enqueue end consumes space, so it can only grow until the batch is pushed below
+    space = capacity_ - queue_.size();
+  }
+  std::vector<std::unique_ptr<T>> batch = callback.Run(space);
+  ASSERT(batch.size() <= space);
+  if (batch.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& data : batch) {
+    ASSERT(data != nullptr);
+    enqueue_.reactive_semaphore_.Decrease();
+    queue_.push(std::move(data));
+  }
+  dequeue_.reactive_semaphore_.Increase(batch.size());
+}
+
 template <typename T>
 void Queue<T>::EnqueueCallbackInternal(EnqueueCallback callback) {
   std::unique_ptr<T> data = callback.Run();
@@ -22,6 +22,7 @@
 #include <chrono>
 #include <future>
 #include <unordered_map>
+#include <vector>
 
 #include "common/bind.h"
 #include "gtest/gtest.h"
@@ -810,6 +811,92 @@ TEST_F(QueueTest, unregister_dequeue_and_wait) {
   delete indicator;
 }
 
+TEST_F(QueueTest, try_dequeue_batch) {
+  Queue<int> queue(kQueueSize);
+  std::vector<int> enqueued;
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  queue.RegisterEnqueue(
+      enqueue_handler_,
+      common::Bind(
+          [](Queue<int>* queue, std::vector<int>* enqueued, std::promise<void>* promise) {
+            int value = enqueued->size();
+            enqueued->push_back(value);
+            if (enqueued->size() == static_cast<size_t>(kQueueSize)) {
+              queue->UnregisterEnqueue();
+              promise->set_value();
+            }
+            return std::make_unique<int>(value);
+          },
+          common::Unretained(&queue),
+          common::Unretained(&enqueued),
+          common::Unretained(&promise)));
+  ASSERT_EQ(future.wait_for(2s), std::future_status::ready);
+
+  auto first = queue.TryDequeueBatch(kHalfOfQueueSize - 1);
+  ASSERT_EQ(first.size(), static_cast<size_t>(kHalfOfQueueSize - 1));
+  auto second = queue.TryDequeueBatch(kDoubleOfQueueSize);
+  ASSERT_EQ(first.size() + second.size(), static_cast<size_t>(kQueueSize));
+  for (size_t i = 0; i < first.size(); i++) {
+    EXPECT_EQ(*first[i], static_cast<int>(i));
+  }
+  for (size_t i = 0; i < second.size(); i++) {
+    EXPECT_EQ(*second[i], static_cast<int>(first.size() + i));
+  }
+  EXPECT_TRUE(queue.TryDequeueBatch(kQueueSize).empty());
+  EXPECT_EQ(queue.TryDequeue(), nullptr);
+}
+
+TEST_F(QueueTest, enqueue_batch_and_dequeue_batch) {
+  Queue<int> queue(kQueueSize);
+  int next_to_enqueue = 0;
+  std::vector<int> dequeued;
+  std::promise<void> promise;
+  auto future = promise.get_future();
+
+  queue.RegisterDequeueBatch(
+      dequeue_handler_,
+      kHalfOfQueueSize,
+      common::Bind(
+          [](Queue<int>* queue, std::vector<int>* dequeued, std::promise<void>* promise,
+             std::vector<std::unique_ptr<int>> batch) {
+            EXPECT_LE(batch.size(), static_cast<size_t>(kHalfOfQueueSize));
+            for (auto& item : batch) {
+              dequeued->push_back(*item);
+            }
+            if (dequeued->size() == static_cast<size_t>(kDoubleOfQueueSize)) {
+              queue->UnregisterDequeue();
+              promise->set_value();
+            }
+          },
+          common::Unretained(&queue),
+          common::Unretained(&dequeued),
+          common::Unretained(&promise)));
+
+  queue.RegisterEnqueueBatch(
+      enqueue_handler_,
+      common::Bind(
+          [](Queue<int>* queue, int* next_to_enqueue, size_t max_items) {
+            EXPECT_LE(max_items, static_cast<size_t>(kQueueSize));
+            std::vector<std::unique_ptr<int>> batch;
+            while (batch.size() < max_items && *next_to_enqueue < kDoubleOfQueueSize) {
+              batch.push_back(std::make_unique<int>((*next_to_enqueue)++));
+            }
+            if (*next_to_enqueue == kDoubleOfQueueSize) {
+              queue->UnregisterEnqueue();
+            }
+            return batch;
+          },
+          common::Unretained(&queue),
+          common::Unretained(&next_to_enqueue)));
+
+  ASSERT_EQ(future.wait_for(2s), std::future_status::ready);
+  ASSERT_EQ(dequeued.size(), static_cast<size_t>(kDoubleOfQueueSize));
+  for (int i = 0; i < kDoubleOfQueueSize; i++) {
+    EXPECT_EQ(dequeued[i], i);
+  }
+}
+
 // Create all threads for death tests in the function that dies
 class QueueDeathTest : public ::testing::Test {
  public:
@@ -908,6 +995,34 @@ TEST_F(EnqueueBufferTest, enqueue) {
   ASSERT_FALSE(enqueue_.registered_);
 }
 
+TEST_F(EnqueueBufferTest, enqueue_batch) {
+  int num_items = 10;
+  std::vector<std::unique_ptr<int>> batch;
+  for (int i = 0; i < num_items; i++) {
+    batch.push_back(std::make_unique<int>(i));
+  }
+  enqueue_buffer_.EnqueueBatch(std::move(batch), handler_);
+  SynchronizeHandler();
+  for (int i = 0; i < num_items; i++) {
+    ASSERT_EQ(enqueue_.queue_.front(), i);
+    enqueue_.queue_.pop();
+  }
+  ASSERT_FALSE(enqueue_.registered_);
+}
+
+TEST_F(EnqueueBufferTest, notify_on_enqueue) {
+  int num_items = 10;
+  int sum = 0;
+  enqueue_buffer_.NotifyOnEnqueue(
+      common::Bind([](int* sum, const int& item) { *sum += item; }, common::Unretained(&sum)));
+  for (int i = 0; i < num_items; i++) {
+    enqueue_buffer_.Enqueue(std::make_unique<int>(i), handler_);
+  }
+  SynchronizeHandler();
+  ASSERT_EQ(sum, 45);
+  ASSERT_EQ(enqueue_.queue_.size(), static_cast<size_t>(num_items));
+}
+
 TEST_F(EnqueueBufferTest, clear) {
   enqueue_.dont_handle_register_enqueue_ = true;
   int num_items = 10;
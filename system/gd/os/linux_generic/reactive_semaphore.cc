@@ -45,8 +45,11 @@ void ReactiveSemaphore::Decrease() {
 }
 
 void ReactiveSemaphore::Increase() {
-  uint64_t val = 1;
-  auto write_result = eventfd_write(fd_, val);
+  Increase(1);
+}
+
+void ReactiveSemaphore::Increase(uint64_t count) {
+  auto write_result = eventfd_write(fd_, count);
   ASSERT_LOG(write_result != -1, "increase failed: %s", strerror(errno));
 }
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "os/utils.h"
 
 namespace bluetooth {
@@ -35,6 +37,8 @@ class ReactiveSemaphore {
   void Decrease();
   // Increase the value of |fd_|, this will cause a crash if |fd_| unwritable.
   void Increase();
+  // Increase the value of |fd_| by |count| with a single write, this will cause a crash if |fd_| unwritable.
+  void Increase(uint64_t count);
   int GetFd();
 
  private:
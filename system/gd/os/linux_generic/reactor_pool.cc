@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/reactor_pool.h"
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace os {
+
+ReactorPool::ReactorPool(const std::string& name, size_t num_shards, Thread::Priority priority) {
+  ASSERT_LOG(num_shards > 0, "A reactor pool needs at least one shard");
+  for (size_t i = 0; i < num_shards; i++) {
+    shards_.push_back(std::make_unique<Thread>(name + "_" + std::to_string(i), priority));
+  }
+}
+
+ReactorPool::~ReactorPool() {
+  Stop();
+}
+
+void ReactorPool::Stop() {
+  for (auto& shard : shards_) {
+    shard->Stop();
+  }
+}
+
+size_t ReactorPool::NumShards() const {
+  return shards_.size();
+}
+
+Thread* ReactorPool::GetShard(size_t index) const {
+  ASSERT_LOG(index < shards_.size(), "Shard %zu out of range, pool has %zu shards", index, shards_.size());
+  return shards_[index].get();
+}
+
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/reactor_pool.h"
+
+#include <future>
+
+#include "common/bind.h"
+#include "gtest/gtest.h"
+#include "os/handler.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+TEST(ReactorPoolTest, shards_are_distinct_threads) {
+  ReactorPool pool("test_shard", 2, Thread::Priority::NORMAL);
+  ASSERT_EQ(pool.NumShards(), 2u);
+  EXPECT_EQ(pool.GetShard(0)->GetThreadName(), "test_shard_0");
+  EXPECT_EQ(pool.GetShard(1)->GetThreadName(), "test_shard_1");
+  EXPECT_NE(pool.GetShard(0)->GetReactor(), pool.GetShard(1)->GetReactor());
+}
+
+TEST(ReactorPoolTest, cross_shard_post) {
+  ReactorPool pool("test_shard", 2, Thread::Priority::NORMAL);
+  Handler first(pool.GetShard(0));
+  Handler second(pool.GetShard(1));
+
+  std::promise<bool> promise;
+  auto future = promise.get_future();
+  Thread* second_shard = pool.GetShard(1);
+  first.Post(common::BindOnce(
+      [](Handler* second, Thread* second_shard, std::promise<bool> promise) {
+        second->Post(common::BindOnce(
+            [](Thread* second_shard, std::promise<bool> promise) {
+              promise.set_value(second_shard->IsSameThread());
+            },
+            common::Unretained(second_shard),
+            std::move(promise)));
+      },
+      common::Unretained(&second),
+      common::Unretained(second_shard),
+      std::move(promise)));
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  EXPECT_TRUE(future.get());
+
+  first.Clear();
+  second.Clear();
+  first.WaitUntilStopped(std::chrono::seconds(1));
+  second.WaitUntilStopped(std::chrono::seconds(1));
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
@@ -21,7 +21,9 @@
 #include "os/wakelock_manager.h"
 
 #include <cerrno>
+#include <map>
 #include <mutex>
+#include <vector>
 
 #include "os/internal/wakelock_native.h"
 #include "os/log.h"
@@ -43,6 +45,66 @@ uint64_t now_ms() {
 
 const std::string WakelockManager::kBtWakelockId = "bluetooth_gd_timer";
 
+// Upper bounds (exclusive) of the hold time histogram buckets. The last bucket counts every hold at least as long as
+// the last bound.
+static constexpr uint64_t kHoldTimeBucketBoundsMs[] = {10, 100, 1000, 10000};
+static constexpr size_t kHoldTimeBuckets = sizeof(kHoldTimeBucketBoundsMs) / sizeof(kHoldTimeBucketBoundsMs[0]) + 1;
+
+// A user of the wakelock, identified by the reason it was acquired for
+struct WakelockHolder {
+  bool is_held = false;
+  uint64_t acquired_timestamp_ms = 0;
+  size_t acquired_count = 0;
+  uint64_t max_held_interval_ms = 0;
+  uint64_t total_held_interval_ms = 0;
+  size_t held_interval_histogram[kHoldTimeBuckets] = {};
+
+  void OnAcquired() {
+    is_held = true;
+    acquired_timestamp_ms = now_ms();
+    acquired_count++;
+  }
+
+  void OnReleased() {
+    is_held = false;
+    uint64_t delta_ms = now_ms() - acquired_timestamp_ms;
+    if (delta_ms > max_held_interval_ms) {
+      max_held_interval_ms = delta_ms;
+    }
+    total_held_interval_ms += delta_ms;
+    size_t bucket = 0;
+    while (bucket < kHoldTimeBuckets - 1 && delta_ms >= kHoldTimeBucketBoundsMs[bucket]) {
+      bucket++;
+    }
+    held_interval_histogram[bucket]++;
+  }
+
+  flatbuffers::Offset<WakelockHolderData> GetDumpsysData(
+      flatbuffers::FlatBufferBuilder* fb_builder, const std::string& reason, uint64_t just_now_ms) const {
+    uint64_t total_held_ms = total_held_interval_ms;
+    uint64_t max_held_ms = max_held_interval_ms;
+    if (is_held) {
+      uint64_t delta_ms = just_now_ms - acquired_timestamp_ms;
+      total_held_ms += delta_ms;
+      if (delta_ms > max_held_ms) {
+        max_held_ms = delta_ms;
+      }
+    }
+    std::vector<int32_t> histogram(held_interval_histogram, held_interval_histogram + kHoldTimeBuckets);
+
+    auto reason_offset = fb_builder->CreateString(reason);
+    auto histogram_offset = fb_builder->CreateVector(histogram);
+    WakelockHolderDataBuilder builder(*fb_builder);
+    builder.add_reason(reason_offset);
+    builder.add_is_held(is_held);
+    builder.add_acquired_count(acquired_count);
+    builder.add_total_held_millis(total_held_ms);
+    builder.add_max_held_millis(max_held_ms);
+    builder.add_held_millis_histogram(histogram_offset);
+    return builder.Finish();
+  }
+};
+
 // Wakelock statistics for the "bluetooth_timer"
 struct WakelockManager::Stats {
   bool is_acquired = false;
@@ -59,6 +121,8 @@ struct WakelockManager::Stats {
   uint64_t last_reset_timestamp_ms = now_ms();
   StatusCode last_acquired_error = StatusCode::SUCCESS;
   StatusCode last_released_error = StatusCode::SUCCESS;
+  std::map<std::string, WakelockHolder> holders;
+  size_t active_holders = 0;
 
   void Reset() {
     is_acquired = false;
@@ -75,6 +139,8 @@ struct WakelockManager::Stats {
     last_reset_timestamp_ms = now_ms();
     last_acquired_error = StatusCode::SUCCESS;
     last_released_error = StatusCode::SUCCESS;
+    holders.clear();
+    active_holders = 0;
   }
 
   // Update the Bluetooth acquire wakelock statistics.
@@ -156,8 +222,15 @@ struct WakelockManager::Stats {
       avg_interval_ms = total_interval_ms / acquired_count;
     }
 
+    std::vector<flatbuffers::Offset<WakelockHolderData>> holder_offsets;
+    for (const auto& [reason, holder] : holders) {
+      holder_offsets.push_back(holder.GetDumpsysData(fb_builder, reason, just_now_ms));
+    }
+    auto holders_offset = fb_builder->CreateVector(holder_offsets);
+    auto title_offset = fb_builder->CreateString("Bluetooth Wakelock Statistics");
+
     WakelockManagerDataBuilder builder(*fb_builder);
-    builder.add_title(fb_builder->CreateString("Bluetooth Wakelock Statistics"));
+    builder.add_title(title_offset);
     builder.add_is_acquired(is_acquired);
     builder.add_is_native(is_native);
     builder.add_acquired_count(acquired_count);
@@ -174,6 +247,7 @@ struct WakelockManager::Stats {
     builder.add_avg_interval_millis(avg_interval_ms);
     builder.add_total_interval_millis(total_interval_ms);
     builder.add_total_time_since_reset_millis(just_now_ms - last_reset_timestamp_ms);
+    builder.add_holders(holders_offset);
     return builder.Finish();
   }
 };
@@ -244,6 +318,33 @@ bool WakelockManager::Release() {
   return status == StatusCode ::SUCCESS;
 }
 
+bool WakelockManager::Acquire(const std::string& reason) {
+  std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
+  WakelockHolder& holder = pstats_->holders[reason];
+  if (holder.is_held) {
+    return pstats_->is_acquired;
+  }
+  holder.OnAcquired();
+  if (pstats_->active_holders++ > 0 && pstats_->is_acquired) {
+    return true;
+  }
+  return Acquire();
+}
+
+bool WakelockManager::Release(const std::string& reason) {
+  std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
+  auto iter = pstats_->holders.find(reason);
+  if (iter == pstats_->holders.end() || !iter->second.is_held) {
+    return true;
+  }
+  iter->second.OnReleased();
+  ASSERT(pstats_->active_holders > 0);
+  if (--pstats_->active_holders > 0 || !pstats_->is_acquired) {
+    return true;
+  }
+  return Release();
+}
+
 void WakelockManager::CleanUp() {
   std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
   if (!initialized_) {
@@ -189,4 +189,50 @@ TEST_F(WakelockManagerTest, test_with_os_callouts_in_a_loop_and_dump) {
   }
 }
 
+TEST_F(WakelockManagerTest, test_reasons_share_wakelock_and_dump) {
+  TestOsCallouts os_callouts;
+  WakelockManager::Get().SetOsCallouts(&os_callouts, handler_);
+
+  WakelockManager::Get().Acquire("scan");
+  WakelockManager::Get().Acquire("advertise");
+  // Acquiring again for a reason that already holds the wakelock does nothing
+  WakelockManager::Get().Acquire("scan");
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(1)));
+
+  WakelockManager::Get().Release("scan");
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(1)));
+
+  // Releasing a reason that does not hold the wakelock does nothing
+  WakelockManager::Get().Release("scan");
+  WakelockManager::Get().Release("unknown");
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(1)));
+
+  WakelockManager::Get().Release("advertise");
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(0)));
+
+  {
+    flatbuffers::FlatBufferBuilder builder(1024);
+    auto offset = WakelockManager::Get().GetDumpsysData(&builder);
+    FinishWakelockManagerDataBuffer(builder, offset);
+    auto data = GetWakelockManagerData(builder.GetBufferPointer());
+
+    ASSERT_EQ(data->acquired_count(), 1);
+    ASSERT_EQ(data->released_count(), 1);
+    ASSERT_NE(data->holders(), nullptr);
+    ASSERT_EQ(data->holders()->size(), 2u);
+    for (const auto* holder : *data->holders()) {
+      ASSERT_FALSE(holder->is_held());
+      ASSERT_EQ(holder->acquired_count(), 1);
+      ASSERT_EQ(holder->held_millis_histogram()->size(), 5u);
+    }
+  }
+
+  WakelockManager::Get().CleanUp();
+  SyncHandler();
+}
+
 }  // namespace testing
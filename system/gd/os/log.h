@@ -191,11 +191,31 @@ static_assert(LOG_TAG != nullptr, "LOG_TAG should never be NULL");
 // location of the log emitting statement, so far they are only used by
 // LogMsg, where the source locations is passed in.
 
+#if defined(FUZZ_TARGET)
+#define _LOG_BINARY_OR_INT(level, log_int, fmt, args...) \
+  log_int(_PREPEND_SRC_LOC_IN_LOG(fmt, ##args))
+#else
+#include "os/logging/binary_log.h"
+
+// When the binary log records |level|, only the call site and the raw
+// arguments are copied, and the formatting is deferred to its dump.
+#define _LOG_BINARY_OR_INT(level, log_int, fmt, args...)                      \
+  do {                                                                        \
+    if (bluetooth::os::BinaryLog::IsEnabled(level)) {                         \
+      static constexpr bluetooth::os::BinaryLogSite _site{                    \
+          level, LOG_TAG, __FILE__, __LINE__, fmt};                           \
+      bluetooth::os::BinaryLog::Write(&_site, __func__, ##args);              \
+    } else {                                                                  \
+      log_int(_PREPEND_SRC_LOC_IN_LOG(fmt, ##args));                          \
+    }                                                                         \
+  } while (false)
+#endif
+
 #define LOG_VERBOSE(fmt, args...)                                             \
-  LOG_VERBOSE_INT(_PREPEND_SRC_LOC_IN_LOG(fmt, ##args))
+  _LOG_BINARY_OR_INT(LOG_TAG_VERBOSE, LOG_VERBOSE_INT, fmt, ##args)
 
 #define LOG_DEBUG(fmt, args...)                                               \
-  LOG_DEBUG_INT(_PREPEND_SRC_LOC_IN_LOG(fmt, ##args))
+  _LOG_BINARY_OR_INT(LOG_TAG_DEBUG, LOG_DEBUG_INT, fmt, ##args)
 
 #define LOG_INFO(fmt, args...)                                                \
   LOG_INFO_INT(_PREPEND_SRC_LOC_IN_LOG(fmt, ##args))
@@ -0,0 +1,318 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "os/logging/binary_log.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+#include "os/log_tags.h"
+
+namespace bluetooth {
+namespace os {
+
+namespace {
+
+// Copy of a record taken while its thread may write the next ones
+struct Entry {
+  int tid;
+  const BinaryLogSite* site;
+  const char* function;
+  int64_t timestamp_ms;
+  bool truncated;
+  std::vector<uint8_t> arguments;
+};
+
+const char* LevelText(int level) {
+  switch (level) {
+    case LOG_TAG_DEBUG:
+      return "D";
+    case LOG_TAG_VERBOSE:
+      return "V";
+    default:
+      return "I";
+  }
+}
+
+class ArgumentReader {
+ public:
+  explicit ArgumentReader(const std::vector<uint8_t>& arguments) : arguments_(arguments) {}
+
+  bool Next(BinaryLog::ArgumentType* type, uint64_t* value, std::string* string) {
+    if (offset_ >= arguments_.size()) {
+      return false;
+    }
+    *type = static_cast<BinaryLog::ArgumentType>(arguments_[offset_++]);
+    switch (*type) {
+      case BinaryLog::STRING: {
+        size_t length = arguments_[offset_++];
+        string->assign(reinterpret_cast<const char*>(&arguments_[offset_]), length);
+        offset_ += length;
+        break;
+      }
+      case BinaryLog::UNKNOWN:
+        break;
+      default:
+        std::memcpy(value, &arguments_[offset_], sizeof(*value));
+        offset_ += sizeof(*value);
+    }
+    return true;
+  }
+
+ private:
+  const std::vector<uint8_t>& arguments_;
+  size_t offset_ = 0;
+};
+
+// Length modifiers of the conversion, e.g. "hh" or "ll"
+std::string GetLengthModifier(const std::string& spec) {
+  size_t end = spec.size() - 1;
+  size_t start = end;
+  while (start > 0 && std::strchr("hljztL", spec[start - 1]) != nullptr) {
+    start--;
+  }
+  return spec.substr(start, end - start);
+}
+
+// Removes the length modifiers of the conversion, to print the value with |length| instead
+std::string WithLengthModifier(const std::string& spec, const std::string& length) {
+  std::string modifier = GetLengthModifier(spec);
+  return spec.substr(0, spec.size() - 1 - modifier.size()) + length + spec.back();
+}
+
+// Truncates |value| to the type the conversion expects, as printf would read it
+int64_t ToSigned(uint64_t value, const std::string& modifier) {
+  if (modifier == "hh") return static_cast<signed char>(value);
+  if (modifier == "h") return static_cast<short>(value);
+  if (modifier.empty()) return static_cast<int>(value);
+  if (modifier == "l") return static_cast<long>(value);
+  return static_cast<int64_t>(value);
+}
+
+uint64_t ToUnsigned(uint64_t value, const std::string& modifier) {
+  if (modifier == "hh") return static_cast<unsigned char>(value);
+  if (modifier == "h") return static_cast<unsigned short>(value);
+  if (modifier.empty()) return static_cast<unsigned int>(value);
+  if (modifier == "l") return static_cast<unsigned long>(value);
+  return value;
+}
+
+std::string FormatArgument(
+    const std::string& spec, BinaryLog::ArgumentType type, uint64_t value, const std::string& string) {
+  char buffer[256];
+  char conversion = spec.back();
+  std::string modifier = GetLengthModifier(spec);
+  if (type == BinaryLog::UNKNOWN) {
+    return "(?)";
+  }
+  switch (conversion) {
+    case 'd':
+    case 'i':
+      snprintf(buffer, sizeof(buffer), WithLengthModifier(spec, "ll").c_str(), (long long)ToSigned(value, modifier));
+      break;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      snprintf(
+          buffer,
+          sizeof(buffer),
+          WithLengthModifier(spec, "ll").c_str(),
+          (unsigned long long)ToUnsigned(value, modifier));
+      break;
+    case 'c':
+      snprintf(buffer, sizeof(buffer), WithLengthModifier(spec, "").c_str(), static_cast<int>(value));
+      break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A': {
+      double number;
+      std::memcpy(&number, &value, sizeof(number));
+      if (type != BinaryLog::DOUBLE) {
+        number = static_cast<double>(static_cast<int64_t>(value));
+      }
+      snprintf(buffer, sizeof(buffer), WithLengthModifier(spec, "").c_str(), number);
+      break;
+    }
+    case 's':
+      snprintf(
+          buffer,
+          sizeof(buffer),
+          WithLengthModifier(spec, "").c_str(),
+          type == BinaryLog::STRING ? string.c_str() : "(?)");
+      break;
+    case 'p':
+      snprintf(buffer, sizeof(buffer), WithLengthModifier(spec, "").c_str(), reinterpret_cast<void*>(value));
+      break;
+    default:
+      return spec;
+  }
+  return buffer;
+}
+
+std::string FormatMessage(const Entry& entry) {
+  const char* format = entry.site->format;
+  ArgumentReader reader(entry.arguments);
+  std::string message;
+  for (const char* c = format; *c != '\0'; c++) {
+    if (*c != '%') {
+      message += *c;
+      continue;
+    }
+    if (c[1] == '%') {
+      message += '%';
+      c++;
+      continue;
+    }
+    // Flags, width, precision, length modifiers and conversion
+    std::string spec = "%";
+    bool missing_argument = false;
+    for (c++; *c != '\0'; c++) {
+      if (*c == '*') {
+        // The width or precision is an argument
+        BinaryLog::ArgumentType type;
+        uint64_t value = 0;
+        std::string string;
+        if (!reader.Next(&type, &value, &string)) {
+          missing_argument = true;
+        }
+        spec += std::to_string(static_cast<int>(value));
+        continue;
+      }
+      spec += *c;
+      if (std::strchr("diouxXcseEfFgGaAp", *c) != nullptr) {
+        break;
+      }
+      if (std::strchr("-+ #0123456789.hljztL", *c) == nullptr) {
+        // Not a conversion printf knows, e.g. %n
+        break;
+      }
+    }
+    if (*c == '\0') {
+      message += spec;
+      break;
+    }
+    BinaryLog::ArgumentType type;
+    uint64_t value = 0;
+    std::string string;
+    if (missing_argument || !reader.Next(&type, &value, &string)) {
+      message += entry.truncated ? "..." : spec;
+      continue;
+    }
+    message += FormatArgument(spec, type, value, string);
+  }
+  return message;
+}
+
+std::string FormatEntry(const Entry& entry) {
+  // Same layout as the logs written to stderr
+  time_t seconds = static_cast<time_t>(entry.timestamp_ms / 1000);
+  struct tm tm;
+  localtime_r(&seconds, &tm);
+  char time[32];
+  size_t length = std::strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", &tm);
+  snprintf(time + length, sizeof(time) - length, ".%03d", static_cast<int>(entry.timestamp_ms % 1000));
+
+  const BinaryLogSite* site = entry.site;
+  char prefix[512];
+  snprintf(
+      prefix,
+      sizeof(prefix),
+      "%s %7d %s %s: %s:%d - %s: ",
+      time,
+      entry.tid,
+      LevelText(site->level),
+      site->tag,
+      site->file,
+      site->line,
+      entry.function);
+  return prefix + FormatMessage(entry);
+}
+
+}  // namespace
+
+std::vector<std::string> BinaryLog::GetLines() {
+  std::vector<Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(GetRegistryMutex());
+    for (const auto* buffer : GetRegistry()) {
+      uint64_t next = buffer->next.load(std::memory_order_acquire);
+      uint64_t first = next > kRecordsPerThread ? next - kRecordsPerThread : 0;
+      for (uint64_t index = first; index < next; index++) {
+        const Record& record = buffer->records[index % kRecordsPerThread];
+        uint64_t sequence = record.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+          // Being overwritten
+          continue;
+        }
+        size_t size = std::min<size_t>(record.size, sizeof(record.arguments));
+        Entry entry{
+            buffer->tid,
+            record.site,
+            record.function,
+            record.timestamp_ms,
+            record.truncated,
+            std::vector<uint8_t>(record.arguments, record.arguments + size)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) != sequence) {
+          continue;
+        }
+        entries.push_back(std::move(entry));
+      }
+    }
+  }
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.timestamp_ms < b.timestamp_ms;
+  });
+
+  std::vector<std::string> lines;
+  lines.reserve(entries.size());
+  for (const auto& entry : entries) {
+    lines.push_back(FormatEntry(entry));
+  }
+  return lines;
+}
+
+void BinaryLog::Dump(int fd) {
+  if (max_level_.load(std::memory_order_relaxed) == kDisabled) {
+    return;
+  }
+  dprintf(fd, "\nBinary log:\n");
+  for (const auto& line : GetLines()) {
+    dprintf(fd, "  %s\n", line.c_str());
+  }
+}
+
+void BinaryLog::Clear() {
+  std::lock_guard<std::mutex> lock(GetRegistryMutex());
+  for (auto* buffer : GetRegistry()) {
+    for (auto& record : buffer->records) {
+      record.sequence.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace os
+}  // namespace bluetooth
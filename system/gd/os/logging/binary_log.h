@@ -0,0 +1,215 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bluetooth {
+namespace os {
+
+// Call site of a binary log statement. Each site is a constant of its function, and its address identifies the format
+// in the records.
+struct BinaryLogSite {
+  int level;
+  const char* tag;
+  const char* file;
+  int line;
+  const char* format;
+};
+
+// Deferred formatting backend of LOG_DEBUG and LOG_VERBOSE. When enabled, the statements only copy their site and
+// their raw arguments into a ring of fixed size records owned by the calling thread, without taking a lock. The
+// records are formatted with printf semantics when they are dumped.
+class BinaryLog {
+ public:
+  // Most verbose level recorded, see LogLevels; logs at this level and below, down to LOG_TAG_DEBUG, are recorded
+  // instead of being sent to logcat or syslog
+  static constexpr char kPropertyLevel[] = "persist.bluetooth.binary_log.level";
+  static constexpr int kDisabled = -1;
+
+  static constexpr size_t kRecordSize = 128;
+  static constexpr size_t kRecordsPerThread = 512;
+  // Longest string argument kept, the rest is dropped
+  static constexpr size_t kMaxStringSize = 48;
+
+  enum ArgumentType : uint8_t { SIGNED, UNSIGNED, DOUBLE, POINTER, STRING, UNKNOWN };
+
+  struct Record {
+    // Odd while the record is written, 2 * (index + 1) once record |index| of the thread is complete
+    std::atomic<uint64_t> sequence{0};
+    const BinaryLogSite* site;
+    const char* function;
+    int64_t timestamp_ms;
+    uint8_t size;
+    bool truncated;
+    uint8_t arguments[kRecordSize - sizeof(sequence) - 2 * sizeof(void*) - sizeof(int64_t) - 2];
+  };
+
+  struct ThreadBuffer {
+    std::atomic<bool> in_use{false};
+    int tid = 0;
+    std::atomic<uint64_t> next{0};
+    std::array<Record, kRecordsPerThread> records;
+  };
+
+  static bool IsEnabled(int level) {
+    return level <= max_level_.load(std::memory_order_relaxed);
+  }
+
+  static void SetLevel(int level) {
+    max_level_.store(level, std::memory_order_relaxed);
+  }
+
+  template <typename... Args>
+  static void Write(const BinaryLogSite* site, const char* function, Args... args) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    uint64_t index = buffer->next.load(std::memory_order_relaxed);
+    Record& record = buffer->records[index % kRecordsPerThread];
+    record.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.site = site;
+    record.function = function;
+    record.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+    record.size = 0;
+    record.truncated = false;
+    (Encode(record, args), ...);
+    record.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer->next.store(index + 1, std::memory_order_release);
+  }
+
+  // Formats the records of all the threads, oldest first
+  static std::vector<std::string> GetLines();
+  static void Dump(int fd);
+  static void Clear();
+
+  // Registry of the thread buffers. The buffer of an exited thread keeps its records until another thread takes it.
+  static std::mutex& GetRegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::vector<ThreadBuffer*>& GetRegistry() {
+    static std::vector<ThreadBuffer*> buffers;
+    return buffers;
+  }
+
+ private:
+  struct ThreadBufferHolder {
+    ThreadBufferHolder() {
+      std::lock_guard<std::mutex> lock(GetRegistryMutex());
+      for (auto* free_buffer : GetRegistry()) {
+        if (!free_buffer->in_use.load(std::memory_order_relaxed)) {
+          buffer = free_buffer;
+          break;
+        }
+      }
+      if (buffer == nullptr) {
+        buffer = new ThreadBuffer();
+        GetRegistry().push_back(buffer);
+      }
+      buffer->tid = static_cast<int>(syscall(SYS_gettid));
+      buffer->in_use.store(true, std::memory_order_relaxed);
+    }
+    ~ThreadBufferHolder() {
+      std::lock_guard<std::mutex> lock(GetRegistryMutex());
+      buffer->in_use.store(false, std::memory_order_relaxed);
+    }
+    ThreadBuffer* buffer = nullptr;
+  };
+
+  static ThreadBuffer* GetThreadBuffer() {
+    thread_local ThreadBufferHolder holder;
+    return holder.buffer;
+  }
+
+  static bool Reserve(Record& record, size_t size) {
+    if (record.truncated || record.size + size > sizeof(record.arguments)) {
+      record.truncated = true;
+      return false;
+    }
+    return true;
+  }
+
+  template <typename T>
+  static void EncodeValue(Record& record, ArgumentType type, T value) {
+    if (!Reserve(record, 1 + sizeof(value))) {
+      return;
+    }
+    record.arguments[record.size++] = type;
+    std::memcpy(&record.arguments[record.size], &value, sizeof(value));
+    record.size += sizeof(value);
+  }
+
+  static void EncodeString(Record& record, const char* string) {
+    if (string == nullptr) {
+      string = "(null)";
+    }
+    size_t length = strnlen(string, kMaxStringSize);
+    if (!Reserve(record, 2 + length)) {
+      return;
+    }
+    record.arguments[record.size++] = STRING;
+    record.arguments[record.size++] = static_cast<uint8_t>(length);
+    std::memcpy(&record.arguments[record.size], string, length);
+    record.size += length;
+  }
+
+  template <typename T>
+  static void Encode(Record& record, const T& arg) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+      EncodeString(record, arg);
+    } else if constexpr (std::is_enum_v<U>) {
+      Encode(record, static_cast<std::underlying_type_t<U>>(arg));
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+      EncodeValue(record, SIGNED, static_cast<int64_t>(arg));
+    } else if constexpr (std::is_integral_v<U>) {
+      EncodeValue(record, UNSIGNED, static_cast<uint64_t>(arg));
+    } else if constexpr (std::is_floating_point_v<U>) {
+      EncodeValue(record, DOUBLE, static_cast<double>(arg));
+    } else if constexpr (std::is_pointer_v<U>) {
+      EncodeValue(record, POINTER, reinterpret_cast<uintptr_t>(arg));
+    } else if constexpr (std::is_null_pointer_v<U>) {
+      EncodeValue(record, POINTER, uintptr_t{0});
+    } else {
+      if (Reserve(record, 1)) {
+        record.arguments[record.size++] = UNKNOWN;
+      }
+    }
+  }
+
+  static inline std::atomic<int> max_level_{kDisabled};
+};
+
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "os/logging/binary_log.h"
+
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+enum class TestCode : uint8_t { CODE = 0x3e };
+
+bool EndsWith(const std::string& line, const std::string& suffix) {
+  return line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+class BinaryLogTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    BinaryLog::Clear();
+    BinaryLog::SetLevel(LOG_TAG_DEBUG);
+  }
+  void TearDown() override {
+    BinaryLog::SetLevel(BinaryLog::kDisabled);
+    BinaryLog::Clear();
+  }
+};
+
+TEST_F(BinaryLogTest, disabled_by_default_level) {
+  BinaryLog::SetLevel(BinaryLog::kDisabled);
+  LOG_DEBUG("not recorded");
+  ASSERT_TRUE(BinaryLog::GetLines().empty());
+}
+
+TEST_F(BinaryLogTest, records_up_to_level) {
+  LOG_DEBUG("recorded");
+  LOG_VERBOSE("not recorded");
+  auto lines = BinaryLog::GetLines();
+  ASSERT_EQ(lines.size(), 1u);
+  ASSERT_TRUE(EndsWith(lines[0], "recorded"));
+}
+
+TEST_F(BinaryLogTest, formats_when_dumped) {
+  LOG_DEBUG(
+      "%d %s %hhx %02x %5.2f %lu %c %*d|%-4s| %%",
+      -3,
+      "text",
+      static_cast<uint16_t>(0x1ff),
+      TestCode::CODE,
+      3.14159,
+      123456789012ul,
+      'z',
+      4,
+      42,
+      "ab");
+  auto lines = BinaryLog::GetLines();
+  ASSERT_EQ(lines.size(), 1u);
+  ASSERT_TRUE(EndsWith(lines[0], "-3 text ff 3e  3.14 123456789012 z   42|ab  | %")) << lines[0];
+  ASSERT_NE(lines[0].find(" D "), std::string::npos) << lines[0];
+  ASSERT_NE(lines[0].find("binary_log_unittest.cc"), std::string::npos) << lines[0];
+}
+
+TEST_F(BinaryLogTest, copies_strings) {
+  std::string text = "before";
+  LOG_DEBUG("%s", text.c_str());
+  text = "after";
+  auto lines = BinaryLog::GetLines();
+  ASSERT_EQ(lines.size(), 1u);
+  ASSERT_TRUE(EndsWith(lines[0], "before"));
+}
+
+TEST_F(BinaryLogTest, truncates_long_records) {
+  std::string text(100, 'x');
+  LOG_DEBUG("%s %s %s %d", text.c_str(), text.c_str(), text.c_str(), 5);
+  auto lines = BinaryLog::GetLines();
+  ASSERT_EQ(lines.size(), 1u);
+  ASSERT_TRUE(EndsWith(lines[0], std::string(BinaryLog::kMaxStringSize, 'x') + " ... ... ...")) << lines[0];
+}
+
+TEST_F(BinaryLogTest, keeps_the_latest_records_of_each_thread) {
+  std::thread thread([] {
+    for (size_t i = 0; i < BinaryLog::kRecordsPerThread + 10; i++) {
+      LOG_DEBUG("record %zu", i);
+    }
+  });
+  thread.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  LOG_DEBUG("main thread");
+  auto lines = BinaryLog::GetLines();
+  ASSERT_EQ(lines.size(), BinaryLog::kRecordsPerThread + 1);
+  ASSERT_TRUE(EndsWith(lines[0], "record 10")) << lines[0];
+  ASSERT_TRUE(EndsWith(lines.back(), "main thread")) << lines.back();
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
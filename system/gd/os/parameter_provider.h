@@ -45,6 +45,11 @@ class ParameterProvider {
 
   static void OverrideSyspropsFilePath(const std::string& path);
 
+  // Return the path to the controller capability cache file
+  static std::string ControllerCapabilityCacheFilePath();
+
+  static void OverrideControllerCapabilityCacheFilePath(const std::string& path);
+
   static bluetooth_keystore::BluetoothKeystoreInterface* GetBtKeystoreInterface();
 
   static void SetBtKeystoreInterface(bluetooth_keystore::BluetoothKeystoreInterface* bt_keystore);
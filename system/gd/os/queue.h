@@ -18,9 +18,11 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -50,6 +52,19 @@ class IQueueDequeue {
   virtual void RegisterDequeue(Handler* handler, DequeueCallback callback) = 0;
   virtual void UnregisterDequeue() = 0;
   virtual std::unique_ptr<T> TryDequeue() = 0;
+  // Dequeue up to |max_items| items at once, oldest first. Implementations that can do better than one
+  // TryDequeue() per item should override this.
+  virtual std::vector<std::unique_ptr<T>> TryDequeueBatch(size_t max_items) {
+    std::vector<std::unique_ptr<T>> batch;
+    while (batch.size() < max_items) {
+      auto item = TryDequeue();
+      if (item == nullptr) {
+        break;
+      }
+      batch.push_back(std::move(item));
+    }
+    return batch;
+  }
 };
 
 template <typename T>
@@ -61,6 +76,13 @@ class Queue : public IQueueEnqueue<T>, public IQueueDequeue<T> {
   // A function moving data form queue to dequeue end buffer, it will be continually be invoked until queue
   // is empty. TryDequeue should be use in this function to get data from queue.
   using DequeueCallback = common::Callback<void()>;
+  // A function filling the queue with up to |max_items| pieces of data in one go, |max_items| being the space left
+  // in the queue. Returning fewer items is fine, but the enqueue end should UnregisterEnqueue when its buffer
+  // becomes empty, as with EnqueueCallback.
+  using EnqueueBatchCallback = common::Callback<std::vector<std::unique_ptr<T>>(size_t max_items)>;
+  // A function receiving up to the registered batch size of items, taken from the queue under a single lock. It is
+  // only invoked with a non empty batch.
+  using DequeueBatchCallback = common::Callback<void(std::vector<std::unique_ptr<T>>)>;
   // Create a queue with |capacity| is the maximum number of messages a queue can contain
   explicit Queue(size_t capacity);
   ~Queue();
@@ -75,11 +97,27 @@ class Queue : public IQueueEnqueue<T>, public IQueueDequeue<T> {
   // Unregister current DequeueCallback from this queue, this will cause a crash if not registered yet.
   void UnregisterDequeue() override;
 
+  // Same as RegisterEnqueue, but |callback| fills all the free space of the queue at once. Unregister with
+  // UnregisterEnqueue.
+  void RegisterEnqueueBatch(Handler* handler, EnqueueBatchCallback callback);
+  // Same as RegisterDequeue, but the queue dequeues up to |max_batch_size| items itself and hands them to
+  // |callback|. Unregister with UnregisterDequeue.
+  void RegisterDequeueBatch(Handler* handler, size_t max_batch_size, DequeueBatchCallback callback);
+
   // Try to dequeue an item from this queue. Return nullptr when there is nothing in the queue.
   std::unique_ptr<T> TryDequeue() override;
+  // Dequeue up to |max_items| items while holding the queue lock once. Return an empty vector when there is nothing
+  // in the queue.
+  std::vector<std::unique_ptr<T>> TryDequeueBatch(size_t max_items) override;
 
  private:
   void EnqueueCallbackInternal(EnqueueCallback callback);
+  void EnqueueBatchCallbackInternal(EnqueueBatchCallback callback);
+  void DequeueBatchCallbackInternal(size_t max_batch_size, DequeueBatchCallback callback);
+  void RegisterEnqueueInternal(Handler* handler, common::Closure callback);
+  void RegisterDequeueInternal(Handler* handler, common::Closure callback);
+  // The maximum number of pieces of data |queue_| can hold
+  const size_t capacity_;
   // An internal queue that holds at most |capacity| pieces of data
   std::queue<std::unique_ptr<T>> queue_;
   // A mutex that guards data in this queue
@@ -117,6 +155,20 @@ class EnqueueBuffer {
     }
   }
 
+  // Buffer all of |batch| while taking the buffer lock and registering with the queue at most once
+  void EnqueueBatch(std::vector<std::unique_ptr<T>> batch, os::Handler* handler) {
+    if (batch.empty()) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& t : batch) {
+      buffer_.push(std::move(t));
+    }
+    if (!enqueue_registered_.exchange(true)) {
+      queue_->RegisterEnqueue(handler, common::Bind(&EnqueueBuffer<T>::enqueue_callback, common::Unretained(this)));
+    }
+  }
+
   void Clear() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (enqueue_registered_.exchange(false)) {
@@ -136,11 +188,20 @@ class EnqueueBuffer {
     callback_on_empty_ = std::move(callback);
   }
 
+  // |callback| is run with each buffered item as it is handed to the queue
+  void NotifyOnEnqueue(common::Callback<void(const T&)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_on_enqueue_ = std::move(callback);
+  }
+
  private:
   std::unique_ptr<T> enqueue_callback() {
     std::lock_guard<std::mutex> lock(mutex_);
     std::unique_ptr<T> enqueued_t = std::move(buffer_.front());
     buffer_.pop();
+    if (!callback_on_enqueue_.is_null()) {
+      callback_on_enqueue_.Run(*enqueued_t);
+    }
     if (buffer_.empty() && enqueue_registered_.exchange(false)) {
       queue_->UnregisterEnqueue();
       if (!callback_on_empty_.is_null()) {
@@ -155,6 +216,7 @@ class EnqueueBuffer {
   std::atomic_bool enqueue_registered_ = false;
   std::queue<std::unique_ptr<T>> buffer_;
   common::OnceClosure callback_on_empty_;
+  common::Callback<void(const T&)> callback_on_enqueue_;
 };
 
 #include "os/linux_generic/queue.tpp"
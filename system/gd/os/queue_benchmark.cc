@@ -15,6 +15,7 @@
  */
 
 #include <future>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "os/handler.h"
@@ -137,6 +138,78 @@ class TestDequeueEnd {
   }
 };
 
+class TestBatchEnqueueEnd {
+ public:
+  explicit TestBatchEnqueueEnd(int64_t count, Queue<std::string>* queue, Handler* handler)
+      : count_(count), handler_(handler), queue_(queue) {}
+
+  void RegisterEnqueue() {
+    handler_->Post(common::BindOnce(&TestBatchEnqueueEnd::handle_register_enqueue, common::Unretained(this)));
+  }
+
+  std::vector<std::unique_ptr<std::string>> EnqueueBatchCallbackForTest(size_t max_items) {
+    std::vector<std::unique_ptr<std::string>> batch;
+    while (count_ > 0 && batch.size() < max_items) {
+      batch.push_back(std::make_unique<std::string>(std::to_string(1)));
+      count_--;
+    }
+    if (count_ == 0) {
+      queue_->UnregisterEnqueue();
+    }
+    return batch;
+  }
+
+  int64_t count_;
+
+ private:
+  Handler* handler_;
+  Queue<std::string>* queue_;
+
+  void handle_register_enqueue() {
+    queue_->RegisterEnqueueBatch(
+        handler_, common::Bind(&TestBatchEnqueueEnd::EnqueueBatchCallbackForTest, common::Unretained(this)));
+  }
+};
+
+class TestBatchDequeueEnd {
+ public:
+  explicit TestBatchDequeueEnd(
+      int64_t count, size_t batch_size, Queue<std::string>* queue, Handler* handler, std::promise<void>* promise)
+      : count_(count), batch_size_(batch_size), handler_(handler), queue_(queue), promise_(promise) {}
+
+  void RegisterDequeue() {
+    handler_->Post(common::BindOnce(&TestBatchDequeueEnd::handle_register_dequeue, common::Unretained(this)));
+  }
+
+  void DequeueBatchCallbackForTest(std::vector<std::unique_ptr<std::string>> batch) {
+    for (auto& data : batch) {
+      buffer_.push(std::move(*data));
+    }
+
+    count_ -= batch.size();
+    if (count_ == 0) {
+      queue_->UnregisterDequeue();
+      promise_->set_value();
+    }
+  }
+
+  std::queue<std::string> buffer_;
+  int64_t count_;
+
+ private:
+  size_t batch_size_;
+  Handler* handler_;
+  Queue<std::string>* queue_;
+  std::promise<void>* promise_;
+
+  void handle_register_dequeue() {
+    queue_->RegisterDequeueBatch(
+        handler_,
+        batch_size_,
+        common::Bind(&TestBatchDequeueEnd::DequeueBatchCallbackForTest, common::Unretained(this)));
+  }
+};
+
 BENCHMARK_DEFINE_F(BM_QueuePerformance, send_packet_vary_by_packet_num)(State& state) {
   for (auto _ : state) {
     int64_t num_data_to_send_ = state.range(0);
@@ -159,6 +232,7 @@ BENCHMARK_DEFINE_F(BM_QueuePerformance, send_packet_vary_by_packet_num)(State& s
   }
 
   state.SetBytesProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
 };
 
 BENCHMARK_REGISTER_F(BM_QueuePerformance, send_packet_vary_by_packet_num)
@@ -170,6 +244,40 @@ BENCHMARK_REGISTER_F(BM_QueuePerformance, send_packet_vary_by_packet_num)
     ->Iterations(100)
     ->UseRealTime();
 
+// Same traffic as send_packet_vary_by_packet_num, but both ends move state.range(1) packets per callback. Compare
+// the items_per_second counters of the two benchmarks to see the effect of batching.
+BENCHMARK_DEFINE_F(BM_QueuePerformance, send_packet_batched_vary_by_packet_num)(State& state) {
+  for (auto _ : state) {
+    int64_t num_data_to_send_ = state.range(0);
+    size_t batch_size = state.range(1);
+    Queue<std::string> queue(num_data_to_send_);
+
+    // register dequeue
+    std::promise<void> dequeue_promise;
+    auto dequeue_future = dequeue_promise.get_future();
+    TestBatchDequeueEnd test_dequeue_end(num_data_to_send_, batch_size, &queue, enqueue_handler_, &dequeue_promise);
+    test_dequeue_end.RegisterDequeue();
+
+    // register batched enqueue
+    TestBatchEnqueueEnd test_enqueue_end(num_data_to_send_, &queue, enqueue_handler_);
+    test_enqueue_end.RegisterEnqueue();
+    dequeue_future.wait();
+  }
+
+  state.SetBytesProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_QueuePerformance, send_packet_batched_vary_by_packet_num)
+    ->Args({1000, 1})
+    ->Args({1000, 16})
+    ->Args({10000, 1})
+    ->Args({10000, 16})
+    ->Args({100000, 16})
+    ->Args({100000, 64})
+    ->Iterations(100)
+    ->UseRealTime();
+
 BENCHMARK_DEFINE_F(BM_QueuePerformance, send_10000_packet_vary_by_packet_size)(State& state) {
   for (auto _ : state) {
     int64_t num_data_to_send_ = 10000;
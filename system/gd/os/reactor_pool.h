@@ -0,0 +1,56 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "os/thread.h"
+
+namespace bluetooth {
+namespace os {
+
+// A fixed set of reactor threads ("shards") that modules can be explicitly assigned to, so that independent parts of
+// the stack run on different cores. Each shard is a regular os::Thread: work reaches it through a Handler bound to
+// that thread, and calls between shards go through Handler::Post()/CallOn() like any other cross-thread call.
+class ReactorPool {
+ public:
+  // Start |num_shards| threads named "<name>_<index>" with the given |priority|
+  ReactorPool(const std::string& name, size_t num_shards, Thread::Priority priority);
+
+  ReactorPool(const ReactorPool&) = delete;
+  ReactorPool& operator=(const ReactorPool&) = delete;
+
+  // Stop and destroy every shard
+  ~ReactorPool();
+
+  // Stop every shard. Must be invoked from a thread that is not in this pool, and only after all the handlers bound
+  // to the shards were cleared.
+  void Stop();
+
+  size_t NumShards() const;
+
+  // Return the thread of shard |index|, which must be smaller than NumShards(). The ownership is NOT transferred.
+  Thread* GetShard(size_t index) const;
+
+ private:
+  std::vector<std::unique_ptr<Thread>> shards_;
+};
+
+}  // namespace os
+}  // namespace bluetooth
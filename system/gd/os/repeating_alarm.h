@@ -22,15 +22,17 @@
 
 #include "common/callback.h"
 #include "os/handler.h"
+#include "os/internal/alarm_multiplexer.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
-// A repeating alarm for reactor-based thread, implemented by Linux timerfd.
-// When it's constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister
-// itself from the thread.
+// A repeating alarm for reactor-based thread. All the alarms of a handler share one Linux timerfd, see
+// internal::AlarmMultiplexer.
+// When it's constructed, it will add a timer to the multiplexer of the handler; when it's destroyed, it will remove
+// it.
 class RepeatingAlarm {
  public:
   // Create and register a repeating alarm on a given handler
@@ -50,9 +52,8 @@ class RepeatingAlarm {
 
  private:
   common::Closure task_;
-  Handler* handler_;
-  int fd_ = 0;
-  Reactor::Reactable* token_;
+  std::shared_ptr<internal::AlarmMultiplexer> multiplexer_;
+  internal::AlarmMultiplexer::TimerId timer_id_;
   mutable std::mutex mutex_;
   void on_fire();
 };
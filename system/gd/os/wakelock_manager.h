@@ -68,6 +68,20 @@ class WakelockManager {
   // The function is thread safe.
   bool Release();
 
+  // Acquire the Bluetooth wakelock on behalf of |reason|.
+  // Each reason either holds the wakelock or not: acquiring again for a reason that already holds it does nothing.
+  // The wakelock is acquired when the first reason acquires it and released when the last one releases it, and the
+  // hold time of each reason is reported in the dumpsys data.
+  // Return true if the wakelock is held, otherwise false.
+  // The function is thread safe.
+  bool Acquire(const std::string& reason);
+
+  // Release the Bluetooth wakelock held on behalf of |reason|. Releasing a reason that does not hold the wakelock does
+  // nothing.
+  // Return true on success, otherwise false.
+  // The function is thread safe.
+  bool Release(const std::string& reason);
+
   // Cleanup the wakelock internal runtime state.
   // This will NOT clean up the callouts
   void CleanUp();
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <forward_list>
 #include <iterator>
@@ -38,6 +39,17 @@ class BasePacketBuilder {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Append the packet to bytes, growing it at most once. Callers sending many
+  // packets can keep bytes around and clear() it to reuse its storage.
+  void SerializeInto(std::vector<uint8_t>& bytes) const {
+    size_t required = bytes.size() + size();
+    if (bytes.capacity() < required) {
+      bytes.reserve(std::max(required, 2 * bytes.capacity()));
+    }
+    BitInserter it(bytes);
+    Serialize(it);
+  }
+
   void SetFlushable(bool is_flushable) {
     is_flushable_ = is_flushable;
   }
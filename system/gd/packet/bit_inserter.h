@@ -35,6 +35,10 @@ class BitInserter : public ByteInserter {
 
   void insert_byte(uint8_t byte) override;
 
+  // Subclasses overriding insert_bits must override insert_bytes too, since
+  // byte aligned insertions skip insert_bits.
+  void insert_bytes(const uint8_t* data, size_t length) override;
+
  protected:
   size_t num_saved_bits_{0};
   uint8_t saved_bits_{0};
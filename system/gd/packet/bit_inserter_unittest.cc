@@ -78,5 +78,34 @@ TEST(BitInserterTest, observerTest) {
   ASSERT_EQ(result.size(), copy.size());
 }
 
+TEST(BitInserterTest, insertBytes) {
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  std::vector<uint8_t> data = {0x01, 0x23, 0x45};
+
+  it.insert_bytes(data.data(), data.size());
+  ASSERT_EQ(data, bytes);
+
+  // Not byte aligned anymore
+  it.insert_bits(0b1010, 4);
+  it.insert_bytes(data.data(), data.size());
+  it.insert_bits(0b0101, 4);
+  std::vector<uint8_t> result = {0x01, 0x23, 0x45, 0x1a, 0x30, 0x52, 0x54};
+  ASSERT_EQ(result, bytes);
+}
+
+TEST(BitInserterTest, insertBytesObserverTest) {
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  std::vector<uint8_t> copy;
+  it.RegisterObserver(ByteObserver([&copy](uint8_t byte) { copy.push_back(byte); }, []() { return 0; }));
+
+  std::vector<uint8_t> data = {0x01, 0x23, 0x45};
+  it.insert_bytes(data.data(), data.size());
+  it.UnregisterObserver();
+  ASSERT_EQ(data, bytes);
+  ASSERT_EQ(data, copy);
+}
+
 }  // namespace packet
 }  // namespace bluetooth
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/fragment_list.h"
+
+namespace bluetooth {
+namespace packet {
+
+FragmentList::FragmentList(std::initializer_list<View> fragments) {
+  for (const auto& fragment : fragments) {
+    push_back(fragment);
+  }
+}
+
+void FragmentList::push_back(const View& fragment) {
+  if (overflow_fragments_.empty() && size_ < kInlineFragments) {
+    inline_fragments_[size_++] = fragment;
+    return;
+  }
+  if (overflow_fragments_.empty()) {
+    overflow_fragments_.reserve(2 * kInlineFragments);
+    for (auto& inline_fragment : inline_fragments_) {
+      overflow_fragments_.push_back(inline_fragment);
+      inline_fragment = View();
+    }
+  }
+  overflow_fragments_.push_back(fragment);
+  size_++;
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "packet/view.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Ordered fragments of a PacketView. Almost every packet has a single
+// fragment, so the first kInlineFragments are stored inline and only longer
+// lists allocate.
+class FragmentList {
+ public:
+  static constexpr size_t kInlineFragments = 2;
+
+  FragmentList() = default;
+  FragmentList(std::initializer_list<View> fragments);
+  FragmentList(const FragmentList& fragments) = default;
+  FragmentList& operator=(const FragmentList& fragments) = default;
+
+  void push_back(const View& fragment);
+
+  // Accessors are inline, they are on the path of every byte read
+  const View* begin() const {
+    return overflow_fragments_.empty() ? inline_fragments_.data() : overflow_fragments_.data();
+  }
+  const View* end() const {
+    return begin() + size_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  // Start of the bytes if they are all in one fragment, nullptr otherwise
+  const uint8_t* GetContiguousData() const {
+    return size_ == 1 ? inline_fragments_[0].data() : nullptr;
+  }
+
+ private:
+  std::array<View, kInlineFragments> inline_fragments_;
+  // Holds all the fragments once there are more than kInlineFragments
+  std::vector<View> overflow_fragments_;
+  size_t size_ = 0;
+};
+
+}  // namespace packet
+}  // namespace bluetooth
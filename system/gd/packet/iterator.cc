@@ -22,12 +22,13 @@ namespace bluetooth {
 namespace packet {
 
 template <bool little_endian>
-Iterator<little_endian>::Iterator(const std::forward_list<View>& data, size_t offset) {
+Iterator<little_endian>::Iterator(const FragmentList& data, size_t offset) {
   data_ = data;
+  contiguous_data_ = data_.GetContiguousData();
   index_ = offset;
   begin_ = 0;
   end_ = 0;
-  for (auto& view : data) {
+  for (const auto& view : data) {
     end_ += view.size();
   }
 }
@@ -84,6 +85,7 @@ Iterator<little_endian>& Iterator<little_endian>::operator=(const Iterator<littl
     return *this;
   }
   this->data_ = itr.data_;
+  this->contiguous_data_ = itr.contiguous_data_;
   this->begin_ = itr.begin_;
   this->end_ = itr.end_;
   this->index_ = itr.index_;
@@ -128,9 +130,12 @@ uint8_t Iterator<little_endian>::operator*() const {
       index_,
       begin_,
       end_);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index_];
+  }
   size_t index = index_;
 
-  for (auto view : data_) {
+  for (const auto& view : data_) {
     if (index < view.size()) {
       return view[index];
     }
@@ -17,11 +17,11 @@
 #pragma once
 
 #include <cstdint>
-#include <forward_list>
 #include <memory>
 #include <type_traits>
 
 #include "packet/custom_field_fixed_size_interface.h"
+#include "packet/fragment_list.h"
 #include "packet/view.h"
 
 namespace bluetooth {
@@ -45,7 +45,7 @@ struct IteratorTraits : public std::iterator<std::random_access_iterator_tag, ui
 template <bool little_endian>
 class Iterator : public IteratorTraits {
  public:
-  Iterator(const std::forward_list<View>& data, size_t offset);
+  Iterator(const FragmentList& data, size_t offset);
   Iterator(const Iterator& itr) = default;
   virtual ~Iterator() = default;
 
@@ -83,6 +83,14 @@ class Iterator : public IteratorTraits {
     T extracted_value{};
     uint8_t* value_ptr = (uint8_t*)&extracted_value;
 
+    if (contiguous_data_ != nullptr && NumBytesRemaining() >= sizeof(T)) {
+      const uint8_t* bytes = contiguous_data_ + index_;
+      for (size_t i = 0; i < sizeof(T); i++) {
+        value_ptr[little_endian ? i : sizeof(T) - i - 1] = bytes[i];
+      }
+      index_ += sizeof(T);
+      return extracted_value;
+    }
     for (size_t i = 0; i < sizeof(T); i++) {
       size_t index = (little_endian ? i : sizeof(T) - i - 1);
       value_ptr[index] = this->operator*();
@@ -103,7 +111,9 @@ class Iterator : public IteratorTraits {
   }
 
  private:
-  std::forward_list<View> data_;
+  FragmentList data_;
+  // Set when data_ is a single fragment, so reads skip the fragment walk
+  const uint8_t* contiguous_data_;
   size_t index_;
   size_t begin_;
   size_t end_;
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "packet/bit_inserter.h"
+#include "packet/packet_builder.h"
+#include "packet/raw_builder.h"
+#include "packet/scatter_gather_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace packet {
+
+namespace {
+
+// Same layout as an outgoing ACL packet: handle, length and a raw payload
+class AclLikeBuilder : public PacketBuilder<true> {
+ public:
+  explicit AclLikeBuilder(std::unique_ptr<BasePacketBuilder> payload) : payload_(std::move(payload)) {}
+
+  size_t size() const override {
+    return 4 + payload_->size();
+  }
+
+  void Serialize(BitInserter& it) const override {
+    insert(static_cast<uint16_t>(0x0001), it);
+    insert(static_cast<uint16_t>(payload_->size()), it);
+    payload_->Serialize(it);
+  }
+
+ private:
+  std::unique_ptr<BasePacketBuilder> payload_;
+};
+
+std::unique_ptr<AclLikeBuilder> MakePacket(size_t payload_size) {
+  return std::make_unique<AclLikeBuilder>(std::make_unique<RawBuilder>(std::vector<uint8_t>(payload_size, 0x5a)));
+}
+
+}  // namespace
+
+// How the HCI layer serialized outgoing data packets: into an empty vector
+// grown as the bytes are inserted
+void BM_SerializeIntoGrowingVector(State& state) {
+  auto packet = MakePacket(state.range(0));
+  for (auto _ : state) {
+    std::vector<uint8_t> bytes;
+    BitInserter it(bytes);
+    packet->Serialize(it);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+void BM_SerializeToBytes(State& state) {
+  auto packet = MakePacket(state.range(0));
+  for (auto _ : state) {
+    auto bytes = packet->SerializeToBytes();
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+// Serializes into one buffer kept across packets, the way a sender with its
+// own TX buffer would
+void BM_SerializeIntoReusedBuffer(State& state) {
+  auto packet = MakePacket(state.range(0));
+  std::vector<uint8_t> bytes;
+  for (auto _ : state) {
+    bytes.clear();
+    packet->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+// Wraps an SDU handed over by its producer and serializes the packet
+void BM_WrapSduInRawBuilder(State& state) {
+  auto sdu = std::make_shared<const std::vector<uint8_t>>(state.range(0), 0x5a);
+  std::vector<uint8_t> bytes;
+  for (auto _ : state) {
+    AclLikeBuilder packet(std::make_unique<RawBuilder>(*sdu));
+    bytes.clear();
+    packet.SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_WrapSduInScatterGatherBuilder(State& state) {
+  auto sdu = std::make_shared<const std::vector<uint8_t>>(state.range(0), 0x5a);
+  std::vector<uint8_t> bytes;
+  for (auto _ : state) {
+    AclLikeBuilder packet(std::make_unique<ScatterGatherBuilder>(sdu));
+    bytes.clear();
+    packet.SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SerializeIntoGrowingVector)->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_SerializeToBytes)->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_SerializeIntoReusedBuffer)->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_WrapSduInRawBuilder)->Arg(251)->Arg(4095)->Arg(65535);
+BENCHMARK(BM_WrapSduInScatterGatherBuilder)->Arg(251)->Arg(4095)->Arg(65535);
+
+}  // namespace packet
+}  // namespace bluetooth
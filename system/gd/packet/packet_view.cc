@@ -17,6 +17,7 @@
 #include "packet/packet_view.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "os/log.h"
 
@@ -24,16 +25,18 @@ namespace bluetooth {
 namespace packet {
 
 template <bool little_endian>
-PacketView<little_endian>::PacketView(const std::forward_list<class View> fragments)
-    : fragments_(fragments), length_(0) {
-  for (auto fragment : fragments_) {
+PacketView<little_endian>::PacketView(FragmentList fragments)
+    : fragments_(std::move(fragments)), length_(0), contiguous_data_(fragments_.GetContiguousData()) {
+  for (const auto& fragment : fragments_) {
     length_ += fragment.size();
   }
 }
 
 template <bool little_endian>
 PacketView<little_endian>::PacketView(std::shared_ptr<const std::vector<uint8_t>> packet)
-    : fragments_({View(packet, 0, packet->size())}), length_(packet->size()) {}
+    : fragments_({View(packet, 0, packet->size())}),
+      length_(packet->size()),
+      contiguous_data_(fragments_.GetContiguousData()) {}
 
 template <bool little_endian>
 Iterator<little_endian> PacketView<little_endian>::begin() const {
@@ -53,6 +56,9 @@ uint8_t PacketView<little_endian>::operator[](size_t index) const {
 template <bool little_endian>
 uint8_t PacketView<little_endian>::at(size_t index) const {
   ASSERT_LOG(index < length_, "Index %zu out of bounds", index);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index];
+  }
   for (const auto& fragment : fragments_) {
     if (index < fragment.size()) {
       return fragment[index];
@@ -69,20 +75,22 @@ size_t PacketView<little_endian>::size() const {
 }
 
 template <bool little_endian>
-std::forward_list<View> PacketView<little_endian>::GetSubviewList(size_t begin, size_t end) const {
+FragmentList PacketView<little_endian>::GetSubviewList(size_t begin, size_t end) const {
   ASSERT(begin <= end);
   ASSERT(end <= length_);
 
-  std::forward_list<View> view_list;
-  std::forward_list<View>::iterator it = view_list.before_begin();
+  FragmentList view_list;
   size_t length = end - begin;
   for (const auto& fragment : fragments_) {
+    if (length == 0) {
+      break;
+    }
     if (begin >= fragment.size()) {
       begin -= fragment.size();
     } else {
       View view(fragment, begin, begin + std::min(length, fragment.size() - begin));
       length -= view.size();
-      it = view_list.insert_after(it, view);
+      view_list.push_back(view);
       begin = 0;
     }
   }
@@ -101,20 +109,11 @@ PacketView<false> PacketView<little_endian>::GetBigEndianSubview(size_t begin, s
 
 template <bool little_endian>
 void PacketView<little_endian>::Append(PacketView to_add) {
-  auto insertion_point = fragments_.begin();
-  size_t remaining_length = length_;
-  while (remaining_length > 0) {
-    remaining_length -= insertion_point->size();
-    if (remaining_length > 0) {
-      insertion_point++;
-    }
-  }
-  ASSERT(insertion_point != fragments_.end());
   for (const auto& fragment : to_add.fragments_) {
-    fragments_.insert_after(insertion_point, fragment);
-    insertion_point++;
+    fragments_.push_back(fragment);
   }
   length_ += to_add.length_;
+  contiguous_data_ = fragments_.GetContiguousData();
 }
 
 // Explicit instantiations for both types of PacketViews.
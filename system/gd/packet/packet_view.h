@@ -17,8 +17,8 @@
 #pragma once
 
 #include <cstdint>
-#include <forward_list>
 
+#include "packet/fragment_list.h"
 #include "packet/iterator.h"
 #include "packet/view.h"
 
@@ -33,7 +33,7 @@ static const bool kLittleEndian = true;
 template <bool little_endian>
 class PacketView {
  public:
-  explicit PacketView(std::forward_list<View> fragments);
+  explicit PacketView(FragmentList fragments);
   explicit PacketView(std::shared_ptr<const std::vector<uint8_t>> packet);
   PacketView(const PacketView& PacketView) = default;
   PacketView<little_endian>() = delete;
@@ -50,14 +50,24 @@ class PacketView {
   PacketView<true> GetLittleEndianSubview(size_t begin, size_t end) const;
   PacketView<false> GetBigEndianSubview(size_t begin, size_t end) const;
 
+  // Call |f| with the data and size of each fragment, in order.
+  template <typename F>
+  void ForEachFragment(F f) const {
+    for (const auto& fragment : fragments_) {
+      f(fragment.data(), fragment.size());
+    }
+  }
+
  protected:
   void Append(PacketView to_add);
 
  private:
-  std::forward_list<View> fragments_;
+  FragmentList fragments_;
   size_t length_;
+  // Set when the packet is a single fragment, so reads skip the fragment walk
+  const uint8_t* contiguous_data_;
 
-  std::forward_list<View> GetSubviewList(size_t begin, size_t end) const;
+  FragmentList GetSubviewList(size_t begin, size_t end) const;
 };
 
 }  // namespace packet
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "packet/packet_view.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace packet {
+
+namespace {
+
+std::shared_ptr<const std::vector<uint8_t>> MakeBytes(size_t size) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>(size);
+  for (size_t i = 0; i < size; i++) {
+    bytes->at(i) = static_cast<uint8_t>(i);
+  }
+  return bytes;
+}
+
+class AppendedPacketView : public PacketView<kLittleEndian> {
+ public:
+  AppendedPacketView(PacketView<kLittleEndian> first, const std::vector<PacketView<kLittleEndian>>& to_append)
+      : PacketView<kLittleEndian>(first) {
+    for (const auto& packet_view : to_append) {
+      Append(packet_view);
+    }
+  }
+};
+
+// Same bytes as the single view, split in three fragments like the multi view
+// tests of packet_view_unittest
+PacketView<kLittleEndian> MakeMultiView(size_t size) {
+  auto bytes = MakeBytes(size);
+  return AppendedPacketView(
+      PacketView<kLittleEndian>({View(bytes, 0, size / 4)}),
+      {PacketView<kLittleEndian>({View(bytes, size / 4, size / 2)}),
+       PacketView<kLittleEndian>({View(bytes, size / 2, size)})});
+}
+
+PacketView<kLittleEndian> MakeView(bool fragmented, size_t size) {
+  if (fragmented) {
+    return MakeMultiView(size);
+  }
+  return PacketView<kLittleEndian>(MakeBytes(size));
+}
+
+}  // namespace
+
+// Reads every byte with operator[]
+void BM_PacketViewArrayOperator(State& state) {
+  auto packet = MakeView(state.range(0), state.range(1));
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < packet.size(); i++) {
+      sum += packet[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+
+// Reads every byte through an iterator, the way generated parsers extract fields
+void BM_PacketViewIteratorExtract(State& state) {
+  auto packet = MakeView(state.range(0), state.range(1));
+  for (auto _ : state) {
+    auto it = packet.begin();
+    uint64_t sum = 0;
+    while (it.NumBytesRemaining() >= sizeof(uint32_t)) {
+      sum += it.extract<uint32_t>();
+    }
+    while (it.NumBytesRemaining() > 0) {
+      sum += it.extract<uint8_t>();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+
+// Nests subviews like an HCI ACL -> L2CAP basic frame -> signalling command parse
+void BM_PacketViewNestedSubviews(State& state) {
+  auto packet = MakeView(state.range(0), state.range(1));
+  for (auto _ : state) {
+    auto acl = packet.GetLittleEndianSubview(4, packet.size());
+    auto l2cap = acl.GetLittleEndianSubview(4, acl.size());
+    auto command = l2cap.GetLittleEndianSubview(4, l2cap.size());
+    auto it = command.begin();
+    benchmark::DoNotOptimize(it.extract<uint16_t>());
+  }
+}
+
+BENCHMARK(BM_PacketViewArrayOperator)->ArgsProduct({{false, true}, {32, 1021}});
+BENCHMARK(BM_PacketViewIteratorExtract)->ArgsProduct({{false, true}, {32, 1021}});
+BENCHMARK(BM_PacketViewNestedSubviews)->ArgsProduct({{false, true}, {32, 1021}});
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -585,6 +585,59 @@ TEST_F(PacketViewMultiViewAppendTest, arrayOperatorTestAppend) {
   ASSERT_DEATH(multi_view[single_view.size()], "");
 }
 
+TEST_F(PacketViewMultiViewTest, extractTest) {
+  // Extracts straddle the fragment boundaries of the multi view
+  for (size_t offset = 0; offset < sizeof(uint64_t); offset++) {
+    auto single_itr = single_view.begin() + offset;
+    auto multi_itr = multi_view.begin() + offset;
+    while (single_itr.NumBytesRemaining() >= sizeof(uint64_t)) {
+      ASSERT_EQ(single_itr.extract<uint64_t>(), multi_itr.extract<uint64_t>());
+    }
+    ASSERT_EQ(single_itr, multi_itr);
+  }
+}
+
+TEST_F(PacketViewMultiViewTest, subviewInOneFragmentTest) {
+  // Bytes 3 to 12 are all in the second fragment
+  PacketView<true> subview = multi_view.GetLittleEndianSubview(4, 12);
+  ASSERT_EQ(subview.size(), 8u);
+  for (size_t i = 0; i < subview.size(); i++) {
+    ASSERT_EQ(subview[i], count_all[4 + i]);
+  }
+  auto itr = subview.begin();
+  ASSERT_EQ(itr.extract<uint64_t>(), 0x0b0a090807060504u);
+  ASSERT_DEATH(subview[subview.size()], "");
+  ASSERT_DEATH(*itr, "");
+}
+
+TEST_F(PacketViewMultiViewTest, forEachFragmentTest) {
+  // The subview starts and ends in the middle of fragments
+  PacketView<true> subview = multi_view.GetLittleEndianSubview(1, count_all.size() - 1);
+  vector<uint8_t> bytes;
+  size_t fragments = 0;
+  subview.ForEachFragment([&bytes, &fragments](const uint8_t* data, size_t length) {
+    bytes.insert(bytes.end(), data, data + length);
+    fragments++;
+  });
+  ASSERT_GT(fragments, 1u);
+  ASSERT_EQ(bytes, vector<uint8_t>(count_all.begin() + 1, count_all.end() - 1));
+}
+
+TEST_F(PacketViewMultiViewAppendTest, appendManyFragmentsTest) {
+  auto bytes = std::make_shared<const vector<uint8_t>>(count_all);
+  AppendedPacketView packet(PacketView<true>({View(bytes, 0, 1)}), {});
+  for (size_t i = 1; i < count_all.size(); i++) {
+    packet = AppendedPacketView(packet, {PacketView<true>({View(bytes, i, i + 1)})});
+  }
+  ASSERT_EQ(packet.size(), count_all.size());
+  for (size_t i = 0; i < count_all.size(); i++) {
+    ASSERT_EQ(packet[i], count_all[i]);
+  }
+  auto itr = packet.begin();
+  ASSERT_EQ(itr.extract<uint32_t>(), 0x03020100u);
+  ASSERT_DEATH(packet[count_all.size()], "");
+}
+
 TEST(ViewTest, arrayOperatorTest) {
   View view_all(std::make_shared<const vector<uint8_t>>(count_all), 0, count_all.size());
   size_t past_end = view_all.size();
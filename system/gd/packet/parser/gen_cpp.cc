@@ -54,6 +54,7 @@ bool generate_cpp_headers_one_file(
     const Declarations& decls,
     bool generate_fuzzing,
     bool generate_tests,
+    bool cache_offsets,
     const std::filesystem::path& input_file,
     const std::filesystem::path& include_dir,
     const std::filesystem::path& out_dir,
@@ -205,7 +206,7 @@ using ::bluetooth::packet::RawBuilder;
   }
 
   for (const auto& packet_def : decls.packet_defs_queue_) {
-    packet_def.second->GenParserDefinition(out_file, generate_fuzzing, generate_tests);
+    packet_def.second->GenParserDefinition(out_file, generate_fuzzing, generate_tests, cache_offsets);
     out_file << "\n\n";
   }
 
@@ -41,6 +41,7 @@ bool generate_cpp_headers_one_file(
     const Declarations& decls,
     bool generate_fuzzing,
     bool generate_tests,
+    bool cache_offsets,
     const std::filesystem::path& input_file,
     const std::filesystem::path& include_dir,
     const std::filesystem::path& out_dir,
@@ -118,6 +119,9 @@ void usage(const char* prog) {
 
   ofs << std::setw(24) << "--num_shards= ";
   ofs << "Number of shards per output pybind11 cc file." << std::endl;
+
+  ofs << std::setw(24) << "--cache_offsets ";
+  ofs << "Cache the offsets of fields that follow variable length fields in the views." << std::endl;
 }
 
 int main(int argc, const char** argv) {
@@ -130,6 +134,7 @@ int main(int argc, const char** argv) {
   size_t num_shards = 1;
   bool generate_fuzzing = false;
   bool generate_tests = false;
+  bool cache_offsets = false;
   std::queue<std::filesystem::path> input_files;
 
   const std::string arg_out = "--out=";
@@ -138,6 +143,7 @@ int main(int argc, const char** argv) {
   const std::string arg_num_shards = "--num_shards=";
   const std::string arg_fuzzing = "--fuzzing";
   const std::string arg_testing = "--testing";
+  const std::string arg_cache_offsets = "--cache_offsets";
   const std::string arg_source_root = "--source_root=";
 
   // Parse the source root first (if it exists) since it will be used for other
@@ -163,6 +169,8 @@ int main(int argc, const char** argv) {
       generate_fuzzing = true;
     } else if (arg.find(arg_testing) == 0) {
       generate_tests = true;
+    } else if (arg.find(arg_cache_offsets) == 0) {
+      cache_offsets = true;
     } else if (arg.find(arg_source_root) == 0) {
       // Do nothing (just don't treat it as input_files)
     } else {
@@ -188,6 +196,7 @@ int main(int argc, const char** argv) {
             declarations,
             generate_fuzzing,
             generate_tests,
+            cache_offsets,
             input_files.front(),
             include_dir,
             out_dir,
@@ -31,7 +31,8 @@ PacketField* PacketDef::GetNewField(const std::string&, ParseLocation) const {
   return nullptr;  // Packets can't be fields
 }
 
-void PacketDef::GenParserDefinition(std::ostream& s, bool generate_fuzzing, bool generate_tests) const {
+void PacketDef::GenParserDefinition(
+    std::ostream& s, bool generate_fuzzing, bool generate_tests, bool cache_offsets) const {
   s << "class " << name_ << "View";
   if (parent_ != nullptr) {
     s << " : public " << parent_->name_ << "View {";
@@ -75,11 +76,14 @@ void PacketDef::GenParserDefinition(std::ostream& s, bool generate_fuzzing, bool
   const auto& public_fields = fields_.GetFieldsWithoutTypes(fixed_types);
   bool has_fixed_fields = public_fields.size() != fields_.size();
   for (const auto& field : public_fields) {
-    GenParserFieldGetter(s, field);
+    GenParserFieldGetter(s, field, cache_offsets);
     s << "\n";
   }
   GenValidator(s);
   s << "\n";
+  if (cache_offsets) {
+    GenOffsetCache(s);
+  }
 
   s << " public:";
   GenParserToString(s);
@@ -100,7 +104,7 @@ void PacketDef::GenParserDefinition(std::ostream& s, bool generate_fuzzing, bool
     const auto& private_fields = fields_.GetFieldsWithTypes(fixed_types);
     s << " private:\n";
     for (const auto& field : private_fields) {
-      GenParserFieldGetter(s, field);
+      GenParserFieldGetter(s, field, cache_offsets);
       s << "\n";
     }
   }
@@ -166,11 +170,16 @@ void PacketDef::GenParserDefinitionPybind11(std::ostream& s) const {
   s << ";\n";
 }
 
-void PacketDef::GenParserFieldGetter(std::ostream& s, const PacketField* field) const {
+void PacketDef::GenParserFieldGetter(std::ostream& s, const PacketField* field, bool cache_offsets) const {
   // Start field offset
   auto start_field_offset = GetOffsetForField(field->GetName(), false);
   auto end_field_offset = GetOffsetForField(field->GetName(), true);
 
+  if (cache_offsets && HasCachedOffset(field)) {
+    // Keep the bits past the byte boundary, the cached offset is in bytes
+    start_field_offset = Size(start_field_offset.bits() % 8, field->GetName() + "_offset() * 8");
+  }
+
   if (start_field_offset.empty() && end_field_offset.empty()) {
     ERROR(field) << "Field location for " << field->GetName() << " is ambiguous, "
                  << "no method exists to determine field location from begin() or end().\n";
@@ -179,6 +188,32 @@ void PacketDef::GenParserFieldGetter(std::ostream& s, const PacketField* field)
   field->GenGetter(s, start_field_offset, end_field_offset);
 }
 
+bool PacketDef::HasCachedOffset(const PacketField* field) const {
+  if (field->GetGetterFunctionName().empty()) {
+    return false;
+  }
+  auto offset = GetOffsetForField(field->GetName(), false);
+  return !offset.empty() && offset.has_dynamic();
+}
+
+void PacketDef::GenOffsetCache(std::ostream& s) const {
+  // The offsets only depend on the bytes of the packet, so views built from
+  // this one (children, copies) keep them.
+  for (const auto& field : fields_) {
+    if (!HasCachedOffset(field)) {
+      continue;
+    }
+    const auto& offset_var = field->GetName() + "_offset_";
+    s << "size_t " << field->GetName() << "_offset() const {";
+    s << "if (" << offset_var << " == SIZE_MAX) {";
+    s << offset_var << " = (" << GetOffsetForField(field->GetName(), false) << ") / 8;";
+    s << "}";
+    s << "return " << offset_var << ";";
+    s << "}\n";
+    s << "mutable size_t " << offset_var << "{SIZE_MAX};\n";
+  }
+}
+
 TypeDef::Type PacketDef::GetDefinitionType() const {
   return TypeDef::Type::PACKET;
 }
@@ -272,8 +307,8 @@ void PacketDef::GenValidator(std::ostream& s) const {
       }
       s << started_field->GetDataType() << " checksum;";
       s << "checksum.Initialize();";
-      s << "for (uint8_t byte : checksum_view) { ";
-      s << "checksum.AddByte(byte);}";
+      s << "checksum_view.ForEachFragment([&checksum](const uint8_t* data, size_t length) { ";
+      s << "checksum.AddBytes(data, length);});";
       s << "if (checksum.GetChecksum() != (begin() + end_sum_index).extract<"
         << util::GetTypeForSize(started_field->GetSize().bits()) << ">()) { return false; }";
 
@@ -31,13 +31,20 @@ class PacketDef : public ParentDef {
 
   PacketField* GetNewField(const std::string& name, ParseLocation loc) const;
 
-  void GenParserDefinition(std::ostream& s, bool generate_fuzzing, bool generate_tests) const;
+  void GenParserDefinition(std::ostream& s, bool generate_fuzzing, bool generate_tests, bool cache_offsets) const;
 
   void GenTestingParserFromBytes(std::ostream& s) const;
 
   void GenParserDefinitionPybind11(std::ostream& s) const;
 
-  void GenParserFieldGetter(std::ostream& s, const PacketField* field) const;
+  void GenParserFieldGetter(std::ostream& s, const PacketField* field, bool cache_offsets) const;
+
+  // Fields with a getter whose offset from begin() depends on other fields
+  bool HasCachedOffset(const PacketField* field) const;
+
+  // With cache_offsets, the getters of these fields compute their offset once
+  // per view instead of re-reading the fields before them on every call.
+  void GenOffsetCache(std::ostream& s) const;
 
   void GenValidator(std::ostream& s) const;
 
@@ -1988,6 +1988,43 @@ TEST(GeneratedPacketTest, testCreateOptional) {
   ASSERT_TRUE(grandchild_view.has_value());
 }
 
+vector<uint8_t> arrays_packet{
+    0x03,  // _size_(bytes)
+    0x01, 0x02, 0x03,
+    0x06,  // _size_(sixteens)
+    0x01, 0x11, 0x02, 0x12, 0x03, 0x13,
+    0x0c,  // _size_(thirtytwos)
+    0x01, 0x11, 0x21, 0x31, 0x02, 0x12, 0x22, 0x32, 0x03, 0x13, 0x23, 0x33,
+};
+
+TEST(GeneratedPacketTest, testFieldsAfterVectors) {
+  std::vector<uint8_t> bytes{0x01, 0x02, 0x03};
+  std::vector<uint16_t> sixteens{0x1101, 0x1202, 0x1303};
+  std::vector<uint32_t> thirtytwos{0x31211101, 0x32221202, 0x33231303};
+
+  PacketView<kLittleEndian> packet_bytes_view(std::make_shared<std::vector<uint8_t>>(arrays_packet));
+  auto view = ArraysView::Create(packet_bytes_view);
+  ASSERT_TRUE(view.IsValid());
+  // The offsets of sixteens and thirtytwos are cached by the first reads
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(bytes, view.GetBytes());
+    ASSERT_EQ(sixteens, view.GetSixteens());
+    ASSERT_EQ(thirtytwos, view.GetThirtytwos());
+  }
+
+  auto copy = view;
+  ASSERT_EQ(sixteens, copy.GetSixteens());
+  ASSERT_EQ(thirtytwos, copy.GetThirtytwos());
+
+  // A view of other bytes does not reuse them
+  std::vector<uint8_t> shorter_packet{0x01, 0x01, 0x02, 0x01, 0x11, 0x04, 0x01, 0x11, 0x21, 0x31};
+  auto shorter_view =
+      ArraysView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(shorter_packet)));
+  ASSERT_TRUE(shorter_view.IsValid());
+  ASSERT_EQ(std::vector<uint16_t>{0x1101}, shorter_view.GetSixteens());
+  ASSERT_EQ(std::vector<uint32_t>{0x31211101}, shorter_view.GetThirtytwos());
+}
+
 TEST(GeneratedPacketTest, testStructWithShadowedNames) {
   uint32_t four_bytes = 0x01020304;
   StructType struct_type = StructType::TWO_BYTE;
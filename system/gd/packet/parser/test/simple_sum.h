@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace bluetooth {
@@ -33,6 +34,12 @@ class SimpleSum {
     sum += byte;
   }
 
+  void AddBytes(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      sum += data[i];
+    }
+  }
+
   uint16_t GetChecksum() const {
     return sum;
   }
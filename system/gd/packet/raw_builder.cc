@@ -91,9 +91,7 @@ bool RawBuilder::CanAddOctets(size_t num_bytes) const {
 }
 
 void RawBuilder::Serialize(BitInserter& it) const {
-  for (const auto& val : payload_) {
-    insert(val, it);
-  }
+  it.insert_bytes(payload_.data(), payload_.size());
 }
 
 size_t RawBuilder::size() const {
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/scatter_gather_builder.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace packet {
+
+ScatterGatherBuilder::ScatterGatherBuilder(std::shared_ptr<const std::vector<uint8_t>> segment) {
+  AddSegment(std::move(segment));
+}
+
+size_t ScatterGatherBuilder::size() const {
+  return size_;
+}
+
+void ScatterGatherBuilder::Serialize(BitInserter& it) const {
+  for (const auto& segment : segments_) {
+    it.insert_bytes(segment.data(), segment.size());
+  }
+}
+
+void ScatterGatherBuilder::AddSegment(std::shared_ptr<const std::vector<uint8_t>> segment) {
+  size_t segment_size = segment->size();
+  AddSegment(View(std::move(segment), 0, segment_size));
+}
+
+void ScatterGatherBuilder::AddSegment(View segment) {
+  if (segment.size() == 0) {
+    return;
+  }
+  size_ += segment.size();
+  segments_.push_back(segment);
+}
+
+std::vector<std::unique_ptr<ScatterGatherBuilder>> ScatterGatherBuilder::Fragment(const BasePacketBuilder& packet,
+                                                                                 size_t fragment_size) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bytes->reserve(packet.size());
+  BitInserter it(*bytes);
+  packet.Serialize(it);
+
+  std::shared_ptr<const std::vector<uint8_t>> shared_bytes = std::move(bytes);
+  std::vector<std::unique_ptr<ScatterGatherBuilder>> fragments;
+  fragments.reserve((shared_bytes->size() + fragment_size - 1) / fragment_size);
+  for (size_t begin = 0; begin < shared_bytes->size(); begin += fragment_size) {
+    auto fragment = std::make_unique<ScatterGatherBuilder>();
+    fragment->AddSegment(View(shared_bytes, begin, std::min(begin + fragment_size, shared_bytes->size())));
+    fragments.push_back(std::move(fragment));
+  }
+  return fragments;
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "packet/bit_inserter.h"
+#include "packet/fragment_list.h"
+#include "packet/packet_builder.h"
+#include "packet/view.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Payload made of refcounted segments. Unlike RawBuilder, the bytes are not
+// copied when the builder is made, only when it is serialized.
+class ScatterGatherBuilder : public PacketBuilder<true> {
+ public:
+  ScatterGatherBuilder() = default;
+  explicit ScatterGatherBuilder(std::shared_ptr<const std::vector<uint8_t>> segment);
+  virtual ~ScatterGatherBuilder() = default;
+
+  virtual size_t size() const override;
+
+  virtual void Serialize(BitInserter& it) const override;
+
+  // Add |segment| to the end of the payload, sharing its bytes.
+  void AddSegment(std::shared_ptr<const std::vector<uint8_t>> segment);
+  void AddSegment(View segment);
+
+  // Serialize |packet| once and cut it in payloads of at most |fragment_size|
+  // bytes, which share the serialized bytes. An empty packet has no fragment.
+  static std::vector<std::unique_ptr<ScatterGatherBuilder>> Fragment(const BasePacketBuilder& packet,
+                                                                     size_t fragment_size);
+
+  // Segments in payload order, for writers able to send them as an iovec.
+  const FragmentList& GetSegments() const {
+    return segments_;
+  }
+
+ private:
+  FragmentList segments_;
+  size_t size_{0};
+};
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/scatter_gather_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "packet/fragmenting_inserter.h"
+
+namespace bluetooth {
+namespace packet {
+
+namespace {
+
+std::shared_ptr<const std::vector<uint8_t>> MakeSegment(uint8_t first, size_t size) {
+  auto segment = std::make_shared<std::vector<uint8_t>>();
+  for (size_t i = 0; i < size; i++) {
+    segment->push_back(static_cast<uint8_t>(first + i));
+  }
+  return segment;
+}
+
+}  // namespace
+
+TEST(ScatterGatherBuilderTest, emptyTest) {
+  ScatterGatherBuilder builder;
+  ASSERT_EQ(0u, builder.size());
+  ASSERT_TRUE(builder.SerializeToBytes().empty());
+}
+
+TEST(ScatterGatherBuilderTest, segmentsAreSharedTest) {
+  auto first = MakeSegment(0x00, 4);
+  auto second = MakeSegment(0x04, 4);
+  ScatterGatherBuilder builder(first);
+  builder.AddSegment(second);
+  // Only the middle of the third segment is part of the payload
+  builder.AddSegment(View(MakeSegment(0x07, 4), 1, 3));
+  builder.AddSegment(std::make_shared<const std::vector<uint8_t>>());
+
+  ASSERT_EQ(10u, builder.size());
+  ASSERT_EQ(3u, builder.GetSegments().size());
+  ASSERT_EQ(first->data(), builder.GetSegments().begin()->data());
+
+  std::vector<uint8_t> expected = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+  ASSERT_EQ(expected, builder.SerializeToBytes());
+}
+
+TEST(ScatterGatherBuilderTest, serializeAfterBitsTest) {
+  ScatterGatherBuilder builder(MakeSegment(0x10, 2));
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  it.insert_bits(0x1, 4);
+  builder.Serialize(it);
+  it.insert_bits(0x0, 4);
+  std::vector<uint8_t> expected = {0x01, 0x11, 0x01};
+  ASSERT_EQ(expected, bytes);
+}
+
+TEST(ScatterGatherBuilderTest, fragmentTest) {
+  ScatterGatherBuilder builder(MakeSegment(0x00, 5));
+  builder.AddSegment(MakeSegment(0x05, 5));
+  std::vector<std::unique_ptr<RawBuilder>> fragments;
+  FragmentingInserter it(4, std::back_insert_iterator(fragments));
+  builder.Serialize(it);
+  it.finalize();
+
+  ASSERT_EQ(3u, fragments.size());
+  ASSERT_EQ(4u, fragments[0]->size());
+  ASSERT_EQ(4u, fragments[1]->size());
+  ASSERT_EQ(2u, fragments[2]->size());
+  std::vector<uint8_t> expected = {0x08, 0x09};
+  ASSERT_EQ(expected, fragments[2]->SerializeToBytes());
+}
+
+TEST(ScatterGatherBuilderTest, fragmentSharesBytesTest) {
+  ScatterGatherBuilder builder(MakeSegment(0x00, 5));
+  builder.AddSegment(MakeSegment(0x05, 5));
+  auto fragments = ScatterGatherBuilder::Fragment(builder, 4);
+
+  ASSERT_EQ(3u, fragments.size());
+  ASSERT_EQ(4u, fragments[0]->size());
+  ASSERT_EQ(4u, fragments[1]->size());
+  ASSERT_EQ(2u, fragments[2]->size());
+  // All the fragments are views of the same serialized bytes
+  ASSERT_EQ(fragments[0]->GetSegments().GetContiguousData() + 4, fragments[1]->GetSegments().GetContiguousData());
+  std::vector<uint8_t> expected = {0x08, 0x09};
+  ASSERT_EQ(expected, fragments[2]->SerializeToBytes());
+
+  ASSERT_TRUE(ScatterGatherBuilder::Fragment(ScatterGatherBuilder(), 4).empty());
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -21,6 +21,8 @@
 namespace bluetooth {
 namespace packet {
 
+View::View() : data_(nullptr), begin_(0), end_(0) {}
+
 View::View(std::shared_ptr<const std::vector<uint8_t>> data, size_t begin, size_t end)
     : data_(data), begin_(begin < data_->size() ? begin : data_->size()),
       end_(end < data_->size() ? end : data_->size()) {}
@@ -40,5 +42,9 @@ uint8_t View::operator[](size_t i) const {
 size_t View::size() const {
   return end_ - begin_;
 }
+
+const uint8_t* View::data() const {
+  return data_ == nullptr ? nullptr : data_->data() + begin_;
+}
 }  // namespace packet
 }  // namespace bluetooth
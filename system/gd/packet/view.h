@@ -26,15 +26,21 @@ namespace packet {
 // Base class that holds a shared pointer to data with bounds.
 class View {
  public:
+  // Empty view, not backed by any data
+  View();
   View(std::shared_ptr<const std::vector<uint8_t>> data, size_t begin, size_t end);
   View(const View& view, size_t begin, size_t end);
   View(const View& view) = default;
+  View& operator=(const View& view) = default;
   virtual ~View() = default;
 
   uint8_t operator[](size_t i) const;
 
   size_t size() const;
 
+  // Bytes of the view, nullptr for an empty view without data
+  const uint8_t* data() const;
+
  private:
   std::shared_ptr<const std::vector<uint8_t>> data_;
   size_t begin_;
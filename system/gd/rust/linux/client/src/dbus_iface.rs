@@ -589,6 +589,14 @@ impl IBluetoothCallback for IBluetoothCallbackDBus {
     ) {
     }
 
+    #[dbus_method("OnDevicesPropertiesChanged", DBusLog::Disable)]
+    fn on_devices_properties_changed(
+        &mut self,
+        remote_devices: Vec<BluetoothDevice>,
+        props: Vec<Vec<BtPropertyType>>,
+    ) {
+    }
+
     #[dbus_method("OnAddressChanged", DBusLog::Disable)]
     fn on_address_changed(&mut self, addr: String) {}
 
@@ -601,6 +609,9 @@ impl IBluetoothCallback for IBluetoothCallbackDBus {
     #[dbus_method("OnDeviceFound", DBusLog::Disable)]
     fn on_device_found(&mut self, remote_device: BluetoothDevice) {}
 
+    #[dbus_method("OnDevicesFound", DBusLog::Disable)]
+    fn on_devices_found(&mut self, remote_devices: Vec<BluetoothDevice>) {}
+
     #[dbus_method("OnDeviceCleared", DBusLog::Disable)]
     fn on_device_cleared(&mut self, remote_device: BluetoothDevice) {}
 
@@ -994,6 +1005,11 @@ impl IBluetooth for BluetoothDBus {
     fn is_swb_supported(&self) -> bool {
         dbus_generated!()
     }
+
+    #[dbus_method("SetCallbackBatching")]
+    fn set_callback_batching(&mut self, callback_id: u32, window_ms: u32) -> bool {
+        dbus_generated!()
+    }
 }
 
 pub(crate) struct BluetoothQALegacyDBus {
@@ -87,6 +87,14 @@ impl IBluetoothCallback for BluetoothCallbackDBus {
     ) {
         dbus_generated!()
     }
+    #[dbus_method("OnDevicesPropertiesChanged")]
+    fn on_devices_properties_changed(
+        &mut self,
+        remote_devices: Vec<BluetoothDevice>,
+        props: Vec<Vec<BtPropertyType>>,
+    ) {
+        dbus_generated!()
+    }
     #[dbus_method("OnAddressChanged")]
     fn on_address_changed(&mut self, addr: String) {
         dbus_generated!()
@@ -103,6 +111,10 @@ impl IBluetoothCallback for BluetoothCallbackDBus {
     fn on_device_found(&mut self, remote_device: BluetoothDevice) {
         dbus_generated!()
     }
+    #[dbus_method("OnDevicesFound")]
+    fn on_devices_found(&mut self, remote_devices: Vec<BluetoothDevice>) {
+        dbus_generated!()
+    }
     #[dbus_method("OnDeviceCleared")]
     fn on_device_cleared(&mut self, remote_device: BluetoothDevice) {
         dbus_generated!()
@@ -706,6 +718,11 @@ impl IBluetooth for IBluetoothDBus {
     fn is_swb_supported(&self) -> bool {
         dbus_generated!()
     }
+
+    #[dbus_method("SetCallbackBatching")]
+    fn set_callback_batching(&mut self, callback_id: u32, window_ms: u32) -> bool {
+        dbus_generated!()
+    }
 }
 
 impl_dbus_arg_enum!(SocketType);
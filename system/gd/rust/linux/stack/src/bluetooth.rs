@@ -46,7 +46,7 @@ use crate::bluetooth_gatt::{
     BluetoothGatt, GattActions, IBluetoothGatt, IScannerCallback, ScanResult,
 };
 use crate::bluetooth_media::{BluetoothMedia, IBluetoothMedia, MediaActions};
-use crate::callbacks::Callbacks;
+use crate::callbacks::{Callbacks, CoalescedEvents};
 use crate::socket_manager::SocketActions;
 use crate::uuid::{Profile, UuidHelper, HOGP};
 use crate::{APIMessage, BluetoothAPI, Message, RPCProxy, SuspendMode};
@@ -60,6 +60,9 @@ const MIN_ADV_INSTANCES_FOR_MULTI_ADV: u8 = 5;
 /// clear event should be sent to clients.
 const FOUND_DEVICE_FRESHNESS: Duration = Duration::from_secs(30);
 
+/// Longest window over which the events of an adapter callback can be batched.
+const MAX_CALLBACK_BATCH_WINDOW_MS: u32 = 1000;
+
 /// This is the value returned from Bluetooth Interface calls.
 // TODO(241930383): Add enum to topshim
 const BTM_SUCCESS: i32 = 0;
@@ -239,6 +242,15 @@ pub trait IBluetooth {
 
     /// Returns whether SWB is supported.
     fn is_swb_supported(&self) -> bool;
+
+    /// Batches the high frequency events of an adapter callback: the devices found and the
+    /// device property changes are then delivered through `on_devices_found` and
+    /// `on_devices_properties_changed`, at most once per `window_ms`. Changes to the same device
+    /// within a window are coalesced into one. A `window_ms` of 0 sends the pending events and
+    /// restores the per-event callbacks.
+    ///
+    /// Returns false if there is no such callback.
+    fn set_callback_batching(&mut self, callback_id: u32, window_ms: u32) -> bool;
 }
 
 /// Adapter API for Bluetooth qualification and verification.
@@ -292,6 +304,9 @@ pub enum DelayedActions {
 
     /// Scanner for BLE discovery is reporting a result.
     BleDiscoveryScannerResult(ScanResult),
+
+    /// The batching window of an adapter callback has elapsed.
+    FlushCallbackBatch(u32),
 }
 
 /// Serializable device used in various apis.
@@ -415,6 +430,18 @@ pub trait IBluetoothCallback: RPCProxy {
         props: Vec<BtPropertyType>,
     );
 
+    /// When the properties of several devices change, for the callbacks batching their events.
+    /// `props[i]` are the properties changed on `remote_devices[i]`.
+    fn on_devices_properties_changed(
+        &mut self,
+        remote_devices: Vec<BluetoothDevice>,
+        props: Vec<Vec<BtPropertyType>>,
+    ) {
+        for (remote_device, props) in remote_devices.into_iter().zip(props.into_iter()) {
+            self.on_device_properties_changed(remote_device, props);
+        }
+    }
+
     /// When any of the adapter local address is changed.
     fn on_address_changed(&mut self, addr: String);
 
@@ -427,6 +454,13 @@ pub trait IBluetoothCallback: RPCProxy {
     /// When a device is found via discovery.
     fn on_device_found(&mut self, remote_device: BluetoothDevice);
 
+    /// When devices are found via discovery, for the callbacks batching their events.
+    fn on_devices_found(&mut self, remote_devices: Vec<BluetoothDevice>) {
+        for remote_device in remote_devices {
+            self.on_device_found(remote_device);
+        }
+    }
+
     /// When a device is cleared from discovered devices cache.
     fn on_device_cleared(&mut self, remote_device: BluetoothDevice);
 
@@ -487,6 +521,42 @@ pub trait IBluetoothConnectionCallback: RPCProxy {
     fn on_device_disconnected(&mut self, remote_device: BluetoothDevice);
 }
 
+/// Events pending for an adapter callback that batches them.
+struct AdapterCallbackBatch {
+    window: Duration,
+    flush_scheduled: bool,
+    devices_found: CoalescedEvents<String, BluetoothDevice>,
+    properties_changed: CoalescedEvents<String, (BluetoothDevice, Vec<BtPropertyType>)>,
+}
+
+impl AdapterCallbackBatch {
+    fn new(window: Duration) -> Self {
+        AdapterCallbackBatch {
+            window,
+            flush_scheduled: false,
+            devices_found: CoalescedEvents::new(),
+            properties_changed: CoalescedEvents::new(),
+        }
+    }
+
+    /// Flushes the batch of callback `id` at the end of its window.
+    fn schedule_flush(&mut self, id: u32, tx: &Sender<Message>) {
+        if self.flush_scheduled {
+            return;
+        }
+        self.flush_scheduled = true;
+
+        let txl = tx.clone();
+        let window = self.window;
+        tokio::spawn(async move {
+            tokio::time::sleep(window).await;
+            let _ = txl
+                .send(Message::DelayedAdapterActions(DelayedActions::FlushCallbackBatch(id)))
+                .await;
+        });
+    }
+}
+
 /// Implementation of the adapter API.
 pub struct Bluetooth {
     intf: Arc<Mutex<BluetoothInterface>>,
@@ -500,6 +570,7 @@ pub struct Bluetooth {
     bluetooth_gatt: Arc<Mutex<Box<BluetoothGatt>>>,
     bluetooth_media: Arc<Mutex<Box<BluetoothMedia>>>,
     callbacks: Callbacks<dyn IBluetoothCallback + Send>,
+    callback_batches: HashMap<u32, AdapterCallbackBatch>,
     connection_callbacks: Callbacks<dyn IBluetoothConnectionCallback + Send>,
     discovering_started: Instant,
     hh: Option<HidHost>,
@@ -547,6 +618,7 @@ impl Bluetooth {
             hci_index,
             bonded_devices: HashMap::new(),
             callbacks: Callbacks::new(tx.clone(), Message::AdapterCallbackDisconnected),
+            callback_batches: HashMap::new(),
             connection_callbacks: Callbacks::new(
                 tx.clone(),
                 Message::ConnectionCallbackDisconnected,
@@ -723,9 +795,87 @@ impl Bluetooth {
     }
 
     pub(crate) fn adapter_callback_disconnected(&mut self, id: u32) {
+        self.callback_batches.remove(&id);
         self.callbacks.remove_callback(id);
     }
 
+    /// Sends a found device to the adapter callbacks, batching it for those that asked.
+    fn notify_device_found(&mut self, remote_device: &BluetoothDevice) {
+        let tx = &self.tx;
+        let batches = &mut self.callback_batches;
+        self.callbacks.for_all_callbacks_with_id(|id, callback| match batches.get_mut(&id) {
+            Some(batch) => {
+                batch.devices_found.push(
+                    remote_device.address.clone(),
+                    remote_device.clone(),
+                    |pending, device| *pending = device,
+                );
+                batch.schedule_flush(id, tx);
+            }
+            None => callback.on_device_found(remote_device.clone()),
+        });
+    }
+
+    /// Sends device property changes to the adapter callbacks, batching them for those that
+    /// asked.
+    fn notify_device_properties_changed(
+        &mut self,
+        remote_device: &BluetoothDevice,
+        props: Vec<BtPropertyType>,
+    ) {
+        let tx = &self.tx;
+        let batches = &mut self.callback_batches;
+        self.callbacks.for_all_callbacks_with_id(|id, callback| match batches.get_mut(&id) {
+            Some(batch) => {
+                batch.properties_changed.push(
+                    remote_device.address.clone(),
+                    (remote_device.clone(), props.clone()),
+                    |(pending_device, pending_props), (device, props)| {
+                        *pending_device = device;
+                        for prop in props {
+                            if !pending_props.contains(&prop) {
+                                pending_props.push(prop);
+                            }
+                        }
+                    },
+                );
+                batch.schedule_flush(id, tx);
+            }
+            None => callback.on_device_properties_changed(remote_device.clone(), props.clone()),
+        });
+    }
+
+    /// Sends the events batched for adapter callback `id`.
+    fn flush_callback_batch(&mut self, id: u32) {
+        let batch = match self.callback_batches.get_mut(&id) {
+            Some(batch) => batch,
+            None => return,
+        };
+        batch.flush_scheduled = false;
+        let devices_found = batch.devices_found.take();
+        let properties_changed = batch.properties_changed.take();
+
+        if let Some(callback) = self.callbacks.get_by_id_mut(id) {
+            if !devices_found.is_empty() {
+                callback.on_devices_found(devices_found);
+            }
+            if !properties_changed.is_empty() {
+                let (remote_devices, props): (Vec<_>, Vec<_>) =
+                    properties_changed.into_iter().unzip();
+                callback.on_devices_properties_changed(remote_devices, props);
+            }
+        }
+    }
+
+    /// Sends the events batched for all adapter callbacks, so that they are not delivered after
+    /// an event that follows them, e.g. a device being cleared.
+    fn flush_callback_batches(&mut self) {
+        let ids: Vec<u32> = self.callback_batches.keys().cloned().collect();
+        for id in ids {
+            self.flush_callback_batch(id);
+        }
+    }
+
     pub(crate) fn connection_callback_disconnected(&mut self, id: u32) {
         self.connection_callbacks.remove_callback(id);
     }
@@ -915,6 +1065,10 @@ impl Bluetooth {
         // Retain only devices that are fresh.
         self.found_devices.retain(|_, d| is_fresh(d, &now));
 
+        if !stale_devices.is_empty() {
+            self.flush_callback_batches();
+        }
+
         for d in stale_devices {
             self.callbacks.for_all_callbacks(|callback| {
                 callback.on_device_cleared(d.clone());
@@ -970,6 +1124,10 @@ impl Bluetooth {
                 self.trigger_freshness_check();
             }
 
+            DelayedActions::FlushCallbackBatch(id) => {
+                self.flush_callback_batch(id);
+            }
+
             DelayedActions::ConnectAllProfiles(device) => {
                 self.connect_all_enabled_profiles(device);
             }
@@ -1435,13 +1593,11 @@ impl BtifBluetoothCallbacks for Bluetooth {
             self.found_devices.insert(address.clone(), device_with_props);
         }
 
-        let device = self.found_devices.get(&address).unwrap();
+        let info = self.found_devices.get(&address).unwrap().info.clone();
 
-        self.callbacks.for_all_callbacks(|callback| {
-            callback.on_device_found(device.info.clone());
-        });
+        self.notify_device_found(&info);
 
-        self.bluetooth_admin.lock().unwrap().on_device_found(&device.info);
+        self.bluetooth_admin.lock().unwrap().on_device_found(&info);
     }
 
     fn discovery_state(&mut self, state: BtDiscoveryState) {
@@ -1468,6 +1624,8 @@ impl BtifBluetoothCallbacks for Bluetooth {
             return;
         }
 
+        // The devices found during the discovery are reported before it ends.
+        self.flush_callback_batches();
         self.callbacks.for_all_callbacks(|callback| {
             callback.on_discovering_changed(state == BtDiscoveryState::Started);
         });
@@ -1688,12 +1846,10 @@ impl BtifBluetoothCallbacks for Bluetooth {
                 }
 
                 let info = &d.info.clone();
-                self.callbacks.for_all_callbacks(|callback| {
-                    callback.on_device_properties_changed(
-                        info.clone(),
-                        properties.clone().into_iter().map(|x| x.get_type()).collect(),
-                    );
-                });
+                self.notify_device_properties_changed(
+                    info,
+                    properties.clone().into_iter().map(|x| x.get_type()).collect(),
+                );
 
                 self.bluetooth_admin
                     .lock()
@@ -1877,6 +2033,7 @@ impl IBluetooth for Bluetooth {
     }
 
     fn unregister_callback(&mut self, callback_id: u32) -> bool {
+        self.callback_batches.remove(&callback_id);
         self.callbacks.remove_callback(callback_id)
     }
 
@@ -2733,6 +2890,25 @@ impl IBluetooth for Bluetooth {
     fn is_swb_supported(&self) -> bool {
         self.intf.lock().unwrap().get_swb_supported()
     }
+
+    fn set_callback_batching(&mut self, callback_id: u32, window_ms: u32) -> bool {
+        if self.callbacks.get_by_id(callback_id).is_none() {
+            return false;
+        }
+
+        if window_ms == 0 {
+            self.flush_callback_batch(callback_id);
+            self.callback_batches.remove(&callback_id);
+            return true;
+        }
+
+        let window = Duration::from_millis(window_ms.min(MAX_CALLBACK_BATCH_WINDOW_MS).into());
+        self.callback_batches
+            .entry(callback_id)
+            .or_insert_with(|| AdapterCallbackBatch::new(window))
+            .window = window;
+        true
+    }
 }
 
 impl BtifSdpCallbacks for Bluetooth {
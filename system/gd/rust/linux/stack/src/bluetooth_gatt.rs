@@ -5,10 +5,10 @@ use btif_macros::{btif_callback, btif_callbacks_dispatcher};
 use bt_topshim::bindings::root::bluetooth::Uuid;
 use bt_topshim::btif::{BluetoothInterface, BtStatus, BtTransport, RawAddress, Uuid128Bit};
 use bt_topshim::profiles::gatt::{
-    ffi::RustAdvertisingTrackInfo, AdvertisingStatus, BtGattDbElement, BtGattNotifyParams,
-    BtGattReadParams, BtGattResponse, BtGattValue, Gatt, GattAdvCallbacks,
-    GattAdvCallbacksDispatcher, GattAdvInbandCallbacksDispatcher, GattClientCallbacks,
-    GattClientCallbacksDispatcher, GattScannerCallbacks, GattScannerCallbacksDispatcher,
+    ffi::RustAdvertisingTrackInfo, AdvertisingStatus, BtGattDbElement, BtGattReadParams,
+    BtGattResponse, BtGattValue, Gatt, GattAdvCallbacks, GattAdvCallbacksDispatcher,
+    GattAdvInbandCallbacksDispatcher, GattClientCallbacks, GattClientCallbacksDispatcher,
+    GattNotification, GattScannerCallbacks, GattScannerCallbacksDispatcher,
     GattScannerInbandCallbacks, GattScannerInbandCallbacksDispatcher, GattServerCallbacks,
     GattServerCallbacksDispatcher, GattStatus, LePhy, MsftAdvMonitor, MsftAdvMonitorPattern,
 };
@@ -2986,7 +2986,7 @@ pub(crate) trait BtifGattClientCallbacks {
     );
 
     #[btif_callback(Notify)]
-    fn notify_cb(&mut self, conn_id: i32, data: BtGattNotifyParams);
+    fn notify_cb(&mut self, conn_id: i32, data: GattNotification);
 
     #[btif_callback(ReadCharacteristic)]
     fn read_characteristic_cb(&mut self, conn_id: i32, status: GattStatus, data: BtGattReadParams);
@@ -3140,17 +3140,13 @@ impl BtifGattClientCallbacks for BluetoothGatt {
         // No-op.
     }
 
-    fn notify_cb(&mut self, conn_id: i32, data: BtGattNotifyParams) {
+    fn notify_cb(&mut self, conn_id: i32, data: GattNotification) {
         let client = self.context_map.get_client_by_conn_id(conn_id);
         if let Some(c) = client {
             let cbid = c.cbid;
             self.context_map.get_callback_from_callback_id(cbid).and_then(
                 |cb: &mut GattClientCallback| {
-                    cb.on_notify(
-                        data.bda.to_string(),
-                        data.handle as i32,
-                        data.value[0..data.len as usize].to_vec(),
-                    );
+                    cb.on_notify(data.bda.to_string(), data.handle as i32, data.value);
                     Some(())
                 },
             );
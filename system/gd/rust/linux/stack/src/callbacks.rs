@@ -1,6 +1,7 @@
 //! Provides utilities for managing callbacks.
 
 use std::collections::HashMap;
+use std::hash::Hash;
 use tokio::sync::mpsc::Sender;
 
 use crate::{Message, RPCProxy};
@@ -90,6 +91,50 @@ impl<T: RPCProxy + Send + ?Sized> Callbacks<T> {
             f(callback);
         }
     }
+
+    /// Applies the given function on all active callbacks, along with their ids.
+    pub fn for_all_callbacks_with_id<F: FnMut(u32, &mut Box<T>)>(&mut self, mut f: F) {
+        for (id, ref mut callback) in self.callbacks.iter_mut() {
+            f(*id, callback);
+        }
+    }
+}
+
+/// Coalesces the pending events of one kind destined to a callback, so that they can be delivered
+/// in a single batched call instead of one call each.
+///
+/// Events are keyed, e.g. by device address. An event whose key is already pending is merged into
+/// the pending one, and the batch keeps the order in which the keys were first pushed.
+pub struct CoalescedEvents<K, V> {
+    keys: Vec<K>,
+    events: HashMap<K, V>,
+}
+
+impl<K: Clone + Eq + Hash, V> CoalescedEvents<K, V> {
+    pub fn new() -> Self {
+        Self { keys: vec![], events: HashMap::new() }
+    }
+
+    /// Adds an event, merging it with `merge` into the pending event of the same key if any.
+    pub fn push<F: FnOnce(&mut V, V)>(&mut self, key: K, event: V, merge: F) {
+        match self.events.get_mut(&key) {
+            Some(pending) => merge(pending, event),
+            None => {
+                self.keys.push(key.clone());
+                self.events.insert(key, event);
+            }
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.keys.is_empty()
+    }
+
+    /// Takes all the pending events.
+    pub fn take(&mut self) -> Vec<V> {
+        let mut events = std::mem::take(&mut self.events);
+        std::mem::take(&mut self.keys).into_iter().filter_map(|k| events.remove(&k)).collect()
+    }
 }
 
 #[cfg(test)]
@@ -152,4 +197,20 @@ mod tests {
         let cbid2 = callbacks.add_callback(Box::new(TestCallback::new(cb_string.clone())));
         assert_ne!(cbid, cbid2);
     }
+
+    #[test]
+    fn test_coalesced_events() {
+        let mut events: CoalescedEvents<String, Vec<u32>> = CoalescedEvents::new();
+        assert!(events.is_empty());
+
+        events.push(String::from("b"), vec![1], |pending, e| pending.extend(e));
+        events.push(String::from("a"), vec![2], |pending, e| pending.extend(e));
+        events.push(String::from("b"), vec![3], |pending, e| pending.extend(e));
+        assert!(!events.is_empty());
+
+        // Events are merged per key, in the order the keys were first pushed.
+        assert_eq!(events.take(), vec![vec![1, 3], vec![2]]);
+        assert!(events.is_empty());
+        assert!(events.take().is_empty());
+    }
 }
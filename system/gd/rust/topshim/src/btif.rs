@@ -1390,6 +1390,15 @@ pub(crate) fn ptr_to_vec<T: Copy, U: From<T>>(start: *const T, length: usize) ->
     }
 }
 
+// Turns C-array u8[] to Vec<u8> with a single copy, rather than element by element as
+// |ptr_to_vec| does. Used for the payloads of the high rate callbacks, e.g. scan results.
+pub(crate) fn ptr_to_bytes(start: *const u8, length: usize) -> Vec<u8> {
+    if start.is_null() || length == 0 {
+        return vec![];
+    }
+    unsafe { std::slice::from_raw_parts(start, length).to_vec() }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1430,6 +1439,14 @@ mod tests {
         assert_eq!(expected, vec);
     }
 
+    #[test]
+    fn test_ptr_to_bytes() {
+        let arr: [u8; 4] = [1, 2, 3, 4];
+        assert_eq!(vec![1, 2, 3], ptr_to_bytes(arr.as_ptr(), 3));
+        assert!(ptr_to_bytes(arr.as_ptr(), 0).is_empty());
+        assert!(ptr_to_bytes(std::ptr::null(), 4).is_empty());
+    }
+
     #[test]
     fn test_property_with_string_conversions() {
         {
@@ -1,5 +1,7 @@
 use crate::bindings::root as bindings;
-use crate::btif::{ptr_to_vec, BluetoothInterface, BtStatus, RawAddress, SupportedProfiles, Uuid};
+use crate::btif::{
+    ptr_to_bytes, ptr_to_vec, BluetoothInterface, BtStatus, RawAddress, SupportedProfiles, Uuid,
+};
 use crate::profiles::gatt::bindings::{
     btgatt_callbacks_t, btgatt_client_callbacks_t, btgatt_client_interface_t, btgatt_interface_t,
     btgatt_scanner_callbacks_t, btgatt_server_callbacks_t, btgatt_server_interface_t,
@@ -583,6 +585,30 @@ impl From<u8> for AdvertisingStatus {
     }
 }
 
+/// A notification or indication from a remote GATT server, holding only the bytes of its value.
+///
+/// |BtGattNotifyParams| always carries a |GATT_MAX_ATTR_LEN| array, which would otherwise be
+/// copied in full on its way to the stack, and copied again into the value sent to the clients.
+#[derive(Debug)]
+pub struct GattNotification {
+    pub bda: RawAddress,
+    pub handle: u16,
+    pub is_notify: bool,
+    pub value: Vec<u8>,
+}
+
+impl From<&BtGattNotifyParams> for GattNotification {
+    fn from(params: &BtGattNotifyParams) -> Self {
+        let len = std::cmp::min(params.len as usize, params.value.len());
+        GattNotification {
+            bda: params.bda,
+            handle: params.handle,
+            is_notify: params.is_notify != 0,
+            value: params.value[..len].to_vec(),
+        }
+    }
+}
+
 #[derive(Debug)]
 pub enum GattClientCallbacks {
     RegisterClient(GattStatus, i32, Uuid),
@@ -590,7 +616,7 @@ pub enum GattClientCallbacks {
     Disconnect(i32, GattStatus, i32, RawAddress),
     SearchComplete(i32, GattStatus),
     RegisterForNotification(i32, i32, GattStatus, u16),
-    Notify(i32, BtGattNotifyParams),
+    Notify(i32, GattNotification),
     ReadCharacteristic(i32, GattStatus, BtGattReadParams),
     WriteCharacteristic(i32, GattStatus, u16, u16, *const u8),
     ReadDescriptor(i32, GattStatus, BtGattReadParams),
@@ -679,7 +705,7 @@ cb_variant!(
     GattClientCb,
     gc_notify_cb -> GattClientCallbacks::Notify,
     i32, *const BtGattNotifyParams, {
-        let _1 = unsafe { *_1.clone() };
+        let _1 = GattNotification::from(unsafe { &*_1 });
     }
 );
 
@@ -825,7 +851,7 @@ cb_variant!(
     gs_request_write_characteristic_cb -> GattServerCallbacks::RequestWriteCharacteristic,
     i32, i32, *const RawAddress, i32, i32, bool, bool, *const u8, usize, {
         let _2 = unsafe { *_2 };
-        let _7 = ptr_to_vec(_7, _8);
+        let _7 = ptr_to_bytes(_7, _8);
     }
 );
 
@@ -834,7 +860,7 @@ cb_variant!(
     gs_request_write_descriptor_cb -> GattServerCallbacks::RequestWriteDescriptor,
     i32, i32, *const RawAddress, i32, i32, bool, bool, *const u8, usize, {
         let _2 = unsafe { *_2 };
-        let _7 = ptr_to_vec(_7, _8);
+        let _7 = ptr_to_bytes(_7, _8);
     }
 );
 
@@ -935,7 +961,7 @@ cb_variant!(
         // Convert the vec! at the end. Since this cb is being called via cxx
         // ffi, we do the vector separation at the cxx layer. The usize is consumed during
         // conversion.
-        let _9 : Vec<u8> = ptr_to_vec(_9, _10);
+        let _9 = ptr_to_bytes(_9, _10);
     }
 );
 
@@ -949,7 +975,7 @@ cb_variant!(
     gdscan_on_batch_scan_reports -> GattScannerCallbacks::OnBatchScanReports,
     i32, i32, i32, i32, *const u8, usize -> _, {
         // Write the vector to the output and consume the usize in the input.
-        let _4 : Vec<u8> = ptr_to_vec(_4, _5);
+        let _4 = ptr_to_bytes(_4, _5);
     }
 );
 
@@ -1034,7 +1060,7 @@ u8, u16, u8, u8, *const RawAddress, u8, u16, {
 cb_variant!(GDScannerInbandCb,
 gdscan_sync_report_callback -> GattScannerInbandCallbacks::SyncReportCallback,
 u16, i8, i8, u8, *const u8, usize -> _, {
-    let _4 = ptr_to_vec(_4, _5 as usize);
+    let _4 = ptr_to_bytes(_4, _5 as usize);
 });
 cb_variant!(GDScannerInbandCb, gdscan_sync_lost_callback -> GattScannerInbandCallbacks::SyncLostCallback, u16);
 cb_variant!(GDScannerInbandCb, gdscan_sync_transfer_callback -> GattScannerInbandCallbacks::SyncTransferCallback,
@@ -1852,6 +1878,7 @@ impl Gatt {
             services_removed_cb: None,
             services_added_cb: None,
             subrate_chg_cb: None,
+            notify_batch_cb: None,
         });
 
         let gatt_server_callbacks = Box::new(btgatt_server_callbacks_t {
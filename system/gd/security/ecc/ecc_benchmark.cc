@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "security/ecc/p_256_ecc_pp.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace security {
+namespace ecc {
+
+namespace {
+
+const uint32_t kPrivateKey[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b, 0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+
+}  // namespace
+
+// Public key generation, the way it was computed for every pairing
+void BM_EccPointMultBinNaf(State& state) {
+  Point q;
+  for (auto _ : state) {
+    uint32_t n[KEY_LENGTH_DWORDS_P256];
+    multiprecision_copy(n, kPrivateKey);
+    ECC_PointMult_Bin_NAF(&q, &curve_p256.G, n);
+    benchmark::DoNotOptimize(q);
+  }
+}
+
+void BM_EccPointMultWindow(State& state) {
+  Point q;
+  for (auto _ : state) {
+    ECC_PointMult_Window(&q, &curve_p256.G, kPrivateKey);
+    benchmark::DoNotOptimize(q);
+  }
+}
+
+void BM_EccPointMultBase(State& state) {
+  Point q;
+  for (auto _ : state) {
+    ECC_PointMult_Base(&q, kPrivateKey);
+    benchmark::DoNotOptimize(q);
+  }
+}
+
+BENCHMARK(BM_EccPointMultBinNaf);
+BENCHMARK(BM_EccPointMultWindow);
+BENCHMARK(BM_EccPointMultBase);
+
+}  // namespace ecc
+}  // namespace security
+}  // namespace bluetooth
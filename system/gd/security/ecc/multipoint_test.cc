@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 #include "security/ecc/p_256_ecc_pp.h"
 
 namespace bluetooth {
@@ -107,6 +109,72 @@ TEST(SmpEccValidationTest, test_invalid_points) {
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
 
+// Private keys and DHKey from Bluetooth Core Specification
+// Version 5.0 | Vol 3, Part H | 2.3.5.6.1
+static const uint32_t kPrivateKeyA[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b, 0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+static const uint32_t kPublicKeyAX[KEY_LENGTH_DWORDS_P256] = {
+    0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111, 0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2};
+static const uint32_t kPublicKeyAY[KEY_LENGTH_DWORDS_P256] = {
+    0x1589d28b, 0x741c8ed0, 0x8fed3024, 0x766345c2, 0x5a52155c, 0x63329abf, 0x652aeb6d, 0xdc809c49};
+static const uint32_t kPrivateKeyB[KEY_LENGTH_DWORDS_P256] = {
+    0xf47fc5fd, 0x6b4fdd49, 0xf19d7cfb, 0x59cb9ac2, 0xeed4e72a, 0x900afcfb, 0x32f6bb9a, 0x55188b3d};
+static const uint32_t kDhKey[KEY_LENGTH_DWORDS_P256] = {
+    0x73bfa698, 0x868d34f3, 0xb4f866f1, 0x99796b13, 0x0a397d9b, 0x341010a6, 0x57c8ad05, 0xec0234a3};
+
+static bool IsEqual(const uint32_t* a, const uint32_t* b) {
+  return memcmp(a, b, KEY_LENGTH_DWORDS_P256 * sizeof(uint32_t)) == 0;
+}
+
+TEST(SmpEccPointMultTest, test_base_point_mult) {
+  Point q;
+  ECC_PointMult_Base(&q, kPrivateKeyA);
+  EXPECT_TRUE(IsEqual(q.x, kPublicKeyAX));
+  EXPECT_TRUE(IsEqual(q.y, kPublicKeyAY));
+}
+
+TEST(SmpEccPointMultTest, test_dhkey) {
+  Point public_key_a;
+  ECC_PointMult_Base(&public_key_a, kPrivateKeyA);
+
+  Point public_key_b;
+  ECC_PointMult_Base(&public_key_b, kPrivateKeyB);
+
+  Point q;
+  ECC_PointMult_Window(&q, &public_key_b, kPrivateKeyA);
+  EXPECT_TRUE(IsEqual(q.x, kDhKey));
+  ECC_PointMult_Window(&q, &public_key_a, kPrivateKeyB);
+  EXPECT_TRUE(IsEqual(q.x, kDhKey));
+}
+
+TEST(SmpEccPointMultTest, test_window_matches_naf) {
+  uint32_t n[KEY_LENGTH_DWORDS_P256];
+  for (uint32_t seed = 1; seed <= 16; seed++) {
+    for (int i = 0; i < KEY_LENGTH_DWORDS_P256; i++) {
+      n[i] = seed * 0x9e3779b9u * (i + 1);
+    }
+    // Small scalars go through the infinity entry of the tables
+    if (seed == 16) {
+      multiprecision_init(n);
+      n[0] = 0x11;
+    }
+
+    Point expected;
+    uint32_t naf_n[KEY_LENGTH_DWORDS_P256];
+    multiprecision_copy(naf_n, n);
+    ECC_PointMult_Bin_NAF(&expected, &curve_p256.G, naf_n);
+
+    Point q;
+    ECC_PointMult_Window(&q, &curve_p256.G, n);
+    EXPECT_TRUE(IsEqual(q.x, expected.x));
+    EXPECT_TRUE(IsEqual(q.y, expected.y));
+
+    ECC_PointMult_Base(&q, n);
+    EXPECT_TRUE(IsEqual(q.x, expected.x));
+    EXPECT_TRUE(IsEqual(q.y, expected.y));
+  }
+}
+
 }  // namespace ecc
 }  // namespace security
 }  // namespace bluetooth
@@ -67,9 +67,20 @@ static constexpr elliptic_curve_t curve_p256{
 /* This function checks that point is on the elliptic curve*/
 bool ECC_ValidatePoint(const Point& point);
 
+#define ECC_WINDOW_BITS 4
+#define ECC_WINDOW_SIZE (1 << ECC_WINDOW_BITS)
+#define ECC_KEY_LENGTH_BITS_P256 (KEY_LENGTH_DWORDS_P256 * 32)
+#define ECC_COMB_TEETH_SPACING (ECC_KEY_LENGTH_BITS_P256 / ECC_WINDOW_BITS)
+
 void ECC_PointMult_Bin_NAF(Point* q, const Point* p, uint32_t* n);
 
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+/* q = n * p, with a fixed window of ECC_WINDOW_BITS */
+void ECC_PointMult_Window(Point* q, const Point* p, const uint32_t* n);
+
+/* q = n * G, with a precomputed comb table of the base point */
+void ECC_PointMult_Base(Point* q, const uint32_t* n);
+
+#define ECC_PointMult(q, p, n) ECC_PointMult_Window(q, p, n)
 
 }  // namespace ecc
 }  // namespace security
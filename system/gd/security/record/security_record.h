@@ -18,6 +18,9 @@
 
 #pragma once
 
+#include <optional>
+#include <string>
+
 #include "hci/address_with_type.h"
 #include "hci/octets.h"
 #include "storage/device.h"
@@ -133,6 +136,9 @@ class SecurityRecord {
   std::optional<hci::Octet16> local_ltk;
   std::optional<uint16_t> local_ediv;
   std::optional<std::array<uint8_t, 8>> local_rand;
+
+  /* Persisted fields as of the last save to or load from the storage, to only write the records that changed */
+  std::optional<std::string> saved_state_;
 };
 
 }  // namespace record
@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "hci/address_with_type.h"
 #include "security/record/security_record.h"
@@ -26,6 +29,9 @@ namespace bluetooth {
 namespace security {
 namespace record {
 
+// Keeps the security records, indexed by pseudo address and identity address. The identity addresses and IRKs are
+// only known after pairing: the indexes of a record are refreshed when it is created, loaded or saved, which is done
+// after every change of its keys.
 class SecurityRecordDatabase {
  public:
   SecurityRecordDatabase(record::SecurityRecordStorage security_record_storage)
@@ -41,6 +47,7 @@ class SecurityRecordDatabase {
     // No security record, create one
     auto record_ptr = std::make_shared<SecurityRecord>(address);
     records_.insert(record_ptr);
+    IndexRecord(record_ptr);
     return record_ptr;
   }
 
@@ -50,30 +57,77 @@ class SecurityRecordDatabase {
     // No record exists
     if (it == records_.end()) return;
 
+    UnindexRecord(*it);
     records_.erase(it);
     security_record_storage_.RemoveDevice(address);
   }
 
   iterator Find(hci::AddressWithType address) {
-    for (auto it = records_.begin(); it != records_.end(); ++it) {
-      std::shared_ptr<SecurityRecord> record = *it;
-      if (record->identity_address_.has_value() && record->identity_address_.value() == address) return it;
-      if (record->GetPseudoAddress() == address) return it;
-      if (record->remote_irk.has_value() && address.IsRpaThatMatchesIrk(record->remote_irk.value())) return it;
-    }
-    return records_.end();
+    auto record = FindRecord(address);
+    if (record == nullptr) return records_.end();
+    return records_.find(record);
   }
 
   void LoadRecordsFromStorage() {
     security_record_storage_.LoadSecurityRecords(&records_);
+    RebuildIndexes();
   }
 
   void SaveRecordsToStorage() {
     security_record_storage_.SaveSecurityRecords(&records_);
+    RebuildIndexes();
   }
 
   std::set<std::shared_ptr<SecurityRecord>> records_;
   record::SecurityRecordStorage security_record_storage_;
+
+ private:
+  std::shared_ptr<SecurityRecord> FindRecord(const hci::AddressWithType& address) const {
+    // The indexed fields are public, check that they still match
+    auto identity = identity_index_.find(address);
+    if (identity != identity_index_.end() && identity->second->identity_address_ == address) {
+      return identity->second;
+    }
+    auto pseudo = pseudo_index_.find(address);
+    if (pseudo != pseudo_index_.end() && pseudo->second->GetPseudoAddress() == address) {
+      return pseudo->second;
+    }
+    if (!address.IsRpa()) return nullptr;
+    for (const auto& record : resolvable_records_) {
+      if (record->remote_irk.has_value() && address.IsRpaThatMatchesIrk(record->remote_irk.value())) return record;
+    }
+    return nullptr;
+  }
+
+  void IndexRecord(const std::shared_ptr<SecurityRecord>& record) {
+    if (record->pseudo_address_.has_value()) pseudo_index_.emplace(record->pseudo_address_.value(), record);
+    if (record->identity_address_.has_value()) identity_index_.emplace(record->identity_address_.value(), record);
+    if (record->remote_irk.has_value()) resolvable_records_.push_back(record);
+  }
+
+  void UnindexRecord(const std::shared_ptr<SecurityRecord>& record) {
+    for (auto* index : {&pseudo_index_, &identity_index_}) {
+      for (auto it = index->begin(); it != index->end();) {
+        it = (it->second == record) ? index->erase(it) : std::next(it);
+      }
+    }
+    resolvable_records_.erase(
+        std::remove(resolvable_records_.begin(), resolvable_records_.end(), record), resolvable_records_.end());
+  }
+
+  void RebuildIndexes() {
+    pseudo_index_.clear();
+    identity_index_.clear();
+    resolvable_records_.clear();
+    for (const auto& record : records_) {
+      IndexRecord(record);
+    }
+  }
+
+  std::unordered_map<hci::AddressWithType, std::shared_ptr<SecurityRecord>> pseudo_index_;
+  std::unordered_map<hci::AddressWithType, std::shared_ptr<SecurityRecord>> identity_index_;
+  // Records with an IRK, to resolve the RPAs with
+  std::vector<std::shared_ptr<SecurityRecord>> resolvable_records_;
 };
 
 }  // namespace record
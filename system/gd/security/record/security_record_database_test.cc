@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+#include "security/record/security_record_database.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace security {
+namespace record {
+namespace {
+
+const hci::AddressWithType kPseudoAddress(
+    hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::RANDOM_DEVICE_ADDRESS);
+const hci::AddressWithType kIdentityAddress(
+    hci::Address({0x11, 0x12, 0x13, 0x14, 0x15, 0xc6}), hci::AddressType::RANDOM_DEVICE_ADDRESS);
+// RPA generated from kIrk
+const hci::AddressWithType kRpa(
+    hci::Address({0xDE, 0x12, 0xC9, 0x03, 0x02, 0x50}), hci::AddressType::RANDOM_DEVICE_ADDRESS);
+const hci::Octet16 kIrk{
+    0x90, 0x5e, 0x60, 0x59, 0xc9, 0x11, 0x43, 0x7b, 0x04, 0x09, 0x6a, 0x53, 0x28, 0xe6, 0x59, 0x6d};
+
+class SecurityRecordDatabaseTest : public ::testing::Test {
+ protected:
+  // Temporary records are never written, the storage is not needed
+  std::shared_ptr<SecurityRecord> CreateTemporaryRecord(hci::AddressWithType address) {
+    auto record = database_.FindOrCreate(address);
+    record->SetIsTemporary(true);
+    return record;
+  }
+
+  SecurityRecordDatabase database_{SecurityRecordStorage(nullptr, nullptr)};
+};
+
+TEST_F(SecurityRecordDatabaseTest, find_or_create_returns_same_record) {
+  auto record = CreateTemporaryRecord(kPseudoAddress);
+  ASSERT_EQ(record, database_.FindOrCreate(kPseudoAddress));
+  ASSERT_EQ(1u, database_.records_.size());
+  ASSERT_EQ(record, *database_.Find(kPseudoAddress));
+  ASSERT_EQ(database_.records_.end(), database_.Find(kIdentityAddress));
+}
+
+TEST_F(SecurityRecordDatabaseTest, find_by_identity_address_and_rpa_after_save) {
+  auto record = CreateTemporaryRecord(kPseudoAddress);
+  record->identity_address_ = kIdentityAddress;
+  record->remote_irk = kIrk;
+  database_.SaveRecordsToStorage();
+
+  ASSERT_EQ(record, *database_.Find(kIdentityAddress));
+  ASSERT_EQ(record, *database_.Find(kRpa));
+  ASSERT_EQ(record, database_.FindOrCreate(kRpa));
+  ASSERT_EQ(1u, database_.records_.size());
+}
+
+TEST_F(SecurityRecordDatabaseTest, stale_identity_address_not_found) {
+  auto record = CreateTemporaryRecord(kPseudoAddress);
+  record->identity_address_ = kIdentityAddress;
+  database_.SaveRecordsToStorage();
+  record->identity_address_.reset();
+
+  ASSERT_EQ(database_.records_.end(), database_.Find(kIdentityAddress));
+  ASSERT_EQ(record, *database_.Find(kPseudoAddress));
+}
+
+}  // namespace
+}  // namespace record
+}  // namespace security
+}  // namespace bluetooth
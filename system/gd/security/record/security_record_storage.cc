@@ -91,6 +91,44 @@ void SetLeData(storage::Mutation& mutation, std::shared_ptr<record::SecurityReco
   }
 }
 
+template <typename T>
+void AppendState(std::string& state, const T& value) {
+  state.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void AppendState(std::string& state, const std::optional<T>& value) {
+  AppendState(state, value.has_value());
+  if (value) {
+    AppendState(state, *value);
+  }
+}
+
+// All the fields of |record| written to the storage
+std::string GetPersistedState(std::shared_ptr<record::SecurityRecord> record) {
+  std::string state;
+  AppendState(state, record->IsClassicLinkKeyValid());
+  if (record->IsClassicLinkKeyValid()) {
+    AppendState(state, record->GetLinkKey());
+    AppendState(state, record->GetKeyType());
+  }
+  AppendState(state, record->pseudo_address_);
+  AppendState(state, record->identity_address_);
+  AppendState(state, record->remote_irk);
+  AppendState(state, record->remote_ltk);
+  AppendState(state, record->remote_rand);
+  AppendState(state, record->remote_ediv);
+  AppendState(state, record->remote_signature_key);
+  if (record->remote_ltk || record->remote_signature_key) {
+    AppendState(state, record->security_level);
+    AppendState(state, record->key_size);
+  }
+  AppendState(state, record->IsAuthenticated());
+  AppendState(state, record->IsEncryptionRequired());
+  AppendState(state, record->RequiresMitmProtection());
+  return state;
+}
+
 void SetAuthenticationData(
     storage::Mutation& /* mutation */,
     std::shared_ptr<record::SecurityRecord> record,
@@ -107,6 +145,8 @@ SecurityRecordStorage::SecurityRecordStorage(storage::StorageModule* storage_mod
 void SecurityRecordStorage::SaveSecurityRecords(std::set<std::shared_ptr<record::SecurityRecord>>* records) {
   for (auto record : *records) {
     if (record->IsTemporary()) continue;
+    std::string state = GetPersistedState(record);
+    if (record->saved_state_ == state) continue;
     storage::Device device = storage_module_->GetDeviceByClassicMacAddress(record->GetPseudoAddress()->GetAddress());
     auto mutation = storage_module_->Modify();
 
@@ -127,6 +167,7 @@ void SecurityRecordStorage::SaveSecurityRecords(std::set<std::shared_ptr<record:
     SetLeData(mutation, record, device);
     SetAuthenticationData(mutation, record, device);
     mutation.Commit();
+    record->saved_state_ = std::move(state);
   }
 }
 
@@ -182,6 +223,7 @@ void SecurityRecordStorage::LoadSecurityRecords(std::set<std::shared_ptr<record:
     record->SetIsEncryptionRequired(device.GetIsEncryptionRequired() == 1 ? true : false);
     record->SetAuthenticated(device.GetIsAuthenticated() == 1 ? true : false);
     record->SetRequiresMitmProtection(device.GetRequiresMitmProtection() == 1 ? true : false);
+    record->saved_state_ = GetPersistedState(record);
     records->insert(record);
   }
 }
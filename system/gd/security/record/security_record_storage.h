@@ -42,7 +42,8 @@ class SecurityRecordStorage {
   SecurityRecordStorage(storage::StorageModule* storage_module, os::Handler* handler);
 
   /**
-   * Iterates through given vector and stores each record's metadata to disk.
+   * Iterates through given vector and stores the metadata of each record that changed since it was last saved or
+   * loaded to disk.
    *
    * <p>Job gets posted to the Handler.
    *
@@ -17,8 +17,10 @@
 
 #include "dumpsys/dumpsys.h"
 
+#include <chrono>
 #include <future>
 #include <string>
+#include <vector>
 
 #include "dumpsys/filter.h"
 #include "dumpsys_data_generated.h"
@@ -37,11 +39,14 @@ static const std::string kReadOnlyDebuggableProperty = "ro.debuggable";
 namespace {
 constexpr char kModuleName[] = "shim::Dumpsys";
 constexpr char kDumpsysTitle[] = "----- Gd Dumpsys ------";
+// Time a module can take to produce its dumpsys data before it is reported as slow
+constexpr std::chrono::milliseconds kModuleDumpsysBudget = std::chrono::milliseconds(50);
 }  // namespace
 
 struct Dumpsys::impl {
  public:
   void DumpWithArgsSync(int fd, const char** args, std::promise<void> promise);
+  void DumpWithArgsOnModuleHandlers(int fd, const char** args);
   int GetNumberOfBundledSchemas() const;
 
   impl(const Dumpsys& dumpsys_module, const dumpsys::ReflectionSchema& reflection_schema);
@@ -56,6 +61,7 @@ struct Dumpsys::impl {
 
  private:
   void DumpWithArgsAsync(int fd, const char** args);
+  void PrintDumpsysData(int fd, std::string* dumpsys_data);
 
   const Dumpsys& dumpsys_module_;
   const dumpsys::ReflectionSchema reflection_schema_;
@@ -139,10 +145,7 @@ void Dumpsys::impl::DumpWithArgsAsync(int fd, const char** args) {
   std::string dumpsys_data;
   dumper.DumpState(&dumpsys_data);
 
-  dprintf(fd, " ----- Filtering as Developer -----\n");
-  FilterAsDeveloper(&dumpsys_data);
-
-  dprintf(fd, "%s", PrintAsJson(&dumpsys_data).c_str());
+  PrintDumpsysData(fd, &dumpsys_data);
 }
 
 void Dumpsys::impl::DumpWithArgsSync(int fd, const char** args, std::promise<void> promise) {
@@ -150,6 +153,32 @@ void Dumpsys::impl::DumpWithArgsSync(int fd, const char** args, std::promise<voi
   promise.set_value();
 }
 
+void Dumpsys::impl::DumpWithArgsOnModuleHandlers(int fd, const char** args) {
+  ParsedDumpsysArgs parsed_dumpsys_args(args);
+  const auto registry = dumpsys_module_.GetModuleRegistry();
+
+  ModuleDumper dumper(*registry, kDumpsysTitle);
+  std::string dumpsys_data;
+  std::vector<std::string> slow_modules;
+  dumper.DumpStateOnModuleHandlers(&dumpsys_data, kModuleDumpsysBudget, &slow_modules);
+  for (const auto& module : slow_modules) {
+    dprintf(
+        fd,
+        " NOTE: %s took more than %lld ms to dump\n",
+        module.c_str(),
+        static_cast<long long>(kModuleDumpsysBudget.count()));
+  }
+
+  PrintDumpsysData(fd, &dumpsys_data);
+}
+
+void Dumpsys::impl::PrintDumpsysData(int fd, std::string* dumpsys_data) {
+  dprintf(fd, " ----- Filtering as Developer -----\n");
+  FilterAsDeveloper(dumpsys_data);
+
+  dprintf(fd, "%s", PrintAsJson(dumpsys_data).c_str());
+}
+
 Dumpsys::Dumpsys(const std::string& pre_bundled_schema)
     : reflection_schema_(dumpsys::ReflectionSchema(pre_bundled_schema)) {}
 
@@ -157,10 +186,8 @@ void Dumpsys::Dump(int fd, const char** args) {
   if (fd <= 0) {
     return;
   }
-  std::promise<void> promise;
-  auto future = promise.get_future();
-  CallOn(pimpl_.get(), &Dumpsys::impl::DumpWithArgsSync, fd, args, std::move(promise));
-  future.get();
+  // Only the collection of each module's data runs on the module handlers, the rest runs on the calling thread
+  pimpl_->DumpWithArgsOnModuleHandlers(fd, args);
 }
 
 void Dumpsys::Dump(int fd, const char** args, std::promise<void> promise) {
@@ -29,7 +29,9 @@ constexpr char kArgumentDeveloper[] = "--dev";
 
 class Dumpsys : public bluetooth::Module {
  public:
+  // Must not be called on the thread of a module
   void Dump(int fd, const char** args);
+  // Dump on the dumpsys module handler, then fulfill |promise|
   void Dump(int fd, const char** args, std::promise<void> promise);
 
   // Convenience thread used by shim layer for task execution
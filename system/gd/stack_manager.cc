@@ -36,6 +36,7 @@ using ::bluetooth::os::WakelockManager;
 namespace bluetooth {
 
 void StackManager::StartUp(ModuleList* modules, Thread* stack_thread) {
+  auto start = std::chrono::steady_clock::now();
   management_thread_ = new Thread("management_thread", Thread::Priority::NORMAL);
   handler_ = new Handler(management_thread_);
 
@@ -58,20 +59,32 @@ void StackManager::StartUp(ModuleList* modules, Thread* stack_thread) {
       "Can't start stack, last instance: %s",
       registry_.last_instance_.c_str());
 
-  LOG_INFO("init complete");
+  LOG_INFO(
+      "init complete in %lld ms",
+      static_cast<long long>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
 }
 
 void StackManager::handle_start_up(ModuleList* modules, Thread* stack_thread, std::promise<void> promise) {
+  // Modules with independent dependencies may start concurrently, e.g. storage I/O alongside the HCI reset
+  registry_.SetMaxParallelStarts(os::GetSystemPropertyUint32("bluetooth.gd.parallel_module_starts",
+                                                             /* default_value = */ 1));
   registry_.Start(modules, stack_thread);
   promise.set_value();
 }
 
 void StackManager::ShutDown() {
+  ShutDown(nullptr);
+}
+
+void StackManager::ShutDown(ModuleList* warm_modules) {
+  auto start = std::chrono::steady_clock::now();
   WakelockManager::Get().Acquire();
 
   std::promise<void> promise;
   auto future = promise.get_future();
-  handler_->Post(common::BindOnce(&StackManager::handle_shut_down, common::Unretained(this), std::move(promise)));
+  handler_->Post(common::BindOnce(
+      &StackManager::handle_shut_down, common::Unretained(this), warm_modules, std::move(promise)));
 
   auto stop_status = future.wait_for(std::chrono::milliseconds(
       get_gd_stack_timeout_ms(/* is_start = */ false)));
@@ -88,10 +101,19 @@ void StackManager::ShutDown() {
   handler_->WaitUntilStopped(std::chrono::milliseconds(2000));
   delete handler_;
   delete management_thread_;
+
+  LOG_INFO(
+      "shut down complete in %lld ms",
+      static_cast<long long>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
 }
 
-void StackManager::handle_shut_down(std::promise<void> promise) {
-  registry_.StopAll();
+void StackManager::handle_shut_down(ModuleList* warm_modules, std::promise<void> promise) {
+  if (warm_modules != nullptr) {
+    registry_.StopAllExcept(warm_modules);
+  } else {
+    registry_.StopAll();
+  }
   promise.set_value();
 }
 
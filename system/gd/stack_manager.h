@@ -26,6 +26,8 @@ class StackManager {
  public:
   void StartUp(ModuleList *modules, os::Thread* stack_thread);
   void ShutDown();
+  // Shut down all modules but |warm_modules| and their dependencies, which the next StartUp() reuses as they are
+  void ShutDown(ModuleList* warm_modules);
 
   template <class T>
   T* GetInstance() const {
@@ -37,13 +39,19 @@ class StackManager {
     return registry_.IsStarted(&T::Factory);
   }
 
+  // Run module T on |thread| instead of the stack thread. Must be called before StartUp().
+  template <class T>
+  void AssignThread(os::Thread* thread) {
+    registry_.AssignThread(&T::Factory, thread);
+  }
+
  private:
   os::Thread* management_thread_ = nullptr;
   os::Handler* handler_ = nullptr;
   ModuleRegistry registry_;
 
   void handle_start_up(ModuleList* modules, os::Thread* stack_thread, std::promise<void> promise);
-  void handle_shut_down(std::promise<void> promise);
+  void handle_shut_down(ModuleList* warm_modules, std::promise<void> promise);
   static std::chrono::milliseconds get_gd_stack_timeout_ms(bool is_start);
 };
 
@@ -65,7 +65,7 @@ ConfigCache::ConfigCache(size_t temp_device_capacity, std::unordered_set<std::st
       temporary_devices_(temp_device_capacity) {}
 
 void ConfigCache::SetPersistentConfigChangedCallback(std::function<void()> persistent_config_changed_callback) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   persistent_config_changed_callback_ = std::move(persistent_config_changed_callback);
 }
 
@@ -84,8 +84,8 @@ ConfigCache& ConfigCache::operator=(ConfigCache&& other) noexcept {
   if (&other == this) {
     return *this;
   }
-  std::lock_guard<std::recursive_mutex> my_lock(mutex_);
-  std::lock_guard<std::recursive_mutex> others_lock(other.mutex_);
+  std::unique_lock<std::shared_mutex> my_lock(mutex_);
+  std::unique_lock<std::shared_mutex> others_lock(other.mutex_);
   ASSERT_LOG(
       other.persistent_config_changed_callback_ == nullptr,
       "Can't assign after setting the callback");
@@ -98,8 +98,10 @@ ConfigCache& ConfigCache::operator=(ConfigCache&& other) noexcept {
 }
 
 bool ConfigCache::operator==(const ConfigCache& rhs) const {
-  std::lock_guard<std::recursive_mutex> my_lock(mutex_);
-  std::lock_guard<std::recursive_mutex> others_lock(rhs.mutex_);
+  std::shared_lock<std::shared_mutex> my_lock(mutex_);
+  std::shared_lock<std::shared_mutex> others_lock(rhs.mutex_);
+  std::lock_guard<std::mutex> my_temporary_devices_lock(temporary_devices_mutex_);
+  std::lock_guard<std::mutex> others_temporary_devices_lock(rhs.temporary_devices_mutex_);
   return persistent_property_names_ == rhs.persistent_property_names_ &&
          information_sections_ == rhs.information_sections_ && persistent_devices_ == rhs.persistent_devices_ &&
          temporary_devices_ == rhs.temporary_devices_;
@@ -110,7 +112,7 @@ bool ConfigCache::operator!=(const ConfigCache& rhs) const {
 }
 
 void ConfigCache::Clear() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   if (information_sections_.size() > 0) {
     information_sections_.clear();
     PersistentConfigChangedCallback();
@@ -125,13 +127,15 @@ void ConfigCache::Clear() {
 }
 
 bool ConfigCache::HasSection(const std::string& section) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> temporary_devices_lock(temporary_devices_mutex_);
   return information_sections_.contains(section) || persistent_devices_.contains(section) ||
          temporary_devices_.contains(section);
 }
 
 bool ConfigCache::HasProperty(const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> temporary_devices_lock(temporary_devices_mutex_);
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
     return section_iter->second.find(property) != section_iter->second.end();
@@ -148,7 +152,8 @@ bool ConfigCache::HasProperty(const std::string& section, const std::string& pro
 }
 
 std::optional<std::string> ConfigCache::GetProperty(const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> temporary_devices_lock(temporary_devices_mutex_);
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
     auto property_iter = section_iter->second.find(property);
@@ -178,7 +183,11 @@ std::optional<std::string> ConfigCache::GetProperty(const std::string& section,
 }
 
 void ConfigCache::SetProperty(std::string section, std::string property, std::string value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  SetPropertyLocked(std::move(section), std::move(property), std::move(value));
+}
+
+void ConfigCache::SetPropertyLocked(std::string section, std::string property, std::string value) {
   TrimAfterNewLine(section);
   TrimAfterNewLine(property);
   TrimAfterNewLine(value);
@@ -224,8 +233,42 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
   section_iter->second.insert_or_assign(property, std::move(value));
 }
 
+void ConfigCache::SetSection(std::string section, common::ListMap<std::string, std::string> properties) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  bool needs_encryption =
+      os::ParameterProvider::GetBtKeystoreInterface() != nullptr && os::ParameterProvider::IsCommonCriteriaMode();
+  if (section.empty() || properties.contains("") || needs_encryption || information_sections_.contains(section) ||
+      persistent_devices_.contains(section) || temporary_devices_.contains(section)) {
+    // Merge, or let SetProperty() check and encrypt each property
+    for (auto& property : properties) {
+      SetPropertyLocked(section, property.first, std::move(property.second));
+    }
+    return;
+  }
+  if (properties.size() == 0) {
+    return;
+  }
+  if (!IsDeviceSection(section)) {
+    information_sections_.try_emplace_back(section, std::move(properties));
+    PersistentConfigChangedCallback();
+    return;
+  }
+  for (const auto& property : properties) {
+    if (IsPersistentProperty(property.first)) {
+      persistent_devices_.try_emplace_back(section, std::move(properties));
+      PersistentConfigChangedCallback();
+      return;
+    }
+  }
+  temporary_devices_.try_emplace(section, std::move(properties));
+}
+
 bool ConfigCache::RemoveSection(const std::string& section) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  return RemoveSectionLocked(section);
+}
+
+bool ConfigCache::RemoveSectionLocked(const std::string& section) {
   // sections are unique among all three maps, hence removing from one of them is enough
   if (information_sections_.extract(section) || persistent_devices_.extract(section)) {
     PersistentConfigChangedCallback();
@@ -236,7 +279,11 @@ bool ConfigCache::RemoveSection(const std::string& section) {
 }
 
 bool ConfigCache::RemoveProperty(const std::string& section, const std::string& property) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  return RemovePropertyLocked(section, property);
+}
+
+bool ConfigCache::RemovePropertyLocked(const std::string& section, const std::string& property) {
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
     auto value = section_iter->second.extract(property);
@@ -285,28 +332,33 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
 }
 
 void ConfigCache::ConvertEncryptOrDecryptKeyIfNeeded() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   LOG_INFO("%s", __func__);
-  auto persistent_sections = GetPersistentSections();
+  auto* keystore = os::ParameterProvider::GetBtKeystoreInterface();
+  if (keystore == nullptr) {
+    return;
+  }
+  std::vector<std::string> persistent_sections;
+  persistent_sections.reserve(persistent_devices_.size());
+  for (const auto& elem : persistent_devices_) {
+    persistent_sections.emplace_back(elem.first);
+  }
+  bool is_common_criteria_mode = os::ParameterProvider::IsCommonCriteriaMode();
   for (const auto& section : persistent_sections) {
     auto section_iter = persistent_devices_.find(section);
     for (const auto& property : kEncryptKeyNameList) {
       auto property_iter = section_iter->second.find(std::string(property));
       if (property_iter != section_iter->second.end()) {
         bool is_encrypted = property_iter->second == kEncryptedStr;
-        if ((!property_iter->second.empty()) && os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
-            os::ParameterProvider::IsCommonCriteriaMode() && !is_encrypted) {
-          if (os::ParameterProvider::GetBtKeystoreInterface()->set_encrypt_key_or_remove_key(
-                  section + "-" + std::string(property), property_iter->second)) {
-            SetProperty(section, std::string(property), kEncryptedStr);
+        if ((!property_iter->second.empty()) && is_common_criteria_mode && !is_encrypted) {
+          if (keystore->set_encrypt_key_or_remove_key(section + "-" + std::string(property), property_iter->second)) {
+            SetPropertyLocked(section, std::string(property), kEncryptedStr);
           }
         }
-        if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && is_encrypted) {
-          std::string value_str =
-              os::ParameterProvider::GetBtKeystoreInterface()->get_key(section + "-" + std::string(property));
-          if (!os::ParameterProvider::IsCommonCriteriaMode()) {
-            SetProperty(section, std::string(property), value_str);
-          }
+        // Keys that stay encrypted are decrypted by GetProperty() on first use, only fetch the ones to write back
+        if (is_encrypted && !is_common_criteria_mode) {
+          std::string value_str = keystore->get_key(section + "-" + std::string(property));
+          SetPropertyLocked(section, std::string(property), value_str);
         }
       }
     }
@@ -322,7 +374,7 @@ bool ConfigCache::IsPersistentProperty(const std::string& property) const {
 }
 
 void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   size_t num_persistent_removed = 0;
   for (auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (auto it = config_section->begin(); it != config_section->end();) {
@@ -349,7 +401,7 @@ void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
 }
 
 std::vector<std::string> ConfigCache::GetPersistentSections() const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   std::vector<std::string> paired_devices;
   paired_devices.reserve(persistent_devices_.size());
   for (const auto& elem : persistent_devices_) {
@@ -359,27 +411,33 @@ std::vector<std::string> ConfigCache::GetPersistentSections() const {
 }
 
 void ConfigCache::Commit(std::queue<MutationEntry>& mutation_entries) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  committing_ = true;
+  persistent_config_changed_while_committing_ = false;
   while (!mutation_entries.empty()) {
     auto entry = std::move(mutation_entries.front());
     mutation_entries.pop();
     switch (entry.entry_type) {
       case MutationEntry::EntryType::SET:
-        SetProperty(std::move(entry.section), std::move(entry.property), std::move(entry.value));
+        SetPropertyLocked(std::move(entry.section), std::move(entry.property), std::move(entry.value));
         break;
       case MutationEntry::EntryType::REMOVE_PROPERTY:
-        RemoveProperty(entry.section, entry.property);
+        RemovePropertyLocked(entry.section, entry.property);
         break;
       case MutationEntry::EntryType::REMOVE_SECTION:
-        RemoveSection(entry.section);
+        RemoveSectionLocked(entry.section);
         break;
         // do not write a default case so that when a new enum is defined, compilation would fail automatically
     }
   }
+  committing_ = false;
+  if (persistent_config_changed_while_committing_) {
+    PersistentConfigChangedCallback();
+  }
 }
 
 std::string ConfigCache::SerializeToLegacyFormat() const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   std::stringstream serialized;
   for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (const auto& section : *config_section) {
@@ -393,9 +451,26 @@ std::string ConfigCache::SerializeToLegacyFormat() const {
   return serialized.str();
 }
 
+std::unordered_map<std::string, std::string> ConfigCache::SerializeSectionsToLegacyFormat() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::unordered_map<std::string, std::string> sections;
+  for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
+    for (const auto& section : *config_section) {
+      std::stringstream serialized;
+      serialized << "[" << section.first << "]" << std::endl;
+      for (const auto& property : section.second) {
+        serialized << property.first << " = " << property.second << std::endl;
+      }
+      sections.emplace(section.first, serialized.str());
+    }
+  }
+  return sections;
+}
+
 std::vector<ConfigCache::SectionAndPropertyValue> ConfigCache::GetSectionNamesWithProperty(
     const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> temporary_devices_lock(temporary_devices_mutex_);
   std::vector<SectionAndPropertyValue> result;
   for (auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (const auto& elem : *config_section) {
@@ -468,7 +543,7 @@ bool FixDeviceTypeInconsistencyInSection(
 }  // namespace
 
 bool ConfigCache::FixDeviceTypeInconsistencies() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   bool persistent_device_changed = false;
   for (auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (auto& elem : *config_section) {
@@ -491,7 +566,8 @@ bool ConfigCache::FixDeviceTypeInconsistencies() {
 
 bool ConfigCache::HasAtLeastOneMatchingPropertiesInSection(
     const std::string& section, const std::unordered_set<std::string_view>& property_names) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> temporary_devices_lock(temporary_devices_mutex_);
   const common::ListMap<std::string, std::string>* section_ptr;
   if (!IsDeviceSection(section)) {
     auto section_iter = information_sections_.find(section);
@@ -518,7 +594,7 @@ bool ConfigCache::HasAtLeastOneMatchingPropertiesInSection(
 }
 
 bool ConfigCache::IsPersistentSection(const std::string& section) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return persistent_devices_.contains(section);
 }
 
@@ -20,8 +20,10 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -48,7 +50,8 @@ class Mutation;
 // The definition of persistent sections is up to the user and is defined through the |persistent_property_names|
 // argument. When these properties are link key properties, then persistent sections is equal to bonded devices
 //
-// This class is thread safe
+// This class is thread safe. Observers hold a shared lock, hence do not block each other, modifiers hold an exclusive
+// lock
 class ConfigCache {
  public:
   ConfigCache(size_t temp_device_capacity, std::unordered_set<std::string_view> persistent_property_names);
@@ -84,6 +87,8 @@ class ConfigCache {
   virtual bool IsPersistentProperty(const std::string& property) const;
   // Serialize to legacy config format
   virtual std::string SerializeToLegacyFormat() const;
+  // Serialize each persistent section to legacy config format, keyed by section name
+  virtual std::unordered_map<std::string, std::string> SerializeSectionsToLegacyFormat() const;
   // Return a copy of pair<section_name, property_value> with property
   struct SectionAndPropertyValue {
     std::string section;
@@ -98,9 +103,11 @@ class ConfigCache {
   virtual std::vector<SectionAndPropertyValue> GetSectionNamesWithProperty(const std::string& property) const;
 
   // modifiers
-  // Commit all mutation entries in sequence while holding the config mutex
+  // Commit all mutation entries in sequence while holding the config mutex, persistent changes are notified once
   virtual void Commit(std::queue<MutationEntry>& mutation);
   virtual void SetProperty(std::string section, std::string property, std::string value);
+  // Same as calling SetProperty() for each of |properties| in order, but looks up and classifies the section only once
+  virtual void SetSection(std::string section, common::ListMap<std::string, std::string> properties);
   virtual bool RemoveSection(const std::string& section);
   virtual bool RemoveProperty(const std::string& section, const std::string& property);
   virtual void ConvertEncryptOrDecryptKeyIfNeeded();
@@ -109,7 +116,8 @@ class ConfigCache {
   virtual void RemoveSectionWithProperty(const std::string& property);
   // remove all content in this config cache, restore it to the state after the explicit constructor
   virtual void Clear();
-  // Set a callback to notify interested party that a persistent config change has just happened
+  // Set a callback to notify interested party that a persistent config change has just happened. The callback runs
+  // with the config locked and must not call back into the config
   virtual void SetPersistentConfigChangedCallback(std::function<void()> persistent_config_changed_callback);
 
   // Device config specific methods
@@ -125,7 +133,10 @@ class ConfigCache {
   static const std::string kDefaultSectionName;
 
  private:
-  mutable std::recursive_mutex mutex_;
+  mutable std::shared_mutex mutex_;
+  // Looking up a temporary device moves it to the head of the LRU, serialize observers that touch
+  // temporary_devices_ while they hold |mutex_| shared
+  mutable std::mutex temporary_devices_mutex_;
   // A callback to notify interested party that a persistent config change has just happened, empty by default
   std::function<void()> persistent_config_changed_callback_;
   // A set of property names that if set would make a section persistent and if non of these properties are set, a
@@ -139,8 +150,22 @@ class ConfigCache {
   // if capacity exceeds given value during initialization
   common::LruCache<std::string, common::ListMap<std::string, std::string>> temporary_devices_;
 
-  // Convenience method to check if the callback is valid before calling it
-  inline void PersistentConfigChangedCallback() const {
+  // Modifiers, must be called with |mutex_| held exclusive
+  void SetPropertyLocked(std::string section, std::string property, std::string value);
+  bool RemoveSectionLocked(const std::string& section);
+  bool RemovePropertyLocked(const std::string& section, const std::string& property);
+
+  // Set while Commit() applies its entries, the changes are then notified once at the end of the commit.
+  // Guarded by |mutex_|
+  bool committing_ = false;
+  bool persistent_config_changed_while_committing_ = false;
+
+  // Convenience method to check if the callback is valid before calling it, must be called with |mutex_| held exclusive
+  inline void PersistentConfigChangedCallback() {
+    if (committing_) {
+      persistent_config_changed_while_committing_ = true;
+      return;
+    }
     if (persistent_config_changed_callback_) {
       persistent_config_changed_callback_();
     }
@@ -120,5 +120,17 @@ std::optional<std::vector<uint8_t>> ConfigCacheHelper::GetBin(
   return value;
 }
 
+std::optional<size_t> ConfigCacheHelper::GetBinLength(const std::string& section, const std::string& property) const {
+  auto value_str = config_cache_.GetProperty(section, property);
+  if (!value_str) {
+    return std::nullopt;
+  }
+  if (value_str->size() % 2 != 0 || !common::IsValidHexString(*value_str)) {
+    LOG_WARN("value_str cannot be parsed to std::vector<uint8_t>");
+    return std::nullopt;
+  }
+  return value_str->size() / 2;
+}
+
 }  // namespace storage
 }  // namespace bluetooth
\ No newline at end of file
@@ -54,6 +54,8 @@ class ConfigCacheHelper {
   virtual std::optional<int> GetInt(const std::string& section, const std::string& property) const;
   virtual void SetBin(const std::string& section, const std::string& property, const std::vector<uint8_t>& value);
   virtual std::optional<std::vector<uint8_t>> GetBin(const std::string& section, const std::string& property) const;
+  // Length of the value GetBin() would return, without parsing it
+  virtual std::optional<size_t> GetBinLength(const std::string& section, const std::string& property) const;
 
   template <typename T, typename std::enable_if<std::is_signed_v<T> && std::is_integral_v<T>, int>::type = 0>
   std::optional<T> Get(const std::string& section, const std::string& property) {
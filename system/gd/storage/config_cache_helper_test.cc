@@ -133,4 +133,18 @@ TEST(ConfigCacheHelperTest, set_get_bin_test) {
   ASSERT_THAT(ConfigCacheHelper(config).GetBin("A", "B"), Optional(ContainerEq(data2)));
 }
 
+TEST(ConfigCacheHelperTest, get_bin_length_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ASSERT_FALSE(ConfigCacheHelper(config).GetBinLength("A", "B"));
+  ConfigCacheHelper(config).SetBin("A", "B", {});
+  ASSERT_THAT(ConfigCacheHelper(config).GetBinLength("A", "B"), Optional(Eq(0u)));
+  ConfigCacheHelper(config).SetBin("A", "B", {0xAB, 0x5D, 0x42});
+  ASSERT_THAT(ConfigCacheHelper(config).GetBinLength("A", "B"), Optional(Eq(3u)));
+  // not parsable by GetBin()
+  config.SetProperty("A", "B", "ab5");
+  ASSERT_FALSE(ConfigCacheHelper(config).GetBinLength("A", "B"));
+  config.SetProperty("A", "B", "ab5g");
+  ASSERT_FALSE(ConfigCacheHelper(config).GetBinLength("A", "B"));
+}
+
 }  // namespace testing
\ No newline at end of file
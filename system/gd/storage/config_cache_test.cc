@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include <cstdio>
+#include <thread>
+#include <vector>
 
 #include "hci/enum_helper.h"
 #include "storage/device.h"
@@ -413,4 +415,63 @@ TEST(ConfigCacheTest, test_empty_persistent_properties) {
   ASSERT_THAT(config.GetPersistentSections(), ElementsAre());
 }
 
-}  // namespace testing
\ No newline at end of file
+TEST(ConfigCacheTest, set_section_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ConfigCache expected(100, Device::kLinkKeyProperties);
+  auto set_section = [&config, &expected](
+                         const std::string& section, std::vector<std::pair<std::string, std::string>> properties) {
+    bluetooth::common::ListMap<std::string, std::string> section_properties;
+    for (const auto& [property, value] : properties) {
+      section_properties.insert_or_assign(property, value);
+      expected.SetProperty(section, property, value);
+    }
+    config.SetSection(section, std::move(section_properties));
+  };
+  set_section("A", {{"B", "C"}, {"D", "E"}});
+  // persistent device with the link key after other properties
+  set_section("AA:BB:CC:DD:EE:FF", {{"name", "foo"}, {"LinkKey", "AABBAABBCCDDEE"}});
+  // temporary device
+  set_section("CC:DD:EE:FF:00:11", {{"name", "bar"}});
+  // existing section, merged
+  set_section("A", {{"B", "F"}, {"G", "H"}});
+  set_section("CC:DD:EE:FF:00:11", {{"LinkKey", "AABBAABBCCDDEE"}});
+  // empty section is not created
+  set_section("I", {});
+
+  ASSERT_EQ(config, expected);
+  ASSERT_THAT(config.GetPersistentSections(), ElementsAre("AA:BB:CC:DD:EE:FF", "CC:DD:EE:FF:00:11"));
+  ASSERT_THAT(config.GetProperty("A", "B"), Optional(StrEq("F")));
+  ASSERT_FALSE(config.HasSection("I"));
+}
+
+TEST(ConfigCacheTest, concurrent_observers_and_modifiers_test) {
+  ConfigCache config(10, Device::kLinkKeyProperties);
+  config.SetProperty("A", "B", "C");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  int num_change = 0;
+  config.SetPersistentConfigChangedCallback([&num_change] { num_change++; });
+
+  std::vector<std::thread> observers;
+  for (int t = 0; t < 4; t++) {
+    observers.emplace_back([&config, t] {
+      for (int i = 0; i < 1000; i++) {
+        ASSERT_THAT(config.GetProperty("AA:BB:CC:DD:EE:FF", "LinkKey"), Optional(StrEq("AABBAABBCCDDEE")));
+        // Temporary devices are reordered on lookup
+        config.HasProperty(GetTestAddress((i + t) % 20), "B");
+        config.GetPersistentSections();
+        config.SerializeToLegacyFormat();
+      }
+    });
+  }
+  for (int i = 0; i < 1000; i++) {
+    config.SetProperty(GetTestAddress(i % 20), "B", std::to_string(i));
+    config.SetProperty("A", "B", std::to_string(i));
+  }
+  for (auto& observer : observers) {
+    observer.join();
+  }
+  ASSERT_EQ(num_change, 1000);
+  ASSERT_THAT(config.GetProperty("A", "B"), Optional(StrEq("999")));
+}
+
+}  // namespace testing
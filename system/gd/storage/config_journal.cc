@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "storage/config_journal.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+
+#include "common/strings.h"
+#include "os/files.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace storage {
+
+namespace {
+
+// FNV-1a, only meant to detect a record cut short
+uint32_t Checksum(const std::string& data) {
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * 16777619u;
+  }
+  return hash;
+}
+
+std::string MakeRecord(const std::string& payload) {
+  char header[32];
+  std::snprintf(header, sizeof(header), "#%zu %08" PRIx32 "\n", payload.size(), Checksum(payload));
+  return header + payload;
+}
+
+// Return false if the record is malformed
+bool ApplyRecord(const std::string& payload, ConfigCache* cache) {
+  std::istringstream lines(payload);
+  std::string line;
+  if (!std::getline(lines, line) || line.size() < 2 || line.front() != '[' || line.back() != ']') {
+    return false;
+  }
+  // Read 'test' from '[text]', hence -2
+  std::string section = line.substr(1, line.size() - 2);
+  cache->RemoveSection(section);
+  while (std::getline(lines, line)) {
+    auto tokens = common::StringSplit(line, "=", 2);
+    if (tokens.size() != 2) {
+      return false;
+    }
+    tokens[0] = common::StringTrim(std::move(tokens[0]));
+    tokens[1] = common::StringTrim(std::move(tokens[1]));
+    cache->SetProperty(section, tokens[0], std::move(tokens[1]));
+  }
+  return true;
+}
+
+}  // namespace
+
+ConfigJournal::ConfigJournal(std::string path) : path_(std::move(path)) {
+  ASSERT(!path_.empty());
+}
+
+size_t ConfigJournal::Replay(ConfigCache* cache) {
+  size_ = 0;
+  if (!os::FileExists(path_)) {
+    return 0;
+  }
+  auto data = os::ReadSmallFile(path_);
+  if (!data) {
+    return 0;
+  }
+
+  size_t num_records = 0;
+  size_t pos = 0;
+  while (pos < data->size()) {
+    size_t header_end = data->find('\n', pos);
+    if (header_end == std::string::npos) {
+      break;
+    }
+    size_t length = 0;
+    uint32_t checksum = 0;
+    std::string header = data->substr(pos, header_end - pos);
+    if (std::sscanf(header.c_str(), "#%zu %" SCNx32, &length, &checksum) != 2 ||
+        length > data->size() - header_end - 1) {
+      break;
+    }
+    std::string payload = data->substr(header_end + 1, length);
+    if (Checksum(payload) != checksum || !ApplyRecord(payload, cache)) {
+      break;
+    }
+    num_records++;
+    pos = header_end + 1 + length;
+  }
+
+  if (pos != data->size()) {
+    LOG_WARN(
+        "Dropping %zu bytes of incomplete records at the end of journal %s", data->size() - pos, path_.c_str());
+    // Records appended after the incomplete one would be lost on the next replay
+    if (!os::WriteToFile(path_, data->substr(0, pos))) {
+      return num_records;
+    }
+  }
+  size_ = pos;
+  return num_records;
+}
+
+void ConfigJournal::Reset(const ConfigCache& cache) {
+  saved_sections_ = cache.SerializeSectionsToLegacyFormat();
+}
+
+bool ConfigJournal::Append(const ConfigCache& cache) {
+  auto sections = cache.SerializeSectionsToLegacyFormat();
+  std::string records;
+  for (const auto& [name, section] : sections) {
+    auto saved = saved_sections_.find(name);
+    if (saved == saved_sections_.end() || saved->second != section) {
+      records += MakeRecord(section);
+    }
+  }
+  for (const auto& saved : saved_sections_) {
+    if (sections.find(saved.first) == sections.end()) {
+      records += MakeRecord("[" + saved.first + "]\n");
+    }
+  }
+  if (records.empty()) {
+    return true;
+  }
+  if (!os::AppendToFile(path_, records)) {
+    return false;
+  }
+  saved_sections_ = std::move(sections);
+  size_ += records.size();
+  return true;
+}
+
+bool ConfigJournal::Delete() {
+  size_ = 0;
+  if (!os::FileExists(path_)) {
+    return true;
+  }
+  return os::RemoveFile(path_);
+}
+
+}  // namespace storage
+}  // namespace bluetooth
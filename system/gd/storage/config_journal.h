@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "storage/config_cache.h"
+
+namespace bluetooth {
+namespace storage {
+
+// Journal of the changes made to the persistent sections of a config cache since it was last written in full to a
+// legacy config file. Saving a change appends the sections that changed instead of rewriting the whole config.
+//
+// Each record is a header line "#<length> <checksum>" followed by a section in legacy config format. A record with
+// only the section name removes the section. A record cut short by a crash fails its checksum, and the records from it
+// are ignored on replay.
+class ConfigJournal {
+ public:
+  static ConfigJournal FromPath(std::string path) {
+    return ConfigJournal(std::move(path));
+  }
+  explicit ConfigJournal(std::string path);
+
+  // Apply the records of the journal file to |cache|, return the number of records applied
+  size_t Replay(ConfigCache* cache);
+  // Remember the persistent sections of |cache| as they are on disk, i.e. in the config file and the journal
+  void Reset(const ConfigCache& cache);
+  // Append the persistent sections changed since the last Reset() or Append(), return false on failure
+  bool Append(const ConfigCache& cache);
+  bool Delete();
+
+  // Size of the journal file, in bytes
+  size_t Size() const {
+    return size_;
+  }
+
+ private:
+  std::string path_;
+  // The persistent sections of the cache as they are on disk, in legacy config format
+  std::unordered_map<std::string, std::string> saved_sections_;
+  size_t size_ = 0;
+};
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_journal.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "os/files.h"
+#include "storage/device.h"
+
+namespace testing {
+
+using bluetooth::os::AppendToFile;
+using bluetooth::os::ReadSmallFile;
+using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigJournal;
+using bluetooth::storage::Device;
+
+class ConfigJournalTest : public Test {
+ protected:
+  void SetUp() override {
+    temp_journal_ = std::filesystem::temp_directory_path() / "temp_config.journal";
+    std::filesystem::remove(temp_journal_);
+    SetUpConfig(&config_);
+    SetUpConfig(&saved_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(temp_journal_);
+  }
+
+  static void SetUpConfig(ConfigCache* config) {
+    config->SetProperty("Adapter", "Address", "01:02:03:ab:cd:ef");
+    config->SetProperty("01:02:03:ab:cd:ea", "LinkKey", "fedcba0987654321fedcba0987654328");
+  }
+
+  std::filesystem::path temp_journal_;
+  // The config being saved
+  ConfigCache config_{100, Device::kLinkKeyProperties};
+  // The config as it was before, in the config file
+  ConfigCache saved_{100, Device::kLinkKeyProperties};
+};
+
+TEST_F(ConfigJournalTest, append_and_replay_loop_back_test) {
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  journal.Reset(config_);
+
+  config_.SetProperty("01:02:03:ab:cd:ea", "name", "hello world");
+  EXPECT_TRUE(journal.Append(config_));
+  config_.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+  config_.SetProperty("Adapter", "ScanMode", "2");
+  EXPECT_TRUE(journal.Append(config_));
+  EXPECT_EQ(journal.Size(), std::filesystem::file_size(temp_journal_));
+
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(&saved_), 3u);
+  EXPECT_EQ(saved_, config_);
+}
+
+TEST_F(ConfigJournalTest, unchanged_config_appends_nothing_test) {
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  journal.Reset(config_);
+
+  EXPECT_TRUE(journal.Append(config_));
+  EXPECT_EQ(journal.Size(), 0u);
+  EXPECT_FALSE(std::filesystem::exists(temp_journal_));
+
+  // Unpaired devices are not saved
+  config_.SetProperty("AA:BB:CC:DD:EE:FF", "name", "foo");
+  EXPECT_TRUE(journal.Append(config_));
+  EXPECT_EQ(journal.Size(), 0u);
+}
+
+TEST_F(ConfigJournalTest, replay_removes_section_test) {
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  journal.Reset(config_);
+
+  config_.RemoveSection("01:02:03:ab:cd:ea");
+  config_.RemoveProperty("Adapter", "Address");
+  EXPECT_TRUE(journal.Append(config_));
+
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(&saved_), 2u);
+  EXPECT_FALSE(saved_.HasSection("01:02:03:ab:cd:ea"));
+  EXPECT_FALSE(saved_.HasSection("Adapter"));
+  EXPECT_EQ(saved_, config_);
+}
+
+TEST_F(ConfigJournalTest, replay_drops_incomplete_record_test) {
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  journal.Reset(config_);
+
+  config_.SetProperty("01:02:03:ab:cd:ea", "name", "hello world");
+  EXPECT_TRUE(journal.Append(config_));
+  auto complete = ReadSmallFile(temp_journal_.string());
+  ASSERT_TRUE(complete);
+  // A record cut short by a crash
+  EXPECT_TRUE(AppendToFile(temp_journal_.string(), "#40 0123abcd\n[Adapter]\nAddr"));
+
+  auto replayed = ConfigJournal::FromPath(temp_journal_.string());
+  EXPECT_EQ(replayed.Replay(&saved_), 1u);
+  EXPECT_EQ(saved_, config_);
+  EXPECT_EQ(replayed.Size(), complete->size());
+  EXPECT_EQ(ReadSmallFile(temp_journal_.string()), complete);
+}
+
+TEST_F(ConfigJournalTest, replay_no_journal_test) {
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  EXPECT_EQ(journal.Replay(&saved_), 0u);
+  EXPECT_EQ(journal.Size(), 0u);
+  EXPECT_EQ(saved_, config_);
+}
+
+}  // namespace testing
@@ -16,11 +16,9 @@
 
 #include "storage/legacy_config_file.h"
 
-#include <cerrno>
-#include <fstream>
-#include <sstream>
+#include <cctype>
+#include <string_view>
 
-#include "common/strings.h"
 #include "os/files.h"
 #include "os/log.h"
 #include "storage/device.h"
@@ -28,24 +26,42 @@
 namespace bluetooth {
 namespace storage {
 
+namespace {
+
+std::string_view TrimWhitespace(std::string_view str) {
+  while (!str.empty() && isspace(static_cast<unsigned char>(str.front()))) {
+    str.remove_prefix(1);
+  }
+  while (!str.empty() && isspace(static_cast<unsigned char>(str.back()))) {
+    str.remove_suffix(1);
+  }
+  return str;
+}
+
+}  // namespace
+
 LegacyConfigFile::LegacyConfigFile(std::string path) : path_(std::move(path)) {
   ASSERT(!path_.empty());
 };
 
 std::optional<ConfigCache> LegacyConfigFile::Read(size_t temp_devices_capacity) {
   ASSERT(!path_.empty());
-  std::ifstream config_file(path_);
-  if (!config_file || !config_file.is_open()) {
-    LOG_ERROR("unable to open file '%s', error: %s", path_.c_str(), strerror(errno));
+  // Parse the whole file at once, instead of allocating strings for each line and each token
+  auto data = os::ReadSmallFile(path_);
+  if (!data) {
+    LOG_ERROR("unable to read file '%s'", path_.c_str());
     return std::nullopt;
   }
   [[maybe_unused]] int line_num = 0;
   ConfigCache cache(temp_devices_capacity, Device::kLinkKeyProperties);
-  std::string line;
   std::string section(ConfigCache::kDefaultSectionName);
-  while (std::getline(config_file, line)) {
+  common::ListMap<std::string, std::string> properties;
+  std::string_view remaining(*data);
+  while (!remaining.empty()) {
     ++line_num;
-    line = common::StringTrim(std::move(line));
+    size_t line_end = remaining.find('\n');
+    std::string_view line = TrimWhitespace(remaining.substr(0, line_end));
+    remaining.remove_prefix(line_end == std::string_view::npos ? remaining.size() : line_end + 1);
     if (line.empty()) {
       continue;
     }
@@ -58,19 +74,22 @@ std::optional<ConfigCache> LegacyConfigFile::Read(size_t temp_devices_capacity)
         LOG_WARN("unterminated section name on line %d", line_num);
         return std::nullopt;
       }
+      cache.SetSection(std::move(section), std::move(properties));
+      properties = {};
       // Read 'test' from '[text]', hence -2
-      section = line.substr(1, line.size() - 2);
+      section = std::string(line.substr(1, line.size() - 2));
     } else {
-      auto tokens = common::StringSplit(line, "=", 2);
-      if (tokens.size() != 2) {
+      size_t separator = line.find('=');
+      if (separator == std::string_view::npos) {
         LOG_WARN("no key/value separator found on line %d", line_num);
         return std::nullopt;
       }
-      tokens[0] = common::StringTrim(std::move(tokens[0]));
-      tokens[1] = common::StringTrim(std::move(tokens[1]));
-      cache.SetProperty(section, tokens[0], std::move(tokens[1]));
+      std::string_view property = TrimWhitespace(line.substr(0, separator));
+      std::string_view value = TrimWhitespace(line.substr(separator + 1));
+      properties.insert_or_assign(std::string(property), std::string(value));
     }
   }
+  cache.SetSection(std::move(section), std::move(properties));
   return cache;
 }
 
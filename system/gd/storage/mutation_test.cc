@@ -122,4 +122,28 @@ TEST(MutationTest, add_to_different_configs) {
   ASSERT_THAT(memory_only_config.GetProperty("A", "D"), Optional(StrEq("Hello")));
 }
 
+TEST(MutationTest, persistent_changes_notified_once_per_commit) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ConfigCache memory_only_config(100, {});
+  int num_change = 0;
+  config.SetPersistentConfigChangedCallback([&num_change] { num_change++; });
+  Mutation mutation(&config, &memory_only_config);
+  mutation.Add(MutationEntry::Set(MutationEntry::PropertyType::NORMAL, "A", "B", "C"));
+  mutation.Add(MutationEntry::Set(MutationEntry::PropertyType::NORMAL, "AA:BB:CC:DD:EE:FF", "LinkKey", "CCDDEEFFGG"));
+  mutation.Add(MutationEntry::Set(MutationEntry::PropertyType::NORMAL, "AA:BB:CC:DD:EE:FF", "Name", "Hello"));
+  mutation.Add(MutationEntry::Remove(MutationEntry::PropertyType::NORMAL, "A", "B"));
+  mutation.Commit();
+  ASSERT_EQ(num_change, 1);
+  ASSERT_THAT(config.GetPersistentSections(), ElementsAre("AA:BB:CC:DD:EE:FF"));
+
+  Mutation mutation2(&config, &memory_only_config);
+  mutation2.Add(MutationEntry::Set(MutationEntry::PropertyType::NORMAL, "CC:DD:EE:FF:00:11", "Name", "Hello"));
+  mutation2.Commit();
+  ASSERT_EQ(num_change, 1);
+
+  // Notified again on the next change outside of a commit
+  config.SetProperty("A", "B", "C");
+  ASSERT_EQ(num_change, 2);
+}
+
 }  // namespace testing
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include "os/parameter_provider.h"
 #include "os/system_properties.h"
 #include "storage/config_cache.h"
+#include "storage/config_journal.h"
 #include "storage/legacy_config_file.h"
 #include "storage/mutation.h"
 
@@ -60,6 +61,9 @@ const std::string StorageModule::kTimeCreatedFormat = "%Y-%m-%d %H:%M:%S";
 
 const std::string StorageModule::kAdapterSection = "Adapter";
 
+// About a dozen bonded devices, rewriting the config costs about as much as appending this much
+const size_t StorageModule::kMaxJournalSize = 16 * 1024;
+
 StorageModule::StorageModule(
     std::string config_file_path,
     std::chrono::milliseconds config_save_delay,
@@ -73,6 +77,7 @@ StorageModule::StorageModule(
       is_single_user_mode_(is_single_user_mode) {
   // e.g. "/data/misc/bluedroid/bt_config.conf" to "/data/misc/bluedroid/bt_config.bak"
   config_backup_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".bak";
+  config_journal_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".journal";
   ASSERT_LOG(
       config_save_delay > kMinConfigSaveDelay,
       "Config save delay of %lld ms is not enough, must be at least %lld ms to avoid overwhelming the disk",
@@ -81,7 +86,7 @@ StorageModule::StorageModule(
 };
 
 StorageModule::~StorageModule() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   pimpl_.reset();
 }
 
@@ -91,21 +96,35 @@ const ModuleFactory StorageModule::Factory = ModuleFactory([]() {
 });
 
 struct StorageModule::impl {
-  explicit impl(Handler* handler, ConfigCache cache, size_t in_memory_cache_size_limit)
-      : config_save_alarm_(handler), cache_(std::move(cache)), memory_only_cache_(in_memory_cache_size_limit, {}) {}
+  explicit impl(Handler* handler, ConfigCache cache, size_t in_memory_cache_size_limit, ConfigJournal journal)
+      : config_save_alarm_(handler),
+        cache_(std::move(cache)),
+        memory_only_cache_(in_memory_cache_size_limit, {}),
+        journal_(std::move(journal)) {}
   Alarm config_save_alarm_;
   ConfigCache cache_;
   ConfigCache memory_only_cache_;
+  // Guards the save alarm and the saving state below, saving only holds |mutex_| shared so the config can be read
+  // meanwhile
+  std::mutex save_mutex_;
+  ConfigJournal journal_;
   bool has_pending_config_save_ = false;
+  // The config file must be rewritten on the next save, e.g. it was read from the backup
+  bool compaction_needed_ = false;
 };
 
 Mutation StorageModule::Modify() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return Mutation(&pimpl_->cache_, &pimpl_->memory_only_cache_);
 }
 
 void StorageModule::SaveDelayed() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  SaveDelayedLocked();
+}
+
+void StorageModule::SaveDelayedLocked() {
+  std::lock_guard<std::mutex> save_lock(pimpl_->save_mutex_);
   if (pimpl_->has_pending_config_save_) {
     return;
   }
@@ -115,11 +134,27 @@ void StorageModule::SaveDelayed() {
 }
 
 void StorageModule::SaveImmediately() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  SaveImmediatelyLocked();
+}
+
+void StorageModule::SaveImmediatelyLocked() {
+  std::lock_guard<std::mutex> save_lock(pimpl_->save_mutex_);
   if (pimpl_->has_pending_config_save_) {
     pimpl_->config_save_alarm_.Cancel();
     pimpl_->has_pending_config_save_ = false;
   }
+  if (!pimpl_->compaction_needed_ && is_journal_enabled()) {
+    if (!pimpl_->journal_.Append(pimpl_->cache_)) {
+      LOG_WARN("Unable to append to config journal, writing the whole config");
+    } else if (pimpl_->journal_.Size() <= kMaxJournalSize) {
+      return;
+    }
+  }
+  WriteConfigFiles();
+}
+
+void StorageModule::WriteConfigFiles() {
   // 1. rename old config to backup name
   if (os::FileExists(config_file_path_)) {
     ASSERT(os::RenameFile(config_file_path_, config_backup_path_));
@@ -134,10 +169,14 @@ void StorageModule::SaveImmediately() {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->set_encrypt_key_or_remove_key(
         kConfigFilePrefix, kConfigFileHash);
   }
+  // 5. the journal is part of the config files now
+  pimpl_->journal_.Delete();
+  pimpl_->journal_.Reset(pimpl_->cache_);
+  pimpl_->compaction_needed_ = false;
 }
 
 void StorageModule::Clear() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   pimpl_->cache_.Clear();
 }
 
@@ -146,16 +185,18 @@ void StorageModule::ListDependencies(ModuleList* list) const {
 }
 
 void StorageModule::Start() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   std::string file_source;
   if (os::GetSystemProperty(kFactoryResetProperty) == "true") {
     LOG_INFO("%s is true, delete config files", kFactoryResetProperty.c_str());
     LegacyConfigFile::FromPath(config_file_path_).Delete();
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
+    ConfigJournal::FromPath(config_journal_path_).Delete();
     os::SetSystemProperty(kFactoryResetProperty, "false");
   }
   if (!is_config_checksum_pass(kConfigFileComparePass)) {
     LegacyConfigFile::FromPath(config_file_path_).Delete();
+    ConfigJournal::FromPath(config_journal_path_).Delete();
   }
   if (!is_config_checksum_pass(kConfigBackupComparePass)) {
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
@@ -174,6 +215,14 @@ void StorageModule::Start() {
     config.emplace(temp_devices_capacity_, Device::kLinkKeyProperties);
     file_source = "Empty";
   }
+  // Apply the changes saved since the config file was last written, on top of the config or its backup which are
+  // written together
+  auto journal = ConfigJournal::FromPath(config_journal_path_);
+  if (journal.Replay(&config.value()) > 0) {
+    LOG_INFO("Replayed config journal at %s", config_journal_path_.c_str());
+    save_needed = true;
+  }
+  journal.Reset(*config);
   if (!file_source.empty()) {
     config->SetProperty(kInfoSection, kFileSourceProperty, std::move(file_source));
   }
@@ -192,10 +241,12 @@ void StorageModule::Start() {
   }
   config->FixDeviceTypeInconsistencies();
   // TODO (b/158035889) Migrate metrics module to GD
-  pimpl_ = std::make_unique<impl>(GetHandler(), std::move(config.value()), temp_devices_capacity_);
+  pimpl_ = std::make_unique<impl>(
+      GetHandler(), std::move(config.value()), temp_devices_capacity_, std::move(journal));
   if (save_needed) {
     // Set a timer and write the new config file to disk.
-    SaveDelayed();
+    pimpl_->compaction_needed_ = true;
+    SaveDelayedLocked();
   }
   pimpl_->cache_.SetPersistentConfigChangedCallback(
       [this] { this->CallOn(this, &StorageModule::SaveDelayed); });
@@ -205,10 +256,14 @@ void StorageModule::Start() {
 }
 
 void StorageModule::Stop() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   if (pimpl_->has_pending_config_save_) {
     // Save pending changes before stopping the module.
-    SaveImmediately();
+    SaveImmediatelyLocked();
+  }
+  if (pimpl_->journal_.Size() > 0) {
+    // Leave a complete config file to whoever reads it next
+    WriteConfigFiles();
   }
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->clear_map();
@@ -221,7 +276,7 @@ std::string StorageModule::ToString() const {
 }
 
 Device StorageModule::GetDeviceByLegacyKey(hci::Address legacy_key_address) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return Device(
       &pimpl_->cache_,
       &pimpl_->memory_only_cache_,
@@ -230,7 +285,7 @@ Device StorageModule::GetDeviceByLegacyKey(hci::Address legacy_key_address) {
 }
 
 Device StorageModule::GetDeviceByClassicMacAddress(hci::Address classic_address) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return Device(
       &pimpl_->cache_,
       &pimpl_->memory_only_cache_,
@@ -239,7 +294,7 @@ Device StorageModule::GetDeviceByClassicMacAddress(hci::Address classic_address)
 }
 
 Device StorageModule::GetDeviceByLeIdentityAddress(hci::Address le_identity_address) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return Device(
       &pimpl_->cache_,
       &pimpl_->memory_only_cache_,
@@ -248,7 +303,7 @@ Device StorageModule::GetDeviceByLeIdentityAddress(hci::Address le_identity_addr
 }
 
 std::vector<Device> StorageModule::GetBondedDevices() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   auto persistent_sections = pimpl_->cache_.GetPersistentSections();
   std::vector<Device> result;
   result.reserve(persistent_sections.size());
@@ -262,119 +317,131 @@ bool StorageModule::is_config_checksum_pass(int check_bit) {
   return ((os::ParameterProvider::GetCommonCriteriaConfigCompareResult() & check_bit) == check_bit);
 }
 
+// The checksum of common criteria mode only covers the config file, every change must be written to it
+bool StorageModule::is_journal_enabled() {
+  return !(
+      bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
+      bluetooth::os::ParameterProvider::IsCommonCriteriaMode());
+}
+
 bool StorageModule::HasSection(const std::string& section) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.HasSection(section);
 }
 
 bool StorageModule::HasProperty(const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.HasProperty(section, property);
 }
 
 std::optional<std::string> StorageModule::GetProperty(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.GetProperty(section, property);
 }
 
 void StorageModule::SetProperty(std::string section, std::string property, std::string value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   pimpl_->cache_.SetProperty(section, property, value);
 }
 
 std::vector<std::string> StorageModule::GetPersistentSections() const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.GetPersistentSections();
 }
 
 void StorageModule::RemoveSection(const std::string& section) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   pimpl_->cache_.RemoveSection(section);
 }
 
 bool StorageModule::RemoveProperty(const std::string& section, const std::string& property) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.RemoveProperty(section, property);
 }
 
 void StorageModule::ConvertEncryptOrDecryptKeyIfNeeded() {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   pimpl_->cache_.ConvertEncryptOrDecryptKeyIfNeeded();
 }
 
 void StorageModule::RemoveSectionWithProperty(const std::string& property) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return pimpl_->cache_.RemoveSectionWithProperty(property);
 }
 
 void StorageModule::SetBool(const std::string& section, const std::string& property, bool value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetBool(section, property, value);
 }
 
 std::optional<bool> StorageModule::GetBool(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetBool(section, property);
 }
 
 void StorageModule::SetUint64(
     const std::string& section, const std::string& property, uint64_t value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetUint64(section, property, value);
 }
 
 std::optional<uint64_t> StorageModule::GetUint64(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetUint64(section, property);
 }
 
 void StorageModule::SetUint32(
     const std::string& section, const std::string& property, uint32_t value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetUint32(section, property, value);
 }
 
 std::optional<uint32_t> StorageModule::GetUint32(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetUint32(section, property);
 }
 void StorageModule::SetInt64(
     const std::string& section, const std::string& property, int64_t value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetInt64(section, property, value);
 }
 std::optional<int64_t> StorageModule::GetInt64(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetInt64(section, property);
 }
 
 void StorageModule::SetInt(const std::string& section, const std::string& property, int value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetInt(section, property, value);
 }
 
 std::optional<int> StorageModule::GetInt(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetInt(section, property);
 }
 
 void StorageModule::SetBin(
     const std::string& section, const std::string& property, const std::vector<uint8_t>& value) {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   ConfigCacheHelper::FromConfigCache(pimpl_->cache_).SetBin(section, property, value);
 }
 
 std::optional<std::vector<uint8_t>> StorageModule::GetBin(
     const std::string& section, const std::string& property) const {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetBin(section, property);
 }
 
+std::optional<size_t> StorageModule::GetBinLength(const std::string& section, const std::string& property) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return ConfigCacheHelper::FromConfigCache(pimpl_->cache_).GetBinLength(section, property);
+}
+
 }  // namespace storage
 }  // namespace bluetooth
@@ -21,6 +21,7 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 
 #include "hci/address.h"
@@ -43,6 +44,10 @@ namespace hci {
 class AclManager;
 }
 
+namespace neighbor {
+class NameDbModule;
+}
+
 namespace storage {
 
 class StorageModule : public bluetooth::Module {
@@ -54,6 +59,9 @@ class StorageModule : public bluetooth::Module {
 
   static const std::string kAdapterSection;
 
+  // Size from which the journal is compacted into the config file
+  static const size_t kMaxJournalSize;
+
   StorageModule(const StorageModule&) = delete;
   StorageModule& operator=(const StorageModule&) = delete;
 
@@ -121,19 +129,22 @@ class StorageModule : public bluetooth::Module {
   friend shim::BtifConfigInterface;
   friend hci::AclManager;
   friend security::internal::SecurityManagerImpl;
+  friend neighbor::NameDbModule;
   // For unit test only
   ConfigCache* GetMemoryOnlyConfigCache();
   // Normally, underlying config will be saved at most 3 seconds after the first config change in a series of changes
   // This method triggers the delayed saving automatically, the delay is equal to |config_save_delay_|
   void SaveDelayed();
   // In some cases, one may want to save the config immediately to disk. Call this method with caution as it runs
-  // immediately on the calling thread
+  // immediately on the calling thread. The changes are appended to the journal, and the config file is only rewritten
+  // once the journal grows past |kMaxJournalSize|
   void SaveImmediately();
   // remove all content in this config cache, restore it to the state after the explicit constructor
   void Clear();
 
   // Create the storage module where:
-  // - config_file_path is the path to the config file on disk, a .bak file will be created with the original
+  // - config_file_path is the path to the config file on disk, a .bak file will be created with the original, and a
+  //   .journal file with the changes since the config file was last written
   // - config_save_delay is the duration after which to dump config to disk after SaveDelayed() is called
   // - temp_devices_capacity is the number of temporary, typically unpaired devices to hold in a memory based LRU
   // - is_restricted_mode and is_single_user_mode are flags from upper layer
@@ -173,10 +184,12 @@ class StorageModule : public bluetooth::Module {
       const std::string& section, const std::string& property, const std::vector<uint8_t>& value);
   std::optional<std::vector<uint8_t>> GetBin(
       const std::string& section, const std::string& property) const;
+  std::optional<size_t> GetBinLength(const std::string& section, const std::string& property) const;
 
  private:
   struct impl;
-  mutable std::recursive_mutex mutex_;
+  // Held exclusive to start and stop the module, shared otherwise as the config cache is thread safe
+  mutable std::shared_mutex mutex_;
   std::unique_ptr<impl> pimpl_;
   std::string config_file_path_;
   std::string config_backup_path_;
@@ -184,7 +197,14 @@ class StorageModule : public bluetooth::Module {
   size_t temp_devices_capacity_;
   bool is_restricted_mode_;
   bool is_single_user_mode_;
+  std::string config_journal_path_;
   static bool is_config_checksum_pass(int check_bit);
+  static bool is_journal_enabled();
+  // Same as SaveDelayed() and SaveImmediately(), must be called with |mutex_| held
+  void SaveDelayedLocked();
+  void SaveImmediatelyLocked();
+  // Write the whole config to the config file and its backup, and empty the journal
+  void WriteConfigFiles();
 };
 
 }  // namespace storage
@@ -31,6 +31,7 @@
 #include "os/fake_timer/fake_timerfd.h"
 #include "os/files.h"
 #include "storage/config_cache.h"
+#include "storage/config_journal.h"
 #include "storage/device.h"
 #include "storage/legacy_config_file.h"
 
@@ -40,6 +41,7 @@ using bluetooth::TestModuleRegistry;
 using bluetooth::hci::Address;
 using bluetooth::os::fake_timer::fake_timerfd_advance;
 using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigJournal;
 using bluetooth::storage::Device;
 using bluetooth::storage::LegacyConfigFile;
 using bluetooth::storage::StorageModule;
@@ -107,9 +109,11 @@ class StorageModuleTest : public Test {
     temp_dir_ = std::filesystem::temp_directory_path();
     temp_config_ = temp_dir_ / "temp_config.txt";
     temp_backup_config_ = temp_dir_ / "temp_config.bak";
+    temp_journal_ = temp_dir_ / "temp_config.journal";
     DeleteConfigFiles();
     ASSERT_FALSE(std::filesystem::exists(temp_config_));
     ASSERT_FALSE(std::filesystem::exists(temp_backup_config_));
+    ASSERT_FALSE(std::filesystem::exists(temp_journal_));
   }
 
   void TearDown() override {
@@ -124,6 +128,18 @@ class StorageModuleTest : public Test {
     if (std::filesystem::exists(temp_backup_config_)) {
       ASSERT_TRUE(std::filesystem::remove(temp_backup_config_));
     }
+    if (std::filesystem::exists(temp_journal_)) {
+      ASSERT_TRUE(std::filesystem::remove(temp_journal_));
+    }
+  }
+
+  // Read the config as saved on disk, i.e. the config file with the journal applied
+  std::optional<ConfigCache> ReadSavedConfig() {
+    auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+    if (config) {
+      ConfigJournal::FromPath(temp_journal_.string()).Replay(&config.value());
+    }
+    return config;
   }
 
   void FakeTimerAdvance(std::chrono::milliseconds time) {
@@ -146,6 +162,7 @@ class StorageModuleTest : public Test {
   std::filesystem::path temp_dir_;
   std::filesystem::path temp_config_;
   std::filesystem::path temp_backup_config_;
+  std::filesystem::path temp_journal_;
 };
 
 TEST_F(StorageModuleTest, empty_config_no_op_test) {
@@ -234,7 +251,7 @@ TEST_F(StorageModuleTest, save_config_test) {
   ASSERT_THAT(storage->GetPropertyPublic("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
 
-  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  auto config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
 
@@ -242,7 +259,7 @@ TEST_F(StorageModuleTest, save_config_test) {
   storage->RemovePropertyPublic("01:02:03:ab:cd:ea", "name");
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
   LOG_INFO("After waiting 2");
-  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_FALSE(config->HasProperty("01:02:03:ab:cd:ea", "name"));
 
@@ -250,7 +267,7 @@ TEST_F(StorageModuleTest, save_config_test) {
   storage->RemoveSectionPublic("01:02:03:ab:cd:ea");
   ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
   LOG_INFO("After waiting 3");
-  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  config = ReadSavedConfig();
   ASSERT_TRUE(config);
   ASSERT_FALSE(config->HasSection("01:02:03:ab:cd:ea"));
 
@@ -259,6 +276,62 @@ TEST_F(StorageModuleTest, save_config_test) {
 
   // Verify states after test
   ASSERT_TRUE(std::filesystem::exists(temp_config_));
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+}
+
+TEST_F(StorageModuleTest, save_appends_to_journal_test) {
+  // Prepare config file
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+
+  // Set up
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, false, false);
+  test_registry_.InjectTestModule(&StorageModule::Factory, storage);
+
+  // Test
+  storage->SetPropertyPublic("01:02:03:ab:cd:ea", "name", "foo");
+  ASSERT_TRUE(WaitForReactorIdle(kTestConfigSaveDelay));
+
+  // Only the journal was written
+  auto config_file = bluetooth::os::ReadSmallFile(temp_config_.string());
+  ASSERT_TRUE(config_file);
+  ASSERT_EQ(*config_file, kReadTestConfig);
+  ASSERT_TRUE(std::filesystem::exists(temp_journal_));
+
+  // Tear down
+  test_registry_.StopAll();
+
+  // Verify the journal was compacted into the config file
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  ASSERT_TRUE(config);
+  ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
+}
+
+TEST_F(StorageModuleTest, journal_replayed_on_start_test) {
+  // Prepare config file, and the journal of a save before a crash
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+  auto saved = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  ASSERT_TRUE(saved);
+  auto journal = ConfigJournal::FromPath(temp_journal_.string());
+  journal.Reset(*saved);
+  saved->SetProperty("01:02:03:ab:cd:ea", "name", "foo");
+  ASSERT_TRUE(journal.Append(*saved));
+
+  // Set up
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, false, false);
+  test_registry_.InjectTestModule(&StorageModule::Factory, storage);
+
+  // Test
+  ASSERT_THAT(storage->GetPropertyPublic("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
+
+  // Tear down
+  test_registry_.StopAll();
+
+  // Verify states after test
+  ASSERT_FALSE(std::filesystem::exists(temp_journal_));
+  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(kTestTempDevicesCapacity);
+  ASSERT_TRUE(config);
+  ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
 }
 
 TEST_F(StorageModuleTest, get_bonded_devices_test) {
@@ -34,6 +34,17 @@ typedef struct {
   packet_reassembled_cb reassembled;
 } packet_fragmenter_callbacks_t;
 
+typedef struct {
+  // SDUs reassembled from several ISO data packets
+  uint64_t fragmented_sdus;
+  // SDUs dropped because they were malformed, or were not complete when the
+  // next SDU started
+  uint64_t dropped_sdus;
+  // Continuation or last fragments received with no SDU being reassembled,
+  // typically the rest of a dropped SDU
+  uint64_t late_fragments;
+} iso_reassembly_stats_t;
+
 typedef struct packet_fragmenter_t {
   // Initialize the fragmenter, specifying the |result_callbacks|.
   void (*init)(const packet_fragmenter_callbacks_t* result_callbacks);
@@ -48,6 +59,9 @@ typedef struct packet_fragmenter_t {
   // Otherwise holds onto it until all fragments arrive, at which point the
   // reassembled callback is called with the reassembled data.
   void (*reassemble_and_dispatch)(BT_HDR* packet);
+
+  // Returns the ISO reassembly counters since the fragmenter was initialized.
+  iso_reassembly_stats_t (*get_iso_reassembly_stats)(void);
 } packet_fragmenter_t;
 
 const packet_fragmenter_t* packet_fragmenter_get_interface();
@@ -23,6 +23,7 @@
 #include <base/logging.h>
 #include <string.h>
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "device/include/controller.h"
@@ -81,13 +82,67 @@ static const allocator_t* buffer_allocator;
 static const controller_t* controller;
 static const packet_fragmenter_callbacks_t* callbacks;
 
-static std::unordered_map<uint16_t /* handle */, BT_HDR*> partial_iso_packets;
+// Reassembly state of an ISO connection. Slots are kept across SDUs, so
+// reassembling an SDU does not cost a map insertion and removal, and the
+// buffer of a dropped SDU is reused for the next one.
+typedef struct {
+  // SDU being reassembled, or nullptr
+  BT_HDR* partial_packet;
+  // Buffer of a dropped SDU, reused by the next SDU of this connection
+  BT_HDR* spare_packet;
+  // Size of the largest SDU seen on this connection, buffers are allocated
+  // with this size so that the spare buffer fits the following SDUs
+  uint16_t capacity;
+} iso_reassembly_slot_t;
+
+static std::unordered_map<uint16_t /* handle */, iso_reassembly_slot_t>
+    iso_reassembly_slots;
+static iso_reassembly_stats_t iso_reassembly_stats;
+
+static BT_HDR* acquire_iso_buffer(iso_reassembly_slot_t* slot, uint16_t len) {
+  if (slot->spare_packet != nullptr && slot->capacity >= len) {
+    BT_HDR* packet = slot->spare_packet;
+    slot->spare_packet = nullptr;
+    return packet;
+  }
+  if (slot->spare_packet != nullptr) {
+    buffer_allocator->free(slot->spare_packet);
+    slot->spare_packet = nullptr;
+  }
+  slot->capacity = std::max(slot->capacity, len);
+  return (BT_HDR*)buffer_allocator->alloc(slot->capacity + sizeof(BT_HDR));
+}
+
+static void drop_partial_iso_packet(iso_reassembly_slot_t* slot) {
+  iso_reassembly_stats.dropped_sdus++;
+  if (slot->spare_packet == nullptr) {
+    slot->spare_packet = slot->partial_packet;
+  } else {
+    buffer_allocator->free(slot->partial_packet);
+  }
+  slot->partial_packet = nullptr;
+}
 
 static void init(const packet_fragmenter_callbacks_t* result_callbacks) {
   callbacks = result_callbacks;
+  iso_reassembly_stats = {};
+}
+
+static void cleanup() {
+  for (auto& [handle, slot] : iso_reassembly_slots) {
+    if (slot.partial_packet != nullptr) {
+      buffer_allocator->free(slot.partial_packet);
+    }
+    if (slot.spare_packet != nullptr) {
+      buffer_allocator->free(slot.spare_packet);
+    }
+  }
+  iso_reassembly_slots.clear();
 }
 
-static void cleanup() { partial_iso_packets.clear(); }
+static iso_reassembly_stats_t get_iso_reassembly_stats() {
+  return iso_reassembly_stats;
+}
 
 static void fragment_and_dispatch(BT_HDR* packet) {
   CHECK(packet != NULL);
@@ -163,7 +218,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
   uint8_t ts_flag = HCI_ISO_GET_TS_FLAG(handle);
   handle = handle & HANDLE_MASK;
 
-  auto map_iter = partial_iso_packets.find(handle);
+  iso_reassembly_slot_t* slot = &iso_reassembly_slots[handle];
 
   switch (boundary_flag) {
     case HCI_ISO_BF_COMPLETE_PACKET:
@@ -171,14 +226,12 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
       uint16_t iso_sdu_length;
       uint8_t packet_status_flags;
 
-      if (map_iter != partial_iso_packets.end()) {
+      if (slot->partial_packet != nullptr) {
         LOG_WARN(
             "%s found unfinished packet for the iso handle with start packet. "
             "Dropping old.",
             __func__);
-        BT_HDR* hdl = map_iter->second;
-        partial_iso_packets.erase(map_iter);
-        buffer_allocator->free(hdl);
+        drop_partial_iso_packet(slot);
       }
 
       if (ts_flag) {
@@ -191,6 +244,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
       if (iso_length < iso_hdr_len) {
         LOG_WARN("%s ISO packet too small (%d < %d). Dropping it.", __func__,
                  packet->len, iso_hdr_len);
+        iso_reassembly_stats.dropped_sdus++;
         buffer_allocator->free(packet);
         return;
       }
@@ -216,6 +270,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
       if ((iso_full_len + sizeof(BT_HDR)) > BT_DEFAULT_BUFFER_SIZE) {
         LOG_ERROR("%s Dropping ISO packet with invalid length (%d).", __func__,
                   iso_sdu_length);
+        iso_reassembly_stats.dropped_sdus++;
         buffer_allocator->free(packet);
         return;
       }
@@ -225,14 +280,23 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
           ((boundary_flag == HCI_ISO_BF_FIRST_FRAGMENTED_PACKET) &&
            (iso_full_len <= packet->len))) {
         LOG_ERROR("%s corrupted ISO frame", __func__);
+        iso_reassembly_stats.dropped_sdus++;
         buffer_allocator->free(packet);
         return;
       }
 
-      partial_packet =
-          (BT_HDR*)buffer_allocator->alloc(iso_full_len + sizeof(BT_HDR));
+      if (boundary_flag == HCI_ISO_BF_COMPLETE_PACKET) {
+        // The packet already holds the whole SDU, hand it up as is
+        packet->layer_specific |= BT_ISO_HDR_OFFSET_POINTS_DATA;
+        packet->offset = iso_hdr_len + HCI_ISO_PREAMBLE_SIZE;
+        callbacks->reassembled(packet);
+        return;
+      }
+
+      partial_packet = acquire_iso_buffer(slot, iso_full_len);
       if (!partial_packet) {
         LOG_ERROR("%s cannot allocate partial packet", __func__);
+        iso_reassembly_stats.dropped_sdus++;
         buffer_allocator->free(packet);
         return;
       }
@@ -248,14 +312,8 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
       STREAM_SKIP_UINT16(stream);  // skip the ISO handle
       UINT16_TO_STREAM(stream, iso_full_len - HCI_ISO_PREAMBLE_SIZE);
 
-      if (boundary_flag == HCI_ISO_BF_FIRST_FRAGMENTED_PACKET) {
-        partial_packet->offset = packet->len;
-        partial_iso_packets[handle] = partial_packet;
-      } else {
-        packet->layer_specific |= BT_ISO_HDR_OFFSET_POINTS_DATA;
-        partial_packet->offset = iso_hdr_len + HCI_ISO_PREAMBLE_SIZE;
-        callbacks->reassembled(partial_packet);
-      }
+      partial_packet->offset = packet->len;
+      slot->partial_packet = partial_packet;
 
       buffer_allocator->free(packet);
       break;
@@ -263,14 +321,15 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
     case HCI_ISO_BF_CONTINUATION_FRAGMENT_PACKET:
       // pass-through
     case HCI_ISO_BF_LAST_FRAGMENT_PACKET:
-      if (map_iter == partial_iso_packets.end()) {
+      if (slot->partial_packet == nullptr) {
         LOG_WARN("%s got continuation for unknown packet. Dropping it.",
                  __func__);
+        iso_reassembly_stats.late_fragments++;
         buffer_allocator->free(packet);
         return;
       }
 
-      partial_packet = map_iter->second;
+      partial_packet = slot->partial_packet;
       if (partial_packet->len <
           (partial_packet->offset + packet->len - HCI_ISO_PREAMBLE_SIZE)) {
         LOG_ERROR(
@@ -278,8 +337,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
             "dropping full packet",
             __func__, partial_packet->len);
         buffer_allocator->free(packet);
-        partial_iso_packets.erase(map_iter);
-        buffer_allocator->free(partial_packet);
+        drop_partial_iso_packet(slot);
         return;
       }
 
@@ -300,8 +358,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
             "size %d",
             __func__, partial_packet->len);
         buffer_allocator->free(packet);
-        partial_iso_packets.erase(map_iter);
-        buffer_allocator->free(partial_packet);
+        drop_partial_iso_packet(slot);
         return;
       }
 
@@ -314,7 +371,8 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
 
       buffer_allocator->free(packet);
 
-      partial_iso_packets.erase(map_iter);
+      slot->partial_packet = nullptr;
+      iso_reassembly_stats.fragmented_sdus++;
       callbacks->reassembled(partial_packet);
 
       break;
@@ -325,10 +383,11 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR* packet) {
   }
 }
 
-static const packet_fragmenter_t interface = {init, cleanup,
-
+static const packet_fragmenter_t interface = {init,
+                                              cleanup,
                                               fragment_and_dispatch,
-                                              reassemble_and_dispatch};
+                                              reassemble_and_dispatch,
+                                              get_iso_reassembly_stats};
 
 const packet_fragmenter_t* packet_fragmenter_get_interface() {
   controller = controller_get_interface();
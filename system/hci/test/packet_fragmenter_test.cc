@@ -265,6 +265,31 @@ static void manufacture_iso_packet_and_then_reassemble(uint16_t event,
   } while (length_sent < total_length);
 }
 
+static BT_HDR* manufacture_iso_start_fragment(uint16_t handle,
+                                             uint16_t sdu_length,
+                                             uint16_t data_length) {
+  BT_HDR* packet = (BT_HDR*)osi_calloc(data_length + 8 + sizeof(BT_HDR));
+  uint8_t* packet_data = packet->data;
+  packet->len = data_length + 8;
+  packet->event = MSG_HC_TO_STACK_HCI_ISO;
+  UINT16_TO_STREAM(packet_data, handle);
+  UINT16_TO_STREAM(packet_data, data_length + 4);
+  UINT16_TO_STREAM(packet_data, iso_packet_seq);
+  UINT16_TO_STREAM(packet_data, sdu_length);
+  return packet;
+}
+
+static BT_HDR* manufacture_iso_continuation_fragment(uint16_t handle,
+                                                    uint16_t data_length) {
+  BT_HDR* packet = (BT_HDR*)osi_calloc(data_length + 4 + sizeof(BT_HDR));
+  uint8_t* packet_data = packet->data;
+  packet->len = data_length + 4;
+  packet->event = MSG_HC_TO_STACK_HCI_ISO;
+  UINT16_TO_STREAM(packet_data, handle);
+  UINT16_TO_STREAM(packet_data, data_length);
+  return packet;
+}
+
 static void manufacture_packet_and_then_reassemble(uint16_t event,
                                                    uint16_t packet_size,
                                                    const char* data) {
@@ -535,3 +560,48 @@ TEST_F(PacketFragmenterTest, test_iso_reassembly_necessary_no_ts) {
   ASSERT_EQ(strlen(sample_data), data_size_sum);
   EXPECT_CALL_COUNT(reassembled_callback, 1);
 }
+
+TEST_F(PacketFragmenterTest, test_iso_reassembly_stats) {
+  reset_for(iso_no_reassembly);
+  iso_has_ts = false;
+  manufacture_packet_and_then_reassemble(MSG_HC_TO_STACK_HCI_ISO, (42 + 4),
+                                         small_sample_data);
+  reset_for(iso_reassembly);
+  manufacture_packet_and_then_reassemble(MSG_HC_TO_STACK_HCI_ISO, 42,
+                                         sample_data);
+
+  iso_reassembly_stats_t stats = fragmenter->get_iso_reassembly_stats();
+  ASSERT_EQ(1u, stats.fragmented_sdus);
+  ASSERT_EQ(0u, stats.dropped_sdus);
+  ASSERT_EQ(0u, stats.late_fragments);
+}
+
+TEST_F(PacketFragmenterTest, test_iso_unfinished_sdu_is_dropped) {
+  reset_for(init);
+  fragmenter->reassemble_and_dispatch(
+      manufacture_iso_start_fragment(test_iso_handle_start_without_ts, 20, 10));
+  // Reuses the buffer of the dropped SDU
+  fragmenter->reassemble_and_dispatch(
+      manufacture_iso_start_fragment(test_iso_handle_start_without_ts, 20, 10));
+  fragmenter->reassemble_and_dispatch(
+      manufacture_iso_continuation_fragment(test_iso_handle_continuation, 5));
+
+  iso_reassembly_stats_t stats = fragmenter->get_iso_reassembly_stats();
+  ASSERT_EQ(0u, stats.fragmented_sdus);
+  ASSERT_EQ(1u, stats.dropped_sdus);
+  ASSERT_EQ(0u, stats.late_fragments);
+  EXPECT_CALL_COUNT(reassembled_callback, 0);
+}
+
+TEST_F(PacketFragmenterTest, test_iso_late_fragment_is_dropped) {
+  reset_for(init);
+  fragmenter->reassemble_and_dispatch(
+      manufacture_iso_continuation_fragment(test_iso_handle_continuation, 5));
+  fragmenter->reassemble_and_dispatch(
+      manufacture_iso_continuation_fragment(test_iso_handle_end, 5));
+
+  iso_reassembly_stats_t stats = fragmenter->get_iso_reassembly_stats();
+  ASSERT_EQ(0u, stats.dropped_sdus);
+  ASSERT_EQ(2u, stats.late_fragments);
+  EXPECT_CALL_COUNT(reassembled_callback, 0);
+}
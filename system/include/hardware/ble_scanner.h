@@ -75,6 +75,22 @@ class AdvertisingTrackInfo {
   std::vector<uint8_t> scan_response;
 };
 
+/** One scan result of a batch. Its advertising data is the |adv_data_len|
+ * bytes at |adv_data_offset| in the buffer shared by the batch. */
+struct ScanResultBatchEntry {
+  uint16_t event_type;
+  uint8_t addr_type;
+  RawAddress bda;
+  uint8_t primary_phy;
+  uint8_t secondary_phy;
+  uint8_t advertising_sid;
+  int8_t tx_power;
+  int8_t rssi;
+  uint16_t periodic_adv_int;
+  uint32_t adv_data_offset;
+  uint16_t adv_data_len;
+};
+
 /**
  * LE Scanning related callbacks invoked from from the Bluetooth native stack
  * All callbacks are invoked on the JNI thread
@@ -92,6 +108,20 @@ class ScanningCallbacks {
                             int8_t tx_power, int8_t rssi,
                             uint16_t periodic_adv_int,
                             std::vector<uint8_t> adv_data) = 0;
+  /** Scan results gathered during one delivery window, when enabled with
+   * BleScannerInterface::SetScanResultBatching. By default they are delivered
+   * one by one to OnScanResult. */
+  virtual void OnScanResultBatch(std::vector<ScanResultBatchEntry> results,
+                                 std::vector<uint8_t> adv_data) {
+    for (const ScanResultBatchEntry& result : results) {
+      auto begin = adv_data.begin() + result.adv_data_offset;
+      OnScanResult(result.event_type, result.addr_type, result.bda,
+                   result.primary_phy, result.secondary_phy,
+                   result.advertising_sid, result.tx_power, result.rssi,
+                   result.periodic_adv_int,
+                   std::vector<uint8_t>(begin, begin + result.adv_data_len));
+    }
+  }
   virtual void OnTrackAdvFoundLost(
       AdvertisingTrackInfo advertising_track_info) = 0;
   virtual void OnBatchScanReports(int client_if, int status, int report_format,
@@ -186,6 +216,18 @@ class BleScannerInterface {
   virtual void SetScanParameters(int scanner_id, int scan_interval,
                                  int scan_window, Callback cb) = 0;
 
+  /** Drops the scan results repeating the last result of an advertiser,
+   * |policy| is a bluetooth::hci::ScanReportPolicy */
+  virtual void SetScanReportPolicy(int scanner_id, uint8_t policy,
+                                   uint8_t rssi_threshold_db,
+                                   uint16_t interval_ms) = 0;
+
+  /** Delivers the scan results in batches to OnScanResultBatch, once
+   * |max_results| are gathered or |max_delay_ms| after the first one.
+   * A |max_results| of 0 or 1 delivers each result to OnScanResult. */
+  virtual void SetScanResultBatching(uint8_t max_results,
+                                     uint16_t max_delay_ms) = 0;
+
   /* Configure the batchscan storage */
   virtual void BatchscanConfigStorage(int client_if, int batch_scan_full_max,
                                       int batch_scan_trunc_max,
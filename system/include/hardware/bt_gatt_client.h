@@ -118,6 +118,14 @@ typedef void (*register_for_notification_callback)(int conn_id, int registered,
 typedef void (*notify_callback)(int conn_id,
                                 const btgatt_notify_params_t& p_data);
 
+/**
+ * Remote device notifications received on a connection, in the order they
+ * arrived, when batching was turned on with set_notify_batching
+ */
+typedef void (*notify_batch_callback)(int conn_id,
+                                      const btgatt_notify_params_t* p_data,
+                                      int count);
+
 /** Reports result of a GATT read operation */
 typedef void (*read_characteristic_callback)(int conn_id, int status,
                                              btgatt_read_params_t* p_data);
@@ -208,6 +216,7 @@ typedef struct {
   conn_updated_callback conn_updated_cb;
   service_changed_callback service_changed_cb;
   subrate_change_callback subrate_chg_cb;
+  notify_batch_callback notify_batch_cb;
 } btgatt_client_callbacks_t;
 
 /** Represents the standard BT-GATT client interface. */
@@ -318,6 +327,15 @@ typedef struct {
                                  int subrate_max, int max_latency, int cont_num,
                                  int timeout);
 
+  /**
+   * Report the notifications of a connection through notify_batch_cb, up to
+   * max_count at a time and at most max_delay_ms after the first one arrived.
+   * Indications are still reported one by one through notify_cb. A max_count
+   * below 2 reports notifications one by one again.
+   */
+  bt_status_t (*set_notify_batching)(int conn_id, int max_count,
+                                     int max_delay_ms);
+
 } btgatt_client_interface_t;
 
 __END_DECLS
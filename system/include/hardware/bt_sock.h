@@ -30,6 +30,11 @@ __BEGIN_DECLS
 #define BTSOCK_FLAG_AUTH_MITM (1 << 3)
 #define BTSOCK_FLAG_AUTH_16_DIGIT (1 << 4)
 #define BTSOCK_FLAG_LE_COC (1 << 5)
+/* Number of channels, up to 5, of an outgoing BTSOCK_FLAG_LE_COC socket set up
+ * with one credit based connection request. SDUs are striped over them. */
+#define BTSOCK_FLAG_LE_COC_CHANNELS_SHIFT 8
+#define BTSOCK_FLAG_LE_COC_CHANNELS_MASK \
+  (0x7 << BTSOCK_FLAG_LE_COC_CHANNELS_SHIFT)
 
 typedef enum {
   BTSOCK_RFCOMM = 1,
@@ -494,6 +494,27 @@
 #define BLE_MAX_L2CAP_CLIENTS 15
 #endif
 
+/* The LE link optimizer measures the ATT and LE CoC traffic of each link over
+ * periods of this length, in ms. */
+#ifndef L2CAP_BLE_LINK_OPT_PERIOD_MS
+#define L2CAP_BLE_LINK_OPT_PERIOD_MS 1000
+#endif
+
+/* Bytes per period from which the link carries bulk data */
+#ifndef L2CAP_BLE_LINK_OPT_BULK_BYTES
+#define L2CAP_BLE_LINK_OPT_BULK_BYTES 4096
+#endif
+
+/* Packets per period from which the link carries interactive control */
+#ifndef L2CAP_BLE_LINK_OPT_CONTROL_PACKETS
+#define L2CAP_BLE_LINK_OPT_CONTROL_PACKETS 8
+#endif
+
+/* Quiet periods before the link steps down to a less demanding class */
+#ifndef L2CAP_BLE_LINK_OPT_QUIET_PERIODS
+#define L2CAP_BLE_LINK_OPT_QUIET_PERIODS 5
+#endif
+
 /******************************************************************************
  *
  * ATT/GATT Protocol/Profile Settings
@@ -702,6 +723,17 @@
 #define PORT_TX_BUF_CRITICAL_WM 15
 #endif
 
+/* Default share of the multiplexer given to a DLC in each scheduling round,
+ * in frames of its peer MTU. */
+#ifndef PORT_TX_DEFAULT_WEIGHT
+#define PORT_TX_DEFAULT_WEIGHT 1
+#endif
+
+/* Largest share of the multiplexer a DLC can ask for, in frames. */
+#ifndef PORT_TX_MAX_WEIGHT
+#define PORT_TX_MAX_WEIGHT 8
+#endif
+
 /* The RFCOMM multiplexer preferred flow control mechanism. */
 #ifndef PORT_FC_DEFAULT
 #define PORT_FC_DEFAULT PORT_FC_CREDIT
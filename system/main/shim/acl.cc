@@ -397,7 +397,7 @@ class ShimAclConnection {
                "Shim Acl was not properly disconnected handle:0x%04x", handle_);
   }
 
-  void EnqueuePacket(std::unique_ptr<packet::RawBuilder> packet) {
+  void EnqueuePacket(std::unique_ptr<packet::BasePacketBuilder> packet) {
     // TODO Handle queue size exceeds some threshold
     queue_.push(std::move(packet));
     RegisterEnqueue();
@@ -479,7 +479,7 @@ class ShimAclConnection {
   SendDataUpwards send_data_upwards_;
   hci::acl_manager::AclConnection::QueueUpEnd* queue_up_end_;
 
-  std::queue<std::unique_ptr<packet::RawBuilder>> queue_;
+  std::queue<std::unique_ptr<packet::BasePacketBuilder>> queue_;
   bool is_enqueue_registered_{false};
   bool is_disconnected_{false};
   CreationTime creation_time_;
@@ -872,7 +872,7 @@ struct shim::legacy::Acl::impl {
   }
 
   void EnqueueClassicPacket(HciHandle handle,
-                            std::unique_ptr<packet::RawBuilder> packet) {
+                            std::unique_ptr<packet::BasePacketBuilder> packet) {
     ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
                handle);
     handle_to_classic_connection_map_[handle]->EnqueuePacket(std::move(packet));
@@ -884,7 +884,7 @@ struct shim::legacy::Acl::impl {
   }
 
   void EnqueueLePacket(HciHandle handle,
-                       std::unique_ptr<packet::RawBuilder> packet) {
+                       std::unique_ptr<packet::BasePacketBuilder> packet) {
     ASSERT_LOG(IsLeAcl(handle), "handle %d is not a LE connection", handle);
     handle_to_le_connection_map_[handle]->EnqueuePacket(std::move(packet));
   }
@@ -1101,6 +1101,37 @@ struct shim::legacy::Acl::impl {
                    "Ignore connection from", "Le");
   }
 
+  void update_le_acceptlist(std::vector<hci::AddressWithType> to_remove,
+                            std::vector<hci::AddressWithType> to_add,
+                            std::promise<size_t> promise) {
+    for (const auto& address_with_type : to_remove) {
+      shadow_acceptlist_.Remove(address_with_type);
+    }
+    size_t accepted = 0;
+    while (accepted < to_add.size() && !shadow_acceptlist_.IsFull()) {
+      shadow_acceptlist_.Add(to_add[accepted++]);
+    }
+    promise.set_value(accepted);
+    if (accepted < to_add.size()) {
+      LOG_ERROR("Acceptlist is full preventing %zu new Le connections",
+                to_add.size() - accepted);
+      to_add.resize(accepted);
+    }
+
+    for (const auto& address_with_type : to_remove) {
+      BTM_LogHistory(kBtmLogTag, ToLegacyAddressWithType(address_with_type),
+                     "Ignore connection from", "Le");
+    }
+    for (const auto& address_with_type : to_add) {
+      BTM_LogHistory(kBtmLogTag, ToLegacyAddressWithType(address_with_type),
+                     "Allow connection from", "Le");
+    }
+    LOG_DEBUG("Updated Le acceptlist removed:%zu added:%zu", to_remove.size(),
+              to_add.size());
+    GetAclManager()->UpdateLeAcceptList(std::move(to_remove),
+                                        std::move(to_add));
+  }
+
   void clear_acceptlist() {
     auto shadow_acceptlist = shadow_acceptlist_.GetCopy();
     size_t count = shadow_acceptlist.size();
@@ -1137,6 +1168,31 @@ struct shim::legacy::Acl::impl {
     GetAclManager()->RemoveDeviceFromResolvingList(address_with_type);
   }
 
+  void UpdateAddressResolution(
+      std::vector<hci::AddressWithType> to_remove,
+      std::vector<hci::ResolvingListEntry> to_add) {
+    for (const auto& address_with_type : to_remove) {
+      if (!shadow_address_resolution_list_.Remove(address_with_type)) {
+        LOG_WARN("Unable to remove from Le Address Resolution list device:%s",
+                 ADDRESS_TO_LOGGABLE_CSTR(address_with_type));
+      }
+    }
+    size_t accepted = 0;
+    while (accepted < to_add.size() &&
+           !shadow_address_resolution_list_.IsFull()) {
+      shadow_address_resolution_list_.Add(to_add[accepted++].address_with_type);
+    }
+    if (accepted < to_add.size()) {
+      LOG_WARN("Le Address Resolution list is full, dropping %zu devices",
+               to_add.size() - accepted);
+      to_add.resize(accepted);
+    }
+    LOG_DEBUG("Updated Le Address Resolution list removed:%zu added:%zu",
+              to_remove.size(), to_add.size());
+    GetAclManager()->UpdateResolvingList(std::move(to_remove),
+                                         std::move(to_add));
+  }
+
   void ClearResolvingList() {
     GetAclManager()->ClearResolvingList();
     // TODO This should really be cleared after successful clear status
@@ -1445,7 +1501,7 @@ void shim::legacy::Acl::on_incoming_acl_credits(uint16_t handle,
 }
 
 void shim::legacy::Acl::write_data_sync(
-    HciHandle handle, std::unique_ptr<packet::RawBuilder> packet) {
+    HciHandle handle, std::unique_ptr<packet::BasePacketBuilder> packet) {
   if (pimpl_->IsClassicAcl(handle)) {
     pimpl_->EnqueueClassicPacket(handle, std::move(packet));
   } else if (pimpl_->IsLeAcl(handle)) {
@@ -1456,7 +1512,7 @@ void shim::legacy::Acl::write_data_sync(
 }
 
 void shim::legacy::Acl::WriteData(HciHandle handle,
-                                  std::unique_ptr<packet::RawBuilder> packet) {
+                                  std::unique_ptr<packet::BasePacketBuilder> packet) {
   handler_->Post(common::BindOnce(&Acl::write_data_sync,
                                   common::Unretained(this), handle,
                                   std::move(packet)));
@@ -1914,6 +1970,14 @@ void shim::legacy::Acl::ClearFilterAcceptList() {
   handler_->CallOn(pimpl_.get(), &Acl::impl::clear_acceptlist);
 }
 
+void shim::legacy::Acl::UpdateLeAcceptList(
+    std::vector<hci::AddressWithType> to_remove,
+    std::vector<hci::AddressWithType> to_add, std::promise<size_t> promise) {
+  handler_->CallOn(pimpl_.get(), &Acl::impl::update_le_acceptlist,
+                   std::move(to_remove), std::move(to_add),
+                   std::move(promise));
+}
+
 void shim::legacy::Acl::LeRand(LeRandCallback cb) {
   handler_->CallOn(pimpl_.get(), &Acl::impl::le_rand, std::move(cb));
 }
@@ -1932,6 +1996,13 @@ void shim::legacy::Acl::RemoveFromAddressResolution(
                    address_with_type);
 }
 
+void shim::legacy::Acl::UpdateAddressResolution(
+    std::vector<hci::AddressWithType> to_remove,
+    std::vector<hci::ResolvingListEntry> to_add) {
+  handler_->CallOn(pimpl_.get(), &Acl::impl::UpdateAddressResolution,
+                   std::move(to_remove), std::move(to_add));
+}
+
 void shim::legacy::Acl::ClearAddressResolution() {
   handler_->CallOn(pimpl_.get(), &Acl::impl::ClearResolvingList);
 }
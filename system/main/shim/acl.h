@@ -18,14 +18,16 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
 #include "gd/hci/acl_manager/connection_callbacks.h"
 #include "gd/hci/acl_manager/le_connection_callbacks.h"
 #include "gd/hci/address.h"
 #include "gd/hci/address_with_type.h"
 #include "gd/hci/class_of_device.h"
+#include "gd/hci/le_address_manager.h"
 #include "gd/os/handler.h"
-#include "gd/packet/raw_builder.h"
+#include "gd/packet/base_packet_builder.h"
 #include "main/shim/acl_legacy_interface.h"
 #include "main/shim/link_connection_interface.h"
 #include "main/shim/link_policy_interface.h"
@@ -94,6 +96,8 @@ class Acl : public hci::acl_manager::ConnectionCallbacks,
                               const std::array<uint8_t, 16>& local_irk);
   void RemoveFromAddressResolution(
       const hci::AddressWithType& address_with_type);
+  void UpdateAddressResolution(std::vector<hci::AddressWithType> to_remove,
+                               std::vector<hci::ResolvingListEntry> to_add);
   void ClearAddressResolution();
 
   // LinkPolicyInterface
@@ -114,7 +118,7 @@ class Acl : public hci::acl_manager::ConnectionCallbacks,
                         uint16_t cont_num, uint16_t sup_tout);
 
   void WriteData(uint16_t hci_handle,
-                 std::unique_ptr<packet::RawBuilder> packet);
+                 std::unique_ptr<packet::BasePacketBuilder> packet);
 
   void Dump(int fd) const;
   void DumpConnectionHistory(int fd) const;
@@ -123,6 +127,9 @@ class Acl : public hci::acl_manager::ConnectionCallbacks,
   void FinalShutdown();
 
   void ClearFilterAcceptList();
+  void UpdateLeAcceptList(std::vector<hci::AddressWithType> to_remove,
+                          std::vector<hci::AddressWithType> to_add,
+                          std::promise<size_t> promise);
   void DisconnectAllForSuspend();
   void LeRand(LeRandCallback cb);
   void SetSystemSuspendState(bool suspended);
@@ -130,7 +137,7 @@ class Acl : public hci::acl_manager::ConnectionCallbacks,
  protected:
   void on_incoming_acl_credits(uint16_t handle, uint16_t credits);
   void write_data_sync(uint16_t hci_handle,
-                       std::unique_ptr<packet::RawBuilder> packet);
+                       std::unique_ptr<packet::BasePacketBuilder> packet);
 
  private:
   os::Handler* handler_;
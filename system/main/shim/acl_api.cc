@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <future>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 #include "gd/hci/acl_manager.h"
 #include "gd/hci/remote_name_request.h"
@@ -64,12 +66,31 @@ void bluetooth::shim::ACL_IgnoreLeConnectionFrom(
       ToAddressWithTypeFromLegacy(legacy_address_with_type));
 }
 
+size_t bluetooth::shim::ACL_UpdateLeAcceptList(
+    const std::vector<tBLE_BD_ADDR>& to_remove,
+    const std::vector<tBLE_BD_ADDR>& to_add) {
+  std::vector<hci::AddressWithType> remove_addresses;
+  for (const auto& address_with_type : to_remove) {
+    remove_addresses.push_back(ToAddressWithTypeFromLegacy(address_with_type));
+  }
+  std::vector<hci::AddressWithType> add_addresses;
+  for (const auto& address_with_type : to_add) {
+    add_addresses.push_back(ToAddressWithTypeFromLegacy(address_with_type));
+  }
+
+  std::promise<size_t> promise;
+  auto future = promise.get_future();
+  Stack::GetInstance()->GetAcl()->UpdateLeAcceptList(
+      std::move(remove_addresses), std::move(add_addresses),
+      std::move(promise));
+  return future.get();
+}
+
 void bluetooth::shim::ACL_WriteData(uint16_t handle, BT_HDR* p_buf) {
-  std::unique_ptr<bluetooth::packet::RawBuilder> packet = MakeUniquePacket(
-      p_buf->data + p_buf->offset + HCI_DATA_PREAMBLE_SIZE,
-      p_buf->len - HCI_DATA_PREAMBLE_SIZE, IsPacketFlushable(p_buf));
+  // The packet takes ownership of |p_buf|
+  auto packet = MakeBtHdrPayload(p_buf, HCI_DATA_PREAMBLE_SIZE,
+                                 IsPacketFlushable(p_buf));
   Stack::GetInstance()->GetAcl()->WriteData(handle, std::move(packet));
-  osi_free(p_buf);
 }
 
 void bluetooth::shim::ACL_ConfigureLePrivacy(bool is_le_privacy_enabled) {
@@ -152,6 +173,27 @@ void bluetooth::shim::ACL_RemoveFromAddressResolution(
       legacy_address_with_type.bda, legacy_address_with_type.type));
 }
 
+void bluetooth::shim::ACL_UpdateAddressResolution(
+    const std::vector<tBLE_BD_ADDR>& to_remove,
+    const std::vector<std::tuple<tBLE_BD_ADDR, Octet16, Octet16>>& to_add) {
+  std::vector<hci::AddressWithType> remove_addresses;
+  for (const auto& address_with_type : to_remove) {
+    remove_addresses.push_back(
+        ToAddressWithType(address_with_type.bda, address_with_type.type));
+  }
+  std::vector<hci::ResolvingListEntry> add_entries;
+  for (const auto& [address_with_type, peer_irk, local_irk] : to_add) {
+    add_entries.push_back({
+        .address_with_type =
+            ToAddressWithType(address_with_type.bda, address_with_type.type),
+        .peer_irk = peer_irk,
+        .local_irk = local_irk,
+    });
+  }
+  Stack::GetInstance()->GetAcl()->UpdateAddressResolution(
+      std::move(remove_addresses), std::move(add_entries));
+}
+
 void bluetooth::shim::ACL_ClearAddressResolution() {
   Stack::GetInstance()->GetAcl()->ClearAddressResolution();
 }
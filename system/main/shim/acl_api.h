@@ -17,6 +17,8 @@
 #pragma once
 
 #include <optional>
+#include <tuple>
+#include <vector>
 
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_octets.h"
@@ -32,6 +34,11 @@ void ACL_CancelClassicConnection(const RawAddress& raw_address);
 bool ACL_AcceptLeConnectionFrom(const tBLE_BD_ADDR& legacy_address_with_type,
                                 bool is_direct);
 void ACL_IgnoreLeConnectionFrom(const tBLE_BD_ADDR& legacy_address_with_type);
+/* Ignores |to_remove| and accepts |to_add| in one accept list update. Returns
+ * how many devices at the front of |to_add| were accepted before the accept
+ * list got full. */
+size_t ACL_UpdateLeAcceptList(const std::vector<tBLE_BD_ADDR>& to_remove,
+                              const std::vector<tBLE_BD_ADDR>& to_add);
 
 void ACL_Disconnect(uint16_t handle, bool is_classic, tHCI_STATUS reason,
                     std::string comment);
@@ -54,6 +61,12 @@ void ACL_AddToAddressResolution(const tBLE_BD_ADDR& legacy_address_with_type,
                                 const Octet16& local_irk);
 void ACL_RemoveFromAddressResolution(
     const tBLE_BD_ADDR& legacy_address_with_type);
+/* Removes |to_remove| from and adds |to_add| to the address resolution list
+ * with a single pause of scanning and advertising. Entries of |to_add| are the
+ * identity address with the peer and local IRKs. */
+void ACL_UpdateAddressResolution(
+    const std::vector<tBLE_BD_ADDR>& to_remove,
+    const std::vector<std::tuple<tBLE_BD_ADDR, Octet16, Octet16>>& to_add);
 void ACL_ClearAddressResolution();
 void ACL_ClearFilterAcceptList();
 void ACL_LeSetDefaultSubrate(uint16_t subrate_min, uint16_t subrate_max,
@@ -19,8 +19,10 @@
  */
 #pragma once
 
+#include <mutex>
 #include <queue>
 #include <set>
+#include <vector>
 
 #include "hci/le_scanning_callback.h"
 #include "include/hardware/ble_scanner.h"
@@ -75,6 +77,11 @@ class BleScannerInterfaceImpl : public ::BleScannerInterface,
                             MsftAdvMonitorEnableCallback cb) override;
   void SetScanParameters(int scanner_id, int scan_interval, int scan_window,
                          Callback cb) override;
+  void SetScanReportPolicy(int scanner_id, uint8_t policy,
+                           uint8_t rssi_threshold_db,
+                           uint16_t interval_ms) override;
+  void SetScanResultBatching(uint8_t max_results,
+                             uint16_t max_delay_ms) override;
   void BatchscanConfigStorage(int client_if, int batch_scan_full_max,
                               int batch_scan_trunc_max,
                               int batch_scan_notify_threshold,
@@ -147,6 +154,29 @@ class BleScannerInterfaceImpl : public ::BleScannerInterface,
   void handle_remote_properties(RawAddress bd_addr, tBLE_ADDR_TYPE addr_type,
                                 std::vector<uint8_t> advertising_data);
 
+  struct ScanResultBatch {
+    std::vector<ScanResultBatchEntry> results;
+    // Address type of each result after resolution, for the remote properties
+    std::vector<tBLE_ADDR_TYPE> remote_addr_types;
+    std::vector<uint8_t> adv_data;
+  };
+
+  bool batch_scan_result(const ScanResultBatchEntry& result,
+                         tBLE_ADDR_TYPE remote_addr_type,
+                         const std::vector<uint8_t>& advertising_data);
+  void send_scan_result_batch();
+  void on_scan_result_batch_timeout(uint64_t generation);
+  void deliver_scan_result_batch(ScanResultBatch batch);
+
+  // The batch is filled from the gd scanning thread, and sent on timeout from
+  // the main thread
+  std::mutex scan_result_batch_mutex_;
+  ScanResultBatch scan_result_batch_;
+  uint8_t scan_result_batch_max_results_ = 0;
+  uint16_t scan_result_batch_max_delay_ms_ = 0;
+  // Bumped each time a batch is sent, so that its timeout is ignored
+  uint64_t scan_result_batch_generation_ = 0;
+
   class AddressCache {
    public:
     void init(void);
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include "gd/common/strings.h"
 #include "gd/os/log.h"
 #include "gd/storage/storage_module.h"
 #include "main/shim/entry.h"
@@ -123,18 +124,13 @@ bool BtifConfigInterface::GetBin(const std::string& section,
 }
 size_t BtifConfigInterface::GetBinLength(const std::string& section,
                                          const std::string& property) {
-  auto value_vec = GetStorage()->GetBin(section, property);
-  if (!value_vec) {
-    return 0;
-  }
-  return value_vec->size();
+  return GetStorage()->GetBinLength(section, property).value_or(0);
 }
 bool BtifConfigInterface::SetBin(const std::string& section,
                                  const std::string& property,
                                  const uint8_t* value, size_t length) {
   ASSERT(value != nullptr);
-  std::vector<uint8_t> value_vec(value, value + length);
-  GetStorage()->SetBin(section, property, value_vec);
+  GetStorage()->SetProperty(section, property, common::ToHexString(value, value + length));
   return true;
 }
 bool BtifConfigInterface::RemoveProperty(const std::string& section,
@@ -21,6 +21,7 @@
 #include <base/functional/bind.h>
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstdint>
 
 #include "common/bidi_queue.h"
@@ -30,6 +31,7 @@
 #include "hci/hci_packets.h"
 #include "hci/include/packet_fragmenter.h"
 #include "hci/vendor_specific_event_manager.h"
+#include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
@@ -272,16 +274,12 @@ bluetooth::common::BidiQueueEnd<bluetooth::hci::IsoBuilder,
     nullptr;
 static bluetooth::os::EnqueueBuffer<bluetooth::hci::IsoBuilder>*
     pending_iso_data = nullptr;
+static bool iso_reassembly_dumpsys_registered = false;
 
 static std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
     const uint8_t* data, size_t len) {
-  bluetooth::packet::RawBuilder builder;
-  std::vector<uint8_t> bytes(data, data + len);
-
-  auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
-  payload->AddOctets(bytes);
-
-  return payload;
+  return std::make_unique<bluetooth::packet::RawBuilder>(
+      std::vector<uint8_t>(data, data + len));
 }
 
 static BT_HDR* WrapPacketAndCopy(
@@ -432,7 +430,23 @@ static void iso_data_callback() {
   packet_fragmenter->reassemble_and_dispatch(data);
 }
 
+#define DUMPSYS_TAG "shim::hci"
+static void dump_iso_reassembly(int fd) {
+  iso_reassembly_stats_t stats = packet_fragmenter->get_iso_reassembly_stats();
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  LOG_DUMPSYS(fd, "Fragmented ISO SDUs reassembled:%" PRIu64,
+              stats.fragmented_sdus);
+  LOG_DUMPSYS(fd, "ISO SDUs dropped:%" PRIu64, stats.dropped_sdus);
+  LOG_DUMPSYS(fd, "Late ISO fragments dropped:%" PRIu64, stats.late_fragments);
+}
+#undef DUMPSYS_TAG
+
 static void register_for_iso() {
+  if (packet_fragmenter != nullptr && !iso_reassembly_dumpsys_registered) {
+    bluetooth::shim::RegisterDumpsysFunction(packet_fragmenter,
+                                             dump_iso_reassembly);
+    iso_reassembly_dumpsys_registered = true;
+  }
   hci_iso_queue_end = bluetooth::shim::GetHciLayer()->GetIsoQueueEnd();
   hci_iso_queue_end->RegisterDequeue(
       bluetooth::shim::GetGdShimHandler(),
@@ -443,6 +457,10 @@ static void register_for_iso() {
 }
 
 static void on_shutting_down() {
+  if (iso_reassembly_dumpsys_registered) {
+    bluetooth::shim::UnregisterDumpsysFunction(packet_fragmenter);
+    iso_reassembly_dumpsys_registered = false;
+  }
   if (pending_iso_data != nullptr) {
     pending_iso_data->Clear();
     delete pending_iso_data;
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "gd/common/init_flags.h"
+#include "gd/packet/base_packet_builder.h"
 #include "gd/packet/raw_builder.h"
 #include "hci/address_with_type.h"
 #include "osi/include/allocator.h"
@@ -106,10 +107,44 @@ inline tBLE_BD_ADDR ToLegacyAddressWithType(
 
 inline std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
     const uint8_t* data, size_t len, bool is_flushable) {
-  bluetooth::packet::RawBuilder builder;
-  std::vector<uint8_t> bytes(data, data + len);
-  auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
-  payload->AddOctets(bytes);
+  auto payload = std::make_unique<bluetooth::packet::RawBuilder>(
+      std::vector<uint8_t>(data, data + len));
+  payload->SetFlushable(is_flushable);
+  return payload;
+}
+
+// Payload of a legacy BT_HDR handed to the gd stack without copying it first.
+// The builder takes ownership of the buffer and serializes straight from it,
+// so the only copy left is the one into the outgoing HCI packet.
+class BtHdrPayloadBuilder : public bluetooth::packet::BasePacketBuilder {
+ public:
+  // |p_buf| is freed when the builder is destroyed. The payload starts
+  // |offset| bytes into the packet data of |p_buf|.
+  BtHdrPayloadBuilder(BT_HDR* p_buf, uint16_t offset)
+      : p_buf_(p_buf), offset_(offset) {
+    ASSERT(p_buf_ != nullptr);
+    ASSERT(offset_ <= p_buf_->len);
+  }
+
+  size_t size() const override { return p_buf_->len - offset_; }
+
+  void Serialize(bluetooth::packet::BitInserter& it) const override {
+    const uint8_t* data = ToPacketData<const uint8_t>(p_buf_.get(), offset_);
+    it.insert_bytes(data, size());
+  }
+
+ private:
+  struct BtHdrDeleter {
+    void operator()(BT_HDR* p_buf) const { osi_free(p_buf); }
+  };
+
+  std::unique_ptr<BT_HDR, BtHdrDeleter> p_buf_;
+  uint16_t offset_;
+};
+
+inline std::unique_ptr<BtHdrPayloadBuilder> MakeBtHdrPayload(
+    BT_HDR* p_buf, uint16_t offset, bool is_flushable) {
+  auto payload = std::make_unique<BtHdrPayloadBuilder>(p_buf, offset);
   payload->SetFlushable(is_flushable);
   return payload;
 }
@@ -118,13 +153,11 @@ inline BT_HDR* MakeLegacyBtHdrPacket(
     std::unique_ptr<bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>>
         packet,
     const std::vector<uint8_t>& preamble) {
-  std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
   BT_HDR* buffer = static_cast<BT_HDR*>(
-      osi_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
+      osi_calloc(packet->size() + preamble.size() + sizeof(BT_HDR)));
   std::copy(preamble.begin(), preamble.end(), buffer->data);
-  std::copy(packet_vector.begin(), packet_vector.end(),
-            buffer->data + preamble.size());
-  buffer->len = preamble.size() + packet_vector.size();
+  std::copy(packet->begin(), packet->end(), buffer->data + preamble.size());
+  buffer->len = preamble.size() + packet->size();
   return buffer;
 }
 
@@ -220,11 +220,7 @@ struct ClassicDynamicChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     if (do_in_main_thread(FROM_HERE,
                           base::BindOnce(appl_info_.pL2CA_DataInd_Cb, cid_token,
                                          base::Unretained(buffer))) !=
@@ -681,12 +677,11 @@ uint8_t L2CA_DataWrite(uint16_t cid, BT_HDR* p_data) {
     return 0;
   }
   auto len = p_data->len;
-  auto* data = p_data->data + p_data->offset;
+  // The packet takes ownership of |p_data|
   uint8_t sent_length =
       classic_dynamic_channel_helper_map_[psm]->send(
-          cid, MakeUniquePacket(data, len, IsPacketFlushable(p_data))) *
+          cid, MakeBtHdrPayload(p_data, 0, IsPacketFlushable(p_data))) *
       len;
-  osi_free(p_data);
   return sent_length;
 }
 
@@ -811,11 +806,7 @@ struct LeFixedChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     auto address = bluetooth::ToRawAddress(device);
     freg_.pL2CA_FixedData_Cb(cid_, address, buffer);
   }
@@ -920,12 +911,10 @@ uint16_t L2CA_SendFixedChnlData(uint16_t cid, const RawAddress& rem_bda,
     return L2CAP_DW_FAILED;
   }
   auto* helper = &le_fixed_channel_helper_.find(cid)->second;
-  auto len = p_buf->len;
-  auto* data = p_buf->data + p_buf->offset;
+  // The packet takes ownership of |p_buf|
   bool sent =
       helper->send(ToGdAddress(rem_bda),
-                   MakeUniquePacket(data, len, IsPacketFlushable(p_buf)));
-  osi_free(p_buf);
+                   MakeBtHdrPayload(p_buf, 0, IsPacketFlushable(p_buf)));
   return sent ? L2CAP_DW_SUCCESS : L2CAP_DW_FAILED;
 }
 
@@ -1311,11 +1300,7 @@ struct LeDynamicChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     if (do_in_main_thread(FROM_HERE,
                           base::BindOnce(appl_info_.pL2CA_DataInd_Cb, cid_token,
                                          base::Unretained(buffer))) !=
@@ -1477,12 +1462,11 @@ uint8_t L2CA_LECocDataWrite(uint16_t cid, BT_HDR* p_data) {
     return 0;
   }
   auto len = p_data->len;
-  auto* data = p_data->data + p_data->offset;
+  // The packet takes ownership of |p_data|
   uint8_t sent_length =
       le_dynamic_channel_helper_map_[psm]->send(
-          cid, MakeUniquePacket(data, len, IsPacketFlushable(p_data))) *
+          cid, MakeBtHdrPayload(p_data, 0, IsPacketFlushable(p_data))) *
       len;
-  osi_free(p_data);
   return sent_length;
 }
 
@@ -37,6 +37,7 @@
 #include "main/shim/shim.h"
 #include "os/log.h"
 #include "stack/btm/btm_int_types.h"
+#include "stack/include/main_thread.h"
 #include "stack/include/btm_log_history.h"
 #include "storage/device.h"
 #include "storage/le_device.h"
@@ -165,6 +166,10 @@ void BleScannerInterfaceImpl::Unregister(int scanner_id) {
 void BleScannerInterfaceImpl::Scan(bool start) {
   LOG(INFO) << __func__ << " in shim layer " <<  ((start) ? "started" : "stopped");
   bluetooth::shim::GetScanning()->Scan(start);
+  if (!start) {
+    std::lock_guard<std::mutex> lock(scan_result_batch_mutex_);
+    send_scan_result_batch();
+  }
   if (start && !btm_cb.ble_ctr_cb.is_ble_observe_active()) {
     btm_cb.neighbor.le_scan = {
         .start_time_ms = timestamper_in_milliseconds.GetTimestamp(),
@@ -358,6 +363,27 @@ void BleScannerInterfaceImpl::SetScanParameters(int scanner_id,
                                                     scan_interval, scan_window);
 }
 
+/** Drops the scan results repeating the last result of an advertiser */
+void BleScannerInterfaceImpl::SetScanReportPolicy(int scanner_id,
+                                                  uint8_t policy,
+                                                  uint8_t rssi_threshold_db,
+                                                  uint16_t interval_ms) {
+  LOG(INFO) << __func__ << " in shim layer";
+  bluetooth::shim::GetScanning()->SetScanReportPolicy(
+      scanner_id, static_cast<bluetooth::hci::ScanReportPolicy>(policy),
+      rssi_threshold_db, interval_ms);
+}
+
+/** Delivers the scan results in batches */
+void BleScannerInterfaceImpl::SetScanResultBatching(uint8_t max_results,
+                                                    uint16_t max_delay_ms) {
+  LOG(INFO) << __func__ << " in shim layer";
+  std::lock_guard<std::mutex> lock(scan_result_batch_mutex_);
+  send_scan_result_batch();
+  scan_result_batch_max_results_ = max_results;
+  scan_result_batch_max_delay_ms_ = max_delay_ms;
+}
+
 /* Configure the batchscan storage */
 void BleScannerInterfaceImpl::BatchscanConfigStorage(
     int client_if, int batch_scan_full_max, int batch_scan_trunc_max,
@@ -521,19 +547,32 @@ void BleScannerInterfaceImpl::OnScanResult(
     btm_ble_process_adv_addr(raw_address, &ble_addr_type);
   }
 
-  do_in_jni_thread(
-      FROM_HERE,
-      base::BindOnce(&BleScannerInterfaceImpl::handle_remote_properties,
-                     base::Unretained(this), raw_address, ble_addr_type,
-                     advertising_data));
-
-  do_in_jni_thread(
-      FROM_HERE,
-      base::BindOnce(&ScanningCallbacks::OnScanResult,
-                     base::Unretained(scanning_callbacks_), event_type,
-                     static_cast<uint8_t>(address_type), raw_address,
-                     primary_phy, secondary_phy, advertising_sid, tx_power,
-                     rssi, periodic_advertising_interval, advertising_data));
+  ScanResultBatchEntry result = {
+      .event_type = event_type,
+      .addr_type = static_cast<uint8_t>(address_type),
+      .bda = raw_address,
+      .primary_phy = primary_phy,
+      .secondary_phy = secondary_phy,
+      .advertising_sid = advertising_sid,
+      .tx_power = tx_power,
+      .rssi = rssi,
+      .periodic_adv_int = periodic_advertising_interval,
+  };
+  if (!batch_scan_result(result, ble_addr_type, advertising_data)) {
+    do_in_jni_thread(
+        FROM_HERE,
+        base::BindOnce(&BleScannerInterfaceImpl::handle_remote_properties,
+                       base::Unretained(this), raw_address, ble_addr_type,
+                       advertising_data));
+
+    do_in_jni_thread(
+        FROM_HERE,
+        base::BindOnce(&ScanningCallbacks::OnScanResult,
+                       base::Unretained(scanning_callbacks_), event_type,
+                       static_cast<uint8_t>(address_type), raw_address,
+                       primary_phy, secondary_phy, advertising_sid, tx_power,
+                       rssi, periodic_advertising_interval, advertising_data));
+  }
 
   // TODO: Remove when StartInquiry in GD part implemented
   btm_ble_process_adv_pkt_cont_for_inquiry(
@@ -542,6 +581,71 @@ void BleScannerInterfaceImpl::OnScanResult(
       advertising_data);
 }
 
+/* Append a scan result to the current batch, return false if batching is
+ * disabled */
+bool BleScannerInterfaceImpl::batch_scan_result(
+    const ScanResultBatchEntry& result, tBLE_ADDR_TYPE remote_addr_type,
+    const std::vector<uint8_t>& advertising_data) {
+  std::lock_guard<std::mutex> lock(scan_result_batch_mutex_);
+  if (scan_result_batch_max_results_ <= 1) {
+    return false;
+  }
+
+  ScanResultBatch& batch = scan_result_batch_;
+  batch.results.push_back(result);
+  batch.results.back().adv_data_offset = batch.adv_data.size();
+  batch.results.back().adv_data_len = advertising_data.size();
+  batch.remote_addr_types.push_back(remote_addr_type);
+  batch.adv_data.insert(batch.adv_data.end(), advertising_data.begin(),
+                        advertising_data.end());
+
+  if (batch.results.size() >= scan_result_batch_max_results_) {
+    send_scan_result_batch();
+  } else if (batch.results.size() == 1) {
+    do_in_main_thread_delayed(
+        FROM_HERE,
+        base::BindOnce(&BleScannerInterfaceImpl::on_scan_result_batch_timeout,
+                       base::Unretained(this), scan_result_batch_generation_),
+        base::Milliseconds(scan_result_batch_max_delay_ms_));
+  }
+  return true;
+}
+
+/* Post the current batch to the JNI thread, scan_result_batch_mutex_ must be
+ * held */
+void BleScannerInterfaceImpl::send_scan_result_batch() {
+  scan_result_batch_generation_++;
+  if (scan_result_batch_.results.empty()) {
+    return;
+  }
+  do_in_jni_thread(
+      FROM_HERE,
+      base::BindOnce(&BleScannerInterfaceImpl::deliver_scan_result_batch,
+                     base::Unretained(this), std::move(scan_result_batch_)));
+  scan_result_batch_ = {};
+  scan_result_batch_.results.reserve(scan_result_batch_max_results_);
+  scan_result_batch_.remote_addr_types.reserve(scan_result_batch_max_results_);
+}
+
+void BleScannerInterfaceImpl::on_scan_result_batch_timeout(
+    uint64_t generation) {
+  std::lock_guard<std::mutex> lock(scan_result_batch_mutex_);
+  if (generation == scan_result_batch_generation_) {
+    send_scan_result_batch();
+  }
+}
+
+void BleScannerInterfaceImpl::deliver_scan_result_batch(ScanResultBatch batch) {
+  for (size_t i = 0; i < batch.results.size(); i++) {
+    auto begin = batch.adv_data.begin() + batch.results[i].adv_data_offset;
+    handle_remote_properties(
+        batch.results[i].bda, batch.remote_addr_types[i],
+        std::vector<uint8_t>(begin, begin + batch.results[i].adv_data_len));
+  }
+  scanning_callbacks_->OnScanResultBatch(std::move(batch.results),
+                                         std::move(batch.adv_data));
+}
+
 void BleScannerInterfaceImpl::OnTrackAdvFoundLost(
     bluetooth::hci::AdvertisingFilterOnFoundOnLostInfo on_found_on_lost_info) {
   AdvertisingTrackInfo track_info = {};
@@ -754,10 +858,11 @@ void BleScannerInterfaceImpl::handle_remote_properties(
     return;
   }
 
+  // Parse the advertising data once for all the fields below
+  AdvertiseDataParser::FieldIndex fields(advertising_data);
   auto device_type = bluetooth::hci::DeviceType::LE;
   uint8_t flag_len;
-  const uint8_t* p_flag = AdvertiseDataParser::GetFieldByType(
-      advertising_data, BTM_BLE_AD_TYPE_FLAG, &flag_len);
+  const uint8_t* p_flag = fields.GetFieldByType(BTM_BLE_AD_TYPE_FLAG, &flag_len);
 
   if (p_flag != NULL && flag_len != 0) {
     if ((BTM_BLE_BREDR_NOT_SPT & *p_flag) == 0) {
@@ -766,12 +871,12 @@ void BleScannerInterfaceImpl::handle_remote_properties(
   }
 
   uint8_t remote_name_len;
-  const uint8_t* p_eir_remote_name = AdvertiseDataParser::GetFieldByType(
-      advertising_data, HCI_EIR_COMPLETE_LOCAL_NAME_TYPE, &remote_name_len);
+  const uint8_t* p_eir_remote_name =
+      fields.GetFieldByType(HCI_EIR_COMPLETE_LOCAL_NAME_TYPE, &remote_name_len);
 
   if (p_eir_remote_name == NULL) {
-    p_eir_remote_name = AdvertiseDataParser::GetFieldByType(
-        advertising_data, HCI_EIR_SHORTENED_LOCAL_NAME_TYPE, &remote_name_len);
+    p_eir_remote_name = fields.GetFieldByType(HCI_EIR_SHORTENED_LOCAL_NAME_TYPE,
+                                              &remote_name_len);
   }
 
   bt_bdname_t bdname = {0};
@@ -806,19 +911,15 @@ void BleScannerInterfaceImpl::handle_remote_properties(
   auto* storage_module = bluetooth::shim::GetStorage();
   bluetooth::hci::Address address = ToGdAddress(bd_addr);
 
-  // update device type
+  // update device type and address type
   auto mutation = storage_module->Modify();
   bluetooth::storage::Device device =
       storage_module->GetDeviceByLegacyKey(address);
   mutation.Add(device.SetDeviceType(device_type));
-  mutation.Commit();
-
-  // update address type
-  auto mutation2 = storage_module->Modify();
   bluetooth::storage::LeDevice le_device = device.Le();
-  mutation2.Add(
+  mutation.Add(
       le_device.SetAddressType((bluetooth::hci::AddressType)addr_type));
-  mutation2.Commit();
+  mutation.Commit();
 }
 
 void BleScannerInterfaceImpl::AddressCache::add(const RawAddress& p_bda) {
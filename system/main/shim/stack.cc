@@ -40,6 +40,7 @@
 #include "gd/hci/vendor_specific_event_manager.h"
 #include "gd/metrics/counter_metrics.h"
 #include "gd/os/log.h"
+#include "gd/os/system_properties.h"
 #include "gd/shim/dumpsys.h"
 #include "gd/storage/storage_module.h"
 #include "gd/sysprops/sysprops_module.h"
@@ -102,12 +103,50 @@ void Stack::StartEverything() {
   bluetooth::shim::init_distance_measurement_manager();
 }
 
+namespace {
+// Total number of gd reactor threads, gd_stack_thread included. 1 keeps every
+// module on gd_stack_thread.
+constexpr char kReactorShardsProperty[] = "bluetooth.gd.reactor_shards";
+// Keep the HAL open across a stop and the next start of the stack.
+constexpr char kWarmRestartProperty[] = "bluetooth.gd.warm_restart.enabled";
+}  // namespace
+
+// Move the modules that only talk to the rest of the stack through handlers
+// off gd_stack_thread, so that scanning and advertising bursts do not delay
+// the HCI/ACL data path. Everything else keeps running on gd_stack_thread
+// since it relies on direct, same-thread calls into its dependencies.
+void Stack::AssignModulesToShards() {
+  uint32_t num_shards =
+      os::GetSystemPropertyUint32(kReactorShardsProperty, 1);
+  if (num_shards <= 1) {
+    return;
+  }
+
+  reactor_pool_ = new os::ReactorPool("gd_stack_shard", num_shards - 1,
+                                      os::Thread::Priority::NORMAL);
+  size_t next_shard = 0;
+  auto next = [this, &next_shard]() {
+    return reactor_pool_->GetShard(next_shard++ % reactor_pool_->NumShards());
+  };
+  stack_manager_.AssignThread<hci::LeScanningManager>(next());
+  stack_manager_.AssignThread<hci::LeAdvertisingManager>(next());
+  stack_manager_.AssignThread<hci::DistanceMeasurementManager>(next());
+  LOG_INFO("%s Gd stack sharded over %u reactor threads", __func__,
+           num_shards);
+}
+
 void Stack::Start(ModuleList* modules) {
   ASSERT_LOG(!is_running_, "%s Gd stack already running", __func__);
   LOG_INFO("%s Starting Gd stack", __func__);
 
-  stack_thread_ =
-      new os::Thread("gd_stack_thread", os::Thread::Priority::REAL_TIME);
+  // After a warm shut down the thread is still running the warm modules
+  if (stack_thread_ == nullptr) {
+    stack_thread_ =
+        new os::Thread("gd_stack_thread", os::Thread::Priority::REAL_TIME);
+  } else {
+    LOG_INFO("%s Warm start of Gd stack", __func__);
+  }
+  AssignModulesToShards();
   stack_manager_.StartUp(modules, stack_thread_);
 
   stack_handler_ = new os::Handler(stack_thread_);
@@ -134,11 +173,33 @@ void Stack::Stop() {
 
   stack_handler_->Clear();
 
-  stack_manager_.ShutDown();
+  // A warm shut down keeps the HAL, and the controller it powers, up until the
+  // next start, so that it skips opening the HAL and loading the firmware.
+  // The upper layers are rebuilt from scratch, and the controller state is
+  // read again after the HCI reset issued by the HCI layer.
+  const bool warm = os::GetSystemPropertyBool(kWarmRestartProperty, false);
+  if (warm) {
+    ModuleList warm_modules;
+    warm_modules.add<hal::HciHal>();
+    stack_manager_.ShutDown(&warm_modules);
+  } else {
+    stack_manager_.ShutDown();
+  }
 
   delete stack_handler_;
   stack_handler_ = nullptr;
 
+  if (reactor_pool_ != nullptr) {
+    reactor_pool_->Stop();
+    delete reactor_pool_;
+    reactor_pool_ = nullptr;
+  }
+
+  if (warm) {
+    LOG_INFO("%s Successfully shut down Gd stack, keeping the HAL", __func__);
+    return;
+  }
+
   stack_thread_->Stop();
   delete stack_thread_;
   stack_thread_ = nullptr;
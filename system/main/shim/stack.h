@@ -21,6 +21,7 @@
 
 #include "gd/module.h"
 #include "gd/os/handler.h"
+#include "gd/os/reactor_pool.h"
 #include "gd/os/thread.h"
 #include "gd/stack_manager.h"
 #include "main/shim/acl.h"
@@ -65,11 +66,13 @@ class Stack {
   StackManager stack_manager_;
   bool is_running_ = false;
   os::Thread* stack_thread_ = nullptr;
+  os::ReactorPool* reactor_pool_ = nullptr;
   os::Handler* stack_handler_ = nullptr;
   legacy::Acl* acl_ = nullptr;
   Btm* btm_ = nullptr;
 
   void Start(ModuleList* modules);
+  void AssignModulesToShards();
 };
 
 }  // namespace shim
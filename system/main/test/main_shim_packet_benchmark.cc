@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gd/packet/bit_inserter.h"
+#include "gd/packet/raw_builder.h"
+#include "main/shim/helpers.h"
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/hcidefs.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Outgoing ACL packet as handed to ACL_WriteData by the legacy stack
+BT_HDR* MakeLegacyAclPacket(size_t payload_size) {
+  BT_HDR* p_buf = static_cast<BT_HDR*>(
+      osi_calloc(sizeof(BT_HDR) + HCI_DATA_PREAMBLE_SIZE + payload_size));
+  p_buf->len = HCI_DATA_PREAMBLE_SIZE + payload_size;
+  return p_buf;
+}
+
+// Copy of the payload into the outgoing HCI packet, done by the gd stack
+void SerializePayload(const bluetooth::packet::BasePacketBuilder& payload,
+                      std::vector<uint8_t>& hci_packet) {
+  hci_packet.clear();
+  bluetooth::packet::BitInserter it(hci_packet);
+  payload.Serialize(it);
+}
+
+// ACL_WriteData used to copy the BT_HDR payload into a vector, copy that
+// vector into a RawBuilder and free the BT_HDR before the payload got
+// serialized.
+void BM_AclWriteData_CopiedPayload(State& state) {
+  size_t payload_size = state.range(0);
+  std::vector<uint8_t> hci_packet;
+  hci_packet.reserve(payload_size);
+  for (auto _ : state) {
+    BT_HDR* p_buf = MakeLegacyAclPacket(payload_size);
+    const uint8_t* data = ToPacketData<const uint8_t>(p_buf, HCI_DATA_PREAMBLE_SIZE);
+    std::vector<uint8_t> bytes(data, data + payload_size);
+    auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
+    payload->AddOctets(bytes);
+    osi_free(p_buf);
+    SerializePayload(*payload, hci_packet);
+    benchmark::DoNotOptimize(hci_packet.data());
+  }
+  state.counters["bytes_copied_per_packet"] = 3 * payload_size;
+  state.SetBytesProcessed(state.iterations() * payload_size);
+}
+
+// The payload is now serialized straight from the BT_HDR it arrived in
+void BM_AclWriteData_BtHdrPayload(State& state) {
+  size_t payload_size = state.range(0);
+  std::vector<uint8_t> hci_packet;
+  hci_packet.reserve(payload_size);
+  for (auto _ : state) {
+    BT_HDR* p_buf = MakeLegacyAclPacket(payload_size);
+    auto payload = bluetooth::MakeBtHdrPayload(p_buf, HCI_DATA_PREAMBLE_SIZE,
+                                               false);
+    SerializePayload(*payload, hci_packet);
+    benchmark::DoNotOptimize(hci_packet.data());
+  }
+  state.counters["bytes_copied_per_packet"] = payload_size;
+  state.SetBytesProcessed(state.iterations() * payload_size);
+}
+
+BENCHMARK(BM_AclWriteData_CopiedPayload)->Arg(27)->Arg(251)->Arg(1021);
+BENCHMARK(BM_AclWriteData_BtHdrPayload)->Arg(27)->Arg(251)->Arg(1021);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -28,6 +28,17 @@ typedef struct thread_t thread_t;
 // Prototype for the alarm callback function.
 typedef void (*alarm_callback_t)(void* data);
 
+// Priority class of an alarm, selecting the thread that runs the callbacks
+// set with |alarm_set|.
+typedef enum {
+  // Callbacks run on the thread shared by all the default alarms.
+  ALARM_PRIORITY_DEFAULT,
+  // Callbacks run on a dedicated thread with a higher real-time priority, so
+  // that long default callbacks don't delay them. Reserved for the timers of
+  // the audio data paths, whose callbacks must be short.
+  ALARM_PRIORITY_MEDIA,
+} alarm_priority_t;
+
 // Creates a new one-time off alarm object with user-assigned
 // |name|. |name| may not be NULL, and a copy of the string will
 // be stored internally. The value of |name| has no semantic
@@ -46,10 +57,17 @@ alarm_t* alarm_new(const char* name);
 // failure.
 alarm_t* alarm_new_periodic(const char* name);
 
-// Frees an |alarm| object created by |alarm_new| or
-// |alarm_new_periodic|. |alarm| may be NULL. If the alarm is
-// pending, it will be cancelled first. It is not safe to call
-// |alarm_free| from inside the callback of |alarm|.
+// Creates a new alarm object as |alarm_new| or |alarm_new_periodic|
+// when |is_periodic| is true, whose callbacks run in the |priority|
+// class.
+alarm_t* alarm_new_with_priority(const char* name, bool is_periodic,
+                                 alarm_priority_t priority);
+
+// Frees an |alarm| object created by |alarm_new|,
+// |alarm_new_periodic| or |alarm_new_with_priority|. |alarm| may
+// be NULL. If the alarm is pending, it will be cancelled first.
+// It is not safe to call |alarm_free| from inside the callback of
+// |alarm|.
 void alarm_free(alarm_t* alarm);
 
 // Sets an |alarm| to execute a callback in the future. The |cb|
@@ -66,8 +84,9 @@ void alarm_free(alarm_t* alarm);
 //
 // The |data| argument may be NULL, but the |cb| callback may not
 // be NULL. All |cb| callbacks scheduled through this call are
-// called within a single (internally created) thread. That
-// thread is not same as the caller’s thread. If two (or more)
+// called within a single (internally created) thread per
+// priority class. That thread is not same as the caller’s
+// thread. If two (or more)
 // alarms are set back-to-back with the same |interval_ms|, the
 // callbacks will be called in the order the alarms are set.
 void alarm_set(alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
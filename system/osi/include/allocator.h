@@ -37,16 +37,80 @@ extern const allocator_t allocator_calloc;
 char* osi_strdup(const char* str);
 char* osi_strndup(const char* str, size_t len);
 
-void* osi_malloc(size_t size);
-void* osi_calloc(size_t size);
+// Heap accounting tags. Allocations through |osi_malloc| and |osi_calloc| are
+// attributed to the module of the calling source file, for example every
+// allocation made from stack/l2cap/ counts towards OSI_ALLOC_TAG_L2CAP.
+typedef enum {
+  OSI_ALLOC_TAG_OTHER = 0,
+  OSI_ALLOC_TAG_HCI,
+  OSI_ALLOC_TAG_L2CAP,
+  OSI_ALLOC_TAG_GATT,
+  OSI_ALLOC_TAG_A2DP,
+  OSI_ALLOC_TAG_AVRCP,
+  OSI_ALLOC_TAG_RFCOMM,
+  OSI_ALLOC_TAG_SDP,
+  OSI_ALLOC_TAG_SCAN,
+  OSI_ALLOC_TAG_LE_AUDIO,
+  OSI_ALLOC_TAG_BTIF,
+  OSI_ALLOC_TAG_COUNT,
+} osi_alloc_tag_t;
+
+// |caller_file| is filled in by the compiler and selects the tag.
+void* osi_malloc(size_t size, const char* caller_file = __builtin_FILE());
+void* osi_calloc(size_t size, const char* caller_file = __builtin_FILE());
 void osi_free(void* ptr);
 
+// Same as |osi_malloc| and |osi_calloc|, for shared helpers allocating on
+// behalf of a known module.
+void* osi_malloc_tagged(osi_alloc_tag_t tag, size_t size);
+void* osi_calloc_tagged(osi_alloc_tag_t tag, size_t size);
+
 // Free a buffer that was previously allocated with function |osi_malloc|
 // or |osi_calloc| and reset the pointer to that buffer to NULL.
 // |p_ptr| is a pointer to the buffer pointer to be reset.
 // |p_ptr| cannot be NULL.
 void osi_free_and_reset(void** p_ptr);
 
+// Small allocations made through |osi_malloc| and |osi_calloc| are served from
+// a thread-caching slab pool with OSI_SLAB_NUM_CLASSES size classes. The pool
+// can be compiled out with -DOSI_SLAB_ALLOCATOR_ENABLED=0, or disabled at
+// runtime by setting bluetooth.osi.slab_allocator.enabled to false.
+#define OSI_SLAB_NUM_CLASSES 9
+
+typedef struct {
+  size_t block_size;
+  size_t in_use;
+  size_t high_water_mark;
+  size_t allocations;
+  // Requests of this class that fell back to malloc because the class was
+  // exhausted.
+  size_t overflows;
+} osi_slab_class_stats_t;
+
+// Fills |stats| with a snapshot of the per-class counters. Returns false if
+// the slab pool is disabled, in which case |stats| is left untouched.
+bool osi_allocator_get_slab_stats(
+    osi_slab_class_stats_t stats[OSI_SLAB_NUM_CLASSES]);
+
+// Per tag heap usage. The counters are kept per thread and published in
+// batches, so the snapshot may lag the latest allocations of other threads by
+// a few tens of kilobytes. The accounting can be disabled at runtime by
+// setting bluetooth.osi.alloc_tags.enabled to false.
+typedef struct {
+  const char* name;
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t allocations;
+} osi_alloc_tag_stats_t;
+
+// Fills |stats| with a snapshot of the per-tag counters. Returns false if the
+// accounting is disabled, in which case |stats| is left untouched.
+bool osi_allocator_get_tag_stats(
+    osi_alloc_tag_stats_t stats[OSI_ALLOC_TAG_COUNT]);
+
+// Dumps the slab pool and the per-tag statistics to the file descriptor |fd|.
+void osi_allocator_debug_dump(int fd);
+
 class OsiObject {
  public:
   OsiObject(void* ptr);
@@ -17,9 +17,15 @@
 // - All strings are case sensitive.
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <initializer_list>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 // The default section name to use if a key/value pair is not defined within
 // a section.
@@ -30,16 +36,186 @@ struct entry_t {
   std::string value;
 };
 
+// A std::list that also keeps a hash index from the |Key| member of each
+// element to its position, so lookups by key do not have to walk the list
+// while iteration keeps insertion order. Keys must not be modified in place
+// once an element is in the list. If several elements share a key, |Find|
+// returns the first one, as a linear search would.
+//
+// Every modification, including handing out a non-const iterator through
+// |begin|, |front| or |back|, moves the list to a new |Generation|, which
+// lets owners cache data derived from the contents.
+template <typename T, std::string T::*Key>
+class IndexedList {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = typename std::list<T>::iterator;
+  using const_iterator = typename std::list<T>::const_iterator;
+
+  IndexedList() = default;
+  IndexedList(std::initializer_list<T> init)
+      : list_(init), generation_(NextGeneration()) {
+    Reindex();
+  }
+  IndexedList(const IndexedList& other)
+      : list_(other.list_), generation_(other.generation_) {
+    Reindex();
+  }
+  IndexedList(IndexedList&& other) noexcept
+      : list_(std::move(other.list_)),
+        index_(std::move(other.index_)),
+        duplicates_(other.duplicates_),
+        generation_(other.generation_) {
+    other.Reset();
+  }
+  IndexedList& operator=(const IndexedList& other) {
+    if (this == &other) return *this;
+    list_ = other.list_;
+    generation_ = other.generation_;
+    Reindex();
+    return *this;
+  }
+  IndexedList& operator=(IndexedList&& other) noexcept {
+    if (this == &other) return *this;
+    list_ = std::move(other.list_);
+    index_ = std::move(other.index_);
+    duplicates_ = other.duplicates_;
+    generation_ = other.generation_;
+    other.Reset();
+    return *this;
+  }
+
+  iterator begin() {
+    MarkModified();
+    return list_.begin();
+  }
+  iterator end() { return list_.end(); }
+  const_iterator begin() const { return list_.begin(); }
+  const_iterator end() const { return list_.end(); }
+  const_iterator cbegin() const { return list_.cbegin(); }
+  const_iterator cend() const { return list_.cend(); }
+
+  size_type size() const { return list_.size(); }
+  bool empty() const { return list_.empty(); }
+
+  reference front() {
+    MarkModified();
+    return list_.front();
+  }
+  reference back() {
+    MarkModified();
+    return list_.back();
+  }
+  const_reference front() const { return list_.front(); }
+  const_reference back() const { return list_.back(); }
+
+  iterator Find(const std::string& key) {
+    auto found = index_.find(key);
+    return (found == index_.end()) ? list_.end() : found->second;
+  }
+  const_iterator Find(const std::string& key) const {
+    auto found = index_.find(key);
+    return (found == index_.end()) ? list_.end() : found->second;
+  }
+  bool Has(const std::string& key) const {
+    return index_.find(key) != index_.end();
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    MarkModified();
+    list_.emplace_back(std::forward<Args>(args)...);
+    AddToIndex(std::prev(list_.end()));
+    return list_.back();
+  }
+
+  iterator erase(const_iterator pos) {
+    MarkModified();
+    auto found = index_.find((*pos).*Key);
+    if (found != index_.end() && found->second == pos) {
+      index_.erase(found);
+      iterator next = list_.erase(pos);
+      // Another element with the same key may now be the first one.
+      if (duplicates_ > 0) Reindex();
+      return next;
+    }
+    // |pos| is a duplicate, or its key was moved out before erasing it.
+    iterator next = list_.erase(pos);
+    Reindex();
+    return next;
+  }
+  void pop_front() { erase(list_.begin()); }
+  void pop_back() { erase(std::prev(list_.end())); }
+  void clear() {
+    MarkModified();
+    list_.clear();
+    index_.clear();
+    duplicates_ = 0;
+  }
+
+  template <typename Compare>
+  void sort(Compare comp) {
+    MarkModified();
+    list_.sort(comp);
+    if (duplicates_ > 0) Reindex();
+  }
+
+  // Records an in-place change to an element that this list cannot observe.
+  void MarkModified() { generation_ = NextGeneration(); }
+  uint64_t Generation() const { return generation_; }
+
+ private:
+  static uint64_t NextGeneration() {
+    static std::atomic<uint64_t> next_generation{1};
+    return next_generation.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void AddToIndex(iterator it) {
+    if (!index_.emplace((*it).*Key, it).second) duplicates_++;
+  }
+
+  void Reindex() {
+    index_.clear();
+    duplicates_ = 0;
+    for (iterator it = list_.begin(); it != list_.end(); ++it) AddToIndex(it);
+  }
+
+  void Reset() {
+    list_.clear();
+    index_.clear();
+    duplicates_ = 0;
+    MarkModified();
+  }
+
+  std::list<T> list_;
+  std::unordered_map<std::string, iterator> index_;
+  size_t duplicates_ = 0;
+  // Generation 0 is only ever used by empty, default constructed lists.
+  uint64_t generation_ = 0;
+};
+
 struct section_t {
   std::string name;
-  std::list<entry_t> entries;
+  IndexedList<entry_t, &entry_t::key> entries;
   void Set(std::string key, std::string value);
   std::list<entry_t>::iterator Find(const std::string& key);
   bool Has(const std::string& key);
+
+  // Returns the serialized "key = value" lines of this section. The text is
+  // cached and only re-rendered when |entries| changed since the last call.
+  const std::string& SerializedEntries() const;
+
+  mutable std::string serialized_cache;
+  mutable uint64_t serialized_generation = 0;
 };
 
 struct config_t {
-  std::list<section_t> sections;
+  IndexedList<section_t, &section_t::name> sections;
   std::list<section_t>::iterator Find(const std::string& section);
   bool Has(const std::string& section);
 };
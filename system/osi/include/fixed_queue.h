@@ -36,6 +36,24 @@ typedef void (*fixed_queue_cb)(fixed_queue_t* queue, void* context);
 // the returned queue with |fixed_queue_free|.
 fixed_queue_t* fixed_queue_new(size_t capacity);
 
+// Largest capacity accepted by |fixed_queue_new_spsc|.
+#define FIXED_QUEUE_SPSC_MAX_CAPACITY (1 << 16)
+
+// Creates a new fixed queue optimized for exactly one producer thread and one
+// consumer thread. Elements are kept in a lock-free ring of |capacity|
+// entries, and a dequeue registered with |fixed_queue_register_dequeue| is
+// woken once per burst of enqueues rather than once per element: the ready
+// callback is invoked repeatedly for as long as it keeps dequeuing. The ready
+// callback must not free the queue.
+//
+// |capacity| must be in the range [1, FIXED_QUEUE_SPSC_MAX_CAPACITY].
+// Enqueue and |fixed_queue_try_peek_last| may only be called from the producer
+// thread; dequeue, flush and |fixed_queue_try_peek_first| only from the
+// consumer thread. |fixed_queue_try_remove_from_queue| and
+// |fixed_queue_get_list| are not supported. Returns NULL on failure. The caller
+// must free the returned queue with |fixed_queue_free|.
+fixed_queue_t* fixed_queue_new_spsc(size_t capacity);
+
 // Frees a queue and (optionally) the enqueued elements.
 // |queue| is the queue to free. If the |free_cb| callback is not null,
 // it is called on each queue element to free it.
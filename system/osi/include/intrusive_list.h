@@ -0,0 +1,173 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "check.h"
+
+// An intrusive, doubly linked list. Unlike |list_t|, the list does not
+// allocate nodes: every element embeds a |list_link_t| and is linked through
+// it, so appending and removing never allocate and walking the list touches
+// the elements directly. Removal of a known element is O(1).
+//
+// The list does not own its elements and never frees them. An element may be
+// on at most one list per embedded link. The function names mirror the ones
+// in list.h so code using |list_t| can be migrated one list at a time:
+//
+//   struct tFOO {
+//     list_link_t link;
+//     int value;
+//   };
+//
+//   intrusive_list_t foos;
+//   intrusive_list_init(&foos);
+//   intrusive_list_append(&foos, &foo->link);
+//   for (list_link_t* l = intrusive_list_begin(&foos);
+//        l != intrusive_list_end(&foos); l = intrusive_list_next(l)) {
+//     tFOO* foo = INTRUSIVE_LIST_ENTRY(l, tFOO, link);
+//   }
+
+typedef struct list_link_t {
+  struct list_link_t* prev;
+  struct list_link_t* next;
+} list_link_t;
+
+typedef struct {
+  list_link_t head;  // Sentinel; |head.next| is the first element.
+  size_t length;
+} intrusive_list_t;
+
+// Returns the element of type |type| that embeds |link| as |member|.
+#define INTRUSIVE_LIST_ENTRY(link, type, member) \
+  ((type*)((char*)(link)-offsetof(type, member)))
+
+// Initializes |list| to the empty state. |list| may not be NULL.
+inline void intrusive_list_init(intrusive_list_t* list) {
+  CHECK(list != NULL);
+  list->head.prev = &list->head;
+  list->head.next = &list->head;
+  list->length = 0;
+}
+
+// Returns true if |link| is currently on a list. Links must be zero
+// initialized (or removed) before this can be used.
+inline bool intrusive_list_is_linked(const list_link_t* link) {
+  CHECK(link != NULL);
+  return link->next != NULL;
+}
+
+inline bool intrusive_list_is_empty(const intrusive_list_t* list) {
+  CHECK(list != NULL);
+  return list->length == 0;
+}
+
+inline size_t intrusive_list_length(const intrusive_list_t* list) {
+  CHECK(list != NULL);
+  return list->length;
+}
+
+// Returns the first link in |list|. |list| may not be empty.
+inline list_link_t* intrusive_list_front(const intrusive_list_t* list) {
+  CHECK(!intrusive_list_is_empty(list));
+  return list->head.next;
+}
+
+// Returns the last link in |list|. |list| may not be empty.
+inline list_link_t* intrusive_list_back(const intrusive_list_t* list) {
+  CHECK(!intrusive_list_is_empty(list));
+  return list->head.prev;
+}
+
+// Links |link| into |list| right after |prev_link|, which must be on |list|
+// (or be |intrusive_list_end|, to prepend). |link| must not be on any list.
+inline void intrusive_list_insert_after(intrusive_list_t* list,
+                                        list_link_t* prev_link,
+                                        list_link_t* link) {
+  CHECK(list != NULL);
+  CHECK(prev_link != NULL);
+  CHECK(link != NULL);
+  CHECK(!intrusive_list_is_linked(link));
+
+  link->prev = prev_link;
+  link->next = prev_link->next;
+  prev_link->next->prev = link;
+  prev_link->next = link;
+  ++list->length;
+}
+
+inline void intrusive_list_prepend(intrusive_list_t* list, list_link_t* link) {
+  intrusive_list_insert_after(list, &list->head, link);
+}
+
+inline void intrusive_list_append(intrusive_list_t* list, list_link_t* link) {
+  intrusive_list_insert_after(list, list->head.prev, link);
+}
+
+// Unlinks |link|, which must be on |list|, in constant time.
+inline void intrusive_list_remove(intrusive_list_t* list, list_link_t* link) {
+  CHECK(list != NULL);
+  CHECK(link != NULL);
+  CHECK(intrusive_list_is_linked(link));
+  CHECK(list->length > 0);
+
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->prev = NULL;
+  link->next = NULL;
+  --list->length;
+}
+
+// Returns true if |link| is on |list|. This walks the list; prefer
+// |intrusive_list_is_linked| when an element can only be on one list.
+inline bool intrusive_list_contains(const intrusive_list_t* list,
+                                    const list_link_t* link) {
+  CHECK(list != NULL);
+  for (const list_link_t* l = list->head.next; l != &list->head; l = l->next) {
+    if (l == link) return true;
+  }
+  return false;
+}
+
+// Iteration, in the same shape as |list_begin|/|list_end|/|list_next|. The
+// end marker is the sentinel, so it is never NULL.
+inline list_link_t* intrusive_list_begin(intrusive_list_t* list) {
+  CHECK(list != NULL);
+  return list->head.next;
+}
+
+inline list_link_t* intrusive_list_end(intrusive_list_t* list) {
+  CHECK(list != NULL);
+  return &list->head;
+}
+
+inline list_link_t* intrusive_list_next(const list_link_t* link) {
+  CHECK(link != NULL);
+  return link->next;
+}
+
+// Unlinks every element of |list| without touching the elements' storage
+// other than their links.
+inline void intrusive_list_clear(intrusive_list_t* list) {
+  CHECK(list != NULL);
+  while (!intrusive_list_is_empty(list)) {
+    intrusive_list_remove(list, intrusive_list_front(list));
+  }
+}
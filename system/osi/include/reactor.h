@@ -37,6 +37,15 @@ typedef enum {
                          // variants).
 } reactor_status_t;
 
+// Counters describing the work done by a reactor loop.
+typedef struct {
+  uint64_t wakeups;                // epoll_wait returns with ready events.
+  uint64_t events;                 // ready events dispatched in total.
+  uint64_t max_events_per_wakeup;  // largest single batch of ready events.
+  uint64_t callback_time_us;       // time spent in callbacks in total.
+  uint64_t max_callback_time_us;   // longest time spent handling one event.
+} reactor_stats_t;
+
 // Creates a new reactor object. Returns NULL on failure. The returned object
 // must be freed by calling |reactor_free|.
 reactor_t* reactor_new(void);
@@ -71,6 +80,17 @@ reactor_object_t* reactor_register(reactor_t* reactor, int fd, void* context,
                                    void (*read_ready)(void* context),
                                    void (*write_ready)(void* context));
 
+// Same as |reactor_register|, but the file descriptor is registered in
+// edge-triggered mode: a callback is only invoked when new readiness arrives,
+// once per wakeup, no matter how much data is pending. The callbacks must
+// therefore drain |fd| (e.g. read until EAGAIN on a non-blocking fd) before
+// returning, or remaining data will not be reported again. This saves one
+// loop iteration per pending item for objects that can consume a whole burst
+// at once.
+reactor_object_t* reactor_register_edge_triggered(
+    reactor_t* reactor, int fd, void* context,
+    void (*read_ready)(void* context), void (*write_ready)(void* context));
+
 // Changes the subscription mode for the file descriptor represented by
 // |object|. If the caller has already registered a file descriptor with a
 // reactor, has a valid |object|, and decides to change the |read_ready| and/or
@@ -81,6 +101,11 @@ bool reactor_change_registration(reactor_object_t* object,
                                  void (*read_ready)(void* context),
                                  void (*write_ready)(void* context));
 
+// Fills |stats| with the loop statistics of |reactor| since it was created.
+// This function is safe to call from any thread. Neither |reactor| nor |stats|
+// may be NULL.
+void reactor_get_stats(const reactor_t* reactor, reactor_stats_t* stats);
+
 // Unregisters a previously registered file descriptor with its reactor. |obj|
 // may not be NULL. |obj| is invalid after calling this function so the caller
 // must drop all references to it.
@@ -18,7 +18,10 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 typedef struct ringbuffer_t ringbuffer_t;
 
@@ -32,6 +35,14 @@ typedef struct ringbuffer_t ringbuffer_t;
 // using |ringbuffer_free|.
 ringbuffer_t* ringbuffer_init(const size_t size);
 
+// Create a ringbuffer of at least |size| bytes whose storage is mapped twice
+// back to back, so that spans returned by |ringbuffer_reserve| and
+// |ringbuffer_peek_span| never split at the wrap-around point. The size is
+// rounded up to a multiple of the page size. Falls back to a regular
+// ringbuffer if the mirrored mapping cannot be created; use
+// |ringbuffer_is_mirrored| to tell the two apart.
+ringbuffer_t* ringbuffer_init_mirrored(const size_t size);
+
 // Frees the ringbuffer structure and buffer
 // Save to call with NULL.
 void ringbuffer_free(ringbuffer_t* rb);
@@ -42,11 +53,32 @@ size_t ringbuffer_available(const ringbuffer_t* rb);
 // Returns size of data in buffer
 size_t ringbuffer_size(const ringbuffer_t* rb);
 
+// Returns true if the ringbuffer was created with the mirrored mapping
+bool ringbuffer_is_mirrored(const ringbuffer_t* rb);
+
 // Attempts to insert up to |length| bytes of data at |p| into the buffer
 // Return actual number of bytes added. Can be less than |length| if buffer
 // is full.
 size_t ringbuffer_insert(ringbuffer_t* rb, const uint8_t* p, size_t length);
 
+// Returns, in |span|, a pointer to contiguous free space at the tail of the
+// buffer that the caller may write into directly, and returns its length. The
+// data only becomes part of the buffer once |ringbuffer_commit| is called.
+// For mirrored buffers the length equals |ringbuffer_available|; otherwise it
+// may be shorter when the free space wraps around.
+size_t ringbuffer_reserve(ringbuffer_t* rb, uint8_t** span);
+
+// Appends |length| bytes written into the span returned by the last call to
+// |ringbuffer_reserve|. |length| must not exceed the reserved length.
+void ringbuffer_commit(ringbuffer_t* rb, size_t length);
+
+// Returns, in |span|, a pointer to contiguous data at the head of the buffer,
+// and returns its length. The span stays valid until the buffer is next
+// modified; call |ringbuffer_delete| to consume it. For mirrored buffers the
+// length equals |ringbuffer_size|; otherwise it may be shorter when the data
+// wraps around.
+size_t ringbuffer_peek_span(const ringbuffer_t* rb, const uint8_t** span);
+
 // Peek |length| number of bytes from the ringbuffer, starting at |offset|,
 // into the buffer |p|. Return the actual number of bytes peeked. Can be less
 // than |length| if there is less than |length| data available. |offset| must
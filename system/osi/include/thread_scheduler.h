@@ -16,5 +16,51 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <sys/types.h>
+
 bool thread_scheduler_enable_real_time(pid_t pid);
 bool thread_scheduler_get_priority_range(int& min, int& max);
+
+// A named scheduling profile. Threads request a profile by name instead of
+// hard coding a policy, so that the policy, priority and placement of each
+// stack thread can be tuned per device.
+//
+// The built-in profiles are:
+//   "default"          - SCHED_OTHER, nice 0
+//   "bt_main"          - the stack main thread
+//   "a2dp_source"      - the A2DP source media worker
+//   "a2dp_encoder"     - the A2DP source encoder worker of heavy codecs
+//   "a2dp_sink"        - the A2DP sink media worker
+//   "le_audio_worker"  - the LE audio HAL client worker
+//
+// Each profile can be overridden with the system property
+// "bluetooth.sched.<name>", formatted as
+//   <policy>[:<priority>[:<cpus>[:<timer_slack_ns>]]]
+// where <policy> is "other", "fifo" or "rr", <priority> is the real-time
+// priority (or the nice value for "other"), <cpus> is a CPU list such as
+// "0-3,6" (empty for no restriction) and <timer_slack_ns> is the timer slack
+// to apply to the thread (0 to leave it unchanged). For example:
+//   setprop bluetooth.sched.a2dp_source fifo:2:4-7
+typedef struct {
+  int policy;               // SCHED_OTHER, SCHED_FIFO or SCHED_RR
+  int priority;             // sched_priority, or the nice value for SCHED_OTHER
+  uint64_t cpu_mask;        // Allowed CPUs, bit N for CPU N; 0 for any CPU
+  uint64_t timer_slack_ns;  // Timer slack latency hint; 0 to leave unchanged
+} thread_scheduler_profile_t;
+
+// Looks up the effective profile |name|, including any system property
+// override, and stores it in |profile|. Returns false if |name| is unknown.
+// |name| and |profile| may not be NULL.
+bool thread_scheduler_get_profile(const char* name,
+                                  thread_scheduler_profile_t* profile);
+
+// Applies the profile |name| to the thread |linux_tid|, as returned by
+// gettid(). A |linux_tid| of 0 refers to the calling thread. Returns true if
+// the policy and priority were applied; failing to apply the CPU affinity or
+// the timer slack is logged but not fatal. The result is recorded for
+// |thread_scheduler_debug_dump|.
+bool thread_scheduler_apply_profile(pid_t linux_tid, const char* name);
+
+// Dumps the effective profiles and the threads they were applied to to |fd|.
+void thread_scheduler_debug_dump(int fd);
@@ -20,6 +20,7 @@
 
 #include <hardware/bluetooth.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Set the Bluetooth OS callouts to |callouts|.
 // This function should be called when native kernel wakelocks are not used
@@ -28,15 +29,44 @@
 void wakelock_set_os_callouts(bt_os_callouts_t* callouts);
 
 // Acquire the Bluetooth wakelock.
+// This is the same as |wakelock_acquire_for(WAKELOCK_REASON_DEFAULT)|.
 // The function is thread safe.
 // Return true on success, otherwise false.
 bool wakelock_acquire(void);
 
 // Release the Bluetooth wakelock.
+// This is the same as |wakelock_release_for(WAKELOCK_REASON_DEFAULT)|.
 // The function is thread safe.
 // Return true on success, otherwise false.
 bool wakelock_release(void);
 
+#define WAKELOCK_REASON_DEFAULT "default"
+
+// Acquire the Bluetooth wakelock on behalf of |reason|, e.g. "alarm" or
+// "a2dp_source". |reason| may not be NULL.
+// Each reason either holds the wakelock or not: acquiring again for a reason
+// that already holds it does nothing. The kernel wakelock is held for as long
+// as at least one reason holds it, so independent users no longer release
+// each other's wakelock.
+// The function is thread safe.
+// Return true if the kernel wakelock is held, otherwise false.
+bool wakelock_acquire_for(const char* reason);
+
+// Release the Bluetooth wakelock held on behalf of |reason|. Releasing a
+// reason that does not hold the wakelock does nothing. When the last reason
+// releases it, the kernel wakelock is kept for the linger window (see
+// |wakelock_set_linger_ms|) so that back-to-back bursts share one kernel
+// acquire/release pair. |reason| may not be NULL.
+// The function is thread safe.
+// Return true on success, otherwise false.
+bool wakelock_release_for(const char* reason);
+
+// Set how long the kernel wakelock is kept after the last reason releases
+// it. 0 releases it immediately. The default is read from the
+// "bluetooth.osi.wakelock.linger_ms" system property.
+// The function is thread safe.
+void wakelock_set_linger_ms(uint64_t linger_ms);
+
 // Cleanup the wakelock internal state.
 // This function should be called by the OSI module cleanup during
 // graceful shutdown.
@@ -30,13 +30,16 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
+#include <map>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "check.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
-#include "osi/include/list.h"
 #include "osi/include/osi.h"
 #include "osi/include/thread.h"
 #include "osi/include/wakelock.h"
@@ -49,6 +52,15 @@ using base::CancelableClosure;
 // Callback and timer threads should run at RT priority in order to ensure they
 // meet audio deadlines.  Use this priority for all audio/timer related thread.
 static const int THREAD_RT_PRIORITY = 1;
+// The callbacks of the media alarms preempt the other callbacks.
+static const int THREAD_MEDIA_RT_PRIORITY = 2;
+
+// A callback running later than this after its deadline is counted as a
+// deadline miss, per priority class.
+static const uint64_t DEADLINE_MISS_MS[] = {
+    50,  // ALARM_PRIORITY_DEFAULT
+    5,   // ALARM_PRIORITY_MEDIA
+};
 
 typedef struct {
   size_t count;
@@ -68,6 +80,13 @@ typedef struct {
   stat_t premature_scheduling;
 } alarm_stats_t;
 
+// Deadline misses of the callbacks of the alarms with the same name
+typedef struct {
+  size_t callback_count;
+  size_t missed_count;
+  uint64_t max_late_ms;
+} deadline_stats_t;
+
 /* Wrapper around CancellableClosure that let it be embedded in structs, without
  * need to define copy operator. */
 struct CancelableClosureInStruct {
@@ -92,13 +111,114 @@ struct alarm_t {
   uint64_t prev_deadline_ms;  // Previous deadline - used for accounting of
                               // periodic timers
   bool is_periodic;
+  alarm_priority_t priority;
   fixed_queue_t* queue;  // The processing queue to add this alarm to
   alarm_callback_t callback;
   void* data;
   alarm_stats_t stats;
+  deadline_stats_t* deadline_stats;  // Shared with the alarms of the same name
 
   bool for_msg_loop;  // True, if the alarm should be processed on message loop
   CancelableClosureInStruct closure;  // posted to message loop for processing
+
+  // Position in |alarms|, or kAlarmNotPending if the alarm is not queued.
+  size_t heap_index;
+  // Breaks deadline ties so that alarms with the same deadline expire in the
+  // order they were set.
+  uint64_t heap_sequence;
+};
+
+static const size_t kAlarmNotPending = SIZE_MAX;
+
+// Pending alarms, kept as a 4-ary min-heap ordered by deadline. Every alarm
+// stores its own position in the heap, so removing an arbitrary alarm does
+// not require a search. The earliest deadline is always at the root.
+class AlarmHeap {
+ public:
+  bool empty() const { return heap_.empty(); }
+  size_t size() const { return heap_.size(); }
+  alarm_t* front() const { return heap_.empty() ? NULL : heap_[0]; }
+
+  void push(alarm_t* alarm) {
+    CHECK(alarm->heap_index == kAlarmNotPending);
+    alarm->heap_sequence = next_sequence_++;
+    alarm->heap_index = heap_.size();
+    heap_.push_back(alarm);
+    sift_up(alarm->heap_index);
+  }
+
+  // Removes |alarm| if it is pending; does nothing otherwise.
+  void remove(alarm_t* alarm) {
+    size_t index = alarm->heap_index;
+    if (index == kAlarmNotPending) return;
+    CHECK(index < heap_.size() && heap_[index] == alarm);
+
+    alarm->heap_index = kAlarmNotPending;
+    alarm_t* last = heap_.back();
+    heap_.pop_back();
+    if (index == heap_.size()) return;
+
+    place(index, last);
+    if (index > 0 && less(last, heap_[parent(index)])) {
+      sift_up(index);
+    } else {
+      sift_down(index);
+    }
+  }
+
+  // Returns the pending alarms sorted by expiration order.
+  std::vector<alarm_t*> sorted() const {
+    std::vector<alarm_t*> ret(heap_);
+    std::sort(ret.begin(), ret.end(), less);
+    return ret;
+  }
+
+ private:
+  static const size_t kArity = 4;
+
+  static size_t parent(size_t index) { return (index - 1) / kArity; }
+
+  static bool less(const alarm_t* a, const alarm_t* b) {
+    if (a->deadline_ms != b->deadline_ms) return a->deadline_ms < b->deadline_ms;
+    return a->heap_sequence < b->heap_sequence;
+  }
+
+  void place(size_t index, alarm_t* alarm) {
+    heap_[index] = alarm;
+    alarm->heap_index = index;
+  }
+
+  void sift_up(size_t index) {
+    alarm_t* alarm = heap_[index];
+    while (index > 0) {
+      size_t p = parent(index);
+      if (!less(alarm, heap_[p])) break;
+      place(index, heap_[p]);
+      index = p;
+    }
+    place(index, alarm);
+  }
+
+  void sift_down(size_t index) {
+    alarm_t* alarm = heap_[index];
+    const size_t count = heap_.size();
+    while (true) {
+      size_t first_child = index * kArity + 1;
+      if (first_child >= count) break;
+      size_t last_child = std::min(first_child + kArity, count);
+      size_t smallest = first_child;
+      for (size_t c = first_child + 1; c < last_child; c++) {
+        if (less(heap_[c], heap_[smallest])) smallest = c;
+      }
+      if (!less(heap_[smallest], alarm)) break;
+      place(index, heap_[smallest]);
+      index = smallest;
+    }
+    place(index, alarm);
+  }
+
+  std::vector<alarm_t*> heap_;
+  uint64_t next_sequence_ = 0;
 };
 
 // If the next wakeup time is less than this threshold, we should acquire
@@ -110,9 +230,9 @@ static const clockid_t CLOCK_ID = CLOCK_BOOTTIME;
 
 // This mutex ensures that the |alarm_set|, |alarm_cancel|, and alarm callback
 // functions execute serially and not concurrently. As a result, this mutex
-// also protects the |alarms| list.
+// also protects the |alarms| heap.
 static std::mutex alarms_mutex;
-static list_t* alarms;
+static AlarmHeap* alarms;
 static timer_t timer;
 static timer_t wakeup_timer;
 static bool timer_set;
@@ -126,7 +246,20 @@ static semaphore_t* alarm_expired;
 static thread_t* default_callback_thread;
 static fixed_queue_t* default_callback_queue;
 
-static alarm_t* alarm_new_internal(const char* name, bool is_periodic);
+// Callback thread and queue of the ALARM_PRIORITY_MEDIA alarms
+static thread_t* media_callback_thread;
+static fixed_queue_t* media_callback_queue;
+
+// Deadline misses per alarm name. They are kept after the alarms are freed,
+// since most alarms only live while they are in use, and across
+// |alarm_cleanup| since the alarms point to them.
+static std::map<std::string, deadline_stats_t>& deadline_stats_by_name() {
+  static auto* deadline_stats = new std::map<std::string, deadline_stats_t>();
+  return *deadline_stats;
+}
+
+static alarm_t* alarm_new_internal(const char* name, bool is_periodic,
+                                   alarm_priority_t priority);
 static bool lazy_initialize(void);
 static uint64_t now_ms(void);
 static void alarm_set_internal(alarm_t* alarm, uint64_t period_ms,
@@ -142,6 +275,8 @@ static void callback_dispatch(void* context);
 static bool timer_create_internal(const clockid_t clock_id, timer_t* timer);
 static void update_scheduling_stats(alarm_stats_t* stats, uint64_t now_ms,
                                     uint64_t deadline_ms);
+static void update_deadline_stats(alarm_t* alarm, uint64_t now_ms,
+                                  uint64_t deadline_ms);
 // Registers |queue| for processing alarm callbacks on |thread|.
 // |queue| may not be NULL. |thread| may not be NULL.
 static void alarm_register_processing_queue(fixed_queue_t* queue,
@@ -153,13 +288,21 @@ static void update_stat(stat_t* stat, uint64_t delta_ms) {
   stat->count++;
 }
 
-alarm_t* alarm_new(const char* name) { return alarm_new_internal(name, false); }
+alarm_t* alarm_new(const char* name) {
+  return alarm_new_internal(name, false, ALARM_PRIORITY_DEFAULT);
+}
 
 alarm_t* alarm_new_periodic(const char* name) {
-  return alarm_new_internal(name, true);
+  return alarm_new_internal(name, true, ALARM_PRIORITY_DEFAULT);
+}
+
+alarm_t* alarm_new_with_priority(const char* name, bool is_periodic,
+                                 alarm_priority_t priority) {
+  return alarm_new_internal(name, is_periodic, priority);
 }
 
-static alarm_t* alarm_new_internal(const char* name, bool is_periodic) {
+static alarm_t* alarm_new_internal(const char* name, bool is_periodic,
+                                   alarm_priority_t priority) {
   // Make sure we have a list we can insert alarms into.
   if (!alarms && !lazy_initialize()) {
     CHECK(false);  // if initialization failed, we should not continue
@@ -171,9 +314,15 @@ static alarm_t* alarm_new_internal(const char* name, bool is_periodic) {
   std::shared_ptr<std::recursive_mutex> ptr(new std::recursive_mutex());
   ret->callback_mutex = ptr;
   ret->is_periodic = is_periodic;
+  ret->priority = priority;
   ret->stats.name = osi_strdup(name);
+  {
+    std::lock_guard<std::mutex> lock(alarms_mutex);
+    ret->deadline_stats = &deadline_stats_by_name()[name];
+  }
 
   ret->for_msg_loop = false;
+  ret->heap_index = kAlarmNotPending;
   // placement new
   new (&ret->closure) CancelableClosureInStruct();
 
@@ -207,8 +356,11 @@ uint64_t alarm_get_remaining_ms(const alarm_t* alarm) {
 
 void alarm_set(alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
                void* data) {
-  alarm_set_internal(alarm, interval_ms, cb, data, default_callback_queue,
-                     false);
+  CHECK(alarm != NULL);
+  fixed_queue_t* queue = (alarm->priority == ALARM_PRIORITY_MEDIA)
+                             ? media_callback_queue
+                             : default_callback_queue;
+  alarm_set_internal(alarm, interval_ms, cb, data, queue, false);
 }
 
 void alarm_set_on_mloop(alarm_t* alarm, uint64_t interval_ms,
@@ -255,8 +407,7 @@ void alarm_cancel(alarm_t* alarm) {
 // Internal implementation of canceling an alarm.
 // The caller must hold the |alarms_mutex|
 static void alarm_cancel_internal(alarm_t* alarm) {
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarms->front() == alarm);
 
   remove_pending_alarm(alarm);
 
@@ -291,12 +442,17 @@ void alarm_cleanup(void) {
   thread_free(default_callback_thread);
   default_callback_thread = NULL;
 
+  fixed_queue_free(media_callback_queue, NULL);
+  media_callback_queue = NULL;
+  thread_free(media_callback_thread);
+  media_callback_thread = NULL;
+
   timer_delete(wakeup_timer);
   timer_delete(timer);
   semaphore_free(alarm_expired);
   alarm_expired = NULL;
 
-  list_free(alarms);
+  delete alarms;
   alarms = NULL;
 }
 
@@ -310,11 +466,7 @@ static bool lazy_initialize(void) {
 
   std::lock_guard<std::mutex> lock(alarms_mutex);
 
-  alarms = list_new(NULL);
-  if (!alarms) {
-    LOG_ERROR("%s unable to allocate alarm list.", __func__);
-    goto error;
-  }
+  alarms = new AlarmHeap();
 
   if (!timer_create_internal(CLOCK_ID, &timer)) goto error;
   timer_initialized = true;
@@ -347,6 +499,19 @@ static bool lazy_initialize(void) {
   alarm_register_processing_queue(default_callback_queue,
                                   default_callback_thread);
 
+  media_callback_thread = thread_new_sized("alarm_media_callbacks", SIZE_MAX);
+  if (media_callback_thread == NULL) {
+    LOG_ERROR("%s unable to create media alarm callbacks thread.", __func__);
+    goto error;
+  }
+  thread_set_rt_priority(media_callback_thread, THREAD_MEDIA_RT_PRIORITY);
+  media_callback_queue = fixed_queue_new(SIZE_MAX);
+  if (media_callback_queue == NULL) {
+    LOG_ERROR("%s unable to create media alarm callbacks queue.", __func__);
+    goto error;
+  }
+  alarm_register_processing_queue(media_callback_queue, media_callback_thread);
+
   dispatcher_thread_active = true;
   dispatcher_thread = thread_new("alarm_dispatcher");
   if (!dispatcher_thread) {
@@ -363,6 +528,11 @@ error:
   thread_free(default_callback_thread);
   default_callback_thread = NULL;
 
+  fixed_queue_free(media_callback_queue, NULL);
+  media_callback_queue = NULL;
+  thread_free(media_callback_thread);
+  media_callback_thread = NULL;
+
   thread_free(dispatcher_thread);
   dispatcher_thread = NULL;
 
@@ -375,7 +545,7 @@ error:
 
   if (timer_initialized) timer_delete(timer);
 
-  list_free(alarms);
+  delete alarms;
   alarms = NULL;
 
   return false;
@@ -393,10 +563,10 @@ static uint64_t now_ms(void) {
   return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000LL);
 }
 
-// Remove alarm from internal alarm list and the processing queue
+// Remove alarm from internal alarm heap and the processing queue
 // The caller must hold the |alarms_mutex|
 static void remove_pending_alarm(alarm_t* alarm) {
-  list_remove(alarms, alarm);
+  alarms->remove(alarm);
 
   if (alarm->for_msg_loop) {
     alarm->closure.i.Cancel();
@@ -411,10 +581,9 @@ static void remove_pending_alarm(alarm_t* alarm) {
 
 // Must be called with |alarms_mutex| held
 static void schedule_next_instance(alarm_t* alarm) {
-  // If the alarm is currently set and it's at the start of the list,
+  // If the alarm is currently set and it's at the root of the heap,
   // we'll need to re-schedule since we've adjusted the earliest deadline.
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarms->front() == alarm);
   if (alarm->callback) remove_pending_alarm(alarm);
 
   // Calculate the next deadline for this alarm
@@ -425,26 +594,12 @@ static void schedule_next_instance(alarm_t* alarm) {
         ((just_now_ms - alarm->creation_time_ms) % alarm->period_ms);
   alarm->deadline_ms = just_now_ms + (alarm->period_ms - ms_into_period);
 
-  // Add it into the timer list sorted by deadline (earliest deadline first).
-  if (list_is_empty(alarms) ||
-      ((alarm_t*)list_front(alarms))->deadline_ms > alarm->deadline_ms) {
-    list_prepend(alarms, alarm);
-  } else {
-    for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-         node = list_next(node)) {
-      list_node_t* next = list_next(node);
-      if (next == list_end(alarms) ||
-          ((alarm_t*)list_node(next))->deadline_ms > alarm->deadline_ms) {
-        list_insert_after(alarms, node, alarm);
-        break;
-      }
-    }
-  }
+  // Add it into the timer heap ordered by deadline (earliest deadline first).
+  alarms->push(alarm);
 
   // If the new alarm has the earliest deadline, we need to re-evaluate our
   // schedule.
-  if (needs_reschedule ||
-      (!list_is_empty(alarms) && list_front(alarms) == alarm)) {
+  if (needs_reschedule || alarms->front() == alarm) {
     reschedule_root_alarm();
   }
 }
@@ -461,13 +616,13 @@ static void reschedule_root_alarm(void) {
   struct itimerspec timer_time;
   memset(&timer_time, 0, sizeof(timer_time));
 
-  if (list_is_empty(alarms)) goto done;
+  if (alarms->empty()) goto done;
 
-  next = static_cast<alarm_t*>(list_front(alarms));
+  next = alarms->front();
   next_expiration = next->deadline_ms - now_ms();
   if (next_expiration < TIMER_INTERVAL_FOR_WAKELOCK_IN_MS) {
     if (!timer_set) {
-      if (!wakelock_acquire()) {
+      if (!wakelock_acquire_for("alarm")) {
         LOG_ERROR("%s unable to acquire wake lock", __func__);
       }
     }
@@ -508,7 +663,7 @@ done:
   timer_set =
       timer_time.it_value.tv_sec != 0 || timer_time.it_value.tv_nsec != 0;
   if (timer_was_set && !timer_set) {
-    wakelock_release();
+    wakelock_release_for("alarm");
   }
 
   if (timer_settime(timer, TIMER_ABSTIME, &timer_time, NULL) == -1)
@@ -580,10 +735,12 @@ static void alarm_ready_generic(alarm_t* alarm,
   // before the callback gets finished executing.
   std::shared_ptr<std::recursive_mutex> local_mutex_ref = alarm->callback_mutex;
   std::lock_guard<std::recursive_mutex> cb_lock(*local_mutex_ref);
-  lock.unlock();
 
   // Update the statistics
-  update_scheduling_stats(&alarm->stats, now_ms(), deadline_ms);
+  uint64_t just_now_ms = now_ms();
+  update_deadline_stats(alarm, just_now_ms, deadline_ms);
+  lock.unlock();
+  update_scheduling_stats(&alarm->stats, just_now_ms, deadline_ms);
 
   // NOTE: Do NOT access "alarm" after the callback, as a safety precaution
   // in case the callback itself deleted the alarm.
@@ -623,14 +780,12 @@ static void callback_dispatch(UNUSED_ATTR void* context) {
     // Take into account that the alarm may get cancelled before we get to it.
     // We're done here if there are no alarms or the alarm at the front is in
     // the future. Exit right away since there's nothing left to do.
-    if (list_is_empty(alarms) ||
-        (alarm = static_cast<alarm_t*>(list_front(alarms)))->deadline_ms >
-            now_ms()) {
+    if (alarms->empty() || (alarm = alarms->front())->deadline_ms > now_ms()) {
       reschedule_root_alarm();
       continue;
     }
 
-    list_remove(alarms, alarm);
+    alarms->remove(alarm);
 
     if (alarm->is_periodic) {
       alarm->prev_deadline_ms = alarm->deadline_ms;
@@ -708,6 +863,18 @@ static void update_scheduling_stats(alarm_stats_t* stats, uint64_t now_ms,
   }
 }
 
+// The caller must hold the |alarms_mutex|
+static void update_deadline_stats(alarm_t* alarm, uint64_t now_ms,
+                                  uint64_t deadline_ms) {
+  deadline_stats_t* stats = alarm->deadline_stats;
+  stats->callback_count++;
+  if (now_ms <= deadline_ms + DEADLINE_MISS_MS[alarm->priority]) return;
+
+  uint64_t late_ms = now_ms - deadline_ms;
+  stats->missed_count++;
+  if (stats->max_late_ms < late_ms) stats->max_late_ms = late_ms;
+}
+
 static void dump_stat(int fd, stat_t* stat, const char* description) {
   uint64_t average_time_ms = 0;
   if (stat->count != 0) average_time_ms = stat->total_ms / stat->count;
@@ -729,16 +896,15 @@ void alarm_debug_dump(int fd) {
 
   uint64_t just_now_ms = now_ms();
 
-  dprintf(fd, "  Total Alarms: %zu\n\n", list_length(alarms));
+  dprintf(fd, "  Total Alarms: %zu\n\n", alarms->size());
 
   // Dump info for each alarm
-  for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-       node = list_next(node)) {
-    alarm_t* alarm = (alarm_t*)list_node(node);
+  for (alarm_t* alarm : alarms->sorted()) {
     alarm_stats_t* stats = &alarm->stats;
 
-    dprintf(fd, "  Alarm : %s (%s)\n", stats->name,
-            (alarm->is_periodic) ? "PERIODIC" : "SINGLE");
+    dprintf(fd, "  Alarm : %s (%s%s)\n", stats->name,
+            (alarm->is_periodic) ? "PERIODIC" : "SINGLE",
+            (alarm->priority == ALARM_PRIORITY_MEDIA) ? ", MEDIA" : "");
 
     dprintf(fd, "%-51s: %zu / %zu / %zu / %zu\n",
             "    Action counts (sched/resched/exec/cancel)",
@@ -763,4 +929,16 @@ void alarm_debug_dump(int fd) {
 
     dprintf(fd, "\n");
   }
+
+  dprintf(fd,
+          "  Deadline misses (late by more than %llu / %llu ms, "
+          "default/media):\n",
+          (unsigned long long)DEADLINE_MISS_MS[ALARM_PRIORITY_DEFAULT],
+          (unsigned long long)DEADLINE_MISS_MS[ALARM_PRIORITY_MEDIA]);
+  for (const auto& [name, stats] : deadline_stats_by_name()) {
+    if (stats.missed_count == 0) continue;
+    dprintf(fd, "    %-47s: %zu / %zu missed, max late %llu ms\n",
+            name.c_str(), stats.missed_count, stats.callback_count,
+            (unsigned long long)stats.max_late_ms);
+  }
 }
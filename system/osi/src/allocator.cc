@@ -18,10 +18,446 @@
 #include "osi/include/allocator.h"
 
 #include <base/logging.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include "check.h"
+#include "osi/include/properties.h"
+
+// The slab allocator hides use-after-free and overflow bugs from the
+// sanitizers, so it is compiled out for instrumented builds.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(hwaddress_sanitizer)
+#define OSI_SLAB_ALLOCATOR_SANITIZED 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define OSI_SLAB_ALLOCATOR_SANITIZED 1
+#endif
+
+#ifndef OSI_SLAB_ALLOCATOR_ENABLED
+#ifdef OSI_SLAB_ALLOCATOR_SANITIZED
+#define OSI_SLAB_ALLOCATOR_ENABLED 0
+#else
+#define OSI_SLAB_ALLOCATOR_ENABLED 1
+#endif
+#endif
+
+namespace {
+
+// Runtime switch to fall back to plain malloc. Read once on first use.
+constexpr char kSlabAllocatorProperty[] = "bluetooth.osi.slab_allocator.enabled";
+
+// Block sizes, chosen to fit the buffers allocated on the data paths:
+// BT_HDR plus headroom for small control PDUs, SBC frames and the L2CAP LE
+// MTU (BT_SMALL_BUFFER_SIZE), a full ACL packet (1021 bytes + HCI and BT_HDR
+// headers) and BT_DEFAULT_BUFFER_SIZE.
+constexpr size_t kSlabClassSizes[] = {32,  64,   128,  256, 512,
+                                      704, 1056, 2048, 4112};
+constexpr size_t kSlabNumClasses =
+    sizeof(kSlabClassSizes) / sizeof(kSlabClassSizes[0]);
+static_assert(kSlabNumClasses == OSI_SLAB_NUM_CLASSES,
+              "OSI_SLAB_NUM_CLASSES out of sync with the size class table");
+
+// Virtual address space reserved per class. Pages are only committed when a
+// block is first handed out; once a class region is exhausted allocations of
+// that class overflow to malloc.
+constexpr size_t kSlabRegionSize = 1024 * 1024;
+
+// Maximum number of free blocks a thread keeps per class, and how many blocks
+// move between the thread cache and the shared free list at once.
+constexpr size_t kThreadCacheMax = 64;
+constexpr size_t kThreadCacheBatch = 16;
+
+struct free_block_t {
+  free_block_t* next;
+};
+
+struct slab_class_t {
+  std::mutex lock;
+  free_block_t* free_list = nullptr;
+  uint8_t* bump = nullptr;
+  uint8_t* end = nullptr;
+  // Heap accounting tag of each block of the class region.
+  uint8_t* tags = nullptr;
+
+  std::atomic<size_t> in_use{0};
+  std::atomic<size_t> high_water_mark{0};
+  std::atomic<size_t> allocations{0};
+  std::atomic<size_t> overflows{0};
+};
+
+struct slab_arena_t {
+  uint8_t* base = nullptr;
+  slab_class_t classes[kSlabNumClasses];
+};
+
+struct thread_cache_t {
+  free_block_t* head[kSlabNumClasses] = {};
+  size_t count[kSlabNumClasses] = {};
+  ~thread_cache_t();
+};
+
+// Never destroyed, so that blocks freed from static destructors or from thread
+// exit after main() has returned still have somewhere to go.
+slab_arena_t* arena = nullptr;
+std::once_flag arena_once;
+
+thread_local thread_cache_t thread_cache;
+// Trivially destructible so it stays readable after |thread_cache| is gone.
+thread_local bool thread_cache_destroyed = false;
+
+// Runtime switch of the per-tag heap accounting. Read once on first use.
+constexpr char kAllocTagsProperty[] = "bluetooth.osi.alloc_tags.enabled";
+
+constexpr const char* kAllocTagNames[] = {
+    "other",  "hci", "l2cap", "gatt",     "a2dp", "avrcp",
+    "rfcomm", "sdp", "scan",  "le_audio", "btif",
+};
+static_assert(sizeof(kAllocTagNames) / sizeof(kAllocTagNames[0]) ==
+                  OSI_ALLOC_TAG_COUNT,
+              "kAllocTagNames out of sync with osi_alloc_tag_t");
+
+struct alloc_tag_rule_t {
+  const char* path;
+  osi_alloc_tag_t tag;
+};
+
+// Matched in order against the path of the calling source file.
+constexpr alloc_tag_rule_t kAllocTagRules[] = {
+    {"btif/src/btif_a2dp", OSI_ALLOC_TAG_A2DP},
+    {"btif/src/btif_av", OSI_ALLOC_TAG_A2DP},
+    {"btif/src/btif_rc", OSI_ALLOC_TAG_AVRCP},
+    {"btif/src/btif_le_audio", OSI_ALLOC_TAG_LE_AUDIO},
+    {"btif/", OSI_ALLOC_TAG_BTIF},
+    {"hci/", OSI_ALLOC_TAG_HCI},
+    {"stack/btu/", OSI_ALLOC_TAG_HCI},
+    {"stack/l2cap/", OSI_ALLOC_TAG_L2CAP},
+    {"stack/gatt/", OSI_ALLOC_TAG_GATT},
+    {"stack/eatt/", OSI_ALLOC_TAG_GATT},
+    {"bta/gatt/", OSI_ALLOC_TAG_GATT},
+    {"stack/a2dp/", OSI_ALLOC_TAG_A2DP},
+    {"stack/avdt/", OSI_ALLOC_TAG_A2DP},
+    {"bta/av/", OSI_ALLOC_TAG_A2DP},
+    {"stack/avrc/", OSI_ALLOC_TAG_AVRCP},
+    {"profile/avrcp/", OSI_ALLOC_TAG_AVRCP},
+    {"stack/rfcomm/", OSI_ALLOC_TAG_RFCOMM},
+    {"stack/sdp/", OSI_ALLOC_TAG_SDP},
+    {"stack/btm/btm_ble_gap", OSI_ALLOC_TAG_SCAN},
+    {"stack/btm/btm_ble_batchscan", OSI_ALLOC_TAG_SCAN},
+    {"stack/btm/btm_inq", OSI_ALLOC_TAG_SCAN},
+    {"bta/le_audio/", OSI_ALLOC_TAG_LE_AUDIO},
+};
+
+// A thread publishes the counters of a tag once they hold this many bytes or
+// allocations, which bounds how stale the published totals are.
+constexpr int64_t kAllocTagFlushBytes = 16 * 1024;
+constexpr uint32_t kAllocTagFlushAllocations = 256;
+
+// Size of the per-thread cache of the tag of each calling source file.
+constexpr size_t kAllocTagCacheSize = 64;
+
+struct alloc_tag_totals_t {
+  std::atomic<int64_t> live_bytes{0};
+  std::atomic<int64_t> peak_bytes{0};
+  std::atomic<uint64_t> allocations{0};
+};
+
+struct thread_tag_stats_t {
+  int64_t live_bytes[OSI_ALLOC_TAG_COUNT] = {};
+  uint32_t allocations[OSI_ALLOC_TAG_COUNT] = {};
+  ~thread_tag_stats_t();
+};
+
+struct alloc_tag_cache_entry_t {
+  const char* file;
+  osi_alloc_tag_t tag;
+};
+
+alloc_tag_totals_t alloc_tag_totals[OSI_ALLOC_TAG_COUNT];
+
+thread_local thread_tag_stats_t thread_tag_stats;
+thread_local bool thread_tag_stats_destroyed = false;
+thread_local alloc_tag_cache_entry_t alloc_tag_cache[kAllocTagCacheSize];
+
+// Tag and size of the live allocations served by malloc, which carry no
+// header. Never destroyed, like |arena|.
+std::mutex malloc_tags_lock;
+std::unordered_map<void*, std::pair<osi_alloc_tag_t, size_t>>* malloc_tags =
+    nullptr;
+
+bool alloc_tags_enabled() {
+  static const bool enabled = osi_property_get_bool(kAllocTagsProperty, true);
+  return enabled;
+}
+
+osi_alloc_tag_t alloc_tag_lookup(const char* file) {
+  for (const auto& rule : kAllocTagRules) {
+    if (strstr(file, rule.path) != nullptr) return rule.tag;
+  }
+  return OSI_ALLOC_TAG_OTHER;
+}
+
+// |file| comes from __builtin_FILE(), so each source file passes the same
+// pointer on every call.
+osi_alloc_tag_t alloc_tag_for_file(const char* file) {
+  if (file == nullptr) return OSI_ALLOC_TAG_OTHER;
+  alloc_tag_cache_entry_t& entry =
+      alloc_tag_cache[(reinterpret_cast<uintptr_t>(file) >> 4) %
+                      kAllocTagCacheSize];
+  if (entry.file != file) {
+    entry.file = file;
+    entry.tag = alloc_tag_lookup(file);
+  }
+  return entry.tag;
+}
+
+void alloc_tag_publish(size_t tag, int64_t live_bytes, uint32_t allocations) {
+  alloc_tag_totals_t& t = alloc_tag_totals[tag];
+  t.allocations.fetch_add(allocations, std::memory_order_relaxed);
+  int64_t live =
+      t.live_bytes.fetch_add(live_bytes, std::memory_order_relaxed) +
+      live_bytes;
+  int64_t peak = t.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !t.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void alloc_tag_flush(thread_tag_stats_t& s, size_t tag) {
+  alloc_tag_publish(tag, s.live_bytes[tag], s.allocations[tag]);
+  s.live_bytes[tag] = 0;
+  s.allocations[tag] = 0;
+}
+
+thread_tag_stats_t::~thread_tag_stats_t() {
+  thread_tag_stats_destroyed = true;
+  for (size_t i = 0; i < OSI_ALLOC_TAG_COUNT; i++) {
+    alloc_tag_flush(*this, i);
+  }
+}
+
+// Adds |bytes| (negative when freed) to the live bytes of |tag|.
+void alloc_tag_account(size_t tag, int64_t bytes) {
+  uint32_t allocations = bytes > 0 ? 1 : 0;
+  if (thread_tag_stats_destroyed) {
+    alloc_tag_publish(tag, bytes, allocations);
+    return;
+  }
+  thread_tag_stats_t& s = thread_tag_stats;
+  s.live_bytes[tag] += bytes;
+  s.allocations[tag] += allocations;
+  if (s.live_bytes[tag] >= kAllocTagFlushBytes ||
+      s.live_bytes[tag] <= -kAllocTagFlushBytes ||
+      s.allocations[tag] >= kAllocTagFlushAllocations) {
+    alloc_tag_flush(s, tag);
+  }
+}
+
+void malloc_tag_track(void* ptr, osi_alloc_tag_t tag, size_t size) {
+  if (!alloc_tags_enabled()) return;
+  {
+    std::lock_guard<std::mutex> lock(malloc_tags_lock);
+    if (malloc_tags == nullptr) {
+      malloc_tags =
+          new std::unordered_map<void*, std::pair<osi_alloc_tag_t, size_t>>();
+    }
+    (*malloc_tags)[ptr] = {tag, size};
+  }
+  alloc_tag_account(tag, size);
+}
+
+// Buffers from libc that never went through osi_malloc are ignored.
+void malloc_tag_untrack(void* ptr) {
+  if (!alloc_tags_enabled()) return;
+  std::pair<osi_alloc_tag_t, size_t> tag_and_size;
+  {
+    std::lock_guard<std::mutex> lock(malloc_tags_lock);
+    if (malloc_tags == nullptr) return;
+    auto it = malloc_tags->find(ptr);
+    if (it == malloc_tags->end()) return;
+    tag_and_size = it->second;
+    malloc_tags->erase(it);
+  }
+  alloc_tag_account(tag_and_size.first,
+                    -static_cast<int64_t>(tag_and_size.second));
+}
+
+void slab_arena_init() {
+  if (!OSI_SLAB_ALLOCATOR_ENABLED) return;
+  if (!osi_property_get_bool(kSlabAllocatorProperty, true)) return;
+
+  void* base = mmap(nullptr, kSlabRegionSize * kSlabNumClasses,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) return;
+
+  slab_arena_t* new_arena = new slab_arena_t();
+  new_arena->base = static_cast<uint8_t*>(base);
+  for (size_t i = 0; i < kSlabNumClasses; i++) {
+    new_arena->classes[i].bump = new_arena->base + i * kSlabRegionSize;
+    new_arena->classes[i].end = new_arena->classes[i].bump + kSlabRegionSize;
+    new_arena->classes[i].tags =
+        new uint8_t[kSlabRegionSize / kSlabClassSizes[i]]();
+  }
+  arena = new_arena;
+}
+
+inline slab_arena_t* slab_arena() {
+  std::call_once(arena_once, slab_arena_init);
+  return arena;
+}
+
+inline size_t slab_class_for_size(size_t size) {
+  for (size_t i = 0; i < kSlabNumClasses; i++) {
+    if (size <= kSlabClassSizes[i]) return i;
+  }
+  return kSlabNumClasses;
+}
+
+// Returns the class owning |ptr|, or kSlabNumClasses if |ptr| did not come
+// from the arena.
+inline size_t slab_class_for_ptr(const slab_arena_t* a, const void* ptr) {
+  const uint8_t* p = static_cast<const uint8_t*>(ptr);
+  if (p < a->base || p >= a->base + kSlabRegionSize * kSlabNumClasses) {
+    return kSlabNumClasses;
+  }
+  return (p - a->base) / kSlabRegionSize;
+}
+
+void slab_account_alloc(slab_class_t& c) {
+  c.allocations.fetch_add(1, std::memory_order_relaxed);
+  size_t in_use = c.in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t hwm = c.high_water_mark.load(std::memory_order_relaxed);
+  while (in_use > hwm && !c.high_water_mark.compare_exchange_weak(
+                             hwm, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+// Moves up to kThreadCacheBatch blocks of class |idx| from the shared free
+// list (or fresh arena space) into the calling thread's cache.
+void slab_refill(slab_arena_t* a, size_t idx) {
+  slab_class_t& c = a->classes[idx];
+  std::lock_guard<std::mutex> lock(c.lock);
+  for (size_t n = 0; n < kThreadCacheBatch; n++) {
+    free_block_t* block = c.free_list;
+    if (block != nullptr) {
+      c.free_list = block->next;
+    } else if (c.bump + kSlabClassSizes[idx] <= c.end) {
+      block = reinterpret_cast<free_block_t*>(c.bump);
+      c.bump += kSlabClassSizes[idx];
+    } else {
+      break;
+    }
+    block->next = thread_cache.head[idx];
+    thread_cache.head[idx] = block;
+    thread_cache.count[idx]++;
+  }
+}
+
+void slab_release_to_shared(slab_arena_t* a, size_t idx, free_block_t* first,
+                            free_block_t* last) {
+  slab_class_t& c = a->classes[idx];
+  std::lock_guard<std::mutex> lock(c.lock);
+  last->next = c.free_list;
+  c.free_list = first;
+}
+
+// Returns |count| blocks from the head of the thread cache to the shared list.
+void slab_flush(slab_arena_t* a, size_t idx, size_t count) {
+  free_block_t* first = thread_cache.head[idx];
+  free_block_t* last = first;
+  for (size_t n = 1; n < count; n++) last = last->next;
+  thread_cache.head[idx] = last->next;
+  thread_cache.count[idx] -= count;
+  slab_release_to_shared(a, idx, first, last);
+}
+
+thread_cache_t::~thread_cache_t() {
+  thread_cache_destroyed = true;
+  if (arena == nullptr) return;
+  for (size_t i = 0; i < kSlabNumClasses; i++) {
+    if (count[i] > 0) slab_flush(arena, i, count[i]);
+  }
+}
+
+// Index of |ptr| among the blocks of class |idx|.
+inline size_t slab_block_index(const slab_arena_t* a, size_t idx,
+                               const void* ptr) {
+  const uint8_t* p = static_cast<const uint8_t*>(ptr);
+  return (p - (a->base + idx * kSlabRegionSize)) / kSlabClassSizes[idx];
+}
+
+void* slab_alloc(size_t size, osi_alloc_tag_t tag) {
+  slab_arena_t* a = slab_arena();
+  if (a == nullptr) return nullptr;
+  size_t idx = slab_class_for_size(size);
+  if (idx == kSlabNumClasses) return nullptr;
+
+  slab_class_t& c = a->classes[idx];
+  free_block_t* block = nullptr;
+  if (thread_cache_destroyed) {
+    std::lock_guard<std::mutex> lock(c.lock);
+    if (c.free_list != nullptr) {
+      block = c.free_list;
+      c.free_list = block->next;
+    }
+  } else {
+    if (thread_cache.head[idx] == nullptr) slab_refill(a, idx);
+    block = thread_cache.head[idx];
+    if (block != nullptr) {
+      thread_cache.head[idx] = block->next;
+      thread_cache.count[idx]--;
+    }
+  }
+
+  if (block == nullptr) {
+    c.overflows.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  slab_account_alloc(c);
+  if (alloc_tags_enabled()) {
+    c.tags[slab_block_index(a, idx, block)] = tag;
+    alloc_tag_account(tag, kSlabClassSizes[idx]);
+  }
+  return block;
+}
+
+// Returns false if |ptr| does not belong to the slab arena.
+bool slab_free(void* ptr) {
+  slab_arena_t* a = arena;
+  if (a == nullptr) return false;
+  size_t idx = slab_class_for_ptr(a, ptr);
+  if (idx == kSlabNumClasses) return false;
+
+  a->classes[idx].in_use.fetch_sub(1, std::memory_order_relaxed);
+  if (alloc_tags_enabled()) {
+    alloc_tag_account(a->classes[idx].tags[slab_block_index(a, idx, ptr)],
+                      -static_cast<int64_t>(kSlabClassSizes[idx]));
+  }
+  free_block_t* block = static_cast<free_block_t*>(ptr);
+  if (thread_cache_destroyed) {
+    slab_release_to_shared(a, idx, block, block);
+    return true;
+  }
+
+  block->next = thread_cache.head[idx];
+  thread_cache.head[idx] = block;
+  if (++thread_cache.count[idx] > kThreadCacheMax) {
+    slab_flush(a, idx, kThreadCacheBatch);
+  }
+  return true;
+}
+
+}  // namespace
 
 char* osi_strdup(const char* str) {
   size_t size = strlen(str) + 1;  // + 1 for the null terminator
@@ -48,21 +484,49 @@ char* osi_strndup(const char* str, size_t len) {
   return new_string;
 }
 
-void* osi_malloc(size_t size) {
+void* osi_malloc_tagged(osi_alloc_tag_t tag, size_t size) {
   CHECK(static_cast<ssize_t>(size) >= 0);
-  void* ptr = malloc(size);
+  void* ptr = slab_alloc(size, tag);
+  if (ptr != nullptr) return ptr;
+  ptr = malloc(size);
   CHECK(ptr);
+  malloc_tag_track(ptr, tag, size);
   return ptr;
 }
 
-void* osi_calloc(size_t size) {
+void* osi_calloc_tagged(osi_alloc_tag_t tag, size_t size) {
   CHECK(static_cast<ssize_t>(size) >= 0);
-  void* ptr = calloc(1, size);
+  void* ptr = slab_alloc(size, tag);
+  if (ptr != nullptr) {
+    memset(ptr, 0, size);
+    return ptr;
+  }
+  ptr = calloc(1, size);
   CHECK(ptr);
+  malloc_tag_track(ptr, tag, size);
   return ptr;
 }
 
-void osi_free(void* ptr) { free(ptr); }
+void* osi_malloc(size_t size, const char* caller_file) {
+  return osi_malloc_tagged(alloc_tags_enabled()
+                               ? alloc_tag_for_file(caller_file)
+                               : OSI_ALLOC_TAG_OTHER,
+                           size);
+}
+
+void* osi_calloc(size_t size, const char* caller_file) {
+  return osi_calloc_tagged(alloc_tags_enabled()
+                               ? alloc_tag_for_file(caller_file)
+                               : OSI_ALLOC_TAG_OTHER,
+                           size);
+}
+
+void osi_free(void* ptr) {
+  if (ptr == nullptr) return;
+  if (slab_free(ptr)) return;
+  malloc_tag_untrack(ptr);
+  free(ptr);
+}
 
 void osi_free_and_reset(void** p_ptr) {
   CHECK(p_ptr != NULL);
@@ -70,9 +534,114 @@ void osi_free_and_reset(void** p_ptr) {
   *p_ptr = NULL;
 }
 
-const allocator_t allocator_calloc = {osi_calloc, osi_free};
+bool osi_allocator_get_slab_stats(
+    osi_slab_class_stats_t stats[OSI_SLAB_NUM_CLASSES]) {
+  slab_arena_t* a = slab_arena();
+  if (a == nullptr) return false;
+  for (size_t i = 0; i < kSlabNumClasses; i++) {
+    const slab_class_t& c = a->classes[i];
+    stats[i].block_size = kSlabClassSizes[i];
+    stats[i].in_use = c.in_use.load(std::memory_order_relaxed);
+    stats[i].high_water_mark =
+        c.high_water_mark.load(std::memory_order_relaxed);
+    stats[i].allocations = c.allocations.load(std::memory_order_relaxed);
+    stats[i].overflows = c.overflows.load(std::memory_order_relaxed);
+  }
+  return true;
+}
+
+bool osi_allocator_get_tag_stats(
+    osi_alloc_tag_stats_t stats[OSI_ALLOC_TAG_COUNT]) {
+  if (!alloc_tags_enabled()) return false;
+  if (!thread_tag_stats_destroyed) {
+    for (size_t i = 0; i < OSI_ALLOC_TAG_COUNT; i++) {
+      alloc_tag_flush(thread_tag_stats, i);
+    }
+  }
+  for (size_t i = 0; i < OSI_ALLOC_TAG_COUNT; i++) {
+    const alloc_tag_totals_t& t = alloc_tag_totals[i];
+    // Other threads may not have published the allocations they freed here.
+    int64_t live = t.live_bytes.load(std::memory_order_relaxed);
+    int64_t peak = t.peak_bytes.load(std::memory_order_relaxed);
+    stats[i].name = kAllocTagNames[i];
+    stats[i].live_bytes = live > 0 ? live : 0;
+    stats[i].peak_bytes = peak > 0 ? peak : 0;
+    stats[i].allocations = t.allocations.load(std::memory_order_relaxed);
+  }
+  return true;
+}
+
+static void osi_allocator_dump_slab_stats(int fd) {
+  dprintf(fd, "\nBluetooth Slab Allocator Statistics:\n");
+
+  osi_slab_class_stats_t stats[OSI_SLAB_NUM_CLASSES];
+  if (!osi_allocator_get_slab_stats(stats)) {
+    dprintf(fd, "  Disabled, using malloc\n");
+    return;
+  }
+
+  dprintf(fd, "  %10s %10s %10s %14s %10s\n", "Block size", "In use",
+          "Max in use", "Allocations", "Overflows");
+  for (size_t i = 0; i < OSI_SLAB_NUM_CLASSES; i++) {
+    dprintf(fd, "  %10zu %10zu %10zu %14zu %10zu\n", stats[i].block_size,
+            stats[i].in_use, stats[i].high_water_mark, stats[i].allocations,
+            stats[i].overflows);
+  }
+}
+
+static void osi_allocator_dump_tag_stats(int fd) {
+  dprintf(fd, "\nBluetooth Heap Usage by Tag:\n");
+
+  osi_alloc_tag_stats_t stats[OSI_ALLOC_TAG_COUNT];
+  if (!osi_allocator_get_tag_stats(stats)) {
+    dprintf(fd, "  Disabled\n");
+    return;
+  }
+
+  // The allocation rate is measured since the previous dump.
+  static std::mutex dump_lock;
+  static std::chrono::steady_clock::time_point last_dump;
+  static size_t last_allocations[OSI_ALLOC_TAG_COUNT];
+  std::lock_guard<std::mutex> lock(dump_lock);
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_s =
+      last_dump.time_since_epoch().count() == 0
+          ? 0
+          : std::chrono::duration<double>(now - last_dump).count();
+  last_dump = now;
+
+  dprintf(fd, "  %-10s %12s %12s %14s %12s\n", "Tag", "Live bytes",
+          "Peak bytes", "Allocations", "Allocs/s");
+  for (size_t i = 0; i < OSI_ALLOC_TAG_COUNT; i++) {
+    double rate =
+        elapsed_s > 0
+            ? (stats[i].allocations - last_allocations[i]) / elapsed_s
+            : 0;
+    last_allocations[i] = stats[i].allocations;
+    dprintf(fd, "  %-10s %12zu %12zu %14zu %12.1f\n", stats[i].name,
+            stats[i].live_bytes, stats[i].peak_bytes, stats[i].allocations,
+            rate);
+  }
+}
+
+void osi_allocator_debug_dump(int fd) {
+  osi_allocator_dump_slab_stats(fd);
+  osi_allocator_dump_tag_stats(fd);
+}
+
+// The users of allocator_t allocate on behalf of their caller, which the
+// allocator does not know.
+static void* allocator_calloc_fn(size_t size) {
+  return osi_calloc_tagged(OSI_ALLOC_TAG_OTHER, size);
+}
+
+static void* allocator_malloc_fn(size_t size) {
+  return osi_malloc_tagged(OSI_ALLOC_TAG_OTHER, size);
+}
+
+const allocator_t allocator_calloc = {allocator_calloc_fn, osi_free};
 
-const allocator_t allocator_malloc = {osi_malloc, osi_free};
+const allocator_t allocator_malloc = {allocator_malloc_fn, osi_free};
 
 OsiObject::OsiObject(void* ptr) : ptr_(ptr) {}
 
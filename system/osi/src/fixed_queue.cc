@@ -17,11 +17,17 @@
  ******************************************************************************/
 
 #include <base/logging.h>
+#include <errno.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <mutex>
 
 #include "check.h"
+#include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/list.h"
@@ -29,7 +35,27 @@
 #include "osi/include/reactor.h"
 #include "osi/semaphore.h"
 
+// Single-producer/single-consumer ring used by queues created with
+// |fixed_queue_new_spsc|. The producer only writes |tail| and the consumer only
+// writes |head|; each index lives on its own cache line.
+//
+// The consumer is woken through |dequeue_fd| only when the producer pushes
+// into an empty ring, and the producer through |enqueue_fd| only when the
+// consumer pops from a full ring, so a burst costs a single wakeup.
+#define SPSC_CACHE_LINE_SIZE 64
+
+typedef struct spsc_ring_t {
+  alignas(SPSC_CACHE_LINE_SIZE) std::atomic<size_t> head;
+  alignas(SPSC_CACHE_LINE_SIZE) std::atomic<size_t> tail;
+  alignas(SPSC_CACHE_LINE_SIZE) size_t mask;
+  void** slots;
+  int dequeue_fd;
+  int enqueue_fd;
+} spsc_ring_t;
+
 typedef struct fixed_queue_t {
+  spsc_ring_t* ring;  // Non-NULL for SPSC queues, which leave |list| unused.
+
   list_t* list;
   semaphore_t* enqueue_sem;
   semaphore_t* dequeue_sem;
@@ -43,6 +69,91 @@ typedef struct fixed_queue_t {
 
 static void internal_dequeue_ready(void* context);
 
+static void spsc_ring_free(spsc_ring_t* ring) {
+  if (ring == NULL) return;
+  if (ring->dequeue_fd != INVALID_FD) close(ring->dequeue_fd);
+  if (ring->enqueue_fd != INVALID_FD) close(ring->enqueue_fd);
+  osi_free(ring->slots);
+  delete ring;
+}
+
+static spsc_ring_t* spsc_ring_new(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) size <<= 1;
+
+  spsc_ring_t* ring = new spsc_ring_t();
+  ring->head = 0;
+  ring->tail = 0;
+  ring->mask = size - 1;
+  ring->slots = static_cast<void**>(osi_calloc(size * sizeof(void*)));
+  ring->dequeue_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  // The ring starts out with free space, so the enqueue fd starts readable.
+  ring->enqueue_fd = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ring->dequeue_fd == INVALID_FD || ring->enqueue_fd == INVALID_FD) {
+    LOG_ERROR("%s unable to create eventfd: %s", __func__, strerror(errno));
+    spsc_ring_free(ring);
+    return NULL;
+  }
+  return ring;
+}
+
+// Clears any pending wakeup on |fd|.
+static void spsc_drain_fd(int fd) {
+  eventfd_t value;
+  eventfd_read(fd, &value);
+}
+
+// Blocks until |fd| has a pending wakeup, then clears it.
+static void spsc_wait_fd(int fd) {
+  struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+  int ret;
+  OSI_NO_INTR(ret = poll(&pfd, 1, -1));
+  spsc_drain_fd(fd);
+}
+
+static size_t spsc_length(const spsc_ring_t* ring) {
+  // Load |head| first so the difference can never underflow.
+  size_t head = ring->head.load(std::memory_order_acquire);
+  size_t tail = ring->tail.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+// Producer side.
+static bool spsc_try_push(fixed_queue_t* queue, void* data) {
+  spsc_ring_t* ring = queue->ring;
+  size_t tail = ring->tail.load(std::memory_order_relaxed);
+  size_t head = ring->head.load(std::memory_order_acquire);
+  if (tail - head >= queue->capacity) return false;
+
+  ring->slots[tail & ring->mask] = data;
+  ring->tail.store(tail + 1, std::memory_order_release);
+
+  // Pairs with the fence in |spsc_try_pop|: either the consumer sees the new
+  // element, or we see that it had drained the ring and may be asleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring->head.load(std::memory_order_relaxed) == tail) {
+    eventfd_write(ring->dequeue_fd, 1);
+  }
+  return true;
+}
+
+// Consumer side.
+static void* spsc_try_pop(fixed_queue_t* queue) {
+  spsc_ring_t* ring = queue->ring;
+  size_t head = ring->head.load(std::memory_order_relaxed);
+  size_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head == tail) return NULL;
+
+  void* data = ring->slots[head & ring->mask];
+  ring->head.store(head + 1, std::memory_order_release);
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring->tail.load(std::memory_order_relaxed) - head >= queue->capacity) {
+    eventfd_write(ring->enqueue_fd, 1);
+  }
+  return data;
+}
+
 fixed_queue_t* fixed_queue_new(size_t capacity) {
   fixed_queue_t* ret =
       static_cast<fixed_queue_t*>(osi_calloc(sizeof(fixed_queue_t)));
@@ -66,11 +177,37 @@ error:
   return NULL;
 }
 
+fixed_queue_t* fixed_queue_new_spsc(size_t capacity) {
+  CHECK(capacity > 0 && capacity <= FIXED_QUEUE_SPSC_MAX_CAPACITY);
+
+  fixed_queue_t* ret =
+      static_cast<fixed_queue_t*>(osi_calloc(sizeof(fixed_queue_t)));
+
+  ret->capacity = capacity;
+  ret->ring = spsc_ring_new(capacity);
+  if (!ret->ring) {
+    osi_free(ret);
+    return NULL;
+  }
+
+  return ret;
+}
+
 void fixed_queue_free(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
   if (!queue) return;
 
   fixed_queue_unregister_dequeue(queue);
 
+  if (queue->ring) {
+    void* data;
+    while ((data = spsc_try_pop(queue)) != NULL) {
+      if (free_cb) free_cb(data);
+    }
+    spsc_ring_free(queue->ring);
+    osi_free(queue);
+    return;
+  }
+
   if (free_cb)
     for (const list_node_t* node = list_begin(queue->list);
          node != list_end(queue->list); node = list_next(node))
@@ -96,6 +233,7 @@ void fixed_queue_flush(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
 
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   if (queue == NULL) return true;
+  if (queue->ring) return spsc_length(queue->ring) == 0;
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list);
@@ -103,6 +241,7 @@ bool fixed_queue_is_empty(fixed_queue_t* queue) {
 
 size_t fixed_queue_length(fixed_queue_t* queue) {
   if (queue == NULL) return 0;
+  if (queue->ring) return spsc_length(queue->ring);
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_length(queue->list);
@@ -118,6 +257,11 @@ void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
   CHECK(queue != NULL);
   CHECK(data != NULL);
 
+  if (queue->ring) {
+    while (!spsc_try_push(queue, data)) spsc_wait_fd(queue->ring->enqueue_fd);
+    return;
+  }
+
   semaphore_wait(queue->enqueue_sem);
 
   {
@@ -131,6 +275,14 @@ void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
 void* fixed_queue_dequeue(fixed_queue_t* queue) {
   CHECK(queue != NULL);
 
+  if (queue->ring) {
+    void* ret;
+    while ((ret = spsc_try_pop(queue)) == NULL) {
+      spsc_wait_fd(queue->ring->dequeue_fd);
+    }
+    return ret;
+  }
+
   semaphore_wait(queue->dequeue_sem);
 
   void* ret = NULL;
@@ -149,6 +301,8 @@ bool fixed_queue_try_enqueue(fixed_queue_t* queue, void* data) {
   CHECK(queue != NULL);
   CHECK(data != NULL);
 
+  if (queue->ring) return spsc_try_push(queue, data);
+
   if (!semaphore_try_wait(queue->enqueue_sem)) return false;
 
   {
@@ -162,6 +316,7 @@ bool fixed_queue_try_enqueue(fixed_queue_t* queue, void* data) {
 
 void* fixed_queue_try_dequeue(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
+  if (queue->ring) return spsc_try_pop(queue);
 
   if (!semaphore_try_wait(queue->dequeue_sem)) return NULL;
 
@@ -180,6 +335,14 @@ void* fixed_queue_try_dequeue(fixed_queue_t* queue) {
 void* fixed_queue_try_peek_first(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
+  if (queue->ring) {
+    // Only safe on the consumer thread.
+    spsc_ring_t* ring = queue->ring;
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head == ring->tail.load(std::memory_order_acquire)) return NULL;
+    return ring->slots[head & ring->mask];
+  }
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list) ? NULL : list_front(queue->list);
 }
@@ -187,12 +350,21 @@ void* fixed_queue_try_peek_first(fixed_queue_t* queue) {
 void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
+  if (queue->ring) {
+    // Only safe on the producer thread.
+    spsc_ring_t* ring = queue->ring;
+    size_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (ring->head.load(std::memory_order_acquire) == tail) return NULL;
+    return ring->slots[(tail - 1) & ring->mask];
+  }
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list) ? NULL : list_back(queue->list);
 }
 
 void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
   if (queue == NULL) return NULL;
+  CHECK(queue->ring == NULL) << "not supported on SPSC queues";
 
   bool removed = false;
   {
@@ -213,6 +385,7 @@ void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
 
 list_t* fixed_queue_get_list(fixed_queue_t* queue) {
   CHECK(queue != NULL);
+  CHECK(queue->ring == NULL) << "not supported on SPSC queues";
 
   // NOTE: Using the list in this way is not thread-safe.
   // Using this list in any context where threads can call other functions
@@ -222,11 +395,13 @@ list_t* fixed_queue_get_list(fixed_queue_t* queue) {
 
 int fixed_queue_get_dequeue_fd(const fixed_queue_t* queue) {
   CHECK(queue != NULL);
+  if (queue->ring) return queue->ring->dequeue_fd;
   return semaphore_get_fd(queue->dequeue_sem);
 }
 
 int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue) {
   CHECK(queue != NULL);
+  if (queue->ring) return queue->ring->enqueue_fd;
   return semaphore_get_fd(queue->enqueue_sem);
 }
 
@@ -259,5 +434,24 @@ static void internal_dequeue_ready(void* context) {
   CHECK(context != NULL);
 
   fixed_queue_t* queue = static_cast<fixed_queue_t*>(context);
-  queue->dequeue_ready(queue, queue->dequeue_context);
+  if (!queue->ring) {
+    queue->dequeue_ready(queue, queue->dequeue_context);
+    return;
+  }
+
+  // A single wakeup covers a whole burst, so keep dispatching for as long as
+  // the callback makes progress. The reactor may unregister |queue| from
+  // within the callback, in which case we must stop.
+  spsc_ring_t* ring = queue->ring;
+  spsc_drain_fd(ring->dequeue_fd);
+  while (spsc_length(ring) > 0 && queue->dequeue_object != NULL) {
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    queue->dequeue_ready(queue, queue->dequeue_context);
+    if (ring->head.load(std::memory_order_relaxed) == head) {
+      // The callback left the element in place; come back on the next
+      // reactor iteration, as a semaphore backed queue would.
+      eventfd_write(ring->dequeue_fd, 1);
+      break;
+    }
+  }
 }
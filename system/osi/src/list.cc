@@ -16,10 +16,38 @@ typedef struct list_t {
   size_t length;
   list_free_cb free_cb;
   const allocator_t* allocator;
+
+  // Nodes released by this list, kept for reuse so that lists used as queues
+  // do not hit the allocator on every append/remove cycle.
+  list_node_t* node_pool;
+  size_t node_pool_size;
 } list_t;
 
+// Maximum number of free nodes a list keeps in |node_pool|.
+static const size_t LIST_NODE_POOL_MAX = 16;
+
 static list_node_t* list_free_node_(list_t* list, list_node_t* node);
 
+static list_node_t* list_alloc_node_(list_t* list) {
+  list_node_t* node = list->node_pool;
+  if (node) {
+    list->node_pool = node->next;
+    --list->node_pool_size;
+    return node;
+  }
+  return (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+}
+
+static void list_release_node_(list_t* list, list_node_t* node) {
+  if (list->node_pool_size < LIST_NODE_POOL_MAX) {
+    node->next = list->node_pool;
+    list->node_pool = node;
+    ++list->node_pool_size;
+    return;
+  }
+  list->allocator->free(node);
+}
+
 // Hidden constructor, only to be used by the hash map for the allocation
 // tracker.
 // Behaves the same as |list_new|, except you get to specify the allocator.
@@ -41,6 +69,11 @@ void list_free(list_t* list) {
   if (!list) return;
 
   list_clear(list);
+  while (list->node_pool) {
+    list_node_t* next = list->node_pool->next;
+    list->allocator->free(list->node_pool);
+    list->node_pool = next;
+  }
   list->allocator->free(list);
 }
 
@@ -92,7 +125,7 @@ bool list_insert_after(list_t* list, list_node_t* prev_node, void* data) {
   CHECK(prev_node != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
 
   node->next = prev_node->next;
@@ -107,7 +140,7 @@ bool list_prepend(list_t* list, void* data) {
   CHECK(list != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
   node->next = list->head;
   node->data = data;
@@ -121,7 +154,7 @@ bool list_append(list_t* list, void* data) {
   CHECK(list != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
   node->next = NULL;
   node->data = data;
@@ -209,7 +242,7 @@ static list_node_t* list_free_node_(list_t* list, list_node_t* node) {
   list_node_t* next = node->next;
 
   if (list->free_cb) list->free_cb(node->data);
-  list->allocator->free(node);
+  list_release_node_(list, node);
   --list->length;
 
   return next;
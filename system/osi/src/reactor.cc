@@ -26,8 +26,10 @@
 #include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <mutex>
 
 #include "check.h"
@@ -47,6 +49,14 @@ struct reactor_t {
   pthread_t run_thread;       // the pthread on which reactor_run is executing.
   bool is_running;            // indicates whether |run_thread| is valid.
   bool object_removed;
+
+  // Loop statistics. Only written by |run_thread|, but may be read from any
+  // thread through |reactor_get_stats|.
+  std::atomic<uint64_t> wakeups;
+  std::atomic<uint64_t> events;
+  std::atomic<uint64_t> max_events_per_wakeup;
+  std::atomic<uint64_t> callback_time_us;
+  std::atomic<uint64_t> max_callback_time_us;
 };
 
 struct reactor_object_t {
@@ -59,9 +69,15 @@ struct reactor_object_t {
                                        // descriptor becomes readable.
   void (*write_ready)(void* context);  // function to call when the file
                                        // descriptor becomes writeable.
+  bool edge_triggered;  // true if registered with EPOLLET.
 };
 
 static reactor_status_t run_reactor(reactor_t* reactor, int iterations);
+static reactor_object_t* register_internal(reactor_t* reactor, int fd,
+                                           void* context,
+                                           void (*read_ready)(void* context),
+                                           void (*write_ready)(void* context),
+                                           bool edge_triggered);
 
 static const size_t MAX_EVENTS = 64;
 static const eventfd_t EVENT_REACTOR_STOP = 1;
@@ -134,9 +150,49 @@ void reactor_stop(reactor_t* reactor) {
   eventfd_write(reactor->event_fd, EVENT_REACTOR_STOP);
 }
 
+void reactor_get_stats(const reactor_t* reactor, reactor_stats_t* stats) {
+  CHECK(reactor != NULL);
+  CHECK(stats != NULL);
+
+  stats->wakeups = reactor->wakeups.load(std::memory_order_relaxed);
+  stats->events = reactor->events.load(std::memory_order_relaxed);
+  stats->max_events_per_wakeup =
+      reactor->max_events_per_wakeup.load(std::memory_order_relaxed);
+  stats->callback_time_us =
+      reactor->callback_time_us.load(std::memory_order_relaxed);
+  stats->max_callback_time_us =
+      reactor->max_callback_time_us.load(std::memory_order_relaxed);
+}
+
+static uint32_t epoll_events_for(void (*read_ready)(void* context),
+                                 void (*write_ready)(void* context),
+                                 bool edge_triggered) {
+  uint32_t events = 0;
+  if (read_ready) events |= (EPOLLIN | EPOLLRDHUP);
+  if (write_ready) events |= EPOLLOUT;
+  if (edge_triggered) events |= EPOLLET;
+  return events;
+}
+
 reactor_object_t* reactor_register(reactor_t* reactor, int fd, void* context,
                                    void (*read_ready)(void* context),
                                    void (*write_ready)(void* context)) {
+  return register_internal(reactor, fd, context, read_ready, write_ready,
+                           false);
+}
+
+reactor_object_t* reactor_register_edge_triggered(
+    reactor_t* reactor, int fd, void* context,
+    void (*read_ready)(void* context), void (*write_ready)(void* context)) {
+  return register_internal(reactor, fd, context, read_ready, write_ready,
+                           true);
+}
+
+static reactor_object_t* register_internal(reactor_t* reactor, int fd,
+                                           void* context,
+                                           void (*read_ready)(void* context),
+                                           void (*write_ready)(void* context),
+                                           bool edge_triggered) {
   CHECK(reactor != NULL);
   CHECK(fd != INVALID_FD);
 
@@ -148,12 +204,12 @@ reactor_object_t* reactor_register(reactor_t* reactor, int fd, void* context,
   object->context = context;
   object->read_ready = read_ready;
   object->write_ready = write_ready;
+  object->edge_triggered = edge_triggered;
   object->mutex = new std::mutex;
 
   struct epoll_event event;
   memset(&event, 0, sizeof(event));
-  if (read_ready) event.events |= (EPOLLIN | EPOLLRDHUP);
-  if (write_ready) event.events |= EPOLLOUT;
+  event.events = epoll_events_for(read_ready, write_ready, edge_triggered);
   event.data.ptr = object;
 
   if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
@@ -174,8 +230,8 @@ bool reactor_change_registration(reactor_object_t* object,
 
   struct epoll_event event;
   memset(&event, 0, sizeof(event));
-  if (read_ready) event.events |= (EPOLLIN | EPOLLRDHUP);
-  if (write_ready) event.events |= EPOLLOUT;
+  event.events =
+      epoll_events_for(read_ready, write_ready, object->edge_triggered);
   event.data.ptr = object;
 
   if (epoll_ctl(object->reactor->epoll_fd, EPOLL_CTL_MOD, object->fd, &event) ==
@@ -226,6 +282,17 @@ void reactor_unregister(reactor_object_t* obj) {
   osi_free(obj);
 }
 
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void update_max(std::atomic<uint64_t>& max, uint64_t value) {
+  if (value > max.load(std::memory_order_relaxed))
+    max.store(value, std::memory_order_relaxed);
+}
+
 // Runs the reactor loop for a maximum of |iterations|.
 // 0 |iterations| means loop forever.
 // |reactor| may not be NULL.
@@ -250,6 +317,10 @@ static reactor_status_t run_reactor(reactor_t* reactor, int iterations) {
       return REACTOR_STATUS_ERROR;
     }
 
+    reactor->wakeups.fetch_add(1, std::memory_order_relaxed);
+    reactor->events.fetch_add(ret, std::memory_order_relaxed);
+    update_max(reactor->max_events_per_wakeup, ret);
+
     for (int j = 0; j < ret; ++j) {
       // The event file descriptor is the only one that registers with
       // a NULL data pointer. We use the NULL to identify it and break
@@ -274,12 +345,17 @@ static reactor_status_t run_reactor(reactor_t* reactor, int iterations) {
         lock.unlock();
 
         reactor->object_removed = false;
+        const uint64_t start_us = now_us();
         if (events[j].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR) &&
             object->read_ready)
           object->read_ready(object->context);
         if (!reactor->object_removed && events[j].events & EPOLLOUT &&
             object->write_ready)
           object->write_ready(object->context);
+        const uint64_t elapsed_us = now_us() - start_us;
+        reactor->callback_time_us.fetch_add(elapsed_us,
+                                            std::memory_order_relaxed);
+        update_max(reactor->max_callback_time_us, elapsed_us);
       }
 
       if (reactor->object_removed) {
@@ -18,9 +18,13 @@
 
 #include <base/logging.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "check.h"
 #include "osi/include/allocator.h"
+#include "osi/include/osi.h"
 #include "osi/include/ringbuffer.h"
 
 struct ringbuffer_t {
@@ -29,6 +33,10 @@ struct ringbuffer_t {
   uint8_t* base;
   uint8_t* head;
   uint8_t* tail;
+  // True if [base + total, base + 2 * total) maps the same pages as
+  // [base, base + total), so that any span starting inside the buffer is
+  // contiguous in memory.
+  bool mirrored;
 };
 
 ringbuffer_t* ringbuffer_init(const size_t size) {
@@ -42,8 +50,58 @@ ringbuffer_t* ringbuffer_init(const size_t size) {
   return p;
 }
 
+// Maps a memfd of |size| bytes twice, back to back. Returns NULL on failure.
+static uint8_t* map_mirrored(size_t size) {
+  int fd = memfd_create("bt_ringbuffer", MFD_CLOEXEC);
+  if (fd == INVALID_FD) return NULL;
+
+  uint8_t* base = NULL;
+  void* region = MAP_FAILED;
+  if (ftruncate(fd, size) == -1) goto done;
+
+  // Reserve the whole range first so the two views are guaranteed adjacent.
+  region = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) goto done;
+
+  if (mmap(region, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+           0) == MAP_FAILED ||
+      mmap(static_cast<uint8_t*>(region) + size, size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    munmap(region, 2 * size);
+    goto done;
+  }
+  base = static_cast<uint8_t*>(region);
+
+done:
+  close(fd);
+  return base;
+}
+
+ringbuffer_t* ringbuffer_init_mirrored(const size_t size) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t total = (size + page_size - 1) / page_size * page_size;
+
+  uint8_t* base = map_mirrored(total);
+  if (base == NULL) return ringbuffer_init(size);
+
+  ringbuffer_t* p =
+      static_cast<ringbuffer_t*>(osi_calloc(sizeof(ringbuffer_t)));
+  p->base = base;
+  p->head = p->tail = p->base;
+  p->total = p->available = total;
+  p->mirrored = true;
+
+  return p;
+}
+
 void ringbuffer_free(ringbuffer_t* rb) {
-  if (rb != NULL) osi_free(rb->base);
+  if (rb != NULL) {
+    if (rb->mirrored) {
+      munmap(rb->base, 2 * rb->total);
+    } else {
+      osi_free(rb->base);
+    }
+  }
   osi_free(rb);
 }
 
@@ -57,21 +115,63 @@ size_t ringbuffer_size(const ringbuffer_t* rb) {
   return rb->total - rb->available;
 }
 
+bool ringbuffer_is_mirrored(const ringbuffer_t* rb) {
+  CHECK(rb);
+  return rb->mirrored;
+}
+
 size_t ringbuffer_insert(ringbuffer_t* rb, const uint8_t* p, size_t length) {
   CHECK(rb);
   CHECK(p);
 
   if (length > ringbuffer_available(rb)) length = ringbuffer_available(rb);
 
-  for (size_t i = 0; i != length; ++i) {
-    *rb->tail++ = *p++;
-    if (rb->tail >= (rb->base + rb->total)) rb->tail = rb->base;
+  uint8_t* span;
+  size_t copied = 0;
+  while (copied < length) {
+    size_t chunk = ringbuffer_reserve(rb, &span);
+    if (chunk > length - copied) chunk = length - copied;
+    memcpy(span, p + copied, chunk);
+    ringbuffer_commit(rb, chunk);
+    copied += chunk;
   }
 
-  rb->available -= length;
   return length;
 }
 
+size_t ringbuffer_reserve(ringbuffer_t* rb, uint8_t** span) {
+  CHECK(rb);
+  CHECK(span);
+
+  *span = rb->tail;
+  if (rb->mirrored) return rb->available;
+
+  const size_t to_end = rb->base + rb->total - rb->tail;
+  return (rb->available < to_end) ? rb->available : to_end;
+}
+
+void ringbuffer_commit(ringbuffer_t* rb, size_t length) {
+  CHECK(rb);
+  CHECK(length <= rb->available);
+
+  rb->tail += length;
+  if (rb->tail >= (rb->base + rb->total)) rb->tail -= rb->total;
+
+  rb->available -= length;
+}
+
+size_t ringbuffer_peek_span(const ringbuffer_t* rb, const uint8_t** span) {
+  CHECK(rb);
+  CHECK(span);
+
+  *span = rb->head;
+  const size_t size = ringbuffer_size(rb);
+  if (rb->mirrored) return size;
+
+  const size_t to_end = rb->base + rb->total - rb->head;
+  return (size < to_end) ? size : to_end;
+}
+
 size_t ringbuffer_delete(ringbuffer_t* rb, size_t length) {
   CHECK(rb);
 
@@ -91,19 +191,21 @@ size_t ringbuffer_peek(const ringbuffer_t* rb, off_t offset, uint8_t* p,
   CHECK(offset >= 0);
   CHECK((size_t)offset <= ringbuffer_size(rb));
 
-  uint8_t* b = ((rb->head - rb->base + offset) % rb->total) + rb->base;
+  const uint8_t* b = ((rb->head - rb->base + offset) % rb->total) + rb->base;
   const size_t bytes_to_copy = (offset + length > ringbuffer_size(rb))
                                    ? ringbuffer_size(rb) - offset
                                    : length;
 
-  for (size_t copied = 0; copied < bytes_to_copy; ++copied) {
-    *p++ = *b++;
-    if (b >= (rb->base + rb->total)) b = rb->base;
+  const size_t to_end = rb->base + rb->total - b;
+  if (rb->mirrored || bytes_to_copy <= to_end) {
+    memcpy(p, b, bytes_to_copy);
+  } else {
+    memcpy(p, b, to_end);
+    memcpy(p + to_end, rb->base, bytes_to_copy - to_end);
   }
 
   return bytes_to_copy;
 }
-
 size_t ringbuffer_pop(ringbuffer_t* rb, uint8_t* p, size_t length) {
   CHECK(rb);
   CHECK(p);
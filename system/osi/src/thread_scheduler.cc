@@ -14,11 +14,191 @@
  * limitations under the License.
  */
 
+#define LOG_TAG "bt_osi_thread_scheduler"
+
+#include "osi/include/thread_scheduler.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "check.h"
+#include "os/log.h"
+#include "osi/include/properties.h"
 
 namespace {
 constexpr int kRealTimeFifoSchedulingPriority = 1;
+constexpr size_t kMaxCpus = 64;
+constexpr char kProfilePropertyPrefix[] = "bluetooth.sched.";
+
+struct builtin_profile_t {
+  const char* name;
+  thread_scheduler_profile_t profile;
+};
+
+// The defaults match the scheduling the stack threads used before profiles
+// existed; devices tune them through the system properties.
+constexpr builtin_profile_t kBuiltinProfiles[] = {
+    {"default", {SCHED_OTHER, 0, 0, 0}},
+    {"bt_main", {SCHED_FIFO, kRealTimeFifoSchedulingPriority, 0, 0}},
+    {"a2dp_source", {SCHED_FIFO, kRealTimeFifoSchedulingPriority, 0, 0}},
+    {"a2dp_encoder", {SCHED_FIFO, kRealTimeFifoSchedulingPriority, 0, 0}},
+    {"a2dp_sink", {SCHED_FIFO, kRealTimeFifoSchedulingPriority, 0, 0}},
+    {"le_audio_worker", {SCHED_FIFO, kRealTimeFifoSchedulingPriority, 0, 0}},
+};
+
+struct applied_profile_t {
+  std::string name;
+  thread_scheduler_profile_t profile;
+  bool success;
+};
+
+std::mutex applied_mutex;
+std::map<pid_t, applied_profile_t> applied_profiles;
+
+const builtin_profile_t* find_builtin_profile(const char* name) {
+  for (const auto& builtin : kBuiltinProfiles) {
+    if (strcmp(builtin.name, name) == 0) return &builtin;
+  }
+  return nullptr;
+}
+
+const char* policy_to_string(int policy) {
+  switch (policy) {
+    case SCHED_OTHER:
+      return "other";
+    case SCHED_FIFO:
+      return "fifo";
+    case SCHED_RR:
+      return "rr";
+    default:
+      return "unknown";
+  }
+}
+
+bool parse_policy(const std::string& str, int* policy) {
+  if (str == "other") {
+    *policy = SCHED_OTHER;
+  } else if (str == "fifo") {
+    *policy = SCHED_FIFO;
+  } else if (str == "rr") {
+    *policy = SCHED_RR;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parse_int(const std::string& str, long long* value) {
+  if (str.empty()) return false;
+  char* end = nullptr;
+  errno = 0;
+  *value = strtoll(str.c_str(), &end, 10);
+  return errno == 0 && *end == '\0';
+}
+
+// Parses a CPU list such as "0-3,6" into a bit mask.
+bool parse_cpu_list(const std::string& str, uint64_t* mask) {
+  *mask = 0;
+  size_t start = 0;
+  while (start < str.size()) {
+    size_t end = str.find(',', start);
+    if (end == std::string::npos) end = str.size();
+    std::string range = str.substr(start, end - start);
+    size_t dash = range.find('-');
+    long long first, last;
+    if (dash == std::string::npos) {
+      if (!parse_int(range, &first)) return false;
+      last = first;
+    } else if (!parse_int(range.substr(0, dash), &first) ||
+               !parse_int(range.substr(dash + 1), &last)) {
+      return false;
+    }
+    if (first < 0 || last < first || last >= (long long)kMaxCpus) return false;
+    for (long long cpu = first; cpu <= last; ++cpu) *mask |= 1ULL << cpu;
+    start = end + 1;
+  }
+  return true;
+}
+
+// Parses "<policy>[:<priority>[:<cpus>[:<timer_slack_ns>]]]" over |profile|.
+bool parse_profile(const std::string& str,
+                   thread_scheduler_profile_t* profile) {
+  thread_scheduler_profile_t parsed = {SCHED_OTHER, 0, 0, 0};
+  std::string fields[4];
+  size_t field = 0;
+  for (char c : str) {
+    if (c != ':') {
+      fields[field] += c;
+    } else if (++field == 4) {
+      return false;
+    }
+  }
+
+  if (!parse_policy(fields[0], &parsed.policy)) return false;
+
+  long long value;
+  if (!fields[1].empty()) {
+    if (!parse_int(fields[1], &value)) return false;
+    parsed.priority = value;
+  } else if (parsed.policy != SCHED_OTHER) {
+    parsed.priority = kRealTimeFifoSchedulingPriority;
+  }
+  if (parsed.policy == SCHED_OTHER) {
+    if (parsed.priority < -20 || parsed.priority > 19) return false;
+  } else if (parsed.priority < sched_get_priority_min(parsed.policy) ||
+             parsed.priority > sched_get_priority_max(parsed.policy)) {
+    return false;
+  }
+
+  if (!parse_cpu_list(fields[2], &parsed.cpu_mask)) return false;
+
+  if (!fields[3].empty()) {
+    if (!parse_int(fields[3], &value) || value < 0) return false;
+    parsed.timer_slack_ns = value;
+  }
+
+  *profile = parsed;
+  return true;
+}
+
+bool apply_affinity(pid_t linux_tid, uint64_t cpu_mask) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (size_t cpu = 0; cpu < kMaxCpus; ++cpu) {
+    if (cpu_mask & (1ULL << cpu)) CPU_SET(cpu, &cpus);
+  }
+  return sched_setaffinity(linux_tid, sizeof(cpus), &cpus) == 0;
+}
+
+bool apply_timer_slack(pid_t linux_tid, uint64_t timer_slack_ns) {
+  if (linux_tid == static_cast<pid_t>(syscall(SYS_gettid))) {
+    return prctl(PR_SET_TIMERSLACK, timer_slack_ns) == 0;
+  }
+
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/task/%d/timerslack_ns", linux_tid);
+  int fd = open(path, O_WRONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  char value[32];
+  int len = snprintf(value, sizeof(value), "%" PRIu64, timer_slack_ns);
+  bool success = write(fd, value, len) == len;
+  close(fd);
+  return success;
+}
 }  // namespace
 
 bool thread_scheduler_enable_real_time(pid_t linux_tid) {
@@ -32,3 +212,89 @@ bool thread_scheduler_get_priority_range(int& min, int& max) {
   max = sched_get_priority_max(SCHED_FIFO);
   return (min != -1 && max != -1) ? true : false;
 }
+
+bool thread_scheduler_get_profile(const char* name,
+                                  thread_scheduler_profile_t* profile) {
+  CHECK(name != NULL);
+  CHECK(profile != NULL);
+
+  const builtin_profile_t* builtin = find_builtin_profile(name);
+  if (builtin == nullptr) return false;
+  *profile = builtin->profile;
+
+  std::string key = std::string(kProfilePropertyPrefix) + name;
+  char value[PROPERTY_VALUE_MAX] = {0};
+  if (osi_property_get(key.c_str(), value, "") > 0 &&
+      !parse_profile(value, profile)) {
+    LOG_WARN("%s: ignoring malformed %s=\"%s\"", __func__, key.c_str(),
+             value);
+  }
+  return true;
+}
+
+bool thread_scheduler_apply_profile(pid_t linux_tid, const char* name) {
+  CHECK(name != NULL);
+
+  if (linux_tid < 0) {
+    LOG_ERROR("%s: invalid linux_tid %d for profile %s", __func__, linux_tid,
+              name);
+    return false;
+  }
+  if (linux_tid == 0) linux_tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+  thread_scheduler_profile_t profile;
+  if (!thread_scheduler_get_profile(name, &profile)) {
+    LOG_ERROR("%s: unknown scheduling profile %s", __func__, name);
+    return false;
+  }
+
+  struct sched_param params = {
+      .sched_priority = profile.policy == SCHED_OTHER ? 0 : profile.priority};
+  bool success = sched_setscheduler(linux_tid, profile.policy, &params) == 0;
+  if (!success) {
+    LOG_ERROR("%s: unable to set %s priority %d for linux_tid %d, error %s",
+              __func__, policy_to_string(profile.policy), profile.priority,
+              linux_tid, strerror(errno));
+  } else if (profile.policy == SCHED_OTHER &&
+             setpriority(PRIO_PROCESS, linux_tid, profile.priority) != 0) {
+    LOG_ERROR("%s: unable to set nice %d for linux_tid %d, error %s", __func__,
+              profile.priority, linux_tid, strerror(errno));
+    success = false;
+  }
+
+  if (profile.cpu_mask != 0 && !apply_affinity(linux_tid, profile.cpu_mask)) {
+    LOG_WARN("%s: unable to set cpu affinity 0x%" PRIx64
+             " for linux_tid %d, error %s",
+             __func__, profile.cpu_mask, linux_tid, strerror(errno));
+  }
+  if (profile.timer_slack_ns != 0 &&
+      !apply_timer_slack(linux_tid, profile.timer_slack_ns)) {
+    LOG_WARN("%s: unable to set timer slack %" PRIu64
+             "ns for linux_tid %d, error %s",
+             __func__, profile.timer_slack_ns, linux_tid, strerror(errno));
+  }
+
+  std::lock_guard<std::mutex> lock(applied_mutex);
+  applied_profiles[linux_tid] = {name, profile, success};
+  return success;
+}
+
+void thread_scheduler_debug_dump(int fd) {
+  dprintf(fd, "\nBluetooth Thread Scheduling Profiles:\n");
+  for (const auto& builtin : kBuiltinProfiles) {
+    thread_scheduler_profile_t profile;
+    thread_scheduler_get_profile(builtin.name, &profile);
+    dprintf(fd, "  %-16s: policy %-5s priority %3d cpus 0x%016" PRIx64
+            " timer slack %" PRIu64 "ns\n",
+            builtin.name, policy_to_string(profile.policy), profile.priority,
+            profile.cpu_mask, profile.timer_slack_ns);
+  }
+
+  std::lock_guard<std::mutex> lock(applied_mutex);
+  dprintf(fd, "  Applied to %zu threads:\n", applied_profiles.size());
+  for (const auto& [linux_tid, applied] : applied_profiles) {
+    dprintf(fd, "    tid %-6d: %-16s policy %-5s priority %3d %s\n", linux_tid,
+            applied.name.c_str(), policy_to_string(applied.profile.policy),
+            applied.profile.priority, applied.success ? "ok" : "FAILED");
+  }
+}
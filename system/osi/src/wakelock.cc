@@ -29,13 +29,19 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 
 #include "base/logging.h"
+#include "check.h"
 #include "common/metrics.h"
 #include "os/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 
 using bluetooth::common::BluetoothMetricsLogger;
 
@@ -77,6 +83,43 @@ static wakelock_stats_t wakelock_stats;
 // are executed serially.
 static std::mutex stats_mutex;
 
+static const char* LINGER_MS_PROPERTY = "bluetooth.osi.wakelock.linger_ms";
+static const int32_t DEFAULT_LINGER_MS = 50;
+
+// Upper bounds (exclusive) of the hold time histogram buckets. The last bucket
+// counts every hold at least as long as the last bound.
+static const uint64_t HOLD_TIME_BUCKET_BOUNDS_MS[] = {10, 100, 1000, 10000};
+#define HOLD_TIME_BUCKETS (ARRAY_SIZE(HOLD_TIME_BUCKET_BOUNDS_MS) + 1)
+
+// A user of the wakelock, identified by the reason it was acquired for.
+typedef struct {
+  bool is_held;
+  uint64_t acquired_timestamp_ms;
+  size_t acquired_count;
+  uint64_t max_held_interval_ms;
+  uint64_t total_held_interval_ms;
+  size_t held_interval_histogram[HOLD_TIME_BUCKETS];
+} wakelock_holder_t;
+
+// Coalescing state. |holders_mutex| protects everything below and serializes
+// the kernel wakelock acquire/release calls made by the coalescing layer.
+static std::mutex holders_mutex;
+static std::map<std::string, wakelock_holder_t> holders;
+static size_t active_holders = 0;
+static bool is_kernel_wakelock_held = false;
+static int64_t linger_ms = -1;  // -1 until read from LINGER_MS_PROPERTY
+static uint64_t release_deadline_ms = 0;  // 0 when no release is pending
+static size_t coalesced_acquire_count = 0;
+
+static std::condition_variable linger_cv;
+static std::thread* linger_thread = nullptr;
+static bool linger_thread_stop = false;
+
+static bool kernel_wakelock_acquire(void);
+static bool kernel_wakelock_release(void);
+static uint64_t get_linger_ms(void);
+static void linger_thread_main(void);
+static uint64_t now_ms(void);
 static bt_status_t wakelock_acquire_callout(void);
 static bt_status_t wakelock_acquire_native(void);
 static bt_status_t wakelock_release_callout(void);
@@ -94,8 +137,119 @@ void wakelock_set_os_callouts(bt_os_callouts_t* callouts) {
 }
 
 bool wakelock_acquire(void) {
+  return wakelock_acquire_for(WAKELOCK_REASON_DEFAULT);
+}
+
+bool wakelock_release(void) {
+  return wakelock_release_for(WAKELOCK_REASON_DEFAULT);
+}
+
+bool wakelock_acquire_for(const char* reason) {
+  CHECK(reason != NULL);
+  pthread_once(&initialized, wakelock_initialize);
+
+  std::lock_guard<std::mutex> lock(holders_mutex);
+
+  wakelock_holder_t& holder = holders[reason];
+  if (holder.is_held) return is_kernel_wakelock_held;
+
+  holder.is_held = true;
+  holder.acquired_timestamp_ms = now_ms();
+  holder.acquired_count++;
+
+  if (active_holders++ == 0) release_deadline_ms = 0;
+
+  if (is_kernel_wakelock_held) {
+    coalesced_acquire_count++;
+    return true;
+  }
+
+  is_kernel_wakelock_held = kernel_wakelock_acquire();
+  return is_kernel_wakelock_held;
+}
+
+bool wakelock_release_for(const char* reason) {
+  CHECK(reason != NULL);
   pthread_once(&initialized, wakelock_initialize);
 
+  std::lock_guard<std::mutex> lock(holders_mutex);
+
+  auto it = holders.find(reason);
+  if (it == holders.end() || !it->second.is_held) return true;
+
+  wakelock_holder_t& holder = it->second;
+  holder.is_held = false;
+  uint64_t delta_ms = now_ms() - holder.acquired_timestamp_ms;
+  if (delta_ms > holder.max_held_interval_ms)
+    holder.max_held_interval_ms = delta_ms;
+  holder.total_held_interval_ms += delta_ms;
+  size_t bucket = 0;
+  while (bucket < ARRAY_SIZE(HOLD_TIME_BUCKET_BOUNDS_MS) &&
+         delta_ms >= HOLD_TIME_BUCKET_BOUNDS_MS[bucket]) {
+    bucket++;
+  }
+  holder.held_interval_histogram[bucket]++;
+
+  CHECK(active_holders > 0);
+  if (--active_holders > 0 || !is_kernel_wakelock_held) return true;
+
+  uint64_t linger = get_linger_ms();
+  if (linger == 0) {
+    is_kernel_wakelock_held = false;
+    return kernel_wakelock_release();
+  }
+
+  // Keep the kernel wakelock for the linger window; the linger thread
+  // releases it unless another reason acquires it first.
+  release_deadline_ms = now_ms() + linger;
+  if (linger_thread == nullptr) {
+    linger_thread_stop = false;
+    linger_thread = new std::thread(linger_thread_main);
+  }
+  linger_cv.notify_one();
+  return true;
+}
+
+void wakelock_set_linger_ms(uint64_t linger) {
+  std::lock_guard<std::mutex> lock(holders_mutex);
+  linger_ms = linger;
+  if (release_deadline_ms != 0) linger_cv.notify_one();
+}
+
+// NOTE: must be called with |holders_mutex| held
+static uint64_t get_linger_ms(void) {
+  if (linger_ms < 0) {
+    linger_ms = osi_property_get_int32(LINGER_MS_PROPERTY, DEFAULT_LINGER_MS);
+    if (linger_ms < 0) linger_ms = 0;
+  }
+  return linger_ms;
+}
+
+static void linger_thread_main(void) {
+  std::unique_lock<std::mutex> lock(holders_mutex);
+  while (!linger_thread_stop) {
+    if (release_deadline_ms == 0) {
+      linger_cv.wait(lock);
+      continue;
+    }
+
+    uint64_t just_now_ms = now_ms();
+    if (just_now_ms < release_deadline_ms) {
+      linger_cv.wait_for(
+          lock, std::chrono::milliseconds(release_deadline_ms - just_now_ms));
+      continue;
+    }
+
+    release_deadline_ms = 0;
+    if (active_holders == 0 && is_kernel_wakelock_held) {
+      is_kernel_wakelock_held = false;
+      kernel_wakelock_release();
+    }
+  }
+}
+
+// NOTE: must be called with |holders_mutex| held
+static bool kernel_wakelock_acquire(void) {
   bt_status_t status = BT_STATUS_FAIL;
 
   if (is_native)
@@ -139,9 +293,8 @@ static bt_status_t wakelock_acquire_native(void) {
   return BT_STATUS_SUCCESS;
 }
 
-bool wakelock_release(void) {
-  pthread_once(&initialized, wakelock_initialize);
-
+// NOTE: must be called with |holders_mutex| held
+static bool kernel_wakelock_release(void) {
   bt_status_t status = BT_STATUS_FAIL;
 
   if (is_native)
@@ -202,10 +355,27 @@ static void wakelock_initialize_native(void) {
 }
 
 void wakelock_cleanup(void) {
-  if (wakelock_stats.is_acquired) {
-    LOG_ERROR("%s releasing wake lock as part of cleanup", __func__);
-    wakelock_release();
+  std::thread* thread = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(holders_mutex);
+    if (is_kernel_wakelock_held) {
+      LOG_ERROR("%s releasing wake lock as part of cleanup", __func__);
+      kernel_wakelock_release();
+      is_kernel_wakelock_held = false;
+    }
+    holders.clear();
+    active_holders = 0;
+    release_deadline_ms = 0;
+    coalesced_acquire_count = 0;
+    linger_thread_stop = true;
+    std::swap(thread, linger_thread);
+  }
+  linger_cv.notify_one();
+  if (thread != nullptr) {
+    thread->join();
+    delete thread;
   }
+
   wake_lock_path.clear();
   wake_unlock_path.clear();
   initialized = PTHREAD_ONCE_INIT;
@@ -363,4 +533,31 @@ void wakelock_debug_dump(int fd) {
   dprintf(fd, "  Total run time (ms)            : %llu\n",
           (unsigned long long)(just_now_ms -
                                wakelock_stats.last_reset_timestamp_ms));
+
+  std::lock_guard<std::mutex> holders_lock(holders_mutex);
+
+  dprintf(fd, "  Linger window (ms)             : %llu\n",
+          (unsigned long long)get_linger_ms());
+  dprintf(fd, "  Active holders                 : %zu\n", active_holders);
+  dprintf(fd, "  Coalesced acquire count        : %zu\n",
+          coalesced_acquire_count);
+  dprintf(fd, "  Holders (hold time histogram: <10ms/<100ms/<1s/<10s/more):\n");
+  for (const auto& [reason, holder] : holders) {
+    uint64_t total_held_ms = holder.total_held_interval_ms;
+    uint64_t max_held_ms = holder.max_held_interval_ms;
+    if (holder.is_held) {
+      uint64_t delta_ms = just_now_ms - holder.acquired_timestamp_ms;
+      total_held_ms += delta_ms;
+      if (delta_ms > max_held_ms) max_held_ms = delta_ms;
+    }
+    dprintf(fd,
+            "    %-16s: %s count %zu total %llu ms max %llu ms "
+            "histogram %zu/%zu/%zu/%zu/%zu\n",
+            reason.c_str(), holder.is_held ? "HELD" : "free",
+            holder.acquired_count, (unsigned long long)total_held_ms,
+            (unsigned long long)max_held_ms, holder.held_interval_histogram[0],
+            holder.held_interval_histogram[1], holder.held_interval_histogram[2],
+            holder.held_interval_histogram[3],
+            holder.held_interval_histogram[4]);
+  }
 }
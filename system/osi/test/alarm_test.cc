@@ -67,6 +67,7 @@ class AlarmTest : public ::testing::Test {
     TIMER_INTERVAL_FOR_WAKELOCK_IN_MS = 500;
 
     wakelock_set_os_callouts(&bt_wakelock_callouts);
+    wakelock_set_linger_ms(0);
 
     cb_counter = 0;
     cb_misordered_counter = 0;
@@ -319,6 +320,35 @@ TEST_F(AlarmTest, test_callback_ordering) {
   EXPECT_FALSE(is_wake_lock_acquired);
 }
 
+// Test whether the callbacks are invoked in deadline order when alarms are
+// rescheduled to deadlines that are the reverse of their set order.
+TEST_F(AlarmTest, test_callback_ordering_reschedule) {
+  alarm_t* alarms[100];
+
+  for (int i = 0; i < 100; i++) {
+    const std::string alarm_name =
+        "alarm_test.test_callback_ordering_reschedule[" + std::to_string(i) +
+        "]";
+    alarms[i] = alarm_new(alarm_name.c_str());
+    alarm_set(alarms[i], 1000, cb, NULL);
+  }
+
+  for (int i = 0; i < 100; i++) {
+    alarm_set(alarms[i], 50 + (99 - i) * 2, ordered_cb, INT_TO_PTR(99 - i));
+  }
+
+  for (int i = 1; i <= 100; i++) {
+    semaphore_wait(semaphore);
+    EXPECT_GE(cb_counter, i);
+  }
+  EXPECT_EQ(cb_counter, 100);
+  EXPECT_EQ(cb_misordered_counter, 0);
+
+  for (int i = 0; i < 100; i++) alarm_free(alarms[i]);
+
+  EXPECT_FALSE(is_wake_lock_acquired);
+}
+
 // Test whether the callbacks are involed in the expected order on a
 // message loop.
 TEST_F(AlarmTest, test_callback_ordering_on_mloop) {
@@ -380,3 +410,35 @@ TEST_F(AlarmTest, test_delete_during_callback) {
   }
   alarm_cleanup();
 }
+
+static semaphore_t* blocking_semaphore;
+
+static void blocking_cb(UNUSED_ATTR void* data) {
+  semaphore_wait(blocking_semaphore);
+  semaphore_post(semaphore);
+}
+
+// A long callback of a default alarm does not delay the media alarms.
+TEST_F(AlarmTest, test_media_alarm_not_blocked_by_default_alarm) {
+  blocking_semaphore = semaphore_new(0);
+  alarm_t* blocking_alarm =
+      alarm_new("alarm_test.test_media_alarm_not_blocked_by_default_alarm");
+  alarm_t* media_alarm = alarm_new_with_priority(
+      "alarm_test.test_media_alarm_not_blocked_by_default_alarm.media", false,
+      ALARM_PRIORITY_MEDIA);
+
+  alarm_set(blocking_alarm, 0, blocking_cb, NULL);
+  alarm_set(media_alarm, 10, cb, NULL);
+
+  msleep(10 + EPSILON_MS);
+  EXPECT_EQ(cb_counter, 1);
+  EXPECT_FALSE(alarm_is_scheduled(media_alarm));
+
+  semaphore_post(blocking_semaphore);
+  semaphore_wait(semaphore);
+  semaphore_wait(semaphore);
+
+  alarm_free(media_alarm);
+  alarm_free(blocking_alarm);
+  semaphore_free(blocking_semaphore);
+}
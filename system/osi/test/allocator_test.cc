@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include <cstring>
+#include <thread>
+#include <vector>
 
 class AllocatorTest : public ::testing::Test {};
 
@@ -48,3 +50,144 @@ TEST_F(AllocatorTest, test_osi_strndup) {
   EXPECT_EQ(0, strcmp(str, copy_str));
   osi_free(copy_str);
 }
+
+TEST_F(AllocatorTest, test_slab_stats_track_allocations) {
+  osi_slab_class_stats_t before[OSI_SLAB_NUM_CLASSES];
+  if (!osi_allocator_get_slab_stats(before)) {
+    GTEST_SKIP() << "slab allocator disabled";
+  }
+
+  void* ptr = osi_malloc(100);
+  ASSERT_NE(nullptr, ptr);
+
+  osi_slab_class_stats_t during[OSI_SLAB_NUM_CLASSES];
+  ASSERT_TRUE(osi_allocator_get_slab_stats(during));
+  size_t idx = 0;
+  while (during[idx].block_size < 100) idx++;
+  EXPECT_EQ(before[idx].in_use + 1, during[idx].in_use);
+  EXPECT_EQ(before[idx].allocations + 1, during[idx].allocations);
+  EXPECT_LE(during[idx].in_use, during[idx].high_water_mark);
+
+  osi_free(ptr);
+
+  osi_slab_class_stats_t after[OSI_SLAB_NUM_CLASSES];
+  ASSERT_TRUE(osi_allocator_get_slab_stats(after));
+  EXPECT_EQ(before[idx].in_use, after[idx].in_use);
+  EXPECT_LE(during[idx].high_water_mark, after[idx].high_water_mark);
+}
+
+TEST_F(AllocatorTest, test_osi_calloc_zeroes_recycled_blocks) {
+  for (int i = 0; i < 64; i++) {
+    uint8_t* ptr = (uint8_t*)osi_malloc(600);
+    memset(ptr, 0xff, 600);
+    osi_free(ptr);
+
+    ptr = (uint8_t*)osi_calloc(600);
+    for (int j = 0; j < 600; j++) ASSERT_EQ(0, ptr[j]);
+    osi_free(ptr);
+  }
+}
+
+TEST_F(AllocatorTest, test_large_and_foreign_buffers) {
+  // Larger than any size class, served by malloc.
+  void* large = osi_malloc(64 * 1024);
+  ASSERT_NE(nullptr, large);
+  memset(large, 0xa5, 64 * 1024);
+  osi_free(large);
+
+  // Buffers from libc must still be accepted by osi_free.
+  osi_free(malloc(32));
+  osi_free(nullptr);
+}
+
+TEST_F(AllocatorTest, test_free_on_other_thread) {
+  constexpr int kCount = 1000;
+  std::vector<void*> buffers;
+  for (int i = 0; i < kCount; i++) {
+    buffers.push_back(osi_malloc(1021 + 12));
+  }
+
+  std::thread other([&buffers]() {
+    for (void* ptr : buffers) osi_free(ptr);
+  });
+  other.join();
+
+  // Blocks freed on the other thread must be reusable here.
+  for (int i = 0; i < kCount; i++) {
+    buffers[i] = osi_calloc(1021 + 12);
+  }
+  for (void* ptr : buffers) osi_free(ptr);
+}
+
+TEST_F(AllocatorTest, test_tag_stats_track_allocations) {
+  osi_alloc_tag_stats_t before[OSI_ALLOC_TAG_COUNT];
+  if (!osi_allocator_get_tag_stats(before)) {
+    GTEST_SKIP() << "heap accounting disabled";
+  }
+
+  void* small = osi_malloc_tagged(OSI_ALLOC_TAG_L2CAP, 100);
+  void* large = osi_calloc_tagged(OSI_ALLOC_TAG_L2CAP, 64 * 1024);
+
+  osi_alloc_tag_stats_t during[OSI_ALLOC_TAG_COUNT];
+  ASSERT_TRUE(osi_allocator_get_tag_stats(during));
+  EXPECT_STREQ("l2cap", during[OSI_ALLOC_TAG_L2CAP].name);
+  EXPECT_GE(during[OSI_ALLOC_TAG_L2CAP].live_bytes,
+            before[OSI_ALLOC_TAG_L2CAP].live_bytes + 100 + 64 * 1024);
+  EXPECT_EQ(before[OSI_ALLOC_TAG_L2CAP].allocations + 2,
+            during[OSI_ALLOC_TAG_L2CAP].allocations);
+  EXPECT_LE(during[OSI_ALLOC_TAG_L2CAP].live_bytes,
+            during[OSI_ALLOC_TAG_L2CAP].peak_bytes);
+  EXPECT_EQ(before[OSI_ALLOC_TAG_GATT].allocations,
+            during[OSI_ALLOC_TAG_GATT].allocations);
+
+  osi_free(small);
+  osi_free(large);
+
+  osi_alloc_tag_stats_t after[OSI_ALLOC_TAG_COUNT];
+  ASSERT_TRUE(osi_allocator_get_tag_stats(after));
+  EXPECT_EQ(before[OSI_ALLOC_TAG_L2CAP].live_bytes,
+            after[OSI_ALLOC_TAG_L2CAP].live_bytes);
+  EXPECT_EQ(during[OSI_ALLOC_TAG_L2CAP].peak_bytes,
+            after[OSI_ALLOC_TAG_L2CAP].peak_bytes);
+}
+
+TEST_F(AllocatorTest, test_tag_inferred_from_caller_file) {
+  osi_alloc_tag_stats_t before[OSI_ALLOC_TAG_COUNT];
+  if (!osi_allocator_get_tag_stats(before)) {
+    GTEST_SKIP() << "heap accounting disabled";
+  }
+
+  osi_free(osi_malloc(32));
+  osi_free(osi_malloc(32, "packages/modules/Bluetooth/system/stack/gatt/x.cc"));
+
+  osi_alloc_tag_stats_t after[OSI_ALLOC_TAG_COUNT];
+  ASSERT_TRUE(osi_allocator_get_tag_stats(after));
+  EXPECT_EQ(before[OSI_ALLOC_TAG_OTHER].allocations + 1,
+            after[OSI_ALLOC_TAG_OTHER].allocations);
+  EXPECT_EQ(before[OSI_ALLOC_TAG_GATT].allocations + 1,
+            after[OSI_ALLOC_TAG_GATT].allocations);
+}
+
+TEST_F(AllocatorTest, test_tag_stats_free_on_other_thread) {
+  osi_alloc_tag_stats_t before[OSI_ALLOC_TAG_COUNT];
+  if (!osi_allocator_get_tag_stats(before)) {
+    GTEST_SKIP() << "heap accounting disabled";
+  }
+
+  std::vector<void*> buffers;
+  for (int i = 0; i < 100; i++) {
+    buffers.push_back(osi_malloc_tagged(OSI_ALLOC_TAG_A2DP, 600));
+  }
+  std::thread other([&buffers]() {
+    for (void* ptr : buffers) osi_free(ptr);
+  });
+  other.join();
+
+  // The other thread published its counters when it exited.
+  osi_alloc_tag_stats_t after[OSI_ALLOC_TAG_COUNT];
+  ASSERT_TRUE(osi_allocator_get_tag_stats(after));
+  EXPECT_EQ(before[OSI_ALLOC_TAG_A2DP].live_bytes,
+            after[OSI_ALLOC_TAG_A2DP].live_bytes);
+  EXPECT_EQ(before[OSI_ALLOC_TAG_A2DP].allocations + 100,
+            after[OSI_ALLOC_TAG_A2DP].allocations);
+}
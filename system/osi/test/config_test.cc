@@ -271,3 +271,72 @@ TEST_F(ConfigTest, checksum_save) {
 
   EXPECT_TRUE(std::filesystem::remove(filename));
 }
+
+TEST_F(ConfigTest, config_save_after_modification) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  EXPECT_TRUE(config_save(*config, CONFIG_FILE));
+
+  // Modify sections after they have been serialized once.
+  config_set_string(config.get(), "DID", "version", "0x2222");
+  config_set_int(config.get(), "DID", "newKey", 42);
+  EXPECT_TRUE(config_remove_key(config.get(), "DID", "productId"));
+  config_set_string(config.get(), "NewSection", "key", "value");
+  EXPECT_TRUE(config_save(*config, CONFIG_FILE));
+
+  std::unique_ptr<config_t> reloaded = config_new(CONFIG_FILE);
+  ASSERT_NE(reloaded, nullptr);
+  EXPECT_EQ(config_get_int(*reloaded, "DID", "version", 0), 0x2222);
+  EXPECT_EQ(config_get_int(*reloaded, "DID", "newKey", 0), 42);
+  EXPECT_FALSE(config_has_key(*reloaded, "DID", "productId"));
+  EXPECT_EQ(*config_get_string(*reloaded, "NewSection", "key", nullptr),
+            "value");
+  EXPECT_EQ(*config_get_string(*reloaded, CONFIG_DEFAULT_SECTION, "first_key",
+                               nullptr),
+            "value");
+}
+
+TEST_F(ConfigTest, section_serialized_entries_cache) {
+  section_t section = {.name = "section"};
+  EXPECT_EQ(section.SerializedEntries(), "");
+
+  section.Set("b", "2");
+  section.Set("a", "1");
+  EXPECT_EQ(section.SerializedEntries(), "b = 2\na = 1\n");
+
+  section.Set("b", "3");
+  EXPECT_EQ(section.SerializedEntries(), "b = 3\na = 1\n");
+
+  section.entries.sort([](const entry_t& first, const entry_t& second) {
+    return first.key < second.key;
+  });
+  EXPECT_EQ(section.SerializedEntries(), "a = 1\nb = 3\n");
+
+  section.entries.erase(section.Find("a"));
+  EXPECT_EQ(section.SerializedEntries(), "b = 3\n");
+
+  // A moved-from section must not keep serving the old text.
+  section_t moved = std::move(section);
+  EXPECT_EQ(moved.SerializedEntries(), "b = 3\n");
+  EXPECT_EQ(section.SerializedEntries(), "");
+}
+
+TEST_F(ConfigTest, indexed_list_duplicate_keys) {
+  config_t config = {
+      .sections = {
+          section_t{.name = "dup", .entries = {{.key = "k", .value = "1"}}},
+          section_t{.name = "dup", .entries = {{.key = "k", .value = "2"}}},
+      }};
+
+  // Lookups return the first matching section, as a linear search would.
+  ASSERT_NE(config.Find("dup"), config.sections.end());
+  EXPECT_EQ(*config_get_string(config, "dup", "k", nullptr), "1");
+
+  config.sections.erase(config.Find("dup"));
+  ASSERT_NE(config.Find("dup"), config.sections.end());
+  EXPECT_EQ(*config_get_string(config, "dup", "k", nullptr), "2");
+
+  EXPECT_TRUE(config_remove_section(&config, "dup"));
+  EXPECT_FALSE(config.Has("dup"));
+  EXPECT_TRUE(config.sections.empty());
+}
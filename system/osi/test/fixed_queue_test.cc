@@ -347,3 +347,79 @@ TEST_F(FixedQueueTest, test_fixed_queue_register_dequeue) {
   thread_free(worker_thread);
   fixed_queue_free(queue, NULL);
 }
+
+TEST_F(FixedQueueTest, test_fixed_queue_spsc_enqueue_dequeue) {
+  fixed_queue_t* queue = fixed_queue_new_spsc(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+  EXPECT_EQ(TEST_QUEUE_SIZE, fixed_queue_capacity(queue));
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  // Test blocking enqueue and blocking dequeue
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+  EXPECT_EQ((size_t)1, fixed_queue_length(queue));
+  EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_dequeue(queue));
+  EXPECT_EQ((size_t)0, fixed_queue_length(queue));
+
+  // Test non-blocking enqueue beyond queue capacity. The ring is rounded up to
+  // a power of two, but the capacity must still be honored.
+  for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+    EXPECT_TRUE(fixed_queue_try_enqueue(queue, (void*)DUMMY_DATA_STRING));
+  }
+  EXPECT_FALSE(fixed_queue_try_enqueue(queue, (void*)DUMMY_DATA_STRING));
+
+  EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_try_peek_first(queue));
+  EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_try_peek_last(queue));
+  for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+    EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_try_dequeue(queue));
+  }
+  EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+  EXPECT_EQ(NULL, fixed_queue_try_peek_first(queue));
+
+  // Test free with elements left in the queue
+  test_queue_entry_free_counter = 0;
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING1);
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING2);
+  fixed_queue_free(queue, test_queue_entry_free_cb);
+  EXPECT_EQ(2, test_queue_entry_free_counter);
+}
+
+static const size_t SPSC_BURST_SIZE = 1000;
+static size_t spsc_received_count = 0;
+
+static void fixed_queue_spsc_ready(fixed_queue_t* queue,
+                                   UNUSED_ATTR void* context) {
+  void* msg = fixed_queue_try_dequeue(queue);
+  EXPECT_TRUE(msg != NULL);
+  if (++spsc_received_count == SPSC_BURST_SIZE) {
+    future_ready(received_message_future, msg);
+  }
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_spsc_register_dequeue_burst) {
+  fixed_queue_t* queue = fixed_queue_new_spsc(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  received_message_future = future_new();
+  ASSERT_TRUE(received_message_future != NULL);
+  spsc_received_count = 0;
+
+  thread_t* worker_thread = thread_new("test_fixed_queue_worker_thread");
+  ASSERT_TRUE(worker_thread != NULL);
+
+  fixed_queue_register_dequeue(queue, thread_get_reactor(worker_thread),
+                               fixed_queue_spsc_ready, NULL);
+
+  // Enqueue many more elements than the queue can hold. The producer blocks
+  // whenever the consumer falls behind, and every element must be delivered.
+  for (size_t i = 0; i < SPSC_BURST_SIZE - 1; i++) {
+    fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+  }
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING3);
+  const char* msg = (const char*)future_await(received_message_future);
+  EXPECT_EQ(DUMMY_DATA_STRING3, msg);
+  EXPECT_EQ(SPSC_BURST_SIZE, spsc_received_count);
+
+  fixed_queue_unregister_dequeue(queue);
+  thread_free(worker_thread);
+  fixed_queue_free(queue, NULL);
+}
@@ -3,6 +3,7 @@
 #include <base/logging.h>
 #include <gtest/gtest.h>
 
+#include "osi/include/intrusive_list.h"
 #include "osi/include/osi.h"
 
 class ListTest : public ::testing::Test {};
@@ -207,3 +208,86 @@ TEST_F(ListTest, test_list_foreach_partial) {
 
   list_free(list);
 }
+
+TEST_F(ListTest, test_list_node_reuse) {
+  list_t* list = list_new(NULL);
+
+  // Nodes released by remove/clear are recycled by later appends; the list
+  // contents must be unaffected.
+  int x[32];
+  for (int round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < ARRAY_SIZE(x); ++i) {
+      x[i] = round * 100 + i;
+      list_append(list, &x[i]);
+    }
+    EXPECT_EQ(list_length(list), ARRAY_SIZE(x));
+    EXPECT_TRUE(list_remove(list, &x[0]));
+    EXPECT_EQ(list_front(list), &x[1]);
+    EXPECT_EQ(list_back(list), &x[ARRAY_SIZE(x) - 1]);
+    list_prepend(list, &x[0]);
+
+    int expected = round * 100;
+    for (const list_node_t* node = list_begin(list); node != list_end(list);
+         node = list_next(node)) {
+      EXPECT_EQ(*(int*)list_node(node), expected++);
+    }
+    list_clear(list);
+    EXPECT_TRUE(list_is_empty(list));
+  }
+
+  list_free(list);
+}
+
+namespace {
+struct intrusive_element_t {
+  int value;
+  list_link_t link;
+};
+}  // namespace
+
+TEST_F(ListTest, test_intrusive_list) {
+  intrusive_list_t list;
+  intrusive_list_init(&list);
+  EXPECT_TRUE(intrusive_list_is_empty(&list));
+  EXPECT_EQ(intrusive_list_begin(&list), intrusive_list_end(&list));
+
+  intrusive_element_t elements[5] = {};
+  for (int i = 0; i < 5; ++i) {
+    elements[i].value = i;
+    EXPECT_FALSE(intrusive_list_is_linked(&elements[i].link));
+  }
+
+  intrusive_list_append(&list, &elements[1].link);
+  intrusive_list_append(&list, &elements[3].link);
+  intrusive_list_prepend(&list, &elements[0].link);
+  intrusive_list_insert_after(&list, &elements[1].link, &elements[2].link);
+  intrusive_list_append(&list, &elements[4].link);
+  EXPECT_EQ(intrusive_list_length(&list), 5u);
+
+  int expected = 0;
+  for (list_link_t* l = intrusive_list_begin(&list);
+       l != intrusive_list_end(&list); l = intrusive_list_next(l)) {
+    EXPECT_EQ(INTRUSIVE_LIST_ENTRY(l, intrusive_element_t, link)->value,
+              expected++);
+  }
+  EXPECT_EQ(expected, 5);
+
+  intrusive_list_remove(&list, &elements[2].link);
+  EXPECT_FALSE(intrusive_list_is_linked(&elements[2].link));
+  EXPECT_FALSE(intrusive_list_contains(&list, &elements[2].link));
+  EXPECT_TRUE(intrusive_list_contains(&list, &elements[3].link));
+  EXPECT_EQ(intrusive_list_length(&list), 4u);
+
+  intrusive_list_remove(&list, &elements[0].link);
+  intrusive_list_remove(&list, &elements[4].link);
+  EXPECT_EQ(INTRUSIVE_LIST_ENTRY(intrusive_list_front(&list),
+                                 intrusive_element_t, link),
+            &elements[1]);
+  EXPECT_EQ(INTRUSIVE_LIST_ENTRY(intrusive_list_back(&list),
+                                 intrusive_element_t, link),
+            &elements[3]);
+
+  intrusive_list_clear(&list);
+  EXPECT_TRUE(intrusive_list_is_empty(&list));
+  EXPECT_FALSE(intrusive_list_is_linked(&elements[1].link));
+}
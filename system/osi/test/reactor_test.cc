@@ -109,3 +109,73 @@ TEST_F(ReactorTest, reactor_unregister_from_separate_thread) {
   close(fd);
   reactor_free(reactor);
 }
+
+static int edge_triggered_count;
+
+static void edge_triggered_cb(UNUSED_ATTR void* context) {
+  // Intentionally leave the eventfd readable.
+  edge_triggered_count++;
+}
+
+TEST_F(ReactorTest, reactor_edge_triggered_not_redelivered) {
+  reactor_t* reactor = reactor_new();
+
+  int fd = eventfd(0, EFD_NONBLOCK);
+  edge_triggered_count = 0;
+  reactor_object_t* object = reactor_register_edge_triggered(
+      reactor, fd, NULL, edge_triggered_cb, NULL);
+  ASSERT_TRUE(object != NULL);
+
+  eventfd_write(fd, 1);
+  EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+  EXPECT_EQ(1, edge_triggered_count);
+
+  // The fd is still readable, but no new data arrived, so only the stop
+  // event may be reported.
+  reactor_stop(reactor);
+  EXPECT_EQ(REACTOR_STATUS_STOP, reactor_run_once(reactor));
+  EXPECT_EQ(1, edge_triggered_count);
+
+  // New data triggers a new edge.
+  eventfd_write(fd, 1);
+  EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+  EXPECT_EQ(2, edge_triggered_count);
+
+  reactor_unregister(object);
+  close(fd);
+  reactor_free(reactor);
+}
+
+static void drain_cb(void* context) {
+  eventfd_t value;
+  eventfd_read(*(int*)context, &value);
+}
+
+TEST_F(ReactorTest, reactor_stats) {
+  reactor_t* reactor = reactor_new();
+
+  reactor_stats_t stats;
+  reactor_get_stats(reactor, &stats);
+  EXPECT_EQ(0u, stats.wakeups);
+  EXPECT_EQ(0u, stats.events);
+
+  int fds[2] = {eventfd(0, 0), eventfd(0, 0)};
+  reactor_object_t* objects[2];
+  for (int i = 0; i < 2; i++) {
+    objects[i] = reactor_register(reactor, fds[i], &fds[i], drain_cb, NULL);
+    eventfd_write(fds[i], 1);
+  }
+
+  EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+  reactor_get_stats(reactor, &stats);
+  EXPECT_EQ(1u, stats.wakeups);
+  EXPECT_EQ(2u, stats.events);
+  EXPECT_EQ(2u, stats.max_events_per_wakeup);
+  EXPECT_LE(stats.max_callback_time_us, stats.callback_time_us);
+
+  for (int i = 0; i < 2; i++) {
+    reactor_unregister(objects[i]);
+    close(fds[i]);
+  }
+  reactor_free(reactor);
+}
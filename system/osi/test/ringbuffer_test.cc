@@ -137,3 +137,70 @@ TEST(RingbufferTest, test_multi_insert_delete) {
 
   ringbuffer_free(rb);
 }
+
+TEST(RingbufferTest, test_reserve_commit_peek_span) {
+  ringbuffer_t* rb = ringbuffer_init(8);
+
+  uint8_t* span = NULL;
+  EXPECT_EQ((size_t)8, ringbuffer_reserve(rb, &span));
+  memset(span, 0xAA, 6);
+  ringbuffer_commit(rb, 6);
+  EXPECT_EQ((size_t)6, ringbuffer_size(rb));
+  EXPECT_EQ((size_t)2, ringbuffer_available(rb));
+
+  const uint8_t* data = NULL;
+  EXPECT_EQ((size_t)6, ringbuffer_peek_span(rb, &data));
+  EXPECT_EQ(0xAA, data[0]);
+  EXPECT_EQ(0xAA, data[5]);
+  EXPECT_EQ((size_t)4, ringbuffer_delete(rb, 4));
+
+  // The free space now wraps around, so the span stops at the end of the
+  // buffer.
+  EXPECT_EQ((size_t)2, ringbuffer_reserve(rb, &span));
+  memset(span, 0xBB, 2);
+  ringbuffer_commit(rb, 2);
+  EXPECT_EQ((size_t)4, ringbuffer_reserve(rb, &span));
+  memset(span, 0xCC, 4);
+  ringbuffer_commit(rb, 4);
+  EXPECT_EQ((size_t)0, ringbuffer_available(rb));
+
+  EXPECT_EQ((size_t)4, ringbuffer_peek_span(rb, &data));
+  uint8_t expected[] = {0xAA, 0xAA, 0xBB, 0xBB, 0xCC, 0xCC, 0xCC, 0xCC};
+  uint8_t popped[8] = {0};
+  EXPECT_EQ((size_t)8, ringbuffer_pop(rb, popped, sizeof(popped)));
+  ASSERT_TRUE(0 == memcmp(expected, popped, sizeof(expected)));
+
+  ringbuffer_free(rb);
+}
+
+TEST(RingbufferTest, test_mirrored_spans_do_not_split) {
+  ringbuffer_t* rb = ringbuffer_init_mirrored(100);
+  if (!ringbuffer_is_mirrored(rb)) {
+    ringbuffer_free(rb);
+    GTEST_SKIP() << "mirrored mapping not supported";
+  }
+
+  const size_t total = ringbuffer_available(rb);
+  EXPECT_GE(total, (size_t)100);
+
+  // Move the head and tail close to the end of the buffer.
+  uint8_t* span = NULL;
+  ringbuffer_reserve(rb, &span);
+  ringbuffer_commit(rb, total - 3);
+  ringbuffer_delete(rb, total - 3);
+
+  // The whole free space is handed out as one span across the wrap point.
+  EXPECT_EQ(total, ringbuffer_reserve(rb, &span));
+  for (size_t i = 0; i < 10; i++) span[i] = i;
+  ringbuffer_commit(rb, 10);
+
+  const uint8_t* data = NULL;
+  EXPECT_EQ((size_t)10, ringbuffer_peek_span(rb, &data));
+  for (size_t i = 0; i < 10; i++) EXPECT_EQ(i, data[i]);
+
+  uint8_t peek[10] = {0};
+  EXPECT_EQ((size_t)10, ringbuffer_peek(rb, 0, peek, sizeof(peek)));
+  ASSERT_TRUE(0 == memcmp(data, peek, sizeof(peek)));
+
+  ringbuffer_free(rb);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "osi/include/thread_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <thread>
+
+#include "osi/include/properties.h"
+
+class ThreadSchedulerTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    osi_property_set("bluetooth.sched.default", "");
+    osi_property_set("bluetooth.sched.a2dp_source", "");
+  }
+};
+
+TEST_F(ThreadSchedulerTest, builtin_profiles) {
+  thread_scheduler_profile_t profile;
+  ASSERT_TRUE(thread_scheduler_get_profile("default", &profile));
+  EXPECT_EQ(profile.policy, SCHED_OTHER);
+  EXPECT_EQ(profile.priority, 0);
+  EXPECT_EQ(profile.cpu_mask, 0u);
+
+  ASSERT_TRUE(thread_scheduler_get_profile("a2dp_source", &profile));
+  EXPECT_EQ(profile.policy, SCHED_FIFO);
+  EXPECT_EQ(profile.priority, 1);
+
+  EXPECT_FALSE(thread_scheduler_get_profile("no_such_profile", &profile));
+  EXPECT_FALSE(thread_scheduler_apply_profile(0, "no_such_profile"));
+}
+
+TEST_F(ThreadSchedulerTest, property_override) {
+  osi_property_set("bluetooth.sched.a2dp_source", "rr:3:0-1,4:50000");
+
+  thread_scheduler_profile_t profile;
+  ASSERT_TRUE(thread_scheduler_get_profile("a2dp_source", &profile));
+  EXPECT_EQ(profile.policy, SCHED_RR);
+  EXPECT_EQ(profile.priority, 3);
+  EXPECT_EQ(profile.cpu_mask, 0x13u);
+  EXPECT_EQ(profile.timer_slack_ns, 50000u);
+}
+
+TEST_F(ThreadSchedulerTest, malformed_property_ignored) {
+  const char* malformed[] = {"batch", "fifo:1000", "other:40", "fifo:1:3-1",
+                             "fifo:1:0:-5", "fifo:1:0:0:extra"};
+  for (const char* value : malformed) {
+    osi_property_set("bluetooth.sched.a2dp_source", value);
+    thread_scheduler_profile_t profile;
+    ASSERT_TRUE(thread_scheduler_get_profile("a2dp_source", &profile));
+    EXPECT_EQ(profile.policy, SCHED_FIFO) << value;
+    EXPECT_EQ(profile.priority, 1) << value;
+  }
+}
+
+TEST_F(ThreadSchedulerTest, apply_cfs_profile) {
+  // Lowering the priority of a thread is always allowed, so this does not
+  // need any privileges.
+  osi_property_set("bluetooth.sched.default", "other:5");
+
+  bool success = false;
+  int nice = 0;
+  std::thread thread([&]() {
+    success = thread_scheduler_apply_profile(0, "default");
+    nice = getpriority(PRIO_PROCESS, 0);
+  });
+  thread.join();
+
+  EXPECT_TRUE(success);
+  EXPECT_EQ(nice, 5);
+}
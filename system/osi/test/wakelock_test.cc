@@ -23,18 +23,25 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <atomic>
 
 #include "osi/include/wakelock.h"
 
-static bool is_wake_lock_acquired = false;
+static std::atomic_bool is_wake_lock_acquired = false;
+static std::atomic_int acquire_wake_lock_count = 0;
+static std::atomic_int release_wake_lock_count = 0;
 
 static int acquire_wake_lock_cb(const char* lock_name) {
   is_wake_lock_acquired = true;
+  acquire_wake_lock_count++;
   return BT_STATUS_SUCCESS;
 }
 
 static int release_wake_lock_cb(const char* lock_name) {
   is_wake_lock_acquired = false;
+  release_wake_lock_count++;
   return BT_STATUS_SUCCESS;
 }
 
@@ -44,6 +51,10 @@ static bt_os_callouts_t bt_wakelock_callouts = {
 class WakelockTest : public ::testing::Test {
  protected:
   void SetUp() override {
+    acquire_wake_lock_count = 0;
+    release_wake_lock_count = 0;
+    wakelock_set_linger_ms(0);
+
 // TODO (jamuraa): maybe use base::CreateNewTempDirectory instead?
 #ifdef __ANDROID__
     tmp_dir_ = "/data/local/tmp/btwlXXXXXX";
@@ -155,3 +166,57 @@ TEST_F(WakelockTest, test_set_paths) {
     ASSERT_FALSE(IsFileWakeLockAcquired());
   }
 }
+
+TEST_F(WakelockTest, test_reasons_are_reference_counted) {
+  wakelock_set_os_callouts(&bt_wakelock_callouts);
+
+  ASSERT_TRUE(wakelock_acquire_for("alarm"));
+  ASSERT_TRUE(wakelock_acquire_for("a2dp_source"));
+  // Acquiring again for a reason that already holds it does nothing.
+  ASSERT_TRUE(wakelock_acquire_for("alarm"));
+  EXPECT_EQ(acquire_wake_lock_count, 1);
+
+  // The wakelock stays acquired until every reason released it.
+  ASSERT_TRUE(wakelock_release_for("alarm"));
+  EXPECT_TRUE(is_wake_lock_acquired);
+  ASSERT_TRUE(wakelock_release_for("alarm"));
+  EXPECT_TRUE(is_wake_lock_acquired);
+  ASSERT_TRUE(wakelock_release_for("a2dp_source"));
+  EXPECT_FALSE(is_wake_lock_acquired);
+  EXPECT_EQ(release_wake_lock_count, 1);
+
+  // Releasing a reason that never acquired the wakelock does nothing.
+  ASSERT_TRUE(wakelock_release_for("le_audio"));
+  EXPECT_EQ(release_wake_lock_count, 1);
+}
+
+TEST_F(WakelockTest, test_linger_coalesces_bursts) {
+  wakelock_set_os_callouts(&bt_wakelock_callouts);
+  wakelock_set_linger_ms(100);
+
+  for (size_t i = 0; i < 100; i++) {
+    ASSERT_TRUE(wakelock_acquire_for("alarm"));
+    ASSERT_TRUE(wakelock_release_for("alarm"));
+  }
+  EXPECT_TRUE(is_wake_lock_acquired);
+  EXPECT_EQ(acquire_wake_lock_count, 1);
+  EXPECT_EQ(release_wake_lock_count, 0);
+
+  // The kernel wakelock is released once the linger window expires.
+  for (int i = 0; i < 100 && is_wake_lock_acquired; i++) usleep(10000);
+  EXPECT_FALSE(is_wake_lock_acquired);
+  EXPECT_EQ(release_wake_lock_count, 1);
+}
+
+TEST_F(WakelockTest, test_cleanup_releases_lingering_wakelock) {
+  wakelock_set_os_callouts(&bt_wakelock_callouts);
+  wakelock_set_linger_ms(60000);
+
+  ASSERT_TRUE(wakelock_acquire_for("alarm"));
+  ASSERT_TRUE(wakelock_release_for("alarm"));
+  EXPECT_TRUE(is_wake_lock_acquired);
+
+  wakelock_cleanup();
+  EXPECT_FALSE(is_wake_lock_acquired);
+  EXPECT_EQ(release_wake_lock_count, 1);
+}
@@ -188,9 +188,10 @@ void Device::VendorPacketHandler(uint8_t label,
         send_message(label, false, std::move(response));
         return;
       }
-      media_interface_->GetSongInfo(base::Bind(
-          &Device::GetElementAttributesResponse, weak_ptr_factory_.GetWeakPtr(),
-          label, get_element_attributes_request_pkt));
+      song_info_requested_ = true;
+      GetCurrentSongInfo(base::Bind(&Device::GetElementAttributesResponse,
+                                    weak_ptr_factory_.GetWeakPtr(), label,
+                                    get_element_attributes_request_pkt));
     } break;
 
     case CommandPdu::GET_PLAY_STATUS: {
@@ -835,6 +836,48 @@ void Device::GetPlayStatusResponse(uint8_t label, PlayStatus status) {
   send_message(label, false, std::move(response));
 }
 
+void Device::GetCurrentSongInfo(MediaInterface::SongInfoCallback cb) {
+  if (song_info_cache_.valid) {
+    if (!cb.is_null()) cb.Run(song_info_cache_.info);
+    return;
+  }
+
+  if (!cb.is_null()) song_info_cache_.pending_cbs.push_back(cb);
+  if (song_info_cache_.fetching) return;
+
+  song_info_cache_.fetching = true;
+  media_interface_->GetSongInfo(base::Bind(&Device::CurrentSongInfoResponse,
+                                           weak_ptr_factory_.GetWeakPtr(),
+                                           song_info_cache_.generation));
+}
+
+void Device::CurrentSongInfoResponse(uint32_t generation, SongInfo info) {
+  if (generation != song_info_cache_.generation) {
+    DEVICE_VLOG(3) << __func__ << ": dropping stale metadata";
+    return;
+  }
+
+  song_info_cache_.valid = true;
+  song_info_cache_.fetching = false;
+  song_info_cache_.info = std::move(info);
+
+  auto pending_cbs = std::move(song_info_cache_.pending_cbs);
+  song_info_cache_.pending_cbs.clear();
+  for (const auto& cb : pending_cbs) cb.Run(song_info_cache_.info);
+}
+
+void Device::InvalidateSongInfo() {
+  song_info_cache_.generation++;
+  song_info_cache_.valid = false;
+  song_info_cache_.fetching = false;
+
+  // Requests waiting for the old metadata get the new one. Otherwise read it
+  // ahead of the next poll of a remote that asked for it before.
+  if (song_info_requested_ || !song_info_cache_.pending_cbs.empty()) {
+    GetCurrentSongInfo(MediaInterface::SongInfoCallback());
+  }
+}
+
 void Device::GetElementAttributesResponse(
     uint8_t label, std::shared_ptr<GetElementAttributesRequest> pkt,
     SongInfo info) {
@@ -1149,8 +1192,10 @@ void Device::HandleGetFolderItems(uint8_t label,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      // A request for the first window starts a new listing of the folder,
+      // read it again in case the player changed its content.
+      GetCurrentFolderItems(
+          pkt->GetStartItem() != 0,
           base::Bind(&Device::GetVFSListResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -1188,10 +1233,9 @@ void Device::HandleGetTotalNumberOfItems(
       break;
     }
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
-          base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label));
+      GetCurrentFolderItems(
+          true, base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
+                           weak_ptr_factory_.GetWeakPtr(), label));
       break;
     case Scope::NOW_PLAYING:
       media_interface_->GetNowPlayingList(
@@ -1213,8 +1257,8 @@ void Device::GetTotalNumberOfItemsMediaPlayersResponse(
   send_message(label, true, std::move(builder));
 }
 
-void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                              std::vector<ListItem> list) {
+void Device::GetTotalNumberOfItemsVFSResponse(
+    uint8_t label, const std::vector<ListItem>& list) {
   DEVICE_VLOG(2) << __func__ << ": num_items=" << list.size();
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
@@ -1231,6 +1275,34 @@ void Device::GetTotalNumberOfItemsNowPlayingResponse(
   send_message(label, true, std::move(builder));
 }
 
+void Device::GetCurrentFolderItems(bool use_cache,
+                                   CurrentFolderItemsCallback cb) {
+  if (use_cache && folder_cache_.valid &&
+      folder_cache_.player_id == curr_browsed_player_id_ &&
+      folder_cache_.folder_id == CurrentFolder()) {
+    DEVICE_VLOG(3) << __func__ << ": cached folder=\"" << CurrentFolder()
+                   << "\" num_items=" << folder_cache_.items.size();
+    cb.Run(folder_cache_.items);
+    return;
+  }
+
+  media_interface_->GetFolderItems(
+      curr_browsed_player_id_, CurrentFolder(),
+      base::Bind(&Device::CurrentFolderItemsResponse,
+                 weak_ptr_factory_.GetWeakPtr(), curr_browsed_player_id_,
+                 CurrentFolder(), cb));
+}
+
+void Device::CurrentFolderItemsResponse(int player_id, std::string folder_id,
+                                        CurrentFolderItemsCallback cb,
+                                        std::vector<ListItem> items) {
+  folder_cache_.valid = true;
+  folder_cache_.player_id = player_id;
+  folder_cache_.folder_id = std::move(folder_id);
+  folder_cache_.items = std::move(items);
+  cb.Run(folder_cache_.items);
+}
+
 void Device::HandleChangePath(uint8_t label,
                               std::shared_ptr<ChangePathRequest> pkt) {
   if (!pkt->IsValid()) {
@@ -1273,15 +1345,14 @@ void Device::HandleChangePath(uint8_t label,
                    << "\"";
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
-      base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
-                 label, pkt));
+  GetCurrentFolderItems(
+      false, base::Bind(&Device::ChangePathResponse,
+                        weak_ptr_factory_.GetWeakPtr(), label, pkt));
 }
 
 void Device::ChangePathResponse(uint8_t label,
                                 std::shared_ptr<ChangePathRequest> pkt,
-                                std::vector<ListItem> list) {
+                                const std::vector<ListItem>& list) {
   // TODO (apanicke): Reconstruct the VFS ID's here. Right now it gets
   // reconstructed in GetFolderItemsVFS
   auto builder =
@@ -1321,10 +1392,9 @@ void Device::HandleGetItemAttributes(
       // then we can auto send the error without calling up. We do this check
       // later right now though in order to prevent race conditions with updates
       // on the media layer.
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
-          base::Bind(&Device::GetItemAttributesVFSResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetCurrentFolderItems(
+          true, base::Bind(&Device::GetItemAttributesVFSResponse,
+                           weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     default:
       DEVICE_LOG(ERROR) << "UNKNOWN SCOPE FOR HANDLE GET ITEM ATTRIBUTES";
@@ -1385,7 +1455,7 @@ void Device::GetItemAttributesNowPlayingResponse(
 
 void Device::GetItemAttributesVFSResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::vector<ListItem> item_list) {
+    const std::vector<ListItem>& item_list) {
   DEVICE_VLOG(2) << __func__ << ": uid=" << loghex(pkt->GetUid());
 
   auto media_id = vfs_ids_.get_media_id(pkt->GetUid());
@@ -1501,7 +1571,7 @@ std::set<AttributeEntry> filter_attributes_requested(
 
 void Device::GetVFSListResponse(uint8_t label,
                                 std::shared_ptr<GetFolderItemsRequest> pkt,
-                                std::vector<ListItem> items) {
+                                const std::vector<ListItem>& items) {
   DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
                  << " end_item=" << pkt->GetEndItem();
 
@@ -1509,27 +1579,17 @@ void Device::GetVFSListResponse(uint8_t label,
   auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, browse_mtu_);
 
-  // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
-  // an operation.
-  for (const auto& item : items) {
-    if (item.type == ListItem::FOLDER) {
-      vfs_ids_.insert(item.folder.media_id);
-    } else if (item.type == ListItem::SONG) {
-      vfs_ids_.insert(item.song.media_id);
-    }
-  }
-
-  // Add the elements retrieved in the last get folder items request and map
-  // them to UIDs The maps will be cleared every time a directory change
-  // happens. These items do not need to correspond with the now playing list as
-  // the UID's only need to be unique in the context of the current scope and
-  // the current folder
+  // Map the elements of the requested window to UIDs. Only the items sent to
+  // the remote need one, and the least recently used ones are dropped from
+  // the map once it is full. These items do not need to correspond with the
+  // now playing list as the UID's only need to be unique in the context of the
+  // current scope and the current folder
   for (auto i = pkt->GetStartItem(); i <= pkt->GetEndItem() && i < items.size();
        i++) {
     if (items[i].type == ListItem::FOLDER) {
-      auto folder = items[i].folder;
+      const auto& folder = items[i].folder;
       // right now we always use folders of mixed type
-      FolderItem folder_item(vfs_ids_.get_uid(folder.media_id), 0x00,
+      FolderItem folder_item(vfs_ids_.insert(folder.media_id), 0x00,
                              folder.is_playable, folder.name);
       if (!builder->AddFolder(folder_item)) break;
     } else if (items[i].type == ListItem::SONG) {
@@ -1544,7 +1604,7 @@ void Device::GetVFSListResponse(uint8_t label,
           song.attributes.find(Attribute::TITLE) != song.attributes.end()
               ? song.attributes.find(Attribute::TITLE)->value()
               : "No Song Info";
-      MediaElementItem song_item(vfs_ids_.get_uid(song.media_id), title,
+      MediaElementItem song_item(vfs_ids_.insert(song.media_id), title,
                                  std::set<AttributeEntry>());
 
       if (pkt->GetNumAttributes() == 0x00) {  // All attributes requested
@@ -1672,7 +1732,10 @@ void Device::SendMediaUpdate(bool metadata, bool play_status, bool queue) {
     }
   }
 
-  if (metadata) HandleTrackUpdate();
+  if (metadata) {
+    InvalidateSongInfo();
+    HandleTrackUpdate();
+  }
 }
 
 void Device::SendFolderUpdate(bool available_players, bool addressed_player,
@@ -1680,6 +1743,12 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   CHECK(media_interface_);
   DEVICE_VLOG(4) << __func__;
 
+  // Any folder update may come with new folder content
+  folder_cache_ = FolderCache();
+
+  // The metadata comes from the addressed player
+  if (addressed_player) InvalidateSongInfo();
+
   if (available_players) {
     HandleAvailablePlayerUpdate();
   }
@@ -1867,6 +1936,13 @@ void Device::DeviceDisconnected() {
   // to reset the local volume var to be sure we send the correct value
   // to the remote device on the next connection.
   volume_ = VOL_NOT_SUPPORTED;
+
+  // Drop the folder listing, it can be large
+  folder_cache_ = FolderCache();
+  song_info_requested_ = false;
+  song_info_cache_.pending_cbs.clear();
+  InvalidateSongInfo();
+  song_info_cache_.info = SongInfo();
 }
 
 static std::string volumeToStr(int8_t volume) {
@@ -222,7 +222,7 @@ class Device {
       uint16_t curr_player, std::vector<MediaPlayerInfo> players);
   virtual void GetVFSListResponse(uint8_t label,
                                   std::shared_ptr<GetFolderItemsRequest> pkt,
-                                  std::vector<ListItem> items);
+                                  const std::vector<ListItem>& items);
   virtual void GetNowPlayingListResponse(
       uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
       std::string curr_song_id, std::vector<SongInfo> song_list);
@@ -232,8 +232,8 @@ class Device {
       uint8_t label, std::shared_ptr<GetTotalNumberOfItemsRequest> pkt);
   virtual void GetTotalNumberOfItemsMediaPlayersResponse(
       uint8_t label, uint16_t curr_player, std::vector<MediaPlayerInfo> list);
-  virtual void GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                                std::vector<ListItem> items);
+  virtual void GetTotalNumberOfItemsVFSResponse(
+      uint8_t label, const std::vector<ListItem>& items);
   virtual void GetTotalNumberOfItemsNowPlayingResponse(
       uint8_t label, std::string curr_song_id, std::vector<SongInfo> song_list);
 
@@ -245,7 +245,7 @@ class Device {
       std::string curr_media_id, std::vector<SongInfo> song_list);
   virtual void GetItemAttributesVFSResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::vector<ListItem> item_list);
+      const std::vector<ListItem>& item_list);
 
   // SET BROWSED PLAYER
   virtual void HandleSetBrowsedPlayer(
@@ -259,7 +259,7 @@ class Device {
                                 std::shared_ptr<ChangePathRequest> request);
   virtual void ChangePathResponse(uint8_t label,
                                   std::shared_ptr<ChangePathRequest> request,
-                                  std::vector<ListItem> list);
+                                  const std::vector<ListItem>& list);
 
   // PLAY ITEM
   virtual void HandlePlayItem(uint8_t label,
@@ -321,6 +321,22 @@ class Device {
     return current_path_.top();
   }
 
+  // Runs |cb| with the items of the current folder of the browsed player.
+  // With |use_cache| the items are taken from the folder cache when it holds
+  // that folder, instead of being read again from the media interface.
+  using CurrentFolderItemsCallback =
+      base::Callback<void(const std::vector<ListItem>&)>;
+  void GetCurrentFolderItems(bool use_cache, CurrentFolderItemsCallback cb);
+  void CurrentFolderItemsResponse(int player_id, std::string folder_id,
+                                  CurrentFolderItemsCallback cb,
+                                  std::vector<ListItem> items);
+
+  // Runs |cb|, if not null, with the metadata of the current track. The
+  // metadata is read once from the media interface per track.
+  void GetCurrentSongInfo(MediaInterface::SongInfoCallback cb);
+  void CurrentSongInfoResponse(uint32_t generation, SongInfo info);
+  void InvalidateSongInfo();
+
   void send_message(uint8_t label, bool browse,
                     std::unique_ptr<::bluetooth::PacketBuilder> message) {
     active_labels_.erase(label);
@@ -357,9 +373,38 @@ class Device {
   Notification avail_players_changed_ = Notification(false, 0);
   Notification uids_changed_ = Notification(false, 0);
 
-  MediaIdMap vfs_ids_;
+  // The VFS UIDs only need to stay valid while the remote browses around
+  // them, bound the map so large libraries do not grow it forever.
+  static constexpr size_t kMaxVfsIds = 4096;
+  MediaIdMap vfs_ids_{kMaxVfsIds};
   MediaIdMap now_playing_ids_;
 
+  // Items of the last VFS folder read from the media interface. Remotes page
+  // through large folders with one GetFolderItems request per window, the
+  // windows after the first one and the item counts are served from here.
+  struct FolderCache {
+    bool valid = false;
+    int player_id = -1;
+    std::string folder_id;
+    std::vector<ListItem> items;
+  };
+  FolderCache folder_cache_;
+
+  // Metadata of the current track. Some remotes poll GetElementAttributes
+  // every second, they are answered from here until the media layer reports
+  // a metadata change, which also reads the new metadata ahead of the next
+  // poll once the remote has asked for it.
+  struct SongInfoCache {
+    // Incremented on every metadata change, to drop stale responses.
+    uint32_t generation = 0;
+    bool valid = false;
+    bool fetching = false;
+    SongInfo info;
+    std::vector<MediaInterface::SongInfoCallback> pending_cbs;
+  };
+  SongInfoCache song_info_cache_;
+  bool song_info_requested_ = false;
+
   uint32_t play_pos_interval_ = 0;
 
   SongInfo last_song_info_;
@@ -16,7 +16,10 @@
 
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
 
 namespace bluetooth {
 namespace avrcp {
@@ -24,39 +27,80 @@ namespace avrcp {
 // A helper class to convert Media ID's (represented as strings) that are
 // received from the AVRCP Media Interface layer into UID's to be used
 // with connected devices.
+//
+// Each Media ID string is stored once and shared by both lookup directions.
+// The map can be bounded, the least recently used ID's being dropped first so
+// browsing a large library does not grow it forever. A dropped ID gets a new
+// UID if it is inserted again.
 class MediaIdMap {
  public:
+  // |max_size| is the maximum number of ID's kept, 0 for no limit.
+  explicit MediaIdMap(size_t max_size = 0) : max_size_(max_size) {}
+
   void clear() {
-    media_id_to_uid_.clear();
-    uid_to_media_id_.clear();
+    entries_.clear();
+    uid_to_entry_.clear();
+    lru_.clear();
+    next_uid_ = 1;
   }
 
+  size_t size() const { return entries_.size(); }
+
   std::string get_media_id(uint64_t uid) {
-    const auto& uid_it = uid_to_media_id_.find(uid);
-    if (uid_it == uid_to_media_id_.end()) return "";
-    return uid_it->second;
+    const auto& uid_it = uid_to_entry_.find(uid);
+    if (uid_it == uid_to_entry_.end()) return "";
+    touch(uid_it->second);
+    return uid_it->second->first;
   }
 
-  uint64_t get_uid(std::string media_id) {
-    const auto& media_id_it = media_id_to_uid_.find(media_id);
-    if (media_id_it == media_id_to_uid_.end()) return 0;
-    return media_id_it->second;
+  uint64_t get_uid(const std::string& media_id) {
+    const auto& media_id_it = entries_.find(media_id);
+    if (media_id_it == entries_.end()) return 0;
+    touch(&*media_id_it);
+    return media_id_it->second.uid;
   }
 
-  uint64_t insert(std::string media_id) {
-    if (media_id_to_uid_.find(media_id) != media_id_to_uid_.end()) {
-      return media_id_to_uid_[media_id];
+  uint64_t insert(const std::string& media_id) {
+    const auto& media_id_it = entries_.find(media_id);
+    if (media_id_it != entries_.end()) {
+      touch(&*media_id_it);
+      return media_id_it->second.uid;
+    }
+
+    if (max_size_ != 0 && entries_.size() >= max_size_) {
+      EntryMap::value_type* oldest = lru_.back();
+      lru_.pop_back();
+      uid_to_entry_.erase(oldest->second.uid);
+      entries_.erase(oldest->first);
     }
 
-    uint64_t uid = media_id_to_uid_.size() + 1;
-    media_id_to_uid_.insert(std::pair<std::string, uint64_t>(media_id, uid));
-    uid_to_media_id_.insert(std::pair<uint64_t, std::string>(uid, media_id));
+    uint64_t uid = next_uid_++;
+    lru_.push_front(nullptr);
+    auto* entry = &*entries_.emplace(media_id, Entry{uid, lru_.begin()}).first;
+    lru_.front() = entry;
+    uid_to_entry_.emplace(uid, entry);
     return uid;
   }
 
  private:
-  std::map<std::string, uint64_t> media_id_to_uid_;
-  std::map<uint64_t, std::string> uid_to_media_id_;
+  struct Entry {
+    uint64_t uid;
+    // Position in |lru_|.
+    std::list<std::pair<const std::string, Entry>*>::iterator lru_it;
+  };
+  using EntryMap = std::unordered_map<std::string, Entry>;
+
+  void touch(EntryMap::value_type* entry) {
+    lru_.splice(lru_.begin(), lru_, entry->second.lru_it);
+  }
+
+  size_t max_size_;
+  uint64_t next_uid_ = 1;
+  // Elements are never moved by a rehash, the other containers point at them.
+  EntryMap entries_;
+  std::unordered_map<uint64_t, EntryMap::value_type*> uid_to_entry_;
+  // Most recently used first.
+  std::list<EntryMap::value_type*> lru_;
 };
 
 }  // namespace avrcp
@@ -742,6 +742,43 @@ TEST_F(AvrcpDeviceTest, getElementAttributesTest) {
   SendMessage(3, TestAvrcpPacket::Make(get_element_attributes_request_full));
 }
 
+TEST_F(AvrcpDeviceTest, getElementAttributesCacheTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr,
+                                  nullptr);
+
+  SongInfo info = {"test_id", {AttributeEntry(Attribute::TITLE, "Test Song")}};
+  SongInfo next_info = {"next_id",
+                        {AttributeEntry(Attribute::TITLE, "Next Song")}};
+
+  // The metadata is read once per track, the read for the next track being
+  // triggered by the metadata update
+  EXPECT_CALL(interface, GetSongInfo(_))
+      .Times(2)
+      .WillOnce(InvokeCb<0>(info))
+      .WillOnce(InvokeCb<0>(next_info));
+
+  for (uint8_t label = 1; label <= 2; label++) {
+    auto response = GetElementAttributesResponseBuilder::MakeBuilder(0xFFFF);
+    response->AddAttributeEntry(Attribute::TITLE, "Test Song");
+    EXPECT_CALL(response_cb,
+                Call(label, false, matchPacket(std::move(response))))
+        .Times(1);
+    SendMessage(label,
+                TestAvrcpPacket::Make(get_element_attributes_request_partial));
+  }
+
+  test_device->SendMediaUpdate(true, false, false);
+
+  auto response = GetElementAttributesResponseBuilder::MakeBuilder(0xFFFF);
+  response->AddAttributeEntry(Attribute::TITLE, "Next Song");
+  EXPECT_CALL(response_cb, Call(3, false, matchPacket(std::move(response))))
+      .Times(1);
+  SendMessage(3, TestAvrcpPacket::Make(get_element_attributes_request_partial));
+}
+
 TEST_F(AvrcpDeviceTest, getElementAttributesWithCoverArtTest) {
   MockMediaInterface interface;
   NiceMock<MockA2dpInterface> a2dp_interface;
@@ -1021,6 +1058,59 @@ TEST_F(AvrcpDeviceTest, getVFSFolderTest) {
   SendBrowseMessage(1, request);
 }
 
+TEST_F(AvrcpDeviceTest, getVFSFolderPagingTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr,
+                                  nullptr);
+
+  std::vector<ListItem> list;
+  for (int i = 0; i < 4; i++) {
+    FolderInfo info = {"test_id" + std::to_string(i), true,
+                       "Test Folder" + std::to_string(i)};
+    list.push_back({ListItem::FOLDER, info, SongInfo()});
+  }
+
+  // The folder is read once for the first window, the next window and the
+  // item count are served from the folder cache
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(1)
+      .WillOnce(InvokeCb<2>(list));
+
+  auto expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  expected_response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  expected_response->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb,
+              Call(1, true, matchPacket(std::move(expected_response))))
+      .Times(1);
+  auto request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {})
+      ->Serialize(request);
+  SendBrowseMessage(1, request);
+
+  expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  expected_response->AddFolder(FolderItem(3, 0, true, "Test Folder2"));
+  expected_response->AddFolder(FolderItem(4, 0, true, "Test Folder3"));
+  EXPECT_CALL(response_cb,
+              Call(2, true, matchPacket(std::move(expected_response))))
+      .Times(1);
+  request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 2, 3, {})
+      ->Serialize(request);
+  SendBrowseMessage(2, request);
+
+  auto total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, list.size());
+  EXPECT_CALL(response_cb,
+              Call(3, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      3, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+}
+
 TEST_F(AvrcpDeviceTest, getFolderItemsMtuTest) {
   auto truncated_packet = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, 0xFFFF);
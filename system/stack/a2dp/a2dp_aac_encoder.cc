@@ -41,6 +41,17 @@
 // offset
 #define A2DP_AAC_OFFSET AVDT_MEDIA_OFFSET
 
+// Adaptive bit rate, with a constant bit rate only: the bit rate is lowered
+// while packets back up in the transmit queue, and raised back to the
+// configured bit rate once the queue has drained. Queue lengths are in
+// packets, periods in encoder ticks, steps in fractions of the configured bit
+// rate.
+#define A2DP_AAC_ABR_QUEUE_CONGESTED 6
+#define A2DP_AAC_ABR_QUEUE_CLEAR 2
+#define A2DP_AAC_ABR_BIT_RATE_DOWN_DIVISOR 8
+#define A2DP_AAC_ABR_BIT_RATE_UP_DIVISOR 32
+#define A2DP_AAC_ABR_BIT_RATE_UP_PERIOD 25
+
 typedef struct {
   uint32_t sample_rate;
   uint8_t channel_mode;
@@ -66,8 +77,18 @@ typedef struct {
   size_t media_read_total_dropped_packets;
   size_t media_read_total_actual_reads_count;
   size_t media_read_total_actual_read_bytes;
+
+  size_t abr_total_bit_rate_decreases;
+  int abr_lowest_bit_rate;
 } a2dp_aac_encoder_stats_t;
 
+typedef struct {
+  int max_bit_rate;      // Bit rate of the codec configuration, 0 if VBR
+  int min_bit_rate;      // Lowest bit rate used under congestion
+  int bit_rate;          // Current bit rate
+  uint16_t clear_ticks;  // Ticks since the queue was last congested
+} tA2DP_AAC_ABR_STATE;
+
 typedef struct {
   a2dp_source_read_callback_t read_callback;
   a2dp_source_enqueue_callback_t enqueue_callback;
@@ -83,6 +104,7 @@ typedef struct {
   tA2DP_FEEDING_PARAMS feeding_params;
   tA2DP_AAC_ENCODER_PARAMS aac_encoder_params;
   tA2DP_AAC_FEEDING_STATE aac_feeding_state;
+  tA2DP_AAC_ABR_STATE abr_state;
 
   a2dp_aac_encoder_stats_t stats;
 } tA2DP_AAC_ENCODER_CB;
@@ -100,6 +122,7 @@ static void a2dp_aac_get_num_frame_iteration(uint8_t* num_of_iterations,
                                              uint64_t timestamp_us);
 static void a2dp_aac_encode_frames(uint8_t nb_frame);
 static bool a2dp_aac_read_feeding(uint8_t* read_buffer, uint32_t* bytes_read);
+static void a2dp_aac_abr_init(int bit_rate, int bit_rate_mode);
 static uint16_t adjust_effective_mtu(
     const tA2DP_ENCODER_INIT_PEER_PARAMS& peer_params);
 
@@ -392,6 +415,10 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config,
     return;  // TODO: Return an error?
   }
 
+  a2dp_aac_abr_init(std::min(A2DP_GetBitRateAac(p_codec_info),
+                             aac_peak_bit_rate),
+                    aac_param_value);
+
   // Mark the end of setting the encoder's parameters
   aac_error =
       aacEncEncode(a2dp_aac_encoder_cb.aac_handle, NULL, NULL, NULL, NULL);
@@ -475,6 +502,59 @@ int a2dp_aac_get_effective_frame_size() {
   return a2dp_aac_encoder_cb.TxAaMtuSize;
 }
 
+static void a2dp_aac_abr_init(int bit_rate, int bit_rate_mode) {
+  tA2DP_AAC_ABR_STATE* p_abr_state = &a2dp_aac_encoder_cb.abr_state;
+
+  memset(p_abr_state, 0, sizeof(*p_abr_state));
+  a2dp_aac_encoder_cb.stats.abr_lowest_bit_rate = bit_rate;
+  // The encoder sizes the frames itself with a variable bit rate
+  if (bit_rate_mode != A2DP_AAC_VARIABLE_BIT_RATE_DISABLED) return;
+  p_abr_state->max_bit_rate = bit_rate;
+  p_abr_state->min_bit_rate = bit_rate / 2;
+  p_abr_state->bit_rate = bit_rate;
+}
+
+void a2dp_aac_set_transmit_queue_length(size_t transmit_queue_length) {
+  tA2DP_AAC_ABR_STATE* p_abr_state = &a2dp_aac_encoder_cb.abr_state;
+  int bit_rate = p_abr_state->bit_rate;
+
+  if (!a2dp_aac_encoder_cb.has_aac_handle || p_abr_state->max_bit_rate == 0)
+    return;
+
+  if (transmit_queue_length >= A2DP_AAC_ABR_QUEUE_CONGESTED) {
+    p_abr_state->clear_ticks = 0;
+    bit_rate = std::max(bit_rate - p_abr_state->max_bit_rate /
+                                       A2DP_AAC_ABR_BIT_RATE_DOWN_DIVISOR,
+                        p_abr_state->min_bit_rate);
+  } else if (transmit_queue_length <= A2DP_AAC_ABR_QUEUE_CLEAR) {
+    if (++p_abr_state->clear_ticks >= A2DP_AAC_ABR_BIT_RATE_UP_PERIOD) {
+      p_abr_state->clear_ticks = 0;
+      bit_rate = std::min(bit_rate + p_abr_state->max_bit_rate /
+                                         A2DP_AAC_ABR_BIT_RATE_UP_DIVISOR,
+                          p_abr_state->max_bit_rate);
+    }
+  }
+  if (bit_rate == p_abr_state->bit_rate) return;
+
+  // The new bit rate applies from the next encoded frame
+  AACENC_ERROR aac_error = aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle,
+                                               AACENC_BITRATE, bit_rate);
+  if (aac_error != AACENC_OK) {
+    LOG_WARN("%s: Cannot set AAC parameter AACENC_BITRATE to %d: "
+             "AAC error 0x%x",
+             __func__, bit_rate, aac_error);
+    return;
+  }
+  LOG_VERBOSE("%s: queue length %zu, bit rate %d -> %d", __func__,
+              transmit_queue_length, p_abr_state->bit_rate, bit_rate);
+  if (bit_rate < p_abr_state->bit_rate) {
+    a2dp_aac_encoder_cb.stats.abr_total_bit_rate_decreases++;
+    a2dp_aac_encoder_cb.stats.abr_lowest_bit_rate =
+        std::min(a2dp_aac_encoder_cb.stats.abr_lowest_bit_rate, bit_rate);
+  }
+  p_abr_state->bit_rate = bit_rate;
+}
+
 void a2dp_aac_send_frames(uint64_t timestamp_us) {
   uint8_t nb_frame = 0;
   uint8_t nb_iterations = 0;
@@ -735,4 +815,17 @@ void A2dpCodecConfigAacSource::debug_codec_dump(int fd) {
           "%zu\n",
           stats->media_read_total_expected_read_bytes,
           stats->media_read_total_actual_read_bytes);
+
+  if (a2dp_aac_encoder_cb.abr_state.max_bit_rate != 0) {
+    dprintf(fd,
+            "  Bit rate (current/configured/lowest)                    : %d / "
+            "%d / %d\n",
+            a2dp_aac_encoder_cb.abr_state.bit_rate,
+            a2dp_aac_encoder_cb.abr_state.max_bit_rate,
+            stats->abr_lowest_bit_rate);
+    dprintf(fd,
+            "  Bit rate decreases on congestion                        : "
+            "%zu\n",
+            stats->abr_total_bit_rate_decreases);
+  }
 }
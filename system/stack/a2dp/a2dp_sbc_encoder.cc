@@ -25,6 +25,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "a2dp_sbc.h"
 #include "a2dp_sbc_up_sample.h"
 #include "common/time_util.h"
@@ -57,6 +59,14 @@
 #define A2DP_SBC_FRAME_HEADER_SIZE_BYTES 4  // A2DP Spec v1.3, 12.4, Table 12.12
 #define A2DP_SBC_SCALE_FACTOR_BITS 4        // A2DP Spec v1.3, 12.4, Table 12.13
 
+/* Adaptive bitpool: the bitpool is lowered while packets back up in the
+ * transmit queue, and raised back to the configured bitpool once the queue
+ * has drained. Queue lengths are in packets, periods in encoder ticks. */
+#define A2DP_SBC_ABR_QUEUE_CONGESTED 6
+#define A2DP_SBC_ABR_QUEUE_CLEAR 2
+#define A2DP_SBC_ABR_BITPOOL_DOWN_STEP 4
+#define A2DP_SBC_ABR_BITPOOL_UP_PERIOD 25
+
 /* offset */
 #define A2DP_HDR_SIZE 1
 #define A2DP_SBC_OFFSET (AVDT_MEDIA_OFFSET + A2DP_SBC_MPL_HDR_LEN)
@@ -65,6 +75,7 @@ typedef struct {
   uint32_t aa_frame_counter;
   int32_t aa_feed_counter;
   int32_t aa_feed_residue;
+  int32_t aa_feed_consumed; /* up-sampled bytes encoded since the last read */
   float counter;
   uint32_t bytes_per_tick; /* pcm bytes read each media task tick */
   uint64_t last_frame_us;
@@ -83,8 +94,17 @@ typedef struct {
 
   size_t media_read_total_expected_frames;
   size_t media_read_total_dropped_frames;
+
+  size_t abr_total_bitpool_decreases;
+  int16_t abr_lowest_bitpool;
 } a2dp_sbc_encoder_stats_t;
 
+typedef struct {
+  int16_t max_bitpool; /* bitpool of the codec configuration */
+  int16_t min_bitpool; /* lowest bitpool used under congestion */
+  uint16_t clear_ticks; /* ticks since the queue was last congested */
+} tA2DP_SBC_ABR_STATE;
+
 typedef struct {
   a2dp_source_read_callback_t read_callback;
   a2dp_source_enqueue_callback_t enqueue_callback;
@@ -96,6 +116,7 @@ typedef struct {
   tA2DP_FEEDING_PARAMS feeding_params;
   tA2DP_SBC_FEEDING_STATE feeding_state;
   int16_t pcmBuffer[SBC_MAX_PCM_BUFFER_SIZE];
+  tA2DP_SBC_ABR_STATE abr_state;
 
   a2dp_sbc_encoder_stats_t stats;
 } tA2DP_SBC_ENCODER_CB;
@@ -106,7 +127,7 @@ static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config,
                                     bool* p_restart_input,
                                     bool* p_restart_output,
                                     bool* p_config_updated);
-static bool a2dp_sbc_read_feeding(uint32_t* bytes);
+static bool a2dp_sbc_read_feeding(int16_t** p_pcm, uint32_t* bytes);
 static void a2dp_sbc_encode_frames(uint8_t nb_frame);
 static void a2dp_sbc_get_num_frame_iteration(uint8_t* num_of_iterations,
                                              uint8_t* num_of_frames,
@@ -331,6 +352,17 @@ static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config,
   /* Reset the SBC encoder */
   SBC_Encoder_Init(&a2dp_sbc_encoder_cb.sbc_encoder_params);
   a2dp_sbc_encoder_cb.tx_sbc_frames = calculate_max_frames_per_packet();
+
+  /* Congestion may lower the bitpool down to half, and never below the
+   * minimum bitpool of the peer */
+  tA2DP_SBC_ABR_STATE* p_abr_state = &a2dp_sbc_encoder_cb.abr_state;
+  p_abr_state->max_bitpool = p_encoder_params->s16BitPool;
+  p_abr_state->min_bitpool =
+      std::max<int16_t>(p_abr_state->max_bitpool / 2, min_bitpool);
+  p_abr_state->min_bitpool =
+      std::min(p_abr_state->min_bitpool, p_abr_state->max_bitpool);
+  p_abr_state->clear_ticks = 0;
+  a2dp_sbc_encoder_cb.stats.abr_lowest_bitpool = p_abr_state->max_bitpool;
 }
 
 void a2dp_sbc_encoder_cleanup(void) {
@@ -356,6 +388,36 @@ void a2dp_sbc_feeding_reset(void) {
 void a2dp_sbc_feeding_flush(void) {
   a2dp_sbc_encoder_cb.feeding_state.counter = 0.0f;
   a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue = 0;
+  a2dp_sbc_encoder_cb.feeding_state.aa_feed_consumed = 0;
+}
+
+void a2dp_sbc_set_transmit_queue_length(size_t transmit_queue_length) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+  tA2DP_SBC_ABR_STATE* p_abr_state = &a2dp_sbc_encoder_cb.abr_state;
+  int16_t bitpool = p_encoder_params->s16BitPool;
+
+  if (transmit_queue_length >= A2DP_SBC_ABR_QUEUE_CONGESTED) {
+    p_abr_state->clear_ticks = 0;
+    bitpool = std::max<int16_t>(bitpool - A2DP_SBC_ABR_BITPOOL_DOWN_STEP,
+                                p_abr_state->min_bitpool);
+  } else if (transmit_queue_length <= A2DP_SBC_ABR_QUEUE_CLEAR) {
+    if (++p_abr_state->clear_ticks >= A2DP_SBC_ABR_BITPOOL_UP_PERIOD) {
+      p_abr_state->clear_ticks = 0;
+      bitpool = std::min<int16_t>(bitpool + 1, p_abr_state->max_bitpool);
+    }
+  }
+  if (bitpool == p_encoder_params->s16BitPool) return;
+
+  LOG_VERBOSE("%s: queue length %zu, bitpool %d -> %d", __func__,
+              transmit_queue_length, p_encoder_params->s16BitPool, bitpool);
+  if (bitpool < p_encoder_params->s16BitPool) {
+    a2dp_sbc_encoder_cb.stats.abr_total_bitpool_decreases++;
+    a2dp_sbc_encoder_cb.stats.abr_lowest_bitpool =
+        std::min(a2dp_sbc_encoder_cb.stats.abr_lowest_bitpool, bitpool);
+  }
+  /* The bitpool of each frame is in its header, the encoder does not need to
+   * be restarted */
+  p_encoder_params->s16BitPool = bitpool;
 }
 
 uint64_t a2dp_sbc_get_encoder_interval_ms(void) {
@@ -500,16 +562,15 @@ static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
     a2dp_sbc_encoder_cb.stats.media_read_total_expected_packets++;
 
     do {
-      /* Fill allocated buffer with 0 */
-      memset(a2dp_sbc_encoder_cb.pcmBuffer, 0,
-             blocm_x_subband * p_encoder_params->s16NumOfChannels);
       //
       // Read the PCM data and encode it. If necessary, upsample the data.
+      // The PCM data is encoded from the buffer it was read or up-sampled
+      // to, and the frame is encoded in place in the media packet.
       //
       uint32_t num_bytes = 0;
-      if (a2dp_sbc_read_feeding(&num_bytes)) {
+      int16_t* input = nullptr;
+      if (a2dp_sbc_read_feeding(&input, &num_bytes)) {
         uint8_t* output = (uint8_t*)(p_buf + 1) + p_buf->offset + p_buf->len;
-        int16_t* input = a2dp_sbc_encoder_cb.pcmBuffer;
         uint16_t output_len = SBC_Encode(p_encoder_params, input, output);
         last_frame_len = output_len;
 
@@ -555,7 +616,19 @@ static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
   }
 }
 
-static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
+/*******************************************************************************
+ *
+ * Function         a2dp_sbc_read_feeding
+ *
+ * Description      Read the PCM data of one SBC frame, up-sampled if the
+ *                  feeding and SBC sampling rates differ.
+ *
+ * Returns          true when a frame of PCM data is available in *p_pcm,
+ *                  the number of bytes read from the source in *bytes_read.
+ *                  The PCM data is valid until the next call.
+ *
+ ******************************************************************************/
+static bool a2dp_sbc_read_feeding(int16_t** p_pcm, uint32_t* bytes_read) {
   SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
   uint16_t blocm_x_subband =
       p_encoder_params->s16NumOfSubBands * p_encoder_params->s16NumOfBlocks;
@@ -613,9 +686,21 @@ static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
     }
     a2dp_sbc_encoder_cb.stats.media_read_total_actual_reads_count++;
     a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue = 0;
+    *p_pcm = a2dp_sbc_encoder_cb.pcmBuffer;
     return true;
   }
 
+  /* Drop the up-sampled PCM samples encoded since the last read */
+  if (a2dp_sbc_encoder_cb.feeding_state.aa_feed_consumed != 0) {
+    if (a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue != 0) {
+      memmove((uint8_t*)up_sampled_buffer,
+              (uint8_t*)up_sampled_buffer +
+                  a2dp_sbc_encoder_cb.feeding_state.aa_feed_consumed,
+              a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue);
+    }
+    a2dp_sbc_encoder_cb.feeding_state.aa_feed_consumed = 0;
+  }
+
   /*
    * Some Feeding PCM frequencies require to split the number of sample
    * to read.
@@ -699,17 +784,11 @@ static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
   if (a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue < bytes_needed)
     return false;
 
-  /* Copy the output pcm samples in SBC encoding buffer */
-  memcpy((uint8_t*)a2dp_sbc_encoder_cb.pcmBuffer, (uint8_t*)up_sampled_buffer,
-         bytes_needed);
-  /* update the residue */
+  /* Encode the pcm samples from the up-sampling buffer, the residue is moved
+   * to the front at the next read */
+  *p_pcm = (int16_t*)up_sampled_buffer;
   a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue -= bytes_needed;
-
-  if (a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue != 0) {
-    memcpy((uint8_t*)up_sampled_buffer,
-           (uint8_t*)up_sampled_buffer + bytes_needed,
-           a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue);
-  }
+  a2dp_sbc_encoder_cb.feeding_state.aa_feed_consumed = bytes_needed;
   return true;
 }
 
@@ -916,4 +995,13 @@ void A2dpCodecConfigSbcSource::debug_codec_dump(int fd) {
           "%zu\n",
           stats->media_read_total_expected_frames,
           stats->media_read_total_dropped_frames);
+
+  dprintf(fd,
+          "  Bitpool (current/configured/lowest)                     : %d / "
+          "%d / %d\n",
+          a2dp_sbc_encoder_cb.sbc_encoder_params.s16BitPool,
+          a2dp_sbc_encoder_cb.abr_state.max_bitpool, stats->abr_lowest_bitpool);
+  dprintf(fd,
+          "  Bitpool decreases on congestion                         : %zu\n",
+          stats->abr_total_bitpool_decreases);
 }
@@ -21,27 +21,40 @@
  *  This module contains utility functions for dealing with SBC data frames
  *  and codec capabilities.
  *
+ *  The PCM feeding is converted to the SBC sample rate with the polyphase
+ *  resampler shared with LE Audio.
+ *
  ******************************************************************************/
 
 #include "a2dp_sbc_up_sample.h"
 
+#include <algorithm>
+#include <array>
+
+#include "audio/asrc/asrc_resampler.h"
+
+using bluetooth::audio::asrc::Resampler;
+
 typedef int(tA2DP_SBC_ACT)(void* p_src, void* p_dst, uint32_t src_samples,
                            uint32_t dst_samples, uint32_t* p_ret);
 
 typedef struct {
-  int32_t cur_pos;      /* current position */
   uint32_t src_sps;     /* samples per second (source audio data) */
   uint32_t dst_sps;     /* samples per second (converted audio data) */
   tA2DP_SBC_ACT* p_act; /* the action function to do the conversion */
   uint8_t bits;         /* number of bits per pcm sample */
   uint8_t n_channels;   /* number of channels (i.e. mono(1), stereo(2)...) */
-  int16_t worker1;
-  int16_t worker2;
   uint8_t div;
+  uint32_t ratio_q26; /* src_sps / dst_sps, in Q26 format */
 } tA2DP_SBC_UPS_CB;
 
 tA2DP_SBC_UPS_CB a2dp_sbc_ups_cb;
 
+/* Polyphase resamplers of the left and right channels, a mono source is
+ * resampled once and duplicated on both output channels. */
+static std::array<Resampler, 2> a2dp_sbc_ups_resamplers = {Resampler(16),
+                                                           Resampler(16)};
+
 /*******************************************************************************
  *
  * Function         a2dp_sbc_init_up_sample
@@ -53,16 +66,30 @@ tA2DP_SBC_UPS_CB a2dp_sbc_ups_cb;
  *                  bits: number of bits per pcm sample
  *                  n_channels: number of channels (i.e. mono(1), stereo(2)...)
  *
+ *                  The history of the resampling filter is kept when called
+ *                  again with the same parameters.
+ *
  * Returns          none
  *
  ******************************************************************************/
 void a2dp_sbc_init_up_sample(uint32_t src_sps, uint32_t dst_sps, uint8_t bits,
                              uint8_t n_channels) {
-  a2dp_sbc_ups_cb.cur_pos = -1;
+  if (a2dp_sbc_ups_cb.p_act != nullptr && a2dp_sbc_ups_cb.src_sps == src_sps &&
+      a2dp_sbc_ups_cb.dst_sps == dst_sps && a2dp_sbc_ups_cb.bits == bits &&
+      a2dp_sbc_ups_cb.n_channels == n_channels) {
+    return;
+  }
+
   a2dp_sbc_ups_cb.src_sps = src_sps;
   a2dp_sbc_ups_cb.dst_sps = dst_sps;
   a2dp_sbc_ups_cb.bits = bits;
   a2dp_sbc_ups_cb.n_channels = n_channels;
+  a2dp_sbc_ups_cb.ratio_q26 =
+      dst_sps ? ((uint64_t(src_sps) << 26) + dst_sps / 2) / dst_sps : 0;
+
+  for (auto& resampler : a2dp_sbc_ups_resamplers) {
+    resampler = Resampler(16);
+  }
 
   if (n_channels == 1) {
     /* mono */
@@ -126,6 +153,76 @@ int a2dp_sbc_up_sample(void* p_src, void* p_dst, uint32_t src_samples,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         a2dp_sbc_resample_16
+ *
+ * Description      Resample up to src_frames of 16 bits PCM, with n_channels
+ *                  interleaved channels, to at most dst_frames of 16 bits
+ *                  stereo PCM.
+ *
+ * Returns          The number of frames written to p_dst
+ *                  The number of frames read from p_src (in *p_src_used)
+ *
+ ******************************************************************************/
+static size_t a2dp_sbc_resample_16(const int16_t* p_src, uint8_t n_channels,
+                                   size_t src_frames, int16_t* p_dst,
+                                   size_t dst_frames, size_t* p_src_used) {
+  size_t in_count = 0;
+  size_t out_count = 0;
+  unsigned in_sub_q26;
+
+  for (uint8_t ch = 0; ch < n_channels; ch++) {
+    a2dp_sbc_ups_resamplers[ch].Resample<int16_t>(
+        a2dp_sbc_ups_cb.ratio_q26, p_src + ch, n_channels, src_frames,
+        &in_count, p_dst + ch, 2, dst_frames, &out_count, &in_sub_q26);
+  }
+
+  if (n_channels == 1) {
+    for (size_t i = 0; i < out_count; i++) p_dst[2 * i + 1] = p_dst[2 * i];
+  }
+
+  *p_src_used = in_count;
+  return out_count;
+}
+
+/*******************************************************************************
+ *
+ * Function         a2dp_sbc_resample_8
+ *
+ * Description      Same as a2dp_sbc_resample_16, for 8 bits unsigned PCM.
+ *                  The samples are converted to 16 bits by chunks.
+ *
+ * Returns          The number of frames written to p_dst
+ *                  The number of frames read from p_src (in *p_src_used)
+ *
+ ******************************************************************************/
+static size_t a2dp_sbc_resample_8(const uint8_t* p_src, uint8_t n_channels,
+                                  size_t src_frames, int16_t* p_dst,
+                                  size_t dst_frames, size_t* p_src_used) {
+  int16_t chunk[256];
+  size_t chunk_frames = sizeof(chunk) / sizeof(chunk[0]) / n_channels;
+  size_t src_used = 0;
+  size_t dst_used = 0;
+
+  while (src_used < src_frames && dst_used < dst_frames) {
+    size_t frames = std::min(chunk_frames, src_frames - src_used);
+    const uint8_t* p_chunk_src = p_src + src_used * n_channels;
+    for (size_t i = 0; i < frames * n_channels; i++) {
+      chunk[i] = (p_chunk_src[i] - 0x80) * 256;
+    }
+
+    size_t in_count;
+    dst_used +=
+        a2dp_sbc_resample_16(chunk, n_channels, frames, p_dst + 2 * dst_used,
+                             dst_frames - dst_used, &in_count);
+    src_used += in_count;
+  }
+
+  *p_src_used = src_used;
+  return dst_used;
+}
+
 /*******************************************************************************
  *
  * Function         a2dp_sbc_up_sample_16s (16bits-stereo)
@@ -147,42 +244,13 @@ int a2dp_sbc_up_sample(void* p_src, void* p_dst, uint32_t src_samples,
  ******************************************************************************/
 int a2dp_sbc_up_sample_16s(void* p_src, void* p_dst, uint32_t src_samples,
                            uint32_t dst_samples, uint32_t* p_ret) {
-  int16_t* p_src_tmp = (int16_t*)p_src;
-  int16_t* p_dst_tmp = (int16_t*)p_dst;
-  int16_t* p_worker1 = &a2dp_sbc_ups_cb.worker1;
-  int16_t* p_worker2 = &a2dp_sbc_ups_cb.worker2;
-  uint32_t src_sps = a2dp_sbc_ups_cb.src_sps;
-  uint32_t dst_sps = a2dp_sbc_ups_cb.dst_sps;
-
-  while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples) {
-    *p_dst_tmp++ = *p_worker1;
-    *p_dst_tmp++ = *p_worker2;
-
-    a2dp_sbc_ups_cb.cur_pos -= src_sps;
-    dst_samples--;
-  }
-
-  a2dp_sbc_ups_cb.cur_pos = dst_sps;
+  size_t src_used;
+  size_t dst_used =
+      a2dp_sbc_resample_16((const int16_t*)p_src, 2, src_samples,
+                           (int16_t*)p_dst, dst_samples, &src_used);
 
-  while (src_samples-- && dst_samples) {
-    *p_worker1 = *p_src_tmp++;
-    *p_worker2 = *p_src_tmp++;
-
-    do {
-      *p_dst_tmp++ = *p_worker1;
-      *p_dst_tmp++ = *p_worker2;
-
-      a2dp_sbc_ups_cb.cur_pos -= src_sps;
-      dst_samples--;
-    } while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples);
-
-    a2dp_sbc_ups_cb.cur_pos += dst_sps;
-  }
-
-  if (a2dp_sbc_ups_cb.cur_pos == (int32_t)dst_sps) a2dp_sbc_ups_cb.cur_pos = 0;
-
-  *p_ret = ((char*)p_src_tmp - (char*)p_src);
-  return ((char*)p_dst_tmp - (char*)p_dst);
+  *p_ret = src_used * 4;
+  return dst_used * 4;
 }
 
 /*******************************************************************************
@@ -206,43 +274,13 @@ int a2dp_sbc_up_sample_16s(void* p_src, void* p_dst, uint32_t src_samples,
  ******************************************************************************/
 int a2dp_sbc_up_sample_16m(void* p_src, void* p_dst, uint32_t src_samples,
                            uint32_t dst_samples, uint32_t* p_ret) {
-  int16_t* p_src_tmp = (int16_t*)p_src;
-  int16_t* p_dst_tmp = (int16_t*)p_dst;
-  int16_t* p_worker = &a2dp_sbc_ups_cb.worker1;
-  uint32_t src_sps = a2dp_sbc_ups_cb.src_sps;
-  uint32_t dst_sps = a2dp_sbc_ups_cb.dst_sps;
-
-  while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples) {
-    *p_dst_tmp++ = *p_worker;
-    *p_dst_tmp++ = *p_worker;
-
-    a2dp_sbc_ups_cb.cur_pos -= src_sps;
-    dst_samples--;
-    dst_samples--;
-  }
-
-  a2dp_sbc_ups_cb.cur_pos = dst_sps;
+  size_t src_used;
+  size_t dst_used =
+      a2dp_sbc_resample_16((const int16_t*)p_src, 1, src_samples,
+                           (int16_t*)p_dst, dst_samples / 2, &src_used);
 
-  while (src_samples-- && dst_samples) {
-    *p_worker = *p_src_tmp++;
-
-    do {
-      *p_dst_tmp++ = *p_worker;
-      *p_dst_tmp++ = *p_worker;
-
-      a2dp_sbc_ups_cb.cur_pos -= src_sps;
-      dst_samples--;
-      dst_samples--;
-
-    } while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples);
-
-    a2dp_sbc_ups_cb.cur_pos += dst_sps;
-  }
-
-  if (a2dp_sbc_ups_cb.cur_pos == (int32_t)dst_sps) a2dp_sbc_ups_cb.cur_pos = 0;
-
-  *p_ret = ((char*)p_src_tmp - (char*)p_src);
-  return ((char*)p_dst_tmp - (char*)p_dst);
+  *p_ret = src_used * 2;
+  return dst_used * 4;
 }
 
 /*******************************************************************************
@@ -266,48 +304,13 @@ int a2dp_sbc_up_sample_16m(void* p_src, void* p_dst, uint32_t src_samples,
  ******************************************************************************/
 int a2dp_sbc_up_sample_8s(void* p_src, void* p_dst, uint32_t src_samples,
                           uint32_t dst_samples, uint32_t* p_ret) {
-  uint8_t* p_src_tmp = (uint8_t*)p_src;
-  int16_t* p_dst_tmp = (int16_t*)p_dst;
-  int16_t* p_worker1 = &a2dp_sbc_ups_cb.worker1;
-  int16_t* p_worker2 = &a2dp_sbc_ups_cb.worker2;
-  uint32_t src_sps = a2dp_sbc_ups_cb.src_sps;
-  uint32_t dst_sps = a2dp_sbc_ups_cb.dst_sps;
-
-  while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples) {
-    *p_dst_tmp++ = *p_worker1;
-    *p_dst_tmp++ = *p_worker2;
-
-    a2dp_sbc_ups_cb.cur_pos -= src_sps;
-    dst_samples--;
-    dst_samples--;
-  }
-
-  a2dp_sbc_ups_cb.cur_pos = dst_sps;
-
-  while (src_samples-- && dst_samples) {
-    *p_worker1 = *(uint8_t*)p_src_tmp++;
-    *p_worker1 -= 0x80;
-    *p_worker1 <<= 8;
-    *p_worker2 = *(uint8_t*)p_src_tmp++;
-    *p_worker2 -= 0x80;
-    *p_worker2 <<= 8;
-
-    do {
-      *p_dst_tmp++ = *p_worker1;
-      *p_dst_tmp++ = *p_worker2;
-
-      a2dp_sbc_ups_cb.cur_pos -= src_sps;
-      dst_samples--;
-      dst_samples--;
-    } while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples);
+  size_t src_used;
+  size_t dst_used =
+      a2dp_sbc_resample_8((const uint8_t*)p_src, 2, src_samples,
+                          (int16_t*)p_dst, dst_samples / 2, &src_used);
 
-    a2dp_sbc_ups_cb.cur_pos += dst_sps;
-  }
-
-  if (a2dp_sbc_ups_cb.cur_pos == (int32_t)dst_sps) a2dp_sbc_ups_cb.cur_pos = 0;
-
-  *p_ret = ((char*)p_src_tmp - (char*)p_src);
-  return ((char*)p_dst_tmp - (char*)p_dst);
+  *p_ret = src_used * 2;
+  return dst_used * 4;
 }
 
 /*******************************************************************************
@@ -330,41 +333,11 @@ int a2dp_sbc_up_sample_8s(void* p_src, void* p_dst, uint32_t src_samples,
  ******************************************************************************/
 int a2dp_sbc_up_sample_8m(void* p_src, void* p_dst, uint32_t src_samples,
                           uint32_t dst_samples, uint32_t* p_ret) {
-  uint8_t* p_src_tmp = (uint8_t*)p_src;
-  int16_t* p_dst_tmp = (int16_t*)p_dst;
-  int16_t* p_worker = &a2dp_sbc_ups_cb.worker1;
-  uint32_t src_sps = a2dp_sbc_ups_cb.src_sps;
-  uint32_t dst_sps = a2dp_sbc_ups_cb.dst_sps;
-
-  while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples) {
-    *p_dst_tmp++ = *p_worker;
-    *p_dst_tmp++ = *p_worker;
-
-    a2dp_sbc_ups_cb.cur_pos -= src_sps;
-    dst_samples -= 4;
-  }
-
-  a2dp_sbc_ups_cb.cur_pos = dst_sps;
-
-  while (src_samples-- && dst_samples) {
-    *p_worker = *(uint8_t*)p_src_tmp++;
-    *p_worker -= 0x80;
-    *p_worker <<= 8;
-
-    do {
-      *p_dst_tmp++ = *p_worker;
-      *p_dst_tmp++ = *p_worker;
-
-      a2dp_sbc_ups_cb.cur_pos -= src_sps;
-      dst_samples -= 4;
-
-    } while (a2dp_sbc_ups_cb.cur_pos > 0 && dst_samples);
-
-    a2dp_sbc_ups_cb.cur_pos += dst_sps;
-  }
-
-  if (a2dp_sbc_ups_cb.cur_pos == (int32_t)dst_sps) a2dp_sbc_ups_cb.cur_pos = 0;
+  size_t src_used;
+  size_t dst_used =
+      a2dp_sbc_resample_8((const uint8_t*)p_src, 1, src_samples,
+                          (int16_t*)p_dst, dst_samples / 4, &src_used);
 
-  *p_ret = ((char*)p_src_tmp - (char*)p_src);
-  return ((char*)p_dst_tmp - (char*)p_dst);
+  *p_ret = src_used;
+  return dst_used * 4;
 }
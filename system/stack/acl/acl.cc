@@ -42,3 +42,74 @@ void tACL_CONN::Reset() {
   switch_role_state_ = BTM_ACL_SWKEY_STATE_IDLE;
   sca = 0;
 }
+
+std::unordered_map<RawAddress, uint8_t>* tACL_CB::AddressIndex(
+    tBT_TRANSPORT transport) {
+  switch (transport) {
+    case BT_TRANSPORT_BR_EDR:
+      return &br_edr_address_index_;
+    case BT_TRANSPORT_LE:
+      return &le_address_index_;
+    default:
+      return nullptr;
+  }
+}
+
+/* An entry already indexed for the same key stays there, as the first match */
+void tACL_CB::IndexConnection(const tACL_CONN* p_acl) {
+  uint8_t index = p_acl - acl_db;
+  handle_index_.emplace(p_acl->hci_handle, index);
+  auto* address_index = AddressIndex(p_acl->transport);
+  if (address_index != nullptr) {
+    address_index->emplace(p_acl->remote_addr, index);
+  }
+}
+
+void tACL_CB::UnindexConnection(const tACL_CONN* p_acl) {
+  uint8_t index = p_acl - acl_db;
+  bool handle_indexed = false;
+  bool address_indexed = false;
+
+  auto handle_it = handle_index_.find(p_acl->hci_handle);
+  if (handle_it != handle_index_.end() && handle_it->second == index) {
+    handle_index_.erase(handle_it);
+    handle_indexed = true;
+  }
+  auto* address_index = AddressIndex(p_acl->transport);
+  if (address_index != nullptr) {
+    auto address_it = address_index->find(p_acl->remote_addr);
+    if (address_it != address_index->end() && address_it->second == index) {
+      address_index->erase(address_it);
+      address_indexed = true;
+    }
+  }
+  if (!handle_indexed && !address_indexed) return;
+
+  /* Another entry with the same key is the first match now */
+  for (uint8_t xx = 0; xx < MAX_L2CAP_LINKS; xx++) {
+    const tACL_CONN& other = acl_db[xx];
+    if (xx == index || !other.in_use) continue;
+    if (handle_indexed && other.hci_handle == p_acl->hci_handle) {
+      handle_index_.emplace(other.hci_handle, xx);
+    }
+    if (address_indexed && other.transport == p_acl->transport &&
+        other.remote_addr == p_acl->remote_addr) {
+      address_index->emplace(other.remote_addr, xx);
+    }
+  }
+}
+
+uint8_t tACL_CB::FindIndexByHandle(uint16_t hci_handle) const {
+  auto it = handle_index_.find(hci_handle);
+  if (it == handle_index_.end()) return MAX_L2CAP_LINKS;
+  return it->second;
+}
+
+tACL_CONN* tACL_CB::FindByAddress(const RawAddress& bd_addr,
+                                  tBT_TRANSPORT transport) {
+  auto* address_index = AddressIndex(transport);
+  if (address_index == nullptr) return nullptr;
+  auto it = address_index->find(bd_addr);
+  if (it == address_index->end()) return nullptr;
+  return &acl_db[it->second];
+}
@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 
 #include "internal_include/bt_target.h"
 #include "internal_include/bt_trace.h"
@@ -152,6 +153,14 @@ typedef struct {
   tHCI_ROLE role;            /* HCI_ROLE_CENTRAL or HCI_ROLE_PERIPHERAL */
 } tBTM_ROLE_SWITCH_CMPL;
 
+/* Traffic seen on a link, used to adapt its sniff requests */
+struct tBTM_PM_TRAFFIC {
+  uint64_t last_packet_ms = 0;
+  uint32_t gap_ms = 0;         /* smoothed idle time between bursts */
+  uint16_t gaps = 0;           /* number of gaps measured, saturates */
+  uint16_t sniff_interval = 0; /* last sniff interval requested */
+};
+
 struct tBTM_PM_MCB {
   bool chg_ind = false;
   tBTM_PM_PWR_MD req_mode;
@@ -161,6 +170,8 @@ struct tBTM_PM_MCB {
   uint16_t max_lat = 0;
   uint16_t min_loc_to = 0;
   uint16_t min_rmt_to = 0;
+  tBTM_PM_TRAFFIC traffic;
+  uint16_t max_sniff_interval = 0; /* exit latency guard, 0 if none */
   void Init(RawAddress bda, uint16_t handle) {
     bda_ = bda;
     handle_ = handle;
@@ -330,6 +341,18 @@ struct tACL_CB {
   friend struct StackAclBtmAcl;
 
   tACL_CONN acl_db[MAX_L2CAP_LINKS];
+  /* acl_db index of the in use entries, by handle and by address for each
+   * transport. Updated when an entry is taken in use, released, or when its
+   * handle or address changes. */
+  std::unordered_map<uint16_t, uint8_t> handle_index_;
+  std::unordered_map<RawAddress, uint8_t> br_edr_address_index_;
+  std::unordered_map<RawAddress, uint8_t> le_address_index_;
+
+  std::unordered_map<RawAddress, uint8_t>* AddressIndex(
+      tBT_TRANSPORT transport);
+  uint8_t FindIndexByHandle(uint16_t hci_handle) const;
+  tACL_CONN* FindByAddress(const RawAddress& bd_addr, tBT_TRANSPORT transport);
+
   tBTM_ROLE_SWITCH_CMPL switch_role_ref_data;
   uint16_t btm_acl_pkt_types_supported = kDefaultPacketTypeMask;
   uint16_t btm_def_link_policy;
@@ -348,6 +371,13 @@ struct tACL_CB {
   uint16_t DefaultPacketTypes() const { return btm_acl_pkt_types_supported; }
   uint16_t DefaultLinkPolicy() const { return btm_def_link_policy; }
 
+  /* Called once an acl_db entry is in use, and after its handle or address
+   * changed */
+  void IndexConnection(const tACL_CONN* p_acl);
+  /* Called before an acl_db entry is released, or its handle or address
+   * changes */
+  void UnindexConnection(const tACL_CONN* p_acl);
+
   struct {
     std::vector<tBTM_PM_STATUS_CBACK*> clients;
   } link_policy;
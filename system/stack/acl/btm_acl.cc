@@ -303,14 +303,7 @@ void BTM_acl_after_controller_started(const controller_t* controller) {
  ******************************************************************************/
 tACL_CONN* StackAclBtmAcl::btm_bda_to_acl(const RawAddress& bda,
                                           tBT_TRANSPORT transport) {
-  tACL_CONN* p_acl = &btm_cb.acl_cb_.acl_db[0];
-  for (uint8_t index = 0; index < MAX_L2CAP_LINKS; index++, p_acl++) {
-    if ((p_acl->in_use) && p_acl->remote_addr == bda &&
-        p_acl->transport == transport) {
-      return p_acl;
-    }
-  }
-  return nullptr;
+  return btm_cb.acl_cb_.FindByAddress(bda, transport);
 }
 
 tACL_CONN* acl_get_connection_from_address(const RawAddress& bd_addr,
@@ -320,17 +313,21 @@ tACL_CONN* acl_get_connection_from_address(const RawAddress& bd_addr,
 
 void StackAclBtmAcl::btm_acl_consolidate(const RawAddress& identity_addr,
                                          const RawAddress& rpa) {
-  tACL_CONN* p_acl = &btm_cb.acl_cb_.acl_db[0];
-  for (uint8_t index = 0; index < MAX_L2CAP_LINKS; index++, p_acl++) {
-    if (!p_acl->in_use) continue;
+  tACL_CB& acl_cb = btm_cb.acl_cb_;
 
-    if (p_acl->remote_addr == rpa) {
-      LOG_INFO("consolidate %s -> %s", ADDRESS_TO_LOGGABLE_CSTR(rpa),
-               ADDRESS_TO_LOGGABLE_CSTR(identity_addr));
-      p_acl->remote_addr = identity_addr;
-      return;
-    }
+  /* First entry with this address, on either transport */
+  tACL_CONN* p_acl = acl_cb.FindByAddress(rpa, BT_TRANSPORT_BR_EDR);
+  tACL_CONN* p_le_acl = acl_cb.FindByAddress(rpa, BT_TRANSPORT_LE);
+  if (p_acl == nullptr || (p_le_acl != nullptr && p_le_acl < p_acl)) {
+    p_acl = p_le_acl;
   }
+  if (p_acl == nullptr) return;
+
+  LOG_INFO("consolidate %s -> %s", ADDRESS_TO_LOGGABLE_CSTR(rpa),
+           ADDRESS_TO_LOGGABLE_CSTR(identity_addr));
+  acl_cb.UnindexConnection(p_acl);
+  p_acl->remote_addr = identity_addr;
+  acl_cb.IndexConnection(p_acl);
 }
 
 void btm_acl_consolidate(const RawAddress& identity_addr,
@@ -349,16 +346,7 @@ void btm_acl_consolidate(const RawAddress& identity_addr,
  *
  ******************************************************************************/
 uint8_t btm_handle_to_acl_index(uint16_t hci_handle) {
-  tACL_CONN* p = &btm_cb.acl_cb_.acl_db[0];
-  uint8_t xx;
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p++) {
-    if ((p->in_use) && (p->hci_handle == hci_handle)) {
-      break;
-    }
-  }
-
-  /* If here, no BD Addr found */
-  return (xx);
+  return btm_cb.acl_cb_.FindIndexByHandle(hci_handle);
 }
 
 tACL_CONN* StackAclBtmAcl::acl_get_connection_from_handle(uint16_t hci_handle) {
@@ -414,9 +402,11 @@ void btm_acl_created(const RawAddress& bda, uint16_t hci_handle,
                      tHCI_ROLE link_role, tBT_TRANSPORT transport) {
   tACL_CONN* p_acl = internal_.btm_bda_to_acl(bda, transport);
   if (p_acl != (tACL_CONN*)NULL) {
+    btm_cb.acl_cb_.UnindexConnection(p_acl);
     p_acl->hci_handle = hci_handle;
     p_acl->link_role = link_role;
     p_acl->transport = transport;
+    btm_cb.acl_cb_.IndexConnection(p_acl);
     if (transport == BT_TRANSPORT_BR_EDR) {
       btm_set_link_policy(p_acl, btm_cb.acl_cb_.DefaultLinkPolicy());
     }
@@ -443,6 +433,7 @@ void btm_acl_created(const RawAddress& bda, uint16_t hci_handle,
   p_acl->transport = transport;
   p_acl->switch_role_failed_attempts = 0;
   p_acl->reset_switch_role();
+  btm_cb.acl_cb_.IndexConnection(p_acl);
 
   LOG_DEBUG(
       "Created new ACL connection peer:%s role:%s handle:0x%04x transport:%s",
@@ -498,6 +489,7 @@ void btm_acl_removed(uint16_t handle) {
     LOG_WARN("Unable to find active acl");
     return;
   }
+  btm_cb.acl_cb_.UnindexConnection(p_acl);
   p_acl->in_use = false;
   NotifyAclLinkDown(*p_acl);
   if (p_acl->is_transport_br_edr()) {
@@ -2634,6 +2626,7 @@ void acl_send_data_packet_br_edr(const RawAddress& bd_addr, BT_HDR* p_buf) {
       return;
     }
     power_telemetry::GetInstance().LogTxAclPktData(p_buf->len);
+    BTM_PM_OnAclTraffic(p_acl->hci_handle);
     return bluetooth::shim::ACL_WriteData(p_acl->hci_handle, p_buf);
 }
 
@@ -2727,6 +2720,7 @@ void acl_rcv_acl_data(BT_HDR* p_msg) {
     osi_free(p_msg);
     return;
   }
+  BTM_PM_OnAclTraffic(acl_header.handle);
   l2c_rcv_acl_data(p_msg);
 }
 
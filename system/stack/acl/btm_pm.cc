@@ -32,9 +32,11 @@
 
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <unordered_map>
 
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "internal_include/bt_target.h"
@@ -91,9 +93,124 @@ const uint8_t
 
         BTM_PM_GET_MD1,  BTM_PM_GET_MD2,  BTM_PM_GET_COMP};
 
+/*****************************************************************************/
+/*      to adapt the sniff requests to the traffic of the link               */
+/*****************************************************************************/
+/* Packets closer than this belong to the same burst */
+#ifndef BTM_PM_TRAFFIC_BURST_MS
+#define BTM_PM_TRAFFIC_BURST_MS 20
+#endif
+
+/* Longer gaps count as this, an idle link is detected separately */
+#ifndef BTM_PM_TRAFFIC_MAX_GAP_MS
+#define BTM_PM_TRAFFIC_MAX_GAP_MS 10000
+#endif
+
+/* Gaps measured before the traffic is used */
+#ifndef BTM_PM_TRAFFIC_MIN_GAPS
+#define BTM_PM_TRAFFIC_MIN_GAPS 4
+#endif
+
+/* A link quiet for this many smoothed gaps is idle, and uses the requested
+ * sniff intervals */
+#ifndef BTM_PM_TRAFFIC_IDLE_GAPS
+#define BTM_PM_TRAFFIC_IDLE_GAPS 4
+#endif
+
+static void btm_pm_traffic_update(tBTM_PM_TRAFFIC* p_traffic, uint64_t now_ms) {
+  if (p_traffic->last_packet_ms != 0) {
+    uint64_t gap_ms = now_ms - p_traffic->last_packet_ms;
+    if (gap_ms >= BTM_PM_TRAFFIC_BURST_MS) {
+      gap_ms = std::min<uint64_t>(gap_ms, BTM_PM_TRAFFIC_MAX_GAP_MS);
+      if (p_traffic->gaps == 0) {
+        p_traffic->gap_ms = gap_ms;
+      } else {
+        /* moving average, 1/8 weight to the new gap */
+        p_traffic->gap_ms = (7 * uint64_t{p_traffic->gap_ms} + gap_ms) / 8;
+      }
+      if (p_traffic->gaps < UINT16_MAX) p_traffic->gaps++;
+    }
+  }
+  p_traffic->last_packet_ms = now_ms;
+}
+
+/* Returns the smoothed gap between bursts in slots, or 0 if the link is idle
+ * or not enough traffic was seen */
+static uint32_t btm_pm_traffic_gap_slots(const tBTM_PM_TRAFFIC& traffic,
+                                         uint64_t now_ms) {
+  if (traffic.gaps < BTM_PM_TRAFFIC_MIN_GAPS) return 0;
+  if (now_ms - traffic.last_packet_ms >
+      uint64_t{BTM_PM_TRAFFIC_IDLE_GAPS} * traffic.gap_ms) {
+    return 0;
+  }
+  /* 0.625 ms slots */
+  return traffic.gap_ms * 8 / 5;
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_pm_adapt_sniff
+ *
+ * Description      Choose the sniff interval within the requested range:
+ *                  half the gap between traffic bursts on a busy link, so the
+ *                  bursts do not wait long for an anchor point, and the
+ *                  requested maximum on an idle link. The interval is kept
+ *                  while the traffic calls for less than twice or half of it,
+ *                  to avoid sniff renegotiations. It never exceeds the exit
+ *                  latency guard of the link.
+ *
+ * Returns          the sniff request to use
+ *
+ ******************************************************************************/
+static tBTM_PM_PWR_MD btm_pm_adapt_sniff(tBTM_PM_MCB* p_cb,
+                                         const tBTM_PM_PWR_MD& requested) {
+  tBTM_PM_PWR_MD md = requested;
+  uint16_t max = requested.max;
+  if (p_cb->max_sniff_interval != 0 && p_cb->max_sniff_interval < max) {
+    max = p_cb->max_sniff_interval;
+  }
+  uint16_t min = std::min(requested.min, max);
+
+  uint32_t target = max;
+  uint32_t gap_slots = btm_pm_traffic_gap_slots(
+      p_cb->traffic, bluetooth::common::time_get_os_boottime_ms());
+  if (gap_slots != 0) {
+    /* sniff intervals are even */
+    target = std::clamp<uint32_t>((gap_slots / 2) & ~1u, min, max);
+  }
+
+  uint16_t current = (p_cb->state == BTM_PM_ST_SNIFF)
+                         ? p_cb->interval
+                         : p_cb->traffic.sniff_interval;
+  if (current >= min && current <= max && current <= 2 * target &&
+      target <= 2 * uint32_t{current}) {
+    target = current;
+  }
+
+  md.max = target;
+  md.min = min;
+  p_cb->traffic.sniff_interval = target;
+  return md;
+}
+
+/* Sniff subrating lets the link skip anchor points up to max_lat. On a busy
+ * link, skipping past the next traffic burst only delays it. */
+static uint16_t btm_pm_adapt_ssr_max_lat(const tBTM_PM_MCB& cb,
+                                         uint16_t max_lat) {
+  uint32_t gap_slots = btm_pm_traffic_gap_slots(
+      cb.traffic, bluetooth::common::time_get_os_boottime_ms());
+  if (max_lat == 0 || gap_slots == 0 || gap_slots >= max_lat) return max_lat;
+  return std::max<uint32_t>(gap_slots, cb.interval);
+}
+
 static void send_sniff_subrating(uint16_t handle, const RawAddress& addr,
                                  uint16_t max_lat, uint16_t min_rmt_to,
                                  uint16_t min_loc_to) {
+  auto it = pm_mode_db.find(handle);
+  if (it != pm_mode_db.end()) {
+    max_lat = btm_pm_adapt_ssr_max_lat(it->second, max_lat);
+  }
+
   uint16_t new_max_lat = 0;
   if (interop_match_addr_get_max_lat(INTEROP_UPDATE_HID_SSR_MAX_LAT, &addr,
                                      &new_max_lat)) {
@@ -166,6 +283,13 @@ void BTM_PM_OnDisconnected(uint16_t handle) {
   }
 }
 
+void BTM_PM_OnAclTraffic(uint16_t handle) {
+  auto it = pm_mode_db.find(handle);
+  if (it == pm_mode_db.end()) return;
+  btm_pm_traffic_update(&it->second.traffic,
+                        bluetooth::common::time_get_os_boottime_ms());
+}
+
 /*******************************************************************************
  *
  * Function         BTM_SetPowerMode
@@ -210,6 +334,16 @@ tBTM_STATUS BTM_SetPowerMode(uint8_t pm_id, const RawAddress& remote_bda,
     mode &= (~BTM_PM_MD_FORCE);
   }
 
+  tBTM_PM_PWR_MD sniff_mode;
+  if (mode == BTM_PM_MD_SNIFF && p_mode->max != 0) {
+    sniff_mode = btm_pm_adapt_sniff(p_cb, *p_mode);
+    if (sniff_mode.max != p_mode->max || sniff_mode.min != p_mode->min) {
+      LOG_DEBUG("Adapted sniff interval max:%hu min:%hu => max:%hu min:%hu",
+                p_mode->max, p_mode->min, sniff_mode.max, sniff_mode.min);
+    }
+    p_mode = &sniff_mode;
+  }
+
   if (mode != BTM_PM_MD_ACTIVE) {
     const controller_t* controller = controller_get_interface();
     if ((mode == BTM_PM_MD_HOLD && !controller->supports_hold_mode()) ||
@@ -285,6 +419,23 @@ bool BTM_SetLinkPolicyActiveMode(const RawAddress& remote_bda) {
   }
 }
 
+tBTM_STATUS BTM_PM_SetMaxSniffInterval(const RawAddress& remote_bda,
+                                       uint16_t max_interval) {
+  tBTM_PM_MCB* p_cb = btm_pm_get_power_manager_from_address(remote_bda);
+  if (p_cb == nullptr) {
+    LOG_WARN("Unable to find power manager for peer:%s",
+             ADDRESS_TO_LOGGABLE_CSTR(remote_bda));
+    return BTM_UNKNOWN_ADDR;
+  }
+  if (p_cb->max_sniff_interval != max_interval) {
+    LOG_INFO("Max sniff interval peer:%s %hu => %hu",
+             ADDRESS_TO_LOGGABLE_CSTR(remote_bda), p_cb->max_sniff_interval,
+             max_interval);
+  }
+  p_cb->max_sniff_interval = max_interval;
+  return BTM_SUCCESS;
+}
+
 bool BTM_ReadPowerMode(const RawAddress& remote_bda, tBTM_PM_MODE* p_mode) {
   if (p_mode == nullptr) {
     LOG_ERROR("power mode is nullptr");
@@ -874,7 +874,9 @@ uint16_t AVDT_WriteReqOpt(uint8_t handle, BT_HDR* p_pkt, uint32_t time_stamp,
     evt.apiwrite.time_stamp = time_stamp;
     evt.apiwrite.m_pt = m_pt;
     evt.apiwrite.opt = opt;
-    avdt_scb_event(p_scb, AVDT_SCB_API_WRITE_REQ_EVT, &evt);
+    if (!avdt_scb_fast_write_req(p_scb, &evt)) {
+      avdt_scb_event(p_scb, AVDT_SCB_API_WRITE_REQ_EVT, &evt);
+    }
   }
 
   LOG_VERBOSE("%s: result=%d avdt_handle=%d", __func__, result, handle);
@@ -425,6 +425,11 @@ class AvdtpScb {
         curr_evt(0),
         cong(false),
         close_code(0),
+        curr_stream(false),
+        media_fast_path(false),
+        media_lcid(0),
+        media_rtp_header(false),
+        media_ssrc(0),
         scb_handle_(0) {}
 
   /**
@@ -474,6 +479,11 @@ class AvdtpScb {
     curr_evt = 0;
     cong = false;
     close_code = 0;
+    curr_stream = false;
+    media_fast_path = false;
+    media_lcid = 0;
+    media_rtp_header = false;
+    media_ssrc = 0;
     scb_handle_ = scb_handle;
   }
 
@@ -500,6 +510,15 @@ class AvdtpScb {
   uint8_t close_code;  // Error code received in close response
   bool curr_stream;    // True if the SCB is the current stream, False otherwise
 
+  // Media fast path: the state of the streaming SCB that media packets
+  // depend on, resolved by avdt_scb_update_media_fast_path() when the state
+  // of an SCB changes, so that the packets sent while the SCB is the only
+  // streaming one bypass the state machine.
+  bool media_fast_path;   // True if the media fast path is armed
+  uint16_t media_lcid;    // L2CAP channel of the media transport channel
+  bool media_rtp_header;  // True if the media packets have an RTP header
+  uint32_t media_ssrc;    // SSRC of the RTP header of the media packets
+
  private:
   uint8_t scb_handle_;  // Unique handle for this AvdtpScb entry
 };
@@ -844,6 +863,8 @@ uint8_t avdt_scb_verify(AvdtpCcb* p_ccb, uint8_t state, uint8_t* p_seid,
                         uint16_t num_seid, uint8_t* p_err_code);
 void avdt_scb_peer_seid_list(tAVDT_MULTI* p_multi);
 uint32_t avdt_scb_gen_ssrc(AvdtpScb* p_scb);
+void avdt_scb_update_media_fast_path(void);
+bool avdt_scb_fast_write_req(AvdtpScb* p_scb, tAVDT_SCB_EVT* p_data);
 
 /* SCB action functions */
 void avdt_scb_hdl_abort_cmd(AvdtpScb* p_scb, tAVDT_SCB_EVT* p_data);
@@ -25,11 +25,15 @@
 
 #include <string.h>
 
+#include "a2dp_codec_api.h"
 #include "avdt_api.h"
 #include "avdt_int.h"
 #include "avdtc_api.h"
+#include "gd/common/audio_pipeline_trace.h"
 #include "internal_include/bt_target.h"
+#include "l2c_api.h"
 #include "osi/include/osi.h"
+#include "stack/include/btm_api.h"
 
 /*****************************************************************************
  * state machine constants and types
@@ -800,8 +804,10 @@ void avdt_scb_event(AvdtpScb* p_scb, uint8_t event, tAVDT_SCB_EVT* p_data) {
   state_table = avdt_scb_st_tbl[p_scb->state];
 
   /* set next state */
+  bool state_changed = false;
   if (p_scb->state != state_table[event][AVDT_SCB_NEXT_STATE]) {
     p_scb->state = state_table[event][AVDT_SCB_NEXT_STATE];
+    state_changed = true;
   }
 
   /* execute action functions */
@@ -813,6 +819,71 @@ void avdt_scb_event(AvdtpScb* p_scb, uint8_t event, tAVDT_SCB_EVT* p_data) {
       break;
     }
   }
+
+  /* the media fast path depends on the state of all the SCBs, and on the
+   * transport channel and configuration the actions may have updated */
+  if (state_changed) {
+    avdt_scb_update_media_fast_path();
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         avdt_scb_update_media_fast_path
+ *
+ * Description      Arm the media fast path of the streaming SCB if it is the
+ *                  only SCB in the streaming state, and disarm it for all the
+ *                  other SCBs.  An armed SCB has its media L2CAP channel, RTP
+ *                  header usage and SSRC resolved, and its media packets
+ *                  bypass the state machine until the state of an SCB
+ *                  changes again.
+ *
+ * Returns          Nothing.
+ *
+ ******************************************************************************/
+void avdt_scb_update_media_fast_path(void) {
+  AvdtpScb* p_stream_scb = nullptr;
+  uint8_t num_st_streams = 0;
+
+  for (int i = 0; i < AVDT_NUM_LINKS; i++) {
+    for (int j = 0; j < AVDT_NUM_SEPS; j++) {
+      AvdtpScb* p_avdt_scb = &avdtp_cb.ccb[i].scb[j];
+      p_avdt_scb->media_fast_path = false;
+      if (p_avdt_scb->allocated &&
+          avdt_scb_st_tbl[p_avdt_scb->state] == avdt_scb_st_stream) {
+        num_st_streams++;
+        p_stream_scb = p_avdt_scb;
+      }
+    }
+  }
+
+  bluetooth::common::AudioPipelineTrace::ClearMediaChannel();
+  if (num_st_streams != 1 || p_stream_scb->p_ccb == nullptr) {
+    return;
+  }
+
+  uint8_t tcid = avdt_ad_type_to_tcid(AVDT_CHAN_MEDIA, p_stream_scb);
+  p_stream_scb->media_lcid =
+      avdtp_cb.ad.rt_tbl[avdt_ccb_to_idx(p_stream_scb->p_ccb)][tcid].lcid;
+  p_stream_scb->media_rtp_header =
+      A2DP_UsesRtpHeader(p_stream_scb->curr_cfg.num_protect > 0,
+                         p_stream_scb->curr_cfg.codec_info);
+  p_stream_scb->media_ssrc = avdt_scb_gen_ssrc(p_stream_scb);
+  p_stream_scb->media_fast_path = true;
+
+  uint16_t remote_cid;
+  if (p_stream_scb->media_rtp_header &&
+      bluetooth::common::AudioPipelineTrace::IsEnabled() &&
+      L2CA_GetRemoteCid(p_stream_scb->media_lcid, &remote_cid)) {
+    bluetooth::common::AudioPipelineTrace::SetMediaChannel(
+        BTM_GetHCIConnHandle(p_stream_scb->p_ccb->peer_addr,
+                             BT_TRANSPORT_BR_EDR),
+        remote_cid);
+  }
+
+  LOG_VERBOSE("%s: SCB hdl=%d lcid=0x%04x rtp_header=%s", __func__,
+              avdt_scb_to_hdl(p_stream_scb), p_stream_scb->media_lcid,
+              p_stream_scb->media_rtp_header ? "true" : "false");
 }
 
 /*******************************************************************************
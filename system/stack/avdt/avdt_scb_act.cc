@@ -30,7 +30,9 @@
 #include "a2dp_codec_api.h"
 #include "avdt_api.h"
 #include "avdt_int.h"
+#include "gd/common/audio_pipeline_trace.h"
 #include "internal_include/bt_target.h"
+#include "l2c_api.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/osi.h"
@@ -1029,6 +1031,62 @@ void avdt_scb_hdl_write_req(AvdtpScb* p_scb, tAVDT_SCB_EVT* p_data) {
   p_scb->p_pkt = p_data->apiwrite.p_buf;
 }
 
+/*******************************************************************************
+ *
+ * Function         avdt_scb_fast_write_req
+ *
+ * Description      This function sends a media packet on the media fast path
+ *                  of the SCB, with the same effect as sending the
+ *                  AVDT_SCB_API_WRITE_REQ_EVT to the SCB state machine in the
+ *                  streaming state.  The packet is sent only if the fast path
+ *                  is armed and no packet is waiting on congestion.
+ *
+ * Returns          true if the packet was consumed, false if it must go
+ *                  through the state machine.
+ *
+ ******************************************************************************/
+bool avdt_scb_fast_write_req(AvdtpScb* p_scb, tAVDT_SCB_EVT* p_data) {
+  tAVDT_CTRL avdt_ctrl;
+  BT_HDR* p_buf = p_data->apiwrite.p_buf;
+
+  if (!p_scb->media_fast_path || p_scb->cong || p_scb->p_pkt != NULL) {
+    return false;
+  }
+
+  p_scb->curr_evt = AVDT_SCB_API_WRITE_REQ_EVT;
+
+  /* Build a media packet, and add an RTP header if required. */
+  if (p_scb->media_rtp_header &&
+      !(p_data->apiwrite.opt & AVDT_DATA_OPT_NO_RTP)) {
+    if (p_buf->offset < AVDT_MEDIA_HDR_SIZE) {
+      LOG_WARN("Dropped media packet; no room for the RTP header");
+      osi_free(p_buf);
+      return true;
+    }
+
+    p_buf->len += AVDT_MEDIA_HDR_SIZE;
+    p_buf->offset -= AVDT_MEDIA_HDR_SIZE;
+    p_scb->media_seq++;
+    uint8_t* p = (uint8_t*)(p_buf + 1) + p_buf->offset;
+
+    UINT8_TO_BE_STREAM(p, AVDT_MEDIA_OCTET1);
+    UINT8_TO_BE_STREAM(p, p_data->apiwrite.m_pt);
+    UINT16_TO_BE_STREAM(p, p_scb->media_seq);
+    UINT32_TO_BE_STREAM(p, p_data->apiwrite.time_stamp);
+    UINT32_TO_BE_STREAM(p, p_scb->media_ssrc);
+    bluetooth::common::AudioPipelineTrace::OnMediaPacketWritten(
+        p_scb->media_seq);
+  }
+
+  L2CA_DataWrite(p_scb->media_lcid, p_buf);
+
+  avdt_ctrl.hdr.err_code = 0;
+  (*p_scb->stream_config.p_avdt_ctrl_cback)(
+      avdt_scb_to_hdl(p_scb), RawAddress::kEmpty, AVDT_WRITE_CFM_EVT,
+      &avdt_ctrl, p_scb->stream_config.scb_index);
+  return true;
+}
+
 /*******************************************************************************
  *
  * Function         avdt_scb_snd_abort_req
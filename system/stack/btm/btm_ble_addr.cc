@@ -32,8 +32,11 @@
 #include "btm_ble_int.h"
 #include "btm_dev.h"
 #include "btm_sec_cb.h"
+#include "common/time_util.h"
 #include "crypto_toolbox/crypto_toolbox.h"
+#include "gd/common/flat_lru_cache.h"
 #include "device/include/controller.h"
+#include "main/shim/dumpsys.h"
 #include "os/log.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/include/acl_api.h"
@@ -45,6 +48,34 @@
 
 extern tBTM_CB btm_cb;
 
+namespace {
+
+/* Number of random addresses whose resolution is remembered */
+constexpr size_t kRpaResolutionCacheSize = 256;
+/* A peer keeps its RPA for 15 minutes by default, the resolution of an
+ * address is not kept longer */
+constexpr uint64_t kRpaResolutionLifetimeMs = 15 * 60 * 1000;
+
+struct RpaResolution {
+  /* nullptr when no IRK resolves the address */
+  tBTM_SEC_DEV_REC* p_dev_rec;
+  uint64_t expiry_ms;
+};
+
+struct RpaResolutionStats {
+  uint64_t hits = 0;
+  uint64_t unresolved_hits = 0;
+  uint64_t misses = 0;
+};
+
+bluetooth::common::FlatLruCache<
+    RawAddress, RpaResolution,
+    bluetooth::common::LruEntryCount<RawAddress, RpaResolution>>
+    rpa_resolution_cache(kRpaResolutionCacheSize);
+RpaResolutionStats rpa_resolution_stats;
+
+}  // namespace
+
 /* This function generates Resolvable Private Address (RPA) from Identity
  * Resolving Key |irk| and |random|*/
 static RawAddress generate_rpa_from_irk_and_rand(const Octet16& irk,
@@ -177,17 +208,103 @@ static bool btm_ble_match_random_bda(void* data, void* context) {
   return true;
 }
 
+/** This function matches the random address to the IRKs of all the device
+ * records, in list order, encrypting a batch of IRKs at a time. */
+static tBTM_SEC_DEV_REC* btm_ble_match_random_bda_in_all_records(
+    const RawAddress& rpa) {
+  constexpr size_t kBatchSize = 8;
+  tBTM_SEC_DEV_REC* records[kBatchSize];
+  Octet16 irks[kBatchSize];
+  Octet16 x[kBatchSize];
+  size_t count = 0;
+
+  /* use the 3 MSB of bd address as prand */
+  Octet16 rand{};
+  rand[0] = rpa.address[2];
+  rand[1] = rpa.address[1];
+  rand[2] = rpa.address[0];
+  const uint8_t hash[3] = {rpa.address[5], rpa.address[4], rpa.address[3]};
+
+  list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec);
+  while (true) {
+    bool end = node == list_end(btm_sec_cb.sec_dev_rec);
+    if (!end) {
+      tBTM_SEC_DEV_REC* p_dev_rec =
+          static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+      node = list_next(node);
+      if ((p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) &&
+          (p_dev_rec->sec_rec.ble_keys.key_type & BTM_LE_KEY_PID)) {
+        records[count] = p_dev_rec;
+        irks[count] = p_dev_rec->sec_rec.ble_keys.irk;
+        count++;
+      }
+    }
+
+    if (count == kBatchSize || (end && count > 0)) {
+      crypto_toolbox::aes_128_multi_key(irks, count, rand, x);
+      for (size_t i = 0; i < count; i++) {
+        if (memcmp(x[i].data(), hash, sizeof(hash)) == 0) return records[i];
+      }
+      count = 0;
+    }
+    if (end) return nullptr;
+  }
+}
+
 /** This function is called to resolve a random address.
  * Returns pointer to the security record of the device whom a random address is
  * matched to.
  */
 tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
-  list_node_t* n = list_foreach(btm_sec_cb.sec_dev_rec,
-                                btm_ble_match_random_bda, (void*)&random_bda);
-  return (n == nullptr) ? (nullptr)
-                        : (static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  RpaResolution* cached = rpa_resolution_cache.find(random_bda);
+  if (cached != nullptr && cached->expiry_ms > now_ms) {
+    if (cached->p_dev_rec == nullptr) {
+      rpa_resolution_stats.unresolved_hits++;
+      return nullptr;
+    }
+    /* The record may have been removed or its keys changed since, checking
+     * the one IRK is enough to confirm it */
+    if (btm_sec_cb.sec_dev_rec_index.Contains(cached->p_dev_rec) &&
+        !btm_ble_match_random_bda(cached->p_dev_rec, (void*)&random_bda)) {
+      rpa_resolution_stats.hits++;
+      return cached->p_dev_rec;
+    }
+  }
+
+  rpa_resolution_stats.misses++;
+  tBTM_SEC_DEV_REC* p_dev_rec =
+      btm_ble_match_random_bda_in_all_records(random_bda);
+  rpa_resolution_cache.insert_or_assign(
+      random_bda, {p_dev_rec, now_ms + kRpaResolutionLifetimeMs});
+  return p_dev_rec;
+}
+
+/** This function is called when a peer IRK is stored, the addresses that
+ * could not be resolved before may resolve with it. */
+void btm_ble_clear_rpa_resolution_cache() { rpa_resolution_cache.clear(); }
+
+#define DUMPSYS_TAG "stack::btm::ble_addr"
+void BTM_BleAddrDumpsys(int fd) {
+  uint64_t lookups = rpa_resolution_stats.hits +
+                     rpa_resolution_stats.unresolved_hits +
+                     rpa_resolution_stats.misses;
+  LOG_DUMPSYS(fd,
+              " rpa resolution cache entries:%zu lookups:%llu hits:%llu "
+              "unresolved_hits:%llu misses:%llu hit_rate:%llu%%",
+              rpa_resolution_cache.size(), (unsigned long long)lookups,
+              (unsigned long long)rpa_resolution_stats.hits,
+              (unsigned long long)rpa_resolution_stats.unresolved_hits,
+              (unsigned long long)rpa_resolution_stats.misses,
+              (unsigned long long)(lookups == 0
+                                       ? 0
+                                       : 100 * (lookups -
+                                                rpa_resolution_stats.misses) /
+                                             lookups));
 }
+#undef DUMPSYS_TAG
 
 /*******************************************************************************
  *  address mapping between pseudo address and real connection address
@@ -197,24 +314,32 @@ static tBTM_SEC_DEV_REC* btm_find_dev_by_identity_addr(
     const RawAddress& bd_addr, uint8_t addr_type) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
-  list_node_t* end = list_end(btm_sec_cb.sec_dev_rec);
-  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec); node != end;
-       node = list_next(node)) {
-    tBTM_SEC_DEV_REC* p_dev_rec =
-        static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
-    if (p_dev_rec->ble.identity_address_with_type.bda == bd_addr) {
-      if ((p_dev_rec->ble.identity_address_with_type.type &
-           (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
-        LOG_WARN("%s find pseudo->random match with diff addr type: %d vs %d",
-                 __func__, p_dev_rec->ble.identity_address_with_type.type,
-                 addr_type);
-
-      /* found the match */
-      return p_dev_rec;
+  tBTM_SEC_DEV_REC* p_dev_rec =
+      btm_sec_cb.sec_dev_rec_index.FindByIdentityAddress(bd_addr);
+  if (p_dev_rec == nullptr ||
+      p_dev_rec->ble.identity_address_with_type.bda != bd_addr) {
+    p_dev_rec = nullptr;
+    list_node_t* end = list_end(btm_sec_cb.sec_dev_rec);
+    for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec); node != end;
+         node = list_next(node)) {
+      tBTM_SEC_DEV_REC* p_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+      if (p_rec->ble.identity_address_with_type.bda == bd_addr) {
+        p_dev_rec = p_rec;
+        btm_sec_cb.sec_dev_rec_index.SetIdentityAddress(bd_addr, p_dev_rec);
+        break;
+      }
     }
+    if (p_dev_rec == nullptr) return NULL;
   }
 
-  return NULL;
+  if ((p_dev_rec->ble.identity_address_with_type.type &
+       (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
+    LOG_WARN("%s find pseudo->random match with diff addr type: %d vs %d",
+             __func__, p_dev_rec->ble.identity_address_with_type.type,
+             addr_type);
+
+  /* found the match */
+  return p_dev_rec;
 }
 
 /*******************************************************************************
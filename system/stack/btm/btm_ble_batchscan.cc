@@ -333,6 +333,75 @@ void read_reports_cb(std::vector<uint8_t> data_all, uint8_t num_records_all,
   }
 }
 
+/* State of the streaming read of the reports. The buffer is reused across
+ * reads, and holds at most BTM_BLE_BATCH_SCAN_STREAM_BUF_SIZE bytes of
+ * reports before they are forwarded */
+struct {
+  bool in_progress = false;
+  uint8_t report_format = 0;
+  uint8_t num_records = 0;
+  std::vector<uint8_t> data;
+} read_reports_stream;
+
+void read_reports_stream_flush(const tBTM_BLE_SCAN_REP_STREAM_CBACK& cb,
+                               tBTM_STATUS status, bool complete) {
+  if (complete) read_reports_stream.in_progress = false;
+  cb.Run(status, read_reports_stream.report_format,
+         read_reports_stream.num_records, read_reports_stream.data, complete);
+  read_reports_stream.num_records = 0;
+  read_reports_stream.data.clear();
+}
+
+/* read reports in streaming mode. Each response is forwarded as soon as the
+ * buffer can't take it, the remaining reports are forwarded on the last
+ * response */
+void read_reports_stream_cb(tBTM_BLE_SCAN_REP_STREAM_CBACK cb, uint8_t* p,
+                            uint16_t len) {
+  if (len < 4) {
+    LOG_ERROR("%s: wrong length", __func__);
+    read_reports_stream_flush(cb, BTM_ERR_PROCESSING, true);
+    return;
+  }
+
+  uint8_t status, subcode, report_format, num_records;
+  STREAM_TO_UINT8(status, p);
+  STREAM_TO_UINT8(subcode, p);
+  STREAM_TO_UINT8(report_format, p);
+  STREAM_TO_UINT8(num_records, p);
+
+  if (subcode != BTM_BLE_BATCH_SCAN_READ_RESULTS) {
+    LOG_ERROR("%s: bad subcode, expected: %d got: %d", __func__,
+              BTM_BLE_BATCH_SCAN_READ_RESULTS, subcode);
+    read_reports_stream_flush(cb, BTM_ERR_PROCESSING, true);
+    return;
+  }
+
+  LOG_VERBOSE("%s: status=%d,len=%d,rec=%d", __func__, status, len - 4,
+              num_records);
+
+  if (num_records == 0 || len == 4) {
+    read_reports_stream_flush(cb, BTM_SUCCESS, true);
+    return;
+  }
+
+  uint16_t data_len = len - 4;
+  if (!read_reports_stream.data.empty() &&
+      (read_reports_stream.report_format != report_format ||
+       read_reports_stream.data.size() + data_len >
+           BTM_BLE_BATCH_SCAN_STREAM_BUF_SIZE ||
+       read_reports_stream.num_records + num_records > UINT8_MAX)) {
+    read_reports_stream_flush(cb, BTM_SUCCESS, false);
+  }
+  read_reports_stream.report_format = report_format;
+  read_reports_stream.data.insert(read_reports_stream.data.end(), p,
+                                  p + data_len);
+  read_reports_stream.num_records += num_records;
+
+  /* More records could be in the buffer and needs to be pulled out */
+  btm_ble_read_batchscan_reports(report_format,
+                                 base::Bind(&read_reports_stream_cb, cb));
+}
+
 /**
  * This function writes the storage configuration in controller
  *
@@ -523,17 +592,14 @@ void BTM_BleDisableBatchScan(base::Callback<void(uint8_t /* status */)> cb) {
   ble_batchscan_cb.cur_state = BTM_BLE_SCAN_DISABLE_CALLED;
 }
 
-/* This function is called to start reading batch scan reports */
-void BTM_BleReadScanReports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
-                            tBTM_BLE_SCAN_REP_CBACK cb) {
+/* Check that batch scan reports can be read for |scan_mode| */
+static tBTM_STATUS btm_ble_check_read_scan_reports(
+    tBTM_BLE_BATCH_SCAN_MODE scan_mode) {
   uint8_t read_scan_mode = 0;
 
-  LOG_VERBOSE("%s; %d", __func__, scan_mode);
-
   if (!can_do_batch_scan()) {
     LOG_ERROR("Controller does not support batch scan");
-    cb.Run(BTM_ERR_PROCESSING, 0, 0, {});
-    return;
+    return BTM_ERR_PROCESSING;
   }
 
   /*  Check if the requested scan mode has already been setup by the user */
@@ -547,7 +613,19 @@ void BTM_BleReadScanReports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
       scan_mode != BTM_BLE_BATCH_SCAN_MODE_ACTI) {
     LOG_ERROR("Illegal read scan params: %d, %d, %d", read_scan_mode, scan_mode,
               ble_batchscan_cb.cur_state);
-    cb.Run(BTM_ILLEGAL_VALUE, 0, 0, {});
+    return BTM_ILLEGAL_VALUE;
+  }
+  return BTM_SUCCESS;
+}
+
+/* This function is called to start reading batch scan reports */
+void BTM_BleReadScanReports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
+                            tBTM_BLE_SCAN_REP_CBACK cb) {
+  LOG_VERBOSE("%s; %d", __func__, scan_mode);
+
+  tBTM_STATUS status = btm_ble_check_read_scan_reports(scan_mode);
+  if (status != BTM_SUCCESS) {
+    cb.Run(status, 0, 0, {});
     return;
   }
 
@@ -556,6 +634,33 @@ void BTM_BleReadScanReports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
   return;
 }
 
+/* This function is called to start reading batch scan reports, forwarding
+ * them as they are read */
+void BTM_BleReadScanReportsStreaming(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
+                                     tBTM_BLE_SCAN_REP_STREAM_CBACK cb) {
+  LOG_VERBOSE("%s; %d", __func__, scan_mode);
+
+  if (read_reports_stream.in_progress) {
+    LOG_ERROR("Batch scan reports are already being read");
+    cb.Run(BTM_BUSY, 0, 0, {}, true);
+    return;
+  }
+
+  tBTM_STATUS status = btm_ble_check_read_scan_reports(scan_mode);
+  if (status != BTM_SUCCESS) {
+    cb.Run(status, 0, 0, {}, true);
+    return;
+  }
+
+  read_reports_stream.in_progress = true;
+  read_reports_stream.report_format = scan_mode;
+  read_reports_stream.num_records = 0;
+  read_reports_stream.data.clear();
+  read_reports_stream.data.reserve(BTM_BLE_BATCH_SCAN_STREAM_BUF_SIZE);
+  btm_ble_read_batchscan_reports(scan_mode,
+                                 base::Bind(&read_reports_stream_cb, cb));
+}
+
 /* This function is called to setup the callback for tracking */
 void BTM_BleTrackAdvertiser(tBTM_BLE_TRACK_ADV_CBACK* p_track_cback,
                             tBTM_BLE_REF_VALUE ref_value) {
@@ -28,6 +28,7 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include "device/include/controller.h"
 #include "main/shim/acl_api.h"
@@ -154,6 +155,26 @@ void BTM_AcceptlistRemove(const RawAddress& address) {
   return;
 }
 
+/** Removes |to_remove| from and adds |to_add| to the acceptlist at once */
+size_t BTM_AcceptlistUpdate(const std::vector<RawAddress>& to_remove,
+                            const std::vector<RawAddress>& to_add) {
+  if (!controller_get_interface()->supports_ble()) {
+    LOG_WARN("Controller does not support Le");
+    return 0;
+  }
+
+  std::vector<tBLE_BD_ADDR> remove_addresses;
+  for (const RawAddress& address : to_remove) {
+    remove_addresses.push_back(BTM_Sec_GetAddressWithType(address));
+  }
+  std::vector<tBLE_BD_ADDR> add_addresses;
+  for (const RawAddress& address : to_add) {
+    add_addresses.push_back(BTM_Sec_GetAddressWithType(address));
+  }
+  return bluetooth::shim::ACL_UpdateLeAcceptList(remove_addresses,
+                                                 add_addresses);
+}
+
 /** Clear the acceptlist, end any pending acceptlist connections */
 void BTM_AcceptlistClear() {
   if (!controller_get_interface()->supports_ble()) {
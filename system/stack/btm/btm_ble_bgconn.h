@@ -16,6 +16,9 @@
  *
  ******************************************************************************/
 
+#include <cstddef>
+#include <vector>
+
 #include "types/raw_address.h"
 
 /** Adds the device into acceptlist. Returns false if acceptlist is full and
@@ -30,5 +33,11 @@ bool BTM_AcceptlistAdd(const RawAddress& address, bool is_direct);
 /** Removes the device from acceptlist */
 void BTM_AcceptlistRemove(const RawAddress& address);
 
+/** Removes |to_remove| from and adds |to_add| to the acceptlist at once.
+ * Returns the number of devices at the front of |to_add| that were added
+ * before the acceptlist got full. */
+size_t BTM_AcceptlistUpdate(const std::vector<RawAddress>& to_remove,
+                            const std::vector<RawAddress>& to_add);
+
 /** Clear the acceptlist, end any pending acceptlist connections */
 void BTM_AcceptlistClear();
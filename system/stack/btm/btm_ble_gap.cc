@@ -2412,24 +2412,23 @@ static void btm_ble_appearance_to_cod(uint16_t appearance, uint8_t* dev_class) {
   };
 }
 
-bool btm_ble_get_appearance_as_cod(std::vector<uint8_t> const& data,
-                                   DEV_CLASS dev_class) {
+static bool btm_ble_get_appearance_as_cod(
+    const AdvertiseDataParser::FieldIndex& fields, DEV_CLASS dev_class) {
   /* Check to see the BLE device has the Appearance UUID in the advertising
    * data. If it does then try to convert the appearance value to a class of
    * device value Fluoride can use. Otherwise fall back to trying to infer if
    * it is a HID device based on the service class.
    */
   uint8_t len;
-  const uint8_t* p_uuid16 = AdvertiseDataParser::GetFieldByType(
-      data, BTM_BLE_AD_TYPE_APPEARANCE, &len);
+  const uint8_t* p_uuid16 =
+      fields.GetFieldByType(BTM_BLE_AD_TYPE_APPEARANCE, &len);
   if (p_uuid16 && len == 2) {
     btm_ble_appearance_to_cod((uint16_t)p_uuid16[0] | (p_uuid16[1] << 8),
                               dev_class);
     return true;
   }
 
-  p_uuid16 = AdvertiseDataParser::GetFieldByType(
-      data, BTM_BLE_AD_TYPE_16SRV_CMPL, &len);
+  p_uuid16 = fields.GetFieldByType(BTM_BLE_AD_TYPE_16SRV_CMPL, &len);
   if (p_uuid16 == NULL) {
     return false;
   }
@@ -2448,6 +2447,12 @@ bool btm_ble_get_appearance_as_cod(std::vector<uint8_t> const& data,
   return false;
 }
 
+bool btm_ble_get_appearance_as_cod(std::vector<uint8_t> const& data,
+                                   DEV_CLASS dev_class) {
+  return btm_ble_get_appearance_as_cod(AdvertiseDataParser::FieldIndex(data),
+                                       dev_class);
+}
+
 /**
  * Update adv packet information into inquiry result.
  */
@@ -2489,31 +2494,28 @@ void btm_ble_update_inq_result(tINQ_DB_ENT* p_i, uint8_t addr_type,
 
   bool has_advertising_flags = false;
   if (!data.empty()) {
-    const uint8_t* p_flag =
-        AdvertiseDataParser::GetFieldByType(data, BTM_BLE_AD_TYPE_FLAG, &len);
+    // Parse the advertising data once for all the fields below
+    AdvertiseDataParser::FieldIndex fields(data);
+    const uint8_t* p_flag = fields.GetFieldByType(BTM_BLE_AD_TYPE_FLAG, &len);
     if (p_flag != NULL && len != 0) {
       has_advertising_flags = true;
       p_cur->flag = *p_flag;
     }
 
-    btm_ble_get_appearance_as_cod(data, p_cur->dev_class);
+    btm_ble_get_appearance_as_cod(fields, p_cur->dev_class);
 
-    const uint8_t* p_rsi =
-        AdvertiseDataParser::GetFieldByType(data, BTM_BLE_AD_TYPE_RSI, &len);
+    const uint8_t* p_rsi = fields.GetFieldByType(BTM_BLE_AD_TYPE_RSI, &len);
     if (p_rsi != nullptr && len == 6) {
       STREAM_TO_BDADDR(p_cur->ble_ad_rsi, p_rsi);
     }
 
-    const uint8_t* p_service_data = data.data();
-    uint8_t service_data_len = 0;
-
-    while ((p_service_data = AdvertiseDataParser::GetFieldByType(
-                p_service_data + service_data_len,
-                data.size() - (p_service_data - data.data()) - service_data_len,
-                BTM_BLE_AD_TYPE_SERVICE_DATA_TYPE, &service_data_len))) {
+    for (const AdvertiseDataField& field : fields.fields()) {
+      if (field.type != BTM_BLE_AD_TYPE_SERVICE_DATA_TYPE) {
+        continue;
+      }
       uint16_t uuid;
-      const uint8_t* p_uuid = p_service_data;
-      if (service_data_len < 2) {
+      const uint8_t* p_uuid = field.data;
+      if (field.length < 2) {
         continue;
       }
       STREAM_TO_UINT16(uuid, p_uuid);
@@ -57,6 +57,7 @@ void btm_gen_resolvable_private_addr(
     base::Callback<void(const RawAddress& rpa)> cb);
 
 tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda);
+void btm_ble_clear_rpa_resolution_cache();
 void btm_gen_resolve_paddr_low(const RawAddress& address);
 
 void btm_ble_batchscan_init(void);
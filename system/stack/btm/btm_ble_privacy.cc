@@ -25,6 +25,14 @@
 
 #include "stack/include/btm_ble_privacy.h"
 
+#include <base/functional/bind.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
 #include "btm_dev.h"
 #include "btm_sec_cb.h"
 #include "btm_sec_int_types.h"
@@ -36,10 +44,31 @@
 #include "stack/include/bt_octets.h"
 #include "stack/include/bt_types.h"
 #include "stack/include/btm_api.h"
+#include "stack/include/main_thread.h"
 #include "types/raw_address.h"
 
 extern tBTM_CB btm_cb;
 
+namespace {
+
+/* Resolving list changes of controllers supporting LE privacy are held back
+ * until the next synchronization. A burst of them, as when the bonded devices
+ * are loaded, is then applied during a single pause of scanning and
+ * advertising. */
+struct tRESOLVING_LIST_SYNC {
+  /* Pseudo addresses of the devices to resolve, the controller resolves the
+   * most recently used ones and the host the others */
+  std::set<RawAddress> wanted;
+  /* Identity addresses to remove from the controller list, by pseudo address.
+   * They are copied as the records may be freed before the synchronization. */
+  std::map<RawAddress, tBLE_BD_ADDR> removed;
+  bool scheduled = false;
+};
+
+tRESOLVING_LIST_SYNC resolving_list_sync;
+
+}  // namespace
+
 /* RPA offload VSC specifics */
 #define HCI_VENDOR_BLE_RPA_VSC (0x0155 | HCI_GRP_VENDOR_SPECIFIC)
 
@@ -550,6 +579,107 @@ static bool is_peer_identity_key_valid(const tBTM_SEC_DEV_REC& dev_rec) {
 
 static Octet16 get_local_irk() { return btm_sec_cb.devcb.id_keys.irk; }
 
+/*******************************************************************************
+ *
+ * Function         btm_ble_resolving_list_sync
+ *
+ * Description      This function applies the resolving list changes held back
+ *                  since the last synchronization in one update. The
+ *                  controller list holds the most recently used devices, the
+ *                  others are evicted and resolved by the host from the IRKs
+ *                  of their security records.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void btm_ble_resolving_list_sync() {
+  resolving_list_sync.scheduled = false;
+  if (btm_cb.ble_ctr_cb.privacy_mode < BTM_PRIVACY_1_2 ||
+      !controller_get_interface()->supports_ble_privacy()) {
+    resolving_list_sync.removed.clear();
+    return;
+  }
+
+  std::vector<tBLE_BD_ADDR> to_remove;
+  for (const auto& [pseudo_addr, identity_addr] : resolving_list_sync.removed) {
+    to_remove.push_back(identity_addr);
+  }
+  resolving_list_sync.removed.clear();
+
+  std::vector<tBTM_SEC_DEV_REC*> candidates;
+  for (auto it = resolving_list_sync.wanted.begin();
+       it != resolving_list_sync.wanted.end();) {
+    tBTM_SEC_DEV_REC* p_dev_rec = btm_find_dev(*it);
+    if (p_dev_rec == nullptr || !is_peer_identity_key_valid(*p_dev_rec)) {
+      it = resolving_list_sync.wanted.erase(it);
+      continue;
+    }
+    candidates.push_back(p_dev_rec);
+    it++;
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const tBTM_SEC_DEV_REC* a, const tBTM_SEC_DEV_REC* b) {
+                     return a->timestamp > b->timestamp;
+                   });
+
+  size_t max_size =
+      controller_get_interface()->get_ble_resolving_list_max_size();
+  std::vector<std::tuple<tBLE_BD_ADDR, Octet16, Octet16>> to_add;
+  size_t host_resolved = 0;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    tBTM_SEC_DEV_REC& dev_rec = *candidates[i];
+    bool in_list = dev_rec.ble.in_controller_list & BTM_RESOLVING_LIST_BIT;
+    if (i < max_size) {
+      if (!in_list) {
+        to_add.emplace_back(dev_rec.ble.identity_address_with_type,
+                            dev_rec.sec_rec.ble_keys.irk, get_local_irk());
+        dev_rec.ble.in_controller_list |= BTM_RESOLVING_LIST_BIT;
+      }
+      continue;
+    }
+    host_resolved++;
+    if (in_list) {
+      to_remove.push_back(dev_rec.ble.identity_address_with_type);
+      dev_rec.ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
+    }
+  }
+
+  if (to_remove.empty() && to_add.empty()) return;
+
+  LOG_INFO(
+      "Updating Address Resolving list removed:%zu added:%zu host "
+      "resolved:%zu",
+      to_remove.size(), to_add.size(), host_resolved);
+  bluetooth::shim::ACL_UpdateAddressResolution(to_remove, to_add);
+}
+
+static void btm_ble_schedule_resolving_list_sync() {
+  if (resolving_list_sync.scheduled) return;
+  resolving_list_sync.scheduled = true;
+  if (do_in_main_thread(FROM_HERE,
+                        base::BindOnce(&btm_ble_resolving_list_sync)) !=
+      BT_STATUS_SUCCESS) {
+    btm_ble_resolving_list_sync();
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_ble_resolving_list_touch
+ *
+ * Description      This function is called when the device is used, to move
+ *                  it to the controller list if it is resolved by the host.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_ble_resolving_list_touch(const tBTM_SEC_DEV_REC& dev_rec) {
+  if (!(dev_rec.ble.in_controller_list & BTM_RESOLVING_LIST_BIT) &&
+      resolving_list_sync.wanted.count(dev_rec.bd_addr) != 0) {
+    btm_ble_schedule_resolving_list_sync();
+  }
+}
+
 void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
   if (btm_cb.ble_ctr_cb.privacy_mode < BTM_PRIVACY_1_2) {
     LOG_DEBUG("Privacy 1.2 is not enabled");
@@ -577,9 +707,6 @@ void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
     return;
   }
 
-  const Octet16& peer_irk = dev_rec.sec_rec.ble_keys.irk;
-  const Octet16& local_irk = get_local_irk();
-
   if (dev_rec.ble.identity_address_with_type.bda.IsEmpty()) {
     dev_rec.ble.identity_address_with_type = {
         .type = dev_rec.ble.AddressType(),
@@ -593,13 +720,11 @@ void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
     return;
   }
 
-  bluetooth::shim::ACL_AddToAddressResolution(
-      dev_rec.ble.identity_address_with_type, peer_irk, local_irk);
+  resolving_list_sync.wanted.insert(dev_rec.bd_addr);
+  btm_ble_schedule_resolving_list_sync();
 
-  LOG_DEBUG("Added to Address Resolving list device:%s",
+  LOG_DEBUG("Queued for Address Resolving list device:%s",
             ADDRESS_TO_LOGGABLE_CSTR(dev_rec.ble.identity_address_with_type));
-
-  dev_rec.ble.in_controller_list |= BTM_RESOLVING_LIST_BIT;
 }
 
 /*******************************************************************************
@@ -620,6 +745,19 @@ void btm_ble_resolving_list_remove_dev(tBTM_SEC_DEV_REC* p_dev_rec) {
   }
   LOG_VERBOSE("%s", __func__);
 
+  if (controller_get_interface()->supports_ble_privacy()) {
+    resolving_list_sync.wanted.erase(p_dev_rec->bd_addr);
+    if (!(p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+      LOG_VERBOSE("Device not in resolving list");
+      return;
+    }
+    p_dev_rec->ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
+    resolving_list_sync.removed.insert_or_assign(
+        p_dev_rec->bd_addr, p_dev_rec->ble.identity_address_with_type);
+    btm_ble_schedule_resolving_list_sync();
+    return;
+  }
+
   if ((p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) &&
       !btm_ble_brcm_find_resolving_pending_entry(
           p_dev_rec->bd_addr, BTM_BLE_META_REMOVE_IRK_ENTRY)) {
@@ -663,5 +801,6 @@ void btm_ble_resolving_list_init(uint8_t max_irk_list_sz) {
 
   controller_get_interface()->set_ble_resolving_list_max_size(max_irk_list_sz);
   btm_ble_clear_resolving_list();
+  resolving_list_sync.removed.clear();
   btm_cb.ble_ctr_cb.resolving_list_avail_size = max_irk_list_sz;
 }
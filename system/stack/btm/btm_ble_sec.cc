@@ -920,6 +920,8 @@ void btm_sec_save_le_key(const RawAddress& bd_addr, tBTM_LE_KEY_TYPE key_type,
         p_rec->bd_addr = p_keys->pid_key.identity_addr;
         /* combine DUMO device security record if needed */
         btm_consolidate_dev(p_rec);
+        /* addresses left unresolved may resolve with the new IRK */
+        btm_ble_clear_rpa_resolution_cache();
         break;
 
       case BTM_LE_KEY_PCSRK:
@@ -1519,6 +1521,7 @@ void btm_ble_connected(const RawAddress& bda, uint16_t handle, uint8_t enc_mode,
            ADDRESS_TO_LOGGABLE_CSTR(bda));
   // TODO() Why is timestamp a counter ?
   p_dev_rec->timestamp = btm_sec_cb.dev_rec_count++;
+  btm_ble_resolving_list_touch(*p_dev_rec);
 
   if (is_ble_addr_type_known(addr_type))
     p_dev_rec->ble.SetAddressType(addr_type);
@@ -63,6 +63,7 @@ struct btm_client_interface_t btm_client_interface = {
             .BTM_GetRole = BTM_GetRole,
             .BTM_SetPowerMode = BTM_SetPowerMode,
             .BTM_SetSsrParams = BTM_SetSsrParams,
+            .BTM_PM_SetMaxSniffInterval = BTM_PM_SetMaxSniffInterval,
             .BTM_SwitchRoleToCentral = BTM_SwitchRoleToCentral,
             .BTM_block_role_switch_for = BTM_block_role_switch_for,
             .BTM_block_sniff_mode_for = BTM_block_sniff_mode_for,
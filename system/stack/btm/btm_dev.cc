@@ -59,6 +59,7 @@ constexpr char kBtmLogTag[] = "BOND";
 static void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
   p_dev_rec->sec_rec.link_key.fill(0);
   memset(&p_dev_rec->sec_rec.ble_keys, 0, sizeof(tBTM_SEC_BLE_KEYS));
+  btm_sec_cb.sec_dev_rec_index.Remove(p_dev_rec);
   list_remove(btm_sec_cb.sec_dev_rec, p_dev_rec);
 }
 
@@ -360,9 +361,22 @@ static bool is_handle_equal(void* data, void* context) {
  *
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
+  // Records without a link all share the invalid handle
+  bool indexed = handle != HCI_INVALID_HANDLE;
+  if (indexed) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        btm_sec_cb.sec_dev_rec_index.FindByHandle(handle);
+    if (p_dev_rec != nullptr && !is_handle_equal(p_dev_rec, &handle))
+      return p_dev_rec;
+  }
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_handle_equal, &handle);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    if (indexed) btm_sec_cb.sec_dev_rec_index.SetHandle(handle, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -392,9 +406,18 @@ static bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_dev_rec =
+      btm_sec_cb.sec_dev_rec_index.FindByAddress(bd_addr);
+  if (p_dev_rec != nullptr && !is_address_equal(p_dev_rec, (void*)&bd_addr))
+    return p_dev_rec;
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    btm_sec_cb.sec_dev_rec_index.SetAddress(bd_addr, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -641,6 +664,7 @@ tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void) {
   p_dev_rec =
       static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
   list_append(btm_sec_cb.sec_dev_rec, p_dev_rec);
+  btm_sec_cb.sec_dev_rec_index.Add(p_dev_rec);
 
   // Initialize defaults
   p_dev_rec->sec_rec.sec_flags = BTM_SEC_IN_USE;
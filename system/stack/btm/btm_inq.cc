@@ -33,7 +33,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "advertise_data_parser.h"
 #include "btif/include/btif_config.h"
@@ -99,8 +103,52 @@ void btm_log_history_scan_mode(uint8_t scan_mode) {
 
 // Inquiry database lock
 std::mutex inq_db_lock_;
-// Inquiry database
-tINQ_DB_ENT inq_db_[BTM_INQ_DB_SIZE];
+
+// Inquiry database, guarded by inq_db_lock_. The entries are allocated once
+// and do not move, the first half holds the BR/EDR devices and the second half
+// the LE devices. The entries in use are indexed by address and kept in least
+// recently used order, the oldest entry of a half is reused when it is full.
+class InquiryDb {
+ public:
+  static constexpr size_t kMaxSize = 1024;
+
+  tINQ_DB_ENT* begin() {
+    Allocate();
+    return entries_.data();
+  }
+  tINQ_DB_ENT* end() { return begin() + entries_.size(); }
+  size_t size() {
+    Allocate();
+    return entries_.size();
+  }
+
+  // Return the entry of a device in use, and mark it as recently used
+  tINQ_DB_ENT* Find(const RawAddress& bd_addr);
+  // Return a cleared entry for a device, reusing the oldest or the weakest
+  // entry if there is no free entry
+  tINQ_DB_ENT* New(const RawAddress& bd_addr, bool is_ble, bool by_rssi);
+  // Mark an entry as unused
+  void Release(tINQ_DB_ENT* p_ent);
+  // Index the entries again after they were moved around
+  void Rebuild();
+
+ private:
+  void Allocate();
+  size_t HalfOf(const tINQ_DB_ENT* p_ent) const {
+    return (p_ent - entries_.data()) < (ptrdiff_t)(entries_.size() / 2) ? 0
+                                                                          : 1;
+  }
+  void Link(tINQ_DB_ENT* p_ent);
+
+  std::vector<tINQ_DB_ENT> entries_;
+  std::unordered_map<RawAddress, tINQ_DB_ENT*> index_;
+  // Entries in use, most recently used first
+  std::list<tINQ_DB_ENT*> lru_[2];
+  std::vector<std::list<tINQ_DB_ENT*>::iterator> lru_pos_;
+  std::vector<tINQ_DB_ENT*> free_[2];
+};
+
+InquiryDb inq_db_;
 
 // Inquiry bluetooth device database lock
 std::mutex bd_db_lock_;
@@ -160,6 +208,10 @@ using bluetooth::Uuid;
 #define PROPERTY_INQ_BY_RSSI "persist.bluetooth.inq_by_rssi"
 #endif
 
+#ifndef PROPERTY_INQ_DB_SIZE
+#define PROPERTY_INQ_DB_SIZE "bluetooth.core.classic.inq_db_size"
+#endif
+
 #define BTIF_DM_DEFAULT_INQ_MAX_DURATION 10
 
 /******************************************************************************/
@@ -797,11 +849,8 @@ tBTM_INQ_INFO* BTM_InqDbRead(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tBTM_INQ_INFO* BTM_InqDbFirst(void) {
-  uint16_t xx;
-
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+  for (tINQ_DB_ENT* p_ent = inq_db_.begin(); p_ent != inq_db_.end(); p_ent++) {
     if (p_ent->in_use) return (&p_ent->inq_info);
   }
 
@@ -821,16 +870,13 @@ tBTM_INQ_INFO* BTM_InqDbFirst(void) {
  *
  ******************************************************************************/
 tBTM_INQ_INFO* BTM_InqDbNext(tBTM_INQ_INFO* p_cur) {
-  uint16_t inx;
-
   std::lock_guard<std::mutex> lock(inq_db_lock_);
 
   if (p_cur) {
     tINQ_DB_ENT* p_ent =
         (tINQ_DB_ENT*)((uint8_t*)p_cur - offsetof(tINQ_DB_ENT, inq_info));
-    inx = (uint16_t)((p_ent - inq_db_) + 1);
 
-    for (p_ent = &inq_db_[inx]; inx < BTM_INQ_DB_SIZE; inx++, p_ent++) {
+    for (p_ent++; p_ent < inq_db_.end(); p_ent++) {
       if (p_ent->in_use) return (&p_ent->inq_info);
     }
 
@@ -874,17 +920,15 @@ tBTM_STATUS BTM_ClearInqDb(const RawAddress* p_bda) {
  *
  ******************************************************************************/
 void btm_clear_all_pending_le_entry(void) {
-  uint16_t xx;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
 
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+  for (tINQ_DB_ENT* p_ent = inq_db_.begin(); p_ent != inq_db_.end(); p_ent++) {
     /* mark all pending LE entry as unused if an LE only device has scan
      * response outstanding */
     if ((p_ent->in_use) &&
         (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
         !p_ent->scan_rsp)
-      p_ent->in_use = false;
+      inq_db_.Release(p_ent);
   }
 }
 
@@ -1043,19 +1087,16 @@ void btm_inq_clear_ssp(void) {
  *
  ******************************************************************************/
 void btm_clr_inq_db(const RawAddress* p_bda) {
-  uint16_t xx;
-
 #if (BTM_INQ_DEBUG == TRUE)
   LOG_VERBOSE("btm_clr_inq_db: inq_active:0x%x state:%d",
               btm_cb.btm_inq_vars.inq_active, btm_cb.btm_inq_vars.state);
 #endif
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+  for (tINQ_DB_ENT* p_ent = inq_db_.begin(); p_ent != inq_db_.end(); p_ent++) {
     if (p_ent->in_use) {
       /* If this is the specified BD_ADDR or clearing all devices */
       if (p_bda == NULL || (p_ent->inq_info.results.remote_bd_addr == *p_bda)) {
-        p_ent->in_use = false;
+        inq_db_.Release(p_ent);
       }
     }
   }
@@ -1143,17 +1184,8 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda)
-      return (p_ent);
-  }
-
-  /* If here, not found */
-  return (NULL);
+  return inq_db_.Find(p_bda);
 }
 
 /*******************************************************************************
@@ -1161,53 +1193,119 @@ tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
  * Function         btm_inq_db_new
  *
  * Description      This function looks through the inquiry database for an
- *                  unused entry. If no entry is free, it allocates the oldest
- *                  entry.
+ *                  unused entry. If no entry is free, it allocates the least
+ *                  recently used entry, or the weakest when sorting by RSSI.
  *
  * Returns          pointer to entry
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble) {
-  uint16_t xx = 0, yy = 0;
-  uint32_t ot = 0xFFFFFFFF;
-  int8_t i_rssi = 0;
+  std::lock_guard<std::mutex> lock(inq_db_lock_);
+  return inq_db_.New(p_bda, is_ble, internal_.inq_by_rssi);
+}
 
-  if (is_ble) yy = BTM_INQ_DB_SIZE / 2;
-  else yy = 0;
+void InquiryDb::Allocate() {
+  if (!entries_.empty()) return;
+
+  int32_t size = osi_property_get_int32(PROPERTY_INQ_DB_SIZE, BTM_INQ_DB_SIZE);
+  size = std::clamp<int32_t>(size, 2, kMaxSize) & ~1;
+  LOG_INFO("Inquiry database of %d entries", size);
+  entries_.resize(size);
+  lru_pos_.resize(size);
+  for (size_t half = 0; half < 2; half++) {
+    free_[half].clear();
+    lru_[half].clear();
+  }
+  index_.clear();
+  // Free entries are taken from the back, the first entries go first
+  for (tINQ_DB_ENT* p_ent = end(); p_ent != begin();) {
+    p_ent--;
+    free_[HalfOf(p_ent)].push_back(p_ent);
+  }
+}
 
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = &inq_db_[yy];
-  tINQ_DB_ENT* p_old = &inq_db_[yy];
+void InquiryDb::Link(tINQ_DB_ENT* p_ent) {
+  size_t half = HalfOf(p_ent);
+  index_[p_ent->inq_info.results.remote_bd_addr] = p_ent;
+  lru_[half].push_front(p_ent);
+  lru_pos_[p_ent - entries_.data()] = lru_[half].begin();
+}
 
-  for (xx = 0; xx < BTM_INQ_DB_SIZE / 2; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
+tINQ_DB_ENT* InquiryDb::Find(const RawAddress& bd_addr) {
+  auto it = index_.find(bd_addr);
+  if (it == index_.end()) return nullptr;
 
-      return (p_ent);
-    }
+  tINQ_DB_ENT* p_ent = it->second;
+  size_t half = HalfOf(p_ent);
+  lru_[half].splice(lru_[half].begin(), lru_[half],
+                    lru_pos_[p_ent - entries_.data()]);
+  return p_ent;
+}
 
-    if (internal_.inq_by_rssi) {
-      if (p_ent->inq_info.results.rssi < i_rssi) {
-        p_old = p_ent;
-        i_rssi = p_ent->inq_info.results.rssi;
-      }
-    } else {
-      if (p_ent->time_of_resp < ot) {
-        p_old = p_ent;
-        ot = p_ent->time_of_resp;
+tINQ_DB_ENT* InquiryDb::New(const RawAddress& bd_addr, bool is_ble,
+                            bool by_rssi) {
+  Allocate();
+  size_t half = is_ble ? 1 : 0;
+  tINQ_DB_ENT* p_ent = nullptr;
+
+  if (free_[half].empty()) {
+    /* No free entry, reuse the weakest or the least recently used one */
+    p_ent = lru_[half].back();
+    if (by_rssi) {
+      int8_t i_rssi = 0;
+      for (tINQ_DB_ENT* p : lru_[half]) {
+        if (p->inq_info.results.rssi < i_rssi) {
+          p_ent = p;
+          i_rssi = p->inq_info.results.rssi;
+        }
       }
     }
+    Release(p_ent);
   }
+  p_ent = free_[half].back();
+  free_[half].pop_back();
+
+  memset(p_ent, 0, sizeof(tINQ_DB_ENT));
+  p_ent->inq_info.results.remote_bd_addr = bd_addr;
+  p_ent->in_use = true;
+  Link(p_ent);
+  return p_ent;
+}
 
-  /* If here, no free entry found. Return the oldest. */
+void InquiryDb::Release(tINQ_DB_ENT* p_ent) {
+  if (!p_ent->in_use) return;
 
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
+  p_ent->in_use = false;
+  size_t half = HalfOf(p_ent);
+  auto it = index_.find(p_ent->inq_info.results.remote_bd_addr);
+  if (it != index_.end() && it->second == p_ent) index_.erase(it);
+  lru_[half].erase(lru_pos_[p_ent - entries_.data()]);
+  free_[half].push_back(p_ent);
+}
 
-  return (p_old);
+void InquiryDb::Rebuild() {
+  Allocate();
+  index_.clear();
+  for (size_t half = 0; half < 2; half++) {
+    free_[half].clear();
+    lru_[half].clear();
+  }
+
+  std::vector<tINQ_DB_ENT*> in_use;
+  for (tINQ_DB_ENT* p_ent = end(); p_ent != begin();) {
+    p_ent--;
+    if (p_ent->in_use) {
+      in_use.push_back(p_ent);
+    } else {
+      free_[HalfOf(p_ent)].push_back(p_ent);
+    }
+  }
+  // Link the oldest responses first, they end up at the back
+  std::stable_sort(in_use.begin(), in_use.end(),
+                   [](const tINQ_DB_ENT* a, const tINQ_DB_ENT* b) {
+                     return a->time_of_resp < b->time_of_resp;
+                   });
+  for (tINQ_DB_ENT* p_ent : in_use) Link(p_ent);
 }
 
 /*******************************************************************************
@@ -1423,16 +1521,15 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
  *
  ******************************************************************************/
 void btm_sort_inq_result(void) {
-  uint8_t xx, yy, num_resp;
+  uint16_t xx, yy, num_resp;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  tINQ_DB_ENT* p_next = inq_db_ + 1;
+  tINQ_DB_ENT* p_ent = inq_db_.begin();
+  tINQ_DB_ENT* p_next = p_ent + 1;
   int size;
   tINQ_DB_ENT* p_tmp = (tINQ_DB_ENT*)osi_malloc(sizeof(tINQ_DB_ENT));
 
-  num_resp = (btm_cb.btm_inq_vars.inq_cmpl_info.num_resp < BTM_INQ_DB_SIZE)
-                 ? btm_cb.btm_inq_vars.inq_cmpl_info.num_resp
-                 : BTM_INQ_DB_SIZE;
+  num_resp = std::min<uint16_t>(btm_cb.btm_inq_vars.inq_cmpl_info.num_resp,
+                                inq_db_.size());
 
   size = sizeof(tINQ_DB_ENT);
   for (xx = 0; xx < num_resp - 1; xx++, p_ent++) {
@@ -1446,6 +1543,7 @@ void btm_sort_inq_result(void) {
   }
 
   osi_free(p_tmp);
+  inq_db_.Rebuild();
 }
 
 /*******************************************************************************
@@ -1696,6 +1794,19 @@ void btm_process_remote_name(const RawAddress* bda, const BD_NAME bdn,
         temp_evt_len--;
       }
       rem_name.remote_bd_name[rem_name.length] = 0;
+
+      /* Keep the name with the inquiry result so that it is not requested
+       * again for this device */
+      std::lock_guard<std::mutex> lock(inq_db_lock_);
+      tINQ_DB_ENT* p_i = inq_db_.Find(rem_name.bd_addr);
+      if (p_i != nullptr) {
+        p_i->inq_info.remote_name_len =
+            std::min<uint16_t>(rem_name.length, BTM_MAX_REM_BD_NAME_LEN);
+        memcpy(p_i->inq_info.remote_name, rem_name.remote_bd_name,
+               p_i->inq_info.remote_name_len);
+        p_i->inq_info.remote_name[p_i->inq_info.remote_name_len] = 0;
+        p_i->inq_info.appl_knows_rem_name = true;
+      }
     } else {
       /* If processing a stand alone remote name then report the error in the
          callback */
@@ -17,10 +17,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #include "base/functional/bind.h"
 #include "base/functional/callback.h"
@@ -51,6 +53,7 @@ static constexpr uint8_t kStateFlagsNone = 0x00;
 static constexpr uint8_t kStateFlagIsConnecting = 0x01;
 static constexpr uint8_t kStateFlagIsConnected = 0x02;
 static constexpr uint8_t kStateFlagHasDataPathSet = 0x04;
+static constexpr uint8_t kStateFlagIsSendingData = 0x08;
 static constexpr uint8_t kStateFlagIsBroadcast = 0x10;
 
 constexpr char kBtmLogTag[] = "ISO";
@@ -82,8 +85,20 @@ struct iso_base {
     uint64_t evt_last_lost_us = 0;
   };
 
+  struct sched_stats {
+    size_t sdu_late_count = 0;
+    uint64_t sdu_last_late_us = 0;
+  };
+
   credits_stats cr_stats;
   event_stats evt_stats;
+  sched_stats sch_stats;
+
+  /* SDU of the current interval, held until all the sending streams of the
+   * CIG or BIG have one */
+  BT_HDR* pending_sdu = nullptr;
+
+  ~iso_base() { osi_free(pending_sdu); }
 };
 
 typedef iso_base iso_cis;
@@ -91,7 +106,8 @@ typedef iso_base iso_bis;
 
 struct iso_impl {
   iso_impl() {
-    iso_credits_ = controller_get_interface()->get_iso_buffer_count();
+    iso_buffer_count_ = controller_get_interface()->get_iso_buffer_count();
+    iso_credits_ = iso_buffer_count_;
     iso_buffer_size_ = controller_get_interface()->get_iso_data_size();
     LOG_INFO("%p created, iso credits: %d, buffer size: %d.", this,
              iso_credits_.load(), iso_buffer_size_);
@@ -417,7 +433,10 @@ struct iso_impl {
                        "handle:0x%04x, status:%s", conn_handle,
                        hci_status_code_text((tHCI_STATUS)(status)).c_str()));
 
-    if (status == HCI_SUCCESS) iso->state_flags &= ~kStateFlagHasDataPathSet;
+    if (status == HCI_SUCCESS) {
+      iso->state_flags &= ~kStateFlagHasDataPathSet;
+      drop_pending_sdu(iso);
+    }
 
     if (iso->state_flags & kStateFlagIsBroadcast) {
       LOG_ASSERT(big_callbacks_ != nullptr) << "Invalid BIG callbacks";
@@ -555,27 +574,84 @@ struct iso_impl {
     uint16_t seq_nb = iso->sync_info.seq_nb;
     iso->sync_info.seq_nb = (seq_nb + 1) & 0xffff;
 
-    if (iso_credits_ == 0 || data_len > iso_buffer_size_) {
-      iso->cr_stats.credits_underflow_bytes += data_len;
-      iso->cr_stats.credits_underflow_count++;
-      iso->cr_stats.credits_last_underflow_us =
-          bluetooth::common::time_get_os_boottime_us();
-
-      LOG(WARNING) << __func__ << ", dropping ISO packet, len: "
-                   << static_cast<int>(data_len)
-                   << ", iso credits: " << static_cast<int>(iso_credits_)
-                   << ", iso handle: " << loghex(iso_handle);
+    if (data_len > iso_buffer_size_) {
+      drop_sdu(iso_handle, iso, data_len);
       return;
     }
 
-    iso_credits_--;
-    iso->used_credits++;
-
     BT_HDR* packet = prepare_hci_packet(iso_handle, seq_nb, data_len);
     memcpy(packet->data + kIsoHeaderWithoutTsLen, data, data_len);
-    auto hci = bluetooth::shim::hci_layer_get_interface();
     packet->event = MSG_STACK_TO_HC_HCI_ISO | 0x0001;
-    hci->transmit_downward(packet->event, packet);
+
+    /* A second SDU of a stream starts a new interval: the streams of the
+     * group without an SDU for the current one are late. */
+    if (iso->pending_sdu != nullptr) send_iso_group(iso, true);
+
+    iso->state_flags |= kStateFlagIsSendingData;
+    iso->pending_sdu = packet;
+    if (IsIsoGroupComplete(iso)) send_iso_group(iso, false);
+  }
+
+  void drop_sdu(uint16_t iso_handle, iso_base* iso, uint16_t data_len) {
+    iso->cr_stats.credits_underflow_bytes += data_len;
+    iso->cr_stats.credits_underflow_count++;
+    iso->cr_stats.credits_last_underflow_us =
+        bluetooth::common::time_get_os_boottime_us();
+
+    LOG(WARNING) << __func__ << ", dropping ISO packet, len: "
+                 << static_cast<int>(data_len)
+                 << ", iso credits: " << static_cast<int>(iso_credits_)
+                 << ", iso handle: " << loghex(iso_handle);
+  }
+
+  /* Send together the SDUs of the current interval of the CIG or BIG of
+   * `iso`. Each stream uses at most its share of the controller buffers, so
+   * that a stream ahead of the others does not take their credits. */
+  void send_iso_group(const iso_base* iso, bool interval_ended) {
+    if (interval_ended) {
+      uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+      ForEachIsoInGroup(iso, [now_us](uint16_t, iso_base* member) {
+        if (member->pending_sdu != nullptr ||
+            !(member->state_flags & kStateFlagIsSendingData))
+          return;
+
+        /* Don't hold the next intervals waiting for the stream, it joins
+         * again with its next SDU */
+        member->state_flags &= ~kStateFlagIsSendingData;
+        member->sch_stats.sdu_late_count++;
+        member->sch_stats.sdu_last_late_us = now_us;
+      });
+    }
+
+    uint16_t credit_quota = GetCreditQuota(iso);
+    auto hci = bluetooth::shim::hci_layer_get_interface();
+    ForEachIsoInGroup(iso, [&](uint16_t handle, iso_base* member) {
+      BT_HDR* packet = std::exchange(member->pending_sdu, nullptr);
+      if (packet == nullptr) return;
+
+      if (iso_credits_ == 0 || member->used_credits >= credit_quota) {
+        drop_sdu(handle, member, packet->len - kIsoHeaderWithoutTsLen);
+        osi_free(packet);
+        return;
+      }
+
+      iso_credits_--;
+      member->used_credits++;
+      hci->transmit_downward(packet->event, packet);
+    });
+  }
+
+  /* Stop scheduling the SDUs of a stream, which does not send anymore */
+  void drop_pending_sdu(iso_base* iso) {
+    iso->state_flags &= ~kStateFlagIsSendingData;
+    osi_free(std::exchange(iso->pending_sdu, nullptr));
+
+    /* The other streams of the group may only have waited for this one */
+    bool has_pending_sdu = false;
+    ForEachIsoInGroup(iso, [&has_pending_sdu](uint16_t, iso_base* member) {
+      has_pending_sdu |= (member->pending_sdu != nullptr);
+    });
+    if (has_pending_sdu && IsIsoGroupComplete(iso)) send_iso_group(iso, false);
   }
 
   void process_cis_est_pkt(uint8_t len, uint8_t* data) {
@@ -637,6 +713,7 @@ struct iso_impl {
         base::StringPrintf("cis_handle:0x%04x, reason:%s", handle,
                            hci_error_code_text((tHCI_REASON)(reason)).c_str()));
     cis_hdl_to_addr.erase(handle);
+    drop_pending_sdu(cis);
 
     if (cis->state_flags & kStateFlagIsConnected) {
       cis_disconnected_evt evt = {
@@ -902,6 +979,38 @@ struct iso_impl {
     return (iso != nullptr) ? iso : GetBisIfKnown(iso_handle);
   }
 
+  /* Call `f` with the handle and the state of each CIS of the CIG of `iso`,
+   * or of each BIS of its BIG */
+  template <typename F>
+  void ForEachIsoInGroup(const iso_base* iso, F f) const {
+    auto& iso_map = (iso->state_flags & kStateFlagIsBroadcast)
+                        ? conn_hdl_to_bis_map_
+                        : conn_hdl_to_cis_map_;
+    for (auto& [handle, member] : iso_map) {
+      if (member->cig_id == iso->cig_id) f(handle, member.get());
+    }
+  }
+
+  bool IsIsoGroupComplete(const iso_base* iso) const {
+    bool is_complete = true;
+    ForEachIsoInGroup(iso, [&is_complete](uint16_t, iso_base* member) {
+      if ((member->state_flags & kStateFlagIsSendingData) &&
+          member->pending_sdu == nullptr)
+        is_complete = false;
+    });
+    return is_complete;
+  }
+
+  /* Credits reserved to each stream of the CIG or BIG of `iso`: the
+   * controller buffers are shared evenly between its streams sending data */
+  uint16_t GetCreditQuota(const iso_base* iso) const {
+    int num_sending = 0;
+    ForEachIsoInGroup(iso, [&num_sending](uint16_t, iso_base* member) {
+      if (member->state_flags & kStateFlagIsSendingData) num_sending++;
+    });
+    return std::max(1, iso_buffer_count_ / std::max(num_sending, 1));
+  }
+
   bool IsCigKnown(uint8_t cig_id) const {
     auto const cis_it =
         std::find_if(conn_hdl_to_cis_map_.cbegin(), conn_hdl_to_cis_map_.cend(),
@@ -936,6 +1045,17 @@ struct iso_impl {
              : 0llu));
   }
 
+  static void dump_sched_stats(int fd, const iso_base::sched_stats& stats) {
+    uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+
+    dprintf(fd, "        Scheduling Stats:\n");
+    dprintf(fd, "          Late SDUs (count): %zu\n", stats.sdu_late_count);
+    dprintf(fd, "          Last late SDU time ago (ms): %llu\n",
+            (stats.sdu_last_late_us > 0
+                 ? (unsigned long long)(now_us - stats.sdu_last_late_us) / 1000
+                 : 0llu));
+  }
+
   static void dump_event_stats(int fd, const iso_base::event_stats& stats) {
     uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
 
@@ -961,24 +1081,28 @@ struct iso_impl {
     for (auto const& cis_pair : conn_hdl_to_cis_map_) {
       dprintf(fd, "      CIS Connection handle: %d\n", cis_pair.first);
       dprintf(fd, "        CIG ID: %d\n", cis_pair.second->cig_id);
-      dprintf(fd, "        Used Credits: %d\n",
-              cis_pair.second->used_credits.load());
+      dprintf(fd, "        Used Credits: %d (reserved: %d)\n",
+              cis_pair.second->used_credits.load(),
+              GetCreditQuota(cis_pair.second.get()));
       dprintf(fd, "        SDU Interval: %d\n", cis_pair.second->sdu_itv);
       dprintf(fd, "        State Flags: 0x%02hx\n",
               cis_pair.second->state_flags.load());
       dump_credits_stats(fd, cis_pair.second->cr_stats);
+      dump_sched_stats(fd, cis_pair.second->sch_stats);
       dump_event_stats(fd, cis_pair.second->evt_stats);
     }
     dprintf(fd, "    BISes:\n");
     for (auto const& cis_pair : conn_hdl_to_bis_map_) {
       dprintf(fd, "      BIS Connection handle: %d\n", cis_pair.first);
       dprintf(fd, "        BIG Handle: %d\n", cis_pair.second->big_handle);
-      dprintf(fd, "        Used Credits: %d\n",
-              cis_pair.second->used_credits.load());
+      dprintf(fd, "        Used Credits: %d (reserved: %d)\n",
+              cis_pair.second->used_credits.load(),
+              GetCreditQuota(cis_pair.second.get()));
       dprintf(fd, "        SDU Interval: %d\n", cis_pair.second->sdu_itv);
       dprintf(fd, "        State Flags: 0x%02hx\n",
               cis_pair.second->state_flags.load());
       dump_credits_stats(fd, cis_pair.second->cr_stats);
+      dump_sched_stats(fd, cis_pair.second->sch_stats);
       dump_event_stats(fd, cis_pair.second->evt_stats);
     }
     dprintf(fd, "  ----------------\n ");
@@ -989,6 +1113,7 @@ struct iso_impl {
   std::map<uint16_t, RawAddress> cis_hdl_to_addr;
 
   std::atomic_uint16_t iso_credits_;
+  int iso_buffer_count_;
   uint16_t iso_buffer_size_;
   uint32_t last_big_create_req_sdu_itv_;
 
@@ -35,12 +35,14 @@
 #include <string>
 
 #include "common/bidi_queue.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "device/include/device_iot_config.h"
 #include "gd/hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/include/hci_layer.h"
 #include "internal_include/bt_target.h"
+#include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
 #include "osi/include/properties.h"
 #include "osi/include/stack_power_telemetry.h"
@@ -81,12 +83,16 @@ typedef struct {
 
 constexpr char kBtmLogTag[] = "SCO";
 
+/* Offset of the data in a SCO packet, after the handle, flags and length */
+constexpr size_t kScoDataOffset = 3;
+
 };  // namespace
 
 using bluetooth::legacy::hci::GetInterface;
 
 // forward declaration for dequeueing packets
-static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet);
+static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet,
+                               uint64_t rx_timestamp_us);
 
 namespace cpp {
 bluetooth::common::BidiQueueEnd<bluetooth::hci::ScoBuilder,
@@ -105,7 +111,11 @@ static void sco_data_callback() {
     LOG_INFO("Dropping invalid packet of size %zu", packet->size());
     return;
   }
-  if (do_in_main_thread(FROM_HERE, base::Bind(&btm_route_sco_data, *packet)) !=
+  /* Stamp the packet on arrival, before it waits for the main thread */
+  if (do_in_main_thread(
+          FROM_HERE,
+          base::Bind(&btm_route_sco_data, *packet,
+                     bluetooth::common::time_get_os_monotonic_raw_us())) !=
       BT_STATUS_SUCCESS) {
     LOG_ERROR("do_in_main_thread failed from sco_data_callback");
   }
@@ -268,6 +278,19 @@ static tSCO_CONN* btm_get_active_sco() {
   return nullptr;
 }
 
+/* Return the rate of the 16-bit mono PCM data of the codec: sampled at 8kHz
+ * for CVSD, 16kHz for mSBC and 32kHz for LC3 */
+static size_t btm_sco_pcm_bytes_per_ms(tBTM_SCO_CODEC_TYPE codec_type) {
+  switch (codec_type) {
+    case BTM_SCO_CODEC_MSBC:
+      return 32;
+    case BTM_SCO_CODEC_LC3:
+      return 64;
+    default:
+      return 16;
+  }
+}
+
 /*******************************************************************************
  *
  * Function         btm_route_sco_data
@@ -279,11 +302,14 @@ static tSCO_CONN* btm_get_active_sco() {
  *                  also tries to balance the write/read data rate between the
  *                  Bluetooth and Audio stack by sending and receiving the same
  *                  amount of PCM data to and from the audio server.
+ *                  rx_timestamp_us is the time the packet was received from
+ *                  the HCI layer, used for the call health statistics.
  *
  * Returns          void
  *
  ******************************************************************************/
-static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
+static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet,
+                               uint64_t rx_timestamp_us) {
   uint16_t handle = valid_packet.GetHandle();
   if (handle > HCI_HANDLE_MAX) {
     LOG_ERROR("Dropping SCO data with invalid handle: 0x%X > 0x%X, ", handle,
@@ -304,9 +330,26 @@ static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
 
   const auto codec_type = active_sco->get_codec_type();
   const std::string codec = sco_codec_type_text(codec_type);
+  tBTM_SCO_STATS* stats = bluetooth::audio::sco::get_stats();
+  stats->update_rx(rx_timestamp_us);
+
+  /* Received packets are a single fragment: read the data in place rather
+   * than copying it out of the packet. */
+  std::vector<uint8_t> data;
+  const uint8_t* rx_data = nullptr;
+  size_t rx_len = 0, rx_fragments = 0;
+  valid_packet.GetLittleEndianSubview(kScoDataOffset, valid_packet.size())
+      .ForEachFragment([&](const uint8_t* fragment, size_t length) {
+        rx_data = fragment;
+        rx_len = length;
+        rx_fragments++;
+      });
+  if (rx_fragments > 1) {
+    data = valid_packet.GetData();
+    rx_data = data.data();
+    rx_len = data.size();
+  }
 
-  auto data = valid_packet.GetData();
-  auto rx_data = data.data();
   const uint8_t* decoded = nullptr;
   size_t written = 0, rc = 0;
   if (codec_type == BTM_SCO_CODEC_MSBC || codec_type == BTM_SCO_CODEC_LC3) {
@@ -316,24 +359,28 @@ static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
       LOG_DEBUG("%s packet corrupted with status(%s)", codec.c_str(),
                 PacketStatusFlagText(status).c_str());
     }
-    auto enqueue_packet = codec_type == BTM_SCO_CODEC_LC3
-                              ? &bluetooth::audio::sco::swb::enqueue_packet
-                              : &bluetooth::audio::sco::wbs::enqueue_packet;
+    bool (*enqueue_packet)(const uint8_t*, size_t, bool) =
+        codec_type == BTM_SCO_CODEC_LC3
+            ? &bluetooth::audio::sco::swb::enqueue_packet
+            : &bluetooth::audio::sco::wbs::enqueue_packet;
     rc = enqueue_packet(
-        data, status != bluetooth::hci::PacketStatusFlag::CORRECTLY_RECEIVED);
+        rx_data, rx_len,
+        status != bluetooth::hci::PacketStatusFlag::CORRECTLY_RECEIVED);
     if (!rc) LOG_DEBUG("Failed to enqueue %s packet", codec.c_str());
 
     while (rc) {
       auto decode = codec_type == BTM_SCO_CODEC_LC3
                         ? &bluetooth::audio::sco::swb::decode
                         : &bluetooth::audio::sco::wbs::decode;
+      uint64_t cpu_start_us = btm_sco_thread_cpu_time_us();
       rc = decode(&decoded);
       if (rc == 0) break;
+      stats->decode_cpu_us.update(btm_sco_thread_cpu_time_us() - cpu_start_us);
 
       written += bluetooth::audio::sco::write(decoded, rc);
     }
   } else {
-    written = bluetooth::audio::sco::write(rx_data, data.size());
+    written = bluetooth::audio::sco::write(rx_data, rx_len);
   }
 
   /* For Chrome OS, we send the outgoing data after receiving an incoming one.
@@ -384,11 +431,28 @@ static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
 
       btm_pcm_buf_write_offset += read;
 
+      /* Encode straight into the SCO packet when it holds a single frame,
+       * else into the packet buffer to be dequeued below */
+      auto encode_packet = codec_type == BTM_SCO_CODEC_LC3
+                               ? &bluetooth::audio::sco::swb::encode_packet
+                               : &bluetooth::audio::sco::wbs::encode_packet;
       auto encode = codec_type == BTM_SCO_CODEC_LC3
                         ? &bluetooth::audio::sco::swb::encode
                         : &bluetooth::audio::sco::wbs::encode;
-      rc = encode(&btm_pcm_buf[btm_pcm_buf_read_offset / sizeof(*btm_pcm_buf)],
-                  btm_pcm_buf_write_offset - btm_pcm_buf_read_offset);
+      int16_t* pcm =
+          &btm_pcm_buf[btm_pcm_buf_read_offset / sizeof(*btm_pcm_buf)];
+      size_t pcm_len = btm_pcm_buf_write_offset - btm_pcm_buf_read_offset;
+      std::vector<uint8_t> packet;
+      uint64_t cpu_start_us = btm_sco_thread_cpu_time_us();
+      rc = encode_packet(pcm, pcm_len, &packet);
+      if (!rc) rc = encode(pcm, pcm_len);
+      if (rc) {
+        stats->encode_cpu_us.update(btm_sco_thread_cpu_time_us() -
+                                    cpu_start_us);
+        /* The frame just encoded waited behind the PCM buffered before it */
+        stats->tx_latency_us.update(pcm_len * 1000 /
+                                    btm_sco_pcm_bytes_per_ms(codec_type));
+      }
 
       if (!rc)
         LOG_DEBUG(
@@ -406,6 +470,8 @@ static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
         btm_pcm_buf_read_offset = 0;
       }
 
+      if (!packet.empty()) btm_send_sco_packet(std::move(packet));
+
       /* Send all of the available SCO packets buffered in the queue */
       while (1) {
         auto dequeue_packet = codec_type == BTM_SCO_CODEC_LC3
@@ -431,6 +497,8 @@ static void btm_route_sco_data(bluetooth::hci::ScoView valid_packet) {
         break;
       }
       written -= read;
+      stats->tx_latency_us.update(read * 1000 /
+                                  btm_sco_pcm_bytes_per_ms(codec_type));
 
       /* In narrow-band, the CVSD encode is offloaded to controller so we can
        * send PCM data directly to SCO.
@@ -1246,6 +1314,18 @@ void btm_sco_on_disconnected(uint16_t hci_handle, tHCI_REASON reason) {
 
   if (p_sco->is_inband()) {
     const auto codec_type = p_sco->get_codec_type();
+    tBTM_SCO_STATS* stats = bluetooth::audio::sco::get_stats();
+    stats->flush_plc_burst();
+    LOG_INFO(
+        "SCO call health codec:%s rx_interval_us[%s] rx_jitter_us:%u "
+        "max_rx_jitter_us:%u tx_latency_us[%s] plc_burst_len[%s] "
+        "decode_cpu_us[%s] encode_cpu_us[%s]",
+        sco_codec_type_text(codec_type).c_str(),
+        stats->rx_interval_us.to_string().c_str(), stats->jitter_us(),
+        stats->max_jitter_us, stats->tx_latency_us.to_string().c_str(),
+        stats->plc_burst_len.to_string().c_str(),
+        stats->decode_cpu_us.to_string().c_str(),
+        stats->encode_cpu_us.to_string().c_str());
     if (codec_type == BTM_SCO_CODEC_MSBC || codec_type == BTM_SCO_CODEC_LC3) {
       auto fill_plc_stats = codec_type == BTM_SCO_CODEC_LC3
                                 ? bluetooth::audio::sco::swb::fill_plc_stats
@@ -1752,6 +1832,31 @@ tBTM_SCO_DEBUG_DUMP BTM_GetScoDebugDump() {
   return debug_dump;
 }
 
+#define DUMPSYS_TAG "stack::btm::sco"
+void BTM_ScoDumpsys(int fd) {
+  const tBTM_SCO_STATS* stats = bluetooth::audio::sco::get_stats();
+  tSCO_CONN* active_sco = btm_get_active_sco();
+
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  LOG_DUMPSYS(fd, " active:%s codec:%s", active_sco ? "true" : "false",
+              active_sco
+                  ? sco_codec_type_text(active_sco->get_codec_type()).c_str()
+                  : "none");
+  LOG_DUMPSYS(fd, " rx_interval_us %s",
+              stats->rx_interval_us.to_string().c_str());
+  LOG_DUMPSYS(fd, " rx_jitter_us:%u max_rx_jitter_us:%u", stats->jitter_us(),
+              stats->max_jitter_us);
+  LOG_DUMPSYS(fd, " tx_latency_us %s",
+              stats->tx_latency_us.to_string().c_str());
+  LOG_DUMPSYS(fd, " plc_burst_len %s ongoing:%u",
+              stats->plc_burst_len.to_string().c_str(), stats->plc_burst);
+  LOG_DUMPSYS(fd, " decode_cpu_us %s",
+              stats->decode_cpu_us.to_string().c_str());
+  LOG_DUMPSYS(fd, " encode_cpu_us %s",
+              stats->encode_cpu_us.to_string().c_str());
+}
+#undef DUMPSYS_TAG
+
 bool btm_peer_supports_esco_2m_phy(RawAddress remote_bda) {
   uint8_t* features = BTM_ReadRemoteFeatures(remote_bda);
   if (features == nullptr) {
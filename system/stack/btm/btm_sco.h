@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "device/include/esco_parameters.h"
 #include "include/check.h"
@@ -25,6 +26,7 @@
 #include "macros.h"
 #include "raw_address.h"
 #include "stack/btm/sco_pkt_status.h"
+#include "stack/btm/sco_stats.h"
 #include "stack/include/btm_api_types.h"
 
 #define BTM_MSBC_CODE_SIZE 240
@@ -49,6 +51,13 @@ size_t read(uint8_t* p_buf, uint32_t len);
 
 /* Write PCM data to the socket from SCO Rx */
 size_t write(const uint8_t* buf, uint32_t len);
+
+/* Get the health statistics of the current, or last, SCO-over-HCI call. They
+ * are reset by open().
+ * Returns:
+ *      Pointer to the statistics struct, never nullptr.
+ */
+tBTM_SCO_STATS* get_stats();
 }  // namespace bluetooth::audio::sco
 
 /* SCO-over-HCI audio HFP WBS related definitions */
@@ -80,11 +89,13 @@ bool fill_plc_stats(int* num_decoded_frames, double* packet_loss_ratio);
 
 /* Try to enqueue a packet to a buffer.
  * Args:
- *    data - Vector of received packet data bytes.
+ *    data - Received packet data bytes, copied straight into the buffer.
+ *    len - Length of the packet data.
  *    corrupted - If the current mSBC packet read is corrupted.
  * Returns:
  *    true if enqueued, false if it failed.
  */
+bool enqueue_packet(const uint8_t* data, size_t len, bool corrupted);
 bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted);
 
 /* Try to decode mSBC frames from the packets in the buffer.
@@ -104,6 +115,19 @@ size_t decode(const uint8_t** output);
  */
 size_t encode(int16_t* data, size_t len);
 
+/* Try to encode PCM data straight into an outgoing SCO packet, with its H2
+ * header, bypassing the packet buffer. This is only possible if a SCO packet
+ * holds exactly one mSBC packet, and no packet is left in the buffer.
+ * Args:
+ *    data - Pointer to the input PCM bytes for the encoder to encode.
+ *    len - Length of the input data.
+ *    packet - Output SCO packet data.
+ * Returns:
+ *    The length of input data that is encoded. 0 if failed, in which case the
+ *    caller shall use encode() and dequeue_packet().
+ */
+size_t encode_packet(int16_t* data, size_t len, std::vector<uint8_t>* packet);
+
 /* Dequeue a SCO packet with encoded mSBC data if possible. The length of the
  * packet is determined by the pkt_size set by the init().
  * Args:
@@ -149,11 +173,13 @@ bool fill_plc_stats(int* num_decoded_frames, double* packet_loss_ratio);
 
 /* Try to enqueue a packet to a buffer.
  * Args:
- *    data - Vector of received packet data bytes.
+ *    data - Received packet data bytes, copied straight into the buffer.
+ *    len - Length of the packet data.
  *    corrupted - If the current LC3 packet read is corrupted.
  * Returns:
  *    true if enqueued, false if it failed.
  */
+bool enqueue_packet(const uint8_t* data, size_t len, bool corrupted);
 bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted);
 
 /* Try to decode LC3 frames from the packets in the buffer.
@@ -173,6 +199,19 @@ size_t decode(const uint8_t** output);
  */
 size_t encode(int16_t* data, size_t len);
 
+/* Try to encode PCM data straight into an outgoing SCO packet, with its H2
+ * header, bypassing the packet buffer. This is only possible if a SCO packet
+ * holds exactly one LC3 packet, and no packet is left in the buffer.
+ * Args:
+ *    data - Pointer to the input PCM bytes for the encoder to encode.
+ *    len - Length of the input data.
+ *    packet - Output SCO packet data.
+ * Returns:
+ *    The length of input data that is encoded. 0 if failed, in which case the
+ *    caller shall use encode() and dequeue_packet().
+ */
+size_t encode_packet(int16_t* data, size_t len, std::vector<uint8_t>* packet);
+
 /* Dequeue a SCO packet with encoded LC3 data if possible. The length of the
  * packet is determined by the pkt_size set by the init().
  * Args:
@@ -70,6 +70,9 @@ namespace {
 
 std::unique_ptr<tUIPC_STATE> sco_uipc = nullptr;
 
+/* Health statistics of the SCO-over-HCI call, kept past its end for dumpsys */
+tBTM_SCO_STATS sco_stats = {};
+
 void sco_data_cb(tUIPC_CH_ID, tUIPC_EVENT event) {
   switch (event) {
     case UIPC_OPEN_EVT:
@@ -94,6 +97,8 @@ namespace audio {
 namespace sco {
 
 void open() {
+  sco_stats.init();
+
   if (sco_uipc != nullptr) {
     LOG_WARN("Re-opening UIPC that is already running");
   }
@@ -131,6 +136,8 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return UIPC_Read(*sco_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, len);
 }
 
+tBTM_SCO_STATS* get_stats() { return &sco_stats; }
+
 size_t write(const uint8_t* p_buf, uint32_t len) {
   if (sco_uipc == nullptr) {
     LOG_WARN("Write to uninitialized or closed UIPC");
@@ -496,14 +503,14 @@ struct tBTM_MSBC_INFO {
     }
   }
 
-  size_t write(const std::vector<uint8_t>& input) {
-    if (input.size() > buf_size - decode_buf_wo) {
+  size_t write(const uint8_t* input, size_t len) {
+    if (len > buf_size - decode_buf_wo) {
       return 0;
     }
 
-    std::copy(input.begin(), input.end(), msbc_decode_buf + decode_buf_wo);
-    decode_buf_wo += input.size();
-    return input.size();
+    std::copy(input, input + len, msbc_decode_buf + decode_buf_wo);
+    decode_buf_wo += len;
+    return len;
   }
 
   const uint8_t* find_msbc_pkt_head() {
@@ -545,14 +552,27 @@ struct tBTM_MSBC_INFO {
       return nullptr;
     }
 
+    encode_buf_wo += BTM_MSBC_PKT_LEN;
+    return fill_h2_header(wp);
+  }
+
+  /* Fill in the H2 header of the next mSBC packet at wp and return a pointer to
+   * the start of the packet's body. */
+  uint8_t* fill_h2_header(uint8_t* wp) {
     wp[0] = BTM_MSBC_H2_HEADER_0;
     wp[1] = btm_h2_header_frames_count[num_encoded_msbc_pkts % 4];
-    encode_buf_wo += BTM_MSBC_PKT_LEN;
 
     num_encoded_msbc_pkts++;
     return wp + BTM_MSBC_H2_HEADER_LEN;
   }
 
+  /* Whether the next mSBC packet can be encoded straight into a SCO packet:
+   * a SCO packet holds exactly one mSBC packet, and none is left in the
+   * buffer to be sent first. */
+  bool can_encode_sco_pkt() {
+    return packet_size == BTM_MSBC_PKT_LEN && encode_buf_wo == encode_buf_ro;
+  }
+
   size_t mark_pkt_dequeued() {
     if (encode_buf_wo - encode_buf_ro < packet_size) return 0;
 
@@ -615,28 +635,32 @@ bool fill_plc_stats(int* num_decoded_frames, double* packet_loss_ratio) {
   return true;
 }
 
-bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted) {
+bool enqueue_packet(const uint8_t* data, size_t len, bool corrupted) {
   if (msbc_info == nullptr) {
     LOG_WARN("mSBC buffer uninitialized or cleaned");
     return false;
   }
 
-  if (data.size() != msbc_info->packet_size) {
+  if (len != msbc_info->packet_size) {
     LOG_WARN(
         "Ignoring the coming packet with size %lu that is inconsistent with "
         "the HAL reported packet size %lu",
-        (unsigned long)data.size(), (unsigned long)msbc_info->packet_size);
+        (unsigned long)len, (unsigned long)msbc_info->packet_size);
     return false;
   }
 
   msbc_info->read_corrupted |= corrupted;
-  if (msbc_info->write(data) != data.size()) {
+  if (msbc_info->write(data, len) != len) {
     return false;
   }
 
   return true;
 }
 
+bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted) {
+  return enqueue_packet(data.data(), data.size(), corrupted);
+}
+
 size_t decode(const uint8_t** out_data) {
   const uint8_t* frame_head = nullptr;
 
@@ -670,6 +694,7 @@ size_t decode(const uint8_t** out_data) {
 
   msbc_info->plc->handle_good_frames(msbc_info->decoded_pcm_buf);
   msbc_info->pkt_status->update(false);
+  sco_stats.update_plc(false);
   *out_data = (const uint8_t*)msbc_info->decoded_pcm_buf;
   msbc_info->mark_pkt_decoded();
   return BTM_MSBC_CODE_SIZE;
@@ -677,6 +702,7 @@ size_t decode(const uint8_t** out_data) {
 packet_loss:
   msbc_info->plc->handle_bad_frames(out_data);
   msbc_info->pkt_status->update(true);
+  sco_stats.update_plc(true);
   msbc_info->mark_pkt_decoded();
   return BTM_MSBC_CODE_SIZE;
 }
@@ -714,6 +740,38 @@ size_t encode(int16_t* data, size_t len) {
   return BTM_MSBC_CODE_SIZE;
 }
 
+size_t encode_packet(int16_t* data, size_t len, std::vector<uint8_t>* packet) {
+  uint8_t* pkt_body = nullptr;
+  uint32_t encoded_size = 0;
+  if (msbc_info == nullptr) {
+    LOG_WARN("mSBC buffer uninitialized or cleaned");
+    return 0;
+  }
+
+  if (data == nullptr || packet == nullptr) {
+    LOG_WARN("Invalid data to encode");
+    return 0;
+  }
+
+  if (len < BTM_MSBC_CODE_SIZE || !msbc_info->can_encode_sco_pkt()) {
+    return 0;
+  }
+
+  /* The padding byte at the end of the mSBC packet is zero */
+  packet->assign(BTM_MSBC_PKT_LEN, 0);
+  pkt_body = msbc_info->fill_h2_header(packet->data());
+
+  encoded_size =
+      GetInterfaceToProfiles()->msbcCodec->encodePacket(data, pkt_body);
+  if (encoded_size != BTM_MSBC_PKT_FRAME_LEN) {
+    LOG_WARN("Encoding invalid packet size: %lu", (unsigned long)encoded_size);
+    std::copy(&btm_msbc_zero_packet[BTM_MSBC_H2_HEADER_LEN],
+              std::end(btm_msbc_zero_packet), pkt_body);
+  }
+
+  return BTM_MSBC_CODE_SIZE;
+}
+
 size_t dequeue_packet(const uint8_t** output) {
   if (msbc_info == nullptr) {
     LOG_WARN("mSBC buffer uninitialized or cleaned");
@@ -847,14 +905,27 @@ struct tBTM_LC3_INFO {
       return nullptr;
     }
 
+    encode_buf_wo += BTM_LC3_PKT_LEN;
+    return fill_h2_header(wp);
+  }
+
+  /* Fill in the H2 header of the next LC3 packet at wp and return a pointer to
+   * the start of the packet's body. */
+  uint8_t* fill_h2_header(uint8_t* wp) {
     wp[0] = BTM_LC3_H2_HEADER_0;
     wp[1] = btm_h2_header_frames_count[num_encoded_lc3_pkts % 4];
-    encode_buf_wo += BTM_LC3_PKT_LEN;
 
     num_encoded_lc3_pkts++;
     return wp + BTM_LC3_H2_HEADER_LEN;
   }
 
+  /* Whether the next LC3 packet can be encoded straight into a SCO packet:
+   * a SCO packet holds exactly one LC3 packet, and none is left in the
+   * buffer to be sent first. */
+  bool can_encode_sco_pkt() {
+    return packet_size == BTM_LC3_PKT_LEN && encode_buf_wo == encode_buf_ro;
+  }
+
   void mark_pkt_decoded() {
     if (decode_buf_ro + BTM_LC3_PKT_LEN > decode_buf_wo) {
       LOG_ERROR("Trying to mark read offset beyond write offset.");
@@ -868,14 +939,14 @@ struct tBTM_LC3_INFO {
     }
   }
 
-  size_t write(const std::vector<uint8_t>& input) {
-    if (input.size() > buf_size - decode_buf_wo) {
+  size_t write(const uint8_t* input, size_t len) {
+    if (len > buf_size - decode_buf_wo) {
       return 0;
     }
 
-    std::copy(input.begin(), input.end(), lc3_decode_buf + decode_buf_wo);
-    decode_buf_wo += input.size();
-    return input.size();
+    std::copy(input, input + len, lc3_decode_buf + decode_buf_wo);
+    decode_buf_wo += len;
+    return len;
   }
 
   const uint8_t* find_lc3_pkt_head() {
@@ -972,28 +1043,32 @@ bool fill_plc_stats(int* num_decoded_frames, double* packet_loss_ratio) {
   return true;
 }
 
-bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted) {
+bool enqueue_packet(const uint8_t* data, size_t len, bool corrupted) {
   if (lc3_info == nullptr) {
     LOG_WARN("LC3 buffer uninitialized or cleaned");
     return false;
   }
 
-  if (data.size() != lc3_info->packet_size) {
+  if (len != lc3_info->packet_size) {
     LOG_WARN(
         "Ignoring the coming packet with size %lu that is inconsistent with "
         "the HAL reported packet size %lu",
-        (unsigned long)data.size(), (unsigned long)lc3_info->packet_size);
+        (unsigned long)len, (unsigned long)lc3_info->packet_size);
     return false;
   }
 
   lc3_info->read_corrupted |= corrupted;
-  if (lc3_info->write(data) != data.size()) {
+  if (lc3_info->write(data, len) != len) {
     return false;
   }
 
   return true;
 }
 
+bool enqueue_packet(const std::vector<uint8_t>& data, bool corrupted) {
+  return enqueue_packet(data.data(), data.size(), corrupted);
+}
+
 size_t decode(const uint8_t** out_data) {
   const uint8_t* frame_head = nullptr;
 
@@ -1017,6 +1092,7 @@ size_t decode(const uint8_t** out_data) {
       frame_head, lc3_info->decoded_pcm_buf, sizeof(lc3_info->decoded_pcm_buf));
 
   lc3_info->pkt_status->update(plc_conducted);
+  sco_stats.update_plc(plc_conducted);
 
   ++decoded_frames;
   lost_frames += plc_conducted;
@@ -1051,6 +1127,31 @@ size_t encode(int16_t* data, size_t len) {
   return GetInterfaceToProfiles()->lc3Codec->encodePacket(data, pkt_body);
 }
 
+size_t encode_packet(int16_t* data, size_t len, std::vector<uint8_t>* packet) {
+  uint8_t* pkt_body = nullptr;
+  size_t encoded = 0;
+  if (lc3_info == nullptr) {
+    LOG_WARN("LC3 buffer uninitialized or cleaned");
+    return 0;
+  }
+
+  if (data == nullptr || packet == nullptr) {
+    LOG_WARN("Invalid data to encode");
+    return 0;
+  }
+
+  if (len < BTM_LC3_CODE_SIZE || !lc3_info->can_encode_sco_pkt()) {
+    return 0;
+  }
+
+  packet->resize(BTM_LC3_PKT_LEN);
+  pkt_body = lc3_info->fill_h2_header(packet->data());
+
+  encoded = GetInterfaceToProfiles()->lc3Codec->encodePacket(data, pkt_body);
+  if (encoded == 0) packet->clear();
+  return encoded;
+}
+
 size_t dequeue_packet(const uint8_t** output) {
   if (lc3_info == nullptr) {
     LOG_WARN("LC3 buffer uninitialized or cleaned");
@@ -20,6 +20,7 @@
 #include "stack/btm/btm_sec_cb.h"
 
 #include <cstdint>
+#include <unordered_map>
 
 #include "internal_include/stack_config.h"
 #include "os/log.h"
@@ -54,6 +55,7 @@ void tBTM_SEC_CB::Init(uint8_t initial_security_mode) {
     *((tBTM_SEC_DEV_REC*)ptr) = {};
     osi_free(ptr);
   });
+  sec_dev_rec_index.Clear();
 }
 
 void tBTM_SEC_CB::Free() {
@@ -62,6 +64,7 @@ void tBTM_SEC_CB::Free() {
 
   list_free(sec_dev_rec);
   sec_dev_rec = nullptr;
+  sec_dev_rec_index.Clear();
 
   alarm_free(sec_collision_timer);
   sec_collision_timer = nullptr;
@@ -73,6 +76,83 @@ void tBTM_SEC_CB::Free() {
   execution_wait_timer = nullptr;
 }
 
+namespace {
+
+template <typename Key>
+tBTM_SEC_DEV_REC* find_in_index(
+    const std::unordered_map<Key, tBTM_SEC_DEV_REC*>& index, const Key& key,
+    const tBTM_SEC_DEV_REC_INDEX& records) {
+  auto it = index.find(key);
+  if (it == index.end() || !records.Contains(it->second)) return nullptr;
+  return it->second;
+}
+
+template <typename Key>
+void set_in_index(std::unordered_map<Key, tBTM_SEC_DEV_REC*>& index,
+                  const Key& key, tBTM_SEC_DEV_REC* p_dev_rec) {
+  // Stale keys are only dropped with their record, start over when too many
+  // addresses were seen for the records.
+  if (index.size() >= tBTM_SEC_DEV_REC_INDEX::kMaxEntries) index.clear();
+  index[key] = p_dev_rec;
+}
+
+template <typename Key>
+void remove_from_index(std::unordered_map<Key, tBTM_SEC_DEV_REC*>& index,
+                       const tBTM_SEC_DEV_REC* p_dev_rec) {
+  for (auto it = index.begin(); it != index.end();) {
+    if (it->second == p_dev_rec) {
+      it = index.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace
+
+void tBTM_SEC_DEV_REC_INDEX::Remove(const tBTM_SEC_DEV_REC* p_dev_rec) {
+  records_.erase(p_dev_rec);
+  remove_from_index(by_address_, p_dev_rec);
+  remove_from_index(by_identity_address_, p_dev_rec);
+  remove_from_index(by_handle_, p_dev_rec);
+}
+
+void tBTM_SEC_DEV_REC_INDEX::Clear() {
+  records_.clear();
+  by_address_.clear();
+  by_identity_address_.clear();
+  by_handle_.clear();
+}
+
+tBTM_SEC_DEV_REC* tBTM_SEC_DEV_REC_INDEX::FindByAddress(
+    const RawAddress& bd_addr) const {
+  return find_in_index(by_address_, bd_addr, *this);
+}
+
+tBTM_SEC_DEV_REC* tBTM_SEC_DEV_REC_INDEX::FindByIdentityAddress(
+    const RawAddress& bd_addr) const {
+  return find_in_index(by_identity_address_, bd_addr, *this);
+}
+
+tBTM_SEC_DEV_REC* tBTM_SEC_DEV_REC_INDEX::FindByHandle(uint16_t handle) const {
+  return find_in_index(by_handle_, handle, *this);
+}
+
+void tBTM_SEC_DEV_REC_INDEX::SetAddress(const RawAddress& bd_addr,
+                                        tBTM_SEC_DEV_REC* p_dev_rec) {
+  set_in_index(by_address_, bd_addr, p_dev_rec);
+}
+
+void tBTM_SEC_DEV_REC_INDEX::SetIdentityAddress(const RawAddress& bd_addr,
+                                                tBTM_SEC_DEV_REC* p_dev_rec) {
+  set_in_index(by_identity_address_, bd_addr, p_dev_rec);
+}
+
+void tBTM_SEC_DEV_REC_INDEX::SetHandle(uint16_t handle,
+                                       tBTM_SEC_DEV_REC* p_dev_rec) {
+  set_in_index(by_handle_, handle, p_dev_rec);
+}
+
 tBTM_SEC_CB btm_sec_cb;
 
 void BTM_Sec_Init() {
@@ -18,6 +18,8 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "internal_include/bt_target.h"
 #include "osi/include/alarm.h"
@@ -29,6 +31,37 @@
 #include "stack/include/security_client_callbacks.h"
 #include "types/raw_address.h"
 
+/* Lookup indexes of tBTM_SEC_CB::sec_dev_rec, kept alongside the list.
+ * Records change address or handle in place, so a record found through an
+ * index is checked against the key before it is used. */
+class tBTM_SEC_DEV_REC_INDEX {
+ public:
+  static constexpr size_t kMaxEntries = 4 * BTM_SEC_MAX_DEVICE_RECORDS;
+
+  void Add(const tBTM_SEC_DEV_REC* p_dev_rec) { records_.insert(p_dev_rec); }
+  void Remove(const tBTM_SEC_DEV_REC* p_dev_rec);
+  void Clear();
+  /* Whether the record is in the list, a stale index entry may point to a
+   * freed record. */
+  bool Contains(const tBTM_SEC_DEV_REC* p_dev_rec) const {
+    return records_.count(p_dev_rec) != 0;
+  }
+
+  tBTM_SEC_DEV_REC* FindByAddress(const RawAddress& bd_addr) const;
+  tBTM_SEC_DEV_REC* FindByIdentityAddress(const RawAddress& bd_addr) const;
+  tBTM_SEC_DEV_REC* FindByHandle(uint16_t handle) const;
+  void SetAddress(const RawAddress& bd_addr, tBTM_SEC_DEV_REC* p_dev_rec);
+  void SetIdentityAddress(const RawAddress& bd_addr,
+                          tBTM_SEC_DEV_REC* p_dev_rec);
+  void SetHandle(uint16_t handle, tBTM_SEC_DEV_REC* p_dev_rec);
+
+ private:
+  std::unordered_set<const tBTM_SEC_DEV_REC*> records_;
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> by_address_;
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> by_identity_address_;
+  std::unordered_map<uint16_t, tBTM_SEC_DEV_REC*> by_handle_;
+};
+
 class tBTM_SEC_CB {
  public:
   tBTM_CFG cfg; /* Device configuration */
@@ -68,6 +101,7 @@ class tBTM_SEC_CB {
   alarm_t* pairing_timer{nullptr};        /* Timer for pairing process    */
   alarm_t* execution_wait_timer{nullptr}; /* To avoid concurrent auth request */
   list_t* sec_dev_rec{nullptr}; /* list of tBTM_SEC_DEV_REC */
+  tBTM_SEC_DEV_REC_INDEX sec_dev_rec_index;
   tBTM_SEC_SERV_REC* p_out_serv{nullptr};
   tBTM_MKEY_CALLBACK* mkey_cback{nullptr};
 
@@ -152,6 +152,9 @@ void BTM_PM_OnConnected(uint16_t handle, const RawAddress& remote_bda);
 // Notified by ACL that a link is disconnected
 void BTM_PM_OnDisconnected(uint16_t handle);
 
+// Notified by ACL of each data packet sent or received on a link
+void BTM_PM_OnAclTraffic(uint16_t handle);
+
 /*******************************************************************************
  *
  * Function         BTM_SetPowerMode
@@ -167,6 +170,25 @@ tBTM_STATUS BTM_SetPowerMode(uint8_t pm_id, const RawAddress& remote_bda,
                              const tBTM_PM_PWR_MD* p_mode);
 bool BTM_SetLinkPolicyActiveMode(const RawAddress& remote_bda);
 
+/*******************************************************************************
+ *
+ * Function         BTM_PM_SetMaxSniffInterval
+ *
+ * Description      Limit the sniff interval of the ACL connection, which
+ *                  bounds the latency of the traffic while in sniff mode.
+ *                  Applies to the next sniff requests.
+ *
+ * Input Param      remote_bda   - device address of desired ACL connection
+ *                  max_interval - longest sniff interval (in 0.625ms), or 0
+ *                                 to remove the limit
+ *
+ * Returns          BTM_SUCCESS if successful,
+ *                  BTM_UNKNOWN_ADDR if bd addr is not active or bad
+ *
+ ******************************************************************************/
+tBTM_STATUS BTM_PM_SetMaxSniffInterval(const RawAddress& remote_bda,
+                                       uint16_t max_interval);
+
 /*******************************************************************************
  *
  * Function         BTM_SetSsrParams
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <time.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define BTM_SCO_HISTOGRAM_MAX_BUCKETS 8
+
+/* Exclusive upper bounds of the buckets of the SCO histograms. Every histogram
+ * has one more bucket for the samples above its last bound. */
+constexpr uint32_t kBtmScoRxIntervalBoundsUs[] = {2500,  5000,  7000, 8000,
+                                                   10000, 15000, 30000};
+constexpr uint32_t kBtmScoTxLatencyBoundsUs[] = {5000, 10000, 20000, 40000,
+                                                 80000};
+constexpr uint32_t kBtmScoPlcBurstBounds[] = {2, 3, 5, 9};
+constexpr uint32_t kBtmScoCodecCpuBoundsUs[] = {50, 100, 200, 500, 1000};
+
+/* CPU time consumed by the calling thread, in microseconds */
+inline uint64_t btm_sco_thread_cpu_time_us() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Histogram of samples over fixed bucket bounds; storage is preallocated so
+ * updating it from the SCO data path never allocates */
+typedef struct {
+  const uint32_t* bounds;
+  size_t num_bounds;
+  uint64_t buckets[BTM_SCO_HISTOGRAM_MAX_BUCKETS];
+  uint64_t count;
+  uint64_t sum;
+  uint32_t max;
+
+ public:
+  template <size_t N>
+  void init(const uint32_t (&b)[N]) {
+    static_assert(N < BTM_SCO_HISTOGRAM_MAX_BUCKETS, "Too many bucket bounds");
+    bounds = b;
+    num_bounds = N;
+    std::fill(std::begin(buckets), std::end(buckets), 0);
+    count = 0;
+    sum = 0;
+    max = 0;
+  }
+
+  void update(uint32_t sample) {
+    size_t i = 0;
+    while (i < num_bounds && sample >= bounds[i]) i++;
+    buckets[i]++;
+    count++;
+    sum += sample;
+    max = std::max(max, sample);
+  }
+
+  uint32_t mean() const { return count == 0 ? 0 : sum / count; }
+
+  /* Output format: count:<n> mean:<m> max:<x> histogram:<b0>/<b1>/...
+   * The buckets are separated by the bounds, e.g. <b0> counts the samples
+   * below bounds[0]. */
+  std::string to_string() const {
+    std::string s = "count:" + std::to_string(count) +
+                    " mean:" + std::to_string(mean()) +
+                    " max:" + std::to_string(max) + " histogram:";
+    for (size_t i = 0; i <= num_bounds; i++) {
+      if (i) s += "/";
+      s += std::to_string(buckets[i]);
+    }
+    return s;
+  }
+} tBTM_SCO_HISTOGRAM;
+
+/* Per call health statistics of a SCO link routed over HCI */
+typedef struct {
+  // Interval between the arrivals of the received SCO packets.
+  tBTM_SCO_HISTOGRAM rx_interval_us;
+  // Estimated time a PCM sample spends in the stack before it is sent to the
+  // controller: the PCM backlog at the time its packet is sent.
+  tBTM_SCO_HISTOGRAM tx_latency_us;
+  // Lengths of the runs of consecutive frames concealed by the PLC.
+  tBTM_SCO_HISTOGRAM plc_burst_len;
+  // Thread CPU time taken to decode or conceal one frame.
+  tBTM_SCO_HISTOGRAM decode_cpu_us;
+  // Thread CPU time taken to encode one frame.
+  tBTM_SCO_HISTOGRAM encode_cpu_us;
+  // Arrival time of the last received packet.
+  uint64_t last_rx_us;
+  // Last arrival interval, to compute the jitter from.
+  uint32_t last_rx_interval_us;
+  // Inter-arrival jitter estimate, scaled by 16 as in RFC 3550.
+  uint32_t jitter_x16;
+  uint32_t max_jitter_us;
+  // Length of the ongoing run of concealed frames.
+  uint32_t plc_burst;
+
+ public:
+  void init() {
+    rx_interval_us.init(kBtmScoRxIntervalBoundsUs);
+    tx_latency_us.init(kBtmScoTxLatencyBoundsUs);
+    plc_burst_len.init(kBtmScoPlcBurstBounds);
+    decode_cpu_us.init(kBtmScoCodecCpuBoundsUs);
+    encode_cpu_us.init(kBtmScoCodecCpuBoundsUs);
+    last_rx_us = 0;
+    last_rx_interval_us = 0;
+    jitter_x16 = 0;
+    max_jitter_us = 0;
+    plc_burst = 0;
+  }
+
+  void update_rx(uint64_t now_us) {
+    if (last_rx_us != 0 && now_us >= last_rx_us) {
+      uint32_t interval = now_us - last_rx_us;
+      rx_interval_us.update(interval);
+      if (last_rx_interval_us != 0) {
+        uint32_t d = interval > last_rx_interval_us
+                         ? interval - last_rx_interval_us
+                         : last_rx_interval_us - interval;
+        jitter_x16 += d - ((jitter_x16 + 8) >> 4);
+        max_jitter_us = std::max(max_jitter_us, jitter_us());
+      }
+      last_rx_interval_us = interval;
+    }
+    last_rx_us = now_us;
+  }
+
+  void update_plc(bool is_lost) {
+    if (is_lost) {
+      plc_burst++;
+      return;
+    }
+    flush_plc_burst();
+  }
+
+  /* Records the ongoing run of concealed frames, if any */
+  void flush_plc_burst() {
+    if (plc_burst == 0) return;
+    plc_burst_len.update(plc_burst);
+    plc_burst = 0;
+  }
+
+  uint32_t jitter_us() const { return (jitter_x16 + 8) >> 4; }
+} tBTM_SCO_STATS;
@@ -28,6 +28,7 @@
 #include "common/message_loop_thread.h"
 #include "include/hardware/bluetooth.h"
 #include "os/log.h"
+#include "osi/include/thread_scheduler.h"
 
 using bluetooth::common::MessageLoopThread;
 
@@ -63,11 +64,13 @@ void post_on_bt_main(BtMainClosure closure) {
 }
 
 void main_thread_start_up() {
+  main_thread.EnableTaskStats();
   main_thread.StartUp();
   if (!main_thread.IsRunning()) {
     LOG(FATAL) << __func__ << ": unable to start btu message loop thread.";
   }
-  if (!main_thread.EnableRealTimeScheduling()) {
+  if (!thread_scheduler_apply_profile(main_thread.GetLinuxThreadId(),
+                                      "bt_main")) {
 #if defined(__ANDROID__)
     LOG(FATAL) << __func__ << ": unable to enable real time scheduling";
 #else
@@ -185,6 +185,12 @@ EattChannel* EattExtension::GetChannelAvailableForClientRequest(
   return pimpl_->eatt_impl_->get_channel_available_for_client_request(bd_addr);
 }
 
+EattChannel* EattExtension::GetLeastBusyChannelForClientRequest(
+    const RawAddress& bd_addr) {
+  return pimpl_->eatt_impl_->get_least_busy_channel_for_client_request(
+      bd_addr);
+}
+
 /* Start stop GATT indication timer per CID */
 void EattExtension::StartIndicationConfirmationTimer(const RawAddress& bd_addr,
                                                      uint16_t cid) {
@@ -207,6 +213,11 @@ void EattExtension::StopAppIndicationTimer(const RawAddress& bd_addr,
   pimpl_->eatt_impl_->stop_app_indication_timer(bd_addr, cid);
 }
 
+void EattExtension::Dump(int fd) {
+  if (!pimpl_->IsRunning()) return;
+  pimpl_->eatt_impl_->dump(fd);
+}
+
 void EattExtension::Start() { pimpl_->Start(); }
 
 void EattExtension::Stop() { pimpl_->Stop(); }
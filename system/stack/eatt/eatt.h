@@ -57,6 +57,9 @@ class EattChannel {
   alarm_t* ind_confirmation_timer_;
   /* GATT client command queue */
   std::deque<tGATT_CMD_Q> cl_cmd_q_;
+  /* GATT client requests sent on the channel, and largest queue seen */
+  uint32_t cl_requests_{0};
+  uint16_t cl_max_queued_{0};
 
   EattChannel(RawAddress& bda, uint16_t cid, uint16_t tx_mtu, uint16_t rx_mtu)
       : bda_(bda),
@@ -243,6 +246,17 @@ class EattExtension {
   virtual EattChannel* GetChannelAvailableForClientRequest(
       const RawAddress& bd_addr);
 
+  /**
+   * Get the EATT channel with the fewest queued GATT requests, for when none
+   * is idle.
+   *
+   * @param bd_addr peer device address
+   *
+   * @return pointer to EATT channel.
+   */
+  virtual EattChannel* GetLeastBusyChannelForClientRequest(
+      const RawAddress& bd_addr);
+
   /**
    * Start GATT indication timer per CID.
    *
@@ -277,6 +291,13 @@ class EattExtension {
    */
   virtual void StopAppIndicationTimer(const RawAddress& bd_addr, uint16_t cid);
 
+  /**
+   * Dump the bearers of each device and how much they were used.
+   *
+   * @param fd file descriptor to write to
+   */
+  virtual void Dump(int fd);
+
   /**
    * Starts the EattExtension module
    */
@@ -684,15 +684,36 @@ struct eatt_impl {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
     if (!eatt_dev) return nullptr;
 
-    auto iter = find_if(
-        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
-        [](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
-          return el.second->state_ == EattChannelState::EATT_CHANNEL_OPENED &&
-                 el.second->cl_cmd_q_.empty();
-        });
+    /* Of the idle channels, take the one that served the fewest requests, so
+     * that the load spreads over all of them */
+    EattChannel* best = nullptr;
+    for (const auto& el : eatt_dev->eatt_channels) {
+      EattChannel* channel = el.second.get();
+      if (channel->state_ != EattChannelState::EATT_CHANNEL_OPENED ||
+          !channel->cl_cmd_q_.empty())
+        continue;
+      if (best == nullptr || channel->cl_requests_ < best->cl_requests_) {
+        best = channel;
+      }
+    }
+    return best;
+  }
 
-    return (iter == eatt_dev->eatt_channels.end()) ? nullptr
-                                                   : iter->second.get();
+  EattChannel* get_least_busy_channel_for_client_request(
+      const RawAddress& bd_addr) {
+    eatt_device* eatt_dev = find_device_by_address(bd_addr);
+    if (!eatt_dev) return nullptr;
+
+    EattChannel* best = nullptr;
+    for (const auto& el : eatt_dev->eatt_channels) {
+      EattChannel* channel = el.second.get();
+      if (channel->state_ != EattChannelState::EATT_CHANNEL_OPENED) continue;
+      if (best == nullptr ||
+          channel->cl_cmd_q_.size() < best->cl_cmd_q_.size()) {
+        best = channel;
+      }
+    }
+    return best;
   }
 
   void free_gatt_resources(const RawAddress& bd_addr) {
@@ -803,6 +824,29 @@ struct eatt_impl {
     alarm_cancel(channel->ind_ack_timer_);
   }
 
+  void dump(int fd) {
+    dprintf(fd, "\nEATT bearers:\n");
+    for (const eatt_device& eatt_dev : devices_) {
+      const tGATT_TCB* p_tcb =
+          gatt_find_tcb_by_addr(eatt_dev.bda_, BT_TRANSPORT_LE);
+      if (p_tcb == nullptr) continue;
+      dprintf(fd, "  %s\n", ADDRESS_TO_LOGGABLE_CSTR(eatt_dev.bda_));
+      dprintf(fd,
+              "    att cid:0x%04x requests:%u queued:%zu max_queued:%u\n",
+              p_tcb->att_lcid, p_tcb->cl_requests, p_tcb->cl_cmd_q.size(),
+              p_tcb->cl_max_queued);
+      for (const auto& el : eatt_dev.eatt_channels) {
+        const EattChannel* channel = el.second.get();
+        dprintf(fd,
+                "    eatt cid:0x%04x state:%d tx_mtu:%u requests:%u "
+                "queued:%zu max_queued:%u\n",
+                channel->cid_, static_cast<int>(channel->state_),
+                channel->tx_mtu_, channel->cl_requests_,
+                channel->cl_cmd_q_.size(), channel->cl_max_queued_);
+      }
+    }
+  }
+
   void reconfigure(const RawAddress& bd_addr, uint16_t cid, uint16_t new_mtu) {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
     if (!eatt_dev) {
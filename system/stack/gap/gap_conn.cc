@@ -20,6 +20,8 @@
 #include <base/strings/stringprintf.h>
 #include <string.h>
 
+#include <vector>
+
 #include "device/include/controller.h"
 #include "gap_api.h"
 #include "internal_include//bt_target.h"
@@ -97,6 +99,18 @@ static void gap_data_ind(uint16_t l2cap_cid, BT_HDR* p_msg);
 static void gap_congestion_ind(uint16_t lcid, bool is_congested);
 static void gap_tx_complete_ind(uint16_t l2cap_cid, uint16_t sdu_sent);
 static void gap_on_l2cap_error(uint16_t l2cap_cid, uint16_t result);
+static void gap_credit_based_connect_ind(const RawAddress& bd_addr,
+                                         std::vector<uint16_t>& lcids,
+                                         uint16_t psm, uint16_t peer_mtu,
+                                         uint8_t identifier);
+static void gap_credit_based_connect_cfm(const RawAddress& bd_addr,
+                                         uint16_t l2cap_cid, uint16_t peer_mtu,
+                                         uint16_t result);
+static void gap_credit_based_reconfig_completed(const RawAddress& bd_addr,
+                                                uint16_t l2cap_cid,
+                                                bool is_local_cfg,
+                                                tL2CAP_LE_CFG_INFO* p_cfg);
+static void gap_credit_based_collision_ind(const RawAddress& bd_addr);
 static tGAP_CCB* gap_find_ccb_by_cid(uint16_t cid);
 static tGAP_CCB* gap_find_ccb_by_handle(uint16_t handle);
 static tGAP_CCB* gap_allocate_ccb(void);
@@ -126,6 +140,12 @@ void gap_conn_init(void) {
   conn.reg_info.pL2CA_CongestionStatus_Cb = gap_congestion_ind;
   conn.reg_info.pL2CA_TxComplete_Cb = gap_tx_complete_ind;
   conn.reg_info.pL2CA_Error_Cb = gap_on_l2cap_error;
+  conn.reg_info.pL2CA_CreditBasedConnectInd_Cb = gap_credit_based_connect_ind;
+  conn.reg_info.pL2CA_CreditBasedConnectCfm_Cb = gap_credit_based_connect_cfm;
+  conn.reg_info.pL2CA_CreditBasedReconfigCompleted_Cb =
+      gap_credit_based_reconfig_completed;
+  conn.reg_info.pL2CA_CreditBasedCollisionInd_Cb =
+      gap_credit_based_collision_ind;
 }
 
 /*******************************************************************************
@@ -221,10 +241,13 @@ uint16_t GAP_ConnOpen(const char* p_serv_name, uint8_t service_id,
   p_ccb->p_callback = p_cb;
 
   /* If originator, use a dynamic PSM */
-  if (!is_server)
+  if (!is_server) {
     conn.reg_info.pL2CA_ConnectInd_Cb = NULL;
-  else
+    conn.reg_info.pL2CA_CreditBasedConnectInd_Cb = NULL;
+  } else {
     conn.reg_info.pL2CA_ConnectInd_Cb = gap_connect_ind;
+    conn.reg_info.pL2CA_CreditBasedConnectInd_Cb = gap_credit_based_connect_ind;
+  }
 
   /* Fill in eL2CAP parameter data */
   if (p_ccb->cfg.fcr_present) {
@@ -299,6 +322,109 @@ uint16_t GAP_ConnOpen(const char* p_serv_name, uint8_t service_id,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         GAP_ConnOpenCreditBased
+ *
+ * Description      This function is called to open up to
+ *                  L2CAP_CREDIT_BASED_MAX_CIDS LE CoC channels to the same PSM
+ *                  of a peer with a single L2CAP Credit Based Connection
+ *                  Request. Each channel gets its own GAP handle, and reports
+ *                  GAP_EVT_CONN_OPENED or GAP_EVT_CONN_CLOSED on its own.
+ *
+ * Parameters:      service_id  - Unique service ID used by BTM
+ *                  rem_bda     - Remote BD Address, an LE link must be up
+ *                  psm         - the PSM used for the connections
+ *                  le_mps      - Maximum PDU Size of each channel
+ *                  p_cfg       - configuration, its MTU is used for each
+ *                                channel
+ *                  security    - security flags
+ *                  p_cb        - Pointer to callback function for events.
+ *                  num_channels - Number of channels requested
+ *
+ * Returns          handles of the channels being set up, in the order of the
+ *                  request, empty if the request could not be sent
+ *
+ ******************************************************************************/
+std::vector<uint16_t> GAP_ConnOpenCreditBased(
+    const char* p_serv_name, uint8_t service_id, const RawAddress& rem_bda,
+    uint16_t psm, uint16_t le_mps, tL2CAP_CFG_INFO* p_cfg, uint16_t security,
+    tGAP_CONN_CALLBACK* p_cb, uint8_t num_channels) {
+  std::vector<uint16_t> handles;
+
+  if (p_cfg == NULL || num_channels == 0 ||
+      num_channels > L2CAP_CREDIT_BASED_MAX_CIDS) {
+    LOG(ERROR) << StringPrintf("%s: Invalid request for %d channels", __func__,
+                               num_channels);
+    return handles;
+  }
+
+  uint16_t max_mps = controller_get_interface()->get_acl_data_size_ble();
+  if (le_mps > max_mps) {
+    LOG(INFO) << "Limiting MPS to one buffer size - " << max_mps;
+    le_mps = max_mps;
+  }
+  tL2CAP_LE_CFG_INFO local_coc_cfg = {
+      .mtu = p_cfg->mtu,
+      .mps = le_mps,
+      .credits = L2CA_LeCreditDefault(),
+      .number_of_channels = num_channels,
+  };
+
+  /* Outgoing only, use a dynamic PSM */
+  conn.reg_info.pL2CA_ConnectInd_Cb = NULL;
+  conn.reg_info.pL2CA_CreditBasedConnectInd_Cb = NULL;
+  uint16_t vpsm =
+      L2CA_RegisterLECoc(psm, conn.reg_info, security, local_coc_cfg);
+  if (vpsm == 0) {
+    LOG(ERROR) << StringPrintf("%s: Failure registering PSM 0x%04x", __func__,
+                               psm);
+    return handles;
+  }
+  /* L2CAP checks it before sending the request for all the channels */
+  BTM_SetSecurityLevel(true, "", 0, security, vpsm, 0, 0);
+
+  std::vector<tGAP_CCB*> ccbs;
+  while (ccbs.size() < num_channels) {
+    tGAP_CCB* p_ccb = gap_allocate_ccb();
+    if (p_ccb == NULL) break;
+
+    p_ccb->transport = BT_TRANSPORT_LE;
+    p_ccb->service_id = service_id;
+    p_ccb->rem_addr_specified = true;
+    p_ccb->rem_dev_address = rem_bda;
+    p_ccb->cfg = *p_cfg;
+    p_ccb->local_coc_cfg = local_coc_cfg;
+    p_ccb->p_callback = p_cb;
+    p_ccb->psm = vpsm;
+    p_ccb->con_flags = GAP_CCB_FLAGS_IS_ORIG | GAP_CCB_FLAGS_SEC_DONE;
+    p_ccb->con_state = GAP_CCB_STATE_CONN_SETUP;
+    ccbs.push_back(p_ccb);
+  }
+
+  if (ccbs.empty()) {
+    BTM_SecClrServiceByPsm(vpsm);
+    L2CA_DeregisterLECoc(vpsm);
+    return handles;
+  }
+
+  local_coc_cfg.number_of_channels = ccbs.size();
+  std::vector<uint16_t> cids =
+      L2CA_ConnectCreditBasedReq(vpsm, rem_bda, &local_coc_cfg);
+
+  /* The last released CCB deregisters the PSM */
+  for (size_t i = 0; i < ccbs.size(); i++) {
+    if (i < cids.size()) {
+      ccbs[i]->connection_id = cids[i];
+      handles.push_back(ccbs[i]->gap_handle);
+    } else {
+      gap_release_ccb(ccbs[i]);
+    }
+  }
+
+  return handles;
+}
+
 /*******************************************************************************
  *
  * Function         GAP_ConnClose
@@ -390,6 +516,44 @@ uint16_t GAP_ConnReadData(uint16_t gap_handle, uint8_t* p_data,
   return (BT_PASS);
 }
 
+/*******************************************************************************
+ *
+ * Function         GAP_ConnBTRead
+ *
+ * Description      Bluetooth-aware applications will call this function after
+ *                  receiving GAP_EVT_RXDATA event. The first received SDU is
+ *                  handed over as is, without copying its payload.
+ *
+ * Parameters:      handle      - Handle of the connection returned in the Open
+ *                  pp_buf      - pointer to address of the buffer; the caller
+ *                                owns the buffer on success
+ *
+ * Returns          BT_PASS             - data read
+ *                  GAP_ERR_BAD_HANDLE  - invalid handle
+ *                  GAP_NO_DATA_AVAIL   - no data available
+ *
+ ******************************************************************************/
+uint16_t GAP_ConnBTRead(uint16_t gap_handle, BT_HDR** pp_buf) {
+  tGAP_CCB* p_ccb = gap_find_ccb_by_handle(gap_handle);
+
+  if (!p_ccb) return (GAP_ERR_BAD_HANDLE);
+
+  *pp_buf = NULL;
+
+  mutex_global_lock();
+
+  BT_HDR* p_buf =
+      static_cast<BT_HDR*>(fixed_queue_try_dequeue(p_ccb->rx_queue));
+  if (p_buf != NULL) p_ccb->rx_queue_size -= p_buf->len;
+
+  mutex_global_unlock();
+
+  if (p_buf == NULL) return (GAP_NO_DATA_AVAIL);
+
+  *pp_buf = p_buf;
+  return (BT_PASS);
+}
+
 /*******************************************************************************
  *
  * Function         GAP_GetRxQueueCnt
@@ -724,6 +888,121 @@ static void gap_connect_cfm(uint16_t l2cap_cid, uint16_t result) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         gap_credit_based_connect_ind
+ *
+ * Description      This function handles an inbound Credit Based Connection
+ *                  Request from L2CAP. Each channel takes one of the CCBs
+ *                  listening on the PSM, the channels left over are refused.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void gap_credit_based_connect_ind(const RawAddress& bd_addr,
+                                         std::vector<uint16_t>& lcids,
+                                         uint16_t psm, uint16_t peer_mtu,
+                                         uint8_t identifier) {
+  std::vector<uint16_t> accepted_lcids;
+  std::vector<tGAP_CCB*> accepted_ccbs;
+  tGAP_CCB* p_ccb = conn.ccb_pool;
+
+  for (uint16_t xx = 0;
+       xx < GAP_MAX_CONNECTIONS && accepted_lcids.size() < lcids.size();
+       xx++, p_ccb++) {
+    if ((p_ccb->con_state == GAP_CCB_STATE_LISTENING) &&
+        (p_ccb->psm == psm) && (p_ccb->transport == BT_TRANSPORT_LE) &&
+        (!p_ccb->rem_addr_specified || (bd_addr == p_ccb->rem_dev_address))) {
+      accepted_lcids.push_back(lcids[accepted_lcids.size()]);
+      accepted_ccbs.push_back(p_ccb);
+    }
+  }
+
+  if (accepted_ccbs.empty()) {
+    LOG(WARNING) << StringPrintf(
+        "%s: No listening CCB for PSM 0x%04x, refusing %zu channels", __func__,
+        psm, lcids.size());
+    L2CA_ConnectCreditBasedRsp(bd_addr, identifier, accepted_lcids,
+                               L2CAP_LE_RESULT_NO_RESOURCES, NULL);
+    return;
+  }
+
+  tL2CAP_LE_CFG_INFO local_coc_cfg = accepted_ccbs[0]->local_coc_cfg;
+  if (!L2CA_ConnectCreditBasedRsp(bd_addr, identifier, accepted_lcids,
+                                  L2CAP_CONN_OK, &local_coc_cfg))
+    return;
+
+  for (size_t i = 0; i < accepted_ccbs.size(); i++) {
+    p_ccb = accepted_ccbs[i];
+    p_ccb->rem_dev_address = bd_addr;
+    p_ccb->connection_id = accepted_lcids[i];
+    L2CA_GetPeerLECocConfig(p_ccb->connection_id, &p_ccb->peer_coc_cfg);
+    p_ccb->rem_mtu_size = peer_mtu;
+
+    /* configuration is not required for LE COC */
+    p_ccb->con_flags |= GAP_CCB_FLAGS_HIS_CFG_DONE;
+    p_ccb->con_flags |= GAP_CCB_FLAGS_MY_CFG_DONE;
+    gap_checks_con_flags(p_ccb);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         gap_credit_based_connect_cfm
+ *
+ * Description      This function handles the result of one channel of a
+ *                  Credit Based Connection Request sent by
+ *                  GAP_ConnOpenCreditBased.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void gap_credit_based_connect_cfm(const RawAddress& bd_addr,
+                                         uint16_t l2cap_cid, uint16_t peer_mtu,
+                                         uint16_t result) {
+  tGAP_CCB* p_ccb = gap_find_ccb_by_cid(l2cap_cid);
+  if (p_ccb == NULL) return;
+
+  if (result != L2CAP_CONN_OK) {
+    tGAP_CB_DATA cb_data;
+    cb_data.l2cap_result = result;
+    if (p_ccb->p_callback)
+      (*p_ccb->p_callback)(p_ccb->gap_handle, GAP_EVT_CONN_CLOSED, &cb_data);
+    gap_release_ccb(p_ccb);
+    return;
+  }
+
+  if (p_ccb->con_state != GAP_CCB_STATE_CONN_SETUP) return;
+
+  L2CA_GetPeerLECocConfig(l2cap_cid, &p_ccb->peer_coc_cfg);
+  p_ccb->rem_mtu_size = peer_mtu;
+
+  /* configuration is not required for LE COC */
+  p_ccb->con_flags |= GAP_CCB_FLAGS_HIS_CFG_DONE;
+  p_ccb->con_flags |= GAP_CCB_FLAGS_MY_CFG_DONE;
+  p_ccb->con_flags |= GAP_CCB_FLAGS_SEC_DONE;
+  gap_checks_con_flags(p_ccb);
+}
+
+static void gap_credit_based_reconfig_completed(const RawAddress& bd_addr,
+                                                uint16_t l2cap_cid,
+                                                bool is_local_cfg,
+                                                tL2CAP_LE_CFG_INFO* p_cfg) {
+  tGAP_CCB* p_ccb = gap_find_ccb_by_cid(l2cap_cid);
+  if (p_ccb == NULL || p_cfg == NULL) return;
+
+  if (is_local_cfg) {
+    p_ccb->local_coc_cfg = *p_cfg;
+  } else {
+    p_ccb->peer_coc_cfg = *p_cfg;
+    p_ccb->rem_mtu_size = p_cfg->mtu;
+  }
+}
+
+static void gap_credit_based_collision_ind(const RawAddress& bd_addr) {
+  LOG(WARNING) << __func__ << ": Credit based connection request collision";
+}
+
 /*******************************************************************************
  *
  * Function         gap_config_ind
@@ -283,9 +283,9 @@ static BT_HDR* attp_build_opcode_cmd(uint8_t op_code) {
  * Returns          None.
  *
  ******************************************************************************/
-static BT_HDR* attp_build_value_cmd(uint16_t payload_size, uint8_t op_code,
-                                    uint16_t handle, uint16_t offset,
-                                    uint16_t len, uint8_t* p_data) {
+BT_HDR* attp_build_value_cmd(uint16_t payload_size, uint8_t op_code,
+                             uint16_t handle, uint16_t offset, uint16_t len,
+                             const uint8_t* p_data) {
   uint8_t *p, *pp, *p_pair_len;
   size_t pair_len;
   size_t size_now = 1;
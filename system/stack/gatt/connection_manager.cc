@@ -26,6 +26,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "internal_include/bt_trace.h"
 #include "main/shim/le_scanning_manager.h"
@@ -83,6 +84,61 @@ namespace {
 // Maps address to apps trying to connect to it
 std::map<RawAddress, tAPPS_CONNECTING> bgconn_dev;
 
+// Accept list change of a device held back until the end of a batch
+struct tACCEPT_LIST_CHANGE {
+  bool was_in_accept_list;
+  bool in_accept_list;
+};
+
+int batch_depth = 0;
+std::map<RawAddress, tACCEPT_LIST_CHANGE> pending_accept_list_changes;
+uint32_t batch_changes_requested = 0;
+tBATCH_STATS batch_stats;
+
+void defer_accept_list_change(const RawAddress& address, bool in_accept_list) {
+  batch_changes_requested++;
+  auto result = pending_accept_list_changes.try_emplace(
+      address, tACCEPT_LIST_CHANGE{.was_in_accept_list = !in_accept_list,
+                                   .in_accept_list = in_accept_list});
+  result.first->second.in_accept_list = in_accept_list;
+}
+
+/* Adds a device for background connection to the accept list, or at the end
+ * of the open batch */
+bool accept_list_add(const RawAddress& address) {
+  if (batch_depth == 0) return BTM_AcceptlistAdd(address);
+  defer_accept_list_change(address, true);
+  return true;
+}
+
+void accept_list_remove(const RawAddress& address) {
+  if (batch_depth == 0) {
+    BTM_AcceptlistRemove(address);
+    return;
+  }
+  defer_accept_list_change(address, false);
+}
+
+/* Applies the change held back for |address| before it is changed outside of
+ * the batch, as for direct connections */
+void apply_pending_accept_list_change(const RawAddress& address) {
+  auto it = pending_accept_list_changes.find(address);
+  if (it == pending_accept_list_changes.end()) return;
+
+  tACCEPT_LIST_CHANGE change = it->second;
+  pending_accept_list_changes.erase(it);
+  if (change.was_in_accept_list == change.in_accept_list) return;
+
+  if (!change.in_accept_list) {
+    BTM_AcceptlistRemove(address);
+  } else if (!BTM_AcceptlistAdd(address)) {
+    LOG_WARN("Failed to add device %s to accept list",
+             ADDRESS_TO_LOGGABLE_CSTR(address));
+    auto dev = bgconn_dev.find(address);
+    if (dev != bgconn_dev.end()) dev->second.is_in_accept_list = false;
+  }
+}
+
 int num_of_targeted_announcements_users(void) {
   return std::count_if(
       bgconn_dev.begin(), bgconn_dev.end(), [](const auto& pair) {
@@ -247,7 +303,7 @@ bool background_connect_targeted_announcement_add(tAPP_ID app_id,
   }
 
   if (disable_accept_list) {
-    BTM_AcceptlistRemove(address);
+    accept_list_remove(address);
     bgconn_dev[address].is_in_accept_list = false;
   }
 
@@ -295,7 +351,7 @@ bool background_connect_add(uint8_t app_id, const RawAddress& address) {
     if (is_targeted_announcement_enabled) {
       LOG_DEBUG("Targeted announcement enabled, do not add to AcceptList");
     } else {
-      if (!BTM_AcceptlistAdd(address)) {
+      if (!accept_list_add(address)) {
         LOG_WARN("Failed to add device %s to accept list for app %d",
                  ADDRESS_TO_LOGGABLE_CSTR(address), static_cast<int>(app_id));
         return false;
@@ -320,7 +376,7 @@ bool remove_unconditional(const RawAddress& address) {
     return false;
   }
 
-  BTM_AcceptlistRemove(address);
+  accept_list_remove(address);
   bgconn_dev.erase(it);
   return true;
 }
@@ -365,7 +421,7 @@ bool background_connect_remove(uint8_t app_id, const RawAddress& address) {
         /* Keep using filtering */
         LOG_DEBUG(" Keep using target announcement filtering");
       } else if (!it->second.doing_bg_conn.empty()) {
-        if (!BTM_AcceptlistAdd(address)) {
+        if (!accept_list_add(address)) {
           LOG_WARN("Could not re add device to accept list");
         } else {
           bgconn_dev[address].is_in_accept_list = true;
@@ -379,7 +435,7 @@ bool background_connect_remove(uint8_t app_id, const RawAddress& address) {
 
   // no more apps interested - remove from accept list and delete record
   if (accept_list_enabled) {
-    BTM_AcceptlistRemove(address);
+    accept_list_remove(address);
     return true;
   }
 
@@ -398,6 +454,7 @@ bool is_background_connection(const RawAddress& address) {
 /** deregister all related background connetion device. */
 void on_app_deregistered(uint8_t app_id) {
   LOG_DEBUG("app_id=%d", static_cast<int>(app_id));
+  batch_begin();
   auto it = bgconn_dev.begin();
   auto end = bgconn_dev.end();
   /* update the BG conn device list */
@@ -411,9 +468,10 @@ void on_app_deregistered(uint8_t app_id) {
       continue;
     }
 
-    BTM_AcceptlistRemove(it->first);
+    accept_list_remove(it->first);
     it = bgconn_dev.erase(it);
   }
+  batch_end();
 }
 
 static void remove_all_clients_with_pending_connections(
@@ -443,6 +501,7 @@ void on_connection_timed_out_from_shim(const RawAddress& address) {
  * to true, as there is no need to wipe controller acceptlist in this case. */
 void reset(bool after_reset) {
   bgconn_dev.clear();
+  pending_accept_list_changes.clear();
   if (!after_reset) {
     target_announcements_filtering_set(false);
     BTM_AcceptlistClear();
@@ -465,6 +524,7 @@ bool direct_connect_add(uint8_t app_id, const RawAddress& address) {
   LOG_DEBUG("app_id=%d, address=%s", static_cast<int>(app_id),
             ADDRESS_TO_LOGGABLE_CSTR(address));
   bool in_acceptlist = false;
+  apply_pending_accept_list_change(address);
   auto it = bgconn_dev.find(address);
   if (it != bgconn_dev.end()) {
     // app already trying to connect to this particular device
@@ -526,6 +586,8 @@ bool direct_connect_remove(uint8_t app_id, const RawAddress& address,
     return false;
   }
 
+  apply_pending_accept_list_change(address);
+
   /* Let see if the device was connected due to Target Announcements.*/
   bool is_targeted_announcement_enabled =
       !it->second.doing_targeted_announcements_conn.empty();
@@ -561,8 +623,67 @@ bool direct_connect_remove(uint8_t app_id, const RawAddress& address,
   return true;
 }
 
+/** Starts holding back the accept list changes of background connections */
+void batch_begin() { batch_depth++; }
+
+/** Ends the batch started by the matching batch_begin(), and applies the
+ * accept list changes that didn't cancel each other out in one update */
+void batch_end() {
+  if (batch_depth == 0) {
+    LOG_WARN("No batch of accept list changes to end");
+    return;
+  }
+  if (--batch_depth > 0) return;
+
+  std::vector<RawAddress> to_remove;
+  std::vector<RawAddress> to_add;
+  for (const auto& [address, change] : pending_accept_list_changes) {
+    if (change.was_in_accept_list == change.in_accept_list) continue;
+    (change.in_accept_list ? to_add : to_remove).push_back(address);
+  }
+  pending_accept_list_changes.clear();
+
+  uint32_t requested = batch_changes_requested;
+  batch_changes_requested = 0;
+  size_t changes = to_remove.size() + to_add.size();
+  batch_stats.changes_requested += requested;
+  batch_stats.changes_applied += changes;
+  if (changes == 0) {
+    batch_stats.pauses_avoided += requested;
+    return;
+  }
+
+  /* A single change costs one pause either way */
+  size_t added = to_add.size();
+  if (changes > 1) {
+    added = BTM_AcceptlistUpdate(to_remove, to_add);
+  } else if (!to_remove.empty()) {
+    BTM_AcceptlistRemove(to_remove.front());
+  } else if (!BTM_AcceptlistAdd(to_add.front())) {
+    added = 0;
+  }
+  for (size_t i = added; i < to_add.size(); i++) {
+    LOG_WARN("Failed to add device %s to accept list",
+             ADDRESS_TO_LOGGABLE_CSTR(to_add[i]));
+    auto it = bgconn_dev.find(to_add[i]);
+    if (it != bgconn_dev.end()) it->second.is_in_accept_list = false;
+  }
+
+  batch_stats.batches++;
+  batch_stats.pauses_avoided += requested - 1;
+  LOG_DEBUG("Applied %zu of %u accept list changes at once", changes,
+            requested);
+}
+
+tBATCH_STATS get_batch_stats() { return batch_stats; }
+
 void dump(int fd) {
   dprintf(fd, "\nconnection_manager state:\n");
+  dprintf(fd,
+          "\taccept list batches: %u, changes requested: %u, applied: %u, "
+          "initiator pauses avoided: %u\n",
+          batch_stats.batches, batch_stats.changes_requested,
+          batch_stats.changes_applied, batch_stats.pauses_avoided);
   if (bgconn_dev.empty()) {
     dprintf(fd, "\tno Low Energy connection attempts\n");
     return;
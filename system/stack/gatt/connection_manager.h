@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <set>
 
 #include "types/raw_address.h"
@@ -54,6 +55,20 @@ bool direct_connect_add(tAPP_ID app_id, const RawAddress& address);
 bool direct_connect_remove(tAPP_ID app_id, const RawAddress& address,
                            bool connection_timeout = false);
 
+/* Accept list changes of background connections made between batch_begin()
+ * and the matching batch_end() are applied together in batch_end(), so that
+ * the initiator is paused once for all of them. Batches can be nested. */
+void batch_begin();
+void batch_end();
+
+struct tBATCH_STATS {
+  uint32_t batches;           /* batches that updated the accept list */
+  uint32_t changes_requested; /* accept list changes made in batches */
+  uint32_t changes_applied;   /* changes left once opposite ones cancelled */
+  uint32_t pauses_avoided;    /* initiator pauses saved by batching */
+};
+tBATCH_STATS get_batch_stats();
+
 void dump(int fd);
 
 /* This callback will be executed when direct connect attempt fails due to
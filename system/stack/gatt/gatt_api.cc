@@ -27,6 +27,7 @@
 
 #include <base/strings/string_number_conversions.h>
 
+#include <algorithm>
 #include <string>
 
 #include "device/include/controller.h"
@@ -40,6 +41,7 @@
 #include "rust/src/connection/ffi/connection_shim.h"
 #include "stack/arbiter/acl_arbiter.h"
 #include "stack/btm/btm_dev.h"
+#include "stack/eatt/eatt.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/gatt/gatt_int.h"
 #include "stack/include/bt_hdr.h"
@@ -130,18 +132,23 @@ static bool is_gatt_attr_type(const Uuid& uuid) {
   return false;
 }
 
-/** Update the the last service info for the service list info */
+/** Update the the last service info and the handle index for the service list
+ * info */
 static void gatt_update_last_srv_info() {
   gatt_cb.last_service_handle = 0;
 
   for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
     gatt_cb.last_service_handle = el.s_hdl;
   }
+
+  gatt_sr_update_srv_index();
 }
 
 /** Update database hash and client status */
 static void gatt_update_for_database_change() {
-  gatt_cb.database_hash = gatts_calculate_database_hash(gatt_cb.srv_list_info);
+  /* Recalculated by gatts_get_database_hash() once it is needed, as services
+   * are often added one after the other */
+  gatt_cb.database_hash_dirty = true;
 
   uint8_t i = 0;
   for (i = 0; i < GATT_MAX_PHY_CHANNEL; i++) {
@@ -458,6 +465,9 @@ tGATT_STATUS GATTS_HandleValueIndication(uint16_t conn_id, uint16_t attr_handle,
 
   if (!GATT_HANDLE_IS_VALID(attr_handle)) return GATT_ILLEGAL_PARAMETER;
 
+  /* The app indicates a new value */
+  gatt_sr_drop_long_read(*p_tcb, attr_handle);
+
   tGATT_VALUE indication;
   indication.conn_id = conn_id;
   indication.handle = attr_handle;
@@ -563,6 +573,9 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
     return GATT_ILLEGAL_PARAMETER;
   }
 
+  /* The app notifies a new value */
+  gatt_sr_drop_long_read(*p_tcb, attr_handle);
+
 #if (GATT_UPPER_TESTER_MULT_VARIABLE_LENGTH_NOTIF == TRUE)
   /* Upper tester for Multiple Value length notifications */
   if (stack_config_get_interface()->get_pts_force_eatt_for_notifications() &&
@@ -623,6 +636,75 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
   return cmd_sent;
 }
 
+/* Sends one |op_code| PDU per value on the ATT bearer, so that values reach
+ * the peer in order across batches, until L2CAP has no room left */
+static uint16_t gatt_send_value_batch(tGATT_TCB& tcb, uint8_t op_code,
+                                      const tGATT_VALUE_REF* p_values,
+                                      uint16_t num_values) {
+  uint16_t cid = tcb.att_lcid;
+  uint16_t payload_size = gatt_tcb_get_payload_size(tcb, cid);
+  uint16_t sent = 0;
+
+  while (sent < num_values) {
+    /* L2CAP drains its queue to the controller while PDUs are added, so look
+     * again once the room seen before is used up */
+    uint16_t room = (cid == L2CAP_ATT_CID)
+                        ? L2CA_GetFixedChnlTxRoom(cid, tcb.peer_bda)
+                        : L2CA_GetTxRoom(cid);
+    if (room == 0) break;
+
+    for (; room > 0 && sent < num_values; room--) {
+      const tGATT_VALUE_REF& value = p_values[sent];
+      if (!GATT_HANDLE_IS_VALID(value.handle)) {
+        LOG_WARN("Invalid handle 0x%04x", value.handle);
+        return sent;
+      }
+
+      BT_HDR* p_buf = attp_build_value_cmd(payload_size, op_code, value.handle,
+                                           0, value.len, value.p_value);
+      if (p_buf == NULL) return sent;
+
+      tGATT_STATUS status = attp_send_msg_to_l2cap(tcb, cid, p_buf);
+      if (status != GATT_SUCCESS && status != GATT_CONGESTED) return sent;
+      sent++;
+    }
+  }
+  return sent;
+}
+
+/*******************************************************************************
+ *
+ * Function         GATTS_HandleValueNotificationBatch
+ *
+ * Description      This function sends handle value notifications to a client
+ *                  for as long as L2CAP has room for them.
+ *
+ * Parameter        conn_id: connection identifier.
+ *                  p_values: values to notify.
+ *                  num_values: number of values.
+ *
+ * Returns          Number of notifications sent, from the first value.
+ *
+ ******************************************************************************/
+uint16_t GATTS_HandleValueNotificationBatch(uint16_t conn_id,
+                                            const tGATT_VALUE_REF* p_values,
+                                            uint16_t num_values) {
+  tGATT_REG* p_reg = gatt_get_regcb(GATT_GET_GATT_IF(conn_id));
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(GATT_GET_TCB_IDX(conn_id));
+
+  if ((p_reg == NULL) || (p_tcb == NULL)) {
+    LOG(ERROR) << __func__ << ": Unknown conn_id=" << loghex(conn_id);
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < num_values; i++) {
+    gatt_sr_drop_long_read(*p_tcb, p_values[i].handle);
+  }
+
+  return gatt_send_value_batch(*p_tcb, GATT_HANDLE_VALUE_NOTIF, p_values,
+                               num_values);
+}
+
 /*******************************************************************************
  *
  * Function         GATTS_SendRsp
@@ -1037,6 +1119,35 @@ tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
   return GATT_SUCCESS;
 }
 
+/*******************************************************************************
+ *
+ * Function         GATTC_GetMaxReadMultiVarHandles
+ *
+ * Description      This function returns how many handles fit in one Read
+ *                  Multiple Variable Length request to the server.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          0 if the server is not known to support the request.
+ *
+ ******************************************************************************/
+uint8_t GATTC_GetMaxReadMultiVarHandles(uint16_t conn_id) {
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(GATT_GET_TCB_IDX(conn_id));
+  if (p_tcb == NULL || gatt_get_regcb(GATT_GET_GATT_IF(conn_id)) == NULL) {
+    return 0;
+  }
+
+  /* Servers supporting EATT shall support Read Multiple Variable Length, and
+   * the supported features are only known after they were read */
+  if (!gatt_profile_get_eatt_support(p_tcb->peer_bda)) return 0;
+
+  /* EATT bearers have an MTU of at least 64, so the ATT bearer is the one
+   * that limits the request */
+  uint16_t payload_size = gatt_tcb_get_payload_size(*p_tcb, L2CAP_ATT_CID);
+  return std::min<uint16_t>((payload_size - 1) / 2,
+                            GATT_MAX_READ_MULTI_HANDLES);
+}
+
 /*******************************************************************************
  *
  * Function         GATTC_Write
@@ -1080,6 +1191,16 @@ tGATT_STATUS GATTC_Write(uint16_t conn_id, tGATT_WRITE_TYPE type,
   if (type == GATT_WRITE_PREPARE) {
     p_clcb->start_offset = p_write->offset;
     p->offset = 0;
+
+    /* The server keeps a prepare queue per bearer, so all the prepared writes
+     * of the app, and their execution, go on the bearer of the first one */
+    uint16_t& prep_write_cid = p_tcb->prep_write_cid[gatt_if - 1];
+    if (prep_write_cid != 0 &&
+        gatt_tcb_is_cid_connected(*p_tcb, prep_write_cid)) {
+      p_clcb->cid = prep_write_cid;
+    } else {
+      prep_write_cid = p_clcb->cid;
+    }
   }
 
   if (gatt_security_check_start(p_clcb))
@@ -1087,6 +1208,34 @@ tGATT_STATUS GATTC_Write(uint16_t conn_id, tGATT_WRITE_TYPE type,
   return GATT_SUCCESS;
 }
 
+/*******************************************************************************
+ *
+ * Function         GATTC_WriteNoRspBatch
+ *
+ * Description      This function sends Write Commands to the server for as
+ *                  long as L2CAP has room for them.
+ *
+ * Parameters       conn_id: connection identifier.
+ *                  p_values: values to write.
+ *                  num_values: number of values.
+ *
+ * Returns          Number of commands sent, from the first value.
+ *
+ ******************************************************************************/
+uint16_t GATTC_WriteNoRspBatch(uint16_t conn_id,
+                               const tGATT_VALUE_REF* p_values,
+                               uint16_t num_values) {
+  tGATT_REG* p_reg = gatt_get_regcb(GATT_GET_GATT_IF(conn_id));
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(GATT_GET_TCB_IDX(conn_id));
+
+  if ((p_reg == NULL) || (p_tcb == NULL)) {
+    LOG(ERROR) << __func__ << ": Unknown conn_id=" << loghex(conn_id);
+    return 0;
+  }
+
+  return gatt_send_value_batch(*p_tcb, GATT_CMD_WRITE, p_values, num_values);
+}
+
 /*******************************************************************************
  *
  * Function         GATTC_ExecuteWrite
@@ -1118,6 +1267,13 @@ tGATT_STATUS GATTC_ExecuteWrite(uint16_t conn_id, bool is_execute) {
   tGATT_CLCB* p_clcb = gatt_clcb_alloc(conn_id);
   if (!p_clcb) return GATT_NO_RESOURCES;
 
+  uint16_t& prep_write_cid = p_tcb->prep_write_cid[gatt_if - 1];
+  if (prep_write_cid != 0 &&
+      gatt_tcb_is_cid_connected(*p_tcb, prep_write_cid)) {
+    p_clcb->cid = prep_write_cid;
+  }
+  prep_write_cid = 0;
+
   p_clcb->operation = GATTC_OPTYPE_EXE_WRITE;
   tGATT_EXEC_FLAG flag =
       is_execute ? GATT_PREP_WRITE_EXEC : GATT_PREP_WRITE_CANCEL;
@@ -1696,3 +1852,7 @@ void gatt_load_bonded(void) {
     }
   }
 }
+
+void GATT_Dumpsys(int fd) {
+  bluetooth::eatt::EattExtension::GetInstance()->Dump(fd);
+}
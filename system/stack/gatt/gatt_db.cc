@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "gatt_int.h"
 #include "l2c_api.h"
 #include "osi/include/osi.h"
@@ -286,41 +288,52 @@ tGATT_STATUS gatts_db_read_attr_value_by_type(
   uint16_t len = 0;
   uint8_t* p = (uint8_t*)(p_rsp + 1) + p_rsp->len + L2CAP_MIN_OFFSET;
 
-  if (p_db) {
-    for (tGATT_ATTR& attr : p_db->attr_list) {
-      if (attr.handle >= s_handle && type == attr.uuid) {
-        if (*p_len <= 2) {
-          status = GATT_NO_RESOURCES;
-          break;
-        }
+  if (!p_db) return status;
+
+  auto indexed = p_db->uuid_index.find(type);
+  if (indexed == p_db->uuid_index.end()) return status;
+
+  /* Only visit the attributes of the requested type within the range */
+  const std::vector<uint16_t>& positions = indexed->second;
+  auto pos = std::lower_bound(
+      positions.begin(), positions.end(), s_handle,
+      [p_db](uint16_t position, uint16_t handle) {
+        return p_db->attr_list[position].handle < handle;
+      });
+  for (; pos != positions.end(); pos++) {
+    tGATT_ATTR& attr = p_db->attr_list[*pos];
+    if (attr.handle > e_handle) break;
+
+    if (*p_len <= 2) {
+      status = GATT_NO_RESOURCES;
+      break;
+    }
 
-        UINT16_TO_STREAM(p, attr.handle);
+    UINT16_TO_STREAM(p, attr.handle);
 
-        status = read_attr_value(attr, 0, &p, false, (uint16_t)(*p_len - 2),
-                                 &len, sec_flag, key_size);
+    status = read_attr_value(attr, 0, &p, false, (uint16_t)(*p_len - 2), &len,
+                             sec_flag, key_size);
 
-        if (status == GATT_PENDING) {
-          status = gatts_send_app_read_request(tcb, cid, op_code, attr.handle,
-                                               0, trans_id, attr.gatt_type);
+    if (status == GATT_PENDING) {
+      status = gatts_send_app_read_request(tcb, cid, op_code, attr.handle, 0,
+                                           trans_id, attr.gatt_type);
 
-          /* one callback at a time */
-          break;
-        } else if (status == GATT_SUCCESS) {
-          if (p_rsp->offset == 0) p_rsp->offset = len + 2;
-
-          if (p_rsp->offset == len + 2) {
-            p_rsp->len += (len + 2);
-            *p_len -= (len + 2);
-          } else {
-            LOG(ERROR) << "format mismatch";
-            status = GATT_NO_RESOURCES;
-            break;
-          }
-        } else {
-          *p_cur_handle = attr.handle;
-          break;
-        }
+      /* one callback at a time */
+      break;
+    } else if (status == GATT_SUCCESS) {
+      if (p_rsp->offset == 0) p_rsp->offset = len + 2;
+
+      if (p_rsp->offset == len + 2) {
+        p_rsp->len += (len + 2);
+        *p_len -= (len + 2);
+      } else {
+        LOG(ERROR) << "format mismatch";
+        status = GATT_NO_RESOURCES;
+        break;
       }
+    } else {
+      *p_cur_handle = attr.handle;
+      break;
     }
   }
 
@@ -450,14 +463,24 @@ uint16_t gatts_add_char_descr(tGATT_SVC_DB& db, tGATT_PERM perm,
 /* Service Attribute Database Query Utility Functions */
 /******************************************************************************/
 tGATT_ATTR* find_attr_by_handle(tGATT_SVC_DB* p_db, uint16_t handle) {
-  if (!p_db) return nullptr;
+  if (!p_db || p_db->attr_list.empty()) return nullptr;
+
+  std::vector<tGATT_ATTR>& attr_list = p_db->attr_list;
+  uint16_t first_handle = attr_list.front().handle;
+  if (handle < first_handle) return nullptr;
 
-  for (auto& attr : p_db->attr_list) {
-    if (attr.handle == handle) return &attr;
-    if (attr.handle > handle) return nullptr;
+  /* Handles are allocated in sequence from the service declaration, so the
+   * attribute is normally found right at its offset */
+  size_t index = handle - first_handle;
+  if (index < attr_list.size() && attr_list[index].handle == handle) {
+    return &attr_list[index];
   }
 
-  return nullptr;
+  auto it = std::lower_bound(attr_list.begin(), attr_list.end(), handle,
+                             [](const tGATT_ATTR& attr, uint16_t handle) {
+                               return attr.handle < handle;
+                             });
+  return (it != attr_list.end() && it->handle == handle) ? &(*it) : nullptr;
 }
 
 /*******************************************************************************
@@ -699,6 +722,7 @@ static tGATT_ATTR& allocate_attr_in_db(tGATT_SVC_DB& db, const Uuid& uuid,
   attr.handle = db.next_handle++;
   attr.uuid = uuid;
   attr.permission = perm;
+  db.uuid_index[uuid].push_back(db.attr_list.size() - 1);
   return attr;
 }
 
@@ -24,6 +24,7 @@
 
 #include <deque>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -81,6 +82,11 @@ inline std::string gatt_security_action_text(const tGATT_SEC_ACTION& action) {
 #define GATT_WAIT_FOR_DISC_RSP_TIMEOUT_MS (5 * 1000)
 #define GATT_REQ_RETRY_LIMIT 2
 
+/* value bytes of prepared writes a peer may have pending on a connection */
+#define GATT_MAX_PREP_WRITE_BYTES (8 * GATT_MAX_ATTR_LEN)
+/* how long a long attribute value read from an app answers Read Blob */
+#define GATT_LONG_READ_CACHE_TIMEOUT_MS 1000
+
 typedef struct {
   bool is_link_key_known;
   bool is_link_key_authed;
@@ -181,6 +187,8 @@ typedef struct {
   std::vector<tGATT_ATTR> attr_list; /* pointer to the attributes */
   uint16_t end_handle;       /* Last handle number           */
   uint16_t next_handle;      /* Next usable handle value     */
+  /* positions in attr_list of the attributes of each type, in handle order */
+  std::unordered_map<bluetooth::Uuid, std::vector<uint16_t>> uuid_index;
 } tGATT_SVC_DB;
 
 /* Data Structure used for GATT server */
@@ -286,6 +294,9 @@ typedef struct {
   uint16_t e_hdl;      /* service ending handle */
   tGATT_IF gatt_if;    /* this service is belong to which application */
   bool is_primary;
+  /* serialized part of the database hash input for this service, filled the
+   * first time the hash is calculated after the service is added */
+  std::vector<uint8_t> hash_info;
 } tGATT_SRV_LIST_ELEM;
 
 typedef struct {
@@ -306,6 +317,15 @@ typedef struct {
   std::unordered_set<tGATT_IF> app_hold_link;
 
   /* server needs */
+  /* last long value an app answered a read with, see
+   * gatt_sr_store_long_read() */
+  struct {
+    uint16_t cid;
+    uint16_t handle;
+    uint16_t offset; /* offset of value[0] in the attribute value */
+    uint64_t expiry_ms;
+    std::vector<uint8_t> value;
+  } sr_long_read;
   /* server response data */
   tGATT_SR_CMD sr_cmd;
   uint16_t indicate_handle;
@@ -314,9 +334,17 @@ typedef struct {
   alarm_t* conf_timer; /* peer confirm to indication timer */
 
   uint8_t prep_cnt[GATT_MAX_APPS];
+  /* value bytes of the prepared writes accepted by the apps */
+  uint32_t prep_write_bytes;
   uint8_t ind_count;
 
   std::deque<tGATT_CMD_Q> cl_cmd_q;
+  /* client requests sent on the ATT bearer, and largest queue seen */
+  uint32_t cl_requests;
+  uint16_t cl_max_queued;
+  /* bearer of the prepared writes of each app, until they are executed or
+   * cancelled, 0 when there is none */
+  uint16_t prep_write_cid[GATT_MAX_APPS];
   alarm_t* ind_ack_timer; /* local app confirm to indication timer */
 
   // TODO(hylo): support byte array data
@@ -410,6 +438,9 @@ typedef struct {
   tGATT_IF gatt_if;
   std::list<tGATT_HDL_LIST_ELEM>* hdl_list_info;
   std::list<tGATT_SRV_LIST_ELEM>* srv_list_info;
+  /* services of srv_list_info by start handle, kept by
+   * gatt_sr_update_srv_index() to find the service of a handle */
+  std::vector<std::list<tGATT_SRV_LIST_ELEM>::iterator> srv_index;
 
   fixed_queue_t* srv_chg_clt_q; /* service change clients queue */
   tGATT_REG cl_rcb[GATT_MAX_APPS];
@@ -444,7 +475,9 @@ typedef struct {
   uint8_t gatt_cl_supported_feat_mask;
 
   uint16_t handle_of_database_hash;
+  /* only valid when database_hash_dirty is false, see gatts_get_database_hash */
   Octet16 database_hash;
+  bool database_hash_dirty;
 
   tGATT_APPL_INFO cb_info;
 
@@ -510,6 +543,9 @@ void gatt_sr_update_cl_status(tGATT_TCB& tcb, bool chg_aware);
 tGATT_STATUS attp_send_cl_confirmation_msg(tGATT_TCB& tcb, uint16_t cid);
 tGATT_STATUS attp_send_cl_msg(tGATT_TCB& tcb, tGATT_CLCB* p_clcb,
                               uint8_t op_code, tGATT_CL_MSG* p_msg);
+BT_HDR* attp_build_value_cmd(uint16_t payload_size, uint8_t op_code,
+                             uint16_t handle, uint16_t offset, uint16_t len,
+                             const uint8_t* p_data);
 BT_HDR* attp_build_sr_msg(tGATT_TCB& tcb, uint8_t op_code, tGATT_SR_MSG* p_msg,
                           uint16_t payload_size);
 tGATT_STATUS attp_send_sr_msg(tGATT_TCB& tcb, uint16_t cid, BT_HDR* p_msg);
@@ -564,6 +600,7 @@ bool gatt_auto_connect_dev_remove(tGATT_IF gatt_if, const RawAddress& bd_addr);
 /* server function */
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle);
+void gatt_sr_update_srv_index();
 tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB& tcb, tGATT_IF gatt_if,
                                      uint32_t trans_id, uint8_t op_code,
                                      tGATT_STATUS status, tGATTS_RSP* p_msg,
@@ -584,6 +621,7 @@ void gatt_notify_subrate_change(uint16_t handle, uint16_t subrate_factor,
 /*   */
 
 bool gatt_tcb_is_cid_busy(tGATT_TCB& tcb, uint16_t cid);
+bool gatt_tcb_is_cid_connected(tGATT_TCB& tcb, uint16_t cid);
 
 tGATT_REG* gatt_get_regcb(tGATT_IF gatt_if);
 bool gatt_is_clcb_allocated(uint16_t conn_id);
@@ -596,6 +634,7 @@ bool gatt_tcb_get_cid_available_for_indication(tGATT_TCB* p_tcb,
 bool gatt_tcb_find_indicate_handle(tGATT_TCB& tcb, uint16_t cid,
                                    uint16_t* indicated_handle_p);
 uint16_t gatt_tcb_get_att_cid(tGATT_TCB& tcb, bool eatt_support);
+uint16_t gatt_tcb_get_cl_request_cid(tGATT_TCB& tcb, bool eatt_support);
 uint16_t gatt_tcb_get_payload_size(tGATT_TCB& tcb, uint16_t cid);
 void gatt_clcb_invalidate(tGATT_TCB* p_tcb, const tGATT_CLCB* p_clcb);
 uint16_t gatt_get_mtu(const RawAddress& bda, tBT_TRANSPORT transport);
@@ -615,6 +654,13 @@ void gatt_sr_update_cback_cnt(tGATT_TCB& p_tcb, uint16_t cid, tGATT_IF gatt_if,
                               bool is_inc, bool is_reset_first);
 void gatt_sr_update_prep_cnt(tGATT_TCB& tcb, tGATT_IF gatt_if, bool is_inc,
                              bool is_reset_first);
+void gatt_sr_store_long_read(tGATT_TCB& tcb, uint16_t cid, uint16_t handle,
+                             uint16_t offset, const uint8_t* p_value,
+                             uint16_t len);
+bool gatt_sr_read_long_cached(tGATT_TCB& tcb, uint16_t cid, uint16_t handle,
+                              uint16_t offset, uint8_t* p_value,
+                              uint16_t* p_len, uint16_t max_len);
+void gatt_sr_drop_long_read(tGATT_TCB& tcb, uint16_t handle);
 
 uint8_t gatt_num_clcb_by_bd_addr(const RawAddress& bda);
 tGATT_TCB* gatt_find_tcb_by_cid(uint16_t lcid);
@@ -685,9 +731,11 @@ tGATT_STATUS gatts_read_attr_perm_check(tGATT_SVC_DB* p_db, bool is_long,
                                         uint16_t handle,
                                         tGATT_SEC_FLAG sec_flag,
                                         uint8_t key_size);
+tGATT_ATTR* find_attr_by_handle(tGATT_SVC_DB* p_db, uint16_t handle);
 bluetooth::Uuid* gatts_get_service_uuid(tGATT_SVC_DB* p_db);
 
 /* gatt_sr_hash.cc */
 Octet16 gatts_calculate_database_hash(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr);
+const Octet16& gatts_get_database_hash();
 
 #endif
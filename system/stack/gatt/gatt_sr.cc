@@ -326,8 +326,20 @@ tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB& tcb, tGATT_IF gatt_if,
     if (!process_read_multi_rsp(sr_res_p, status, p_msg, payload_size))
       return (GATT_SUCCESS);
   } else {
-    if (op_code == GATT_REQ_PREPARE_WRITE && status == GATT_SUCCESS)
+    if (op_code == GATT_REQ_PREPARE_WRITE && status == GATT_SUCCESS) {
       gatt_sr_update_prep_cnt(tcb, gatt_if, true, false);
+      tcb.prep_write_bytes += p_msg->attr_value.len;
+    }
+
+    /* The client reads the rest of a value that does not fit with Read Blob */
+    if ((op_code == GATT_REQ_READ || op_code == GATT_REQ_READ_BLOB) &&
+        status == GATT_SUCCESS && p_msg->attr_value.len >= payload_size - 1 &&
+        p_msg->attr_value.len <= GATT_MAX_ATTR_LEN) {
+      gatt_sr_store_long_read(
+          tcb, sr_res_p->cid, sr_res_p->handle,
+          op_code == GATT_REQ_READ_BLOB ? p_msg->attr_value.offset : 0,
+          p_msg->attr_value.value, p_msg->attr_value.len);
+    }
 
     if (op_code == GATT_REQ_EXEC_WRITE && status != GATT_SUCCESS)
       gatt_sr_reset_cback_cnt(tcb, sr_res_p->cid);
@@ -402,6 +414,9 @@ void gatt_process_exec_write_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
   /* mask the flag */
   flag &= GATT_PREP_WRITE_EXEC;
 
+  tcb.prep_write_bytes = 0;
+  gatt_sr_drop_long_read(tcb, 0);
+
   /* no prep write is queued */
   if (!gatt_sr_is_prep_cnt_zero(tcb)) {
     trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, 0);
@@ -560,11 +575,15 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
   uint16_t payload_size = gatt_tcb_get_payload_size(tcb, cid);
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl < s_hdl || el.s_hdl > e_hdl ||
-        el.type != GATT_UUID_PRI_SERVICE) {
-      continue;
-    }
+  /* Services starting within the range, in handle order */
+  auto it = std::lower_bound(
+      gatt_cb.srv_index.begin(), gatt_cb.srv_index.end(), s_hdl,
+      [](const std::list<tGATT_SRV_LIST_ELEM>::iterator& srv, uint16_t handle) {
+        return srv->s_hdl < handle;
+      });
+  for (; it != gatt_cb.srv_index.end() && (*it)->s_hdl <= e_hdl; it++) {
+    tGATT_SRV_LIST_ELEM& el = **it;
+    if (el.type != GATT_UUID_PRI_SERVICE) continue;
 
     Uuid* p_uuid = gatts_get_service_uuid(el.p_db);
     if (!p_uuid) continue;
@@ -1026,6 +1045,16 @@ static void gatts_process_write_req(tGATT_TCB& tcb, uint16_t cid,
       break;
   }
 
+  if (op_code == GATT_REQ_PREPARE_WRITE &&
+      tcb.prep_write_bytes + len > GATT_MAX_PREP_WRITE_BYTES) {
+    LOG_WARN("%u prepared bytes pending, rejecting prepare write of %u",
+             tcb.prep_write_bytes, len);
+    gatt_send_error_rsp(tcb, cid, GATT_PREPARE_Q_FULL, op_code, handle, false);
+    return;
+  }
+
+  gatt_sr_drop_long_read(tcb, handle);
+
   gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
 
   status = gatts_write_attr_perm_check(el.p_db, op_code, handle,
@@ -1102,9 +1131,19 @@ static void gatts_process_read_req(tGATT_TCB& tcb, uint16_t cid,
   gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
 
   uint16_t value_len = 0;
-  tGATT_STATUS reason = gatts_read_attr_value_by_handle(
-      tcb, cid, el.p_db, op_code, handle, offset, p, &value_len,
-      (uint16_t)buf_len, sec_flag, key_size, 0);
+  tGATT_STATUS reason;
+  if (op_code == GATT_REQ_READ_BLOB &&
+      gatts_read_attr_perm_check(el.p_db, true, handle, sec_flag, key_size) ==
+          GATT_SUCCESS &&
+      gatt_sr_read_long_cached(tcb, cid, handle, offset, p, &value_len,
+                               (uint16_t)buf_len)) {
+    reason = GATT_SUCCESS;
+  } else {
+    if (op_code == GATT_REQ_READ) gatt_sr_drop_long_read(tcb, handle);
+    reason = gatts_read_attr_value_by_handle(
+        tcb, cid, el.p_db, op_code, handle, offset, p, &value_len,
+        (uint16_t)buf_len, sec_flag, key_size, 0);
+  }
   p_msg->len += value_len;
 
   if (reason != GATT_SUCCESS) {
@@ -1159,31 +1198,28 @@ void gatts_process_attribute_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
 #endif
 
   if (GATT_HANDLE_IS_VALID(handle)) {
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        for (const auto& attr : el.p_db->attr_list) {
-          if (attr.handle == handle) {
-            switch (op_code) {
-              case GATT_REQ_READ: /* read char/char descriptor value */
-              case GATT_REQ_READ_BLOB:
-                gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
-                break;
-
-              case GATT_REQ_WRITE: /* write char/char descriptor value */
-              case GATT_CMD_WRITE:
-              case GATT_SIGN_CMD_WRITE:
-              case GATT_REQ_PREPARE_WRITE:
-                gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
-                                        attr.gatt_type);
-                break;
-              default:
-                break;
-            }
-            status = GATT_SUCCESS;
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    if (it != gatt_cb.srv_list_info->end()) {
+      tGATT_SRV_LIST_ELEM& el = *it;
+      const tGATT_ATTR* p_attr = find_attr_by_handle(el.p_db, handle);
+      if (p_attr) {
+        switch (op_code) {
+          case GATT_REQ_READ: /* read char/char descriptor value */
+          case GATT_REQ_READ_BLOB:
+            gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
+            break;
+
+          case GATT_REQ_WRITE: /* write char/char descriptor value */
+          case GATT_CMD_WRITE:
+          case GATT_SIGN_CMD_WRITE:
+          case GATT_REQ_PREPARE_WRITE:
+            gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
+                                    p_attr->gatt_type);
+            break;
+          default:
             break;
-          }
         }
-        break;
+        status = GATT_SUCCESS;
       }
     }
   }
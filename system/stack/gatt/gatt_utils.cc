@@ -26,9 +26,11 @@
 #include <base/logging.h>
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 
+#include "common/time_util.h"
 #include "hardware/bt_gatt_types.h"
 #include "internal_include/bt_target.h"
 #include "os/log.h"
@@ -781,21 +783,48 @@ void  gatt_ind_ack_timeout(void* data) {
  *
  * Description      Search for a service that owns a specific handle.
  *
- * Returns          GATT_MAX_SR_PROFILES if not found. Otherwise the index of
- *                  the service.
+ * Returns          gatt_cb.srv_list_info->end() if not found. Otherwise the
+ *                  iterator of the service.
  *
  ******************************************************************************/
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle) {
-  auto it = gatt_cb.srv_list_info->begin();
+  const auto& index = gatt_cb.srv_index;
 
-  for (; it != gatt_cb.srv_list_info->end(); it++) {
-    if (it->s_hdl <= handle && it->e_hdl >= handle) {
-      return it;
-    }
+  /* Last service starting at or before the handle */
+  auto it = std::upper_bound(
+      index.begin(), index.end(), handle,
+      [](uint16_t handle,
+         const std::list<tGATT_SRV_LIST_ELEM>::iterator& srv) {
+        return handle < srv->s_hdl;
+      });
+  if (it != index.begin() && (*std::prev(it))->e_hdl >= handle) {
+    return *std::prev(it);
   }
 
-  return it;
+  return gatt_cb.srv_list_info->end();
+}
+
+/*******************************************************************************
+ *
+ * Description      Rebuild the index of the services by start handle. Must be
+ *                  called whenever services are added to or removed from
+ *                  gatt_cb.srv_list_info.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_sr_update_srv_index() {
+  gatt_cb.srv_index.clear();
+  for (auto it = gatt_cb.srv_list_info->begin();
+       it != gatt_cb.srv_list_info->end(); it++) {
+    gatt_cb.srv_index.push_back(it);
+  }
+  std::sort(gatt_cb.srv_index.begin(), gatt_cb.srv_index.end(),
+            [](const std::list<tGATT_SRV_LIST_ELEM>::iterator& a,
+               const std::list<tGATT_SRV_LIST_ELEM>::iterator& b) {
+              return a->s_hdl < b->s_hdl;
+            });
 }
 
 /*******************************************************************************
@@ -1019,6 +1048,24 @@ bool gatt_tcb_is_cid_busy(tGATT_TCB& tcb, uint16_t cid) {
 
   return !channel->cl_cmd_q_.empty();
 }
+
+/*******************************************************************************
+ *
+ * Function         gatt_tcb_is_cid_connected
+ *
+ * Description      The function check if the bearer with given cid is still
+ *                  connected
+ *
+ * Returns          True when connected
+ *
+ ******************************************************************************/
+bool gatt_tcb_is_cid_connected(tGATT_TCB& tcb, uint16_t cid) {
+  if (cid == tcb.att_lcid) return true;
+
+  return EattExtension::GetInstance()->FindEattChannelByCid(tcb.peer_bda,
+                                                            cid) != nullptr;
+}
+
 /*******************************************************************************
  *
  * Function         gatt_clcb_alloc
@@ -1040,7 +1087,7 @@ tGATT_CLCB* gatt_clcb_alloc(uint16_t conn_id) {
   clcb.p_reg = p_reg;
   clcb.p_tcb = p_tcb;
   /* Use eatt only when clients wants that */
-  clcb.cid = gatt_tcb_get_att_cid(*p_tcb, p_reg->eatt_support);
+  clcb.cid = gatt_tcb_get_cl_request_cid(*p_tcb, p_reg->eatt_support);
 
   gatt_cb.clcb_queue.emplace_back(clcb);
   auto p_clcb = &(gatt_cb.clcb_queue.back());
@@ -1141,6 +1188,36 @@ uint16_t gatt_tcb_get_att_cid(tGATT_TCB& tcb, bool eatt_support) {
   return tcb.att_lcid;
 }
 
+/*******************************************************************************
+ *
+ * Function         gatt_tcb_get_cl_request_cid
+ *
+ * Description      This function gets the bearer for a client request. Idle
+ *                  EATT bearers are used first, then the ATT bearer when it
+ *                  is idle, otherwise the bearer with the fewest queued
+ *                  requests. Requests on different bearers complete in any
+ *                  order, apps needing ordering wait for each response.
+ *
+ * Returns          CID of the bearer
+ *
+ ******************************************************************************/
+uint16_t gatt_tcb_get_cl_request_cid(tGATT_TCB& tcb, bool eatt_support) {
+  if (!eatt_support || !tcb.eatt) return tcb.att_lcid;
+
+  EattExtension* eatt = EattExtension::GetInstance();
+  EattChannel* channel =
+      eatt->GetChannelAvailableForClientRequest(tcb.peer_bda);
+  if (channel) return channel->cid_;
+
+  if (tcb.cl_cmd_q.empty()) return tcb.att_lcid;
+
+  channel = eatt->GetLeastBusyChannelForClientRequest(tcb.peer_bda);
+  if (channel && channel->cl_cmd_q_.size() < tcb.cl_cmd_q.size()) {
+    return channel->cid_;
+  }
+  return tcb.att_lcid;
+}
+
 /*******************************************************************************
  *
  * Function         gatt_tcb_get_payload_size
@@ -1390,6 +1467,7 @@ void gatt_sr_reset_prep_cnt(tGATT_TCB& tcb) {
   for (uint8_t i = 0; i < GATT_MAX_APPS; i++) {
     tcb.prep_cnt[i] = 0;
   }
+  tcb.prep_write_bytes = 0;
 }
 
 /* Get pointer to server command on given cid */
@@ -1503,6 +1581,79 @@ void gatt_sr_update_prep_cnt(tGATT_TCB& tcb, tGATT_IF gatt_if, bool is_inc,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         gatt_sr_store_long_read
+ *
+ * Description      Keep the value an app answered a Read or Read Blob request
+ *                  with when it does not fit in the response, so that the Read
+ *                  Blob requests of the rest of the value are answered without
+ *                  the app for GATT_LONG_READ_CACHE_TIMEOUT_MS.
+ *
+ * Parameter        offset: offset of p_value in the attribute value.
+ *
+ * Returns          None
+ *
+ ******************************************************************************/
+void gatt_sr_store_long_read(tGATT_TCB& tcb, uint16_t cid, uint16_t handle,
+                             uint16_t offset, const uint8_t* p_value,
+                             uint16_t len) {
+  auto& cache = tcb.sr_long_read;
+  cache.cid = cid;
+  cache.handle = handle;
+  cache.offset = offset;
+  cache.expiry_ms = bluetooth::common::time_get_os_boottime_ms() +
+                    GATT_LONG_READ_CACHE_TIMEOUT_MS;
+  cache.value.assign(p_value, p_value + len);
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_read_long_cached
+ *
+ * Description      Copy the part of a long attribute value at |offset| from
+ *                  the value kept by gatt_sr_store_long_read().
+ *
+ * Returns          true if the value was copied into p_value, false if the
+ *                  app has to be asked.
+ *
+ ******************************************************************************/
+bool gatt_sr_read_long_cached(tGATT_TCB& tcb, uint16_t cid, uint16_t handle,
+                              uint16_t offset, uint8_t* p_value,
+                              uint16_t* p_len, uint16_t max_len) {
+  auto& cache = tcb.sr_long_read;
+  if (cache.value.empty() || cache.cid != cid || cache.handle != handle ||
+      offset < cache.offset || offset - cache.offset > cache.value.size()) {
+    return false;
+  }
+
+  if (bluetooth::common::time_get_os_boottime_ms() >= cache.expiry_ms) {
+    cache.value.clear();
+    return false;
+  }
+
+  size_t start = offset - cache.offset;
+  uint16_t len = std::min<size_t>(cache.value.size() - start, max_len);
+  memcpy(p_value, cache.value.data() + start, len);
+  *p_len = len;
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_drop_long_read
+ *
+ * Description      Forget the long value kept for |handle|, or the one kept
+ *                  for any handle if |handle| is 0, when it may have changed.
+ *
+ * Returns          None
+ *
+ ******************************************************************************/
+void gatt_sr_drop_long_read(tGATT_TCB& tcb, uint16_t handle) {
+  auto& cache = tcb.sr_long_read;
+  if (handle == 0 || cache.handle == handle) cache.value.clear();
+}
+
 /** Cancel LE Create Connection request */
 bool gatt_cancel_open(tGATT_IF gatt_if, const RawAddress& bda) {
   tGATT_TCB* p_tcb = gatt_find_tcb_by_addr(bda, BT_TRANSPORT_LE);
@@ -1564,6 +1715,9 @@ bool gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
 
   if (p_clcb->cid == tcb.att_lcid) {
     tcb.cl_cmd_q.push_back(cmd);
+    tcb.cl_requests++;
+    tcb.cl_max_queued =
+        std::max<uint16_t>(tcb.cl_max_queued, tcb.cl_cmd_q.size());
   } else {
     EattChannel* channel =
         EattExtension::GetInstance()->FindEattChannelByCid(tcb.peer_bda, cmd.cid);
@@ -1573,6 +1727,9 @@ bool gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
       return false;
     }
     channel->cl_cmd_q_.push_back(cmd);
+    channel->cl_requests_++;
+    channel->cl_max_queued_ =
+        std::max<uint16_t>(channel->cl_max_queued_, channel->cl_cmd_q_.size());
   }
 
   return true;
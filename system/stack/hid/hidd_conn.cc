@@ -337,6 +337,7 @@ static void hidd_l2cif_disconnect_ind(uint16_t cid, bool ack_needed) {
       osi_free(hd_cb.pending_data);
       hd_cb.pending_data = NULL;
     }
+    hidd_conn_free_coalesced_reports();
 
     hd_cb.device.state = HIDD_DEV_NO_CONN;
     p_hcon->conn_state = HID_CONN_STATE_UNUSED;
@@ -389,6 +390,83 @@ static void hidd_l2cif_disconnect(uint16_t cid) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         hidd_conn_coalesce_report
+ *
+ * Description      Holds back an input report while the interrupt channel is
+ *                  congested. A pending report with the same report id is
+ *                  superseded by the new one, as it will never be looked at.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void hidd_conn_coalesce_report(BT_HDR* p_buf, uint8_t report_id) {
+  p_buf->layer_specific = report_id;
+
+  for (uint8_t i = 0; i < hd_cb.num_coalesced_reports; i++) {
+    if (hd_cb.coalesced_reports[i]->layer_specific == report_id) {
+      osi_free(hd_cb.coalesced_reports[i]);
+      hd_cb.coalesced_reports[i] = p_buf;
+      return;
+    }
+  }
+
+  if (hd_cb.num_coalesced_reports == HIDD_MAX_COALESCED_REPORTS) {
+    LOG_WARN("%s: too many pending reports, dropping the oldest one",
+             __func__);
+    osi_free(hd_cb.coalesced_reports[0]);
+    memmove(&hd_cb.coalesced_reports[0], &hd_cb.coalesced_reports[1],
+            (HIDD_MAX_COALESCED_REPORTS - 1) * sizeof(BT_HDR*));
+    hd_cb.num_coalesced_reports--;
+  }
+
+  hd_cb.coalesced_reports[hd_cb.num_coalesced_reports++] = p_buf;
+}
+
+/*******************************************************************************
+ *
+ * Function         hidd_conn_send_coalesced_reports
+ *
+ * Description      Sends the input reports held back during congestion, until
+ *                  the interrupt channel gets congested again.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void hidd_conn_send_coalesced_reports(void) {
+  uint8_t sent = 0;
+
+  while (sent < hd_cb.num_coalesced_reports) {
+    BT_HDR* p_buf = hd_cb.coalesced_reports[sent++];
+    p_buf->layer_specific = 0;
+    if (L2CA_DataWrite(hd_cb.device.conn.intr_cid, p_buf) ==
+        L2CAP_DW_CONGESTED) {
+      break;
+    }
+  }
+
+  hd_cb.num_coalesced_reports -= sent;
+  memmove(&hd_cb.coalesced_reports[0], &hd_cb.coalesced_reports[sent],
+          hd_cb.num_coalesced_reports * sizeof(BT_HDR*));
+}
+
+/*******************************************************************************
+ *
+ * Function         hidd_conn_free_coalesced_reports
+ *
+ * Description      Drops the input reports held back during congestion.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void hidd_conn_free_coalesced_reports(void) {
+  for (uint8_t i = 0; i < hd_cb.num_coalesced_reports; i++) {
+    osi_free(hd_cb.coalesced_reports[i]);
+  }
+  hd_cb.num_coalesced_reports = 0;
+}
+
 /*******************************************************************************
  *
  * Function         hidd_l2cif_cong_ind
@@ -413,6 +491,9 @@ static void hidd_l2cif_cong_ind(uint16_t cid, bool congested) {
     p_hcon->conn_flags |= HID_CONN_FLAGS_CONGESTED;
   } else {
     p_hcon->conn_flags &= ~HID_CONN_FLAGS_CONGESTED;
+    if (hd_cb.device.state == HIDD_DEV_CONNECTED) {
+      hidd_conn_send_coalesced_reports();
+    }
   }
 }
 
@@ -683,6 +764,7 @@ tHID_STATUS hidd_conn_disconnect(void) {
     osi_free(hd_cb.pending_data);
     hd_cb.pending_data = NULL;
   }
+  hidd_conn_free_coalesced_reports();
 
   tHID_CONN* p_hcon = &hd_cb.device.conn;
 
@@ -728,7 +810,15 @@ tHID_STATUS hidd_conn_send_data(uint8_t channel, uint8_t msg_type,
 
   tHID_CONN* p_hcon = &hd_cb.device.conn;
 
-  if (p_hcon->conn_flags & HID_CONN_FLAGS_CONGESTED) {
+  // Input reports carry the current state of the device. While the interrupt
+  // channel is congested, or older reports are still held back, the latest
+  // report of each report id is kept for later instead of being dropped.
+  bool coalesce = msg_type == HID_TRANS_DATA && channel == HID_CHANNEL_INTR &&
+                  hd_cb.device.state == HIDD_DEV_CONNECTED &&
+                  ((p_hcon->conn_flags & HID_CONN_FLAGS_CONGESTED) ||
+                   hd_cb.num_coalesced_reports > 0);
+
+  if ((p_hcon->conn_flags & HID_CONN_FLAGS_CONGESTED) && !coalesce) {
     log_counter_metrics(android::bluetooth::CodePathCounterKeyEnum::
                             HIDD_ERR_CONGESTED_AT_FLAG_CHECK,
                         1);
@@ -808,11 +898,17 @@ tHID_STATUS hidd_conn_send_data(uint8_t channel, uint8_t msg_type,
     return HID_ERR_NO_CONNECTION;
   }
 
+  if (coalesce) {
+    hidd_conn_coalesce_report(p_buf, data);
+    return (HID_SUCCESS);
+  }
+
 #ifdef REPORT_TRANSFER_TIMESTAMP
   if (report_transfer) {
     LOG_ERROR("%s: report sent", __func__);
   }
 #endif
+
   LOG_VERBOSE("%s: report sent", __func__);
 
   if (!L2CA_DataWrite(cid, p_buf)) {
@@ -36,6 +36,10 @@
 
 enum { HIDD_DEV_NO_CONN, HIDD_DEV_CONNECTED };
 
+/* Max number of distinct input reports held back while the interrupt channel
+ * is congested */
+#define HIDD_MAX_COALESCED_REPORTS 8
+
 typedef struct device_ctb {
   bool in_use;
   RawAddress addr;
@@ -65,6 +69,12 @@ typedef struct dev_ctb {
 
   BT_HDR* pending_data;
 
+  /* Input reports held back while the interrupt channel is congested, in
+   * arrival order. Only the latest report of each report id is kept, its id
+   * is stored in layer_specific. */
+  BT_HDR* coalesced_reports[HIDD_MAX_COALESCED_REPORTS];
+  uint8_t num_coalesced_reports;
+
   bool pending_vc_unplug;
 } tHID_DEV_CTB;
 
@@ -75,6 +85,7 @@ tHID_STATUS hidd_conn_disconnect(void);
 tHID_STATUS hidd_conn_send_data(uint8_t channel, uint8_t msg_type,
                                 uint8_t param, uint8_t data, uint16_t len,
                                 uint8_t* p_data);
+void hidd_conn_free_coalesced_reports(void);
 
 #ifdef __cplusplus
 extern "C" {
@@ -80,4 +80,10 @@ int a2dp_aac_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_aac_send_frames(uint64_t timestamp_us);
 
+// Set the transmit queue length for the A2DP AAC encoder.
+// With a constant bit rate, the bit rate is lowered while
+// |transmit_queue_length| packets back up in the queue, and raised back to the
+// configured bit rate once it has drained.
+void a2dp_aac_set_transmit_queue_length(size_t transmit_queue_length);
+
 #endif  // A2DP_AAC_ENCODER_H
@@ -65,6 +65,11 @@ int a2dp_sbc_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_sbc_send_frames(uint64_t timestamp_us);
 
+// Set the transmit queue length for the A2DP SBC encoder.
+// The bitpool is lowered while |transmit_queue_length| packets back up in the
+// queue, and raised back to the configured bitpool once it has drained.
+void a2dp_sbc_set_transmit_queue_length(size_t transmit_queue_length);
+
 // Get SBC bitrate
 // Returns |uint32_t| bitrate in bits per second
 uint32_t a2dp_sbc_get_bitrate();
@@ -19,7 +19,9 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <vector>
 
 // Scan Response data from Traxxas
@@ -27,6 +29,14 @@ static constexpr std::array<uint8_t, 18> trx_quirk{
     {0x14, 0x09, 0x54, 0xFF, 0xFF, 0x20, 0x42, 0x4C, 0x45, 0x05, 0x12, 0xFF,
      0x00, 0xE8, 0x03, 0x02, 0x0A, 0x00}};
 
+/* An AD structure of advertising data. |data| points inside the advertising
+ * data, at the |length| bytes following the type */
+struct AdvertiseDataField {
+  uint8_t type;
+  const uint8_t* data;
+  uint8_t length;
+};
+
 class AdvertiseDataParser {
   // Return true if the packet is malformed, but should be considered valid for
   // compatibility with already existing devices
@@ -142,4 +152,123 @@ class AdvertiseDataParser {
                                        uint8_t type, uint8_t* p_length) {
     return GetFieldByType(ad.data(), ad.size(), type, p_length);
   }
+
+  /**
+   * Iterates over the AD structures of advertising data in a single pass,
+   * without copying it. The iteration stops at the first zero length or
+   * truncated structure, like GetFieldByType.
+   */
+  class FieldIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = AdvertiseDataField;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const AdvertiseDataField*;
+    using reference = const AdvertiseDataField&;
+
+    FieldIterator() = default;
+    FieldIterator(const uint8_t* ad, size_t ad_len) : ad_(ad), ad_len_(ad_len) {
+      Parse();
+    }
+
+    reference operator*() const { return field_; }
+    pointer operator->() const { return &field_; }
+
+    FieldIterator& operator++() {
+      position_ += field_.length + 2;
+      Parse();
+      return *this;
+    }
+
+    FieldIterator operator++(int) {
+      FieldIterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(const FieldIterator& other) const {
+      return ad_ == other.ad_ && position_ == other.position_;
+    }
+    bool operator!=(const FieldIterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    // Read the field at |position_|, or become the end iterator.
+    void Parse() {
+      if (ad_ == nullptr || position_ >= ad_len_) {
+        *this = FieldIterator();
+        return;
+      }
+      uint8_t len = ad_[position_];
+      if (len == 0 || position_ + len >= ad_len_) {
+        *this = FieldIterator();
+        return;
+      }
+      field_ = {ad_[position_ + 1], ad_ + position_ + 2,
+                static_cast<uint8_t>(len - 1)};
+    }
+
+    const uint8_t* ad_ = nullptr;
+    size_t ad_len_ = 0;
+    size_t position_ = 0;
+    AdvertiseDataField field_{};
+  };
+
+  /* The AD structures of advertising data, for use in range-based for loops */
+  class Fields {
+   public:
+    Fields(const uint8_t* ad, size_t ad_len) : ad_(ad), ad_len_(ad_len) {}
+
+    FieldIterator begin() const { return FieldIterator(ad_, ad_len_); }
+    FieldIterator end() const { return FieldIterator(); }
+
+   private:
+    const uint8_t* ad_;
+    size_t ad_len_;
+  };
+
+  static Fields GetFields(const uint8_t* ad, size_t ad_len) {
+    return Fields(ad, ad_len);
+  }
+
+  static Fields GetFields(std::vector<uint8_t> const& ad) {
+    return Fields(ad.data(), ad.size());
+  }
+
+  /**
+   * The AD structures of an advertising report, parsed once and shared by the
+   * consumers of the report. The advertising data must outlive the index.
+   */
+  class FieldIndex {
+   public:
+    FieldIndex(const uint8_t* ad, size_t ad_len) {
+      for (const AdvertiseDataField& field : GetFields(ad, ad_len)) {
+        fields_.push_back(field);
+      }
+    }
+
+    explicit FieldIndex(std::vector<uint8_t> const& ad)
+        : FieldIndex(ad.data(), ad.size()) {}
+
+    /**
+     * Return the first field of |type| and its length in |p_length|, as
+     * GetFieldByType does
+     */
+    const uint8_t* GetFieldByType(uint8_t type, uint8_t* p_length) const {
+      for (const AdvertiseDataField& field : fields_) {
+        if (field.type == type) {
+          *p_length = field.length;
+          return field.data;
+        }
+      }
+      *p_length = 0;
+      return nullptr;
+    }
+
+    const std::vector<AdvertiseDataField>& fields() const { return fields_; }
+
+   private:
+    std::vector<AdvertiseDataField> fields_;
+  };
 };
@@ -565,6 +565,19 @@ uint8_t BTM_GetNumScoLinks(void);
  ******************************************************************************/
 tBTM_SCO_DEBUG_DUMP BTM_GetScoDebugDump(void);
 
+/*******************************************************************************
+ *
+ * Function         BTM_ScoDumpsys
+ *
+ * Description      Dump the health statistics of the current, or last, SCO
+ *                  call routed over HCI: packet arrival interval and jitter,
+ *                  TX latency estimate, PLC bursts and codec CPU time.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTM_ScoDumpsys(int fd);
+
 /*******************************************************************************
  *
  * Function         BTM_GetPeerDeviceTypeFromFeatures
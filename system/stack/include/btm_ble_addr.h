@@ -51,6 +51,9 @@ bool btm_identity_addr_to_random_pseudo_from_address_with_type(
 
 bool maybe_resolve_address(RawAddress* bda, tBLE_ADDR_TYPE* bda_type);
 
+/* Dump the state of the random address resolution */
+void BTM_BleAddrDumpsys(int fd);
+
 /* BLE address mapping with CS feature */
 bool btm_random_pseudo_to_identity_addr(RawAddress* random_pseudo,
                                         tBLE_ADDR_TYPE* p_identity_addr_type);
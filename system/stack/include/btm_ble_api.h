@@ -110,6 +110,11 @@ void BTM_BleDisableBatchScan(base::Callback<void(uint8_t /* status */)> cb);
 void BTM_BleReadScanReports(tBLE_SCAN_MODE scan_mode,
                             tBTM_BLE_SCAN_REP_CBACK cb);
 
+/* This function is called to read batch scan reports, forwarding them as
+ * they are read */
+void BTM_BleReadScanReportsStreaming(tBLE_SCAN_MODE scan_mode,
+                                     tBTM_BLE_SCAN_REP_STREAM_CBACK cb);
+
 /* This function is called to setup the callback for tracking */
 void BTM_BleTrackAdvertiser(tBTM_BLE_TRACK_ADV_CBACK* p_track_cback,
                             tBTM_BLE_REF_VALUE ref_value);
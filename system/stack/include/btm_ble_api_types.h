@@ -365,6 +365,17 @@ typedef void(tBTM_BLE_SCAN_THRESHOLD_CBACK)(tBTM_BLE_REF_VALUE ref_value);
 using tBTM_BLE_SCAN_REP_CBACK =
     base::Callback<void(tBTM_STATUS /* status */, uint8_t /* report_format */,
                         uint8_t /* num_reports */, std::vector<uint8_t>)>;
+/* Called for each part of the reports read in streaming mode. |data| is only
+ * valid during the call, |complete| is set on the last call */
+using tBTM_BLE_SCAN_REP_STREAM_CBACK = base::Callback<void(
+    tBTM_STATUS /* status */, uint8_t /* report_format */,
+    uint8_t /* num_reports */, const std::vector<uint8_t>& /* data */,
+    bool /* complete */)>;
+
+/* Bound on the reports buffered before they are forwarded in streaming mode */
+#ifndef BTM_BLE_BATCH_SCAN_STREAM_BUF_SIZE
+#define BTM_BLE_BATCH_SCAN_STREAM_BUF_SIZE 1024
+#endif
 
 #ifndef BTM_BLE_BATCH_SCAN_MAX
 #define BTM_BLE_BATCH_SCAN_MAX 5
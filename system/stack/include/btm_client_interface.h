@@ -80,6 +80,8 @@ struct btm_client_interface_t {
                                     const tBTM_PM_PWR_MD* p_mode);
     tBTM_STATUS (*BTM_SetSsrParams)(const RawAddress& bd_addr, uint16_t max_lat,
                                     uint16_t min_rmt_to, uint16_t min_loc_to);
+    tBTM_STATUS (*BTM_PM_SetMaxSniffInterval)(const RawAddress& bd_addr,
+                                              uint16_t max_interval);
     tBTM_STATUS (*BTM_SwitchRoleToCentral)(const RawAddress& remote_bd_addr);
     void (*BTM_block_role_switch_for)(const RawAddress& peer_addr);
     void (*BTM_block_sniff_mode_for)(const RawAddress& peer_addr);
@@ -20,6 +20,7 @@
 #define GAP_API_H
 
 #include <cstdint>
+#include <vector>
 
 #include "btm_api.h"
 #include "l2c_api.h"
@@ -128,6 +129,24 @@ uint16_t GAP_ConnOpen(const char* p_serv_name, uint8_t service_id,
                       tL2CAP_ERTM_INFO* ertm_info, uint16_t security,
                       tGAP_CONN_CALLBACK* p_cb, tBT_TRANSPORT transport);
 
+/*******************************************************************************
+ *
+ * Function         GAP_ConnOpenCreditBased
+ *
+ * Description      This function is called to open up to
+ *                  L2CAP_CREDIT_BASED_MAX_CIDS LE CoC channels to a peer with
+ *                  a single Credit Based Connection Request. The LE link to
+ *                  the peer must be up.
+ *
+ * Returns          handles of the channels, in the order of the request, or
+ *                  an empty vector if the request could not be sent
+ *
+ ******************************************************************************/
+std::vector<uint16_t> GAP_ConnOpenCreditBased(
+    const char* p_serv_name, uint8_t service_id, const RawAddress& rem_bda,
+    uint16_t psm, uint16_t le_mps, tL2CAP_CFG_INFO* p_cfg, uint16_t security,
+    tGAP_CONN_CALLBACK* p_cb, uint8_t num_channels);
+
 /*******************************************************************************
  *
  * Function         GAP_ConnClose
@@ -156,6 +175,22 @@ uint16_t GAP_ConnClose(uint16_t gap_handle);
 uint16_t GAP_ConnReadData(uint16_t gap_handle, uint8_t* p_data,
                           uint16_t max_len, uint16_t* p_len);
 
+/*******************************************************************************
+ *
+ * Function         GAP_ConnBTRead
+ *
+ * Description      Bluetooth-aware applications will call this function after
+ *                  receiving GAP_EVT_RXDATA event. The first received SDU is
+ *                  dequeued and its ownership passed to the caller, no data
+ *                  copy is made.
+ *
+ * Returns          BT_PASS             - data read
+ *                  GAP_ERR_BAD_HANDLE  - invalid handle
+ *                  GAP_NO_DATA_AVAIL   - no data available
+ *
+ ******************************************************************************/
+uint16_t GAP_ConnBTRead(uint16_t gap_handle, BT_HDR** pp_buf);
+
 /*******************************************************************************
  *
  * Function         GAP_GetRxQueueCnt
@@ -492,6 +492,14 @@ typedef struct {
   uint8_t value[GATT_MAX_ATTR_LEN]; /* the actual attribute value */
 } tGATT_VALUE;
 
+/* Attribute value sent without a copy, see GATTS_HandleValueNotificationBatch
+ * and GATTC_WriteNoRspBatch */
+typedef struct {
+  uint16_t handle;        /* attribute handle */
+  uint16_t len;           /* length of attribute value */
+  const uint8_t* p_value; /* the attribute value */
+} tGATT_VALUE_REF;
+
 /* Union of the event data which is used in the server respond API to carry the
  * server response information
 */
@@ -925,6 +933,27 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
                                            uint16_t attr_handle,
                                            uint16_t val_len, uint8_t* p_val);
 
+/*******************************************************************************
+ *
+ * Function         GATTS_HandleValueNotificationBatch
+ *
+ * Description      This function sends handle value notifications to a client
+ *                  on the ATT bearer, in order, for as long as L2CAP has room
+ *                  for them. The last notification sent may leave the bearer
+ *                  congested, p_congestion_cb then reports when it is not
+ *                  anymore and the remaining values can be sent.
+ *
+ * Parameter        conn_id: connection identifier.
+ *                  p_values: values to notify.
+ *                  num_values: number of values.
+ *
+ * Returns          Number of notifications sent, from the first value.
+ *
+ ******************************************************************************/
+uint16_t GATTS_HandleValueNotificationBatch(uint16_t conn_id,
+                                            const tGATT_VALUE_REF* p_values,
+                                            uint16_t num_values);
+
 /*******************************************************************************
  *
  * Function         GATTS_SendRsp
@@ -1049,6 +1078,21 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
 tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
                         tGATT_READ_PARAM* p_read);
 
+/*******************************************************************************
+ *
+ * Function         GATTC_GetMaxReadMultiVarHandles
+ *
+ * Description      This function returns how many handles fit in one Read
+ *                  Multiple Variable Length request to the server.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          0 if the server is not known to support the request,
+ *                  otherwise up to GATT_MAX_READ_MULTI_HANDLES.
+ *
+ ******************************************************************************/
+uint8_t GATTC_GetMaxReadMultiVarHandles(uint16_t conn_id);
+
 /*******************************************************************************
  *
  * Function         GATTC_Write
@@ -1066,6 +1110,29 @@ tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
 tGATT_STATUS GATTC_Write(uint16_t conn_id, tGATT_WRITE_TYPE type,
                          tGATT_VALUE* p_write);
 
+/*******************************************************************************
+ *
+ * Function         GATTC_WriteNoRspBatch
+ *
+ * Description      This function sends Write Commands to the server on the ATT
+ *                  bearer, in order, for as long as L2CAP has room for them.
+ *                  The commands are not signed and are not held back behind
+ *                  requests waiting for a response. The last command sent may
+ *                  leave the bearer congested, p_congestion_cb then reports
+ *                  when it is not anymore and the remaining values can be
+ *                  sent.
+ *
+ * Parameters       conn_id: connection identifier.
+ *                  p_values: values to write.
+ *                  num_values: number of values.
+ *
+ * Returns          Number of commands sent, from the first value.
+ *
+ ******************************************************************************/
+uint16_t GATTC_WriteNoRspBatch(uint16_t conn_id,
+                               const tGATT_VALUE_REF* p_values,
+                               uint16_t num_values);
+
 /*******************************************************************************
  *
  * Function         GATTC_ExecuteWrite
@@ -1280,6 +1347,18 @@ bool GATT_GetConnIdIfConnected(tGATT_IF gatt_if, const RawAddress& bd_addr,
 void GATT_ConfigServiceChangeCCC(const RawAddress& remote_bda, bool enable,
                                  tBT_TRANSPORT transport);
 
+/*******************************************************************************
+ *
+ * Function         GATT_Dumpsys
+ *
+ * Description      Dump the ATT and EATT bearers of each device, with the
+ *                  client requests each of them carried
+ *
+ * Returns          None.
+ *
+ ******************************************************************************/
+void GATT_Dumpsys(int fd);
+
 // Enables the GATT profile on the device.
 // It clears out the control blocks, and registers with L2CAP.
 void gatt_init(void);
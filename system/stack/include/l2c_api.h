@@ -579,6 +579,20 @@ uint8_t L2CA_DataWrite(uint16_t cid, BT_HDR* p_data);
 
 uint8_t L2CA_LECocDataWrite(uint16_t cid, BT_HDR* p_data);
 
+/*******************************************************************************
+ *
+ * Function         L2CA_GetTxRoom
+ *
+ * Description      Higher layers call this function to know how many more
+ *                  SDUs the channel accepts. The last of them makes the
+ *                  channel congested, and the congestion status callback
+ *                  reports when the channel is uncongested again.
+ *
+ * Returns          Number of SDUs, 0 if the channel is congested or unknown
+ *
+ ******************************************************************************/
+uint16_t L2CA_GetTxRoom(uint16_t cid);
+
 // Given a local channel identifier, |lcid|, this function returns the bound
 // remote channel identifier, |rcid|. If
 // |lcid| is not known or is invalid, this function returns false and does not
@@ -783,6 +797,23 @@ bool L2CA_ConnectFixedChnl(uint16_t fixed_cid, const RawAddress& bd_addr);
 uint16_t L2CA_SendFixedChnlData(uint16_t fixed_cid, const RawAddress& rem_bda,
                                 BT_HDR* p_buf);
 
+/*******************************************************************************
+ *
+ *  Function        L2CA_GetFixedChnlTxRoom
+ *
+ *  Description     Get how many more SDUs a fixed channel accepts. The last of
+ *                  them makes the channel congested, and the fixed channel
+ *                  congestion callback reports when it is uncongested again.
+ *
+ *  Parameters:     Fixed CID
+ *                  BD Address of remote
+ *
+ * Return value     Number of SDUs, 0 if the channel is congested or the link
+ *                  does not exist
+ *
+ ******************************************************************************/
+uint16_t L2CA_GetFixedChnlTxRoom(uint16_t fixed_cid, const RawAddress& rem_bda);
+
 /*******************************************************************************
  *
  *  Function        L2CA_RemoveFixedChnl
@@ -923,4 +954,17 @@ void L2CA_SetMediaStreamChannel(uint16_t local_media_cid, bool status);
 bool L2CA_isMediaChannel(uint16_t handle, uint16_t channel_id,
                          bool is_local_cid);
 
+/*******************************************************************************
+**
+** Function         L2CA_Dumpsys
+**
+** Description      This function dumps the links and channels, with the
+**                      retransmission and acknowledgement ratios of the
+**                      channels in enhanced retransmission mode
+**
+** Returns          void
+**
+*******************************************************************************/
+void L2CA_Dumpsys(int fd);
+
 #endif /* L2C_API_H */
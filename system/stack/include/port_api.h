@@ -440,6 +440,24 @@ void RFCOMM_Init(void);
  ******************************************************************************/
 const char* PORT_GetResultString(const uint8_t result_code);
 
+/*******************************************************************************
+ *
+ * Function         PORT_SetTxPriority
+ *
+ * Description      This function sets how the data of a port is scheduled
+ *                  with the data of the other ports on the same multiplexer.
+ *                  Ports of the headset and handsfree profiles are in the
+ *                  control plane by default, the other ports are not.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                  control_plane - true to send the data of the port before
+ *                               the data of the bulk ports in each round
+ *                  weight     - frames the port sends in each round, from 1
+ *                               to PORT_TX_MAX_WEIGHT
+ *
+ ******************************************************************************/
+int PORT_SetTxPriority(uint16_t handle, bool control_plane, uint8_t weight);
+
 /*******************************************************************************
  *
  * Function         PORT_GetSecurityMask
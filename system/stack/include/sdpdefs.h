@@ -59,6 +59,9 @@
 
 #define ATTR_ID_GOEP_L2CAP_PSM 0x0200
 
+/* Service Discovery Server record */
+#define ATTR_ID_SERVICE_DATABASE_STATE 0x0201
+
 #define ATTR_ID_NETWORK 0x0301
 #define ATTR_ID_FAX_CLASS_1_SUPPORT 0x0302
 #define ATTR_ID_REMOTE_AUDIO_VOLUME_CONTROL 0x0302
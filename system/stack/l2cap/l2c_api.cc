@@ -39,6 +39,7 @@
 #include "gd/os/system_properties.h"
 #include "internal_include/bt_target.h"
 #include "internal_include/bt_trace.h"
+#include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
@@ -49,6 +50,7 @@
 #include "stack/include/l2c_api.h"
 #include "stack/include/main_thread.h"
 #include "stack/l2cap/l2c_int.h"
+#include "types/bt_transport.h"
 #include "types/raw_address.h"
 
 void btsnd_hcic_enhanced_flush(uint16_t handle,
@@ -1366,6 +1368,40 @@ uint16_t L2CA_SendFixedChnlData(uint16_t fixed_cid, const RawAddress& rem_bda,
   return (L2CAP_DW_SUCCESS);
 }
 
+/*******************************************************************************
+ *
+ *  Function        L2CA_GetFixedChnlTxRoom
+ *
+ *  Description     Get how many more SDUs a fixed channel accepts before it is
+ *                  congested.
+ *
+ *  Parameters:     Fixed CID
+ *                  BD Address of remote
+ *
+ * Return value     Number of SDUs, 0 if the channel is congested or the link
+ *                  does not exist
+ *
+ ******************************************************************************/
+uint16_t L2CA_GetFixedChnlTxRoom(uint16_t fixed_cid, const RawAddress& rem_bda) {
+  tBT_TRANSPORT transport = BT_TRANSPORT_BR_EDR;
+
+  if (fixed_cid >= L2CAP_ATT_CID && fixed_cid <= L2CAP_SMP_CID)
+    transport = BT_TRANSPORT_LE;
+
+  if ((fixed_cid < L2CAP_FIRST_FIXED_CHNL) ||
+      (fixed_cid > L2CAP_LAST_FIXED_CHNL)) {
+    return 0;
+  }
+
+  tL2C_LCB* p_lcb = l2cu_find_lcb_by_bd_addr(rem_bda, transport);
+  if (p_lcb == NULL || p_lcb->link_state == LST_DISCONNECTING) return 0;
+
+  /* The channel control block is set up with the first SDU */
+  tL2C_CCB* p_ccb = p_lcb->p_fixed_ccbs[fixed_cid - L2CAP_FIRST_FIXED_CHNL];
+  if (p_ccb == NULL) return 1;
+  return l2cu_get_tx_room(p_ccb);
+}
+
 /*******************************************************************************
  *
  *  Function        L2CA_RemoveFixedChnl
@@ -1502,6 +1538,22 @@ uint8_t L2CA_LECocDataWrite(uint16_t cid, BT_HDR* p_data) {
   return L2CA_DataWrite(cid, p_data);
 }
 
+/*******************************************************************************
+ *
+ * Function         L2CA_GetTxRoom
+ *
+ * Description      Higher layers call this function to know how many more
+ *                  SDUs the channel accepts before it is congested.
+ *
+ * Returns          Number of SDUs, 0 if the channel is congested or unknown
+ *
+ ******************************************************************************/
+uint16_t L2CA_GetTxRoom(uint16_t cid) {
+  tL2C_CCB* p_ccb = l2cu_find_ccb_by_cid(NULL, cid);
+  if (p_ccb == NULL) return 0;
+  return l2cu_get_tx_room(p_ccb);
+}
+
 /*******************************************************************************
  *
  * Function         L2CA_SetChnlFlushability
@@ -1767,3 +1819,69 @@ bool L2CA_isMediaChannel(uint16_t handle, uint16_t channel_id,
 
   return ret;
 }
+
+/* Ratio in percent, or 0 when nothing was counted */
+static unsigned percent(uint32_t count, uint32_t total) {
+  if (total == 0) return 0;
+  return (unsigned)((100ull * count) / total);
+}
+
+#define DUMPSYS_TAG "shim::legacy::l2cap"
+void L2CA_Dumpsys(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+
+  LOG_DUMPSYS(fd, "  acl buffers:%u quotas:%s round_robin_quota:%u",
+              l2cb.num_lm_acl_bufs,
+              l2cb.dynamic_acl_quota ? "dynamic" : "static",
+              l2cb.round_robin_quota);
+
+  const tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  for (int i = 0; i < MAX_L2CAP_LINKS; i++, p_lcb++) {
+    if (!p_lcb->in_use) continue;
+    LOG_DUMPSYS(fd, "  link:%s handle:0x%04x transport:%s",
+                ADDRESS_TO_LOGGABLE_CSTR(p_lcb->remote_bd_addr),
+                p_lcb->Handle(), bt_transport_text(p_lcb->transport).c_str());
+    LOG_DUMPSYS(fd,
+                "    acl quota:%u reason:%s demand:%u pkts/period "
+                "sent_not_acked:%u",
+                p_lcb->link_xmit_quota,
+                quota_reason_text(p_lcb->quota_reason).c_str(),
+                p_lcb->quota_demand / 16, p_lcb->sent_not_acked);
+
+    for (const tL2C_CCB* p_ccb = p_lcb->ccb_queue.p_first_ccb; p_ccb != NULL;
+         p_ccb = p_ccb->p_next_ccb) {
+      LOG_DUMPSYS(fd,
+                  "    cid:0x%04x rcid:0x%04x psm:0x%04x starved "
+                  "no_credits:%u flow_controlled:%u",
+                  p_ccb->local_cid, p_ccb->remote_cid,
+                  p_ccb->p_rcb ? p_ccb->p_rcb->psm : 0,
+                  p_ccb->metrics.starved.no_credits,
+                  p_ccb->metrics.starved.flow_controlled);
+      const auto& credits = p_ccb->le_credit_policy;
+      if (credits.IsConfigured()) {
+        LOG_DUMPSYS(
+            fd,
+            "      le credits remote:%u window:%u drain_rate:%uB/s remote "
+            "starved:%u for %lldms",
+            p_ccb->remote_credit_count, credits.GetWindow(),
+            credits.GetDrainRate(), credits.GetStats().starved_intervals,
+            static_cast<long long>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    credits.GetStats().starved_time)
+                    .count()));
+      }
+      if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_ERTM_MODE) continue;
+
+      const auto& stats = p_ccb->fcrb.stats;
+      LOG_DUMPSYS(fd,
+                  "      ertm tx i_frames:%u retransmitted:%u (%u%%) "
+                  "rx i_frames:%u acks:%u (%u%%) srej:%u rej:%u",
+                  stats.i_frames_sent, stats.i_frames_retransmitted,
+                  percent(stats.i_frames_retransmitted, stats.i_frames_sent),
+                  stats.i_frames_received, stats.acks_sent,
+                  percent(stats.acks_sent, stats.i_frames_received),
+                  stats.srej_frames_sent, stats.rej_frames_sent);
+    }
+  }
+}
+#undef DUMPSYS_TAG
@@ -70,6 +70,31 @@ using base::StringPrintf;
 static void l2cble_start_conn_update(tL2C_LCB* p_lcb);
 static void l2cble_start_subrate_change(tL2C_LCB* p_lcb);
 
+/* Connection parameters of the LE link optimizer, per traffic class */
+namespace {
+
+struct tL2C_BLE_LINK_OPT_CONN_PARAMS {
+  uint16_t min_interval;
+  uint16_t max_interval;
+  uint16_t latency;
+};
+
+/* 11.25 ~ 15 ms, so a transfer gets several packets per connection event */
+constexpr tL2C_BLE_LINK_OPT_CONN_PARAMS kBulkConnParams = {
+    .min_interval = BTM_BLE_CONN_INT_MIN_LIMIT,
+    .max_interval = 12,
+    .latency = 0,
+};
+
+/* 15 ~ 30 ms, for short round trips */
+constexpr tL2C_BLE_LINK_OPT_CONN_PARAMS kControlConnParams = {
+    .min_interval = 12,
+    .max_interval = 24,
+    .latency = 0,
+};
+
+}  // namespace
+
 /*******************************************************************************
  *
  *  Function        L2CA_UpdateBleConnParams
@@ -110,6 +135,7 @@ bool L2CA_UpdateBleConnParams(const RawAddress& rem_bda, uint16_t min_int,
   p_lcb->latency = latency;
   p_lcb->timeout = timeout;
   p_lcb->conn_update_mask |= L2C_BLE_NEW_CONN_PARAM;
+  p_lcb->link_opt.conn_params_pinned = true;
   p_lcb->min_ce_len = min_ce_len;
   p_lcb->max_ce_len = max_ce_len;
 
@@ -176,7 +202,7 @@ void L2CA_Consolidate(const RawAddress& identity_addr, const RawAddress& rpa) {
   LOG_INFO("consolidating l2c_lcb record %s -> %s",
            ADDRESS_TO_LOGGABLE_CSTR(rpa),
            ADDRESS_TO_LOGGABLE_CSTR(identity_addr));
-  p_lcb->remote_bd_addr = identity_addr;
+  l2cu_set_lcb_bd_addr(p_lcb, identity_addr);
 }
 
 hci_role_t L2CA_GetBleConnRole(const RawAddress& bd_addr) {
@@ -285,6 +311,8 @@ bool l2cble_conn_comp(uint16_t handle, uint8_t role, const RawAddress& bda,
                              L2CAP_FIXED_CHNL_BLE_SIG_BIT |
                              L2CAP_FIXED_CHNL_SMP_BIT;
 
+  l2cble_link_opt_start(p_lcb);
+
   if (role == HCI_ROLE_PERIPHERAL) {
     if (!controller_get_interface()
              ->supports_ble_peripheral_initiated_feature_exchange()) {
@@ -547,6 +575,7 @@ void l2cble_process_sig_cmd(tL2C_LCB* p_lcb, uint8_t* p, uint16_t pkt_len) {
           p_lcb->latency = latency;
           p_lcb->timeout = timeout;
           p_lcb->conn_update_mask |= L2C_BLE_NEW_CONN_PARAM;
+          p_lcb->link_opt.conn_params_pinned = true;
 
           l2cble_start_conn_update(p_lcb);
         }
@@ -1321,6 +1350,7 @@ void l2cble_process_rc_param_request_evt(uint16_t handle, uint16_t int_min,
     p_lcb->max_interval = int_max;
     p_lcb->latency = latency;
     p_lcb->timeout = timeout;
+    p_lcb->link_opt.conn_params_pinned = true;
 
     /* if update is enabled, always accept connection parameter update */
     if ((p_lcb->conn_update_mask & L2C_BLE_CONN_UPDATE_DISABLE) == 0) {
@@ -1364,7 +1394,10 @@ void l2cble_update_data_length(tL2C_LCB* p_lcb) {
     }
   }
 
-  if (tx_mtu > BTM_BLE_DATA_SIZE_MAX) tx_mtu = BTM_BLE_DATA_SIZE_MAX;
+  /* bulk traffic uses the largest packets, whatever the channel MTU */
+  if (p_lcb->link_opt.traffic_class == L2C_BLE_TRAFFIC_BULK ||
+      tx_mtu > BTM_BLE_DATA_SIZE_MAX)
+    tx_mtu = BTM_BLE_DATA_SIZE_MAX;
 
   /* update TX data length if changed */
   if (p_lcb->tx_data_len != tx_mtu)
@@ -1420,6 +1453,174 @@ void l2cble_process_data_length_change_event(uint16_t handle,
   /* ignore rx_data len for now */
 }
 
+/*******************************************************************************
+ *
+ * Function         l2cble_link_opt_start
+ *
+ * Description      Start following the traffic of a new LE link
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void l2cble_link_opt_timeout(void* data);
+
+void l2cble_link_opt_start(tL2C_LCB* p_lcb) {
+  alarm_t* timer = p_lcb->link_opt.timer;
+  p_lcb->link_opt = {};
+  if (!osi_property_get_bool("bluetooth.l2cap.le.link_optimizer.enabled",
+                             true)) {
+    alarm_free(timer);
+    return;
+  }
+
+  if (timer == nullptr) timer = alarm_new_periodic("l2c_lcb.link_opt_timer");
+  p_lcb->link_opt.timer = timer;
+  alarm_set_on_mloop(timer, L2CAP_BLE_LINK_OPT_PERIOD_MS,
+                     l2cble_link_opt_timeout, p_lcb);
+}
+
+void l2cble_link_opt_stop(tL2C_LCB* p_lcb) {
+  alarm_free(p_lcb->link_opt.timer);
+  p_lcb->link_opt.timer = nullptr;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cble_link_opt_traffic
+ *
+ * Description      Count a packet sent or received on an LE link. Only the
+ *                  ATT and LE CoC traffic is counted, the signaling and SMP
+ *                  traffic does not last.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2cble_link_opt_traffic(tL2C_LCB* p_lcb, uint16_t cid, uint16_t len) {
+  if (p_lcb->link_opt.timer == nullptr) return;
+  if (cid != L2CAP_ATT_CID && cid < L2CAP_BASE_APPL_CID) return;
+
+  p_lcb->link_opt.bytes += len;
+  if (p_lcb->link_opt.packets < UINT16_MAX) p_lcb->link_opt.packets++;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cble_link_opt_next_class
+ *
+ * Description      Close the current traffic period and choose the class of
+ *                  the link. A link steps up as soon as its traffic grows,
+ *                  and down only after L2CAP_BLE_LINK_OPT_QUIET_PERIODS
+ *                  periods with less traffic, so that the gaps of a transfer
+ *                  do not renegotiate the link.
+ *
+ * Returns          the traffic class the link should use
+ *
+ ******************************************************************************/
+tL2C_BLE_TRAFFIC_CLASS l2cble_link_opt_next_class(tL2C_BLE_LINK_OPT* p_opt) {
+  tL2C_BLE_TRAFFIC_CLASS measured = L2C_BLE_TRAFFIC_IDLE;
+  if (p_opt->bytes >= L2CAP_BLE_LINK_OPT_BULK_BYTES) {
+    measured = L2C_BLE_TRAFFIC_BULK;
+  } else if (p_opt->packets >= L2CAP_BLE_LINK_OPT_CONTROL_PACKETS) {
+    measured = L2C_BLE_TRAFFIC_CONTROL;
+  }
+  p_opt->bytes = 0;
+  p_opt->packets = 0;
+
+  if (measured >= p_opt->traffic_class) {
+    p_opt->quiet_periods = 0;
+    return measured;
+  }
+  if (++p_opt->quiet_periods < L2CAP_BLE_LINK_OPT_QUIET_PERIODS) {
+    return p_opt->traffic_class;
+  }
+  p_opt->quiet_periods = 0;
+  return measured;
+}
+
+static void l2cble_link_opt_set_conn_params(tL2C_LCB* p_lcb,
+                                            tL2C_BLE_TRAFFIC_CLASS cls) {
+  tL2C_BLE_LINK_OPT& opt = p_lcb->link_opt;
+  if (opt.conn_params_pinned ||
+      (p_lcb->conn_update_mask & L2C_BLE_CONN_UPDATE_DISABLE)) {
+    return;
+  }
+
+  if (cls == L2C_BLE_TRAFFIC_IDLE) {
+    if (!opt.conn_params_changed) return;
+    p_lcb->min_interval = opt.min_interval;
+    p_lcb->max_interval = opt.max_interval;
+    p_lcb->latency = opt.latency;
+    p_lcb->timeout = opt.timeout;
+    opt.conn_params_changed = false;
+  } else {
+    const tL2C_BLE_LINK_OPT_CONN_PARAMS& params =
+        (cls == L2C_BLE_TRAFFIC_BULK) ? kBulkConnParams : kControlConnParams;
+    uint16_t min_interval = params.min_interval;
+    uint16_t max_interval = params.max_interval;
+    L2CA_AdjustConnectionIntervals(&min_interval, &max_interval,
+                                   BTM_BLE_CONN_INT_MIN_LIMIT);
+    /* the link is already at least as fast */
+    if (!opt.conn_params_changed && p_lcb->max_interval <= max_interval &&
+        p_lcb->latency <= params.latency) {
+      return;
+    }
+    if (!opt.conn_params_changed) {
+      opt.min_interval = p_lcb->min_interval;
+      opt.max_interval = p_lcb->max_interval;
+      opt.latency = p_lcb->latency;
+      opt.timeout = p_lcb->timeout;
+      opt.conn_params_changed = true;
+    }
+    p_lcb->min_interval = min_interval;
+    p_lcb->max_interval = max_interval;
+    p_lcb->latency = params.latency;
+  }
+  p_lcb->min_ce_len = 0;
+  p_lcb->max_ce_len = 0;
+  p_lcb->conn_update_mask |= L2C_BLE_NEW_CONN_PARAM;
+  l2cble_start_conn_update(p_lcb);
+}
+
+static void l2cble_link_opt_set_phy(tL2C_LCB* p_lcb,
+                                    tL2C_BLE_TRAFFIC_CLASS cls) {
+  tL2C_BLE_LINK_OPT& opt = p_lcb->link_opt;
+  if (cls == L2C_BLE_TRAFFIC_BULK) {
+    if (opt.phy_2m_requested ||
+        !controller_get_interface()->supports_ble_2m_phy() ||
+        !acl_peer_supports_ble_2m_phy(p_lcb->Handle())) {
+      return;
+    }
+    BTM_BleSetPhy(p_lcb->remote_bd_addr, PHY_LE_2M, PHY_LE_2M, 0);
+    opt.phy_2m_requested = true;
+  } else if (cls == L2C_BLE_TRAFFIC_IDLE && opt.phy_2m_requested) {
+    BTM_BleSetPhy(p_lcb->remote_bd_addr, PHY_LE_1M, PHY_LE_1M, 0);
+    opt.phy_2m_requested = false;
+  }
+}
+
+static void l2cble_link_opt_timeout(void* data) {
+  tL2C_LCB* p_lcb = (tL2C_LCB*)data;
+  if (!p_lcb->in_use || !p_lcb->is_transport_ble() ||
+      p_lcb->link_state != LST_CONNECTED) {
+    return;
+  }
+
+  tL2C_BLE_TRAFFIC_CLASS cls = l2cble_link_opt_next_class(&p_lcb->link_opt);
+  if (cls == p_lcb->link_opt.traffic_class) return;
+
+  LOG_INFO("LE link traffic class changed device:%s %hhu => %hhu",
+           ADDRESS_TO_LOGGABLE_CSTR(p_lcb->remote_bd_addr),
+           static_cast<uint8_t>(p_lcb->link_opt.traffic_class),
+           static_cast<uint8_t>(cls));
+  p_lcb->link_opt.traffic_class = cls;
+
+  /* the data length stays raised when the traffic subsides, it only bounds
+   * the size of the packets */
+  if (cls == L2C_BLE_TRAFFIC_BULK) l2cble_update_data_length(p_lcb);
+  l2cble_link_opt_set_phy(p_lcb, cls);
+  l2cble_link_opt_set_conn_params(p_lcb, cls);
+}
+
 /*******************************************************************************
  *
  * Function         l2cble_credit_based_conn_req
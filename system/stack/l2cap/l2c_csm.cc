@@ -1722,6 +1722,9 @@ void l2c_enqueue_peer_data(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
   CHECK(p_ccb != nullptr);
 
   p_ccb->metrics.tx(p_buf->len);
+  if (p_ccb->p_lcb != nullptr && p_ccb->p_lcb->transport == BT_TRANSPORT_LE) {
+    l2cble_link_opt_traffic(p_ccb->p_lcb, p_ccb->local_cid, p_buf->len);
+  }
 
   uint8_t* p;
 
@@ -1751,6 +1754,7 @@ void l2c_enqueue_peer_data(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
         p_ccb->remote_cid);
   } else {
     fixed_queue_enqueue(p_ccb->xmit_hold_q, p_buf);
+    l2cu_ccb_data_queued(p_ccb);
   }
 
   l2cu_check_channel_congestion(p_ccb);
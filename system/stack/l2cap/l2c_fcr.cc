@@ -28,9 +28,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "internal_include/bt_target.h"
+#include "l2cap/fcs.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
+#include "osi/include/properties.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_types.h"
 #include "stack/include/l2c_api.h"
@@ -48,38 +52,10 @@ static const char* SAR_types[] = {"Unsegmented", "Start", "End",
                                   "Continuation"};
 static const char* SUP_types[] = {"RR", "REJ", "RNR", "SREJ"};
 
-/* Look-up table for the CRC calculation */
-static const unsigned short crctab[256] = {
-    0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241, 0xc601,
-    0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440, 0xcc01, 0x0cc0,
-    0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40, 0x0a00, 0xcac1, 0xcb81,
-    0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841, 0xd801, 0x18c0, 0x1980, 0xd941,
-    0x1b00, 0xdbc1, 0xda81, 0x1a40, 0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01,
-    0x1dc0, 0x1c80, 0xdc41, 0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0,
-    0x1680, 0xd641, 0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081,
-    0x1040, 0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
-    0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441, 0x3c00,
-    0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41, 0xfa01, 0x3ac0,
-    0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840, 0x2800, 0xe8c1, 0xe981,
-    0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41, 0xee01, 0x2ec0, 0x2f80, 0xef41,
-    0x2d00, 0xedc1, 0xec81, 0x2c40, 0xe401, 0x24c0, 0x2580, 0xe541, 0x2700,
-    0xe7c1, 0xe681, 0x2640, 0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0,
-    0x2080, 0xe041, 0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281,
-    0x6240, 0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
-    0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41, 0xaa01,
-    0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840, 0x7800, 0xb8c1,
-    0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41, 0xbe01, 0x7ec0, 0x7f80,
-    0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40, 0xb401, 0x74c0, 0x7580, 0xb541,
-    0x7700, 0xb7c1, 0xb681, 0x7640, 0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101,
-    0x71c0, 0x7080, 0xb041, 0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0,
-    0x5280, 0x9241, 0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481,
-    0x5440, 0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
-    0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841, 0x8801,
-    0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40, 0x4e00, 0x8ec1,
-    0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41, 0x4400, 0x84c1, 0x8581,
-    0x4540, 0x8701, 0x47c0, 0x4680, 0x8641, 0x8201, 0x42c0, 0x4380, 0x8341,
-    0x4100, 0x81c1, 0x8081, 0x4040,
-};
+/* Acknowledgement coalescing, see l2c_fcr_max_held_acks() */
+static const char* kPropertyMaxHeldAcks = "bluetooth.l2cap.ertm.max_held_acks";
+static const char* kPropertyAckTimeoutMs =
+    "bluetooth.l2cap.ertm.ack_timeout_ms";
 
 /*******************************************************************************
  *  Static local functions
@@ -93,27 +69,22 @@ static void prepare_I_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf,
                             bool is_retransmission);
 static bool do_sar_reassembly(tL2C_CCB* p_ccb, BT_HDR* p_buf,
                               uint16_t ctrl_word);
+static void send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
+                         uint16_t pf_bit, uint8_t req_seq);
 
 /*******************************************************************************
  *
  * Function         l2c_fcr_updcrc
  *
- * Description      This function computes the CRC using the look-up table.
+ * Description      This function computes the CRC, several bytes at a time,
+ *                  with the implementation shared with the gd stack.
  *
  * Returns          CRC
  *
  ******************************************************************************/
 static unsigned short l2c_fcr_updcrc(unsigned short icrc, unsigned char* icp,
                                      int icnt) {
-  unsigned short crc = icrc;
-  unsigned char* cp = icp;
-  int cnt = icnt;
-
-  while (cnt--) {
-    crc = ((crc >> 8) & 0xff) ^ crctab[(crc & 0xff) ^ *cp++];
-  }
-
-  return (crc);
+  return bluetooth::l2cap::Fcs::Update(icrc, icp, icnt);
 }
 
 /*******************************************************************************
@@ -274,6 +245,45 @@ bool l2c_fcr_is_flow_controlled(tL2C_CCB* p_ccb) {
   return (false);
 }
 
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_max_held_acks
+ *
+ * Description      Number of received I-frames for which sending an RR can be
+ *                  delayed, for a transmit window of tx_win_sz frames. It is a
+ *                  third of the window unless the
+ *                  bluetooth.l2cap.ertm.max_held_acks property sets it.
+ *
+ * Returns          uint8_t
+ *
+ ******************************************************************************/
+uint8_t l2c_fcr_max_held_acks(uint8_t tx_win_sz) {
+  static const int32_t max_held_acks =
+      osi_property_get_int32(kPropertyMaxHeldAcks, -1);
+
+  if (max_held_acks < 0) return tx_win_sz / 3;
+
+  /* Holding a whole window would stall the peer until the ack timer expires */
+  if (tx_win_sz == 0) return 0;
+  return std::min<int32_t>(max_held_acks, tx_win_sz - 1);
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_ack_timeout_ms
+ *
+ * Description      How long an RR for received I-frames can be delayed
+ *
+ * Returns          uint64_t
+ *
+ ******************************************************************************/
+static uint64_t l2c_fcr_ack_timeout_ms() {
+  static const int32_t ack_timeout_ms =
+      osi_property_get_int32(kPropertyAckTimeoutMs, L2CAP_FCR_ACK_TIMEOUT_MS);
+
+  return ack_timeout_ms > 0 ? ack_timeout_ms : L2CAP_FCR_ACK_TIMEOUT_MS;
+}
+
 /*******************************************************************************
  *
  * Function         prepare_I_frame
@@ -304,12 +314,14 @@ static void prepare_I_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf,
     STREAM_TO_UINT16(ctrl_word, p);
 
     ctrl_word &= ~(L2CAP_FCR_REQ_SEQ_BITS + L2CAP_FCR_F_BIT);
+    p_fcrb->stats.i_frames_retransmitted++;
   } else {
     ctrl_word = p_buf->layer_specific & L2CAP_FCR_SEG_BITS; /* SAR bits */
     ctrl_word |=
         (p_fcrb->next_tx_seq << L2CAP_FCR_TX_SEQ_BITS_SHIFT); /* Tx Seq */
 
     p_fcrb->next_tx_seq = (p_fcrb->next_tx_seq + 1) & L2CAP_FCR_SEQ_MODULO;
+    p_fcrb->stats.i_frames_sent++;
   }
 
   /* Set the F-bit and reqseq only if using re-transmission mode */
@@ -384,6 +396,22 @@ static void prepare_I_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf,
 void l2c_fcr_send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
                           uint16_t pf_bit) {
   CHECK(p_ccb != NULL);
+  send_S_frame(p_ccb, function_code, pf_bit, p_ccb->fcrb.next_seq_expected);
+}
+
+/*******************************************************************************
+ *
+ * Function         send_S_frame
+ *
+ * Description      This function formats and sends an S-frame with the given
+ *                  receive sequence number. Only an SREJ may carry another
+ *                  sequence number than the next one expected.
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+static void send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
+                         uint16_t pf_bit, uint8_t req_seq) {
   uint8_t* p;
   uint16_t ctrl_word;
   uint16_t fcs;
@@ -399,9 +427,22 @@ void l2c_fcr_send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
 
   /* Create the control word to use */
   ctrl_word = (function_code << L2CAP_FCR_SUP_SHIFT) | L2CAP_FCR_S_FRAME_BIT;
-  ctrl_word |= (p_ccb->fcrb.next_seq_expected << L2CAP_FCR_REQ_SEQ_BITS_SHIFT);
+  ctrl_word |= (req_seq << L2CAP_FCR_REQ_SEQ_BITS_SHIFT);
   ctrl_word |= pf_bit;
 
+  switch (function_code) {
+    case L2CAP_FCR_SUP_RR:
+    case L2CAP_FCR_SUP_RNR:
+      p_ccb->fcrb.stats.acks_sent++;
+      break;
+    case L2CAP_FCR_SUP_REJ:
+      p_ccb->fcrb.stats.rej_frames_sent++;
+      break;
+    case L2CAP_FCR_SUP_SREJ:
+      p_ccb->fcrb.stats.srej_frames_sent++;
+      break;
+  }
+
   BT_HDR* p_buf = (BT_HDR*)osi_malloc(L2CAP_CMD_BUF_SIZE);
   p_buf->offset = HCI_DATA_PREAMBLE_SIZE;
   p_buf->len = L2CAP_PKT_OVERHEAD + L2CAP_FCR_OVERHEAD;
@@ -449,6 +490,9 @@ void l2c_fcr_send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
 
   l2c_link_check_send_pkts(p_ccb->p_lcb, 0, p_buf);
 
+  /* An SREJ for a frame after the first lost one does not ack anything */
+  if (req_seq != p_ccb->fcrb.next_seq_expected) return;
+
   p_ccb->fcrb.last_ack_sent = p_ccb->fcrb.next_seq_expected;
 
   alarm_cancel(p_ccb->fcrb.ack_timer);
@@ -813,7 +857,9 @@ void l2c_fcr_proc_ack_tout(tL2C_CCB* p_ccb) {
       p_ccb->local_cid, p_ccb->chnl_state, p_ccb->fcrb.wait_ack,
       p_ccb->fcrb.next_seq_expected, p_ccb->fcrb.last_ack_sent);
 
+  /* Frames received during SREJ recovery are acked when it is over */
   if ((p_ccb->chnl_state == CST_OPEN) && (!p_ccb->fcrb.wait_ack) &&
+      (!p_ccb->fcrb.srej_sent) &&
       (p_ccb->fcrb.last_ack_sent != p_ccb->fcrb.next_seq_expected)) {
     l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_RR, 0);
   }
@@ -1079,8 +1125,9 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
             p_ccb->local_cid, tx_seq, p_fcrb->next_seq_expected,
             p_fcrb->rej_sent);
 
-        /* If only one lost, we will send SREJ, otherwise we will send REJ */
-        if (num_lost > 1) {
+        /* If only a few lost, we will send an SREJ for each of them,
+         * otherwise we will send REJ */
+        if (num_lost > L2CAP_FCR_MAX_SREJ_LOST) {
           osi_free(p_buf);
           p_fcrb->rej_sent = true;
           l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_REJ, 0);
@@ -1095,7 +1142,10 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
           p_buf->layer_specific = tx_seq;
           fixed_queue_enqueue(p_fcrb->srej_rcv_hold_q, p_buf);
           p_fcrb->srej_sent = true;
-          l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_SREJ, 0);
+          for (uint8_t lost_seq = p_fcrb->next_seq_expected; lost_seq != tx_seq;
+               lost_seq = (lost_seq + 1) & L2CAP_FCR_SEQ_MODULO) {
+            send_S_frame(p_ccb, L2CAP_FCR_SUP_SREJ, 0, lost_seq);
+          }
         }
         alarm_cancel(p_ccb->fcrb.ack_timer);
       }
@@ -1105,12 +1155,22 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
 
   /* Seq number is the next expected. Clear possible reject exception in case it
    * occured */
-  p_fcrb->rej_sent = p_fcrb->srej_sent = false;
+  p_fcrb->rej_sent = false;
 
   /* Adjust the next_seq, so that if the upper layer sends more data in the
      callback
      context, the received frame is acked by an I-frame. */
   p_fcrb->next_seq_expected = (tx_seq + 1) & L2CAP_FCR_SEQ_MODULO;
+  p_fcrb->stats.i_frames_received++;
+
+  /* The SREJ exception is over once all the frames before the held ones were
+   * received */
+  if (p_fcrb->srej_sent) {
+    BT_HDR* p_held =
+        (BT_HDR*)fixed_queue_try_peek_first(p_fcrb->srej_rcv_hold_q);
+    p_fcrb->srej_sent = (p_held != NULL) &&
+                        (p_held->layer_specific != p_fcrb->next_seq_expected);
+  }
 
   /* If any SAR problem in eRTM mode, spec says disconnect. */
   if (!do_sar_reassembly(p_ccb, p_buf, ctrl_word)) {
@@ -1134,7 +1194,7 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
     if (delay_ack) {
       /* If it is the first I frame we did not ack, start ack timer */
       if (!alarm_is_scheduled(p_ccb->fcrb.ack_timer)) {
-        alarm_set_on_mloop(p_ccb->fcrb.ack_timer, L2CAP_FCR_ACK_TIMEOUT_MS,
+        alarm_set_on_mloop(p_ccb->fcrb.ack_timer, l2c_fcr_ack_timeout_ms(),
                            l2c_fcrb_ack_timer_timeout, p_ccb);
       }
     } else if ((fixed_queue_is_empty(p_ccb->xmit_hold_q) ||
@@ -1256,6 +1316,25 @@ static bool do_sar_reassembly(tL2C_CCB* p_ccb, BT_HDR* p_buf,
   return (packet_ok);
 }
 
+/*******************************************************************************
+ *
+ * Function         get_i_frame_tx_seq
+ *
+ * Description      This function reads the sequence number of an I-frame
+ *                  saved for retransmission.
+ *
+ * Returns          uint8_t
+ *
+ ******************************************************************************/
+static uint8_t get_i_frame_tx_seq(const BT_HDR* p_buf) {
+  const uint8_t* p =
+      ((const uint8_t*)(p_buf + 1)) + p_buf->offset + L2CAP_PKT_OVERHEAD;
+  uint16_t ctrl_word;
+
+  STREAM_TO_UINT16(ctrl_word, p);
+  return (ctrl_word & L2CAP_FCR_TX_SEQ_BITS) >> L2CAP_FCR_TX_SEQ_BITS_SHIFT;
+}
+
 /*******************************************************************************
  *
  * Function         retransmit_i_frames
@@ -1269,9 +1348,9 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
   CHECK(p_ccb != NULL);
 
   BT_HDR* p_buf = NULL;
-  uint8_t* p;
   uint8_t buf_seq;
-  uint16_t ctrl_word;
+  /* Copies still in the retransmission queue, by sequence number */
+  BT_HDR* p_queued[L2CAP_FCR_SEQ_MODULO + 1] = {};
 
   if ((!fixed_queue_is_empty(p_ccb->fcrb.waiting_for_ack_q)) &&
       (p_ccb->peer_cfg.fcr.max_transmit != 0) &&
@@ -1301,13 +1380,7 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
     if (list_ack != NULL) {
       for (; node_ack != list_end(list_ack); node_ack = list_next(node_ack)) {
         p_buf = (BT_HDR*)list_node(node_ack);
-        /* Get the old control word */
-        p = ((uint8_t*)(p_buf + 1)) + p_buf->offset + L2CAP_PKT_OVERHEAD;
-
-        STREAM_TO_UINT16(ctrl_word, p);
-
-        buf_seq =
-            (ctrl_word & L2CAP_FCR_TX_SEQ_BITS) >> L2CAP_FCR_TX_SEQ_BITS_SHIFT;
+        buf_seq = get_i_frame_tx_seq(p_buf);
 
         LOG_VERBOSE("retransmit_i_frames()   cur seq: %u  looking for: %u",
                     buf_seq, tx_seq);
@@ -1321,6 +1394,18 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
                 fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q));
       return (true);
     }
+
+    /* Nothing to copy if the frame is still waiting to be retransmitted, its
+     * ReqSeq and F-bit are rewritten when it is sent */
+    list_t* list_retrans = fixed_queue_get_list(p_ccb->fcrb.retrans_q);
+    for (const list_node_t* node = list_begin(list_retrans);
+         node != list_end(list_retrans); node = list_next(node)) {
+      if (get_i_frame_tx_seq((BT_HDR*)list_node(node)) == tx_seq) {
+        LOG_VERBOSE("retransmit_i_frames() seq: %u already queued", tx_seq);
+        node_ack = list_end(list_ack);
+        break;
+      }
+    }
   } else {
     // Iterate though list and flush the amount requested from
     // the transmit data queue that satisfy the layer and event conditions.
@@ -1336,9 +1421,14 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
       }
     }
 
-    /* Also flush our retransmission queue */
-    while (!fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
-      osi_free(fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q));
+    /* Our retransmission queue is rebuilt in order, keeping the copies of the
+     * frames that were not sent yet */
+    while (!fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+      BT_HDR* p_tmp = (BT_HDR*)fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q);
+      buf_seq = get_i_frame_tx_seq(p_tmp);
+      osi_free(p_queued[buf_seq]);
+      p_queued[buf_seq] = p_tmp;
+    }
 
     if (list_ack != NULL) node_ack = list_begin(list_ack);
   }
@@ -1348,7 +1438,12 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
       p_buf = (BT_HDR*)list_node(node_ack);
       node_ack = list_next(node_ack);
 
-      BT_HDR* p_buf2 = l2c_fcr_clone_buf(p_buf, p_buf->offset, p_buf->len);
+      buf_seq = get_i_frame_tx_seq(p_buf);
+      BT_HDR* p_buf2 = p_queued[buf_seq];
+      p_queued[buf_seq] = NULL;
+      if (p_buf2 == NULL) {
+        p_buf2 = l2c_fcr_clone_buf(p_buf, p_buf->offset, p_buf->len);
+      }
       if (p_buf2) {
         p_buf2->layer_specific = p_buf->layer_specific;
 
@@ -1357,12 +1452,21 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
 
       if ((tx_seq != L2C_FCR_RETX_ALL_PKTS) || (p_buf2 == NULL)) break;
     }
+    l2cu_ccb_data_queued(p_ccb);
   }
 
+  /* Copies of frames acked since they were queued */
+  for (BT_HDR* p_tmp : p_queued) osi_free(p_tmp);
+
   l2c_link_check_send_pkts(p_ccb->p_lcb, 0, NULL);
 
   if (fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q)) {
-    p_ccb->fcrb.num_tries++;
+    /* The SREJs sent by the peer for several lost frames count as a single
+     * try, the one of the oldest unacked frame */
+    if ((tx_seq == L2C_FCR_RETX_ALL_PKTS) ||
+        (tx_seq == p_ccb->fcrb.last_rx_ack)) {
+      p_ccb->fcrb.num_tries++;
+    }
     l2c_fcr_start_timer(p_ccb);
   }
 
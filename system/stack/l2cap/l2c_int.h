@@ -31,6 +31,7 @@
 
 #include "internal_include/bt_target.h"
 #include "l2c_api.h"
+#include "l2cap/le_credit_policy.h"
 #include "l2cdefs.h"
 #include "macros.h"
 #include "osi/include/alarm.h"
@@ -39,6 +40,7 @@
 #include "stack/include/bt_hdr.h"
 #include "stack/include/btm_sec_api_types.h"
 #include "stack/include/hci_error_code.h"
+#include "stack/include/hcidefs.h"
 #include "types/hci_role.h"
 #include "types/raw_address.h"
 
@@ -66,6 +68,10 @@ constexpr uint16_t L2CAP_CREDIT_BASED_MIN_MPS = 64;
 #define L2CAP_BLE_LINK_CONNECT_TIMEOUT_MS (30 * 1000)  /* 30 seconds */
 #define L2CAP_FCR_ACK_TIMEOUT_MS 200                   /* 200 milliseconds */
 
+/* Most consecutive I-frames recovered with one SREJ each before a REJ is
+ * sent to have the peer go back to the first lost frame */
+#define L2CAP_FCR_MAX_SREJ_LOST 4
+
 /* Define the possible L2CAP channel states. The names of
  * the states may seem a bit strange, but they are taken from
  * the Bluetooth specification.
@@ -128,6 +134,33 @@ inline std::string link_state_text(const tL2C_LINK_STATE& state) {
   }
 }
 
+/* Why a link got its ACL buffer quota, shown in dumpsys
+*/
+typedef enum : uint8_t {
+  L2C_QUOTA_STATIC,        /* Equal share of the low priority buffers */
+  L2C_QUOTA_HIGH_PRIORITY, /* High priority link */
+  L2C_QUOTA_ROUND_ROBIN,   /* Not enough buffers for one per link */
+  L2C_QUOTA_IDLE,          /* No traffic, the minimum of one buffer */
+  L2C_QUOTA_DEMAND,        /* Share following the measured traffic */
+} tL2C_QUOTA_REASON;
+
+inline std::string quota_reason_text(const tL2C_QUOTA_REASON& reason) {
+  switch (reason) {
+    case L2C_QUOTA_STATIC:
+      return std::string("static");
+    case L2C_QUOTA_HIGH_PRIORITY:
+      return std::string("high_priority");
+    case L2C_QUOTA_ROUND_ROBIN:
+      return std::string("round_robin");
+    case L2C_QUOTA_IDLE:
+      return std::string("idle");
+    case L2C_QUOTA_DEMAND:
+      return std::string("demand");
+    default:
+      return std::string("UNKNOWN");
+  }
+}
+
 /* Define input events to the L2CAP link and channel state machines. The names
  * of the events may seem a bit strange, but they are taken from
  * the Bluetooth specification.
@@ -244,6 +277,15 @@ typedef struct {
   alarm_t* ack_timer;         /* Timer delaying RR */
   alarm_t* mon_retrans_timer; /* Timer Monitor or Retransmission */
 
+  struct {
+    uint32_t i_frames_sent;          /* I-frames sent for the first time */
+    uint32_t i_frames_retransmitted; /* I-frames sent again */
+    uint32_t i_frames_received;      /* I-frames received in sequence */
+    uint32_t acks_sent;              /* RR and RNR S-frames sent */
+    uint32_t srej_frames_sent;       /* SREJ S-frames sent */
+    uint32_t rej_frames_sent;        /* REJ S-frames sent */
+  } stats;
+
 } tL2C_FCRB;
 
 typedef struct {
@@ -289,6 +331,9 @@ typedef struct t_l2c_ccb {
   uint16_t ble_sdu_length; /* Length of unassembled sdu length*/
   struct t_l2c_ccb* p_next_ccb; /* Next CCB in the chain */
   struct t_l2c_ccb* p_prev_ccb; /* Previous CCB in the chain */
+  struct t_l2c_ccb* p_next_ready; /* Next CCB in the ready list */
+  struct t_l2c_ccb* p_prev_ready; /* Previous CCB in the ready list */
+  bool in_ready_list;             /* true while in the ready list of its LCB */
   struct t_l2c_linkcb* p_lcb;   /* Link this CCB is assigned to */
 
   uint16_t local_cid;  /* Local CID */
@@ -343,6 +388,9 @@ typedef struct t_l2c_ccb {
    * remote). Valid only for LE CoC */
   uint16_t remote_credit_count;
 
+  /* Decides when credits are returned to the remote. Valid only for LE CoC */
+  bluetooth::l2cap::LeCreditPolicy le_credit_policy;
+
   /* used to indicate that ECOC is used */
   bool ecoc{false};
   bool reconfig_started;
@@ -366,6 +414,11 @@ typedef struct t_l2c_ccb {
         }
       } rx, tx;
     } dropped;
+    /* Times the channel had data queued but could not be served */
+    struct {
+      unsigned no_credits{0};      /* LE CoC without credits from the peer */
+      unsigned flow_controlled{0}; /* eL2CAP waiting for acks or remote busy */
+    } starved;
   } metrics;
 
 } tL2C_CCB;
@@ -390,13 +443,18 @@ typedef struct {
  * sure that low priority channel (for example, HF signaling on RFCOMM) can be
  * sent to the headset even if higher priority channel (for example, AV media
  * channel) is congested.
+ *
+ * Only the channels with queued data are on the ready list of their group.
+ * They are served from its front and moved to its back, so finding the next
+ * channel to serve does not walk the idle channels of the link.
  */
 
 typedef struct {
-  tL2C_CCB* p_serve_ccb; /* current serving ccb within priority group */
-  tL2C_CCB* p_first_ccb; /* first ccb of priority group */
-  uint8_t num_ccb;       /* number of channels in priority group */
-  uint8_t quota;         /* burst transmission quota */
+  tL2C_CCB* p_first_ready; /* next ccb of priority group to serve */
+  tL2C_CCB* p_last_ready;  /* last ccb of priority group to serve */
+  uint8_t num_ready;       /* number of channels in the ready list */
+  uint8_t num_ccb;         /* number of channels in priority group */
+  uint8_t quota;           /* burst transmission quota */
 } tL2C_RR_SERV;
 
 typedef enum : uint8_t {
@@ -410,6 +468,36 @@ typedef enum : uint8_t {
   L2C_BLE_NOT_DEFAULT_PARAM = (1u << 3),
 } tCONN_UPDATE_MASK;
 
+/* Traffic class of an LE link, from the least to the most demanding */
+typedef enum : uint8_t {
+  L2C_BLE_TRAFFIC_IDLE = 0,
+  /* small and frequent packets, e.g. audio control or HID over GATT */
+  L2C_BLE_TRAFFIC_CONTROL,
+  /* large transfers over ATT or LE CoC */
+  L2C_BLE_TRAFFIC_BULK,
+} tL2C_BLE_TRAFFIC_CLASS;
+
+/* The LE link optimizer follows the traffic of the link and negotiates the
+ * data length, PHY and connection parameters that suit it. */
+typedef struct {
+  alarm_t* timer;
+  uint32_t bytes;   /* traffic of the current period */
+  uint16_t packets;
+  uint8_t quiet_periods; /* periods with less traffic than the class */
+  tL2C_BLE_TRAFFIC_CLASS traffic_class;
+
+  /* the connection parameters were requested by a profile or by the peer, and
+   * are left alone */
+  bool conn_params_pinned;
+  bool conn_params_changed;
+  bool phy_2m_requested;
+  /* connection parameters to go back to when the traffic subsides */
+  uint16_t min_interval;
+  uint16_t max_interval;
+  uint16_t latency;
+  uint16_t timeout;
+} tL2C_BLE_LINK_OPT;
+
 /* Define a link control block. There is one link control block between
  * this device and any other device (i.e. BD ADDR).
 */
@@ -439,6 +527,7 @@ typedef struct t_l2c_linkcb {
   tL2C_CCB* p_pending_ccb;  /* ccb of waiting channel during link disconnect */
   alarm_t* info_resp_timer; /* Timer entry for info resp timeout evt */
   RawAddress remote_bd_addr; /* The BD address of the remote */
+  uint16_t next_by_addr; /* Next LCB in the same l2cb.lcb_by_addr bucket */
 
  private:
   tHCI_ROLE link_role_{HCI_ROLE_CENTRAL}; /* Central or peripheral */
@@ -472,6 +561,11 @@ typedef struct t_l2c_linkcb {
       sent_not_acked = 0;
   }
 
+  /* Traffic measured for the dynamic ACL buffer quotas */
+  uint16_t quota_acked;  /* Packets completed in the current period */
+  uint32_t quota_demand; /* Smoothed packets per period, in 1/16 of packet */
+  tL2C_QUOTA_REASON quota_reason;
+
   bool w4_info_rsp;                /* true when info request is active */
   uint32_t peer_ext_fea;           /* Peer's extended features mask */
   list_t* link_xmit_data_q;        /* Link transmit data buffer queue */
@@ -546,6 +640,8 @@ typedef struct t_l2c_linkcb {
 
   uint8_t subrate_req_mask;
 
+  tL2C_BLE_LINK_OPT link_opt;
+
   /* each priority group is limited burst transmission */
   /* round robin service for the same priority channels */
   tL2C_RR_SERV rr_serv[L2CAP_NUM_CHNL_PRIORITY];
@@ -575,6 +671,15 @@ typedef struct t_l2c_linkcb {
   }
 } tL2C_LCB;
 
+/* Buckets of the BD address to LCB hash, a power of two */
+#ifndef L2C_LCB_ADDR_HASH_SIZE
+#define L2C_LCB_ADDR_HASH_SIZE 64
+#endif
+static_assert((L2C_LCB_ADDR_HASH_SIZE & (L2C_LCB_ADDR_HASH_SIZE - 1)) == 0,
+              "L2C_LCB_ADDR_HASH_SIZE must be a power of two");
+static_assert(L2C_LCB_ADDR_HASH_SIZE >= MAX_L2CAP_LINKS,
+              "L2C_LCB_ADDR_HASH_SIZE must not be below MAX_L2CAP_LINKS");
+
 /* Define the L2CAP control structure
 */
 typedef struct {
@@ -594,12 +699,22 @@ typedef struct {
 
   bool check_round_robin;       /* Do a round robin check */
 
+  /* Low priority quotas follow the traffic of the links, rebalanced every
+   * L2C_DYN_QUOTA_PERIOD_MS */
+  bool dynamic_acl_quota;
+  uint64_t dyn_quota_period_start_ms;
+
   bool is_cong_cback_context;
 
   tL2C_LCB lcb_pool[MAX_L2CAP_LINKS];    /* Link Control Block pool */
   tL2C_CCB ccb_pool[MAX_L2CAP_CHANNELS]; /* Channel Control Block pool */
   tL2C_RCB rcb_pool[MAX_L2CAP_CLIENTS];  /* Registration info pool */
 
+  /* LCB lookup tables, kept by l2c_utils.cc. An entry is 1 + the index of the
+   * LCB in lcb_pool, 0 when there is none */
+  uint16_t lcb_by_handle[HCI_HANDLE_MAX + 1];
+  uint16_t lcb_by_addr[L2C_LCB_ADDR_HASH_SIZE]; /* Chained by next_by_addr */
+
   tL2C_CCB* p_free_ccb_first; /* Pointer to first free CCB */
   tL2C_CCB* p_free_ccb_last;  /* Pointer to last  free CCB */
 
@@ -676,6 +791,18 @@ typedef void(tL2C_FCR_MGMT_EVT_HDLR)(uint8_t, tL2C_CCB*);
 */
 #define L2CAP_HIGH_PRI_MIN_XMIT_QUOTA_A (L2CAP_HIGH_PRI_MIN_XMIT_QUOTA)
 
+/* Period over which the traffic of the links is measured, for the dynamic ACL
+ * buffer quotas
+*/
+#ifndef L2C_DYN_QUOTA_PERIOD_MS
+#define L2C_DYN_QUOTA_PERIOD_MS 500
+#endif
+
+/* Dynamic quotas are only changed when a link would gain or lose a quarter of
+ * its quota, and at least this many buffers
+*/
+#define L2C_DYN_QUOTA_MIN_CHANGE 2
+
 /* L2CAP global data
  ***********************************
 */
@@ -694,6 +821,7 @@ uint8_t l2c_data_write(uint16_t cid, BT_HDR* p_data, uint16_t flag);
 tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
                             tBT_TRANSPORT transport);
 void l2cu_release_lcb(tL2C_LCB* p_lcb);
+void l2cu_set_lcb_bd_addr(tL2C_LCB* p_lcb, const RawAddress& bd_addr);
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport);
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle);
@@ -704,6 +832,8 @@ bool l2cu_set_acl_latency(const RawAddress& bd_addr, tL2CAP_LATENCY latency);
 
 void l2cu_enqueue_ccb(tL2C_CCB* p_ccb);
 void l2cu_dequeue_ccb(tL2C_CCB* p_ccb);
+void l2cu_ccb_data_queued(tL2C_CCB* p_ccb);
+void l2cu_remove_ready_ccb(tL2C_CCB* p_ccb);
 void l2cu_change_pri_ccb(tL2C_CCB* p_ccb, tL2CAP_CHNL_PRIORITY priority);
 
 tL2C_CCB* l2cu_allocate_ccb(tL2C_LCB* p_lcb, uint16_t cid,
@@ -733,6 +863,7 @@ void l2cu_reject_connection(tL2C_LCB* p_lcb, uint16_t remote_cid,
 void l2cu_send_peer_info_req(tL2C_LCB* p_lcb, uint16_t info_type);
 void l2cu_set_acl_hci_header(BT_HDR* p_buf, tL2C_CCB* p_ccb);
 void l2cu_check_channel_congestion(tL2C_CCB* p_ccb);
+uint16_t l2cu_get_tx_room(const tL2C_CCB* p_ccb);
 void l2cu_disconnect_chnl(tL2C_CCB* p_ccb);
 
 void l2cu_send_peer_ble_par_req(tL2C_LCB* p_lcb, uint16_t min_int,
@@ -802,6 +933,8 @@ void l2c_info_resp_timer_timeout(void* data);
 void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
                               BT_HDR* p_buf);
 void l2c_link_adjust_allocation(void);
+void l2c_link_split_quota(uint16_t total, const uint32_t* demand,
+                          uint16_t* quota, uint16_t num_links);
 
 void l2c_link_sec_comp(const RawAddress* p_bda, tBT_TRANSPORT trasnport,
                        void* p_ref_data, tBTM_STATUS status);
@@ -845,6 +978,7 @@ bool l2c_fcr_renegotiate_chan(tL2C_CCB* p_ccb, tL2CAP_CFG_INFO* p_cfg);
 uint8_t l2c_fcr_process_peer_cfg_req(tL2C_CCB* p_ccb, tL2CAP_CFG_INFO* p_cfg);
 void l2c_fcr_adj_monitor_retran_timeout(tL2C_CCB* p_ccb);
 void l2c_fcr_stop_timer(tL2C_CCB* p_ccb);
+uint8_t l2c_fcr_max_held_acks(uint8_t tx_win_sz);
 
 /* Functions provided by l2c_ble.cc
  ***********************************
@@ -864,6 +998,11 @@ tL2CAP_LE_RESULT_CODE l2ble_sec_access_req(const RawAddress& bd_addr,
 
 void l2cble_update_data_length(tL2C_LCB* p_lcb);
 
+void l2cble_link_opt_start(tL2C_LCB* p_lcb);
+void l2cble_link_opt_stop(tL2C_LCB* p_lcb);
+void l2cble_link_opt_traffic(tL2C_LCB* p_lcb, uint16_t cid, uint16_t len);
+tL2C_BLE_TRAFFIC_CLASS l2cble_link_opt_next_class(tL2C_BLE_LINK_OPT* p_opt);
+
 void l2cu_process_fixed_disc_cback(tL2C_LCB* p_lcb);
 
 void l2cble_process_subrate_change_evt(uint16_t handle, uint8_t status,
@@ -25,8 +25,10 @@
  ******************************************************************************/
 #define LOG_TAG "l2c_link"
 
+#include <algorithm>
 #include <cstdint>
 
+#include "common/time_util.h"
 #include "device/include/device_iot_config.h"
 #include "internal_include/bt_target.h"
 #include "os/log.h"
@@ -520,20 +522,76 @@ void l2c_info_resp_timer_timeout(void* data) {
 
 /*******************************************************************************
  *
- * Function         l2c_link_adjust_allocation
+ * Function         l2c_link_split_quota
  *
- * Description      This function is called when a link is created or removed
- *                  to calculate the amount of packets each link may send to
- *                  the HCI without an ack coming back.
+ * Description      Split total buffers between num_links links, in proportion
+ *                  to their demand. Each link gets at least one buffer, and
+ *                  links get equal shares when none has any demand. total
+ *                  must not be below num_links.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2c_link_split_quota(uint16_t total, const uint32_t* demand,
+                          uint16_t* quota, uint16_t num_links) {
+  if (num_links == 0) return;
+
+  uint64_t total_demand = 0;
+  for (uint16_t i = 0; i < num_links; i++) total_demand += demand[i];
+
+  uint16_t spare = total - num_links;
+  if (total_demand == 0) {
+    for (uint16_t i = 0; i < num_links; i++) {
+      quota[i] = 1 + spare / num_links + (i < spare % num_links ? 1 : 0);
+    }
+    return;
+  }
+
+  uint16_t left = spare;
+  for (uint16_t i = 0; i < num_links; i++) {
+    uint16_t share = (uint16_t)((uint64_t{spare} * demand[i]) / total_demand);
+    quota[i] = 1 + share;
+    left -= share;
+  }
+
+  /* What rounding left goes to the links with the largest remainders */
+  bool got_left[MAX_L2CAP_LINKS] = {};
+  while (left > 0) {
+    uint16_t best = num_links;
+    uint64_t best_remainder = 0;
+    for (uint16_t i = 0; i < num_links; i++) {
+      uint64_t remainder = (uint64_t{spare} * demand[i]) % total_demand;
+      if (!got_left[i] && (best == num_links || remainder > best_remainder)) {
+        best = i;
+        best_remainder = remainder;
+      }
+    }
+    if (best == num_links) break;
+    got_left[best] = true;
+    quota[best]++;
+    left--;
+  }
+}
+
+/* Whether a link takes ACL buffers from the BR/EDR pool */
+static bool l2c_link_uses_acl_bufs(const tL2C_LCB* p_lcb) {
+  bool is_share_buffer = (l2cb.num_lm_ble_bufs == L2C_DEF_NUM_BLE_BUF_SHARED);
+  return p_lcb->in_use &&
+         (is_share_buffer || p_lcb->transport != BT_TRANSPORT_LE);
+}
+
+/*******************************************************************************
  *
- *                  Currently, this is a simple allocation, dividing the
- *                  number of Controller Packets by the number of links. In
- *                  the future, QOS configuration should be examined.
+ * Function         l2c_link_adjust_allocation_internal
+ *
+ * Description      Work out the quota of each link. When periodic, dynamic
+ *                  quotas stay as they are unless a link would gain or lose a
+ *                  significant part of its quota.
  *
  * Returns          void
  *
  ******************************************************************************/
-void l2c_link_adjust_allocation(void) {
+static void l2c_link_adjust_allocation_internal(bool periodic) {
   uint16_t qq, yy, qq_remainder;
   tL2C_LCB* p_lcb;
   uint16_t hi_quota, low_quota;
@@ -541,8 +599,6 @@ void l2c_link_adjust_allocation(void) {
   uint16_t num_hipri_links = 0;
   uint16_t controller_xmit_quota = l2cb.num_lm_acl_bufs;
   uint16_t high_pri_link_quota = L2CAP_HIGH_PRI_MIN_XMIT_QUOTA_A;
-  bool is_share_buffer =
-      (l2cb.num_lm_ble_bufs == L2C_DEF_NUM_BLE_BUF_SHARED) ? true : false;
 
   /* If no links active, reset buffer quotas and controller buffers */
   if (l2cb.num_used_lcbs == 0) {
@@ -553,8 +609,7 @@ void l2c_link_adjust_allocation(void) {
 
   /* First, count the links */
   for (yy = 0, p_lcb = &l2cb.lcb_pool[0]; yy < MAX_L2CAP_LINKS; yy++, p_lcb++) {
-    if (p_lcb->in_use &&
-        (is_share_buffer || p_lcb->transport != BT_TRANSPORT_LE)) {
+    if (l2c_link_uses_acl_bufs(p_lcb)) {
       if (p_lcb->acl_priority == L2CAP_PRIORITY_HIGH)
         num_hipri_links++;
       else
@@ -594,17 +649,60 @@ void l2c_link_adjust_allocation(void) {
     qq = qq_remainder = 1;
   }
 
+  /* Split the low priority buffers following the traffic of the links */
+  bool dynamic = l2cb.dynamic_acl_quota && num_lowpri_links > 0 &&
+                 num_lowpri_links <= low_quota;
+  uint16_t dyn_quota[MAX_L2CAP_LINKS] = {};
+  uint32_t demand[MAX_L2CAP_LINKS] = {};
+  uint64_t total_demand = 0;
+  if (dynamic) {
+    uint16_t nn = 0;
+    for (yy = 0, p_lcb = &l2cb.lcb_pool[0]; yy < MAX_L2CAP_LINKS;
+         yy++, p_lcb++) {
+      if (l2c_link_uses_acl_bufs(p_lcb) && !p_lcb->is_high_priority()) {
+        demand[nn++] = p_lcb->quota_demand;
+        total_demand += p_lcb->quota_demand;
+      }
+    }
+    l2c_link_split_quota(low_quota, demand, dyn_quota, nn);
+  }
+
+  /* Leave dynamic quotas alone while the traffic only changes a little */
+  if (dynamic && periodic) {
+    bool significant = false;
+    uint16_t nn = 0;
+    for (yy = 0, p_lcb = &l2cb.lcb_pool[0]; yy < MAX_L2CAP_LINKS;
+         yy++, p_lcb++) {
+      if (!l2c_link_uses_acl_bufs(p_lcb) || p_lcb->is_high_priority()) continue;
+      uint16_t current = p_lcb->link_xmit_quota;
+      uint16_t wanted = dyn_quota[nn++];
+      uint16_t change = (wanted > current) ? wanted - current : current - wanted;
+      if (change >= std::max<uint16_t>(L2C_DYN_QUOTA_MIN_CHANGE, current / 4)) {
+        significant = true;
+      }
+    }
+    if (!significant) return;
+  }
+
   LOG_DEBUG(
       "l2c_link_adjust_allocation  num_hipri: %u  num_lowpri: %u  low_quota: "
-      "%u  round_robin_quota: %u  qq: %u",
-      num_hipri_links, num_lowpri_links, low_quota, l2cb.round_robin_quota, qq);
+      "%u  round_robin_quota: %u  qq: %u  dynamic: %d",
+      num_hipri_links, num_lowpri_links, low_quota, l2cb.round_robin_quota, qq,
+      dynamic);
 
   /* Now, assign the quotas to each link */
+  uint16_t nn = 0;
   for (yy = 0, p_lcb = &l2cb.lcb_pool[0]; yy < MAX_L2CAP_LINKS; yy++, p_lcb++) {
-    if (p_lcb->in_use &&
-        (is_share_buffer || p_lcb->transport != BT_TRANSPORT_LE)) {
+    if (l2c_link_uses_acl_bufs(p_lcb)) {
       if (p_lcb->acl_priority == L2CAP_PRIORITY_HIGH) {
         p_lcb->link_xmit_quota = high_pri_link_quota;
+        p_lcb->quota_reason = L2C_QUOTA_HIGH_PRIORITY;
+      } else if (dynamic) {
+        p_lcb->link_xmit_quota = dyn_quota[nn];
+        p_lcb->quota_reason = (total_demand > 0 && demand[nn] == 0)
+                                  ? L2C_QUOTA_IDLE
+                                  : L2C_QUOTA_DEMAND;
+        nn++;
       } else {
         /* Safety check in case we switched to round-robin with something
          * outstanding */
@@ -619,11 +717,16 @@ void l2c_link_adjust_allocation(void) {
           p_lcb->link_xmit_quota++;
           qq_remainder--;
         }
+        p_lcb->quota_reason = (num_lowpri_links > low_quota)
+                                  ? L2C_QUOTA_ROUND_ROBIN
+                                  : L2C_QUOTA_STATIC;
       }
 
       LOG_DEBUG(
-          "l2c_link_adjust_allocation LCB %d   Priority: %d  XmitQuota: %d", yy,
-          p_lcb->acl_priority, p_lcb->link_xmit_quota);
+          "l2c_link_adjust_allocation LCB %d   Priority: %d  XmitQuota: %d  "
+          "Reason: %s",
+          yy, p_lcb->acl_priority, p_lcb->link_xmit_quota,
+          quota_reason_text(p_lcb->quota_reason).c_str());
 
       LOG_DEBUG("        SentNotAcked: %d  RRUnacked: %d",
                 p_lcb->sent_not_acked, l2cb.round_robin_unacked);
@@ -642,6 +745,66 @@ void l2c_link_adjust_allocation(void) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         l2c_link_adjust_allocation
+ *
+ * Description      This function is called when a link is created or removed
+ *                  to calculate the amount of packets each link may send to
+ *                  the HCI without an ack coming back.
+ *
+ *                  High priority links get a fixed quota. The other links
+ *                  share the remaining buffers equally or, when
+ *                  bluetooth.l2cap.dynamic_acl_quota.enabled is set, in
+ *                  proportion to their traffic.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2c_link_adjust_allocation(void) {
+  l2c_link_adjust_allocation_internal(false);
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_link_measure_traffic
+ *
+ * Description      Once per L2C_DYN_QUOTA_PERIOD_MS, fold the packets each
+ *                  link completed and still has queued into its demand, and
+ *                  rebalance the dynamic quotas. Driven by the completed
+ *                  packets, as quotas only matter while there is traffic.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void l2c_link_measure_traffic(void) {
+  if (!l2cb.dynamic_acl_quota) return;
+
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  if (now_ms - l2cb.dyn_quota_period_start_ms < L2C_DYN_QUOTA_PERIOD_MS) {
+    return;
+  }
+  l2cb.dyn_quota_period_start_ms = now_ms;
+
+  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  for (int yy = 0; yy < MAX_L2CAP_LINKS; yy++, p_lcb++) {
+    if (!l2c_link_uses_acl_bufs(p_lcb)) continue;
+
+    uint32_t queued = list_length(p_lcb->link_xmit_data_q);
+    for (const tL2C_CCB* p_ccb = p_lcb->ccb_queue.p_first_ccb; p_ccb != NULL;
+         p_ccb = p_ccb->p_next_ccb) {
+      queued += fixed_queue_length(p_ccb->xmit_hold_q);
+    }
+
+    /* Exponential average, a quarter of the weight on the last period */
+    uint32_t sample = 16 * (p_lcb->quota_acked + queued);
+    p_lcb->quota_demand = (3 * p_lcb->quota_demand + sample) / 4;
+    p_lcb->quota_acked = 0;
+  }
+
+  l2c_link_adjust_allocation_internal(true);
+}
+
 /*******************************************************************************
  *
  * Function         l2c_link_adjust_chnl_allocation
@@ -1020,6 +1183,8 @@ void l2c_packets_completed(uint16_t handle, uint16_t num_sent) {
     return;
   }
   p_lcb->update_outstanding_packets(num_sent);
+  p_lcb->quota_acked += num_sent;
+  l2c_link_measure_traffic();
 
   switch (p_lcb->transport) {
     case BT_TRANSPORT_BR_EDR:
@@ -1141,33 +1306,23 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
 
   /* scan all of priority until finding a channel to serve */
   for (i = 0; (i < L2CAP_NUM_CHNL_PRIORITY) && (!p_serve_ccb); i++) {
-    /* scan all channel within serving priority group until finding a channel to
-     * serve */
-    for (j = 0; (j < p_lcb->rr_serv[p_lcb->rr_pri].num_ccb) && (!p_serve_ccb);
-         j++) {
-      /* scaning from next serving channel */
-      p_ccb = p_lcb->rr_serv[p_lcb->rr_pri].p_serve_ccb;
+    tL2C_RR_SERV* p_serv = &p_lcb->rr_serv[p_lcb->rr_pri];
 
-      if (!p_ccb) {
-        LOG_ERROR("p_serve_ccb is NULL, rr_pri=%d", p_lcb->rr_pri);
-        return NULL;
-      }
+    /* scan the channels with data of the serving priority group until finding
+     * a channel to serve */
+    int num_ready = p_serv->num_ready;
+    for (j = 0; (j < num_ready) && (!p_serve_ccb); j++) {
+      /* scaning from next serving channel */
+      p_ccb = p_serv->p_first_ready;
 
       LOG_VERBOSE("RR scan pri=%d, lcid=0x%04x, q_cout=%zu",
                   p_ccb->ccb_priority, p_ccb->local_cid,
                   fixed_queue_length(p_ccb->xmit_hold_q));
 
-      /* store the next serving channel */
-      /* this channel is the last channel of its priority group */
-      if ((p_ccb->p_next_ccb == NULL) ||
-          (p_ccb->p_next_ccb->ccb_priority != p_ccb->ccb_priority)) {
-        /* next serving channel is set to the first channel in the group */
-        p_lcb->rr_serv[p_lcb->rr_pri].p_serve_ccb =
-            p_lcb->rr_serv[p_lcb->rr_pri].p_first_ccb;
-      } else {
-        /* next serving channel is set to the next channel in the group */
-        p_lcb->rr_serv[p_lcb->rr_pri].p_serve_ccb = p_ccb->p_next_ccb;
-      }
+      /* the channel is served again once all the other ones were */
+      l2cu_remove_ready_ccb(p_ccb);
+      l2cu_ccb_data_queued(p_ccb);
+      if (!p_ccb->in_ready_list) continue;
 
       if (p_ccb->chnl_state != CST_OPEN) continue;
 
@@ -1178,15 +1333,20 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
       } else {
         /* eL2CAP option in use */
         if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
-          if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) continue;
+          if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) {
+            p_ccb->metrics.starved.flow_controlled++;
+            continue;
+          }
 
           if (fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
             if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
 
             /* If in eRTM mode, check for window closure */
             if ((p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE) &&
-                (l2c_fcr_is_flow_controlled(p_ccb)))
+                (l2c_fcr_is_flow_controlled(p_ccb))) {
+              p_ccb->metrics.starved.flow_controlled++;
               continue;
+            }
           }
         } else {
           if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
@@ -1196,12 +1356,12 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
       /* found a channel to serve */
       p_serve_ccb = p_ccb;
       /* decrease quota of its priority group */
-      p_lcb->rr_serv[p_lcb->rr_pri].quota--;
+      p_serv->quota--;
     }
 
     /* if there is no more quota of the priority group or no channel to have
      * data to send */
-    if ((p_lcb->rr_serv[p_lcb->rr_pri].quota == 0) || (!p_serve_ccb)) {
+    if ((p_serv->quota == 0) || (!p_serve_ccb)) {
       /* serve next priority group */
       p_lcb->rr_pri = (p_lcb->rr_pri + 1) % L2CAP_NUM_CHNL_PRIORITY;
       /* initialize its quota */
@@ -1286,6 +1446,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
     /* Check credits */
     if (p_ccb->peer_conn_cfg.credits == 0) {
       LOG_DEBUG("No credits to send packets");
+      p_ccb->metrics.starved.no_credits++;
       return NULL;
     }
 
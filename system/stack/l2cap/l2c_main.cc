@@ -33,6 +33,7 @@
 #include "main/shim/entry.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
+#include "osi/include/properties.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_psm_types.h"
 #include "stack/include/bt_types.h"
@@ -45,6 +46,7 @@
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
 static void process_l2cap_cmd(tL2C_LCB* p_lcb, uint8_t* p, uint16_t pkt_len);
+static void l2c_le_return_credits(tL2C_CCB* p_ccb, uint16_t pdu_len);
 
 /******************************************************************************/
 /*               G L O B A L      L 2 C A P       D A T A                     */
@@ -133,6 +135,10 @@ void l2c_rcv_acl_data(BT_HDR* p_msg) {
     return;
   }
 
+  if (p_lcb->transport == BT_TRANSPORT_LE) {
+    l2cble_link_opt_traffic(p_lcb, rcv_cid, l2cap_len);
+  }
+
   /* Send the data through the channel state machine */
   if (rcv_cid == L2CAP_SIGNALLING_CID) {
     process_l2cap_cmd(p_lcb, p, l2cap_len);
@@ -182,19 +188,9 @@ void l2c_rcv_acl_data(BT_HDR* p_msg) {
   }
 
   if (p_lcb->transport == BT_TRANSPORT_LE) {
+    uint16_t pdu_len = p_msg->len;
     l2c_lcc_proc_pdu(p_ccb, p_msg);
-
-    /* The remote device has one less credit left */
-    --p_ccb->remote_credit_count;
-
-    /* If the credits left on the remote device are getting low, send some */
-    if (p_ccb->remote_credit_count <= L2CA_LeCreditThreshold()) {
-      uint16_t credits = L2CA_LeCreditDefault() - p_ccb->remote_credit_count;
-      p_ccb->remote_credit_count = L2CA_LeCreditDefault();
-
-      /* Return back credits */
-      l2c_csm_execute(p_ccb, L2CEVT_L2CA_SEND_FLOW_CONTROL_CREDIT, &credits);
-    }
+    l2c_le_return_credits(p_ccb, pdu_len);
   } else {
     /* Basic mode packets go straight to the state machine */
     if (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_BASIC_MODE)
@@ -209,6 +205,67 @@ void l2c_rcv_acl_data(BT_HDR* p_msg) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         l2c_le_max_buffered_bytes
+ *
+ * Description      Memory ceiling of an LE CoC channel: bytes the remote may
+ *                  send with the credits it holds. The
+ *                  bluetooth.l2cap.le.max_buffered_bytes property sets it.
+ *
+ * Returns          size_t
+ *
+ ******************************************************************************/
+static size_t l2c_le_max_buffered_bytes() {
+  static const int32_t max_buffered_bytes = osi_property_get_int32(
+      "bluetooth.l2cap.le.max_buffered_bytes",
+      bluetooth::l2cap::LeCreditPolicy::kDefaultMaxBufferedBytes);
+
+  return max_buffered_bytes > 0
+             ? max_buffered_bytes
+             : bluetooth::l2cap::LeCreditPolicy::kDefaultMaxBufferedBytes;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_le_return_credits
+ *
+ * Description      Account for the credit the remote used to send a PDU of
+ *                  pdu_len bytes on an LE CoC channel, and return credits
+ *                  once the credit policy asks for it. The SDUs are handed to
+ *                  the application as they are reassembled, so received
+ *                  bytes are consumed right away.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void l2c_le_return_credits(tL2C_CCB* p_ccb, uint16_t pdu_len) {
+  auto& policy = p_ccb->le_credit_policy;
+  if (!policy.IsConfigured()) {
+    policy.Configure(p_ccb->remote_credit_count, L2CA_LeCreditDefault(),
+                     p_ccb->local_conn_cfg.mps, l2c_le_max_buffered_bytes());
+  }
+
+  /* The remote device has one less credit left */
+  if (p_ccb->remote_credit_count > 0) {
+    --p_ccb->remote_credit_count;
+  } else {
+    LOG_WARN("cid 0x%04x: PDU received while the remote has no credit",
+             p_ccb->local_cid);
+  }
+
+  auto now = bluetooth::l2cap::LeCreditPolicy::Clock::now();
+  policy.OnPduReceived(pdu_len, p_ccb->remote_credit_count, now);
+  policy.OnConsumed(pdu_len, now);
+
+  uint16_t credits = policy.GetCreditsToSend(p_ccb->remote_credit_count, now);
+  if (credits == 0) return;
+  p_ccb->remote_credit_count += credits;
+
+  /* Return back credits */
+  l2c_csm_execute(p_ccb, L2CEVT_L2CA_SEND_FLOW_CONTROL_CREDIT, &credits);
+}
+
 /*******************************************************************************
  *
  * Function         process_l2cap_cmd
@@ -868,6 +925,10 @@ void l2c_init(void) {
   l2cb.l2c_ble_fixed_chnls_mask = L2CAP_FIXED_CHNL_ATT_BIT |
                                   L2CAP_FIXED_CHNL_BLE_SIG_BIT |
                                   L2CAP_FIXED_CHNL_SMP_BIT;
+
+  /* Split the low priority ACL buffers following the traffic of the links */
+  l2cb.dynamic_acl_quota = osi_property_get_bool(
+      "bluetooth.l2cap.dynamic_acl_quota.enabled", false);
 }
 
 void l2c_free(void) {}
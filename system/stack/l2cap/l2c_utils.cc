@@ -49,6 +49,42 @@
 
 tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb); // TODO Move
 
+/* Entries of the l2cb LCB lookup tables */
+static uint16_t lcb_to_entry(const tL2C_LCB* p_lcb) {
+  return (uint16_t)(p_lcb - l2cb.lcb_pool) + 1;
+}
+
+static tL2C_LCB* entry_to_lcb(uint16_t entry) {
+  return entry ? &l2cb.lcb_pool[entry - 1] : nullptr;
+}
+
+/* FNV-1a of the BD address */
+static uint16_t& lcb_addr_bucket(const RawAddress& bd_addr) {
+  uint32_t hash = 2166136261u;
+  for (uint8_t byte : bd_addr.address) {
+    hash = (hash ^ byte) * 16777619u;
+  }
+  return l2cb.lcb_by_addr[hash & (L2C_LCB_ADDR_HASH_SIZE - 1)];
+}
+
+static void l2cu_hash_lcb(tL2C_LCB* p_lcb) {
+  uint16_t& head = lcb_addr_bucket(p_lcb->remote_bd_addr);
+  p_lcb->next_by_addr = head;
+  head = lcb_to_entry(p_lcb);
+}
+
+static void l2cu_unhash_lcb(tL2C_LCB* p_lcb) {
+  uint16_t entry = lcb_to_entry(p_lcb);
+  for (uint16_t* p_entry = &lcb_addr_bucket(p_lcb->remote_bd_addr);
+       *p_entry != 0; p_entry = &entry_to_lcb(*p_entry)->next_by_addr) {
+    if (*p_entry == entry) {
+      *p_entry = p_lcb->next_by_addr;
+      p_lcb->next_by_addr = 0;
+      return;
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_lcb
@@ -67,9 +103,11 @@ tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
     if (!p_lcb->in_use) {
       alarm_free(p_lcb->l2c_lcb_timer);
       alarm_free(p_lcb->info_resp_timer);
+      l2cble_link_opt_stop(p_lcb);
       memset(p_lcb, 0, sizeof(tL2C_LCB));
 
       p_lcb->remote_bd_addr = p_bd_addr;
+      l2cu_hash_lcb(p_lcb);
 
       p_lcb->in_use = true;
       p_lcb->with_active_local_clients = false;
@@ -111,6 +149,24 @@ void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle) {
              p_lcb.Handle(), handle);
   }
   p_lcb.SetHandle(handle);
+  if (handle <= HCI_HANDLE_MAX) {
+    l2cb.lcb_by_handle[handle] = lcb_to_entry(&p_lcb);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cu_set_lcb_bd_addr
+ *
+ * Description      Change the remote BD address of an LCB in use
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2cu_set_lcb_bd_addr(tL2C_LCB* p_lcb, const RawAddress& bd_addr) {
+  l2cu_unhash_lcb(p_lcb);
+  p_lcb->remote_bd_addr = bd_addr;
+  l2cu_hash_lcb(p_lcb);
 }
 
 /*******************************************************************************
@@ -152,12 +208,14 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
 
   p_lcb->in_use = false;
   p_lcb->ResetBonding();
+  l2cu_unhash_lcb(p_lcb);
 
   /* Stop and free timers */
   alarm_free(p_lcb->l2c_lcb_timer);
   p_lcb->l2c_lcb_timer = NULL;
   alarm_free(p_lcb->info_resp_timer);
   p_lcb->info_resp_timer = NULL;
+  l2cble_link_opt_stop(p_lcb);
 
   if (p_lcb->transport == BT_TRANSPORT_BR_EDR) /* Release all SCO links */
     BTM_RemoveSco(p_lcb->remote_bd_addr);
@@ -230,18 +288,16 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
  *
  * Function         l2cu_find_lcb_by_bd_addr
  *
- * Description      Look through all active LCBs for a match based on the
- *                  remote BD address.
+ * Description      Look up the active LCB for the remote BD address, in the
+ *                  address hash.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport) {
-  int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
-
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  for (tL2C_LCB* p_lcb = entry_to_lcb(lcb_addr_bucket(p_bd_addr));
+       p_lcb != nullptr; p_lcb = entry_to_lcb(p_lcb->next_by_addr)) {
     if ((p_lcb->in_use) && p_lcb->transport == transport &&
         (p_lcb->remote_bd_addr == p_bd_addr)) {
       return (p_lcb);
@@ -1212,16 +1268,15 @@ void l2cu_enqueue_ccb(tL2C_CCB* p_ccb) {
   if (p_ccb->p_lcb != NULL) {
     /* if this is the first channel in this priority group */
     if (p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb == 0) {
-      /* Set the first channel to this CCB */
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb = p_ccb;
-      /* Set the next serving channel in this group to this CCB */
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb = p_ccb;
       /* Initialize quota of this priority group based on its priority */
       p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].quota =
           L2CAP_GET_PRIORITY_QUOTA(p_ccb->ccb_priority);
     }
     /* increase number of channels in this group */
     p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb++;
+
+    /* Data may be queued already if the channel changed priority */
+    l2cu_ccb_data_queued(p_ccb);
   }
 }
 
@@ -1254,26 +1309,10 @@ void l2cu_dequeue_ccb(tL2C_CCB* p_ccb) {
 
   /* Removing CCB from round robin service table of its LCB */
   if (p_ccb->p_lcb != NULL) {
+    l2cu_remove_ready_ccb(p_ccb);
+
     /* decrease number of channels in this priority group */
     p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb--;
-
-    /* if it was the last channel in the priority group */
-    if (p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb == 0) {
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb = NULL;
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb = NULL;
-    } else {
-      /* if it is the first channel of this group */
-      if (p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb == p_ccb) {
-        p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb =
-            p_ccb->p_next_ccb;
-      }
-      /* if it is the next serving channel of this group */
-      if (p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb == p_ccb) {
-        /* simply, start serving from the first channel */
-        p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb =
-            p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb;
-      }
-    }
   }
 
   if (p_ccb == p_q->p_first_ccb) {
@@ -1297,6 +1336,71 @@ void l2cu_dequeue_ccb(tL2C_CCB* p_ccb) {
   p_ccb->p_next_ccb = p_ccb->p_prev_ccb = NULL;
 }
 
+/******************************************************************************
+ *
+ * Function         l2cu_ccb_data_queued
+ *
+ * Description      Put a dynamic channel at the back of the ready list of its
+ *                  priority group, when it has data queued and is not on the
+ *                  list yet. Must be called whenever data is queued on the
+ *                  channel.
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+void l2cu_ccb_data_queued(tL2C_CCB* p_ccb) {
+  /* Fixed channels are served before the round robin */
+  if (p_ccb->in_ready_list || p_ccb->p_lcb == NULL ||
+      p_ccb->local_cid < L2CAP_BASE_APPL_CID) {
+    return;
+  }
+
+  if (fixed_queue_is_empty(p_ccb->xmit_hold_q) &&
+      fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+    return;
+  }
+
+  tL2C_RR_SERV* p_serv = &p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority];
+  p_ccb->p_next_ready = NULL;
+  p_ccb->p_prev_ready = p_serv->p_last_ready;
+  if (p_serv->p_last_ready != NULL) {
+    p_serv->p_last_ready->p_next_ready = p_ccb;
+  } else {
+    p_serv->p_first_ready = p_ccb;
+  }
+  p_serv->p_last_ready = p_ccb;
+  p_serv->num_ready++;
+  p_ccb->in_ready_list = true;
+}
+
+/******************************************************************************
+ *
+ * Function         l2cu_remove_ready_ccb
+ *
+ * Description      Take a channel off the ready list of its priority group
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+void l2cu_remove_ready_ccb(tL2C_CCB* p_ccb) {
+  if (!p_ccb->in_ready_list) return;
+
+  tL2C_RR_SERV* p_serv = &p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority];
+  if (p_ccb->p_prev_ready != NULL) {
+    p_ccb->p_prev_ready->p_next_ready = p_ccb->p_next_ready;
+  } else {
+    p_serv->p_first_ready = p_ccb->p_next_ready;
+  }
+  if (p_ccb->p_next_ready != NULL) {
+    p_ccb->p_next_ready->p_prev_ready = p_ccb->p_prev_ready;
+  } else {
+    p_serv->p_last_ready = p_ccb->p_prev_ready;
+  }
+  p_serv->num_ready--;
+  p_ccb->p_next_ready = p_ccb->p_prev_ready = NULL;
+  p_ccb->in_ready_list = false;
+}
+
 /******************************************************************************
  *
  * Function         l2cu_change_pri_ccb
@@ -1321,17 +1425,15 @@ void l2cu_change_pri_ccb(tL2C_CCB* p_ccb, tL2CAP_CHNL_PRIORITY priority) {
     else {
       /* If CCB is the only guy on the queue, no need to re-enqueue */
       /* update only round robin service data */
+      l2cu_remove_ready_ccb(p_ccb);
       p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb = 0;
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb = NULL;
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb = NULL;
 
       p_ccb->ccb_priority = priority;
 
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_first_ccb = p_ccb;
-      p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].p_serve_ccb = p_ccb;
       p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].quota =
           L2CAP_GET_PRIORITY_QUOTA(p_ccb->ccb_priority);
       p_ccb->p_lcb->rr_serv[p_ccb->ccb_priority].num_ccb = 1;
+      l2cu_ccb_data_queued(p_ccb);
     }
   }
 }
@@ -1386,6 +1488,8 @@ tL2C_CCB* l2cu_allocate_ccb(tL2C_LCB* p_lcb, uint16_t cid, bool is_eatt) {
   }
 
   p_ccb->p_next_ccb = p_ccb->p_prev_ccb = nullptr;
+  p_ccb->p_next_ready = p_ccb->p_prev_ready = nullptr;
+  p_ccb->in_ready_list = false;
 
   p_ccb->in_use = true;
 
@@ -1577,6 +1681,25 @@ void l2cu_release_ccb(tL2C_CCB* p_ccb) {
 
   l2c_fcr_cleanup(p_ccb);
 
+  if (p_ccb->metrics.starved.no_credits ||
+      p_ccb->metrics.starved.flow_controlled) {
+    LOG_INFO("cid 0x%04x starved without credits:%u flow controlled:%u",
+             p_ccb->local_cid, p_ccb->metrics.starved.no_credits,
+             p_ccb->metrics.starved.flow_controlled);
+  }
+  p_ccb->metrics.starved = {};
+
+  const auto& credit_stats = p_ccb->le_credit_policy.GetStats();
+  if (credit_stats.starved_intervals) {
+    LOG_INFO("cid 0x%04x remote ran out of credits %u times, for %lld ms",
+             p_ccb->local_cid, credit_stats.starved_intervals,
+             static_cast<long long>(
+                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                     credit_stats.starved_time)
+                     .count()));
+  }
+  p_ccb->le_credit_policy = {};
+
   /* Channel may not be assigned to any LCB if it was just pre-reserved */
   if ((p_lcb) && ((p_ccb->local_cid >= L2CAP_BASE_APPL_CID))) {
     l2cu_dequeue_ccb(p_ccb);
@@ -1961,9 +2084,10 @@ void l2cu_process_peer_cfg_rsp(tL2C_CCB* p_ccb, tL2CAP_CFG_INFO* p_cfg) {
     /* Calculate the max number of packets for which we can delay sending an ack
      */
     if (p_cfg->fcr.tx_win_sz < p_ccb->our_cfg.fcr.tx_win_sz)
-      p_ccb->fcrb.max_held_acks = p_cfg->fcr.tx_win_sz / 3;
+      p_ccb->fcrb.max_held_acks = l2c_fcr_max_held_acks(p_cfg->fcr.tx_win_sz);
     else
-      p_ccb->fcrb.max_held_acks = p_ccb->our_cfg.fcr.tx_win_sz / 3;
+      p_ccb->fcrb.max_held_acks =
+          l2c_fcr_max_held_acks(p_ccb->our_cfg.fcr.tx_win_sz);
 
     LOG_VERBOSE(
         "l2cu_process_peer_cfg_rsp(): peer tx_win_sz: %d, our tx_win_sz: %d, "
@@ -2005,7 +2129,7 @@ void l2cu_process_our_cfg_req(tL2C_CCB* p_ccb, tL2CAP_CFG_INFO* p_cfg) {
     }
 
     /* Set the threshold to send acks (may be updated in the cfg response) */
-    p_ccb->fcrb.max_held_acks = p_cfg->fcr.tx_win_sz / 3;
+    p_ccb->fcrb.max_held_acks = l2c_fcr_max_held_acks(p_cfg->fcr.tx_win_sz);
 
     /* Include FCS option only if peer can handle it */
     if ((p_ccb->p_lcb->peer_ext_fea & L2CAP_EXTFEA_NO_CRC) == 0) {
@@ -3382,13 +3506,20 @@ void l2cu_send_peer_ble_credit_based_disconn_req(tL2C_CCB* p_ccb) {
  *
  * Function         l2cu_find_lcb_by_handle
  *
- * Description      Look through all active LCBs for a match based on the
- *                  HCI handle.
+ * Description      Look up the active LCB for the HCI handle, in the handle
+ *                  table.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle) {
+  if (handle <= HCI_HANDLE_MAX) {
+    /* The entry is left behind when the handle is invalidated */
+    tL2C_LCB* p_lcb = entry_to_lcb(l2cb.lcb_by_handle[handle]);
+    if (p_lcb && p_lcb->in_use && p_lcb->Handle() == handle) return p_lcb;
+    return NULL;
+  }
+
   int xx;
   tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
 
@@ -3535,6 +3666,18 @@ void l2cu_check_channel_congestion(tL2C_CCB* p_ccb) {
   }
 }
 
+/* Number of SDUs the channel accepts before it reports congestion. The last of
+ * them makes the channel congested, so that the congestion callback tells when
+ * there is room again. */
+uint16_t l2cu_get_tx_room(const tL2C_CCB* p_ccb) {
+  if (p_ccb->cong_sent) return 0;
+  if (p_ccb->buff_quota == 0) return UINT16_MAX;
+
+  size_t q_count = fixed_queue_length(p_ccb->xmit_hold_q);
+  if (q_count > p_ccb->buff_quota) return 0;
+  return p_ccb->buff_quota + 1 - q_count;
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_is_ccb_active
@@ -190,6 +190,7 @@ int RFCOMM_CreateConnectionWithSecurity(uint16_t uuid, uint8_t scn,
   // Assign port specific values
   p_port->state = PORT_CONNECTION_STATE_OPENING;
   p_port->uuid = uuid;
+  port_select_tx_lane(p_port);
   p_port->is_server = is_server;
   p_port->scn = scn;
   p_port->ev_mask = 0;
@@ -862,8 +863,7 @@ static int port_write(tPORT* p_port, BT_HDR* p_buf) {
         (p_port->rfc.p_mcb && p_port->rfc.p_mcb->peer_ready), p_port->rfc.state,
         p_port->port_ctrl);
 
-    fixed_queue_enqueue(p_port->tx.queue, p_buf);
-    p_port->tx.queue_size += p_buf->len;
+    port_rfc_enqueue_tx_data(p_port, p_buf);
 
     return (PORT_CMD_PENDING);
   } else {
@@ -1178,6 +1178,43 @@ const char* PORT_GetResultString(const uint8_t result_code) {
   return result_code_strings[result_code];
 }
 
+/*******************************************************************************
+ *
+ * Function         PORT_SetTxPriority
+ *
+ * Description      This function sets how the data of a port is scheduled
+ *                  with the data of the other ports on the same multiplexer.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                  control_plane - true to send the data of the port before
+ *                               the data of the bulk ports in each round
+ *                  weight     - frames the port sends in each round
+ *
+ ******************************************************************************/
+int PORT_SetTxPriority(uint16_t handle, bool control_plane, uint8_t weight) {
+  LOG_VERBOSE("PORT_SetTxPriority() handle:%d control_plane:%d weight:%d",
+              handle, control_plane, weight);
+
+  /* Check if handle is valid to avoid crashing */
+  if ((handle == 0) || (handle > MAX_RFC_PORTS)) {
+    return (PORT_BAD_HANDLE);
+  }
+
+  tPORT* p_port = &rfc_cb.port.port[handle - 1];
+
+  if (!p_port->in_use || (p_port->state == PORT_CONNECTION_STATE_CLOSED)) {
+    return (PORT_NOT_OPENED);
+  }
+
+  if ((weight == 0) || (weight > PORT_TX_MAX_WEIGHT)) {
+    return (PORT_UNKNOWN_ERROR);
+  }
+
+  p_port->tx_priority = control_plane;
+  p_port->tx_weight = weight;
+  return (PORT_SUCCESS);
+}
+
 /*******************************************************************************
  *
  * Function         PORT_GetSecurityMask
@@ -52,6 +52,15 @@ typedef struct {
   tPORT_CALLBACK* p_callback; /* Address of the callback function */
 } tPORT_DATA;
 
+/*
+ * Queueing delay of the buffers sent from the tx queue of a port
+*/
+typedef struct {
+  uint32_t count;    /* Number of buffers sent after waiting in the queue */
+  uint64_t total_ms; /* Sum of their queueing delays */
+  uint32_t max_ms;   /* Longest queueing delay */
+} tPORT_TX_DELAY;
+
 /*
  * Port control structure used to pass modem info
 */
@@ -100,6 +109,7 @@ typedef struct {
                                             connection was completed*/
   tL2CAP_CFG_INFO pending_cfg_info = {}; /* store configure info for incoming
                                        connection while connecting */
+  uint8_t tx_next_port = 0; /* Port index the next data lane round starts at */
 } tRFC_MCB;
 
 /*
@@ -184,6 +194,7 @@ typedef struct {
                           /* number of buffers peer is allowed to sent */
   uint16_t
       credit_rx_max; /* Max number of credits we will allow this guy to sent */
+  uint16_t credit_rx_base;  /* credit_rx_max derived from the rx watermarks */
   uint16_t credit_rx_low;   /* Number of credits when we send credit update */
   uint16_t rx_buf_critical; /* port receive queue critical watermark level */
   bool keep_port_handle;    /* true if port is not deallocated when closing */
@@ -191,6 +202,15 @@ typedef struct {
   uint16_t keep_mtu; /* Max MTU that port can receive by server */
   uint16_t sec_mask; /* Bitmask of security requirements for this port */
                      /* see the BTM_SEC_* values in btm_api_types.h */
+
+  /* The tx queues of the ports of a mux are drained by a deficit round robin.
+   * Control plane DLCs, e.g. the HFP Service Level Connection, are served
+   * first in each round, then the other DLCs get a byte budget of tx_weight
+   * frames. */
+  bool tx_priority;        /* true if the DLC is in the control plane lane */
+  uint8_t tx_weight;       /* Frames of peer_mtu sent per round */
+  uint32_t tx_deficit;     /* Bytes the DLC can still send in this round */
+  tPORT_TX_DELAY tx_delay; /* Time the sent buffers waited in tx.queue */
 } tPORT;
 
 /* Define the PORT/RFCOMM control structure
@@ -206,6 +226,7 @@ typedef struct {
 tPORT* port_allocate_port(uint8_t dlci, const RawAddress& bd_addr);
 void port_set_defaults(tPORT* p_port);
 void port_select_mtu(tPORT* p_port);
+void port_select_tx_lane(tPORT* p_port);
 void port_release_port(tPORT* p_port);
 tPORT* port_find_mcb_dlci_port(tRFC_MCB* p_mcb, uint8_t dlci);
 tRFC_MCB* port_find_mcb(const RawAddress& bd_addr);
@@ -225,5 +246,6 @@ void port_start_par_neg(tPORT* p_port);
 void port_start_control(tPORT* p_port);
 void port_start_close(tPORT* p_port);
 void port_rfc_closed(tPORT* p_port, uint8_t res);
+void port_rfc_enqueue_tx_data(tPORT* p_port, BT_HDR* p_buf);
 
 #endif
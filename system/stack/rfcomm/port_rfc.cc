@@ -29,9 +29,11 @@
 #include <base/logging.h>
 #include <frameworks/proto_logging/stats/enums/bluetooth/enums.pb.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
+#include "common/time_util.h"
 #include "gd/hal/snoop_logger.h"
 #include "internal_include/bt_target.h"
 #include "internal_include/bt_trace.h"
@@ -51,6 +53,7 @@
  * Local function definitions
 */
 uint32_t port_rfc_send_tx_data(tPORT* p_port);
+static void port_rfc_schedule_tx_data(tRFC_MCB* p_mcb, uint32_t* p_events);
 void port_rfc_closed(tPORT* p_port, uint8_t res);
 void port_get_credits(tPORT* p_port, uint8_t k);
 
@@ -884,6 +887,13 @@ void PORT_FlowInd(tRFC_MCB* p_mcb, uint8_t dlci, bool enable_data) {
     p_port->tx.peer_fc = !enable_data;
   }
 
+  /* The ports of the mux share the L2CAP channel, let the scheduler decide
+   * which of them sends first */
+  uint32_t tx_events[MAX_RFC_PORTS] = {};
+  if (dlci == 0) {
+    port_rfc_schedule_tx_data(p_mcb, tx_events);
+  }
+
   for (i = 0; i < MAX_RFC_PORTS; i++) {
     /* If DLCI is 0 event applies to all ports */
     if (dlci == 0) {
@@ -898,7 +908,11 @@ void PORT_FlowInd(tRFC_MCB* p_mcb, uint8_t dlci, bool enable_data) {
     events |= port_flow_control_user(p_port);
 
     /* Check if data can be sent and send it */
-    events |= port_rfc_send_tx_data(p_port);
+    if (dlci == 0) {
+      events |= tx_events[i];
+    } else {
+      events |= port_rfc_send_tx_data(p_port);
+    }
 
     /* Mask out all events that are not of interest to user */
     events &= p_port->ev_mask;
@@ -912,6 +926,71 @@ void PORT_FlowInd(tRFC_MCB* p_mcb, uint8_t dlci, bool enable_data) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         port_rfc_enqueue_tx_data
+ *
+ * Description      This function keeps a buffer in the tx queue of the port
+ *                  until the peer can receive it.  The low 16 bits of the
+ *                  time it was queued at, in ms, are kept in layer_specific
+ *                  until it is sent.
+ *
+ ******************************************************************************/
+void port_rfc_enqueue_tx_data(tPORT* p_port, BT_HDR* p_buf) {
+  p_buf->layer_specific =
+      (uint16_t)bluetooth::common::time_get_os_boottime_ms();
+  fixed_queue_enqueue(p_port->tx.queue, p_buf);
+  p_port->tx.queue_size += p_buf->len;
+}
+
+/*******************************************************************************
+ *
+ * Function         port_rfc_send_tx_buf
+ *
+ * Description      This function sends the buffer at the head of the tx queue
+ *                  of the port, and accounts for the time it waited.
+ *
+ * Returns          Length of the buffer sent, or 0 if the queue is empty
+ *
+ ******************************************************************************/
+static uint16_t port_rfc_send_tx_buf(tPORT* p_port, uint32_t* p_events) {
+  mutex_global_lock();
+
+  BT_HDR* p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_port->tx.queue);
+  if (p_buf == NULL) {
+    mutex_global_unlock();
+
+    /* queue is empty-- all data sent */
+    *p_events |= PORT_EV_TXEMPTY;
+    return 0;
+  }
+  p_port->tx.queue_size -= p_buf->len;
+
+  mutex_global_unlock();
+
+  uint16_t delay_ms =
+      (uint16_t)bluetooth::common::time_get_os_boottime_ms() -
+      (uint16_t)p_buf->layer_specific;
+  p_port->tx_delay.count++;
+  p_port->tx_delay.total_ms += delay_ms;
+  p_port->tx_delay.max_ms =
+      std::max(p_port->tx_delay.max_ms, (uint32_t)delay_ms);
+
+  uint16_t len = p_buf->len;
+
+  LOG_VERBOSE("Sending RFCOMM_DataReq tx.queue_size=%d queued for %dms",
+              p_port->tx.queue_size, delay_ms);
+
+  RFCOMM_DataReq(p_port->rfc.p_mcb, p_port->dlci, p_buf);
+
+  *p_events |= PORT_EV_TXCHAR;
+
+  if (p_port->tx.queue_size == 0) {
+    *p_events |= PORT_EV_TXEMPTY;
+  }
+  return len;
+}
+
 /*******************************************************************************
  *
  * Function         port_rfc_send_tx_data
@@ -921,7 +1000,6 @@ void PORT_FlowInd(tRFC_MCB* p_mcb, uint8_t dlci, bool enable_data) {
  ******************************************************************************/
 uint32_t port_rfc_send_tx_data(tPORT* p_port) {
   uint32_t events = 0;
-  BT_HDR* p_buf;
 
   /* if there is data to be sent */
   if (p_port->tx.queue_size > 0) {
@@ -929,38 +1007,86 @@ uint32_t port_rfc_send_tx_data(tPORT* p_port) {
     while (!p_port->tx.peer_fc && p_port->rfc.p_mcb &&
            p_port->rfc.p_mcb->peer_ready) {
       /* get data from tx queue and send it */
-      mutex_global_lock();
-
-      p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_port->tx.queue);
-      if (p_buf != NULL) {
-        p_port->tx.queue_size -= p_buf->len;
-
-        mutex_global_unlock();
-
-        LOG_VERBOSE("Sending RFCOMM_DataReq tx.queue_size=%d",
-                    p_port->tx.queue_size);
-
-        RFCOMM_DataReq(p_port->rfc.p_mcb, p_port->dlci, p_buf);
+      if (port_rfc_send_tx_buf(p_port, &events) == 0 ||
+          p_port->tx.queue_size == 0) {
+        break;
+      }
+    }
+    /* If we flow controlled user based on the queue size enable data again */
+    events |= port_flow_control_user(p_port);
+  }
+  return (events & p_port->ev_mask);
+}
 
-        events |= PORT_EV_TXCHAR;
+/*******************************************************************************
+ *
+ * Function         port_rfc_schedule_tx_data
+ *
+ * Description      This function sends the data queued on the ports of a
+ *                  multiplexer when the peer is ready again, by deficit round
+ *                  robin.  In each round the control plane ports are served
+ *                  first, then each of the other ports can send tx_weight
+ *                  frames, so that a bulk transfer does not delay the AT
+ *                  commands of a Service Level Connection on the same mux.
+ *                  The events of each port are ORed into p_events, indexed
+ *                  like rfc_cb.port.port.
+ *
+ ******************************************************************************/
+static void port_rfc_schedule_tx_data(tRFC_MCB* p_mcb, uint32_t* p_events) {
+  bool backlogged = true;
+
+  while (backlogged && p_mcb->peer_ready) {
+    backlogged = false;
+
+    for (bool priority : {true, false}) {
+      for (int n = 0; (n < MAX_RFC_PORTS) && p_mcb->peer_ready; n++) {
+        int i = (p_mcb->tx_next_port + n) % MAX_RFC_PORTS;
+        tPORT* p_port = &rfc_cb.port.port[i];
+
+        if (!p_port->in_use || (p_port->rfc.p_mcb != p_mcb) ||
+            (p_port->rfc.state != RFC_STATE_OPENED) ||
+            (p_port->tx_priority != priority) || (p_port->tx.queue_size == 0))
+          continue;
+
+        /* A turn cut short by the peer resumes with the bytes it has left,
+         * otherwise the port gets its budget for this round */
+        uint32_t quantum =
+            p_port->tx_weight * std::max<uint32_t>(p_port->peer_mtu, 1);
+        bool in_turn = false;
+
+        while (!p_port->tx.peer_fc && p_mcb->peer_ready) {
+          mutex_global_lock();
+          BT_HDR* p_buf = (BT_HDR*)fixed_queue_try_peek_first(p_port->tx.queue);
+          uint16_t len = (p_buf != NULL) ? p_buf->len : 0;
+          mutex_global_unlock();
+
+          if (p_buf == NULL) break;
+          if (len > p_port->tx_deficit) {
+            /* Budget of the turn used, the rest waits for the next round */
+            if (in_turn) break;
+            p_port->tx_deficit += quantum;
+            in_turn = true;
+            continue;
+          }
+          in_turn = true;
+          p_port->tx_deficit -= port_rfc_send_tx_buf(p_port, &p_events[i]);
+        }
 
         if (p_port->tx.queue_size == 0) {
-          events |= PORT_EV_TXEMPTY;
-          break;
+          p_port->tx_deficit = 0;
+        } else if (!p_port->tx.peer_fc) {
+          backlogged = true;
         }
-      }
-      /* queue is empty-- all data sent */
-      else {
-        mutex_global_unlock();
 
-        events |= PORT_EV_TXEMPTY;
-        break;
+        if (!priority && !p_mcb->peer_ready) {
+          /* Start the next data lane round with the port that was cut short */
+          p_mcb->tx_next_port = (p_port->tx.queue_size > 0)
+                                    ? i
+                                    : ((i + 1) % MAX_RFC_PORTS);
+        }
       }
     }
-    /* If we flow controlled user based on the queue size enable data again */
-    events |= port_flow_control_user(p_port);
   }
-  return (events & p_port->ev_mask);
 }
 
 /*******************************************************************************
@@ -26,6 +26,8 @@
 
 #include <base/logging.h>
 
+#include <algorithm>
+#include <cinttypes>
 #include <cstdint>
 #include <cstring>
 
@@ -35,6 +37,7 @@
 #include "osi/include/mutex.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/btm_client_interface.h"
+#include "stack/include/bt_uuid16.h"
 #include "stack/rfcomm/port_int.h"
 #include "stack/rfcomm/rfc_int.h"
 #include "types/raw_address.h"
@@ -127,6 +130,36 @@ void port_set_defaults(tPORT* p_port) {
 
   p_port->tx.queue = fixed_queue_new(SIZE_MAX);
   p_port->rx.queue = fixed_queue_new(SIZE_MAX);
+
+  p_port->tx_weight = PORT_TX_DEFAULT_WEIGHT;
+  p_port->tx_deficit = 0;
+  memset(&p_port->tx_delay, 0, sizeof(p_port->tx_delay));
+  port_select_tx_lane(p_port);
+}
+
+/*******************************************************************************
+ *
+ * Function         port_select_tx_lane
+ *
+ * Description      Puts the DLCs carrying AT commands of the headset and
+ *                  handsfree profiles into the control plane lane of the mux
+ *                  scheduler, so that their latency is not affected by bulk
+ *                  transfers on the other DLCs.
+ *
+ ******************************************************************************/
+void port_select_tx_lane(tPORT* p_port) {
+  switch (p_port->uuid) {
+    case UUID_SERVCLASS_HEADSET:
+    case UUID_SERVCLASS_HEADSET_HS:
+    case UUID_SERVCLASS_HEADSET_AUDIO_GATEWAY:
+    case UUID_SERVCLASS_HF_HANDSFREE:
+    case UUID_SERVCLASS_AG_HANDSFREE:
+      p_port->tx_priority = true;
+      break;
+    default:
+      p_port->tx_priority = false;
+      break;
+  }
 }
 
 /*******************************************************************************
@@ -184,6 +217,7 @@ void port_select_mtu(tPORT* p_port) {
   p_port->credit_rx_max = (PORT_RX_HIGH_WM / p_port->mtu);
   if (p_port->credit_rx_max > PORT_RX_BUF_HIGH_WM)
     p_port->credit_rx_max = PORT_RX_BUF_HIGH_WM;
+  p_port->credit_rx_base = p_port->credit_rx_max;
   p_port->credit_rx_low = (PORT_RX_LOW_WM / p_port->mtu);
   if (p_port->credit_rx_low > PORT_RX_BUF_LOW_WM)
     p_port->credit_rx_low = PORT_RX_BUF_LOW_WM;
@@ -208,6 +242,15 @@ void port_release_port(tPORT* p_port) {
   LOG_VERBOSE("%s p_port: %p state: %d keep_handle: %d", __func__, p_port,
               p_port->rfc.state, p_port->keep_port_handle);
 
+  if (p_port->tx_delay.count > 0) {
+    LOG_INFO(
+        "handle:%d dlci:%d priority:%d tx queueing delay avg:%" PRIu64
+        "ms max:%ums over %u buffers",
+        p_port->handle, p_port->dlci, p_port->tx_priority,
+        p_port->tx_delay.total_ms / p_port->tx_delay.count,
+        p_port->tx_delay.max_ms, p_port->tx_delay.count);
+  }
+
   mutex_global_lock();
   BT_HDR* p_buf;
   while ((p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_port->rx.queue)) !=
@@ -221,6 +264,7 @@ void port_release_port(tPORT* p_port) {
     osi_free(p_buf);
   }
   p_port->tx.queue_size = 0;
+  p_port->tx_deficit = 0;
   mutex_global_unlock();
 
   alarm_cancel(p_port->rfc.port_timer);
@@ -251,6 +295,8 @@ void port_release_port(tPORT* p_port) {
       uint32_t mask = p_port->ev_mask;
       tPORT_CALLBACK* p_port_cb = p_port->p_callback;
       tPORT_STATE user_port_pars = p_port->user_port_pars;
+      bool tx_priority = p_port->tx_priority;
+      uint8_t tx_weight = p_port->tx_weight;
 
       port_set_defaults(p_port);
 
@@ -258,6 +304,8 @@ void port_release_port(tPORT* p_port) {
       p_port->ev_mask = mask;
       p_port->p_callback = p_port_cb;
       p_port->user_port_pars = user_port_pars;
+      p_port->tx_priority = tx_priority;
+      p_port->tx_weight = tx_weight;
       p_port->mtu = p_port->keep_mtu;
 
       p_port->state = PORT_CONNECTION_STATE_OPENING;
@@ -444,6 +492,38 @@ uint32_t port_get_signal_changes(tPORT* p_port, uint8_t old_signals,
   return (p_port->ev_mask & events);
 }
 
+/*******************************************************************************
+ *
+ * Function         port_adapt_rx_credit_window
+ *
+ * Description      Size the credit window to the throughput of the consumer.
+ *                  When the peer used up all its credits without the consumer
+ *                  falling behind, the window is what limits the throughput,
+ *                  so it is widened by one credit, up to the critical
+ *                  watermark of the receive queue. When the consumer pushes
+ *                  back, the window is halved, down to the watermark based
+ *                  size.
+ *
+ * Returns          nothing
+ *
+ ******************************************************************************/
+static void port_adapt_rx_credit_window(tPORT* p_port, bool consumer_starved) {
+  uint16_t credit_rx_max = p_port->credit_rx_max;
+
+  if (consumer_starved) {
+    if (credit_rx_max < p_port->rx_buf_critical) credit_rx_max++;
+  } else {
+    credit_rx_max = std::max(p_port->credit_rx_base,
+                             static_cast<uint16_t>(credit_rx_max / 2));
+  }
+
+  if (credit_rx_max != p_port->credit_rx_max) {
+    LOG_VERBOSE("%s: port_handle:%d credit_rx_max %d -> %d", __func__,
+                p_port->handle, p_port->credit_rx_max, credit_rx_max);
+    p_port->credit_rx_max = credit_rx_max;
+  }
+}
+
 /*******************************************************************************
  *
  * Function         port_flow_control_peer
@@ -469,6 +549,13 @@ void port_flow_control_peer(tPORT* p_port, bool enable, uint16_t count) {
         p_port->credit_rx -= count;
       }
 
+      /* If the peer ran out of credits while the data kept being consumed, */
+      /* offer it a larger window */
+      if ((p_port->credit_rx == 0) && !p_port->rx.peer_fc &&
+          !p_port->rx.user_fc) {
+        port_adapt_rx_credit_window(p_port, true);
+      }
+
       /* If credit count is less than low credit watermark, and user */
       /* did not force flow control, send a credit update */
       /* There might be a special case when we just adjusted rx_max */
@@ -492,6 +579,9 @@ void port_flow_control_peer(tPORT* p_port, bool enable, uint16_t count) {
       else if (fixed_queue_length(p_port->rx.queue) >= p_port->credit_rx_max) {
         p_port->rx.peer_fc = true;
       }
+
+      /* The consumer is falling behind, shrink the window */
+      if (p_port->rx.peer_fc) port_adapt_rx_credit_window(p_port, false);
     }
   }
   /* else using TS 07.10 flow control */
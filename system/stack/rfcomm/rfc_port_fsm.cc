@@ -479,8 +479,10 @@ void rfc_port_sm_opened(tPORT* p_port, tRFC_PORT_EVENT event, void* p_data) {
       /* There might be an initial case when we reduced rx_max and credit_rx is
        * still */
       /* bigger.  Make sure that we do not send 255 */
+      /* A full size frame can carry them too: RFCOMM_DATA_OVERHEAD leaves
+       * room for the credit octet. */
       if ((p_port->rfc.p_mcb->flow == PORT_FC_CREDIT) &&
-          (((BT_HDR*)p_data)->len < p_port->peer_mtu) &&
+          (((BT_HDR*)p_data)->len <= p_port->peer_mtu) &&
           (!p_port->rx.user_fc) &&
           (p_port->credit_rx_max > p_port->credit_rx)) {
         ((BT_HDR*)p_data)->layer_specific =
@@ -44,6 +44,7 @@
 static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
                              const uint8_t* p_his_uuid, uint16_t his_len,
                              int nest_level);
+static void sdp_db_build_uuid_index(tSDP_RECORD* p_rec);
 
 bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
                       uint32_t attr_len, uint8_t* p_val);
@@ -59,22 +60,44 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
  * Returns          Pointer to the record, or NULL if not found.
  *
  ******************************************************************************/
-const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
+const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_start,
                                          const tSDP_UUID_SEQ* p_seq) {
-  uint16_t xx, yy;
+  uint16_t xx, yy, zz;
   const tSDP_ATTRIBUTE* p_attr;
+  tSDP_RECORD* p_rec = &sdp_cb.server_db.record[0];
   tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
+  uint8_t uuids[MAX_UUIDS_PER_SEQ][bluetooth::Uuid::kNumBytes128];
 
-  /* If NULL, start at the beginning, else start at the first specified record
-   */
-  if (!p_rec)
-    p_rec = &sdp_cb.server_db.record[0];
-  else
-    p_rec++;
+  /* If NULL, start at the beginning, else start after the specified record */
+  if (p_start) p_rec = &sdp_cb.server_db.record[p_start - p_rec + 1];
+
+  /* Convert the searched UUIDs once, to look them up in the record indexes */
+  for (yy = 0; yy < p_seq->num_uids; yy++) {
+    if (!sdpu_uuid_to_128bit(&p_seq->uuid_entry[yy].value[0],
+                             p_seq->uuid_entry[yy].len, uuids[yy]))
+      return (NULL);
+  }
 
   /* Look through the records. The spec says that a match occurs if */
   /* the record contains all the passed UUIDs in it.                */
   for (; p_rec < p_end; p_rec++) {
+    if (!p_rec->uuid_index_valid) sdp_db_build_uuid_index(p_rec);
+
+    if (p_rec->uuid_index_complete) {
+      for (yy = 0; yy < p_seq->num_uids; yy++) {
+        for (zz = 0; zz < p_rec->num_uuids; zz++) {
+          if (!memcmp(p_rec->uuids[zz], uuids[yy],
+                      bluetooth::Uuid::kNumBytes128))
+            break;
+        }
+        /* If any UUID was not found,  on to the next record */
+        if (zz == p_rec->num_uuids) break;
+      }
+
+      if (yy == p_seq->num_uids) return (p_rec);
+      continue;
+    }
+
     for (yy = 0; yy < p_seq->num_uids; yy++) {
       p_attr = &p_rec->attribute[0];
       for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
@@ -142,6 +165,99 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
   return (false);
 }
 
+/*******************************************************************************
+ *
+ * Function         sdp_db_index_uuid
+ *
+ * Description      This function adds a UUID to the index of a record, unless
+ *                  already there. The index is marked incomplete if full.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_index_uuid(tSDP_RECORD* p_rec, const uint8_t* p_uuid,
+                              uint32_t len) {
+  uint8_t uuid[bluetooth::Uuid::kNumBytes128];
+
+  /* Such a UUID never matches a search, see sdpu_compare_uuid_arrays */
+  if (!sdpu_uuid_to_128bit(p_uuid, len, uuid)) return;
+
+  for (uint16_t xx = 0; xx < p_rec->num_uuids; xx++) {
+    if (!memcmp(p_rec->uuids[xx], uuid, sizeof(uuid))) return;
+  }
+
+  if (p_rec->num_uuids == SDP_MAX_REC_UUIDS) {
+    p_rec->uuid_index_complete = false;
+    return;
+  }
+
+  memcpy(p_rec->uuids[p_rec->num_uuids++], uuid, sizeof(uuid));
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_index_uuids_in_seq
+ *
+ * Description      This function adds the UUIDs of a data element sequence to
+ *                  the index of a record. It visits the same elements as
+ *                  find_uuid_in_seq.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_index_uuids_in_seq(tSDP_RECORD* p_rec, uint8_t* p,
+                                      uint32_t seq_len, int nest_level) {
+  uint8_t* p_end = p + seq_len;
+  uint8_t type;
+  uint32_t len;
+
+  /* A little safety check to avoid excessive recursion */
+  if (nest_level > 3) return;
+
+  while (p < p_end) {
+    type = *p++;
+    p = sdpu_get_len_from_type(p, p_end, type, &len);
+    if (p == NULL || (p + len) > p_end) {
+      LOG_WARN("%s: bad length", __func__);
+      break;
+    }
+    type = type >> 3;
+    if (type == UUID_DESC_TYPE) {
+      sdp_db_index_uuid(p_rec, p, len);
+    } else if (type == DATA_ELE_SEQ_DESC_TYPE) {
+      sdp_db_index_uuids_in_seq(p_rec, p, len, nest_level + 1);
+    }
+    p = p + len;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_build_uuid_index
+ *
+ * Description      This function collects the UUIDs found in the attributes
+ *                  of a record, so searches do not have to parse them again.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_build_uuid_index(tSDP_RECORD* p_rec) {
+  const tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
+
+  p_rec->num_uuids = 0;
+  p_rec->uuid_index_complete = true;
+
+  for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
+    if (p_attr->type == UUID_DESC_TYPE) {
+      sdp_db_index_uuid(p_rec, p_attr->value_ptr, p_attr->len);
+    } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
+      sdp_db_index_uuids_in_seq(p_rec, p_attr->value_ptr, p_attr->len, 0);
+    }
+  }
+
+  p_rec->uuid_index_valid = true;
+}
+
 /*******************************************************************************
  *
  * Function         sdp_db_find_record
@@ -454,6 +570,8 @@ bool SDP_AddAttributeToRecord(tSDP_RECORD* p_rec, uint16_t attr_id,
   uint16_t xx, yy;
   tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
 
+  p_rec->uuid_index_valid = false;
+
   /* Found the record. Now, see if the attribute already exists */
   for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
     /* The attribute exists. replace it */
@@ -869,6 +987,8 @@ bool SDP_DeleteAttributeFromRecord(tSDP_RECORD* p_rec, uint16_t attr_id) {
   uint8_t* pad_ptr;
   uint32_t len; /* Number of bytes in the entry */
 
+  p_rec->uuid_index_valid = false;
+
   /* Found it. Now, find the attribute */
   for (uint16_t attribute_index = 0; attribute_index < p_rec->num_attributes;
        attribute_index++, p_attr++) {
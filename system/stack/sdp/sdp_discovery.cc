@@ -24,13 +24,18 @@
 
 #define LOG_TAG "sdp_discovery"
 
+#include <algorithm>
 #include <cstdint>
+#include <list>
+#include <vector>
 
 #include "bt_target.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
+#include "osi/include/properties.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_types.h"
+#include "stack/include/bt_uuid16.h"
 #include "stack/include/sdpdefs.h"
 #include "stack/sdp/sdp_discovery_db.h"
 #include "stack/sdp/sdpint.h"
@@ -48,6 +53,9 @@ static void process_service_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                      uint8_t* p_reply_end);
 static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                             uint8_t* p_reply_end);
+static void process_db_state_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
+                                 uint8_t* p_reply_end);
+static void save_search_attr_list(tCONN_CB* p_ccb, bool from_cache);
 static uint8_t* save_attr_seq(tCONN_CB* p_ccb, uint8_t* p, uint8_t* p_msg_end);
 static tSDP_DISC_REC* add_record(tSDP_DISCOVERY_DB* p_db,
                                  const RawAddress& p_bda);
@@ -198,6 +206,157 @@ static void sdp_snd_service_search_req(tCONN_CB* p_ccb, uint8_t cont_len,
                      sdp_conn_timer_timeout, p_ccb);
 }
 
+/*******************************************************************************
+ *
+ *  Discovery cache
+ *
+ *  The complete service search attribute response lists received from the
+ *  last peers are kept, together with the service database state the peer
+ *  reported. A discovery for the same filters first queries that state only,
+ *  and when it did not change the saved list is parsed into the caller's
+ *  database instead of running the full discovery again.
+ *
+ ******************************************************************************/
+#define SDP_DISC_CACHE_SIZE 8
+#define SDP_DISC_CACHE_PROPERTY "bluetooth.sdp.discovery_cache.enabled"
+
+typedef struct {
+  RawAddress bd_addr;
+  std::vector<Uuid> uuid_filters;
+  std::vector<uint16_t> attr_filters;
+  bool has_db_state; /* false if the peer does not report its state */
+  uint32_t db_state;
+  std::vector<uint8_t> rsp_list;
+} tSDP_DISC_CACHE_ENTRY;
+
+/* Most recently used entry first */
+static std::list<tSDP_DISC_CACHE_ENTRY> sdp_disc_cache;
+
+static bool sdp_disc_cache_enabled(void) {
+  return osi_property_get_bool(SDP_DISC_CACHE_PROPERTY, true);
+}
+
+static bool sdp_disc_cache_entry_matches(const tSDP_DISC_CACHE_ENTRY& entry,
+                                         const tCONN_CB* p_ccb) {
+  const tSDP_DISCOVERY_DB* p_db = p_ccb->p_db;
+
+  return entry.bd_addr == p_ccb->device_address &&
+         std::equal(entry.uuid_filters.begin(), entry.uuid_filters.end(),
+                    p_db->uuid_filters,
+                    p_db->uuid_filters + p_db->num_uuid_filters) &&
+         std::equal(entry.attr_filters.begin(), entry.attr_filters.end(),
+                    p_db->attr_filters,
+                    p_db->attr_filters + p_db->num_attr_filters);
+}
+
+static const tSDP_DISC_CACHE_ENTRY* sdp_disc_cache_find(
+    const tCONN_CB* p_ccb) {
+  for (auto it = sdp_disc_cache.begin(); it != sdp_disc_cache.end(); it++) {
+    if (sdp_disc_cache_entry_matches(*it, p_ccb)) {
+      sdp_disc_cache.splice(sdp_disc_cache.begin(), sdp_disc_cache, it);
+      return &sdp_disc_cache.front();
+    }
+  }
+  return NULL;
+}
+
+/* Returns true if the peer is known not to report its database state, in
+ * which case querying it would only delay the discovery */
+static bool sdp_disc_cache_lacks_db_state(const RawAddress& bd_addr) {
+  for (const auto& entry : sdp_disc_cache) {
+    if (entry.bd_addr == bd_addr && !entry.has_db_state) return true;
+  }
+  return false;
+}
+
+/* Saves the complete response list the discovery of |p_ccb| received */
+static void sdp_disc_cache_store(const tCONN_CB* p_ccb) {
+  const tSDP_DISCOVERY_DB* p_db = p_ccb->p_db;
+
+  if (!sdp_disc_cache_enabled()) return;
+
+  sdp_disc_cache.remove_if([p_ccb](const tSDP_DISC_CACHE_ENTRY& entry) {
+    return sdp_disc_cache_entry_matches(entry, p_ccb);
+  });
+  if (sdp_disc_cache.size() >= SDP_DISC_CACHE_SIZE) sdp_disc_cache.pop_back();
+
+  tSDP_DISC_CACHE_ENTRY entry;
+  entry.bd_addr = p_ccb->device_address;
+  entry.uuid_filters.assign(p_db->uuid_filters,
+                            p_db->uuid_filters + p_db->num_uuid_filters);
+  entry.attr_filters.assign(p_db->attr_filters,
+                            p_db->attr_filters + p_db->num_attr_filters);
+  entry.has_db_state = p_ccb->db_state_valid;
+  entry.db_state = p_ccb->db_state;
+  /* The list is useless without a state to validate it against */
+  if (entry.has_db_state)
+    entry.rsp_list.assign(p_ccb->rsp_list, p_ccb->rsp_list + p_ccb->list_len);
+  sdp_disc_cache.push_front(std::move(entry));
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_cache_clear
+ *
+ * Description      This function drops all the saved discovery results.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_disc_cache_clear(void) { sdp_disc_cache.clear(); }
+
+/*******************************************************************************
+ *
+ * Function         sdp_snd_db_state_req
+ *
+ * Description      Send a service search attribute request for the service
+ *                  database state of the SDP server.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_snd_db_state_req(tCONN_CB* p_ccb) {
+  uint8_t *p, *p_start, *p_param_len;
+  BT_HDR* p_cmd = (BT_HDR*)osi_malloc(SDP_DATA_BUF_SIZE);
+  uint16_t bytes_left = SDP_DATA_BUF_SIZE - sizeof(BT_HDR) - L2CAP_MIN_OFFSET;
+  Uuid uuid = Uuid::From16Bit(UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER);
+  uint16_t attr_id = ATTR_ID_SERVICE_DATABASE_STATE;
+
+  /* Prepare the buffer for sending the packet to L2CAP */
+  p_cmd->offset = L2CAP_MIN_OFFSET;
+  p = p_start = (uint8_t*)(p_cmd + 1) + L2CAP_MIN_OFFSET;
+
+  /* Build a service search attribute request packet */
+  UINT8_TO_BE_STREAM(p, SDP_PDU_SERVICE_SEARCH_ATTR_REQ);
+  UINT16_TO_BE_STREAM(p, p_ccb->transaction_id);
+  p_ccb->transaction_id++;
+
+  /* Skip the length, we need to add it at the end */
+  p_param_len = p;
+  p += 2;
+
+  p = sdpu_build_uuid_seq(p, 1, &uuid, bytes_left);
+  UINT16_TO_BE_STREAM(p, sdp_cb.max_attr_list_size);
+  p = sdpu_build_attrib_seq(p, &attr_id, 1);
+
+  /* No continuation */
+  UINT8_TO_BE_STREAM(p, 0);
+
+  /* Go back and put the parameter length into the buffer */
+  UINT16_TO_BE_STREAM(p_param_len, (uint16_t)(p - p_param_len - 2));
+
+  p_ccb->disc_state = SDP_DISC_WAIT_DB_STATE;
+
+  /* Set the length of the SDP data in the buffer */
+  p_cmd->len = (uint16_t)(p - p_start);
+
+  L2CA_DataWrite(p_ccb->connection_id, p_cmd);
+
+  /* Start inactivity timer */
+  alarm_set_on_mloop(p_ccb->sdp_conn_timer, SDP_INACT_TIMEOUT_MS,
+                     sdp_conn_timer_timeout, p_ccb);
+}
+
 /*******************************************************************************
  *
  * Function         sdp_disc_connected
@@ -210,6 +369,12 @@ static void sdp_snd_service_search_req(tCONN_CB* p_ccb, uint8_t cont_len,
  ******************************************************************************/
 void sdp_disc_connected(tCONN_CB* p_ccb) {
   if (p_ccb->is_attr_search) {
+    if (sdp_disc_cache_enabled() &&
+        !sdp_disc_cache_lacks_db_state(p_ccb->device_address)) {
+      sdp_snd_db_state_req(p_ccb);
+      return;
+    }
+
     p_ccb->disc_state = SDP_DISC_WAIT_SEARCH_ATTR;
 
     process_service_search_attr_rsp(p_ccb, NULL, NULL);
@@ -272,6 +437,17 @@ void sdp_disc_server_rsp(tCONN_CB* p_ccb, BT_HDR* p_msg) {
       if (p_ccb->disc_state == SDP_DISC_WAIT_SEARCH_ATTR) {
         process_service_search_attr_rsp(p_ccb, p, p_end);
         invalid_pdu = false;
+      } else if (p_ccb->disc_state == SDP_DISC_WAIT_DB_STATE) {
+        process_db_state_rsp(p_ccb, p, p_end);
+        invalid_pdu = false;
+      }
+      break;
+
+    case SDP_PDU_ERROR_RESPONSE:
+      /* The state query is optional, carry on without the cache */
+      if (p_ccb->disc_state == SDP_DISC_WAIT_DB_STATE) {
+        process_db_state_rsp(p_ccb, NULL, NULL);
+        invalid_pdu = false;
       }
       break;
   }
@@ -543,9 +719,7 @@ static void process_service_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
  ******************************************************************************/
 static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                             uint8_t* p_reply_end) {
-  uint8_t *p, *p_start, *p_end, *p_param_len;
-  uint8_t type;
-  uint32_t seq_len;
+  uint8_t *p_start, *p_param_len;
   uint16_t param_len, lists_byte_count = 0;
   bool cont_request_needed = false;
 
@@ -661,9 +835,104 @@ static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
     return;
   }
 
-/*******************************************************************/
-/* We now have the full response, which is a sequence of sequences */
-/*******************************************************************/
+  save_search_attr_list(p_ccb, false);
+}
+
+/*******************************************************************************
+ *
+ * Function         process_db_state_rsp
+ *
+ * Description      This function is called when there is a response to the
+ *                  service database state query, or with a NULL reply if the
+ *                  server rejected it. If the state matches the one the saved
+ *                  response list was received with, that list is parsed
+ *                  instead of searching the server again.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void process_db_state_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
+                                 uint8_t* p_reply_end) {
+  uint16_t lists_byte_count;
+  uint8_t* p_end;
+  uint8_t type;
+  uint32_t seq_len;
+
+  /* Expect a sequence holding the attribute sequence of the SDP server
+   * record, with the state as its only attribute. Anything else, such as a
+   * truncated response, is treated as an unknown state. */
+  if (p_reply && p_reply + 4 + sizeof(lists_byte_count) <= p_reply_end) {
+    /* Skip transaction ID and length */
+    p_reply += 4;
+    BE_STREAM_TO_UINT16(lists_byte_count, p_reply);
+    if (lists_byte_count < p_reply_end - p_reply &&
+        p_reply[lists_byte_count] == 0 /* continuation */) {
+      p_end = p_reply + lists_byte_count;
+      for (int i = 0; i < 2 && p_reply; i++) {
+        if (p_reply >= p_end) {
+          p_reply = NULL;
+          break;
+        }
+        type = *p_reply++;
+        if ((type >> 3) != DATA_ELE_SEQ_DESC_TYPE) {
+          p_reply = NULL;
+          break;
+        }
+        p_reply = sdpu_get_len_from_type(p_reply, p_end, type, &seq_len);
+        if (p_reply && seq_len <= (uint32_t)(p_end - p_reply))
+          p_end = p_reply + seq_len;
+        else
+          p_reply = NULL;
+      }
+      if (p_reply && p_reply + 8 <= p_end &&
+          p_reply[0] == ((UINT_DESC_TYPE << 3) | SIZE_TWO_BYTES) &&
+          p_reply[1] == (ATTR_ID_SERVICE_DATABASE_STATE >> 8) &&
+          p_reply[2] == (ATTR_ID_SERVICE_DATABASE_STATE & 0xff) &&
+          p_reply[3] == ((UINT_DESC_TYPE << 3) | SIZE_FOUR_BYTES)) {
+        p_reply += 4;
+        BE_STREAM_TO_UINT32(p_ccb->db_state, p_reply);
+        p_ccb->db_state_valid = true;
+      }
+    }
+  }
+
+  p_ccb->disc_state = SDP_DISC_WAIT_SEARCH_ATTR;
+
+  if (p_ccb->db_state_valid) {
+    const tSDP_DISC_CACHE_ENTRY* p_entry = sdp_disc_cache_find(p_ccb);
+
+    if (p_entry && p_entry->has_db_state &&
+        p_entry->db_state == p_ccb->db_state) {
+      LOG_VERBOSE("Service database state 0x%08x unchanged, using saved list",
+                  p_ccb->db_state);
+      if (p_ccb->rsp_list == NULL)
+        p_ccb->rsp_list = (uint8_t*)osi_malloc(SDP_MAX_LIST_BYTE_COUNT);
+      memcpy(p_ccb->rsp_list, p_entry->rsp_list.data(),
+             p_entry->rsp_list.size());
+      p_ccb->list_len = p_entry->rsp_list.size();
+      save_search_attr_list(p_ccb, true);
+      return;
+    }
+  }
+
+  process_service_search_attr_rsp(p_ccb, NULL, NULL);
+}
+
+/*******************************************************************************
+ *
+ * Function         save_search_attr_list
+ *
+ * Description      This function parses the full service search attribute
+ *                  response list, which is a sequence of sequences, into the
+ *                  discovery database and completes the discovery.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void save_search_attr_list(tCONN_CB* p_ccb, bool from_cache) {
+  uint8_t *p, *p_end;
+  uint8_t type;
+  uint32_t seq_len;
 
   if (!sdp_copy_raw_data(p_ccb, true)) {
     LOG_ERROR("sdp_copy_raw_data failed");
@@ -702,6 +971,8 @@ static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
     }
   }
 
+  if (!from_cache) sdp_disc_cache_store(p_ccb);
+
   /* Since we got everything we need, disconnect the call */
   sdpu_log_attribute_metrics(p_ccb->device_address, p_ccb->p_db);
   sdp_disconnect(p_ccb, SDP_SUCCESS);
@@ -103,6 +103,7 @@ void sdp_free(void) {
     alarm_free(sdp_cb.ccb[i].sdp_conn_timer);
     sdp_cb.ccb[i].sdp_conn_timer = NULL;
   }
+  sdp_disc_cache_clear();
 }
 
 /*******************************************************************************
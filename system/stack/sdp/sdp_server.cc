@@ -54,15 +54,12 @@
 #define HFP_PROFILE_MINOR_VERSION_6 0x06
 #define HFP_PROFILE_MINOR_VERSION_7 0x07
 #define HFP_PROFILE_MINOR_VERSION_9 0x09
-#define PBAP_GOEP_L2CAP_PSM_LEN 0x06
-#define PBAP_SUPP_FEA_LEN 0x08
 
 #ifndef SDP_ENABLE_PTS_PBAP
 #define SDP_ENABLE_PTS_PBAP "bluetooth.pts.pbap"
 #endif
 
 #define PBAP_1_2 0x0102
-#define PBAP_1_2_BL_LEN 14
 
 /* Used to set PBAP local SDP device record for PBAP 1.2 upgrade */
 typedef struct {
@@ -96,9 +93,6 @@ void hfp_fallback(bool& is_hfp_fallback, const tSDP_ATTRIBUTE* p_attr);
 static bool is_device_in_allowlist_for_pbap(RawAddress remote_address,
                                             bool check_for_1_2);
 
-static uint16_t sdp_pbap_pse_dynamic_attributes_len_update(
-    tCONN_CB* p_ccb, tSDP_ATTR_SEQ* attr_seq, tSDP_UUID_SEQ* uid_seq);
-
 static const tSDP_RECORD* sdp_upgrade_pse_record(const tSDP_RECORD* p_rec,
                                                  RawAddress remote_address);
 
@@ -510,7 +504,6 @@ static void process_service_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     p_rsp = &p_ccb->rsp_list[3]; /* Leave space for data elem descr */
 
     /* Reset continuation parameters in p_ccb */
-    p_ccb->cont_info.prev_sdp_rec = NULL;
     p_ccb->cont_info.next_attr_index = 0;
     p_ccb->cont_info.attr_offset = 0;
   }
@@ -678,133 +671,93 @@ static void process_service_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
 
 /*******************************************************************************
  *
- * Function         process_service_search_attr_req
+ * Function         sdp_search_attr_record
  *
- * Description      This function handles a combined service search and
- *                  attribute read request from the client. It builds a reply
- *                  message with info from the database, and sends the reply
- *                  back to the client.
+ * Description      This function returns the record to build the response
+ *                  from, for a record matching a service search attribute
+ *                  request of the peer.
  *
- * Returns          void
+ * Returns          Pointer to the record
  *
  ******************************************************************************/
-static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
-                                            uint16_t param_len, uint8_t* p_req,
-                                            uint8_t* p_req_end) {
-  uint16_t max_list_len;
-  int16_t rem_len;
-  uint16_t len_to_send, cont_offset;
-  tSDP_UUID_SEQ uid_seq;
-  uint8_t *p_rsp, *p_rsp_start, *p_rsp_param_len;
-  uint16_t rsp_param_len, xx;
-  const tSDP_RECORD* p_rec;
-  tSDP_RECORD* p_prev_rec;
-  tSDP_ATTR_SEQ attr_seq, attr_seq_sav;
-  const tSDP_ATTRIBUTE* p_attr;
-  bool maxxed_out = false, is_cont = false;
-  uint8_t* p_seq_start;
-  bool is_hfp_fallback = false;
-  uint16_t seq_len, attr_len;
-
-  /* Extract the UUID sequence to search for */
-  p_req = sdpu_extract_uid_seq(p_req, param_len, &uid_seq);
-
-  if ((!p_req) || (!uid_seq.num_uids) ||
-      (p_req + sizeof(uint16_t) > p_req_end)) {
-    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_REQ_SYNTAX,
-                            SDP_TEXT_BAD_UUID_LIST);
-    return;
-  }
-
-  /* Get the max list length we can send. Cap it at our max list length. */
-  BE_STREAM_TO_UINT16(max_list_len, p_req);
-
-  if (max_list_len > (p_ccb->rem_mtu_size - SDP_MAX_SERVATTR_RSPHDR_LEN))
-    max_list_len = p_ccb->rem_mtu_size - SDP_MAX_SERVATTR_RSPHDR_LEN;
-
-  param_len = static_cast<uint16_t>(p_req_end - p_req);
-  p_req = sdpu_extract_attr_seq(p_req, param_len, &attr_seq);
-
-  if ((!p_req) || (!attr_seq.num_attr) ||
-      (p_req + sizeof(uint8_t) > p_req_end)) {
-    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_REQ_SYNTAX,
-                            SDP_TEXT_BAD_ATTR_LIST);
-    return;
-  }
-
-  memcpy(&attr_seq_sav, &attr_seq, sizeof(tSDP_ATTR_SEQ));
-
-  if (max_list_len < 4) {
-    sdpu_build_n_send_error(p_ccb, trans_num, SDP_ILLEGAL_PARAMETER, NULL);
-    return;
+static const tSDP_RECORD* sdp_search_attr_record(const tSDP_RECORD* p_rec,
+                                                 tCONN_CB* p_ccb) {
+  if (bluetooth::common::init_flags::
+          pbap_pse_dynamic_version_upgrade_is_enabled()) {
+    return sdp_upgrade_pse_record(p_rec, p_ccb->device_address);
   }
+  LOG_WARN("PBAP PSE dynamic version upgrade is not enabled");
+  return p_rec;
+}
 
-  /* Free and reallocate buffer */
-  osi_free(p_ccb->rsp_list);
-  p_ccb->rsp_list = (uint8_t*)osi_malloc(max_list_len);
-
-  /* Check if this is a continuation request */
-  if (p_req + 1 > p_req_end) {
-    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
-                            SDP_TEXT_BAD_CONT_LEN);
-    return;
+/*******************************************************************************
+ *
+ * Function         sdp_get_search_attr_list_len
+ *
+ * Description      This function gets the length of the response list of a
+ *                  service search attribute request, without the header of
+ *                  the outer data element sequence.
+ *
+ * Returns          the length of the list
+ *
+ ******************************************************************************/
+static uint32_t sdp_get_search_attr_list_len(tCONN_CB* p_ccb,
+                                             const tSDP_UUID_SEQ* p_uid_seq,
+                                             const tSDP_ATTR_SEQ* p_attr_seq) {
+  const tSDP_RECORD* p_rec;
+  uint32_t len = 0;
+  uint16_t seq_len;
+
+  for (p_rec = sdp_db_service_search(NULL, p_uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_rec, p_uid_seq)) {
+    seq_len =
+        sdpu_get_attrib_seq_len(sdp_search_attr_record(p_rec, p_ccb), p_attr_seq);
+    if (seq_len != 0) len += 3 + seq_len;
   }
-  if (*p_req) {
-    if (*p_req++ != SDP_CONTINUATION_LEN ||
-        (p_req + sizeof(uint16_t) > p_req_end)) {
-      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
-                              SDP_TEXT_BAD_CONT_LEN);
-      return;
-    }
-    BE_STREAM_TO_UINT16(cont_offset, p_req);
-
-    if (cont_offset != p_ccb->cont_offset) {
-      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
-                              SDP_TEXT_BAD_CONT_INX);
-      return;
-    }
-    is_cont = true;
-
-    /* Initialise for continuation response */
-    p_rsp = &p_ccb->rsp_list[0];
-    attr_seq.attr_entry[p_ccb->cont_info.next_attr_index].start =
-        p_ccb->cont_info.next_attr_start_id;
-  } else {
-    p_ccb->cont_offset = 0;
-    p_rsp = &p_ccb->rsp_list[3]; /* Leave space for data elem descr */
+  return len;
+}
 
-    /* Reset continuation parameters in p_ccb */
-    p_ccb->cont_info.prev_sdp_rec = NULL;
-    p_ccb->cont_info.next_attr_index = 0;
-    p_ccb->cont_info.last_attr_seq_desc_sent = false;
-    p_ccb->cont_info.attr_offset = 0;
-  }
+/*******************************************************************************
+ *
+ * Function         sdp_build_search_attr_list
+ *
+ * Description      This function builds the complete response list of a
+ *                  service search attribute request, with the peer specific
+ *                  attribute values, so continuation requests are served from
+ *                  it.
+ *
+ * Returns          the length of the list, 0 if it did not fit in the buffer
+ *
+ ******************************************************************************/
+static uint16_t sdp_build_search_attr_list(tCONN_CB* p_ccb,
+                                           const tSDP_UUID_SEQ* p_uid_seq,
+                                           const tSDP_ATTR_SEQ* p_attr_seq,
+                                           uint8_t* p_out, uint32_t max_len) {
+  uint8_t* p_rsp = p_out + 3; /* Leave space for data elem descr */
+  uint8_t* p_end = p_out + max_len;
+  uint8_t* p_seq_start;
+  const tSDP_RECORD* p_rec;
+  const tSDP_RECORD* p_prev_rec;
+  const tSDP_ATTRIBUTE* p_attr = NULL;
+  tSDP_ATTR_SEQ attr_seq;
+  bool maxxed_out = false;
+  bool is_hfp_fallback = false;
+  uint16_t xx, seq_len, attr_len;
+  uint32_t list_len;
 
-  /* Get a list of handles that match the UUIDs given to us */
-  for (p_rec = sdp_db_service_search(p_ccb->cont_info.prev_sdp_rec, &uid_seq);
-       p_rec; p_rec = sdp_db_service_search(p_rec, &uid_seq)) {
+  for (p_rec = sdp_db_service_search(NULL, p_uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_prev_rec, p_uid_seq)) {
     /* Store the actual record pointer which would be reused later */
-    p_prev_rec = (tSDP_RECORD*)p_rec;
-    if (bluetooth::common::init_flags::
-            pbap_pse_dynamic_version_upgrade_is_enabled()) {
-      p_rec = sdp_upgrade_pse_record(p_rec, p_ccb->device_address);
-    } else {
-      LOG_WARN("PBAP PSE dynamic version upgrade is not enabled");
-    }
+    p_prev_rec = p_rec;
+    p_rec = sdp_search_attr_record(p_rec, p_ccb);
+
     /* Allow space for attribute sequence type and length */
-    p_seq_start = p_rsp;
-    if (!p_ccb->cont_info.last_attr_seq_desc_sent) {
-      /* See if there is enough room to include a new service in the current
-       * response */
-      rem_len = max_list_len - (int16_t)(p_rsp - &p_ccb->rsp_list[0]);
-      if (rem_len < 3) {
-        /* Not enough room. Update continuation info for next response */
-        p_ccb->cont_info.next_attr_index = 0;
-        p_ccb->cont_info.next_attr_start_id = attr_seq.attr_entry[0].start;
-        break;
-      }
-      p_rsp += 3;
+    if (p_end - p_rsp < 3) {
+      maxxed_out = true;
+      break;
     }
+    p_seq_start = p_rsp;
+    p_rsp += 3;
 
     bool is_service_avrc_target = false;
     const tSDP_ATTRIBUTE* p_attr_service_id;
@@ -818,8 +771,9 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
       is_service_avrc_target =
           sdpu_is_service_id_avrc_target(p_attr_service_id);
     }
-    /* Get a list of handles that match the UUIDs given to us */
-    for (xx = p_ccb->cont_info.next_attr_index; xx < attr_seq.num_attr; xx++) {
+
+    memcpy(&attr_seq, p_attr_seq, sizeof(tSDP_ATTR_SEQ));
+    for (xx = 0; xx < attr_seq.num_attr; xx++) {
       p_attr = sdp_db_find_attr_in_rec(p_rec, attr_seq.attr_entry[xx].start,
                                        attr_seq.attr_entry[xx].end);
 
@@ -841,55 +795,13 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
           is_hfp_fallback =
               sdp_dynamic_change_hfp_version(p_attr, p_ccb->device_address);
         }
-        /* Check if attribute fits. Assume 3-byte value type/length */
-        rem_len = max_list_len - (int16_t)(p_rsp - &p_ccb->rsp_list[0]);
-
-        /* just in case */
-        if (rem_len <= 0) {
-          p_ccb->cont_info.next_attr_index = xx;
-          p_ccb->cont_info.next_attr_start_id = p_attr->id;
-          maxxed_out = true;
-          break;
-        }
 
         attr_len = sdpu_get_attrib_entry_len(p_attr);
-        /* if there is a partial attribute pending to be sent */
-        if (p_ccb->cont_info.attr_offset) {
-          if (attr_len < p_ccb->cont_info.attr_offset) {
-            LOG(ERROR) << "offset is bigger than attribute length";
-            sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
-                                    SDP_TEXT_BAD_CONT_LEN);
-            return;
-          }
-          p_rsp = sdpu_build_partial_attrib_entry(
-              p_rsp, p_attr, rem_len, &p_ccb->cont_info.attr_offset);
-
-          /* If the partial attrib could not been fully added yet */
-          if (p_ccb->cont_info.attr_offset != attr_len) {
-            maxxed_out = true;
-            break;
-          } else /* If the partial attrib has been added in full by now */
-            p_ccb->cont_info.attr_offset = 0; /* reset attr_offset */
-        } else if (rem_len <
-                   attr_len) /* Not enough space for attr... so add partially */
-        {
-          if (attr_len >= SDP_MAX_ATTR_LEN) {
-            LOG_ERROR("SDP attr too big: max_list_len=%d,attr_len=%d",
-                      max_list_len, attr_len);
-            sdpu_build_n_send_error(p_ccb, trans_num, SDP_NO_RESOURCES, NULL);
-            return;
-          }
-
-          /* add the partial attribute if possible */
-          p_rsp = sdpu_build_partial_attrib_entry(
-              p_rsp, p_attr, (uint16_t)rem_len, &p_ccb->cont_info.attr_offset);
-
-          p_ccb->cont_info.next_attr_index = xx;
-          p_ccb->cont_info.next_attr_start_id = p_attr->id;
+        if (p_end - p_rsp < attr_len) {
           maxxed_out = true;
           break;
-        } else /* build the whole attribute */
-          p_rsp = sdpu_build_attrib_entry(p_rsp, p_attr);
+        }
+        p_rsp = sdpu_build_attrib_entry(p_rsp, p_attr);
 
         /* If doing a range, stick with this one till no more attributes found
          */
@@ -908,104 +820,139 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
       hfp_fallback(is_hfp_fallback, p_attr);
     }
 
+    if (maxxed_out) break;
+
     /* Go back and put the type and length into the buffer */
-    if (!p_ccb->cont_info.last_attr_seq_desc_sent) {
-      seq_len = sdpu_get_attrib_seq_len(p_rec, &attr_seq_sav);
-      if (seq_len != 0) {
-        UINT8_TO_BE_STREAM(p_seq_start,
-                           (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
-        UINT16_TO_BE_STREAM(p_seq_start, seq_len);
-
-        if (maxxed_out) p_ccb->cont_info.last_attr_seq_desc_sent = true;
-      } else
-        p_rsp = p_seq_start;
-    }
+    seq_len = (uint16_t)(p_rsp - p_seq_start - 3);
+    if (seq_len != 0) {
+      UINT8_TO_BE_STREAM(p_seq_start,
+                         (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
+      UINT16_TO_BE_STREAM(p_seq_start, seq_len);
+    } else
+      p_rsp = p_seq_start;
+  }
 
-    if (maxxed_out) break;
+  if (maxxed_out) {
+    LOG_ERROR("SDP attribute list too big: max_len=%u", max_len);
+    return 0;
+  }
+
+  /* Put in the sequence header (2 or 3 bytes) */
+  list_len = (uint32_t)(p_rsp - p_out - 3);
+  if (list_len + 3 > 255) {
+    p_out[0] = (uint8_t)((DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
+    p_out[1] = (uint8_t)(list_len >> 8);
+    p_out[2] = (uint8_t)list_len;
+    return (uint16_t)(list_len + 3);
+  }
 
-    /* Restore the attr_seq to look for in the next sdp record */
-    memcpy(&attr_seq, &attr_seq_sav, sizeof(tSDP_ATTR_SEQ));
+  p_out[0] = (uint8_t)((DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_BYTE);
+  p_out[1] = (uint8_t)list_len;
+  memmove(&p_out[2], &p_out[3], list_len);
+  return (uint16_t)(list_len + 2);
+}
 
-    /* Reset the next attr index */
-    p_ccb->cont_info.next_attr_index = 0;
-    /* restore the record pointer.*/
-    p_rec = p_prev_rec;
-    p_ccb->cont_info.prev_sdp_rec = p_rec;
-    p_ccb->cont_info.last_attr_seq_desc_sent = false;
+/*******************************************************************************
+ *
+ * Function         process_service_search_attr_req
+ *
+ * Description      This function handles a combined service search and
+ *                  attribute read request from the client. It builds a reply
+ *                  message with info from the database, and sends the reply
+ *                  back to the client.
+ *
+ *                  The whole response list is built on the first request of
+ *                  the client, continuation requests only send the next part
+ *                  of it.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
+                                            uint16_t param_len, uint8_t* p_req,
+                                            uint8_t* p_req_end) {
+  uint16_t max_list_len;
+  uint16_t len_to_send, cont_offset;
+  uint32_t list_len;
+  tSDP_UUID_SEQ uid_seq;
+  uint8_t *p_rsp, *p_rsp_start, *p_rsp_param_len;
+  uint16_t rsp_param_len;
+  tSDP_ATTR_SEQ attr_seq;
+
+  /* Extract the UUID sequence to search for */
+  p_req = sdpu_extract_uid_seq(p_req, param_len, &uid_seq);
+
+  if ((!p_req) || (!uid_seq.num_uids) ||
+      (p_req + sizeof(uint16_t) > p_req_end)) {
+    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_REQ_SYNTAX,
+                            SDP_TEXT_BAD_UUID_LIST);
+    return;
   }
 
-  /* response length */
-  len_to_send = (uint16_t)(p_rsp - &p_ccb->rsp_list[0]);
-  cont_offset = 0;
+  /* Get the max list length we can send. Cap it at our max list length. */
+  BE_STREAM_TO_UINT16(max_list_len, p_req);
+
+  if (max_list_len > (p_ccb->rem_mtu_size - SDP_MAX_SERVATTR_RSPHDR_LEN))
+    max_list_len = p_ccb->rem_mtu_size - SDP_MAX_SERVATTR_RSPHDR_LEN;
 
-  // The current SDP server design has a critical flaw where it can run into
-  // an infinite request/response loop with the client. Here's the scenario:
-  // - client makes SDP request
-  // - server returns the first fragment of the response with a continuation
-  //   token
-  // - an SDP record is deleted from the server
-  // - client issues another request with previous continuation token
-  // - server has nothing to send back because the record is unavailable but
-  //   in the first fragment, it had specified more response bytes than are
-  //   now available
-  // - server sends back no additional response bytes and returns the same
-  //   continuation token
-  // - client issues another request with the continuation token, and the
-  //   process repeats
-  //
-  // We work around this design flaw here by checking if we will make forward
-  // progress (i.e. we will send > 0 response bytes) on a continued request.
-  // If not, we must have run into the above situation and we tell the peer an
-  // error occurred.
-  //
-  // TODO(sharvil): rewrite SDP server.
-  if (is_cont && len_to_send == 0) {
-    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE, NULL);
+  param_len = static_cast<uint16_t>(p_req_end - p_req);
+  p_req = sdpu_extract_attr_seq(p_req, param_len, &attr_seq);
+
+  if ((!p_req) || (!attr_seq.num_attr) ||
+      (p_req + sizeof(uint8_t) > p_req_end)) {
+    sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_REQ_SYNTAX,
+                            SDP_TEXT_BAD_ATTR_LIST);
     return;
   }
 
-  /* If first response, insert sequence header */
-  if (!is_cont) {
-    /* Get the total list length for requested uid and attribute sequence */
-    p_ccb->list_len = sdpu_get_list_len(&uid_seq, &attr_seq_sav) + 3;
-
-    /* Get the length of denylisted attributes to be updated if device is
-     * denylisted */
-    if (bluetooth::common::init_flags::
-            pbap_pse_dynamic_version_upgrade_is_enabled()) {
-      p_ccb->pse_dynamic_attributes_len =
-          sdp_pbap_pse_dynamic_attributes_len_update(p_ccb, &attr_seq_sav,
-                                                     &uid_seq);
-    } else {
-      LOG_WARN("PBAP PSE dynamic version upgrade is not enabled");
-      p_ccb->pse_dynamic_attributes_len = 0;
-    }
+  if (max_list_len < 4) {
+    sdpu_build_n_send_error(p_ccb, trans_num, SDP_ILLEGAL_PARAMETER, NULL);
+    return;
+  }
 
-    LOG_VERBOSE("p_ccb->list_len = %d pse_dynamic_attributes_len = %d",
-                p_ccb->list_len, p_ccb->pse_dynamic_attributes_len);
+  /* Check if this is a continuation request */
+  if (*p_req) {
+    if (*p_req++ != SDP_CONTINUATION_LEN ||
+        (p_req + sizeof(uint16_t) > p_req_end)) {
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
+                              SDP_TEXT_BAD_CONT_LEN);
+      return;
+    }
+    BE_STREAM_TO_UINT16(cont_offset, p_req);
 
-    /* Put in the sequence header (2 or 3 bytes) */
-    if (p_ccb->list_len > 255) {
-      p_ccb->rsp_list[0] =
-          (uint8_t)((DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
-      p_ccb->rsp_list[1] =
-          (uint8_t)((p_ccb->list_len - 3 + p_ccb->pse_dynamic_attributes_len) >>
-                    8);
-      p_ccb->rsp_list[2] =
-          (uint8_t)(p_ccb->list_len - 3 + p_ccb->pse_dynamic_attributes_len);
-    } else {
-      cont_offset = 1;
+    if (p_ccb->search_attr_list == NULL || cont_offset != p_ccb->cont_offset ||
+        cont_offset >= p_ccb->search_attr_list_len) {
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
+                              SDP_TEXT_BAD_CONT_INX);
+      return;
+    }
+  } else {
+    /* Build the whole response list */
+    osi_free_and_reset((void**)&p_ccb->search_attr_list);
+    p_ccb->search_attr_list_len = 0;
+    p_ccb->cont_offset = 0;
 
-      p_ccb->rsp_list[1] =
-          (uint8_t)((DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_BYTE);
-      p_ccb->rsp_list[2] =
-          (uint8_t)(p_ccb->list_len - 3 + p_ccb->pse_dynamic_attributes_len);
+    list_len = sdp_get_search_attr_list_len(p_ccb, &uid_seq, &attr_seq) + 3;
+    if (list_len > UINT16_MAX) {
+      LOG_ERROR("SDP attribute list too big: list_len=%u", list_len);
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_NO_RESOURCES, NULL);
+      return;
+    }
 
-      p_ccb->list_len--;
-      len_to_send--;
+    p_ccb->search_attr_list = (uint8_t*)osi_malloc(list_len);
+    p_ccb->search_attr_list_len = sdp_build_search_attr_list(
+        p_ccb, &uid_seq, &attr_seq, p_ccb->search_attr_list, list_len);
+    if (p_ccb->search_attr_list_len == 0) {
+      osi_free_and_reset((void**)&p_ccb->search_attr_list);
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_NO_RESOURCES, NULL);
+      return;
     }
   }
 
+  /* response length */
+  len_to_send = p_ccb->search_attr_list_len - p_ccb->cont_offset;
+  if (len_to_send > max_list_len) len_to_send = max_list_len;
+
   /* Get a buffer to use to build the response */
   BT_HDR* p_buf = (BT_HDR*)osi_malloc(SDP_DATA_BUF_SIZE);
   p_buf->offset = L2CAP_MIN_OFFSET;
@@ -1022,28 +969,22 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
   /* Stream the list length to send */
   UINT16_TO_BE_STREAM(p_rsp, len_to_send);
 
-  /* copy from rsp_list to the actual buffer to be sent */
-  memcpy(p_rsp, &p_ccb->rsp_list[cont_offset], len_to_send);
+  /* copy from the response list to the actual buffer to be sent */
+  memcpy(p_rsp, &p_ccb->search_attr_list[p_ccb->cont_offset], len_to_send);
   p_rsp += len_to_send;
 
   p_ccb->cont_offset += len_to_send;
 
-  LOG_VERBOSE(
-      "p_ccb->pse_dynamic_attributes_len %d, cont_offset = %d, p_ccb->list_len "
-      "= %d",
-      p_ccb->pse_dynamic_attributes_len, p_ccb->cont_offset,
-      p_ccb->list_len + p_ccb->pse_dynamic_attributes_len);
+  LOG_VERBOSE("cont_offset = %d, search_attr_list_len = %d",
+              p_ccb->cont_offset, p_ccb->search_attr_list_len);
   /* If anything left to send, continuation needed */
-  if (p_ccb->cont_offset <
-      (p_ccb->list_len + p_ccb->pse_dynamic_attributes_len)) {
-    is_cont = true;
+  if (p_ccb->cont_offset < p_ccb->search_attr_list_len) {
     UINT8_TO_BE_STREAM(p_rsp, SDP_CONTINUATION_LEN);
     UINT16_TO_BE_STREAM(p_rsp, p_ccb->cont_offset);
   } else {
     UINT8_TO_BE_STREAM(p_rsp, 0);
-    if (p_ccb->pse_dynamic_attributes_len) {
-      p_ccb->pse_dynamic_attributes_len = 0;
-    }
+    osi_free_and_reset((void**)&p_ccb->search_attr_list);
+    p_ccb->search_attr_list_len = 0;
   }
 
   /* Go back and put the parameter length into the buffer */
@@ -1094,102 +1035,6 @@ static bool is_device_in_allowlist_for_pbap(RawAddress remote_address,
   return false;
 }
 
-/*************************************************************************************
-**
-** Function        sdp_pbap_pse_dynamic_attributes_len_update
-**
-** Description      length of the attributes need to be added in final sdp
-*response len
-**
-** Returns         returns the length of denylisted attributes.
-**
-***************************************************************************************/
-static uint16_t sdp_pbap_pse_dynamic_attributes_len_update(
-    tCONN_CB* p_ccb, tSDP_ATTR_SEQ* attr_seq, tSDP_UUID_SEQ* uid_seq) {
-  if (!p_ccb || !attr_seq || !uid_seq) return 0;
-  const tSDP_RECORD* p_rec;
-
-  p_ccb->pse_dynamic_attributes_len = 0;
-
-  // Check to validate if 1.2 record is getting sent
-  bool is_pbap_102_supported =
-      btif_storage_is_pce_version_102(p_ccb->device_address);
-  bool is_pbap_101_allowlisted =
-      is_device_in_allowlist_for_pbap(p_ccb->device_address, false);
-  bool is_pbap_102_allowlisted =
-      is_device_in_allowlist_for_pbap(p_ccb->device_address, true);
-  bool running_pts = osi_property_get_bool(SDP_ENABLE_PTS_PBAP, false);
-
-  LOG_VERBOSE(
-      "remote BD Addr : %s is_pbap_102_supported = %d "
-      "is_pbap_101_allowlisted = %d is_pbap_102_allowlisted = %d "
-      "running_pts = %d",
-      ADDRESS_TO_LOGGABLE_CSTR(p_ccb->device_address), is_pbap_102_supported,
-      is_pbap_101_allowlisted, is_pbap_102_allowlisted, running_pts);
-
-  if (is_pbap_101_allowlisted ||
-      (!is_pbap_102_supported && !is_pbap_102_allowlisted && !running_pts)) {
-    // Send Length without any update
-    return p_ccb->pse_dynamic_attributes_len;
-  }
-
-  int xx;
-  tSDP_ATTRIBUTE attr;
-  for (p_rec = (tSDP_RECORD*)sdp_db_service_search(NULL, uid_seq); p_rec;
-       p_rec = (tSDP_RECORD*)sdp_db_service_search(p_rec, uid_seq)) {
-    attr = p_rec->attribute[1];
-    if ((attr.id == ATTR_ID_SERVICE_CLASS_ID_LIST) &&
-        (((attr.value_ptr[1] << 8) | (attr.value_ptr[2])) ==
-         UUID_SERVCLASS_PBAP_PSE)) {
-      // PBAP PSE Record
-      p_rec = sdp_upgrade_pse_record(p_rec, p_ccb->device_address);
-      LOG_VERBOSE("response has PBAP PSE record for allowlist device");
-
-      int att_index;
-      bool l2cap_psm_len_included = false, supp_attr_len_included = false;
-      for (xx = p_ccb->cont_info.next_attr_index; xx < attr_seq->num_attr;
-           xx++) {
-        LOG_VERBOSE(
-            "xx = %d attr_seq->num_attr = %d, "
-            "attr_seq->attr_entry[xx].start = %d , "
-            "attr_seq->attr_entry[xx].end = %d",
-            xx, attr_seq->num_attr, attr_seq->attr_entry[xx].start,
-            attr_seq->attr_entry[xx].end);
-
-        for (att_index = 0; att_index < p_rec->num_attributes; att_index++) {
-          tSDP_ATTRIBUTE cur_attr = p_rec->attribute[att_index];
-          if (cur_attr.id == ATTR_ID_GOEP_L2CAP_PSM &&
-              !l2cap_psm_len_included &&
-              cur_attr.id >= attr_seq->attr_entry[xx].start &&
-              cur_attr.id <= attr_seq->attr_entry[xx].end) {
-            l2cap_psm_len_included = true;
-            p_ccb->pse_dynamic_attributes_len += PBAP_GOEP_L2CAP_PSM_LEN;
-            LOG_ERROR(
-                "ATTR_ID_GOEP_L2CAP_PSM requested,"
-                " need to change length by %d",
-                p_ccb->pse_dynamic_attributes_len);
-          } else if (cur_attr.id == ATTR_ID_PBAP_SUPPORTED_FEATURES &&
-                     !supp_attr_len_included &&
-                     cur_attr.id >= attr_seq->attr_entry[xx].start &&
-                     cur_attr.id <= attr_seq->attr_entry[xx].end) {
-            supp_attr_len_included = true;
-            p_ccb->pse_dynamic_attributes_len += PBAP_SUPP_FEA_LEN;
-            LOG_VERBOSE(
-                "ATTR_ID_PBAP_SUPPORTED_FEATURES requested,"
-                " need to change length by %d",
-                p_ccb->pse_dynamic_attributes_len);
-          }
-        }
-        if (p_ccb->pse_dynamic_attributes_len == PBAP_1_2_BL_LEN) break;
-      }
-      break;
-    }
-  }
-  LOG_VERBOSE("pse_dynamic_attributes_len = %d",
-              p_ccb->pse_dynamic_attributes_len);
-  return p_ccb->pse_dynamic_attributes_len;
-}
-
 /*************************************************************************************
 **
 ** Function        sdp_upgrade_pbap_pse_record
@@ -447,6 +447,8 @@ void sdpu_release_ccb(tCONN_CB& ccb) {
   /* Free the response buffer */
   if (ccb.rsp_list) LOG_VERBOSE("releasing SDP rsp_list");
   osi_free_and_reset((void**)&ccb.rsp_list);
+  osi_free_and_reset((void**)&ccb.search_attr_list);
+  ccb.search_attr_list_len = 0;
 }
 
 /*******************************************************************************
@@ -1123,6 +1125,32 @@ bool sdpu_compare_uuid_arrays(const uint8_t* p_uuid1, uint32_t len1,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         sdpu_uuid_to_128bit
+ *
+ * Description      This function converts a 2, 4 or 16 byte UUID to its
+ *                  16 byte form, using the SDP base UUID.
+ *
+ * NOTE             Both UUIDs are in Big Endian order.
+ *
+ * Returns          true if converted, false if the length is invalid
+ *
+ ******************************************************************************/
+bool sdpu_uuid_to_128bit(const uint8_t* p_uuid, uint32_t len,
+                         uint8_t* p_uuid128) {
+  memcpy(p_uuid128, sdp_base_uuid, Uuid::kNumBytes128);
+
+  if (len == Uuid::kNumBytes16)
+    memcpy(p_uuid128 + 2, p_uuid, len);
+  else if (len == Uuid::kNumBytes32 || len == Uuid::kNumBytes128)
+    memcpy(p_uuid128, p_uuid, len);
+  else
+    return false;
+
+  return true;
+}
+
 /*******************************************************************************
  *
  * Function         sdpu_compare_uuid_with_attr
@@ -1205,35 +1233,6 @@ void sdpu_sort_attr_list(uint16_t num_attr, tSDP_DISCOVERY_DB* p_db) {
   }
 }
 
-/*******************************************************************************
- *
- * Function         sdpu_get_list_len
- *
- * Description      gets the total list length in the sdp database for a given
- *                  uid sequence and attr sequence
- *
- * Returns          void
- *
- ******************************************************************************/
-uint16_t sdpu_get_list_len(tSDP_UUID_SEQ* uid_seq, tSDP_ATTR_SEQ* attr_seq) {
-  const tSDP_RECORD* p_rec;
-  uint16_t len = 0;
-  uint16_t len1;
-
-  for (p_rec = sdp_db_service_search(NULL, uid_seq); p_rec;
-       p_rec = sdp_db_service_search(p_rec, uid_seq)) {
-    len += 3;
-
-    len1 = sdpu_get_attrib_seq_len(p_rec, attr_seq);
-
-    if (len1 != 0)
-      len += len1;
-    else
-      len -= 3;
-  }
-  return len;
-}
-
 /*******************************************************************************
  *
  * Function         sdpu_get_attrib_seq_len
@@ -60,6 +60,10 @@
 #define MAX_UUIDS_PER_SEQ 16
 #define MAX_ATTR_PER_SEQ 16
 
+/* Max number of distinct UUIDs indexed per record. Records with more UUIDs
+ * are searched by parsing their attributes. */
+#define SDP_MAX_REC_UUIDS 32
+
 /* Max length we support for any attribute */
 #ifdef SDP_MAX_ATTR_LEN
 #define MAX_ATTR_LEN SDP_MAX_ATTR_LEN
@@ -104,6 +108,13 @@ typedef struct {
   uint16_t num_attributes;
   tSDP_ATTRIBUTE attribute[SDP_MAX_REC_ATTR];
   uint8_t attr_pad[SDP_MAX_PAD_LEN];
+
+  /* Index of the UUIDs found in the attributes, in their 128-bit form. It is
+   * rebuilt on the next search once the attributes change. */
+  bool uuid_index_valid;
+  bool uuid_index_complete; /* false if the record has too many UUIDs */
+  uint16_t num_uuids;
+  uint8_t uuids[SDP_MAX_REC_UUIDS][bluetooth::Uuid::kNumBytes128];
 } tSDP_RECORD;
 
 /* Define the SDP database */
@@ -119,10 +130,6 @@ typedef struct {
   uint16_t next_attr_index;    /* attr index for next continuation response */
   uint16_t next_attr_start_id; /* attr id to start with for the attr index in
                                   next cont. response */
-  const tSDP_RECORD* prev_sdp_rec; /* last sdp record that was completely sent
-                                in the response */
-  bool last_attr_seq_desc_sent; /* whether attr seq length has been sent
-                                   previously */
   uint16_t attr_offset; /* offset within the attr to keep trak of partial
                            attributes in the responses */
 } tSDP_CONT_INFO;
@@ -170,7 +177,7 @@ enum : uint8_t {
   SDP_DISC_WAIT_HANDLES = 1,
   SDP_DISC_WAIT_ATTR = 2,
   SDP_DISC_WAIT_SEARCH_ATTR = 3,
-  SDP_DISC_WAIT_UNUSED4 = 4,
+  SDP_DISC_WAIT_DB_STATE = 4,
   SDP_DISC_WAIT_CANCEL = 5,
 };
 typedef uint8_t tSDP_DISC_WAIT;
@@ -185,9 +192,10 @@ struct tCONN_CB {
   uint16_t rem_mtu_size;
   uint16_t connection_id;
   uint16_t list_len; /* length of the response in the GKI buffer */
-  uint16_t pse_dynamic_attributes_len; /* length of the attributes need to be
-                             added in final sdp response len */
   uint8_t* rsp_list; /* pointer to GKI buffer holding response */
+  uint8_t* search_attr_list; /* complete service search attribute response
+                                list, continuations are served from it */
+  uint16_t search_attr_list_len;
 
   tSDP_DISCOVERY_DB* p_db; /* Database to save info into   */
   tSDP_DISC_CMPL_CB* p_cb; /* Callback for discovery done  */
@@ -203,6 +211,8 @@ struct tCONN_CB {
 
   uint8_t disc_state;
   bool is_attr_search;
+  bool db_state_valid; /* The peer reported its service database state */
+  uint32_t db_state;   /* Service database state reported by the peer */
 
   uint16_t cont_offset;     /* Continuation state data in the server response */
   tSDP_CONT_INFO cont_info; /* structure to hold continuation information for
@@ -219,6 +229,7 @@ inline std::string sdp_disc_wait_text(const tSDP_DISC_WAIT& state) {
     CASE_RETURN_TEXT(SDP_DISC_WAIT_HANDLES);
     CASE_RETURN_TEXT(SDP_DISC_WAIT_ATTR);
     CASE_RETURN_TEXT(SDP_DISC_WAIT_SEARCH_ATTR);
+    CASE_RETURN_TEXT(SDP_DISC_WAIT_DB_STATE);
     CASE_RETURN_TEXT(SDP_DISC_WAIT_CANCEL);
     default:
       return base::StringPrintf("UNKNOWN[%d]", state);
@@ -271,11 +282,12 @@ uint8_t* sdpu_get_len_from_type(uint8_t* p, uint8_t* p_end, uint8_t type,
 bool sdpu_is_base_uuid(uint8_t* p_uuid);
 bool sdpu_compare_uuid_arrays(const uint8_t* p_uuid1, uint32_t len1,
                               const uint8_t* p_uuid2, uint16_t len2);
+bool sdpu_uuid_to_128bit(const uint8_t* p_uuid, uint32_t len,
+                         uint8_t* p_uuid128);
 bool sdpu_compare_uuid_with_attr(const bluetooth::Uuid& uuid,
                                  tSDP_DISC_ATTR* p_attr);
 
 void sdpu_sort_attr_list(uint16_t num_attr, tSDP_DISCOVERY_DB* p_db);
-uint16_t sdpu_get_list_len(tSDP_UUID_SEQ* uid_seq, tSDP_ATTR_SEQ* attr_seq);
 uint16_t sdpu_get_attrib_seq_len(const tSDP_RECORD* p_rec,
                                  const tSDP_ATTR_SEQ* attr_seq);
 uint16_t sdpu_get_attrib_entry_len(const tSDP_ATTRIBUTE* p_attr);
@@ -320,6 +332,7 @@ void sdp_server_handle_client_req(tCONN_CB* p_ccb, BT_HDR* p_msg);
  */
 void sdp_disc_connected(tCONN_CB* p_ccb);
 void sdp_disc_server_rsp(tCONN_CB* p_ccb, BT_HDR* p_msg);
+void sdp_disc_cache_clear(void);
 
 void update_pce_entry_to_interop_database(RawAddress remote_addr);
 bool is_sdp_pbap_pce_disabled(RawAddress remote_addr);
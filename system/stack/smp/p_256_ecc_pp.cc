@@ -191,6 +191,168 @@ static void ECC_NAF(uint8_t* naf, uint32_t* NumNAF, uint32_t* k) {
   *NumNAF = i;
 }
 
+// Convert q to affine coordinates
+static void p_256_to_affine(Point* q) {
+  uint32_t z_inv[KEY_LENGTH_DWORDS_P256];
+
+  multiprecision_inv_mod(z_inv, q->z);
+  multiprecision_mersenns_squa_mod(q->z, z_inv);
+  multiprecision_mersenns_mult_mod(q->x, q->x, q->z);
+  multiprecision_mersenns_mult_mod(q->z, q->z, z_inv);
+  multiprecision_mersenns_mult_mod(q->y, q->y, q->z);
+}
+
+// Convert |count| points to affine coordinates with a single inversion
+static void p_256_normalize_points(Point* points, uint32_t count) {
+  uint32_t products[ECC_WINDOW_SIZE][KEY_LENGTH_DWORDS_P256];
+  uint32_t inv[KEY_LENGTH_DWORDS_P256];
+  uint32_t z_inv[KEY_LENGTH_DWORDS_P256];
+  uint32_t t[KEY_LENGTH_DWORDS_P256];
+
+  multiprecision_copy(products[0], points[0].z);
+  for (uint32_t i = 1; i < count; i++) {
+    multiprecision_mersenns_mult_mod(products[i], products[i - 1],
+                                     points[i].z);
+  }
+
+  multiprecision_copy(t, products[count - 1]);
+  multiprecision_inv_mod(inv, t);
+
+  for (uint32_t i = count; i-- > 0;) {
+    if (i > 0) {
+      multiprecision_mersenns_mult_mod(z_inv, inv, products[i - 1]);
+      multiprecision_mersenns_mult_mod(inv, inv, points[i].z);
+    } else {
+      multiprecision_copy(z_inv, inv);
+    }
+    multiprecision_mersenns_squa_mod(t, z_inv);
+    multiprecision_mersenns_mult_mod(points[i].x, points[i].x, t);
+    multiprecision_mersenns_mult_mod(t, t, z_inv);
+    multiprecision_mersenns_mult_mod(points[i].y, points[i].y, t);
+    multiprecision_init(points[i].z);
+    points[i].z[0] = 1;
+  }
+}
+
+// r = table[index], reading every entry so that the memory accesses do not
+// depend on the index
+static void p_256_select_point(Point* r, const Point* table, uint32_t size,
+                               uint32_t index) {
+  p_256_init_point(r);
+  for (uint32_t i = 0; i < size; i++) {
+    uint32_t diff = i ^ index;
+    // all ones if i == index
+    uint32_t mask = ((diff | (0u - diff)) >> 31) - 1;
+    for (int j = 0; j < KEY_LENGTH_DWORDS_P256; j++) {
+      r->x[j] |= table[i].x[j] & mask;
+      r->y[j] |= table[i].y[j] & mask;
+      r->z[j] |= table[i].z[j] & mask;
+    }
+  }
+}
+
+static uint32_t p_256_get_bit(const uint32_t* n, uint32_t bit) {
+  return (n[bit / DWORD_BITS] >> (bit % DWORD_BITS)) & 0x01;
+}
+
+static uint32_t p_256_get_window(const uint32_t* n, uint32_t window) {
+  uint32_t bit = window * ECC_WINDOW_BITS;
+  return (n[bit / DWORD_BITS] >> (bit % DWORD_BITS)) &
+         (ECC_WINDOW_SIZE - 1);
+}
+
+struct CombTable {
+  // points[i] = sum of 2^(ECC_COMB_TEETH_SPACING * b) * G over the bits b
+  // set in i, in affine coordinates
+  Point points[ECC_WINDOW_SIZE];
+};
+
+static CombTable p_256_make_comb_table() {
+  CombTable table;
+  p_256_init_curve();
+  Point r;
+
+  p_256_init_point(&table.points[0]);
+  p_256_copy_point(&table.points[1], &curve_p256.G);
+  multiprecision_init(table.points[1].z);
+  table.points[1].z[0] = 1;
+  for (uint32_t b = 1; b < ECC_WINDOW_BITS; b++) {
+    Point* tooth = &table.points[1 << b];
+    p_256_copy_point(tooth, &table.points[1 << (b - 1)]);
+    for (uint32_t i = 0; i < ECC_COMB_TEETH_SPACING; i++) {
+      p_256_copy_point(&r, tooth);
+      ECC_Double(tooth, &r);
+    }
+    p_256_normalize_points(tooth, 1);
+  }
+
+  for (uint32_t i = 3; i < ECC_WINDOW_SIZE; i++) {
+    uint32_t low_bit = i & (0u - i);
+    if (low_bit == i) continue;
+    p_256_copy_point(&r, &table.points[i - low_bit]);
+    ECC_Add(&table.points[i], &r, &table.points[low_bit]);
+  }
+  p_256_normalize_points(&table.points[1], ECC_WINDOW_SIZE - 1);
+  return table;
+}
+
+// Fixed-base comb: ECC_COMB_TEETH_SPACING doublings and additions, with a
+// table built once
+void ECC_PointMult_Base(Point* q, const uint32_t* n) {
+  static const CombTable table = p_256_make_comb_table();
+  Point r;
+  Point t;
+
+  p_256_init_point(q);
+  for (int i = ECC_COMB_TEETH_SPACING - 1; i >= 0; i--) {
+    p_256_copy_point(&r, q);
+    ECC_Double(q, &r);
+
+    uint32_t index = 0;
+    for (uint32_t b = 0; b < ECC_WINDOW_BITS; b++) {
+      index |= p_256_get_bit(n, i + b * ECC_COMB_TEETH_SPACING) << b;
+    }
+    p_256_select_point(&t, table.points, ECC_WINDOW_SIZE, index);
+    p_256_copy_point(&r, q);
+    ECC_Add(q, &r, &t);
+  }
+
+  p_256_to_affine(q);
+}
+
+// Fixed window: the same sequence of doublings, additions and table scans
+// whatever the scalar
+void ECC_PointMult_Window(Point* q, Point* p, const uint32_t* n) {
+  Point table[ECC_WINDOW_SIZE];
+  Point r;
+  Point t;
+
+  // table[i] = i * p
+  p_256_init_point(&table[0]);
+  p_256_copy_point(&table[1], p);
+  multiprecision_init(table[1].z);
+  table[1].z[0] = 1;
+  ECC_Double(&table[2], &table[1]);
+  for (uint32_t i = 3; i < ECC_WINDOW_SIZE; i++) {
+    p_256_copy_point(&r, &table[i - 1]);
+    ECC_Add(&table[i], &r, &table[1]);
+  }
+  p_256_normalize_points(&table[2], ECC_WINDOW_SIZE - 2);
+
+  p_256_init_point(q);
+  for (int i = ECC_KEY_LENGTH_BITS_P256 / ECC_WINDOW_BITS - 1; i >= 0; i--) {
+    for (uint32_t j = 0; j < ECC_WINDOW_BITS; j++) {
+      p_256_copy_point(&r, q);
+      ECC_Double(q, &r);
+    }
+    p_256_select_point(&t, table, ECC_WINDOW_SIZE, p_256_get_window(n, i));
+    p_256_copy_point(&r, q);
+    ECC_Add(q, &r, &t);
+  }
+
+  p_256_to_affine(q);
+}
+
 // Binary Non-Adjacent Form for point multiplication
 void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n) {
   uint32_t sign;
@@ -234,11 +396,7 @@ void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n) {
     }
   }
 
-  multiprecision_inv_mod(minus_p.x, q->z);
-  multiprecision_mersenns_squa_mod(q->z, minus_p.x);
-  multiprecision_mersenns_mult_mod(q->x, q->x, q->z);
-  multiprecision_mersenns_mult_mod(q->z, q->z, minus_p.x);
-  multiprecision_mersenns_mult_mod(q->y, q->y, q->z);
+  p_256_to_affine(q);
 }
 
 bool ECC_ValidatePoint(const Point& pt) {
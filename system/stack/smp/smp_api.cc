@@ -45,7 +45,10 @@
  * Returns          void
  *
  ******************************************************************************/
-void SMP_Init(uint8_t init_security_mode) { smp_cb.init(init_security_mode); }
+void SMP_Init(uint8_t init_security_mode) {
+  smp_cb.init(init_security_mode);
+  smp_key_pool_clear();
+}
 
 /*******************************************************************************
  *
@@ -106,6 +109,8 @@ tSMP_STATUS SMP_Pair(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type) {
       return SMP_PAIR_INTERNAL_ERR;
     }
 
+    /* get a key pair ready while the channel is set up */
+    smp_key_pool_refill();
     return SMP_STARTED;
   }
 }
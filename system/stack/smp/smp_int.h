@@ -488,6 +488,9 @@ void smp_generate_ltk(tSMP_CB* p_cb, tSMP_INT_DATA* p_data);
 void smp_generate_passkey(tSMP_CB* p_cb, tSMP_INT_DATA* p_data);
 void smp_generate_rand_cont(tSMP_CB* p_cb, tSMP_INT_DATA* p_data);
 void smp_create_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data);
+void smp_key_pool_refill(void);
+bool smp_key_pool_take(BT_OCTET32 private_key, tSMP_PUBLIC_KEY* publ_key);
+void smp_key_pool_clear(void);
 void smp_use_oob_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data);
 void smp_compute_dhkey(tSMP_CB* p_cb);
 void smp_calculate_local_commitment(tSMP_CB* p_cb);
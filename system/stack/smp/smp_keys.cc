@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <cstring>
 
+#include "common/time_util.h"
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "device/include/controller.h"
 #include "os/log.h"
@@ -55,9 +56,38 @@ using crypto_toolbox::aes_128;
 static void smp_process_stk(tSMP_CB* p_cb, Octet16* p);
 static Octet16 smp_calculate_legacy_short_term_key(tSMP_CB* p_cb);
 static void smp_process_private_key(tSMP_CB* p_cb);
+static void smp_local_key_pair_created(tSMP_CB* p_cb);
 
 #define SMP_PASSKEY_MASK 0xfff00000
 
+/* Number of local P-256 key pairs generated ahead of the pairings */
+#ifndef SMP_KEY_POOL_SIZE
+#define SMP_KEY_POOL_SIZE 2
+#endif
+
+/* Pre-generated key pairs older than this are not used */
+#ifndef SMP_KEY_POOL_MAX_AGE_MS
+#define SMP_KEY_POOL_MAX_AGE_MS (10 * 60 * 1000)
+#endif
+
+typedef struct {
+  BT_OCTET32 private_key;
+  tSMP_PUBLIC_KEY publ_key;
+  uint64_t created_ms;
+} tSMP_KEY_PAIR;
+
+/* Key pairs ready for the next Secure Connections pairings, oldest first.
+ * Each key pair is used for one pairing only. */
+static struct {
+  tSMP_KEY_PAIR pairs[SMP_KEY_POOL_SIZE];
+  uint8_t count;
+  /* Private key being filled with the controller random numbers */
+  BT_OCTET32 next_private_key;
+  bool refilling;
+  /* Drops the random numbers requested before smp_key_pool_clear */
+  uint32_t generation;
+} smp_key_pool;
+
 // If there is data saved here, then use its info instead
 // This needs to be cleared on a successfult pairing using the oob data
 static tSMP_LOC_OOB_DATA saved_local_oob_data = {};
@@ -586,13 +616,122 @@ Octet16 smp_calculate_legacy_short_term_key(tSMP_CB* p_cb) {
   return aes_128(p_cb->tk, text);
 }
 
+/* Remove the oldest key pair, and wipe its slot */
+static void smp_key_pool_pop_front(void) {
+  smp_key_pool.count--;
+  memmove(&smp_key_pool.pairs[0], &smp_key_pool.pairs[1],
+          smp_key_pool.count * sizeof(tSMP_KEY_PAIR));
+  memset(&smp_key_pool.pairs[smp_key_pool.count], 0, sizeof(tSMP_KEY_PAIR));
+}
+
+/* Drop the key pairs that were not used in time */
+static void smp_key_pool_drop_stale(uint64_t now_ms) {
+  while (smp_key_pool.count > 0 &&
+         now_ms - smp_key_pool.pairs[0].created_ms > SMP_KEY_POOL_MAX_AGE_MS) {
+    LOG_VERBOSE("drop stale key pair");
+    smp_key_pool_pop_front();
+  }
+}
+
+/* Each random number fills 8 octets of the next private key, the last one
+ * completes the key pair */
+static void smp_key_pool_on_rand(uint32_t generation, uint8_t offset,
+                                 BT_OCTET8 rand) {
+  if (generation != smp_key_pool.generation) return;
+
+  memcpy(&smp_key_pool.next_private_key[offset], rand, BT_OCTET8_LEN);
+  offset += BT_OCTET8_LEN;
+  if (offset < BT_OCTET32_LEN) {
+    btsnd_hcic_ble_rand(
+        Bind(&smp_key_pool_on_rand, smp_key_pool.generation, offset));
+    return;
+  }
+
+  smp_key_pool.refilling = false;
+  if (smp_key_pool.count < SMP_KEY_POOL_SIZE) {
+    tSMP_KEY_PAIR* p_pair = &smp_key_pool.pairs[smp_key_pool.count++];
+    Point public_key;
+
+    memcpy(p_pair->private_key, smp_key_pool.next_private_key, BT_OCTET32_LEN);
+    ECC_PointMult_Base(&public_key, (uint32_t*)p_pair->private_key);
+    memcpy(p_pair->publ_key.x, public_key.x, BT_OCTET32_LEN);
+    memcpy(p_pair->publ_key.y, public_key.y, BT_OCTET32_LEN);
+    p_pair->created_ms = bluetooth::common::time_get_os_boottime_ms();
+    LOG_VERBOSE("key pairs ready:%u", smp_key_pool.count);
+  }
+  memset(smp_key_pool.next_private_key, 0, BT_OCTET32_LEN);
+
+  smp_key_pool_refill();
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_key_pool_refill
+ *
+ * Description      This function drops the stale key pairs, then generates
+ *                  local P-256 key pairs until the pool is full, one at a
+ *                  time, so that the pairings do not wait for the controller
+ *                  random numbers and the public key computation.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void smp_key_pool_refill(void) {
+  smp_key_pool_drop_stale(bluetooth::common::time_get_os_boottime_ms());
+  if (smp_key_pool.refilling || smp_key_pool.count >= SMP_KEY_POOL_SIZE) {
+    return;
+  }
+
+  smp_key_pool.refilling = true;
+  btsnd_hcic_ble_rand(
+      Bind(&smp_key_pool_on_rand, smp_key_pool.generation, uint8_t{0}));
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_key_pool_take
+ *
+ * Description      This function removes the oldest pre-generated key pair
+ *                  from the pool, dropping the key pairs that are too old.
+ *
+ * Returns          true if a key pair was copied to private_key and publ_key.
+ *
+ ******************************************************************************/
+bool smp_key_pool_take(BT_OCTET32 private_key, tSMP_PUBLIC_KEY* publ_key) {
+  smp_key_pool_drop_stale(bluetooth::common::time_get_os_boottime_ms());
+  if (smp_key_pool.count == 0) return false;
+
+  memcpy(private_key, smp_key_pool.pairs[0].private_key, BT_OCTET32_LEN);
+  *publ_key = smp_key_pool.pairs[0].publ_key;
+  smp_key_pool_pop_front();
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_key_pool_clear
+ *
+ * Description      This function drops all the pre-generated key pairs, and
+ *                  the random numbers still requested for the next one.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void smp_key_pool_clear(void) {
+  uint32_t generation = smp_key_pool.generation;
+
+  memset(&smp_key_pool, 0, sizeof(smp_key_pool));
+  smp_key_pool.generation = generation + 1;
+}
+
 /*******************************************************************************
  *
  * Function         smp_create_private_key
  *
  * Description      This function is called to create private key used to
  *                  calculate public key and DHKey.
- *                  The function starts private key creation requesting
+ *                  The function uses a pre-generated key pair if there is one,
+ *                  otherwise it starts private key creation requesting
  *                  for the controller to generate [0-7] octets of private key.
  *
  * Returns          void
@@ -623,6 +762,12 @@ void smp_create_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data) {
     LOG_WARN("OOB Association Model with no saved data present");
   }
 
+  if (smp_key_pool_take(p_cb->private_key, &p_cb->loc_publ_key)) {
+    LOG_VERBOSE("use pre-generated key pair");
+    smp_local_key_pair_created(p_cb);
+    return;
+  }
+
   btsnd_hcic_ble_rand(Bind(
       [](tSMP_CB* p_cb, BT_OCTET8 rand) {
         memcpy((void*)p_cb->private_key, rand, BT_OCTET8_LEN);
@@ -710,8 +855,8 @@ void smp_use_oob_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data) {
  * Function         smp_process_private_key
  *
  * Description      This function processes private key.
- *                  It calculates public key and notifies SM that private key /
- *                  public key pair is created.
+ *                  It calculates public key, then notifies SM that private
+ *                  key / public key pair is created.
  *
  * Returns          void
  *
@@ -723,10 +868,24 @@ void smp_process_private_key(tSMP_CB* p_cb) {
   LOG_VERBOSE("addr:%s", ADDRESS_TO_LOGGABLE_CSTR(p_cb->pairing_bda));
 
   memcpy(private_key, p_cb->private_key, BT_OCTET32_LEN);
-  ECC_PointMult(&public_key, &(curve_p256.G), (uint32_t*)private_key);
+  ECC_PointMult_Base(&public_key, (uint32_t*)private_key);
   memcpy(p_cb->loc_publ_key.x, public_key.x, BT_OCTET32_LEN);
   memcpy(p_cb->loc_publ_key.y, public_key.y, BT_OCTET32_LEN);
 
+  smp_local_key_pair_created(p_cb);
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_local_key_pair_created
+ *
+ * Description      This function notifies SM that private key / public key
+ *                  pair is created.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void smp_local_key_pair_created(tSMP_CB* p_cb) {
   smp_debug_print_nbyte_little_endian(p_cb->private_key, "private",
                                       BT_OCTET32_LEN);
   smp_debug_print_nbyte_little_endian(p_cb->loc_publ_key.x, "local public(x)",
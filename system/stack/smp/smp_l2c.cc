@@ -169,6 +169,7 @@ static void smp_data_received(uint16_t channel, const RawAddress& bd_addr,
         !(p_cb->flags & SMP_PAIR_FLAGS_WE_STARTED_DD)) {
       p_cb->role = L2CA_GetBleConnRole(bd_addr);
       p_cb->pairing_bda = bd_addr;
+      smp_key_pool_refill();
     } else if (bd_addr != p_cb->pairing_bda) {
       osi_free(p_buf);
       smp_reject_unexpected_pairing_command(bd_addr);
@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
@@ -27,6 +28,7 @@
 #include <iomanip>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "common/init_flags.h"
 #include "common/testing/log_capture.h"
@@ -284,6 +286,95 @@ TEST_F(A2dpSbcTest, effective_mtu_when_peer_does_not_support_3mbps) {
   ASSERT_EQ(a2dp_sbc_get_effective_frame_size(), 663 /* MAX_2MBPS_AVDTP_MTU */);
 }
 
+TEST_F(A2dpSbcTest, bitpool_follows_transmit_queue_length) {
+  static int bitpool;
+  auto read_cb = +[](uint8_t* p_buf, uint32_t len) -> uint32_t {
+    memset(p_buf, 0, len);
+    return len;
+  };
+  auto enqueue_cb = +[](BT_HDR* p_buf, size_t frames_n, uint32_t len) -> bool {
+    // The bitpool is the third byte of the SBC frame header
+    bitpool = Data(p_buf)[2];
+    osi_free(p_buf);
+    return false;
+  };
+  InitializeEncoder(true, read_cb, enqueue_cb);
+  uint64_t timestamp_us = 0;
+  auto send_frames = [&]() {
+    bitpool = -1;
+    timestamp_us += kA2dpTickUs;
+    encoder_iface_->send_frames(timestamp_us);
+    return bitpool;
+  };
+  ASSERT_NE(encoder_iface_->set_transmit_queue_length, nullptr);
+  send_frames();
+  const int configured_bitpool = send_frames();
+  ASSERT_GT(configured_bitpool, 0);
+
+  // The bitpool goes down while the queue is congested, down to half
+  int previous_bitpool = configured_bitpool;
+  for (int i = 0; i < 100; i++) {
+    encoder_iface_->set_transmit_queue_length(10);
+    int current_bitpool = send_frames();
+    ASSERT_LE(current_bitpool, previous_bitpool);
+    ASSERT_GE(current_bitpool, configured_bitpool / 2);
+    previous_bitpool = current_bitpool;
+  }
+  ASSERT_EQ(previous_bitpool, configured_bitpool / 2);
+
+  // And goes back up progressively once the queue is clear
+  for (int i = 0; i < 2000; i++) {
+    encoder_iface_->set_transmit_queue_length(0);
+    int current_bitpool = send_frames();
+    ASSERT_GE(current_bitpool, previous_bitpool);
+    ASSERT_LE(current_bitpool, previous_bitpool + 1);
+    previous_bitpool = current_bitpool;
+  }
+  ASSERT_EQ(previous_bitpool, configured_bitpool);
+}
+
+TEST_F(A2dpSbcTest, short_read_is_completed_at_next_tick) {
+  static size_t read_offset;
+  static uint32_t short_read_len;
+  static std::vector<uint8_t> first_packet;
+  auto read_cb = +[](uint8_t* p_buf, uint32_t len) -> uint32_t {
+    if (short_read_len != 0) {
+      len = short_read_len;
+      short_read_len = 0;
+    }
+    memcpy(p_buf, wav_reader.GetSamples() + read_offset, len);
+    read_offset += len;
+    return len;
+  };
+  auto enqueue_cb = +[](BT_HDR* p_buf, size_t frames_n, uint32_t len) -> bool {
+    if (first_packet.empty()) {
+      first_packet.assign(Data(p_buf), Data(p_buf) + p_buf->len);
+    }
+    osi_free(p_buf);
+    return false;
+  };
+  auto encode_first_packet = [&](uint32_t first_read_len) {
+    read_offset = 0;
+    short_read_len = first_read_len;
+    first_packet.clear();
+    InitializeEncoder(true, read_cb, enqueue_cb);
+    uint64_t timestamp_us = 0;
+    for (int i = 0; i < 10 && first_packet.empty(); i++) {
+      timestamp_us += kA2dpTickUs;
+      encoder_iface_->send_frames(timestamp_us);
+    }
+    return first_packet;
+  };
+
+  // The PCM data of a short read is kept, and completed by the next read
+  std::vector<uint8_t> reference = encode_first_packet(0);
+  std::vector<uint8_t> resumed = encode_first_packet(kSbcReadSize / 2);
+  size_t len = std::min(reference.size(), resumed.size());
+  ASSERT_GT(len, 0u);
+  ASSERT_TRUE(std::equal(reference.begin(), reference.begin() + len,
+                         resumed.begin()));
+}
+
 TEST_F(A2dpSbcTest, debug_codec_dump) {
   log_capture_ = std::make_unique<LogCapture>();
   a2dp_codecs_->debug_codec_dump(2);
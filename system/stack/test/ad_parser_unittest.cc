@@ -210,4 +210,47 @@ TEST(AdvertiseDataParserTest, GetFieldByTypeInLoop) {
     match_no++;
   }
   EXPECT_EQ(match_no, 3);
-}
\ No newline at end of file
+}
+TEST(AdvertiseDataParserTest, GetFields) {
+  const std::vector<uint8_t> data0{0x02, 0x01, 0x02, 0x01, 0x0a, 0x03,
+                                   0x16, 0x4f, 0x18, 0x00, 0x00};
+
+  std::vector<AdvertiseDataField> fields;
+  for (const AdvertiseDataField& field : AdvertiseDataParser::GetFields(data0)) {
+    fields.push_back(field);
+  }
+  ASSERT_EQ(fields.size(), 3u);
+  EXPECT_EQ(fields[0].type, 0x01);
+  EXPECT_EQ(fields[0].data, data0.data() + 2);
+  EXPECT_EQ(fields[0].length, 1);
+  EXPECT_EQ(fields[1].type, 0x0a);
+  EXPECT_EQ(fields[1].length, 0);
+  EXPECT_EQ(fields[2].type, 0x16);
+  EXPECT_EQ(fields[2].data, data0.data() + 7);
+  EXPECT_EQ(fields[2].length, 2);
+
+  // Iteration stops at a truncated field.
+  const std::vector<uint8_t> data1{0x02, 0x01, 0x02, 0x05, 0x16, 0x4f};
+  auto data1_fields = AdvertiseDataParser::GetFields(data1);
+  EXPECT_EQ(std::distance(data1_fields.begin(), data1_fields.end()), 1);
+
+  const std::vector<uint8_t> data2;
+  auto data2_fields = AdvertiseDataParser::GetFields(data2);
+  EXPECT_TRUE(data2_fields.begin() == data2_fields.end());
+}
+
+TEST(AdvertiseDataParserTest, FieldIndex) {
+  const std::vector<uint8_t> data0{0x02, 0x01, 0x02, 0x03, 0x16, 0x4f,
+                                   0x18, 0x04, 0x16, 0x53, 0x18, 0x00};
+
+  AdvertiseDataParser::FieldIndex index(data0);
+  ASSERT_EQ(index.fields().size(), 3u);
+
+  for (uint8_t type : {0x01, 0x16, 0x09}) {
+    uint8_t index_len = 0xff;
+    uint8_t parser_len = 0xff;
+    EXPECT_EQ(index.GetFieldByType(type, &index_len),
+              AdvertiseDataParser::GetFieldByType(data0, type, &parser_len));
+    EXPECT_EQ(index_len, parser_len);
+  }
+}
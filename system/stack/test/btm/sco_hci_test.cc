@@ -268,6 +268,30 @@ TEST_F(ScoHciSwbWithInitCleanTest, SwbEnqueuePacket) {
   ASSERT_EQ(bluetooth::audio::sco::swb::enqueue_packet(payload, false), false);
 }
 
+TEST_F(ScoHciWbsWithInitCleanTest, WbsEnqueuePacketInPlace) {
+  uint8_t packet[72] = {};
+  // Reject the data of a packet with a size other than the HAL packet size
+  ASSERT_EQ(bluetooth::audio::sco::wbs::enqueue_packet(packet, 72, false),
+            false);
+  ASSERT_EQ(bluetooth::audio::sco::wbs::enqueue_packet(packet, 60, false),
+            true);
+  // Return 0 if buffer is full
+  ASSERT_EQ(bluetooth::audio::sco::wbs::enqueue_packet(packet, 60, false),
+            false);
+}
+
+TEST_F(ScoHciSwbWithInitCleanTest, SwbEnqueuePacketInPlace) {
+  uint8_t packet[72] = {};
+  // Reject the data of a packet with a size other than the HAL packet size
+  ASSERT_EQ(bluetooth::audio::sco::swb::enqueue_packet(packet, 72, false),
+            false);
+  ASSERT_EQ(bluetooth::audio::sco::swb::enqueue_packet(packet, 60, false),
+            true);
+  // Return 0 if buffer is full
+  ASSERT_EQ(bluetooth::audio::sco::swb::enqueue_packet(packet, 60, false),
+            false);
+}
+
 TEST_F(ScoHciWbsTest, WbsDecodeWithoutInit) {
   const uint8_t* decoded = nullptr;
   // Return 0 if buffer is uninitialized
@@ -468,6 +492,88 @@ TEST_F(ScoHciSwbWithInitCleanTest, SwbEncodeDequeuePackets) {
   }
 }
 
+TEST_F(ScoHciWbsWithInitCleanTest, WbsEncodePacket) {
+  uint8_t h2_header_frames_count[] = {0x08, 0x38, 0xc8, 0xf8};
+  int16_t data[120] = {0};
+  const uint8_t* encoded = nullptr;
+  std::vector<uint8_t> packet;
+
+  // Return 0 if data is invalid or its length is insufficient
+  ASSERT_EQ(bluetooth::audio::sco::wbs::encode_packet(nullptr, sizeof(data),
+                                                      &packet),
+            size_t(0));
+  ASSERT_EQ(bluetooth::audio::sco::wbs::encode_packet(data, sizeof(data) - 1,
+                                                      &packet),
+            size_t(0));
+
+  for (size_t i = 0; i < 5; i++) {
+    ASSERT_EQ(
+        bluetooth::audio::sco::wbs::encode_packet(data, sizeof(data), &packet),
+        sizeof(data));
+    ASSERT_EQ(packet.size(), size_t(60));
+    for (size_t j = 0; j < 60; j++) {
+      ASSERT_EQ(packet[j],
+                j == 1 ? h2_header_frames_count[i % 4] : msbc_zero_packet[j]);
+    }
+  }
+
+  // Return 0 while a packet is left in the buffer, which is sent first
+  ASSERT_EQ(bluetooth::audio::sco::wbs::encode(data, sizeof(data)),
+            sizeof(data));
+  ASSERT_EQ(
+      bluetooth::audio::sco::wbs::encode_packet(data, sizeof(data), &packet),
+      size_t(0));
+  ASSERT_EQ(bluetooth::audio::sco::wbs::dequeue_packet(&encoded), size_t(60));
+  ASSERT_EQ(encoded[1], h2_header_frames_count[5 % 4]);
+
+  // Return 0 if a SCO packet does not hold exactly one mSBC packet
+  ASSERT_EQ(bluetooth::audio::sco::wbs::init(72), size_t(72));
+  ASSERT_EQ(
+      bluetooth::audio::sco::wbs::encode_packet(data, sizeof(data), &packet),
+      size_t(0));
+}
+
+TEST_F(ScoHciSwbWithInitCleanTest, SwbEncodePacket) {
+  uint8_t h2_header_frames_count[] = {0x08, 0x38, 0xc8, 0xf8};
+  int16_t data[BTM_LC3_CODE_SIZE / 2] = {0};
+  const uint8_t* encoded = nullptr;
+  std::vector<uint8_t> packet;
+
+  // Return 0 if data is invalid or its length is insufficient
+  ASSERT_EQ(bluetooth::audio::sco::swb::encode_packet(nullptr, sizeof(data),
+                                                      &packet),
+            size_t(0));
+  ASSERT_EQ(bluetooth::audio::sco::swb::encode_packet(data, sizeof(data) - 1,
+                                                      &packet),
+            size_t(0));
+
+  for (size_t i = 0; i < 5; i++) {
+    ASSERT_EQ(
+        bluetooth::audio::sco::swb::encode_packet(data, sizeof(data), &packet),
+        sizeof(data));
+    ASSERT_EQ(packet.size(), size_t(60));
+    for (size_t j = 0; j < 60; j++) {
+      ASSERT_EQ(packet[j],
+                j == 1 ? h2_header_frames_count[i % 4] : lc3_zero_packet[j]);
+    }
+  }
+
+  // Return 0 while a packet is left in the buffer, which is sent first
+  ASSERT_EQ(bluetooth::audio::sco::swb::encode(data, sizeof(data)),
+            sizeof(data));
+  ASSERT_EQ(
+      bluetooth::audio::sco::swb::encode_packet(data, sizeof(data), &packet),
+      size_t(0));
+  ASSERT_EQ(bluetooth::audio::sco::swb::dequeue_packet(&encoded), size_t(60));
+  ASSERT_EQ(encoded[1], h2_header_frames_count[5 % 4]);
+
+  // Return 0 if a SCO packet does not hold exactly one LC3 packet
+  ASSERT_EQ(bluetooth::audio::sco::swb::init(72), size_t(72));
+  ASSERT_EQ(
+      bluetooth::audio::sco::swb::encode_packet(data, sizeof(data), &packet),
+      size_t(0));
+}
+
 TEST_F(ScoHciWbsWithInitCleanTest, WbsPlc) {
   int16_t triangle[16] = {0, 100,  200,  300,  400,  300,  200,  100,
                           0, -100, -200, -300, -400, -300, -200, -100};
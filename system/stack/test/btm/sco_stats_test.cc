@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/btm/sco_stats.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using testing::Test;
+
+class ScoStatsTest : public Test {
+ public:
+ protected:
+  void SetUp() override { stats.init(); }
+  void TearDown() override {}
+
+  tBTM_SCO_STATS stats;
+};
+
+TEST_F(ScoStatsTest, Histogram) {
+  tBTM_SCO_HISTOGRAM histogram;
+  histogram.init(kBtmScoCodecCpuBoundsUs);
+  ASSERT_EQ(histogram.to_string(),
+            "count:0 mean:0 max:0 histogram:0/0/0/0/0/0");
+
+  for (uint32_t sample : {0, 49, 50, 999, 1000, 5000}) histogram.update(sample);
+  ASSERT_EQ(histogram.count, (uint64_t)6);
+  ASSERT_EQ(histogram.max, (uint32_t)5000);
+  ASSERT_EQ(histogram.mean(), (uint32_t)(7098 / 6));
+  ASSERT_EQ(histogram.to_string(),
+            "count:6 mean:1183 max:5000 histogram:2/1/0/0/1/2");
+}
+
+TEST_F(ScoStatsTest, RxIntervalAndJitter) {
+  uint64_t ts = 1000000;
+  for (int i = 0; i < 100; i++) {
+    stats.update_rx(ts);
+    ts += 7500;
+  }
+  ASSERT_EQ(stats.rx_interval_us.count, (uint64_t)99);
+  ASSERT_EQ(stats.rx_interval_us.buckets[3], (uint64_t)99);
+  ASSERT_EQ(stats.jitter_us(), (uint32_t)0);
+
+  /* Alternate between early and late arrivals */
+  for (int i = 0; i < 100; i++) {
+    stats.update_rx(ts);
+    ts += i % 2 ? 5500 : 9500;
+  }
+  ASSERT_EQ(stats.rx_interval_us.max, (uint32_t)9500);
+  ASSERT_NEAR(stats.jitter_us(), 4000, 250);
+  ASSERT_GE(stats.max_jitter_us, stats.jitter_us());
+}
+
+TEST_F(ScoStatsTest, PlcBursts) {
+  bool pl[] = {0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+  for (bool b : pl) stats.update_plc(b);
+  ASSERT_EQ(stats.plc_burst_len.count, (uint64_t)3);
+  ASSERT_EQ(stats.plc_burst, (uint32_t)10);
+
+  stats.flush_plc_burst();
+  ASSERT_EQ(stats.plc_burst, (uint32_t)0);
+  ASSERT_EQ(stats.plc_burst_len.to_string(),
+            "count:4 mean:4 max:10 histogram:1/1/1/0/1");
+}
+
+}  // namespace
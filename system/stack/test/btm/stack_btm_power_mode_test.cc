@@ -26,6 +26,7 @@
 #include "stack/include/btm_api.h"
 #include "stack/include/hci_error_code.h"
 #include "test/common/mock_functions.h"
+#include "test/mock/mock_stack_hcic_hcicmds.h"
 #include "types/raw_address.h"
 
 namespace {
@@ -200,3 +201,30 @@ TEST_F(StackBtmPowerModeConnected, BTM_SetPowerMode__ActiveToSniffTwice) {
         current_power_mode);
   }
 }
+
+TEST_F(StackBtmPowerModeConnected, BTM_SetPowerMode__SniffIntervalGuard) {
+  uint16_t max_sniff_period = 0;
+  uint16_t min_sniff_period = 0;
+  test::mock::stack_hcic_hcicmds::btsnd_hcic_sniff_mode.body =
+      [&](uint16_t /* handle */, uint16_t max_period, uint16_t min_period,
+          uint16_t /* attempt */, uint16_t /* timeout */) {
+        max_sniff_period = max_period;
+        min_sniff_period = min_period;
+      };
+
+  ASSERT_EQ(BTM_SUCCESS, BTM_PM_SetMaxSniffInterval(kRawAddress, 54));
+  tBTM_PM_PWR_MD mode = {
+      .max = 800,
+      .min = 400,
+      .attempt = 4,
+      .timeout = 1,
+      .mode = BTM_PM_MD_SNIFF,
+  };
+  ASSERT_EQ("BTM_CMD_STARTED",
+            btm_status_text(BTM_SetPowerMode(pm_id_, kRawAddress, &mode)));
+  ASSERT_EQ(1, get_func_call_count("btsnd_hcic_sniff_mode"));
+  ASSERT_EQ(54, max_sniff_period);
+  ASSERT_EQ(54, min_sniff_period);
+
+  test::mock::stack_hcic_hcicmds::btsnd_hcic_sniff_mode = {};
+}
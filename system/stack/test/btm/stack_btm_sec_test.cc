@@ -269,3 +269,40 @@ TEST_F(StackBtmSecWithInitFreeTest, wipe_secrets_and_remove) {
 
   wipe_secrets_and_remove(device_record);
 }
+
+TEST_F(StackBtmSecWithInitFreeTest, btm_find_dev__indexed) {
+  const RawAddress bd_addr = RawAddress({0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6});
+  const RawAddress other_addr =
+      RawAddress({0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6});
+  const uint16_t classic_handle = 0x1234;
+
+  tBTM_SEC_DEV_REC* other_record = btm_sec_allocate_dev_rec();
+  other_record->bd_addr = other_addr;
+  other_record->hci_handle = HCI_INVALID_HANDLE;
+  other_record->ble_hci_handle = HCI_INVALID_HANDLE;
+  tBTM_SEC_DEV_REC* device_record = btm_sec_allocate_dev_rec();
+  device_record->bd_addr = bd_addr;
+  device_record->hci_handle = classic_handle;
+  device_record->ble_hci_handle = HCI_INVALID_HANDLE;
+
+  // Repeated lookups go through the indexes
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(device_record, btm_find_dev(bd_addr));
+    ASSERT_EQ(device_record, btm_find_dev_by_handle(classic_handle));
+  }
+
+  // The records are changed in place, the indexes must not return them
+  device_record->hci_handle = HCI_INVALID_HANDLE;
+  other_record->hci_handle = classic_handle;
+  ASSERT_EQ(other_record, btm_find_dev_by_handle(classic_handle));
+  device_record->bd_addr = other_addr;
+  other_record->bd_addr = bd_addr;
+  ASSERT_EQ(other_record, btm_find_dev(bd_addr));
+
+  // Removed records are dropped from the indexes
+  wipe_secrets_and_remove(other_record);
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(classic_handle));
+
+  wipe_secrets_and_remove(device_record);
+}
@@ -32,7 +32,9 @@
 #include "stack/btm/btm_sec_cb.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_hci_link_interface.h"
+#include "stack/include/btm_api.h"
 #include "stack/include/btm_client_interface.h"
+#include "stack/include/inq_hci_link_interface.h"
 #include "stack/l2cap/l2c_int.h"
 #include "test/common/mock_functions.h"
 #include "test/mock/mock_legacy_hci_interface.h"
@@ -300,3 +302,40 @@ TEST_F(StackBtmWithInitFreeTest, is_disconnect_reason_valid) {
       ASSERT_FALSE(is_disconnect_reason_valid(reason));
   }
 }
+
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void btm_clr_inq_db(const RawAddress* p_bda);
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
+
+TEST_F(StackBtmTest, btm_inq_db__least_recently_used_entry_is_reused) {
+  constexpr size_t kClassicEntries = BTM_INQ_DB_SIZE / 2;
+  auto make_address = [](size_t i) {
+    return RawAddress({0x0a, 0x0b, 0x0c, 0x0d, static_cast<uint8_t>(i >> 8),
+                       static_cast<uint8_t>(i)});
+  };
+  bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+
+  for (size_t i = 0; i < kClassicEntries; i++) {
+    tINQ_DB_ENT* p_ent = btm_inq_db_new(make_address(i), false);
+    ASSERT_NE(nullptr, p_ent);
+    ASSERT_EQ(make_address(i), p_ent->inq_info.results.remote_bd_addr);
+  }
+  // LE devices do not take BR/EDR entries
+  ASSERT_NE(nullptr, btm_inq_db_new(make_address(kClassicEntries), true));
+
+  // The first device was used last, the second one is reused
+  ASSERT_NE(nullptr, btm_inq_db_find(make_address(0)));
+  tINQ_DB_ENT* p_ent = btm_inq_db_new(make_address(kClassicEntries + 1), false);
+  ASSERT_EQ(nullptr, btm_inq_db_find(make_address(1)));
+  ASSERT_EQ(p_ent, btm_inq_db_find(make_address(kClassicEntries + 1)));
+  ASSERT_NE(nullptr, btm_inq_db_find(make_address(0)));
+  ASSERT_NE(nullptr, btm_inq_db_find(make_address(kClassicEntries)));
+
+  bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+  ASSERT_EQ(nullptr, btm_inq_db_find(make_address(0)));
+  ASSERT_EQ(nullptr, BTM_InqDbFirst());
+}
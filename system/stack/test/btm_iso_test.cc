@@ -18,6 +18,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "btm_iso_api.h"
 #include "hci/include/hci_layer.h"
 #include "main/shim/hci_layer.h"
@@ -2364,6 +2366,100 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturnedByDisconnection) {
   }
 }
 
+TEST_F(IsoManagerTest, SendIsoDataBatchedPerCigInterval) {
+  std::vector<uint8_t> data_vec(108, 0);
+
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  auto left = volatile_test_cig_create_cmpl_evt_.conn_handles[0];
+  auto right = volatile_test_cig_create_cmpl_evt_.conn_handles[1];
+  IsoManager::GetInstance()->SetupIsoDataPath(left, kDefaultIsoDataPathParams);
+  IsoManager::GetInstance()->SetupIsoDataPath(right, kDefaultIsoDataPathParams);
+
+  auto return_credits = [](uint16_t handle, uint16_t num_credits) {
+    uint8_t mock_rsp[5];
+    uint8_t* p = mock_rsp;
+    UINT8_TO_STREAM(p, 1);
+    UINT16_TO_STREAM(p, handle);
+    UINT16_TO_STREAM(p, num_credits);
+    IsoManager::GetInstance()->HandleNumComplDataPkts(mock_rsp,
+                                                      sizeof(mock_rsp));
+  };
+
+  /* The left stream sends alone, then the right stream joins the schedule:
+   * its SDU waits for the next one of the left stream */
+  EXPECT_CALL(iso_interface_, HciSend).Times(1);
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  EXPECT_CALL(iso_interface_, HciSend).Times(0);
+  IsoManager::GetInstance()->SendIsoData(right, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  EXPECT_CALL(iso_interface_, HciSend).Times(2);
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  /* The SDU of the left stream waits for the one of the right stream */
+  EXPECT_CALL(iso_interface_, HciSend).Times(0);
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  std::vector<uint16_t> sent_handles;
+  EXPECT_CALL(iso_interface_, HciSend)
+      .Times(2)
+      .WillRepeatedly([&sent_handles](BT_HDR* p_msg, uint16_t) {
+        uint8_t* p = p_msg->data;
+        uint16_t handle;
+        STREAM_TO_UINT16(handle, p);
+        sent_handles.push_back(handle);
+      });
+  IsoManager::GetInstance()->SendIsoData(right, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+  std::sort(sent_handles.begin(), sent_handles.end());
+  ASSERT_EQ(sent_handles, std::vector<uint16_t>({std::min(left, right),
+                                                 std::max(left, right)}));
+
+  return_credits(left, 3);
+  return_credits(right, 2);
+
+  /* The right stream misses an interval: the left stream SDU goes out with
+   * the next one, then the left stream is not held anymore */
+  EXPECT_CALL(iso_interface_, HciSend).Times(0);
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  EXPECT_CALL(iso_interface_, HciSend).Times(3);
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  IsoManager::GetInstance()->SendIsoData(left, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  /* A disconnected stream is not waited for */
+  EXPECT_CALL(iso_interface_, HciSend).Times(0);
+  IsoManager::GetInstance()->SendIsoData(right, data_vec.data(),
+                                         data_vec.size());
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+
+  EXPECT_CALL(iso_interface_, HciSend).Times(1);
+  IsoManager::GetInstance()->HandleDisconnect(left, 16);
+  testing::Mock::VerifyAndClearExpectations(&iso_interface_);
+}
+
 TEST_F(IsoManagerDeathTest, SendIsoDataWithNoDataPath) {
   std::vector<uint8_t> data_vec(108, 0);
 
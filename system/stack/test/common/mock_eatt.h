@@ -56,6 +56,8 @@ class MockEattExtension : public EattExtension {
               (const RawAddress& bd_addr));
   MOCK_METHOD((EattChannel*), GetChannelAvailableForClientRequest,
               (const RawAddress& bd_addr));
+  MOCK_METHOD((EattChannel*), GetLeastBusyChannelForClientRequest,
+              (const RawAddress& bd_addr));
   MOCK_METHOD((void), StartIndicationConfirmationTimer,
               (const RawAddress& bd_addr, uint16_t cid));
   MOCK_METHOD((void), StopIndicationConfirmationTimer,
@@ -66,6 +68,8 @@ class MockEattExtension : public EattExtension {
   MOCK_METHOD((void), StopAppIndicationTimer,
               (const RawAddress& bd_addr, uint16_t cid));
 
+  MOCK_METHOD((void), Dump, (int fd));
+
   MOCK_METHOD((void), Start, ());
   MOCK_METHOD((void), Stop, ());
 };
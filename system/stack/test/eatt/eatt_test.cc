@@ -624,6 +624,41 @@ TEST_F(EattTest, TestCollisionHandling) {
   ConnectDeviceEattSupported(5, true /* collision*/);
 }
 
+TEST_F(EattTest, ClientRequestsSpreadOverChannels) {
+  ConnectDeviceEattSupported(/* num_of_accepted_connections = */ 3);
+
+  // act: the first channel served a request and still waits for its response
+  EattChannel* first = eatt_instance_->FindEattChannelByCid(
+      test_address, connected_cids_[0]);
+  first->cl_requests_ = 1;
+  first->cl_cmd_q_.push_back({});
+
+  // assert: an idle channel that served no request is picked
+  EattChannel* channel =
+      eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+  ASSERT_NE(channel, nullptr);
+  ASSERT_NE(channel->cid_, connected_cids_[0]);
+
+  // act: all channels are busy, the others with two requests each
+  for (size_t i = 1; i < connected_cids_.size(); i++) {
+    EattChannel* busy = eatt_instance_->FindEattChannelByCid(
+        test_address, connected_cids_[i]);
+    busy->cl_cmd_q_.push_back({});
+    busy->cl_cmd_q_.push_back({});
+  }
+
+  // assert: no channel is idle, and the least busy one is the first
+  ASSERT_EQ(eatt_instance_->GetChannelAvailableForClientRequest(test_address),
+            nullptr);
+  ASSERT_EQ(eatt_instance_->GetLeastBusyChannelForClientRequest(test_address),
+            first);
+
+  for (uint16_t cid : connected_cids_) {
+    eatt_instance_->FindEattChannelByCid(test_address, cid)->cl_cmd_q_.clear();
+  }
+  DisconnectEattDevice(connected_cids_);
+}
+
 TEST_F(EattTest, ChannelUnavailableWhileOpening) {
   // arrange
   ON_CALL(gatt_interface_, ClientReadSupportedFeatures)
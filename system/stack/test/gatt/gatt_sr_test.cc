@@ -50,6 +50,9 @@ struct TestMutables {
     int access_count_{0};
     tGATT_STATUS return_status_{GATT_SUCCESS};
   } gatts_write_attr_perm_check;
+  struct {
+    int access_count_{0};
+  } gatts_read_attr_value_by_handle;
 };
 
 TestMutables test_state_;
@@ -110,6 +113,7 @@ tGATT_STATUS gatts_read_attr_value_by_handle(
     uint16_t handle, uint16_t offset, uint8_t* p_value, uint16_t* p_len,
     uint16_t mtu, tGATT_SEC_FLAG sec_flag, uint8_t key_size,
     uint32_t trans_id) {
+  test_state_.gatts_read_attr_value_by_handle.access_count_++;
   return GATT_SUCCESS;
 }
 tGATT_STATUS gatts_write_attr_perm_check(tGATT_SVC_DB* p_db, uint8_t op_code,
@@ -338,6 +342,47 @@ TEST_F(GattSrTest, gatts_process_write_req_request_write_typical) {
   CHECK(test_state_.application_request_callback.data_.write_req.len == length);
 }
 
+TEST_F(GattSrTest, gatts_process_write_req_prepare_write_over_budget) {
+  uint8_t p_data[4] = {0x00, 0x00, 0x11, 0x22};
+  tcb_.prep_write_bytes = GATT_MAX_PREP_WRITE_BYTES - 1;
+
+  gatts_process_write_req(tcb_, L2CAP_ATT_CID, el_, kHandle,
+                          GATT_REQ_PREPARE_WRITE, sizeof(p_data), p_data,
+                          kGattCharacteristicType);
+
+  CHECK(test_state_.gatts_write_attr_perm_check.access_count_ == 0);
+  CHECK(test_state_.application_request_callback.type_ == 0xff);
+  CHECK(test_state_.attp_build_sr_msg.op_code_ == GATT_RSP_ERROR);
+}
+
+TEST_F(GattSrTest, gatts_process_read_req_read_blob_from_long_read_cache) {
+  uint8_t value[100];
+  for (size_t i = 0; i < sizeof(value); i++) value[i] = i;
+  tcb_.payload_size = GATT_DEF_BLE_MTU_SIZE;
+  gatt_sr_store_long_read(tcb_, L2CAP_ATT_CID, kHandle, 0, value,
+                          sizeof(value));
+
+  uint8_t offset[2] = {22, 0};
+  gatts_process_read_req(tcb_, L2CAP_ATT_CID, el_, GATT_REQ_READ_BLOB, kHandle,
+                         sizeof(offset), offset);
+  CHECK(test_state_.gatts_read_attr_value_by_handle.access_count_ == 0);
+
+  uint8_t part[GATT_DEF_BLE_MTU_SIZE];
+  uint16_t len = 0;
+  CHECK(gatt_sr_read_long_cached(tcb_, L2CAP_ATT_CID, kHandle, 88, part, &len,
+                                 sizeof(part)));
+  CHECK(len == 12);
+  CHECK(part[0] == 88);
+
+  /* A write of the attribute makes the app answer again */
+  uint8_t p_data[2] = {0x34, 0x12};
+  gatts_process_write_req(tcb_, L2CAP_ATT_CID, el_, kHandle, GATT_REQ_WRITE,
+                          sizeof(p_data), p_data, kGattCharacteristicType);
+  gatts_process_read_req(tcb_, L2CAP_ATT_CID, el_, GATT_REQ_READ_BLOB, kHandle,
+                         sizeof(offset), offset);
+  CHECK(test_state_.gatts_read_attr_value_by_handle.access_count_ == 1);
+}
+
 TEST_F(GattSrRobustCachingTest,
        gatts_process_db_out_of_sync_for_gatt_req_read_by_grp_type) {
   tcb_.is_robust_cache_change_aware = false;
@@ -20,11 +20,17 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/strings.h"
+#include "osi/include/allocator.h"
 #include "stack/gatt/gatt_int.h"
+#include "stack/include/bt_hdr.h"
 #include "stack/include/gatt_api.h"
+#include "stack/include/l2c_api.h"
+#include "stack/include/l2cdefs.h"
 #include "stack/sdp/internal/sdp_api.h"
+#include "test/mock/mock_stack_l2cap_api.h"
 #include "test/mock/mock_stack_sdp_legacy_api.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
@@ -151,6 +157,57 @@ TEST_F(StackGattTest, GATT_Register_Deregister) {
   gatt_free();
 }
 
+TEST_F(StackGattTest, value_batch_stops_when_l2cap_has_no_room) {
+  gatt_init();
+  tGATT_IF gatt_if = GATT_Register(bluetooth::Uuid::GetRandom(), "batch",
+                                   &gatt_callbacks, false);
+  tGATT_TCB& tcb = gatt_cb.tcb[0];
+  tcb.in_use = true;
+  tcb.tcb_idx = 0;
+  tcb.att_lcid = L2CAP_ATT_CID;
+  tcb.payload_size = GATT_DEF_BLE_MTU_SIZE;
+  uint16_t conn_id = GATT_CREATE_CONN_ID(0, gatt_if);
+
+  // The PDU that uses up the room leaves the channel congested
+  uint16_t room = 3;
+  std::vector<uint8_t> op_codes;
+  test::mock::stack_l2cap_api::L2CA_GetFixedChnlTxRoom.body =
+      [&room](uint16_t /* fixed_cid */, const RawAddress& /* rem_bda */) {
+        return room;
+      };
+  test::mock::stack_l2cap_api::L2CA_SendFixedChnlData.body =
+      [&room, &op_codes](uint16_t /* fixed_cid */,
+                         const RawAddress& /* rem_bda */, BT_HDR* p_buf) {
+        op_codes.push_back(*((uint8_t*)(p_buf + 1) + p_buf->offset));
+        osi_free(p_buf);
+        room--;
+        return (uint16_t)(room > 0 ? L2CAP_DW_SUCCESS : L2CAP_DW_CONGESTED);
+      };
+
+  uint8_t value[] = {0x01, 0x02, 0x03};
+  std::vector<tGATT_VALUE_REF> values;
+  for (uint16_t handle = 0x0010; handle < 0x0015; handle++) {
+    values.push_back({.handle = handle, .len = sizeof(value), .p_value = value});
+  }
+  ASSERT_EQ(3, GATTS_HandleValueNotificationBatch(conn_id, values.data(),
+                                                  values.size()));
+  ASSERT_EQ(0, GATTC_WriteNoRspBatch(conn_id, values.data() + 3, 2));
+
+  room = 4;
+  ASSERT_EQ(2, GATTC_WriteNoRspBatch(conn_id, values.data() + 3, 2));
+  ASSERT_EQ((std::vector<uint8_t>{GATT_HANDLE_VALUE_NOTIF,
+                                  GATT_HANDLE_VALUE_NOTIF,
+                                  GATT_HANDLE_VALUE_NOTIF, GATT_CMD_WRITE,
+                                  GATT_CMD_WRITE}),
+            op_codes);
+
+  test::mock::stack_l2cap_api::L2CA_GetFixedChnlTxRoom = {};
+  test::mock::stack_l2cap_api::L2CA_SendFixedChnlData = {};
+  tcb.in_use = false;
+  GATT_Deregister(gatt_if);
+  gatt_free();
+}
+
 TEST_F(StackGattTest, gatt_status_text) {
   std::vector<std::pair<tGATT_STATUS, std::string>> statuses = {
       std::make_pair(GATT_SUCCESS, "GATT_SUCCESS"),  // Also GATT_ENCRYPED_MITM
@@ -15,6 +15,8 @@
 
 using testing::_;
 using testing::DoAll;
+using testing::ElementsAre;
+using testing::IsEmpty;
 using testing::Mock;
 using testing::Return;
 using testing::SaveArg;
@@ -34,6 +36,8 @@ class AcceptlistMock {
   MOCK_METHOD1(AcceptlistAdd, bool(const RawAddress&));
   MOCK_METHOD2(AcceptlistAdd, bool(const RawAddress&, bool is_direct));
   MOCK_METHOD1(AcceptlistRemove, void(const RawAddress&));
+  MOCK_METHOD2(AcceptlistUpdate, size_t(const std::vector<RawAddress>&,
+                                        const std::vector<RawAddress>&));
   MOCK_METHOD0(AcceptlistClear, void());
   MOCK_METHOD2(OnConnectionTimedOut, void(uint8_t, const RawAddress&));
 
@@ -66,6 +70,11 @@ void BTM_AcceptlistRemove(const RawAddress& address) {
   return localAcceptlistMock->AcceptlistRemove(address);
 }
 
+size_t BTM_AcceptlistUpdate(const std::vector<RawAddress>& to_remove,
+                            const std::vector<RawAddress>& to_add) {
+  return localAcceptlistMock->AcceptlistUpdate(to_remove, to_add);
+}
+
 void BTM_AcceptlistClear() { return localAcceptlistMock->AcceptlistClear(); }
 
 void BTM_BleTargetAnnouncementObserve(bool enable,
@@ -390,4 +399,60 @@ TEST_F(BleConnectionManager,
   Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
 }
 
+/** Verify that the accept list changes of a batch are applied in one update,
+ * without the ones that cancel each other out. */
+TEST_F(BleConnectionManager, test_background_connection_batch) {
+  RawAddress address3{{0x33, 0x33, 0x03, 0x33, 0x44, 0x33}};
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(_)).Times(0);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(_)).Times(0);
+  EXPECT_CALL(*localAcceptlistMock,
+              AcceptlistUpdate(IsEmpty(), ElementsAre(address2, address3)))
+      .WillOnce(Return(2));
+
+  tBATCH_STATS stats_before = get_batch_stats();
+  batch_begin();
+  EXPECT_TRUE(background_connect_add(CLIENT1, address1));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address2));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address3));
+  EXPECT_TRUE(background_connect_remove(CLIENT1, address1));
+  batch_end();
+
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+  tBATCH_STATS stats = get_batch_stats();
+  EXPECT_EQ(stats.batches - stats_before.batches, 1u);
+  EXPECT_EQ(stats.changes_requested - stats_before.changes_requested, 4u);
+  EXPECT_EQ(stats.changes_applied - stats_before.changes_applied, 2u);
+  EXPECT_EQ(stats.pauses_avoided - stats_before.pauses_avoided, 3u);
+
+  /* Deregistering the app removes its devices in one update */
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(_)).Times(0);
+  EXPECT_CALL(*localAcceptlistMock,
+              AcceptlistUpdate(ElementsAre(address2, address3), IsEmpty()))
+      .WillOnce(Return(0));
+  on_app_deregistered(CLIENT1);
+  EXPECT_EQ(get_apps_connecting_to(address2).size(), 0UL);
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+}
+
+/** Verify that a device the accept list has no room for in a batch is not
+ * considered to be in it. */
+TEST_F(BleConnectionManager, test_background_connection_batch_accept_list_full) {
+  EXPECT_CALL(*localAcceptlistMock,
+              AcceptlistUpdate(IsEmpty(), ElementsAre(address1, address2)))
+      .WillOnce(Return(1));
+
+  batch_begin();
+  EXPECT_TRUE(background_connect_add(CLIENT1, address1));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address2));
+  batch_end();
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  /* Only the device in the accept list is removed from it */
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(address1)).Times(1);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(address2)).Times(0);
+  EXPECT_TRUE(background_connect_remove(CLIENT1, address1));
+  EXPECT_TRUE(background_connect_remove(CLIENT1, address2));
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+}
+
 }  // namespace connection_manager
@@ -19,10 +19,15 @@
 
 #include <cstring>
 #include <map>
+#include <vector>
 
 #include "common/message_loop_thread.h"
+#include "osi/include/allocator.h"
 #include "osi/include/log.h"
+#include "stack/hid/hidd_int.h"
 #include "stack/hid/hidh_int.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/l2c_api.h"
 #include "stack/include/hci_error_code.h"
 #include "test/common/mock_functions.h"
 #include "test/mock/mock_stack_l2cap_api.h"
@@ -49,6 +54,8 @@ using testing::StrEq;
 using testing::StrictMock;
 using testing::Test;
 
+constexpr uint16_t kIntrCid = 0x41;
+
 class StackHidTest : public Test {
  public:
  protected:
@@ -74,4 +81,66 @@ TEST_F(StackHidTest, disconnect_bad_cid) {
   l2cap_callbacks.pL2CA_Error_Cb(123, 456);
 }
 
+TEST_F(StackHidTest, device_coalesces_reports_while_congested) {
+  tL2CAP_APPL_INFO l2cap_callbacks;
+  std::vector<std::vector<uint8_t>> sent;
+
+  test::mock::stack_l2cap_api::L2CA_Register2.body =
+      [&l2cap_callbacks](uint16_t psm, const tL2CAP_APPL_INFO& p_cb_info,
+                         bool enable_snoop, tL2CAP_ERTM_INFO* p_ertm_info,
+                         uint16_t my_mtu, uint16_t required_remote_mtu,
+                         uint16_t sec_level) {
+        l2cap_callbacks = p_cb_info;
+        return psm;
+      };
+  test::mock::stack_l2cap_api::L2CA_DataWrite.body = [&sent](uint16_t cid,
+                                                             BT_HDR* p_data) {
+    EXPECT_EQ(kIntrCid, cid);
+    EXPECT_EQ(0, p_data->layer_specific);
+    uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+    sent.emplace_back(p, p + p_data->len);
+    osi_free(p_data);
+    return sent.size() == 1 ? L2CAP_DW_CONGESTED : L2CAP_DW_SUCCESS;
+  };
+
+  ASSERT_EQ(HID_SUCCESS, hidd_conn_reg());
+  hd_cb.device.state = HIDD_DEV_CONNECTED;
+  hd_cb.device.conn.conn_state = HID_CONN_STATE_CONNECTED;
+  hd_cb.device.conn.intr_cid = kIntrCid;
+
+  l2cap_callbacks.pL2CA_CongestionStatus_Cb(kIntrCid, true);
+
+  uint8_t data[] = {0x10};
+  ASSERT_EQ(HID_SUCCESS, HID_DevSendReport(HID_CHANNEL_INTR,
+                                           HID_PAR_REP_TYPE_INPUT, 1, 1, data));
+  data[0] = 0x20;
+  ASSERT_EQ(HID_SUCCESS, HID_DevSendReport(HID_CHANNEL_INTR,
+                                           HID_PAR_REP_TYPE_INPUT, 2, 1, data));
+  data[0] = 0x11;
+  ASSERT_EQ(HID_SUCCESS, HID_DevSendReport(HID_CHANNEL_INTR,
+                                           HID_PAR_REP_TYPE_INPUT, 1, 1, data));
+  ASSERT_EQ(0, get_func_call_count("L2CA_DataWrite"));
+  ASSERT_EQ(2, hd_cb.num_coalesced_reports);
+
+  // The first write congests the channel again, the other report is kept
+  l2cap_callbacks.pL2CA_CongestionStatus_Cb(kIntrCid, false);
+  ASSERT_EQ(1u, sent.size());
+  ASSERT_EQ(1, hd_cb.num_coalesced_reports);
+
+  // Reports sent after the congestion is gone are not reordered
+  data[0] = 0x21;
+  ASSERT_EQ(HID_SUCCESS, HID_DevSendReport(HID_CHANNEL_INTR,
+                                           HID_PAR_REP_TYPE_INPUT, 2, 1, data));
+  l2cap_callbacks.pL2CA_CongestionStatus_Cb(kIntrCid, false);
+  ASSERT_EQ(2u, sent.size());
+  ASSERT_EQ(0, hd_cb.num_coalesced_reports);
+
+  const uint8_t hdr = HID_BUILD_HDR(HID_TRANS_DATA, HID_PAR_REP_TYPE_INPUT);
+  ASSERT_EQ((std::vector<uint8_t>{hdr, 1, 0x11}), sent[0]);
+  ASSERT_EQ((std::vector<uint8_t>{hdr, 2, 0x21}), sent[1]);
+
+  hd_cb.device.state = HIDD_DEV_NO_CONN;
+  hd_cb.device.conn.conn_state = HID_CONN_STATE_UNUSED;
+}
+
 }  // namespace
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 
 #include <cstddef>
+#include <vector>
 
 #include "osi/include/allocator.h"
 #include "stack/include/bt_uuid16.h"
@@ -26,6 +27,7 @@
 #include "stack/sdp/internal/sdp_api.h"
 #include "stack/sdp/sdpint.h"
 #include "test/mock/mock_osi_allocator.h"
+#include "test/mock/mock_osi_properties.h"
 #include "test/mock/mock_stack_l2cap_api.h"
 
 #ifndef BT_DEFAULT_BUFFER_SIZE
@@ -182,6 +184,7 @@ TEST_F(StackSdpMainTest, sdp_disc_wait_text) {
       std::make_pair(SDP_DISC_WAIT_HANDLES, "SDP_DISC_WAIT_HANDLES"),
       std::make_pair(SDP_DISC_WAIT_ATTR, "SDP_DISC_WAIT_ATTR"),
       std::make_pair(SDP_DISC_WAIT_SEARCH_ATTR, "SDP_DISC_WAIT_SEARCH_ATTR"),
+      std::make_pair(SDP_DISC_WAIT_DB_STATE, "SDP_DISC_WAIT_DB_STATE"),
       std::make_pair(SDP_DISC_WAIT_CANCEL, "SDP_DISC_WAIT_CANCEL"),
   };
   for (const auto& state : states) {
@@ -265,6 +268,216 @@ TEST_F(StackSdpMainTest, sdp_status_text) {
                    .c_str());
 }
 
+TEST_F(StackSdpMainTest, sdp_db_service_search_uuid_index) {
+  uint16_t a2dp_sink = UUID_SERVCLASS_AUDIO_SINK;
+  uint16_t hfp = UUID_SERVCLASS_HF_HANDSFREE;
+  uint32_t handle1 = SDP_CreateRecord();
+  uint32_t handle2 = SDP_CreateRecord();
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle1, 1, &a2dp_sink));
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle2, 1, &hfp));
+
+  tSDP_PROTOCOL_ELEM proto_list[2] = {};
+  proto_list[0].protocol_uuid = UUID_PROTOCOL_L2CAP;
+  proto_list[1].protocol_uuid = UUID_PROTOCOL_RFCOMM;
+  proto_list[1].num_params = 1;
+  proto_list[1].params[0] = 3;
+  ASSERT_TRUE(SDP_AddProtocolList(handle2, 2, proto_list));
+
+  // UUIDs nested in sequences are found, in their 16 and 128-bit forms
+  tSDP_UUID_SEQ seq = {};
+  seq.num_uids = 2;
+  seq.uuid_entry[0].len = 2;
+  seq.uuid_entry[0].value[0] = UUID_PROTOCOL_RFCOMM >> 8;
+  seq.uuid_entry[0].value[1] = UUID_PROTOCOL_RFCOMM & 0xff;
+  seq.uuid_entry[1].len = bluetooth::Uuid::kNumBytes128;
+  memcpy(seq.uuid_entry[1].value,
+         bluetooth::Uuid::From16Bit(hfp).To128BitBE().data(),
+         bluetooth::Uuid::kNumBytes128);
+
+  const tSDP_RECORD* p_rec = sdp_db_service_search(nullptr, &seq);
+  ASSERT_NE(nullptr, p_rec);
+  ASSERT_EQ(handle2, p_rec->record_handle);
+  ASSERT_EQ(nullptr, sdp_db_service_search(p_rec, &seq));
+
+  // The index follows the changes of the record
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle2, 1, &a2dp_sink));
+  ASSERT_EQ(nullptr, sdp_db_service_search(nullptr, &seq));
+
+  seq.num_uids = 1;
+  seq.uuid_entry[0].value[0] = a2dp_sink >> 8;
+  seq.uuid_entry[0].value[1] = a2dp_sink & 0xff;
+  p_rec = sdp_db_service_search(nullptr, &seq);
+  ASSERT_NE(nullptr, p_rec);
+  ASSERT_EQ(handle1, p_rec->record_handle);
+  p_rec = sdp_db_service_search(p_rec, &seq);
+  ASSERT_NE(nullptr, p_rec);
+  ASSERT_EQ(handle2, p_rec->record_handle);
+
+  ASSERT_TRUE(SDP_DeleteRecord(0));
+}
+
+TEST_F(StackSdpMainTest, sdp_service_search_attr_continuation) {
+  static std::vector<std::vector<uint8_t>> responses;
+  test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                        BT_HDR* p_data) {
+    uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+    responses.emplace_back(p, p + p_data->len);
+    osi_free_and_reset((void**)&p_data);
+    return 0;
+  };
+
+  const char* name = "A service name long enough to need continuations";
+  for (uint16_t i = 0; i < 4; i++) {
+    uint32_t handle = SDP_CreateRecord();
+    uint16_t service = UUID_SERVCLASS_SERIAL_PORT;
+    tSDP_PROTOCOL_ELEM proto_list[2] = {};
+    proto_list[0].protocol_uuid = UUID_PROTOCOL_L2CAP;
+    proto_list[1].protocol_uuid = UUID_PROTOCOL_RFCOMM;
+    proto_list[1].num_params = 1;
+    proto_list[1].params[0] = i + 1;
+    ASSERT_TRUE(SDP_AddServiceClassIdList(handle, 1, &service));
+    ASSERT_TRUE(SDP_AddProtocolList(handle, 2, proto_list));
+    ASSERT_TRUE(SDP_AddAttribute(handle, ATTR_ID_SERVICE_NAME,
+                                 TEXT_STR_DESC_TYPE, strlen(name) + 1,
+                                 (uint8_t*)name));
+  }
+
+  tCONN_CB* p_ccb = sdpu_allocate_ccb();
+  ASSERT_NE(nullptr, p_ccb);
+
+  // Reads the whole attribute list of the serial port records
+  auto read_list = [p_ccb](uint16_t mtu, size_t* num_rsp) {
+    std::vector<uint8_t> list;
+    std::vector<uint8_t> cont = {0};
+    p_ccb->rem_mtu_size = mtu;
+    responses.clear();
+    do {
+      std::vector<uint8_t> params = {0x35, 0x03, 0x19, 0x11, 0x01, 0xff, 0xff,
+                                     0x35, 0x05, 0x0a, 0x00, 0x00, 0xff, 0xff};
+      params.insert(params.end(), cont.begin(), cont.end());
+      BT_HDR* p_msg = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + 5 + params.size());
+      uint8_t* p = (uint8_t*)(p_msg + 1);
+      p_msg->offset = 0;
+      p_msg->len = 5 + params.size();
+      UINT8_TO_BE_STREAM(p, SDP_PDU_SERVICE_SEARCH_ATTR_REQ);
+      UINT16_TO_BE_STREAM(p, 1);
+      UINT16_TO_BE_STREAM(p, params.size());
+      memcpy(p, params.data(), params.size());
+      sdp_server_handle_client_req(p_ccb, p_msg);
+      osi_free(p_msg);
+
+      const std::vector<uint8_t>& rsp = responses.back();
+      EXPECT_EQ(SDP_PDU_SERVICE_SEARCH_ATTR_RSP, rsp[0]);
+      uint16_t len = (rsp[5] << 8) | rsp[6];
+      list.insert(list.end(), rsp.begin() + 7, rsp.begin() + 7 + len);
+      cont.assign(rsp.begin() + 7 + len, rsp.end());
+    } while (cont[0] != 0 && responses.size() < 100);
+    *num_rsp = responses.size();
+    return list;
+  };
+
+  size_t num_rsp;
+  std::vector<uint8_t> list = read_list(672, &num_rsp);
+  ASSERT_EQ(1u, num_rsp);
+  ASSERT_EQ((DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD, list[0]);
+  ASSERT_EQ(list.size() - 3, (size_t)((list[1] << 8) | list[2]));
+
+  // Fragmented responses carry the same list
+  ASSERT_EQ(list, read_list(48, &num_rsp));
+  ASSERT_GT(num_rsp, 4u);
+
+  sdpu_release_ccb(*p_ccb);
+  ASSERT_TRUE(SDP_DeleteRecord(0));
+}
+
+static tSDP_RESULT disc_cache_result;
+
+// Runs a service search attribute discovery of the serial port records, the
+// peer answering the requests it is sent with |rsps|. Returns the number of
+// requests sent.
+static size_t disc_cache_discover(
+    const std::vector<std::vector<uint8_t>>& rsps) {
+  static std::vector<std::vector<uint8_t>> requests;
+  test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                        BT_HDR* p_data) {
+    uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+    requests.emplace_back(p, p + p_data->len);
+    osi_free_and_reset((void**)&p_data);
+    return 0;
+  };
+  requests.clear();
+
+  bluetooth::Uuid uuid =
+      bluetooth::Uuid::From16Bit(UUID_SERVCLASS_SERIAL_PORT);
+  EXPECT_TRUE(
+      SDP_InitDiscoveryDb(sdp_db, BT_DEFAULT_BUFFER_SIZE, 1, &uuid, 0, nullptr));
+  disc_cache_result = SDP_GENERIC_ERROR;
+  EXPECT_TRUE(SDP_ServiceSearchAttributeRequest(
+      addr, sdp_db, [](const RawAddress& bd_addr, tSDP_RESULT result) {
+        disc_cache_result = result;
+      }));
+  const uint16_t cid = L2CA_ConnectReq2_cid;
+  tL2CAP_CFG_INFO cfg;
+  sdp_cb.reg_info.pL2CA_ConfigCfm_Cb(cid, 0, &cfg);
+
+  for (size_t i = 0; i < rsps.size() && i < requests.size(); i++) {
+    const std::vector<uint8_t>& rsp = rsps[i];
+    BT_HDR* p_msg = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + 7 + rsp.size() + 1);
+    uint8_t* p = (uint8_t*)(p_msg + 1);
+    p_msg->offset = 0;
+    p_msg->len = 7 + rsp.size() + 1;
+    UINT8_TO_BE_STREAM(p, SDP_PDU_SERVICE_SEARCH_ATTR_RSP);
+    UINT16_TO_BE_STREAM(p, (requests[i][1] << 8) | requests[i][2]);
+    UINT16_TO_BE_STREAM(p, 2 + rsp.size() + 1);
+    UINT16_TO_BE_STREAM(p, rsp.size());
+    ARRAY_TO_BE_STREAM(p, rsp.data(), (int)rsp.size());
+    UINT8_TO_BE_STREAM(p, 0);
+    sdp_cb.reg_info.pL2CA_DataInd_Cb(cid, p_msg);
+  }
+  sdp_cb.reg_info.pL2CA_DisconnectCfm_Cb(cid, 0);
+  return requests.size();
+}
+
+TEST_F(StackSdpMainTest, sdp_discovery_cache) {
+  const std::vector<uint8_t> state = {0x35, 0x0a, 0x35, 0x08, 0x09, 0x02,
+                                      0x01, 0x0a, 0x00, 0x00, 0x00, 0x01};
+  const std::vector<uint8_t> new_state = {0x35, 0x0a, 0x35, 0x08,
+                                          0x09, 0x02, 0x01, 0x0a,
+                                          0x00, 0x00, 0x00, 0x02};
+  const std::vector<uint8_t> no_state = {0x35, 0x00};
+  const std::vector<uint8_t> list = {0x35, 0x0a, 0x35, 0x08, 0x09, 0x00,
+                                     0x01, 0x35, 0x03, 0x19, 0x11, 0x01};
+  test::mock::osi_properties::osi_property_get_bool.body =
+      [](const char* key, bool default_value) { return default_value; };
+  sdp_disc_cache_clear();
+
+  // The first discovery queries the state, then searches the records
+  ASSERT_EQ(2u, disc_cache_discover({state, list}));
+  ASSERT_EQ(SDP_SUCCESS, disc_cache_result);
+  ASSERT_NE(nullptr, SDP_FindServiceInDb(sdp_db, UUID_SERVCLASS_SERIAL_PORT,
+                                         nullptr));
+
+  // An unchanged state is enough to get the same records
+  ASSERT_EQ(1u, disc_cache_discover({state}));
+  ASSERT_EQ(SDP_SUCCESS, disc_cache_result);
+  ASSERT_NE(nullptr, SDP_FindServiceInDb(sdp_db, UUID_SERVCLASS_SERIAL_PORT,
+                                         nullptr));
+
+  // A new state forces the search
+  ASSERT_EQ(2u, disc_cache_discover({new_state, list}));
+  ASSERT_EQ(SDP_SUCCESS, disc_cache_result);
+
+  // Peers without a state are not queried for it again
+  sdp_disc_cache_clear();
+  ASSERT_EQ(2u, disc_cache_discover({no_state, list}));
+  ASSERT_EQ(1u, disc_cache_discover({list}));
+  ASSERT_EQ(SDP_SUCCESS, disc_cache_result);
+  ASSERT_NE(nullptr, SDP_FindServiceInDb(sdp_db, UUID_SERVCLASS_SERIAL_PORT,
+                                         nullptr));
+  sdp_disc_cache_clear();
+  test::mock::osi_properties::osi_property_get_bool = {};
+}
+
 static tSDP_DISCOVERY_DB db{};
 static tSDP_DISC_REC rec{};
 static tSDP_DISC_ATTR uuid_desc_attr{};
@@ -38,6 +38,9 @@ const char* test_flags[] = {
 };
 
 const RawAddress kRawAddress = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+const RawAddress kRawAddress2 = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+const RawAddress kIdentityAddress =
+    RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x88});
 }  // namespace
 
 namespace bluetooth {
@@ -115,3 +118,34 @@ TEST_F(StackAclTest, acl_process_extended_features) {
 
   btm_acl_removed(hci_handle);
 }
+
+TEST_F(StackAclTest, acl_lookup_follows_connection_changes) {
+  const uint16_t hci_handle = 0x123;
+  const uint16_t hci_handle2 = 0x124;
+
+  btm_acl_created(kRawAddress, hci_handle, HCI_ROLE_CENTRAL, BT_TRANSPORT_LE);
+  btm_acl_created(kRawAddress2, hci_handle2, HCI_ROLE_CENTRAL,
+                  BT_TRANSPORT_LE);
+  tACL_CONN* p_acl = btm_acl_for_bda(kRawAddress, BT_TRANSPORT_LE);
+  tACL_CONN* p_acl2 = btm_acl_for_bda(kRawAddress2, BT_TRANSPORT_LE);
+  ASSERT_NE(nullptr, p_acl);
+  ASSERT_NE(nullptr, p_acl2);
+  ASSERT_NE(p_acl, p_acl2);
+  ASSERT_EQ(p_acl, acl_get_connection_from_handle(hci_handle));
+  ASSERT_EQ(p_acl2, acl_get_connection_from_handle(hci_handle2));
+  ASSERT_EQ(nullptr, btm_acl_for_bda(kRawAddress, BT_TRANSPORT_BR_EDR));
+
+  // The resolvable private address is replaced by the identity address
+  btm_acl_consolidate(kIdentityAddress, kRawAddress);
+  ASSERT_EQ(nullptr, btm_acl_for_bda(kRawAddress, BT_TRANSPORT_LE));
+  ASSERT_EQ(p_acl, btm_acl_for_bda(kIdentityAddress, BT_TRANSPORT_LE));
+  ASSERT_EQ(p_acl, acl_get_connection_from_handle(hci_handle));
+
+  btm_acl_removed(hci_handle);
+  ASSERT_EQ(nullptr, acl_get_connection_from_handle(hci_handle));
+  ASSERT_EQ(nullptr, btm_acl_for_bda(kIdentityAddress, BT_TRANSPORT_LE));
+  ASSERT_EQ(p_acl2, acl_get_connection_from_handle(hci_handle2));
+
+  btm_acl_removed(hci_handle2);
+  ASSERT_EQ(nullptr, btm_acl_for_bda(kRawAddress2, BT_TRANSPORT_LE));
+}
@@ -26,6 +26,7 @@
 #include "stack/include/avdt_api.h"
 #include "stack/test/common/mock_stack_avdt_msg.h"
 #include "test/common/mock_functions.h"
+#include "test/mock/mock_stack_l2cap_api.h"
 #include "types/raw_address.h"
 
 #ifndef UNUSED_ATTR
@@ -453,3 +454,59 @@ TEST_F(StackAvdtpTest, avdt_scb_hdl_pkt_no_frag_regression_test3) {
   // thus vt_data.p_pkt will be set to nullptr
   ASSERT_EQ(evt_data.p_pkt, nullptr);
 }
+
+TEST_F(StackAvdtpTest, test_media_fast_path) {
+  auto pscb = avdt_scb_by_hdl(scb_handle_);
+  ASSERT_NE(pscb, nullptr);
+
+  // Stream on the media transport channel 0x0041
+  constexpr uint16_t kMediaLcid = 0x0041;
+  uint8_t tcid = avdt_ad_type_to_tcid(AVDT_CHAN_MEDIA, pscb);
+  avdtp_cb.ad.rt_tbl[avdt_ccb_to_idx(pscb->p_ccb)][tcid].lcid = kMediaLcid;
+  pscb->state = AVDT_SCB_STREAM_ST;
+  avdt_scb_update_media_fast_path();
+  ASSERT_TRUE(pscb->media_fast_path);
+  ASSERT_EQ(pscb->media_lcid, kMediaLcid);
+  reset_mock_function_count_map();
+
+  uint16_t write_lcid = 0;
+  int write_count = 0;
+  test::mock::stack_l2cap_api::L2CA_DataWrite.body = [&](uint16_t cid,
+                                                         BT_HDR* p_data) {
+    write_lcid = cid;
+    write_count++;
+    osi_free(p_data);
+    return L2CAP_DW_SUCCESS;
+  };
+
+  // The media packet is sent without going through the state machine
+  BT_HDR* p_pkt = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + 100);
+  p_pkt->offset = AVDT_MEDIA_OFFSET;
+  p_pkt->len = 10;
+  ASSERT_EQ(AVDT_WriteReqOpt(scb_handle_, p_pkt, 0, 0, AVDT_DATA_OPT_NONE),
+            AVDT_SUCCESS);
+  ASSERT_EQ(write_count, 1);
+  ASSERT_EQ(write_lcid, kMediaLcid);
+  ASSERT_EQ(callback_event_, AVDT_WRITE_CFM_EVT);
+  ASSERT_EQ(get_func_call_count("A2DP_UsesRtpHeader"), 0);
+
+  // A congested channel holds the packet in the state machine
+  pscb->cong = true;
+  p_pkt = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + 100);
+  p_pkt->offset = AVDT_MEDIA_OFFSET;
+  p_pkt->len = 10;
+  ASSERT_EQ(AVDT_WriteReqOpt(scb_handle_, p_pkt, 0, 0, AVDT_DATA_OPT_NONE),
+            AVDT_SUCCESS);
+  ASSERT_EQ(write_count, 1);
+  ASSERT_EQ(pscb->p_pkt, p_pkt);
+  osi_free_and_reset((void**)&pscb->p_pkt);
+  pscb->cong = false;
+
+  // Leaving the streaming state disarms the fast path
+  tAVDT_SCB_EVT data;
+  avdt_scb_event(pscb, AVDT_SCB_TC_CLOSE_EVT, &data);
+  ASSERT_FALSE(pscb->media_fast_path);
+
+  test::mock::stack_l2cap_api::L2CA_DataWrite = {};
+  avdtp_cb.ad.rt_tbl[avdt_ccb_to_idx(pscb->p_ccb)][tcid].lcid = 0;
+}
@@ -20,6 +20,9 @@
 
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "stack/gatt/gatt_int.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/l2c_api.h"
+#include "stack/include/l2cdefs.h"
 #include "stack/test/common/mock_eatt.h"
 #include "test/common/mock_functions.h"
 #include "types/bluetooth/uuid.h"
@@ -86,3 +89,103 @@ TEST(GattDatabaseTest, matchExampleInBtSpecV52) {
 
   ASSERT_EQ(result_hash, expected_hash);
 }
+
+TEST(GattDatabaseTest, findAttributesAndServicesByHandle) {
+  tGATT_SVC_DB local_db[2];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_info;
+
+  add_item_to_list(srv_list_info, &local_db[0], true);
+  gatts_init_service_db(local_db[0], Uuid::From16Bit(0x1800), true, 0x0001, 5);
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A00));
+  srv_list_info.back().s_hdl = 0x0001;
+  srv_list_info.back().e_hdl = 0x0005;
+  // Leaves a gap of handles between the two services
+  add_item_to_list(srv_list_info, &local_db[1], true);
+  gatts_init_service_db(local_db[1], Uuid::From16Bit(0x1801), true, 0x0010, 4);
+  gatts_add_characteristic(local_db[1], 0, GATT_CHAR_PROP_BIT_INDICATE,
+    Uuid::From16Bit(0x2A05));
+  gatts_add_char_descr(local_db[1], GATT_CHAR_PROP_BIT_READ, Uuid::From16Bit(0x2902));
+  srv_list_info.back().s_hdl = 0x0010;
+  srv_list_info.back().e_hdl = 0x0013;
+
+  ASSERT_EQ(find_attr_by_handle(&local_db[0], 0x0000), nullptr);
+  ASSERT_EQ(find_attr_by_handle(&local_db[0], 0x0003)->handle, 0x0003);
+  ASSERT_EQ(find_attr_by_handle(&local_db[0], 0x0004), nullptr);
+  ASSERT_EQ(find_attr_by_handle(&local_db[1], 0x0012)->handle, 0x0012);
+  ASSERT_EQ(find_attr_by_handle(&local_db[1], 0x0013)->handle, 0x0013);
+  ASSERT_EQ(find_attr_by_handle(&local_db[1], 0x0014), nullptr);
+
+  gatt_cb.srv_list_info = &srv_list_info;
+  gatt_sr_update_srv_index();
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0001), srv_list_info.begin());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0005), srv_list_info.begin());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0008), srv_list_info.end());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0013), std::next(srv_list_info.begin()));
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0014), srv_list_info.end());
+  gatt_cb.srv_index.clear();
+  gatt_cb.srv_list_info = nullptr;
+}
+
+TEST(GattDatabaseTest, readByTypeOnlyReturnsAttributesInRange) {
+  tGATT_SVC_DB db;
+  gatts_init_service_db(db, Uuid::From16Bit(0x1800), true, 0x0001, 8);
+  gatts_add_characteristic(db, GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A00));
+  gatts_add_char_descr(db, GATT_PERM_READ, Uuid::From16Bit(0x2901));
+  gatts_add_characteristic(db, GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A01));
+
+  tGATT_TCB tcb;
+  alignas(BT_HDR) uint8_t buffer[sizeof(BT_HDR) + 256] = {};
+  BT_HDR* p_rsp = reinterpret_cast<BT_HDR*>(buffer);
+  uint16_t len = 100, err_hdl = 0;
+  // Characteristic declarations are at handles 0x0002 and 0x0005
+  ASSERT_EQ(gatts_db_read_attr_value_by_type(
+                tcb, L2CAP_ATT_CID, &db, GATT_REQ_READ_BY_TYPE, p_rsp, 0x0001,
+                0x0004, Uuid::From16Bit(GATT_UUID_CHAR_DECLARE), &len, 0, 0, 0,
+                &err_hdl),
+            GATT_SUCCESS);
+  ASSERT_EQ(p_rsp->len, 7);
+
+  *p_rsp = {};
+  ASSERT_EQ(gatts_db_read_attr_value_by_type(
+                tcb, L2CAP_ATT_CID, &db, GATT_REQ_READ_BY_TYPE, p_rsp, 0x0003,
+                0xFFFF, Uuid::From16Bit(GATT_UUID_CHAR_DECLARE), &len, 0, 0, 0,
+                &err_hdl),
+            GATT_SUCCESS);
+  ASSERT_EQ(p_rsp->len, 7);
+
+  ASSERT_EQ(gatts_db_read_attr_value_by_type(
+                tcb, L2CAP_ATT_CID, &db, GATT_REQ_READ_BY_TYPE, p_rsp, 0x0003,
+                0x0004, Uuid::From16Bit(GATT_UUID_CHAR_DECLARE), &len, 0, 0, 0,
+                &err_hdl),
+            GATT_NOT_FOUND);
+}
+
+TEST(GattDatabaseTest, hashOfCachedServicesFollowsServiceChanges) {
+  tGATT_SVC_DB local_db[2];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_info;
+
+  add_item_to_list(srv_list_info, &local_db[0], true);
+  gatts_init_service_db(local_db[0], Uuid::From16Bit(0x1800), true, 0x0001, 3);
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A00));
+  Octet16 first_hash = gatts_calculate_database_hash(&srv_list_info);
+  ASSERT_EQ(gatts_calculate_database_hash(&srv_list_info), first_hash);
+
+  add_item_to_list(srv_list_info, &local_db[1], true);
+  gatts_init_service_db(local_db[1], Uuid::From16Bit(0x1801), true, 0x0004, 3);
+  gatts_add_characteristic(local_db[1], 0, GATT_CHAR_PROP_BIT_INDICATE,
+    Uuid::From16Bit(0x2A05));
+  Octet16 second_hash = gatts_calculate_database_hash(&srv_list_info);
+  ASSERT_NE(second_hash, first_hash);
+
+  // Same result as serializing both services from scratch
+  std::list<tGATT_SRV_LIST_ELEM> fresh_list(srv_list_info);
+  for (auto& el : fresh_list) el.hash_info.clear();
+  ASSERT_EQ(gatts_calculate_database_hash(&fresh_list), second_hash);
+
+  srv_list_info.pop_back();
+  ASSERT_EQ(gatts_calculate_database_hash(&srv_list_info), first_hash);
+}
@@ -19,6 +19,7 @@
 #include "common/init_flags.h"
 #include "device/include/controller.h"
 #include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/include/l2cap_controller_interface.h"
 #include "stack/include/l2cap_hci_link_interface.h"
@@ -202,6 +203,84 @@ TEST_F(StackL2capChannelTest, l2c_link_init) {
             l2cb.controller_xmit_window);
 }
 
+TEST_F(StackL2capChannelTest, l2cu_get_tx_room) {
+  // Without a quota the channel never gets congested
+  ASSERT_EQ(UINT16_MAX, l2cu_get_tx_room(&ccb_));
+
+  ccb_.buff_quota = 2;
+  ccb_.xmit_hold_q = fixed_queue_new(SIZE_MAX);
+  ASSERT_EQ(3, l2cu_get_tx_room(&ccb_));
+
+  fixed_queue_enqueue(ccb_.xmit_hold_q, osi_calloc(sizeof(BT_HDR)));
+  ASSERT_EQ(2, l2cu_get_tx_room(&ccb_));
+
+  ccb_.cong_sent = true;
+  ASSERT_EQ(0, l2cu_get_tx_room(&ccb_));
+
+  fixed_queue_free(ccb_.xmit_hold_q, osi_free);
+  ccb_.xmit_hold_q = nullptr;
+}
+
+TEST_F(StackL2capTest, lcb_lookup_by_handle_and_bd_addr) {
+  const RawAddress addr_1({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const RawAddress addr_2({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+
+  tL2C_LCB* p_classic = l2cu_allocate_lcb(addr_1, false, BT_TRANSPORT_BR_EDR);
+  tL2C_LCB* p_le = l2cu_allocate_lcb(addr_1, false, BT_TRANSPORT_LE);
+  ASSERT_EQ(p_classic, l2cu_find_lcb_by_bd_addr(addr_1, BT_TRANSPORT_BR_EDR));
+  ASSERT_EQ(p_le, l2cu_find_lcb_by_bd_addr(addr_1, BT_TRANSPORT_LE));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(addr_2, BT_TRANSPORT_LE));
+
+  l2cu_set_lcb_handle(*p_le, 0x0040);
+  ASSERT_EQ(p_le, l2cu_find_lcb_by_handle(0x0040));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0041));
+
+  l2cu_set_lcb_bd_addr(p_le, addr_2);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(addr_1, BT_TRANSPORT_LE));
+  ASSERT_EQ(p_le, l2cu_find_lcb_by_bd_addr(addr_2, BT_TRANSPORT_LE));
+
+  l2cu_release_lcb(p_le);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(addr_2, BT_TRANSPORT_LE));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0040));
+  ASSERT_EQ(p_classic, l2cu_find_lcb_by_bd_addr(addr_1, BT_TRANSPORT_BR_EDR));
+
+  l2cu_release_lcb(p_classic);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(addr_1, BT_TRANSPORT_BR_EDR));
+}
+
+TEST_F(StackL2capTest, l2c_link_split_quota) {
+  uint16_t quota[3] = {};
+
+  // Equal shares without any traffic
+  const uint32_t no_demand[3] = {0, 0, 0};
+  l2c_link_split_quota(8, no_demand, quota, 3);
+  ASSERT_EQ(3, quota[0]);
+  ASSERT_EQ(3, quota[1]);
+  ASSERT_EQ(2, quota[2]);
+
+  // An idle link keeps one buffer, busy links share the rest
+  const uint32_t demand[3] = {300, 0, 100};
+  l2c_link_split_quota(10, demand, quota, 3);
+  ASSERT_EQ(6, quota[0]);
+  ASSERT_EQ(1, quota[1]);
+  ASSERT_EQ(3, quota[2]);
+
+  // Rounding leftovers go to the largest remainders
+  const uint32_t even_demand[3] = {1, 1, 1};
+  l2c_link_split_quota(7, even_demand, quota, 3);
+  ASSERT_EQ(7, quota[0] + quota[1] + quota[2]);
+  ASSERT_GE(quota[0], 2);
+  ASSERT_GE(quota[1], 2);
+  ASSERT_GE(quota[2], 2);
+}
+
+TEST_F(StackL2capTest, l2c_fcr_max_held_acks) {
+  // A third of the window unless configured otherwise
+  ASSERT_EQ(0, l2c_fcr_max_held_acks(1));
+  ASSERT_EQ(3, l2c_fcr_max_held_acks(10));
+  ASSERT_EQ(21, l2c_fcr_max_held_acks(63));
+}
+
 TEST_F(StackL2capTest, l2cap_result_code_text) {
   std::vector<std::pair<tL2CAP_CONN, std::string>> results = {
       std::make_pair(L2CAP_CONN_OK, "L2CAP_CONN_OK"),
@@ -246,3 +325,36 @@ TEST_F(StackL2capTest, l2cap_result_code_text) {
           static_cast<tL2CAP_CONN>(std::numeric_limits<std::uint16_t>::max()))
           .c_str());
 }
+
+TEST_F(StackL2capTest, l2cble_link_opt_next_class) {
+  tL2C_BLE_LINK_OPT opt = {};
+  ASSERT_EQ(L2C_BLE_TRAFFIC_IDLE, l2cble_link_opt_next_class(&opt));
+
+  // A bulk transfer steps up at once
+  opt.bytes = L2CAP_BLE_LINK_OPT_BULK_BYTES;
+  opt.packets = 20;
+  ASSERT_EQ(L2C_BLE_TRAFFIC_BULK, l2cble_link_opt_next_class(&opt));
+  ASSERT_EQ(0u, opt.bytes);
+  ASSERT_EQ(0u, opt.packets);
+  opt.traffic_class = L2C_BLE_TRAFFIC_BULK;
+
+  // and steps down only after the quiet periods
+  for (int i = 1; i < L2CAP_BLE_LINK_OPT_QUIET_PERIODS; i++) {
+    opt.packets = L2CAP_BLE_LINK_OPT_CONTROL_PACKETS;
+    ASSERT_EQ(L2C_BLE_TRAFFIC_BULK, l2cble_link_opt_next_class(&opt));
+  }
+  opt.packets = L2CAP_BLE_LINK_OPT_CONTROL_PACKETS;
+  ASSERT_EQ(L2C_BLE_TRAFFIC_CONTROL, l2cble_link_opt_next_class(&opt));
+  opt.traffic_class = L2C_BLE_TRAFFIC_CONTROL;
+
+  // A burst in the middle of the quiet periods starts them again
+  for (int i = 1; i < L2CAP_BLE_LINK_OPT_QUIET_PERIODS; i++) {
+    ASSERT_EQ(L2C_BLE_TRAFFIC_CONTROL, l2cble_link_opt_next_class(&opt));
+  }
+  opt.packets = L2CAP_BLE_LINK_OPT_CONTROL_PACKETS;
+  ASSERT_EQ(L2C_BLE_TRAFFIC_CONTROL, l2cble_link_opt_next_class(&opt));
+  for (int i = 1; i < L2CAP_BLE_LINK_OPT_QUIET_PERIODS; i++) {
+    ASSERT_EQ(L2C_BLE_TRAFFIC_CONTROL, l2cble_link_opt_next_class(&opt));
+  }
+  ASSERT_EQ(L2C_BLE_TRAFFIC_IDLE, l2cble_link_opt_next_class(&opt));
+}
@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 #include <stdarg.h>
 
+#include <cstring>
 #include <string>
 
 #include "crypto_toolbox/crypto_toolbox.h"
@@ -32,6 +33,7 @@
 #include "stack/smp/p_256_ecc_pp.h"
 #include "stack/smp/smp_int.h"
 #include "test/mock/mock_stack_acl.h"
+#include "test/mock/mock_stack_hcic_hciblecmds.h"
 #include "types/hci_role.h"
 #include "types/raw_address.h"
 
@@ -402,6 +404,117 @@ TEST(SmpEccValidationTest, test_invalid_points) {
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
 
+// Private keys and DHKey from Bluetooth Core Specification
+// Version 5.0 | Vol 3, Part H | 2.3.5.6.1
+static const uint32_t kPrivateKeyA[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b,
+    0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+static const uint32_t kPublicKeyAX[KEY_LENGTH_DWORDS_P256] = {
+    0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111,
+    0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2};
+static const uint32_t kPrivateKeyB[KEY_LENGTH_DWORDS_P256] = {
+    0xf47fc5fd, 0x6b4fdd49, 0xf19d7cfb, 0x59cb9ac2,
+    0xeed4e72a, 0x900afcfb, 0x32f6bb9a, 0x55188b3d};
+static const uint32_t kDhKey[KEY_LENGTH_DWORDS_P256] = {
+    0x73bfa698, 0x868d34f3, 0xb4f866f1, 0x99796b13,
+    0x0a397d9b, 0x341010a6, 0x57c8ad05, 0xec0234a3};
+
+TEST(SmpEccPointMultTest, test_dhkey) {
+  p_256_init_curve();
+
+  Point public_key_a;
+  ECC_PointMult_Base(&public_key_a, kPrivateKeyA);
+  EXPECT_EQ(0, memcmp(public_key_a.x, kPublicKeyAX, sizeof(kPublicKeyAX)));
+
+  Point public_key_b;
+  ECC_PointMult_Base(&public_key_b, kPrivateKeyB);
+
+  Point dhkey;
+  ECC_PointMult_Window(&dhkey, &public_key_b, kPrivateKeyA);
+  EXPECT_EQ(0, memcmp(dhkey.x, kDhKey, sizeof(kDhKey)));
+
+  // Same result as the binary NAF multiplication
+  uint32_t n[KEY_LENGTH_DWORDS_P256];
+  memcpy(n, kPrivateKeyB, sizeof(n));
+  ECC_PointMult_Bin_NAF(&dhkey, &public_key_a, n);
+  EXPECT_EQ(0, memcmp(dhkey.x, kDhKey, sizeof(kDhKey)));
+}
+
+class SmpKeyPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    p_256_init_curve();
+    smp_key_pool_clear();
+    // The controller random numbers are the octets of private key A, in order
+    test::mock::stack_hcic_hciblecmds::btsnd_hcic_ble_rand.body =
+        [this](base::Callback<void(BT_OCTET8)> cb) {
+          BT_OCTET8 rand;
+          memcpy(rand, (const uint8_t*)kPrivateKeyA + rand_offset_,
+                 BT_OCTET8_LEN);
+          rand_offset_ = (rand_offset_ + BT_OCTET8_LEN) % BT_OCTET32_LEN;
+          rand_count_++;
+          cb.Run(rand);
+        };
+  }
+
+  void TearDown() override {
+    smp_key_pool_clear();
+    test::mock::stack_hcic_hciblecmds::btsnd_hcic_ble_rand = {};
+  }
+
+  size_t rand_offset_ = 0;
+  int rand_count_ = 0;
+};
+
+TEST_F(SmpKeyPoolTest, refill_generates_key_pairs) {
+  smp_key_pool_refill();
+  // Each key pair takes four random numbers
+  ASSERT_EQ(rand_count_, 8);
+
+  for (int i = 0; i < 2; i++) {
+    BT_OCTET32 private_key;
+    tSMP_PUBLIC_KEY publ_key;
+    ASSERT_TRUE(smp_key_pool_take(private_key, &publ_key));
+    EXPECT_EQ(0, memcmp(private_key, kPrivateKeyA, BT_OCTET32_LEN));
+    EXPECT_EQ(0, memcmp(publ_key.x, kPublicKeyAX, BT_OCTET32_LEN));
+  }
+
+  BT_OCTET32 private_key;
+  tSMP_PUBLIC_KEY publ_key;
+  ASSERT_FALSE(smp_key_pool_take(private_key, &publ_key));
+
+  // Only the used key pairs are replaced
+  smp_key_pool_refill();
+  ASSERT_TRUE(smp_key_pool_take(private_key, &publ_key));
+  smp_key_pool_refill();
+  ASSERT_EQ(rand_count_, 20);
+}
+
+TEST_F(SmpKeyPoolTest, clear_drops_key_pairs) {
+  smp_key_pool_refill();
+  smp_key_pool_clear();
+
+  BT_OCTET32 private_key;
+  tSMP_PUBLIC_KEY publ_key;
+  ASSERT_FALSE(smp_key_pool_take(private_key, &publ_key));
+}
+
+TEST_F(SmpKeyPoolTest, random_numbers_requested_before_clear_are_dropped) {
+  base::Callback<void(BT_OCTET8)> pending;
+  test::mock::stack_hcic_hciblecmds::btsnd_hcic_ble_rand.body =
+      [&pending](base::Callback<void(BT_OCTET8)> cb) { pending = cb; };
+
+  smp_key_pool_refill();
+  ASSERT_FALSE(pending.is_null());
+  smp_key_pool_clear();
+
+  BT_OCTET8 rand = {};
+  base::Callback<void(BT_OCTET8)> cb = pending;
+  pending.Reset();
+  cb.Run(rand);
+  ASSERT_TRUE(pending.is_null());
+}
+
 TEST(SmpStatusText, smp_status_text) {
   std::vector<std::pair<tSMP_STATUS, std::string>> status = {
       std::make_pair(SMP_SUCCESS, "SMP_SUCCESS"),
@@ -48,6 +48,7 @@ struct BTA_dm_report_role_change BTA_dm_report_role_change;
 struct bta_dm_acl_up bta_dm_acl_up;
 struct bta_dm_add_ble_device bta_dm_add_ble_device;
 struct bta_dm_add_blekey bta_dm_add_blekey;
+struct bta_dm_add_bonded_devices bta_dm_add_bonded_devices;
 struct bta_dm_add_device bta_dm_add_device;
 struct bta_dm_ble_config_local_privacy bta_dm_ble_config_local_privacy;
 struct bta_dm_ble_confirm_reply bta_dm_ble_confirm_reply;
@@ -136,6 +137,10 @@ void bta_dm_add_blekey(const RawAddress& bd_addr, tBTA_LE_KEY_VALUE blekey,
   inc_func_call_count(__func__);
   test::mock::bta_dm_act::bta_dm_add_blekey(bd_addr, blekey, key_type);
 }
+void bta_dm_add_bonded_devices(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+  inc_func_call_count(__func__);
+  test::mock::bta_dm_act::bta_dm_add_bonded_devices(std::move(devices));
+}
 void bta_dm_add_device(std::unique_ptr<tBTA_DM_API_ADD_DEVICE> msg) {
   inc_func_call_count(__func__);
   test::mock::bta_dm_act::bta_dm_add_device(std::move(msg));
@@ -180,6 +180,18 @@ struct bta_dm_add_blekey {
 };
 extern struct bta_dm_add_blekey bta_dm_add_blekey;
 
+// Name: bta_dm_add_bonded_devices
+// Params: std::vector<tBTA_DM_BONDED_DEVICE> devices
+// Return: void
+struct bta_dm_add_bonded_devices {
+  std::function<void(std::vector<tBTA_DM_BONDED_DEVICE> devices)> body{
+      [](std::vector<tBTA_DM_BONDED_DEVICE> devices) {}};
+  void operator()(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+    body(std::move(devices));
+  };
+};
+extern struct bta_dm_add_bonded_devices bta_dm_add_bonded_devices;
+
 // Name: bta_dm_add_device
 // Params: std::unique_ptr<tBTA_DM_API_ADD_DEVICE> msg
 // Return: void
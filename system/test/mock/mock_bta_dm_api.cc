@@ -38,6 +38,7 @@ namespace bta_dm_api {
 // Function state capture and return values, if needed
 struct BTA_DmAddBleDevice BTA_DmAddBleDevice;
 struct BTA_DmAddBleKey BTA_DmAddBleKey;
+struct BTA_DmAddBondedDevices BTA_DmAddBondedDevices;
 struct BTA_DmAddDevice BTA_DmAddDevice;
 struct BTA_DmAllowWakeByHid BTA_DmAllowWakeByHid;
 struct BTA_DmBleConfigLocalPrivacy BTA_DmBleConfigLocalPrivacy;
@@ -115,6 +116,10 @@ void BTA_DmAddBleKey(const RawAddress& bd_addr, tBTA_LE_KEY_VALUE* p_le_key,
   inc_func_call_count(__func__);
   test::mock::bta_dm_api::BTA_DmAddBleKey(bd_addr, p_le_key, key_type);
 }
+void BTA_DmAddBondedDevices(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+  inc_func_call_count(__func__);
+  test::mock::bta_dm_api::BTA_DmAddBondedDevices(std::move(devices));
+}
 void BTA_DmAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
                      const LinkKey& link_key, uint8_t key_type,
                      uint8_t pin_length) {
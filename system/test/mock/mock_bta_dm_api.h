@@ -76,6 +76,18 @@ struct BTA_DmAddBleKey {
 };
 extern struct BTA_DmAddBleKey BTA_DmAddBleKey;
 
+// Name: BTA_DmAddBondedDevices
+// Params: std::vector<tBTA_DM_BONDED_DEVICE> devices
+// Return: void
+struct BTA_DmAddBondedDevices {
+  std::function<void(std::vector<tBTA_DM_BONDED_DEVICE> devices)> body{
+      [](std::vector<tBTA_DM_BONDED_DEVICE> devices) {}};
+  void operator()(std::vector<tBTA_DM_BONDED_DEVICE> devices) {
+    body(std::move(devices));
+  };
+};
+extern struct BTA_DmAddBondedDevices BTA_DmAddBondedDevices;
+
 // Name: BTA_DmAddDevice
 // Params: const RawAddress& bd_addr, DEV_CLASS dev_class, const LinkKey&
 // link_key, uint8_t key_type, uint8_t pin_length Return: void
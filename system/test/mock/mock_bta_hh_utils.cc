@@ -46,6 +46,8 @@ struct bta_hh_tod_spt bta_hh_tod_spt;
 struct bta_hh_trace_dev_db bta_hh_trace_dev_db;
 struct bta_hh_update_di_info bta_hh_update_di_info;
 struct bta_hh_le_is_hh_gatt_if bta_hh_le_is_hh_gatt_if;
+struct bta_hh_update_rpt_stats bta_hh_update_rpt_stats;
+struct bta_hh_rpt_hist_text bta_hh_rpt_hist_text;
 
 }  // namespace bta_hh_utils
 }  // namespace mock
@@ -109,5 +111,15 @@ bool bta_hh_le_is_hh_gatt_if(tGATT_IF client_if) {
   test::mock::bta_hh_utils::bta_hh_le_is_hh_gatt_if(client_if);
   return false;
 }
+void bta_hh_update_rpt_stats(tBTA_HH_RPT_STATS* p_stats,
+                             uint64_t rx_timestamp_us, uint64_t now_us) {
+  inc_func_call_count(__func__);
+  test::mock::bta_hh_utils::bta_hh_update_rpt_stats(p_stats, rx_timestamp_us,
+                                                    now_us);
+}
+std::string bta_hh_rpt_hist_text(const tBTA_HH_RPT_HIST& hist) {
+  inc_func_call_count(__func__);
+  return test::mock::bta_hh_utils::bta_hh_rpt_hist_text(hist);
+}
 // Mocked functions complete
 // END mockcify generation
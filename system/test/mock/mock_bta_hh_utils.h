@@ -23,6 +23,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
 
 // Original included files, if any
 #include "bta/hh/bta_hh_int.h"
@@ -175,6 +176,32 @@ struct bta_hh_le_is_hh_gatt_if {
 };
 extern struct bta_hh_le_is_hh_gatt_if bta_hh_le_is_hh_gatt_if;
 
+// Name: bta_hh_update_rpt_stats
+// Params: tBTA_HH_RPT_STATS* p_stats, uint64_t rx_timestamp_us, uint64_t
+// now_us Return: void
+struct bta_hh_update_rpt_stats {
+  std::function<void(tBTA_HH_RPT_STATS* p_stats, uint64_t rx_timestamp_us,
+                     uint64_t now_us)>
+      body{[](tBTA_HH_RPT_STATS* p_stats, uint64_t rx_timestamp_us,
+              uint64_t now_us) {}};
+  void operator()(tBTA_HH_RPT_STATS* p_stats, uint64_t rx_timestamp_us,
+                  uint64_t now_us) {
+    body(p_stats, rx_timestamp_us, now_us);
+  };
+};
+extern struct bta_hh_update_rpt_stats bta_hh_update_rpt_stats;
+
+// Name: bta_hh_rpt_hist_text
+// Params: const tBTA_HH_RPT_HIST& hist
+// Return: std::string
+struct bta_hh_rpt_hist_text {
+  std::string return_value{};
+  std::function<std::string(const tBTA_HH_RPT_HIST& hist)> body{
+      [this](const tBTA_HH_RPT_HIST& hist) { return return_value; }};
+  std::string operator()(const tBTA_HH_RPT_HIST& hist) { return body(hist); };
+};
+extern struct bta_hh_rpt_hist_text bta_hh_rpt_hist_text;
+
 }  // namespace bta_hh_utils
 }  // namespace mock
 }  // namespace test
@@ -57,6 +57,10 @@ tBTA_JV_STATUS BTA_JvL2capRead(uint32_t handle, uint32_t req_id,
   inc_func_call_count(__func__);
   return 0;
 }
+tBTA_JV_STATUS BTA_JvL2capReadBuf(uint32_t handle, BT_HDR** pp_buf) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 tBTA_JV_STATUS BTA_JvL2capReady(uint32_t handle, uint32_t* p_data_size) {
   inc_func_call_count(__func__);
   return 0;
@@ -128,6 +132,13 @@ void BTA_JvL2capConnect(int conn_type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
                         uint32_t l2cap_socket_id) {
   inc_func_call_count(__func__);
 }
+void BTA_JvL2capConnectCreditBased(tBTA_SEC sec_mask, uint16_t remote_psm,
+                                   uint16_t rx_mtu, uint8_t num_channels,
+                                   const RawAddress& peer_bd_addr,
+                                   tBTA_JV_L2CAP_CBACK* p_cback,
+                                   uint32_t l2cap_socket_id) {
+  inc_func_call_count(__func__);
+}
 void BTA_JvL2capStartServer(int conn_type, tBTA_SEC sec_mask, tBTA_JV_ROLE role,
                             std::unique_ptr<tL2CAP_ERTM_INFO> ertm_info,
                             uint16_t local_psm, uint16_t rx_mtu,
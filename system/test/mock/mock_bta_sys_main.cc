@@ -51,6 +51,7 @@ struct bta_sys_start_timer bta_sys_start_timer;
 }  // namespace test
 
 // Mocked functions, if any
+void DumpsysBtaSys(int fd) { inc_func_call_count(__func__); }
 void BTA_sys_signal_hw_error() {
   inc_func_call_count(__func__);
   test::mock::bta_sys_main::BTA_sys_signal_hw_error();
@@ -15,7 +15,7 @@
  */
 /*
  * Generated mock file from original source file
- *   Functions generated:5
+ *   Functions generated:7
  *
  *  mockcify.pl ver 0.6.0
  */
@@ -37,10 +37,12 @@ namespace btif_profile_queue {
 
 // Function state capture and return values, if needed
 struct btif_queue_advance btif_queue_advance;
+struct btif_queue_advance_by_uuid btif_queue_advance_by_uuid;
 struct btif_queue_cleanup btif_queue_cleanup;
 struct btif_queue_connect btif_queue_connect;
 struct btif_queue_connect_next btif_queue_connect_next;
 struct btif_queue_release btif_queue_release;
+struct btif_debug_queue_dump btif_debug_queue_dump;
 
 }  // namespace btif_profile_queue
 }  // namespace mock
@@ -63,6 +65,10 @@ void btif_queue_advance() {
   inc_func_call_count(__func__);
   test::mock::btif_profile_queue::btif_queue_advance();
 }
+void btif_queue_advance_by_uuid(uint16_t uuid, const RawAddress* bda) {
+  inc_func_call_count(__func__);
+  test::mock::btif_profile_queue::btif_queue_advance_by_uuid(uuid, bda);
+}
 void btif_queue_cleanup(uint16_t uuid) {
   inc_func_call_count(__func__);
   test::mock::btif_profile_queue::btif_queue_cleanup(uuid);
@@ -81,5 +87,9 @@ void btif_queue_release() {
   inc_func_call_count(__func__);
   test::mock::btif_profile_queue::btif_queue_release();
 }
+void btif_debug_queue_dump(int fd) {
+  inc_func_call_count(__func__);
+  test::mock::btif_profile_queue::btif_debug_queue_dump(fd);
+}
 // Mocked functions complete
 // END mockcify generation
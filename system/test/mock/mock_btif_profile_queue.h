@@ -17,7 +17,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:5
+ *   Functions generated:7
  *
  *  mockcify.pl ver 0.6.0
  */
@@ -47,6 +47,16 @@ struct btif_queue_advance {
 };
 extern struct btif_queue_advance btif_queue_advance;
 
+// Name: btif_queue_advance_by_uuid
+// Params: uint16_t uuid, const RawAddress* bda
+// Return: void
+struct btif_queue_advance_by_uuid {
+  std::function<void(uint16_t uuid, const RawAddress* bda)> body{
+      [](uint16_t uuid, const RawAddress* bda) {}};
+  void operator()(uint16_t uuid, const RawAddress* bda) { body(uuid, bda); };
+};
+extern struct btif_queue_advance_by_uuid btif_queue_advance_by_uuid;
+
 // Name: btif_queue_cleanup
 // Params: uint16_t uuid
 // Return: void
@@ -91,6 +101,15 @@ struct btif_queue_release {
 };
 extern struct btif_queue_release btif_queue_release;
 
+// Name: btif_debug_queue_dump
+// Params: int fd
+// Return: void
+struct btif_debug_queue_dump {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct btif_debug_queue_dump btif_debug_queue_dump;
+
 }  // namespace btif_profile_queue
 }  // namespace mock
 }  // namespace test
@@ -46,6 +46,12 @@ void bluetooth::shim::ACL_IgnoreLeConnectionFrom(
     const tBLE_BD_ADDR& legacy_address_with_type) {
   inc_func_call_count(__func__);
 }
+size_t bluetooth::shim::ACL_UpdateLeAcceptList(
+    const std::vector<tBLE_BD_ADDR>& to_remove,
+    const std::vector<tBLE_BD_ADDR>& to_add) {
+  inc_func_call_count(__func__);
+  return to_add.size();
+}
 void bluetooth::shim::ACL_ConfigureLePrivacy(bool is_le_privacy_enabled) {
   inc_func_call_count(__func__);
 }
@@ -86,6 +92,11 @@ void bluetooth::shim::ACL_RemoveFromAddressResolution(
     const tBLE_BD_ADDR& legacy_address_with_type) {
   inc_func_call_count(__func__);
 }
+void bluetooth::shim::ACL_UpdateAddressResolution(
+    const std::vector<tBLE_BD_ADDR>& to_remove,
+    const std::vector<std::tuple<tBLE_BD_ADDR, Octet16, Octet16>>& to_add) {
+  inc_func_call_count(__func__);
+}
 void bluetooth::shim::ACL_ClearAddressResolution() {
   inc_func_call_count(__func__);
 }
@@ -42,6 +42,7 @@ struct alarm_get_remaining_ms alarm_get_remaining_ms;
 struct alarm_is_scheduled alarm_is_scheduled;
 struct alarm_new alarm_new;
 struct alarm_new_periodic alarm_new_periodic;
+struct alarm_new_with_priority alarm_new_with_priority;
 struct alarm_set alarm_set;
 struct alarm_set_on_mloop alarm_set_on_mloop;
 
@@ -82,6 +83,12 @@ alarm_t* alarm_new_periodic(const char* name) {
   inc_func_call_count(__func__);
   return test::mock::osi_alarm::alarm_new_periodic(name);
 }
+alarm_t* alarm_new_with_priority(const char* name, bool is_periodic,
+                                 alarm_priority_t priority) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_alarm::alarm_new_with_priority(name, is_periodic,
+                                                        priority);
+}
 void alarm_set(alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
                void* data) {
   inc_func_call_count(__func__);
@@ -116,6 +116,22 @@ struct alarm_new_periodic {
 };
 extern struct alarm_new_periodic alarm_new_periodic;
 
+// Name: alarm_new_with_priority
+// Params: const char* name, bool is_periodic, alarm_priority_t priority
+// Return: alarm_t*
+struct alarm_new_with_priority {
+  alarm_t* return_value{0};
+  std::function<alarm_t*(const char* name, bool is_periodic,
+                         alarm_priority_t priority)>
+      body{[this](const char* name, bool is_periodic,
+                  alarm_priority_t priority) { return return_value; }};
+  alarm_t* operator()(const char* name, bool is_periodic,
+                      alarm_priority_t priority) {
+    return body(name, is_periodic, priority);
+  };
+};
+extern struct alarm_new_with_priority alarm_new_with_priority;
+
 // Name: alarm_set
 // Params: alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb, void* data
 // Return: void
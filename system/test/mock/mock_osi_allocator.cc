@@ -23,6 +23,7 @@
 // Mock include file to share data between tests and mock
 #include "test/mock/mock_osi_allocator.h"
 
+#include "osi/include/allocator.h"
 #include "test/common/mock_functions.h"
 
 // Mocked internal structures, if any
@@ -44,7 +45,7 @@ struct osi_strndup osi_strndup;
 }  // namespace test
 
 // Mocked functions, if any
-void* osi_calloc(size_t size) {
+void* osi_calloc(size_t size, const char* caller_file) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_calloc(size);
 }
@@ -56,7 +57,7 @@ void osi_free_and_reset(void** p_ptr) {
   inc_func_call_count(__func__);
   test::mock::osi_allocator::osi_free_and_reset(p_ptr);
 }
-void* osi_malloc(size_t size) {
+void* osi_malloc(size_t size, const char* caller_file) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_malloc(size);
 }
@@ -68,5 +69,24 @@ char* osi_strndup(const char* str, size_t len) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_strndup(str, len);
 }
+void* osi_calloc_tagged(osi_alloc_tag_t tag, size_t size) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_allocator::osi_calloc(size);
+}
+void* osi_malloc_tagged(osi_alloc_tag_t tag, size_t size) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_allocator::osi_malloc(size);
+}
+bool osi_allocator_get_slab_stats(
+    osi_slab_class_stats_t stats[OSI_SLAB_NUM_CLASSES]) {
+  inc_func_call_count(__func__);
+  return false;
+}
+bool osi_allocator_get_tag_stats(
+    osi_alloc_tag_stats_t stats[OSI_ALLOC_TAG_COUNT]) {
+  inc_func_call_count(__func__);
+  return false;
+}
+void osi_allocator_debug_dump(int fd) { inc_func_call_count(__func__); }
 // Mocked functions complete
 // END mockcify generation
@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:2
+ *   Functions generated:5
  *
  *  mockcify.pl ver 0.3.0
  */
@@ -34,6 +34,9 @@ namespace osi_thread_scheduler {
 // Function state capture and return values, if needed
 struct thread_scheduler_enable_real_time thread_scheduler_enable_real_time;
 struct thread_scheduler_get_priority_range thread_scheduler_get_priority_range;
+struct thread_scheduler_get_profile thread_scheduler_get_profile;
+struct thread_scheduler_apply_profile thread_scheduler_apply_profile;
+struct thread_scheduler_debug_dump thread_scheduler_debug_dump;
 
 }  // namespace osi_thread_scheduler
 }  // namespace mock
@@ -50,5 +53,20 @@ bool thread_scheduler_get_priority_range(int& min, int& max) {
   return test::mock::osi_thread_scheduler::thread_scheduler_get_priority_range(
       min, max);
 }
+bool thread_scheduler_get_profile(const char* name,
+                                  thread_scheduler_profile_t* profile) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_thread_scheduler::thread_scheduler_get_profile(
+      name, profile);
+}
+bool thread_scheduler_apply_profile(pid_t linux_tid, const char* name) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_thread_scheduler::thread_scheduler_apply_profile(
+      linux_tid, name);
+}
+void thread_scheduler_debug_dump(int fd) {
+  inc_func_call_count(__func__);
+  test::mock::osi_thread_scheduler::thread_scheduler_debug_dump(fd);
+}
 // Mocked functions complete
 // END mockcify generation
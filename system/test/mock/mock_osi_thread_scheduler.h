@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:2
+ *   Functions generated:5
  *
  *  mockcify.pl ver 0.3.0
  */
@@ -26,6 +26,7 @@
 #include <functional>
 
 // Original included files, if any
+#include "osi/include/thread_scheduler.h"
 
 // Mocked compile conditionals, if any
 
@@ -58,6 +59,43 @@ struct thread_scheduler_get_priority_range {
 extern struct thread_scheduler_get_priority_range
     thread_scheduler_get_priority_range;
 
+// Name: thread_scheduler_get_profile
+// Params: const char* name, thread_scheduler_profile_t* profile
+// Return: bool
+struct thread_scheduler_get_profile {
+  bool return_value{false};
+  std::function<bool(const char* name, thread_scheduler_profile_t* profile)>
+      body{[this](const char* name, thread_scheduler_profile_t* profile) {
+        return return_value;
+      }};
+  bool operator()(const char* name, thread_scheduler_profile_t* profile) {
+    return body(name, profile);
+  };
+};
+extern struct thread_scheduler_get_profile thread_scheduler_get_profile;
+
+// Name: thread_scheduler_apply_profile
+// Params: pid_t linux_tid, const char* name
+// Return: bool
+struct thread_scheduler_apply_profile {
+  bool return_value{true};
+  std::function<bool(pid_t linux_tid, const char* name)> body{
+      [this](pid_t linux_tid, const char* name) { return return_value; }};
+  bool operator()(pid_t linux_tid, const char* name) {
+    return body(linux_tid, name);
+  };
+};
+extern struct thread_scheduler_apply_profile thread_scheduler_apply_profile;
+
+// Name: thread_scheduler_debug_dump
+// Params: int fd
+// Return: void
+struct thread_scheduler_debug_dump {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct thread_scheduler_debug_dump thread_scheduler_debug_dump;
+
 }  // namespace osi_thread_scheduler
 }  // namespace mock
 }  // namespace test
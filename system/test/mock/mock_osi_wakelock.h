@@ -16,11 +16,12 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:6
+ *   Functions generated:9
  *
  *  mockcify.pl ver 0.3.0
  */
 
+#include <cstdint>
 #include <functional>
 
 #include "include/hardware/bluetooth.h"
@@ -45,6 +46,17 @@ struct wakelock_acquire {
 };
 extern struct wakelock_acquire wakelock_acquire;
 
+// Name: wakelock_acquire_for
+// Params: const char* reason
+// Return: bool
+struct wakelock_acquire_for {
+  bool return_value{false};
+  std::function<bool(const char* reason)> body{
+      [this](const char* reason) { return return_value; }};
+  bool operator()(const char* reason) { return body(reason); };
+};
+extern struct wakelock_acquire_for wakelock_acquire_for;
+
 // Name: wakelock_cleanup
 // Params: void
 // Return: void
@@ -73,6 +85,26 @@ struct wakelock_release {
 };
 extern struct wakelock_release wakelock_release;
 
+// Name: wakelock_release_for
+// Params: const char* reason
+// Return: bool
+struct wakelock_release_for {
+  bool return_value{false};
+  std::function<bool(const char* reason)> body{
+      [this](const char* reason) { return return_value; }};
+  bool operator()(const char* reason) { return body(reason); };
+};
+extern struct wakelock_release_for wakelock_release_for;
+
+// Name: wakelock_set_linger_ms
+// Params: uint64_t linger_ms
+// Return: void
+struct wakelock_set_linger_ms {
+  std::function<void(uint64_t linger_ms)> body{[](uint64_t linger_ms) {}};
+  void operator()(uint64_t linger_ms) { body(linger_ms); };
+};
+extern struct wakelock_set_linger_ms wakelock_set_linger_ms;
+
 // Name: wakelock_set_os_callouts
 // Params: bt_os_callouts_t* callouts
 // Return: void
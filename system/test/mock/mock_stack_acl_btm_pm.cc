@@ -65,6 +65,14 @@ void BTM_PM_OnConnected(uint16_t /* handle */,
 void BTM_PM_OnDisconnected(uint16_t /* handle */) {
   inc_func_call_count(__func__);
 }
+void BTM_PM_OnAclTraffic(uint16_t /* handle */) {
+  inc_func_call_count(__func__);
+}
+tBTM_STATUS BTM_PM_SetMaxSniffInterval(const RawAddress& /* remote_bda */,
+                                       uint16_t /* max_interval */) {
+  inc_func_call_count(__func__);
+  return BTM_SUCCESS;
+}
 void btm_pm_on_mode_change(tHCI_STATUS /* status */, uint16_t /* handle */,
                            tHCI_MODE /* current_mode */,
                            uint16_t /* interval */) {
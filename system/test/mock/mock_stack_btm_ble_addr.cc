@@ -80,6 +80,8 @@ tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda) {
   return test::mock::stack_btm_ble_addr::btm_ble_resolve_random_addr(
       random_bda);
 }
+void btm_ble_clear_rpa_resolution_cache() { inc_func_call_count(__func__); }
+void BTM_BleAddrDumpsys(int /* fd */) { inc_func_call_count(__func__); }
 bool btm_identity_addr_to_random_pseudo(RawAddress* bd_addr,
                                         tBLE_ADDR_TYPE* p_addr_type,
                                         bool refresh) {
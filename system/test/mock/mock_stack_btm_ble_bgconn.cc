@@ -44,6 +44,7 @@ struct BTM_SetLeConnectionModeToSlow BTM_SetLeConnectionModeToSlow;
 struct BTM_AcceptlistAdd BTM_AcceptlistAdd;
 struct BTM_AcceptlistAddDirect BTM_AcceptlistAddDirect;
 struct BTM_AcceptlistRemove BTM_AcceptlistRemove;
+struct BTM_AcceptlistUpdate BTM_AcceptlistUpdate;
 struct BTM_AcceptlistClear BTM_AcceptlistClear;
 
 }  // namespace stack_btm_ble_bgconn
@@ -84,6 +85,12 @@ void BTM_AcceptlistRemove(const RawAddress& address) {
   inc_func_call_count(__func__);
   test::mock::stack_btm_ble_bgconn::BTM_AcceptlistRemove(address);
 }
+size_t BTM_AcceptlistUpdate(const std::vector<RawAddress>& to_remove,
+                            const std::vector<RawAddress>& to_add) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_btm_ble_bgconn::BTM_AcceptlistUpdate(to_remove,
+                                                                to_add);
+}
 void BTM_AcceptlistClear() {
   inc_func_call_count(__func__);
   test::mock::stack_btm_ble_bgconn::BTM_AcceptlistClear();
@@ -22,6 +22,7 @@
  */
 
 #include <functional>
+#include <vector>
 
 // Original included files, if any
 #include <base/functional/bind.h>
@@ -107,6 +108,22 @@ struct BTM_AcceptlistRemove {
   void operator()(const RawAddress& address) { body(address); };
 };
 extern struct BTM_AcceptlistRemove BTM_AcceptlistRemove;
+// Name: BTM_AcceptlistUpdate
+// Params: const std::vector<RawAddress>& to_remove, const
+// std::vector<RawAddress>& to_add Returns: size_t
+struct BTM_AcceptlistUpdate {
+  std::function<size_t(const std::vector<RawAddress>& to_remove,
+                       const std::vector<RawAddress>& to_add)>
+      body{[](const std::vector<RawAddress>& /* to_remove */,
+              const std::vector<RawAddress>& to_add) {
+        return to_add.size();
+      }};
+  size_t operator()(const std::vector<RawAddress>& to_remove,
+                    const std::vector<RawAddress>& to_add) {
+    return body(to_remove, to_add);
+  };
+};
+extern struct BTM_AcceptlistUpdate BTM_AcceptlistUpdate;
 // Name: BTM_AcceptlistClear
 // Params:
 // Returns: void
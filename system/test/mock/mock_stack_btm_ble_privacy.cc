@@ -48,6 +48,7 @@ struct btm_ble_clear_resolving_list btm_ble_clear_resolving_list;
 struct btm_ble_read_resolving_list_entry btm_ble_read_resolving_list_entry;
 struct btm_ble_resolving_list_load_dev btm_ble_resolving_list_load_dev;
 struct btm_ble_resolving_list_remove_dev btm_ble_resolving_list_remove_dev;
+struct btm_ble_resolving_list_touch btm_ble_resolving_list_touch;
 struct btm_ble_resolving_list_init btm_ble_resolving_list_init;
 
 }  // namespace stack_btm_ble_privacy
@@ -99,6 +100,10 @@ void btm_ble_resolving_list_remove_dev(tBTM_SEC_DEV_REC* p_dev_rec) {
   test::mock::stack_btm_ble_privacy::btm_ble_resolving_list_remove_dev(
       p_dev_rec);
 }
+void btm_ble_resolving_list_touch(const tBTM_SEC_DEV_REC& dev_rec) {
+  inc_func_call_count(__func__);
+  test::mock::stack_btm_ble_privacy::btm_ble_resolving_list_touch(dev_rec);
+}
 void btm_ble_resolving_list_init(uint8_t max_irk_list_sz) {
   inc_func_call_count(__func__);
   test::mock::stack_btm_ble_privacy::btm_ble_resolving_list_init(
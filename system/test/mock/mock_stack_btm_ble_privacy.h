@@ -122,6 +122,15 @@ struct btm_ble_resolving_list_remove_dev {
 };
 extern struct btm_ble_resolving_list_remove_dev
     btm_ble_resolving_list_remove_dev;
+// Name: btm_ble_resolving_list_touch
+// Params: const tBTM_SEC_DEV_REC& dev_rec
+// Returns: void
+struct btm_ble_resolving_list_touch {
+  std::function<void(const tBTM_SEC_DEV_REC& dev_rec)> body{
+      [](const tBTM_SEC_DEV_REC& /* dev_rec */) {}};
+  void operator()(const tBTM_SEC_DEV_REC& dev_rec) { body(dev_rec); };
+};
+extern struct btm_ble_resolving_list_touch btm_ble_resolving_list_touch;
 // Name: btm_ble_enable_resolving_list_for_platform
 // Params: uint8_t rl_mask
 // Returns: void
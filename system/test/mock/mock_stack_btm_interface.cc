@@ -98,6 +98,11 @@ struct btm_client_interface_t default_btm_client_interface = {
                                uint16_t /* min_loc_to */) -> tBTM_STATUS {
           return BTM_SUCCESS;
         },
+        .BTM_PM_SetMaxSniffInterval =
+            [](const RawAddress& /* bd_addr */,
+               uint16_t /* max_interval */) -> tBTM_STATUS {
+          return BTM_SUCCESS;
+        },
         .BTM_SwitchRoleToCentral = [](const RawAddress& /* remote_bd_addr */)
             -> tBTM_STATUS { return BTM_SUCCESS; },
         .BTM_block_role_switch_for = [](const RawAddress& /* peer_addr */) {},
@@ -76,6 +76,7 @@ tBTM_SCO_DEBUG_DUMP BTM_GetScoDebugDump(void) {
   inc_func_call_count(__func__);
   return {};
 }
+void BTM_ScoDumpsys(int /* fd */) { inc_func_call_count(__func__); }
 void BTM_EScoConnRsp(uint16_t /* sco_inx */, uint8_t /* hci_status */,
                      enh_esco_params_t* /* p_parms */) {
   inc_func_call_count(__func__);
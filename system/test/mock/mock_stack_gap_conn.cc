@@ -57,11 +57,23 @@ uint16_t GAP_ConnOpen(const char* /* p_serv_name */, uint8_t /* service_id */,
   inc_func_call_count(__func__);
   return 0;
 }
+std::vector<uint16_t> GAP_ConnOpenCreditBased(
+    const char* /* p_serv_name */, uint8_t /* service_id */,
+    const RawAddress& /* rem_bda */, uint16_t /* psm */, uint16_t /* le_mps */,
+    tL2CAP_CFG_INFO* /* p_cfg */, uint16_t /* security */,
+    tGAP_CONN_CALLBACK* /* p_cb */, uint8_t /* num_channels */) {
+  inc_func_call_count(__func__);
+  return {};
+}
 uint16_t GAP_ConnReadData(uint16_t /* gap_handle */, uint8_t* /* p_data */,
                           uint16_t /* max_len */, uint16_t* /* p_len */) {
   inc_func_call_count(__func__);
   return 0;
 }
+uint16_t GAP_ConnBTRead(uint16_t /* gap_handle */, BT_HDR** /* pp_buf */) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 uint16_t GAP_ConnWriteData(uint16_t /* gap_handle */, BT_HDR* /* msg */) {
   inc_func_call_count(__func__);
   return 0;
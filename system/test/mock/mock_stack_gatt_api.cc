@@ -45,12 +45,15 @@ struct GATTC_ConfigureMTU GATTC_ConfigureMTU;
 struct GATTC_Discover GATTC_Discover;
 struct GATTC_ExecuteWrite GATTC_ExecuteWrite;
 struct GATTC_Read GATTC_Read;
+struct GATTC_GetMaxReadMultiVarHandles GATTC_GetMaxReadMultiVarHandles;
 struct GATTC_SendHandleValueConfirm GATTC_SendHandleValueConfirm;
 struct GATTC_Write GATTC_Write;
+struct GATTC_WriteNoRspBatch GATTC_WriteNoRspBatch;
 struct GATTS_AddService GATTS_AddService;
 struct GATTS_DeleteService GATTS_DeleteService;
 struct GATTS_HandleValueIndication GATTS_HandleValueIndication;
 struct GATTS_HandleValueNotification GATTS_HandleValueNotification;
+struct GATTS_HandleValueNotificationBatch GATTS_HandleValueNotificationBatch;
 struct GATTS_NVRegister GATTS_NVRegister;
 struct GATTS_SendRsp GATTS_SendRsp;
 struct GATTS_StopService GATTS_StopService;
@@ -84,12 +87,15 @@ tGATT_STATUS GATTC_ConfigureMTU::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Discover::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_ExecuteWrite::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Read::return_value = GATT_SUCCESS;
+uint8_t GATTC_GetMaxReadMultiVarHandles::return_value = 0;
 tGATT_STATUS GATTC_SendHandleValueConfirm::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Write::return_value = GATT_SUCCESS;
+uint16_t GATTC_WriteNoRspBatch::return_value = 0;
 tGATT_STATUS GATTS_AddService::return_value = GATT_SUCCESS;
 bool GATTS_DeleteService::return_value = false;
 tGATT_STATUS GATTS_HandleValueIndication::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTS_HandleValueNotification::return_value = GATT_SUCCESS;
+uint16_t GATTS_HandleValueNotificationBatch::return_value = 0;
 bool GATTS_NVRegister::return_value = false;
 tGATT_STATUS GATTS_SendRsp::return_value = GATT_SUCCESS;
 bool GATT_CancelConnect::return_value = false;
@@ -147,6 +153,10 @@ tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
   inc_func_call_count(__func__);
   return test::mock::stack_gatt_api::GATTC_Read(conn_id, type, p_read);
 }
+uint8_t GATTC_GetMaxReadMultiVarHandles(uint16_t conn_id) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTC_GetMaxReadMultiVarHandles(conn_id);
+}
 tGATT_STATUS GATTC_SendHandleValueConfirm(uint16_t conn_id, uint16_t cid) {
   inc_func_call_count(__func__);
   return test::mock::stack_gatt_api::GATTC_SendHandleValueConfirm(conn_id, cid);
@@ -156,6 +166,13 @@ tGATT_STATUS GATTC_Write(uint16_t conn_id, tGATT_WRITE_TYPE type,
   inc_func_call_count(__func__);
   return test::mock::stack_gatt_api::GATTC_Write(conn_id, type, p_write);
 }
+uint16_t GATTC_WriteNoRspBatch(uint16_t conn_id,
+                               const tGATT_VALUE_REF* p_values,
+                               uint16_t num_values) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTC_WriteNoRspBatch(conn_id, p_values,
+                                                          num_values);
+}
 tGATT_STATUS GATTS_AddService(tGATT_IF gatt_if, btgatt_db_element_t* service,
                               int count) {
   inc_func_call_count(__func__);
@@ -180,6 +197,13 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
   return test::mock::stack_gatt_api::GATTS_HandleValueNotification(
       conn_id, attr_handle, val_len, p_val);
 }
+uint16_t GATTS_HandleValueNotificationBatch(uint16_t conn_id,
+                                            const tGATT_VALUE_REF* p_values,
+                                            uint16_t num_values) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTS_HandleValueNotificationBatch(
+      conn_id, p_values, num_values);
+}
 bool GATTS_NVRegister(tGATT_APPL_INFO* p_cb_info) {
   inc_func_call_count(__func__);
   return test::mock::stack_gatt_api::GATTS_NVRegister(p_cb_info);
@@ -264,4 +288,6 @@ bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
       gatt_if, bd_addr, 0, connection_type, transport, opportunistic, 0);
 }
 
+void GATT_Dumpsys(int /* fd */) { inc_func_call_count(__func__); }
+
 // END mockcify generation
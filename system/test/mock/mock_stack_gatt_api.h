@@ -163,6 +163,34 @@ struct GATTC_Read {
 };
 extern struct GATTC_Read GATTC_Read;
 
+// Name: GATTC_GetMaxReadMultiVarHandles
+// Params: uint16_t conn_id
+// Return: uint8_t
+struct GATTC_GetMaxReadMultiVarHandles {
+  static uint8_t return_value;
+  std::function<uint8_t(uint16_t conn_id)> body{
+      [](uint16_t /* conn_id */) { return return_value; }};
+  uint8_t operator()(uint16_t conn_id) { return body(conn_id); };
+};
+extern struct GATTC_GetMaxReadMultiVarHandles GATTC_GetMaxReadMultiVarHandles;
+
+// Name: GATTC_WriteNoRspBatch
+// Params: uint16_t conn_id, const tGATT_VALUE_REF* p_values, uint16_t
+// num_values
+// Return: uint16_t
+struct GATTC_WriteNoRspBatch {
+  static uint16_t return_value;
+  std::function<uint16_t(uint16_t conn_id, const tGATT_VALUE_REF* p_values,
+                         uint16_t num_values)>
+      body{[](uint16_t /* conn_id */, const tGATT_VALUE_REF* /* p_values */,
+              uint16_t /* num_values */) { return return_value; }};
+  uint16_t operator()(uint16_t conn_id, const tGATT_VALUE_REF* p_values,
+                      uint16_t num_values) {
+    return body(conn_id, p_values, num_values);
+  };
+};
+extern struct GATTC_WriteNoRspBatch GATTC_WriteNoRspBatch;
+
 // Name: GATTC_SendHandleValueConfirm
 // Params: uint16_t conn_id, uint16_t cid
 // Return: tGATT_STATUS
@@ -239,6 +267,24 @@ struct GATTS_HandleValueIndication {
 };
 extern struct GATTS_HandleValueIndication GATTS_HandleValueIndication;
 
+// Name: GATTS_HandleValueNotificationBatch
+// Params: uint16_t conn_id, const tGATT_VALUE_REF* p_values, uint16_t
+// num_values
+// Return: uint16_t
+struct GATTS_HandleValueNotificationBatch {
+  static uint16_t return_value;
+  std::function<uint16_t(uint16_t conn_id, const tGATT_VALUE_REF* p_values,
+                         uint16_t num_values)>
+      body{[](uint16_t /* conn_id */, const tGATT_VALUE_REF* /* p_values */,
+              uint16_t /* num_values */) { return return_value; }};
+  uint16_t operator()(uint16_t conn_id, const tGATT_VALUE_REF* p_values,
+                      uint16_t num_values) {
+    return body(conn_id, p_values, num_values);
+  };
+};
+extern struct GATTS_HandleValueNotificationBatch
+    GATTS_HandleValueNotificationBatch;
+
 // Name: GATTS_HandleValueNotification
 // Params: uint16_t conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t*
 // p_val Return: tGATT_STATUS
@@ -61,11 +61,13 @@ struct L2CA_GetPeerFeatures L2CA_GetPeerFeatures;
 struct L2CA_RegisterFixedChannel L2CA_RegisterFixedChannel;
 struct L2CA_ConnectFixedChnl L2CA_ConnectFixedChnl;
 struct L2CA_SendFixedChnlData L2CA_SendFixedChnlData;
+struct L2CA_GetFixedChnlTxRoom L2CA_GetFixedChnlTxRoom;
 struct L2CA_RemoveFixedChnl L2CA_RemoveFixedChnl;
 struct L2CA_SetLeGattTimeout L2CA_SetLeGattTimeout;
 struct L2CA_MarkLeLinkAsActive L2CA_MarkLeLinkAsActive;
 struct L2CA_DataWrite L2CA_DataWrite;
 struct L2CA_LECocDataWrite L2CA_LECocDataWrite;
+struct L2CA_GetTxRoom L2CA_GetTxRoom;
 struct L2CA_SetChnlFlushability L2CA_SetChnlFlushability;
 struct L2CA_FlushChannel L2CA_FlushChannel;
 struct L2CA_IsLinkEstablished L2CA_IsLinkEstablished;
@@ -73,6 +75,7 @@ struct L2CA_SetMediaStreamChannel L2CA_SetMediaStreamChannel;
 struct L2CA_isMediaChannel L2CA_isMediaChannel;
 struct L2CA_LeCreditDefault L2CA_LeCreditDefault;
 struct L2CA_LeCreditThreshold L2CA_LeCreditThreshold;
+struct L2CA_Dumpsys L2CA_Dumpsys;
 
 }  // namespace stack_l2cap_api
 }  // namespace mock
@@ -222,6 +225,11 @@ uint16_t L2CA_SendFixedChnlData(uint16_t fixed_cid, const RawAddress& rem_bda,
   return test::mock::stack_l2cap_api::L2CA_SendFixedChnlData(fixed_cid, rem_bda,
                                                              p_buf);
 }
+uint16_t L2CA_GetFixedChnlTxRoom(uint16_t fixed_cid, const RawAddress& rem_bda) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_l2cap_api::L2CA_GetFixedChnlTxRoom(fixed_cid,
+                                                              rem_bda);
+}
 bool L2CA_RemoveFixedChnl(uint16_t fixed_cid, const RawAddress& rem_bda) {
   inc_func_call_count(__func__);
   return test::mock::stack_l2cap_api::L2CA_RemoveFixedChnl(fixed_cid, rem_bda);
@@ -242,6 +250,10 @@ uint8_t L2CA_LECocDataWrite(uint16_t cid, BT_HDR* p_data) {
   inc_func_call_count(__func__);
   return test::mock::stack_l2cap_api::L2CA_LECocDataWrite(cid, p_data);
 }
+uint16_t L2CA_GetTxRoom(uint16_t cid) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_l2cap_api::L2CA_GetTxRoom(cid);
+}
 bool L2CA_SetChnlFlushability(uint16_t cid, bool is_flushable) {
   inc_func_call_count(__func__);
   return test::mock::stack_l2cap_api::L2CA_SetChnlFlushability(cid,
@@ -276,5 +288,9 @@ uint16_t L2CA_LeCreditThreshold() {
   inc_func_call_count(__func__);
   return test::mock::stack_l2cap_api::L2CA_LeCreditThreshold();
 }
+void L2CA_Dumpsys(int fd) {
+  inc_func_call_count(__func__);
+  test::mock::stack_l2cap_api::L2CA_Dumpsys(fd);
+}
 
 // END mockcify generation
@@ -387,6 +387,19 @@ struct L2CA_SendFixedChnlData {
   };
 };
 extern struct L2CA_SendFixedChnlData L2CA_SendFixedChnlData;
+// Name: L2CA_GetFixedChnlTxRoom
+// Params: uint16_t fixed_cid, const RawAddress& rem_bda
+// Returns: uint16_t
+struct L2CA_GetFixedChnlTxRoom {
+  std::function<uint16_t(uint16_t fixed_cid, const RawAddress& rem_bda)> body{
+      [](uint16_t /* fixed_cid */, const RawAddress& /* rem_bda */) {
+        return 0;
+      }};
+  uint16_t operator()(uint16_t fixed_cid, const RawAddress& rem_bda) {
+    return body(fixed_cid, rem_bda);
+  };
+};
+extern struct L2CA_GetFixedChnlTxRoom L2CA_GetFixedChnlTxRoom;
 // Name: L2CA_RemoveFixedChnl
 // Params: uint16_t fixed_cid, const RawAddress& rem_bda
 // Returns: bool
@@ -444,6 +457,15 @@ struct L2CA_LECocDataWrite {
   };
 };
 extern struct L2CA_LECocDataWrite L2CA_LECocDataWrite;
+// Name: L2CA_GetTxRoom
+// Params: uint16_t cid
+// Returns: uint16_t
+struct L2CA_GetTxRoom {
+  std::function<uint16_t(uint16_t cid)> body{
+      [](uint16_t /* cid */) { return 0; }};
+  uint16_t operator()(uint16_t cid) { return body(cid); };
+};
+extern struct L2CA_GetTxRoom L2CA_GetTxRoom;
 // Name: L2CA_SetChnlFlushability
 // Params: uint16_t cid, bool is_flushable
 // Returns: bool
@@ -518,6 +540,14 @@ struct L2CA_LeCreditThreshold {
   uint16_t operator()() { return body(); };
 };
 extern struct L2CA_LeCreditThreshold L2CA_LeCreditThreshold;
+// Name: L2CA_Dumpsys
+// Params: int fd
+// Returns: void
+struct L2CA_Dumpsys {
+  std::function<void(int fd)> body{[](int /* fd */) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct L2CA_Dumpsys L2CA_Dumpsys;
 
 }  // namespace stack_l2cap_api
 }  // namespace mock
@@ -51,6 +51,10 @@ struct l2cble_process_rc_param_request_evt l2cble_process_rc_param_request_evt;
 struct l2cble_update_data_length l2cble_update_data_length;
 struct l2cble_process_data_length_change_event
     l2cble_process_data_length_change_event;
+struct l2cble_link_opt_start l2cble_link_opt_start;
+struct l2cble_link_opt_stop l2cble_link_opt_stop;
+struct l2cble_link_opt_traffic l2cble_link_opt_traffic;
+struct l2cble_link_opt_next_class l2cble_link_opt_next_class;
 struct l2cble_credit_based_conn_req l2cble_credit_based_conn_req;
 struct l2cble_credit_based_conn_res l2cble_credit_based_conn_res;
 struct l2cble_send_flow_control_credit l2cble_send_flow_control_credit;
@@ -140,6 +144,22 @@ void l2cble_process_data_length_change_event(uint16_t handle,
   test::mock::stack_l2cap_ble::l2cble_process_data_length_change_event(
       handle, tx_data_len, rx_data_len);
 }
+void l2cble_link_opt_start(tL2C_LCB* p_lcb) {
+  inc_func_call_count(__func__);
+  test::mock::stack_l2cap_ble::l2cble_link_opt_start(p_lcb);
+}
+void l2cble_link_opt_stop(tL2C_LCB* p_lcb) {
+  inc_func_call_count(__func__);
+  test::mock::stack_l2cap_ble::l2cble_link_opt_stop(p_lcb);
+}
+void l2cble_link_opt_traffic(tL2C_LCB* p_lcb, uint16_t cid, uint16_t len) {
+  inc_func_call_count(__func__);
+  test::mock::stack_l2cap_ble::l2cble_link_opt_traffic(p_lcb, cid, len);
+}
+tL2C_BLE_TRAFFIC_CLASS l2cble_link_opt_next_class(tL2C_BLE_LINK_OPT* p_opt) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_l2cap_ble::l2cble_link_opt_next_class(p_opt);
+}
 void l2cble_credit_based_conn_req(tL2C_CCB* p_ccb) {
   inc_func_call_count(__func__);
   test::mock::stack_l2cap_ble::l2cble_credit_based_conn_req(p_ccb);
@@ -207,6 +207,44 @@ struct l2cble_process_data_length_change_event {
 };
 extern struct l2cble_process_data_length_change_event
     l2cble_process_data_length_change_event;
+// Name: l2cble_link_opt_start
+// Params: tL2C_LCB* p_lcb
+// Returns: void
+struct l2cble_link_opt_start {
+  std::function<void(tL2C_LCB* p_lcb)> body{[](tL2C_LCB* /* p_lcb */) {}};
+  void operator()(tL2C_LCB* p_lcb) { body(p_lcb); };
+};
+extern struct l2cble_link_opt_start l2cble_link_opt_start;
+// Name: l2cble_link_opt_stop
+// Params: tL2C_LCB* p_lcb
+// Returns: void
+struct l2cble_link_opt_stop {
+  std::function<void(tL2C_LCB* p_lcb)> body{[](tL2C_LCB* /* p_lcb */) {}};
+  void operator()(tL2C_LCB* p_lcb) { body(p_lcb); };
+};
+extern struct l2cble_link_opt_stop l2cble_link_opt_stop;
+// Name: l2cble_link_opt_traffic
+// Params: tL2C_LCB* p_lcb, uint16_t cid, uint16_t len
+// Returns: void
+struct l2cble_link_opt_traffic {
+  std::function<void(tL2C_LCB* p_lcb, uint16_t cid, uint16_t len)> body{
+      [](tL2C_LCB* /* p_lcb */, uint16_t /* cid */, uint16_t /* len */) {}};
+  void operator()(tL2C_LCB* p_lcb, uint16_t cid, uint16_t len) {
+    body(p_lcb, cid, len);
+  };
+};
+extern struct l2cble_link_opt_traffic l2cble_link_opt_traffic;
+// Name: l2cble_link_opt_next_class
+// Params: tL2C_BLE_LINK_OPT* p_opt
+// Returns: tL2C_BLE_TRAFFIC_CLASS
+struct l2cble_link_opt_next_class {
+  std::function<tL2C_BLE_TRAFFIC_CLASS(tL2C_BLE_LINK_OPT* p_opt)> body{
+      [](tL2C_BLE_LINK_OPT* /* p_opt */) { return L2C_BLE_TRAFFIC_IDLE; }};
+  tL2C_BLE_TRAFFIC_CLASS operator()(tL2C_BLE_LINK_OPT* p_opt) {
+    return body(p_opt);
+  };
+};
+extern struct l2cble_link_opt_next_class l2cble_link_opt_next_class;
 // Name: l2cble_credit_based_conn_req
 // Params: tL2C_CCB* p_ccb
 // Returns: void
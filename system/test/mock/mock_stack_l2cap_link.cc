@@ -49,6 +49,10 @@ void l2c_info_resp_timer_timeout(void* /* data */) {
 }
 void l2c_link_adjust_allocation(void) { inc_func_call_count(__func__); }
 void l2c_link_adjust_chnl_allocation(void) { inc_func_call_count(__func__); }
+void l2c_link_split_quota(uint16_t /* total */, const uint32_t* /* demand */,
+                          uint16_t* /* quota */, uint16_t /* num_links */) {
+  inc_func_call_count(__func__);
+}
 void l2c_link_check_send_pkts(tL2C_LCB* /* p_lcb */, uint16_t /* local_cid */,
                               BT_HDR* /* p_buf */) {
   inc_func_call_count(__func__);
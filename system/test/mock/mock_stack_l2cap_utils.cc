@@ -130,6 +130,9 @@ void l2cu_adj_id(tL2C_LCB* /* p_lcb */) { inc_func_call_count(__func__); }
 void l2cu_adjust_out_mps(tL2C_CCB* /* p_ccb */) {
   inc_func_call_count(__func__);
 }
+void l2cu_ccb_data_queued(tL2C_CCB* /* p_ccb */) {
+  inc_func_call_count(__func__);
+}
 void l2cu_change_pri_ccb(tL2C_CCB* /* p_ccb */,
                          tL2CAP_CHNL_PRIORITY /* priority */) {
   inc_func_call_count(__func__);
@@ -137,6 +140,10 @@ void l2cu_change_pri_ccb(tL2C_CCB* /* p_ccb */,
 void l2cu_check_channel_congestion(tL2C_CCB* /* p_ccb */) {
   inc_func_call_count(__func__);
 }
+uint16_t l2cu_get_tx_room(const tL2C_CCB* /* p_ccb */) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 void l2cu_create_conn_after_switch(tL2C_LCB* /* p_lcb */) {
   inc_func_call_count(__func__);
 }
@@ -194,6 +201,9 @@ void l2cu_release_ble_rcb(tL2C_RCB* /* p_rcb */) {
 void l2cu_release_ccb(tL2C_CCB* /* p_ccb */) { inc_func_call_count(__func__); }
 void l2cu_release_lcb(tL2C_LCB* /* p_lcb */) { inc_func_call_count(__func__); }
 void l2cu_release_rcb(tL2C_RCB* /* p_rcb */) { inc_func_call_count(__func__); }
+void l2cu_remove_ready_ccb(tL2C_CCB* /* p_ccb */) {
+  inc_func_call_count(__func__);
+}
 void l2cu_resubmit_pending_sec_req(const RawAddress* /* p_bda */) {
   inc_func_call_count(__func__);
 }
@@ -283,6 +293,10 @@ void l2cu_send_peer_info_rsp(tL2C_LCB* /* p_lcb */, uint8_t /* remote_id */,
 void l2cu_set_acl_hci_header(BT_HDR* /* p_buf */, tL2C_CCB* /* p_ccb */) {
   inc_func_call_count(__func__);
 }
+void l2cu_set_lcb_bd_addr(tL2C_LCB* /* p_lcb */,
+                          const RawAddress& /* bd_addr */) {
+  inc_func_call_count(__func__);
+}
 void l2cu_set_lcb_handle(struct t_l2c_linkcb& /* p_lcb */,
                          uint16_t /* handle */) {
   inc_func_call_count(__func__);
@@ -109,6 +109,11 @@ int RFCOMM_RemoveServer(uint16_t /* handle */) {
   inc_func_call_count(__func__);
   return 0;
 }
+int PORT_SetTxPriority(uint16_t /* handle */, bool /* control_plane */,
+                       uint8_t /* weight */) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 int PORT_GetSecurityMask(uint16_t /* handle */, uint16_t* /* sec_mask */) {
   inc_func_call_count(__func__);
   return 0;
@@ -38,6 +38,7 @@
 #include "osi/include/ringbuffer.h"
 #include "osi/include/socket.h"
 #include "osi/include/thread.h"
+#include "osi/include/thread_scheduler.h"
 #include "osi/include/wakelock.h"
 #include "osi/src/compat.cc"  // For strlcpy
 #include "test/common/fake_osi.h"
@@ -253,11 +254,19 @@ char* osi_strndup(const char* str, size_t len) {
 }
 void osi_free(void* ptr) { inc_func_call_count(__func__); }
 void osi_free_and_reset(void** p_ptr) { inc_func_call_count(__func__); }
-void* osi_calloc(size_t size) {
+void* osi_calloc(size_t size, const char* caller_file) {
   inc_func_call_count(__func__);
   return nullptr;
 }
-void* osi_malloc(size_t size) {
+void* osi_malloc(size_t size, const char* caller_file) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+void* osi_calloc_tagged(osi_alloc_tag_t tag, size_t size) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+void* osi_malloc_tagged(osi_alloc_tag_t tag, size_t size) {
   inc_func_call_count(__func__);
   return nullptr;
 }
@@ -339,6 +348,11 @@ alarm_t* alarm_new_periodic(const char* name) {
   inc_func_call_count(__func__);
   return nullptr;
 }
+alarm_t* alarm_new_with_priority(const char* name, bool is_periodic,
+                                 alarm_priority_t priority) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
 struct fake_osi_alarm_set_on_mloop fake_osi_alarm_set_on_mloop_;
 bool alarm_is_scheduled(const alarm_t* alarm) {
   inc_func_call_count(__func__);
@@ -562,6 +576,17 @@ int32_t osi_property_get_int32(const char* key, int32_t default_value) {
   return 0;
 }
 
+bool thread_scheduler_get_profile(const char* name,
+                                  thread_scheduler_profile_t* profile) {
+  inc_func_call_count(__func__);
+  return false;
+}
+bool thread_scheduler_apply_profile(pid_t linux_tid, const char* name) {
+  inc_func_call_count(__func__);
+  return true;
+}
+void thread_scheduler_debug_dump(int fd) { inc_func_call_count(__func__); }
+
 bool wakelock_acquire(void) {
   inc_func_call_count(__func__);
   return false;
@@ -570,6 +595,17 @@ bool wakelock_release(void) {
   inc_func_call_count(__func__);
   return false;
 }
+bool wakelock_acquire_for(const char* reason) {
+  inc_func_call_count(__func__);
+  return false;
+}
+bool wakelock_release_for(const char* reason) {
+  inc_func_call_count(__func__);
+  return false;
+}
+void wakelock_set_linger_ms(uint64_t linger_ms) {
+  inc_func_call_count(__func__);
+}
 void wakelock_cleanup(void) { inc_func_call_count(__func__); }
 void wakelock_debug_dump(int fd) { inc_func_call_count(__func__); }
 void wakelock_set_os_callouts(bt_os_callouts_t* callouts) {